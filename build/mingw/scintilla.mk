@@ -4,8 +4,6 @@ PROJ = scintilla
 NAME = lib$(PROJ).a
 OBJDIR = $(BINFOLDER)/obj/$(PROJ)
 
-CPPFLAGS += -DNO_CXX11_REGEX
-
 scintilla_dir = ../../scintilla
 lexers_dir = $(scintilla_dir)/lexers
 lexlib_dir = $(scintilla_dir)/lexlib
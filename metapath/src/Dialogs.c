@@ -1901,8 +1901,8 @@ INT_PTR CALLBACK OpenWithDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lPa
 				DirList_GetDispInfo(hwndLV, lParam, flagNoFadeHidden);
 				break;
 
-			case LVN_DELETEITEM:
-				DirList_DeleteItem(hwndLV, lParam);
+			case LVN_ODFINDITEM:
+				SetWindowLongPtr(hwnd, DWLP_MSGRESULT, DirList_FindItem(hwndLV, lParam));
 				break;
 
 			case LVN_ITEMCHANGED: {
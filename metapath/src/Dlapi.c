@@ -20,6 +20,7 @@
 
 #include <windows.h>
 #include <windowsx.h>
+#include <stdlib.h>
 #include <shlwapi.h>
 #include <shlobj.h>
 #include <shellapi.h>
@@ -28,6 +29,56 @@
 #include "Dlapi.h"
 
 //==== DirList ================================================================
+//==== DLENTRY Structure ======================================================
+
+// The listview is an owner data (virtual) control, items are kept in
+// DLDATA.entries and sorted by the keys cached from WIN32_FIND_DATA.
+typedef struct DLENTRY { // dle
+	LPITEMIDLIST pidl;			// Item Id relative to DLDATA.pidl, NULL for DL_RECURSIVE
+	LPCWSTR pszName;			// File name or path relative to DLDATA.szPath, stored in a DLNAMEBLOCK
+	LPCWSTR pszExt;				// Extension inside pszName, sort key for DS_TYPE
+	ULONGLONG size;				// File size
+	FILETIME ftLastWriteTime;	// Last modified time
+	DWORD dwAttributes;			// File attributes
+	int iImage;					// Icon index, default icon until resolved
+	UINT state;					// LVIS_OVERLAYMASK and LVIS_CUT state
+	BOOL bIconResolved;			// Icon and overlay has been set by Icon Thread
+} DLENTRY;
+
+#define DLNAMEBLOCK_SIZE	(32*1024 - 8)	// WCHARs, must be larger than MAX_PATH
+
+// names are allocated in blocks which are never moved, block list is freed as a whole.
+typedef struct DLNAMEBLOCK {
+	struct DLNAMEBLOCK *next;
+	UINT used;
+	WCHAR text[DLNAMEBLOCK_SIZE];
+} DLNAMEBLOCK;
+
+//==== DLCACHE Structure ======================================================
+
+#define DLCACHE_SIZE	4
+
+// listing of a previously visited directory, valid until hChange is signaled.
+typedef struct DLCACHE {
+	HANDLE hChange;				// FindFirstChangeNotification(), NULL for empty slot
+	UINT serial;				// Larger for recently cached listing
+	UINT cbidl;
+	LPITEMIDLIST pidl;
+	LPSHELLFOLDER lpsf;
+	WCHAR szPath[MAX_PATH];
+	DWORD grfFlags;
+	DL_FILTER dlf;				// Only used to compare filter, pFilter is not valid
+	BOOL bNoFadeHidden;
+	DLENTRY *entries;
+	UINT count;
+	UINT capacity;
+	DLNAMEBLOCK *names;
+} DLCACHE;
+
+#define DLWATCH_BUFFER_SIZE		(64*1024)	// maximum size for network directory
+#define DLWATCH_NOTIFY_FILTER	(FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | \
+		FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE)
+
 //==== DLDATA Structure =======================================================
 
 typedef struct DLDATA { // dl
@@ -39,9 +90,20 @@ typedef struct DLDATA { // dl
 	int iDefIconFolder;			// Default Folder Icon
 	int iDefIconFile;			// Default File Icon
 	BOOL bNoFadeHidden;			// Flag passed from GetDispInfo()
-	HANDLE hExitThread;			// Flag is set when Icon Thread should terminate
-	HANDLE hTerminatedThread;	// Flag is set when Icon Thread has terminated
-	HANDLE hIconThread;
+	DLENTRY *entries;			// Items displayed in the listview
+	UINT count;
+	UINT capacity;
+	DLNAMEBLOCK *names;			// Storage for DLENTRY.pszName
+	BOOL bComplete;				// All items has been enumerated
+	DWORD grfFlags;				// Flags passed to DirList_Fill()
+	DL_FILTER dlf;				// Filter passed to DirList_Fill()
+	int iSortFlags;				// Current sort order of entries
+	BOOL fSortRev;
+	HANDLE hWatchDir;			// Directory handle for ReadDirectoryChangesW()
+	OVERLAPPED watchOverlapped;
+	LPBYTE watchBuffer;
+	UINT cacheSerial;
+	DLCACHE cache[DLCACHE_SIZE];	// Listings of recently visited directories
 } DLDATA, *LPDLDATA;
 
 typedef const DLDATA * LPCDLDATA;
@@ -70,11 +132,12 @@ void DirList_Init(HWND hwnd, LPCWSTR pszHeader) {
 	lstrcpy(lpdl->szPath, L"");
 
 	SHFILEINFO shfi;
-	// Add Imagelists
-	HIMAGELIST hil = (HIMAGELIST)SHGetFileInfo(L"C:\\", 0, &shfi, sizeof(SHFILEINFO), SHGFI_SMALLICON | SHGFI_SYSICONINDEX);
+	// Add Imagelists, system image list is shared by all items,
+	// use attributes only to not touch the disk on startup.
+	HIMAGELIST hil = (HIMAGELIST)SHGetFileInfo(L"C:\\", FILE_ATTRIBUTE_DIRECTORY, &shfi, sizeof(SHFILEINFO), SHGFI_USEFILEATTRIBUTES | SHGFI_SMALLICON | SHGFI_SYSICONINDEX);
 	ListView_SetImageList(hwnd, hil, LVSIL_SMALL);
 
-	hil = (HIMAGELIST)SHGetFileInfo(L"C:\\", 0, &shfi, sizeof(SHFILEINFO), SHGFI_LARGEICON | SHGFI_SYSICONINDEX);
+	hil = (HIMAGELIST)SHGetFileInfo(L"C:\\", FILE_ATTRIBUTE_DIRECTORY, &shfi, sizeof(SHFILEINFO), SHGFI_USEFILEATTRIBUTES | SHGFI_LARGEICON | SHGFI_SYSICONINDEX);
 	ListView_SetImageList(hwnd, hil, LVSIL_NORMAL);
 
 	// Initialize default icons - done in DirList_Fill()
@@ -86,6 +149,219 @@ void DirList_Init(HWND hwnd, LPCWSTR pszHeader) {
 
 	lpdl->iDefIconFolder = 0;
 	lpdl->iDefIconFile = 0;
+	lpdl->watchOverlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	// overlay and fading are provided by DirList_GetDispInfo()
+	ListView_SetCallbackMask(hwnd, LVIS_OVERLAYMASK | LVIS_CUT);
+}
+
+static LPCWSTR DirList_AddName(DLNAMEBLOCK **names, LPCWSTR pszName) {
+	const UINT cch = lstrlen(pszName) + 1;
+	DLNAMEBLOCK *block = *names;
+	if (block == NULL || block->used + cch > DLNAMEBLOCK_SIZE) {
+		block = (DLNAMEBLOCK *)NP2HeapAlloc(sizeof(DLNAMEBLOCK));
+		block->next = *names;
+		*names = block;
+	}
+	LPWSTR lpszName = block->text + block->used;
+	CopyMemory(lpszName, pszName, cch * sizeof(WCHAR));
+	block->used += cch;
+	return lpszName;
+}
+
+static void DirList_FreeNames(DLNAMEBLOCK *names) {
+	while (names) {
+		DLNAMEBLOCK *next = names->next;
+		NP2HeapFree(names);
+		names = next;
+	}
+}
+
+static void DirList_FreeListing(DLENTRY *entries, UINT count, DLNAMEBLOCK *names) {
+	if (entries) {
+		for (UINT i = 0; i < count; i++) {
+			CoTaskMemFree((LPVOID)(entries[i].pidl));
+		}
+		NP2HeapFree(entries);
+	}
+	DirList_FreeNames(names);
+}
+
+static void DirList_FreeEntries(LPDLDATA lpdl) {
+	DirList_FreeListing(lpdl->entries, lpdl->count, lpdl->names);
+	lpdl->entries = NULL;
+	lpdl->count = 0;
+	lpdl->capacity = 0;
+	lpdl->names = NULL;
+}
+
+static inline DLENTRY *DirList_GetEntry(LPCDLDATA lpdl, int iItem) {
+	return ((UINT)iItem < lpdl->count) ? &lpdl->entries[iItem] : NULL;
+}
+
+// full path of entry without pidl, found by DirList_FindThread()
+static void DirList_GetEntryPath(LPCDLDATA lpdl, const DLENTRY *dle, LPWSTR lpszPath) {
+	lstrcpy(lpszPath, lpdl->szPath);
+	PathAppend(lpszPath, dle->pszName);
+}
+
+static void DirList_GrowEntries(LPDLDATA lpdl, UINT count) {
+	if (count > lpdl->capacity) {
+		UINT capacity = 2*lpdl->capacity;
+		if (capacity < count) {
+			capacity = count;
+		}
+		DLENTRY *entries = (DLENTRY *)NP2HeapAlloc(capacity * sizeof(DLENTRY));
+		if (lpdl->entries) {
+			CopyMemory(entries, lpdl->entries, lpdl->count * sizeof(DLENTRY));
+			NP2HeapFree(lpdl->entries);
+		}
+		lpdl->entries = entries;
+		lpdl->capacity = capacity;
+	}
+}
+
+static void DirList_InitEntry(LPCDLDATA lpdl, DLENTRY *dle, LPITEMIDLIST pidl, const WIN32_FIND_DATA *pfd, DLNAMEBLOCK **names) {
+	dle->pidl = pidl;
+	dle->pszName = DirList_AddName(names, pfd->cFileName);
+	dle->pszExt = PathFindExtension(dle->pszName);
+	dle->size = (((ULONGLONG)pfd->nFileSizeHigh) << 32) | pfd->nFileSizeLow;
+	dle->ftLastWriteTime = pfd->ftLastWriteTime;
+	dle->dwAttributes = pfd->dwFileAttributes;
+	// Setup default Icon - Folder or File
+	dle->iImage = (pfd->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? lpdl->iDefIconFolder : lpdl->iDefIconFile;
+	// Fade hidden/system files
+	dle->state = (!lpdl->bNoFadeHidden && (pfd->dwFileAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM))) ? LVIS_CUT : 0;
+	dle->bIconResolved = FALSE;
+}
+
+static void DirList_GetFindData(LPSHELLFOLDER lpsf, LPCITEMIDLIST pidl, DWORD dwAttributes, LPWIN32_FIND_DATA pfd) {
+	if (S_OK != SHGetDataFromIDList(lpsf, pidl, SHGDFIL_FINDDATA, pfd, sizeof(WIN32_FIND_DATA))) {
+		ZeroMemory(pfd, sizeof(WIN32_FIND_DATA));
+		pfd->dwFileAttributes = (dwAttributes & SFGAO_FOLDER) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+		IL_GetDisplayName(lpsf, pidl, SHGDN_INFOLDER | SHGDN_FORPARSING, pfd->cFileName, MAX_PATH);
+	}
+}
+
+// the control only stores state by index, keep focused item when entries are moved.
+// entry is identified by its name pointer, which is unique and not moved.
+static LPCWSTR DirList_GetFocusedEntry(HWND hwnd, LPCDLDATA lpdl, BOOL *pbSelected) {
+	const int iFocus = ListView_GetNextItem(hwnd, -1, LVNI_FOCUSED);
+	const DLENTRY *dle = DirList_GetEntry(lpdl, iFocus);
+	*pbSelected = dle != NULL && ListView_GetItemState(hwnd, iFocus, LVIS_SELECTED) != 0;
+	return dle ? dle->pszName : NULL;
+}
+
+static void DirList_SetFocusedEntry(HWND hwnd, LPCDLDATA lpdl, LPCWSTR pszFocus, BOOL bSelected) {
+	ListView_SetItemState(hwnd, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+	if (pszFocus) {
+		for (UINT i = 0; i < lpdl->count; i++) {
+			if (lpdl->entries[i].pszName == pszFocus) {
+				const UINT state = bSelected ? (LVIS_SELECTED | LVIS_FOCUSED) : LVIS_FOCUSED;
+				ListView_SetItemState(hwnd, i, state, state);
+				break;
+			}
+		}
+	}
+}
+
+//=============================================================================
+//
+//  DirList_StopWatch()
+//
+//  Stop watching changes of current directory, see DirList_StartWatch()
+//
+static void DirList_StopWatch(LPDLDATA lpdl) {
+	HANDLE hDir = lpdl->hWatchDir;
+	if (hDir) {
+		lpdl->hWatchDir = NULL;
+		CancelIo(hDir);
+		DWORD cbTransferred;
+		GetOverlappedResult(hDir, &lpdl->watchOverlapped, &cbTransferred, TRUE);
+		CloseHandle(hDir);
+	}
+}
+
+static inline BOOL DirList_HasPendingChanges(LPCDLDATA lpdl) {
+	return lpdl->hWatchDir && WaitForSingleObject(lpdl->watchOverlapped.hEvent, 0) == WAIT_OBJECT_0;
+}
+
+//=============================================================================
+//
+//  DirList_CacheListing()
+//
+//  Keep listing of current directory for DirList_FillFromCache()
+//
+static void DirList_FreeCacheSlot(DLCACHE *slot) {
+	if (slot->hChange) {
+		FindCloseChangeNotification(slot->hChange);
+		DirList_FreeListing(slot->entries, slot->count, slot->names);
+		CoTaskMemFree((LPVOID)(slot->pidl));
+#if defined(__cplusplus)
+		slot->lpsf->Release();
+#else
+		slot->lpsf->lpVtbl->Release(slot->lpsf);
+#endif
+		ZeroMemory(slot, sizeof(DLCACHE));
+	}
+}
+
+static void DirList_CacheListing(LPDLDATA lpdl) {
+	// changes not applied yet or enumeration stopped by user
+	if (lpdl->lpsf == NULL || lpdl->pidl == NULL || !lpdl->bComplete || DirList_HasPendingChanges(lpdl)) {
+		return;
+	}
+	// subdirectories are not watched
+	if (lpdl->grfFlags & DL_RECURSIVE) {
+		return;
+	}
+
+	HANDLE hChange = FindFirstChangeNotification(lpdl->szPath, FALSE, DLWATCH_NOTIFY_FILTER);
+	if (hChange == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	// changed before hChange is created
+	if (DirList_HasPendingChanges(lpdl)) {
+		FindCloseChangeNotification(hChange);
+		return;
+	}
+
+	// replace listing of same directory, or empty or least recently cached slot
+	DLCACHE *slot = NULL;
+	for (UINT i = 0; i < DLCACHE_SIZE; i++) {
+		DLCACHE *item = &lpdl->cache[i];
+		if (item->hChange == NULL || StrCaseEqual(item->szPath, lpdl->szPath)) {
+			slot = item;
+			break;
+		}
+		if (slot == NULL || item->serial < slot->serial) {
+			slot = item;
+		}
+	}
+
+	DirList_FreeCacheSlot(slot);
+	slot->hChange = hChange;
+	slot->serial = ++lpdl->cacheSerial;
+	slot->cbidl = lpdl->cbidl;
+	slot->pidl = lpdl->pidl;
+	slot->lpsf = lpdl->lpsf;
+	lstrcpy(slot->szPath, lpdl->szPath);
+	slot->grfFlags = lpdl->grfFlags;
+	CopyMemory(&slot->dlf, &lpdl->dlf, sizeof(DL_FILTER));
+	slot->bNoFadeHidden = lpdl->bNoFadeHidden;
+	slot->entries = lpdl->entries;
+	slot->count = lpdl->count;
+	slot->capacity = lpdl->capacity;
+	slot->names = lpdl->names;
+
+	// listing is owned by the slot
+	lpdl->cbidl = 0;
+	lpdl->pidl = NULL;
+	lpdl->lpsf = NULL;
+	lpdl->entries = NULL;
+	lpdl->count = 0;
+	lpdl->capacity = 0;
+	lpdl->names = NULL;
 }
 
 //=============================================================================
@@ -98,6 +374,15 @@ void DirList_Destroy(HWND hwnd) {
 	LPDLDATA lpdl = (LPDLDATA)GetProp(hwnd, pDirListProp);
 
 	BackgroundWorker_Destroy(&lpdl->worker);
+	DirList_StopWatch(lpdl);
+	CloseHandle(lpdl->watchOverlapped.hEvent);
+	if (lpdl->watchBuffer) {
+		NP2HeapFree(lpdl->watchBuffer);
+	}
+	for (UINT i = 0; i < DLCACHE_SIZE; i++) {
+		DirList_FreeCacheSlot(&lpdl->cache[i]);
+	}
+	DirList_FreeEntries(lpdl);
 
 	if (lpdl->pidl) {
 		CoTaskMemFree((LPVOID)(lpdl->pidl));
@@ -129,11 +414,328 @@ void DirList_StartIconThread(HWND hwnd) {
 	lpdl->worker.workerThread = CreateThread(NULL, 0, DirList_IconThread, (LPVOID)lpdl, 0, NULL);
 }
 
+//=============================================================================
+//
+//  DirList_FillThread()
+//
+//  Thread to enumerate directory items in the background, found items are
+//  taken and appended to the listview by DirList_Fill() in batches.
+//
+typedef struct DLFILL {
+	LPDLDATA lpdl;
+	DWORD grfFlags;
+	LPCDL_FILTER pdlf;
+	CRITICAL_SECTION lock;
+	DLENTRY *items;		// pending items, NULL after taken by DirList_Fill()
+	UINT count;
+	UINT capacity;
+	DLNAMEBLOCK *names;	// only used by the threads, moved to DLDATA after they finished
+} DLFILL;
+
+#define DLFILL_BATCH_INTERVAL	100	// milliseconds between listview updates
+
+static void DirList_AddFillItem(DLFILL *fill, LPITEMIDLIST pidl, const WIN32_FIND_DATA *pfd) {
+	EnterCriticalSection(&fill->lock);
+	// names are shared by DirList_FindWorker() threads
+	DLENTRY dle;
+	DirList_InitEntry(fill->lpdl, &dle, pidl, pfd, &fill->names);
+	if (fill->count == fill->capacity) {
+		const UINT capacity = fill->capacity ? 2*fill->capacity : 256;
+		DLENTRY *items = (DLENTRY *)NP2HeapAlloc(capacity * sizeof(DLENTRY));
+		if (fill->items) {
+			CopyMemory(items, fill->items, fill->count * sizeof(DLENTRY));
+			NP2HeapFree(fill->items);
+		}
+		fill->items = items;
+		fill->capacity = capacity;
+	}
+	fill->items[fill->count] = dle;
+	fill->count++;
+	LeaveCriticalSection(&fill->lock);
+}
+
+static DWORD WINAPI DirList_FillThread(LPVOID lpParam) {
+	DLFILL *fill = (DLFILL *)lpParam;
+	BackgroundWorker *worker = &fill->lpdl->worker;
+	LPSHELLFOLDER lpsf = fill->lpdl->lpsf;
+	WIN32_FIND_DATA fd;
+
+	// Create an Enumeration object for lpsf
+	LPENUMIDLIST lpe = NULL;
+#if defined(__cplusplus)
+	if (S_OK == lpsf->EnumObjects(worker->hwnd, fill->grfFlags, &lpe)) {
+		// Enumerate the contents of lpsf
+		LPITEMIDLIST pidlEntry = NULL;
+		while (BackgroundWorker_Continue(worker) && S_OK == lpe->Next(1, &pidlEntry, NULL)) {
+			// Check if it's part of the Filesystem
+			DWORD dwAttributes = SFGAO_FILESYSTEM | SFGAO_FOLDER;
+			lpsf->GetAttributesOf(1, (LPCITEMIDLIST *)(&pidlEntry), &dwAttributes);
+
+			BOOL bMatch = FALSE;
+			if (dwAttributes & SFGAO_FILESYSTEM) {
+				// Check if item matches specified filter
+				DirList_GetFindData(lpsf, pidlEntry, dwAttributes, &fd);
+				bMatch = DirList_MatchFilter(&fd, fill->pdlf);
+			}
+			if (bMatch) {
+				DirList_AddFillItem(fill, pidlEntry, &fd);
+			} else {
+				CoTaskMemFree(pidlEntry);
+			}
+		} // IEnumIDList::Next()
+
+		lpe->Release();
+	} // IShellFolder::EnumObjects()
+#else
+	if (S_OK == lpsf->lpVtbl->EnumObjects(lpsf, worker->hwnd, fill->grfFlags, &lpe)) {
+		// Enumerate the contents of lpsf
+		LPITEMIDLIST pidlEntry = NULL;
+		while (BackgroundWorker_Continue(worker) && S_OK == lpe->lpVtbl->Next(lpe, 1, &pidlEntry, NULL)) {
+			// Check if it's part of the Filesystem
+			DWORD dwAttributes = SFGAO_FILESYSTEM | SFGAO_FOLDER;
+			lpsf->lpVtbl->GetAttributesOf(lpsf, 1, (LPCITEMIDLIST *)(&pidlEntry), &dwAttributes);
+
+			BOOL bMatch = FALSE;
+			if (dwAttributes & SFGAO_FILESYSTEM) {
+				// Check if item matches specified filter
+				DirList_GetFindData(lpsf, pidlEntry, dwAttributes, &fd);
+				bMatch = DirList_MatchFilter(&fd, fill->pdlf);
+			}
+			if (bMatch) {
+				DirList_AddFillItem(fill, pidlEntry, &fd);
+			} else {
+				CoTaskMemFree((LPVOID)pidlEntry);
+			}
+		} // IEnumIDList::Next()
+
+		lpe->lpVtbl->Release(lpe);
+	} // IShellFolder::EnumObjects()
+#endif
+
+	return 0;
+}
+
+//=============================================================================
+//
+//  DirList_FindThread()
+//
+//  Thread to find files in the directory tree for DL_RECURSIVE, directories
+//  are walked with FindFirstFileEx() by DirList_FindWorker() on all processors,
+//  matching files are added with path relative to DLDATA.szPath.
+//
+#define DLFIND_MAX_THREADS	8
+
+typedef struct DLFIND {
+	DLFILL *fill;
+	BOOL bLargeFetch;
+	CRITICAL_SECTION lock;
+	HANDLE hEvent;		// signaled when directory is pushed or all directories are walked
+	LPWSTR *dirs;		// directories to be walked, relative path ends with backslash
+	UINT count;
+	UINT capacity;
+	UINT busy;			// number of threads walking a directory
+	WCHAR szRoot[MAX_PATH];
+	int cchRoot;
+} DLFIND;
+
+static void DirList_PushFindDir(DLFIND *find, LPCWSTR lpszDir, int cchDir) {
+	LPWSTR pszDir = (LPWSTR)NP2HeapAlloc((cchDir + 1) * sizeof(WCHAR));
+	CopyMemory(pszDir, lpszDir, cchDir * sizeof(WCHAR));
+
+	EnterCriticalSection(&find->lock);
+	if (find->count == find->capacity) {
+		const UINT capacity = find->capacity ? 2*find->capacity : 256;
+		LPWSTR *dirs = (LPWSTR *)NP2HeapAlloc(capacity * sizeof(LPWSTR));
+		if (find->dirs) {
+			CopyMemory(dirs, find->dirs, find->count * sizeof(LPWSTR));
+			NP2HeapFree(find->dirs);
+		}
+		find->dirs = dirs;
+		find->capacity = capacity;
+	}
+	find->dirs[find->count] = pszDir;
+	find->count++;
+	LeaveCriticalSection(&find->lock);
+	SetEvent(find->hEvent);
+}
+
+static void DirList_FindInDirectory(DLFIND *find, LPCWSTR lpszDir) {
+	DLFILL *fill = find->fill;
+	const BackgroundWorker *worker = &fill->lpdl->worker;
+	const DWORD grfFlags = fill->grfFlags;
+
+	WCHAR szPath[MAX_PATH];
+	const int cchRoot = find->cchRoot;
+	const int cchDir = lstrlen(lpszDir);
+	if (cchRoot + cchDir + 2 > MAX_PATH) {
+		return;
+	}
+	CopyMemory(szPath, find->szRoot, cchRoot * sizeof(WCHAR));
+	CopyMemory(szPath + cchRoot, lpszDir, cchDir * sizeof(WCHAR));
+	szPath[cchRoot + cchDir] = L'*';
+	szPath[cchRoot + cchDir + 1] = L'\0';
+
+	WIN32_FIND_DATA fd;
+	// FindExInfoBasic and FIND_FIRST_EX_LARGE_FETCH are supported since Windows 7.
+	HANDLE hFind = FindFirstFileEx(szPath, find->bLargeFetch ? FindExInfoBasic : FindExInfoStandard, &fd,
+		FindExSearchNameMatch, NULL, find->bLargeFetch ? FIND_FIRST_EX_LARGE_FETCH : 0);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	// reuse szPath for relative path
+	CopyMemory(szPath, lpszDir, cchDir * sizeof(WCHAR));
+	do {
+		const DWORD dwAttr = fd.dwFileAttributes;
+		if ((dwAttr & FILE_ATTRIBUTE_HIDDEN) && !(grfFlags & DL_INCLHIDDEN)) {
+			continue;
+		}
+
+		const int cchName = lstrlen(fd.cFileName);
+		if (cchRoot + cchDir + cchName + 2 > MAX_PATH) {
+			continue;
+		}
+		if (dwAttr & FILE_ATTRIBUTE_DIRECTORY) {
+			// directory links are skipped to avoid cycles
+			if ((dwAttr & FILE_ATTRIBUTE_REPARSE_POINT)
+				|| (fd.cFileName[0] == L'.' && (fd.cFileName[1] == L'\0' || (fd.cFileName[1] == L'.' && fd.cFileName[2] == L'\0')))) {
+				continue;
+			}
+			CopyMemory(szPath + cchDir, fd.cFileName, cchName * sizeof(WCHAR));
+			szPath[cchDir + cchName] = L'\\';
+			DirList_PushFindDir(find, szPath, cchDir + cchName + 1);
+		} else if (DirList_MatchFilter(&fd, fill->pdlf)) {
+			CopyMemory(szPath + cchDir, fd.cFileName, (cchName + 1) * sizeof(WCHAR));
+			lstrcpy(fd.cFileName, szPath);
+			DirList_AddFillItem(fill, NULL, &fd);
+		}
+	} while (BackgroundWorker_Continue(worker) && FindNextFile(hFind, &fd));
+
+	FindClose(hFind);
+}
+
+static DWORD WINAPI DirList_FindWorker(LPVOID lpParam) {
+	DLFIND *find = (DLFIND *)lpParam;
+	const BackgroundWorker *worker = &find->fill->lpdl->worker;
+
+	while (BackgroundWorker_Continue(worker)) {
+		LPWSTR pszDir = NULL;
+		EnterCriticalSection(&find->lock);
+		if (find->count != 0) {
+			find->count--;
+			pszDir = find->dirs[find->count];
+			find->busy++;
+		}
+		const BOOL bDone = pszDir == NULL && find->busy == 0;
+		LeaveCriticalSection(&find->lock);
+
+		if (pszDir == NULL) {
+			if (bDone) {
+				// wake up next waiting thread
+				SetEvent(find->hEvent);
+				break;
+			}
+			// timeout in case the event is consumed by other thread
+			WaitForSingleObject(find->hEvent, 10);
+			continue;
+		}
+
+		DirList_FindInDirectory(find, pszDir);
+		NP2HeapFree(pszDir);
+
+		EnterCriticalSection(&find->lock);
+		find->busy--;
+		const BOOL bIdle = find->count == 0 && find->busy == 0;
+		LeaveCriticalSection(&find->lock);
+		if (bIdle) {
+			SetEvent(find->hEvent);
+		}
+	}
+	return 0;
+}
+
+static DWORD WINAPI DirList_FindThread(LPVOID lpParam) {
+	DLFIND find;
+	ZeroMemory(&find, sizeof(find));
+	find.fill = (DLFILL *)lpParam;
+	find.bLargeFetch = IsWin7AndAbove();
+	InitializeCriticalSection(&find.lock);
+	find.hEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	lstrcpy(find.szRoot, find.fill->lpdl->szPath);
+	PathAddBackslash(find.szRoot);
+	find.cchRoot = lstrlen(find.szRoot);
+	DirList_PushFindDir(&find, L"", 0);
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const UINT threadCount = (UINT)clamp_i((int)info.dwNumberOfProcessors, 1, DLFIND_MAX_THREADS);
+	HANDLE threads[DLFIND_MAX_THREADS];
+	UINT count = 0;
+	for (UINT i = 1; i < threadCount; i++) {
+		HANDLE hThread = CreateThread(NULL, 0, DirList_FindWorker, &find, 0, NULL);
+		if (hThread != NULL) {
+			threads[count++] = hThread;
+		}
+	}
+
+	DirList_FindWorker(&find);
+	if (count != 0) {
+		WaitForMultipleObjects(count, threads, TRUE, INFINITE);
+		for (UINT i = 0; i < count; i++) {
+			CloseHandle(threads[i]);
+		}
+	}
+
+	// directories left by cancellation
+	for (UINT i = 0; i < find.count; i++) {
+		NP2HeapFree(find.dirs[i]);
+	}
+	if (find.dirs) {
+		NP2HeapFree(find.dirs);
+	}
+	CloseHandle(find.hEvent);
+	DeleteCriticalSection(&find.lock);
+	return 0;
+}
+
+// append pending items to the entries, returns number of appended items.
+static UINT DirList_TakeFillItems(HWND hwnd, DLFILL *fill) {
+	EnterCriticalSection(&fill->lock);
+	DLENTRY *items = fill->items;
+	const UINT count = fill->count;
+	fill->items = NULL;
+	fill->count = 0;
+	fill->capacity = 0;
+	LeaveCriticalSection(&fill->lock);
+
+	if (items == NULL) {
+		return 0;
+	}
+
+	LPDLDATA lpdl = fill->lpdl;
+	if (lpdl->entries == NULL) {
+		lpdl->entries = items;
+		lpdl->count = count;
+		lpdl->capacity = count;
+	} else {
+		DirList_GrowEntries(lpdl, lpdl->count + count);
+		CopyMemory(lpdl->entries + lpdl->count, items, count * sizeof(DLENTRY));
+		lpdl->count += count;
+		NP2HeapFree(items);
+	}
+
+	ListView_SetItemCountEx(hwnd, lpdl->count, LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+	return count;
+}
+
 //=============================================================================
 //
 //  DirList_Fill()
 //
-//  Snapshots a directory and displays the items in the listview control
+//  Snapshots a directory and displays the items in the listview control.
+//  Items are enumerated on a worker thread, when it takes longer than
+//  DLFILL_BATCH_INTERVAL, found items are displayed in batches while the
+//  remaining are enumerated, pressing Esc stops the enumeration.
 //
 int DirList_Fill(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpec, BOOL bExcludeFilter, BOOL bNoFadeHidden, int iSortFlags, BOOL fSortRev) {
 	LPDLDATA lpdl = (LPDLDATA)GetProp(hwnd, pDirListProp);
@@ -154,24 +756,21 @@ int DirList_Fill(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpe
 		return -1;
 	}
 
+	// Keep listing of previous directory
+	if (!StrCaseEqual(lpdl->szPath, lpszDir)) {
+		DirList_CacheListing(lpdl);
+	}
+	DirList_StopWatch(lpdl);
+
 	lstrcpy(lpdl->szPath, lpszDir);
 
 	// Init ListView
 	SendMessage(hwnd, WM_SETREDRAW, 0, 0);
 	ListView_DeleteAllItems(hwnd);
+	DirList_FreeEntries(lpdl);
 
 	// Init Filter
-	DL_FILTER dlf;
-	DirList_CreateFilter(&dlf, lpszFileSpec, bExcludeFilter);
-
-	// Init lvi
-	LV_ITEM lvi;
-	lvi.mask = LVIF_TEXT | LVIF_IMAGE | LVIF_PARAM;
-	lvi.iItem = 0;
-	lvi.iSubItem = 0;
-	lvi.pszText = LPSTR_TEXTCALLBACK;
-	lvi.cchTextMax = MAX_PATH;
-	lvi.iImage = I_IMAGECALLBACK;
+	DirList_CreateFilter(&lpdl->dlf, lpszFileSpec, bExcludeFilter);
 
 	WCHAR wszDir[MAX_PATH];
 	lstrcpy(wszDir, lpszDir);
@@ -187,80 +786,14 @@ int DirList_Fill(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpe
 #if defined(__cplusplus)
 		if (S_OK == lpsfDesktop->ParseDisplayName(hwnd, NULL, wszDir, &chParsed, &pidl, &dwAttributes)) {
 			// Bind pidl to IShellFolder
-			if (S_OK == lpsfDesktop->BindToObject(pidl, NULL, IID_IShellFolder, (void **)(&lpsf))) {
-				// Create an Enumeration object for lpsf
-				LPENUMIDLIST lpe = NULL;
-				if (S_OK == lpsf->EnumObjects(hwnd, grfFlags, &lpe)) {
-					// Enumerate the contents of lpsf
-					LPITEMIDLIST pidlEntry = NULL;
-					while (S_OK == lpe->Next(1, &pidlEntry, NULL)) {
-						// Add found item to the List
-						// Check if it's part of the Filesystem
-						dwAttributes = SFGAO_FILESYSTEM | SFGAO_FOLDER;
-						lpsf->GetAttributesOf(1, (LPCITEMIDLIST *)(&pidlEntry), &dwAttributes);
-
-						if (dwAttributes & SFGAO_FILESYSTEM) {
-							// Check if item matches specified filter
-							if (DirList_MatchFilter(lpsf, pidlEntry, &dlf)) {
-								LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)CoTaskMemAlloc(sizeof(LV_ITEMDATA));
-								lplvid->pidl = pidlEntry;
-								lplvid->lpsf = lpsf;
-								lpsf->AddRef();
-								lvi.lParam = (LPARAM)lplvid;
-								// Setup default Icon - Folder or File
-								lvi.iImage = (dwAttributes & SFGAO_FOLDER) ? lpdl->iDefIconFolder : lpdl->iDefIconFile;
-								ListView_InsertItem(hwnd, &lvi);
-								lvi.iItem++;
-							}
-						}
-					} // IEnumIDList::Next()
-
-					lpe->Release();
-
-				} // IShellFolder::EnumObjects()
-
-			} // IShellFolder::BindToObject()
-
+			lpsfDesktop->BindToObject(pidl, NULL, IID_IShellFolder, (void **)(&lpsf));
 		} // IShellFolder::ParseDisplayName()
 
 		lpsfDesktop->Release();
 #else
 		if (S_OK == lpsfDesktop->lpVtbl->ParseDisplayName(lpsfDesktop, hwnd, NULL, wszDir, &chParsed, &pidl, &dwAttributes)) {
 			// Bind pidl to IShellFolder
-			if (S_OK == lpsfDesktop->lpVtbl->BindToObject(lpsfDesktop, pidl, NULL, &IID_IShellFolder, (void **)(&lpsf))) {
-				// Create an Enumeration object for lpsf
-				LPENUMIDLIST lpe = NULL;
-				if (S_OK == lpsf->lpVtbl->EnumObjects(lpsf, hwnd, grfFlags, &lpe)) {
-					// Enumerate the contents of lpsf
-					LPITEMIDLIST pidlEntry = NULL;
-					while (S_OK == lpe->lpVtbl->Next(lpe, 1, &pidlEntry, NULL)) {
-						// Add found item to the List
-						// Check if it's part of the Filesystem
-						dwAttributes = SFGAO_FILESYSTEM | SFGAO_FOLDER;
-						lpsf->lpVtbl->GetAttributesOf(lpsf, 1, (LPCITEMIDLIST *)(&pidlEntry), &dwAttributes);
-
-						if (dwAttributes & SFGAO_FILESYSTEM) {
-							// Check if item matches specified filter
-							if (DirList_MatchFilter(lpsf, pidlEntry, &dlf)) {
-								LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)CoTaskMemAlloc(sizeof(LV_ITEMDATA));
-								lplvid->pidl = pidlEntry;
-								lplvid->lpsf = lpsf;
-								lpsf->lpVtbl->AddRef(lpsf);
-								lvi.lParam = (LPARAM)lplvid;
-								// Setup default Icon - Folder or File
-								lvi.iImage = (dwAttributes & SFGAO_FOLDER) ? lpdl->iDefIconFolder : lpdl->iDefIconFile;
-								ListView_InsertItem(hwnd, &lvi);
-								lvi.iItem++;
-							}
-						}
-					} // IEnumIDList::Next()
-
-					lpe->lpVtbl->Release(lpe);
-
-				} // IShellFolder::EnumObjects()
-
-			} // IShellFolder::BindToObject()
-
+			lpsfDesktop->lpVtbl->BindToObject(lpsfDesktop, pidl, NULL, &IID_IShellFolder, (void **)(&lpsf));
 		} // IShellFolder::ParseDisplayName()
 
 		lpsfDesktop->lpVtbl->Release(lpsfDesktop);
@@ -284,6 +817,73 @@ int DirList_Fill(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpe
 	lpdl->pidl = pidl;
 	lpdl->lpsf = lpsf;
 	lpdl->bNoFadeHidden = bNoFadeHidden;
+	lpdl->grfFlags = grfFlags;
+	lpdl->bComplete = TRUE;
+
+	if (lpsf) {
+		DLFILL fill;
+		ZeroMemory(&fill, sizeof(fill));
+		fill.lpdl = lpdl;
+		fill.grfFlags = grfFlags;
+		fill.pdlf = &lpdl->dlf;
+		InitializeCriticalSection(&fill.lock);
+
+		BackgroundWorker *worker = &lpdl->worker;
+		LPTHREAD_START_ROUTINE fillThread = (grfFlags & DL_RECURSIVE) ? DirList_FindThread : DirList_FillThread;
+		HANDLE workerThread = CreateThread(NULL, 0, fillThread, &fill, 0, NULL);
+		if (workerThread == NULL) {
+			fillThread(&fill);
+		} else {
+			worker->workerThread = workerThread;
+			BOOL bRedraw = FALSE;
+			DWORD dwLastUpdate = GetTickCount();
+			// only paint messages are dispatched, keyboard and mouse input is discarded to prevent reentrance.
+			DWORD dwWait;
+			while ((dwWait = MsgWaitForMultipleObjects(1, &workerThread, FALSE, DLFILL_BATCH_INTERVAL, QS_INPUT | QS_PAINT | QS_SENDMESSAGE)) != WAIT_OBJECT_0) {
+				if (dwWait == WAIT_OBJECT_0 + 1) {
+					MSG msg;
+					while (PeekMessage(&msg, NULL, WM_KEYFIRST, WM_KEYLAST, PM_REMOVE)) {
+						if (msg.message == WM_KEYDOWN && msg.wParam == VK_ESCAPE) {
+							SetEvent(worker->eventCancel);
+							lpdl->bComplete = FALSE;
+						}
+					}
+					while (PeekMessage(&msg, NULL, WM_MOUSEFIRST, WM_MOUSELAST, PM_REMOVE)) {}
+					while (PeekMessage(&msg, NULL, WM_NCMOUSEMOVE, WM_NCXBUTTONDBLCLK, PM_REMOVE)) {}
+					while (PeekMessage(&msg, NULL, WM_PAINT, WM_PAINT, PM_REMOVE)) {
+						DispatchMessage(&msg);
+					}
+				} else if (dwWait == WAIT_FAILED) {
+					lpdl->bComplete = FALSE;
+					break;
+				}
+
+				const DWORD dwTick = GetTickCount();
+				if (dwTick - dwLastUpdate >= DLFILL_BATCH_INTERVAL) {
+					dwLastUpdate = dwTick;
+					if (bRedraw) {
+						SendMessage(hwnd, WM_SETREDRAW, 0, 0);
+					}
+					DirList_TakeFillItems(hwnd, &fill);
+					if (!bRedraw) {
+						bRedraw = TRUE;
+						ListView_SetColumnWidth(hwnd, 0, LVSCW_AUTOSIZE_USEHEADER);
+					}
+					SendMessage(hwnd, WM_SETREDRAW, 1, 0);
+					UpdateWindow(hwnd);
+				}
+			}
+			// close thread handle and reset cancel event
+			BackgroundWorker_Cancel(worker);
+			if (bRedraw) {
+				SendMessage(hwnd, WM_SETREDRAW, 0, 0);
+			}
+		}
+
+		DirList_TakeFillItems(hwnd, &fill);
+		lpdl->names = fill.names;
+		DeleteCriticalSection(&fill.lock);
+	}
 
 	// Set column width to fit window
 	ListView_SetColumnWidth(hwnd, 0, LVSCW_AUTOSIZE_USEHEADER);
@@ -300,105 +900,302 @@ int DirList_Fill(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpe
 
 //=============================================================================
 //
-//  DirList_IconThread()
+//  DirList_FillFromCache()
 //
-//  Thread to extract file icons in the background
+//  Displays listing of a recently visited directory when the directory
+//  is not changed since it was left, returns -1 when DirList_Fill() is
+//  required.
 //
-DWORD WINAPI DirList_IconThread(LPVOID lpParam) {
-	LPDLDATA lpdl = (LPDLDATA)lpParam;
-	BackgroundWorker *worker = &lpdl->worker;
+int DirList_FillFromCache(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpec, BOOL bExcludeFilter, BOOL bNoFadeHidden, int iSortFlags, BOOL fSortRev) {
+	LPDLDATA lpdl = (LPDLDATA)GetProp(hwnd, pDirListProp);
+	if (StrIsEmpty(lpszDir)) {
+		return -1;
+	}
 
-	// Exit immediately if DirList_Fill() hasn't been called
-	if (!lpdl->lpsf) {
-		return 0;
+	DL_FILTER dlf;
+	DirList_CreateFilter(&dlf, lpszFileSpec, bExcludeFilter);
+
+	DLCACHE *slot = NULL;
+	for (UINT i = 0; i < DLCACHE_SIZE; i++) {
+		DLCACHE *item = &lpdl->cache[i];
+		if (item->hChange && StrCaseEqual(item->szPath, lpszDir)) {
+			if (item->grfFlags == grfFlags && item->bNoFadeHidden == bNoFadeHidden
+				&& item->dlf.nCount == dlf.nCount && item->dlf.bExcludeFilter == dlf.bExcludeFilter
+				&& memcmp(item->dlf.tFilterBuf, dlf.tFilterBuf, sizeof(dlf.tFilterBuf)) == 0) {
+				slot = item;
+			}
+			break;
+		}
+	}
+	if (slot == NULL) {
+		return -1;
+	}
+	// directory is changed after the listing is cached
+	if (WaitForSingleObject(slot->hChange, 0) != WAIT_TIMEOUT) {
+		DirList_FreeCacheSlot(slot);
+		return -1;
 	}
 
-	HWND hwnd = worker->hwnd;
-	const int iMaxItem = ListView_GetItemCount(hwnd);
+	// take the listing out before current listing is cached
+	DLCACHE cached;
+	CopyMemory(&cached, slot, sizeof(DLCACHE));
+	ZeroMemory(slot, sizeof(DLCACHE));
+	FindCloseChangeNotification(cached.hChange);
 
-	// Get IShellIcon
-	IShellIcon *lpshi;
+	BackgroundWorker_Cancel(&lpdl->worker);
+	DirList_CacheListing(lpdl);
+	DirList_StopWatch(lpdl);
+
+	SendMessage(hwnd, WM_SETREDRAW, 0, 0);
+	ListView_DeleteAllItems(hwnd);
+	DirList_FreeEntries(lpdl);
+
+	if (lpdl->pidl) {
+		CoTaskMemFree((LPVOID)(lpdl->pidl));
+	}
+
+	if (lpdl->lpsf) {
 #if defined(__cplusplus)
-	lpdl->lpsf->QueryInterface(IID_IShellIcon, (void **)(&lpshi));
+		lpdl->lpsf->Release();
 #else
-	lpdl->lpsf->lpVtbl->QueryInterface(lpdl->lpsf, &IID_IShellIcon, (void **)(&lpshi));
+		lpdl->lpsf->lpVtbl->Release(lpdl->lpsf);
 #endif
+	}
 
-	int iItem = 0;
-	while (iItem < iMaxItem && BackgroundWorker_Continue(worker)) {
-		LV_ITEM lvi;
-		lvi.iItem = iItem;
-		lvi.mask = LVIF_PARAM;
-		if (ListView_GetItem(hwnd, &lvi)) {
-			LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
-			lvi.mask = LVIF_IMAGE;
+	// Set lpdl
+	lstrcpy(lpdl->szPath, cached.szPath);
+	lpdl->cbidl = cached.cbidl;
+	lpdl->pidl = cached.pidl;
+	lpdl->lpsf = cached.lpsf;
+	lpdl->bNoFadeHidden = bNoFadeHidden;
+	lpdl->grfFlags = grfFlags;
+	lpdl->bComplete = TRUE;
+	DirList_CreateFilter(&lpdl->dlf, lpszFileSpec, bExcludeFilter);
+	lpdl->entries = cached.entries;
+	lpdl->count = cached.count;
+	lpdl->capacity = cached.capacity;
+	lpdl->names = cached.names;
+
+	ListView_SetItemCountEx(hwnd, lpdl->count, 0);
+	ListView_SetColumnWidth(hwnd, 0, LVSCW_AUTOSIZE_USEHEADER);
+	DirList_Sort(hwnd, iSortFlags, fSortRev);
+	SendMessage(hwnd, WM_SETREDRAW, 1, 0);
 
+	return (int)lpdl->count;
+}
+
+//=============================================================================
+//
+//  DirList_IconThread()
+//
+//  Thread to extract file icons in the background, rows in view are resolved
+//  first, files sharing an extension are looked up only once.
+//
+#define DLICON_CACHE_SIZE	256		// power of two, half is used at most
+#define DLICON_EXT_SIZE		16
+
+typedef struct DLICON_NODE {
+	UINT hash;
+	int iImage;
+	WCHAR szExt[DLICON_EXT_SIZE];	// empty for files without extension
+} DLICON_NODE;
+
+typedef struct DLICON_CACHE {
+	UINT count;
+	DLICON_NODE nodes[DLICON_CACHE_SIZE];
+} DLICON_CACHE;
+
+typedef struct DLICON_RESOLVER {
+	LPDLDATA lpdl;
+	IShellIcon *lpshi;
+	DLICON_CACHE *cache;
+} DLICON_RESOLVER;
+
+// files with these extensions have individual icons
+static BOOL DirList_HasFileIcon(LPCWSTR lpszExt) {
+	static const LPCWSTR fileIconExt[] = {
+		L".exe", L".lnk", L".ico", L".cur", L".ani", L".url", L".scr", L".msc",
+	};
+	for (UINT i = 0; i < COUNTOF(fileIconExt); i++) {
+		if (StrCaseEqual(lpszExt, fileIconExt[i])) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// case insensitive, non-ASCII characters are compared by caller, zero hash marks empty node.
+static UINT DirList_ExtensionHash(LPCWSTR lpszExt, UINT length) {
+	UINT hash = 2166136261U ^ length;
+	for (UINT i = 0; i < length; i++) {
+		UINT ch = lpszExt[i];
+		ch = (ch >= L'A' && ch <= L'Z') ? (ch | 0x20) : ch;
+		hash = (hash ^ ch) * 16777619U;
+	}
+	return hash | 1;
+}
+
+// returns cache node for the extension, or NULL if it can't be cached.
+static DLICON_NODE *DirList_FindIconNode(DLICON_CACHE *cache, LPCWSTR lpszExt) {
+	const UINT length = lstrlen(lpszExt);
+	if (length >= DLICON_EXT_SIZE || DirList_HasFileIcon(lpszExt)) {
+		return NULL;
+	}
+
+	const UINT hash = DirList_ExtensionHash(lpszExt, length);
+
+	UINT index = hash & (DLICON_CACHE_SIZE - 1);
+	DLICON_NODE *node;
+	while ((node = &cache->nodes[index])->hash != 0) {
+		if (node->hash == hash && StrCaseEqual(node->szExt, lpszExt)) {
+			return node;
+		}
+		index = (index + 1) & (DLICON_CACHE_SIZE - 1);
+	}
+	if (cache->count >= DLICON_CACHE_SIZE/2) {
+		return NULL;
+	}
+	// new node, iImage is set by caller
+	cache->count++;
+	node->hash = hash;
+	node->iImage = -1;
+	lstrcpy(node->szExt, lpszExt);
+	return node;
+}
+
+static void DirList_ResolveIcon(const DLICON_RESOLVER *resolver, DLENTRY *dle) {
+	LPCDLDATA lpdl = resolver->lpdl;
+	LPSHELLFOLDER lpsf = lpdl->lpsf;
+	IShellIcon *lpshi = resolver->lpshi;
+
+	DLICON_NODE *node = NULL;
+	if (!(dle->dwAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		node = DirList_FindIconNode(resolver->cache, PathFindExtension(dle->pszName));
+	}
+
+	int iImage;
+	if (node != NULL && node->iImage >= 0) {
+		iImage = node->iImage;
+	} else if (dle->pidl == NULL) {
+		SHFILEINFO shfi;
+		WCHAR szPath[MAX_PATH];
+		DirList_GetEntryPath(lpdl, dle, szPath);
+		SHGetFileInfo(szPath, 0, &shfi, sizeof(SHFILEINFO), SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
+		iImage = shfi.iIcon;
+		if (node != NULL) {
+			node->iImage = iImage;
+		}
+	} else {
 #if defined(__cplusplus)
-			if (!lpshi || S_OK != lpshi->GetIconOf(lplvid->pidl, GIL_FORSHELL, &lvi.iImage)) {
-				SHFILEINFO shfi;
-				LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, lplvid->pidl, 0);
-				SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
-				CoTaskMemFree(pidl);
-				lvi.iImage = shfi.iIcon;
-			}
+		if (!lpshi || S_OK != lpshi->GetIconOf(dle->pidl, GIL_FORSHELL, &iImage)) {
+			SHFILEINFO shfi;
+			LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, dle->pidl, 0);
+			SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
+			CoTaskMemFree(pidl);
+			iImage = shfi.iIcon;
+		}
 #else
-			if (!lpshi || S_OK != lpshi->lpVtbl->GetIconOf(lpshi, lplvid->pidl, GIL_FORSHELL, &lvi.iImage)) {
-				SHFILEINFO shfi;
-				LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, lplvid->pidl, 0);
-				SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
-				CoTaskMemFree((LPVOID)pidl);
-				lvi.iImage = shfi.iIcon;
-			}
+		if (!lpshi || S_OK != lpshi->lpVtbl->GetIconOf(lpshi, dle->pidl, GIL_FORSHELL, &iImage)) {
+			SHFILEINFO shfi;
+			LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, dle->pidl, 0);
+			SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
+			CoTaskMemFree((LPVOID)pidl);
+			iImage = shfi.iIcon;
+		}
 #endif
+		if (node != NULL) {
+			node->iImage = iImage;
+		}
+	}
 
-			// It proved necessary to reset the state bits...
-			lvi.stateMask = 0;
-			lvi.state = 0;
-
-			DWORD dwAttributes = SFGAO_LINK | SFGAO_SHARE;
-			// Link and Share Overlay
+	DWORD dwAttributes = SFGAO_LINK | SFGAO_SHARE;
+	// Link and Share Overlay
+	if (dle->pidl == NULL) {
+		dwAttributes = 0;
+	} else {
 #if defined(__cplusplus)
-			lplvid->lpsf->GetAttributesOf(1, (LPCITEMIDLIST *)(&lplvid->pidl), &dwAttributes);
+		lpsf->GetAttributesOf(1, (LPCITEMIDLIST *)(&dle->pidl), &dwAttributes);
 #else
-			lplvid->lpsf->lpVtbl->GetAttributesOf(lplvid->lpsf, 1, (LPCITEMIDLIST *)(&lplvid->pidl), &dwAttributes);
+		lpsf->lpVtbl->GetAttributesOf(lpsf, 1, (LPCITEMIDLIST *)(&dle->pidl), &dwAttributes);
 #endif
+	}
 
-			if (dwAttributes & SFGAO_LINK) {
-				lvi.mask |= LVIF_STATE;
-				lvi.stateMask |= LVIS_OVERLAYMASK;
-				lvi.state |= INDEXTOOVERLAYMASK(2);
-			}
+	UINT state = dle->state & ~LVIS_OVERLAYMASK;
+	if (dwAttributes & SFGAO_LINK) {
+		state |= INDEXTOOVERLAYMASK(2);
+	}
+	if (dwAttributes & SFGAO_SHARE) {
+		state |= INDEXTOOVERLAYMASK(1);
+	}
 
-			if (dwAttributes & SFGAO_SHARE) {
-				lvi.mask |= LVIF_STATE;
-				lvi.stateMask |= LVIS_OVERLAYMASK;
-				lvi.state |= INDEXTOOVERLAYMASK(1);
-			}
+	dle->iImage = iImage;
+	dle->state = state;
+	dle->bIconResolved = TRUE;
+}
 
-			// Fade hidden/system files
-			if (!lpdl->bNoFadeHidden) {
-				WIN32_FIND_DATA fd;
-				if (S_OK == SHGetDataFromIDList(lplvid->lpsf, lplvid->pidl, SHGDFIL_FINDDATA, &fd, sizeof(WIN32_FIND_DATA))) {
-					if ((fd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) || (fd.dwFileAttributes & FILE_ATTRIBUTE_SYSTEM)) {
-						lvi.mask |= LVIF_STATE;
-						lvi.stateMask |= LVIS_CUT;
-						lvi.state |= LVIS_CUT;
-					}
+#define DLICON_BATCH_SIZE	32	// rows resolved in order before checking rows in view again
+
+DWORD WINAPI DirList_IconThread(LPVOID lpParam) {
+	LPDLDATA lpdl = (LPDLDATA)lpParam;
+	BackgroundWorker *worker = &lpdl->worker;
+
+	// Exit immediately if DirList_Fill() hasn't been called
+	if (!lpdl->lpsf) {
+		return 0;
+	}
+
+	HWND hwnd = worker->hwnd;
+	// entries are not changed until the thread is stopped
+	DLENTRY * const entries = lpdl->entries;
+	const UINT count = lpdl->count;
+
+	DLICON_RESOLVER resolver;
+	resolver.lpdl = lpdl;
+	resolver.cache = (DLICON_CACHE *)NP2HeapAlloc(sizeof(DLICON_CACHE));
+
+	// Get IShellIcon
+	resolver.lpshi = NULL;
+#if defined(__cplusplus)
+	lpdl->lpsf->QueryInterface(IID_IShellIcon, (void **)(&resolver.lpshi));
+#else
+	lpdl->lpsf->lpVtbl->QueryInterface(lpdl->lpsf, &IID_IShellIcon, (void **)(&resolver.lpshi));
+#endif
+
+	UINT iNext = 0;
+	int iLastTop = -1;
+	while (iNext < count && BackgroundWorker_Continue(worker)) {
+		// rows in view, checked again after scrolling
+		const int iTop = ListView_GetTopIndex(hwnd);
+		if (iTop != iLastTop) {
+			iLastTop = iTop;
+			const UINT iFirst = (UINT)max_i(iTop, 0);
+			const UINT iLast = (UINT)min_i((int)iFirst + ListView_GetCountPerPage(hwnd) + 1, (int)count);
+			for (UINT iItem = iFirst; iItem < iLast && BackgroundWorker_Continue(worker); iItem++) {
+				if (!entries[iItem].bIconResolved) {
+					DirList_ResolveIcon(&resolver, &entries[iItem]);
+					ListView_RedrawItems(hwnd, iItem, iItem);
 				}
 			}
-			lvi.iSubItem = 0;
-			ListView_SetItem(hwnd, &lvi);
 		}
-		iItem++;
+
+		// remaining rows in order
+		const UINT iBatchEnd = (UINT)min_i((int)iNext + DLICON_BATCH_SIZE, (int)count);
+		for (; iNext < iBatchEnd && BackgroundWorker_Continue(worker); iNext++) {
+			if (!entries[iNext].bIconResolved) {
+				DirList_ResolveIcon(&resolver, &entries[iNext]);
+				ListView_RedrawItems(hwnd, iNext, iNext);
+			}
+		}
 	}
 
-	if (lpshi) {
+	if (resolver.lpshi) {
 #if defined(__cplusplus)
-		lpshi->Release();
+		resolver.lpshi->Release();
 #else
-		lpshi->lpVtbl->Release(lpshi);
+		resolver.lpshi->lpVtbl->Release(resolver.lpshi);
 #endif
 	}
+	NP2HeapFree(resolver.cache);
 
 	return 0;
 }
@@ -411,124 +1208,384 @@ DWORD WINAPI DirList_IconThread(LPVOID lpParam) {
 //  the listview control
 //
 BOOL DirList_GetDispInfo(HWND hwnd, LPARAM lParam, BOOL bNoFadeHidden) {
-	UNREFERENCED_PARAMETER(hwnd);
 	UNREFERENCED_PARAMETER(bNoFadeHidden);
 
 	LV_DISPINFO *lpdi = (LV_DISPINFO *)lParam;
-
-	LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lpdi->item.lParam;
+	const LPCDLDATA lpdl = (LPCDLDATA)GetProp(hwnd, pDirListProp);
+	const DLENTRY *dle = DirList_GetEntry(lpdl, lpdi->item.iItem);
 
 	// SubItem 0 is handled only
-	if (lpdi->item.iSubItem != 0) {
+	if (dle == NULL || lpdi->item.iSubItem != 0) {
 		return FALSE;
 	}
 
 	// Text
 	if (lpdi->item.mask & LVIF_TEXT) {
-		IL_GetDisplayName(lplvid->lpsf, lplvid->pidl, SHGDN_INFOLDER, lpdi->item.pszText, lpdi->item.cchTextMax);
+		if (dle->pidl) {
+			IL_GetDisplayName(lpdl->lpsf, dle->pidl, SHGDN_INFOLDER, lpdi->item.pszText, lpdi->item.cchTextMax);
+		} else {
+			lstrcpyn(lpdi->item.pszText, dle->pszName, lpdi->item.cchTextMax);
+		}
 	}
 
-	// Set values
-	lpdi->item.mask |= LVIF_DI_SETITEM;
+	// Icon
+	if (lpdi->item.mask & LVIF_IMAGE) {
+		lpdi->item.iImage = dle->iImage;
+	}
+
+	// Overlay and fading, see DirList_Init()
+	if (lpdi->item.mask & LVIF_STATE) {
+		lpdi->item.state = (lpdi->item.state & ~lpdi->item.stateMask) | (dle->state & lpdi->item.stateMask);
+	}
 
 	return TRUE;
 }
 
 //=============================================================================
 //
-//  DirList_DeleteItem()
+//  DirList_FindItem()
+//
+//  Must be called in response to a WM_NOTIFY/LVN_ODFINDITEM message from
+//  the listview control, returns index of the found item or -1
+//
+int DirList_FindItem(HWND hwnd, LPARAM lParam) {
+	const NMLVFINDITEM *lpfi = (NMLVFINDITEM *)lParam;
+	const LPCDLDATA lpdl = (LPCDLDATA)GetProp(hwnd, pDirListProp);
+	const UINT flags = lpfi->lvfi.flags;
+
+	if (!(flags & (LVFI_STRING | LVFI_PARTIAL)) || lpfi->lvfi.psz == NULL || lpdl->count == 0) {
+		return -1;
+	}
+
+	const int cchFind = lstrlen(lpfi->lvfi.psz);
+	UINT iItem = (lpfi->iStart < 0) ? 0 : (UINT)(lpfi->iStart);
+	for (UINT i = 0; i < lpdl->count; i++, iItem++) {
+		if (iItem >= lpdl->count) {
+			if (!(flags & LVFI_WRAP)) {
+				break;
+			}
+			iItem = 0;
+		}
+
+		WCHAR szDisplayName[MAX_PATH];
+		const DLENTRY *dle = &lpdl->entries[iItem];
+		if (dle->pidl) {
+			IL_GetDisplayName(lpdl->lpsf, dle->pidl, SHGDN_INFOLDER, szDisplayName, MAX_PATH);
+		} else {
+			lstrcpyn(szDisplayName, dle->pszName, MAX_PATH);
+		}
+		if ((flags & LVFI_PARTIAL) ? (StrCmpNI(szDisplayName, lpfi->lvfi.psz, cchFind) == 0) : StrCaseEqual(szDisplayName, lpfi->lvfi.psz)) {
+			return (int)iItem;
+		}
+	}
+
+	return -1;
+}
+
+//=============================================================================
+//
+//  DirList_CompareProc()
+//
+//  Compares two list items, folders are sorted before files
+//
+static inline int DirList_CompareFolder(const DLENTRY *dle1, const DLENTRY *dle2) {
+	return (int)(dle2->dwAttributes & FILE_ATTRIBUTE_DIRECTORY) - (int)(dle1->dwAttributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+static int __cdecl DirList_CompareName(const void *p1, const void *p2) {
+	const DLENTRY *dle1 = (const DLENTRY *)p1;
+	const DLENTRY *dle2 = (const DLENTRY *)p2;
+	int result = DirList_CompareFolder(dle1, dle2);
+	result = result ? result : StrCmpLogicalW(dle1->pszName, dle2->pszName);
+	return result;
+}
+
+static int __cdecl DirList_CompareSize(const void *p1, const void *p2) {
+	const DLENTRY *dle1 = (const DLENTRY *)p1;
+	const DLENTRY *dle2 = (const DLENTRY *)p2;
+	int result = DirList_CompareFolder(dle1, dle2);
+	if (result == 0 && dle1->size != dle2->size) {
+		result = (dle1->size < dle2->size) ? -1 : 1;
+	}
+	result = result ? result : StrCmpLogicalW(dle1->pszName, dle2->pszName);
+	return result;
+}
+
+static int __cdecl DirList_CompareType(const void *p1, const void *p2) {
+	const DLENTRY *dle1 = (const DLENTRY *)p1;
+	const DLENTRY *dle2 = (const DLENTRY *)p2;
+	int result = DirList_CompareFolder(dle1, dle2);
+	result = result ? result : StrCmpIW(dle1->pszExt, dle2->pszExt);
+	result = result ? result : StrCmpLogicalW(dle1->pszName, dle2->pszName);
+	return result;
+}
+
+static int __cdecl DirList_CompareLastMod(const void *p1, const void *p2) {
+	const DLENTRY *dle1 = (const DLENTRY *)p1;
+	const DLENTRY *dle2 = (const DLENTRY *)p2;
+	int result = DirList_CompareFolder(dle1, dle2);
+	if (result == 0) {
+		const ULONGLONG t1 = ((ULONGLONG)dle1->ftLastWriteTime.dwHighDateTime << 32) | dle1->ftLastWriteTime.dwLowDateTime;
+		const ULONGLONG t2 = ((ULONGLONG)dle2->ftLastWriteTime.dwHighDateTime << 32) | dle2->ftLastWriteTime.dwLowDateTime;
+		if (t1 != t2) {
+			result = (t1 < t2) ? -1 : 1;
+		}
+	}
+	result = result ? result : StrCmpLogicalW(dle1->pszName, dle2->pszName);
+	return result;
+}
+
+//=============================================================================
+//
+//  DirList_Sort()
+//
+//  Sorts the listview control by the specified order
+//
+typedef int (__cdecl *DirList_CompareFunc)(const void *, const void *);
+
+static DirList_CompareFunc DirList_GetCompareFunc(int lFlags) {
+	switch (lFlags) {
+	case DS_SIZE:
+		return DirList_CompareSize;
+	case DS_TYPE:
+		return DirList_CompareType;
+	case DS_LASTMOD:
+		return DirList_CompareLastMod;
+	default:
+		return DirList_CompareName;
+	}
+}
+
+BOOL DirList_Sort(HWND hwnd, int lFlags, BOOL fRev) {
+	LPDLDATA lpdl = (LPDLDATA)GetProp(hwnd, pDirListProp);
+	lpdl->iSortFlags = lFlags;
+	lpdl->fSortRev = fRev;
+	if (lpdl->count < 2) {
+		return TRUE;
+	}
+
+	// Icon Thread accesses entries by index, restart it after sorting
+	const BOOL bIconThread = lpdl->worker.workerThread != NULL;
+	BackgroundWorker_Cancel(&lpdl->worker);
+
+	BOOL bSelected;
+	LPCWSTR pszFocus = DirList_GetFocusedEntry(hwnd, lpdl, &bSelected);
+
+	DLENTRY * const entries = lpdl->entries;
+	const UINT count = lpdl->count;
+	qsort(entries, count, sizeof(DLENTRY), DirList_GetCompareFunc(lFlags));
+	if (fRev) {
+		for (UINT i = 0, j = count - 1; i < j; i++, j--) {
+			const DLENTRY tmp = entries[i];
+			entries[i] = entries[j];
+			entries[j] = tmp;
+		}
+	}
+
+	if (pszFocus) {
+		DirList_SetFocusedEntry(hwnd, lpdl, pszFocus, bSelected);
+	}
+
+	ListView_RedrawItems(hwnd, 0, count - 1);
+	if (bIconThread) {
+		lpdl->worker.workerThread = CreateThread(NULL, 0, DirList_IconThread, (LPVOID)lpdl, 0, NULL);
+	}
+	return TRUE;
+}
+
+//=============================================================================
+//
+//  DirList_StartWatch()
+//
+//  Watch changes of current directory with ReadDirectoryChangesW()
+//
+static BOOL DirList_ReadChanges(LPDLDATA lpdl) {
+	HANDLE hEvent = lpdl->watchOverlapped.hEvent;
+	ZeroMemory(&lpdl->watchOverlapped, sizeof(OVERLAPPED));
+	lpdl->watchOverlapped.hEvent = hEvent;
+	ResetEvent(hEvent);
+	return ReadDirectoryChangesW(lpdl->hWatchDir, lpdl->watchBuffer, DLWATCH_BUFFER_SIZE, FALSE, DLWATCH_NOTIFY_FILTER, NULL, &lpdl->watchOverlapped, NULL);
+}
+
+BOOL DirList_StartWatch(HWND hwnd) {
+	LPDLDATA lpdl = (LPDLDATA)GetProp(hwnd, pDirListProp);
+	DirList_StopWatch(lpdl);
+
+	// changes in subdirectories are not applied, use IDM_VIEW_UPDATE instead
+	if (lpdl->grfFlags & DL_RECURSIVE) {
+		return FALSE;
+	}
+
+	WCHAR szPath[MAX_PATH];
+	if (lpdl->pidl == NULL || !SHGetPathFromIDList(lpdl->pidl, szPath)) {
+		return FALSE;
+	}
+
+	HANDLE hDir = CreateFile(szPath, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							 NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (hDir == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+
+	if (lpdl->watchBuffer == NULL) {
+		lpdl->watchBuffer = (LPBYTE)NP2HeapAlloc(DLWATCH_BUFFER_SIZE);
+	}
+	lpdl->hWatchDir = hDir;
+	if (!DirList_ReadChanges(lpdl)) {
+		lpdl->hWatchDir = NULL;
+		CloseHandle(hDir);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+//=============================================================================
+//
+//  DirList_HasChanged()
 //
-//  Must be called in response to a WM_NOTIFY/LVN_DELETEITEM message
-//  from the control
+//  Check whether current directory has changes to be applied
 //
-BOOL DirList_DeleteItem(HWND hwnd, LPARAM lParam) {
-	const NM_LISTVIEW *lpnmlv = (NM_LISTVIEW *)lParam;
-
-	LV_ITEM lvi;
-	lvi.iItem = lpnmlv->iItem;
-	lvi.iSubItem = 0;
-	lvi.mask = LVIF_PARAM;
-
-	if (ListView_GetItem(hwnd, &lvi)) {
-		// Free mem
-		LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
-		CoTaskMemFree((LPVOID)(lplvid->pidl));
-#if defined(__cplusplus)
-		lplvid->lpsf->Release();
-#else
-		lplvid->lpsf->lpVtbl->Release(lplvid->lpsf);
-#endif
-
-		CoTaskMemFree(lplvid);
-		return TRUE;
-	}
-	return FALSE;
+BOOL DirList_HasChanged(HWND hwnd) {
+	const LPCDLDATA lpdl = (LPCDLDATA)GetProp(hwnd, pDirListProp);
+	return DirList_HasPendingChanges(lpdl);
 }
 
 //=============================================================================
 //
-//  DirList_CompareProc()
+//  DirList_ApplyChanges()
 //
-//  Compares two list items
+//  Updates the listing with changes reported by ReadDirectoryChangesW(),
+//  returns number of items, or -1 when the directory must be filled again.
 //
-int CALLBACK DirList_CompareProcFw(LPARAM lp1, LPARAM lp2, LPARAM lFlags) {
-	const LPCLV_ITEMDATA lplvid1 = (LPCLV_ITEMDATA)lp1;
-	const LPCLV_ITEMDATA lplvid2 = (LPCLV_ITEMDATA)lp2;
+static void DirList_RemoveEntry(LPDLDATA lpdl, LPCWSTR lpszName, LPCWSTR *ppszFocus) {
+	DLENTRY * const entries = lpdl->entries;
+	for (UINT i = 0; i < lpdl->count; i++) {
+		if (StrCaseEqual(entries[i].pszName, lpszName)) {
+			if (entries[i].pszName == *ppszFocus) {
+				*ppszFocus = NULL;
+			}
+			CoTaskMemFree((LPVOID)(entries[i].pidl));
+			lpdl->count--;
+			MoveMemory(entries + i, entries + i + 1, (lpdl->count - i) * sizeof(DLENTRY));
+			break;
+		}
+	}
+}
+
+static void DirList_InsertEntry(LPDLDATA lpdl, LPCWSTR lpszName) {
+	LPSHELLFOLDER lpsf = lpdl->lpsf;
+	WCHAR wszName[MAX_PATH];
+	lstrcpyn(wszName, lpszName, MAX_PATH);
 
+	LPITEMIDLIST pidl = NULL;
+	ULONG chParsed = 0;
+	ULONG dwAttributes = SFGAO_FILESYSTEM | SFGAO_FOLDER;
 #if defined(__cplusplus)
-	HRESULT hr = lplvid1->lpsf->CompareIDs(lFlags, lplvid1->pidl, lplvid2->pidl);
+	if (S_OK != lpsf->ParseDisplayName(NULL, NULL, wszName, &chParsed, &pidl, &dwAttributes)) {
+		return;
+	}
 #else
-	HRESULT hr = lplvid1->lpsf->lpVtbl->CompareIDs(lplvid1->lpsf, lFlags, lplvid1->pidl, lplvid2->pidl);
+	if (S_OK != lpsf->lpVtbl->ParseDisplayName(lpsf, NULL, NULL, wszName, &chParsed, &pidl, &dwAttributes)) {
+		return;
+	}
 #endif
-	int result = (short)HRESULT_CODE(hr);
 
-	if (result != 0 || lFlags == 0) {
-		return result;
+	// same check as DirList_FillThread() and IShellFolder::EnumObjects()
+	WIN32_FIND_DATA fd;
+	BOOL bMatch = FALSE;
+	if (dwAttributes & SFGAO_FILESYSTEM) {
+		DirList_GetFindData(lpsf, pidl, dwAttributes, &fd);
+		const DWORD grfFlags = lpdl->grfFlags;
+		const BOOL bFolder = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		bMatch = (grfFlags & (bFolder ? DL_FOLDERS : DL_NONFOLDERS))
+			&& ((grfFlags & DL_INCLHIDDEN) || !(fd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN))
+			&& DirList_MatchFilter(&fd, &lpdl->dlf);
+	}
+	if (!bMatch) {
+		CoTaskMemFree((LPVOID)pidl);
+		return;
 	}
 
-#if defined(__cplusplus)
-	hr = lplvid1->lpsf->CompareIDs(0, lplvid1->pidl, lplvid2->pidl);
-#else
-	hr = lplvid1->lpsf->lpVtbl->CompareIDs(lplvid1->lpsf, 0, lplvid1->pidl, lplvid2->pidl);
-#endif
-	result = (short)HRESULT_CODE(hr);
+	DLENTRY dle;
+	DirList_InitEntry(lpdl, &dle, pidl, &fd, &lpdl->names);
+
+	// find insert position in sorted entries
+	const DirList_CompareFunc cmpFunc = DirList_GetCompareFunc(lpdl->iSortFlags);
+	UINT lo = 0;
+	UINT hi = lpdl->count;
+	while (lo < hi) {
+		const UINT mid = (lo + hi) / 2;
+		int cmp = cmpFunc(&dle, &lpdl->entries[mid]);
+		cmp = lpdl->fSortRev ? -cmp : cmp;
+		if (cmp < 0) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
 
-	return result;
+	DirList_GrowEntries(lpdl, lpdl->count + 1);
+	MoveMemory(lpdl->entries + lo + 1, lpdl->entries + lo, (lpdl->count - lo) * sizeof(DLENTRY));
+	lpdl->entries[lo] = dle;
+	lpdl->count++;
 }
 
-int CALLBACK DirList_CompareProcRw(LPARAM lp1, LPARAM lp2, LPARAM lFlags) {
-	const LPCLV_ITEMDATA lplvid1 = (LPCLV_ITEMDATA)lp1;
-	const LPCLV_ITEMDATA lplvid2 = (LPCLV_ITEMDATA)lp2;
+int DirList_ApplyChanges(HWND hwnd) {
+	LPDLDATA lpdl = (LPDLDATA)GetProp(hwnd, pDirListProp);
+	if (!DirList_HasPendingChanges(lpdl) || lpdl->lpsf == NULL) {
+		return (int)lpdl->count;
+	}
+
+	// zero size means too many changes to fit into the buffer
+	DWORD cbTransferred = 0;
+	if (!GetOverlappedResult(lpdl->hWatchDir, &lpdl->watchOverlapped, &cbTransferred, FALSE) || cbTransferred == 0) {
+		DirList_StopWatch(lpdl);
+		return -1;
+	}
 
-#if defined(__cplusplus)
-	HRESULT hr = lplvid1->lpsf->CompareIDs(lFlags, lplvid1->pidl, lplvid2->pidl);
-#else
-	HRESULT hr = lplvid1->lpsf->lpVtbl->CompareIDs(lplvid1->lpsf, lFlags, lplvid1->pidl, lplvid2->pidl);
-#endif
-	int result = -(short)HRESULT_CODE(hr);
+	// Icon Thread accesses entries by index, restart it after changes applied
+	BackgroundWorker_Cancel(&lpdl->worker);
 
-	if (result != 0) {
-		return result;
+	BOOL bSelected;
+	LPCWSTR pszFocus = DirList_GetFocusedEntry(hwnd, lpdl, &bSelected);
+
+	const FILE_NOTIFY_INFORMATION *pfni = (const FILE_NOTIFY_INFORMATION *)lpdl->watchBuffer;
+	while (TRUE) {
+		WCHAR szName[MAX_PATH];
+		const UINT cch = (UINT)min_i((int)(pfni->FileNameLength / sizeof(WCHAR)), MAX_PATH - 1);
+		CopyMemory(szName, pfni->FileName, cch * sizeof(WCHAR));
+		szName[cch] = L'\0';
+
+		switch (pfni->Action) {
+		case FILE_ACTION_ADDED:
+		case FILE_ACTION_MODIFIED:
+		case FILE_ACTION_RENAMED_NEW_NAME:
+			DirList_RemoveEntry(lpdl, szName, &pszFocus);
+			DirList_InsertEntry(lpdl, szName);
+			break;
+
+		case FILE_ACTION_REMOVED:
+		case FILE_ACTION_RENAMED_OLD_NAME:
+			DirList_RemoveEntry(lpdl, szName, &pszFocus);
+			break;
+		}
+
+		if (pfni->NextEntryOffset == 0) {
+			break;
+		}
+		pfni = (const FILE_NOTIFY_INFORMATION *)((const BYTE *)pfni + pfni->NextEntryOffset);
 	}
 
-#if defined(__cplusplus)
-	hr = lplvid1->lpsf->CompareIDs(0, lplvid1->pidl, lplvid2->pidl);
-#else
-	hr = lplvid1->lpsf->lpVtbl->CompareIDs(lplvid1->lpsf, 0, lplvid1->pidl, lplvid2->pidl);
-#endif
-	result = -(short)HRESULT_CODE(hr);
+	// watch next changes
+	if (!DirList_ReadChanges(lpdl)) {
+		DirList_StopWatch(lpdl);
+	}
 
-	return result;
-}
+	ListView_SetItemCountEx(hwnd, lpdl->count, LVSICF_NOSCROLL);
+	DirList_SetFocusedEntry(hwnd, lpdl, pszFocus, bSelected);
+	DirList_StartIconThread(hwnd);
 
-//=============================================================================
-//
-//  DirList_Sort()
-//
-//  Sorts the listview control by the specified order
-//
-BOOL DirList_Sort(HWND hwnd, int lFlags, BOOL fRev) {
-	return ListView_SortItems(hwnd, (fRev? DirList_CompareProcRw : DirList_CompareProcFw), lFlags);
+	return (int)lpdl->count;
 }
 
 //=============================================================================
@@ -546,40 +1603,36 @@ int DirList_GetItem(HWND hwnd, int iItem, LPDLITEM lpdli) {
 		}
 	}
 
-	LV_ITEM lvi;
-	lvi.mask = LVIF_PARAM;
-	lvi.iItem = iItem;
-	lvi.iSubItem = 0;
-
-	if (!ListView_GetItem(hwnd, &lvi)) {
+	const LPCDLDATA lpdl = (LPCDLDATA)GetProp(hwnd, pDirListProp);
+	const DLENTRY *dle = DirList_GetEntry(lpdl, iItem);
+	if (dle == NULL) {
 		if (lpdli->mask & DLI_TYPE) {
 			lpdli->ntype = DLE_NONE;
 		}
 		return -1;
 	}
 
-	LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
-
 	// Filename
 	if (lpdli->mask & DLI_FILENAME) {
-		IL_GetDisplayName(lplvid->lpsf, lplvid->pidl, SHGDN_FORPARSING, lpdli->szFileName, MAX_PATH);
+		if (dle->pidl) {
+			IL_GetDisplayName(lpdl->lpsf, dle->pidl, SHGDN_FORPARSING, lpdli->szFileName, MAX_PATH);
+		} else {
+			DirList_GetEntryPath(lpdl, dle, lpdli->szFileName);
+		}
 	}
 
 	// Displayname
 	if (lpdli->mask & DLI_DISPNAME) {
-		IL_GetDisplayName(lplvid->lpsf, lplvid->pidl, SHGDN_INFOLDER, lpdli->szDisplayName, MAX_PATH);
+		if (dle->pidl) {
+			IL_GetDisplayName(lpdl->lpsf, dle->pidl, SHGDN_INFOLDER, lpdli->szDisplayName, MAX_PATH);
+		} else {
+			lstrcpyn(lpdli->szDisplayName, dle->pszName, MAX_PATH);
+		}
 	}
 
 	// Type (File / Directory)
 	if (lpdli->mask & DLI_TYPE) {
-		WIN32_FIND_DATA fd;
-		//ULONG dwAttributes = SFGAO_FILESYSTEM;
-
-		if (S_OK == SHGetDataFromIDList(lplvid->lpsf, lplvid->pidl, SHGDFIL_FINDDATA, &fd, sizeof(WIN32_FIND_DATA))) {
-			lpdli->ntype = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? DLE_DIR : DLE_FILE;
-		}
-		//lplvid->lpsf->lpVtbl->GetAttributesOf(lplvid->lpsf, 1, &lplvid->pidl, &dwAttributes);
-		//lpdli->ntype = (dwAttributes & SFGAO_FOLDER) ? DLE_DIR : DLE_FILE;
+		lpdli->ntype = (dle->dwAttributes & FILE_ATTRIBUTE_DIRECTORY) ? DLE_DIR : DLE_FILE;
 	}
 
 	return iItem;
@@ -600,22 +1653,68 @@ int DirList_GetItemEx(HWND hwnd, int iItem, LPWIN32_FIND_DATA pfd) {
 		}
 	}
 
-	LV_ITEM lvi;
-	lvi.mask = LVIF_PARAM;
-	lvi.iItem = iItem;
-	lvi.iSubItem = 0;
-
-	if (!ListView_GetItem(hwnd, &lvi)) {
+	const LPCDLDATA lpdl = (LPCDLDATA)GetProp(hwnd, pDirListProp);
+	const DLENTRY *dle = DirList_GetEntry(lpdl, iItem);
+	if (dle == NULL) {
 		return -1;
 	}
 
-	LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
-	if (S_OK == SHGetDataFromIDList(lplvid->lpsf, lplvid->pidl, SHGDFIL_FINDDATA, pfd, sizeof(WIN32_FIND_DATA))) {
+	if (dle->pidl == NULL) {
+		ZeroMemory(pfd, sizeof(WIN32_FIND_DATA));
+		pfd->dwFileAttributes = dle->dwAttributes;
+		pfd->ftLastWriteTime = dle->ftLastWriteTime;
+		pfd->nFileSizeHigh = (DWORD)(dle->size >> 32);
+		pfd->nFileSizeLow = (DWORD)(dle->size);
+		lstrcpyn(pfd->cFileName, PathFindFileName(dle->pszName), MAX_PATH);
+		return iItem;
+	}
+	if (S_OK == SHGetDataFromIDList(lpdl->lpsf, dle->pidl, SHGDFIL_FINDDATA, pfd, sizeof(WIN32_FIND_DATA))) {
 		return iItem;
 	}
 	return -1;
 }
 
+//=============================================================================
+//
+//  DirList_BindEntry()
+//
+//  Retrieves parent folder and relative Item Id of an entry, entries found
+//  in subdirectories are bound to their own parent folder. The returned
+//  folder must be released, and *ppidlFree must be freed.
+//
+static LPSHELLFOLDER DirList_BindEntry(LPCDLDATA lpdl, const DLENTRY *dle, LPCITEMIDLIST *ppidl, LPITEMIDLIST *ppidlFree) {
+	LPSHELLFOLDER lpsf = NULL;
+	*ppidlFree = NULL;
+	if (dle->pidl) {
+		lpsf = lpdl->lpsf;
+		*ppidl = dle->pidl;
+#if defined(__cplusplus)
+		lpsf->AddRef();
+#else
+		lpsf->lpVtbl->AddRef(lpsf);
+#endif
+		return lpsf;
+	}
+
+	WCHAR szPath[MAX_PATH];
+	DirList_GetEntryPath(lpdl, dle, szPath);
+	LPITEMIDLIST pidl;
+	if (SUCCEEDED(SHParseDisplayName(szPath, NULL, &pidl, 0, NULL))) {
+#if defined(__cplusplus)
+		const HRESULT hr = SHBindToParent(pidl, IID_IShellFolder, (void **)(&lpsf), ppidl);
+#else
+		const HRESULT hr = SHBindToParent(pidl, &IID_IShellFolder, (void **)(&lpsf), ppidl);
+#endif
+		if (SUCCEEDED(hr)) {
+			*ppidlFree = pidl;
+		} else {
+			lpsf = NULL;
+			CoTaskMemFree((LPVOID)pidl);
+		}
+	}
+	return lpsf;
+}
+
 //=============================================================================
 //
 //  DirList_PropertyDlg()
@@ -633,21 +1732,24 @@ BOOL DirList_PropertyDlg(HWND hwnd, int iItem) {
 		}
 	}
 
-	LV_ITEM lvi;
-	lvi.mask = LVIF_PARAM;
-	lvi.iItem = iItem;
-	lvi.iSubItem = 0;
+	const LPCDLDATA lpdl = (LPCDLDATA)GetProp(hwnd, pDirListProp);
+	DLENTRY *dle = DirList_GetEntry(lpdl, iItem);
+	if (dle == NULL) {
+		return FALSE;
+	}
 
-	if (!ListView_GetItem(hwnd, &lvi)) {
+	LPCITEMIDLIST pidl;
+	LPITEMIDLIST pidlFree;
+	LPSHELLFOLDER lpsf = DirList_BindEntry(lpdl, dle, &pidl, &pidlFree);
+	if (lpsf == NULL) {
 		return FALSE;
 	}
 
 	BOOL bSuccess = TRUE;
-	LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
 	LPCONTEXTMENU lpcm;
 
 #if defined(__cplusplus)
-	if (S_OK == lplvid->lpsf->GetUIObjectOf(GetParent(hwnd), 1, (LPCITEMIDLIST *)(&lplvid->pidl), IID_IContextMenu, NULL, (void **)(&lpcm))) {
+	if (S_OK == lpsf->GetUIObjectOf(GetParent(hwnd), 1, &pidl, IID_IContextMenu, NULL, (void **)(&lpcm))) {
 		CMINVOKECOMMANDINFO cmi;
 		cmi.cbSize = sizeof(CMINVOKECOMMANDINFO);
 		cmi.fMask = 0;
@@ -668,7 +1770,7 @@ BOOL DirList_PropertyDlg(HWND hwnd, int iItem) {
 		bSuccess = FALSE;
 	}
 #else
-	if (S_OK == lplvid->lpsf->lpVtbl->GetUIObjectOf(lplvid->lpsf, GetParent(hwnd), 1, (LPCITEMIDLIST *)(&lplvid->pidl), &IID_IContextMenu, NULL, (void **)(&lpcm))) {
+	if (S_OK == lpsf->lpVtbl->GetUIObjectOf(lpsf, GetParent(hwnd), 1, &pidl, &IID_IContextMenu, NULL, (void **)(&lpcm))) {
 		CMINVOKECOMMANDINFO cmi;
 		cmi.cbSize = sizeof(CMINVOKECOMMANDINFO);
 		cmi.fMask = 0;
@@ -690,6 +1792,14 @@ BOOL DirList_PropertyDlg(HWND hwnd, int iItem) {
 	}
 #endif
 
+#if defined(__cplusplus)
+	lpsf->Release();
+#else
+	lpsf->lpVtbl->Release(lpsf);
+#endif
+	if (pidlFree) {
+		CoTaskMemFree((LPVOID)pidlFree);
+	}
 	return bSuccess;
 }
 
@@ -708,16 +1818,16 @@ extern HANDLE CreateDropSource(void);
 void DirList_DoDragDrop(HWND hwnd, LPARAM lParam) {
 	const NM_LISTVIEW *pnmlv = (NM_LISTVIEW *)lParam;
 
-	LV_ITEM lvi;
-	lvi.iItem = pnmlv->iItem;
-	lvi.iSubItem = 0;
-	lvi.mask = LVIF_PARAM;
+	const LPCDLDATA lpdl = (LPCDLDATA)GetProp(hwnd, pDirListProp);
+	DLENTRY *dle = DirList_GetEntry(lpdl, pnmlv->iItem);
 
-	if (ListView_GetItem(hwnd, &lvi)) {
-		LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
+	LPCITEMIDLIST pidl;
+	LPITEMIDLIST pidlFree;
+	LPSHELLFOLDER lpsf = (dle != NULL) ? DirList_BindEntry(lpdl, dle, &pidl, &pidlFree) : NULL;
+	if (lpsf != NULL) {
 		LPDATAOBJECT lpdo;
 #if defined(__cplusplus)
-		if (SUCCEEDED(lplvid->lpsf->GetUIObjectOf(GetParent(hwnd), 1, (LPCITEMIDLIST *)(&lplvid->pidl), IID_IDataObject, NULL, (void **)(&lpdo)))) {
+		if (SUCCEEDED(lpsf->GetUIObjectOf(GetParent(hwnd), 1, &pidl, IID_IDataObject, NULL, (void **)(&lpdo)))) {
 			LPDROPSOURCE lpds = (LPDROPSOURCE)CreateDropSource();
 			DWORD dwEffect;
 
@@ -727,7 +1837,7 @@ void DirList_DoDragDrop(HWND hwnd, LPARAM lParam) {
 			lpds->Release();
 		}
 #else
-		if (SUCCEEDED(lplvid->lpsf->lpVtbl->GetUIObjectOf(lplvid->lpsf, GetParent(hwnd), 1, (LPCITEMIDLIST *)(&lplvid->pidl), &IID_IDataObject, NULL, (void **)(&lpdo)))) {
+		if (SUCCEEDED(lpsf->lpVtbl->GetUIObjectOf(lpsf, GetParent(hwnd), 1, &pidl, &IID_IDataObject, NULL, (void **)(&lpdo)))) {
 			LPDROPSOURCE lpds = (LPDROPSOURCE)CreateDropSource();
 			DWORD dwEffect;
 
@@ -737,6 +1847,15 @@ void DirList_DoDragDrop(HWND hwnd, LPARAM lParam) {
 			lpds->lpVtbl->Release(lpds);
 		}
 #endif
+
+#if defined(__cplusplus)
+		lpsf->Release();
+#else
+		lpsf->lpVtbl->Release(lpsf);
+#endif
+		if (pidlFree) {
+			CoTaskMemFree((LPVOID)pidlFree);
+		}
 	}
 }
 
@@ -824,6 +1943,60 @@ BOOL DirList_IsFileSelected(HWND hwnd) {
 //
 //  Create a valid DL_FILTER structure
 //
+static const DL_FILTER_EXT *DirList_FindFilterExt(LPCDL_FILTER pdlf, LPCWSTR lpszExt, UINT length, UINT hash) {
+	UINT index = hash & (DL_FILTER_HASHSIZE - 1);
+	const DL_FILTER_EXT *node;
+	while ((node = &pdlf->tExt[index])->hash != 0) {
+		if (node->hash == hash && node->length == length && StrCmpNI(node->pszExt, lpszExt, length) == 0) {
+			return node;
+		}
+		index = (index + 1) & (DL_FILTER_HASHSIZE - 1);
+	}
+	return NULL;
+}
+
+static void DirList_CompilePattern(PDL_FILTER pdlf, LPWSTR pszPattern) {
+	// trim spaces around pattern
+	while (*pszPattern == L' ') {
+		pszPattern++;
+	}
+	LPWSTR pszEnd = StrEnd(pszPattern);
+	while (pszEnd != pszPattern && pszEnd[-1] == L' ') {
+		*--pszEnd = L'\0';
+	}
+	if (*pszPattern == L'\0') { // Filters like L"\0" are ignored
+		return;
+	}
+
+	if (StrEqual(pszPattern, L"*") || StrEqual(pszPattern, L"*.*")) {
+		pdlf->bMatchAll = TRUE;
+		return;
+	}
+
+	// "*.ext" without other wildcard or dot is put into extension table
+	if (pszPattern[0] == L'*' && pszPattern[1] == L'.' && pszPattern[2] != L'\0'
+		&& StrPBrk(pszPattern + 2, L"*?.") == NULL) {
+		LPCWSTR lpszExt = pszPattern + 2;
+		const UINT length = (UINT)(pszEnd - lpszExt);
+		const UINT hash = DirList_ExtensionHash(lpszExt, length);
+		if (DirList_FindFilterExt(pdlf, lpszExt, length, hash) != NULL) {
+			return;
+		}
+		UINT index = hash & (DL_FILTER_HASHSIZE - 1);
+		while (pdlf->tExt[index].hash != 0) {
+			index = (index + 1) & (DL_FILTER_HASHSIZE - 1);
+		}
+		DL_FILTER_EXT *node = &pdlf->tExt[index];
+		node->hash = hash;
+		node->length = length;
+		node->pszExt = lpszExt;
+		return;
+	}
+
+	CharLowerBuff(pszPattern, (DWORD)(pszEnd - pszPattern));
+	pdlf->pFilter[pdlf->nGlob++] = pszPattern;
+}
+
 void DirList_CreateFilter(PDL_FILTER pdlf, LPCWSTR lpszFileSpec, BOOL bExcludeFilter) {
 	ZeroMemory(pdlf, sizeof(DL_FILTER));
 	if (StrIsEmpty(lpszFileSpec) || StrEqual(lpszFileSpec, L"*.*")) {
@@ -832,14 +2005,19 @@ void DirList_CreateFilter(PDL_FILTER pdlf, LPCWSTR lpszFileSpec, BOOL bExcludeFi
 
 	lstrcpyn(pdlf->tFilterBuf, lpszFileSpec, (DL_FILTER_BUFSIZE - 1));
 	pdlf->bExcludeFilter = bExcludeFilter;
-	pdlf->nCount = 1;
-	pdlf->pFilter[0] = pdlf->tFilterBuf;    // Zeile zum Ausprobieren
 
-	WCHAR *p;
-	while ((p = StrChr(pdlf->pFilter[pdlf->nCount - 1], L';')) != NULL) {
-		*p = L'\0';                              // Replace L';' by L'\0'
-		pdlf->pFilter[pdlf->nCount] = (p + 1);  // Next position after L';'
+	LPWSTR pszPattern = pdlf->tFilterBuf;
+	while (TRUE) {
+		LPWSTR p = StrChr(pszPattern, L';');
+		if (p != NULL) {
+			*p = L'\0';                          // Replace L';' by L'\0'
+		}
 		pdlf->nCount++;                         // Increase number of filters
+		DirList_CompilePattern(pdlf, pszPattern);
+		if (p == NULL) {
+			break;
+		}
+		pszPattern = p + 1;                     // Next position after L';'
 	}
 }
 
@@ -849,17 +2027,68 @@ void DirList_CreateFilter(PDL_FILTER pdlf, LPCWSTR lpszFileSpec, BOOL bExcludeFi
 //
 //  Check if a specified item matches a given filter
 //
-BOOL DirList_MatchFilter(LPSHELLFOLDER lpsf, LPCITEMIDLIST pidl, LPCDL_FILTER pdlf) {
+static BOOL DirList_MatchGlob(LPCWSTR lpszName, LPCWSTR lpszPattern) {
+	LPCWSTR pStar = NULL;
+	LPCWSTR pBack = NULL;
+	while (*lpszName) {
+		if (*lpszPattern == L'*') {
+			pStar = ++lpszPattern;
+			pBack = lpszName;
+		} else if (*lpszPattern == L'?' || *lpszPattern == *lpszName) {
+			lpszPattern++;
+			lpszName++;
+		} else if (pStar) {
+			lpszPattern = pStar;
+			lpszName = ++pBack;
+		} else {
+			return FALSE;
+		}
+	}
+	// same as PathMatchSpec(), "name.*" also matches "name"
+	if (lpszPattern[0] == L'.' && lpszPattern[1] == L'*') {
+		lpszPattern += 2;
+	}
+	while (*lpszPattern == L'*') {
+		lpszPattern++;
+	}
+	return *lpszPattern == L'\0';
+}
+
+static BOOL DirList_MatchPatterns(LPCWSTR lpszName, LPCDL_FILTER pdlf) {
+	if (pdlf->bMatchAll) {
+		return TRUE;
+	}
+
+	LPCWSTR lpszExt = StrRChr(lpszName, NULL, L'.');
+	if (lpszExt != NULL) {
+		lpszExt++;
+		const UINT length = lstrlen(lpszExt);
+		if (length != 0 && DirList_FindFilterExt(pdlf, lpszExt, length, DirList_ExtensionHash(lpszExt, length)) != NULL) {
+			return TRUE;
+		}
+	}
+
+	if (pdlf->nGlob != 0) {
+		WCHAR szName[MAX_PATH];
+		lstrcpyn(szName, lpszName, COUNTOF(szName));
+		CharLower(szName);
+		for (int i = 0; i < pdlf->nGlob; i++) {
+			if (DirList_MatchGlob(szName, pdlf->pFilter[i])) {
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
+BOOL DirList_MatchFilter(const WIN32_FIND_DATA *pfd, LPCDL_FILTER pdlf) {
 	// Immediately return true if lpszFileSpec is *.* or NULL
 	if (pdlf->nCount == 0 && !pdlf->bExcludeFilter) {
 		return TRUE;
 	}
 
-	WIN32_FIND_DATA fd;
-	SHGetDataFromIDList(lpsf, pidl, SHGDFIL_FINDDATA, &fd, sizeof(WIN32_FIND_DATA));
-
 	// All the directories are added
-	if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+	if (pfd->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
 		return TRUE;
 	}
 
@@ -868,20 +2097,8 @@ BOOL DirList_MatchFilter(LPSHELLFOLDER lpsf, LPCITEMIDLIST pidl, LPCDL_FILTER pd
 		return FALSE;
 	}
 
-	for (int i = 0; i < pdlf->nCount; i++) {
-		if (*pdlf->pFilter[i]) { // Filters like L"\0" are ignored
-			const BOOL bMatchSpec = PathMatchSpec(fd.cFileName, pdlf->pFilter[i]);
-			if (bMatchSpec) {
-				if (!pdlf->bExcludeFilter) {
-					return TRUE;
-				}
-				return FALSE;
-			}
-		}
-	}
-
-	// No matching
-	return pdlf->bExcludeFilter;
+	const BOOL bMatchSpec = DirList_MatchPatterns(pfd->cFileName, pdlf);
+	return pdlf->bExcludeFilter ? !bMatchSpec : bMatchSpec;
 }
 
 //==== DriveBox ===============================================================
@@ -890,11 +2107,36 @@ BOOL DirList_MatchFilter(LPSHELLFOLDER lpsf, LPCITEMIDLIST pidl, LPCDL_FILTER pd
 //
 //  Internal Itemdata Structure
 //
+//  Drive letters are listed immediately, label and icon are resolved by
+//  DriveBox_ResolveThread(), a drive not resolved in DRIVEBOX_RESOLVE_TIMEOUT
+//  (e.g. disconnected network drive) keeps the placeholder.
+//
 typedef struct DC_ITEMDATA {
-	LPITEMIDLIST pidl;
-	LPSHELLFOLDER lpsf;
+	WCHAR szRoot[4];		// L"C:\\"
+	BOOL bResolved;
 } DC_ITEMDATA, *LPDC_ITEMDATA;
 
+typedef const DC_ITEMDATA *LPCDC_ITEMDATA;
+
+typedef struct DC_RESOLVE {
+	HWND hwnd;				// drive box, result is posted to its parent
+	UINT serial;			// items are ignored after the box is filled again
+	WCHAR szRoot[4];
+	WCHAR szName[MAX_PATH];
+	int iImage;
+	BOOL bAvailable;
+} DC_RESOLVE;
+
+typedef struct DC_RESOLVE_LIST {
+	UINT count;
+	DC_RESOLVE *items[26];
+} DC_RESOLVE_LIST;
+
+#define DRIVEBOX_RESOLVE_TIMEOUT	2000	// milliseconds
+
+static DWORD dwDriveBoxMask;
+static UINT iDriveBoxSerial;
+
 //=============================================================================
 //
 //  DriveBox_Init()
@@ -903,167 +2145,177 @@ typedef struct DC_ITEMDATA {
 //
 BOOL DriveBox_Init(HWND hwnd) {
 	SHFILEINFO shfi;
-	HIMAGELIST hil = (HIMAGELIST)SHGetFileInfo(L"C:\\", 0, &shfi, sizeof(SHFILEINFO), SHGFI_SMALLICON | SHGFI_SYSICONINDEX);
+	HIMAGELIST hil = (HIMAGELIST)SHGetFileInfo(L"C:\\", FILE_ATTRIBUTE_DIRECTORY, &shfi, sizeof(SHFILEINFO), SHGFI_USEFILEATTRIBUTES | SHGFI_SMALLICON | SHGFI_SYSICONINDEX);
 	SendMessage(hwnd, CBEM_SETIMAGELIST, 0, (LPARAM)hil);
 	SendMessage(hwnd, CBEM_SETEXTENDEDSTYLE, CBES_EX_NOSIZELIMIT, CBES_EX_NOSIZELIMIT);
 
 	return TRUE;
 }
 
+//=============================================================================
+//
+//  DriveBox_ResolveThread()
+//
+//  Retrieves label and icon of drives, each drive is resolved on its own
+//  thread, which owns the DC_RESOLVE and posts it to the main window.
+//
+static void DriveBox_PostResult(DC_RESOLVE *result) {
+	if (!PostMessage(GetParent(result->hwnd), APPM_DRIVEBOX_RESOLVED, 0, (LPARAM)result)) {
+		NP2HeapFree(result);
+	}
+}
+
+static DWORD WINAPI DriveBox_ResolveDriveThread(LPVOID lpParam) {
+	DC_RESOLVE *result = (DC_RESOLVE *)lpParam;
+	SHFILEINFO shfi;
+	// may be blocked by network drive until SMB timeout
+	if (SHGetFileInfo(result->szRoot, 0, &shfi, sizeof(SHFILEINFO), SHGFI_DISPLAYNAME | SHGFI_SYSICONINDEX | SHGFI_SMALLICON)) {
+		lstrcpyn(result->szName, shfi.szDisplayName, COUNTOF(result->szName));
+		result->iImage = shfi.iIcon;
+		result->bAvailable = TRUE;
+	}
+	DriveBox_PostResult(result);
+	return 0;
+}
+
+static DWORD WINAPI DriveBox_ResolveThread(LPVOID lpParam) {
+	DC_RESOLVE_LIST *list = (DC_RESOLVE_LIST *)lpParam;
+	HANDLE threads[COUNTOF(list->items)];
+	DC_RESOLVE roots[COUNTOF(list->items)];
+
+	for (UINT i = 0; i < list->count; i++) {
+		// copy for timeout, the thread owns the item
+		CopyMemory(&roots[i], list->items[i], sizeof(DC_RESOLVE));
+		threads[i] = CreateThread(NULL, 0, DriveBox_ResolveDriveThread, list->items[i], 0, NULL);
+		if (threads[i] == NULL) {
+			DriveBox_ResolveDriveThread(list->items[i]);
+		}
+	}
+
+	const DWORD dwStart = GetTickCount();
+	for (UINT i = 0; i < list->count; i++) {
+		if (threads[i] != NULL) {
+			const DWORD dwElapsed = GetTickCount() - dwStart;
+			const DWORD dwTimeout = (dwElapsed < DRIVEBOX_RESOLVE_TIMEOUT) ? (DRIVEBOX_RESOLVE_TIMEOUT - dwElapsed) : 0;
+			if (WaitForSingleObject(threads[i], dwTimeout) != WAIT_OBJECT_0) {
+				// report unavailable drive, the thread may still post its result later
+				DC_RESOLVE *result = (DC_RESOLVE *)NP2HeapAlloc(sizeof(DC_RESOLVE));
+				CopyMemory(result, &roots[i], sizeof(DC_RESOLVE));
+				DriveBox_PostResult(result);
+			}
+			CloseHandle(threads[i]);
+		}
+	}
+
+	NP2HeapFree(list);
+	return 0;
+}
+
 //=============================================================================
 //
 //  DriveBox_Fill
 //
+//  Lists drive letters from GetLogicalDrives(), nothing is changed when drives
+//  are not changed since last call.
+//
 int DriveBox_Fill(HWND hwnd) {
+	const DWORD dwMask = GetLogicalDrives();
+	if (dwMask == dwDriveBoxMask && ComboBox_GetCount(hwnd) > 0) {
+		return ComboBox_GetCount(hwnd);
+	}
+
+	dwDriveBoxMask = dwMask;
+	++iDriveBoxSerial;
+
 	// Init ComboBox
 	SendMessage(hwnd, WM_SETREDRAW, 0, 0);
 	ComboBox_ResetContent(hwnd);
 
+	// placeholder icon
+	SHFILEINFO shfi;
+	SHGetFileInfo(L"C:\\", FILE_ATTRIBUTE_DIRECTORY, &shfi, sizeof(SHFILEINFO), SHGFI_USEFILEATTRIBUTES | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
+
 	COMBOBOXEXITEM cbei;
 	ZeroMemory(&cbei, sizeof(COMBOBOXEXITEM));
 	cbei.mask = CBEIF_TEXT | CBEIF_IMAGE | CBEIF_SELECTEDIMAGE | CBEIF_LPARAM;
-	cbei.pszText = LPSTR_TEXTCALLBACK;
-	cbei.cchTextMax = MAX_PATH;
-	cbei.iImage = I_IMAGECALLBACK;
-	cbei.iSelectedImage = I_IMAGECALLBACK;
-
-	// Get pidl to [My Computer]
-	LPITEMIDLIST pidl;
-#if _WIN32_WINNT < _WIN32_WINNT_VISTA
-	if (S_OK == SHGetFolderLocation(hwnd, CSIDL_DRIVES, NULL, SHGFP_TYPE_DEFAULT, &pidl))
-#else
-	if (S_OK == SHGetKnownFolderIDList(&FOLDERID_ComputerFolder, KF_FLAG_DEFAULT, NULL, &pidl))
-#endif
-	{
-		// Get Desktop Folder
-		LPSHELLFOLDER lpsfDesktop;
-		if (S_OK == SHGetDesktopFolder(&lpsfDesktop)) {
-			// Bind pidl to IShellFolder
-			LPSHELLFOLDER lpsf; // Workspace == CSIDL_DRIVES
-#if defined(__cplusplus)
-			if (S_OK == lpsfDesktop->BindToObject(pidl, NULL, IID_IShellFolder, (void **)(&lpsf))) {
-				// Create an Enumeration object for lpsf
-				const DWORD grfFlags = SHCONTF_FOLDERS;
-				LPENUMIDLIST lpe;
-				if (S_OK == lpsf->EnumObjects(hwnd, grfFlags, &lpe)) {
-					// Enumerate the contents of [My Computer]
-					LPITEMIDLIST pidlEntry;
-					while (S_OK == lpe->Next(1, &pidlEntry, NULL)) {
-						// Add item to the List if it is part of the
-						// Filesystem
-						ULONG dwAttributes = SFGAO_FILESYSTEM;
-						lpsf->GetAttributesOf(1, (LPCITEMIDLIST *)(&pidlEntry), &dwAttributes);
-
-						if (dwAttributes & SFGAO_FILESYSTEM) {
-							// Windows XP: check if pidlEntry is a drive
-							SHDESCRIPTIONID di;
-							HRESULT hr = SHGetDataFromIDList(lpsf, pidlEntry, SHGDFIL_DESCRIPTIONID, &di, sizeof(SHDESCRIPTIONID));
-							if (hr != S_OK || (di.dwDescriptionId >= SHDID_COMPUTER_DRIVE35 && di.dwDescriptionId <= SHDID_COMPUTER_OTHER)) {
-								LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)CoTaskMemAlloc(sizeof(DC_ITEMDATA));
-								//lpdcid->pidl = IL_Copy(pidlEntry);
-								lpdcid->pidl = pidlEntry;
-								lpdcid->lpsf = lpsf;
-								lpsf->AddRef();
-
-								// Insert sorted ...
-								{
-									COMBOBOXEXITEM cbei2;
-									cbei2.mask = CBEIF_LPARAM;
-									cbei2.iItem = 0;
-
-									while ((SendMessage(hwnd, CBEM_GETITEM, 0, (LPARAM)&cbei2))) {
-										const LPCLV_ITEMDATA lpdcid2 = (LPCLV_ITEMDATA)cbei2.lParam;
-										hr = lpdcid->lpsf->CompareIDs(0, lpdcid->pidl, lpdcid2->pidl);
-
-										if ((short)HRESULT_CODE(hr) < 0) {
-											break;
-										}
-										cbei2.iItem++;
-									}
-
-									cbei.iItem = cbei2.iItem;
-									cbei.lParam = (LPARAM)lpdcid;
-									SendMessage(hwnd, CBEM_INSERTITEM, 0, (LPARAM)&cbei);
-								}
-							}
-						}
-					} // IEnumIDList::Next()
-
-					lpe->Release();
-				} // IShellFolder::EnumObjects()
-
-				lpsf->Release();
-			} // IShellFolder::BindToObject()
-#else
-			if (S_OK == lpsfDesktop->lpVtbl->BindToObject(lpsfDesktop, pidl, NULL, &IID_IShellFolder, (void **)(&lpsf))) {
-				// Create an Enumeration object for lpsf
-				const DWORD grfFlags = SHCONTF_FOLDERS;
-				LPENUMIDLIST lpe;
-				if (S_OK == lpsf->lpVtbl->EnumObjects(lpsf, hwnd, grfFlags, &lpe)) {
-					// Enumerate the contents of [My Computer]
-					LPITEMIDLIST pidlEntry;
-					while (S_OK == lpe->lpVtbl->Next(lpe, 1, &pidlEntry, NULL)) {
-						// Add item to the List if it is part of the
-						// Filesystem
-						ULONG dwAttributes = SFGAO_FILESYSTEM;
-						lpsf->lpVtbl->GetAttributesOf(lpsf, 1, (LPCITEMIDLIST *)(&pidlEntry), &dwAttributes);
-
-						if (dwAttributes & SFGAO_FILESYSTEM) {
-							// Windows XP: check if pidlEntry is a drive
-							SHDESCRIPTIONID di;
-							HRESULT hr = SHGetDataFromIDList(lpsf, pidlEntry, SHGDFIL_DESCRIPTIONID, &di, sizeof(SHDESCRIPTIONID));
-							if (hr != S_OK || (di.dwDescriptionId >= SHDID_COMPUTER_DRIVE35 && di.dwDescriptionId <= SHDID_COMPUTER_OTHER)) {
-								LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)CoTaskMemAlloc(sizeof(DC_ITEMDATA));
-								//lpdcid->pidl = IL_Copy(pidlEntry);
-								lpdcid->pidl = pidlEntry;
-								lpdcid->lpsf = lpsf;
-								lpsf->lpVtbl->AddRef(lpsf);
-
-								// Insert sorted ...
-								{
-									COMBOBOXEXITEM cbei2;
-									cbei2.mask = CBEIF_LPARAM;
-									cbei2.iItem = 0;
-
-									while ((SendMessage(hwnd, CBEM_GETITEM, 0, (LPARAM)&cbei2))) {
-										const LPCLV_ITEMDATA lpdcid2 = (LPCLV_ITEMDATA)cbei2.lParam;
-										hr = lpdcid->lpsf->lpVtbl->CompareIDs(lpdcid->lpsf, 0, lpdcid->pidl, lpdcid2->pidl);
-
-										if ((short)HRESULT_CODE(hr) < 0) {
-											break;
-										}
-										cbei2.iItem++;
-									}
-
-									cbei.iItem = cbei2.iItem;
-									cbei.lParam = (LPARAM)lpdcid;
-									SendMessage(hwnd, CBEM_INSERTITEM, 0, (LPARAM)&cbei);
-								}
-							}
-						}
-					} // IEnumIDList::Next()
+	cbei.iImage = shfi.iIcon;
+	cbei.iSelectedImage = shfi.iIcon;
 
-					lpe->lpVtbl->Release(lpe);
-				} // IShellFolder::EnumObjects()
+	DC_RESOLVE_LIST *list = (DC_RESOLVE_LIST *)NP2HeapAlloc(sizeof(DC_RESOLVE_LIST));
+	for (int i = 0; i < 26; i++) {
+		if (!(dwMask & (1U << i))) {
+			continue;
+		}
 
-				lpsf->lpVtbl->Release(lpsf);
-			} // IShellFolder::BindToObject()
-#endif
-			CoTaskMemFree((LPVOID)pidl);
-		} // SHGetDesktopFolder()
+		LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)NP2HeapAlloc(sizeof(DC_ITEMDATA));
+		lpdcid->szRoot[0] = (WCHAR)(L'A' + i);
+		lpdcid->szRoot[1] = L':';
+		lpdcid->szRoot[2] = L'\\';
+
+		// placeholder label without backslash
+		WCHAR szName[3] = { lpdcid->szRoot[0], L':', L'\0' };
+		cbei.iItem = ComboBox_GetCount(hwnd);
+		cbei.pszText = szName;
+		cbei.lParam = (LPARAM)lpdcid;
+		SendMessage(hwnd, CBEM_INSERTITEM, 0, (LPARAM)&cbei);
+
+		DC_RESOLVE *result = (DC_RESOLVE *)NP2HeapAlloc(sizeof(DC_RESOLVE));
+		result->hwnd = hwnd;
+		result->serial = iDriveBoxSerial;
+		lstrcpy(result->szRoot, lpdcid->szRoot);
+		lstrcpy(result->szName, szName);
+		result->iImage = shfi.iIcon;
+		list->items[list->count++] = result;
+	}
 
-#if defined(__cplusplus)
-		lpsfDesktop->Release();
-#else
-		lpsfDesktop->lpVtbl->Release(lpsfDesktop);
-#endif
-	} // SHGetKnownFolderIDList()
+	HANDLE hThread = CreateThread(NULL, 0, DriveBox_ResolveThread, list, 0, NULL);
+	if (hThread != NULL) {
+		CloseHandle(hThread);
+	} else {
+		for (UINT i = 0; i < list->count; i++) {
+			NP2HeapFree(list->items[i]);
+		}
+		NP2HeapFree(list);
+	}
 
 	SendMessage(hwnd, WM_SETREDRAW, 1, 0);
 	// Return number of items added to combo box
 	return ComboBox_GetCount(hwnd);
 }
 
+//=============================================================================
+//
+//  DriveBox_SetResolved()
+//
+//  Handles APPM_DRIVEBOX_RESOLVED posted by DriveBox_ResolveThread()
+//
+void DriveBox_SetResolved(HWND hwnd, LPARAM lParam) {
+	DC_RESOLVE *result = (DC_RESOLVE *)lParam;
+	if (result->serial == iDriveBoxSerial) {
+		COMBOBOXEXITEM cbei;
+		cbei.mask = CBEIF_LPARAM;
+		const int cbItems = ComboBox_GetCount(hwnd);
+		for (int i = 0; i < cbItems; i++) {
+			cbei.iItem = i;
+			SendMessage(hwnd, CBEM_GETITEM, 0, (LPARAM)&cbei);
+			LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)cbei.lParam;
+			if (lpdcid->szRoot[0] == result->szRoot[0]) {
+				// drive timed out is still resolved when its thread finishes
+				if (!lpdcid->bResolved && result->bAvailable) {
+					lpdcid->bResolved = TRUE;
+					cbei.mask = CBEIF_TEXT | CBEIF_IMAGE | CBEIF_SELECTEDIMAGE;
+					cbei.pszText = result->szName;
+					cbei.iImage = result->iImage;
+					cbei.iSelectedImage = result->iImage;
+					SendMessage(hwnd, CBEM_SETITEM, 0, (LPARAM)&cbei);
+				}
+				break;
+			}
+		}
+	}
+	NP2HeapFree(result);
+}
+
 //=============================================================================
 //
 //  DriveBox_GetSelDrive
@@ -1080,10 +2332,10 @@ BOOL DriveBox_GetSelDrive(HWND hwnd, LPWSTR lpszDrive, int nDrive, BOOL fNoSlash
 	cbei.mask = CBEIF_LPARAM;
 	cbei.iItem = i;
 	SendMessage(hwnd, CBEM_GETITEM, 0, (LPARAM)&cbei);
-	LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)cbei.lParam;
+	LPCDC_ITEMDATA lpdcid = (LPCDC_ITEMDATA)cbei.lParam;
 
 	// Get File System Path for Drive
-	IL_GetDisplayName(lpdcid->lpsf, lpdcid->pidl, SHGDN_FORPARSING, lpszDrive, nDrive);
+	lstrcpyn(lpszDrive, lpdcid->szRoot, nDrive);
 
 	// Remove Backslash if required (makes Drive relative!!!)
 	if (fNoSlash) {
@@ -1108,18 +2360,13 @@ BOOL DriveBox_SelectDrive(HWND hwnd, LPCWSTR lpszPath) {
 	cbei.mask = CBEIF_LPARAM;
 
 	for (int i = 0; i < cbItems; i++) {
-		WCHAR szRoot[64] = L"";
-		LPDC_ITEMDATA lpdcid;
 		// Get DC_ITEMDATA* of Item i
 		cbei.iItem = i;
 		SendMessage(hwnd, CBEM_GETITEM, 0, (LPARAM)&cbei);
-		lpdcid = (LPDC_ITEMDATA)cbei.lParam;
-
-		// Get File System Path for Drive
-		IL_GetDisplayName(lpdcid->lpsf, lpdcid->pidl, SHGDN_FORPARSING, szRoot, COUNTOF(szRoot));
+		LPCDC_ITEMDATA lpdcid = (LPCDC_ITEMDATA)cbei.lParam;
 
 		// Compare Root Directory with Path
-		if (PathIsSameRoot(lpszPath, szRoot)) {
+		if (PathIsSameRoot(lpszPath, lpdcid->szRoot)) {
 			// Select matching Drive
 			ComboBox_SetCurSel(hwnd, i);
 			return TRUE;
@@ -1145,16 +2392,34 @@ BOOL DriveBox_PropertyDlg(HWND hwnd) {
 		return FALSE;
 	}
 
-	BOOL bSuccess = TRUE;
 	COMBOBOXEXITEM cbei;
 	cbei.mask = CBEIF_LPARAM;
 	cbei.iItem = iItem;
 	SendMessage(hwnd, CBEM_GETITEM, 0, (LPARAM)&cbei);
-	LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)cbei.lParam;
+	LPCDC_ITEMDATA lpdcid = (LPCDC_ITEMDATA)cbei.lParam;
+
+	// bind drive to [My Computer] on demand
+	LPITEMIDLIST pidlDrive;
+	if (FAILED(SHParseDisplayName(lpdcid->szRoot, NULL, &pidlDrive, 0, NULL))) {
+		return FALSE;
+	}
+
+	LPSHELLFOLDER lpsf;
+	LPCITEMIDLIST pidl;
+#if defined(__cplusplus)
+	if (FAILED(SHBindToParent(pidlDrive, IID_IShellFolder, (void **)(&lpsf), &pidl))) {
+#else
+	if (FAILED(SHBindToParent(pidlDrive, &IID_IShellFolder, (void **)(&lpsf), &pidl))) {
+#endif
+		CoTaskMemFree((LPVOID)pidlDrive);
+		return FALSE;
+	}
+
+	BOOL bSuccess = TRUE;
 	LPCONTEXTMENU lpcm;
 
 #if defined(__cplusplus)
-	if (S_OK == lpdcid->lpsf->GetUIObjectOf(GetParent(hwnd), 1, (LPCITEMIDLIST *)(&lpdcid->pidl), IID_IContextMenu, NULL, (void **)(&lpcm))) {
+	if (S_OK == lpsf->GetUIObjectOf(GetParent(hwnd), 1, &pidl, IID_IContextMenu, NULL, (void **)(&lpcm))) {
 		CMINVOKECOMMANDINFO cmi;
 		cmi.cbSize = sizeof(CMINVOKECOMMANDINFO);
 		cmi.fMask = 0;
@@ -1175,7 +2440,7 @@ BOOL DriveBox_PropertyDlg(HWND hwnd) {
 		bSuccess = FALSE;
 	}
 #else
-	if (S_OK == lpdcid->lpsf->lpVtbl->GetUIObjectOf(lpdcid->lpsf, GetParent(hwnd), 1, (LPCITEMIDLIST *)(&lpdcid->pidl), &IID_IContextMenu, NULL, (void **)(&lpcm))) {
+	if (S_OK == lpsf->lpVtbl->GetUIObjectOf(lpsf, GetParent(hwnd), 1, &pidl, &IID_IContextMenu, NULL, (void **)(&lpcm))) {
 		CMINVOKECOMMANDINFO cmi;
 		cmi.cbSize = sizeof(CMINVOKECOMMANDINFO);
 		cmi.fMask = 0;
@@ -1197,6 +2462,12 @@ BOOL DriveBox_PropertyDlg(HWND hwnd) {
 	}
 #endif
 
+#if defined(__cplusplus)
+	lpsf->Release();
+#else
+	lpsf->lpVtbl->Release(lpsf);
+#endif
+	CoTaskMemFree((LPVOID)pidlDrive);
 	return bSuccess;
 }
 
@@ -1211,53 +2482,7 @@ LRESULT DriveBox_DeleteItem(HWND hwnd, LPARAM lParam) {
 
 	cbei.mask = CBEIF_LPARAM;
 	SendMessage(hwnd, CBEM_GETITEM, 0, (LPARAM)&cbei);
-	LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)cbei.lParam;
-
-	// Free pidl
-	CoTaskMemFree((LPVOID)(lpdcid->pidl));
-	// Release lpsf
-#if defined(__cplusplus)
-	lpdcid->lpsf->Release();
-#else
-	lpdcid->lpsf->lpVtbl->Release(lpdcid->lpsf);
-#endif
-	// Free lpdcid itself
-	CoTaskMemFree(lpdcid);
-
-	return TRUE;
-}
-
-//=============================================================================
-//
-//  DriveBox_GetDispInfo
-//
-LRESULT DriveBox_GetDispInfo(HWND hwnd, LPARAM lParam) {
-	UNREFERENCED_PARAMETER(hwnd);
-
-	NMCOMBOBOXEX *lpnmcbe = (NMCOMBOBOXEX *)lParam;
-	LPDC_ITEMDATA lpdcid = (LPDC_ITEMDATA)lpnmcbe->ceItem.lParam;
-
-	if (!lpdcid) {
-		return FALSE;
-	}
-
-	// Get Display Name
-	if (lpnmcbe->ceItem.mask & CBEIF_TEXT) {
-		IL_GetDisplayName(lpdcid->lpsf, lpdcid->pidl, SHGDN_NORMAL, lpnmcbe->ceItem.pszText, lpnmcbe->ceItem.cchTextMax);
-	}
-
-	// Get Icon Index
-	if (lpnmcbe->ceItem.mask & (CBEIF_IMAGE | CBEIF_SELECTEDIMAGE)) {
-		WCHAR szTemp[MAX_PATH];
-		SHFILEINFO shfi;
-		IL_GetDisplayName(lpdcid->lpsf, lpdcid->pidl, SHGDN_FORPARSING, szTemp, MAX_PATH);
-		SHGetFileInfo(szTemp, 0, &shfi, sizeof(SHFILEINFO), SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
-		lpnmcbe->ceItem.iImage = shfi.iIcon;
-		lpnmcbe->ceItem.iSelectedImage = shfi.iIcon;
-	}
-
-	// Set values
-	lpnmcbe->ceItem.mask |= CBEIF_DI_SETITEM;
+	NP2HeapFree((LPVOID)cbei.lParam);
 
 	return TRUE;
 }
@@ -19,13 +19,6 @@
 ******************************************************************************/
 #pragma once
 
-typedef struct LV_ITEMDATA { // lvid
-	LPITEMIDLIST pidl; // Item Id
-	LPSHELLFOLDER lpsf; // Parent IShellFolder Interface
-} LV_ITEMDATA, *LPLV_ITEMDATA;
-
-typedef const LV_ITEMDATA *LPCLV_ITEMDATA;
-
 void DirList_Init(HWND hwnd, LPCWSTR pszHeader);
 void DirList_Destroy(HWND hwnd);
 void DirList_StartIconThread(HWND hwnd);
@@ -34,12 +27,16 @@ void DirList_StartIconThread(HWND hwnd);
 #define DL_NONFOLDERS   64
 #define DL_INCLHIDDEN  128
 #define DL_ALLOBJECTS  (DL_FOLDERS | DL_NONFOLDERS | DL_INCLHIDDEN)
+#define DL_RECURSIVE   256	// find files in subdirectories, not saved
 int DirList_Fill(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpec,
 				 BOOL bExcludeFilter, BOOL bNoFadeHidden,
 				 int iSortFlags, BOOL fSortRev);
+int DirList_FillFromCache(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpec,
+				 BOOL bExcludeFilter, BOOL bNoFadeHidden,
+				 int iSortFlags, BOOL fSortRev);
 DWORD WINAPI DirList_IconThread(LPVOID lpParam);
 BOOL DirList_GetDispInfo(HWND hwnd, LPARAM lParam, BOOL bNoFadeHidden);
-BOOL DirList_DeleteItem(HWND hwnd, LPARAM lParam);
+int DirList_FindItem(HWND hwnd, LPARAM lParam);
 
 #define DS_NAME     0
 #define DS_SIZE     1
@@ -47,6 +44,9 @@ BOOL DirList_DeleteItem(HWND hwnd, LPARAM lParam);
 #define DS_LASTMOD  3
 
 BOOL DirList_Sort(HWND hwnd, int lFlags, BOOL fRev);
+BOOL DirList_StartWatch(HWND hwnd);
+BOOL DirList_HasChanged(HWND hwnd);
+int DirList_ApplyChanges(HWND hwnd);
 
 #define DLE_NONE 0
 #define DLE_DIR  1
@@ -75,25 +75,38 @@ BOOL DirList_SelectItem(HWND hwnd, LPCWSTR lpszDisplayName, LPCWSTR lpszFullPath
 BOOL DirList_IsFileSelected(HWND hwnd);
 
 #define DL_FILTER_BUFSIZE 128
+#define DL_FILTER_HASHSIZE 64	// power of two, more than twice of "*.x;" patterns fit in the buffer
+typedef struct DL_FILTER_EXT {
+	UINT hash;
+	UINT length;
+	LPCWSTR pszExt;
+} DL_FILTER_EXT;
+
 typedef struct DL_FILTER { //dlf
 	int nCount;
 	WCHAR tFilterBuf[DL_FILTER_BUFSIZE];
-	LPWSTR pFilter[DL_FILTER_BUFSIZE];
+	LPWSTR pFilter[DL_FILTER_BUFSIZE];	// wildcard patterns not in extension table
 	BOOL bExcludeFilter;
+	BOOL bMatchAll;						// has "*" or "*.*" pattern
+	int nGlob;
+	DL_FILTER_EXT tExt[DL_FILTER_HASHSIZE];	// "*.ext" patterns, zero hash marks empty slot
 } DL_FILTER, *PDL_FILTER, *LPDL_FILTER;
 
 typedef const DL_FILTER *LPCDL_FILTER;
 
 void DirList_CreateFilter(PDL_FILTER pdlf, LPCWSTR lpszFileSpec, BOOL bExcludeFilter);
-BOOL DirList_MatchFilter(LPSHELLFOLDER lpsf, LPCITEMIDLIST pidl, LPCDL_FILTER pdlf);
+BOOL DirList_MatchFilter(const WIN32_FIND_DATA *pfd, LPCDL_FILTER pdlf);
+
+// posted to parent of the drive box when label and icon of a drive are resolved
+#define APPM_DRIVEBOX_RESOLVED	(WM_APP + 5)
 
 BOOL DriveBox_Init(HWND hwnd);
 int  DriveBox_Fill(HWND hwnd);
+void DriveBox_SetResolved(HWND hwnd, LPARAM lParam);
 BOOL DriveBox_GetSelDrive(HWND hwnd, LPWSTR lpszDrive, int nDrive, BOOL fNoSlash);
 BOOL DriveBox_SelectDrive(HWND hwnd, LPCWSTR lpszPath);
 BOOL DriveBox_PropertyDlg(HWND hwnd);
 LRESULT DriveBox_DeleteItem(HWND hwnd, LPARAM lParam);
-LRESULT DriveBox_GetDispInfo(HWND hwnd, LPARAM lParam);
 
 static inline LPITEMIDLIST IL_Next(LPITEMIDLIST pidl) {
 	return (LPITEMIDLIST)((LPBYTE)(pidl) + pidl->mkid.cb);
@@ -98,6 +98,15 @@ BOOL IniSectionParseArray(IniSection *section, LPWSTR lpCachedIniSection) {
 	return count != 0;
 }
 
+// FNV-1a hash of key characters and length
+static inline UINT IniSectionHashKey(LPCWSTR key, UINT keyLen) {
+	UINT hash = 2166136261U ^ keyLen;
+	for (UINT i = 0; i < keyLen; i++) {
+		hash = (hash ^ key[i]) * 16777619U;
+	}
+	return hash;
+}
+
 BOOL IniSectionParse(IniSection *section, LPWSTR lpCachedIniSection) {
 	IniSectionClear(section);
 	if (StrIsEmpty(lpCachedIniSection)) {
@@ -105,6 +114,9 @@ BOOL IniSectionParse(IniSection *section, LPWSTR lpCachedIniSection) {
 	}
 
 	const int capacity = section->capacity;
+	const UINT mask = section->mask;
+	IniKeyValueNode **table = section->hashTable;
+	ZeroMemory(table, (mask + 1) * sizeof(IniKeyValueNode *));
 	LPWSTR p = lpCachedIniSection;
 	int count = 0;
 
@@ -114,32 +126,24 @@ BOOL IniSectionParse(IniSection *section, LPWSTR lpCachedIniSection) {
 			*v++ = L'\0';
 			const UINT keyLen = (UINT)(v - p - 1);
 			IniKeyValueNode *node = &section->nodeList[count];
-			node->hash = keyLen | ((*(const UINT *)p) << 8);
+			const UINT hash = IniSectionHashKey(p, keyLen);
+			node->hash = hash;
 			node->key = p;
 			node->value = v;
+			// duplicate key is placed after previous one, and found by next lookup of same key.
+			UINT index = hash & mask;
+			while (table[index] != NULL) {
+				index = (index + 1) & mask;
+			}
+			table[index] = node;
 			++count;
 			p = v;
 		}
 		p = StrEnd(p) + 1;
 	} while (*p && count < capacity);
 
-	if (count == 0) {
-		return FALSE;
-	}
-
 	section->count = count;
-	section->head = &section->nodeList[0];
-	--count;
-#if IniSectionImplUseSentinelNode
-	section->nodeList[count].next = section->sentinel;
-#else
-	section->nodeList[count].next = NULL;
-#endif
-	while (count != 0) {
-		section->nodeList[count - 1].next = &section->nodeList[count];
-		--count;
-	}
-	return TRUE;
+	return count != 0;
 }
 
 LPCWSTR IniSectionUnsafeGetValue(IniSection *section, LPCWSTR key, int keyLen) {
@@ -147,47 +151,21 @@ LPCWSTR IniSectionUnsafeGetValue(IniSection *section, LPCWSTR key, int keyLen) {
 		keyLen = lstrlen(key);
 	}
 
-	const UINT hash = keyLen | ((*(const UINT *)key) << 8);
-	IniKeyValueNode *node = section->head;
-	IniKeyValueNode *prev = NULL;
-#if IniSectionImplUseSentinelNode
-	section->sentinel->hash = hash;
-	while (TRUE) {
-		if (node->hash == hash) {
-			if (node == section->sentinel) {
-				return NULL;
-			}
-			if (StrEqual(node->key, key)) {
-				// remove the node
-				--section->count;
-				if (prev == NULL) {
-					section->head = node->next;
-				} else {
-					prev->next = node->next;
-				}
-				return node->value;
-			}
-		}
-		prev = node;
-		node = node->next;
-	}
-#else
-	do {
-		if (node->hash == hash && StrEqual(node->key, key)) {
-			// remove the node
+	const UINT hash = IniSectionHashKey(key, keyLen);
+	const UINT mask = section->mask;
+	IniKeyValueNode * const *table = section->hashTable;
+	UINT index = hash & mask;
+	IniKeyValueNode *node;
+	while ((node = table[index]) != NULL) {
+		if (node->hash == hash && node->key != NULL && StrEqual(node->key, key)) {
+			// keep the slot to not break probe sequence, only mark the node as consumed.
 			--section->count;
-			if (prev == NULL) {
-				section->head = node->next;
-			} else {
-				prev->next = node->next;
-			}
+			node->key = NULL;
 			return node->value;
 		}
-		prev = node;
-		node = node->next;
-	} while (node);
+		index = (index + 1) & mask;
+	}
 	return NULL;
-#endif
 }
 
 void IniSectionGetStringImpl(IniSection *section, LPCWSTR key, int keyLen, LPCWSTR lpDefault, LPWSTR lpReturnedString, int cchReturnedString) {
@@ -365,6 +343,78 @@ void BackgroundWorker_Destroy(BackgroundWorker *worker) {
 	CloseHandle(worker->eventCancel);
 }
 
+//=============================================================================
+//
+// StartupTiming_Start()
+//
+#define MAX_STARTUP_TIMING_STAGE	32
+
+static struct StartupTiming {
+	LARGE_INTEGER freq;
+	LARGE_INTEGER begin;
+	UINT count;
+	LPCSTR stage[MAX_STARTUP_TIMING_STAGE];
+	LONGLONG time[MAX_STARTUP_TIMING_STAGE];
+} startupTiming;
+
+void StartupTiming_Start(void) {
+	QueryPerformanceFrequency(&startupTiming.freq);
+	QueryPerformanceCounter(&startupTiming.begin);
+}
+
+void StartupTiming_Mark(LPCSTR stage) {
+	// only record counter here, formatting and I/O are deferred to StartupTiming_Report().
+	const UINT count = startupTiming.count;
+	if (count < MAX_STARTUP_TIMING_STAGE) {
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		startupTiming.stage[count] = stage;
+		startupTiming.time[count] = now.QuadPart;
+		startupTiming.count = count + 1;
+	}
+}
+
+static void StartupTiming_Write(FILE *fp, const char *buf) {
+	if (fp) {
+		fputs(buf, fp);
+	} else {
+		OutputDebugStringA(buf);
+	}
+}
+
+void StartupTiming_Report(LPCWSTR lpszFile) {
+	FILE *fp = NULL;
+	BOOL bConsole = FALSE;
+	if (StrNotEmpty(lpszFile)) {
+		fp = _wfopen(lpszFile, L"a");
+	} else if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+		fp = _wfopen(L"CONOUT$", L"w");
+		bConsole = TRUE;
+	}
+
+	SYSTEMTIME st;
+	GetLocalTime(&st);
+	const double freq = (double)(startupTiming.freq.QuadPart);
+	LONGLONG last = startupTiming.begin.QuadPart;
+	char buf[256];
+	snprintf(buf, COUNTOF(buf), "\n%04u-%02u-%02u %02u:%02u:%02u metapath startup timing (ms)\n%-28s %10s %10s\n",
+		st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond, "stage", "elapsed", "total");
+	StartupTiming_Write(fp, buf);
+	for (UINT i = 0; i < startupTiming.count; i++) {
+		const LONGLONG time = startupTiming.time[i];
+		snprintf(buf, COUNTOF(buf), "%-28s %10.3f %10.3f\n", startupTiming.stage[i],
+			((time - last) * 1000) / freq, ((time - startupTiming.begin.QuadPart) * 1000) / freq);
+		last = time;
+		StartupTiming_Write(fp, buf);
+	}
+	if (fp) {
+		fclose(fp);
+	}
+	if (bConsole) {
+		FreeConsole();
+	}
+}
+
 //=============================================================================
 //
 // PrivateSetCurrentProcessExplicitAppUserModelID()
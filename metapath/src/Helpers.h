@@ -206,38 +206,32 @@ NP2_inline void IniSetBoolEx(LPCWSTR lpSection, LPCWSTR lpName, BOOL b, BOOL bDe
 #define SaveIniSection(lpSection, lpBuf) \
 	WritePrivateProfileSection(lpSection, lpBuf, szIniFile)
 
-struct IniKeyValueNode;
 typedef struct IniKeyValueNode {
-	struct IniKeyValueNode *next;
 	UINT hash;
-	LPCWSTR key;
+	LPCWSTR key;	// NULL after the value is returned by lookup
 	LPCWSTR value;
 } IniKeyValueNode;
 
-// https://en.wikipedia.org/wiki/Sentinel_node
-// https://en.wikipedia.org/wiki/Sentinel_value
-#define IniSectionImplUseSentinelNode	1
-
+// https://en.wikipedia.org/wiki/Open_addressing
+// hash index of nodeList built by IniSectionParse(), linear probing with load factor at most 50%.
 typedef struct IniSection {
 	int count;
 	int capacity;
-	IniKeyValueNode *head;
-#if IniSectionImplUseSentinelNode
-	IniKeyValueNode *sentinel;
-#endif
+	UINT mask;
 	IniKeyValueNode *nodeList;
+	IniKeyValueNode **hashTable;
 } IniSection;
 
 NP2_inline void IniSectionInit(IniSection *section, int capacity) {
+	UINT size = 16;
+	while (size < 2 * (UINT)capacity) {
+		size <<= 1;
+	}
 	section->count = 0;
 	section->capacity = capacity;
-	section->head = NULL;
-#if IniSectionImplUseSentinelNode
-	section->nodeList = (IniKeyValueNode *)NP2HeapAlloc((capacity + 1) * sizeof(IniKeyValueNode));
-	section->sentinel = &section->nodeList[capacity];
-#else
-	section->nodeList = (IniKeyValueNode *)NP2HeapAlloc(capacity * sizeof(IniKeyValueNode));
-#endif
+	section->mask = size - 1;
+	section->nodeList = (IniKeyValueNode *)NP2HeapAlloc(capacity * sizeof(IniKeyValueNode) + size * sizeof(IniKeyValueNode *));
+	section->hashTable = (IniKeyValueNode **)(section->nodeList + capacity);
 }
 
 NP2_inline void IniSectionFree(IniSection *section) {
@@ -246,7 +240,6 @@ NP2_inline void IniSectionFree(IniSection *section) {
 
 NP2_inline void IniSectionClear(IniSection *section) {
 	section->count = 0;
-	section->head = NULL;
 }
 
 NP2_inline BOOL IniSectionIsEmpty(const IniSection *section) {
@@ -365,6 +358,11 @@ void BackgroundWorker_Destroy(BackgroundWorker *worker);
 #define BackgroundWorker_Continue(worker)	\
 	(WaitForSingleObject((worker)->eventCancel, 0) != WAIT_OBJECT_0)
 
+// startup stage profiler, stages are always recorded, report is only written with /timing.
+void StartupTiming_Start(void);
+void StartupTiming_Mark(LPCSTR stage);
+void StartupTiming_Report(LPCWSTR lpszFile);
+
 HRESULT PrivateSetCurrentProcessExplicitAppUserModelID(PCWSTR AppID);
 BOOL IsElevated(void);
 BOOL ExeNameFromWnd(HWND hwnd, LPWSTR szExeName, int cchExeName);
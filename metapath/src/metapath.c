@@ -71,7 +71,6 @@ static HWND hwndDriveBox;
 HWND	hwndDirList;
 HWND	hwndMain;
 
-static HANDLE hChangeHandle = NULL;
 HISTORY	mHistory;
 
 WCHAR	szIniFile[MAX_PATH] = L"";
@@ -189,6 +188,8 @@ static int	iAutoRefreshRate	= 0; // unit: 1/10 sec
 int			flagNoFadeHidden	= 0;
 static int	iOpacityLevel		= 75;
 static int	flagPosParam		= 0;
+static int	flagStartupTiming	= 0;
+static LPWSTR lpTimingArg = NULL;
 
 static inline BOOL HasFilter(void) {
 	return !StrEqual(tchFilter, L"*.*") || bNegFilter;
@@ -244,6 +245,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	SetEnvironmentVariable(L"UBSAN_OPTIONS", L"log_path=" WC_METAPATH L"-UBSan.log");
 #endif
 
+	StartupTiming_Start();
 	// Set global variable g_hInstance
 	g_hInstance = hInstance;
 #if _WIN32_WINNT < _WIN32_WINNT_VISTA
@@ -263,6 +265,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	TestIniFile();
 	CreateIniFile(szIniFile);
 	LoadFlags();
+	StartupTiming_Mark("FindIniFile, LoadFlags");
 
 	// Try to activate another window
 	if (ActivatePrevInst()) {
@@ -281,6 +284,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	InitCommonControlsEx(&icex);
 
 	msgTaskbarCreated = RegisterWindowMessage(L"TaskbarCreated");
+	StartupTiming_Mark("OleInitialize, InitCommon");
 
 #if NP2_ENABLE_APP_LOCALIZATION_DLL
 	hResDLL = LoadLocalizedResourceDLL(uiLanguage, WC_METAPATH L".dll");
@@ -307,6 +311,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 
 	// Load Settings
 	LoadSettings();
+	StartupTiming_Mark("LoadSettings");
 
 	if (!InitApplication(hInstance)) {
 		CleanUpResources(FALSE);
@@ -316,6 +321,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	InitInstance(hInstance, nShowCmd);
 	HWND hwnd = hwndMain;
 	HACCEL hAcc = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDR_MAINWND));
+	StartupTiming_Mark("InitInstance");
 	MSG msg;
 
 	while (GetMessage(&msg, NULL, 0, 0)) {
@@ -425,6 +431,7 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 				   NULL,
 				   hInstance,
 				   NULL);
+	StartupTiming_Mark("CreateWindow: MainWnd");
 
 	if (bAlwaysOnTop) {
 		SetWindowPos(hwndMain, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
@@ -441,6 +448,7 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 		ShowWindow(hwndMain, SW_HIDE);   // trick ShowWindow()
 		ShowNotifyIcon(hwndMain, TRUE);
 	}
+	StartupTiming_Mark("ShowWindow");
 
 	// Pathname parameter
 	if (lpPathArg) {
@@ -492,7 +500,6 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		if (!bShutdownOK) {
 			// Terminate directory watching
 			KillTimer(hwnd, ID_TIMER);
-			FindCloseChangeNotification(hChangeHandle);
 
 			// GetWindowPlacement
 			WINDOWPLACEMENT wndpl;
@@ -565,15 +572,20 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 	return DefWindowProc(hwnd, umsg, wParam, lParam);
 
 	case WM_TIMER:
-		// Check Change Notification Handle
-		if (WAIT_OBJECT_0 == WaitForSingleObject(hChangeHandle, 0)) {
+		// Check directory changes, apply them in place when possible
+		if (DirList_HasChanged(hwndDirList)) {
+			const int cItems = DirList_ApplyChanges(hwndDirList);
+			if (cItems >= 0) {
+				UpdateStatusItemCount(cItems);
+				break;
+			}
+
 			// Store information about currently selected item
 			DLITEM dli;
 			dli.mask = DLI_ALL;
 			dli.ntype = DLE_NONE;
 			DirList_GetItem(hwndDirList, -1, &dli);
 
-			FindNextChangeNotification(hChangeHandle);
 			SendWMCommand(hwnd, IDM_VIEW_UPDATE);
 
 			// must use SendMessage() !!
@@ -738,6 +750,10 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		}
 		break;
 
+	case APPM_DRIVEBOX_RESOLVED:
+		DriveBox_SetResolved(hwndDriveBox, lParam);
+		break;
+
 	case APPM_CENTER_MESSAGE_BOX: {
 		HWND box = FindWindow(L"#32770", NULL);
 		HWND parent = GetParent(box);
@@ -800,8 +816,10 @@ LRESULT MsgCreate(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 					   hInstance,
 					   NULL);
 
+	StartupTiming_Mark("MsgCreate: CreateWindow");
 	// Create Toolbar and Statusbar
 	CreateBars(hwnd, hInstance);
+	StartupTiming_Mark("MsgCreate: CreateBars");
 
 	// Window Initialization
 	// DriveBox
@@ -816,6 +834,7 @@ LRESULT MsgCreate(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	ListView_SetExtendedListViewStyle(hwndDirList, LVS_EX_DOUBLEBUFFER | LVS_EX_LABELTIP);
 	ListView_InsertColumn(hwndDirList, 0, &lvc);
 	DirList_Init(hwndDirList, NULL);
+	StartupTiming_Mark("MsgCreate: ImageList");
 	if (bTrackSelect) {
 		ListView_SetExtendedListViewStyleEx(hwndDirList,
 											LVS_EX_TRACKSELECT | LVS_EX_ONECLICKACTIVATE,
@@ -1158,6 +1177,7 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	CheckCmd(hmenu, IDM_VIEW_FOLDERS, (dwFillMask & DL_FOLDERS));
 	CheckCmd(hmenu, IDM_VIEW_FILES, (dwFillMask & DL_NONFOLDERS));
 	CheckCmd(hmenu, IDM_VIEW_HIDDEN, (dwFillMask & DL_INCLHIDDEN));
+	CheckCmd(hmenu, IDM_VIEW_RECURSIVE, (dwFillMask & DL_RECURSIVE));
 
 	EnableCmd(hmenu, IDM_VIEW_FILTERALL, HasFilter());
 
@@ -1533,17 +1553,19 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		SHFileOperation(&shfos);
 
 		// Check if there are any changes in the directory, then update!
-		if (WAIT_OBJECT_0 == WaitForSingleObject(hChangeHandle, 0)) {
-
-			SendWMCommand(hwnd, IDM_VIEW_UPDATE);
+		if (DirList_HasChanged(hwndDirList)) {
+			const int cItems = DirList_ApplyChanges(hwndDirList);
+			if (cItems < 0) {
+				SendWMCommand(hwnd, IDM_VIEW_UPDATE);
+			} else {
+				UpdateStatusItemCount(cItems);
+			}
 			if (iItem > 0) {
 				iItem--;
 			}
 			iItem = min_i(iItem, ListView_GetItemCount(hwndDirList) - 1);
 			ListView_SetItemState(hwndDirList, iItem, LVIS_FOCUSED, LVIS_FOCUSED);
 			ListView_EnsureVisible(hwndDirList, iItem, FALSE);
-
-			FindNextChangeNotification(hChangeHandle);
 		}
 	}
 	break;
@@ -1635,6 +1657,16 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		ListView_EnsureVisible(hwndDirList, 0, FALSE); // not done by update
 		break;
 
+	case IDM_VIEW_RECURSIVE:
+		if (dwFillMask & DL_RECURSIVE) {
+			dwFillMask &= (~DL_RECURSIVE);
+		} else {
+			dwFillMask |= DL_RECURSIVE;
+		}
+		SendWMCommand(hwnd, IDM_VIEW_UPDATE);
+		ListView_EnsureVisible(hwndDirList, 0, FALSE); // not done by update
+		break;
+
 	case IDM_VIEW_FILTER:
 		if (GetFilterDlg(hwnd)) {
 			// Store information about currently selected item
@@ -2109,9 +2141,8 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 			DirList_GetDispInfo(hwndDirList, lParam, flagNoFadeHidden);
 			break;
 
-		case LVN_DELETEITEM:
-			DirList_DeleteItem(hwndDirList, lParam);
-			break;
+		case LVN_ODFINDITEM:
+			return DirList_FindItem(hwndDirList, lParam);
 
 		case LVN_BEGINDRAG:
 		case LVN_BEGINRDRAG:
@@ -2197,10 +2228,6 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 	case IDC_DRIVEBOX:
 		switch (pnmh->code) {
-		case CBEN_GETDISPINFO:
-			DriveBox_GetDispInfo(hwndDriveBox, lParam);
-			break;
-
 		case CBEN_DELETEITEM:
 			DriveBox_DeleteItem(hwndDriveBox, lParam);
 			break;
@@ -2255,6 +2282,31 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	return 0;
 }
 
+//=============================================================================
+//
+//  UpdateStatusItemCount()
+//
+//
+void UpdateStatusItemCount(int cItems) {
+	WCHAR tch[256];
+	WCHAR tchnum[64];
+	_ltow(cItems, tchnum, 10);
+	FormatNumberStr(tchnum);
+	WCHAR fmt[64];
+	FormatString(tch, fmt, HasFilter() ? IDS_NUMFILES_FILTER : IDS_NUMFILES, tchnum);
+	StatusSetText(hwndStatus, ID_FILEINFO, tch);
+}
+
+static void ReportStartupTiming(void) {
+	flagStartupTiming = 0;
+	StartupTiming_Mark("ChangeDirectory");
+	StartupTiming_Report(lpTimingArg);
+	if (lpTimingArg) {
+		NP2HeapFree(lpTimingArg);
+		lpTimingArg = NULL;
+	}
+}
+
 //=============================================================================
 //
 //  ChangeDirectory()
@@ -2294,7 +2346,11 @@ BOOL ChangeDirectory(HWND hwnd, LPCWSTR lpszNewDir, BOOL bUpdateHistory) {
 			Toolbar_SetButtonImage(hwndToolbar, IDT_VIEW_FILTER, TB_ADD_FILTER_BMP);
 		}
 
-		const int cItems = DirList_Fill(hwndDirList, szCurDir, dwFillMask, tchFilter, bNegFilter, flagNoFadeHidden, nSortFlags, fSortRev);
+		// reuse listing of recently visited directory when it's unchanged
+		int cItems = fUpdate ? DirList_FillFromCache(hwndDirList, szCurDir, dwFillMask, tchFilter, bNegFilter, flagNoFadeHidden, nSortFlags, fSortRev) : -1;
+		if (cItems < 0) {
+			cItems = DirList_Fill(hwndDirList, szCurDir, dwFillMask, tchFilter, bNegFilter, flagNoFadeHidden, nSortFlags, fSortRev);
+		}
 		DirList_StartIconThread(hwndDirList);
 
 		// Get long pathname
@@ -2314,25 +2370,17 @@ BOOL ChangeDirectory(HWND hwnd, LPCWSTR lpszNewDir, BOOL bUpdateHistory) {
 			ListView_EnsureVisible(hwndDirList, iTopItem, TRUE);
 		}
 
-		// setup new change notification handle
-		FindCloseChangeNotification(hChangeHandle);
-		hChangeHandle = FindFirstChangeNotification(szCurDir, FALSE,
-						FILE_NOTIFY_CHANGE_FILE_NAME  | \
-						FILE_NOTIFY_CHANGE_DIR_NAME   | \
-						FILE_NOTIFY_CHANGE_ATTRIBUTES | \
-						FILE_NOTIFY_CHANGE_SIZE | \
-						FILE_NOTIFY_CHANGE_LAST_WRITE);
+		// watch changes of new directory
+		DirList_StartWatch(hwndDirList);
 
 		DriveBox_Fill(hwndDriveBox);
 		DriveBox_SelectDrive(hwndDriveBox, szCurDir);
 
-		WCHAR tch[256];
-		WCHAR tchnum[64];
-		_ltow(cItems, tchnum, 10);
-		FormatNumberStr(tchnum);
-		WCHAR fmt[64];
-		FormatString(tch, fmt, HasFilter() ? IDS_NUMFILES_FILTER : IDS_NUMFILES, tchnum);
-		StatusSetText(hwndStatus, ID_FILEINFO, tch);
+		UpdateStatusItemCount(cItems);
+		if (flagStartupTiming) {
+			// first listing is shown, remaining work (icons, drive box) is done in background
+			ReportStartupTiming();
+		}
 
 		// Update History
 		if (bUpdateHistory) {
@@ -2727,7 +2775,7 @@ void SaveSettings(BOOL bSaveSettingsNow) {
 	IniSectionSetStringEx(pIniSection, L"QuikviewParams", szQuickviewParams, L"");
 	PathRelativeToApp(tchOpenWithDir, wchTmp, COUNTOF(wchTmp), FALSE, TRUE, flagPortableMyDocs);
 	IniSectionSetString(pIniSection, L"OpenWithDir", wchTmp);
-	IniSectionSetIntEx(pIniSection, L"FillMask", dwFillMask, DL_ALLOBJECTS);
+	IniSectionSetIntEx(pIniSection, L"FillMask", dwFillMask & DL_ALLOBJECTS, DL_ALLOBJECTS);
 	IniSectionSetIntEx(pIniSection, L"SortOptions", nSortFlags, DS_NAME);
 	IniSectionSetBoolEx(pIniSection, L"SortReverse", fSortRev, 0);
 	IniSectionSetStringEx(pIniSection, L"FileFilter", tchFilter, L"*.*");
@@ -2913,6 +2961,20 @@ int ParseCommandLineOption(LPWSTR lp1, LPWSTR lp2) {
 		default:
 			break;
 		}
+	} else if (StrCaseEqual(opt, L"timing")) {
+		flagStartupTiming = 1;
+		state = 1;
+	} else if (StrHasPrefixCase(opt, L"timing=")) {
+		// append report to specified file instead of console,
+		// resolved now since current directory is changed later.
+		opt += CSTRLEN(L"timing=");
+		StrTrim(opt, L"\" ");
+		if (lpTimingArg == NULL) {
+			lpTimingArg = (LPWSTR)NP2HeapAlloc(sizeof(WCHAR) * MAX_PATH);
+		}
+		GetFullPathName(opt, MAX_PATH, lpTimingArg, NULL);
+		flagStartupTiming = 1;
+		state = 1;
 	}
 
 	return state;
@@ -48,6 +48,7 @@
 					LVS_NOCOLUMNHEADER | \
 					LVS_SHAREIMAGELISTS | \
 					LVS_AUTOARRANGE | \
+					LVS_OWNERDATA | \
 					LVS_SINGLESEL | \
 					LVS_SHOWSELALWAYS)
 
@@ -112,6 +113,7 @@ BOOL ActivatePrevInst(void);
 void GetRelaunchParameters(LPWSTR szParameters);
 void ShowNotifyIcon(HWND hwnd, BOOL bAdd);
 
+void UpdateStatusItemCount(int cItems);
 BOOL ChangeDirectory(HWND hwnd, LPCWSTR lpszNewDir, BOOL bUpdateHistory);
 void SetUILanguage(int resID);
 void LoadSettings(void);
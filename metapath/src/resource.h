@@ -199,6 +199,7 @@
 #define IDM_VIEW_OPTIONS				40216
 #define IDM_VIEW_ALWAYSONTOP			40217
 #define IDM_VIEW_ABOUT					40218
+#define IDM_VIEW_RECURSIVE				40219
 #define IDM_SORT_NAME					40301
 #define IDM_SORT_SIZE					40302
 #define IDM_SORT_TYPE					40303
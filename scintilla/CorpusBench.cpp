@@ -0,0 +1,453 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//! Standard editing operations over the large document corpus generated by tools/PerfCorpus.py.
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include <windows.h>
+
+#include "ScintillaTypes.h"
+#include "ScintillaMessages.h"
+#include "ScintillaCall.h"
+#include "Scintilla.h"
+#include "SciLexer.h"
+
+// Corpus files are named workload.encoding.extension, e.g. log.utf8.log, mixed.cp936.txt, where
+// encoding is utf8, utf16le or cpNNN for an ANSI code page, extension selects the lexer.
+// Operations, each is run on a freshly loaded document and timed as best of all runs:
+// open         read the file, convert it to UTF-8 like Notepad2 does for UTF-16 and ANSI code pages,
+//              then SetText().
+// find-all     SearchInTarget() loop over the whole document, each match is marked with an indicator
+//              (like EditMarkAll()).
+// replace-all  SearchInTarget() + ReplaceTarget() loop (like EditReplaceAll()).
+// sort         sort all lines ascending and replace the whole document (like EditSortLines()).
+// wrap         word wrap all lines at window width.
+// fold-all     lex and fold the whole document, then collapse all folds (like FoldToggleAll()).
+// save         convert to the file's encoding and write it into a temporary file.
+// Every corpus file contains the marker used by find-all and replace-all.
+// Output of -json is the input of `PerfCorpus.py compare baseline.json result.json`.
+// The 1 GiB log needs a 64-bit build.
+
+// cl /EHsc /std:c++17 /DNDEBUG /DUNICODE /D_UNICODE /Ox /Ot /GS- /GR- /W4 /Iinclude /Isrc /Ilexlib /Iwin32 CorpusBench.cpp call\ScintillaCall.cxx src\*.cxx win32\*.cxx lexlib\*.cxx lexers\*.cxx user32.lib gdi32.lib imm32.lib ole32.lib oleaut32.lib uuid.lib msimg32.lib shlwapi.lib comctl32.lib
+// g++ -std=gnu++17 -DNDEBUG -DUNICODE -D_UNICODE -O2 -Iinclude -Isrc -Ilexlib -Iwin32 CorpusBench.cpp call/ScintillaCall.cxx src/*.cxx win32/*.cxx lexlib/*.cxx lexers/*.cxx -limm32 -lole32 -loleaut32 -luuid -lmsimg32 -lshlwapi -lcomctl32 -lgdi32 -o CorpusBench
+// usage: CorpusBench [-json] [-repeat count] [-op name] [-file name] corpus
+
+using namespace Scintilla;
+
+namespace {
+
+struct BenchOptions {
+	bool json = false;
+	int repeat = 3;
+	const char *operation = nullptr;
+	const char *file = nullptr;
+	const char *corpus = nullptr;
+};
+
+// same as marker in tools/PerfCorpus.py
+constexpr std::string_view findText = "np2mark";
+constexpr std::string_view replaceText = "np2_replaced_mark";
+constexpr UINT CodePageUTF16LE = 1200;
+
+struct CorpusFile {
+	std::filesystem::path path;
+	std::string name;
+	UINT codePage = CP_UTF8;
+	int lexer = SCLEX_NULL;
+};
+
+bool ParseCorpusFile(const std::filesystem::path &path, CorpusFile &file) {
+	file.path = path;
+	file.name = path.filename().string();
+	const size_t first = file.name.find('.');
+	const size_t last = file.name.rfind('.');
+	if (first == std::string::npos || first == last) {
+		return false;
+	}
+
+	const std::string encoding = file.name.substr(first + 1, last - first - 1);
+	if (encoding == "utf8") {
+		file.codePage = CP_UTF8;
+	} else if (encoding == "utf16le") {
+		file.codePage = CodePageUTF16LE;
+	} else if (encoding.size() > 2 && encoding.compare(0, 2, "cp") == 0) {
+		file.codePage = static_cast<UINT>(atoi(encoding.c_str() + 2));
+	} else {
+		return false;
+	}
+
+	const std::string extension = file.name.substr(last + 1);
+	if (extension == "js") {
+		file.lexer = SCLEX_JAVASCRIPT;
+	} else if (extension == "json") {
+		file.lexer = SCLEX_JSON;
+	} else if (extension == "xml") {
+		file.lexer = SCLEX_XML;
+	} else {
+		file.lexer = SCLEX_NULL;
+	}
+	return true;
+}
+
+std::string ReadFileData(const std::filesystem::path &path) {
+	std::string data;
+	FILE *fp = _wfopen(path.c_str(), L"rb");
+	if (fp == nullptr) {
+		return data;
+	}
+	std::error_code ec;
+	data.reserve(static_cast<size_t>(std::filesystem::file_size(path, ec)));
+	char buffer[1024*1024];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), fp)) != 0) {
+		data.append(buffer, count);
+	}
+	fclose(fp);
+	return data;
+}
+
+std::string WideToUTF8(const wchar_t *wide, size_t length) {
+	std::string text;
+	const int len = ::WideCharToMultiByte(CP_UTF8, 0, wide, static_cast<int>(length), nullptr, 0, nullptr, nullptr);
+	text.resize(len);
+	::WideCharToMultiByte(CP_UTF8, 0, wide, static_cast<int>(length), text.data(), len, nullptr, nullptr);
+	return text;
+}
+
+std::wstring UTF8ToWide(const char *text, size_t length) {
+	std::wstring wide;
+	const int len = ::MultiByteToWideChar(CP_UTF8, 0, text, static_cast<int>(length), nullptr, 0);
+	wide.resize(len);
+	::MultiByteToWideChar(CP_UTF8, 0, text, static_cast<int>(length), wide.data(), len);
+	return wide;
+}
+
+std::string DecodeText(std::string &&data, UINT codePage) {
+	if (codePage == CP_UTF8) {
+		return std::move(data);
+	}
+	if (codePage == CodePageUTF16LE) {
+		const size_t offset = (data.size() >= 2 && data[0] == '\xFF' && data[1] == '\xFE') ? 2 : 0;
+		return WideToUTF8(reinterpret_cast<const wchar_t *>(data.data() + offset), (data.size() - offset)/sizeof(wchar_t));
+	}
+	std::wstring wide;
+	const int len = ::MultiByteToWideChar(codePage, 0, data.data(), static_cast<int>(data.size()), nullptr, 0);
+	wide.resize(len);
+	::MultiByteToWideChar(codePage, 0, data.data(), static_cast<int>(data.size()), wide.data(), len);
+	return WideToUTF8(wide.data(), wide.size());
+}
+
+std::string EncodeText(const char *text, size_t length, UINT codePage) {
+	if (codePage == CP_UTF8) {
+		return std::string(text, length);
+	}
+	const std::wstring wide = UTF8ToWide(text, length);
+	std::string data;
+	if (codePage == CodePageUTF16LE) {
+		data.reserve(2 + wide.size()*sizeof(wchar_t));
+		data.append("\xFF\xFE");
+		data.append(reinterpret_cast<const char *>(wide.data()), wide.size()*sizeof(wchar_t));
+		return data;
+	}
+	const int len = ::WideCharToMultiByte(codePage, 0, wide.data(), static_cast<int>(wide.size()), nullptr, 0, nullptr, nullptr);
+	data.resize(len);
+	::WideCharToMultiByte(codePage, 0, wide.data(), static_cast<int>(wide.size()), data.data(), len, nullptr, nullptr);
+	return data;
+}
+
+double ElapsedSeconds(std::chrono::steady_clock::time_point start) noexcept {
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return duration.count();
+}
+
+class EditorWindow {
+	HWND hwnd = nullptr;
+public:
+	ScintillaCall call;
+
+	explicit EditorWindow(HINSTANCE hInstance) noexcept {
+		hwnd = ::CreateWindowEx(0, L"Scintilla", nullptr, WS_OVERLAPPEDWINDOW,
+			0, 0, 1280, 800, nullptr, nullptr, hInstance, nullptr);
+		if (hwnd) {
+			const FunctionDirect fn = reinterpret_cast<FunctionDirect>(::SendMessage(hwnd, static_cast<UINT>(Message::GetDirectStatusFunction), 0, 0));
+			const intptr_t ptr = ::SendMessage(hwnd, static_cast<UINT>(Message::GetDirectPointer), 0, 0);
+			call.SetFnPtr(fn, ptr);
+		}
+	}
+	EditorWindow(const EditorWindow &) = delete;
+	EditorWindow &operator=(const EditorWindow &) = delete;
+	~EditorWindow() {
+		if (hwnd) {
+			::DestroyWindow(hwnd);
+		}
+	}
+	bool Valid() const noexcept {
+		return call.IsValid();
+	}
+	void Load(const CorpusFile &file, const std::string &text) {
+		call.SetUndoCollection(false);
+		call.SetWrapMode(Wrap::None);
+		call.ClearAll();
+		call.SetLexer(file.lexer);
+		call.SetProperty("fold", "1");
+		call.SetText(text.c_str());
+		call.SetUndoCollection(true);
+		call.EmptyUndoBuffer();
+		call.SetEmptySelection(0);
+	}
+	std::string_view Text() {
+		const Position length = call.Length();
+		return std::string_view(static_cast<const char *>(call.CharacterPointer()), length);
+	}
+};
+
+double RunOpen(const CorpusFile &file, EditorWindow &editor) {
+	editor.Load(file, std::string());
+	const auto start = std::chrono::steady_clock::now();
+	const std::string text = DecodeText(ReadFileData(file.path), file.codePage);
+	editor.call.SetText(text.c_str());
+	return ElapsedSeconds(start);
+}
+
+double RunFindAll(EditorWindow &editor) {
+	const auto start = std::chrono::steady_clock::now();
+	editor.call.SetSearchFlags(FindOption::MatchCase);
+	editor.call.SetIndicatorCurrent(INDICATOR_CONTAINER);
+	const Position length = editor.call.Length();
+	editor.call.SetTargetRange(0, length);
+	while (editor.call.SearchInTarget(findText) >= 0) {
+		const Position matchStart = editor.call.TargetStart();
+		const Position matchEnd = editor.call.TargetEnd();
+		editor.call.IndicatorFillRange(matchStart, matchEnd - matchStart);
+		editor.call.SetTargetRange(matchEnd, length);
+	}
+	return ElapsedSeconds(start);
+}
+
+double RunReplaceAll(EditorWindow &editor) {
+	const auto start = std::chrono::steady_clock::now();
+	editor.call.SetSearchFlags(FindOption::MatchCase);
+	editor.call.BeginUndoAction();
+	editor.call.SetTargetRange(0, editor.call.Length());
+	while (editor.call.SearchInTarget(findText) >= 0) {
+		const Position end = editor.call.TargetEnd();
+		editor.call.ReplaceTarget(replaceText);
+		const Position next = end + static_cast<Position>(replaceText.length() - findText.length());
+		editor.call.SetTargetRange(next, editor.call.Length());
+	}
+	editor.call.EndUndoAction();
+	return ElapsedSeconds(start);
+}
+
+double RunSort(EditorWindow &editor) {
+	const auto start = std::chrono::steady_clock::now();
+	const std::string_view text = editor.Text();
+	std::vector<std::string_view> lines;
+	size_t lineStart = 0;
+	while (lineStart < text.length()) {
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos) {
+			lineEnd = text.length();
+		}
+		lines.push_back(text.substr(lineStart, lineEnd - lineStart));
+		lineStart = lineEnd + 1;
+	}
+	std::stable_sort(lines.begin(), lines.end());
+	std::string sorted;
+	sorted.reserve(text.length() + 1);
+	for (const std::string_view line : lines) {
+		sorted.append(line);
+		sorted.push_back('\n');
+	}
+	editor.call.TargetWholeDocument();
+	editor.call.ReplaceTarget(sorted);
+	return ElapsedSeconds(start);
+}
+
+double RunWrap(EditorWindow &editor) {
+	const auto start = std::chrono::steady_clock::now();
+	editor.call.SetWrapMode(Wrap::Word);
+	// wraps all pending lines before the last line is made visible
+	editor.call.EnsureVisible(editor.call.LineCount() - 1);
+	const double duration = ElapsedSeconds(start);
+	editor.call.SetWrapMode(Wrap::None);
+	return duration;
+}
+
+double RunFoldAll(EditorWindow &editor) {
+	const auto start = std::chrono::steady_clock::now();
+	// styles the whole document before folding
+	editor.call.FoldAll(FoldAction::Contract);
+	const double duration = ElapsedSeconds(start);
+	editor.call.FoldAll(FoldAction::Expand);
+	return duration;
+}
+
+double RunSave(const CorpusFile &file, EditorWindow &editor, const std::filesystem::path &savePath) {
+	const auto start = std::chrono::steady_clock::now();
+	const std::string_view text = editor.Text();
+	const std::string data = EncodeText(text.data(), text.length(), file.codePage);
+	FILE *fp = _wfopen(savePath.c_str(), L"wb");
+	if (fp != nullptr) {
+		fwrite(data.data(), 1, data.size(), fp);
+		fclose(fp);
+	}
+	const double duration = ElapsedSeconds(start);
+	std::error_code ec;
+	std::filesystem::remove(savePath, ec);
+	return duration;
+}
+
+constexpr const char *operationNames[] = {
+	"open", "find-all", "replace-all", "sort", "wrap", "fold-all", "save",
+};
+
+bool Selected(const char *filter, std::string_view name) noexcept {
+	return filter == nullptr || name == filter;
+}
+
+void PrintResult(const BenchOptions &options, const CorpusFile &file, const char *operation, uintmax_t bytes, double seconds) {
+	const double rate = (seconds > 0) ? bytes/(1024*1024*seconds) : 0;
+	if (options.json) {
+		printf("{\"file\": \"%s\", \"op\": \"%s\", \"bytes\": %ju, \"ms\": %.3f, \"MiBps\": %.2f},\n",
+			file.name.c_str(), operation, bytes, seconds*1000, rate);
+	} else {
+		printf("%-24s %-12s %12ju %12.3f %10.2f\n", file.name.c_str(), operation, bytes, seconds*1000, rate);
+	}
+	fflush(stdout);
+}
+
+void RunCorpusFile(const BenchOptions &options, const CorpusFile &file, EditorWindow &editor) {
+	std::error_code ec;
+	const uintmax_t bytes = std::filesystem::file_size(file.path, ec);
+	const std::string text = DecodeText(ReadFileData(file.path), file.codePage);
+	const std::filesystem::path savePath = std::filesystem::temp_directory_path(ec) / (file.name + ".save");
+
+	for (const char *operation : operationNames) {
+		if (!Selected(options.operation, operation)) {
+			continue;
+		}
+		double best = 1e9;
+		for (int i = 0; i < options.repeat; i++) {
+			const std::string_view name = operation;
+			double duration = 0;
+			if (name == "open") {
+				duration = RunOpen(file, editor);
+			} else {
+				editor.Load(file, text);
+				if (name == "find-all") {
+					duration = RunFindAll(editor);
+				} else if (name == "replace-all") {
+					duration = RunReplaceAll(editor);
+				} else if (name == "sort") {
+					duration = RunSort(editor);
+				} else if (name == "wrap") {
+					duration = RunWrap(editor);
+				} else if (name == "fold-all") {
+					duration = RunFoldAll(editor);
+				} else {
+					duration = RunSave(file, editor, savePath);
+				}
+			}
+			best = std::min(best, duration);
+		}
+		PrintResult(options, file, operation, bytes, best);
+	}
+	editor.Load(file, std::string());
+}
+
+bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (strcmp(arg, "-json") == 0) {
+			options.json = true;
+		} else if (strcmp(arg, "-repeat") == 0 && i + 1 < argc) {
+			options.repeat = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-op") == 0 && i + 1 < argc) {
+			options.operation = argv[++i];
+		} else if (strcmp(arg, "-file") == 0 && i + 1 < argc) {
+			options.file = argv[++i];
+		} else if (arg[0] != '-' && options.corpus == nullptr) {
+			options.corpus = arg;
+		} else {
+			return false;
+		}
+	}
+	return options.corpus != nullptr;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options)) {
+		fprintf(stderr, "usage: %s [-json] [-repeat count] [-op open|find-all|replace-all|sort|wrap|fold-all|save] [-file name] corpus\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<CorpusFile> files;
+	std::error_code ec;
+	for (const auto &entry : std::filesystem::directory_iterator(options.corpus, ec)) {
+		CorpusFile file;
+		if (entry.is_regular_file() && ParseCorpusFile(entry.path(), file) && Selected(options.file, file.name)) {
+			files.push_back(std::move(file));
+		}
+	}
+	if (ec) {
+		fprintf(stderr, "read %s fail: %s\n", options.corpus, ec.message().c_str());
+		return EXIT_FAILURE;
+	}
+	std::sort(files.begin(), files.end(), [](const CorpusFile &lhs, const CorpusFile &rhs) {
+		return lhs.name < rhs.name;
+	});
+
+	// stable timing: run on one CPU with high priority
+	::SetProcessAffinityMask(::GetCurrentProcess(), 1);
+	::SetPriorityClass(::GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+	::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+	HINSTANCE hInstance = ::GetModuleHandle(nullptr);
+	Scintilla_LoadDpiForWindow();
+	Scintilla_RegisterClasses(hInstance);
+
+	int status = EXIT_SUCCESS;
+	{
+		EditorWindow editor(hInstance);
+		if (!editor.Valid()) {
+			fprintf(stderr, "create Scintilla window fail: %lu\n", ::GetLastError());
+			return EXIT_FAILURE;
+		}
+		editor.call.SetCodePage(SC_CP_UTF8);
+
+		if (options.json) {
+			printf("[\n");
+		} else {
+			printf("%-24s %-12s %12s %12s %10s\n", "file", "op", "bytes", "ms", "MiB/s");
+		}
+		try {
+			for (const CorpusFile &file : files) {
+				RunCorpusFile(options, file, editor);
+			}
+		} catch (const Failure &failure) {
+			fprintf(stderr, "Scintilla call fail: %d\n", static_cast<int>(failure.status));
+			status = EXIT_FAILURE;
+		}
+		if (options.json) {
+			printf("{\"file\": \"end\"}\n]\n");
+		}
+	}
+
+	Scintilla_ReleaseResources();
+	return status;
+}
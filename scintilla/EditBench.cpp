@@ -0,0 +1,359 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//! Headless editing benchmark, scripts a hidden Scintilla window through ScintillaCall.
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <chrono>
+
+#include <windows.h>
+
+#include "ScintillaTypes.h"
+#include "ScintillaMessages.h"
+#include "ScintillaCall.h"
+#include "Scintilla.h"
+
+// Workloads, run against a synthetic source like document:
+// load         SetText() of the whole document, throughput is MiB/s.
+// typing       WM_CHAR at random positions, each keystroke is one sample.
+// replace-all  SearchInTarget() + ReplaceTarget() loop over the whole document (like EditReplaceAll()),
+//              each pass is one sample.
+// multi-caret  WM_CHAR with one caret on each of many lines, each keystroke is one sample.
+// undo / redo  Undo() then Redo() of separate ReplaceSel() actions, each call is one sample.
+// Latency percentiles are in microseconds over all samples, rate is samples (or MiB) per second.
+// Covers CellBuffer, Document and UndoHistory end to end, including notifications and layout
+// invalidation done by the editor for each change.
+
+// cl /EHsc /std:c++17 /DNDEBUG /DUNICODE /D_UNICODE /Ox /Ot /GS- /GR- /W4 /Iinclude /Isrc /Ilexlib /Iwin32 EditBench.cpp call\ScintillaCall.cxx src\*.cxx win32\*.cxx lexlib\*.cxx lexers\*.cxx user32.lib gdi32.lib imm32.lib ole32.lib oleaut32.lib uuid.lib msimg32.lib shlwapi.lib comctl32.lib
+// g++ -std=gnu++17 -DNDEBUG -DUNICODE -D_UNICODE -O2 -Iinclude -Isrc -Ilexlib -Iwin32 EditBench.cpp call/ScintillaCall.cxx src/*.cxx win32/*.cxx lexlib/*.cxx lexers/*.cxx -limm32 -lole32 -loleaut32 -luuid -lmsimg32 -lshlwapi -lcomctl32 -lgdi32 -o EditBench
+// usage: EditBench [-json] [-repeat count] [-size MiB] [-ops count] [-case name]
+
+using namespace Scintilla;
+
+namespace {
+
+struct BenchOptions {
+	bool json = false;
+	int repeat = 5;
+	size_t size = 16*1024*1024;
+	int operations = 10000;
+	const char *filter = nullptr;
+};
+
+constexpr int caretCount = 100;
+
+// xorshift32, same sequence on every run and every compiler
+struct Random {
+	uint32_t state = 0x2545F491;
+	uint32_t Next(uint32_t range) noexcept {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state % range;
+	}
+};
+
+std::string MakeDocument(size_t size) {
+	static constexpr const char *words[] = {
+		"if", "else", "for", "while", "return", "int", "const", "auto", "value", "index",
+		"count", "buffer", "length", "position", "style", "line", "text", "result", "foo", "bar",
+	};
+	static constexpr const char *separators[] = { " ", " ", " ", ", ", "(", ") ", " = ", "; ", ".", "->" };
+	Random random;
+	std::string text;
+	text.reserve(size + 128);
+	while (text.size() < size) {
+		const uint32_t indent = random.Next(4);
+		text.append(indent*4, ' ');
+		const uint32_t wordCount = 3 + random.Next(10);
+		for (uint32_t i = 0; i < wordCount; i++) {
+			text += words[random.Next(static_cast<uint32_t>(std::size(words)))];
+			text += separators[random.Next(static_cast<uint32_t>(std::size(separators)))];
+		}
+		text.push_back('\n');
+	}
+	return text;
+}
+
+double ElapsedSeconds(std::chrono::steady_clock::time_point start) noexcept {
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return duration.count();
+}
+
+// samples in seconds
+struct Samples {
+	std::vector<double> values;
+	double total = 0;
+	void Add(double seconds) {
+		values.push_back(seconds);
+		total += seconds;
+	}
+	double Percentile(double percent) {
+		if (values.empty()) {
+			return 0;
+		}
+		const size_t index = std::min(values.size() - 1, static_cast<size_t>(percent*values.size()/100));
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return values[index];
+	}
+};
+
+bool Selected(const BenchOptions &options, const char *name) noexcept {
+	return options.filter == nullptr || strcmp(options.filter, name) == 0;
+}
+
+// rate is items per second, or MiB per second when bytes is not zero
+void PrintResult(const BenchOptions &options, const char *name, Samples &samples, size_t bytes = 0) {
+	const size_t count = samples.values.size();
+	double rate = 0;
+	if (samples.total > 0) {
+		rate = (bytes != 0) ? bytes/(1024*1024*samples.total) : count/samples.total;
+	}
+	const double p50 = samples.Percentile(50)*1e6;
+	const double p90 = samples.Percentile(90)*1e6;
+	const double p99 = samples.Percentile(99)*1e6;
+	const double maximum = samples.Percentile(100)*1e6;
+	if (options.json) {
+		printf("{\"case\": \"%s\", \"samples\": %zu, \"ms\": %.3f, \"%s\": %.2f, \"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f},\n",
+			name, count, samples.total*1000, (bytes != 0) ? "MiBps" : "ops", rate, p50, p90, p99, maximum);
+	} else {
+		printf("%-12s %8zu %10.3f %12.2f%s %10.3f %10.3f %10.3f %10.3f\n",
+			name, count, samples.total*1000, rate, (bytes != 0) ? "M" : " ", p50, p90, p99, maximum);
+	}
+}
+
+class EditorWindow {
+	HWND hwnd = nullptr;
+public:
+	ScintillaCall call;
+
+	explicit EditorWindow(HINSTANCE hInstance) noexcept {
+		hwnd = ::CreateWindowEx(0, L"Scintilla", nullptr, WS_OVERLAPPEDWINDOW,
+			0, 0, 1280, 800, nullptr, nullptr, hInstance, nullptr);
+		if (hwnd) {
+			const FunctionDirect fn = reinterpret_cast<FunctionDirect>(::SendMessage(hwnd, static_cast<UINT>(Message::GetDirectStatusFunction), 0, 0));
+			const intptr_t ptr = ::SendMessage(hwnd, static_cast<UINT>(Message::GetDirectPointer), 0, 0);
+			call.SetFnPtr(fn, ptr);
+		}
+	}
+	EditorWindow(const EditorWindow &) = delete;
+	EditorWindow &operator=(const EditorWindow &) = delete;
+	~EditorWindow() {
+		if (hwnd) {
+			::DestroyWindow(hwnd);
+		}
+	}
+	bool Valid() const noexcept {
+		return call.IsValid();
+	}
+	// typed character goes through Editor::InsertCharacter() like keyboard input
+	void Type(char ch) const noexcept {
+		::SendMessage(hwnd, WM_CHAR, static_cast<unsigned char>(ch), 0);
+	}
+	void Reset(const std::string &text) {
+		call.SetUndoCollection(false);
+		call.ClearAll();
+		call.SetText(text.c_str());
+		call.SetUndoCollection(true);
+		call.EmptyUndoBuffer();
+		call.SetEmptySelection(0);
+	}
+};
+
+void BenchLoad(const BenchOptions &options, EditorWindow &editor, const std::string &text) {
+	Samples samples;
+	editor.call.SetUndoCollection(false);
+	for (int i = 0; i < options.repeat; i++) {
+		editor.call.ClearAll();
+		const auto start = std::chrono::steady_clock::now();
+		editor.call.SetText(text.c_str());
+		samples.Add(ElapsedSeconds(start));
+	}
+	editor.call.SetUndoCollection(true);
+	PrintResult(options, "load", samples, text.size()*samples.values.size());
+}
+
+void BenchTyping(const BenchOptions &options, EditorWindow &editor, const std::string &text) {
+	Samples samples;
+	Random random;
+	for (int i = 0; i < options.repeat; i++) {
+		editor.Reset(text);
+		for (int op = 0; op < options.operations; op++) {
+			const Position length = editor.call.Length();
+			editor.call.GotoPos(random.Next(static_cast<uint32_t>(length)));
+			const char ch = static_cast<char>('a' + random.Next(26));
+			const auto start = std::chrono::steady_clock::now();
+			editor.Type(ch);
+			samples.Add(ElapsedSeconds(start));
+		}
+	}
+	PrintResult(options, "typing", samples);
+}
+
+void BenchReplaceAll(const BenchOptions &options, EditorWindow &editor, const std::string &text) {
+	constexpr std::string_view find = "foo";
+	constexpr std::string_view replace = "foo_bar";
+	Samples samples;
+	for (int i = 0; i < options.repeat; i++) {
+		editor.Reset(text);
+		const auto start = std::chrono::steady_clock::now();
+		editor.call.SetSearchFlags(FindOption::MatchCase | FindOption::WholeWord);
+		editor.call.BeginUndoAction();
+		editor.call.SetTargetRange(0, editor.call.Length());
+		while (editor.call.SearchInTarget(find) >= 0) {
+			const Position end = editor.call.TargetEnd();
+			editor.call.ReplaceTarget(replace);
+			const Position next = end + static_cast<Position>(replace.length() - find.length());
+			editor.call.SetTargetRange(next, editor.call.Length());
+		}
+		editor.call.EndUndoAction();
+		samples.Add(ElapsedSeconds(start));
+	}
+	PrintResult(options, "replace-all", samples, text.size()*samples.values.size());
+}
+
+void BenchMultiCaret(const BenchOptions &options, EditorWindow &editor, const std::string &text) {
+	Samples samples;
+	Random random;
+	editor.call.SetMultipleSelection(true);
+	editor.call.SetAdditionalSelectionTyping(true);
+	for (int i = 0; i < options.repeat; i++) {
+		editor.Reset(text);
+		const Line lineCount = editor.call.LineCount();
+		const Line firstLine = random.Next(static_cast<uint32_t>(std::max<Line>(lineCount - caretCount*2, 1)));
+		for (int caret = 0; caret < caretCount; caret++) {
+			const Position position = editor.call.LineEnd(std::min(firstLine + caret*2, lineCount - 1));
+			if (caret == 0) {
+				editor.call.SetSelection(position, position);
+			} else {
+				editor.call.AddSelection(position, position);
+			}
+		}
+		const int keystrokes = std::max(options.operations / caretCount, 1);
+		for (int op = 0; op < keystrokes; op++) {
+			const char ch = static_cast<char>('a' + random.Next(26));
+			const auto start = std::chrono::steady_clock::now();
+			editor.Type(ch);
+			samples.Add(ElapsedSeconds(start));
+		}
+	}
+	editor.call.SetEmptySelection(0);
+	editor.call.SetMultipleSelection(false);
+	PrintResult(options, "multi-caret", samples);
+}
+
+void BenchUndoRedo(const BenchOptions &options, EditorWindow &editor, const std::string &text) {
+	Samples undo;
+	Samples redo;
+	Random random;
+	for (int i = 0; i < options.repeat; i++) {
+		editor.Reset(text);
+		for (int op = 0; op < options.operations; op++) {
+			const Position length = editor.call.Length();
+			editor.call.SetEmptySelection(random.Next(static_cast<uint32_t>(length)));
+			editor.call.ReplaceSel((op & 1) ? "value " : "index");
+		}
+		while (editor.call.CanUndo()) {
+			const auto start = std::chrono::steady_clock::now();
+			editor.call.Undo();
+			undo.Add(ElapsedSeconds(start));
+		}
+		while (editor.call.CanRedo()) {
+			const auto start = std::chrono::steady_clock::now();
+			editor.call.Redo();
+			redo.Add(ElapsedSeconds(start));
+		}
+	}
+	PrintResult(options, "undo", undo);
+	PrintResult(options, "redo", redo);
+}
+
+bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (strcmp(arg, "-json") == 0) {
+			options.json = true;
+		} else if (strcmp(arg, "-repeat") == 0 && i + 1 < argc) {
+			options.repeat = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-size") == 0 && i + 1 < argc) {
+			options.size = static_cast<size_t>(std::max(atoi(argv[++i]), 1))*1024*1024;
+		} else if (strcmp(arg, "-ops") == 0 && i + 1 < argc) {
+			options.operations = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-case") == 0 && i + 1 < argc) {
+			options.filter = argv[++i];
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options)) {
+		fprintf(stderr, "usage: %s [-json] [-repeat count] [-size MiB] [-ops count] [-case load|typing|replace-all|multi-caret|undo]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// stable timing: run on one CPU with high priority
+	::SetProcessAffinityMask(::GetCurrentProcess(), 1);
+	::SetPriorityClass(::GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+	::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+	HINSTANCE hInstance = ::GetModuleHandle(nullptr);
+	Scintilla_LoadDpiForWindow();
+	Scintilla_RegisterClasses(hInstance);
+
+	int status = EXIT_SUCCESS;
+	{
+		EditorWindow editor(hInstance);
+		if (!editor.Valid()) {
+			fprintf(stderr, "create Scintilla window fail: %lu\n", ::GetLastError());
+			return EXIT_FAILURE;
+		}
+		editor.call.SetCodePage(SC_CP_UTF8);
+		const std::string text = MakeDocument(options.size);
+
+		if (options.json) {
+			printf("[\n");
+		} else {
+			printf("%-12s %8s %10s %13s %10s %10s %10s %10s\n", "case", "samples", "ms", "rate", "p50 us", "p90 us", "p99 us", "max us");
+		}
+		try {
+			if (Selected(options, "load")) {
+				BenchLoad(options, editor, text);
+			}
+			if (Selected(options, "typing")) {
+				BenchTyping(options, editor, text);
+			}
+			if (Selected(options, "replace-all")) {
+				BenchReplaceAll(options, editor, text);
+			}
+			if (Selected(options, "multi-caret")) {
+				BenchMultiCaret(options, editor, text);
+			}
+			if (Selected(options, "undo")) {
+				BenchUndoRedo(options, editor, text);
+			}
+		} catch (const Failure &failure) {
+			fprintf(stderr, "Scintilla call fail: %d\n", static_cast<int>(failure.status));
+			status = EXIT_FAILURE;
+		}
+		if (options.json) {
+			printf("{\"case\": \"end\"}\n]\n");
+		}
+	}
+
+	Scintilla_ReleaseResources();
+	return status;
+}
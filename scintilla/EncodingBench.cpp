@@ -0,0 +1,423 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//! Encoding detection, line ending detection and UTF conversion throughput benchmark.
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include <shlwapi.h>
+#include <commctrl.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include "../src/SciCall.h"
+#if !NP2_FORCE_COMPILE_C_AS_CPP
+extern "C" {
+#endif
+#include "../src/Helpers.h"
+#include "../src/Dialogs.h"
+#include "../src/Notepad2.h"
+#include "../src/Edit.h"
+#if !NP2_FORCE_COMPILE_C_AS_CPP
+}
+#endif
+
+// Runs the file loading and saving hot paths from EditEncoding.c over synthetic text of several sizes
+// and over every file in an optional corpus directory: IsUnicode(), IsUTF8(), IsUTF7(),
+// DetectDBCSEncoding(), EditDetectEOLMode(), UTF8ToUTF16() and UTF16ToUTF8(); plus ReadFile() and
+// WriteFile() for corpus files to compare detection cost with raw I/O.
+// Instruction set is chosen at compile time (see VectorISA.h): x64 builds use SSE2 by default and
+// AVX2 with /arch:AVX2 or -mavx2, scalar code is only built for ARM64.
+
+// cl /EHsc /std:c++17 /DNDEBUG /DUNICODE /D_UNICODE /Ox /Ot /GS- /GR- /W4 /Iinclude EncodingBench.cpp ..\src\EditEncoding.c shlwapi.lib user32.lib gdi32.lib
+// cl /EHsc /std:c++17 /DNDEBUG /DUNICODE /D_UNICODE /Ox /Ot /GS- /GR- /W4 /arch:AVX2 /Iinclude EncodingBench.cpp ..\src\EditEncoding.c shlwapi.lib user32.lib gdi32.lib
+// gcc -std=gnu17 -DNDEBUG -DUNICODE -D_UNICODE -O2 -mavx2 -mpopcnt -mbmi -mbmi2 -mlzcnt -Iinclude -c ../src/EditEncoding.c -o EditEncoding.o
+// g++ -std=gnu++17 -DNDEBUG -DUNICODE -D_UNICODE -O2 -mavx2 -mpopcnt -mbmi -mbmi2 -mlzcnt -Iinclude EncodingBench.cpp EditEncoding.o -lshlwapi -lgdi32 -o EncodingBench
+// usage: EncodingBench [-json] [-repeat count] [-size MiB[,MiB...]] [-sample MiB] [corpus]
+
+// stubs for symbols EditEncoding.c references from other modules.
+extern "C" {
+
+HINSTANCE g_hInstance;
+HANDLE g_hDefaultHeap;
+HANDLE g_hScintilla;
+BOOL bSkipUnicodeDetection = FALSE;
+int iDefaultCodePage = 0;
+int iDefaultCharSet = DEFAULT_CHARSET;
+DWORD dwEOLSampleMinSize = 0;
+int iEOLSampleBlockCount = 32;
+
+LRESULT SCI_METHOD Scintilla_DirectFunction(HANDLE handle, UINT msg, WPARAM wParam, LPARAM lParam) {
+	UNREFERENCED_PARAMETER(handle);
+	UNREFERENCED_PARAMETER(msg);
+	UNREFERENCED_PARAMETER(wParam);
+	UNREFERENCED_PARAMETER(lParam);
+	return 0;
+}
+
+void AutoC_ResetWordCharTable(void) {
+}
+
+BOOL EditConvertText(UINT cpSource, UINT cpDest, BOOL bSetSavePoint) {
+	UNREFERENCED_PARAMETER(cpSource);
+	UNREFERENCED_PARAMETER(cpDest);
+	UNREFERENCED_PARAMETER(bSetSavePoint);
+	return FALSE;
+}
+
+int MsgBox(UINT uType, UINT uIdMsg, ...) {
+	UNREFERENCED_PARAMETER(uType);
+	UNREFERENCED_PARAMETER(uIdMsg);
+	return IDNO;
+}
+
+INT_PTR InfoBox(UINT uType, LPCWSTR lpstrSetting, UINT uidMessage, ...) {
+	UNREFERENCED_PARAMETER(uType);
+	UNREFERENCED_PARAMETER(lpstrSetting);
+	UNREFERENCED_PARAMETER(uidMessage);
+	return IDNO;
+}
+
+void DebugPrintf(const char *fmt, ...) {
+	UNREFERENCED_PARAMETER(fmt);
+}
+
+void StopWatch_ShowLog(const StopWatch *watch, LPCSTR msg) {
+	UNREFERENCED_PARAMETER(watch);
+	UNREFERENCED_PARAMETER(msg);
+}
+
+}
+
+namespace {
+
+#if NP2_USE_AVX2
+constexpr const char *isaName = "AVX2";
+#elif NP2_USE_SSE2
+constexpr const char *isaName = "SSE2";
+#else
+constexpr const char *isaName = "scalar";
+#endif
+
+// detection and conversion may read up to one vector past the end, same as NP2_MAPPED_FILE_PADDING
+constexpr size_t bufferPadding = 64;
+
+struct BenchOptions {
+	bool json = false;
+	int repeat = 5;
+	std::vector<size_t> sizes;
+	const char *corpus = nullptr;
+};
+
+struct Corpus {
+	std::string name;
+	std::vector<char> data;	// with bufferPadding zero bytes after the text
+	size_t length = 0;
+	bool utf16 = false;
+};
+
+void AppendUTF8(std::string &text, uint32_t ch) {
+	if (ch < 0x80) {
+		text.push_back(static_cast<char>(ch));
+	} else if (ch < 0x800) {
+		text.push_back(static_cast<char>(0xC0 | (ch >> 6)));
+		text.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+	} else if (ch < 0x10000) {
+		text.push_back(static_cast<char>(0xE0 | (ch >> 12)));
+		text.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+		text.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+	} else {
+		text.push_back(static_cast<char>(0xF0 | (ch >> 18)));
+		text.push_back(static_cast<char>(0x80 | ((ch >> 12) & 0x3F)));
+		text.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+		text.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+	}
+}
+
+// deterministic text, kind: 0 = ASCII source code, 1 = mixed UTF-8, 2 = Shift_JIS
+std::string MakeSyntheticText(int kind, size_t size) {
+	static const char *const words[] = {
+		"int", "return", "static", "const", "char", "value", "length", "buffer", "if", "else", "for", "while",
+		"(", ")", "{", "}", ";", "=", "+", "0x40", "1024", "//", "\"text\"",
+	};
+	std::string text;
+	text.reserve(size + 64);
+	uint32_t seed = 0x2545F491;
+	size_t column = 0;
+	while (text.size() < size) {
+		seed = seed*1103515245 + 12345;
+		const uint32_t rand = seed >> 8;
+		if (kind == 2 && (rand & 3) != 0) {
+			// hiragana or kanji
+			if (rand & 4) {
+				text.push_back('\x82');
+				text.push_back(static_cast<char>(0x9F + (rand >> 4) % 83));
+			} else {
+				text.push_back(static_cast<char>(0x88 + (rand >> 4) % 8));
+				text.push_back(static_cast<char>(0x40 + (rand >> 8) % 60));
+			}
+			column += 2;
+		} else if (kind == 1 && (rand & 7) == 0) {
+			static const uint32_t blocks[] = {0xE9, 0x3B1, 0x430, 0x4E00, 0xAC00, 0x1F600};
+			const uint32_t base = blocks[(rand >> 4) % std::size(blocks)];
+			AppendUTF8(text, base + (rand >> 8) % 32);
+			column += 2;
+		} else {
+			const char *word = words[(rand >> 4) % std::size(words)];
+			text.append(word);
+			text.push_back(' ');
+			column += strlen(word) + 1;
+		}
+		if (column > 40 + (rand >> 16) % 60) {
+			text.append((kind == 0) ? "\r\n" : "\n");
+			column = 0;
+		}
+	}
+	return text;
+}
+
+Corpus MakeCorpus(std::string name, const char *text, size_t length, bool utf16) {
+	Corpus corpus;
+	corpus.name = std::move(name);
+	corpus.length = length;
+	corpus.utf16 = utf16;
+	corpus.data.resize(length + bufferPadding);
+	memcpy(corpus.data.data(), text, length);
+	return corpus;
+}
+
+Corpus MakeUTF16Corpus(std::string name, const std::string &text) {
+	const int count = MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+	std::vector<WCHAR> wide(count);
+	MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), wide.data(), count);
+	return MakeCorpus(std::move(name), reinterpret_cast<const char *>(wide.data()), count*sizeof(WCHAR), true);
+}
+
+double ElapsedSeconds(std::chrono::steady_clock::time_point start) noexcept {
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return duration.count();
+}
+
+constexpr double Throughput(size_t length, double seconds) noexcept {
+	return (seconds > 0) ? length / (1e9*seconds) : 0;
+}
+
+void PrintResult(const BenchOptions &options, const Corpus &corpus, const char *function, double seconds) {
+	const double rate = Throughput(corpus.length, seconds);
+	if (options.json) {
+		std::string name;
+		for (const char ch : corpus.name) {
+			if (ch == '\\' || ch == '\"') {
+				name.push_back('\\');
+			}
+			name.push_back(ch);
+		}
+		printf("{\"function\": \"%s\", \"corpus\": \"%s\", \"isa\": \"%s\", \"bytes\": %zu, \"ms\": %.3f, \"GBps\": %.3f},\n",
+			function, name.c_str(), isaName, corpus.length, seconds*1000, rate);
+	} else {
+		printf("%-20s %-32s %10zu %10.3f\n", function, corpus.name.c_str(), corpus.length, rate);
+	}
+}
+
+// best time of all runs
+template <typename Function>
+double BestTime(int repeat, Function function) {
+	double best = 1e9;
+	for (int i = 0; i < repeat; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		best = std::min(best, ElapsedSeconds(start));
+	}
+	return best;
+}
+
+void RunCorpus(const BenchOptions &options, const Corpus &corpus) {
+	const char *data = corpus.data.data();
+	const DWORD length = static_cast<DWORD>(corpus.length);
+	volatile size_t sink = 0;
+
+	double seconds = BestTime(options.repeat, [&] {
+		BOOL bBOM = FALSE;
+		BOOL bReverse = FALSE;
+		sink += IsUnicode(data, length, &bBOM, &bReverse);
+	});
+	PrintResult(options, corpus, "IsUnicode", seconds);
+	if (corpus.utf16) {
+		std::vector<char> output(corpus.length*3/2 + bufferPadding);
+		seconds = BestTime(options.repeat, [&] {
+			sink += UTF16ToUTF8(reinterpret_cast<LPCWSTR>(data), corpus.length/sizeof(WCHAR), output.data(), nullptr);
+		});
+		PrintResult(options, corpus, "UTF16ToUTF8", seconds);
+		return;
+	}
+
+	seconds = BestTime(options.repeat, [&] {
+		sink += IsUTF8(data, length);
+	});
+	PrintResult(options, corpus, "IsUTF8", seconds);
+	seconds = BestTime(options.repeat, [&] {
+		sink += IsUTF7(data, length);
+	});
+	PrintResult(options, corpus, "IsUTF7", seconds);
+	seconds = BestTime(options.repeat, [&] {
+		sink += DetectDBCSEncoding(data, length);
+	});
+	PrintResult(options, corpus, "DetectDBCSEncoding", seconds);
+	seconds = BestTime(options.repeat, [&] {
+		EditFileIOStatus status;
+		memset(&status, 0, sizeof(status));
+		status.iEOLMode = SC_EOL_CRLF;
+		EditDetectEOLMode(data, length, &status);
+		sink += status.totalLineCount;
+	});
+	PrintResult(options, corpus, "EditDetectEOLMode", seconds);
+
+	std::vector<WCHAR> output(corpus.length + bufferPadding);
+	seconds = BestTime(options.repeat, [&] {
+		sink += UTF8ToUTF16(data, corpus.length, output.data());
+	});
+	PrintResult(options, corpus, "UTF8ToUTF16", seconds);
+}
+
+// raw file I/O of the load and save paths, without encoding detection or conversion
+void RunFileIO(const BenchOptions &options, const std::filesystem::path &path, const Corpus &corpus) {
+	std::vector<char> buffer(corpus.length + bufferPadding);
+	double seconds = BestTime(options.repeat, [&] {
+		HANDLE hFile = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile != INVALID_HANDLE_VALUE) {
+			DWORD cbRead = 0;
+			ReadFile(hFile, buffer.data(), static_cast<DWORD>(corpus.length), &cbRead, nullptr);
+			CloseHandle(hFile);
+		}
+	});
+	PrintResult(options, corpus, "ReadFile", seconds);
+
+	WCHAR tempDir[MAX_PATH];
+	WCHAR tempPath[MAX_PATH];
+	GetTempPath(MAX_PATH, tempDir);
+	if (!GetTempFileName(tempDir, L"NP2", 0, tempPath)) {
+		return;
+	}
+	seconds = BestTime(options.repeat, [&] {
+		HANDLE hFile = CreateFile(tempPath, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile != INVALID_HANDLE_VALUE) {
+			DWORD cbWritten = 0;
+			WriteFile(hFile, corpus.data.data(), static_cast<DWORD>(corpus.length), &cbWritten, nullptr);
+			CloseHandle(hFile);
+		}
+	});
+	DeleteFile(tempPath);
+	PrintResult(options, corpus, "WriteFile", seconds);
+}
+
+bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (strcmp(arg, "-json") == 0) {
+			options.json = true;
+		} else if (strcmp(arg, "-repeat") == 0 && i + 1 < argc) {
+			options.repeat = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-size") == 0 && i + 1 < argc) {
+			options.sizes.clear();
+			const char *list = argv[++i];
+			while (*list) {
+				char *end;
+				const unsigned long size = strtoul(list, &end, 10);
+				if (end == list) {
+					return false;
+				}
+				if (size != 0) {
+					options.sizes.push_back(static_cast<size_t>(size)*1024*1024);
+				}
+				list = (*end == ',') ? end + 1 : end;
+			}
+		} else if (strcmp(arg, "-sample") == 0 && i + 1 < argc) {
+			dwEOLSampleMinSize = static_cast<DWORD>(std::max(atoi(argv[++i]), 0))*1024*1024;
+		} else if (arg[0] != '-' && options.corpus == nullptr) {
+			options.corpus = arg;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	BenchOptions options;
+	options.sizes = {1024*1024, 16*1024*1024, 256*1024*1024};
+	if (!ParseOptions(argc, argv, options)) {
+		fprintf(stderr, "usage: %s [-json] [-repeat count] [-size MiB[,MiB...]] [-sample MiB] [corpus]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	g_hDefaultHeap = GetProcessHeap();
+	Encoding_InitDefaults();
+
+	std::vector<std::filesystem::path> files;
+	if (options.corpus != nullptr) {
+		std::error_code ec;
+		for (const auto &entry : std::filesystem::directory_iterator(options.corpus, ec)) {
+			if (entry.is_regular_file() && entry.file_size(ec) < 0x7FFFFFFF) {
+				files.push_back(entry.path());
+			}
+		}
+		if (ec) {
+			fprintf(stderr, "read %s fail: %s\n", options.corpus, ec.message().c_str());
+			return EXIT_FAILURE;
+		}
+		std::sort(files.begin(), files.end());
+	}
+
+	if (options.json) {
+		printf("[\n");
+	} else {
+		printf("ISA: %s\n", isaName);
+		printf("%-20s %-32s %10s %10s\n", "function", "corpus", "bytes", "GB/s");
+	}
+	static const char *const kindNames[] = {"ascii", "utf8", "sjis"};
+	for (const size_t size : options.sizes) {
+		const std::string suffix = "-" + std::to_string(size >> 20) + "MiB";
+		for (int kind = 0; kind < 3; kind++) {
+			const std::string text = MakeSyntheticText(kind, size);
+			const Corpus corpus = MakeCorpus(kindNames[kind] + suffix, text.data(), text.size(), false);
+			RunCorpus(options, corpus);
+			if (kind == 1) {
+				RunCorpus(options, MakeUTF16Corpus("utf16" + suffix, text));
+			}
+		}
+	}
+	for (const auto &path : files) {
+		std::string text;
+		FILE *fp = _wfopen(path.c_str(), L"rb");
+		if (fp == nullptr) {
+			continue;
+		}
+		char buffer[64*1024];
+		size_t count;
+		while ((count = fread(buffer, 1, sizeof(buffer), fp)) != 0) {
+			text.append(buffer, count);
+		}
+		fclose(fp);
+		if (text.empty()) {
+			continue;
+		}
+		BOOL bBOM = FALSE;
+		BOOL bReverse = FALSE;
+		const bool utf16 = IsUnicode(text.data(), static_cast<DWORD>(text.size()), &bBOM, &bReverse) && !bReverse;
+		const Corpus corpus = MakeCorpus(path.filename().string(), text.data(), text.size() & ~static_cast<size_t>(utf16), utf16);
+		RunCorpus(options, corpus);
+		RunFileIO(options, path, corpus);
+	}
+	if (options.json) {
+		printf("{\"isa\": \"%s\"}\n]\n", isaName);
+	}
+	return EXIT_SUCCESS;
+}
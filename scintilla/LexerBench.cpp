@@ -0,0 +1,235 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//! Headless lexer throughput benchmark.
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <forward_list>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+
+#include "ScintillaTypes.h"
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+#include "SciLexer.h"
+#include "Debugging.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "LexerModule.h"
+
+// Runs every lexer in the catalogue over files in a corpus directory, a file is used for the lexer
+// whose language name matches the file name up to the first dot, e.g. cpp.Lexer.cxx, hypertext.html.
+// Lex and fold passes are timed separately, for lexers without separate folder fold time is zero
+// and folding is included in lex time.
+
+// cl /EHsc /std:c++17 /DNDEBUG /Ox /Ot /GS- /GR- /W4 /Iinclude /Isrc /Ilexlib LexerBench.cpp lexers\*.cxx lexlib\*.cxx src\CaseConvert.cxx src\CaseFolder.cxx src\CellBuffer.cxx src\CharClassify.cxx src\Decoration.cxx src\Document.cxx src\PerLine.cxx src\RESearch.cxx src\RunStyles.cxx src\SplitVector.cxx src\UniConversion.cxx
+// g++ -std=gnu++17 -DNDEBUG -O2 -Iinclude -Isrc -Ilexlib LexerBench.cpp lexers/*.cxx lexlib/*.cxx src/{CaseConvert,CaseFolder,CellBuffer,CharClassify,Decoration,Document,PerLine,RESearch,RunStyles,SplitVector,UniConversion}.cxx -o LexerBench
+// usage: LexerBench [-json] [-repeat count] [-size MiB] [-lexer name] corpus
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+using namespace Lexilla;
+
+namespace Scintilla::Internal {
+
+void Platform::Assert(const char *c, const char *file, int line) noexcept {
+	fprintf(stderr, "Assertion [%s] failed at %s %d\n", c, file, line);
+	abort();
+}
+
+}
+
+namespace {
+
+struct BenchOptions {
+	bool json = false;
+	int repeat = 5;
+	size_t minSize = 8*1024*1024;
+	const char *lexer = nullptr;
+	const char *corpus = nullptr;
+};
+
+struct BenchResult {
+	double lexTime = 0;
+	double foldTime = 0;
+};
+
+std::string ReadCorpusFile(const std::filesystem::path &path, size_t minSize) {
+	std::string text;
+	FILE *fp = fopen(path.string().c_str(), "rb");
+	if (fp == nullptr) {
+		return text;
+	}
+	char buffer[64*1024];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), fp)) != 0) {
+		text.append(buffer, count);
+	}
+	fclose(fp);
+	// repeat small file to get stable timing
+	if (!text.empty() && text.size() < minSize) {
+		if (text.back() != '\n') {
+			text.push_back('\n');
+		}
+		const size_t length = text.size();
+		text.reserve(minSize + length);
+		while (text.size() < minSize) {
+			text.append(text.data(), length);
+		}
+	}
+	return text;
+}
+
+double ElapsedSeconds(std::chrono::steady_clock::time_point start) noexcept {
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return duration.count();
+}
+
+// best time of all runs
+BenchResult RunLexer(const LexerModule *lm, const std::string &text, int repeat) {
+	Document doc(DocumentOption::Default);
+	doc.SetUndoCollection(false);
+	doc.InsertString(0, text.data(), text.size());
+	const Sci_Position length = doc.Length();
+
+	ILexer5 *lexer = lm->Create();
+	lexer->PropertySet("fold", "1");
+	BenchResult result{1e9, 1e9};
+	for (int i = 0; i < repeat; i++) {
+		auto start = std::chrono::steady_clock::now();
+		lexer->Lex(0, length, 0, &doc);
+		result.lexTime = std::min(result.lexTime, ElapsedSeconds(start));
+		start = std::chrono::steady_clock::now();
+		lexer->Fold(0, length, 0, &doc);
+		result.foldTime = std::min(result.foldTime, ElapsedSeconds(start));
+	}
+	lexer->Release();
+	return result;
+}
+
+constexpr double Throughput(size_t length, double seconds) noexcept {
+	return (seconds > 0) ? length / (1024*1024*seconds) : 0;
+}
+
+void PrintResult(const BenchOptions &options, const LexerModule *lm, const std::filesystem::path &path, size_t length, const BenchResult &result) {
+	const double lexRate = Throughput(length, result.lexTime);
+	const double foldRate = lm->HasFolder() ? Throughput(length, result.foldTime) : 0;
+	if (options.json) {
+		std::string file;
+		for (const char ch : path.filename().string()) {
+			if (ch == '\\' || ch == '\"') {
+				file.push_back('\\');
+			}
+			file.push_back(ch);
+		}
+		printf("{\"lexer\": \"%s\", \"file\": \"%s\", \"bytes\": %zu, \"lex_ms\": %.3f, \"fold_ms\": %.3f, \"lex_MiBps\": %.2f, \"fold_MiBps\": %.2f},\n",
+			lm->languageName, file.c_str(), length, result.lexTime*1000, result.foldTime*1000, lexRate, foldRate);
+	} else {
+		printf("%-16s %-32s %10zu %10.2f %10.2f\n", lm->languageName, path.filename().string().c_str(), length, lexRate, foldRate);
+	}
+}
+
+bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (strcmp(arg, "-json") == 0) {
+			options.json = true;
+		} else if (strcmp(arg, "-repeat") == 0 && i + 1 < argc) {
+			options.repeat = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-size") == 0 && i + 1 < argc) {
+			options.minSize = static_cast<size_t>(std::max(atoi(argv[++i]), 0))*1024*1024;
+		} else if (strcmp(arg, "-lexer") == 0 && i + 1 < argc) {
+			options.lexer = argv[++i];
+		} else if (arg[0] != '-' && options.corpus == nullptr) {
+			options.corpus = arg;
+		} else {
+			return false;
+		}
+	}
+	return options.corpus != nullptr;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options)) {
+		fprintf(stderr, "usage: %s [-json] [-repeat count] [-size MiB] [-lexer name] corpus\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::filesystem::path> files;
+	std::error_code ec;
+	for (const auto &entry : std::filesystem::directory_iterator(options.corpus, ec)) {
+		if (entry.is_regular_file()) {
+			files.push_back(entry.path());
+		}
+	}
+	if (ec) {
+		fprintf(stderr, "read %s fail: %s\n", options.corpus, ec.message().c_str());
+		return EXIT_FAILURE;
+	}
+	std::sort(files.begin(), files.end());
+
+	std::vector<const LexerModule *> modules;
+	for (int language = SCLEX_CONTAINER; language < SCLEX_AUTOMATIC; language++) {
+		const LexerModule *lm = LexerModule::Find(language);
+		if (lm->GetLanguage() == language && lm->languageName != nullptr) {
+			modules.push_back(lm);
+		}
+	}
+
+	if (options.json) {
+		printf("[\n");
+	} else {
+		printf("%-16s %-32s %10s %10s %10s\n", "lexer", "file", "bytes", "lex MiB/s", "fold MiB/s");
+	}
+	size_t total = 0;
+	double totalTime = 0;
+	for (const LexerModule *lm : modules) {
+		const std::string_view name = lm->languageName;
+		if (options.lexer != nullptr && name != options.lexer) {
+			continue;
+		}
+		for (const auto &path : files) {
+			const std::string filename = path.filename().string();
+			if (!(filename.size() > name.size() && filename.compare(0, name.size(), name) == 0 && filename[name.size()] == '.')) {
+				continue;
+			}
+			const std::string text = ReadCorpusFile(path, options.minSize);
+			if (text.empty()) {
+				continue;
+			}
+			const BenchResult result = RunLexer(lm, text, options.repeat);
+			PrintResult(options, lm, path, text.size(), result);
+			total += text.size();
+			totalTime += result.lexTime + result.foldTime;
+		}
+	}
+	if (options.json) {
+		printf("{\"lexer\": \"total\", \"bytes\": %zu, \"seconds\": %.3f, \"MiBps\": %.2f}\n]\n", total, totalTime, Throughput(total, totalTime));
+	} else {
+		printf("%-16s %-32s %10zu %10.2f\n", "total", "", total, Throughput(total, totalTime));
+	}
+	return EXIT_SUCCESS;
+}
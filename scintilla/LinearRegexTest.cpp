@@ -0,0 +1,282 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//! Regression test for LinearRegex::SearchBackward(), which must find the match with greatest start
+//! like trying anchored forward search at each start position backward from the end.
+//! Forward matches and captures are compared with std::regex in ECMAScript mode.
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <regex>
+
+#include "ScintillaTypes.h"
+#include "Debugging.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "LinearRegex.h"
+
+// cl /EHsc /std:c++17 /DNDEBUG /O2 /W4 /Zc:wchar_t- /Isrc /Iinclude /Ilexlib LinearRegexTest.cpp src\LinearRegex.cxx src\CellBuffer.cxx src\CharClassify.cxx src\CaseConvert.cxx src\UniConversion.cxx src\RunStyles.cxx src\SplitVector.cxx src\LZ4Block.cxx
+// g++ -std=gnu++17 -DNDEBUG -O2 -Wall -Wextra -fshort-wchar -Isrc -Iinclude -Ilexlib LinearRegexTest.cpp src/LinearRegex.cxx src/CellBuffer.cxx src/CharClassify.cxx src/CaseConvert.cxx src/UniConversion.cxx src/RunStyles.cxx src/SplitVector.cxx src/LZ4Block.cxx -o LinearRegexTest
+// usage: LinearRegexTest [iterations]
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr int CpUtf8 = 65001;
+
+CharClassify charClass;
+
+uint32_t seed = 1;
+
+uint32_t Random(uint32_t range) noexcept {
+	seed = seed*1103515245 + 12345;
+	return (seed >> 8) % range;
+}
+
+constexpr bool IsTrailByte(char ch) noexcept {
+	return (static_cast<unsigned char>(ch) & 0xC0) == 0x80;
+}
+
+Sci::Position PositionBefore(std::string_view text, Sci::Position pos) noexcept {
+	if (pos <= 0) {
+		return -1;
+	}
+	pos--;
+	while (pos > 0 && IsTrailByte(text[pos])) {
+		pos--;
+	}
+	return pos;
+}
+
+bool CheckBackward(const char *pattern, std::string_view text, Sci::Position startPos, Sci::Position endPos,
+	Sci::Position expectedStart, Sci::Position expectedEnd) {
+	LinearRegex regex;
+	const LinearRegex::Encoding encoding = { CpUtf8, &charClass, nullptr };
+	if (regex.Compile(pattern, strlen(pattern), true, encoding)) {
+		printf("compile fail: %s\n", pattern);
+		return false;
+	}
+	const SplitView view(text.data(), text.length());
+	const bool matched = regex.SearchBackward(view, startPos, endPos);
+	const Sci::Position start = matched ? regex.groupStart[0] : LinearRegex::NotFound;
+	const Sci::Position end = matched ? regex.groupEnd[0] : LinearRegex::NotFound;
+	if (start != expectedStart || end != expectedEnd) {
+		printf("backward fail: /%s/ in \"%.*s\" [%td, %td], got %td+%td, expected %td+%td\n", pattern,
+			static_cast<int>(text.length()), text.data(), startPos, endPos,
+			start, end - start, expectedStart, expectedEnd - expectedStart);
+		return false;
+	}
+	return true;
+}
+
+using GroupList = std::vector<std::pair<Sci::Position, Sci::Position>>;
+
+GroupList SearchForward(const char *pattern, std::string_view text, bool caseSensitive) {
+	LinearRegex regex;
+	const LinearRegex::Encoding encoding = { CpUtf8, &charClass, nullptr };
+	if (regex.Compile(pattern, strlen(pattern), caseSensitive, encoding)) {
+		printf("compile fail: %s\n", pattern);
+		return {};
+	}
+	const SplitView view(text.data(), text.length());
+	GroupList groups;
+	if (regex.Search(view, 0, text.length(), -1)) {
+		for (int i = 0; i < LinearRegex::MaxGroup; i++) {
+			groups.emplace_back(regex.groupStart[i], regex.groupEnd[i]);
+		}
+	}
+	return groups;
+}
+
+bool CheckGroups(const char *pattern, std::string_view text, bool caseSensitive, const GroupList &expected) {
+	const GroupList groups = SearchForward(pattern, text, caseSensitive);
+	for (size_t i = 0; i < std::max(groups.size(), expected.size()); i++) {
+		const auto group = (i < groups.size()) ? groups[i] : std::make_pair<Sci::Position, Sci::Position>(LinearRegex::NotFound, LinearRegex::NotFound);
+		const auto want = (i < expected.size()) ? expected[i] : std::make_pair<Sci::Position, Sci::Position>(LinearRegex::NotFound, LinearRegex::NotFound);
+		if (group != want) {
+			printf("forward fail: /%s/%s in \"%.*s\", group %zu got %td+%td, expected %td+%td\n", pattern, caseSensitive ? "" : "i",
+				static_cast<int>(text.length()), text.data(), i,
+				group.first, group.second - group.first, want.first, want.second - want.first);
+			return false;
+		}
+	}
+	return true;
+}
+
+// std::regex in ECMAScript mode is the oracle, texts have no line ends as matches don't cross them.
+bool CheckOracle(const char *pattern, std::string_view text, bool caseSensitive) {
+	auto flags = std::regex::ECMAScript;
+	if (!caseSensitive) {
+		flags |= std::regex::icase;
+	}
+	const std::regex oracle(pattern, flags);
+	std::match_results<std::string_view::const_iterator> match;
+	GroupList expected;
+	if (std::regex_search(text.begin(), text.end(), match, oracle)) {
+		for (size_t i = 0; i < match.size() && i < LinearRegex::MaxGroup; i++) {
+			if (match[i].matched) {
+				expected.emplace_back(match[i].first - text.begin(), match[i].second - text.begin());
+			} else {
+				expected.emplace_back(LinearRegex::NotFound, LinearRegex::NotFound);
+			}
+		}
+	}
+	return CheckGroups(pattern, text, caseSensitive, expected);
+}
+
+struct OracleCase {
+	const char *pattern;
+	const char *text;
+	bool caseSensitive;
+};
+
+// patterns without loops whose body can match empty text, std::regex implementations
+// disagree with each other and with ECMAScript on empty iterations.
+constexpr OracleCase oracleCases[] = {
+	{ "a+", "xaaay", true },
+	{ "a+?", "xaaay", true },
+	{ "(a|ab)(c|bcd)(d*)", "abcd", true },
+	{ "(a+)(b+)?", "aac", true },
+	{ "(a+?)(a*)", "aaa", true },
+	{ "(ab|a)(bc|c)?", "abc", true },
+	{ "(?:(a)|b)(c)", "bc", true },
+	{ "x(a|b)*y", "xababy", true },
+	{ "(a|b)+?b", "aabb", true },
+	{ "([a-c]+)-([0-9]{2,3})", "zz abc-1234", true },
+	{ "a{2}b{1,}c{0,2}", "aabbbccc", true },
+	{ "\\d+\\.\\d*", "v 12.50", true },
+	{ "\\w+\\s+\\w+", "  ab_1 \tcd!", true },
+	{ "[^ab]+", "aabcdb", true },
+	{ "[[:alpha:]]+[[:digit:]]", "12ab3", true },
+	{ "\\bab", "cab ab", true },
+	{ "ab\\B", "ab abc", true },
+	{ "^ab|cd$", "xabcd", true },
+	{ "(b|ab)(c|bc)", "abc", true },
+	{ "(A+)b", "xaAb", false },
+	{ "[a-c]+", "XBCAd", false },
+	{ "(x|X)(Y)", "xXy", false },
+};
+
+bool TestOracle(int iterations) {
+	bool ok = true;
+	for (const OracleCase &test : oracleCases) {
+		ok = CheckOracle(test.pattern, test.text, test.caseSensitive) && ok;
+	}
+	static const char *const pieces[] = { "a", "b", "c", "d", "x", "y", "A", "B", "1", "2", "-", " ", "." };
+	for (int iteration = 0; iteration < iterations && ok; iteration++) {
+		const OracleCase &test = oracleCases[Random(std::size(oracleCases))];
+		std::string text;
+		const int count = Random(12);
+		for (int i = 0; i < count; i++) {
+			text += pieces[Random(std::size(pieces))];
+		}
+		if (!CheckOracle(test.pattern, text, test.caseSensitive)) {
+			printf("oracle fail: iteration %d\n", iteration);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+// loops whose iteration can match empty text, expected results from ECMAScript specification:
+// an iteration matching empty text stops the loop.
+bool TestEmptyLoops() {
+	bool ok = CheckGroups("(|a)+", "aadc", true, { { 0, 2 }, { 1, 2 } });
+	ok = CheckGroups("(|a)*", "aa", true, { { 0, 2 }, { 1, 2 } }) && ok;
+	ok = CheckGroups("(a|)*", "aa", true, { { 0, 2 }, { 1, 2 } }) && ok;
+	ok = CheckGroups("(a*)*b", "aab", true, { { 0, 3 }, { 0, 2 } }) && ok;
+	ok = CheckGroups("(a*)+", "aab", true, { { 0, 2 }, { 0, 2 } }) && ok;
+	ok = CheckGroups("(a*)+b", "b", true, { { 0, 1 }, { 0, 0 } }) && ok;
+	ok = CheckGroups("(a*)*", "b", true, { { 0, 0 } }) && ok;
+	ok = CheckGroups("(a?)+?b", "ab", true, { { 0, 2 }, { 0, 1 } }) && ok;
+	return ok;
+}
+
+bool TestExamples() {
+	bool ok = CheckBackward("a+", "xaaa", 0, 4, 3, 4);
+	ok = CheckBackward("[^a][^a]*", "c  _b", 0, 5, 4, 5) && ok;
+	ok = CheckBackward("a+", "xaaa", 0, 3, 2, 3) && ok;
+	ok = CheckBackward("b", "abab", 0, 3, 1, 2) && ok;
+	ok = CheckBackward("b", "abab", 2, 3, -1, -1) && ok;
+	// starts inside a UTF-8 character are not tried
+	ok = CheckBackward(".", "a\xC3\xA9\xC3\xA9", 0, 5, 3, 5) && ok;
+	ok = CheckBackward("[^a]+", "a\xC3\xA9\xE4\xB8\xAD", 0, 6, 3, 6) && ok;
+	ok = CheckBackward("\xC3\xA9+", "\xC3\xA9\xC3\xA9x", 0, 4, 2, 4) && ok;
+	return ok;
+}
+
+// compare with anchored forward search from each character start backward from the end
+bool TestRandom(int iterations) {
+	static const char *const patterns[] = {
+		"a+", "a*b", "[^a][^a]*", "(ab|a)b*", "b|ab", "a.?b", "\\w+", "[ab]{2,3}", "\xC3\xA9+a?", ".", "^a", "b$", "\\bab",
+	};
+	static const char *const pieces[] = { "a", "b", "c", " ", "\xC3\xA9", "\xE4\xB8\xAD", "\n" };
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		const char *pattern = patterns[Random(std::size(patterns))];
+		std::string text;
+		const int count = Random(16);
+		for (int i = 0; i < count; i++) {
+			text += pieces[Random(std::size(pieces))];
+		}
+		const Sci::Position length = text.length();
+		Sci::Position startPos = Random(static_cast<uint32_t>(length + 1));
+		Sci::Position endPos = Random(static_cast<uint32_t>(length + 1));
+		if (startPos > endPos) {
+			std::swap(startPos, endPos);
+		}
+		while (startPos > 0 && IsTrailByte(text[startPos])) {
+			startPos--;
+		}
+		while (endPos < length && IsTrailByte(text[endPos])) {
+			endPos++;
+		}
+
+		LinearRegex regex;
+		const LinearRegex::Encoding encoding = { CpUtf8, &charClass, nullptr };
+		regex.Compile(pattern, strlen(pattern), true, encoding);
+		const SplitView view(text.data(), text.length());
+		Sci::Position expectedStart = LinearRegex::NotFound;
+		Sci::Position expectedEnd = LinearRegex::NotFound;
+		for (Sci::Position pos = endPos; pos >= startPos; pos--) {
+			if (pos < length && IsTrailByte(text[pos])) {
+				continue;
+			}
+			if (regex.Search(view, pos, endPos, PositionBefore(text, pos), true)) {
+				expectedStart = regex.groupStart[0];
+				expectedEnd = regex.groupEnd[0];
+				break;
+			}
+		}
+		if (!CheckBackward(pattern, text, startPos, endPos, expectedStart, expectedEnd)) {
+			printf("random fail: iteration %d\n", iteration);
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	const int iterations = (argc > 1) ? atoi(argv[1]) : 10000;
+	bool ok = TestExamples();
+	ok = TestRandom(iterations) && ok;
+	ok = TestEmptyLoops() && ok;
+	ok = TestOracle(iterations) && ok;
+	printf("%s\n", ok ? "pass" : "fail");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,482 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//! Rendering micro-benchmark: style runs, line layout, position cache and offscreen text drawing.
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include <windows.h>
+
+#include "ScintillaTypes.h"
+#include "Scintilla.h"
+#include "Debugging.h"
+#include "Geometry.h"
+#include "Platform.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "PlatWin.h"
+
+// Cases, each timed as the best of several runs after one warm up run:
+// runstyles   RunStyles<Sci::Position, int> FillRange(), InsertSpace() + DeleteRange() and
+//             FindNextChange() scan over a styling buffer as large as the synthetic document.
+// layout      EditView::LayoutLine() on synthetic long lines in a hidden Scintilla window, reached
+//             through SCI_POINTXFROMPOSITION after the layout cache is dropped. BreakFinder
+//             segmentation is exercised by the "styled" text (style changes every few characters)
+//             against the "plain" text (long runs subdivided by lengthEachSubdivision).
+//             "hit" keeps the position cache warm, "miss" disables it so every segment is measured.
+// measure     Surface::MeasureWidthsUTF8() for BreakFinder sized segments, the position cache miss path.
+// draw        Surface::DrawTextNoClipUTF8() into an offscreen bitmap with SurfaceGDI and SurfaceD2D
+//             (ID2D1DCRenderTarget bound to a memory DC).
+// Times are reported as nanoseconds per item, where an item is a byte of text or a RunStyles operation.
+// The process is pinned to one CPU with high priority to reduce noise.
+
+// cl /EHsc /std:c++17 /DNDEBUG /DUNICODE /D_UNICODE /Ox /Ot /GS- /GR- /W4 /Iinclude /Isrc /Ilexlib /Iwin32 RenderBench.cpp src\*.cxx win32\*.cxx lexlib\*.cxx lexers\*.cxx user32.lib gdi32.lib imm32.lib ole32.lib oleaut32.lib uuid.lib msimg32.lib shlwapi.lib comctl32.lib
+// g++ -std=gnu++17 -DNDEBUG -DUNICODE -D_UNICODE -O2 -Iinclude -Isrc -Ilexlib -Iwin32 RenderBench.cpp src/*.cxx win32/*.cxx lexlib/*.cxx lexers/*.cxx -limm32 -lole32 -loleaut32 -luuid -lmsimg32 -lshlwapi -lcomctl32 -lgdi32 -o RenderBench
+// usage: RenderBench [-json] [-repeat count] [-length chars] [-lines count] [-case name]
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+struct BenchOptions {
+	bool json = false;
+	int repeat = 5;
+	int lineLength = 20000;
+	int lineCount = 64;
+	const char *filter = nullptr;
+};
+
+struct SyntheticText {
+	const char *name;
+	std::string text;	// lines separated by '\n'
+	std::string styles;	// one style byte for each byte of text
+};
+
+constexpr const char *fontName = "Consolas";
+constexpr XYPOSITION fontSize = 11;
+constexpr int surfaceWidth = 1024;
+constexpr int surfaceHeight = 256;
+constexpr size_t segmentLength = 100;
+
+// xorshift32, same sequence on every run and every compiler
+struct Random {
+	uint32_t state = 0x2545F491;
+	uint32_t Next(uint32_t range) noexcept {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state % range;
+	}
+};
+
+SyntheticText MakeText(const char *name, const BenchOptions &options, bool styled, bool unicode) {
+	static constexpr const char *punctuation[] = { " ", " ", " ", ", ", "(", ")", " = ", "; ", "->", "." };
+	static constexpr const char *words[] = { "\xC3\xA9t\xC3\xA9", "\xE4\xB8\xAD\xE6\x96\x87", "\xCE\xB1\xCE\xB2\xCE\xB3", "\xE3\x81\x8B\xE3\x81\xAA" };
+	Random random;
+	SyntheticText result{name, {}, {}};
+	const size_t lineLength = options.lineLength;
+	for (int line = 0; line < options.lineCount; line++) {
+		const size_t start = result.text.size();
+		char style = 0;
+		while (result.text.size() - start < lineLength) {
+			const size_t wordStart = result.text.size();
+			if (unicode && random.Next(4) == 0) {
+				result.text += words[random.Next(static_cast<uint32_t>(std::size(words)))];
+			} else {
+				const uint32_t wordLength = 2 + random.Next(8);
+				for (uint32_t i = 0; i < wordLength; i++) {
+					result.text.push_back(static_cast<char>('a' + random.Next(26)));
+				}
+			}
+			if (styled) {
+				style = static_cast<char>(1 + random.Next(7));
+			}
+			result.styles.append(result.text.size() - wordStart, style);
+			const size_t separatorStart = result.text.size();
+			result.text += punctuation[random.Next(static_cast<uint32_t>(std::size(punctuation)))];
+			result.styles.append(result.text.size() - separatorStart, styled ? 0 : style);
+		}
+		result.text.push_back('\n');
+		result.styles.push_back(0);
+	}
+	return result;
+}
+
+double ElapsedSeconds(std::chrono::steady_clock::time_point start) noexcept {
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return duration.count();
+}
+
+// best time of all runs, first run is used to warm up caches
+template <typename Function>
+double BestTime(int repeat, Function function) {
+	function();
+	double best = 1e9;
+	for (int i = 0; i < repeat; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		best = std::min(best, ElapsedSeconds(start));
+	}
+	return best;
+}
+
+bool Selected(const BenchOptions &options, const char *name) noexcept {
+	return options.filter == nullptr || strcmp(options.filter, name) == 0;
+}
+
+void PrintResult(const BenchOptions &options, const char *name, const char *variant, const char *technology, size_t items, double seconds) {
+	const double nsPerItem = (items != 0) ? seconds*1e9/items : 0;
+	if (options.json) {
+		printf("{\"case\": \"%s\", \"variant\": \"%s\", \"technology\": \"%s\", \"items\": %zu, \"ms\": %.3f, \"ns_per_item\": %.3f},\n",
+			name, variant, technology, items, seconds*1000, nsPerItem);
+	} else {
+		printf("%-10s %-16s %-12s %12zu %10.3f %10.3f\n", name, variant, technology, items, seconds*1000, nsPerItem);
+	}
+}
+
+void BenchRunStyles(const BenchOptions &options, size_t length) {
+	constexpr int operationCount = 100000;
+	const Sci::Position documentLength = length;
+	RunStyles<Sci::Position, int> rs;
+	rs.InsertSpace(0, documentLength);
+
+	double seconds = BestTime(options.repeat, [&]() {
+		Random random;
+		rs.DeleteAll();
+		rs.InsertSpace(0, documentLength);
+		for (int i = 0; i < operationCount; i++) {
+			const Sci::Position position = random.Next(static_cast<uint32_t>(documentLength));
+			const Sci::Position fillLength = std::min<Sci::Position>(1 + random.Next(16), documentLength - position);
+			rs.FillRange(position, static_cast<int>(random.Next(8)), fillLength);
+		}
+	});
+	PrintResult(options, "runstyles", "fill", "", operationCount, seconds);
+
+	seconds = BestTime(options.repeat, [&]() {
+		Random random;
+		for (int i = 0; i < operationCount; i++) {
+			const Sci::Position position = random.Next(static_cast<uint32_t>(documentLength));
+			const Sci::Position insertLength = 1 + random.Next(16);
+			rs.InsertSpace(position, insertLength);
+			rs.DeleteRange(position, insertLength);
+		}
+	});
+	PrintResult(options, "runstyles", "insert+delete", "", operationCount, seconds);
+
+	size_t runs = 0;
+	seconds = BestTime(options.repeat, [&]() {
+		runs = 0;
+		Sci::Position position = 0;
+		while (position < documentLength) {
+			position = rs.FindNextChange(position, documentLength);
+			runs++;
+		}
+	});
+	PrintResult(options, "runstyles", "scan", "", runs, seconds);
+}
+
+class ScintillaView {
+	HWND hwnd = nullptr;
+	SciFnDirect function = nullptr;
+	sptr_t pointer = 0;
+public:
+	explicit ScintillaView(HINSTANCE hInstance) noexcept {
+		hwnd = ::CreateWindowEx(0, L"Scintilla", nullptr, WS_OVERLAPPEDWINDOW,
+			0, 0, 1280, 800, nullptr, nullptr, hInstance, nullptr);
+		if (hwnd) {
+			function = reinterpret_cast<SciFnDirect>(::SendMessage(hwnd, SCI_GETDIRECTFUNCTION, 0, 0));
+			pointer = ::SendMessage(hwnd, SCI_GETDIRECTPOINTER, 0, 0);
+		}
+	}
+	ScintillaView(const ScintillaView &) = delete;
+	ScintillaView &operator=(const ScintillaView &) = delete;
+	~ScintillaView() {
+		if (hwnd) {
+			::DestroyWindow(hwnd);
+		}
+	}
+	bool Valid() const noexcept {
+		return function != nullptr;
+	}
+	sptr_t Call(unsigned int message, uptr_t wParam = 0, sptr_t lParam = 0) const {
+		return function(pointer, message, wParam, lParam);
+	}
+};
+
+void SetupView(const ScintillaView &view, const SyntheticText &synthetic, int technology) {
+	view.Call(SCI_SETTECHNOLOGY, technology);
+	view.Call(SCI_SETCODEPAGE, SC_CP_UTF8);
+	view.Call(SCI_SETUNDOCOLLECTION, 0);
+	view.Call(SCI_STYLESETFONT, STYLE_DEFAULT, reinterpret_cast<sptr_t>(fontName));
+	view.Call(SCI_STYLESETSIZE, STYLE_DEFAULT, static_cast<int>(fontSize));
+	view.Call(SCI_STYLECLEARALL);
+	for (int style = 1; style < 8; style++) {
+		view.Call(SCI_STYLESETFORE, style, RGB(style*32, 128 - style*16, 255 - style*32));
+	}
+	view.Call(SCI_SETTEXT, 0, reinterpret_cast<sptr_t>(synthetic.text.c_str()));
+	view.Call(SCI_STARTSTYLING, 0);
+	view.Call(SCI_SETSTYLINGEX, synthetic.styles.size(), reinterpret_cast<sptr_t>(synthetic.styles.data()));
+}
+
+void LayoutAllLines(const ScintillaView &view) {
+	// drop cached layouts but keep the position cache
+	view.Call(SCI_SETLAYOUTCACHE, SC_CACHE_CARET);
+	view.Call(SCI_SETLAYOUTCACHE, SC_CACHE_NONE);
+	const sptr_t lineCount = view.Call(SCI_GETLINECOUNT);
+	for (sptr_t line = 0; line < lineCount; line++) {
+		const sptr_t position = view.Call(SCI_GETLINEENDPOSITION, line);
+		view.Call(SCI_POINTXFROMPOSITION, 0, position);
+	}
+}
+
+void BenchLayout(const BenchOptions &options, HINSTANCE hInstance, const std::vector<SyntheticText> &texts, int technology, const char *techName) {
+	ScintillaView view(hInstance);
+	if (!view.Valid()) {
+		fprintf(stderr, "create Scintilla window fail: %lu\n", ::GetLastError());
+		return;
+	}
+	for (const SyntheticText &synthetic : texts) {
+		SetupView(view, synthetic, technology);
+		if (view.Call(SCI_GETTECHNOLOGY) != technology) {
+			return;
+		}
+		char variant[32];
+		view.Call(SCI_SETPOSITIONCACHE, 1024);
+		double seconds = BestTime(options.repeat, [&]() {
+			LayoutAllLines(view);
+		});
+		sprintf(variant, "%s hit", synthetic.name);
+		PrintResult(options, "layout", variant, techName, synthetic.text.size(), seconds);
+
+		view.Call(SCI_SETPOSITIONCACHE, 0);
+		seconds = BestTime(options.repeat, [&]() {
+			LayoutAllLines(view);
+		});
+		sprintf(variant, "%s miss", synthetic.name);
+		PrintResult(options, "layout", variant, techName, synthetic.text.size(), seconds);
+	}
+}
+
+// split text into segments similar to what BreakFinder passes to the position cache.
+std::vector<std::string_view> SplitSegments(const std::string &text) {
+	std::vector<std::string_view> segments;
+	const char *ptr = text.data();
+	const char * const end = ptr + text.size();
+	while (ptr < end) {
+		size_t length = std::min<size_t>(segmentLength, end - ptr);
+		// don't split UTF-8 sequence
+		while (ptr + length < end && (static_cast<unsigned char>(ptr[length]) & 0xC0) == 0x80) {
+			++length;
+		}
+		const char *newline = static_cast<const char *>(memchr(ptr, '\n', length));
+		if (newline) {
+			length = newline - ptr;
+			if (length == 0) {
+				++ptr;
+				continue;
+			}
+		}
+		segments.emplace_back(ptr, length);
+		ptr += length;
+	}
+	return segments;
+}
+
+void BenchSurface(const BenchOptions &options, HWND hwnd, const std::vector<SyntheticText> &texts, Technology technology, const char *techName) {
+	const FontParameters fp(fontName, fontSize, FontWeight::Normal, false, FontQuality::QualityDefault, technology);
+	const std::shared_ptr<Font> font = Font::Allocate(fp);
+	const SurfaceMode mode(SC_CP_UTF8, false);
+
+	HDC hdcScreen = ::GetDC(hwnd);
+	HDC hdc = ::CreateCompatibleDC(hdcScreen);
+	HBITMAP hbm = ::CreateCompatibleBitmap(hdcScreen, surfaceWidth, surfaceHeight);
+	::ReleaseDC(hwnd, hdcScreen);
+	HGDIOBJ hbmOld = ::SelectObject(hdc, hbm);
+
+	for (const SyntheticText &synthetic : texts) {
+		const std::vector<std::string_view> segments = SplitSegments(synthetic.text);
+		size_t maxLength = 0;
+		for (const std::string_view segment : segments) {
+			maxLength = std::max(maxLength, segment.length());
+		}
+		std::vector<XYPOSITION> positions(maxLength);
+		const size_t items = synthetic.text.size();
+		std::unique_ptr<Surface> surface = Surface::Allocate(technology);
+		surface->Init(hwnd);
+		surface->SetMode(mode);
+		if (Selected(options, "measure")) {
+			const double seconds = BestTime(options.repeat, [&]() {
+				for (const std::string_view segment : segments) {
+					surface->MeasureWidthsUTF8(font.get(), segment, positions.data());
+				}
+			});
+			PrintResult(options, "measure", synthetic.name, techName, items, seconds);
+		}
+		if (!Selected(options, "draw")) {
+			continue;
+		}
+
+		const XYPOSITION ascent = surface->Ascent(font.get());
+		const XYPOSITION lineHeight = std::max<XYPOSITION>(surface->Height(font.get()), 1);
+		const auto drawAll = [&](Surface &target) {
+			XYPOSITION top = 0;
+			for (const std::string_view segment : segments) {
+				const PRectangle rc(0, top, surfaceWidth, top + lineHeight);
+				target.DrawTextNoClipUTF8(rc, font.get(), top + ascent, segment, ColourRGBA(0, 0, 0), ColourRGBA(0xff, 0xff, 0xff));
+				top += lineHeight;
+				if (top + lineHeight > surfaceHeight) {
+					top = 0;
+				}
+			}
+		};
+
+		double seconds = 0;
+		if (technology == Technology::Default) {
+			surface->Init(hdc, hwnd);
+			surface->SetMode(mode);
+			seconds = BestTime(options.repeat, [&]() {
+				drawAll(*surface);
+				::GdiFlush();
+			});
+		} else {
+#if defined(USE_D2D)
+			const D2D1_RENDER_TARGET_PROPERTIES props = D2D1::RenderTargetProperties(
+				D2D1_RENDER_TARGET_TYPE_DEFAULT,
+				D2D1::PixelFormat(
+					DXGI_FORMAT_B8G8R8A8_UNORM,
+					D2D1_ALPHA_MODE_IGNORE),
+				0,
+				0,
+				D2D1_RENDER_TARGET_USAGE_NONE,
+				D2D1_FEATURE_LEVEL_DEFAULT
+			);
+			ID2D1DCRenderTarget *pDCRT = nullptr;
+			HRESULT hr = pD2DFactory->CreateDCRenderTarget(&props, &pDCRT);
+			if (SUCCEEDED(hr) && pDCRT) {
+				const RECT rcBind = { 0, 0, surfaceWidth, surfaceHeight };
+				hr = pDCRT->BindDC(hdc, &rcBind);
+				if (SUCCEEDED(hr)) {
+					surface->Init(pDCRT, hwnd);
+					surface->SetMode(mode);
+					seconds = BestTime(options.repeat, [&]() {
+						pDCRT->BeginDraw();
+						drawAll(*surface);
+						surface->FlushDrawing();
+						pDCRT->EndDraw();
+					});
+				}
+				surface->Release();
+				ReleaseUnknown(pDCRT);
+			}
+			if (FAILED(hr)) {
+				fprintf(stderr, "create D2D render target fail: %08lx\n", static_cast<unsigned long>(hr));
+				continue;
+			}
+#endif
+		}
+		PrintResult(options, "draw", synthetic.name, techName, items, seconds);
+	}
+
+	::SelectObject(hdc, hbmOld);
+	::DeleteObject(hbm);
+	::DeleteDC(hdc);
+}
+
+bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (strcmp(arg, "-json") == 0) {
+			options.json = true;
+		} else if (strcmp(arg, "-repeat") == 0 && i + 1 < argc) {
+			options.repeat = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-length") == 0 && i + 1 < argc) {
+			options.lineLength = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-lines") == 0 && i + 1 < argc) {
+			options.lineCount = std::max(atoi(argv[++i]), 1);
+		} else if (strcmp(arg, "-case") == 0 && i + 1 < argc) {
+			options.filter = argv[++i];
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options)) {
+		fprintf(stderr, "usage: %s [-json] [-repeat count] [-length chars] [-lines count] [-case runstyles|layout|measure|draw]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// stable timing: run on one CPU with high priority
+	::SetProcessAffinityMask(::GetCurrentProcess(), 1);
+	::SetPriorityClass(::GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+	::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+	HINSTANCE hInstance = ::GetModuleHandle(nullptr);
+	Scintilla_LoadDpiForWindow();
+	Scintilla_RegisterClasses(hInstance);
+
+	const std::vector<SyntheticText> texts = {
+		MakeText("plain", options, false, false),
+		MakeText("styled", options, true, false),
+		MakeText("utf8", options, true, true),
+	};
+
+	struct TechnologyInfo {
+		int technology;
+		const char *name;
+	};
+	std::vector<TechnologyInfo> technologies = { { SC_TECHNOLOGY_DEFAULT, "gdi" } };
+#if defined(USE_D2D)
+	if (LoadD2D()) {
+		technologies.push_back({ SC_TECHNOLOGY_DIRECTWRITE, "d2d" });
+	}
+#endif
+
+	if (options.json) {
+		printf("[\n");
+	} else {
+		printf("%-10s %-16s %-12s %12s %10s %10s\n", "case", "variant", "technology", "items", "ms", "ns/item");
+	}
+	if (Selected(options, "runstyles")) {
+		BenchRunStyles(options, texts.front().text.size());
+	}
+	if (Selected(options, "layout")) {
+		for (const TechnologyInfo &info : technologies) {
+			BenchLayout(options, hInstance, texts, info.technology, info.name);
+		}
+	}
+	if (Selected(options, "measure") || Selected(options, "draw")) {
+		HWND hwnd = ::CreateWindowEx(0, L"Static", nullptr, WS_OVERLAPPEDWINDOW,
+			0, 0, surfaceWidth, surfaceHeight, nullptr, nullptr, hInstance, nullptr);
+		for (const TechnologyInfo &info : technologies) {
+			BenchSurface(options, hwnd, texts, static_cast<Technology>(info.technology), info.name);
+		}
+		::DestroyWindow(hwnd);
+	}
+	if (options.json) {
+		printf("{\"case\": \"end\"}\n]\n");
+	}
+
+	Scintilla_ReleaseResources();
+	return EXIT_SUCCESS;
+}
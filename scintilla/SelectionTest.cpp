@@ -0,0 +1,109 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//! Regression test for Selection, compares trimming of many ranges (which uses the range index)
+//! with trimming the same ranges one by one.
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+
+#include "Debugging.h"
+#include "Position.h"
+#include "Selection.h"
+
+// cl /EHsc /std:c++17 /DNDEBUG /O2 /W4 /Isrc /Iinclude SelectionTest.cpp src\Selection.cxx
+// g++ -std=gnu++17 -DNDEBUG -O2 -Wall -Wextra -Isrc -Iinclude SelectionTest.cpp src/Selection.cxx -o SelectionTest
+// usage: SelectionTest [iterations]
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+uint32_t seed = 1;
+
+uint32_t Random(uint32_t range) noexcept {
+	seed = seed*1103515245 + 12345;
+	return (seed >> 8) % range;
+}
+
+// unindexed Selection::AddSelection()
+void AddSelection(std::vector<SelectionRange> &ranges, size_t &mainRange, SelectionRange range) {
+	for (size_t i = 0; i < ranges.size();) {
+		if (i != mainRange && ranges[i].Trim(range)) {
+			ranges.erase(ranges.begin() + i);
+			if (i < mainRange) {
+				mainRange--;
+			}
+		} else {
+			i++;
+		}
+	}
+	ranges.push_back(range);
+	mainRange = ranges.size() - 1;
+}
+
+bool Same(const Selection &sel, const std::vector<SelectionRange> &ranges, size_t mainRange) {
+	if (sel.Count() != ranges.size() || sel.Main() != mainRange) {
+		return false;
+	}
+	for (size_t r = 0; r < ranges.size(); r++) {
+		if (!(sel.Range(r) == ranges[r])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// range 0 contains the added range and is trimmed to empty at its start
+bool TestCoveringRange() {
+	Selection sel;
+	sel.SetSelection(SelectionRange(200, 100));
+	for (Sci::Position i = 0; i < 31; i++) {
+		sel.AddSelection(SelectionRange(1000 + i*10));
+	}
+	sel.AddSelection(SelectionRange(160, 150));
+	if (sel.Count() != 32 || sel.Main() != 31) {
+		printf("covering range fail: %zu ranges, main %zu\n", sel.Count(), sel.Main());
+		return false;
+	}
+	return true;
+}
+
+bool TestRandom(int iterations) {
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		Selection sel;
+		sel.SetSelection(SelectionRange(0));
+		std::vector<SelectionRange> ranges{SelectionRange(0)};
+		size_t mainRange = 0;
+		const int count = 32 + Random(200);
+		for (int i = 0; i < count; i++) {
+			const Sci::Position anchor = Random(4000);
+			const Sci::Position caret = Random(4) ? anchor + Random(40) : anchor;
+			const SelectionRange range(caret, anchor);
+			sel.AddSelection(range);
+			AddSelection(ranges, mainRange, range);
+			if (!Same(sel, ranges, mainRange)) {
+				printf("random fail: iteration %d, add %d [%td, %td], %zu ranges, expected %zu\n",
+					iteration, i, anchor, caret, sel.Count(), ranges.size());
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	const int iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+	bool ok = TestCoveringRange();
+	ok = TestRandom(iterations) && ok;
+	printf("%s\n", ok ? "pass" : "fail");
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -346,6 +346,14 @@ int ScintillaCall::GetNextTabStop(Line line, int x) {
 	return static_cast<int>(Call(Message::GetNextTabStop, line, x));
 }
 
+void ScintillaCall::SetFieldDelimiter(int delimiter) {
+	Call(Message::SetFieldDelimiter, delimiter);
+}
+
+int ScintillaCall::FieldDelimiter() {
+	return static_cast<int>(Call(Message::GetFieldDelimiter));
+}
+
 void ScintillaCall::SetCodePage(int codePage) {
 	Call(Message::SetCodePage, codePage);
 }
@@ -630,6 +638,10 @@ bool ScintillaCall::StyleGetCheckMonospaced(int style) {
 	return Call(Message::StyleGetCheckMonospaced, style);
 }
 
+void ScintillaCall::StyleSetDefinitions(Position count, void *definitions) {
+	CallPointer(Message::StyleSetDefinitions, count, definitions);
+}
+
 void ScintillaCall::SetElementColour(Scintilla::Element element, ColourAlpha colourElement) {
 	Call(Message::SetElementColour, static_cast<uintptr_t>(element), colourElement);
 }
@@ -750,6 +762,14 @@ void ScintillaCall::EndUndoAction() {
 	Call(Message::EndUndoAction);
 }
 
+void ScintillaCall::BeginBulkModification() {
+	Call(Message::BeginBulkModification);
+}
+
+void ScintillaCall::EndBulkModification() {
+	Call(Message::EndBulkModification);
+}
+
 void ScintillaCall::IndicSetStyle(int indicator, Scintilla::IndicatorStyle indicatorStyle) {
 	Call(Message::IndicSetStyle, indicator, static_cast<intptr_t>(indicatorStyle));
 }
@@ -1202,6 +1222,18 @@ void ScintillaCall::EmptyUndoBuffer() {
 	Call(Message::EmptyUndoBuffer);
 }
 
+void ScintillaCall::SetUndoMemoryBudget(Position bytes) {
+	Call(Message::SetUndoMemoryBudget, bytes);
+}
+
+Position ScintillaCall::UndoMemoryBudget() {
+	return Call(Message::GetUndoMemoryBudget);
+}
+
+Position ScintillaCall::UndoMemoryUsage() {
+	return Call(Message::GetUndoMemoryUsage);
+}
+
 void ScintillaCall::Undo() {
 	Call(Message::Undo);
 }
@@ -1326,6 +1358,18 @@ Position ScintillaCall::ReplaceTargetRE(Position length, const char *text) {
 	return CallString(Message::ReplaceTargetRE, length, text);
 }
 
+Position ScintillaCall::SubstituteTargetRE(const char *text, char *substituted) {
+	return CallPointer(Message::SubstituteTargetRE, reinterpret_cast<uintptr_t>(text), substituted);
+}
+
+std::string ScintillaCall::SubstituteTargetRE(const char *text) {
+	return CallReturnString(Message::SubstituteTargetRE, reinterpret_cast<uintptr_t>(text));
+}
+
+Position ScintillaCall::ReplaceRanges(Position count, void *ranges) {
+	return CallPointer(Message::ReplaceRanges, count, ranges);
+}
+
 Position ScintillaCall::SearchInTarget(Position length, const char *text) {
 	return CallString(Message::SearchInTarget, length, text);
 }
@@ -1546,6 +1590,22 @@ IdleStyling ScintillaCall::IdleStyling() {
 	return static_cast<Scintilla::IdleStyling>(Call(Message::GetIdleStyling));
 }
 
+void ScintillaCall::SetStyleWindow(Position windowSize) {
+	Call(Message::SetStyleWindow, windowSize);
+}
+
+Position ScintillaCall::StyleWindow() {
+	return Call(Message::GetStyleWindow);
+}
+
+void ScintillaCall::SetStyleBudget(int milliseconds) {
+	Call(Message::SetStyleBudget, milliseconds);
+}
+
+int ScintillaCall::StyleBudget() {
+	return static_cast<int>(Call(Message::GetStyleBudget));
+}
+
 void ScintillaCall::SetWrapMode(Scintilla::Wrap wrapMode) {
 	Call(Message::SetWrapMode, static_cast<uintptr_t>(wrapMode));
 }
@@ -1594,6 +1654,26 @@ LineCache ScintillaCall::LayoutCache() {
 	return static_cast<Scintilla::LineCache>(Call(Message::GetLayoutCache));
 }
 
+void ScintillaCall::SetLayoutCacheBudget(Position bytes) {
+	Call(Message::SetLayoutCacheBudget, bytes);
+}
+
+Position ScintillaCall::LayoutCacheBudget() {
+	return Call(Message::GetLayoutCacheBudget);
+}
+
+Position ScintillaCall::LayoutCacheMemory() {
+	return Call(Message::GetLayoutCacheMemory);
+}
+
+void ScintillaCall::SetPaintTiming(bool timing) {
+	Call(Message::SetPaintTiming, timing);
+}
+
+bool ScintillaCall::PaintTiming() {
+	return Call(Message::GetPaintTiming);
+}
+
 void ScintillaCall::SetScrollWidth(int pixelWidth) {
 	Call(Message::SetScrollWidth, pixelWidth);
 }
@@ -1958,14 +2038,26 @@ void ScintillaCall::BraceBadLightIndicator(bool useSetting, int indicator) {
 	Call(Message::BraceBadLightIndicator, useSetting, indicator);
 }
 
-Position ScintillaCall::BraceMatch(Position pos, int maxReStyle) {
-	return Call(Message::BraceMatch, pos, maxReStyle);
+Position ScintillaCall::BraceMatch(Position pos, Position maxDistance) {
+	return Call(Message::BraceMatch, pos, maxDistance);
 }
 
 Position ScintillaCall::BraceMatchNext(Position pos, Position startPos) {
 	return Call(Message::BraceMatchNext, pos, startPos);
 }
 
+void ScintillaCall::SetTagStyle(int style, bool tag) {
+	Call(Message::SetTagStyle, style, tag);
+}
+
+void ScintillaCall::SetVoidTags(bool caseSensitive, const char *tags) {
+	CallString(Message::SetVoidTags, caseSensitive, tags);
+}
+
+Position ScintillaCall::FindTag(Position pos, Scintilla::TagFind which) {
+	return Call(Message::FindTag, pos, static_cast<intptr_t>(which));
+}
+
 bool ScintillaCall::ViewEOL() {
 	return Call(Message::GetViewEOL);
 }
@@ -2070,6 +2162,10 @@ DocumentOption ScintillaCall::DocumentOptions() {
 	return static_cast<Scintilla::DocumentOption>(Call(Message::GetDocumentOptions));
 }
 
+void ScintillaCall::ConvertToLargeDocument(Scintilla::DocumentOption documentOptions) {
+	Call(Message::ConvertToLargeDocument, static_cast<uintptr_t>(documentOptions));
+}
+
 ModificationFlags ScintillaCall::ModEventMask() {
 	return static_cast<Scintilla::ModificationFlags>(Call(Message::GetModEventMask));
 }
@@ -2402,6 +2498,14 @@ void ScintillaCall::Allocate(Position bytes) {
 	Call(Message::Allocate, bytes);
 }
 
+void ScintillaCall::SetLargePages(bool useLargePages) {
+	Call(Message::SetLargePages, useLargePages);
+}
+
+bool ScintillaCall::GetLargePages() {
+	return Call(Message::GetLargePages);
+}
+
 Position ScintillaCall::TargetAsUTF8(char *s) {
 	return CallPointer(Message::TargetAsUTF8, 0, s);
 }
@@ -2486,6 +2590,10 @@ void ScintillaCall::IndicatorClearRange(Position start, Position lengthClear) {
 	Call(Message::IndicatorClearRange, start, lengthClear);
 }
 
+void ScintillaCall::IndicatorFillRanges(Position count, void *ranges) {
+	CallPointer(Message::IndicatorFillRanges, count, ranges);
+}
+
 int ScintillaCall::IndicatorAllOnFor(Position pos) {
 	return static_cast<int>(Call(Message::IndicatorAllOnFor, pos));
 }
@@ -2510,6 +2618,34 @@ int ScintillaCall::PositionCache() {
 	return static_cast<int>(Call(Message::GetPositionCache));
 }
 
+void ScintillaCall::SetLayoutThreads(int threads) {
+	Call(Message::SetLayoutThreads, threads);
+}
+
+int ScintillaCall::LayoutThreads() {
+	return static_cast<int>(Call(Message::GetLayoutThreads));
+}
+
+Position ScintillaCall::PositionCacheStatistic(Scintilla::PositionCacheStatistic statistic) {
+	return Call(Message::GetPositionCacheStatistic, static_cast<uintptr_t>(statistic));
+}
+
+void ScintillaCall::ResetPositionCacheStatistics() {
+	Call(Message::ResetPositionCacheStatistics);
+}
+
+Position ScintillaCall::MemoryUsage(Scintilla::MemoryUsage usage) {
+	return Call(Message::GetMemoryUsage, static_cast<uintptr_t>(usage));
+}
+
+Position ScintillaCall::StylingStatistic(Scintilla::StylingStatistic statistic) {
+	return Call(Message::GetStylingStatistic, static_cast<uintptr_t>(statistic));
+}
+
+void ScintillaCall::ResetStylingStatistics() {
+	Call(Message::ResetStylingStatistics);
+}
+
 void ScintillaCall::CopyAllowLine() {
 	Call(Message::CopyAllowLine);
 }
@@ -2526,6 +2662,22 @@ Position ScintillaCall::GapPosition() {
 	return Call(Message::GetGapPosition);
 }
 
+void *ScintillaCall::SegmentPointer(Position pos, void *segmentEnd) {
+	return reinterpret_cast<void *>(CallPointer(Message::GetSegmentPointer, pos, segmentEnd));
+}
+
+void *ScintillaCall::StyleRangePointer(Position start, Position lengthRange) {
+	return reinterpret_cast<void *>(Call(Message::GetStyleRangePointer, start, lengthRange));
+}
+
+void *ScintillaCall::AcquireTextSnapshot() {
+	return reinterpret_cast<void *>(Call(Message::AcquireTextSnapshot));
+}
+
+void ScintillaCall::ReleaseTextSnapshot(void *snapshot) {
+	CallPointer(Message::ReleaseTextSnapshot, 0, snapshot);
+}
+
 void ScintillaCall::IndicSetAlpha(int indicator, Scintilla::Alpha alpha) {
 	Call(Message::IndicSetAlpha, indicator, static_cast<intptr_t>(alpha));
 }
@@ -286,3 +286,18 @@ static inline __m128i rgba_to_bgra_epi32_sse4_si32(uint32_t color) NP2_noexcept
 #endif
 }
 #endif // NP2_USE_AVX2
+
+#if NP2_USE_NEON
+static inline uint8x8_t neon_div_u16_by_255(uint16x8_t value) NP2_noexcept {
+	// uint16_t value / 255 => (value + 1 + (value >> 8)) >> 8, exact for value <= 255*255
+	return vshrn_n_u16(vaddq_u16(vaddq_u16(value, vdupq_n_u16(1)), vshrq_n_u16(value, 8)), 8);
+}
+
+// (fore*alpha + back*(255 - alpha)) / 255 for one color channel of 16 pixels
+static inline uint8x16_t neon_alpha_blend_u8x16(uint8x16_t fore, uint8x16_t alpha, uint8x8_t back) NP2_noexcept {
+	const uint8x16_t inverse = vmvnq_u8(alpha);
+	const uint16x8_t lo = vmlal_u8(vmull_u8(back, vget_low_u8(inverse)), vget_low_u8(fore), vget_low_u8(alpha));
+	const uint16x8_t hi = vmlal_u8(vmull_u8(back, vget_high_u8(inverse)), vget_high_u8(fore), vget_high_u8(alpha));
+	return vcombine_u8(neon_div_u16_by_255(lo), neon_div_u16_by_255(hi));
+}
+#endif // NP2_USE_NEON
@@ -40,6 +40,8 @@ public:
 	virtual Sci_Position SCI_METHOD LineEnd(Sci_Line line) const noexcept = 0;
 	virtual Sci_Position SCI_METHOD GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const noexcept = 0;
 	virtual int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const noexcept = 0;
+	// narrow [*pStart, *pEnd) to contiguous text around position, return pointer to text at *pStart.
+	virtual const char * SCI_METHOD CharRangePointer(Sci_Position position, Sci_Position *pStart, Sci_Position *pEnd) const noexcept = 0;
 };
 
 enum {
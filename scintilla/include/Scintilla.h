@@ -107,6 +107,8 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_CLEARTABSTOPS 2675
 #define SCI_ADDTABSTOP 2676
 #define SCI_GETNEXTTABSTOP 2677
+#define SCI_SETFIELDDELIMITER 2805
+#define SCI_GETFIELDDELIMITER 2806
 #define SC_CP_UTF8 65001
 #define SCI_SETCODEPAGE 2037
 #define SCI_SETFONTLOCALE 2760
@@ -277,6 +279,19 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_STYLESETHOTSPOT 2409
 #define SCI_STYLESETCHECKMONOSPACED 2254
 #define SCI_STYLEGETCHECKMONOSPACED 2255
+#define SC_STYLEDEFINITION_NONE 0x0000
+#define SC_STYLEDEFINITION_FONT 0x0001
+#define SC_STYLEDEFINITION_SIZE 0x0002
+#define SC_STYLEDEFINITION_FORE 0x0004
+#define SC_STYLEDEFINITION_BACK 0x0008
+#define SC_STYLEDEFINITION_WEIGHT 0x0010
+#define SC_STYLEDEFINITION_ITALIC 0x0020
+#define SC_STYLEDEFINITION_UNDERLINE 0x0040
+#define SC_STYLEDEFINITION_STRIKE 0x0080
+#define SC_STYLEDEFINITION_EOLFILLED 0x0100
+#define SC_STYLEDEFINITION_CASE 0x0200
+#define SC_STYLEDEFINITION_CHARACTERSET 0x0400
+#define SCI_STYLESETDEFINITIONS 2795
 #define SC_ELEMENT_LIST 0
 #define SC_ELEMENT_LIST_BACK 1
 #define SC_ELEMENT_LIST_SELECTED 2
@@ -330,6 +345,8 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_GETCHARACTERCATEGORYOPTIMIZATION 2721
 #define SCI_BEGINUNDOACTION 2078
 #define SCI_ENDUNDOACTION 2079
+#define SCI_BEGINBULKMODIFICATION 2799
+#define SCI_ENDBULKMODIFICATION 2800
 #define INDIC_PLAIN 0
 #define INDIC_SQUIGGLE 1
 #define INDIC_TT 2
@@ -403,6 +420,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_AUTOCGETAUTOHIDE 2119
 #define SC_AUTOCOMPLETE_NORMAL 0
 #define SC_AUTOCOMPLETE_FIXED_SIZE 1
+#define SC_AUTOCOMPLETE_FUZZY_MATCH 4
 #define SCI_AUTOCSETOPTIONS 2638
 #define SCI_AUTOCGETOPTIONS 2639
 #define SCI_AUTOCSETDROPRESTOFWORD 2270
@@ -461,6 +479,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCFIND_WORDSTART 0x00100000
 #define SCFIND_REGEXP 0x00200000
 #define SCFIND_POSIX 0x00400000
+#define SCFIND_LINEARREGEX 0x00800000
 #define SCFIND_CXX11REGEX 0x00800000
 #define SCI_FINDTEXT 2150
 #define SCI_FORMATRANGE 2151
@@ -490,6 +509,9 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_CANPASTE 2173
 #define SCI_CANUNDO 2174
 #define SCI_EMPTYUNDOBUFFER 2175
+#define SCI_SETUNDOMEMORYBUDGET 2786
+#define SCI_GETUNDOMEMORYBUDGET 2787
+#define SCI_GETUNDOMEMORYUSAGE 2788
 #define SCI_UNDO 2176
 #define SCI_CUT 2177
 #define SCI_COPY 2178
@@ -519,6 +541,8 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_TARGETWHOLEDOCUMENT 2690
 #define SCI_REPLACETARGET 2194
 #define SCI_REPLACETARGETRE 2195
+#define SCI_SUBSTITUTETARGETRE 2789
+#define SCI_REPLACERANGES 2794
 #define SCI_SEARCHINTARGET 2197
 #define SCI_SETSEARCHFLAGS 2198
 #define SCI_GETSEARCHFLAGS 2199
@@ -600,8 +624,13 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SC_IDLESTYLING_TOVISIBLE 1
 #define SC_IDLESTYLING_AFTERVISIBLE 2
 #define SC_IDLESTYLING_ALL 3
+#define SC_IDLESTYLING_BACKGROUND 4
 #define SCI_SETIDLESTYLING 2692
 #define SCI_GETIDLESTYLING 2693
+#define SCI_SETSTYLEWINDOW 2775
+#define SCI_GETSTYLEWINDOW 2776
+#define SCI_SETSTYLEBUDGET 2807
+#define SCI_GETSTYLEBUDGET 2808
 #define SC_WRAP_NONE 0
 #define SC_WRAP_WORD 1
 #define SC_WRAP_CHAR 2
@@ -634,6 +663,11 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SC_CACHE_DOCUMENT 3
 #define SCI_SETLAYOUTCACHE 2272
 #define SCI_GETLAYOUTCACHE 2273
+#define SCI_SETLAYOUTCACHEBUDGET 2781
+#define SCI_GETLAYOUTCACHEBUDGET 2782
+#define SCI_GETLAYOUTCACHEMEMORY 2783
+#define SCI_SETPAINTTIMING 2784
+#define SCI_GETPAINTTIMING 2785
 #define SCI_SETSCROLLWIDTH 2274
 #define SCI_GETSCROLLWIDTH 2275
 #define SCI_SETSCROLLWIDTHTRACKING 2516
@@ -741,6 +775,13 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_BRACEBADLIGHTINDICATOR 2499
 #define SCI_BRACEMATCH 2353
 #define SCI_BRACEMATCHNEXT 2369
+#define SCI_SETTAGSTYLE 2809
+#define SCI_SETVOIDTAGS 2810
+#define SC_TAGFIND_START 0
+#define SC_TAGFIND_END 1
+#define SC_TAGFIND_MATCH 2
+#define SC_TAGFIND_ENCLOSING 3
+#define SCI_FINDTAG 2811
 #define SCI_GETVIEWEOL 2355
 #define SCI_SETVIEWEOL 2356
 #define SCI_GETDOCPOINTER 2357
@@ -774,11 +815,16 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_GETZOOM 2374
 #define SC_DOCUMENTOPTION_DEFAULT 0
 #define SC_DOCUMENTOPTION_STYLES_NONE 0x1
+#define SC_DOCUMENTOPTION_STYLES_COMPRESSED 0x2
 #define SC_DOCUMENTOPTION_TEXT_LARGE 0x100
+#define SC_DOCUMENTOPTION_TEXT_CHUNKED 0x200
+#define SC_DOCUMENTOPTION_LINES_COMPACT 0x400
+#define SC_DOCUMENTOPTION_TEXT_COMPRESSED 0x800
 #define SCI_CREATEDOCUMENT 2375
 #define SCI_ADDREFDOCUMENT 2376
 #define SCI_RELEASEDOCUMENT 2377
 #define SCI_GETDOCUMENTOPTIONS 2379
+#define SCI_CONVERTTOLARGEDOCUMENT 2791
 #define SCI_GETMODEVENTMASK 2378
 #define SCI_SETCOMMANDEVENTS 2717
 #define SCI_GETCOMMANDEVENTS 2718
@@ -881,6 +927,8 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_AUTOCSETORDER 2660
 #define SCI_AUTOCGETORDER 2661
 #define SCI_ALLOCATE 2446
+#define SCI_SETLARGEPAGES 2803
+#define SCI_GETLARGEPAGES 2804
 #define SCI_TARGETASUTF8 2447
 #define SCI_SETLENGTHFORENCODE 2448
 #define SCI_ENCODEDFROMUTF8 2449
@@ -910,16 +958,44 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_GETINDICATORVALUE 2503
 #define SCI_INDICATORFILLRANGE 2504
 #define SCI_INDICATORCLEARRANGE 2505
+#define SCI_INDICATORFILLRANGES 2792
 #define SCI_INDICATORALLONFOR 2506
 #define SCI_INDICATORVALUEAT 2507
 #define SCI_INDICATORSTART 2508
 #define SCI_INDICATOREND 2509
 #define SCI_SETPOSITIONCACHE 2514
 #define SCI_GETPOSITIONCACHE 2515
+#define SCI_SETLAYOUTTHREADS 2777
+#define SCI_GETLAYOUTTHREADS 2778
+#define SC_POSITIONCACHESTATISTIC_HITS 0
+#define SC_POSITIONCACHESTATISTIC_MISSES 1
+#define SC_POSITIONCACHESTATISTIC_EVICTIONS 2
+#define SCI_GETPOSITIONCACHESTATISTIC 2779
+#define SCI_RESETPOSITIONCACHESTATISTICS 2780
+#define SC_MEMORYUSAGE_TOTAL 0
+#define SC_MEMORYUSAGE_TEXT 1
+#define SC_MEMORYUSAGE_STYLES 2
+#define SC_MEMORYUSAGE_LINES 3
+#define SC_MEMORYUSAGE_UNDO 4
+#define SC_MEMORYUSAGE_MARKERS 5
+#define SC_MEMORYUSAGE_LINE_DATA 6
+#define SC_MEMORYUSAGE_INDICATORS 7
+#define SC_MEMORYUSAGE_LAYOUT_CACHE 8
+#define SC_MEMORYUSAGE_POSITION_CACHE 9
+#define SCI_GETMEMORYUSAGE 2790
+#define SC_STYLINGSTATISTIC_DURATION 0
+#define SC_STYLINGSTATISTIC_BYTES 1
+#define SC_STYLINGSTATISTIC_TIME 2
+#define SCI_GETSTYLINGSTATISTIC 2797
+#define SCI_RESETSTYLINGSTATISTICS 2798
 #define SCI_COPYALLOWLINE 2519
 #define SCI_GETCHARACTERPOINTER 2520
 #define SCI_GETRANGEPOINTER 2643
 #define SCI_GETGAPPOSITION 2644
+#define SCI_GETSEGMENTPOINTER 2793
+#define SCI_GETSTYLERANGEPOINTER 2796
+#define SCI_ACQUIRETEXTSNAPSHOT 2801
+#define SCI_RELEASETEXTSNAPSHOT 2802
 #define SCI_INDICSETALPHA 2523
 #define SCI_INDICGETALPHA 2524
 #define SCI_INDICSETOUTLINEALPHA 2558
@@ -1087,6 +1163,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SC_SUPPORTS_FRACTIONAL_STROKE_WIDTH 2
 #define SC_SUPPORTS_TRANSLUCENT_STROKE 3
 #define SC_SUPPORTS_PIXEL_MODIFICATION 4
+#define SC_SUPPORTS_THREAD_SAFE_MEASURE_WIDTHS 5
 #define SCI_SUPPORTSFEATURE 2750
 #define SC_LINECHARACTERINDEX_NONE 0
 #define SC_LINECHARACTERINDEX_UTF32 1
@@ -1157,7 +1234,8 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SC_MOD_INSERTCHECK 0x100000
 #define SC_MOD_CHANGETABSTOPS 0x200000
 #define SC_MOD_CHANGEEOLANNOTATION 0x400000
-#define SC_MODEVENTMASKALL 0x7FFFFF
+#define SC_MOD_BULKMODIFICATION 0x800000
+#define SC_MODEVENTMASKALL 0xFFFFFF
 #define SC_UPDATE_NONE 0x0
 #define SC_UPDATE_CONTENT 0x1
 #define SC_UPDATE_SELECTION 0x2
@@ -1234,6 +1312,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCN_AUTOCCOMPLETED 2030
 #define SCN_MARGINRIGHTCLICK 2031
 #define SCN_AUTOCSELECTIONCHANGE 2032
+#define SCN_STYLINGDEGRADED 2033
 #ifndef SCI_DISABLE_PROVISIONAL
 #define SC_BIDIRECTIONAL_DISABLED 0
 #define SC_BIDIRECTIONAL_L2R 1
@@ -1265,6 +1344,29 @@ struct Sci_TextToFind {
 	struct Sci_CharacterRange chrgText;
 };
 
+struct Sci_TextReplacement {
+	Sci_Position position;
+	Sci_Position deleteLength;
+	Sci_Position insertLength;
+	const char *text;
+};
+
+struct Sci_StyleDefinition {
+	int style;
+	int mask;
+	int fore;
+	int back;
+	int sizeFractional;
+	int weight;
+	int italic;
+	int underline;
+	int strike;
+	int eolFilled;
+	int caseForce;
+	int characterSet;
+	const char *fontName;
+};
+
 typedef void *Sci_SurfaceID;
 
 struct Sci_Rectangle {
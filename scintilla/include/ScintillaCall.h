@@ -125,6 +125,8 @@ public:
 	void ClearTabStops(Line line);
 	void AddTabStop(Line line, int x);
 	int GetNextTabStop(Line line, int x);
+	void SetFieldDelimiter(int delimiter);
+	int FieldDelimiter();
 	void SetCodePage(int codePage);
 	void SetFontLocale(const char *localeName);
 	int FontLocale(char *localeName);
@@ -196,6 +198,7 @@ public:
 	void StyleSetHotSpot(int style, bool hotspot);
 	void StyleSetCheckMonospaced(int style, bool checkMonospaced);
 	bool StyleGetCheckMonospaced(int style);
+	void StyleSetDefinitions(Position count, void *definitions);
 	void SetElementColour(Scintilla::Element element, ColourAlpha colourElement);
 	ColourAlpha ElementColour(Scintilla::Element element);
 	void ResetElementColour(Scintilla::Element element);
@@ -226,6 +229,8 @@ public:
 	int CharacterCategoryOptimization();
 	void BeginUndoAction();
 	void EndUndoAction();
+	void BeginBulkModification();
+	void EndBulkModification();
 	void IndicSetStyle(int indicator, Scintilla::IndicatorStyle indicatorStyle);
 	Scintilla::IndicatorStyle IndicGetStyle(int indicator);
 	void IndicSetFore(int indicator, Colour fore);
@@ -339,6 +344,9 @@ public:
 	bool CanPaste();
 	bool CanUndo();
 	void EmptyUndoBuffer();
+	void SetUndoMemoryBudget(Position bytes);
+	Position UndoMemoryBudget();
+	Position UndoMemoryUsage();
 	void Undo();
 	void Cut(bool asBinary);
 	void Copy(bool asBinary);
@@ -370,6 +378,9 @@ public:
 	void TargetWholeDocument();
 	Position ReplaceTarget(Position length, const char *text);
 	Position ReplaceTargetRE(Position length, const char *text);
+	Position SubstituteTargetRE(const char *text, char *substituted);
+	std::string SubstituteTargetRE(const char *text);
+	Position ReplaceRanges(Position count, void *ranges);
 	Position SearchInTarget(Position length, const char *text);
 	void SetSearchFlags(Scintilla::FindOption searchFlags);
 	Scintilla::FindOption SearchFlags();
@@ -425,6 +436,10 @@ public:
 	bool IsRangeWord(Position start, Position end);
 	void SetIdleStyling(Scintilla::IdleStyling idleStyling);
 	Scintilla::IdleStyling IdleStyling();
+	void SetStyleWindow(Position windowSize);
+	Position StyleWindow();
+	void SetStyleBudget(int milliseconds);
+	int StyleBudget();
 	void SetWrapMode(Scintilla::Wrap wrapMode);
 	Scintilla::Wrap WrapMode();
 	void SetWrapVisualFlags(Scintilla::WrapVisualFlag wrapVisualFlags);
@@ -437,6 +452,11 @@ public:
 	Scintilla::WrapIndentMode WrapIndentMode();
 	void SetLayoutCache(Scintilla::LineCache cacheMode);
 	Scintilla::LineCache LayoutCache();
+	void SetLayoutCacheBudget(Position bytes);
+	Position LayoutCacheBudget();
+	Position LayoutCacheMemory();
+	void SetPaintTiming(bool timing);
+	bool PaintTiming();
 	void SetScrollWidth(int pixelWidth);
 	int ScrollWidth();
 	void SetScrollWidthTracking(bool tracking);
@@ -528,8 +548,11 @@ public:
 	void BraceHighlightIndicator(bool useSetting, int indicator);
 	void BraceBadLight(Position pos);
 	void BraceBadLightIndicator(bool useSetting, int indicator);
-	Position BraceMatch(Position pos, int maxReStyle);
+	Position BraceMatch(Position pos, Position maxDistance);
 	Position BraceMatchNext(Position pos, Position startPos);
+	void SetTagStyle(int style, bool tag);
+	void SetVoidTags(bool caseSensitive, const char *tags);
+	Position FindTag(Position pos, Scintilla::TagFind which);
 	bool ViewEOL();
 	void SetViewEOL(bool visible);
 	void *DocPointer();
@@ -556,6 +579,7 @@ public:
 	void AddRefDocument(void *doc);
 	void ReleaseDocument(void *doc);
 	Scintilla::DocumentOption DocumentOptions();
+	void ConvertToLargeDocument(Scintilla::DocumentOption documentOptions);
 	Scintilla::ModificationFlags ModEventMask();
 	void SetCommandEvents(bool commandEvents);
 	bool CommandEvents();
@@ -639,6 +663,8 @@ public:
 	void AutoCSetOrder(Scintilla::Ordering order);
 	Scintilla::Ordering AutoCGetOrder();
 	void Allocate(Position bytes);
+	void SetLargePages(bool useLargePages);
+	bool GetLargePages();
 	Position TargetAsUTF8(char *s);
 	std::string TargetAsUTF8();
 	void SetLengthForEncode(Position bytes);
@@ -660,16 +686,28 @@ public:
 	int IndicatorValue();
 	void IndicatorFillRange(Position start, Position lengthFill);
 	void IndicatorClearRange(Position start, Position lengthClear);
+	void IndicatorFillRanges(Position count, void *ranges);
 	int IndicatorAllOnFor(Position pos);
 	int IndicatorValueAt(int indicator, Position pos);
 	Position IndicatorStart(int indicator, Position pos);
 	Position IndicatorEnd(int indicator, Position pos);
 	void SetPositionCache(int size);
 	int PositionCache();
+	void SetLayoutThreads(int threads);
+	int LayoutThreads();
+	Position PositionCacheStatistic(Scintilla::PositionCacheStatistic statistic);
+	void ResetPositionCacheStatistics();
+	Position MemoryUsage(Scintilla::MemoryUsage usage);
+	Position StylingStatistic(Scintilla::StylingStatistic statistic);
+	void ResetStylingStatistics();
 	void CopyAllowLine();
 	void *CharacterPointer();
 	void *RangePointer(Position start, Position lengthRange);
 	Position GapPosition();
+	void *SegmentPointer(Position pos, void *segmentEnd);
+	void *StyleRangePointer(Position start, Position lengthRange);
+	void *AcquireTextSnapshot();
+	void ReleaseTextSnapshot(void *snapshot);
 	void IndicSetAlpha(int indicator, Scintilla::Alpha alpha);
 	Scintilla::Alpha IndicGetAlpha(int indicator);
 	void IndicSetOutlineAlpha(int indicator, Scintilla::Alpha alpha);
@@ -64,6 +64,8 @@ enum class Message {
 	ClearTabStops = 2675,
 	AddTabStop = 2676,
 	GetNextTabStop = 2677,
+	SetFieldDelimiter = 2805,
+	GetFieldDelimiter = 2806,
 	SetCodePage = 2037,
 	SetFontLocale = 2760,
 	GetFontLocale = 2761,
@@ -133,6 +135,7 @@ enum class Message {
 	StyleSetHotSpot = 2409,
 	StyleSetCheckMonospaced = 2254,
 	StyleGetCheckMonospaced = 2255,
+	StyleSetDefinitions = 2795,
 	SetElementColour = 2753,
 	GetElementColour = 2754,
 	ResetElementColour = 2755,
@@ -162,6 +165,8 @@ enum class Message {
 	GetCharacterCategoryOptimization = 2721,
 	BeginUndoAction = 2078,
 	EndUndoAction = 2079,
+	BeginBulkModification = 2799,
+	EndBulkModification = 2800,
 	IndicSetStyle = 2080,
 	IndicGetStyle = 2081,
 	IndicSetFore = 2082,
@@ -273,6 +278,9 @@ enum class Message {
 	CanPaste = 2173,
 	CanUndo = 2174,
 	EmptyUndoBuffer = 2175,
+	SetUndoMemoryBudget = 2786,
+	GetUndoMemoryBudget = 2787,
+	GetUndoMemoryUsage = 2788,
 	Undo = 2176,
 	Cut = 2177,
 	Copy = 2178,
@@ -302,6 +310,8 @@ enum class Message {
 	TargetWholeDocument = 2690,
 	ReplaceTarget = 2194,
 	ReplaceTargetRE = 2195,
+	SubstituteTargetRE = 2789,
+	ReplaceRanges = 2794,
 	SearchInTarget = 2197,
 	SetSearchFlags = 2198,
 	GetSearchFlags = 2199,
@@ -356,6 +366,10 @@ enum class Message {
 	IsRangeWord = 2691,
 	SetIdleStyling = 2692,
 	GetIdleStyling = 2693,
+	SetStyleWindow = 2775,
+	GetStyleWindow = 2776,
+	SetStyleBudget = 2807,
+	GetStyleBudget = 2808,
 	SetWrapMode = 2268,
 	GetWrapMode = 2269,
 	SetWrapVisualFlags = 2460,
@@ -368,6 +382,11 @@ enum class Message {
 	GetWrapIndentMode = 2473,
 	SetLayoutCache = 2272,
 	GetLayoutCache = 2273,
+	SetLayoutCacheBudget = 2781,
+	GetLayoutCacheBudget = 2782,
+	GetLayoutCacheMemory = 2783,
+	SetPaintTiming = 2784,
+	GetPaintTiming = 2785,
 	SetScrollWidth = 2274,
 	GetScrollWidth = 2275,
 	SetScrollWidthTracking = 2516,
@@ -460,6 +479,9 @@ enum class Message {
 	BraceBadLightIndicator = 2499,
 	BraceMatch = 2353,
 	BraceMatchNext = 2369,
+	SetTagStyle = 2809,
+	SetVoidTags = 2810,
+	FindTag = 2811,
 	GetViewEOL = 2355,
 	SetViewEOL = 2356,
 	GetDocPointer = 2357,
@@ -486,6 +508,7 @@ enum class Message {
 	AddRefDocument = 2376,
 	ReleaseDocument = 2377,
 	GetDocumentOptions = 2379,
+	ConvertToLargeDocument = 2791,
 	GetModEventMask = 2378,
 	SetCommandEvents = 2717,
 	GetCommandEvents = 2718,
@@ -566,6 +589,8 @@ enum class Message {
 	AutoCSetOrder = 2660,
 	AutoCGetOrder = 2661,
 	Allocate = 2446,
+	SetLargePages = 2803,
+	GetLargePages = 2804,
 	TargetAsUTF8 = 2447,
 	SetLengthForEncode = 2448,
 	EncodedFromUTF8 = 2449,
@@ -585,16 +610,28 @@ enum class Message {
 	GetIndicatorValue = 2503,
 	IndicatorFillRange = 2504,
 	IndicatorClearRange = 2505,
+	IndicatorFillRanges = 2792,
 	IndicatorAllOnFor = 2506,
 	IndicatorValueAt = 2507,
 	IndicatorStart = 2508,
 	IndicatorEnd = 2509,
 	SetPositionCache = 2514,
 	GetPositionCache = 2515,
+	SetLayoutThreads = 2777,
+	GetLayoutThreads = 2778,
+	GetPositionCacheStatistic = 2779,
+	ResetPositionCacheStatistics = 2780,
+	GetMemoryUsage = 2790,
+	GetStylingStatistic = 2797,
+	ResetStylingStatistics = 2798,
 	CopyAllowLine = 2519,
 	GetCharacterPointer = 2520,
 	GetRangePointer = 2643,
 	GetGapPosition = 2644,
+	GetSegmentPointer = 2793,
+	GetStyleRangePointer = 2796,
+	AcquireTextSnapshot = 2801,
+	ReleaseTextSnapshot = 2802,
 	IndicSetAlpha = 2523,
 	IndicGetAlpha = 2524,
 	IndicSetOutlineAlpha = 2558,
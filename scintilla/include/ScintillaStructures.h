@@ -26,6 +26,29 @@ struct TextToFind final {
 	CharacterRange chrgText;
 };
 
+struct TextReplacement final {
+	Position position;
+	Position deleteLength;
+	Position insertLength;
+	const char *text;
+};
+
+struct StyleDefinition final {
+	int style;
+	StyleDefinitionMask mask;
+	int fore;
+	int back;
+	int sizeFractional;
+	int weight;
+	int italic;
+	int underline;
+	int strike;
+	int eolFilled;
+	int caseForce;
+	int characterSet;
+	const char *fontName;
+};
+
 using SurfaceID = void *;
 
 struct Rectangle final {
@@ -158,6 +158,21 @@ enum class FontWeight {
 	Bold = 700,
 };
 
+enum class StyleDefinitionMask {
+	None = 0x0000,
+	Font = 0x0001,
+	Size = 0x0002,
+	Fore = 0x0004,
+	Back = 0x0008,
+	Weight = 0x0010,
+	Italic = 0x0020,
+	Underline = 0x0040,
+	Strike = 0x0080,
+	EOLFilled = 0x0100,
+	Case = 0x0200,
+	CharacterSet = 0x0400,
+};
+
 enum class Element {
 	List = 0,
 	ListBack = 1,
@@ -233,6 +248,7 @@ enum class IndicFlag {
 enum class AutoCompleteOption {
 	Normal = 0,
 	FixedSize = 1,
+	FuzzyMatch = 4,
 };
 
 enum class IndentView {
@@ -258,6 +274,7 @@ enum class FindOption {
 	WordStart = 0x00100000,
 	RegExp = 0x00200000,
 	Posix = 0x00400000,
+	LinearRegEx = 0x00800000,
 	Cxx11RegEx = 0x00800000,
 };
 
@@ -308,6 +325,7 @@ enum class IdleStyling {
 	ToVisible = 1,
 	AfterVisible = 2,
 	All = 3,
+	Background = 4,
 };
 
 enum class Wrap {
@@ -375,6 +393,13 @@ enum class TabCompletion {
 	Latex = 2,
 };
 
+enum class TagFind {
+	Start = 0,
+	End = 1,
+	Match = 2,
+	Enclosing = 3,
+};
+
 enum class EdgeVisualStyle {
 	None = 0,
 	Line = 1,
@@ -391,7 +416,11 @@ enum class PopUp {
 enum class DocumentOption {
 	Default = 0,
 	StylesNone = 0x1,
+	StylesCompressed = 0x2,
 	TextLarge = 0x100,
+	TextChunked = 0x200,
+	LinesCompact = 0x400,
+	TextCompressed = 0x800,
 };
 
 enum class Status {
@@ -453,6 +482,31 @@ enum class CaretStyle {
 	BlockAfter = 0x100,
 };
 
+enum class PositionCacheStatistic {
+	Hits = 0,
+	Misses = 1,
+	Evictions = 2,
+};
+
+enum class MemoryUsage {
+	Total = 0,
+	Text = 1,
+	Styles = 2,
+	Lines = 3,
+	Undo = 4,
+	Markers = 5,
+	LineData = 6,
+	Indicators = 7,
+	LayoutCache = 8,
+	PositionCache = 9,
+};
+
+enum class StylingStatistic {
+	Duration = 0,
+	Bytes = 1,
+	Time = 2,
+};
+
 enum class MarginOption {
 	None = 0,
 	SubLineSelect = 1,
@@ -516,6 +570,7 @@ enum class Supports {
 	FractionalStrokeWidth = 2,
 	TranslucentStroke = 3,
 	PixelModification = 4,
+	ThreadSafeMeasureWidths = 5,
 };
 
 enum class LineCharacterIndexType {
@@ -555,7 +610,8 @@ enum class ModificationFlags {
 	InsertCheck = 0x100000,
 	ChangeTabStops = 0x200000,
 	ChangeEOLAnnotation = 0x400000,
-	EventMaskAll = 0x7FFFFF,
+	BulkModification = 0x800000,
+	EventMaskAll = 0xFFFFFF,
 };
 
 enum class Update {
@@ -659,6 +715,7 @@ enum class Notification {
 	AutoCCompleted = 2030,
 	MarginRightClick = 2031,
 	AutoCSelectionChange = 2032,
+	StylingDegraded = 2033,
 };
 //--Autogenerated -- end of section automatically generated from Scintilla.iface
 
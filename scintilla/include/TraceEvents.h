@@ -0,0 +1,40 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+// ETW TraceLogging events for hot paths in Notepad2 and Scintilla.
+#pragma once
+
+// Events are compiled out by default, build with NP2_ENABLE_TRACELOGGING=1 to emit them.
+// When compiled in, events are only recorded while a trace session enables provider "Notepad2"
+// {61f63ddc-9a6e-5c29-ab53-264dc5c82833}, e.g.
+//     wpr -start GeneralProfile -start Notepad2.wprp
+//     tracelog -start np2 -f np2.etl -guid *Notepad2 ... tracelog -stop np2
+// Otherwise each event costs one test of the provider's enabled flag.
+// Events with Start/Stop opcode are shown as regions in WPA's Generic Events table.
+#ifndef NP2_ENABLE_TRACELOGGING
+#define NP2_ENABLE_TRACELOGGING		0
+#endif
+
+#if NP2_ENABLE_TRACELOGGING
+#include <TraceLoggingProvider.h>
+
+TRACELOGGING_DECLARE_PROVIDER(np2TraceProvider);
+
+// defined in PlatWin.cxx, registered by Scintilla_RegisterClasses()
+#define NP2_TRACE_REGISTER()		TraceLoggingRegister(np2TraceProvider)
+#define NP2_TRACE_UNREGISTER()		TraceLoggingUnregister(np2TraceProvider)
+
+// at least one field is required after the name
+#define NP2_TRACE_START(name, ...)	TraceLoggingWrite(np2TraceProvider, name, TraceLoggingOpcode(WINEVENT_OPCODE_START), __VA_ARGS__)
+#define NP2_TRACE_STOP(name, ...)	TraceLoggingWrite(np2TraceProvider, name, TraceLoggingOpcode(WINEVENT_OPCODE_STOP), __VA_ARGS__)
+#define NP2_TRACE_MARK(name, ...)	TraceLoggingWrite(np2TraceProvider, name, __VA_ARGS__)
+#define NP2_TRACE_INT64(value, name)	TraceLoggingInt64((value), name)
+#define NP2_TRACE_STRING(value, name)	TraceLoggingString((value), name)
+#define NP2_TRACE_WSTRING(value, name)	TraceLoggingWideString((value), name)
+
+#else
+#define NP2_TRACE_REGISTER()
+#define NP2_TRACE_UNREGISTER()
+#define NP2_TRACE_START(name, ...)
+#define NP2_TRACE_STOP(name, ...)
+#define NP2_TRACE_MARK(name, ...)
+#endif
@@ -32,19 +32,24 @@
 	#define NP2_TARGET_ARM32	0
 	#define NP2_USE_SSE2		0
 	#define NP2_USE_AVX2		0
-	// TODO: use ARM Neon
+	#define NP2_DYNAMIC_AVX2	0
+	// Neon is mandatory on ARM64
+	#define NP2_USE_NEON		1
 #elif defined(__arm__) || defined(_ARM_) || defined(_M_ARM)
 	#define NP2_TARGET_ARM		1
 	#define NP2_TARGET_ARM64	0
 	#define NP2_TARGET_ARM32	1
 	#define NP2_USE_SSE2		0
 	#define NP2_USE_AVX2		0
+	#define NP2_DYNAMIC_AVX2	0
+	#define NP2_USE_NEON		0
 #else
 	#define NP2_TARGET_ARM		0
 	#define NP2_TARGET_ARM64	0
 	#define NP2_TARGET_ARM32	0
 	// SSE2 enabled by default
 	#define NP2_USE_SSE2		1
+	#define NP2_USE_NEON		0
 
 	// Clang and GCC use -march=x86-64-v3, https://clang.llvm.org/docs/UsersManual.html#x86
 	// or -mavx2 -mpopcnt -mbmi -mbmi2 -mlzcnt -mmovbe
@@ -55,13 +60,84 @@
 		#define NP2_USE_AVX2	0
 	#endif
 
-	// TODO: use __isa_enabled/__isa_available in MSVC build to dynamic enable AVX2 code.
-	//#if defined(_MSC_VER) || (defined(__has_include) && __has_include(<isa_availability.h>))
-	//	#include <isa_availability.h>
-	//#else
-	//#endif
+	// x64 build without AVX2 enabled: hot kernels are also compiled for AVX2,
+	// and selected at runtime with np2_cpu_supports_avx2().
+	#if defined(_WIN64) && !NP2_USE_AVX2
+		#define NP2_DYNAMIC_AVX2	1
+	#else
+		#define NP2_DYNAMIC_AVX2	0
+	#endif
+#endif
+
+#if NP2_USE_NEON
+#if defined(_MSC_VER) && !defined(__clang__)
+	#include <arm64_neon.h>
+#else
+	#include <arm_neon.h>
+#endif
+
+// like _mm_movemask_epi8(), value is result of compare: each byte is either 0 or 0xff.
+static inline uint32_t neon_movemask_epi8(uint8x16_t value) NP2_noexcept {
+	static const uint8_t weight[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+	value = vandq_u8(value, vld1q_u8(weight));
+	return vaddv_u8(vget_low_u8(value)) | ((uint32_t)vaddv_u8(vget_high_u8(value)) << 8);
+}
+
+// 64-bit mask for 64 bytes of compare result, bit n for byte n.
+static inline uint64_t neon_movemask_epi8x4(uint8x16_t value1, uint8x16_t value2, uint8x16_t value3, uint8x16_t value4) NP2_noexcept {
+	static const uint8_t weight[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+	const uint8x16_t bits = vld1q_u8(weight);
+	// three rounds of pairwise add fold each 8 bytes into one byte
+	const uint8x16_t sum12 = vpaddq_u8(vandq_u8(value1, bits), vandq_u8(value2, bits));
+	const uint8x16_t sum34 = vpaddq_u8(vandq_u8(value3, bits), vandq_u8(value4, bits));
+	uint8x16_t sum = vpaddq_u8(sum12, sum34);
+	sum = vpaddq_u8(sum, sum);
+	return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+#endif
+
+// prefetch for sequential scan over large buffer. hardware prefetcher stops at page boundary,
+// prefetch one page ahead also starts address translation for next page before it's scanned.
+#define NP2_PREFETCH_DISTANCE	4096
+#if NP2_USE_SSE2
+	#define NP2_PREFETCH(ptr)	_mm_prefetch((const char *)(ptr), _MM_HINT_T0)
+#elif defined(__clang__) || defined(__GNUC__)
+	#define NP2_PREFETCH(ptr)	__builtin_prefetch(ptr)
+#elif defined(_MSC_VER) && NP2_TARGET_ARM
+	#define NP2_PREFETCH(ptr)	__prefetch(ptr)
+#else
+	#define NP2_PREFETCH(ptr)	((void)(ptr))
+#endif
+
+// mark function that use AVX2 instructions, MSVC allows intrinsics without /arch:AVX2.
+#if NP2_DYNAMIC_AVX2 && (defined(__clang__) || defined(__GNUC__))
+	#define NP2_TARGET_AVX2		__attribute__((__target__("avx2,bmi")))
+#else
+	#define NP2_TARGET_AVX2
+#endif
 
-	// TODO: Function Multiversioning https://gcc.gnu.org/wiki/FunctionMultiVersioning
+#if NP2_DYNAMIC_AVX2
+// check AVX2 and BMI1 used by NP2_TARGET_AVX2 functions, result should be cached by caller.
+static inline int np2_cpu_supports_avx2(void) NP2_noexcept {
+#if defined(__clang__) || defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+#else
+	int info[4];
+	__cpuid(info, 1);
+	// OSXSAVE and AVX
+	if ((info[2] & 0x18000000) != 0x18000000) {
+		return 0;
+	}
+	// XMM and YMM state enabled by OS
+	if ((_xgetbv(0) & 6) != 6) {
+		return 0;
+	}
+	__cpuidex(info, 7, 0);
+	// BMI1 and AVX2
+	return (info[1] & 0x28) == 0x28;
+#endif
+}
 #endif
 
 // for C++20, use functions from <bit> header.
@@ -455,4 +455,4 @@ static void FoldAsmDoc(Sci_PositionU startPos, Sci_Position length, int initStyl
 	}
 }
 
-LexerModule lmAsm(SCLEX_ASM, ColouriseAsmDoc, "asm", FoldAsmDoc);
+LexerModule lmAsm(SCLEX_ASM, ColouriseAsmDoc, "asm", FoldAsmDoc, false, true);
@@ -413,6 +413,8 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 			if (sc.Match('*', '/')) {
 				sc.Forward();
 				sc.ForwardSetState(SCE_C_DEFAULT);
+			} else if (sc.ch != '\\') { // line continuation handled below
+				sc.ForwardUntilNext("*\\");
 			}
 			break;
 		case SCE_C_COMMENTLINE:
@@ -422,6 +424,8 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 				sc.SetState(SCE_C_XML_TAG);
 				sc.Forward();
 				sc.ForwardSetState(SCE_C_XML_DEFAULT);
+			} else if (sc.ch != '\\') {
+				sc.ForwardUntilNext((lexType == LEX_PHP) ? "?\\" : "\\");
 			}
 			break;
 		case SCE_C_COMMENTDOC:
@@ -530,6 +534,8 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 				sc.Forward();
 			} else if (sc.ch == '\'') {
 				sc.ForwardSetState(SCE_C_DEFAULT);
+			} else if (sc.ch != '\\') {
+				sc.ForwardUntilNext("\\'");
 			}
 			break;
 		case SCE_C_STRINGEOL:
@@ -570,6 +576,8 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 					sc.Forward();
 				outerStyle = SCE_C_DEFAULT;
 				sc.ForwardSetState(SCE_C_DEFAULT);
+			} else if (!isIncludePreprocessor && sc.ch != '\\') {
+				sc.ForwardUntilNext((lexType == LEX_PHP) ? "\\\"${" : "\\\"");
 			}
 			break;
 		case SCE_C_STRINGRAW:
@@ -1286,4 +1294,4 @@ static void FoldCppDoc(Sci_PositionU startPos, Sci_Position length, int initStyl
 	}
 }
 
-LexerModule lmCPP(SCLEX_CPP, ColouriseCppDoc, "cpp", FoldCppDoc);
+LexerModule lmCPP(SCLEX_CPP, ColouriseCppDoc, "cpp", FoldCppDoc, false, true);
@@ -10,6 +10,7 @@
 
 #include <string>
 #include <string_view>
+#include <initializer_list>
 
 #include "ILexer.h"
 #include "Scintilla.h"
@@ -95,56 +96,107 @@ int PrintScriptingIndicatorOffset(Accessor &styler, Sci_PositionU start, Sci_Pos
 	return iResult;
 }
 
-script_type ScriptOfState(int state) noexcept {
-	if ((state >= SCE_HP_START) && (state <= SCE_HP_IDENTIFIER)) {
-		return eScriptPython;
-	}
-	if ((state >= SCE_HB_START) && (state <= SCE_HB_OPERATOR)) {
-		return eScriptVBS;
-	}
-	if ((state >= SCE_HJ_START) && (state <= SCE_HJ_TEMPLATELITERAL)) {
-		return eScriptJS;
+// state class flags, several predicates are tested for every character.
+enum {
+	StateClassString = 1 << 0,
+	StateClassNoTermination = 1 << 1,
+	StateClassCommentASP = 1 << 2,
+	StateClassTag = 1 << 3,
+	StateClassComment = 1 << 4,
+	StateClassScriptComment = 1 << 5,
+	StateClassPHPString = 1 << 6,
+	StateClassNoScriptFold = 1 << 7,
+};
+
+struct StateClass {
+	unsigned char script;
+	unsigned char flags;
+	signed char printOffset;	// offset from state to print style when not in eNonHtmlScript
+	signed char stateOffset;	// offset from print style to state
+};
+
+struct StateClassTable {
+	StateClass table[256]{};
+
+	constexpr void SetRange(int first, int last, int script, int printOffset) noexcept {
+		for (int state = first; state <= last; state++) {
+			table[state].script = static_cast<unsigned char>(script);
+			table[state].printOffset = static_cast<signed char>(printOffset);
+		}
 	}
-	if ((state >= SCE_HPHP_DEFAULT) && (state <= SCE_HPHP_COMMENTLINE)) {
-		return eScriptPHP;
+	constexpr void SetStateOffset(int first, int last, int stateOffset) noexcept {
+		for (int state = first; state <= last; state++) {
+			table[state].stateOffset = static_cast<signed char>(stateOffset);
+		}
 	}
-	if ((state >= SCE_H_SGML_DEFAULT) && (state < SCE_H_SGML_BLOCK_DEFAULT)) {
-		return eScriptSGML;
+	constexpr void SetFlag(std::initializer_list<int> states, int flag) noexcept {
+		for (const int state : states) {
+			table[state].flags |= static_cast<unsigned char>(flag);
+		}
 	}
-	if (state == SCE_H_SGML_BLOCK_DEFAULT) {
-		return eScriptSGMLblock;
+
+	constexpr StateClassTable() noexcept {
+		SetRange(SCE_HJ_START, SCE_HJ_REGEX, eScriptJS, SCE_HA_JS);
+		SetRange(SCE_HJ_TEMPLATELITERAL, SCE_HJ_TEMPLATELITERAL, eScriptJS, 0);
+		SetRange(SCE_HB_START, SCE_HB_OPERATOR, eScriptVBS, SCE_HA_VBS);
+		SetRange(SCE_HP_START, SCE_HP_IDENTIFIER, eScriptPython, SCE_HA_PYTHON);
+		SetRange(SCE_HPHP_DEFAULT, SCE_HPHP_COMMENTLINE, eScriptPHP, 0);
+		SetRange(SCE_H_SGML_DEFAULT, SCE_H_SGML_BLOCK_DEFAULT - 1, eScriptSGML, 0);
+		SetRange(SCE_H_SGML_BLOCK_DEFAULT, SCE_H_SGML_BLOCK_DEFAULT, eScriptSGMLblock, 0);
+
+		SetStateOffset(SCE_HJA_START, SCE_HJA_TEMPLATELITERAL, -SCE_HA_JS);
+		SetStateOffset(SCE_HBA_START, SCE_HBA_OPERATOR, -SCE_HA_VBS);
+		SetStateOffset(SCE_HPA_START, SCE_HPA_IDENTIFIER, -SCE_HA_PYTHON);
+
+		SetFlag({SCE_HJ_DOUBLESTRING, SCE_HJ_SINGLESTRING, SCE_HJ_TEMPLATELITERAL,
+			SCE_HJA_DOUBLESTRING, SCE_HJA_SINGLESTRING, SCE_HJA_TEMPLATELITERAL,
+			SCE_HB_STRING, SCE_HBA_STRING,
+			SCE_HP_STRING, SCE_HP_CHARACTER, SCE_HP_TRIPLE, SCE_HP_TRIPLEDOUBLE,
+			SCE_HPA_STRING, SCE_HPA_CHARACTER, SCE_HPA_TRIPLE, SCE_HPA_TRIPLEDOUBLE,
+			SCE_HPHP_HSTRING, SCE_HPHP_HEREDOC, SCE_HPHP_SIMPLESTRING, SCE_HPHP_NOWDOC,
+			SCE_HPHP_HSTRING_VARIABLE, SCE_HPHP_COMPLEX_VARIABLE},
+			StateClassString | StateClassNoTermination | StateClassNoScriptFold);
+		SetFlag({SCE_HB_COMMENTLINE, SCE_HPHP_COMMENT, SCE_HP_COMMENTLINE, SCE_HPA_COMMENTLINE},
+			StateClassNoTermination);
+		// not really well done, since it's only comments that should lex the %> and <%
+		SetFlag({SCE_HJ_COMMENT, SCE_HJ_COMMENTLINE, SCE_HJ_COMMENTDOC, SCE_HB_COMMENTLINE,
+			SCE_HP_COMMENTLINE, SCE_HPHP_COMMENT, SCE_HPHP_COMMENTLINE},
+			StateClassCommentASP);
+		SetFlag({SCE_H_TAG, SCE_H_TAGUNKNOWN, SCE_H_SCRIPT, SCE_H_ATTRIBUTE, SCE_H_ATTRIBUTEUNKNOWN,
+			SCE_H_NUMBER, SCE_H_OTHER, SCE_H_DOUBLESTRING, SCE_H_SINGLESTRING},
+			StateClassTag);
+		SetFlag({SCE_H_COMMENT, SCE_H_SGML_COMMENT}, StateClassComment);
+		SetFlag({SCE_HJ_COMMENT, SCE_HJ_COMMENTLINE, SCE_HJA_COMMENT, SCE_HJA_COMMENTLINE,
+			SCE_HB_COMMENTLINE, SCE_HBA_COMMENTLINE},
+			StateClassScriptComment);
+		SetFlag({SCE_HPHP_HSTRING, SCE_HPHP_SIMPLESTRING, SCE_HPHP_HSTRING_VARIABLE,
+			SCE_HPHP_HEREDOC, SCE_HPHP_NOWDOC, SCE_HPHP_COMPLEX_VARIABLE},
+			StateClassPHPString);
+		SetFlag({SCE_HPHP_COMMENT, SCE_HPHP_COMMENTLINE, SCE_HJ_COMMENT, SCE_HJ_COMMENTLINE, SCE_HJ_COMMENTDOC},
+			StateClassNoScriptFold);
 	}
-	return eScriptNone;
+};
+
+constexpr StateClassTable stateClassTable;
+
+constexpr const StateClass &ClassOfState(int state) noexcept {
+	return stateClassTable.table[static_cast<unsigned char>(state)];
 }
 
-constexpr int statePrintForState(int state, script_mode inScriptType) noexcept {
-	if (state >= SCE_HJ_START) {
-		if ((state >= SCE_HP_START) && (state <= SCE_HP_IDENTIFIER)) {
-			return state + ((inScriptType == eNonHtmlScript) ? 0 : SCE_HA_PYTHON);
-		}
-		if ((state >= SCE_HB_START) && (state <= SCE_HB_OPERATOR)) {
-			return state + ((inScriptType == eNonHtmlScript) ? 0 : SCE_HA_VBS);
-		}
-		if ((state >= SCE_HJ_START) && (state <= SCE_HJ_REGEX)) {
-			return state + ((inScriptType == eNonHtmlScript) ? 0 : SCE_HA_JS);
-		}
-	}
+constexpr bool StateHasClass(int state, int flag) noexcept {
+	return ClassOfState(state).flags & flag;
+}
 
-	return state;
+constexpr script_type ScriptOfState(int state) noexcept {
+	return static_cast<script_type>(ClassOfState(state).script);
 }
 
-constexpr int stateForPrintState(int StateToPrint) noexcept {
-	if ((StateToPrint >= SCE_HPA_START) && (StateToPrint <= SCE_HPA_IDENTIFIER)) {
-		return StateToPrint - SCE_HA_PYTHON;
-	}
-	if ((StateToPrint >= SCE_HBA_START) && (StateToPrint <= SCE_HBA_OPERATOR)) {
-		return StateToPrint - SCE_HA_VBS;
-	}
-	if ((StateToPrint >= SCE_HJA_START) && (StateToPrint <= SCE_HJA_TEMPLATELITERAL)) {
-		return StateToPrint - SCE_HA_JS;
-	}
+constexpr int statePrintForState(int state, script_mode inScriptType) noexcept {
+	return state + ((inScriptType == eNonHtmlScript) ? 0 : ClassOfState(state).printOffset);
+}
 
-	return StateToPrint;
+constexpr int stateForPrintState(int StateToPrint) noexcept {
+	return StateToPrint + ClassOfState(StateToPrint).stateOffset;
 }
 
 bool IsNumber(Sci_PositionU start, Accessor &styler) noexcept {
@@ -153,58 +205,15 @@ bool IsNumber(Sci_PositionU start, Accessor &styler) noexcept {
 }
 
 constexpr bool isStringState(int state) noexcept {
-	switch (state) {
-	case SCE_HJ_DOUBLESTRING:
-	case SCE_HJ_SINGLESTRING:
-	case SCE_HJ_TEMPLATELITERAL:
-	case SCE_HJA_DOUBLESTRING:
-	case SCE_HJA_SINGLESTRING:
-	case SCE_HJA_TEMPLATELITERAL:
-	case SCE_HB_STRING:
-	case SCE_HBA_STRING:
-	case SCE_HP_STRING:
-	case SCE_HP_CHARACTER:
-	case SCE_HP_TRIPLE:
-	case SCE_HP_TRIPLEDOUBLE:
-	case SCE_HPA_STRING:
-	case SCE_HPA_CHARACTER:
-	case SCE_HPA_TRIPLE:
-	case SCE_HPA_TRIPLEDOUBLE:
-	case SCE_HPHP_HSTRING:
-	case SCE_HPHP_HEREDOC:
-	case SCE_HPHP_SIMPLESTRING:
-	case SCE_HPHP_NOWDOC:
-	case SCE_HPHP_HSTRING_VARIABLE:
-	case SCE_HPHP_COMPLEX_VARIABLE:
-		return true;
-	default:
-		return false;
-	}
+	return StateHasClass(state, StateClassString);
 }
 
 constexpr bool stateAllowsTermination(int state) noexcept {
-	bool allowTermination = !isStringState(state);
-	if (allowTermination) {
-		switch (state) {
-		case SCE_HB_COMMENTLINE:
-		case SCE_HPHP_COMMENT:
-		case SCE_HP_COMMENTLINE:
-		case SCE_HPA_COMMENTLINE:
-			allowTermination = false;
-		}
-	}
-	return allowTermination;
+	return !StateHasClass(state, StateClassNoTermination);
 }
 
-// not really well done, since it's only comments that should lex the %> and <%
 constexpr bool isCommentASPState(int state) noexcept {
-	return state == SCE_HJ_COMMENT
-		|| state == SCE_HJ_COMMENTLINE
-		|| state == SCE_HJ_COMMENTDOC
-		|| state == SCE_HB_COMMENTLINE
-		|| state == SCE_HP_COMMENTLINE
-		|| state == SCE_HPHP_COMMENT
-		|| state == SCE_HPHP_COMMENTLINE;
+	return StateHasClass(state, StateClassCommentASP);
 }
 
 void classifyAttribHTML(Sci_PositionU start, Sci_PositionU end, const WordList &keywords, Accessor &styler) {
@@ -405,20 +414,15 @@ constexpr bool issgmlwordchar(int ch) noexcept {
 }
 
 constexpr bool InTagState(int state) noexcept {
-	return state == SCE_H_TAG || state == SCE_H_TAGUNKNOWN ||
-	       state == SCE_H_SCRIPT ||
-	       state == SCE_H_ATTRIBUTE || state == SCE_H_ATTRIBUTEUNKNOWN ||
-	       state == SCE_H_NUMBER || state == SCE_H_OTHER ||
-	       state == SCE_H_DOUBLESTRING || state == SCE_H_SINGLESTRING;
+	return StateHasClass(state, StateClassTag);
 }
 
 constexpr bool IsCommentState(const int state) noexcept {
-	return state == SCE_H_COMMENT || state == SCE_H_SGML_COMMENT;
+	return StateHasClass(state, StateClassComment);
 }
 
 constexpr bool IsScriptCommentState(const int state) noexcept {
-	return state == SCE_HJ_COMMENT || state == SCE_HJ_COMMENTLINE || state == SCE_HJA_COMMENT ||
-		   state == SCE_HJA_COMMENTLINE || state == SCE_HB_COMMENTLINE || state == SCE_HBA_COMMENTLINE;
+	return StateHasClass(state, StateClassScriptComment);
 }
 
 bool isMakoBlockEnd(const int ch, const int chNext, const char *blockType) noexcept {
@@ -451,13 +455,7 @@ bool isDjangoBlockEnd(const int ch, const int chNext, const char *blockType) noe
 }
 
 constexpr bool isPHPStringState(int state) noexcept {
-	return
-	    (state == SCE_HPHP_HSTRING) ||
-	    (state == SCE_HPHP_SIMPLESTRING) ||
-	    (state == SCE_HPHP_HSTRING_VARIABLE) ||
-	    (state == SCE_HPHP_HEREDOC) ||
-	    (state == SCE_HPHP_NOWDOC) ||
-	    (state == SCE_HPHP_COMPLEX_VARIABLE);
+	return StateHasClass(state, StateClassPHPString);
 }
 
 Sci_Position FindPhpStringDelimiter(char *phpStringDelimiter, const int phpStringDelimiterSize, Sci_Position i, const Sci_Position lengthDoc, Accessor &styler, int &heardocQuotes) noexcept {
@@ -657,6 +655,8 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 	int levelPrev = styler.LevelAt(lineCurrent) & SC_FOLDLEVELNUMBERMASK;
 	int levelCurrent = levelPrev;
 	int lineStartVisibleChars = 0;
+	// skip content of script comment and string, trail byte in DBCS character may equal to special character.
+	const bool skipSpan = !isMako && !isDjango && styler.Encoding() != EncodingType::dbcs;
 
 	int chPrev = ' ';
 	int ch = ' ';
@@ -709,7 +709,7 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 			case eScriptPHP:
 				//not currently supported				case eScriptVBS:
 
-				if ((state != SCE_HPHP_COMMENT) && (state != SCE_HPHP_COMMENTLINE) && (state != SCE_HJ_COMMENT) && (state != SCE_HJ_COMMENTLINE) && (state != SCE_HJ_COMMENTDOC) && (!isStringState(state))) {
+				if (!StateHasClass(state, StateClassNoScriptFold)) {
 				//Platform::DebugPrintf("state=%d, StateToPrint=%d, initStyle=%d\n", state, StateToPrint, initStyle);
 				//if ((state == SCE_HPHP_OPERATOR) || (state == SCE_HPHP_DEFAULT) || (state == SCE_HJ_SYMBOLS) || (state == SCE_HJ_START) || (state == SCE_HJ_DEFAULT)) {
 					if (ch == '#') {
@@ -1638,6 +1638,14 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 				styler.ColorTo(i, statePrintForState(SCE_HJ_COMMENTLINE, inScriptType));
 				state = SCE_HJ_DEFAULT;
 				ch = ' ';
+			} else if (skipSpan) {
+				// stop before line end or any script end
+				const Sci_Position pos = styler.FindAnyOf(i + 1, sci::min<Sci_Position>(styler.LineStart(lineCurrent + 1) - 2, lengthDoc), "<%?") - 1;
+				if (pos > i) {
+					i = pos;
+					chPrev = static_cast<unsigned char>(styler[i - 1]);
+					ch = static_cast<unsigned char>(styler[i]);
+				}
 			}
 			break;
 		case SCE_HJ_DOUBLESTRING:
@@ -1651,6 +1659,13 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 			} else if (IsEOLChar(ch)) {
 				styler.ColorTo(i, StateToPrint);
 				state = SCE_HJ_STRINGEOL;
+			} else if (skipSpan) {
+				const Sci_Position pos = styler.FindAnyOf(i + 1, sci::min<Sci_Position>(styler.LineStart(lineCurrent + 1) - 2, lengthDoc), "\\\"<%") - 1;
+				if (pos > i) {
+					i = pos;
+					chPrev = static_cast<unsigned char>(styler[i - 1]);
+					ch = static_cast<unsigned char>(styler[i]);
+				}
 			}
 			break;
 		case SCE_HJ_SINGLESTRING:
@@ -1666,6 +1681,13 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 				if (chPrev != '\\' && (chPrev2 != '\\' || chPrev != '\r' || ch != '\n')) {
 					state = SCE_HJ_STRINGEOL;
 				}
+			} else if (skipSpan) {
+				const Sci_Position pos = styler.FindAnyOf(i + 1, sci::min<Sci_Position>(styler.LineStart(lineCurrent + 1) - 2, lengthDoc), "\\'<%") - 1;
+				if (pos > i) {
+					i = pos;
+					chPrev = static_cast<unsigned char>(styler[i - 1]);
+					ch = static_cast<unsigned char>(styler[i]);
+				}
 			}
 			break;
 		case SCE_HJ_STRINGEOL:
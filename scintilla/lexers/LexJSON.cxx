@@ -36,8 +36,6 @@ enum {
 };
 
 void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, LexerWordList keywordLists, Accessor &styler) {
-	const bool fold = styler.GetPropertyInt("fold", 1) & true;
-
 	int state = initStyle;
 	uint8_t chNext = styler[startPos];
 	styler.StartAt(startPos);
@@ -45,11 +43,6 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 	const Sci_PositionU endPos = startPos + lengthDoc;
 
 	Sci_Line lineCurrent = styler.GetLine(startPos);
-	int levelCurrent = SC_FOLDLEVELBASE;
-	if (lineCurrent > 0) {
-		levelCurrent = styler.LevelAt(lineCurrent - 1) >> 16;
-	}
-	int levelNext = levelCurrent;
 
 	constexpr int MaxLexWordLength = 8; // Infinity
 	char buf[MaxLexWordLength + 1];
@@ -60,6 +53,8 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 	bool atLineStart = startPos == static_cast<Sci_PositionU>(styler.LineStart(lineCurrent));
 	Sci_PositionU lineStartNext = styler.LineStart(lineCurrent + 1);
 	Sci_PositionU lineEndPos = sci::min(lineStartNext, endPos) - 1;
+	// trail byte in DBCS character may equal to backslash or quote
+	const bool skipSpan = styler.Encoding() != EncodingType::dbcs;
 
 	// scripts/GenerateCharTable.py
 	static constexpr const uint8_t kJsonCharClass[256] = {
@@ -166,6 +161,13 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 				}
 				state = SCE_JSON_DEFAULT;
 				continue;
+			} else if (skipSpan) {
+				const Sci_PositionU pos = styler.FindAnyOf(i + 1, lineEndPos, (state == SCE_JSON_STRING) ? "\\\"" : "\\'") - 1;
+				if (pos > i) {
+					i = pos;
+					chNext = styler.SafeGetCharAt(i + 1);
+					continue;
+				}
 			}
 			break;
 
@@ -173,6 +175,10 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 			if (atLineStart) {
 				styler.ColorTo(i, state);
 				state = SCE_JSON_DEFAULT;
+			} else if (skipSpan && i + 1 < lineEndPos) {
+				i = lineEndPos - 1;
+				chNext = styler.SafeGetCharAt(i + 1);
+				continue;
 			}
 			break;
 
@@ -182,9 +188,16 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 				chNext = styler.SafeGetCharAt(i + 1);
 				styler.ColorTo(i + 1, state);
 				state = SCE_JSON_DEFAULT;
-				levelNext--;
 				continue;
 			}
+			if (skipSpan) {
+				const Sci_PositionU pos = styler.FindAnyOf(i + 1, lineEndPos, "*") - 1;
+				if (pos > i) {
+					i = pos;
+					chNext = styler.SafeGetCharAt(i + 1);
+					continue;
+				}
+			}
 			break;
 		}
 
@@ -195,12 +208,6 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 				styler.ColorTo(i, state);
 				state = nextState >> 5;
 				switch (charClass) {
-				case JsonChar_BraceOpen:
-					levelNext++;
-					break;
-				case JsonChar_BraceClose:
-					levelNext--;
-					break;
 				case JsonChar_WordStart:
 					buf[0] = static_cast<char>(ch);
 					wordLen = 1;
@@ -215,7 +222,6 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 						state = SCE_JSON_LINECOMMENT;
 					} else if (chNext == '*') {
 						state = SCE_JSON_BLOCKCOMMENT;
-						levelNext++;
 						i++;
 						chNext = styler.SafeGetCharAt(i + 1);
 					}
@@ -234,17 +240,6 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 
 		atLineStart = i == lineEndPos;
 		if (atLineStart) {
-			if (fold) {
-				const int levelUse = levelCurrent;
-				int lev = levelUse | levelNext << 16;
-				if (levelUse < levelNext) {
-					lev |= SC_FOLDLEVELHEADERFLAG;
-				}
-				if (lev != styler.LevelAt(lineCurrent)) {
-					styler.SetLevel(lineCurrent, lev);
-				}
-				levelCurrent = levelNext;
-			}
 			lineCurrent++;
 			lineStartNext = styler.LineStart(lineCurrent + 1);
 			lineEndPos = sci::min(lineStartNext, endPos) - 1;
@@ -255,6 +250,64 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 	styler.ColorTo(endPos, state);
 }
 
+// folded from styles, so for a huge document fold levels are only computed when lines are displayed.
+void FoldJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, LexerWordList, Accessor &styler) {
+	const Sci_PositionU endPos = startPos + lengthDoc;
+	Sci_Line lineCurrent = styler.GetLine(startPos);
+	int levelCurrent = SC_FOLDLEVELBASE;
+	if (lineCurrent > 0) {
+		levelCurrent = styler.LevelAt(lineCurrent - 1) >> 16;
+	}
+
+	int levelNext = levelCurrent;
+	Sci_PositionU lineStartNext = styler.LineStart(lineCurrent + 1);
+	Sci_PositionU lineEndPos = sci::min(lineStartNext, endPos) - 1;
+
+	int styleNext = styler.StyleAt(startPos);
+	int style = initStyle;
+
+	for (Sci_PositionU i = startPos; i < endPos; i++) {
+		const int stylePrev = style;
+		style = styleNext;
+		styleNext = styler.StyleAt(i + 1);
+
+		switch (style) {
+		case SCE_JSON_OPERATOR: {
+			const char ch = styler[i];
+			if (ch == '{' || ch == '[') {
+				levelNext++;
+			} else if (ch == '}' || ch == ']') {
+				levelNext--;
+			}
+		} break;
+
+		case SCE_JSON_BLOCKCOMMENT:
+			if (style != stylePrev) {
+				levelNext++;
+			} else if (style != styleNext) {
+				levelNext--;
+			}
+			break;
+		}
+
+		if (i == lineEndPos) {
+			const int levelUse = levelCurrent;
+			int lev = levelUse | levelNext << 16;
+			if (levelUse < levelNext) {
+				lev |= SC_FOLDLEVELHEADERFLAG;
+			}
+			if (lev != styler.LevelAt(lineCurrent)) {
+				styler.SetLevel(lineCurrent, lev);
+			}
+
+			lineCurrent++;
+			lineStartNext = styler.LineStart(lineCurrent + 1);
+			lineEndPos = sci::min(lineStartNext, endPos) - 1;
+			levelCurrent = levelNext;
+		}
+	}
+}
+
 }
 
-LexerModule lmJSON(SCLEX_JSON, ColouriseJSONDoc, "json");
+LexerModule lmJSON(SCLEX_JSON, ColouriseJSONDoc, "json", FoldJSONDoc);
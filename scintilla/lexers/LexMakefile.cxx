@@ -297,4 +297,4 @@ static void FoldMakeDoc(Sci_PositionU startPos, Sci_Position length, int initSty
 	}
 }
 
-LexerModule lmMake(SCLEX_MAKEFILE, ColouriseMakeDoc, "makefile", FoldMakeDoc);
+LexerModule lmMake(SCLEX_MAKEFILE, ColouriseMakeDoc, "makefile", FoldMakeDoc, false, true);
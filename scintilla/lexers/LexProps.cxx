@@ -203,7 +203,7 @@ void FoldPropsDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int /*initStyl
 }
 
 #if ENABLE_FOLD_PROPS_COMMENT
-LexerModule lmProps(SCLEX_PROPERTIES, ColourisePropsDoc, "props", FoldPropsDoc);
+LexerModule lmProps(SCLEX_PROPERTIES, ColourisePropsDoc, "props", FoldPropsDoc, true);
 #else
-LexerModule lmProps(SCLEX_PROPERTIES, ColourisePropsDoc, "props");
+LexerModule lmProps(SCLEX_PROPERTIES, ColourisePropsDoc, "props", nullptr, true);
 #endif
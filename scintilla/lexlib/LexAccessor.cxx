@@ -3,20 +3,117 @@
 
 #include <cstdint>
 #include <cassert>
+#include <cstring>
 
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "ILexer.h"
+#include "VectorISA.h"
 #include "LexAccessor.h"
 #include "CharacterSet.h"
 #include "LexerUtils.h"
 
 using namespace Lexilla;
 
+namespace {
+
+// find first character in set (count is 1 to 4) in contiguous text, return length when not found.
+size_t FindAnyOfInSegment(const char *text, size_t length, const char *set, size_t count) noexcept {
+	// unused slots repeat first character
+	const char ch0 = set[0];
+	const char ch1 = set[(count > 1) ? 1 : 0];
+	const char ch2 = set[(count > 2) ? 2 : 0];
+	const char ch3 = set[(count > 3) ? 3 : 0];
+	size_t index = 0;
+#if NP2_USE_AVX2
+	const __m256i chars0 = _mm256_set1_epi8(ch0);
+	const __m256i chars1 = _mm256_set1_epi8(ch1);
+	const __m256i chars2 = _mm256_set1_epi8(ch2);
+	const __m256i chars3 = _mm256_set1_epi8(ch3);
+	for (; index + sizeof(__m256i) <= length; index += sizeof(__m256i)) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + index));
+		const __m256i match = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(chunk, chars0), _mm256_cmpeq_epi8(chunk, chars1)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(chunk, chars2), _mm256_cmpeq_epi8(chunk, chars3)));
+		const uint32_t mask = _mm256_movemask_epi8(match);
+		if (mask) {
+			return index + np2::ctz(mask);
+		}
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	const __m128i chars0 = _mm_set1_epi8(ch0);
+	const __m128i chars1 = _mm_set1_epi8(ch1);
+	const __m128i chars2 = _mm_set1_epi8(ch2);
+	const __m128i chars3 = _mm_set1_epi8(ch3);
+	for (; index + sizeof(__m128i) <= length; index += sizeof(__m128i)) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + index));
+		const __m128i match = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, chars0), _mm_cmpeq_epi8(chunk, chars1)),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, chars2), _mm_cmpeq_epi8(chunk, chars3)));
+		const uint32_t mask = _mm_movemask_epi8(match);
+		if (mask) {
+			return index + np2::ctz(mask);
+		}
+	}
+	// end NP2_USE_SSE2
+#endif
+	for (; index < length; index++) {
+		const char ch = text[index];
+		if (ch == ch0 || ch == ch1 || ch == ch2 || ch == ch3) {
+			break;
+		}
+	}
+	return index;
+}
+
+}
+
 namespace Lexilla {
 
+Sci_Position LexAccessor::FindAnyOf(Sci_Position position, Sci_Position limit, const char *set) noexcept {
+	const size_t count = strlen(set);
+	assert(count >= 1 && count <= 4);
+	while (position < limit) {
+		if (position < startPos || position >= endPos) {
+			Fill(position);
+		}
+		const Sci_Position end = sci::min(limit, endPos);
+		const size_t index = FindAnyOfInSegment(text + (position - startPos), end - position, set, count);
+		position += index;
+		if (position < end) {
+			break;
+		}
+	}
+	return position;
+}
+
+void LexAccessor::Fill(Sci_Position position) noexcept {
+	if (position >= 0 && position < lenDoc) {
+		// point straight into document text on the side of the gap containing position
+		startPos = 0;
+		endPos = lenDoc;
+		text = pAccess->CharRangePointer(position, &startPos, &endPos);
+		if (text) {
+			return;
+		}
+	}
+
+	text = buf;
+	Sci_Position m = lenDoc - bufferSize;
+	startPos = position - slopSize;
+	startPos = sci::min(startPos, m);
+	startPos = sci::max<Sci_Position>(startPos, 0);
+	endPos = startPos + bufferSize;
+	endPos = sci::min(endPos, lenDoc);
+
+	m = endPos - startPos;
+	pAccess->GetCharRange(buf, startPos, m);
+	buf[m] = '\0';
+}
+
 bool LexAccessor::MatchIgnoreCase(Sci_Position pos, const char *s) noexcept {
 	for (; *s; s++, pos++) {
 		if (*s != MakeLowerCase(SafeGetCharAt(pos))) {
@@ -31,7 +128,7 @@ void LexAccessor::GetRange(Sci_PositionU startPos_, Sci_PositionU endPos_, char
 	endPos_ = sci::min(endPos_, startPos_ + len - 1);
 	len = endPos_ - startPos_;
 	if (startPos_ >= static_cast<Sci_PositionU>(startPos) && endPos_ <= static_cast<Sci_PositionU>(endPos)) {
-		const char * const p = buf + (startPos_ - startPos);
+		const char * const p = text + (startPos_ - startPos);
 		memcpy(s, p, len);
 	} else {
 		pAccess->GetCharRange(s, startPos_, len);
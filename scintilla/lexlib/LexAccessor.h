@@ -26,6 +26,8 @@ private:
 		slopSize = bufferSize / 8,
 	};
 	char buf[bufferSize + 1];
+	// text for [startPos, endPos), either buf or pointer into document
+	const char *text;
 	Sci_Position startPos;
 	Sci_Position endPos;
 	const int codePage;
@@ -36,22 +38,11 @@ private:
 	Sci_PositionU startSeg;
 	Sci_Position startPosStyling;
 
-	void Fill(Sci_Position position) noexcept {
-		Sci_Position m = lenDoc - bufferSize;
-		startPos = position - slopSize;
-		startPos = sci::min(startPos, m);
-		startPos = sci::max<Sci_Position>(startPos, 0);
-		endPos = startPos + bufferSize;
-		endPos = sci::min(endPos, lenDoc);
-
-		m = endPos - startPos;
-		pAccess->GetCharRange(buf, startPos, m);
-		buf[m] = '\0';
-	}
+	void Fill(Sci_Position position) noexcept;
 
 public:
 	explicit LexAccessor(Scintilla::IDocument *pAccess_) noexcept :
-		pAccess(pAccess_), startPos(0), endPos(0),
+		pAccess(pAccess_), text(buf), startPos(0), endPos(0),
 		codePage(pAccess->CodePage()),
 		encodingType((codePage == 65001) ? EncodingType::unicode : (codePage ? EncodingType::dbcs : EncodingType::eightBit)),
 		lenDoc(pAccess->Length()),
@@ -63,10 +54,10 @@ public:
 		styleBuf[0] = 0;
 	}
 	char operator[](Sci_Position position) noexcept {
-		if (position < startPos || position >= endPos) {
+		if (static_cast<Sci_PositionU>(position - startPos) >= static_cast<Sci_PositionU>(endPos - startPos)) {
 			Fill(position);
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 	constexpr Scintilla::IDocument *MultiByteAccess() const noexcept {
 		return pAccess;
@@ -77,14 +68,14 @@ public:
 
 	/** Safe version of operator[], returning a defined value for invalid position. */
 	char SafeGetCharAt(Sci_Position position) noexcept {
-		if (position < startPos || position >= endPos) {
+		if (static_cast<Sci_PositionU>(position - startPos) >= static_cast<Sci_PositionU>(endPos - startPos)) {
 			Fill(position);
 			if (position < startPos || position >= endPos) {
 				// Position is outside range of document
 				return '\0';
 			}
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 #if 0
 	[[deprecated]]
@@ -96,7 +87,7 @@ public:
 				return chDefault;
 			}
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 #endif
 	bool IsLeadByte(unsigned char ch) const noexcept {
@@ -120,6 +111,8 @@ public:
 		return true;
 	}
 	bool MatchIgnoreCase(Sci_Position pos, const char *s) noexcept;
+	// Find first position in [position, limit) with a character in set (1 to 4 characters), or limit.
+	Sci_Position FindAnyOf(Sci_Position position, Sci_Position limit, const char *set) noexcept;
 
 	// Get first len - 1 characters in range [startPos_, endPos_).
 	void GetRange(Sci_PositionU startPos_, Sci_PositionU endPos_, char *s, Sci_PositionU len) noexcept;
@@ -25,6 +25,12 @@ class LexerModule final {
 	LexerFunction const fnLexer;
 	LexerFunction const fnFolder;
 	LexerFactoryFunction const fnFactory;
+	// lexer and folder keep no static state and look back at most two lines,
+	// so a document can be split into chunks that are lexed on several threads.
+	const bool parallel;
+	// lexer or folder keeps state in static variables, so it is serialized with
+	// background styling threads.
+	const bool staticState;
 
 public:
 	const char *const languageName;
@@ -32,11 +38,15 @@ public:
 		int language_,
 		LexerFunction fnLexer_,
 		const char *languageName_ = nullptr,
-		LexerFunction fnFolder_ = nullptr) noexcept:
+		LexerFunction fnFolder_ = nullptr,
+		bool parallel_ = false,
+		bool staticState_ = false) noexcept:
 		language(language_),
 		fnLexer(fnLexer_),
 		fnFolder(fnFolder_),
 		fnFactory(nullptr),
+		parallel(parallel_),
+		staticState(staticState_),
 		languageName(languageName_) {
 	}
 
@@ -48,12 +58,23 @@ public:
 		fnLexer(nullptr),
 		fnFolder(nullptr),
 		fnFactory(fnFactory_),
+		parallel(false),
+		staticState(false),
 		languageName(languageName_) {
 	}
 
 	constexpr int GetLanguage() const noexcept {
 		return language;
 	}
+	constexpr bool HasFolder() const noexcept {
+		return fnFolder != nullptr;
+	}
+	constexpr bool CanLexInParallel() const noexcept {
+		return parallel;
+	}
+	constexpr bool HasStaticState() const noexcept {
+		return staticState;
+	}
 
 	Scintilla::ILexer5 *Create() const;
 
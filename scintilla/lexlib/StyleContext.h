@@ -104,6 +104,21 @@ public:
 			Forward();
 		}
 	}
+	// Forward over characters of current line until chNext is in set (1 to 4 characters)
+	// or at line end, used to skip text that current state ignores, e.g. content of comment or string.
+	void ForwardUntilNext(const char *set) noexcept {
+		if (!multiByteAccess && !atLineEnd) {
+			const Sci_PositionU lineEnd = sci::min<Sci_PositionU>(lineStartNext - (currentLine < lineDocEnd), endPos);
+			const Sci_PositionU pos = styler.FindAnyOf(currentPos + 1, lineEnd, set) - 1;
+			if (pos > currentPos) {
+				currentPos = pos;
+				atLineStart = false;
+				chPrev = static_cast<unsigned char>(styler[pos - 1]);
+				ch = static_cast<unsigned char>(styler[pos]);
+				chNext = static_cast<unsigned char>(styler.SafeGetCharAt(pos + 1));
+			}
+		}
+	}
 	void ForwardBytes(Sci_Position nb) noexcept {
 		const Sci_PositionU forwardPos = currentPos + nb;
 		while (forwardPos > currentPos) {
@@ -66,6 +66,17 @@ inline char **ArrayFromWordList(char *wordlist, size_t slen, range_t *len) {
 	return keywords;
 }
 
+/** Hash for exact match lookup, stops at NUL.
+ */
+inline range_t HashWord(const char *s) noexcept {
+	// FNV-1a
+	range_t hash = 2166136261U;
+	while (*s) {
+		hash = (hash ^ static_cast<unsigned char>(*s++)) * 16777619U;
+	}
+	return hash;
+}
+
 /** Threshold for linear search.
  * Because of cache locality and other metrics, linear search is faster than binary search
  * when word list contains few words.
@@ -89,7 +100,7 @@ struct Range {
 }
 
 WordList::WordList() noexcept :
-	words(nullptr), list(nullptr), len(0) {
+	words(nullptr), list(nullptr), len(0), hashTable(nullptr), hashMask(0) {
 	// Prevent warnings by static analyzers about uninitialized ranges.
 	ranges[0] = {};
 }
@@ -122,10 +133,13 @@ void WordList::Clear() noexcept {
 	if (words) {
 		delete[]list;
 		delete[]words;
+		delete[]hashTable;
 	}
 	words = nullptr;
 	list = nullptr;
 	len = 0;
+	hashTable = nullptr;
+	hashMask = 0;
 }
 
 bool WordList::Set(const char *s, bool toLower) {
@@ -161,6 +175,21 @@ bool WordList::Set(const char *s, bool toLower) {
 		}
 		ranges[indexChar] = start | (i << 16);
 	}
+
+	// open addressing with load factor at most 1/2, replaces binary search in InList().
+	range_t capacity = 8;
+	while (capacity < len*2) {
+		capacity <<= 1;
+	}
+	hashTable = new range_t[capacity]();
+	hashMask = capacity - 1;
+	for (range_t i = 0; i < len; i++) {
+		range_t slot = HashWord(words[i]) & hashMask;
+		while (hashTable[slot] != 0) {
+			slot = (slot + 1) & hashMask;
+		}
+		hashTable[slot] = i + 1;
+	}
 	return true;
 }
 
@@ -180,7 +209,7 @@ bool WordList::InList(const char *s) const noexcept {
 	range_t end = ranges[firstChar];
 	if (end) {
 		Range range(end);
-		range_t count = range.Length();
+		const range_t count = range.Length();
 		if (count < WordListLinearSearchThreshold) {
 			do {
 				const char *a = words[range.start] + 1;
@@ -194,26 +223,14 @@ bool WordList::InList(const char *s) const noexcept {
 				}
 			} while (range.Next());
 		} else {
-			do {
-				const range_t step = count >> 1;
-				const range_t mid = range.start + step;
-				const char *a = words[mid] + 1;
-				const char *b = s + 1;
-				while (*a && *a == *b) {
-					a++;
-					b++;
-				}
-				const int diff = static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
-				if (diff == 0) {
+			range_t slot = HashWord(s) & hashMask;
+			range_t index;
+			while ((index = hashTable[slot]) != 0) {
+				if (strcmp(words[index - 1], s) == 0) {
 					return true;
 				}
-				if (diff < 0) {
-					range.start = mid + 1;
-					count -= step + 1;
-				} else {
-					count = step;
-				}
-			} while (count != 0);
+				slot = (slot + 1) & hashMask;
+			}
 		}
 	}
 
@@ -19,6 +19,8 @@ private:
 	char *list;
 	range_t len;
 	range_t ranges[128];	// only ASCII, most word starts with character in '_a-zA-Z'
+	range_t *hashTable;		// word index + 1, for exact match in InList()
+	range_t hashMask;
 public:
 	explicit WordList() noexcept;
 	~WordList();
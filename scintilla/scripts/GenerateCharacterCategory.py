@@ -524,6 +524,32 @@ constexpr int {table}Mask2 = {maskC};
 """.format(**args)
 	return table, function
 
+def compressBMPTable(head, indexTable, prefix):
+	# two-stage table: byte sized block index + leaf, small enough to stay in L1 cache
+	indexA, indexB, shift = splitbins(indexTable, False, 1)
+	mask = (1 << shift) - 1
+	print(f'{head}:', (len(indexA), max(indexA)), len(indexB), shift, (len(indexA) + len(indexB))/1024)
+
+	for ch in range(len(indexTable)):
+		value = indexB[(indexA[ch >> shift] << shift) | (ch & mask)]
+		expect = indexTable[ch]
+		if value != expect:
+			print(f'{head} verify fail:', '%04X, expect: %d, got: %d' % (ch, expect, value))
+			return None
+
+	output = []
+	output.append("const unsigned char %sIndex[] = {" % prefix)
+	output.extend(dumpArray(indexA, 20))
+	output.append("};")
+	output.append("")
+	output.append("const unsigned char %sLeaf[] = {" % prefix)
+	output.extend(dumpArray(indexB, 20))
+	output.append("};")
+	output.append("")
+	output.append("constexpr int %sShift = %d;" % (prefix, shift))
+	output.append("constexpr int %sMask = %d;" % (prefix, mask))
+	return output
+
 def runLengthEncode(head, indexTable, valueBit, totalBit=16):
 	assert max(indexTable) < 2**valueBit
 	maxLength = 2**(totalBit - valueBit) - 1
@@ -618,22 +644,20 @@ def updateCharacterCategoryTable(filename):
 		value = categories.index(category)
 		indexTable[ch] = value
 
+	output.append("")
+	table = compressBMPTable('CharacterCategory BMP', indexTable[:BMPCharacterCharacterCount], 'catBMP')
+	output.extend(table)
+
 	args = {
 		'table': 'catTable',
 		'with_function': False,
 	}
 
-	table, function = compressIndexTable('CharacterCategoryTable', indexTable, args)
+	table, function = compressIndexTable('CharacterCategory Supplementary', indexTable[BMPCharacterCharacterCount:], args)
 	output.append("")
 	output.extend(table.splitlines())
 	output.extend(function.splitlines())
 
-	data = runLengthEncode('CharacterCategoryTable', indexTable[:BMPCharacterCharacterCount], 5)
-	output.append("")
-	output.append(f'const unsigned short CatTableRLE_BMP[] = {{')
-	output.extend(dumpArray(data, 20))
-	output.append("};")
-
 	output.append("")
 	output.append("#endif")
 
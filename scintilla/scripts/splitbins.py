@@ -22,7 +22,7 @@ def getsize(data):
 	else:
 		return 4
 
-def splitbins(t, second=False):
+def splitbins(t, second=False, indexSize=None):
 	"""t -> (t1, t2, shift).  Split a table to save space.
 
 	t is a sequence of ints.  This function can be useful to save space if
@@ -31,6 +31,8 @@ def splitbins(t, second=False):
 	code), and where for each i in range(len(t)),
 		t[i] == t2[(t1[i >> shift] << shift) | (i & mask)]
 	where mask is a bitmask isolating the last "shift" bits.
+	When indexSize is given, only splits whose t1 fits in that many bytes
+	are considered.
 	"""
 
 	# the most we can shift n and still have something left
@@ -51,6 +53,8 @@ def splitbins(t, second=False):
 				bincache[part] = index
 				t2.extend(part)
 			t1.append(index >> shift)
+		if indexSize and getsize(t1) > indexSize:
+			continue
 		# determine memory size
 		b = len(t1)*getsize(t1)
 		if second:
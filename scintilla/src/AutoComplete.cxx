@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <cstdint>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -15,6 +16,7 @@
 #include <string>
 #include <string_view>
 #include <vector>
+#include <utility>
 #include <optional>
 #include <algorithm>
 #include <memory>
@@ -32,6 +34,7 @@
 
 using namespace Scintilla;
 using namespace Scintilla::Internal;
+using namespace Lexilla;
 
 AutoComplete::AutoComplete() :
 	active(false),
@@ -155,13 +158,192 @@ struct Sorter {
 	}
 };
 
+namespace {
+
+// one bit for each ASCII letter (case insensitive), digit and '_', other characters share remaining bits.
+constexpr uint64_t FuzzyCharMask(unsigned char ch) noexcept {
+	if (ch >= 'a' && ch <= 'z') {
+		return UINT64_C(1) << (ch - 'a');
+	}
+	if (ch >= 'A' && ch <= 'Z') {
+		return UINT64_C(1) << (ch - 'A');
+	}
+	if (ch >= '0' && ch <= '9') {
+		return UINT64_C(1) << (ch - '0' + 26);
+	}
+	if (ch == '_') {
+		return UINT64_C(1) << 36;
+	}
+	return UINT64_C(1) << (37 + ch % 27);
+}
+
+uint64_t FuzzyWordMask(const char *word, size_t length) noexcept {
+	uint64_t mask = 0;
+	for (size_t i = 0; i < length; i++) {
+		mask |= FuzzyCharMask(word[i]);
+	}
+	return mask;
+}
+
+// start of word, camel hump, or first character after punctuation.
+constexpr bool IsFuzzyBoundary(const char *word, int index) noexcept {
+	if (index == 0) {
+		return true;
+	}
+	const unsigned char ch = word[index];
+	const unsigned char chPrev = word[index - 1];
+	return (IsUpperCase(ch) && !IsUpperCase(chPrev))
+		|| (IsAlphaNumeric(ch) && !IsAlphaNumeric(chPrev) && chPrev < 0x80);
+}
+
+constexpr int FuzzyNoMatch = INT32_MIN / 2;
+constexpr int FuzzyMaxWordLength = 256;
+
+// best score of case insensitive subsequence match: each query character adds score, more when it
+// matches at a boundary or right after previous matched character, skipped characters reduce score.
+int FuzzyScore(const char *word, int length, const char *query, int queryLength) noexcept {
+	length = std::min(length, FuzzyMaxWordLength);
+	if (length < queryLength) {
+		return FuzzyNoMatch;
+	}
+
+	// best score with previous query character matched at word[i]
+	int prev[FuzzyMaxWordLength];
+	int curr[FuzzyMaxWordLength];
+	for (int j = 0; j < queryLength; j++) {
+		const unsigned char chQuery = query[j];
+		const unsigned char chFold = MakeLowerCase(chQuery);
+		int run = FuzzyNoMatch; // best of prev[k] for k < i - 1, minus gap
+		bool any = false;
+		for (int i = 0; i < length; i++) {
+			int best;
+			if (j == 0) {
+				best = -std::min(i, 8);
+			} else {
+				best = FuzzyNoMatch;
+				if (i > 0) {
+					const int consecutive = prev[i - 1];
+					if (consecutive != FuzzyNoMatch) {
+						best = consecutive + 12;
+					}
+					best = std::max(best, run);
+					run = std::max(run - 1, consecutive - 1);
+				}
+			}
+			curr[i] = FuzzyNoMatch;
+			const unsigned char ch = word[i];
+			if (best != FuzzyNoMatch && MakeLowerCase(ch) == chFold) {
+				int score = best + 16;
+				if (IsFuzzyBoundary(word, i)) {
+					score += 24;
+				}
+				if (ch == chQuery) {
+					score += 1;
+				}
+				curr[i] = score;
+				any = true;
+			}
+		}
+		if (!any) {
+			return FuzzyNoMatch;
+		}
+		std::copy(curr, curr + length, prev);
+	}
+
+	int score = FuzzyNoMatch;
+	for (int i = queryLength - 1; i < length; i++) {
+		score = std::max(score, prev[i]);
+	}
+	// prefer shorter word
+	return score - length/4;
+}
+
+}
+
+void AutoComplete::SetFuzzyList(const char *list) {
+	fuzzyList.clear();
+	fuzzyItems.clear();
+	fuzzyMasks.clear();
+	fuzzyQuery.clear();
+	fuzzyCandidates.clear();
+	if (!FlagSet(options, AutoCompleteOption::FuzzyMatch)) {
+		return;
+	}
+
+	// same as ListBox::SetList(): word and optional type separated by typesep.
+	fuzzyList = list;
+	const char *start = fuzzyList.c_str();
+	const char *p = start;
+	while (*p) {
+		const char *word = p;
+		while (*p && *p != separator && *p != typesep) {
+			++p;
+		}
+		const int length = static_cast<int>(p - word);
+		fuzzyItems.emplace_back(static_cast<int>(word - start), length);
+		fuzzyMasks.push_back(FuzzyWordMask(word, length));
+		while (*p && *p != separator) {
+			++p;
+		}
+		if (*p == separator) {
+			++p;
+		}
+	}
+}
+
+int AutoComplete::FuzzySelect(const char *word) {
+	const size_t lenWord = strlen(word);
+	if (lenWord == 0 || lenWord > FuzzyMaxWordLength || fuzzyItems.size() != static_cast<size_t>(lb->Length())) {
+		return -1;
+	}
+
+	const std::string_view query(word, lenWord);
+	const uint64_t mask = FuzzyWordMask(word, lenWord);
+	const uint64_t * const masks = fuzzyMasks.data();
+	std::vector<int> matched;
+	int selection = -1;
+	int bestScore = FuzzyNoMatch;
+	const auto scoreItem = [&](int index) {
+		const auto [offset, length] = fuzzyItems[index];
+		const int score = FuzzyScore(fuzzyList.c_str() + offset, length, word, static_cast<int>(lenWord));
+		if (score != FuzzyNoMatch) {
+			matched.push_back(index);
+			if (score > bestScore) {
+				bestScore = score;
+				selection = index;
+			}
+		}
+	};
+
+	// an item matching the query as subsequence also matches every prefix of the query,
+	// so when a character is typed only items matched previous query are scored again.
+	if (!fuzzyQuery.empty() && query.length() > fuzzyQuery.length() && query.compare(0, fuzzyQuery.length(), fuzzyQuery) == 0) {
+		for (const int index : fuzzyCandidates) {
+			if ((masks[index] & mask) == mask) {
+				scoreItem(index);
+			}
+		}
+	} else {
+		// filter out items that don't contain every character of word, the loop can be vectorized.
+		const int count = static_cast<int>(fuzzyMasks.size());
+		for (int index = 0; index < count; index++) {
+			if ((masks[index] & mask) != mask) {
+				continue;
+			}
+			scoreItem(index);
+		}
+	}
+	fuzzyQuery = query;
+	fuzzyCandidates = std::move(matched);
+	return selection;
+}
+
 void AutoComplete::SetList(const char *list) {
 	if (autoSort == Ordering::PreSorted) {
+		// list box order is sorted order
+		sortMatrix.clear();
+		SetFuzzyList(list);
 		lb->SetList(list, separator, typesep);
-		sortMatrix.resize(lb->Length());
-		for (int i = 0; i < static_cast<int>(sortMatrix.size()); ++i) {
-			sortMatrix[i] = i;
-		}
 		return;
 	}
 
@@ -172,6 +354,7 @@ void AutoComplete::SetList(const char *list) {
 	}
 	std::sort(sortMatrix.begin(), sortMatrix.end(), IndexSort);
 	if (autoSort == Ordering::Custom || sortMatrix.size() < 2) {
+		SetFuzzyList(list);
 		lb->SetList(list, separator, typesep);
 		PLATFORM_ASSERT(lb->Length() == static_cast<int>(sortMatrix.size()));
 		return;
@@ -198,9 +381,8 @@ void AutoComplete::SetList(const char *list) {
 		item[wordLen] = '\0';
 		sortedList += item;
 	}
-	for (int i = 0; i < static_cast<int>(sortMatrix.size()); ++i) {
-		sortMatrix[i] = i;
-	}
+	sortMatrix.clear();
+	SetFuzzyList(sortedList.c_str());
 	lb->SetList(sortedList.c_str(), separator, typesep);
 }
 
@@ -244,7 +426,7 @@ void AutoComplete::Select(const char *word) {
 	int end = lb->Length() - 1; // upper bound of the api array block to search
 	while ((start <= end) && (location == -1)) { // Binary searching loop
 		int pivot = (start + end) / 2;
-		std::string item = lb->GetValue(sortMatrix[pivot]);
+		std::string item = lb->GetValue(SortedIndex(pivot));
 		int cond;
 		if (ignoreCase)
 			cond = CompareNCaseInsensitive(word, item.c_str(), lenWord);
@@ -253,7 +435,7 @@ void AutoComplete::Select(const char *word) {
 		if (!cond) {
 			// Find first match
 			while (pivot > start) {
-				item = lb->GetValue(sortMatrix[pivot - 1]);
+				item = lb->GetValue(SortedIndex(pivot - 1));
 				if (ignoreCase)
 					cond = CompareNCaseInsensitive(word, item.c_str(), lenWord);
 				else
@@ -267,7 +449,7 @@ void AutoComplete::Select(const char *word) {
 				&& ignoreCaseBehaviour == CaseInsensitiveBehaviour::RespectCase) {
 				// Check for exact-case match
 				for (; pivot <= end; pivot++) {
-					item = lb->GetValue(sortMatrix[pivot]);
+					item = lb->GetValue(SortedIndex(pivot));
 					if (!strncmp(word, item.c_str(), lenWord)) {
 						location = pivot;
 						break;
@@ -282,6 +464,13 @@ void AutoComplete::Select(const char *word) {
 			start = pivot + 1;
 		}
 	}
+	if (location == -1 && FlagSet(options, AutoCompleteOption::FuzzyMatch)) {
+		const int selection = FuzzySelect(word);
+		if (selection >= 0) {
+			lb->Select(selection);
+			return;
+		}
+	}
 	if (location == -1) {
 		if (autoHide)
 			Cancel();
@@ -291,13 +480,13 @@ void AutoComplete::Select(const char *word) {
 		if (autoSort == Ordering::Custom) {
 			// Check for a logically earlier match
 			for (int i = location + 1; i <= end; ++i) {
-				const std::string item = lb->GetValue(sortMatrix[i]);
+				const std::string item = lb->GetValue(SortedIndex(i));
 				if (CompareNCaseInsensitive(word, item.c_str(), lenWord) != 0)
 					break;
 				if (sortMatrix[i] < sortMatrix[location] && !strncmp(word, item.c_str(), lenWord))
 					location = i;
 			}
 		}
-		lb->Select(sortMatrix[location]);
+		lb->Select(SortedIndex(location));
 	}
 }
@@ -19,7 +19,22 @@ class AutoComplete {
 	enum {
 		maxItemLen = 1024
 	};
+	// list box index of each item in sorted order, empty when items are already sorted.
 	std::vector<int> sortMatrix;
+	// items in list box order for FuzzyMatch: offset and length into fuzzyList,
+	// fuzzyMasks are kept in separate array for fast filtering.
+	std::string fuzzyList;
+	std::vector<std::pair<int, int>> fuzzyItems;
+	std::vector<uint64_t> fuzzyMasks;
+	// last fuzzy query and items matched it, typing more characters only rescores these items.
+	std::string fuzzyQuery;
+	std::vector<int> fuzzyCandidates;
+
+	int SortedIndex(int index) const noexcept {
+		return sortMatrix.empty() ? index : sortMatrix[index];
+	}
+	void SetFuzzyList(const char *list);
+	int FuzzySelect(const char *word);
 
 public:
 
@@ -9,6 +9,7 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 
 #include <stdexcept>
@@ -17,6 +18,7 @@
 #include <vector>
 #include <algorithm>
 
+#include "VectorISA.h"
 #include "CaseConvert.h"
 #include "UniConversion.h"
 
@@ -570,6 +572,65 @@ const char *complexCaseConversions =
 //--Autogenerated -- end of section automatically generated
 ;
 
+constexpr int maxBMP = 0xffff;
+
+// Case of ASCII letters is changed by flipping bit 0x20, asciiFirst is 'A' for fold and lower case, 'a' for upper case.
+// Bytes >= 0x80 are negative as signed char, so they are never in range and copied unchanged.
+#if NP2_USE_AVX2
+inline __m256i ConvertASCIIBlock(__m256i chunk, __m256i vectFirst, __m256i vectLast) noexcept {
+	const __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, vectFirst), _mm256_cmpgt_epi8(vectLast, chunk));
+	return _mm256_xor_si256(chunk, _mm256_and_si256(mask, _mm256_set1_epi8(0x20)));
+}
+#elif NP2_USE_SSE2
+inline __m128i ConvertASCIIBlock(__m128i chunk, __m128i vectFirst, __m128i vectLast) noexcept {
+	const __m128i mask = _mm_and_si128(_mm_cmpgt_epi8(chunk, vectFirst), _mm_cmplt_epi8(chunk, vectLast));
+	return _mm_xor_si128(chunk, _mm_and_si128(mask, _mm_set1_epi8(0x20)));
+}
+#endif
+
+// Converts [mixed, mixed + length) in whole blocks, returns count of bytes converted.
+// With asciiOnly, stops at first non-ASCII byte, bytes after the returned count
+// may also be written, but never past length.
+template <bool asciiOnly>
+size_t ConvertASCIIBlocks(char *converted, const char *mixed, size_t length, char asciiFirst) noexcept {
+	size_t pos = 0;
+#if NP2_USE_AVX2
+	const __m256i vectFirst = _mm256_set1_epi8(static_cast<char>(asciiFirst - 1));
+	const __m256i vectLast = _mm256_set1_epi8(static_cast<char>(asciiFirst + 26));
+	while (pos + sizeof(__m256i) <= length) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mixed + pos));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(converted + pos), ConvertASCIIBlock(chunk, vectFirst, vectLast));
+		if constexpr (asciiOnly) {
+			const uint32_t mask = _mm256_movemask_epi8(chunk);
+			if (mask != 0) {
+				return pos + np2::ctz(mask);
+			}
+		}
+		pos += sizeof(__m256i);
+	}
+#elif NP2_USE_SSE2
+	const __m128i vectFirst = _mm_set1_epi8(static_cast<char>(asciiFirst - 1));
+	const __m128i vectLast = _mm_set1_epi8(static_cast<char>(asciiFirst + 26));
+	while (pos + sizeof(__m128i) <= length) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mixed + pos));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(converted + pos), ConvertASCIIBlock(chunk, vectFirst, vectLast));
+		if constexpr (asciiOnly) {
+			const uint32_t mask = _mm_movemask_epi8(chunk);
+			if (mask != 0) {
+				return pos + np2::ctz(mask);
+			}
+		}
+		pos += sizeof(__m128i);
+	}
+#else
+	(void)converted;
+	(void)mixed;
+	(void)length;
+	(void)asciiFirst;
+#endif
+	return pos;
+}
+
 class CaseConverter final : public ICaseConverter {
 	// Maximum length of a case conversion result is 6 bytes in UTF-8
 	enum {
@@ -606,6 +667,16 @@ class CaseConverter final : public ICaseConverter {
 	// The parallel arrays
 	std::vector<int> characters;
 	std::vector<ConversionString> conversions;
+	// Two-stage table for BMP: block index and blocks of 1-based index into conversions, 0 for no conversion.
+	// First block is all zero and shared by blocks without any conversion.
+	enum {
+		bmpBlockShift = 7,
+		bmpBlockSize = 1 << bmpBlockShift,
+		bmpBlockMask = bmpBlockSize - 1,
+	};
+	std::vector<unsigned short> bmpBlocks;
+	std::vector<unsigned short> bmpIndex;
+	char asciiFirst = 'A';
 
 public:
 	CaseConverter() noexcept = default;
@@ -616,6 +687,10 @@ public:
 		characterToConversion.emplace_back(character, conversion);
 	}
 	const char *Find(int character) const {
+		if (static_cast<unsigned int>(character) <= maxBMP) {
+			const unsigned int index = bmpIndex[(bmpBlocks[character >> bmpBlockShift] << bmpBlockShift) | (character & bmpBlockMask)];
+			return index ? conversions[index - 1].conversion : nullptr;
+		}
 		const auto it = std::lower_bound(characters.begin(), characters.end(), character);
 		if (it == characters.end())
 			return nullptr;
@@ -628,11 +703,22 @@ public:
 		size_t lenConverted = 0;
 		size_t mixedPos = 0;
 		unsigned char bytes[UTF8MaxBytes + 1]{};
+		if (sizeConverted == 0) {
+			return 0;
+		}
 		while (mixedPos < lenMixed) {
 			const unsigned char leadByte = mixed[mixedPos];
 			const char *caseConverted = nullptr;
 			size_t lenMixedChar = 1;
 			if (UTF8IsAscii(leadByte)) {
+				// bulk convert ASCII run, keep one byte spare as the result must be shorter than sizeConverted
+				const size_t length = std::min(lenMixed - mixedPos, sizeConverted - lenConverted - 1);
+				const size_t count = ConvertASCIIBlocks<true>(converted + lenConverted, mixed + mixedPos, length, asciiFirst);
+				if (count != 0) {
+					lenConverted += count;
+					mixedPos += count;
+					continue;
+				}
 				caseConverted = Find(leadByte);
 			} else {
 				bytes[0] = leadByte;
@@ -677,6 +763,20 @@ public:
 		}
 		// Empty the original calculated data completely
 		CharacterToConversion().swap(characterToConversion);
+
+		bmpBlocks.assign((maxBMP + 1) >> bmpBlockShift, 0);
+		bmpIndex.assign(bmpBlockSize, 0);
+		for (size_t i = 0; i < characters.size() && characters[i] <= maxBMP; i++) {
+			const int character = characters[i];
+			unsigned short &block = bmpBlocks[character >> bmpBlockShift];
+			if (block == 0) {
+				block = static_cast<unsigned short>(bmpIndex.size() >> bmpBlockShift);
+				bmpIndex.resize(bmpIndex.size() + bmpBlockSize);
+			}
+			bmpIndex[(block << bmpBlockShift) | (character & bmpBlockMask)] = static_cast<unsigned short>(i + 1);
+		}
+		// ASCII letters of lower or upper case are converted by ConvertASCIIBlocks()
+		asciiFirst = Find('A') ? 'A' : 'a';
 	}
 };
 
@@ -823,6 +923,16 @@ size_t CaseConvertString(char *converted, size_t sizeConverted, const char *mixe
 	return pCaseConv->CaseConvertString(converted, sizeConverted, mixed, lenMixed);
 }
 
+void CaseConvertASCII(char *s, size_t length, CaseConversion conversion) noexcept {
+	const char asciiFirst = (conversion == CaseConversion::upper) ? 'a' : 'A';
+	for (size_t pos = ConvertASCIIBlocks<false>(s, s, length, asciiFirst); pos < length; pos++) {
+		const char ch = s[pos];
+		if (ch >= asciiFirst && ch < asciiFirst + 26) {
+			s[pos] = static_cast<char>(ch ^ 0x20);
+		}
+	}
+}
+
 std::string CaseConvertString(const std::string &s, CaseConversion conversion) {
 	std::string retMapped(s.length() * maxExpansionCaseConversion, 0);
 	const size_t lenMapped = CaseConvertString(retMapped.data(), retMapped.length(), s.c_str(), s.length(),
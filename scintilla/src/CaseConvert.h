@@ -36,6 +36,9 @@ constexpr size_t maxExpansionCaseConversion = 3;
 // If there is not enough space then 0 is returned.
 size_t CaseConvertString(char *converted, size_t sizeConverted, const char *mixed, size_t lenMixed, CaseConversion conversion);
 
+// Converts case of ASCII letters in place, other bytes are unchanged.
+void CaseConvertASCII(char *s, size_t length, CaseConversion conversion) noexcept;
+
 // Converts a mixed case string using a particular conversion.
 std::string CaseConvertString(const std::string &s, CaseConversion conversion);
 
@@ -20,6 +20,11 @@
 #include <algorithm>
 #include <memory>
 #include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
 
 #include "ScintillaTypes.h"
 
@@ -29,6 +34,9 @@
 #include "Position.h"
 #include "SplitVector.h"
 #include "Partitioning.h"
+#include "LZ4Block.h"
+#include "ChunkedVector.h"
+#include "RunStyles.h"
 #include "CellBuffer.h"
 #include "UniConversion.h"
 #include "ElapsedPeriod.h"
@@ -47,6 +55,11 @@ struct CountWidths {
 	CountWidths operator-() const noexcept {
 		return CountWidths(-countBasePlane, -countOtherPlanes);
 	}
+	CountWidths &operator+=(const CountWidths &other) noexcept {
+		countBasePlane += other.countBasePlane;
+		countOtherPlanes += other.countOtherPlanes;
+		return *this;
+	}
 	Sci::Position WidthUTF32() const noexcept {
 		// All code points take one code unit in UTF-32.
 		return countBasePlane + countOtherPlanes;
@@ -84,6 +97,9 @@ public:
 	virtual bool ReleaseLineCharacterIndex(Scintilla::LineCharacterIndexType lineCharacterIndex) = 0;
 	virtual Sci::Position IndexLineStart(Sci::Line line, Scintilla::LineCharacterIndexType lineCharacterIndex) const noexcept = 0;
 	virtual Sci::Line LineFromPositionIndex(Sci::Position pos, Scintilla::LineCharacterIndexType lineCharacterIndex) const noexcept = 0;
+	virtual Sci::Line IndexedLines() const noexcept = 0;
+	virtual void SetIndexedLines(Sci::Line lines) noexcept = 0;
+	virtual size_t MemoryUsage() const noexcept = 0;
 	virtual ~ILineVector() = default;
 };
 
@@ -115,6 +131,12 @@ public:
 			length++;
 			starts.InsertPartition(static_cast<POS>(line), static_cast<POS>(length));
 		}
+		// the last line is also 1 character wide, so lines not yet measured are ascending
+		const POS lastLine = starts.Partitions() - 1;
+		const POS lastStart = starts.PositionFromPartition(lastLine);
+		if (starts.Length() <= lastStart) {
+			starts.InsertText(lastLine, lastStart + 1 - starts.Length());
+		}
 		return refCount == 1;
 	}
 	bool Release() {
@@ -148,16 +170,21 @@ public:
 		for (POS l = 0; l < static_cast<POS>(lines); l++) {
 			starts.InsertPartition(lineAsPos + l, lineStart + l);
 		}
+		// keep following lines ascending, lines not yet measured are searched by LineFromPositionIndex()
+		starts.InsertText(lineAsPos + static_cast<POS>(lines) - 1, static_cast<POS>(lines));
 	}
 };
 
-template <typename POS>
+template <typename POS, typename Starts = Partitioning<POS>>
 class LineVector final : public ILineVector {
-	Partitioning<POS> starts;
+	Starts starts;
 	PerLine *perLine;
 	LineStartIndex<POS> startsUTF16;
 	LineStartIndex<POS> startsUTF32;
 	LineCharacterIndexType activeIndices;
+	// character widths are measured lazily, only lines before indexedLines have correct widths,
+	// later lines keep the width of 1 given when they were inserted.
+	Sci::Line indexedLines = 0;
 
 	void SetActiveIndices() noexcept {
 		activeIndices = (startsUTF32.Active() ? LineCharacterIndexType::Utf32 : LineCharacterIndexType::None)
@@ -180,6 +207,7 @@ public:
 		}
 		startsUTF32.starts.DeleteAll();
 		startsUTF16.starts.DeleteAll();
+		indexedLines = 0;
 	}
 	void SetPerLine(PerLine *pl) noexcept override {
 		perLine = pl;
@@ -197,6 +225,10 @@ public:
 			if (FlagSet(activeIndices, LineCharacterIndexType::Utf16)) {
 				startsUTF16.InsertLines(line, 1);
 			}
+			// lines split from an indexed line are measured by the caller
+			if (line > 0 && line <= indexedLines) {
+				indexedLines++;
+			}
 		}
 		if (perLine) {
 			if ((line > 0) && lineStart) {
@@ -219,6 +251,9 @@ public:
 			if (FlagSet(activeIndices, LineCharacterIndexType::Utf16)) {
 				startsUTF16.InsertLines(line, lines);
 			}
+			if (line > 0 && line <= indexedLines) {
+				indexedLines += lines;
+			}
 		}
 		if (perLine) {
 			if ((line > 0) && lineStart) {
@@ -238,6 +273,12 @@ public:
 		if (FlagSet(activeIndices, LineCharacterIndexType::Utf16)) {
 			startsUTF16.starts.RemovePartition(static_cast<POS>(line));
 		}
+		if (line < indexedLines) {
+			indexedLines--;
+		} else if (line == indexedLines && line > 0) {
+			// the last indexed line is joined with a line not yet measured
+			indexedLines = line - 1;
+		}
 		if (perLine) {
 			perLine->RemoveLine(line);
 		}
@@ -263,6 +304,10 @@ public:
 		return starts.PositionFromPartition(static_cast<POS>(line));
 	}
 	void InsertCharacters(Sci::Line line, CountWidths delta) noexcept override {
+		if (line >= indexedLines) {
+			// keep width of 1 until measured
+			return;
+		}
 		if (FlagSet(activeIndices, LineCharacterIndexType::Utf32)) {
 			startsUTF32.starts.InsertText(static_cast<POS>(line), static_cast<POS>(delta.WidthUTF32()));
 		}
@@ -322,29 +367,276 @@ public:
 			return static_cast<Sci::Line>(startsUTF16.starts.PartitionFromPosition(static_cast<POS>(pos)));
 		}
 	}
+	Sci::Line IndexedLines() const noexcept override {
+		return indexedLines;
+	}
+	void SetIndexedLines(Sci::Line lines) noexcept override {
+		indexedLines = lines;
+	}
+	size_t MemoryUsage() const noexcept override {
+		return starts.MemoryUsage() + startsUTF32.starts.MemoryUsage() + startsUTF16.starts.MemoryUsage();
+	}
+};
+
+namespace Scintilla::Internal {
+
+// Temporary file holding spilled undo text, removed when closed.
+// On Windows it is created in the user's temporary directory, as tmpfile() from msvcrt creates
+// the file in root of current drive, which fails without administrator rights.
+class UndoSpillFile {
+#if defined(_WIN32)
+	HANDLE hFile = INVALID_HANDLE_VALUE;
+	// positioned read or write in pieces a DWORD can count
+	template <typename T, typename F>
+	bool Transfer(size_t position, T *data, size_t length, F transfer) noexcept {
+		while (length != 0) {
+			const DWORD piece = static_cast<DWORD>(std::min<size_t>(length, 1024*1024*1024));
+			OVERLAPPED overlapped {};
+			overlapped.Offset = static_cast<DWORD>(position);
+			overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(position) >> 32);
+			DWORD transferred = 0;
+			if (!transfer(hFile, data, piece, &transferred, &overlapped) || transferred != piece) {
+				return false;
+			}
+			position += piece;
+			data += piece;
+			length -= piece;
+		}
+		return true;
+	}
+#else
+	FILE *fp = nullptr;
+	bool Seek(size_t position) noexcept {
+		return fseeko(fp, static_cast<off_t>(position), SEEK_SET) == 0;
+	}
+#endif
+public:
+	UndoSpillFile() noexcept = default;
+	// Deleted so UndoSpillFile objects can not be copied.
+	UndoSpillFile(const UndoSpillFile &) = delete;
+	UndoSpillFile(UndoSpillFile &&) = delete;
+	void operator=(const UndoSpillFile &) = delete;
+	void operator=(UndoSpillFile &&) = delete;
+	~UndoSpillFile() {
+#if defined(_WIN32)
+		if (hFile != INVALID_HANDLE_VALUE) {
+			CloseHandle(hFile);
+		}
+#else
+		if (fp) {
+			fclose(fp);
+		}
+#endif
+	}
+	// returns false when the file can not be created now, e.g. temporary directory is full.
+	bool Open() noexcept {
+#if defined(_WIN32)
+		if (hFile != INVALID_HANDLE_VALUE) {
+			return true;
+		}
+		WCHAR dir[MAX_PATH + 1];
+		const DWORD length = GetTempPathW(MAX_PATH + 1, dir);
+		WCHAR path[MAX_PATH];
+		if (length == 0 || length > MAX_PATH || !GetTempFileNameW(dir, L"sci", 0, path)) {
+			return false;
+		}
+		hFile = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+			FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE) {
+			DeleteFileW(path);
+			return false;
+		}
+		return true;
+#else
+		if (!fp) {
+			fp = tmpfile();
+		}
+		return fp != nullptr;
+#endif
+	}
+	bool Write(size_t position, const char *data, size_t length) noexcept {
+#if defined(_WIN32)
+		return Transfer(position, data, length, [](HANDLE handle, const char *buffer, DWORD count, DWORD *transferred, OVERLAPPED *overlapped) noexcept {
+			return WriteFile(handle, buffer, count, transferred, overlapped);
+		});
+#else
+		return Seek(position) && fwrite(data, 1, length, fp) == length;
+#endif
+	}
+	bool Read(size_t position, char *data, size_t length) noexcept {
+#if defined(_WIN32)
+		return Transfer(position, data, length, [](HANDLE handle, char *buffer, DWORD count, DWORD *transferred, OVERLAPPED *overlapped) noexcept {
+			return ReadFile(handle, buffer, count, transferred, overlapped);
+		});
+#else
+		return Seek(position) && fread(data, 1, length, fp) == length;
+#endif
+	}
 };
 
+}
+
+UndoTextArena::UndoTextArena() noexcept : current{0}, used{0}, budget{0}, resident{0} {
+}
+
+UndoTextArena::~UndoTextArena() = default;
+
+size_t UndoTextArena::BlockUsed(size_t index) const noexcept {
+	return (index < current) ? blocks[index + 1].start - blocks[index].start : ((index == current) ? used : 0);
+}
+
+size_t UndoTextArena::BlockFromPosition(size_t position) const noexcept {
+	// last block starting at or before position, blocks after current are spare
+	const auto end = blocks.begin() + current + 1;
+	const auto it = std::upper_bound(blocks.begin(), end, position, [](size_t pos, const Block &block) noexcept {
+		return pos < block.start;
+	});
+	return (it == blocks.begin()) ? 0 : (it - blocks.begin() - 1);
+}
+
+bool UndoTextArena::Load(size_t index, size_t length) {
+	Block &block = blocks[index];
+	if (block.data) {
+		return true;
+	}
+	block.data = std::make_unique<char[]>(block.size);
+	resident += block.size;
+	return length == 0 || (spillFile && spillFile->Read(block.start, block.data.get(), length));
+}
+
+void UndoTextArena::Free(size_t index) noexcept {
+	Block &block = blocks[index];
+	if (block.data) {
+		block.data.reset();
+		resident -= block.size;
+	}
+}
+
+void UndoTextArena::Trim() {
+	if (budget == 0 || resident <= budget) {
+		return;
+	}
+	// spare blocks hold no text so are just freed
+	for (size_t index = blocks.size() - 1; index > current && resident > budget; index--) {
+		Free(index);
+	}
+	if (!spillFile) {
+		spillFile = std::make_unique<UndoSpillFile>();
+	}
+	// creating the file is tried again when next block is allocated
+	if (!spillFile->Open()) {
+		return;
+	}
+	// oldest blocks first, current block is never spilled
+	for (size_t index = 0; index < current && resident > budget; index++) {
+		Block &block = blocks[index];
+		if (block.data) {
+			if (!spillFile->Write(block.start, block.data.get(), BlockUsed(index))) {
+				return;
+			}
+			Free(index);
+		}
+	}
+}
+
+char *UndoTextArena::Allocate(size_t length) {
+	if (!blocks.empty() && used + length <= blocks[current].size) {
+		char *ptr = blocks[current].data.get() + used;
+		used += length;
+		return ptr;
+	}
+	// continue in next block, reusing it when large enough
+	const size_t start = Top();
+	const size_t next = blocks.empty() ? 0 : current + 1;
+	if (next < blocks.size() && (blocks[next].size < length || !blocks[next].data)) {
+		for (size_t index = next; index < blocks.size(); index++) {
+			Free(index);
+		}
+		blocks.resize(next);
+	}
+	if (next == blocks.size()) {
+		const size_t size = std::max(blockSize, length);
+		blocks.push_back({std::make_unique<char[]>(size), size, start});
+		resident += size;
+	}
+	current = next;
+	blocks[current].start = start;
+	used = length;
+	Trim();
+	return blocks[current].data.get();
+}
+
+void UndoTextArena::Rewind(size_t top) {
+	if (blocks.empty()) {
+		return;
+	}
+	while (current > 0 && blocks[current].start > top) {
+		current--;
+	}
+	used = top - blocks[current].start;
+	if (!Load(current, used)) {
+		throw std::runtime_error("UndoTextArena::Rewind: spilled undo text can not be read.");
+	}
+	// keep one spare block for following actions
+	for (size_t index = current + 2; index < blocks.size(); index++) {
+		Free(index);
+	}
+	if (blocks.size() > current + 2) {
+		blocks.resize(current + 2);
+	}
+}
+
+void UndoTextArena::Clear() noexcept {
+	// keep first block to avoid allocating it again
+	for (size_t index = 1; index < blocks.size(); index++) {
+		Free(index);
+	}
+	if (blocks.size() > 1 || (!blocks.empty() && !blocks[0].data)) {
+		blocks.resize(blocks[0].data ? 1 : 0);
+	}
+	current = 0;
+	used = 0;
+}
+
+bool UndoTextArena::EnsureLoaded(size_t start, size_t end) noexcept {
+	if (start >= end) {
+		return true;
+	}
+	try {
+		const size_t last = BlockFromPosition(end - 1);
+		for (size_t index = BlockFromPosition(start); index <= last; index++) {
+			if (!Load(index, BlockUsed(index))) {
+				Free(index);
+				return false;
+			}
+		}
+	} catch (const std::bad_alloc &) {
+		return false;
+	}
+	return true;
+}
+
+const char *UndoTextArena::TextAt(size_t position) const noexcept {
+	const Block &block = blocks[BlockFromPosition(position)];
+	return block.data.get() + (position - block.start);
+}
+
+void UndoTextArena::SetBudget(size_t budget_) {
+	budget = budget_;
+	Trim();
+}
+
 Action::Action() noexcept {
 	at = ActionType::start;
 	position = 0;
+	data = nullptr;
 	lenData = 0;
 	mayCoalesce = false;
+	textEnd = 0;
 }
 
 Action::~Action() = default;
 
-void Action::Create(ActionType at_, Sci::Position position_, const char *data_, Sci::Position lenData_, bool mayCoalesce_) {
-	data = nullptr;
-	position = position_;
-	at = at_;
-	if (lenData_) {
-		data = std::make_unique<char[]>(lenData_);
-		memcpy(data.get(), data_, lenData_);
-	}
-	lenData = lenData_;
-	mayCoalesce = mayCoalesce_;
-}
-
 void Action::Clear() noexcept {
 	data = nullptr;
 	lenData = 0;
@@ -377,11 +669,46 @@ UndoHistory::UndoHistory() {
 	savePoint = 0;
 	tentativePoint = -1;
 
-	actions[currentAction].Create(ActionType::start);
+	CreateAction(currentAction, ActionType::start);
 }
 
 UndoHistory::~UndoHistory() = default;
 
+bool UndoHistory::EnsureTextLoaded(int first, int last) noexcept {
+	if (first > last) {
+		return true;
+	}
+	const size_t start = actions[first].textEnd - actions[first].lenData;
+	if (!text.EnsureLoaded(start, actions[last].textEnd)) {
+		return false;
+	}
+	// spilled blocks are read into new memory
+	for (int index = first; index <= last; index++) {
+		Action &action = actions[index];
+		if (action.lenData) {
+			action.data = text.TextAt(action.textEnd - action.lenData);
+		}
+	}
+	return true;
+}
+
+void UndoHistory::CreateAction(int index, ActionType at, Sci::Position position, const char *data, Sci::Position lengthData, bool mayCoalesce) {
+	// actions from index onwards are discarded, so is their text
+	text.Rewind((index > 0) ? actions[index - 1].textEnd : 0);
+	Action &action = actions[index];
+	action.at = at;
+	action.position = position;
+	action.data = nullptr;
+	if (lengthData) {
+		char *copy = text.Allocate(lengthData);
+		memcpy(copy, data, lengthData);
+		action.data = copy;
+	}
+	action.lenData = lengthData;
+	action.mayCoalesce = mayCoalesce;
+	action.textEnd = text.Top();
+}
+
 void UndoHistory::EnsureUndoRoom() {
 	// Have to test that there is room for 2 more actions in the array
 	// as two actions may be created by the calling function
@@ -456,11 +783,11 @@ const char *UndoHistory::AppendAction(ActionType at, Sci::Position position, con
 	}
 	startSequence = oldCurrentAction != currentAction;
 	const int actionWithData = currentAction;
-	actions[currentAction].Create(at, position, data, lengthData, mayCoalesce);
+	CreateAction(currentAction, at, position, data, lengthData, mayCoalesce);
 	currentAction++;
-	actions[currentAction].Create(ActionType::start);
+	CreateAction(currentAction, ActionType::start);
 	maxAction = currentAction;
-	return actions[actionWithData].data.get();
+	return actions[actionWithData].data;
 }
 
 void UndoHistory::BeginUndoAction() {
@@ -468,7 +795,7 @@ void UndoHistory::BeginUndoAction() {
 	if (undoSequenceDepth == 0) {
 		if (actions[currentAction].at != ActionType::start) {
 			currentAction++;
-			actions[currentAction].Create(ActionType::start);
+			CreateAction(currentAction, ActionType::start);
 			maxAction = currentAction;
 		}
 		actions[currentAction].mayCoalesce = false;
@@ -483,7 +810,7 @@ void UndoHistory::EndUndoAction() {
 	if (0 == undoSequenceDepth) {
 		if (actions[currentAction].at != ActionType::start) {
 			currentAction++;
-			actions[currentAction].Create(ActionType::start);
+			CreateAction(currentAction, ActionType::start);
 			maxAction = currentAction;
 		}
 		actions[currentAction].mayCoalesce = false;
@@ -498,13 +825,30 @@ void UndoHistory::DeleteUndoHistory() {
 	for (int i = 1; i < maxAction; i++) {
 		actions[i].Clear();
 	}
+	text.Clear();
 	maxAction = 0;
 	currentAction = 0;
-	actions[currentAction].Create(ActionType::start);
+	CreateAction(currentAction, ActionType::start);
 	savePoint = 0;
 	tentativePoint = -1;
 }
 
+void UndoHistory::SetMemoryBudget(size_t budget) {
+	text.SetBudget(budget);
+}
+
+size_t UndoHistory::GetMemoryBudget() const noexcept {
+	return text.GetBudget();
+}
+
+size_t UndoHistory::MemoryUsage() const noexcept {
+	return text.MemoryUsage();
+}
+
+size_t UndoHistory::MemoryAllocated() const noexcept {
+	return actions.capacity() * sizeof(Action) + text.MemoryUsage();
+}
+
 void UndoHistory::SetSavePoint() noexcept {
 	savePoint = currentAction;
 }
@@ -531,7 +875,7 @@ int UndoHistory::TentativeSteps() noexcept {
 	// Drop any trailing ActionType::start
 	if (actions[currentAction].at == ActionType::start && currentAction > 0)
 		currentAction--;
-	if (tentativePoint >= 0)
+	if (tentativePoint >= 0 && EnsureTextLoaded(tentativePoint + 1, currentAction))
 		return currentAction - tentativePoint;
 	else
 		return -1;
@@ -551,6 +895,9 @@ int UndoHistory::StartUndo() noexcept {
 	while (actions[act].at != ActionType::start && act > 0) {
 		act--;
 	}
+	if (!EnsureTextLoaded(act + 1, currentAction)) {
+		return 0;
+	}
 	return currentAction - act;
 }
 
@@ -576,6 +923,9 @@ int UndoHistory::StartRedo() noexcept {
 	while (act < maxAction && actions[act].at != ActionType::start) {
 		act++;
 	}
+	if (!EnsureTextLoaded(currentAction, act - 1)) {
+		return 0;
+	}
 	return act - currentAction;
 }
 
@@ -598,16 +948,158 @@ SplitView::SplitView(const SplitVector<char> &instance) noexcept {
 	segment2 = instance.ElementPointer(length1) - length1;
 }
 
-CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_) :
-	hasStyles(hasStyles_), largeDocument(largeDocument_) {
+SplitView::SplitView(const char *text, size_t length_) noexcept {
+	length = length_;
+	length1 = length_;
+	segment1 = text;
+	segment2 = text;
+}
+
+SplitView::SplitView(const char *text, size_t start, size_t end) noexcept {
+	length = end;
+	length1 = end;
+	segment1 = text - start;
+	segment2 = segment1;
+}
+
+namespace {
+
+// pack the text while inserting, so loading a huge document doesn't need memory for all of it.
+constexpr Sci::Position PackInsertionInterval = 64*1024*1024;
+
+}
+
+TextStorage::TextStorage(bool chunked, bool compressed_) : compressed{chunked && compressed_} {
+	if (chunked) {
+		chunks = std::make_unique<ChunkedVector<char>>();
+	}
+}
+
+TextStorage::~TextStorage() = default;
+
+char TextStorage::ValueAt(Sci::Position position) const noexcept {
+	return chunks ? chunks->ValueAt(position) : gapBuffer.ValueAt(position);
+}
+
+Sci::Position TextStorage::Length() const noexcept {
+	return chunks ? chunks->Length() : gapBuffer.Length();
+}
+
+void TextStorage::ReAllocate(Sci::Position newSize) {
+	if (chunks) {
+		chunks->ReAllocate(newSize);
+	} else {
+		gapBuffer.ReAllocate(newSize);
+	}
+}
+
+void TextStorage::InsertFromArray(Sci::Position positionToInsert, const char *s, Sci::Position positionFrom, Sci::Position insertLength) {
+	if (chunks) {
+		chunks->InsertFromArray(positionToInsert, s, positionFrom, insertLength);
+		if (compressed) {
+			insertedSincePack += insertLength;
+			if (insertedSincePack >= PackInsertionInterval) {
+				insertedSincePack = 0;
+				chunks->Pack(positionToInsert, positionToInsert + insertLength);
+			}
+		}
+	} else {
+		gapBuffer.InsertFromArray(positionToInsert, s, positionFrom, insertLength);
+	}
+}
+
+void TextStorage::DeleteRange(Sci::Position position, Sci::Position deleteLength) {
+	if (chunks) {
+		chunks->DeleteRange(position, deleteLength);
+	} else {
+		gapBuffer.DeleteRange(position, deleteLength);
+	}
+}
+
+void TextStorage::GetRange(char *buffer, Sci::Position position, Sci::Position retrieveLength) const noexcept {
+	if (chunks) {
+		chunks->GetRange(buffer, position, retrieveLength);
+	} else {
+		gapBuffer.GetRange(buffer, position, retrieveLength);
+	}
+}
+
+const char *TextStorage::BufferPointer() {
+	return chunks ? chunks->BufferPointer() : gapBuffer.BufferPointer();
+}
+
+const char *TextStorage::RangePointer(Sci::Position position, Sci::Position rangeLength) {
+	return chunks ? chunks->RangePointer(position, rangeLength) : gapBuffer.RangePointer(position, rangeLength);
+}
+
+Sci::Position TextStorage::GapPosition() const noexcept {
+	return chunks ? chunks->GapPosition() : gapBuffer.GapPosition();
+}
+
+const char *TextStorage::CharRangePointer(Sci::Position position, Sci::Position *pStart, Sci::Position *pEnd) const noexcept {
+	if (chunks) {
+		return chunks->ChunkRange(position, pStart, pEnd);
+	}
+	// text on either side of the gap is contiguous
+	const SplitView view(gapBuffer);
+	if (position < static_cast<Sci::Position>(view.length1)) {
+		*pEnd = std::min<Sci::Position>(*pEnd, view.length1);
+		return view.segment1 + *pStart;
+	}
+	*pStart = std::max<Sci::Position>(*pStart, view.length1);
+	return view.segment2 + *pStart;
+}
+
+SplitView TextStorage::AllView() {
+	if (chunks) {
+		// chunks are consolidated into one contiguous segment
+		return SplitView(chunks->BufferPointer(), chunks->Length());
+	}
+	return SplitView(gapBuffer);
+}
+
+size_t TextStorage::MemoryUsage() const noexcept {
+	return chunks ? chunks->MemoryUsage() : gapBuffer.MemoryUsage();
+}
+
+void TextStorage::Pack(Sci::Position hotStart, Sci::Position hotEnd) {
+	if (compressed) {
+		insertedSincePack = 0;
+		chunks->Pack(hotStart, hotEnd);
+	}
+}
+
+void TextStorage::Pin(Sci::Position position, Sci::Position length) noexcept {
+	if (compressed) {
+		chunks->Pin(position, length);
+	}
+}
+
+namespace {
+
+std::unique_ptr<ILineVector> LineVectorCreate(bool largeDocument, bool compactLines) {
+	if (compactLines)
+		return std::make_unique<LineVector<Sci::Position, CompactPartitioning>>();
+	else if (largeDocument)
+		return std::make_unique<LineVector<Sci::Position>>();
+	else
+		return std::make_unique<LineVector<int>>();
+}
+
+}
+
+CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_, bool compressStyles_, bool chunkedText_, bool compactLines_, bool compressedText_) :
+	hasStyles(hasStyles_), largeDocument(largeDocument_), compressStyles(compressStyles_),
+	compactLines(largeDocument_ && compactLines_), substance(chunkedText_ || compressedText_, compressedText_) {
+	if (hasStyles && compressStyles) {
+		styleRuns = std::make_unique<RunStyles<Sci::Position, char>>();
+	}
+	styleExpandedLength = 0;
 	readOnly = false;
 	utf8Substance = false;
 	utf8LineEnds = LineEndType::Default;
 	collectingUndo = true;
-	if (largeDocument)
-		plv = std::make_unique<LineVector<Sci::Position>>();
-	else
-		plv = std::make_unique<LineVector<int>>();
+	plv = LineVectorCreate(largeDocument, compactLines);
 }
 
 CellBuffer::~CellBuffer() = default;
@@ -636,6 +1128,9 @@ void CellBuffer::GetCharRange(char *buffer, Sci::Position position, Sci::Positio
 }
 
 char CellBuffer::StyleAt(Sci::Position position) const noexcept {
+	if (styleRuns) {
+		return (position >= 0 && position < styleRuns->Length()) ? styleRuns->ValueAt(position) : '\0';
+	}
 	return hasStyles ? style.ValueAt(position) : '\0';
 }
 
@@ -648,6 +1143,19 @@ void CellBuffer::GetStyleRange(unsigned char *buffer, Sci::Position position, Sc
 		std::fill_n(buffer, lengthRetrieve, static_cast<unsigned char>(0));
 		return;
 	}
+	if (styleRuns) {
+		const Sci::Position end = position + lengthRetrieve;
+		if (end > styleRuns->Length()) {
+			return;
+		}
+		while (position < end) {
+			const Sci::Position runEnd = std::min(styleRuns->EndRun(position), end);
+			memset(buffer, static_cast<unsigned char>(styleRuns->ValueAt(position)), runEnd - position);
+			buffer += runEnd - position;
+			position = runEnd;
+		}
+		return;
+	}
 	if ((position + lengthRetrieve) > style.Length()) {
 		//Platform::DebugPrintf("Bad GetStyleRange %.0f for %.0f of %.0f\n",
 		//					static_cast<double>(position),
@@ -662,11 +1170,20 @@ const char *CellBuffer::BufferPointer() {
 	return substance.BufferPointer();
 }
 
-const char *CellBuffer::RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept {
+const char *CellBuffer::RangePointer(Sci::Position position, Sci::Position rangeLength) {
 	return substance.RangePointer(position, rangeLength);
 }
 
-const char *CellBuffer::StyleRangePointer(Sci::Position position, Sci::Position rangeLength) noexcept {
+const char *CellBuffer::StyleRangePointer(Sci::Position position, Sci::Position rangeLength) {
+	if (styleRuns) {
+		// expand runs into a buffer reused between calls
+		if (rangeLength > styleExpandedLength) {
+			styleExpanded = std::make_unique<char[]>(rangeLength);
+			styleExpandedLength = rangeLength;
+		}
+		GetStyleRange(reinterpret_cast<unsigned char *>(styleExpanded.get()), position, rangeLength);
+		return styleExpanded.get();
+	}
 	return hasStyles ? style.RangePointer(position, rangeLength) : nullptr;
 }
 
@@ -674,8 +1191,20 @@ Sci::Position CellBuffer::GapPosition() const noexcept {
 	return substance.GapPosition();
 }
 
-SplitView CellBuffer::AllView() const noexcept {
-	return SplitView(substance);
+const char *CellBuffer::CharRangePointer(Sci::Position position, Sci::Position *pStart, Sci::Position *pEnd) const noexcept {
+	return substance.CharRangePointer(position, pStart, pEnd);
+}
+
+SplitView CellBuffer::AllView() {
+	return substance.AllView();
+}
+
+void CellBuffer::PackText(Sci::Position hotStart, Sci::Position hotEnd) {
+	substance.Pack(hotStart, hotEnd);
+}
+
+void CellBuffer::PinText(Sci::Position position, Sci::Position length) noexcept {
+	substance.Pin(position, length);
 }
 
 // The char* returned is to an allocation owned by the undo history
@@ -694,7 +1223,10 @@ const char *CellBuffer::InsertString(Sci::Position position, const char *s, Sci:
 	return data;
 }
 
-bool CellBuffer::SetStyleAt(Sci::Position position, char styleValue) noexcept {
+bool CellBuffer::SetStyleAt(Sci::Position position, char styleValue) {
+	if (styleRuns) {
+		return position >= 0 && styleRuns->FillRange(position, styleValue, 1).changed;
+	}
 	if (!hasStyles) {
 		return false;
 	}
@@ -707,7 +1239,12 @@ bool CellBuffer::SetStyleAt(Sci::Position position, char styleValue) noexcept {
 	}
 }
 
-bool CellBuffer::SetStyleFor(Sci::Position position, Sci::Position lengthStyle, char styleValue) noexcept {
+bool CellBuffer::SetStyleFor(Sci::Position position, Sci::Position lengthStyle, char styleValue) {
+	if (styleRuns) {
+		PLATFORM_ASSERT(lengthStyle == 0 ||
+			(lengthStyle > 0 && lengthStyle + position <= styleRuns->Length()));
+		return position >= 0 && styleRuns->FillRange(position, styleValue, lengthStyle).changed;
+	}
 	if (!hasStyles) {
 		return false;
 	}
@@ -725,6 +1262,46 @@ bool CellBuffer::SetStyleFor(Sci::Position position, Sci::Position lengthStyle,
 	return changed;
 }
 
+bool CellBuffer::SetStyles(Sci::Position position, const unsigned char *styles, Sci::Position length, Sci::Position &startMod, Sci::Position &endMod) {
+	if (!hasStyles) {
+		return false;
+	}
+	bool changed = false;
+	if (styleRuns) {
+		// fill each run of same style at once
+		Sci::Position index = 0;
+		while (index < length) {
+			const unsigned char styleValue = styles[index];
+			Sci::Position next = index + 1;
+			while (next < length && styles[next] == styleValue) {
+				next++;
+			}
+			const FillResult<Sci::Position> result = styleRuns->FillRange(position + index, static_cast<char>(styleValue), next - index);
+			if (result.changed) {
+				if (!changed) {
+					startMod = result.position;
+				}
+				changed = true;
+				endMod = result.position + result.fillLength - 1;
+			}
+			index = next;
+		}
+	} else {
+		for (Sci::Position index = 0; index < length; index++, position++) {
+			const char styleValue = styles[index];
+			if (style.ValueAt(position) != styleValue) {
+				style.SetValueAt(position, styleValue);
+				if (!changed) {
+					startMod = position;
+				}
+				changed = true;
+				endMod = position;
+			}
+		}
+	}
+	return changed;
+}
+
 // The char* returned is to an allocation owned by the undo history
 const char *CellBuffer::DeleteChars(Sci::Position position, Sci::Position deleteLength, bool &startSequence) {
 	// InsertString and DeleteChars are the bottleneck though which all changes occur
@@ -749,7 +1326,7 @@ Sci::Position CellBuffer::Length() const noexcept {
 
 void CellBuffer::Allocate(Sci::Position newSize) {
 	substance.ReAllocate(newSize);
-	if (hasStyles) {
+	if (hasStyles && !styleRuns) {
 		style.ReAllocate(newSize);
 	}
 }
@@ -757,7 +1334,16 @@ void CellBuffer::Allocate(Sci::Position newSize) {
 bool CellBuffer::EnsureStyleBuffer(bool hasStyles_) {
 	if (hasStyles != hasStyles_) {
 		hasStyles = hasStyles_;
-		if (hasStyles_) {
+		if (compressStyles) {
+			if (hasStyles_) {
+				styleRuns = std::make_unique<RunStyles<Sci::Position, char>>();
+				styleRuns->InsertSpace(0, substance.Length());
+			} else {
+				styleRuns.reset();
+				styleExpanded.reset();
+				styleExpandedLength = 0;
+			}
+		} else if (hasStyles_) {
 			style.InsertValue(0, substance.Length(), 0);
 		} else {
 			style.DeleteAll();
@@ -767,7 +1353,63 @@ bool CellBuffer::EnsureStyleBuffer(bool hasStyles_) {
 	return false;
 }
 
+void CellBuffer::ConvertToLarge(bool compressStyles_, bool compactLines_) {
+	if (largeDocument) {
+		return;
+	}
+
+	// Text and undo history are position type independent and kept as is,
+	// only line starts are copied into a 64-bit line vector.
+	std::unique_ptr<ILineVector> plvLarge = LineVectorCreate(true, compactLines_);
+	const Sci::Line lines = plv->Lines();
+	plvLarge->AllocateLines(lines);
+	plvLarge->InsertText(0, Length());
+	constexpr Sci::Line blockLines = 64*1024;
+	std::vector<Sci::Position> positions(static_cast<size_t>(std::min(lines, blockLines)));
+	for (Sci::Line line = 1; line < lines;) {
+		const Sci::Line count = std::min(lines - line, blockLines);
+		for (Sci::Line i = 0; i < count; i++) {
+			positions[i] = plv->LineStart(line + i);
+		}
+		plvLarge->InsertLines(line, positions.data(), count, true);
+		line += count;
+	}
+
+	const LineCharacterIndexType indexes = plv->LineCharacterIndex();
+	plv = std::move(plvLarge);
+	largeDocument = true;
+	compactLines = compactLines_;
+	AllocateLineCharacterIndex(indexes);
+
+	if (compressStyles_ && !compressStyles) {
+		compressStyles = true;
+		if (hasStyles) {
+			styleRuns = std::make_unique<RunStyles<Sci::Position, char>>();
+			const Sci::Position length = style.Length();
+			styleRuns->InsertSpace(0, length);
+			const char *styles = style.BufferPointer();
+			Sci::Position position = 0;
+			while (position < length) {
+				const char value = styles[position];
+				const char *end = std::find_if(styles + position + 1, styles + length, [value](char ch) noexcept {
+					return ch != value;
+				});
+				const Sci::Position runLength = end - styles - position;
+				if (value != 0) {
+					styleRuns->FillRange(position, value, runLength);
+				}
+				position += runLength;
+			}
+			style.DeleteAll();
+		}
+	}
+}
+
 void CellBuffer::SetUTF8Substance(bool utf8Substance_) noexcept {
+	if (utf8Substance_ && !utf8Substance) {
+		// the index is not maintained for other encodings
+		plv->SetIndexedLines(0);
+	}
 	utf8Substance = utf8Substance_;
 }
 
@@ -810,8 +1452,8 @@ LineCharacterIndexType CellBuffer::LineCharacterIndex() const noexcept {
 void CellBuffer::AllocateLineCharacterIndex(LineCharacterIndexType lineCharacterIndex) {
 	if (utf8Substance) {
 		if (plv->AllocateLineCharacterIndex(lineCharacterIndex, Lines())) {
-			// Changed so recalculate whole file
-			RecalculateIndexLineStarts(0, Lines() - 1);
+			// Changed so recalculate whole file, lines are measured on first query
+			plv->SetIndexedLines(0);
 		}
 	}
 }
@@ -842,10 +1484,18 @@ Sci::Line CellBuffer::LineFromPosition(Sci::Position pos) const noexcept {
 }
 
 Sci::Position CellBuffer::IndexLineStart(Sci::Line line, LineCharacterIndexType lineCharacterIndex) const noexcept {
+	if (line > plv->IndexedLines()) {
+		IndexLines(line);
+	}
 	return plv->IndexLineStart(line, lineCharacterIndex);
 }
 
 Sci::Line CellBuffer::LineFromPositionIndex(Sci::Position pos, LineCharacterIndexType lineCharacterIndex) const noexcept {
+	Sci::Line indexedLines = plv->IndexedLines();
+	while (indexedLines < Lines() && plv->IndexLineStart(indexedLines, lineCharacterIndex) <= pos) {
+		IndexLines(indexedLines + 1);
+		indexedLines = plv->IndexedLines();
+	}
 	return plv->LineFromPositionIndex(pos, lineCharacterIndex);
 }
 
@@ -865,6 +1515,22 @@ bool CellBuffer::HasStyles() const noexcept {
 	return hasStyles;
 }
 
+bool CellBuffer::IsStylesCompressed() const noexcept {
+	return compressStyles;
+}
+
+bool CellBuffer::IsTextChunked() const noexcept {
+	return substance.IsChunked();
+}
+
+bool CellBuffer::IsTextCompressed() const noexcept {
+	return substance.IsCompressed();
+}
+
+bool CellBuffer::IsLinesCompact() const noexcept {
+	return compactLines;
+}
+
 void CellBuffer::SetSavePoint() noexcept {
 	uh.SetSavePoint();
 }
@@ -983,6 +1649,33 @@ CountWidths CountCharacterWidthsUTF8(std::string_view sv) noexcept {
 	CountWidths cw;
 	size_t remaining = sv.length();
 	while (remaining > 0) {
+		// skip ASCII blocks
+#if NP2_USE_AVX2
+		while (remaining >= sizeof(__m256i)) {
+			const __m256i chunk = _mm256_loadu_si256((const __m256i *)sv.data());
+			if (_mm256_movemask_epi8(chunk) != 0) {
+				break;
+			}
+			cw.countBasePlane += sizeof(__m256i);
+			sv.remove_prefix(sizeof(__m256i));
+			remaining -= sizeof(__m256i);
+		}
+		// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+		while (remaining >= sizeof(__m128i)) {
+			const __m128i chunk = _mm_loadu_si128((const __m128i *)sv.data());
+			if (_mm_movemask_epi8(chunk) != 0) {
+				break;
+			}
+			cw.countBasePlane += sizeof(__m128i);
+			sv.remove_prefix(sizeof(__m128i));
+			remaining -= sizeof(__m128i);
+		}
+		// end NP2_USE_SSE2
+#endif
+		if (remaining == 0) {
+			break;
+		}
 		const int utf8Status = UTF8Classify(sv);
 		const int lenChar = utf8Status & UTF8MaskWidth;
 		cw.CountChar(lenChar);
@@ -992,27 +1685,160 @@ CountWidths CountCharacterWidthsUTF8(std::string_view sv) noexcept {
 	return cw;
 }
 
+// bulk insertion (e.g. loading huge file) finds line ends in chunks on all processors.
+constexpr Sci::Position ParallelLineIndexMinSize = 16*1024*1024;
+constexpr Sci::Position ParallelLineIndexChunkSize = 4*1024*1024;
+
+// append position after each line end in [ptr, end), position is document position of ptr, *end must be readable.
+// CR followed by LF is skipped and the LF ends the line, so chunks can be scanned independently.
+#if NP2_USE_AVX2 || NP2_DYNAMIC_AVX2
+NP2_TARGET_AVX2
+void FindLineEndsAVX2(const char *ptr, const char * const end, Sci::Position position, std::vector<Sci::Position> &positions) {
+	const __m256i vectCR = _mm256_set1_epi8('\r');
+	const __m256i vectLF = _mm256_set1_epi8('\n');
+	for (; ptr + sizeof(__m256i) <= end; ptr += sizeof(__m256i), position += sizeof(__m256i)) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+		uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectCR), _mm256_cmpeq_epi8(chunk, vectLF)));
+		while (mask) {
+			const uint32_t trailing = np2::ctz(mask);
+			mask &= mask - 1;
+			if (ptr[trailing] == '\n' || ptr[trailing + 1] != '\n') {
+				positions.push_back(position + trailing + 1);
+			}
+		}
+	}
+	while (ptr < end) {
+		const char ch = *ptr++;
+		++position;
+		if (ch == '\n' || (ch == '\r' && *ptr != '\n')) {
+			positions.push_back(position);
+		}
+	}
+}
+#endif
+
+#if NP2_DYNAMIC_AVX2
+const bool cpuSupportsAVX2 = np2_cpu_supports_avx2();
+#endif
+
+void FindLineEnds(const char *ptr, const char * const end, Sci::Position position, std::vector<Sci::Position> &positions) {
+#if NP2_USE_AVX2
+	FindLineEndsAVX2(ptr, end, position, positions);
+#else
+#if NP2_DYNAMIC_AVX2
+	if (cpuSupportsAVX2) {
+		FindLineEndsAVX2(ptr, end, position, positions);
+		return;
+	}
+#endif
+#if NP2_USE_SSE2
+	const __m128i vectCR = _mm_set1_epi8('\r');
+	const __m128i vectLF = _mm_set1_epi8('\n');
+	for (; ptr + sizeof(__m128i) <= end; ptr += sizeof(__m128i), position += sizeof(__m128i)) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, vectCR), _mm_cmpeq_epi8(chunk, vectLF)));
+		while (mask) {
+			const uint32_t trailing = np2::ctz(mask);
+			mask &= mask - 1;
+			if (ptr[trailing] == '\n' || ptr[trailing + 1] != '\n') {
+				positions.push_back(position + trailing + 1);
+			}
+		}
+	}
+	// end NP2_USE_SSE2
+#elif NP2_USE_NEON
+	const uint8x16_t vectCR = vdupq_n_u8('\r');
+	const uint8x16_t vectLF = vdupq_n_u8('\n');
+	for (; ptr + 4*sizeof(uint8x16_t) <= end; ptr += 4*sizeof(uint8x16_t), position += 4*sizeof(uint8x16_t)) {
+		const uint8_t * const chunk = reinterpret_cast<const uint8_t *>(ptr);
+		const uint8x16_t chunk1 = vld1q_u8(chunk);
+		const uint8x16_t chunk2 = vld1q_u8(chunk + sizeof(uint8x16_t));
+		const uint8x16_t chunk3 = vld1q_u8(chunk + 2*sizeof(uint8x16_t));
+		const uint8x16_t chunk4 = vld1q_u8(chunk + 3*sizeof(uint8x16_t));
+		uint64_t mask = neon_movemask_epi8x4(vorrq_u8(vceqq_u8(chunk1, vectCR), vceqq_u8(chunk1, vectLF)),
+			vorrq_u8(vceqq_u8(chunk2, vectCR), vceqq_u8(chunk2, vectLF)),
+			vorrq_u8(vceqq_u8(chunk3, vectCR), vceqq_u8(chunk3, vectLF)),
+			vorrq_u8(vceqq_u8(chunk4, vectCR), vceqq_u8(chunk4, vectLF)));
+		while (mask) {
+			const uint64_t trailing = np2::ctz(mask);
+			mask &= mask - 1;
+			if (ptr[trailing] == '\n' || ptr[trailing + 1] != '\n') {
+				positions.push_back(position + trailing + 1);
+			}
+		}
+	}
+	// end NP2_USE_NEON
+#endif
+	while (ptr < end) {
+		const char ch = *ptr++;
+		++position;
+		if (ch == '\n' || (ch == '\r' && *ptr != '\n')) {
+			positions.push_back(position);
+		}
+	}
+#endif
+}
+
 }
 
 bool CellBuffer::MaintainingLineCharacterIndex() const noexcept {
 	return plv->LineCharacterIndex() != LineCharacterIndexType::None;
 }
 
-void CellBuffer::RecalculateIndexLineStarts(Sci::Line lineFirst, Sci::Line lineLast) {
-	std::string text;
+// count characters in [position, end) in blocks split before a lead byte
+CountWidths CellBuffer::CountCharacterWidths(Sci::Position position, Sci::Position end) const noexcept {
+	constexpr Sci::Position blockSize = 4096;
+	char buffer[blockSize];
+	CountWidths cw;
+	while (position < end) {
+		Sci::Position length = std::min(end - position, blockSize);
+		if (position + length < end) {
+			Sci::Position split = length;
+			while (split > length - UTF8MaxBytes && UTF8IsTrailByte(substance.ValueAt(position + split))) {
+				split--;
+			}
+			if (!UTF8IsTrailByte(substance.ValueAt(position + split))) {
+				length = split;
+			}
+		}
+		substance.GetRange(buffer, position, length);
+		cw += CountCharacterWidthsUTF8(std::string_view(buffer, length));
+		position += length;
+	}
+	return cw;
+}
+
+void CellBuffer::RecalculateIndexLineStarts(Sci::Line lineFirst, Sci::Line lineLast) noexcept {
+	// lines not yet measured are measured on first query
+	lineLast = std::min(lineLast, plv->IndexedLines() - 1);
 	Sci::Position posLineEnd = LineStart(lineFirst);
 	for (Sci::Line line = lineFirst; line <= lineLast; line++) {
-		// Find line start and end, retrieve text of line, count characters and update line width
+		// Find line start and end, count characters and update line width
 		const Sci::Position posLineStart = posLineEnd;
 		posLineEnd = LineStart(line + 1);
-		const Sci::Position width = posLineEnd - posLineStart;
-		text.resize(width);
-		GetCharRange(text.data(), posLineStart, width);
-		const CountWidths cw = CountCharacterWidthsUTF8(text);
+		const CountWidths cw = CountCharacterWidths(posLineStart, posLineEnd);
 		plv->SetLineCharactersWidth(line, cw);
 	}
 }
 
+// measure lines in blocks until lines before line are indexed
+void CellBuffer::IndexLines(Sci::Line line) const noexcept {
+	constexpr Sci::Line blockLines = 4096;
+	const Sci::Line lineFirst = plv->IndexedLines();
+	const Sci::Line lineEnd = std::min(Lines(), (line / blockLines + 1) * blockLines);
+	if (lineFirst >= lineEnd || !MaintainingLineCharacterIndex()) {
+		return;
+	}
+	Sci::Position posLineEnd = LineStart(lineFirst);
+	for (Sci::Line index = lineFirst; index < lineEnd; index++) {
+		const Sci::Position posLineStart = posLineEnd;
+		posLineEnd = LineStart(index + 1);
+		const CountWidths cw = CountCharacterWidths(posLineStart, posLineEnd);
+		plv->SetLineCharactersWidth(index, cw);
+	}
+	plv->SetIndexedLines(lineEnd);
+}
+
 void CellBuffer::BasicInsertString(const Sci::Position position, const char * const s, const Sci::Position insertLength) {
 	if (insertLength == 0)
 		return;
@@ -1041,7 +1867,10 @@ void CellBuffer::BasicInsertString(const Sci::Position position, const char * co
 	}
 
 	substance.InsertFromArray(position, s, 0, insertLength);
-	if (hasStyles) {
+	if (styleRuns) {
+		styleRuns->InsertSpace(position, insertLength);
+		styleRuns->FillRange(position, 0, insertLength);
+	} else if (hasStyles) {
 		style.InsertValue(position, insertLength, 0);
 	}
 
@@ -1081,6 +1910,62 @@ void CellBuffer::BasicInsertString(const Sci::Position position, const char * co
 		simpleInsertion = false;
 	}
 
+	if (utf8LineEnds == LineEndType::Default && end - ptr >= ParallelLineIndexMinSize) {
+		// find line ends in parallel, then insert all lines at once without reallocating in small blocks.
+		const size_t length = end - ptr;
+		const size_t chunkCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, length / ParallelLineIndexChunkSize);
+		const size_t chunkSize = length / chunkCount;
+		std::vector<std::vector<Sci::Position>> chunkPositions(chunkCount);
+		std::vector<std::thread> threads;
+		threads.reserve(chunkCount - 1);
+		for (size_t i = 0; i < chunkCount; i++) {
+			const char *chunkStart = ptr + i*chunkSize;
+			const char *chunkEnd = (i + 1 == chunkCount) ? end : chunkStart + chunkSize;
+			const Sci::Position chunkPosition = position + chunkStart - s;
+			// last chunk is scanned on current thread
+			bool scanned = false;
+			if (i + 1 != chunkCount) {
+				try {
+					threads.emplace_back(FindLineEnds, chunkStart, chunkEnd, chunkPosition, std::ref(chunkPositions[i]));
+					scanned = true;
+				} catch (const std::exception &) {
+					// fallback to scan on current thread
+				}
+			}
+			if (!scanned) {
+				FindLineEnds(chunkStart, chunkEnd, chunkPosition, chunkPositions[i]);
+			}
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+		for (const std::vector<Sci::Position> &chunk : chunkPositions) {
+			if (!chunk.empty()) {
+				plv->InsertLines(lineInsert, chunk.data(), chunk.size(), atLineStart);
+				lineInsert += chunk.size();
+			}
+		}
+		ptr = end;
+	}
+
+#if NP2_DYNAMIC_AVX2 || NP2_USE_NEON
+#if NP2_DYNAMIC_AVX2
+	if (cpuSupportsAVX2 && utf8LineEnds == LineEndType::Default && ptr + 2*sizeof(__m256i) <= end) {
+		// the inline SSE2 loop below is compiled without AVX2, scan with the AVX2 kernel instead.
+#else
+	if (utf8LineEnds == LineEndType::Default && ptr + 4*sizeof(uint8x16_t) <= end) {
+		// no inline Neon loop below, scan with the Neon kernel.
+#endif
+		std::vector<Sci::Position> lineEnds;
+		FindLineEnds(ptr, end, position + ptr - s, lineEnds);
+		if (!lineEnds.empty()) {
+			plv->InsertLines(lineInsert, lineEnds.data(), lineEnds.size(), atLineStart);
+			lineInsert += lineEnds.size();
+		}
+		ptr = end;
+	}
+#endif
+
 #if NP2_USE_AVX2
 	if (utf8LineEnds == LineEndType::Default && ptr + 2*sizeof(__m256i) <= end) {
 		const __m256i vectCR = _mm256_set1_epi8('\r');
@@ -1532,7 +2417,9 @@ void CellBuffer::BasicDeleteChars(const Sci::Position position, const Sci::Posit
 	if (lineRecalculateStart >= 0) {
 		RecalculateIndexLineStarts(lineRecalculateStart, lineRecalculateStart);
 	}
-	if (hasStyles) {
+	if (styleRuns) {
+		styleRuns->DeleteRange(position, deleteLength);
+	} else if (hasStyles) {
 		style.DeleteRange(position, deleteLength);
 	}
 }
@@ -1564,6 +2451,33 @@ void CellBuffer::DeleteUndoHistory() {
 	uh.DeleteUndoHistory();
 }
 
+void CellBuffer::SetUndoMemoryBudget(size_t budget) {
+	uh.SetMemoryBudget(budget);
+}
+
+size_t CellBuffer::GetUndoMemoryBudget() const noexcept {
+	return uh.GetMemoryBudget();
+}
+
+size_t CellBuffer::UndoMemoryUsage() const noexcept {
+	return uh.MemoryUsage();
+}
+
+size_t CellBuffer::MemoryUsage(Scintilla::MemoryUsage usage) const noexcept {
+	switch (usage) {
+	case Scintilla::MemoryUsage::Text:
+		return substance.MemoryUsage();
+	case Scintilla::MemoryUsage::Styles:
+		return style.MemoryUsage() + (styleRuns ? styleRuns->MemoryUsage() : 0) + styleExpandedLength;
+	case Scintilla::MemoryUsage::Lines:
+		return plv->MemoryUsage();
+	case Scintilla::MemoryUsage::Undo:
+		return uh.MemoryAllocated();
+	default:
+		return 0;
+	}
+}
+
 bool CellBuffer::CanUndo() const noexcept {
 	return uh.CanUndo();
 }
@@ -1585,7 +2499,7 @@ void CellBuffer::PerformUndoStep() {
 		}
 		BasicDeleteChars(actionStep.position, actionStep.lenData);
 	} else if (actionStep.at == ActionType::remove) {
-		BasicInsertString(actionStep.position, actionStep.data.get(), actionStep.lenData);
+		BasicInsertString(actionStep.position, actionStep.data, actionStep.lenData);
 	}
 	uh.CompletedUndoStep();
 }
@@ -1605,7 +2519,7 @@ const Action &CellBuffer::GetRedoStep() const noexcept {
 void CellBuffer::PerformRedoStep() {
 	const Action &actionStep = uh.GetRedoStep();
 	if (actionStep.at == ActionType::insert) {
-		BasicInsertString(actionStep.position, actionStep.data.get(), actionStep.lenData);
+		BasicInsertString(actionStep.position, actionStep.data, actionStep.lenData);
 	} else if (actionStep.at == ActionType::remove) {
 		BasicDeleteChars(actionStep.position, actionStep.lenData);
 	}
@@ -10,6 +10,9 @@
 
 namespace Scintilla::Internal {
 
+template <typename DISTANCE, typename STYLE>
+class RunStyles;
+
 // Interface to per-line data that wants to see each line insertion and deletion
 class PerLine {
 public:
@@ -19,15 +22,71 @@ public:
 	virtual void InsertLine(Sci::Line line) = 0;
 	virtual void InsertLines(Sci::Line line, Sci::Line lines) = 0;
 	virtual void RemoveLine(Sci::Line line) = 0;
+	virtual size_t MemoryUsage() const noexcept = 0;
 };
 
 /**
  * The line vector contains information about each of the lines in a cell buffer.
  */
 class ILineVector;
+struct CountWidths;
 
 enum class ActionType { insert, remove, start, container };
 
+class UndoSpillFile;
+
+/**
+ * Stack of large blocks holding text of undo actions, so each action does not need its own
+ * allocation. Text is allocated in the same order as actions, so discarding actions after
+ * an index rewinds the stack to the end of text for the action before it.
+ * When a memory budget is set, the oldest blocks are written to a temporary file at their
+ * position in the stack and read back when undo reaches them.
+ */
+class UndoTextArena {
+	static constexpr size_t blockSize = 64*1024;
+	struct Block {
+		std::unique_ptr<char[]> data; // nullptr when spilled to file
+		size_t size;
+		size_t start; // position of the block in the whole stack
+	};
+	std::vector<Block> blocks;
+	size_t current;
+	size_t used;
+	size_t budget;
+	size_t resident;
+	std::unique_ptr<UndoSpillFile> spillFile;
+	size_t BlockUsed(size_t index) const noexcept;
+	size_t BlockFromPosition(size_t position) const noexcept;
+	bool Load(size_t index, size_t length);
+	void Free(size_t index) noexcept;
+	void Trim();
+public:
+	UndoTextArena() noexcept;
+	// Deleted so UndoTextArena objects can not be copied.
+	UndoTextArena(const UndoTextArena &) = delete;
+	UndoTextArena(UndoTextArena &&) = delete;
+	void operator=(const UndoTextArena &) = delete;
+	void operator=(UndoTextArena &&) = delete;
+	~UndoTextArena();
+	/// Position after the last allocated text
+	size_t Top() const noexcept {
+		return blocks.empty() ? 0 : blocks[current].start + used;
+	}
+	char *Allocate(size_t length);
+	void Rewind(size_t top);
+	void Clear() noexcept;
+	/// Read back spilled text between positions, returns false when it can not be read.
+	bool EnsureLoaded(size_t start, size_t end) noexcept;
+	const char *TextAt(size_t position) const noexcept;
+	void SetBudget(size_t budget_);
+	size_t GetBudget() const noexcept {
+		return budget;
+	}
+	size_t MemoryUsage() const noexcept {
+		return resident;
+	}
+};
+
 /**
  * Actions are used to store all the information required to perform one undo/redo step.
  */
@@ -35,9 +94,10 @@ class Action {
 public:
 	ActionType at;
 	Sci::Position position;
-	std::unique_ptr<char[]> data;
+	const char *data;
 	Sci::Position lenData;
 	bool mayCoalesce;
+	size_t textEnd; // UndoTextArena::Top() after text of this action
 
 	Action() noexcept;
 	// Deleted so Action objects can not be copied.
@@ -47,7 +107,6 @@ public:
 	// Move constructor allows vector to be resized without reallocating.
 	Action(Action &&other) noexcept = default;
 	~Action();
-	void Create(ActionType at_, Sci::Position position_ = 0, const char *data_ = nullptr, Sci::Position lenData_ = 0, bool mayCoalesce_ = true);
 	void Clear() noexcept;
 };
 
@@ -56,6 +115,7 @@ public:
  */
 class UndoHistory {
 	std::vector<Action> actions;
+	UndoTextArena text;
 	int maxAction;
 	int currentAction;
 	int undoSequenceDepth;
@@ -63,6 +123,8 @@ class UndoHistory {
 	int tentativePoint;
 
 	void EnsureUndoRoom();
+	bool EnsureTextLoaded(int first, int last) noexcept;
+	void CreateAction(int index, ActionType at, Sci::Position position = 0, const char *data = nullptr, Sci::Position lengthData = 0, bool mayCoalesce = true);
 
 public:
 	UndoHistory();
@@ -79,6 +141,10 @@ public:
 	void EndUndoAction();
 	void DropUndoSequence() noexcept;
 	void DeleteUndoHistory();
+	void SetMemoryBudget(size_t budget);
+	size_t GetMemoryBudget() const noexcept;
+	size_t MemoryUsage() const noexcept;
+	size_t MemoryAllocated() const noexcept;
 
 	/// The save point is a marker in the undo stack where the container has stated that
 	/// the buffer was saved. Undo and redo can move over the save point.
@@ -110,6 +176,9 @@ struct SplitView {
 	size_t length = 0;
 
 	SplitView(const SplitVector<char> &instance) noexcept;
+	SplitView(const char *text, size_t length_) noexcept;
+	// text copied from [start, end) of a document, addressed with document positions.
+	SplitView(const char *text, size_t start, size_t end) noexcept;
 
 	bool operator==(const SplitView &other) const noexcept {
 		return segment1 == other.segment1 && length1 == other.length1
@@ -130,6 +199,50 @@ struct SplitView {
 	}
 };
 
+template <typename T>
+class ChunkedVector;
+
+/**
+ * Text of a document, held in a gap buffer or, for documents created with
+ * DocumentOption::TextChunked, in chunks so edits far apart don't move a gap across the text.
+ * With DocumentOption::TextCompressed, chunks away from the view are packed with LZ4.
+ */
+class TextStorage {
+	SplitVector<char> gapBuffer;
+	std::unique_ptr<ChunkedVector<char>> chunks;
+	bool compressed;
+	Sci::Position insertedSincePack = 0;
+public:
+	TextStorage(bool chunked, bool compressed_);
+	// Deleted so TextStorage objects can not be copied.
+	TextStorage(const TextStorage &) = delete;
+	TextStorage(TextStorage &&) = delete;
+	void operator=(const TextStorage &) = delete;
+	void operator=(TextStorage &&) = delete;
+	~TextStorage();
+
+	bool IsChunked() const noexcept {
+		return chunks != nullptr;
+	}
+	bool IsCompressed() const noexcept {
+		return compressed;
+	}
+	char ValueAt(Sci::Position position) const noexcept;
+	Sci::Position Length() const noexcept;
+	void ReAllocate(Sci::Position newSize);
+	void InsertFromArray(Sci::Position positionToInsert, const char *s, Sci::Position positionFrom, Sci::Position insertLength);
+	void DeleteRange(Sci::Position position, Sci::Position deleteLength);
+	void GetRange(char *buffer, Sci::Position position, Sci::Position retrieveLength) const noexcept;
+	const char *BufferPointer();
+	const char *RangePointer(Sci::Position position, Sci::Position rangeLength);
+	Sci::Position GapPosition() const noexcept;
+	const char *CharRangePointer(Sci::Position position, Sci::Position *pStart, Sci::Position *pEnd) const noexcept;
+	SplitView AllView();
+	size_t MemoryUsage() const noexcept;
+	void Pack(Sci::Position hotStart, Sci::Position hotEnd);
+	void Pin(Sci::Position position, Sci::Position length) noexcept;
+};
+
 /**
  * Holder for an expandable array of characters that supports undo and line markers.
  * Based on article "Data Structures in a Bit-Mapped Text Editor"
@@ -138,9 +251,15 @@ struct SplitView {
 class CellBuffer {
 private:
 	bool hasStyles;
-	const bool largeDocument;
-	SplitVector<char> substance;
+	bool largeDocument;
+	bool compressStyles;
+	bool compactLines;
+	TextStorage substance;
 	SplitVector<char> style;
+	// run-length style store used instead of style for huge documents, where styles have long runs
+	std::unique_ptr<RunStyles<Sci::Position, char>> styleRuns;
+	std::unique_ptr<char[]> styleExpanded;
+	Sci::Position styleExpandedLength;
 	bool readOnly;
 	bool utf8Substance;
 	Scintilla::LineEndType utf8LineEnds;
@@ -153,14 +272,16 @@ private:
 	bool UTF8LineEndOverlaps(Sci::Position position) const noexcept;
 	bool UTF8IsCharacterBoundary(Sci::Position position) const;
 	void ResetLineEnds();
-	void RecalculateIndexLineStarts(Sci::Line lineFirst, Sci::Line lineLast);
+	CountWidths CountCharacterWidths(Sci::Position position, Sci::Position end) const noexcept;
+	void RecalculateIndexLineStarts(Sci::Line lineFirst, Sci::Line lineLast) noexcept;
+	void IndexLines(Sci::Line line) const noexcept;
 	bool MaintainingLineCharacterIndex() const noexcept;
 	/// Actions without undo
 	void BasicInsertString(Sci::Position position, const char *s, Sci::Position insertLength);
 	void BasicDeleteChars(Sci::Position position, Sci::Position deleteLength);
 
 public:
-	CellBuffer(bool hasStyles_, bool largeDocument_);
+	CellBuffer(bool hasStyles_, bool largeDocument_, bool compressStyles_ = false, bool chunkedText_ = false, bool compactLines_ = false, bool compressedText_ = false);
 	// Deleted so CellBuffer objects can not be copied.
 	CellBuffer(const CellBuffer &) = delete;
 	CellBuffer(CellBuffer &&) = delete;
@@ -175,14 +296,20 @@ public:
 	char StyleAt(Sci::Position position) const noexcept;
 	void GetStyleRange(unsigned char *buffer, Sci::Position position, Sci::Position lengthRetrieve) const noexcept;
 	const char *BufferPointer();
-	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept;
-	const char *StyleRangePointer(Sci::Position position, Sci::Position rangeLength) noexcept;
+	const char *RangePointer(Sci::Position position, Sci::Position rangeLength);
+	const char *StyleRangePointer(Sci::Position position, Sci::Position rangeLength);
 	Sci::Position GapPosition() const noexcept;
-	SplitView AllView() const noexcept;
+	const char *CharRangePointer(Sci::Position position, Sci::Position *pStart, Sci::Position *pEnd) const noexcept;
+	SplitView AllView();
+	/// Compress text outside the range when text is compressed, see DocumentOption::TextCompressed.
+	void PackText(Sci::Position hotStart, Sci::Position hotEnd);
+	/// Keep the range of a pointer given to application unpacked until the text is changed.
+	void PinText(Sci::Position position, Sci::Position length) noexcept;
 
 	Sci::Position Length() const noexcept;
 	void Allocate(Sci::Position newSize);
 	bool EnsureStyleBuffer(bool hasStyles_);
+	void ConvertToLarge(bool compressStyles_, bool compactLines_);
 	void SetUTF8Substance(bool utf8Substance_) noexcept;
 	Scintilla::LineEndType GetLineEndTypes() const noexcept {
 		return utf8LineEnds;
@@ -205,8 +332,10 @@ public:
 
 	/// Setting styles for positions outside the range of the buffer is safe and has no effect.
 	/// @return true if the style of a character is changed.
-	bool SetStyleAt(Sci::Position position, char styleValue) noexcept;
-	bool SetStyleFor(Sci::Position position, Sci::Position lengthStyle, char styleValue) noexcept;
+	bool SetStyleAt(Sci::Position position, char styleValue);
+	bool SetStyleFor(Sci::Position position, Sci::Position lengthStyle, char styleValue);
+	/// @return true if any style is changed, startMod and endMod are the first and last changed position.
+	bool SetStyles(Sci::Position position, const unsigned char *styles, Sci::Position length, Sci::Position &startMod, Sci::Position &endMod);
 
 	const char *DeleteChars(Sci::Position position, Sci::Position deleteLength, bool &startSequence);
 
@@ -214,6 +343,10 @@ public:
 	void SetReadOnly(bool set) noexcept;
 	bool IsLarge() const noexcept;
 	bool HasStyles() const noexcept;
+	bool IsStylesCompressed() const noexcept;
+	bool IsTextChunked() const noexcept;
+	bool IsTextCompressed() const noexcept;
+	bool IsLinesCompact() const noexcept;
 
 	/// The save point is a marker in the undo stack where the container has stated that
 	/// the buffer was saved. Undo and redo can move over the save point.
@@ -231,6 +364,10 @@ public:
 	void EndUndoAction();
 	void AddUndoAction(Sci::Position token, bool mayCoalesce);
 	void DeleteUndoHistory();
+	void SetUndoMemoryBudget(size_t budget);
+	size_t GetUndoMemoryBudget() const noexcept;
+	size_t UndoMemoryUsage() const noexcept;
+	size_t MemoryUsage(Scintilla::MemoryUsage usage) const noexcept;
 
 	/// To perform an undo, StartUndo is called to retrieve the number of steps, then UndoStep is
 	/// called that many times. Similarly for redo.
@@ -0,0 +1,513 @@
+// Scintilla source code edit control
+/** @file ChunkedVector.h
+ ** Data structure for holding large arrays in chunks so insertions
+ ** and deletions far apart don't need to move a gap across the array.
+ ** Chunks can be packed with LZ4 to keep rarely used parts compressed.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+#pragma once
+
+namespace Scintilla::Internal {
+
+/// Elements are held in a list of chunks, chunk starts are held in a Partitioning.
+/// Chunks filled by insertion hold at most chunkSize elements. Consolidate() creates
+/// a bigger chunk for contiguous access, later edits split it by copying the shorter side.
+/// Pack() compresses chunks outside a range and releases their elements, packed chunks are
+/// decoded into a few cache buffers for reading and decoded back into a chunk when changed.
+template <typename T>
+class ChunkedVector {
+	struct Chunk {
+		std::unique_ptr<T[]> data;
+		ptrdiff_t start = 0;	// offset of the first element inside data
+		ptrdiff_t length = 0;
+		ptrdiff_t capacity = 0;
+		std::unique_ptr<char[]> packed;	// compressed elements while data is released
+		size_t packedLength = 0;
+		size_t packId = 0;				// identifies decoded copy of packed elements
+		bool incompressible = false;	// not packed again until changed
+		T *Elements() const noexcept {
+			return data.get() + start;
+		}
+		bool IsPacked() const noexcept {
+			return packed != nullptr;
+		}
+	};
+
+	struct DecodedChunk {
+		size_t packId = 0;
+		std::unique_ptr<T[]> data;
+	};
+
+	static constexpr ptrdiff_t chunkSize = 64*1024;
+	// packed chunk must be at least 1/packMinSaving smaller
+	static constexpr size_t packMinSaving = 8;
+	// pointers returned for packed chunks stay valid until this many other chunks are decoded
+	static constexpr size_t decodedCacheSize = 8;
+
+	std::vector<Chunk> chunks;
+	Partitioning<ptrdiff_t> starts;
+	T empty;	/// Returned as the result of out-of-bounds access.
+	// reading packed chunks changes the cache, so a packed vector must not be read by several threads
+	mutable std::unique_ptr<DecodedChunk[]> decoded;
+	mutable size_t decodedNext = 0;
+	size_t lastPackId = 0;
+	// range of pointer given to application, kept unpacked until next change
+	ptrdiff_t pinStart = 0;
+	ptrdiff_t pinEnd = 0;
+
+	static Chunk MakeChunk(ptrdiff_t capacity) {
+		Chunk chunk;
+		chunk.data.reset(new T[capacity]);
+		chunk.capacity = capacity;
+		return chunk;
+	}
+
+	static T *DecodeTo(const Chunk &chunk, T *buffer) noexcept {
+		[[maybe_unused]] const bool decodedAll = LZ4Block::Decompress(chunk.packed.get(), chunk.packedLength,
+			reinterpret_cast<char *>(buffer), chunk.length * sizeof(T));
+		PLATFORM_ASSERT(decodedAll);
+		return buffer + chunk.length;
+	}
+
+	static T *CopyElements(const Chunk &chunk, T *buffer) noexcept {
+		if (chunk.IsPacked()) {
+			return DecodeTo(chunk, buffer);
+		}
+		return std::copy_n(chunk.Elements(), chunk.length, buffer);
+	}
+
+	/// Decode packed elements back into the chunk before it's changed.
+	static void Unpack(Chunk &chunk) {
+		if (chunk.IsPacked()) {
+			Chunk resident = MakeChunk(std::max(chunk.length, chunkSize));
+			DecodeTo(chunk, resident.data.get());
+			chunk.data = std::move(resident.data);
+			chunk.start = 0;
+			chunk.capacity = resident.capacity;
+			chunk.packed.reset();
+			chunk.packedLength = 0;
+		}
+	}
+
+	/// Retrieve elements of a chunk for reading, packed chunk is decoded into a cache buffer.
+	const T *ChunkElements(const Chunk &chunk) const noexcept {
+		if (!chunk.IsPacked()) {
+			return chunk.Elements();
+		}
+		for (size_t index = 0; index < decodedCacheSize; index++) {
+			if (decoded[index].packId == chunk.packId) {
+				return decoded[index].data.get();
+			}
+		}
+		DecodedChunk &slot = decoded[decodedNext];
+		decodedNext = (decodedNext + 1) % decodedCacheSize;
+		slot.packId = chunk.packId;
+		DecodeTo(chunk, slot.data.get());
+		return slot.data.get();
+	}
+
+	/// Compress elements into packed, returns false when it doesn't save enough.
+	bool PackElements(Chunk &chunk, const T *elements, char *buffer, size_t bufferSize) {
+		const size_t length = chunk.length * sizeof(T);
+		const size_t packedLength = LZ4Block::Compress(reinterpret_cast<const char *>(elements), length, buffer, bufferSize);
+		if (packedLength == 0 || packedLength > length - length/packMinSaving) {
+			chunk.incompressible = true;
+			return false;
+		}
+		chunk.packed = std::make_unique<char[]>(packedLength);
+		memcpy(chunk.packed.get(), buffer, packedLength);
+		chunk.packedLength = packedLength;
+		chunk.packId = ++lastPackId;
+		chunk.data.reset();
+		chunk.start = 0;
+		chunk.capacity = 0;
+		return true;
+	}
+
+	/// Replace a chunk made by Consolidate() with chunks of chunkSize, so each one can be decoded
+	/// into a cache buffer. Pieces outside the hot range are packed directly from the long chunk.
+	ptrdiff_t PackLongChunk(ptrdiff_t index, ptrdiff_t hotStart, ptrdiff_t hotEnd, char *buffer, size_t bufferSize) {
+		const ptrdiff_t position = starts.PositionFromPartition(index);
+		const Chunk &chunk = chunks[index];
+		const T *elements = chunk.Elements();
+		std::vector<Chunk> pieces;
+		std::vector<ptrdiff_t> pieceStarts;
+		for (ptrdiff_t offset = 0; offset < chunk.length; offset += chunkSize) {
+			Chunk piece;
+			piece.length = std::min(chunkSize, chunk.length - offset);
+			const ptrdiff_t pieceStart = position + offset;
+			const bool hot = pieceStart < hotEnd && pieceStart + piece.length > hotStart;
+			if (hot || !PackElements(piece, elements + offset, buffer, bufferSize)) {
+				piece.data.reset(new T[chunkSize]);
+				piece.capacity = chunkSize;
+				std::copy_n(elements + offset, piece.length, piece.data.get());
+			}
+			if (offset != 0) {
+				pieceStarts.push_back(pieceStart);
+			}
+			pieces.push_back(std::move(piece));
+		}
+		chunks[index] = std::move(pieces.front());
+		chunks.insert(chunks.begin() + index + 1, std::make_move_iterator(pieces.begin() + 1), std::make_move_iterator(pieces.end()));
+		starts.InsertPartitions(index + 1, pieceStarts.data(), pieceStarts.size());
+		return index + pieces.size();
+	}
+
+	/// Ensure the chunk has room for wantedLength elements starting at start.
+	static void RoomFor(Chunk &chunk, ptrdiff_t wantedLength) {
+		Unpack(chunk);
+		if (chunk.start + wantedLength <= chunk.capacity) {
+			return;
+		}
+		if (wantedLength <= chunk.capacity) {
+			std::move(chunk.Elements(), chunk.Elements() + chunk.length, chunk.data.get());
+		} else {
+			Chunk grown = MakeChunk(std::max(wantedLength, chunkSize));
+			std::move(chunk.Elements(), chunk.Elements() + chunk.length, grown.data.get());
+			chunk.data = std::move(grown.data);
+			chunk.capacity = grown.capacity;
+		}
+		chunk.start = 0;
+	}
+
+	/// Insert a chunk that will hold elements starting at position.
+	void InsertChunk(ptrdiff_t index, ptrdiff_t position, Chunk &&chunk) {
+		chunks.insert(chunks.begin() + index, std::move(chunk));
+		starts.InsertPartition(index, position);
+	}
+
+	/// Split chunk at offset and return index of the chunk starting there.
+	ptrdiff_t SplitChunk(ptrdiff_t index, ptrdiff_t offset) {
+		if (offset == 0) {
+			return index;
+		}
+		if (offset == chunks[index].length) {
+			return index + 1;
+		}
+		Unpack(chunks[index]);
+		const ptrdiff_t position = starts.PositionFromPartition(index) + offset;
+		const ptrdiff_t tailLength = chunks[index].length - offset;
+		if (offset < tailLength) {
+			// copy head into new chunk before current chunk
+			Chunk head = MakeChunk(std::max(offset, chunkSize));
+			Chunk &chunk = chunks[index];
+			std::copy_n(chunk.Elements(), offset, head.data.get());
+			head.length = offset;
+			chunk.start += offset;
+			chunk.length = tailLength;
+			chunks.insert(chunks.begin() + index, std::move(head));
+			starts.InsertPartition(index + 1, position);
+		} else {
+			Chunk tail = MakeChunk(std::max(tailLength, chunkSize));
+			Chunk &chunk = chunks[index];
+			std::copy_n(chunk.Elements() + offset, tailLength, tail.data.get());
+			tail.length = tailLength;
+			chunk.length = offset;
+			InsertChunk(index + 1, position, std::move(tail));
+		}
+		return index + 1;
+	}
+
+	/// Merge chunk into previous chunk when they fit in one chunk.
+	void MergeChunk(ptrdiff_t index) {
+		if (index <= 0 || index >= static_cast<ptrdiff_t>(chunks.size())) {
+			return;
+		}
+		Chunk &prev = chunks[index - 1];
+		const Chunk &chunk = chunks[index];
+		const ptrdiff_t length = prev.length + chunk.length;
+		if (length <= chunkSize) {
+			RoomFor(prev, length);
+			CopyElements(chunk, prev.Elements() + prev.length);
+			prev.length = length;
+			prev.incompressible = false;
+			chunks.erase(chunks.begin() + index);
+			starts.RemovePartition(index);
+		}
+	}
+
+	/// Replace chunks from first to last with a single chunk, leaving room for an element beyond them.
+	void Consolidate(ptrdiff_t first, ptrdiff_t last) {
+		const ptrdiff_t position = starts.PositionFromPartition(first);
+		const ptrdiff_t length = starts.PositionFromPartition(last + 1) - position;
+		Chunk &chunk = chunks[first];
+		if (first == last) {
+			RoomFor(chunk, length + 1);
+			return;
+		}
+		Chunk merged = MakeChunk(length + 1);
+		T *data = merged.data.get();
+		for (ptrdiff_t index = first; index <= last; index++) {
+			data = CopyElements(chunks[index], data);
+		}
+		merged.length = length;
+		chunk = std::move(merged);
+		chunks.erase(chunks.begin() + first + 1, chunks.begin() + last + 1);
+		if (first == 0 && last + 1 == Chunks()) {
+			starts.DeleteAll();
+			starts.InsertText(0, length);
+		} else {
+			for (ptrdiff_t index = first; index < last; index++) {
+				starts.RemovePartition(first + 1);
+			}
+		}
+	}
+
+	ptrdiff_t Chunks() const noexcept {
+		return starts.Partitions();
+	}
+
+public:
+	ChunkedVector() : starts(8), empty() {
+		chunks.emplace_back();
+	}
+
+	// Deleted so ChunkedVector objects can not be copied.
+	ChunkedVector(const ChunkedVector &) = delete;
+	ChunkedVector(ChunkedVector &&) = delete;
+	void operator=(const ChunkedVector &) = delete;
+	void operator=(ChunkedVector &&) = delete;
+
+	~ChunkedVector() = default;
+
+	/// Reserve room for index of chunks to hold newSize elements.
+	void ReAllocate(ptrdiff_t newSize) {
+		if (newSize < 0)
+			throw std::runtime_error("ChunkedVector::ReAllocate: negative size.");
+		const size_t count = newSize/chunkSize + 1;
+		if (count > chunks.size()) {
+			chunks.reserve(count);
+			starts.ReAllocate(count);
+		}
+	}
+
+	/// Retrieve the length of the buffer.
+	ptrdiff_t Length() const noexcept {
+		return starts.Length();
+	}
+
+	/// Bytes allocated for chunks and their starts.
+	size_t MemoryUsage() const noexcept {
+		size_t bytes = chunks.capacity() * sizeof(Chunk) + starts.MemoryUsage();
+		for (const Chunk &chunk : chunks) {
+			bytes += chunk.capacity * sizeof(T) + chunk.packedLength;
+		}
+		if (decoded) {
+			bytes += decodedCacheSize * (sizeof(DecodedChunk) + chunkSize * sizeof(T));
+		}
+		return bytes;
+	}
+
+	/// Retrieve the element at a particular position.
+	/// Retrieving positions outside the range of the buffer returns empty or 0.
+	const T& ValueAt(ptrdiff_t position) const noexcept {
+		if (position < 0 || position >= Length()) {
+			return empty;
+		}
+		const ptrdiff_t index = starts.PartitionFromPosition(position);
+		return ChunkElements(chunks[index])[position - starts.PositionFromPartition(index)];
+	}
+
+	/// Clip the range to the chunk containing position and return a pointer to its start.
+	const T *ChunkRange(ptrdiff_t position, ptrdiff_t *pStart, ptrdiff_t *pEnd) const noexcept {
+		const ptrdiff_t index = starts.PartitionFromPosition(position);
+		const ptrdiff_t chunkStart = starts.PositionFromPartition(index);
+		*pStart = std::max(*pStart, chunkStart);
+		*pEnd = std::min(*pEnd, starts.PositionFromPartition(index + 1));
+		return ChunkElements(chunks[index]) + (*pStart - chunkStart);
+	}
+
+	/// Insert text into the buffer from an array.
+	void InsertFromArray(ptrdiff_t positionToInsert, const T s[], ptrdiff_t positionFrom, ptrdiff_t insertLength) {
+		PLATFORM_ASSERT((positionToInsert >= 0) && (positionToInsert <= Length()));
+		if (insertLength <= 0 || positionToInsert < 0 || positionToInsert > Length()) {
+			return;
+		}
+		Unpin();
+		s += positionFrom;
+		ptrdiff_t index = starts.PartitionFromPosition(positionToInsert);
+		ptrdiff_t offset = positionToInsert - starts.PositionFromPartition(index);
+		if (offset == 0 && index > 0 && chunks[index - 1].length + insertLength <= chunkSize) {
+			// append to end of previous chunk
+			--index;
+			offset = chunks[index].length;
+		}
+		Chunk *chunk = &chunks[index];
+		if (chunk->length + insertLength > chunkSize) {
+			index = SplitChunk(index, offset);
+			if (index > 0 && chunks[index - 1].length + insertLength <= chunkSize) {
+				--index;
+				chunk = &chunks[index];
+				offset = chunk->length;
+			} else {
+				// fill new chunks with the text
+				ptrdiff_t position = positionToInsert;
+				while (insertLength > 0) {
+					const ptrdiff_t length = std::min(insertLength, chunkSize);
+					Chunk part = MakeChunk(chunkSize);
+					std::copy_n(s, length, part.data.get());
+					part.length = length;
+					InsertChunk(index, position, std::move(part));
+					starts.InsertText(index, length);
+					++index;
+					s += length;
+					position += length;
+					insertLength -= length;
+				}
+				return;
+			}
+		}
+		RoomFor(*chunk, chunk->length + insertLength);
+		T *data = chunk->Elements();
+		std::move_backward(data + offset, data + chunk->length, data + chunk->length + insertLength);
+		std::copy_n(s, insertLength, data + offset);
+		chunk->length += insertLength;
+		chunk->incompressible = false;
+		starts.InsertText(index, insertLength);
+	}
+
+	/// Delete a range from the buffer.
+	/// Deleting positions outside the current range fails.
+	void DeleteRange(ptrdiff_t position, ptrdiff_t deleteLength) {
+		PLATFORM_ASSERT((position >= 0) && (position + deleteLength <= Length()));
+		if (deleteLength <= 0 || position < 0 || (position + deleteLength) > Length()) {
+			return;
+		}
+		Unpin();
+		if (position == 0 && deleteLength == Length()) {
+			DeleteAll();
+			return;
+		}
+		ptrdiff_t index = 0;
+		while (deleteLength > 0) {
+			index = starts.PartitionFromPosition(position);
+			const ptrdiff_t offset = position - starts.PositionFromPartition(index);
+			Chunk &chunk = chunks[index];
+			const ptrdiff_t count = std::min(deleteLength, chunk.length - offset);
+			const ptrdiff_t tailLength = chunk.length - offset - count;
+			starts.InsertText(index, -count);
+			deleteLength -= count;
+			if (count == chunk.length) {
+				chunks.erase(chunks.begin() + index);
+				starts.RemovePartition(index + 1);
+				continue;
+			}
+			// move the shorter side
+			Unpack(chunk);
+			T *data = chunk.Elements();
+			if (offset < tailLength) {
+				std::move_backward(data, data + offset, data + offset + count);
+				chunk.start += count;
+			} else {
+				std::move(data + offset + count, data + chunk.length, data + offset);
+			}
+			chunk.length -= count;
+		}
+		MergeChunk(index + 1);
+		MergeChunk(index);
+	}
+
+	/// Delete all the buffer contents.
+	void DeleteAll() {
+		Unpin();
+		chunks.clear();
+		chunks.emplace_back();
+		starts.DeleteAll();
+	}
+
+	/// Retrieve a range of elements into an array
+	void GetRange(T *buffer, ptrdiff_t position, ptrdiff_t retrieveLength) const noexcept {
+		ptrdiff_t index = starts.PartitionFromPosition(position);
+		ptrdiff_t offset = position - starts.PositionFromPartition(index);
+		while (retrieveLength > 0) {
+			const Chunk &chunk = chunks[index];
+			const ptrdiff_t length = std::min(retrieveLength, chunk.length - offset);
+			if (chunk.IsPacked() && length == chunk.length) {
+				buffer = DecodeTo(chunk, buffer);
+			} else {
+				buffer = std::copy_n(ChunkElements(chunk) + offset, length, buffer);
+			}
+			retrieveLength -= length;
+			offset = 0;
+			++index;
+		}
+	}
+
+	/// Consolidate the buffer and return a pointer to the first element.
+	/// Also ensures there is an empty element beyond logical end in case its
+	/// passed to a function expecting a NUL terminated string.
+	const T *BufferPointer() {
+		Consolidate(0, Chunks() - 1);
+		Chunk &chunk = chunks.front();
+		T emptyOne = {};
+		chunk.Elements()[chunk.length] = std::move(emptyOne);
+		return chunk.Elements();
+	}
+
+	/// Return a pointer to a range of elements, first consolidating chunks
+	/// over the range if needed to make that range contiguous.
+	const T *RangePointer(ptrdiff_t position, ptrdiff_t rangeLength) {
+		if (position < 0 || rangeLength < 0 || position + rangeLength > Length()) {
+			return nullptr;
+		}
+		const ptrdiff_t first = starts.PartitionFromPosition(position);
+		const ptrdiff_t last = (rangeLength == 0) ? first : starts.PartitionFromPosition(position + rangeLength - 1);
+		if (first != last) {
+			Consolidate(first, last);
+		} else {
+			Unpack(chunks[first]);
+		}
+		return chunks[first].Elements() + (position - starts.PositionFromPartition(first));
+	}
+
+	/// Return the position of the first chunk boundary, before it text is contiguous.
+	ptrdiff_t GapPosition() const noexcept {
+		return starts.PositionFromPartition(1);
+	}
+
+	/// Keep the range unpacked until next change, so pointers into it stay valid.
+	void Pin(ptrdiff_t position, ptrdiff_t length) noexcept {
+		pinStart = position;
+		pinEnd = position + length;
+	}
+
+	void Unpin() noexcept {
+		pinStart = 0;
+		pinEnd = 0;
+	}
+
+	/// Pack chunks outside the range from hotStart to hotEnd and the pinned range.
+	void Pack(ptrdiff_t hotStart, ptrdiff_t hotEnd) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (!decoded) {
+			decoded = std::make_unique<DecodedChunk[]>(decodedCacheSize);
+			for (size_t index = 0; index < decodedCacheSize; index++) {
+				decoded[index].data.reset(new T[chunkSize]);
+			}
+		}
+		const size_t bufferSize = LZ4Block::CompressBound(chunkSize * sizeof(T));
+		std::unique_ptr<char[]> buffer;
+		ptrdiff_t index = 0;
+		while (index < Chunks()) {
+			Chunk &chunk = chunks[index];
+			const ptrdiff_t position = starts.PositionFromPartition(index);
+			const ptrdiff_t end = position + chunk.length;
+			if (chunk.IsPacked() || chunk.incompressible || chunk.length == 0 || (position < pinEnd && end > pinStart)
+				|| (chunk.length <= chunkSize && position < hotEnd && end > hotStart)) {
+				++index;
+				continue;
+			}
+			if (!buffer) {
+				buffer = std::make_unique<char[]>(bufferSize);
+			}
+			if (chunk.length > chunkSize) {
+				index = PackLongChunk(index, hotStart, hotEnd, buffer.get(), bufferSize);
+			} else {
+				PackElements(chunk, chunk.Elements(), buffer.get(), bufferSize);
+				++index;
+			}
+		}
+	}
+};
+
+}
@@ -94,6 +94,7 @@ public:
 
 	bool GetExpanded(Sci::Line lineDoc) const noexcept override;
 	bool SetExpanded(Sci::Line lineDoc, bool isExpanded) override;
+	void ExpandAll() override;
 	Sci::Line ContractedNext(Sci::Line lineDocStart) const noexcept override;
 
 	int GetHeight(Sci::Line lineDoc) const noexcept override;
@@ -337,14 +338,27 @@ bool ContractionState<LINE>::SetVisible(Sci::Line lineDocStart, Sci::Line lineDo
 		Sci::Line delta = 0;
 		Check();
 		if ((lineDocStart <= lineDocEnd) && (lineDocStart >= 0) && (lineDocEnd < LinesInDoc())) {
-			for (Sci::Line line = lineDocStart; line <= lineDocEnd; line++) {
-				if (GetVisible(line) != isVisible) {
-					const int heightLine = heights->ValueAt(static_cast<LINE>(line));
-					const int difference = isVisible ? heightLine : -heightLine;
-					visible->SetValueAt(static_cast<LINE>(line), isVisible ? 1 : 0);
-					displayLines->InsertText(static_cast<LINE>(line), difference);
-					delta += difference;
+			// Work on runs of lines with same visibility and same height instead of line by line,
+			// so folding or unfolding huge ranges does not split and merge runs for every line.
+			const char value = isVisible ? 1 : 0;
+			const LINE lineEnd = static_cast<LINE>(lineDocEnd + 1);
+			LINE line = static_cast<LINE>(lineDocStart);
+			while (line < lineEnd) {
+				const LINE runEnd = std::min(visible->EndRun(line), lineEnd);
+				if (visible->ValueAt(line) != value) {
+					const LINE runStart = line;
+					while (line < runEnd) {
+						const LINE heightEnd = std::min(heights->EndRun(line), runEnd);
+						const int heightLine = heights->ValueAt(line);
+						const int difference = isVisible ? heightLine : -heightLine;
+						delta += static_cast<Sci::Line>(difference) * (heightEnd - line);
+						for (; line < heightEnd; line++) {
+							displayLines->InsertText(line, difference);
+						}
+					}
+					visible->FillRange(runStart, value, runEnd - runStart);
 				}
+				line = runEnd;
 			}
 		} else {
 			return false;
@@ -413,6 +427,14 @@ bool ContractionState<LINE>::SetExpanded(Sci::Line lineDoc, bool isExpanded) {
 	}
 }
 
+template <typename LINE>
+void ContractionState<LINE>::ExpandAll() {
+	if (!OneToOne()) {
+		expanded->FillRange(0, 1, expanded->Length());
+		Check();
+	}
+}
+
 template <typename LINE>
 Sci::Line ContractionState<LINE>::ContractedNext(Sci::Line lineDocStart) const noexcept {
 	if (OneToOne()) {
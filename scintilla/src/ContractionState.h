@@ -42,6 +42,7 @@ public:
 
 	virtual bool GetExpanded(Sci::Line lineDoc) const noexcept = 0;
 	virtual bool SetExpanded(Sci::Line lineDoc, bool isExpanded) = 0;
+	virtual void ExpandAll() = 0;
 	virtual Sci::Line ContractedNext(Sci::Line lineDocStart) const noexcept = 0;
 
 	virtual int GetHeight(Sci::Line lineDoc) const noexcept = 0;
@@ -105,6 +105,7 @@ public:
 
 	// Returns changed=true if some values may have changed
 	FillResult<Sci::Position> FillRange(Sci::Position position, int value, Sci::Position fillLength) override;
+	FillResult<Sci::Position> FillRanges(const Sci::Position *ranges, size_t count, int value) override;
 
 	void InsertSpace(Sci::Position position, Sci::Position insertLength) override;
 	void DeleteRange(Sci::Position position, Sci::Position deleteLength) override;
@@ -122,6 +123,14 @@ public:
 	void SetClickNotified(bool notified) noexcept override {
 		clickNotified = notified;
 	}
+
+	size_t MemoryUsage() const noexcept override {
+		size_t bytes = decorationList.capacity() * sizeof(decorationList[0]) + decorationView.capacity() * sizeof(decorationView[0]);
+		for (const auto &deco : decorationList) {
+			bytes += sizeof(Decoration<POS>) + deco->rs.MemoryUsage();
+		}
+		return bytes;
+	}
 };
 
 template <typename POS>
@@ -201,6 +210,22 @@ FillResult<Sci::Position> DecorationList<POS>::FillRange(Sci::Position position,
 	return fr;
 }
 
+template <typename POS>
+FillResult<Sci::Position> DecorationList<POS>::FillRanges(const Sci::Position *ranges, size_t count, int value) {
+	if (!current) {
+		current = DecorationFromIndicator(currentIndicator);
+		if (!current) {
+			current = Create(currentIndicator, lengthDocument);
+		}
+	}
+	const FillResult<POS> frInPOS = current->rs.FillRanges(ranges, count, value);
+	const FillResult<Sci::Position> fr{ frInPOS.changed, frInPOS.position, frInPOS.fillLength };
+	if (current->Empty()) {
+		Delete(currentIndicator);
+	}
+	return fr;
+}
+
 template <typename POS>
 void DecorationList<POS>::InsertSpace(Sci::Position position, Sci::Position insertLength) {
 	const bool atEnd = position == lengthDocument;
@@ -35,6 +35,8 @@ public:
 
 	// Returns with changed=true if some values may have changed
 	virtual FillResult<Sci::Position> FillRange(Sci::Position position, int value, Sci::Position fillLength) = 0;
+	// ranges are sorted (position, length) pairs
+	virtual FillResult<Sci::Position> FillRanges(const Sci::Position *ranges, size_t count, int value) = 0;
 	virtual void InsertSpace(Sci::Position position, Sci::Position insertLength) = 0;
 	virtual void DeleteRange(Sci::Position position, Sci::Position deleteLength) = 0;
 	virtual void DeleteLexerDecorations() = 0;
@@ -46,6 +48,8 @@ public:
 
 	virtual bool ClickNotified() const noexcept = 0;
 	virtual void SetClickNotified(bool notified) noexcept = 0;
+
+	virtual size_t MemoryUsage() const noexcept = 0;
 };
 
 std::unique_ptr<IDecoration> DecorationCreate(bool largeDocument, int indicator);
@@ -22,10 +22,7 @@
 #include <algorithm>
 #include <memory>
 #include <chrono>
-
-#ifndef NO_CXX11_REGEX
-#include <regex>
-#endif
+#include <atomic>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -34,6 +31,8 @@
 #include "ILexer.h"
 
 #include "Debugging.h"
+#include "VectorISA.h"
+#include "TraceEvents.h"
 
 #include "CharacterSet.h"
 //#include "CharacterCategory.h"
@@ -48,6 +47,7 @@
 #include "CaseFolder.h"
 #include "Document.h"
 #include "RESearch.h"
+#include "LinearRegex.h"
 #include "UniConversion.h"
 #include "ElapsedPeriod.h"
 
@@ -81,13 +81,51 @@ void LexInterface::Colourise(Sci::Position start, Sci::Position end) {
 
 		if (len > 0) {
 			instance->Lex(start, len, styleStart, pdoc);
-			instance->Fold(start, len, styleStart, pdoc);
+			if (FoldOnDemand()) {
+				// folded by FoldTo() when lines are displayed or navigated
+				foldedEnd = std::min(foldedEnd, start);
+			} else {
+				Sci::Position foldStart = start;
+				if (foldedEnd < start) {
+					// lines skipped while folding on demand
+					foldStart = pdoc->LineStart(pdoc->SciLineFromPosition(foldedEnd));
+					styleStart = (foldStart > 0) ? pdoc->StyleAt(foldStart - 1) : 0;
+				}
+				instance->Fold(foldStart, end - foldStart, styleStart, pdoc);
+				foldedEnd = PTRDIFF_MAX;
+			}
 		}
 
 		performingStyle = false;
 	}
 }
 
+void LexInterface::Lex(Sci::Position start, Sci::Position end) {
+	if (pdoc && instance && !performingStyle && start < end) {
+		performingStyle = true;
+		const int styleStart = (start > 0) ? pdoc->StyleAt(start - 1) : 0;
+		instance->Lex(start, end - start, styleStart, pdoc);
+		performingStyle = false;
+	}
+}
+
+// Folding resumes at the line of foldedEnd from the level of previous line, which is
+// the depth checkpoint kept from last folding, so only lines not yet folded are scanned.
+void LexInterface::FoldTo(Sci::Position end) {
+	if (pdoc && instance && !performingStyle && foldedEnd < end) {
+		performingStyle = true;
+		const Sci::Position start = pdoc->LineStart(pdoc->SciLineFromPosition(foldedEnd));
+		const int styleStart = (start > 0) ? pdoc->StyleAt(start - 1) : 0;
+		instance->Fold(start, end - start, styleStart, pdoc);
+		foldedEnd = end;
+		performingStyle = false;
+	}
+}
+
+bool LexInterface::FoldOnDemand() const noexcept {
+	return false;
+}
+
 bool LexInterface::UseContainerLexing() const noexcept {
 	return !instance;
 }
@@ -126,8 +164,44 @@ Sci::Position ActionDuration::ActionsInAllowedTime(double secondsAllowed) const
 	return actions * unitBytes;
 }
 
+namespace Scintilla::Internal {
+
+/**
+ * Immutable copy of document text. The text follows the object in the same allocation,
+ * so the text pointer given to clients also identifies the snapshot.
+ * References are atomic, the last reader to release it frees it on its own thread.
+ */
+class TextSnapshot {
+	std::atomic<int> references;
+	explicit TextSnapshot() noexcept : references{1} {}
+public:
+	static TextSnapshot *Create(Sci::Position length) {
+		void *memory = ::operator new(sizeof(TextSnapshot) + length + 1);
+		TextSnapshot *snapshot = new (memory) TextSnapshot();
+		snapshot->Text()[length] = '\0';
+		return snapshot;
+	}
+	static TextSnapshot *FromText(const char *text) noexcept {
+		return reinterpret_cast<TextSnapshot *>(const_cast<char *>(text)) - 1;
+	}
+	char *Text() noexcept {
+		return reinterpret_cast<char *>(this + 1);
+	}
+	void AddRef() noexcept {
+		references.fetch_add(1, std::memory_order_relaxed);
+	}
+	void Release() noexcept {
+		if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			this->~TextSnapshot();
+			::operator delete(this);
+		}
+	}
+};
+
+}
+
 Document::Document(DocumentOption options) :
-	cb(!FlagSet(options, DocumentOption::StylesNone), FlagSet(options, DocumentOption::TextLarge)) {
+	cb(!FlagSet(options, DocumentOption::StylesNone), FlagSet(options, DocumentOption::TextLarge), FlagSet(options, DocumentOption::StylesCompressed), FlagSet(options, DocumentOption::TextChunked), FlagSet(options, DocumentOption::LinesCompact), FlagSet(options, DocumentOption::TextCompressed)) {
 	refCount = 0;
 #ifdef _WIN32
 	eolMode = EndOfLine::CrLf;
@@ -138,6 +212,8 @@ Document::Document(DocumentOption options) :
 	dbcsCharClass = nullptr;
 	lineEndBitSet = LineEndType::Default;
 	endStyled = 0;
+	styledValidEnd = 0;
+	editedEnd = 0;
 	styleClock = 0;
 	enteredModification = 0;
 	enteredStyling = 0;
@@ -169,6 +245,9 @@ Document::~Document() {
 	for (const auto &watcher : watchers) {
 		watcher.watcher->NotifyDeleted(this, watcher.userData);
 	}
+	if (textSnapshot) {
+		textSnapshot->Release();
+	}
 }
 
 // Increase reference count and return its previous value.
@@ -220,6 +299,15 @@ void Document::RemoveLine(Sci::Line line) {
 	}
 }
 
+size_t Document::MemoryUsage() const noexcept {
+	size_t bytes = 0;
+	for (const auto &pl : perLineData) {
+		if (pl)
+			bytes += pl->MemoryUsage();
+	}
+	return bytes;
+}
+
 LineMarkers *Document::Markers() const noexcept {
 	return down_cast<LineMarkers *>(perLineData[ldMarkers].get());
 }
@@ -255,6 +343,7 @@ bool Document::SetDBCSCodePage(int dbcsCodePage_) {
 	if (dbcsCodePage != dbcsCodePage_) {
 		dbcsCodePage = dbcsCodePage_;
 		pcf.reset();
+		foldedSearchKey.clear();
 		cb.SetLineEndTypes(lineEndBitSet & LineEndTypesSupported());
 		cb.SetUTF8Substance(CpUtf8 == dbcsCodePage);
 		dbcsCharClass = DBCSCharClassify::Get(dbcsCodePage_);
@@ -313,7 +402,11 @@ void Document::TentativeUndo(bool pendingUpdate) {
 				}
 				cb.PerformUndoStep();
 				if (action.at != ActionType::container) {
-					ModifiedAt(action.position);
+					if (action.at == ActionType::remove) {
+						ModifiedAt(action.position, action.lenData, 0);
+					} else {
+						ModifiedAt(action.position, 0, action.lenData);
+					}
 				}
 
 				ModificationFlags modFlags = ModificationFlags::Undo;
@@ -334,7 +427,7 @@ void Document::TentativeUndo(bool pendingUpdate) {
 						modFlags |= ModificationFlags::MultilineUndoRedo;
 				}
 				NotifyModified(DocModification(modFlags, action.position, action.lenData,
-					linesAdded, action.data.get()));
+					linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -356,6 +449,10 @@ Sci::Line Document::MarkerNext(Sci::Line lineStart, MarkerMask mask) const noexc
 	return Markers()->MarkerNext(lineStart, mask);
 }
 
+Sci::Line Document::MarkerPrevious(Sci::Line lineStart, MarkerMask mask) const noexcept {
+	return Markers()->MarkerPrevious(lineStart, mask);
+}
+
 int Document::AddMark(Sci::Line line, int markerNum) {
 	if (line >= 0 && line <= LinesTotal()) {
 		const int prev = Markers()->AddMark(line, markerNum, LinesTotal());
@@ -394,12 +491,7 @@ void Document::DeleteMarkFromHandle(int markerHandle) {
 }
 
 void Document::DeleteAllMarks(int markerNum) {
-	bool someChanges = false;
-	for (Sci::Line line = 0; line < LinesTotal(); line++) {
-		if (Markers()->DeleteMark(line, markerNum, true))
-			someChanges = true;
-	}
-	if (someChanges) {
+	if (Markers()->DeleteAllMarks(markerNum)) {
 		DocModification mh(ModificationFlags::ChangeMarker);
 		mh.line = -1;
 		NotifyModified(mh);
@@ -549,6 +641,7 @@ Sci::Line Document::GetLastChild(Sci::Line lineParent, std::optional<FoldLevel>
 	Sci::Line lineMaxSubord = lineParent;
 	while (lineMaxSubord < maxLine - 1) {
 		EnsureStyledTo(LineStart(lineMaxSubord + 2));
+		EnsureFoldedTo(LineStart(lineMaxSubord + 2));
 		if (!IsSubordinate(levelStart, GetFoldLevel(lineMaxSubord + 1)))
 			break;
 		if ((lookLastLine != -1) && (lineMaxSubord >= lookLastLine) && !LevelIsWhitespace(GetFoldLevel(lineMaxSubord)))
@@ -1144,8 +1237,64 @@ EncodingFamily Document::CodePageFamily() const noexcept {
 }
 
 void Document::ModifiedAt(Sci::Position pos) noexcept {
+	TruncateBraceIndexes(pos);
+	tagIndex.Truncate(pos);
+	if (pli) {
+		pli->InvalidateFolding(pos);
+	}
+	if (endStyled > pos)
+		endStyled = pos;
+	styledValidEnd = 0;
+	if (speculativeEnd > pos) {
+		speculativeEnd = 0;
+	}
+	ResumeStyleWindow();
+}
+
+// Text modification: keep track of the styled range after the modification, lexing can stop
+// there once the lexer state converges back to the state recorded before the modification.
+void Document::ModifiedAt(Sci::Position pos, Sci::Position lengthInserted, Sci::Position lengthDeleted) noexcept {
+	for (BraceIndex &index : braceIndexes) {
+		index.Edit(pos, lengthInserted, lengthDeleted);
+	}
+	tagIndex.Truncate(pos);
+	if (pli) {
+		pli->InvalidateFolding(pos);
+	}
+	if (styleDegradedStart > pos) {
+		styleDegradedStart = std::max(pos, styleDegradedStart - lengthDeleted) + lengthInserted;
+	}
+	if (speculativeEnd > pos) {
+		// lexed again on next paint
+		speculativeEnd = 0;
+	}
+	if (styledValidEnd <= endStyled) {
+		if (endStyled <= pos) {
+			styledValidEnd = 0;
+			return;
+		}
+		styledValidEnd = endStyled;
+		editedEnd = pos;
+	}
+	if (styledValidEnd > pos) {
+		styledValidEnd = std::max(pos, styledValidEnd - lengthDeleted) + lengthInserted;
+	}
+	if (editedEnd > pos) {
+		editedEnd = std::max(pos, editedEnd - lengthDeleted) + lengthInserted;
+	}
+	editedEnd = std::max(editedEnd, pos + lengthInserted);
 	if (endStyled > pos)
 		endStyled = pos;
+	if (styledValidEnd <= editedEnd) {
+		styledValidEnd = 0;
+	}
+	if (styleViewEnd > pos) {
+		if (styleViewStart > pos) {
+			styleViewStart = std::max(pos, styleViewStart - lengthDeleted) + lengthInserted;
+		}
+		styleViewEnd = std::max(pos, styleViewEnd - lengthDeleted) + lengthInserted;
+	}
+	ResumeStyleWindow();
 }
 
 void Document::CheckReadOnly() noexcept {
@@ -1184,7 +1333,7 @@ bool Document::DeleteChars(Sci::Position pos, Sci::Position len) {
 			if (startSavePoint && cb.IsCollectingUndo())
 				NotifySavePoint(false);
 			if ((pos < Length()) || (pos == 0))
-				ModifiedAt(pos);
+				ModifiedAt(pos, 0, len);
 			else
 				ModifiedAt(pos - 1);
 			NotifyModified(
@@ -1263,7 +1412,7 @@ Sci::Position Document::InsertString(Sci::Position position, const char *s, Sci:
 #endif
 	if (startSavePoint && cb.IsCollectingUndo())
 		NotifySavePoint(false);
-	ModifiedAt(position);
+	ModifiedAt(position, insertLength, 0);
 	NotifyModified(
 		DocModification(
 			ModificationFlags::InsertText | ModificationFlags::User |
@@ -1277,6 +1426,97 @@ Sci::Position Document::InsertString(Sci::Position position, const char *s, Sci:
 	return insertLength;
 }
 
+/**
+ * Replace sorted and non-overlapping ranges, positions are before any replacement.
+ * Each range is changed inside cell buffer to keep per line data for unchanged lines,
+ * watchers are notified once with deletion and insertion of the whole changed span.
+ */
+Sci::Position Document::ReplaceRanges(const TextReplacement *ranges, Sci::Position count) {
+	if (count <= 0) {
+		return 0;
+	}
+	Sci::Position spanEnd = 0;
+	for (Sci::Position index = 0; index < count; index++) {
+		const TextReplacement &range = ranges[index];
+		if (range.position < spanEnd || range.deleteLength < 0 || range.insertLength < 0
+			|| (range.insertLength != 0 && range.text == nullptr)) {
+			return 0;
+		}
+		spanEnd = range.position + range.deleteLength;
+	}
+	if (spanEnd > Length()) {
+		return 0;
+	}
+	CheckReadOnly();	// Application may change read only state here
+	if (cb.IsReadOnly()) {
+		return 0;
+	}
+	if (enteredModification != 0) {
+		return 0;
+	}
+	enteredModification++;
+	const Sci::Position spanStart = ranges[0].position;
+	const Sci::Position deleteLength = spanEnd - spanStart;
+	const Sci::Line lineStart = SciLineFromPosition(spanStart);
+	const Sci::Line deleteLines = SciLineFromPosition(spanEnd) - lineStart;
+	NotifyModified(
+		DocModification(
+			ModificationFlags::BeforeDelete | ModificationFlags::User,
+			spanStart, deleteLength,
+			0, nullptr));
+	const bool startSavePoint = cb.IsSavePoint();
+	bool startSequence = false;
+	bool linesChanged = false;
+	Sci::Position delta = 0;
+	{
+		UndoGroup ug(this);
+		for (Sci::Position index = 0; index < count; index++) {
+			const TextReplacement &range = ranges[index];
+			const Sci::Position position = range.position + delta;
+			const Sci::Line prevLinesTotal = LinesTotal();
+			bool startAction = false;
+			// indicators are moved for each range to keep those between ranges
+			if (range.deleteLength != 0) {
+				cb.DeleteChars(position, range.deleteLength, startAction);
+				decorations->DeleteRange(position, range.deleteLength);
+				startSequence = startSequence || startAction;
+			}
+			if (range.insertLength != 0) {
+				cb.InsertString(position, range.text, range.insertLength, startAction);
+				decorations->InsertSpace(position, range.insertLength);
+				startSequence = startSequence || startAction;
+			}
+			linesChanged = linesChanged || (LinesTotal() != prevLinesTotal);
+			delta += range.insertLength - range.deleteLength;
+		}
+	}
+	if (startSavePoint && cb.IsCollectingUndo())
+		NotifySavePoint(false);
+	const Sci::Position insertLength = deleteLength + delta;
+	ModifiedAt(spanStart, insertLength, deleteLength);
+	// no text for the span as it's not contiguous in undo history, lines inside the span
+	// are kept when no line end is inserted or deleted.
+	if (deleteLength != 0) {
+		NotifyModified(
+			DocModification(
+				ModificationFlags::DeleteText | ModificationFlags::User |
+				(startSequence ? ModificationFlags::StartAction : ModificationFlags::None),
+				spanStart, deleteLength,
+				linesChanged ? -deleteLines : 0, nullptr), false);
+		startSequence = false;
+	}
+	if (insertLength != 0) {
+		NotifyModified(
+			DocModification(
+				ModificationFlags::InsertText | ModificationFlags::User |
+				(startSequence ? ModificationFlags::StartAction : ModificationFlags::None),
+				spanStart, insertLength,
+				linesChanged ? (SciLineFromPosition(spanStart + insertLength) - lineStart) : 0, nullptr), false);
+	}
+	enteredModification--;
+	return delta;
+}
+
 void Document::ChangeInsertion(const char *s, Sci::Position length) {
 	insertionSet = true;
 	insertion.assign(s, length);
@@ -1334,7 +1574,11 @@ Sci::Position Document::Undo() {
 				}
 				cb.PerformUndoStep();
 				if (action.at != ActionType::container) {
-					ModifiedAt(action.position);
+					if (action.at == ActionType::remove) {
+						ModifiedAt(action.position, action.lenData, 0);
+					} else {
+						ModifiedAt(action.position, 0, action.lenData);
+					}
 					newPos = action.position;
 				}
 
@@ -1371,7 +1615,7 @@ Sci::Position Document::Undo() {
 						modFlags |= ModificationFlags::MultilineUndoRedo;
 				}
 				NotifyModified(DocModification(modFlags, action.position, action.lenData,
-					linesAdded, action.data.get()));
+					linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -1408,7 +1652,11 @@ Sci::Position Document::Redo() {
 				}
 				cb.PerformRedoStep();
 				if (action.at != ActionType::container) {
-					ModifiedAt(action.position);
+					if (action.at == ActionType::insert) {
+						ModifiedAt(action.position, action.lenData, 0);
+					} else {
+						ModifiedAt(action.position, 0, action.lenData);
+					}
 					newPos = action.position;
 				}
 
@@ -1431,7 +1679,7 @@ Sci::Position Document::Redo() {
 				}
 				NotifyModified(
 					DocModification(modFlags, action.position, action.lenData,
-						linesAdded, action.data.get()));
+						linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -1513,6 +1761,10 @@ Sci::Position Document::SetLineIndentation(Sci::Line line, Sci::Position indent)
 	}
 }
 
+std::string Document::IndentationText(Sci::Position indent) const {
+	return CreateIndentation(indent, tabInChars, !useTabs);
+}
+
 Sci::Position Document::GetLineIndentPosition(Sci::Line line) const noexcept {
 	if (line < 0)
 		return 0;
@@ -1553,6 +1805,21 @@ Sci::Position Document::CountCharacters(Sci::Position startPos, Sci::Position en
 	endPos = MovePositionOutsideChar(endPos, -1, false);
 	Sci::Position count = 0;
 	Sci::Position i = startPos;
+	if (CpUtf8 == dbcsCodePage && FlagSet(cb.LineCharacterIndex(), LineCharacterIndexType::Utf32)) {
+		const Sci::Line lineStart = SciLineFromPosition(startPos);
+		const Sci::Line lineEnd = SciLineFromPosition(endPos);
+		if (lineEnd > lineStart + 1) {
+			// only count characters for partial lines, whole lines are taken from the line character index
+			const Sci::Position lineStartNext = LineStart(lineStart + 1);
+			while (i < lineStartNext) {
+				count++;
+				i = NextPosition(i, 1);
+			}
+			count += cb.IndexLineStart(lineEnd, LineCharacterIndexType::Utf32)
+				- cb.IndexLineStart(lineStart + 1, LineCharacterIndexType::Utf32);
+			i = LineStart(lineEnd);
+		}
+	}
 	while (i < endPos) {
 		count++;
 		i = NextPosition(i, 1);
@@ -1664,47 +1931,191 @@ std::string Document::TransformLineEnds(const char *s, size_t len, EndOfLine eol
 	return dest;
 }
 
+namespace {
+
+// find first CR or LF in [text, end), returns end when not found.
+const char *FindLineEnd(const char *text, const char *end) noexcept {
+#if NP2_USE_AVX2
+	const __m256i vectCR = _mm256_set1_epi8('\r');
+	const __m256i vectLF = _mm256_set1_epi8('\n');
+	for (; text + sizeof(__m256i) <= end; text += sizeof(__m256i)) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text));
+		const uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectCR), _mm256_cmpeq_epi8(chunk, vectLF)));
+		if (mask) {
+			return text + np2::ctz(mask);
+		}
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	const __m128i vectCR = _mm_set1_epi8('\r');
+	const __m128i vectLF = _mm_set1_epi8('\n');
+	for (; text + sizeof(__m128i) <= end; text += sizeof(__m128i)) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+		const uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, vectCR), _mm_cmpeq_epi8(chunk, vectLF)));
+		if (mask) {
+			return text + np2::ctz(mask);
+		}
+	}
+	// end NP2_USE_SSE2
+#endif
+	for (; text < end; text++) {
+		if (*text == '\r' || *text == '\n') {
+			break;
+		}
+	}
+	return text;
+}
+
+}
+
+// Rewrite text between first and last line end that differs from eolModeSet with one deletion
+// and one insertion, instead of an edit for each line, line count is unchanged so markers are kept.
 void Document::ConvertLineEnds(EndOfLine eolModeSet) {
-	UndoGroup ug(this);
+	const char *eolWanted = (eolModeSet == EndOfLine::CrLf) ? "\r\n" : ((eolModeSet == EndOfLine::Cr) ? "\r" : "\n");
+	const size_t eolWantedLength = (eolModeSet == EndOfLine::CrLf) ? 2 : 1;
+	const Sci::Position length = Length();
+	Sci::Position changeStart = -1;
+	Sci::Position changeEnd = 0;
+	size_t destLength = 0;
+	std::string dest;
 
-	for (Sci::Position pos = 0; pos < Length(); pos++) {
-		if (cb.CharAt(pos) == '\r') {
-			if (cb.CharAt(pos + 1) == '\n') {
-				// CRLF
-				if (eolModeSet == EndOfLine::Cr) {
-					DeleteChars(pos + 1, 1); // Delete the LF
-				} else if (eolModeSet == EndOfLine::Lf) {
-					DeleteChars(pos, 1); // Delete the CR
-				} else {
-					pos++;
+	Sci::Position pos = 0;
+	while (pos < length) {
+		Sci::Position segmentStart = pos;
+		Sci::Position segmentEnd = length;
+		const char * const segment = cb.CharRangePointer(pos, &segmentStart, &segmentEnd);
+		const char * const end = segment + (segmentEnd - pos);
+		const char *text = segment;
+		while (true) {
+			const char * const eol = FindLineEnd(text, end);
+			if (changeStart >= 0) {
+				dest.append(text, eol - text);
+			}
+			pos += eol - text;
+			if (eol == end) {
+				break;
+			}
+
+			EndOfLine eolMode = EndOfLine::Lf;
+			Sci::Position eolLength = 1;
+			if (*eol == '\r') {
+				eolMode = EndOfLine::Cr;
+				if (cb.CharAt(pos + 1) == '\n') {
+					eolMode = EndOfLine::CrLf;
+					eolLength = 2;
 				}
-			} else {
-				// CR
-				if (eolModeSet == EndOfLine::CrLf) {
-					pos += InsertString(pos + 1, "\n", 1); // Insert LF
-				} else if (eolModeSet == EndOfLine::Lf) {
-					pos += InsertString(pos, "\n", 1); // Insert LF
-					DeleteChars(pos, 1); // Delete CR
-					pos--;
-				}
-			}
-		} else if (cb.CharAt(pos) == '\n') {
-			// LF
-			if (eolModeSet == EndOfLine::CrLf) {
-				pos += InsertString(pos, "\r", 1); // Insert CR
-			} else if (eolModeSet == EndOfLine::Cr) {
-				pos += InsertString(pos, "\r", 1); // Insert CR
-				DeleteChars(pos, 1); // Delete LF
-				pos--;
 			}
+			if (eolMode != eolModeSet && changeStart < 0) {
+				changeStart = pos;
+				dest.reserve(length - pos + (length - pos)/16);
+			}
+			if (changeStart >= 0) {
+				dest.append(eolWanted, eolWantedLength);
+				if (eolMode != eolModeSet) {
+					changeEnd = pos + eolLength;
+					destLength = dest.length();
+				}
+			}
+			pos += eolLength;
+			if (pos >= segmentEnd) {
+				// CR LF pair crosses segment boundary
+				break;
+			}
+			text = eol + eolLength;
 		}
 	}
 
+	if (changeStart < 0 || cb.IsReadOnly()) {
+		return;
+	}
+
+	// save markers, deleted lines are merged into other line
+	const Sci::Line lineStart = SciLineFromPosition(changeStart);
+	const Sci::Line lineEnd = SciLineFromPosition(changeEnd);
+	std::vector<std::pair<Sci::Line, MarkerMask>> marks;
+	const LineMarkers *markers = Markers();
+	for (Sci::Line line = markers->MarkerNext(lineStart, ~static_cast<MarkerMask>(0)); line >= 0 && line <= lineEnd;
+		line = markers->MarkerNext(line + 1, ~static_cast<MarkerMask>(0))) {
+		marks.emplace_back(line, markers->MarkValue(line));
+	}
+
+	UndoGroup ug(this);
+	DeleteChars(changeStart, changeEnd - changeStart);
+	InsertString(changeStart, dest.data(), destLength);
+
+	if (!marks.empty()) {
+		for (Sci::Line line = markers->MarkerNext(lineStart, ~static_cast<MarkerMask>(0)); line >= 0 && line <= lineEnd;
+			line = markers->MarkerNext(line + 1, ~static_cast<MarkerMask>(0))) {
+			Markers()->DeleteMark(line, -1, false);
+		}
+		for (const auto &[line, mask] : marks) {
+			MarkerMask m = mask;
+			for (int i = 0; m; i++, m >>= 1) {
+				if (m & 1) {
+					Markers()->AddMark(line, i, LinesTotal());
+				}
+			}
+		}
+		DocModification mh(ModificationFlags::ChangeMarker);
+		mh.line = -1;
+		NotifyModified(mh);
+	}
 }
 
 DocumentOption Document::Options() const noexcept {
 	return (IsLarge() ? DocumentOption::TextLarge : DocumentOption::Default) |
-		(cb.HasStyles() ? DocumentOption::Default : DocumentOption::StylesNone);
+		(cb.HasStyles() ? DocumentOption::Default : DocumentOption::StylesNone) |
+		(cb.IsStylesCompressed() ? DocumentOption::StylesCompressed : DocumentOption::Default) |
+		(cb.IsTextChunked() ? DocumentOption::TextChunked : DocumentOption::Default) |
+		(cb.IsTextCompressed() ? DocumentOption::TextCompressed : DocumentOption::Default) |
+		(cb.IsLinesCompact() ? DocumentOption::LinesCompact : DocumentOption::Default);
+}
+
+DocumentOption Document::WorkerOptions() const noexcept {
+	return static_cast<DocumentOption>(static_cast<int>(Options()) & ~static_cast<int>(DocumentOption::TextCompressed));
+}
+
+void Document::ConvertToLarge(DocumentOption options) {
+	if (IsLarge()) {
+		return;
+	}
+
+	cb.ConvertToLarge(FlagSet(options, DocumentOption::StylesCompressed), FlagSet(options, DocumentOption::LinesCompact));
+	cb.SetPerLine(this);
+
+	// indicator runs are copied into 64-bit run lists
+	std::unique_ptr<IDecorationList> decorationsLarge = DecorationListCreate(true);
+	decorationsLarge->InsertSpace(0, cb.Length());
+	for (const IDecoration *deco : decorations->View()) {
+		decorationsLarge->SetCurrentIndicator(deco->Indicator());
+		const Sci::Position length = deco->Length();
+		Sci::Position position = 0;
+		while (position < length) {
+			const Sci::Position end = deco->EndRun(position);
+			const int value = deco->ValueAt(position);
+			if (value != 0) {
+				decorationsLarge->FillRange(position, value, end - position);
+			}
+			position = end;
+		}
+	}
+	decorationsLarge->SetCurrentIndicator(decorations->GetCurrentIndicator());
+	decorationsLarge->SetCurrentValue(decorations->GetCurrentValue());
+	decorationsLarge->SetClickNotified(decorations->ClickNotified());
+	decorations = std::move(decorationsLarge);
+}
+
+size_t Document::MemoryUsage(Scintilla::MemoryUsage usage) const noexcept {
+	switch (usage) {
+	case Scintilla::MemoryUsage::Markers:
+		return perLineData[ldMarkers]->MemoryUsage();
+	case Scintilla::MemoryUsage::LineData:
+		return MemoryUsage() - perLineData[ldMarkers]->MemoryUsage();
+	case Scintilla::MemoryUsage::Indicators:
+		return decorations->MemoryUsage();
+	default:
+		return cb.MemoryUsage(usage);
+	}
 }
 
 bool Document::IsWhiteLine(Sci::Line line) const noexcept {
@@ -1902,6 +2313,116 @@ constexpr bool IsWordEdge(CharacterClass cc, CharacterClass ccNext) noexcept {
 		&& (cc == CharacterClass::word || cc == CharacterClass::punctuation || cc == CharacterClass::cjkWord);
 }
 
+// skip to first position in [pos, end) that may start a case insensitive match for text starts with ASCII ch:
+// either ch in different case, or leading byte of non-ASCII character which may folded to ch.
+Sci::Position SkipToFoldCandidate(const char *text, Sci::Position pos, Sci::Position end, unsigned char ch, unsigned char leadMask) noexcept {
+	const char lower = ch;
+	const char upper = MakeUpperCase(ch);
+#if NP2_USE_AVX2
+	const __m256i vectLower = _mm256_set1_epi8(lower);
+	const __m256i vectUpper = _mm256_set1_epi8(upper);
+	const __m256i vectLead = _mm256_set1_epi8(leadMask);
+	for (; pos + static_cast<Sci::Position>(sizeof(__m256i)) <= end; pos += sizeof(__m256i)) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + pos));
+		const __m256i lead = _mm256_cmpeq_epi8(_mm256_and_si256(chunk, vectLead), vectLead);
+		const uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(lead,
+			_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectLower), _mm256_cmpeq_epi8(chunk, vectUpper))));
+		if (mask) {
+			return pos + np2::ctz(mask);
+		}
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	const __m128i vectLower = _mm_set1_epi8(lower);
+	const __m128i vectUpper = _mm_set1_epi8(upper);
+	const __m128i vectLead = _mm_set1_epi8(leadMask);
+	for (; pos + static_cast<Sci::Position>(sizeof(__m128i)) <= end; pos += sizeof(__m128i)) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+		const __m128i lead = _mm_cmpeq_epi8(_mm_and_si128(chunk, vectLead), vectLead);
+		const uint32_t mask = _mm_movemask_epi8(_mm_or_si128(lead,
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, vectLower), _mm_cmpeq_epi8(chunk, vectUpper))));
+		if (mask) {
+			return pos + np2::ctz(mask);
+		}
+	}
+	// end NP2_USE_SSE2
+#endif
+	for (; pos < end; pos++) {
+		const char chPos = text[pos];
+		if (chPos == lower || chPos == upper || (static_cast<unsigned char>(chPos) & leadMask) == leadMask) {
+			break;
+		}
+	}
+	return pos;
+}
+
+Sci::Position SkipToFoldCandidate(const SplitView &cbView, Sci::Position pos, Sci::Position end, unsigned char ch, unsigned char leadMask) noexcept {
+	const Sci::Position length1 = cbView.length1;
+	if (pos < length1) {
+		const Sci::Position end1 = std::min(end, length1);
+		pos = SkipToFoldCandidate(cbView.segment1, pos, end1, ch, leadMask);
+		if (pos < end1) {
+			return pos;
+		}
+	}
+	if (pos < end) {
+		pos = SkipToFoldCandidate(cbView.segment2, pos, end, ch, leadMask);
+	}
+	return pos;
+}
+
+// packed text is searched in windows of about this size, instead of unpacking all chunks with AllView().
+constexpr Sci::Position searchWindowSize = 1024*1024;
+// bytes before and after searched range read for context, e.g. character before a character before start.
+constexpr Sci::Position searchWindowMargin = 2*UTF8MaxBytes;
+
+// find first match for search in contiguous text, candidate match starts in [text, text + count),
+// text + count + lengthFind - 1 must be readable. filter candidates by comparing first and last byte.
+const char *FindTextInSegment(const char *text, size_t count, const char *search, size_t lengthFind) noexcept {
+	const char * const end = text + count;
+#if NP2_USE_AVX2
+	const __m256i firstByte = _mm256_set1_epi8(search[0]);
+	const __m256i lastByte = _mm256_set1_epi8(search[lengthFind - 1]);
+	for (; text + sizeof(__m256i) <= end; text += sizeof(__m256i)) {
+		NP2_PREFETCH(text + NP2_PREFETCH_DISTANCE);
+		const __m256i chunk1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text));
+		const __m256i chunk2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + lengthFind - 1));
+		uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(chunk1, firstByte), _mm256_cmpeq_epi8(chunk2, lastByte)));
+		while (mask) {
+			const uint32_t trailing = np2::ctz(mask);
+			if (memcmp(text + trailing + 1, search + 1, lengthFind - 1) == 0) {
+				return text + trailing;
+			}
+			mask &= mask - 1;
+		}
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	const __m128i firstByte = _mm_set1_epi8(search[0]);
+	const __m128i lastByte = _mm_set1_epi8(search[lengthFind - 1]);
+	for (; text + sizeof(__m128i) <= end; text += sizeof(__m128i)) {
+		NP2_PREFETCH(text + NP2_PREFETCH_DISTANCE);
+		const __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+		const __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + lengthFind - 1));
+		uint32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(chunk1, firstByte), _mm_cmpeq_epi8(chunk2, lastByte)));
+		while (mask) {
+			const uint32_t trailing = np2::ctz(mask);
+			if (memcmp(text + trailing + 1, search + 1, lengthFind - 1) == 0) {
+				return text + trailing;
+			}
+			mask &= mask - 1;
+		}
+	}
+	// end NP2_USE_SSE2
+#endif
+	for (; text < end; text++) {
+		if (*text == search[0] && memcmp(text + 1, search + 1, lengthFind - 1) == 0) {
+			return text;
+		}
+	}
+	return nullptr;
+}
+
 }
 
 /**
@@ -1956,6 +2477,19 @@ bool Document::HasCaseFolder() const noexcept {
 
 void Document::SetCaseFolder(std::unique_ptr<CaseFolder> pcf_) noexcept {
 	pcf = std::move(pcf_);
+	foldedSearchKey.clear();
+}
+
+size_t Document::FoldSearchText(const char *search, Sci::Position lengthFind) {
+	// Mark All and Replace All search same text repeatedly.
+	const std::string_view text(search, lengthFind);
+	if (foldedSearchKey != text) {
+		constexpr size_t maxFoldingExpansion = 4;
+		foldedSearch.resize((lengthFind + 1) * UTF8MaxBytes * maxFoldingExpansion + 1);
+		lenFoldedSearch = pcf->Fold(foldedSearch.data(), foldedSearch.size(), search, lengthFind);
+		foldedSearchKey = text;
+	}
+	return lenFoldedSearch;
 }
 
 Document::CharacterExtracted Document::ExtractCharacter(Sci::Position position) const noexcept {
@@ -1978,6 +2512,29 @@ Document::CharacterExtracted Document::ExtractCharacter(Sci::Position position)
 	}
 }
 
+// View of text for searching from start to end, with searchWindowMargin bytes around them readable.
+// Packed text is copied with GetCharRange() into a window addressed with document positions, which
+// extends further in search direction, so searching again after a match (e.g. Mark All) reuses it.
+SplitView Document::SearchView(Sci::Position start, Sci::Position end, bool forward) {
+	if (!cb.IsTextCompressed()) {
+		return cb.AllView();
+	}
+	const Sci::Position length = Length();
+	start = std::max<Sci::Position>(start - searchWindowMargin, 0);
+	end = std::min(end + searchWindowMargin, length);
+	if (start < searchWindowStart || end > searchWindowStart + static_cast<Sci::Position>(searchWindow.length())) {
+		if (forward) {
+			end = std::min(end + searchWindowSize, length);
+		} else {
+			start = std::max<Sci::Position>(start - searchWindowSize, 0);
+		}
+		searchWindow.resize(end - start);
+		cb.GetCharRange(searchWindow.data(), start, end - start);
+		searchWindowStart = start;
+	}
+	return SplitView(searchWindow.data(), searchWindowStart, searchWindowStart + searchWindow.length());
+}
+
 /**
  * Find text in document, supporting both forward and backward
  * searches (just pass minPos > maxPos to do a backward search)
@@ -1994,245 +2551,335 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 			regex = std::unique_ptr<RegexSearchBase>(CreateRegexSearch(&charClass));
 		}
 		return regex->FindText(this, minPos, maxPos, search, caseSensitive, flags, length);
-	} else {
-		const bool word = FlagSet(flags, FindOption::WholeWord);
-		const bool wordStart = FlagSet(flags, FindOption::WordStart);
+	}
+
+	const bool word = FlagSet(flags, FindOption::WholeWord);
+	const bool wordStart = FlagSet(flags, FindOption::WordStart);
+	if (!cb.IsTextCompressed()) {
+		return FindTextInView(cb.AllView(), minPos, maxPos, search, caseSensitive, word, wordStart, length);
+	}
+
+	// packed text is searched in windows, which overlap by the longest text a match can span.
+	const Sci::Position lengthFind = *length;
+	Sci::Position overlap = lengthFind;
+	if (!caseSensitive) {
+		// each character of matched text is folded into at least one byte of folded search text
+		overlap = FoldSearchText(search, lengthFind) * UTF8MaxBytes;
+	}
+	const Sci::Position windowSize = std::max(searchWindowSize, 2*overlap);
+	Sci::Position pos = minPos;
+	while (true) {
+		*length = lengthFind;
+		if (minPos <= maxPos) {
+			// matches starting before windowEnd are complete in the window
+			const Sci::Position windowEnd = std::min(maxPos, pos + windowSize);
+			const Sci::Position end = std::min(maxPos, windowEnd + overlap);
+			const Sci::Position found = FindTextInView(SearchView(pos, end, true), pos, end, search, caseSensitive, word, wordStart, length);
+			if (end == maxPos || (found >= 0 && found < windowEnd)) {
+				return found;
+			}
+			pos = windowEnd;
+		} else {
+			const Sci::Position windowStart = std::max(maxPos, pos - windowSize);
+			const Sci::Position found = FindTextInView(SearchView(windowStart, pos, false), pos, windowStart, search, caseSensitive, word, wordStart, length);
+			if (found >= 0 || windowStart == maxPos) {
+				return found;
+			}
+			// matches starting before windowStart end before pos
+			pos = windowStart + overlap;
+		}
+	}
+}
 
-		const Sci::Position direction = maxPos - minPos;
-		//const bool forward = direction >= 0;
-		const int increment = (direction >= 0) ? 1 : -1;
-		// table for the condition: forward ? (pos < endSearch) : (pos >= endSearch)
+Sci::Position Document::FindTextInView(const SplitView &cbView, Sci::Position minPos, Sci::Position maxPos, const char *search,
+	bool caseSensitive, bool word, bool wordStart, Sci::Position *length) {
+	const Sci::Position direction = maxPos - minPos;
+	//const bool forward = direction >= 0;
+	const int increment = (direction >= 0) ? 1 : -1;
+	// table for the condition: forward ? (pos < endSearch) : (pos >= endSearch)
         //                   direction >= 0  direction < 0
         // pos >= endSearch: break           continue
         // pos < endSearch:  continue        break
-		// i.e. continue search when direction and (pos - endSearch) have opposite signs,
-		// which can be wrote as: (direction ^ (pos - endSearch)) < 0
-
-		// Range endpoints should not be inside DBCS characters, but just in case, move them.
-		const Sci::Position startPos = MovePositionOutsideChar(minPos, increment, false);
-		const Sci::Position endPos = MovePositionOutsideChar(maxPos, increment, false);
-
-		// Compute actual search ranges needed
-		const Sci::Position lengthFind = *length;
-
-		// character less than safeChar is encoded in single byte in the encoding.
-		constexpr int safeCharASCII = 0x80;		// UTF-8 forward & backward search, DBCS forward search
-		constexpr int safeCharSBCS = 256;		// all
-
-		//Platform::DebugPrintf("Find %d %d %s %d\n", startPos, endPos, search, lengthFind);
-		const Sci::Position limitPos = std::max(startPos, endPos);
-		Sci::Position pos = startPos;
-		if (direction < 0 && !caseSensitive) {
-			// Back all of a character
-			pos = NextPosition(pos, -1);
-		}
-		const SplitView cbView = cb.AllView();
-		if (caseSensitive) {
-			const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
-			const unsigned char * const searchData = reinterpret_cast<const unsigned char *>(search);
-			const unsigned char charStartSearch = searchData[0];
-			const int safeChar = (0 == dbcsCodePage) ? safeCharSBCS : ((direction >= 0 || CpUtf8 == dbcsCodePage) ? safeCharASCII : dbcsCharClass->MinTrailByte());
-			// Boyer-Moore-Horspool-Sunday Algorithm / Quick Search Algorithm
-			// http://www-igm.univ-mlv.fr/~lecroq/string/index.html
-			// http://www-igm.univ-mlv.fr/~lecroq/string/node19.html
-			// https://www.inf.hs-flensburg.de/lang/algorithmen/pattern/sundayen.htm
-			Sci::Position shiftTable[256];
-			if (lengthFind != 1) {
-				Sci::Position shift = lengthFind;
-				std::fill_n(shiftTable, std::size(shiftTable), (shift + 1) * increment);
-				if (direction >= 0) {
-					const unsigned char *ptr = searchData;
-					while (*ptr != 0) {
-						shiftTable[*ptr++] = shift--;
-					}
+	// i.e. continue search when direction and (pos - endSearch) have opposite signs,
+	// which can be wrote as: (direction ^ (pos - endSearch)) < 0
+
+	// Range endpoints should not be inside DBCS characters, but just in case, move them.
+	const Sci::Position startPos = MovePositionOutsideChar(minPos, increment, false);
+	const Sci::Position endPos = MovePositionOutsideChar(maxPos, increment, false);
+
+	// Compute actual search ranges needed
+	const Sci::Position lengthFind = *length;
+
+	// character less than safeChar is encoded in single byte in the encoding.
+	constexpr int safeCharASCII = 0x80;		// UTF-8 forward & backward search, DBCS forward search
+	constexpr int safeCharSBCS = 256;		// all
+
+	//Platform::DebugPrintf("Find %d %d %s %d\n", startPos, endPos, search, lengthFind);
+	const Sci::Position limitPos = std::max(startPos, endPos);
+	Sci::Position pos = startPos;
+	if (direction < 0 && !caseSensitive) {
+		// Back all of a character
+		pos = NextPosition(pos, -1);
+	}
+	if (caseSensitive && direction >= 0 && (dbcsCodePage == 0 || (CpUtf8 == dbcsCodePage && !UTF8IsTrailByte(static_cast<unsigned char>(search[0]))))) {
+		// forward search in single byte encoding or UTF-8, every match starts at character boundary.
+		// search directly on the two contiguous segments of the buffer.
+		const Sci::Position endSearch = endPos - lengthFind + 1;
+		const Sci::Position length1 = cbView.length1;
+		while (pos < endSearch) {
+			Sci::Position found = -1;
+			if (pos + lengthFind <= length1) {
+				// match inside first segment
+				const Sci::Position count = std::min(endSearch, length1 - lengthFind + 1) - pos;
+				const char *ptr = FindTextInSegment(cbView.segment1 + pos, count, search, lengthFind);
+				if (ptr != nullptr) {
+					found = ptr - cbView.segment1;
 				} else {
-					const unsigned char *ptr = searchData + shift - 1;
-					shift = -shift;
-					while (ptr >= searchData) {
-						shiftTable[*ptr--] = shift++;
-					}
+					pos += count;
+				}
+			} else if (pos < length1) {
+				// match across the gap
+				bool matched = true;
+				for (Sci::Position indexSearch = 0; (indexSearch < lengthFind) && matched; indexSearch++) {
+					matched = cbView.CharAt(pos + indexSearch) == search[indexSearch];
+				}
+				if (matched) {
+					found = pos;
+				} else {
+					++pos;
+				}
+			} else {
+				// match inside second segment
+				const char *ptr = FindTextInSegment(cbView.segment2 + pos, endSearch - pos, search, lengthFind);
+				if (ptr == nullptr) {
+					break;
 				}
+				found = ptr - cbView.segment2;
 			}
-
-			const Sci::Position skip = (direction >= 0) ? lengthFind : -1;
-			if (direction < 0) {
-				pos = MovePositionOutsideChar(pos - lengthFind, -1, false);
+			if (found >= 0) {
+				if (MatchesWordOptions(word, wordStart, found, lengthFind)) {
+					return found;
+				}
+				pos = found + 1;
 			}
-			//while (forward ? (pos < endSearch) : (pos >= endSearch)) {
-			while ((direction ^ (pos - endSearch)) < 0) {
-				const unsigned char leadByte = cbView.CharAt(pos);
-				if (charStartSearch == leadByte) {
-					bool found = (pos + lengthFind) <= limitPos;
-					for (Sci::Position indexSearch = 1; (indexSearch < lengthFind) && found; indexSearch++) {
-						const unsigned char ch = cbView.CharAt(pos + indexSearch);
-						found = ch == searchData[indexSearch];
-					}
-					if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
-						return pos;
-					}
+		}
+	} else if (caseSensitive) {
+		const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
+		const unsigned char * const searchData = reinterpret_cast<const unsigned char *>(search);
+		const unsigned char charStartSearch = searchData[0];
+		const int safeChar = (0 == dbcsCodePage) ? safeCharSBCS : ((direction >= 0 || CpUtf8 == dbcsCodePage) ? safeCharASCII : dbcsCharClass->MinTrailByte());
+		// Boyer-Moore-Horspool-Sunday Algorithm / Quick Search Algorithm
+		// http://www-igm.univ-mlv.fr/~lecroq/string/index.html
+		// http://www-igm.univ-mlv.fr/~lecroq/string/node19.html
+		// https://www.inf.hs-flensburg.de/lang/algorithmen/pattern/sundayen.htm
+		Sci::Position shiftTable[256];
+		if (lengthFind != 1) {
+			Sci::Position shift = lengthFind;
+			std::fill_n(shiftTable, std::size(shiftTable), (shift + 1) * increment);
+			if (direction >= 0) {
+				const unsigned char *ptr = searchData;
+				while (*ptr != 0) {
+					shiftTable[*ptr++] = shift--;
 				}
-
-				if (lengthFind == 1) {
-					if (leadByte < safeChar) {
-						pos += increment;
-					} else {
-						if (!NextCharacter(pos, increment)) {
-							break;
-						}
-					}
-				} else {
-					const unsigned char nextByte = cbView.CharAt(pos + skip);
-					pos += shiftTable[nextByte];
-					if (nextByte >= safeChar) {
-						pos = MovePositionOutsideChar(pos, increment, false);
-					}
+			} else {
+				const unsigned char *ptr = searchData + shift - 1;
+				shift = -shift;
+				while (ptr >= searchData) {
+					shiftTable[*ptr--] = shift++;
 				}
 			}
-		} else if (CpUtf8 == dbcsCodePage) {
-			constexpr size_t maxFoldingExpansion = 4;
-			std::vector<char> searchThing((lengthFind + 1) * UTF8MaxBytes * maxFoldingExpansion + 1);
-			const size_t lenSearch = pcf->Fold(searchThing.data(), searchThing.size(), search, lengthFind);
-			const unsigned char * const searchData = reinterpret_cast<const unsigned char *>(searchThing.data());
-			//while (forward ? (pos < endPos) : (pos >= endPos)) {
-			while ((direction ^ (pos - endPos)) < 0) {
-				int widthFirstCharacter = 0;
-				Sci::Position posIndexDocument = pos;
-				size_t indexSearch = 0;
-				bool characterMatches = true;
-				for (;;) {
-					const unsigned char leadByte = cbView.CharAt(posIndexDocument);
-					char bytes[UTF8MaxBytes + 1];
-					int widthChar = 1;
-					if (!UTF8IsAscii(leadByte)) {
-						const int widthCharBytes = UTF8BytesOfLead(leadByte);
-						bytes[0] = static_cast<char>(leadByte);
-						for (int b = 1; b < widthCharBytes; b++) {
-							bytes[b] = cbView.CharAt(posIndexDocument + b);
-						}
-						widthChar = UTF8ClassifyMulti(reinterpret_cast<const unsigned char *>(bytes), widthCharBytes) & UTF8MaskWidth;
-					}
-					if (!widthFirstCharacter) {
-						widthFirstCharacter = widthChar;
-					}
-					if ((posIndexDocument + widthChar) > limitPos) {
-						break;
-					}
-					size_t lenFlat = 1;
-					if (widthChar == 1) {
-						characterMatches = searchData[indexSearch] == MakeLowerCase(leadByte);
-					} else {
-						char folded[UTF8MaxBytes * maxFoldingExpansion + 1];
-						lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
-						// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
-						assert((indexSearch + lenFlat) <= searchThing.size());
-						// Does folded match the buffer
-						characterMatches = 0 == memcmp(folded, searchData + indexSearch, lenFlat);
-					}
-					if (!characterMatches) {
-						break;
-					}
-					posIndexDocument += widthChar;
-					indexSearch += lenFlat;
-					if (indexSearch >= lenSearch) {
-						break;
-					}
+		}
+
+		const Sci::Position skip = (direction >= 0) ? lengthFind : -1;
+		if (direction < 0) {
+			pos = MovePositionOutsideChar(pos - lengthFind, -1, false);
+		}
+		//while (forward ? (pos < endSearch) : (pos >= endSearch)) {
+		while ((direction ^ (pos - endSearch)) < 0) {
+			const unsigned char leadByte = cbView.CharAt(pos);
+			if (charStartSearch == leadByte) {
+				bool found = (pos + lengthFind) <= limitPos;
+				for (Sci::Position indexSearch = 1; (indexSearch < lengthFind) && found; indexSearch++) {
+					const unsigned char ch = cbView.CharAt(pos + indexSearch);
+					found = ch == searchData[indexSearch];
 				}
-				if (characterMatches && (indexSearch == lenSearch)) {
-					if (MatchesWordOptions(word, wordStart, pos, posIndexDocument - pos)) {
-						*length = posIndexDocument - pos;
-						return pos;
-					}
+				if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+					return pos;
 				}
-				if (direction >= 0) {
-					pos += widthFirstCharacter;
+			}
+
+			if (lengthFind == 1) {
+				if (leadByte < safeChar) {
+					pos += increment;
 				} else {
 					if (!NextCharacter(pos, increment)) {
 						break;
 					}
 				}
+			} else {
+				const unsigned char nextByte = cbView.CharAt(pos + skip);
+				pos += shiftTable[nextByte];
+				if (nextByte >= safeChar) {
+					pos = MovePositionOutsideChar(pos, increment, false);
+				}
+			}
+		}
+	} else if (CpUtf8 == dbcsCodePage) {
+		constexpr size_t maxFoldingExpansion = 4;
+		const size_t lenSearch = FoldSearchText(search, lengthFind);
+		const unsigned char * const searchData = reinterpret_cast<const unsigned char *>(foldedSearch.data());
+		// forward search for text starts with ASCII: skip positions can not start a match.
+		const bool skipToCandidate = direction >= 0 && UTF8IsAscii(searchData[0]);
+		//while (forward ? (pos < endPos) : (pos >= endPos)) {
+		while ((direction ^ (pos - endPos)) < 0) {
+			if (skipToCandidate) {
+				pos = SkipToFoldCandidate(cbView, pos, endPos, searchData[0], 0xC0);
+				if (pos >= endPos) {
+					break;
+				}
 			}
-		} else if (dbcsCodePage) {
-			constexpr size_t maxBytesCharacter = 2;
-			constexpr size_t maxFoldingExpansion = 4;
-			std::vector<char> searchThing((lengthFind + 1) * maxBytesCharacter * maxFoldingExpansion + 1);
-			const size_t lenSearch = pcf->Fold(searchThing.data(), searchThing.size(), search, lengthFind);
-			const unsigned char * const searchData = reinterpret_cast<const unsigned char *>(searchThing.data());
-			//while (forward ? (pos < endPos) : (pos >= endPos)) {
-			while ((direction ^ (pos - endPos)) < 0) {
-				int widthFirstCharacter = 0;
-				Sci::Position indexDocument = 0;
-				size_t indexSearch = 0;
-				bool characterMatches = true;
-				for (;;) {
-					const unsigned char leadByte = cbView.CharAt(pos + indexDocument);
-					const int widthChar = 1 + IsDBCSLeadByteNoExcept(leadByte);
-					if (!widthFirstCharacter) {
-						widthFirstCharacter = widthChar;
-					}
-					if ((pos + indexDocument + widthChar) > limitPos) {
-						break;
-					}
-					size_t lenFlat = 1;
-					if (widthChar == 1) {
-						characterMatches = searchData[indexSearch] == MakeLowerCase(leadByte);
-					} else {
-						char bytes[maxBytesCharacter + 1];
-						bytes[0] = static_cast<char>(leadByte);
-						bytes[1] = cbView.CharAt(pos + indexDocument + 1);
-						char folded[maxBytesCharacter * maxFoldingExpansion + 1];
-						lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
-						// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
-						assert((indexSearch + lenFlat) <= searchThing.size());
-						// Does folded match the buffer
-						characterMatches = 0 == memcmp(folded, searchData + indexSearch, lenFlat);
-					}
-					if (!characterMatches) {
-						break;
-					}
-					indexDocument += widthChar;
-					indexSearch += lenFlat;
-					if (indexSearch >= lenSearch) {
-						break;
+			int widthFirstCharacter = 0;
+			Sci::Position posIndexDocument = pos;
+			size_t indexSearch = 0;
+			bool characterMatches = true;
+			for (;;) {
+				const unsigned char leadByte = cbView.CharAt(posIndexDocument);
+				char bytes[UTF8MaxBytes + 1];
+				int widthChar = 1;
+				if (!UTF8IsAscii(leadByte)) {
+					const int widthCharBytes = UTF8BytesOfLead(leadByte);
+					bytes[0] = static_cast<char>(leadByte);
+					for (int b = 1; b < widthCharBytes; b++) {
+						bytes[b] = cbView.CharAt(posIndexDocument + b);
 					}
+					widthChar = UTF8ClassifyMulti(reinterpret_cast<const unsigned char *>(bytes), widthCharBytes) & UTF8MaskWidth;
 				}
-				if (characterMatches && (indexSearch == lenSearch)) {
-					if (MatchesWordOptions(word, wordStart, pos, indexDocument)) {
-						*length = indexDocument;
-						return pos;
-					}
+				if (!widthFirstCharacter) {
+					widthFirstCharacter = widthChar;
+				}
+				if ((posIndexDocument + widthChar) > limitPos) {
+					break;
 				}
-				if (direction >= 0) {
-					pos += widthFirstCharacter;
+				size_t lenFlat = 1;
+				if (widthChar == 1) {
+					characterMatches = searchData[indexSearch] == MakeLowerCase(leadByte);
 				} else {
-					if (!NextCharacter(pos, increment)) {
-						break;
-					}
+					char folded[UTF8MaxBytes * maxFoldingExpansion + 1];
+					lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
+					// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of foldedSearch
+					assert((indexSearch + lenFlat) <= foldedSearch.size());
+					// Does folded match the buffer
+					characterMatches = 0 == memcmp(folded, searchData + indexSearch, lenFlat);
+				}
+				if (!characterMatches) {
+					break;
+				}
+				posIndexDocument += widthChar;
+				indexSearch += lenFlat;
+				if (indexSearch >= lenSearch) {
+					break;
 				}
 			}
-		} else {
-			const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
-			std::vector<char> searchThing(lengthFind + 1);
-			pcf->Fold(searchThing.data(), searchThing.size(), search, lengthFind);
-			const char * const searchData = searchThing.data();
-			//while (forward ? (pos < endSearch) : (pos >= endSearch)) {
-			while ((direction ^ (pos - endSearch)) < 0) {
-				bool found = (pos + lengthFind) <= limitPos;
-				for (Sci::Position indexSearch = 0; (indexSearch < lengthFind) && found; indexSearch++) {
-					const char ch = cbView.CharAt(pos + indexSearch);
-					const char chTest = searchData[indexSearch];
-					if (UTF8IsAscii(ch)) {
-						found = chTest == MakeLowerCase(ch);
-					} else {
-						char folded[2];
-						pcf->Fold(folded, sizeof(folded), &ch, 1);
-						found = folded[0] == chTest;
-					}
+			if (characterMatches && (indexSearch == lenSearch)) {
+				if (MatchesWordOptions(word, wordStart, pos, posIndexDocument - pos)) {
+					*length = posIndexDocument - pos;
+					return pos;
 				}
-				if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+			}
+			if (direction >= 0) {
+				pos += widthFirstCharacter;
+			} else {
+				if (!NextCharacter(pos, increment)) {
+					break;
+				}
+			}
+		}
+	} else if (dbcsCodePage) {
+		constexpr size_t maxBytesCharacter = 2;
+		constexpr size_t maxFoldingExpansion = 4;
+		const size_t lenSearch = FoldSearchText(search, lengthFind);
+		const unsigned char * const searchData = reinterpret_cast<const unsigned char *>(foldedSearch.data());
+		//while (forward ? (pos < endPos) : (pos >= endPos)) {
+		while ((direction ^ (pos - endPos)) < 0) {
+			int widthFirstCharacter = 0;
+			Sci::Position indexDocument = 0;
+			size_t indexSearch = 0;
+			bool characterMatches = true;
+			for (;;) {
+				const unsigned char leadByte = cbView.CharAt(pos + indexDocument);
+				const int widthChar = 1 + IsDBCSLeadByteNoExcept(leadByte);
+				if (!widthFirstCharacter) {
+					widthFirstCharacter = widthChar;
+				}
+				if ((pos + indexDocument + widthChar) > limitPos) {
+					break;
+				}
+				size_t lenFlat = 1;
+				if (widthChar == 1) {
+					characterMatches = searchData[indexSearch] == MakeLowerCase(leadByte);
+				} else {
+					char bytes[maxBytesCharacter + 1];
+					bytes[0] = static_cast<char>(leadByte);
+					bytes[1] = cbView.CharAt(pos + indexDocument + 1);
+					char folded[maxBytesCharacter * maxFoldingExpansion + 1];
+					lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
+					// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of foldedSearch
+					assert((indexSearch + lenFlat) <= foldedSearch.size());
+					// Does folded match the buffer
+					characterMatches = 0 == memcmp(folded, searchData + indexSearch, lenFlat);
+				}
+				if (!characterMatches) {
+					break;
+				}
+				indexDocument += widthChar;
+				indexSearch += lenFlat;
+				if (indexSearch >= lenSearch) {
+					break;
+				}
+			}
+			if (characterMatches && (indexSearch == lenSearch)) {
+				if (MatchesWordOptions(word, wordStart, pos, indexDocument)) {
+					*length = indexDocument;
 					return pos;
 				}
-				pos += increment;
 			}
+			if (direction >= 0) {
+				pos += widthFirstCharacter;
+			} else {
+				if (!NextCharacter(pos, increment)) {
+					break;
+				}
+			}
+		}
+	} else {
+		const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
+		FoldSearchText(search, lengthFind);
+		const char * const searchData = foldedSearch.data();
+		const bool skipToCandidate = direction >= 0 && UTF8IsAscii(searchData[0]);
+		//while (forward ? (pos < endSearch) : (pos >= endSearch)) {
+		while ((direction ^ (pos - endSearch)) < 0) {
+			if (skipToCandidate) {
+				pos = SkipToFoldCandidate(cbView, pos, endSearch, searchData[0], 0x80);
+				if (pos >= endSearch) {
+					break;
+				}
+			}
+			bool found = (pos + lengthFind) <= limitPos;
+			for (Sci::Position indexSearch = 0; (indexSearch < lengthFind) && found; indexSearch++) {
+				const char ch = cbView.CharAt(pos + indexSearch);
+				const char chTest = searchData[indexSearch];
+				if (UTF8IsAscii(ch)) {
+					found = chTest == MakeLowerCase(ch);
+				} else {
+					char folded[2];
+					pcf->Fold(folded, sizeof(folded), &ch, 1);
+					found = folded[0] == chTest;
+				}
+			}
+			if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+				return pos;
+			}
+			pos += increment;
 		}
 	}
 	//Platform::DebugPrintf("Not found\n");
@@ -2312,6 +2959,8 @@ bool SCI_METHOD Document::SetStyleFor(Sci_Position length, unsigned char style)
 		enteredStyling++;
 		const Sci::Position prevEndStyled = endStyled;
 		if (cb.SetStyleFor(endStyled, length, style)) {
+			InvalidateBraceIndexes(prevEndStyled, prevEndStyled + length);
+			tagIndex.Truncate(prevEndStyled);
 			const DocModification mh(ModificationFlags::ChangeStyle | ModificationFlags::User,
 				prevEndStyled, length);
 			NotifyModified(mh);
@@ -2327,20 +2976,14 @@ bool SCI_METHOD Document::SetStyles(Sci_Position length, const unsigned char *st
 		return false;
 	} else {
 		enteredStyling++;
-		bool didChange = false;
 		Sci::Position startMod = 0;
 		Sci::Position endMod = 0;
-		for (int iPos = 0; iPos < length; iPos++, endStyled++) {
-			PLATFORM_ASSERT(endStyled < Length());
-			if (cb.SetStyleAt(endStyled, styles[iPos])) {
-				if (!didChange) {
-					startMod = endStyled;
-				}
-				didChange = true;
-				endMod = endStyled;
-			}
-		}
+		PLATFORM_ASSERT(endStyled + length <= Length());
+		const bool didChange = cb.SetStyles(endStyled, styles, length, startMod, endMod);
+		endStyled += length;
 		if (didChange) {
+			InvalidateBraceIndexes(startMod, endMod + 1);
+			tagIndex.Truncate(startMod);
 			const DocModification mh(ModificationFlags::ChangeStyle | ModificationFlags::User,
 				startMod, endMod - startMod + 1);
 			NotifyModified(mh);
@@ -2352,11 +2995,15 @@ bool SCI_METHOD Document::SetStyles(Sci_Position length, const unsigned char *st
 
 void Document::EnsureStyledTo(Sci::Position pos) {
 	if ((enteredStyling == 0) && (pos > GetEndStyled())) {
+		NP2_TRACE_START("EnsureStyledTo", NP2_TRACE_INT64(GetEndStyled(), "endStyled"), NP2_TRACE_INT64(pos, "pos"));
+		const Sci::Position stylingStart = GetEndStyled();
+		const ElapsedPeriod epStyling;
 		IncrementStyleClock();
 		if (pli && !pli->UseContainerLexing()) {
-			const Sci::Line lineEndStyled = SciLineFromPosition(GetEndStyled());
-			const Sci::Position endStyledTo = LineStart(lineEndStyled);
-			pli->Colourise(endStyledTo, pos);
+			ColouriseBatches(pos);
+			if (styleWindow != 0) {
+				TrimStyleWindow();
+			}
 		} else {
 			// Ask the watchers to style, and stop as soon as one responds.
 			for (auto it = watchers.begin();
@@ -2364,6 +3011,260 @@ void Document::EnsureStyledTo(Sci::Position pos) {
 				it->watcher->NotifyStyleNeeded(this, it->userData, pos);
 			}
 		}
+		stylingStatistics.bytes += std::max<Sci::Position>(GetEndStyled() - stylingStart, 0);
+		stylingStatistics.duration += epStyling.Duration();
+		NP2_TRACE_STOP("EnsureStyledTo", NP2_TRACE_INT64(GetEndStyled(), "endStyled"));
+	}
+}
+
+namespace {
+
+// minimum bytes folded at a time when folding on demand.
+constexpr Sci::Position foldOnDemandStep = 64*1024;
+
+}
+
+// Fold levels are computed on demand for a huge document, only fold lines that are styled.
+void Document::EnsureFoldedTo(Sci::Position pos) {
+	if (pli && pos > pli->FoldedEnd()) {
+		// lines are usually requested one after another, so fold a few more
+		const Sci::Position end = LineStart(SciLineFromPosition(std::min(pos + foldOnDemandStep, Length())) + 1);
+		pli->FoldTo(std::min(end, LineStart(SciLineFromPosition(GetEndStyled()))));
+	}
+}
+
+namespace {
+
+// Lexers resume at a line start from the style of the previous character,
+// the previous line state and the previous fold level.
+struct LexerCheckpoint {
+	Sci::Line line;
+	int style;
+	int lineState;
+	int level;
+};
+
+constexpr Sci::Line maxLexerCheckpoints = 256;
+
+}
+
+void Document::ColouriseConverging(Sci::Position start, Sci::Position end) {
+	// lines after the edit, whose old state is still valid and will be relexed. line state
+	// and level of the edited line itself come from line which was split or joined.
+	const Sci::Line lineFirst = std::max(SciLineFromPosition(editedEnd) + 1, SciLineFromPosition(start));
+	const Sci::Line lineLast = SciLineFromPosition(std::min(end, styledValidEnd)) - 1;
+	if (lineFirst > lineLast) {
+		pli->Colourise(start, end);
+	} else {
+		std::vector<LexerCheckpoint> checkpoints;
+		const Sci::Line interval = 1 + (lineLast - lineFirst) / maxLexerCheckpoints;
+		checkpoints.reserve((lineLast - lineFirst) / interval + 1);
+		for (Sci::Line line = lineFirst; line <= lineLast; line += interval) {
+			checkpoints.push_back({ line, StyleIndexAt(LineStart(line + 1) - 1), GetLineState(line), GetLevel(line) });
+		}
+
+		pli->Colourise(start, end);
+
+		for (const LexerCheckpoint &checkpoint : checkpoints) {
+			const Sci::Line line = checkpoint.line;
+			// lexing may have been skipped or stopped early
+			if (LineStart(line + 1) <= endStyled && checkpoint.style == StyleIndexAt(LineStart(line + 1) - 1)
+				&& checkpoint.lineState == GetLineState(line) && checkpoint.level == GetLevel(line)) {
+				// same state as before the edit, styles after this line are unchanged
+				endStyled = std::max(endStyled, styledValidEnd);
+				break;
+			}
+		}
+	}
+	// state before endStyled is relexed, only state after it is still the one before the edit
+	editedEnd = std::max(editedEnd, endStyled);
+	if (endStyled >= styledValidEnd) {
+		styledValidEnd = 0;
+	}
+}
+
+namespace {
+
+// when styles are evicted, styles for the line before every checkpoint line are kept,
+// lexing (and folding that starts one line before) restarts from a checkpoint to restore evicted styles.
+constexpr Sci::Line styleCheckpointLines = 1024;
+
+}
+
+// Lexer watchdog: when a budget is set, lex in batches of about a quarter of the budget at the
+// measured styling speed. A lexer can't be interrupted inside a batch, but a batch exceeding the
+// budget shows the lexer is pathological on this text, so text after it is given default style
+// instead of freezing the view again on each request.
+void Document::ColouriseBatches(Sci::Position pos) {
+	const double budget = styleBudget/1000.0;
+	while (pos > GetEndStyled()) {
+		if (styleDegradedStart >= 0 && GetEndStyled() >= styleDegradedStart) {
+			SetStyleFor(pos - GetEndStyled(), 0);
+			break;
+		}
+		const Sci::Position endStyledTo = LineStart(SciLineFromPosition(GetEndStyled()));
+		Sci::Position batchEnd = pos;
+		if (styleBudget > 0) {
+			const Sci::Position batchBytes = std::min<Sci::Position>(durationStyleOneUnit.ActionsInAllowedTime(budget/4), ActionDuration::InitialBytes);
+			batchEnd = std::min(pos, LineStart(SciLineFromPosition(endStyledTo + batchBytes) + 1));
+			if (styleDegradedStart >= 0) {
+				batchEnd = std::min(batchEnd, styleDegradedStart);
+			}
+		}
+		const ElapsedPeriod epBatch;
+		// with style window, styles after the converged line may have been evicted
+		if (styledValidEnd > endStyledTo && styleWindow == 0) {
+			ColouriseConverging(endStyledTo, batchEnd);
+		} else {
+			pli->Colourise(endStyledTo, batchEnd);
+		}
+		if (styleBudget == 0 || GetEndStyled() <= endStyledTo) {
+			break;
+		}
+		if (styleDegradedStart < 0 && epBatch.Duration() > budget) {
+			styleDegradedStart = GetEndStyled();
+			for (const auto &watcher : watchers) {
+				watcher.watcher->NotifyStylingDegraded(this, watcher.userData, styleDegradedStart);
+			}
+		}
+	}
+}
+
+// Speculative styling: the view far after endStyled is lexed from the state stored before it,
+// which is the state left by previous styling (e.g. before an edit) or default state for text
+// never styled. endStyled is kept, so exact styling overwrites guessed styles and line states
+// when it catches up, and fold levels are only computed by exact styling.
+void Document::ColouriseSpeculative(Sci::Position start, Sci::Position end) {
+	if (enteredStyling != 0 || !pli || pli->UseContainerLexing() || styleDegradedStart >= 0) {
+		return;
+	}
+	// styles before styledValidEnd are still from before the edit, resume from them
+	start = LineStart(SciLineFromPosition(std::max(start, styledValidEnd)));
+	end = std::min(end, Length());
+	if (start <= endStyled || start >= end || (start >= speculativeStart && end <= speculativeEnd)) {
+		return;
+	}
+
+	const Sci::Position prevEndStyled = endStyled;
+	pli->Lex(start, end);
+	endStyled = prevEndStyled;
+	speculativeStart = start;
+	speculativeEnd = end;
+}
+
+void Document::SetStyleBudget(int milliseconds) noexcept {
+	milliseconds = std::max(milliseconds, 0);
+	if (milliseconds == styleBudget) {
+		return;
+	}
+	styleBudget = milliseconds;
+	if (styleDegradedStart >= 0) {
+		// relex text given default style
+		endStyled = std::min(endStyled, styleDegradedStart);
+		styleDegradedStart = -1;
+	}
+}
+
+void Document::SetStyleWindow(Sci::Position windowSize) noexcept {
+	// evicted styles only release memory in run-length style store
+	if (windowSize < 0 || !cb.IsStylesCompressed()) {
+		windowSize = 0;
+	}
+	if (windowSize == 0 && styleWindowStart != 0) {
+		// evicted styles are required again
+		endStyled = 0;
+		styledValidEnd = 0;
+	}
+	styleWindow = windowSize;
+	styleWindowStart = 0;
+	styleViewStart = 0;
+	styleViewEnd = 0;
+}
+
+void Document::EvictStyles(Sci::Position start, Sci::Position end) {
+	InvalidateBraceIndexes(start, end);
+	tagIndex.Truncate(start);
+	Sci::Line line = (SciLineFromPosition(start) / styleCheckpointLines + 1) * styleCheckpointLines;
+	while (start < end) {
+		const Sci::Position checkpoint = std::min(LineStart(line - 1), end);
+		if (checkpoint > start) {
+			cb.SetStyleFor(start, checkpoint - start, 0);
+		}
+		start = LineStart(line);
+		line += styleCheckpointLines;
+	}
+}
+
+void Document::TrimStyleWindow() {
+	const Sci::Position limit = LineStart(SciLineFromPosition(endStyled - styleWindow));
+	if (limit - styleWindowStart < styleWindow/4) {
+		// evict in batches
+		return;
+	}
+	if (styleViewStart < limit && styleViewEnd > styleWindowStart) {
+		EvictStyles(styleWindowStart, styleViewStart);
+		EvictStyles(styleViewEnd, limit);
+	} else {
+		EvictStyles(styleWindowStart, limit);
+	}
+	styleWindowStart = limit;
+}
+
+// Lexing resumes from the style before start of the line, when that style is evicted,
+// restart from the view range or the checkpoint before it.
+void Document::ResumeStyleWindow() noexcept {
+	if (styleWindowStart == 0) {
+		return;
+	}
+	const Sci::Line lineEndStyled = SciLineFromPosition(endStyled);
+	const Sci::Position lineStart = LineStart(lineEndStyled);
+	if (lineStart > styleWindowStart) {
+		return;
+	}
+	if (lineStart > styleViewStart && lineStart <= styleViewEnd) {
+		styleWindowStart = styleViewStart;
+	} else {
+		endStyled = LineStart(lineEndStyled / styleCheckpointLines * styleCheckpointLines);
+		styleWindowStart = endStyled;
+	}
+}
+
+void Document::EnsureStyleWindow(Sci::Position start, Sci::Position end) {
+	if (styleWindow == 0 || enteredStyling != 0 || !pli || pli->UseContainerLexing()) {
+		return;
+	}
+	end = std::min(end, endStyled);
+	if (start >= end || (start >= styleViewStart && end <= styleViewEnd)) {
+		return;
+	}
+
+	// new view range from the checkpoint before start to a checkpoint interval after end
+	const Sci::Line lineStart = SciLineFromPosition(start) / styleCheckpointLines * styleCheckpointLines;
+	const Sci::Position viewStart = LineStart(lineStart);
+	const Sci::Position viewEnd = std::min(endStyled, LineStart(SciLineFromPosition(end) + styleCheckpointLines));
+	// styles of old view range after styleWindowStart are evicted by TrimStyleWindow()
+	const Sci::Position evictEnd = std::min(styleViewEnd, styleWindowStart);
+	EvictStyles(styleViewStart, std::min(viewStart, evictEnd));
+	EvictStyles(std::max(styleViewStart, viewEnd), evictEnd);
+	styleViewStart = viewStart;
+	styleViewEnd = viewEnd;
+
+	const Sci::Position lexEnd = std::min(viewEnd, styleWindowStart);
+	if (viewStart < lexEnd) {
+		// relex evicted styles, lexer state after lexEnd is unchanged, but the lexer
+		// may leave partial state for the line at lexEnd
+		const Sci::Position prevEndStyled = endStyled;
+		const Sci::Line lineEnd = SciLineFromPosition(lexEnd);
+		const int lineState = GetLineState(lineEnd);
+		const int level = GetLevel(lineEnd);
+		pli->Colourise(viewStart, lexEnd);
+		if (GetLineState(lineEnd) != lineState) {
+			SetLineState(lineEnd, lineState);
+		}
+		if (GetLevel(lineEnd) != level) {
+			SetLevel(lineEnd, level);
+		}
+		endStyled = prevEndStyled;
 	}
 }
 
@@ -2379,6 +3280,10 @@ void Document::LexerChanged(bool hasStyles_) {
 	if (cb.EnsureStyleBuffer(hasStyles_)) {
 		endStyled = 0;
 	}
+	styledValidEnd = 0;
+	styleDegradedStart = -1;
+	speculativeEnd = 0;
+	ResumeStyleWindow();
 	// Tell the watchers the lexer has changed.
 	for (const auto &watcher : watchers) {
 		watcher.watcher->NotifyLexerChanged(this, watcher.userData);
@@ -2546,6 +3451,15 @@ void SCI_METHOD Document::DecorationFillRange(Sci_Position position, int value,
 	}
 }
 
+void Document::DecorationFillRanges(const Sci::Position *ranges, size_t count, int value) {
+	const FillResult<Sci::Position> fr = decorations->FillRanges(ranges, count, value);
+	if (fr.changed) {
+		const DocModification mh(ModificationFlags::ChangeIndicator | ModificationFlags::User,
+			fr.position, fr.fillLength);
+		NotifyModified(mh);
+	}
+}
+
 bool Document::AddWatcher(DocWatcher *watcher, void *userData) {
 	const WatcherWithUserData wwud(watcher, userData);
 	const auto it = std::find(watchers.begin(), watchers.end(), wwud);
@@ -2582,17 +3496,88 @@ void Document::NotifySavePoint(bool atSavePoint) noexcept {
 	}
 }
 
-void Document::NotifyModified(DocModification mh) {
-	if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
-		decorations->InsertSpace(mh.position, mh.length);
-	} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
-		decorations->DeleteRange(mh.position, mh.length);
+void Document::NotifyModified(DocModification mh, bool updateDecorations) {
+	if (updateDecorations) {
+		if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
+			decorations->InsertSpace(mh.position, mh.length);
+		} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
+			decorations->DeleteRange(mh.position, mh.length);
+		}
+	}
+	if (FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText)) {
+		if (textSnapshot) {
+			// readers keep their references, next acquire copies the new text
+			textSnapshot->Release();
+			textSnapshot = nullptr;
+		}
+		if (!searchWindow.empty()) {
+			// copied text is stale, next search copies it again
+			std::string().swap(searchWindow);
+			searchWindowStart = 0;
+		}
+		if (bulkModification.depth != 0) {
+			bulkModification.Add(FlagSet(mh.modificationType, ModificationFlags::InsertText), mh.position, mh.length, mh.linesAdded);
+		}
 	}
 	for (const auto &watcher : watchers) {
 		watcher.watcher->NotifyModified(this, mh, watcher.userData);
 	}
 }
 
+void BulkModification::Add(bool insert, Sci::Position position, Sci::Position length, Sci::Line lines) noexcept {
+	linesAdded += lines;
+	if (insert) {
+		if (start < 0) {
+			start = position;
+			end = position + length;
+		} else if (position < start) {
+			start = position;
+			end += length;
+		} else if (position <= end) {
+			end += length;
+		} else {
+			end = position + length;
+		}
+	} else {
+		if (start < 0) {
+			start = position;
+			end = position;
+		} else {
+			start = std::min(start, position);
+			end = (end >= position + length) ? (end - length) : position;
+		}
+	}
+}
+
+const char *Document::AcquireTextSnapshot() {
+	if (!textSnapshot) {
+		// copy both sides of the gap, unlike BufferPointer() the gap is not moved
+		const Sci::Position length = cb.Length();
+		textSnapshot = TextSnapshot::Create(length);
+		cb.GetCharRange(textSnapshot->Text(), 0, length);
+	}
+	textSnapshot->AddRef();
+	return textSnapshot->Text();
+}
+
+void Document::ReleaseTextSnapshot(const char *text) noexcept {
+	if (text) {
+		TextSnapshot::FromText(text)->Release();
+	}
+}
+
+void Document::EndBulkModification() {
+	if (bulkModification.depth == 0 || --bulkModification.depth != 0) {
+		return;
+	}
+	const BulkModification bulk = bulkModification;
+	bulkModification = {};
+	if (bulk.start >= 0) {
+		// watchers redo deferred work once, length is the changed range in current document
+		NotifyModified(DocModification(ModificationFlags::BulkModification, bulk.start, bulk.end - bulk.start, bulk.linesAdded));
+	}
+}
+
 // Used for word part navigation.
 static constexpr bool IsASCIIPunctuationCharacter(unsigned int ch) noexcept {
 	return IsPunctuation(ch);
@@ -2755,17 +3740,258 @@ static constexpr char BraceOpposite(char ch) noexcept {
 	}
 }
 
-// TODO: should be able to extend styled region to find matching brace
-Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position /*maxReStyle*/, Sci::Position startPos, bool useStartPos) const noexcept {
-	const char chBrace = CharAt(position);
-	const char chSeek = BraceOpposite(chBrace);
-	if (chSeek == '\0')
+namespace {
+
+// find ch in [position, end) one contiguous segment at a time, returns end when not found.
+Sci::Position FindByte(const Document &doc, Sci::Position position, Sci::Position end, char ch) noexcept {
+	while (position < end) {
+		Sci::Position segmentStart = position;
+		Sci::Position segmentEnd = end;
+		const char * const segment = doc.CharRangePointer(position, &segmentStart, &segmentEnd);
+		const void * const found = memchr(segment, static_cast<unsigned char>(ch), segmentEnd - segmentStart);
+		if (found) {
+			return segmentStart + (static_cast<const char *>(found) - segment);
+		}
+		position = segmentEnd;
+	}
+	return end;
+}
+
+}
+
+BraceIndex::BraceIndex(char chOpen_, char chClose_, int style_) :
+	depths(1), chOpen(chOpen_), chClose(chClose_), style(style_) {}
+
+// insert braces in [start, end) at index, the range must not contain indexed braces
+void BraceIndex::Scan(const Document &doc, Sci::Position start, Sci::Position end, size_t index) {
+	std::vector<Sci::Position> found;
+	std::vector<signed char> foundSteps;
+	Sci::Position nextOpen = FindByte(doc, start, end, chOpen);
+	Sci::Position nextClose = FindByte(doc, start, end, chClose);
+	while (true) {
+		const Sci::Position position = std::min(nextOpen, nextClose);
+		if (position >= end) {
+			break;
+		}
+		const bool open = position == nextOpen;
+		if (doc.StyleIndexAt(position) == style) {
+			found.push_back(position);
+			foundSteps.push_back(open ? 1 : -1);
+		}
+		if (open) {
+			nextOpen = FindByte(doc, position + 1, end, chOpen);
+		} else {
+			nextClose = FindByte(doc, position + 1, end, chClose);
+		}
+	}
+	if (!found.empty()) {
+		positions.insert(positions.begin() + index, found.begin(), found.end());
+		steps.insert(steps.begin() + index, foundSteps.begin(), foundSteps.end());
+		depths.insert(depths.begin() + index + 1, found.size(), 0);
+		validDepths = std::min(validDepths, index);
+	}
+}
+
+// remove braces in [start, end)
+void BraceIndex::Erase(Sci::Position start, Sci::Position end) noexcept {
+	const auto itFirst = std::lower_bound(positions.begin(), positions.end(), start);
+	const size_t first = itFirst - positions.begin();
+	const size_t last = std::lower_bound(itFirst, positions.end(), end) - positions.begin();
+	if (first < last) {
+		positions.erase(positions.begin() + first, positions.begin() + last);
+		steps.erase(steps.begin() + first, steps.begin() + last);
+		depths.erase(depths.begin() + first + 1, depths.begin() + last + 1);
+		validDepths = std::min(validDepths, first);
+	}
+}
+
+void BraceIndex::UpdateDepths() {
+	const size_t first = validDepths;
+	const size_t count = positions.size();
+	if (first >= count && treeLeaves == depths.size()) {
+		return;
+	}
+	for (size_t i = first; i < count; i++) {
+		depths[i + 1] = depths[i] + steps[i];
+	}
+	validDepths = count;
+	if (depths.size() > leafStart) {
+		// grow the tree and rebuild all nodes
+		leafStart = std::max<size_t>(leafStart, 1024);
+		while (leafStart < depths.size()) {
+			leafStart *= 2;
+		}
+		tree.assign(2*leafStart, INT_MAX);
+		UpdateTree(0, depths.size());
+	} else {
+		UpdateTree(first, std::max(treeLeaves, depths.size()));
+	}
+	treeLeaves = depths.size();
+}
+
+void BraceIndex::UpdateTree(size_t first, size_t last) noexcept {
+	if (first >= last) {
+		return;
+	}
+	for (size_t i = first; i < last; i++) {
+		tree[leafStart + i] = (i < depths.size()) ? depths[i] : INT_MAX;
+	}
+	size_t nodeFirst = (leafStart + first) / 2;
+	size_t nodeLast = (leafStart + last - 1) / 2;
+	while (nodeFirst != 0) {
+		for (size_t node = nodeFirst; node <= nodeLast; node++) {
+			tree[node] = std::min(tree[2*node], tree[2*node + 1]);
+		}
+		nodeFirst /= 2;
+		nodeLast /= 2;
+	}
+}
+
+// first index in [first, last] with depth not greater than depth
+ptrdiff_t BraceIndex::FindFirst(size_t node, size_t nodeFirst, size_t nodeLast, size_t first, size_t last, int depth) const noexcept {
+	if (nodeFirst > last || nodeLast < first || tree[node] > depth) {
 		return -1;
-	const int styBrace = StyleIndexAt(position);
+	}
+	if (nodeFirst == nodeLast) {
+		return nodeFirst;
+	}
+	const size_t middle = (nodeFirst + nodeLast) / 2;
+	const ptrdiff_t index = FindFirst(2*node, nodeFirst, middle, first, last, depth);
+	if (index >= 0) {
+		return index;
+	}
+	return FindFirst(2*node + 1, middle + 1, nodeLast, first, last, depth);
+}
+
+// last index in [first, last] with depth not greater than depth
+ptrdiff_t BraceIndex::FindLast(size_t node, size_t nodeFirst, size_t nodeLast, size_t first, size_t last, int depth) const noexcept {
+	if (nodeFirst > last || nodeLast < first || tree[node] > depth) {
+		return -1;
+	}
+	if (nodeFirst == nodeLast) {
+		return nodeFirst;
+	}
+	const size_t middle = (nodeFirst + nodeLast) / 2;
+	const ptrdiff_t index = FindLast(2*node + 1, middle + 1, nodeLast, first, last, depth);
+	if (index >= 0) {
+		return index;
+	}
+	return FindLast(2*node, nodeFirst, middle, first, last, depth);
+}
+
+// mark [start, end) dirty, it is merged with the current dirty range
+void BraceIndex::Invalidate(Sci::Position start, Sci::Position end) noexcept {
+	end = std::min(end, limit);
+	if (start >= end) {
+		return;
+	}
+	if (dirtyStart < dirtyEnd) {
+		start = std::min(start, dirtyStart);
+		end = std::max(end, dirtyEnd);
+	}
+	Erase(start, end);
+	if (end >= limit) {
+		limit = start;
+		dirtyStart = 0;
+		dirtyEnd = 0;
+	} else {
+		dirtyStart = start;
+		dirtyEnd = end;
+	}
+}
+
+void BraceIndex::Truncate(Sci::Position position) noexcept {
+	Invalidate(position, limit);
+}
+
+void BraceIndex::Edit(Sci::Position position, Sci::Position lengthInserted, Sci::Position lengthDeleted) noexcept {
+	if (position >= limit) {
+		return;
+	}
+	Invalidate(position, position + lengthDeleted);
+	if (position >= limit) {
+		return;
+	}
+	const Sci::Position delta = lengthInserted - lengthDeleted;
+	if (delta != 0) {
+		for (auto it = std::lower_bound(positions.begin(), positions.end(), position); it != positions.end(); ++it) {
+			*it += delta;
+		}
+		if (dirtyStart > position) {
+			dirtyStart += delta;
+		}
+		if (dirtyEnd > position) {
+			dirtyEnd += delta;
+		}
+		limit += delta;
+	}
+	Invalidate(position, position + lengthInserted);
+}
+
+// index braces in [0, end)
+void BraceIndex::Extend(const Document &doc, Sci::Position end) {
+	if (dirtyStart < dirtyEnd && dirtyStart < end) {
+		const Sci::Position scanEnd = std::min(dirtyEnd, end);
+		const size_t index = std::lower_bound(positions.begin(), positions.end(), dirtyStart) - positions.begin();
+		Scan(doc, dirtyStart, scanEnd, index);
+		dirtyStart = scanEnd;
+		if (dirtyStart >= dirtyEnd) {
+			dirtyStart = 0;
+			dirtyEnd = 0;
+		}
+	}
+	if (end > limit) {
+		Scan(doc, limit, end, positions.size());
+		limit = end;
+	}
+	UpdateDepths();
+}
+
+// match for an opening brace with braces in [position, end), depth is updated when not found
+Sci::Position BraceIndex::MatchForward(Sci::Position position, Sci::Position end, int &depth) const noexcept {
+	const auto itFirst = std::lower_bound(positions.begin(), positions.end(), position);
+	const size_t first = itFirst - positions.begin();
+	const size_t last = std::lower_bound(itFirst, positions.end(), end) - positions.begin();
+	if (first >= last) {
+		return -1;
+	}
+	const ptrdiff_t index = FindFirst(1, 0, leafStart - 1, first + 1, last, depths[first] - depth);
+	if (index >= 0) {
+		return positions[index - 1];
+	}
+	depth += depths[last] - depths[first];
+	return -1;
+}
+
+// match for a closing brace with braces in [0, position]
+Sci::Position BraceIndex::MatchBackward(Sci::Position position, int depth) const noexcept {
+	const size_t last = std::upper_bound(positions.begin(), positions.end(), position) - positions.begin();
+	if (last == 0) {
+		return -1;
+	}
+	const ptrdiff_t index = FindLast(1, 0, leafStart - 1, 0, last - 1, depths[last] - depth);
+	if (index >= 0) {
+		return positions[index];
+	}
+	return -1;
+}
+
+namespace {
+
+// walking the text is fast enough for small documents
+constexpr Sci::Position braceIndexMinLength = 1024*1024;
+// nearby braces are matched by walking the text before the index is used
+constexpr Sci::Position braceScanLength = 64*1024;
+// forward matching extends the index one block at a time until the match is found
+constexpr Sci::Position braceIndexBlockLength = 1024*1024;
+constexpr size_t maxBraceIndexes = 8;
+
+}
+
+// walk from position to end (exclusive when moving forward, inclusive when moving backward)
+Sci::Position Document::BraceScan(Sci::Position position, Sci::Position end, char chBrace, char chSeek, int styBrace, int &depth) const noexcept {
 	const int direction = (chBrace < chSeek) ? 1 : -1;
-	int depth = 1;
-	position = useStartPos ? startPos : NextPosition(position, direction);
-	while ((position >= 0) && (position < Length())) {
+	while ((direction > 0) ? (position < end) : (position >= end)) {
 		const char chAtPos = CharAt(position);
 		const int styAtPos = StyleIndexAt(position);
 		if ((position > GetEndStyled()) || (styAtPos == styBrace)) {
@@ -2784,12 +4010,338 @@ Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position /*maxRe
 	return -1;
 }
 
+// TODO: should be able to extend styled region to find matching brace
+// maxDistance limits how far from the brace a match is searched, 0 searches whole document.
+Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position maxDistance, Sci::Position startPos, bool useStartPos) const {
+	const char chBrace = CharAt(position);
+	const char chSeek = BraceOpposite(chBrace);
+	if (chSeek == '\0')
+		return -1;
+	const int styBrace = StyleIndexAt(position);
+	const int direction = (chBrace < chSeek) ? 1 : -1;
+	// end of search, exclusive when forward and inclusive when backward
+	Sci::Position limit = (direction > 0) ? Length() : 0;
+	if (maxDistance > 0) {
+		limit = (direction > 0) ? std::min(limit, position + maxDistance) : std::max(limit, position - maxDistance);
+	}
+	int depth = 1;
+	position = useStartPos ? startPos : NextPosition(position, direction);
+	if (position < 0 || position >= Length()) {
+		return -1;
+	}
+
+	// braces in DBCS trail bytes are skipped by NextPosition(), the index only works on single bytes
+	if (Length() >= braceIndexMinLength && (dbcsCodePage == 0 || dbcsCodePage == CpUtf8)) {
+		const Sci::Position nearLimit = (direction > 0) ? std::min(limit, position + braceScanLength) : std::max(limit, position - braceScanLength);
+		const Sci::Position nearMatch = BraceScan(position, nearLimit, chBrace, chSeek, styBrace, depth);
+		if (nearMatch >= 0 || nearLimit == limit) {
+			return nearMatch;
+		}
+		position = (direction > 0) ? nearLimit : nearLimit - 1;
+		const char chOpen = (direction > 0) ? chBrace : chSeek;
+		auto it = std::find_if(braceIndexes.begin(), braceIndexes.end(), [chOpen, styBrace](const BraceIndex &index) noexcept {
+			return index.chOpen == chOpen && index.style == styBrace;
+		});
+		if (it == braceIndexes.end()) {
+			if (braceIndexes.size() >= maxBraceIndexes) {
+				braceIndexes.erase(braceIndexes.begin());
+			}
+			it = braceIndexes.emplace(braceIndexes.end(), chOpen, BraceOpposite(chOpen), styBrace);
+		}
+		// brace at endStyled and after it are matched by walking the text
+		const Sci::Position end = endStyled;
+		if (direction > 0) {
+			const Sci::Position indexEnd = std::min(end, limit);
+			while (position < indexEnd) {
+				const Sci::Position blockEnd = std::min(indexEnd, std::max(it->Limit(), position + braceIndexBlockLength));
+				it->Extend(*this, blockEnd);
+				const Sci::Position match = it->MatchForward(position, blockEnd, depth);
+				if (match >= 0) {
+					return match;
+				}
+				position = blockEnd;
+			}
+		} else {
+			if (position >= end) {
+				const Sci::Position match = BraceScan(position, std::max(end, limit), chBrace, chSeek, styBrace, depth);
+				if (match >= 0 || end <= limit) {
+					return match;
+				}
+				position = end - 1;
+			}
+			it->Extend(*this, position + 1);
+			const Sci::Position match = it->MatchBackward(position, depth);
+			return (match >= limit) ? match : -1;
+		}
+	}
+	return BraceScan(position, limit, chBrace, chSeek, styBrace, depth);
+}
+
+void Document::TruncateBraceIndexes(Sci::Position position) noexcept {
+	for (BraceIndex &index : braceIndexes) {
+		index.Truncate(position);
+	}
+}
+
+void Document::InvalidateBraceIndexes(Sci::Position start, Sci::Position end) noexcept {
+	for (BraceIndex &index : braceIndexes) {
+		index.Invalidate(start, end);
+	}
+}
+
+namespace {
+
+// unpaired end tag only closes elements within this depth
+constexpr int maxTagPairDepth = 256;
+constexpr size_t maxVoidTagLength = 32;
+
+constexpr bool IsTagNameStart(unsigned char ch) noexcept {
+	return IsAlpha(ch) || ch == '_' || ch == ':' || ch >= 0x80;
+}
+
+constexpr bool IsTagNameChar(unsigned char ch) noexcept {
+	return IsAlphaNumeric(ch) || ch == '-' || ch == '_' || ch == ':' || ch == '.' || ch >= 0x80;
+}
+
+}
+
+bool TagIndex::IsTagStyle(const Document &doc, Sci::Position position) const noexcept {
+	return tagStyles[doc.StyleIndexAt(position)];
+}
+
+bool TagIndex::IsVoidTag(const Document &doc, Sci::Position position) const {
+	if (voidTags.empty()) {
+		return false;
+	}
+	char name[maxVoidTagLength + 2] = " ";
+	size_t length = 1;
+	while (true) {
+		const unsigned char ch = doc.CharAt(position++);
+		if (!IsTagNameChar(ch)) {
+			break;
+		}
+		if (length > maxVoidTagLength) {
+			return false;
+		}
+		name[length++] = static_cast<char>(caseSensitive ? ch : MakeLowerCase(ch));
+	}
+	name[length++] = ' ';
+	return voidTags.find(name, 0, length) != std::string::npos;
+}
+
+bool TagIndex::NameEqual(const Document &doc, const Tag &tag, const Tag &other) const noexcept {
+	Sci::Position position = tag.start + ((tag.kind == TagKind::Close) ? 2 : 1);
+	Sci::Position otherPosition = other.start + ((other.kind == TagKind::Close) ? 2 : 1);
+	while (true) {
+		const unsigned char ch = doc.CharAt(position++);
+		const unsigned char chOther = doc.CharAt(otherPosition++);
+		const bool nameChar = IsTagNameChar(ch);
+		if (!nameChar || !IsTagNameChar(chOther)) {
+			return nameChar == IsTagNameChar(chOther);
+		}
+		if (ch != chOther && (caseSensitive || MakeLowerCase(ch) != MakeLowerCase(chOther))) {
+			return false;
+		}
+	}
+}
+
+void TagIndex::Clear() noexcept {
+	limit = 0;
+	current = -1;
+	tags.clear();
+}
+
+void TagIndex::SetTagStyle(int style, bool tag) noexcept {
+	if (style < 0) {
+		std::fill(std::begin(tagStyles), std::end(tagStyles), false);
+	} else if (style < static_cast<int>(std::size(tagStyles))) {
+		tagStyles[style] = tag;
+	}
+	enabled = std::any_of(std::begin(tagStyles), std::end(tagStyles), [](bool value) noexcept {
+		return value;
+	});
+	Clear();
+	if (!enabled) {
+		tags.shrink_to_fit();
+	}
+}
+
+void TagIndex::SetVoidTags(bool caseSensitive_, const char *names) {
+	caseSensitive = caseSensitive_;
+	voidTags.clear();
+	if (names && *names) {
+		voidTags.push_back(' ');
+		for (; *names; names++) {
+			const unsigned char ch = *names;
+			voidTags.push_back(static_cast<char>(IsASpace(ch) ? ' ' : (caseSensitive ? ch : MakeLowerCase(ch))));
+		}
+		voidTags.push_back(' ');
+	}
+	Clear();
+}
+
+void TagIndex::Truncate(Sci::Position position) noexcept {
+	if (position >= limit) {
+		return;
+	}
+	// also remove the tag containing position
+	const auto it = std::partition_point(tags.begin(), tags.end(), [position](const Tag &tag) noexcept {
+		return tag.start + tag.length <= position;
+	});
+	if (it != tags.end()) {
+		position = std::min(position, it->start);
+	}
+	const ptrdiff_t count = it - tags.begin();
+	tags.erase(it, tags.end());
+	limit = position;
+	// elements closed by removed tags are open again
+	current = Innermost(count - 1);
+	for (int index = current; index >= 0; index = tags[index].parent) {
+		tags[index].match = -1;
+	}
+}
+
+void TagIndex::AddTag(const Document &doc, Sci::Position start, Sci::Position end, TagKind kind) {
+	const int index = static_cast<int>(tags.size());
+	Tag tag { start, static_cast<int>(end - start), kind, current, -1 };
+	if (kind == TagKind::Close) {
+		// end tag closes the innermost element of same name and elements inside it
+		int open = current;
+		int depth = 0;
+		while (open >= 0 && !NameEqual(doc, tag, tags[open])) {
+			open = (++depth < maxTagPairDepth) ? tags[open].parent : -1;
+		}
+		if (open >= 0) {
+			tags[open].match = index;
+			tag.match = open;
+			tag.parent = tags[open].parent;
+			current = tag.parent;
+		}
+	} else if (kind == TagKind::Open) {
+		current = index;
+	}
+	tags.push_back(tag);
+}
+
+bool TagIndex::Extend(const Document &doc, Sci::Position end) {
+	const Sci::Position endStyled = doc.GetEndStyled();
+	end = std::min(end, endStyled);
+	Sci::Position position = limit;
+	while (position < end && tags.size() < INT_MAX) {
+		const Sci::Position start = FindByte(doc, position, end, '<');
+		if (start >= end) {
+			position = end;
+			break;
+		}
+		position = start + 1;
+		if (!IsTagStyle(doc, start)) {
+			continue;
+		}
+		TagKind kind = TagKind::Open;
+		Sci::Position nameStart = start + 1;
+		if (doc.CharAt(nameStart) == '/') {
+			kind = TagKind::Close;
+			nameStart++;
+		}
+		if (!IsTagNameStart(static_cast<unsigned char>(doc.CharAt(nameStart)))) {
+			// comment, CDATA section, document type or processing instruction
+			continue;
+		}
+		// '>' inside attribute value has different style
+		Sci::Position tagEnd = FindByte(doc, nameStart, endStyled, '>');
+		while (tagEnd < endStyled && !IsTagStyle(doc, tagEnd)) {
+			tagEnd = FindByte(doc, tagEnd + 1, endStyled, '>');
+		}
+		if (tagEnd >= endStyled) {
+			if (endStyled < doc.Length()) {
+				// index the tag after its end is styled
+				position = start;
+				break;
+			}
+			continue;
+		}
+		tagEnd++;
+		if (tagEnd - start > INT_MAX) {
+			continue;
+		}
+		if (kind == TagKind::Open && (doc.CharAt(tagEnd - 2) == '/' || IsVoidTag(doc, nameStart))) {
+			kind = TagKind::Empty;
+		}
+		AddTag(doc, start, tagEnd, kind);
+		position = tagEnd;
+	}
+	limit = std::max(limit, std::min(position, endStyled));
+	return limit >= end;
+}
+
+bool TagIndex::Pending(const Document &doc) const noexcept {
+	return enabled && limit < doc.GetEndStyled();
+}
+
+ptrdiff_t TagIndex::TagBefore(Sci::Position position) const noexcept {
+	const auto it = std::partition_point(tags.begin(), tags.end(), [position](const Tag &tag) noexcept {
+		return tag.start <= position;
+	});
+	return (it - tags.begin()) - 1;
+}
+
+Sci::Position TagIndex::Find(const Document &doc, Sci::Position position, TagFind which) {
+	if (!enabled || position < 0) {
+		return -1;
+	}
+	Extend(doc, position + 1);
+	const ptrdiff_t index = TagBefore(position);
+	const bool inside = index >= 0 && position < tags[index].start + tags[index].length;
+	switch (which) {
+	case TagFind::Start:
+		return inside ? tags[index].start : -1;
+
+	case TagFind::End:
+		return inside ? tags[index].start + tags[index].length : -1;
+
+	case TagFind::Match:
+		if (inside) {
+			if (tags[index].match < 0 && tags[index].kind == TagKind::Open) {
+				// end tag is after position
+				Extend(doc, doc.GetEndStyled());
+			}
+			const int match = tags[index].match;
+			return (match >= 0) ? tags[match].start : -1;
+		}
+		return -1;
+
+	case TagFind::Enclosing:
+		if (position <= limit) {
+			int open;
+			if (index >= 0 && tags[index].start == position) {
+				// position is before the tag
+				open = Innermost(index - 1);
+			} else {
+				open = inside ? tags[index].parent : Innermost(index);
+			}
+			return (open >= 0) ? tags[open].start : -1;
+		}
+		return -1;
+
+	default:
+		return -1;
+	}
+}
+
+bool Document::IndexTags(Sci::Position length) {
+	if (!tagIndex.Pending(*this)) {
+		return false;
+	}
+	// stops at a tag whose end is not yet styled
+	return tagIndex.Extend(*this, tagIndex.Limit() + length) && tagIndex.Pending(*this);
+}
+
 /**
  * Implementation of RegexSearchBase for the default built-in regular expression engine
  */
 class BuiltinRegex : public RegexSearchBase {
 public:
-	explicit BuiltinRegex(CharClassify *charClassTable) : search(charClassTable) {}
+	explicit BuiltinRegex(CharClassify *charClassTable) : search(charClassTable), charClass(charClassTable) {}
 
 	Sci::Position FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
 		bool caseSensitive, FindOption flags, Sci::Position *length) override;
@@ -2798,10 +4350,16 @@ public:
 
 	void ClearCache() noexcept override {
 		search.ClearCache();
+		linear.ClearCache();
 	}
 
 private:
+	Sci::Position LinearFindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+		bool caseSensitive, Sci::Position *length);
+
 	RESearch search;
+	LinearRegex linear;
+	const CharClassify *charClass;
 	std::string substituted;
 };
 
@@ -2891,391 +4449,18 @@ public:
 	}
 };
 
-#ifndef NO_CXX11_REGEX
-
-class ByteIterator {
-public:
-	typedef std::bidirectional_iterator_tag iterator_category;
-	typedef char value_type;
-	typedef ptrdiff_t difference_type;
-	typedef char* pointer;
-	typedef char& reference;
-
-	const Document *doc;
-	Sci::Position position;
-	ByteIterator(const Document *doc_ = nullptr, Sci::Position position_ = 0) noexcept :
-		doc(doc_), position(position_) {}
-	ByteIterator(const ByteIterator &other) noexcept {
-		doc = other.doc;
-		position = other.position;
-	}
-	ByteIterator(ByteIterator &&other) noexcept {
-		doc = other.doc;
-		position = other.position;
-	}
-	ByteIterator &operator=(const ByteIterator &other) noexcept {
-		if (this != &other) {
-			doc = other.doc;
-			position = other.position;
-		}
-		return *this;
-	}
-	ByteIterator &operator=(ByteIterator &&) noexcept = default;
-	~ByteIterator() = default;
-	char operator*() const noexcept {
-		return doc->CharAt(position);
-	}
-	ByteIterator &operator++() noexcept {
-		position++;
-		return *this;
-	}
-	ByteIterator operator++(int) noexcept {
-		ByteIterator retVal(*this);
-		position++;
-		return retVal;
-	}
-	ByteIterator &operator--() noexcept {
-		position--;
-		return *this;
-	}
-	bool operator==(const ByteIterator &other) const noexcept {
-		return doc == other.doc && position == other.position;
-	}
-	bool operator!=(const ByteIterator &other) const noexcept {
-		return doc != other.doc || position != other.position;
-	}
-	Sci::Position Pos() const noexcept {
-		return position;
-	}
-	Sci::Position PosRoundUp() const noexcept {
-		return position;
-	}
-};
-
-// On Windows, wchar_t is 16 bits wide and on Unix it is 32 bits wide.
-// Would be better to use sizeof(wchar_t) or similar to differentiate
-// but easier for now to hard-code platforms.
-// C++11 has char16_t and char32_t but neither Clang nor Visual C++
-// appear to allow specializing basic_regex over these.
-
-#ifdef _WIN32
-#define WCHAR_T_IS_16 1
-#else
-#define WCHAR_T_IS_16 0
-#endif
-
-#if WCHAR_T_IS_16
-
-// On Windows, report non-BMP characters as 2 separate surrogates as that
-// matches wregex since it is based on wchar_t.
-class UTF8Iterator {
-	// These 3 fields determine the iterator position and are used for comparisons
-	const Document *doc;
-	Sci::Position position;
-	size_t characterIndex;
-	// Remaining fields are derived from the determining fields so are excluded in comparisons
-	unsigned int lenBytes;
-	size_t lenCharacters;
-	wchar_t buffered[2];
-public:
-	typedef std::bidirectional_iterator_tag iterator_category;
-	typedef wchar_t value_type;
-	typedef ptrdiff_t difference_type;
-	typedef wchar_t* pointer;
-	typedef wchar_t& reference;
-
-	UTF8Iterator(const Document *doc_ = nullptr, Sci::Position position_ = 0) noexcept :
-		doc(doc_), position(position_), characterIndex(0), lenBytes(0), lenCharacters(0), buffered{} {
-		buffered[0] = 0;
-		buffered[1] = 0;
-		if (doc) {
-			ReadCharacter();
-		}
-	}
-	UTF8Iterator(const UTF8Iterator &other) noexcept : buffered{} {
-		doc = other.doc;
-		position = other.position;
-		characterIndex = other.characterIndex;
-		lenBytes = other.lenBytes;
-		lenCharacters = other.lenCharacters;
-		buffered[0] = other.buffered[0];
-		buffered[1] = other.buffered[1];
-	}
-	UTF8Iterator(UTF8Iterator &&other) noexcept = default;
-	UTF8Iterator &operator=(const UTF8Iterator &other) noexcept {
-		if (this != &other) {
-			doc = other.doc;
-			position = other.position;
-			characterIndex = other.characterIndex;
-			lenBytes = other.lenBytes;
-			lenCharacters = other.lenCharacters;
-			buffered[0] = other.buffered[0];
-			buffered[1] = other.buffered[1];
-		}
-		return *this;
-	}
-	UTF8Iterator &operator=(UTF8Iterator &&) noexcept = default;
-	~UTF8Iterator() = default;
-	wchar_t operator*() const noexcept {
-		assert(lenCharacters != 0);
-		return buffered[characterIndex];
-	}
-	UTF8Iterator &operator++() noexcept {
-		if ((characterIndex + 1) < (lenCharacters)) {
-			characterIndex++;
-		} else {
-			position += lenBytes;
-			ReadCharacter();
-			characterIndex = 0;
-		}
-		return *this;
-	}
-	UTF8Iterator operator++(int) noexcept {
-		UTF8Iterator retVal(*this);
-		if ((characterIndex + 1) < (lenCharacters)) {
-			characterIndex++;
-		} else {
-			position += lenBytes;
-			ReadCharacter();
-			characterIndex = 0;
-		}
-		return retVal;
-	}
-	UTF8Iterator &operator--() noexcept {
-		if (characterIndex) {
-			characterIndex--;
-		} else {
-			position = doc->NextPosition(position, -1);
-			ReadCharacter();
-			characterIndex = lenCharacters - 1;
-		}
-		return *this;
-	}
-	bool operator==(const UTF8Iterator &other) const noexcept {
-		// Only test the determining fields, not the character widths and values derived from this
-		return doc == other.doc &&
-			position == other.position &&
-			characterIndex == other.characterIndex;
-	}
-	bool operator!=(const UTF8Iterator &other) const noexcept {
-		// Only test the determining fields, not the character widths and values derived from this
-		return doc != other.doc ||
-			position != other.position ||
-			characterIndex != other.characterIndex;
-	}
-	Sci::Position Pos() const noexcept {
-		return position;
-	}
-	Sci::Position PosRoundUp() const noexcept {
-		if (characterIndex)
-			return position + lenBytes;	// Force to end of character
-		else
-			return position;
-	}
-private:
-	void ReadCharacter() noexcept {
-		const Document::CharacterExtracted charExtracted = doc->ExtractCharacter(position);
-		lenBytes = charExtracted.widthBytes;
-		if (charExtracted.character == unicodeReplacementChar) {
-			lenCharacters = 1;
-			buffered[0] = static_cast<wchar_t>(charExtracted.character);
-		} else {
-			lenCharacters = UTF16FromUTF32Character(charExtracted.character, buffered);
-		}
-	}
-};
-
-#else
-
-// On Unix, report non-BMP characters as single characters
-
-class UTF8Iterator {
-	const Document *doc;
-	Sci::Position position;
-public:
-	typedef std::bidirectional_iterator_tag iterator_category;
-	typedef wchar_t value_type;
-	typedef ptrdiff_t difference_type;
-	typedef wchar_t* pointer;
-	typedef wchar_t& reference;
-
-	UTF8Iterator(const Document *doc_ = nullptr, Sci::Position position_ = 0) noexcept :
-		doc(doc_), position(position_) {}
-	UTF8Iterator(const UTF8Iterator &other) noexcept {
-		doc = other.doc;
-		position = other.position;
-	}
-	UTF8Iterator(UTF8Iterator &&other) noexcept = default;
-	UTF8Iterator &operator=(const UTF8Iterator &other) noexcept {
-		if (this != &other) {
-			doc = other.doc;
-			position = other.position;
-		}
-		return *this;
-	}
-	UTF8Iterator &operator=(UTF8Iterator &&) noexcept = default;
-	~UTF8Iterator() = default;
-	wchar_t operator*() const noexcept {
-		const Document::CharacterExtracted charExtracted = doc->ExtractCharacter(position);
-		return charExtracted.character;
-	}
-	UTF8Iterator &operator++() noexcept {
-		position = doc->NextPosition(position, 1);
-		return *this;
-	}
-	UTF8Iterator operator++(int) noexcept {
-		UTF8Iterator retVal(*this);
-		position = doc->NextPosition(position, 1);
-		return retVal;
-	}
-	UTF8Iterator &operator--() noexcept {
-		position = doc->NextPosition(position, -1);
-		return *this;
-	}
-	bool operator==(const UTF8Iterator &other) const noexcept {
-		return doc == other.doc && position == other.position;
-	}
-	bool operator!=(const UTF8Iterator &other) const noexcept {
-		return doc != other.doc || position != other.position;
-	}
-	Sci::Position Pos() const noexcept {
-		return position;
-	}
-	Sci::Position PosRoundUp() const noexcept {
-		return position;
-	}
-};
-
-#endif
-
-std::regex_constants::match_flag_type MatchFlags(const Document *doc, Sci::Position startPos, Sci::Position endPos) {
-	std::regex_constants::match_flag_type flagsMatch = std::regex_constants::match_default;
-	if (!doc->IsLineStartPosition(startPos))
-		flagsMatch |= std::regex_constants::match_not_bol;
-	if (!doc->IsLineEndPosition(endPos))
-		flagsMatch |= std::regex_constants::match_not_eol;
-	return flagsMatch;
-}
-
-template<typename Iterator, typename Regex>
-bool MatchOnLines(const Document *doc, const Regex &regexp, const RESearchRange &resr, RESearch &search) {
-	std::match_results<Iterator> match;
-
-	// MSVC and libc++ have problems with ^ and $ matching line ends inside a range.
-	// CRLF line ends are also a problem as ^ and $ only treat LF as a line end.
-	// The std::regex::multiline option was added to C++17 to improve behaviour but
-	// has not been implemented by compiler runtimes with MSVC always in multiline
-	// mode and libc++ and libstdc++ always in single-line mode.
-	// If multiline regex worked well then the line by line iteration could be removed
-	// for the forwards case and replaced with the following 4 lines:
-#ifdef REGEX_MULTILINE
-	Iterator itStart(doc, resr.startPos);
-	Iterator itEnd(doc, resr.endPos);
-	const std::regex_constants::match_flag_type flagsMatch = MatchFlags(doc, resr.startPos, resr.endPos);
-	const bool matched = std::regex_search(itStart, itEnd, match, regexp, flagsMatch);
-#else
-	// Line by line.
-	bool matched = false;
-	for (Sci::Line line = resr.lineRangeStart; line != resr.lineRangeBreak; line += resr.increment) {
-		const Range lineRange = resr.LineRange(line);
-		Iterator itStart(doc, lineRange.start);
-		Iterator itEnd(doc, lineRange.end);
-		std::regex_constants::match_flag_type flagsMatch = MatchFlags(doc, lineRange.start, lineRange.end);
-		matched = std::regex_search(itStart, itEnd, match, regexp, flagsMatch);
-		// Check for the last match on this line.
-		if (matched) {
-			if (resr.increment == -1) {
-				while (matched) {
-					Iterator itNext(doc, match[0].second.PosRoundUp());
-					flagsMatch = MatchFlags(doc, itNext.Pos(), lineRange.end);
-					std::match_results<Iterator> matchNext;
-					matched = std::regex_search(itNext, itEnd, matchNext, regexp, flagsMatch);
-					if (matched) {
-						if (match[0].first == match[0].second) {
-							// Empty match means failure so exit
-							return false;
-						}
-						match = matchNext;
-					}
-				}
-				matched = true;
-			}
-			break;
-		}
-	}
-#endif
-	if (matched) {
-		for (size_t co = 0; co < match.size(); co++) {
-			search.bopat[co] = match[co].first.Pos();
-			search.eopat[co] = match[co].second.PosRoundUp();
-			const Sci::Position lenMatch = search.eopat[co] - search.bopat[co];
-			search.pat[co].resize(lenMatch);
-			for (Sci::Position iPos = 0; iPos < lenMatch; iPos++) {
-				search.pat[co][iPos] = doc->CharAt(iPos + search.bopat[co]);
-			}
-		}
-	}
-	return matched;
-}
-
-Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
-	bool caseSensitive, Sci::Position *length, RESearch &search) {
-	const RESearchRange resr(doc, minPos, maxPos);
-	try {
-		//const ElapsedPeriod ep;
-		std::regex::flag_type flagsRe = std::regex::ECMAScript;
-		// Flags that appear to have no effect:
-		// | std::regex::collate | std::regex::extended;
-		if (!caseSensitive)
-			flagsRe = flagsRe | std::regex::icase;
-
-		// Clear the RESearch so can fill in matches
-		search.Clear();
-
-		bool matched = false;
-		if (CpUtf8 == doc->dbcsCodePage) {
-			const std::wstring ws = WStringFromUTF8(s);
-			std::wregex regexp;
-			regexp.assign(ws, flagsRe);
-			matched = MatchOnLines<UTF8Iterator>(doc, regexp, resr, search);
-		} else {
-			std::regex regexp;
-			regexp.assign(s, flagsRe);
-			matched = MatchOnLines<ByteIterator>(doc, regexp, resr, search);
-		}
-
-		Sci::Position posMatch = -1;
-		if (matched) {
-			posMatch = search.bopat[0];
-			*length = search.eopat[0] - search.bopat[0];
-		}
-		// Example - search in doc/ScintillaHistory.html for
-		// [[:upper:]]eta[[:space:]]
-		// On MacBook, normally around 1 second but with locale imbued -> 14 seconds.
-		//const double durSearch = ep.Duration();
-		//Platform::DebugPrintf("Search:%9.6g \n", durSearch);
-		return posMatch;
-	} catch (const std::regex_error &) {
-		// Failed to create regular expression
-		throw RegexError();
-	} catch (...) {
-		// Failed in some other way
-		return -1;
-	}
+Sci::Position PositionBefore(const Document *doc, Sci::Position pos) noexcept {
+	return (pos > 0) ? doc->NextPosition(pos, -1) : -1;
 }
 
-#endif
-
 }
 
 Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
 	bool caseSensitive, FindOption flags, Sci::Position *length) {
 
-#ifndef NO_CXX11_REGEX
-	if (FlagSet(flags, FindOption::Cxx11RegEx)) {
-		return Cxx11RegexFindText(doc, minPos, maxPos, s, caseSensitive, length, search);
+	if (FlagSet(flags, FindOption::LinearRegEx)) {
+		return LinearFindText(doc, minPos, maxPos, s, caseSensitive, length);
 	}
-#endif
 
 	const RESearchRange resr(doc, minPos, maxPos);
 
@@ -3321,28 +4506,15 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 		}
 
 		const DocumentIndexer di(doc, endOfLine);
-		int success = search.Execute(di, startOfLine, endOfLine);
+		// Find the last match on this line by trying start positions backward from the end,
+		// instead of rescanning forward from start of line for each match.
+		const int success = (resr.increment == 1) ? search.Execute(di, startOfLine, endOfLine)
+			: search.ExecuteBackward(di, startOfLine, endOfLine);
 		if (success) {
 			pos = search.bopat[0];
 			// Ensure only whole characters selected
 			search.eopat[0] = doc->MovePositionOutsideChar(search.eopat[0], 1, false);
 			lenRet = search.eopat[0] - search.bopat[0];
-			// There can be only one start of a line, so no need to look for last match in line
-			if ((resr.increment == -1) && !searchforLineStart) {
-				// Check for the last match on this line.
-				int repetitions = 1000;	// Break out of infinite loop
-				while (success && (search.eopat[0] <= endOfLine) && (repetitions--)) {
-					success = search.Execute(di, pos + 1, endOfLine);
-					if (success) {
-						if (search.eopat[0] <= minPos) {
-							pos = search.bopat[0];
-							lenRet = search.eopat[0] - search.bopat[0];
-						} else {
-							success = 0;
-						}
-					}
-				}
-			}
 			break;
 		}
 	}
@@ -3350,6 +4522,87 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 	return pos;
 }
 
+Sci::Position BuiltinRegex::LinearFindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+	bool caseSensitive, Sci::Position *length) {
+	const LinearRegex::Encoding encoding = { doc->dbcsCodePage, charClass, doc->GetDBCSCharClassify() };
+	const char *errmsg = linear.Compile(s, *length, caseSensitive, encoding);
+	if (errmsg) {
+		throw RegexError();
+	}
+
+	// Clear the RESearch so can fill in matches for SubstituteByPosition()
+	search.Clear();
+	const RESearchRange resr(doc, minPos, maxPos);
+	// matches don't cross line ends, so packed text is searched in windows of whole lines,
+	// other text in a single view.
+	const bool packed = doc->IsTextCompressed();
+	bool matched = false;
+	if (resr.increment == 1) {
+		Sci::Position pos = resr.startPos;
+		while (true) {
+			Sci::Position end = resr.endPos;
+			if (packed) {
+				end = std::min(end, doc->LineStart(doc->SciLineFromPosition(pos + searchWindowSize) + 1));
+			}
+			matched = linear.Search(doc->SearchView(pos, end, true), pos, end, PositionBefore(doc, pos));
+			if (matched || end == resr.endPos) {
+				break;
+			}
+			pos = end;
+		}
+		if (matched) {
+			std::copy_n(linear.groupStart, LinearRegex::MaxGroup, search.bopat);
+			std::copy_n(linear.groupEnd, LinearRegex::MaxGroup, search.eopat);
+		}
+	} else if (linear.CanSearchBackward()) {
+		Sci::Position pos = resr.startPos;
+		while (true) {
+			Sci::Position start = resr.endPos;
+			if (packed) {
+				start = std::max(start, doc->LineStart(doc->SciLineFromPosition(pos - searchWindowSize)));
+			}
+			matched = linear.SearchBackward(doc->SearchView(start, pos, false), start, pos);
+			if (matched || start == resr.endPos) {
+				break;
+			}
+			pos = start;
+		}
+		if (matched) {
+			std::copy_n(linear.groupStart, LinearRegex::MaxGroup, search.bopat);
+			std::copy_n(linear.groupEnd, LinearRegex::MaxGroup, search.eopat);
+		}
+	} else {
+		for (Sci::Line line = resr.lineRangeStart; line != resr.lineRangeBreak && !matched; line += resr.increment) {
+			// Check for the last match on this line.
+			const Range lineRange = resr.LineRange(line);
+			const SplitView view = doc->SearchView(lineRange.start, lineRange.end, false);
+			Sci::Position pos = lineRange.start;
+			while (pos <= lineRange.end && linear.Search(view, pos, lineRange.end, PositionBefore(doc, pos))) {
+				matched = true;
+				std::copy_n(linear.groupStart, LinearRegex::MaxGroup, search.bopat);
+				std::copy_n(linear.groupEnd, LinearRegex::MaxGroup, search.eopat);
+				// continue after the match, or the next character for empty match
+				Sci::Position next = linear.groupEnd[0];
+				if (next == linear.groupStart[0]) {
+					next = doc->NextPosition(next, 1);
+					if (next <= pos) {
+						break;
+					}
+				}
+				pos = next;
+			}
+		}
+	}
+
+	Sci::Position posMatch = -1;
+	*length = 0;
+	if (matched) {
+		posMatch = search.bopat[0];
+		*length = search.eopat[0] - search.bopat[0];
+	}
+	return posMatch;
+}
+
 const char *BuiltinRegex::SubstituteByPosition(Document *doc, const char *text, Sci::Position *length) {
 	substituted.clear();
 	const DocumentIndexer di(doc, doc->Length());
@@ -11,6 +11,7 @@ namespace Scintilla::Internal {
 class DocWatcher;
 class DocModification;
 class Document;
+class TextSnapshot;
 class LineMarkers;
 class LineLevels;
 class LineState;
@@ -184,6 +185,10 @@ protected:
 	Document *pdoc;
 	LexerInstance instance;
 	bool performingStyle;	///< Prevent reentrance
+	// when folding on demand, fold levels of lines before foldedEnd are up to date,
+	// otherwise lines are folded together with lexing and it is PTRDIFF_MAX.
+	Sci::Position foldedEnd = PTRDIFF_MAX;
+	virtual bool FoldOnDemand() const noexcept;
 public:
 	explicit LexInterface(Document *pdoc_) noexcept;
 	LexInterface(const LexInterface &) = delete;
@@ -191,7 +196,18 @@ public:
 	LexInterface &operator=(const LexInterface &) = delete;
 	LexInterface &operator=(LexInterface &&) = delete;
 	virtual ~LexInterface() noexcept;
-	void Colourise(Sci::Position start, Sci::Position end);
+	virtual void Colourise(Sci::Position start, Sci::Position end);
+	// lex without folding, for text styled speculatively
+	virtual void Lex(Sci::Position start, Sci::Position end);
+	virtual void FoldTo(Sci::Position end);
+	Sci::Position FoldedEnd() const noexcept {
+		return foldedEnd;
+	}
+	void InvalidateFolding(Sci::Position pos) noexcept {
+		if (foldedEnd > pos && foldedEnd != PTRDIFF_MAX) {
+			foldedEnd = pos;
+		}
+	}
 	virtual Scintilla::LineEndType LineEndTypesSupported() const noexcept;
 	bool UseContainerLexing() const noexcept;
 };
@@ -223,6 +239,118 @@ public:
 	Sci::Position ActionsInAllowedTime(double secondsAllowed) const noexcept;
 };
 
+// Totals of EnsureStyledTo since the document was created or statistics were reset.
+struct StylingStatistics {
+	Sci::Position bytes = 0;
+	// seconds spent in lexer or container styling
+	double duration = 0;
+};
+
+// Text changes between BeginBulkModification and EndBulkModification, coalesced into
+// range [start, end) of the current document, start is negative when nothing changed.
+struct BulkModification {
+	int depth = 0;
+	Sci::Position start = -1;
+	Sci::Position end = -1;
+	Sci::Line linesAdded = 0;
+	void Add(bool insert, Sci::Position position, Sci::Position length, Sci::Line lines) noexcept;
+};
+
+/**
+ * Positions of one brace pair in one style with the nesting depth before each brace.
+ * A segment tree over the depths finds the matching brace in logarithmic time.
+ * Braces before limit are indexed except inside the dirty range, edits shift the braces
+ * after them and mark the changed text dirty, style changes mark the restyled text dirty.
+ * The dirty range is scanned again and the index extended on demand by queries.
+ */
+class BraceIndex {
+	Sci::Position limit = 0;
+	Sci::Position dirtyStart = 0;
+	Sci::Position dirtyEnd = 0;
+	std::vector<Sci::Position> positions;
+	// +1 for an opening brace, -1 for a closing brace
+	std::vector<signed char> steps;
+	// depths[i] is the depth before positions[i], only depths up to validDepths are updated
+	std::vector<int> depths;
+	size_t validDepths = 0;
+	// minimum depth of each node, leaves start at leafStart
+	std::vector<int> tree;
+	size_t leafStart = 0;
+	size_t treeLeaves = 0;
+	void Scan(const Document &doc, Sci::Position start, Sci::Position end, size_t index);
+	void Erase(Sci::Position start, Sci::Position end) noexcept;
+	void UpdateDepths();
+	void UpdateTree(size_t first, size_t last) noexcept;
+	ptrdiff_t FindFirst(size_t node, size_t nodeFirst, size_t nodeLast, size_t first, size_t last, int depth) const noexcept;
+	ptrdiff_t FindLast(size_t node, size_t nodeFirst, size_t nodeLast, size_t first, size_t last, int depth) const noexcept;
+public:
+	char chOpen;
+	char chClose;
+	int style;
+	BraceIndex(char chOpen_, char chClose_, int style_);
+	Sci::Position Limit() const noexcept {
+		return limit;
+	}
+	void Invalidate(Sci::Position start, Sci::Position end) noexcept;
+	void Truncate(Sci::Position position) noexcept;
+	void Edit(Sci::Position position, Sci::Position lengthInserted, Sci::Position lengthDeleted) noexcept;
+	void Extend(const Document &doc, Sci::Position end);
+	Sci::Position MatchForward(Sci::Position position, Sci::Position end, int &depth) const noexcept;
+	Sci::Position MatchBackward(Sci::Position position, int depth) const noexcept;
+};
+
+/**
+ * Start and end tags of markup text in styled text, each end tag is paired with the innermost
+ * open element of the same name, so tag matching and the enclosing element are found with
+ * a binary search. Tags before limit are indexed, edits and style changes truncate the index
+ * and it is extended again on idle or on the next query.
+ */
+class TagIndex {
+	enum class TagKind : unsigned char {
+		Open,
+		Close,
+		Empty,	// self closing or void element
+	};
+	struct Tag {
+		Sci::Position start;
+		int length;
+		TagKind kind;
+		// innermost open element containing the tag, -1 for top level
+		int parent;
+		// paired tag, -1 when not found
+		int match;
+	};
+	Sci::Position limit = 0;
+	std::vector<Tag> tags;
+	// innermost open element at limit
+	int current = -1;
+	bool tagStyles[256]{};
+	bool caseSensitive = false;
+	// " name name ", in lower case when not case sensitive
+	std::string voidTags;
+	bool IsTagStyle(const Document &doc, Sci::Position position) const noexcept;
+	bool IsVoidTag(const Document &doc, Sci::Position position) const;
+	bool NameEqual(const Document &doc, const Tag &tag, const Tag &other) const noexcept;
+	int Innermost(ptrdiff_t index) const noexcept {
+		return (index < 0) ? -1 : ((tags[index].kind == TagKind::Open) ? static_cast<int>(index) : tags[index].parent);
+	}
+	void AddTag(const Document &doc, Sci::Position start, Sci::Position end, TagKind kind);
+	ptrdiff_t TagBefore(Sci::Position position) const noexcept;
+public:
+	bool enabled = false;
+	Sci::Position Limit() const noexcept {
+		return limit;
+	}
+	void Clear() noexcept;
+	void SetTagStyle(int style, bool tag) noexcept;
+	void SetVoidTags(bool caseSensitive_, const char *names);
+	void Truncate(Sci::Position position) noexcept;
+	// returns true when text before end is indexed, lookahead for end of tags is bounded by endStyled
+	bool Extend(const Document &doc, Sci::Position end);
+	bool Pending(const Document &doc) const noexcept;
+	Sci::Position Find(const Document &doc, Sci::Position position, Scintilla::TagFind which);
+};
+
 /**
  */
 class Document : PerLine, public Scintilla::IDocument, public Scintilla::ILoader {
@@ -247,11 +375,37 @@ private:
 	CharacterCategoryMap charMap;
 #endif
 	std::unique_ptr<CaseFolder> pcf;
+	// folded text for last case insensitive search
+	std::string foldedSearchKey;
+	std::vector<char> foldedSearch;
+	size_t lenFoldedSearch = 0;
+	// packed text copied for searching, kept until text is changed
+	std::string searchWindow;
+	Sci::Position searchWindowStart = 0;
 	Sci::Position endStyled;
+	// after an edit, styles in [editedEnd, styledValidEnd) are still those from before the edit
+	Sci::Position styledValidEnd;
+	Sci::Position editedEnd;
+	// when styleWindow is set, styles before styleWindowStart are evicted except for the
+	// view range [styleViewStart, styleViewEnd) and the line before each checkpoint line
+	Sci::Position styleWindow = 0;
+	Sci::Position styleWindowStart = 0;
+	Sci::Position styleViewStart = 0;
+	Sci::Position styleViewEnd = 0;
+	// milliseconds allowed for lexing one batch in EnsureStyledTo, 0 lexes in one call without the watchdog.
+	int styleBudget = 0;
+	// lexer exceeded styleBudget before this position, text after it is given default style, -1 when not degraded.
+	Sci::Position styleDegradedStart = -1;
+	// range after endStyled lexed speculatively, to avoid lexing it again on each paint
+	Sci::Position speculativeStart = 0;
+	Sci::Position speculativeEnd = 0;
 	int styleClock;
 	int enteredModification;
 	int enteredStyling;
 	int enteredReadOnlyCount;
+	BulkModification bulkModification;
+	// shared copy of text until next modification, see AcquireTextSnapshot()
+	TextSnapshot *textSnapshot = nullptr;
 
 	bool insertionSet;
 	std::string insertion;
@@ -274,6 +428,14 @@ private:
 	std::unique_ptr<RegexSearchBase> regex;
 	std::unique_ptr<LexInterface> pli;
 	const DBCSCharClassify *dbcsCharClass;
+	mutable std::vector<BraceIndex> braceIndexes;
+	TagIndex tagIndex;
+
+	void EvictStyles(Sci::Position start, Sci::Position end);
+	void TrimStyleWindow();
+	void ResumeStyleWindow() noexcept;
+	Sci::Position FindTextInView(const SplitView &cbView, Sci::Position minPos, Sci::Position maxPos, const char *search,
+		bool caseSensitive, bool word, bool wordStart, Sci::Position *length);
 
 public:
 
@@ -299,6 +461,7 @@ public:
 	bool tabIndents;
 	bool backspaceUnindents;
 	ActionDuration durationStyleOneUnit;
+	StylingStatistics stylingStatistics;
 
 	std::unique_ptr<IDecorationList> decorations;
 
@@ -319,6 +482,7 @@ public:
 	void InsertLine(Sci::Line line) override;
 	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
+	size_t MemoryUsage() const noexcept override;
 
 	Scintilla::LineEndType LineEndTypesSupported() const noexcept;
 	bool SetDBCSCodePage(int dbcsCodePage_);
@@ -361,6 +525,9 @@ public:
 	bool IsDBCSTrailByteNoExcept(unsigned char ch) const noexcept {
 		return dbcsCharClass->IsTrailByte(ch);
 	}
+	const DBCSCharClassify *GetDBCSCharClassify() const noexcept {
+		return dbcsCharClass;
+	}
 	bool IsDBCSDualByteAt(Sci::Position pos) const noexcept;
 	int DBCSDrawBytes(const char *text, size_t length) const noexcept;
 	int SafeSegment(const char *text, int lengthSegment) const noexcept;
@@ -368,9 +535,11 @@ public:
 
 	// Gateways to modifying document
 	void ModifiedAt(Sci::Position pos) noexcept;
+	void ModifiedAt(Sci::Position pos, Sci::Position lengthInserted, Sci::Position lengthDeleted) noexcept;
 	void CheckReadOnly() noexcept;
 	bool DeleteChars(Sci::Position pos, Sci::Position len);
 	Sci::Position InsertString(Sci::Position position, const char *s, Sci::Position insertLength);
+	Sci::Position ReplaceRanges(const Scintilla::TextReplacement *ranges, Sci::Position count);
 	void ChangeInsertion(const char *s, Sci::Position length);
 	int SCI_METHOD AddData(const char *data, Sci_Position length) override;
 	void * SCI_METHOD ConvertToDocument() noexcept override;
@@ -385,6 +554,15 @@ public:
 	void DeleteUndoHistory() {
 		cb.DeleteUndoHistory();
 	}
+	void SetUndoMemoryBudget(size_t budget) {
+		cb.SetUndoMemoryBudget(budget);
+	}
+	size_t GetUndoMemoryBudget() const noexcept {
+		return cb.GetUndoMemoryBudget();
+	}
+	size_t UndoMemoryUsage() const noexcept {
+		return cb.UndoMemoryUsage();
+	}
 	bool SetUndoCollection(bool collectUndo) noexcept {
 		return cb.SetUndoCollection(collectUndo);
 	}
@@ -397,6 +575,13 @@ public:
 	void EndUndoAction() {
 		cb.EndUndoAction();
 	}
+	void BeginBulkModification() noexcept {
+		bulkModification.depth++;
+	}
+	void EndBulkModification();
+	bool InBulkModification() const noexcept {
+		return bulkModification.depth != 0;
+	}
 	void AddUndoAction(Sci::Position token, bool mayCoalesce) {
 		cb.AddUndoAction(token, mayCoalesce);
 	}
@@ -419,18 +604,34 @@ public:
 	const char * SCI_METHOD BufferPointer() override {
 		return cb.BufferPointer();
 	}
-	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept {
+	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) {
 		return cb.RangePointer(position, rangeLength);
 	}
-	const char *StyleRangePointer(Sci::Position position, Sci::Position rangeLength) noexcept {
+	const char *StyleRangePointer(Sci::Position position, Sci::Position rangeLength) {
 		return cb.StyleRangePointer(position, rangeLength);
 	}
 	Sci::Position GapPosition() const noexcept {
 		return cb.GapPosition();
 	}
+	SplitView AllView() {
+		return cb.AllView();
+	}
+	SplitView SearchView(Sci::Position start, Sci::Position end, bool forward);
+	bool IsTextCompressed() const noexcept {
+		return cb.IsTextCompressed();
+	}
+	void PackText(Sci::Position hotStart, Sci::Position hotEnd) {
+		cb.PackText(hotStart, hotEnd);
+	}
+	void PinText(Sci::Position position, Sci::Position length) noexcept {
+		cb.PinText(position, length);
+	}
+	const char *AcquireTextSnapshot();
+	static void ReleaseTextSnapshot(const char *text) noexcept;
 
 	int SCI_METHOD GetLineIndentation(Sci_Line line) const noexcept override;
 	Sci::Position SetLineIndentation(Sci::Line line, Sci::Position indent);
+	std::string IndentationText(Sci::Position indent) const;
 	Sci::Position GetLineIndentPosition(Sci::Line line) const noexcept;
 	Sci::Position GetColumn(Sci::Position pos) noexcept;
 	Sci::Position CountCharacters(Sci::Position startPos, Sci::Position endPos) const noexcept;
@@ -450,6 +651,10 @@ public:
 		return cb.IsLarge();
 	}
 	Scintilla::DocumentOption Options() const noexcept;
+	// options for private copy read by worker threads, as reading packed text is not thread safe.
+	Scintilla::DocumentOption WorkerOptions() const noexcept;
+	void ConvertToLarge(Scintilla::DocumentOption options);
+	size_t MemoryUsage(Scintilla::MemoryUsage usage) const noexcept;
 
 	void DelChar(Sci::Position pos);
 	void DelCharBack(Sci::Position pos);
@@ -463,6 +668,9 @@ public:
 	void SCI_METHOD GetCharRange(char *buffer, Sci_Position position, Sci_Position lengthRetrieve) const noexcept override {
 		cb.GetCharRange(buffer, position, lengthRetrieve);
 	}
+	const char * SCI_METHOD CharRangePointer(Sci_Position position, Sci_Position *pStart, Sci_Position *pEnd) const noexcept override {
+		return cb.CharRangePointer(position, pStart, pEnd);
+	}
 	unsigned char SCI_METHOD StyleAt(Sci_Position position) const noexcept override {
 		return cb.StyleAt(position);
 	}
@@ -474,6 +682,7 @@ public:
 	}
 	MarkerMask GetMark(Sci::Line line) const noexcept;
 	Sci::Line MarkerNext(Sci::Line lineStart, MarkerMask mask) const noexcept;
+	Sci::Line MarkerPrevious(Sci::Line lineStart, MarkerMask mask) const noexcept;
 	int AddMark(Sci::Line line, int markerNum);
 	void AddMarkSet(Sci::Line line, MarkerMask valueSet);
 	void DeleteMark(Sci::Line line, int markerNum);
@@ -518,6 +727,7 @@ public:
 	bool IsWordAt(Sci::Position start, Sci::Position end) const noexcept;
 
 	bool MatchesWordOptions(bool word, bool wordStart, Sci::Position pos, Sci::Position length) const noexcept;
+	size_t FoldSearchText(const char *search, Sci::Position lengthFind);
 	bool HasCaseFolder() const noexcept;
 	void SetCaseFolder(std::unique_ptr<CaseFolder> pcf_) noexcept;
 	Sci::Position FindText(Sci::Position minPos, Sci::Position maxPos, const char *search, Scintilla::FindOption flags, Sci::Position *length);
@@ -543,14 +753,25 @@ public:
 		return endStyled;
 	}
 	void EnsureStyledTo(Sci::Position pos);
+	void EnsureFoldedTo(Sci::Position pos);
+	void ColouriseConverging(Sci::Position start, Sci::Position end);
+	void ColouriseBatches(Sci::Position pos);
+	void ColouriseSpeculative(Sci::Position start, Sci::Position end);
 	void StyleToAdjustingLineDuration(Sci::Position pos);
 	void LexerChanged(bool hasStyles_);
+	void SetStyleWindow(Sci::Position windowSize) noexcept;
+	Sci::Position GetStyleWindow() const noexcept {
+		return styleWindow;
+	}
+	void EnsureStyleWindow(Sci::Position start, Sci::Position end);
+	void SetStyleBudget(int milliseconds) noexcept;
 	int GetStyleClock() const noexcept {
 		return styleClock;
 	}
 	void IncrementStyleClock() noexcept;
 	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) noexcept override;
 	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override;
+	void DecorationFillRanges(const Sci::Position *ranges, size_t count, int value);
 	LexInterface *GetLexInterface() const noexcept;
 	void SetLexInterface(std::unique_ptr<LexInterface> pLexInterface) noexcept;
 
@@ -591,7 +812,24 @@ public:
 	int IndentSize() const noexcept {
 		return actualIndentInChars;
 	}
-	Sci::Position BraceMatch(Sci::Position position, Sci::Position maxReStyle, Sci::Position startPos, bool useStartPos) const noexcept;
+	Sci::Position BraceScan(Sci::Position position, Sci::Position end, char chBrace, char chSeek, int styBrace, int &depth) const noexcept;
+	Sci::Position BraceMatch(Sci::Position position, Sci::Position maxDistance, Sci::Position startPos, bool useStartPos) const;
+	void TruncateBraceIndexes(Sci::Position position) noexcept;
+	void InvalidateBraceIndexes(Sci::Position start, Sci::Position end) noexcept;
+	void SetTagStyle(int style, bool tag) noexcept {
+		tagIndex.SetTagStyle(style, tag);
+	}
+	void SetVoidTags(bool caseSensitive, const char *names) {
+		tagIndex.SetVoidTags(caseSensitive, names);
+	}
+	// index tags in at most length bytes of styled text, returns true when more to index
+	bool IndexTags(Sci::Position length);
+	bool TagIndexPending() const noexcept {
+		return tagIndex.Pending(*this);
+	}
+	Sci::Position FindTag(Sci::Position position, Scintilla::TagFind which) {
+		return tagIndex.Find(*this, position, which);
+	}
 
 	bool IsAutoCompletionWordCharacter(unsigned int ch) const noexcept {
 		return WordCharacterClass(ch) == CharacterClass::word;
@@ -600,7 +838,7 @@ public:
 private:
 	void NotifyModifyAttempt() noexcept;
 	void NotifySavePoint(bool atSavePoint) noexcept;
-	void NotifyModified(DocModification mh);
+	void NotifyModified(DocModification mh, bool updateDecorations = true);
 };
 
 class UndoGroup {
@@ -668,7 +906,7 @@ public:
 		position(act.position),
 		length(act.lenData),
 		linesAdded(linesAdded_),
-		text(act.data.get()),
+		text(act.data),
 		line(0),
 		foldLevelNow(Scintilla::FoldLevel::None),
 		foldLevelPrev(Scintilla::FoldLevel::None),
@@ -691,6 +929,7 @@ public:
 	virtual void NotifyStyleNeeded(Document *doc, void *userData, Sci::Position endPos) = 0;
 	virtual void NotifyLexerChanged(Document *doc, void *userData) = 0;
 	virtual void NotifyErrorOccurred(Document *doc, void *userData, Scintilla::Status status) noexcept = 0;
+	virtual void NotifyStylingDegraded(Document *doc, void *userData, Sci::Position position) = 0;
 };
 
 }
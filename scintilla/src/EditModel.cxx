@@ -22,6 +22,8 @@
 #include <memory>
 
 #include "ScintillaTypes.h"
+#include "ScintillaMessages.h"
+#include "ScintillaStructures.h"
 #include "ILoader.h"
 #include "ILexer.h"
 
@@ -55,7 +57,7 @@ using namespace Scintilla;
 using namespace Scintilla::Internal;
 
 Caret::Caret() noexcept :
-	active(false), on(false), period(500) {}
+	active(false), on(false), period(500), timeout(0), elapsed(0) {}
 
 EditModel::EditModel() : braces{} {
 	inOverstrike = false;
@@ -15,6 +15,8 @@ public:
 	bool active;
 	bool on;
 	int period;
+	int timeout;	// stop blinking after this many milliseconds without caret movement, 0 for never
+	int elapsed;
 
 	Caret() noexcept;
 };
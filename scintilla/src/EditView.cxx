@@ -24,6 +24,7 @@
 #include <iterator>
 #include <memory>
 #include <chrono>
+#include <thread>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -36,6 +37,7 @@
 #include "Platform.h"
 #include "VectorISA.h"
 #include "GraphicUtils.h"
+#include "TraceEvents.h"
 
 #include "CharacterSet.h"
 //#include "CharacterCategory.h"
@@ -235,6 +237,8 @@ EditView::EditView() {
 	additionalCaretsVisible = true;
 	imeCaretBlockOverride = false;
 	llc.SetLevel(LineCache::Caret);
+	maxLayoutThreads = 1;
+	paintTiming = false;
 	tabArrowHeight = 4;
 	customDrawTabArrow = nullptr;
 	customDrawWrapMarker = nullptr;
@@ -256,12 +260,21 @@ bool EditView::SetPhasesDraw(int phases) noexcept {
 	return redraw;
 }
 
+void EditView::SetLayoutThreads(unsigned int threads) noexcept {
+	maxLayoutThreads = std::clamp(threads, 1U, std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+unsigned int EditView::GetLayoutThreads() const noexcept {
+	return maxLayoutThreads;
+}
+
 bool EditView::LinesOverlap() const noexcept {
 	return phasesDraw == PhasesDraw::Multiple;
 }
 
 void EditView::ClearAllTabstops() noexcept {
 	ldTabstops.reset();
+	documentTabstops.clear();
 }
 
 XYPOSITION EditView::NextTabstopPos(Sci::Line line, XYPOSITION x, XYPOSITION tabWidth) const noexcept {
@@ -271,11 +284,24 @@ XYPOSITION EditView::NextTabstopPos(Sci::Line line, XYPOSITION x, XYPOSITION tab
 	return (static_cast<int>((x + tabWidthMinimumPixels) / tabWidth) + 1) * tabWidth;
 }
 
-bool EditView::ClearTabstops(Sci::Line line) const noexcept {
+bool EditView::ClearTabstops(Sci::Line line) noexcept {
+	if (line < 0) {
+		const bool cleared = !documentTabstops.empty();
+		documentTabstops.clear();
+		return cleared;
+	}
 	return ldTabstops && ldTabstops->ClearTabstops(line);
 }
 
 bool EditView::AddTabstop(Sci::Line line, int x) {
+	if (line < 0) {
+		const auto it = std::lower_bound(documentTabstops.begin(), documentTabstops.end(), x);
+		if (it == documentTabstops.end() || *it != x) {
+			documentTabstops.insert(it, x);
+			return true;
+		}
+		return false;
+	}
 	if (!ldTabstops) {
 		ldTabstops = std::make_unique<LineTabstops>();
 	}
@@ -284,9 +310,39 @@ bool EditView::AddTabstop(Sci::Line line, int x) {
 
 int EditView::GetNextTabstop(Sci::Line line, int x) const noexcept {
 	if (ldTabstops) {
-		return ldTabstops->GetNextTabstop(line, x);
-	} else {
-		return 0;
+		const int next = ldTabstops->GetNextTabstop(line, x);
+		if (next > 0) {
+			return next;
+		}
+	}
+	const auto it = std::upper_bound(documentTabstops.begin(), documentTabstops.end(), x);
+	return (it != documentTabstops.end()) ? *it : 0;
+}
+
+/**
+* Move text after each field delimiter outside double quotes to the next explicit tab stop.
+* The gap is added to the width of the delimiter, BreakFinder ends a segment after each delimiter
+* so text after it is drawn at the moved position. Quote state is only known from start of line.
+*/
+void EditView::AlignFields(const ViewStyle &vstyle, LineLayout *ll, Range range) const noexcept {
+	const char delimiter = static_cast<char>(vstyle.fieldDelimiter);
+	const Sci::Line line = ll->LineNumber();
+	XYPOSITION shift = 0;
+	bool quoted = false;
+	for (Sci::Position i = range.start; i < range.end; i++) {
+		const char ch = ll->chars[i];
+		ll->positions[i + 1] += shift;
+		if (ch == '\"') {
+			quoted = !quoted;
+		} else if (ch == delimiter && !quoted) {
+			const XYPOSITION x = ll->positions[i + 1];
+			// first tab stop at or after x
+			const int next = GetNextTabstop(line, static_cast<int>(std::ceil(x)) - 1);
+			if (next > x) {
+				shift += next - x;
+				ll->positions[i + 1] = static_cast<XYPOSITION>(next);
+			}
+		}
 	}
 }
 
@@ -458,6 +514,12 @@ constexpr bool IsControlCharacter(unsigned char ch) noexcept {
 	return ch < 32 || ch == 127;
 }
 
+// Lines at least this long are laid out with estimated positions when not wrapped and only
+// blocks around the visible area and the caret are measured, so huge single lines open quickly.
+constexpr int longLineEstimateLength = 1024*1024;
+constexpr int longLineBlockLength = 64*1024;
+constexpr XYPOSITION longLineMeasureMargin = 4096;
+
 constexpr bool ViewIsASCII(std::string_view text) noexcept {
 	for (const unsigned char ch : text) {
 		if (ch & 0x80) {
@@ -469,12 +531,165 @@ constexpr bool ViewIsASCII(std::string_view text) noexcept {
 
 }
 
+/**
+* Determine the x position of each character in @a range of the line, the position at the start
+* of @a range should already be set. Returns whether the last segment is italic.
+*/
+bool EditView::LayoutSegments(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, Range range, Sci::Position posLineStart, PositionCache &cache) const {
+	bool lastSegItalics = false;
+
+	BreakFinder bfLayout(ll, nullptr, range, posLineStart, 0, false, model.pdoc, &model.reprs, nullptr, vstyle.fieldDelimiter);
+	while (bfLayout.More()) {
+
+		const TextSegment ts = bfLayout.Next();
+
+		std::fill(&ll->positions[ts.start + 1], &ll->positions[ts.end() + 1], 0.0f);
+		if (vstyle.styles[ll->styles[ts.start]].visible) {
+			if (ts.representation) {
+				XYPOSITION representationWidth = vstyle.controlCharWidth;
+				if (ll->chars[ts.start] == '\t') {
+					// Tab is a special case of representation, taking a variable amount of space
+					const XYPOSITION x = ll->positions[ts.start];
+					representationWidth = NextTabstopPos(ll->LineNumber(), x, vstyle.tabWidth) - ll->positions[ts.start];
+				} else {
+					if (representationWidth <= 0.0) {
+						assert(ts.representation->stringRep.length() <= Representation::maxLength);
+						XYPOSITION positionsRepr[Representation::maxLength + 1];
+						// ts.representation->stringRep is UTF-8 which only matches cache if document is UTF-8
+						// or it only contains ASCII which is a subset of all currently supported encodings.
+						if ((CpUtf8 == model.pdoc->dbcsCodePage) || ViewIsASCII(ts.representation->stringRep)) {
+							cache.MeasureWidths(surface, vstyle, StyleControlChar, ts.representation->stringRep, positionsRepr);
+						} else {
+							surface->MeasureWidthsUTF8(vstyle.styles[StyleControlChar].font.get(), ts.representation->stringRep, positionsRepr);
+						}
+						representationWidth = positionsRepr[ts.representation->stringRep.length() - 1];
+						if (FlagSet(ts.representation->appearance, RepresentationAppearance::Blob)) {
+							representationWidth += vstyle.ctrlCharPadding;
+						}
+					}
+				}
+				for (int ii = 0; ii < ts.length; ii++) {
+					ll->positions[ts.start + 1 + ii] = representationWidth;
+				}
+			} else {
+				if ((ts.length == 1) && (' ' == ll->chars[ts.start])) {
+					// Over half the segments are single characters and of these about half are space characters.
+					ll->positions[ts.start + 1] = vstyle.styles[ll->styles[ts.start]].spaceWidth;
+				} else {
+					cache.MeasureWidths(surface, vstyle, ll->styles[ts.start],
+						std::string_view(&ll->chars[ts.start], ts.length), &ll->positions[ts.start + 1]);
+				}
+			}
+			lastSegItalics = (!ts.representation) && ((ll->chars[ts.end() - 1] != ' ') && vstyle.styles[ll->styles[ts.start]].italic);
+		}
+
+		for (Sci::Position posToIncrease = ts.start + 1; posToIncrease <= ts.end(); posToIncrease++) {
+			ll->positions[posToIncrease] += ll->positions[ts.start];
+		}
+	}
+
+	if (vstyle.fieldDelimiter) {
+		AlignFields(vstyle, ll, range);
+	}
+	return lastSegItalics;
+}
+
+/**
+* Measure blocks of a very long line laid out with estimated positions: all blocks when wrapping,
+* otherwise blocks around the horizontally visible area and the block containing the main caret.
+* Blocks are only ever added so the start of a newly measured block does not move.
+*/
+void EditView::MeasureLongLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width, Sci::Position posLineStart, PositionCache &cache) const {
+	std::vector<bool> &measured = ll->measuredBlocks;
+	const int numCharsInLine = ll->numCharsInLine;
+	const int blocks = static_cast<int>(measured.size());
+	if (width != LineLayout::wrapWidthInfinite) {
+		// wrapping needs all positions, measure whole line at once instead of moving positions for each block
+		const bool lastSegItalics = LayoutSegments(model, surface, vstyle, ll, Range(0, numCharsInLine), posLineStart, cache);
+		if (lastSegItalics) {
+			ll->positions[numCharsInLine] += vstyle.lastSegItalicsOffset;
+		}
+		measured.clear();
+		return;
+	}
+	const auto blockStart = [&](int block) noexcept -> int {
+		if (block <= 0) {
+			return 0;
+		}
+		if (block >= blocks) {
+			return numCharsInLine;
+		}
+		const Sci::Position pos = model.pdoc->MovePositionOutsideChar(posLineStart + block*longLineBlockLength, 1, false);
+		return static_cast<int>(std::min<Sci::Position>(pos - posLineStart, numCharsInLine));
+	};
+	const auto blockFromPosition = [&](Sci::Position posInLine) noexcept -> int {
+		int block = static_cast<int>(std::min<Sci::Position>(posInLine / longLineBlockLength, blocks - 1));
+		if (block > 0 && posInLine < blockStart(block)) {
+			block--;
+		}
+		return block;
+	};
+	const auto measureBlock = [&](int block) -> bool {
+		if (measured[block]) {
+			return false;
+		}
+		measured[block] = true;
+		const int start = blockStart(block);
+		const int end = blockStart(block + 1);
+		const XYPOSITION endEstimated = ll->positions[end];
+		const bool lastSegItalics = LayoutSegments(model, surface, vstyle, ll, Range(start, end), posLineStart, cache);
+		if (end == numCharsInLine) {
+			if (lastSegItalics) {
+				ll->positions[end] += vstyle.lastSegItalicsOffset;
+			}
+		} else {
+			// move following characters by difference between measured and estimated width
+			const XYPOSITION delta = ll->positions[end] - endEstimated;
+			if (delta != 0) {
+				for (int i = end + 1; i <= numCharsInLine; i++) {
+					ll->positions[i] += delta;
+				}
+			}
+		}
+		return true;
+	};
+
+	const Sci::Position caretInLine = model.sel.MainCaret() - posLineStart;
+	if (caretInLine >= 0 && caretInLine <= numCharsInLine) {
+		measureBlock(blockFromPosition(caretInLine));
+	}
+	const Range rangeLine(0, numCharsInLine);
+	const XYPOSITION xStart = std::max(model.xOffset - longLineMeasureMargin, 0.0);
+	const XYPOSITION xEnd = model.xOffset + 2*longLineMeasureMargin;
+	bool changed;
+	do {
+		// measuring a block moves following blocks, so repeat until visible area is covered
+		changed = false;
+		const int first = blockFromPosition(ll->FindBefore(xStart, rangeLine));
+		const int last = blockFromPosition(ll->FindBefore(xEnd, rangeLine));
+		for (int block = first; block <= last; block++) {
+			changed |= measureBlock(block);
+		}
+	} while (changed);
+	if (std::find(measured.begin(), measured.end(), false) == measured.end()) {
+		measured.clear();
+	}
+}
+
 /**
 * Fill in the LineLayout data for the given line.
 * Copy the given @a line and its styles from the document into local arrays.
 * Also determine the x position at which each character starts.
 */
 void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width) {
+	LayoutLine(model, surface, vstyle, ll, width, posCache);
+}
+
+/**
+* Safe to call on worker threads with a separate @a surface, @a ll and @a cache for each thread,
+* as long as the document and view style are not changed.
+*/
+void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width, PositionCache &cache) const {
 	if (!ll)
 		return;
 
@@ -591,68 +806,35 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 		// Layout the line, determining the position of each character,
 		// with an extra element at the end for the end of the line.
 		ll->positions[0] = 0;
-		bool lastSegItalics = false;
-
-		BreakFinder bfLayout(ll, nullptr, Range(0, numCharsInLine), posLineStart, 0, false, model.pdoc, &model.reprs, nullptr);
-		while (bfLayout.More()) {
-
-			const TextSegment ts = bfLayout.Next();
-
-			std::fill(&ll->positions[ts.start + 1], &ll->positions[ts.end() + 1], 0.0f);
-			if (vstyle.styles[ll->styles[ts.start]].visible) {
-				if (ts.representation) {
-					XYPOSITION representationWidth = vstyle.controlCharWidth;
-					if (ll->chars[ts.start] == '\t') {
-						// Tab is a special case of representation, taking a variable amount of space
-						const XYPOSITION x = ll->positions[ts.start];
-						representationWidth = NextTabstopPos(line, x, vstyle.tabWidth) - ll->positions[ts.start];
-					} else {
-						if (representationWidth <= 0.0) {
-							assert(ts.representation->stringRep.length() <= Representation::maxLength);
-							XYPOSITION positionsRepr[Representation::maxLength + 1];
-							// ts.representation->stringRep is UTF-8 which only matches cache if document is UTF-8
-							// or it only contains ASCII which is a subset of all currently supported encodings.
-							if ((CpUtf8 == model.pdoc->dbcsCodePage) || ViewIsASCII(ts.representation->stringRep)) {
-								posCache.MeasureWidths(surface, vstyle, StyleControlChar, ts.representation->stringRep, positionsRepr);
-							} else {
-								surface->MeasureWidthsUTF8(vstyle.styles[StyleControlChar].font.get(), ts.representation->stringRep, positionsRepr);
-							}
-							representationWidth = positionsRepr[ts.representation->stringRep.length() - 1];
-							if (FlagSet(ts.representation->appearance, RepresentationAppearance::Blob)) {
-								representationWidth += vstyle.ctrlCharPadding;
-							}
-						}
-					}
-					for (int ii = 0; ii < ts.length; ii++) {
-						ll->positions[ts.start + 1 + ii] = representationWidth;
-					}
-				} else {
-					if ((ts.length == 1) && (' ' == ll->chars[ts.start])) {
-						// Over half the segments are single characters and of these about half are space characters.
-						ll->positions[ts.start + 1] = vstyle.styles[ll->styles[ts.start]].spaceWidth;
-					} else {
-						posCache.MeasureWidths(surface, vstyle, ll->styles[ts.start],
-							std::string_view(&ll->chars[ts.start], ts.length), &ll->positions[ts.start + 1]);
-					}
-				}
-				lastSegItalics = (!ts.representation) && ((ll->chars[ts.end() - 1] != ' ') && vstyle.styles[ll->styles[ts.start]].italic);
+		ll->measuredBlocks.clear();
+		if (width == LineLayout::wrapWidthInfinite && numCharsInLine >= longLineEstimateLength && !model.BidirectionalEnabled()) {
+			// Estimate positions from average character width, only the visible part is measured below.
+			const XYPOSITION aveCharWidth = vstyle.aveCharWidth;
+			for (int charInLine = 1; charInLine <= numCharsInLine; charInLine++) {
+				ll->positions[charInLine] = charInLine*aveCharWidth;
 			}
-
-			for (Sci::Position posToIncrease = ts.start + 1; posToIncrease <= ts.end(); posToIncrease++) {
-				ll->positions[posToIncrease] += ll->positions[ts.start];
+			ll->measuredBlocks.resize((numCharsInLine + longLineBlockLength - 1) / longLineBlockLength);
+		} else {
+			const bool lastSegItalics = LayoutSegments(model, surface, vstyle, ll, Range(0, numCharsInLine), posLineStart, cache);
+			// Small hack to make lines that end with italics not cut off the edge of the last character
+			if (lastSegItalics) {
+				ll->positions[numCharsInLine] += vstyle.lastSegItalicsOffset;
 			}
 		}
-
-		// Small hack to make lines that end with italics not cut off the edge of the last character
-		if (lastSegItalics) {
-			ll->positions[numCharsInLine] += vstyle.lastSegItalicsOffset;
+		int indentEnd = 0;
+		while (indentEnd < numCharsInLine && IsSpaceOrTab(ll->chars[indentEnd])) {
+			++indentEnd;
 		}
 		ll->numCharsInLine = numCharsInLine;
 		ll->numCharsBeforeEOL = numCharsBeforeEOL;
+		ll->indentEnd = indentEnd;
 		validity = LineLayout::ValidLevel::positions;
 		//const double duration = period.Duration()*1e3;
 		//printf("invalid line=%zd (%d) duration=%f\n", line + 1, lineLength, duration);
 	}
+	if (!ll->measuredBlocks.empty()) {
+		MeasureLongLine(model, surface, vstyle, ll, width, posLineStart, cache);
+	}
 	if ((validity == LineLayout::ValidLevel::positions) || (ll->widthLine != width)) {
 		ll->widthLine = width;
 		if (width == LineLayout::wrapWidthInfinite) {
@@ -681,13 +863,8 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 				break;
 			}
 			ll->wrapIndent = wrapAddIndent;
-			if (vstyle.wrap.indentMode != WrapIndentMode::Fixed) {
-				for (int i = 0; i < ll->numCharsInLine; i++) {
-					if (!IsSpaceOrTab(ll->chars[i])) {
-						ll->wrapIndent += ll->positions[i]; // Add line indent
-						break;
-					}
-				}
+			if (vstyle.wrap.indentMode != WrapIndentMode::Fixed && ll->indentEnd < ll->numCharsInLine) {
+				ll->wrapIndent += ll->positions[ll->indentEnd]; // Add line indent
 			}
 			// Check for text width minimum
 			if (ll->wrapIndent > width - static_cast<int>(aveCharWidth) * 15)
@@ -1102,6 +1279,44 @@ void EditView::DrawIndentGuide(Surface *surface, Sci::Line lineVisible, int line
 		highlight ? *pixmapIndentGuideHighlight : *pixmapIndentGuide);
 }
 
+namespace {
+
+// Call op(offset) for each space in chars[start, end).
+template <typename Op>
+void ForEachSpace(const char *chars, int start, int end, Op op) {
+	int offset = start;
+#if NP2_USE_AVX2
+	const __m256i vectSpace = _mm256_set1_epi8(' ');
+	for (; offset + static_cast<int>(sizeof(__m256i)) <= end; offset += sizeof(__m256i)) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(chars + offset));
+		uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vectSpace));
+		while (mask) {
+			op(offset + static_cast<int>(np2::ctz(mask)));
+			mask &= mask - 1;
+		}
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	const __m128i vectSpace = _mm_set1_epi8(' ');
+	for (; offset + static_cast<int>(sizeof(__m128i)) <= end; offset += sizeof(__m128i)) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars + offset));
+		uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vectSpace));
+		while (mask) {
+			op(offset + static_cast<int>(np2::ctz(mask)));
+			mask &= mask - 1;
+		}
+	}
+	// end NP2_USE_SSE2
+#endif
+	for (; offset < end; offset++) {
+		if (chars[offset] == ' ') {
+			op(offset);
+		}
+	}
+}
+
+}
+
 static void DrawTextBlob(Surface *surface, const ViewStyle &vsDraw, PRectangle rcSegment,
 	std::string_view text, ColourRGBA textBack, ColourRGBA textFore, bool fillBackground) {
 	if (rcSegment.Empty())
@@ -1184,7 +1399,7 @@ void EditView::DrawEOL(Surface *surface, const EditModel &model, const ViewStyle
 			const SelectionSegment virtualSpaceRange(SelectionPosition(model.pdoc->LineEnd(line)),
 				SelectionPosition(model.pdoc->LineEnd(line),
 					model.sel.VirtualSpaceFor(model.pdoc->LineEnd(line))));
-			for (size_t r = 0; r < model.sel.Count(); r++) {
+			for (const size_t r : model.sel.RangesTouching(virtualSpaceRange.start.Position(), virtualSpaceRange.end.Position())) {
 				const SelectionSegment portion = model.sel.Range(r).Intersect(virtualSpaceRange);
 				if (!portion.Empty()) {
 					const XYPOSITION spaceWidth = vsDraw.styles[ll->EndLineStyle()].spaceWidth;
@@ -1797,8 +2012,10 @@ void EditView::DrawCarets(Surface *surface, const EditModel &model, const ViewSt
 		return;
 	}
 	const Sci::Position posLineStart = model.pdoc->LineStart(lineDoc);
-	// For each selection draw
-	for (size_t r = 0; (r < model.sel.Count()) || drawDrag; r++) {
+	// For each selection with caret possibly on this line draw
+	const std::vector<size_t> rangesOnLine = drawDrag ? std::vector<size_t>(1, 0)
+		: model.sel.RangesTouching(posLineStart, model.pdoc->LineEnd(lineDoc));
+	for (const size_t r : rangesOnLine) {
 		const bool mainCaret = r == model.sel.Main();
 		SelectionPosition posCaret = (drawDrag ? model.posDrag : model.sel.Range(r).caret);
 		if (vsDraw.DrawCaretInsideSelection(model.inOverstrike, imeCaretBlockOverride) &&
@@ -1896,8 +2113,6 @@ void EditView::DrawCarets(Surface *surface, const EditModel &model, const ViewSt
 				}
 			}
 		}
-		if (drawDrag)
-			break;
 	}
 }
 
@@ -1940,12 +2155,12 @@ void EditView::DrawBackground(Surface *surface, const EditModel &model, const Vi
 	int subLine, std::optional<ColourRGBA> background) const {
 
 	const bool selBackDrawn = vsDraw.SelectionBackgroundDrawn();
-	bool inIndentation = subLine == 0;	// Do not handle indentation except on first subline.
+	const int indentEnd = (subLine == 0) ? ll->indentEnd : 0;	// Do not handle indentation except on first subline.
 	const XYACCUMULATOR subLineStart = ll->positions[lineRange.start];
 	// Does not take margin into account but not significant
 	const XYPOSITION xStartVisible = static_cast<XYPOSITION>(subLineStart - xStart);
 
-	BreakFinder bfBack(ll, &model.sel, lineRange, posLineStart, xStartVisible, selBackDrawn, model.pdoc, &model.reprs, nullptr);
+	BreakFinder bfBack(ll, &model.sel, lineRange, posLineStart, xStartVisible, selBackDrawn, model.pdoc, &model.reprs, nullptr, vsDraw.fieldDelimiter);
 
 	const bool drawWhitespaceBackground = vsDraw.WhitespaceBackgroundDrawn() && !background;
 
@@ -1973,33 +2188,24 @@ void EditView::DrawBackground(Surface *surface, const EditModel &model, const Vi
 			if (ts.representation) {
 				if (ll->chars[i] == '\t') {
 					// Tab display
-					if (drawWhitespaceBackground && vsDraw.WhiteSpaceVisible(inIndentation)) {
+					if (drawWhitespaceBackground && vsDraw.WhiteSpaceVisible(i < indentEnd)) {
 						textBack = vsDraw.ElementColour(Element::WhiteSpaceBack)->Opaque();
 					}
-				} else {
-					// Blob display
-					inIndentation = false;
 				}
 				surface->FillRectangleAligned(rcSegment, Fill(textBack));
 			} else {
 				// Normal text display
 				surface->FillRectangleAligned(rcSegment, Fill(textBack));
-				if (vsDraw.viewWhitespace != WhiteSpace::Invisible) {
-					for (int cpos = 0; cpos <= i - ts.start; cpos++) {
-						if (ll->chars[cpos + ts.start] == ' ') {
-							if (drawWhitespaceBackground && vsDraw.WhiteSpaceVisible(inIndentation)) {
-								const PRectangle rcSpace(
-									ll->positions[cpos + ts.start] + xStart - static_cast<XYPOSITION>(subLineStart),
-									rcSegment.top,
-									ll->positions[cpos + ts.start + 1] + xStart - static_cast<XYPOSITION>(subLineStart),
-									rcSegment.bottom);
-								surface->FillRectangleAligned(rcSpace,
-									vsDraw.ElementColour(Element::WhiteSpaceBack)->Opaque());
-							}
-						} else {
-							inIndentation = false;
+				if (drawWhitespaceBackground && vsDraw.viewWhitespace != WhiteSpace::Invisible) {
+					const ColourRGBA whiteSpaceBack = vsDraw.ElementColour(Element::WhiteSpaceBack)->Opaque();
+					const XYPOSITION xOffset = xStart - static_cast<XYPOSITION>(subLineStart);
+					ForEachSpace(ll->chars.get(), ts.start, ts.end(), [&](int offset) {
+						if (vsDraw.WhiteSpaceVisible(offset < indentEnd)) {
+							const PRectangle rcSpace(ll->positions[offset] + xOffset, rcSegment.top,
+								ll->positions[offset + 1] + xOffset, rcSegment.bottom);
+							surface->FillRectangleAligned(rcSpace, Fill(whiteSpaceBack));
 						}
-					}
+					});
 				}
 			}
 		} else if (rcSegment.left > rcLine.right) {
@@ -2061,7 +2267,7 @@ static void DrawTranslucentSelection(Surface *surface, const EditModel &model, c
 		const SelectionPosition posStart(posLineStart + lineRange.start);
 		const SelectionPosition posEnd(posLineStart + lineRange.end, virtualSpaces);
 		const SelectionSegment virtualSpaceRange(posStart, posEnd);
-		for (size_t r = 0; r < model.sel.Count(); r++) {
+		for (const size_t r : model.sel.RangesTouching(posStart.Position(), posEnd.Position())) {
 			const SelectionSegment portion = model.sel.Range(r).Intersect(virtualSpaceRange);
 			if (!portion.Empty()) {
 				const ColourRGBA selectionBack = SelectionBackground(model, vsDraw, model.sel.RangeType(r));
@@ -2150,7 +2356,7 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 
 	const bool selBackDrawn = vsDraw.SelectionBackgroundDrawn();
 	const bool drawWhitespaceBackground = vsDraw.WhitespaceBackgroundDrawn() && !background;
-	bool inIndentation = subLine == 0;	// Do not handle indentation except on first subline.
+	const int indentEnd = (subLine == 0) ? ll->indentEnd : 0;	// Do not handle indentation except on first subline.
 
 	const XYACCUMULATOR subLineStart = ll->positions[lineRange.start];
 	const XYPOSITION indentWidth = model.pdoc->IndentSize() * vsDraw.aveCharWidth;
@@ -2160,7 +2366,7 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 
 	// Foreground drawing loop
 	BreakFinder bfFore(ll, &model.sel, lineRange, posLineStart, xStartVisible,
-		(((phasesDraw == PhasesDraw::One) && selBackDrawn) || vsDraw.SelectionTextDrawn()), model.pdoc, &model.reprs, &vsDraw);
+		(((phasesDraw == PhasesDraw::One) && selBackDrawn) || vsDraw.SelectionTextDrawn()), model.pdoc, &model.reprs, &vsDraw, vsDraw.fieldDelimiter);
 
 	while (bfFore.More()) {
 
@@ -2220,6 +2426,7 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 			if (ts.representation) {
 				if (ll->chars[i] == '\t') {
 					// Tab display
+					const bool inIndentation = i < indentEnd;
 					if (phasesDraw == PhasesDraw::One) {
 						if (drawWhitespaceBackground && vsDraw.WhiteSpaceVisible(inIndentation))
 							textBack = vsDraw.ElementColour(Element::WhiteSpaceBack)->Opaque();
@@ -2249,7 +2456,6 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 						}
 					}
 				} else {
-					inIndentation = false;
 					if (vsDraw.controlCharSymbol >= 32) {
 						// Using one font for all control characters so it can be controlled independently to ensure
 						// the box goes around the characters tightly. Seems to be no way to work out what height
@@ -2284,46 +2490,46 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 							rcSegment.top + vsDraw.maxAscent, text, textFore, textBack);
 					}
 				}
-				if (vsDraw.viewWhitespace != WhiteSpace::Invisible ||
-					(inIndentation && vsDraw.viewIndentationGuides != IndentView::None)) {
-					for (int cpos = 0; cpos <= i - ts.start; cpos++) {
-						if (ll->chars[cpos + ts.start] == ' ') {
-							if (vsDraw.viewWhitespace != WhiteSpace::Invisible) {
-								if (vsDraw.WhiteSpaceVisible(inIndentation)) {
-									const XYPOSITION xmid = (ll->positions[cpos + ts.start] + ll->positions[cpos + ts.start + 1]) / 2;
-									if ((phasesDraw == PhasesDraw::One) && drawWhitespaceBackground) {
-										textBack = vsDraw.ElementColour(Element::WhiteSpaceBack)->Opaque();
-										const PRectangle rcSpace(
-											ll->positions[cpos + ts.start] + xStart - static_cast<XYPOSITION>(subLineStart),
-											rcSegment.top,
-											ll->positions[cpos + ts.start + 1] + xStart - static_cast<XYPOSITION>(subLineStart),
-											rcSegment.bottom);
-										surface->FillRectangleAligned(rcSpace, Fill(textBack));
-									}
-									const int halfDotWidth = vsDraw.whitespaceSize / 2;
-									PRectangle rcDot(xmid + xStart - halfDotWidth - static_cast<XYPOSITION>(subLineStart),
-										rcSegment.top + vsDraw.lineHeight / 2, 0.0f, 0.0f);
-									rcDot.right = rcDot.left + vsDraw.whitespaceSize;
-									rcDot.bottom = rcDot.top + vsDraw.whitespaceSize;
-									const ColourRGBA whiteSpaceFore = vsDraw.ElementColour(Element::WhiteSpace).value_or(textFore);
-									surface->FillRectangleAligned(rcDot, Fill(whiteSpaceFore));
-								}
+				const bool drawSpaces = vsDraw.viewWhitespace != WhiteSpace::Invisible;
+				const bool drawGuides = vsDraw.viewIndentationGuides == IndentView::Real && ts.start < indentEnd;
+				if (drawSpaces || drawGuides) {
+					// only spaces inside indentation are needed for guides
+					const int spaceEnd = drawSpaces ? ts.end() : std::min(ts.end(), indentEnd);
+					const XYPOSITION xOffset = xStart - static_cast<XYPOSITION>(subLineStart);
+					if (drawSpaces && (phasesDraw == PhasesDraw::One) && drawWhitespaceBackground) {
+						// fill whitespace backgrounds before dots, so fills with same colour are adjacent
+						const ColourRGBA whiteSpaceBack = vsDraw.ElementColour(Element::WhiteSpaceBack)->Opaque();
+						ForEachSpace(ll->chars.get(), ts.start, spaceEnd, [&](int offset) {
+							if (vsDraw.WhiteSpaceVisible(offset < indentEnd)) {
+								const PRectangle rcSpace(ll->positions[offset] + xOffset, rcSegment.top,
+									ll->positions[offset + 1] + xOffset, rcSegment.bottom);
+								surface->FillRectangleAligned(rcSpace, Fill(whiteSpaceBack));
 							}
-							if (inIndentation && vsDraw.viewIndentationGuides == IndentView::Real) {
-								for (int indentCount = static_cast<int>((ll->positions[cpos + ts.start] + epsilon) / indentWidth);
-									indentCount <= (ll->positions[cpos + ts.start + 1] - epsilon) / indentWidth;
-									indentCount++) {
-									if (indentCount > 0) {
-										const XYPOSITION xIndent = std::floor(indentCount * indentWidth);
-										DrawIndentGuide(surface, lineVisible, vsDraw.lineHeight, xIndent + xStart, rcSegment,
-											(ll->xHighlightGuide == xIndent));
-									}
+						});
+					}
+					const ColourRGBA whiteSpaceFore = vsDraw.ElementColour(Element::WhiteSpace).value_or(textFore);
+					const int halfDotWidth = vsDraw.whitespaceSize / 2;
+					ForEachSpace(ll->chars.get(), ts.start, spaceEnd, [&](int offset) {
+						const bool inIndentation = offset < indentEnd;
+						if (drawSpaces && vsDraw.WhiteSpaceVisible(inIndentation)) {
+							const XYPOSITION xmid = (ll->positions[offset] + ll->positions[offset + 1]) / 2;
+							PRectangle rcDot(xmid + xOffset - halfDotWidth, rcSegment.top + vsDraw.lineHeight / 2, 0.0f, 0.0f);
+							rcDot.right = rcDot.left + vsDraw.whitespaceSize;
+							rcDot.bottom = rcDot.top + vsDraw.whitespaceSize;
+							surface->FillRectangleAligned(rcDot, Fill(whiteSpaceFore));
+						}
+						if (inIndentation && drawGuides) {
+							for (int indentCount = static_cast<int>((ll->positions[offset] + epsilon) / indentWidth);
+								indentCount <= (ll->positions[offset + 1] - epsilon) / indentWidth;
+								indentCount++) {
+								if (indentCount > 0) {
+									const XYPOSITION xIndent = std::floor(indentCount * indentWidth);
+									DrawIndentGuide(surface, lineVisible, vsDraw.lineHeight, xIndent + xStart, rcSegment,
+										(ll->xHighlightGuide == xIndent));
 								}
 							}
-						} else {
-							inIndentation = false;
 						}
-					}
+					});
 				}
 			}
 			if (ll->hotspot.Valid() && vsDraw.hotspotUnderline && ll->hotspot.ContainsCharacter(iDoc)) {
@@ -2531,6 +2737,25 @@ static void DrawFoldLines(Surface *surface, const EditModel &model, const ViewSt
 	}
 }
 
+void EditView::DrawPaintTimings(Surface *surface, const ViewStyle &vsDraw, PRectangle rcText) const {
+	const PaintTimings &timings = paintTimingsShown;
+	char text[160];
+	const int length = snprintf(text, sizeof(text),
+		"total %.2f  style %.2f  wrap %.2f  layout %.2f  measure %.2f  draw %.2f ms  lines %d",
+		timings.total*1e3, timings.styling*1e3, timings.wrapping*1e3, timings.layout*1e3,
+		timings.measure*1e3, timings.draw*1e3, timings.linesLaidOut);
+	const std::string_view sv(text, std::clamp(length, 0, static_cast<int>(sizeof(text)) - 1));
+	const Style &style = vsDraw.styles[StyleDefault];
+	const XYPOSITION width = surface->WidthText(style.font.get(), sv);
+	// inverse of default style so it stands out from text
+	PRectangle rcTimings = rcText;
+	rcTimings.left = std::max(rcText.left, rcText.right - width - 2*vsDraw.aveCharWidth);
+	rcTimings.bottom = rcTimings.top + vsDraw.lineHeight;
+	surface->FillRectangleAligned(rcTimings, Fill(style.fore));
+	rcTimings.left += vsDraw.aveCharWidth;
+	surface->DrawTextNoClip(rcTimings, style.font.get(), rcTimings.top + vsDraw.maxAscent, sv, style.back, style.fore);
+}
+
 void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectangle rcArea,
 	PRectangle rcClient, const ViewStyle &vsDraw) {
 	// Allow text at start of line to overlap 1 pixel into the margin as this displays
@@ -2539,6 +2764,7 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 
 	// Do the painting
 	if (rcArea.right > vsDraw.textStart - leftTextOverlap) {
+		NP2_TRACE_START("PaintText", NP2_TRACE_INT64(static_cast<int>(rcArea.top), "top"), NP2_TRACE_INT64(static_cast<int>(rcArea.bottom), "bottom"));
 
 		Surface *surface = surfaceWindow;
 		if (bufferedDraw) {
@@ -2574,12 +2800,6 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 		}
 
 		// Loop on visible lines
-#if defined(TIME_PAINTING)
-		double durLayout = 0.0;
-		double durPaint = 0.0;
-		double durCopy = 0.0;
-		const ElapsedPeriod epWhole;
-#endif
 		const bool bracesIgnoreStyle = ((vsDraw.braceHighlightIndicatorSet && (model.bracesMatchStyle == StyleBraceLight)) ||
 			(vsDraw.braceBadLightIndicatorSet && (model.bracesMatchStyle == StyleBraceBad)));
 		const bool needDrawFoldLines = FlagSet(model.foldFlags, (FoldFlag::LineBeforeExpanded | FoldFlag::LineBeforeContracted
@@ -2628,17 +2848,16 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 
 				// Copy this line and its styles from the document into local arrays
 				// and determine the x position at which each character starts.
-#if defined(TIME_PAINTING)
 				ElapsedPeriod ep;
-#endif
 				if (lineDoc != lineDocPrevious) {
 					lineDocPrevious = lineDoc;
 					ll = RetrieveLineLayout(lineDoc, model);
 					LayoutLine(model, surface, vsDraw, ll, model.wrapWidth);
+					if (paintTiming) {
+						paintTimings.layout += ep.Duration(true);
+						paintTimings.linesLaidOut++;
+					}
 				}
-#if defined(TIME_PAINTING)
-				durLayout += ep.Duration(true);
-#endif
 				if (ll) {
 					ll->containsCaret = !hideSelection && (lineDoc == lineCaret) &&
 						(ll->lines == 1 || !vsDraw.caretLine.subLine || ll->InLine(caretOffset, subLine));
@@ -2669,9 +2888,6 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 					}
 
 					DrawLine(surface, model, vsDraw, ll, lineDoc, visibleLine, xStart, rcLine, subLine, phase);
-#if defined(TIME_PAINTING)
-					durPaint += ep.Duration(true);
-#endif
 					// Restore the previous styles for the brace highlights in case layout is in cache.
 					ll->RestoreBracesHighlight(rangeLine, model.braces, bracesIgnoreStyle);
 
@@ -2694,9 +2910,9 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 
 					lineWidthMaxSeen = std::max(
 						lineWidthMaxSeen, static_cast<int>(ll->positions[ll->numCharsInLine]));
-#if defined(TIME_PAINTING)
-					durCopy += ep.Duration();
-#endif
+					if (paintTiming) {
+						paintTimings.draw += ep.Duration();
+					}
 				}
 
 				if (!bufferedDraw) {
@@ -2707,10 +2923,6 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 				visibleLine++;
 			}
 		}
-#if defined(TIME_PAINTING)
-		if (durPaint < 0.00000001)
-			durPaint = 0.00000001;
-#endif
 		// Right column limit indicator
 		PRectangle rcBeyondEOF = (vsDraw.marginInside) ? rcClient : rcArea;
 		rcBeyondEOF.left = static_cast<XYPOSITION>(vsDraw.textStart);
@@ -2735,15 +2947,15 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 			}
 		}
 
+		if (paintTiming) {
+			DrawPaintTimings(surfaceWindow, vsDraw, rcTextArea);
+		}
+
 		if (clipping)
 			surfaceWindow->PopClip();
 
 		//Platform::DebugPrintf("start display %d, offset = %d\n", model.pdoc->Length(), model.xOffset);
-#if defined(TIME_PAINTING)
-		Platform::DebugPrintf(
-			"Layout:%9.6g    Paint:%9.6g    Ratio:%9.6g   Copy:%9.6g   Total:%9.6g\n",
-			durLayout, durPaint, durLayout / durPaint, durCopy, epWhole.Duration());
-#endif
+		NP2_TRACE_STOP("PaintText", NP2_TRACE_INT64(model.pdoc->Length(), "length"));
 	}
 }
 
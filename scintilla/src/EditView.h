@@ -48,6 +48,19 @@ typedef void (*DrawTabArrowFn)(Surface *surface, PRectangle rcTab, int ymid,
 
 class LineTabstops;
 
+/**
+* Timings in seconds of one painted frame, collected when EditView::paintTiming is set.
+*/
+struct PaintTimings {
+	double total = 0;
+	double styling = 0;
+	double wrapping = 0;
+	double layout = 0;
+	double measure = 0;
+	double draw = 0;
+	int linesLaidOut = 0;
+};
+
 /**
 * EditView draws the main text area.
 */
@@ -55,6 +68,8 @@ class EditView final {
 public:
 	PrintParameters printParameters;
 	std::unique_ptr<LineTabstops> ldTabstops;
+	// tab stops for all lines, added to line -1, used after tab stops of the line
+	std::vector<int> documentTabstops;
 	int tabWidthMinimumPixels;
 
 	bool hideSelection;
@@ -83,6 +98,12 @@ public:
 
 	LineLayoutCache llc;
 	PositionCache posCache;
+	unsigned int maxLayoutThreads;
+
+	// Diagnostic overlay showing timings of the previous frame in the top right of text area.
+	bool paintTiming;
+	PaintTimings paintTimings;
+	PaintTimings paintTimingsShown;
 
 	int tabArrowHeight; // draw arrow heads this many pixels above/below line midpoint
 	/** Some platforms, notably PLAT_CURSES, do not support Scintilla's native
@@ -106,9 +127,10 @@ public:
 
 	void ClearAllTabstops() noexcept;
 	XYPOSITION SCICALL NextTabstopPos(Sci::Line line, XYPOSITION x, XYPOSITION tabWidth) const noexcept;
-	bool ClearTabstops(Sci::Line line) const noexcept;
+	bool ClearTabstops(Sci::Line line) noexcept;
 	bool AddTabstop(Sci::Line line, int x);
 	int GetNextTabstop(Sci::Line line, int x) const noexcept;
+	void AlignFields(const ViewStyle &vstyle, LineLayout *ll, Range range) const noexcept;
 	void LinesAddedOrRemoved(Sci::Line lineOfPos, Sci::Line linesAdded) const;
 
 	void DropGraphics() noexcept;
@@ -117,6 +139,14 @@ public:
 	LineLayout *RetrieveLineLayout(Sci::Line lineNumber, const EditModel &model);
 	void LayoutLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
 		LineLayout *ll, int width = LineLayout::wrapWidthInfinite);
+	void LayoutLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, int width, PositionCache &cache) const;
+	bool LayoutSegments(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, Range range, Sci::Position posLineStart, PositionCache &cache) const;
+	void MeasureLongLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, int width, Sci::Position posLineStart, PositionCache &cache) const;
+	void SetLayoutThreads(unsigned int threads) noexcept;
+	unsigned int GetLayoutThreads() const noexcept;
 
 	static void UpdateBidiData(const EditModel &model, const ViewStyle &vstyle, LineLayout *ll);
 
@@ -151,6 +181,7 @@ public:
 		Sci::Line line, Sci::Line lineVisible, PRectangle rcLine, int xStart, int subLine) const;
 	void SCICALL DrawLine(Surface *surface, const EditModel &model, const ViewStyle &vsDraw, const LineLayout *ll, Sci::Line line,
 		Sci::Line lineVisible, int xStart, PRectangle rcLine, int subLine, DrawPhase phase);
+	void DrawPaintTimings(Surface *surface, const ViewStyle &vsDraw, PRectangle rcText) const;
 	void SCICALL PaintText(Surface *surfaceWindow, const EditModel &model, PRectangle rcArea, PRectangle rcClient,
 		const ViewStyle &vsDraw);
 	void SCICALL FillLineRemainder(Surface *surface, const EditModel &model, const ViewStyle &vsDraw, const LineLayout *ll,
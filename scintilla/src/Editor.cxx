@@ -24,6 +24,8 @@
 #include <iterator>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <thread>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -34,6 +36,7 @@
 #include "Debugging.h"
 #include "Geometry.h"
 #include "Platform.h"
+#include "TraceEvents.h"
 
 #include "CharacterSet.h"
 //#include "CharacterCategory.h"
@@ -53,6 +56,7 @@
 #include "CharClassify.h"
 #include "Decoration.h"
 #include "CaseFolder.h"
+#include "CaseConvert.h"
 #include "Document.h"
 #include "UniConversion.h"
 #include "Selection.h"
@@ -116,6 +120,208 @@ static constexpr bool IsAllSpacesOrTabs(std::string_view sv) noexcept {
 	return true;
 }
 
+namespace Scintilla::Internal {
+
+/**
+ * Background wrapping job: lays out a snapshot of lines pending wrap on worker
+ * threads, each with its own measuring surface and position cache. Chunks at the
+ * start of pending lines, at the caret and at the top of the view are laid out first.
+ * Display line counts of finished chunks are published on the UI thread, until a
+ * modification, a style change or a new wrap width makes the snapshot stale.
+ */
+class BackgroundWrapper final : public EditModel {
+public:
+	// lay out in line aligned chunks of about this size, so results are published
+	// progressively and a cancelled job stops soon.
+	static constexpr Sci::Position ChunkSize = 256*1024;
+	// a smaller remainder is wrapped on idle as usual.
+	static constexpr Sci::Position MinimumLength = 4*1024*1024;
+	// limit memory used by the snapshot, remainder is wrapped by next job.
+	static constexpr Sci::Position MaximumLength = 64*1024*1024;
+	// milliseconds to wait after last modification before taking a new snapshot.
+	static constexpr int RestartDelay = 500;
+	static constexpr int PollInterval = 50;
+
+	struct Chunk {
+		Sci::Line lineStart = 0;
+		Sci::Line lineEnd = 0;
+		std::vector<int> linesWrapped;
+		std::atomic<bool> finished = false;
+		// only accessed on UI thread
+		bool applied = false;
+	};
+
+	const Sci::Line lineStart;
+	const Sci::Line lineEnd;
+	std::atomic<bool> cancelled = false;
+	std::atomic<bool> done = false;
+	std::vector<Chunk> chunks;
+	// chunks applied from the start, only accessed on UI thread
+	size_t chunksInOrder = 0;
+
+	BackgroundWrapper(const Document &document, const ViewStyle &vs, const SpecialRepresentations &reprs_,
+		int tabWidthMinimumPixels, int wrapWidth_, Sci::Line lineStart_, Sci::Line lineEnd_);
+	void AddWorker(std::unique_ptr<Surface> surface);
+	void SetPriority(std::initializer_list<Sci::Line> lines);
+	static void Run(std::shared_ptr<BackgroundWrapper> job) noexcept;
+
+	Sci::Line TopLineOfMain() const noexcept override {
+		return 0;
+	}
+	Point GetVisibleOriginInMain() const noexcept override {
+		return Point();
+	}
+	Sci::Line LinesOnScreen() const noexcept override {
+		return 0;
+	}
+	Range GetHotSpotRange() const noexcept override {
+		return Range(Sci::invalidPosition);
+	}
+
+private:
+	// snapshot, loaded into pdoc on the worker thread
+	std::string text;
+	std::vector<unsigned char> styles;
+	ViewStyle vsWrap;
+	EditView view;
+	std::vector<std::unique_ptr<Surface>> surfaces;
+	std::vector<size_t> order;
+	std::atomic<size_t> nextChunk = 0;
+
+	void Load();
+	void LayoutChunks(Surface *surface) noexcept;
+};
+
+}
+
+BackgroundWrapper::BackgroundWrapper(const Document &document, const ViewStyle &vs, const SpecialRepresentations &reprs_,
+	int tabWidthMinimumPixels, int wrapWidth_, Sci::Line lineStart_, Sci::Line lineEnd_) :
+	lineStart{lineStart_}, lineEnd{lineEnd_}, vsWrap{vs} {
+	// not copied by ViewStyle copy constructor, fonts are shared as measuring is thread safe
+	for (size_t sty = 0; sty < vs.styles.size(); sty++) {
+		vsWrap.styles[sty].Copy(vs.styles[sty].font, vs.styles[sty]);
+	}
+	vsWrap.someStylesForceCase = vs.someStylesForceCase;
+	vsWrap.aveCharWidth = vs.aveCharWidth;
+	vsWrap.spaceWidth = vs.spaceWidth;
+	vsWrap.tabWidth = vs.tabWidth;
+	reprs = reprs_;
+	wrapWidth = wrapWidth_;
+	view.tabWidthMinimumPixels = tabWidthMinimumPixels;
+
+	// created here as code page setup is not thread safe
+	Document *doc = new Document(document.WorkerOptions());
+	doc->AddRef();
+	pdoc->Release();
+	pdoc = doc;
+	doc->SetUndoCollection(false);
+	doc->SetDBCSCodePage(document.dbcsCodePage);
+	doc->tabInChars = document.tabInChars;
+	doc->indentInChars = document.indentInChars;
+	unsigned char buffer[256 + 1]{};
+	for (const CharacterClass cc : {CharacterClass::space, CharacterClass::newLine, CharacterClass::word, CharacterClass::punctuation}) {
+		const int count = document.GetCharsOfClass(cc, buffer);
+		buffer[count] = '\0';
+		doc->SetCharClasses(buffer, cc);
+	}
+
+	const Sci::Position start = document.LineStart(lineStart);
+	const Sci::Position length = document.LineStart(lineEnd) - start;
+	text.resize(length);
+	document.GetCharRange(text.data(), start, length);
+	styles.resize(length);
+	document.GetStyleRange(styles.data(), start, length);
+
+	std::vector<Sci::Line> lines{lineStart};
+	while (lines.back() < lineEnd) {
+		const Sci::Line line = lines.back();
+		lines.push_back(std::clamp(document.SciLineFromPosition(document.LineStart(line) + ChunkSize) + 1, line + 1, lineEnd));
+	}
+	chunks = std::vector<Chunk>(lines.size() - 1);
+	for (size_t index = 0; index < chunks.size(); index++) {
+		chunks[index].lineStart = lines[index];
+		chunks[index].lineEnd = lines[index + 1];
+	}
+}
+
+void BackgroundWrapper::AddWorker(std::unique_ptr<Surface> surface) {
+	surfaces.push_back(std::move(surface));
+}
+
+void BackgroundWrapper::SetPriority(std::initializer_list<Sci::Line> lines) {
+	order.reserve(chunks.size());
+	for (const Sci::Line line : lines) {
+		const auto it = std::upper_bound(chunks.begin(), chunks.end(), line, [](Sci::Line value, const Chunk &chunk) noexcept {
+			return value < chunk.lineEnd;
+		});
+		if (it != chunks.end() && line >= it->lineStart) {
+			const size_t index = it - chunks.begin();
+			if (std::find(order.begin(), order.end(), index) == order.end()) {
+				order.push_back(index);
+			}
+		}
+	}
+	const size_t first = order.size();
+	for (size_t index = 0; index < chunks.size(); index++) {
+		if (std::find(order.begin(), order.begin() + first, index) == order.begin() + first) {
+			order.push_back(index);
+		}
+	}
+}
+
+void BackgroundWrapper::Run(std::shared_ptr<BackgroundWrapper> job) noexcept {
+	std::vector<std::thread> workers;
+	try {
+		job->Load();
+		for (size_t i = 1; i < job->surfaces.size(); i++) {
+			workers.emplace_back(&BackgroundWrapper::LayoutChunks, job.get(), job->surfaces[i].get());
+		}
+	} catch (...) {
+		// publish what has been finished
+		job->cancelled = true;
+	}
+	if (!job->cancelled) {
+		job->LayoutChunks(job->surfaces[0].get());
+	}
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	job->done.store(true, std::memory_order_release);
+}
+
+void BackgroundWrapper::Load() {
+	pdoc->InsertString(0, text.data(), text.length());
+	std::string().swap(text);
+	pdoc->StartStyling(0);
+	pdoc->SetStyles(styles.size(), styles.data());
+	std::vector<unsigned char>().swap(styles);
+}
+
+void BackgroundWrapper::LayoutChunks(Surface *surface) noexcept {
+	try {
+		PositionCache cache;
+		LineLayout ll(0, 0);
+		while (!cancelled.load(std::memory_order_relaxed)) {
+			const size_t index = nextChunk.fetch_add(1, std::memory_order_relaxed);
+			if (index >= order.size()) {
+				break;
+			}
+			Chunk &chunk = chunks[order[index]];
+			chunk.linesWrapped.resize(chunk.lineEnd - chunk.lineStart);
+			for (Sci::Line line = chunk.lineStart; line < chunk.lineEnd; line++) {
+				// snapshot starts at lineStart
+				const Sci::Line lineSnapshot = line - lineStart;
+				ll.ReSet(lineSnapshot, static_cast<int>(pdoc->LineStart(lineSnapshot + 1) - pdoc->LineStart(lineSnapshot)));
+				view.LayoutLine(*this, surface, vsWrap, &ll, wrapWidth, cache);
+				chunk.linesWrapped[line - chunk.lineStart] = ll.lines;
+			}
+			chunk.finished.store(true, std::memory_order_release);
+		}
+	} catch (...) {
+		// unfinished chunks are wrapped on idle
+	}
+}
+
 Editor::Editor() {
 	ctrlID = 0;
 
@@ -167,6 +373,7 @@ Editor::Editor() {
 	multipleSelection = false;
 	additionalSelectionTyping = false;
 	multiPasteMode = MultiPaste::Once;
+	selectionBatch = nullptr;
 	virtualSpaceOptions = VirtualSpace::None;
 
 	targetRange = SelectionSegment();
@@ -186,6 +393,7 @@ Editor::Editor() {
 	willRedrawAll = false;
 	idleStyling = IdleStyling::None;
 	needIdleStyling = false;
+	styleBudget = 0;
 
 	modEventMask = ModificationFlags::EventMaskAll;
 	commandEvents = true;
@@ -201,6 +409,9 @@ Editor::Editor() {
 }
 
 Editor::~Editor() {
+	if (backgroundWrapper) {
+		backgroundWrapper->cancelled = true;
+	}
 	pdoc->RemoveWatcher(this, nullptr);
 	DropGraphics();
 }
@@ -274,6 +485,50 @@ void Editor::InvalidateStyleRedraw() {
 	Redraw();
 }
 
+namespace {
+
+// text is measured again once zooming pauses for this many milliseconds.
+constexpr int zoomMeasureDelay = 250;
+
+}
+
+// Advances of outline fonts drawn by DirectWrite scale with font size, so cached positions
+// are scaled as a provisional layout instead of measuring all visible text at each zoom step.
+// GDI advances are hinted to whole pixels at each size, so they are measured again.
+void Editor::ZoomChanged(int zoomPrevious) {
+	if (technology != Technology::Default) {
+		const XYPOSITION ratio = static_cast<XYPOSITION>(vs.zoomLevel) / zoomPrevious;
+		stylesValid = false;
+		DropGraphics();
+		NeedWrapping();
+		view.llc.Scale(ratio);
+		view.posCache.Scale(ratio);
+		Redraw();
+		FineTickerStart(TickReason::zoom, zoomMeasureDelay, zoomMeasureDelay/10);
+	} else {
+		InvalidateStyleRedraw();
+	}
+	NotifyZoom();
+}
+
+// Colours are only used when drawing, so line layouts and cached positions are kept.
+void Editor::InvalidateColourData() {
+	stylesValid = false;
+	DropGraphics();
+}
+
+void Editor::InvalidateColourRedraw() {
+	InvalidateColourData();
+	Redraw();
+}
+
+// Used by style messages: layouts are only discarded by RefreshStyleData()
+// when the fonts, case or visibility of some style differ from the last refresh.
+void Editor::InvalidateStyleAttributes() {
+	styleLayoutPending = true;
+	InvalidateColourRedraw();
+}
+
 void Editor::RefreshStyleData() {
 	if (!stylesValid) {
 		stylesValid = true;
@@ -281,6 +536,15 @@ void Editor::RefreshStyleData() {
 		if (surface) {
 			vs.Refresh(*surface, pdoc->tabInChars);
 		}
+		std::vector<StyleLayoutKey> keys;
+		vs.GetStyleLayoutKeys(keys);
+		if (styleLayoutPending && keys != styleLayoutKeys) {
+			NeedWrapping();
+			view.llc.Invalidate(LineLayout::ValidLevel::invalid);
+			view.posCache.Clear();
+		}
+		styleLayoutPending = false;
+		styleLayoutKeys = std::move(keys);
 		SetScrollBars();
 		SetRectangularRange();
 	}
@@ -446,6 +710,9 @@ void Editor::SetTopLine(Sci::Line topLineNew) noexcept {
 	if ((topLine != topLineNew) && (topLineNew >= 0)) {
 		topLine = topLineNew;
 		ContainerNeedsUpdate(Update::VScroll);
+		if (pdoc->IsTextCompressed()) {
+			QueueIdleWork(WorkItems::packText);
+		}
 	}
 	posTopLine = pdoc->LineStart(pcs->DocFromDisplay(topLine));
 }
@@ -782,9 +1049,11 @@ void Editor::MultipleSelectAdd(AddNumber addNumber) {
 				const Sci::Position pos = pdoc->FindText(searchStart, searchEnd,
 					selectedText.c_str(), searchFlags, &lengthFound);
 				if (pos >= 0) {
-					sel.AddSelection(SelectionRange(pos + lengthFound, pos));
+					// added range is main, non-const RangeMain() would discard the selection index
+					const SelectionRange rangeFound(pos + lengthFound, pos);
+					sel.AddSelection(rangeFound);
 					ContainerNeedsUpdate(Update::Selection);
-					ScrollRange(sel.RangeMain());
+					ScrollRange(rangeFound);
 					Redraw();
 					if (addNumber == AddNumber::one)
 						return;
@@ -1438,6 +1707,7 @@ void Editor::ShowCaretAtCurrentPosition() {
 	if (hasFocus) {
 		caret.active = true;
 		caret.on = true;
+		caret.elapsed = 0;
 		FineTickerCancel(TickReason::caret);
 		if (caret.period > 0)
 			FineTickerStart(TickReason::caret, caret.period, caret.period / 10);
@@ -1459,6 +1729,7 @@ void Editor::CaretSetPeriod(int period) {
 	if (caret.period != period) {
 		caret.period = period;
 		caret.on = true;
+		caret.elapsed = 0;
 		FineTickerCancel(TickReason::caret);
 		if ((caret.active) && (caret.period > 0))
 			FineTickerStart(TickReason::caret, caret.period, caret.period / 10);
@@ -1489,6 +1760,14 @@ bool Editor::Wrapping() const noexcept {
 
 void Editor::NeedWrapping(Sci::Line docLineStart, Sci::Line docLineEnd) noexcept {
 	//Platform::DebugPrintf("\nNeedWrapping: %0d..%0d\n", docLineStart, docLineEnd);
+	if (backgroundWrapper) {
+		// snapshot is stale, delay taking a new snapshot
+		CancelBackgroundWrapping();
+		FineTickerStart(TickReason::wrap, BackgroundWrapper::RestartDelay, BackgroundWrapper::RestartDelay/10);
+	} else if (FineTickerRunning(TickReason::wrap)) {
+		// still editing
+		FineTickerStart(TickReason::wrap, BackgroundWrapper::RestartDelay, BackgroundWrapper::RestartDelay/10);
+	}
 	if (wrapPending.AddRange(docLineStart, docLineEnd)) {
 		view.llc.Invalidate(LineLayout::ValidLevel::positions);
 	}
@@ -1509,6 +1788,92 @@ bool Editor::WrapOneLine(Surface *surface, Sci::Line lineToWrap) {
 		((vs.annotationVisible != AnnotationVisible::Hidden) ? pdoc->AnnotationLines(lineToWrap) : 0));
 }
 
+namespace {
+
+// minimum bytes laid out by each thread
+constexpr Sci::Position ParallelWrapChunkSize = 256*1024;
+
+struct WrapChunk {
+	Sci::Line lineStart = 0;
+	Sci::Line lineEnd = 0;
+	Sci::Line lineDone = 0;
+	std::unique_ptr<Surface> surface;
+	std::unique_ptr<PositionCache> posCache;
+};
+
+}
+
+// Lay out lines on worker threads, each with its own measuring surface and position cache,
+// then set heights for all lines on current thread.
+bool Editor::WrapLinesParallel(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd, size_t chunkCount) {
+	const Sci::Position posStart = pdoc->LineStart(lineToWrap);
+	const Sci::Position chunkSize = (pdoc->LineStart(lineToWrapEnd) - posStart) / chunkCount;
+	std::vector<int> linesWrapped(lineToWrapEnd - lineToWrap, 1);
+	std::vector<WrapChunk> chunks(chunkCount);
+	Sci::Line lineStart = lineToWrap;
+	for (size_t i = 0; i < chunkCount; i++) {
+		WrapChunk &chunk = chunks[i];
+		const Sci::Line lineEnd = (i + 1 == chunkCount) ? lineToWrapEnd :
+			std::clamp(pdoc->SciLineFromPosition(posStart + (i + 1)*chunkSize), lineStart, lineToWrapEnd);
+		chunk.lineStart = lineStart;
+		chunk.lineDone = lineStart;
+		chunk.lineEnd = lineEnd;
+		lineStart = lineEnd;
+	}
+
+	const auto layoutChunk = [this, lineToWrap, &linesWrapped](WrapChunk *chunk, Surface *surfaceMeasure, PositionCache *cache) noexcept {
+		try {
+			LineLayout ll(chunk->lineStart, 0);
+			while (chunk->lineDone < chunk->lineEnd) {
+				const Sci::Line line = chunk->lineDone;
+				ll.ReSet(line, static_cast<int>(pdoc->LineStart(line + 1) - pdoc->LineStart(line)));
+				view.LayoutLine(*this, surfaceMeasure, vs, &ll, wrapWidth, *cache);
+				linesWrapped[line - lineToWrap] = ll.lines;
+				chunk->lineDone++;
+			}
+		} catch (const std::exception &) {
+			// remaining lines are wrapped on current thread
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(chunkCount - 1);
+	for (size_t i = 0; i + 1 < chunkCount; i++) {
+		WrapChunk &chunk = chunks[i];
+		try {
+			chunk.surface = Surface::Allocate(technology);
+			chunk.surface->Init(wMain.GetID());
+			chunk.surface->SetMode(SurfaceMode(CodePage(), BidirectionalR2L()));
+			chunk.posCache = std::make_unique<PositionCache>();
+			threads.emplace_back(layoutChunk, &chunk, chunk.surface.get(), chunk.posCache.get());
+		} catch (const std::exception &) {
+			// fallback to wrap on current thread
+			break;
+		}
+	}
+	// last chunk is laid out on current thread
+	layoutChunk(&chunks.back(), surface, &view.posCache);
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	bool wrapOccurred = false;
+	const bool annotationVisible = vs.annotationVisible != AnnotationVisible::Hidden;
+	for (const WrapChunk &chunk : chunks) {
+		for (Sci::Line line = chunk.lineStart; line < chunk.lineEnd; line++) {
+			if (line < chunk.lineDone) {
+				if (pcs->SetHeight(line, linesWrapped[line - lineToWrap] + (annotationVisible ? pdoc->AnnotationLines(line) : 0))) {
+					wrapOccurred = true;
+				}
+			} else if (WrapOneLine(surface, line)) {
+				wrapOccurred = true;
+			}
+			wrapPending.Wrapped(line);
+		}
+	}
+	return wrapOccurred;
+}
+
 // Perform  wrapping for a subset of the lines needing wrapping.
 // wsAll: wrap all lines which need wrapping in this single call
 // wsVisible: wrap currently visible lines
@@ -1545,6 +1910,9 @@ bool Editor::WrapLines(WrapScope ws) {
 #endif
 	Sci::Line goodTopLine = topLine;
 	bool wrapOccurred = false;
+	if (ws == WrapScope::wsAll || !Wrapping()) {
+		CancelBackgroundWrapping();
+	}
 	if (!Wrapping()) {
 		if (wrapWidth != LineLayout::wrapWidthInfinite) {
 			wrapWidth = LineLayout::wrapWidthInfinite;
@@ -1615,15 +1983,24 @@ bool Editor::WrapLines(WrapScope ws) {
 			if (surface) {
 				//Platform::DebugPrintf("Wraplines: scope=%0d need=%0d..%0d perform=%0d..%0d\n", ws, wrapPending.start, wrapPending.end, lineToWrap, lineToWrapEnd);
 				const Sci::Position bytesBeingWrapped = pdoc->LineStart(lineToWrapEnd) - pdoc->LineStart(lineToWrap);
+				NP2_TRACE_START("WrapLines", NP2_TRACE_INT64(lineToWrap, "lineStart"), NP2_TRACE_INT64(lineToWrapEnd, "lineEnd"),
+					NP2_TRACE_INT64(bytesBeingWrapped, "bytes"), NP2_TRACE_INT64(static_cast<int>(ws), "scope"));
 				const ElapsedPeriod epWrapping;
-				while (lineToWrap < lineToWrapEnd) {
-					if (WrapOneLine(surface, lineToWrap)) {
-						wrapOccurred = true;
+				const size_t chunkCount = std::min<size_t>(view.GetLayoutThreads(), bytesBeingWrapped / ParallelWrapChunkSize);
+				// reading packed text is not thread safe
+				if (ws != WrapScope::wsVisible && chunkCount > 1 && !pdoc->IsTextCompressed() && surface->SupportsFeature(Supports::ThreadSafeMeasureWidths)) {
+					wrapOccurred = WrapLinesParallel(surface, lineToWrap, lineToWrapEnd, chunkCount);
+				} else {
+					while (lineToWrap < lineToWrapEnd) {
+						if (WrapOneLine(surface, lineToWrap)) {
+							wrapOccurred = true;
+						}
+						wrapPending.Wrapped(lineToWrap);
+						lineToWrap++;
 					}
-					wrapPending.Wrapped(lineToWrap);
-					lineToWrap++;
 				}
 				const double duration = epWrapping.Duration();
+				NP2_TRACE_STOP("WrapLines", NP2_TRACE_INT64(wrapOccurred, "wrapOccurred"));
 #ifdef WRAP_LINES_TIMING
 				wrapTiming.Add(bytesBeingWrapped, duration);
 #endif
@@ -1657,6 +2034,127 @@ bool Editor::WrapLines(WrapScope ws) {
 	return wrapOccurred;
 }
 
+// Start laying out a large range of pending lines on background threads,
+// return true when lines are (or are about to be) wrapped in background.
+bool Editor::StartBackgroundWrapping() {
+	if (backgroundWrapper || FineTickerRunning(TickReason::wrap)) {
+		return true;
+	}
+	if (!Wrapping() || view.GetLayoutThreads() <= 1 || view.ldTabstops || !wMain.GetID()
+		|| pdoc->GetLineEndTypesActive() != LineEndType::Default) {
+		return false;
+	}
+
+	const Sci::Line lineStart = std::min(wrapPending.start, pdoc->LinesTotal());
+	Sci::Line lineEnd = std::min({wrapPending.end, pdoc->LinesTotal(), pdoc->SciLineFromPosition(pdoc->GetEndStyled())});
+	const Sci::Position posStart = pdoc->LineStart(lineStart);
+	if (pdoc->LineStart(lineEnd) - posStart > BackgroundWrapper::MaximumLength) {
+		lineEnd = std::max(pdoc->SciLineFromPosition(posStart + BackgroundWrapper::MaximumLength), lineStart + 1);
+	}
+	if (pdoc->LineStart(lineEnd) - posStart < BackgroundWrapper::MinimumLength) {
+		return false;
+	}
+
+	PRectangle rcTextArea = GetClientRectangle();
+	rcTextArea.left = static_cast<XYPOSITION>(vs.textStart);
+	rcTextArea.right -= vs.rightMarginWidth;
+	wrapWidth = static_cast<int>(rcTextArea.Width());
+	RefreshStyleData();
+
+	try {
+		auto job = std::make_shared<BackgroundWrapper>(*pdoc, vs, reprs, view.tabWidthMinimumPixels, wrapWidth, lineStart, lineEnd);
+		const Sci::Line lineCaret = pdoc->SciLineFromPosition(sel.MainCaret());
+		job->SetPriority({lineStart, lineCaret, pcs->DocFromDisplay(topLine)});
+		// current thread is kept for user interaction
+		const unsigned int workers = std::max(view.GetLayoutThreads() - 1, 1U);
+		for (unsigned int i = 0; i < workers; i++) {
+			std::unique_ptr<Surface> surface = Surface::Allocate(technology);
+			surface->Init(wMain.GetID());
+			surface->SetMode(SurfaceMode(CodePage(), BidirectionalR2L()));
+			if (!surface->SupportsFeature(Supports::ThreadSafeMeasureWidths)) {
+				return false;
+			}
+			job->AddWorker(std::move(surface));
+		}
+		std::thread thread(BackgroundWrapper::Run, job);
+		thread.detach();
+		backgroundWrapper = std::move(job);
+	} catch (const std::exception &) {
+		// fallback to wrap on idle
+		return false;
+	}
+	FineTickerStart(TickReason::wrap, BackgroundWrapper::PollInterval, BackgroundWrapper::PollInterval/10);
+	return true;
+}
+
+// Set heights for lines laid out in background, keep top document line in place.
+void Editor::PublishBackgroundWrapping() {
+	if (!backgroundWrapper) {
+		// restart delay expired
+		FineTickerCancel(TickReason::wrap);
+		SetIdle(true);
+		return;
+	}
+
+	BackgroundWrapper &job = *backgroundWrapper;
+	const bool done = job.done.load(std::memory_order_acquire);
+	const Sci::Line lineDocTop = pcs->DocFromDisplay(topLine);
+	const Sci::Line subLineTop = topLine - pcs->DisplayFromDoc(lineDocTop);
+	const bool annotationVisible = vs.annotationVisible != AnnotationVisible::Hidden;
+	bool wrapOccurred = false;
+	bool finished = true;
+	for (BackgroundWrapper::Chunk &chunk : job.chunks) {
+		if (chunk.applied) {
+			continue;
+		}
+		if (!chunk.finished.load(std::memory_order_acquire)) {
+			finished = false;
+			continue;
+		}
+		for (Sci::Line line = chunk.lineStart; line < chunk.lineEnd; line++) {
+			if (pcs->SetHeight(line, chunk.linesWrapped[line - chunk.lineStart] + (annotationVisible ? pdoc->AnnotationLines(line) : 0))) {
+				wrapOccurred = true;
+			}
+		}
+		chunk.applied = true;
+		std::vector<int>().swap(chunk.linesWrapped);
+	}
+	while (job.chunksInOrder < job.chunks.size() && job.chunks[job.chunksInOrder].applied) {
+		const BackgroundWrapper::Chunk &chunk = job.chunks[job.chunksInOrder];
+		if (wrapPending.start >= chunk.lineStart) {
+			wrapPending.start = std::max(wrapPending.start, chunk.lineEnd);
+		}
+		job.chunksInOrder++;
+	}
+
+	if (wrapOccurred) {
+		SetScrollBars();
+		const Sci::Line goodTopLine = pcs->DisplayFromDoc(lineDocTop) + std::min(
+			subLineTop, static_cast<Sci::Line>(pcs->GetHeight(lineDocTop) - 1));
+		SetTopLine(std::clamp<Sci::Line>(goodTopLine, 0, MaxScrollPos()));
+		SetVerticalScrollPos();
+		Redraw();
+	}
+
+	if (finished || done) {
+		CancelBackgroundWrapping();
+		if (wrapPending.start >= std::min(wrapPending.end, pdoc->LinesTotal())) {
+			wrapPending.Reset();
+		} else {
+			// remaining lines are wrapped by next job or on idle
+			SetIdle(true);
+		}
+	}
+}
+
+void Editor::CancelBackgroundWrapping() noexcept {
+	if (backgroundWrapper) {
+		backgroundWrapper->cancelled = true;
+		backgroundWrapper.reset();
+	}
+	FineTickerCancel(TickReason::wrap);
+}
+
 void Editor::LinesJoin() {
 	if (!RangeContainsProtected(targetRange.start.Position(), targetRange.end.Position())) {
 		UndoGroup ug(pdoc);
@@ -1788,7 +2286,16 @@ void Editor::Paint(Surface *surfaceWindow, PRectangle rcArea) {
 
 	paintAbandonedByStyling = false;
 
+	const ElapsedPeriod epPaint;
+	const double measureTimeStart = view.posCache.GetStatistics().measureTime;
+	if (view.paintTiming) {
+		view.paintTimings = {};
+	}
+
 	StyleAreaBounded(rcArea, false);
+	if (view.paintTiming) {
+		view.paintTimings.styling = epPaint.Duration();
+	}
 
 	const PRectangle rcClient = GetClientRectangle();
 	//Platform::DebugPrintf("Client: (%.0f,%.0f) ... (%.0f,%.0f)\n",
@@ -1800,7 +2307,12 @@ void Editor::Paint(Surface *surfaceWindow, PRectangle rcArea) {
 	}
 
 	// Wrap the visible lines if needed.
-	if (WrapLines(WrapScope::wsVisible)) {
+	const ElapsedPeriod epWrapping;
+	const bool wrapped = WrapLines(WrapScope::wsVisible);
+	if (view.paintTiming) {
+		view.paintTimings.wrapping = epWrapping.Duration();
+	}
+	if (wrapped) {
 		// The wrapping process has changed the height of some lines so
 		// abandon this paint for a complete repaint.
 		if (AbandonPaint()) {
@@ -1865,6 +2377,12 @@ void Editor::Paint(Surface *surfaceWindow, PRectangle rcArea) {
 	if (!view.bufferedDraw)
 		surfaceWindow->PopClip();
 
+	if (view.paintTiming) {
+		view.paintTimings.measure = view.posCache.GetStatistics().measureTime - measureTimeStart;
+		view.paintTimings.total = epPaint.Duration();
+		view.paintTimingsShown = view.paintTimings;
+	}
+
 	NotifyPainted();
 }
 
@@ -1956,6 +2474,108 @@ SelectionPosition Editor::RealizeVirtualSpace(SelectionPosition position) {
 	return SelectionPosition(RealizeVirtualSpace(position.Position(), position.VirtualSpace()));
 }
 
+// Replace the ranges of a rectangular selection with text (or only delete them) as a single
+// document change instead of a change for each line. Returns false when ranges need to be
+// edited one by one, document and selection are not changed in that case.
+bool Editor::ReplaceRectangularSelection(std::string_view text, bool realizeVirtualSpace) {
+	const size_t count = sel.Count();
+	if (!sel.IsRectangular() || count < 2 || inOverstrike || pdoc->IsReadOnly()) {
+		return false;
+	}
+
+	std::vector<SelectionRange *> ranges;
+	ranges.reserve(count);
+	for (size_t r = 0; r < count; r++) {
+		ranges.push_back(&sel.Range(r));
+	}
+	std::sort(ranges.begin(), ranges.end(),
+		[](const SelectionRange *a, const SelectionRange *b) noexcept { return *a < *b; });
+
+	std::vector<SelectionRange> rangesNew;
+	std::vector<TextReplacement> replacements;
+	std::string textInsert;
+	rangesNew.reserve(count);
+	Sci::Position lengthChange = 0;
+	Sci::Position endPrevious = 0;
+	for (const SelectionRange *current : ranges) {
+		SelectionRange range = *current;
+		Sci::Position position = range.Start().Position();
+		Sci::Position deleteLength = range.Length();
+		const Sci::Position endRange = position + deleteLength;
+		if (position < endPrevious || RangeContainsProtected(position, endRange)) {
+			return false;
+		}
+		if (!realizeVirtualSpace) {
+			// same as ClearSelection(), virtual space at start is kept
+			if (!range.Empty()) {
+				range = SelectionRange(range.Start());
+			}
+			range.caret.Add(lengthChange);
+			range.anchor.Add(lengthChange);
+			if (deleteLength != 0) {
+				replacements.push_back({position, deleteLength, 0, nullptr});
+				lengthChange -= deleteLength;
+			}
+		} else {
+			// same as InsertCharacter()
+			if (!range.Empty()) {
+				if (deleteLength != 0) {
+					range.ClearVirtualSpace();
+				} else {
+					range.MinimizeVirtualSpace();
+				}
+			}
+			const size_t offset = textInsert.length();
+			const Sci::Position virtualSpace = range.caret.VirtualSpace();
+			if (virtualSpace > 0) {
+				const Sci::Line line = pdoc->SciLineFromPosition(position);
+				if (pdoc->GetLineIndentPosition(line) == position) {
+					// see RealizeVirtualSpace()
+					const Sci::Position lineStart = pdoc->LineStart(line);
+					if (lineStart < endPrevious) {
+						return false;
+					}
+					textInsert += pdoc->IndentationText(pdoc->GetLineIndentation(line) + virtualSpace);
+					deleteLength += position - lineStart;
+					position = lineStart;
+				} else {
+					textInsert.append(virtualSpace, ' ');
+				}
+			}
+			textInsert += text;
+			const Sci::Position insertLength = textInsert.length() - offset;
+			if (deleteLength != 0 || insertLength != 0) {
+				replacements.push_back({position, deleteLength, insertLength, nullptr});
+			}
+			range = SelectionRange(position + lengthChange + insertLength);
+			lengthChange += insertLength - deleteLength;
+		}
+		rangesNew.push_back(range);
+		endPrevious = endRange;
+	}
+
+	if (!replacements.empty()) {
+		// inserted text is stored in order of replacements
+		const char *ptr = textInsert.data();
+		for (TextReplacement &replacement : replacements) {
+			replacement.text = ptr;
+			ptr += replacement.insertLength;
+		}
+		const bool caretFirst = sel.Rectangular().caret < sel.Rectangular().anchor;
+		pdoc->ReplaceRanges(replacements.data(), replacements.size());
+		// rectangular range is moved into the changed span, restore its direction
+		if (caretFirst) {
+			sel.Rectangular() = SelectionRange(rangesNew.front().caret, rangesNew.back().anchor);
+		} else {
+			sel.Rectangular() = SelectionRange(rangesNew.back().caret, rangesNew.front().anchor);
+		}
+	}
+	for (size_t index = 0; index < count; index++) {
+		*ranges[index] = rangesNew[index];
+	}
+	return true;
+}
+
 void Editor::AddChar(char ch) {
 	const char s[2] = { ch, '\0' };
 	InsertCharacter(std::string_view(s, 1), CharacterSource::DirectInput);
@@ -2000,76 +2620,70 @@ void Editor::InsertCharacter(std::string_view sv, CharacterSource charSource) {
 		const char encloseCh = (charSource != CharacterSource::DirectInput || sv.length() != 1
 			|| sel.IsRectangular() || sel.Empty()) ? '\0' : EncloseSelectionCharacter(sv[0]);
 
-		// Vector elements point into selection in order to change selection.
-		std::vector<SelectionRange *> selPtrs;
-		for (size_t r = 0; r < sel.Count(); r++) {
-			selPtrs.push_back(&sel.Range(r));
-		}
-		// Order selections by position in document.
-		std::sort(selPtrs.begin(), selPtrs.end(),
-			[](const SelectionRange *a, const SelectionRange *b) noexcept { return *a < *b; });
-
-		// Loop in reverse to avoid disturbing positions of selections yet to be processed.
-		for (auto rit = selPtrs.rbegin(); rit != selPtrs.rend(); ++rit) {
-			SelectionRange *currentSel = *rit;
-			if (!RangeContainsProtected(currentSel->Start().Position(),
-				currentSel->End().Position())) {
-				Sci::Position positionInsert = currentSel->Start().Position();
-				std::string text;
-				bool forward = false;
-				if (!currentSel->Empty()) {
-					const Sci::Position selectionLength = currentSel->Length();
-					if (selectionLength) {
-						if (encloseCh) {
-							forward = currentSel->anchor < currentSel->caret;
-							text.resize(selectionLength + 2);
-							text[0] = sv[0];
-							pdoc->GetCharRange(text.data() + 1, positionInsert, selectionLength);
-							text[selectionLength + 1] = encloseCh;
-						}
-						pdoc->DeleteChars(positionInsert, selectionLength);
-						currentSel->ClearVirtualSpace();
-					} else {
-						// Range is all virtual so collapse to start of virtual space
-						currentSel->MinimizeVirtualSpace();
-					}
-				} else if (inOverstrike) {
-					if (positionInsert < pdoc->Length()) {
-						if (!pdoc->IsPositionInLineEnd(positionInsert)) {
-							pdoc->DelChar(positionInsert);
+		if (!ReplaceRectangularSelection(sv, true)) {
+			// Loop in reverse to avoid disturbing positions of selections yet to be processed.
+			SelectionBatch batch(sel, selectionBatch);
+			for (size_t index = batch.Count(); index-- > 0;) {
+				SelectionRange *currentSel = &batch.Edit(index);
+				if (!RangeContainsProtected(currentSel->Start().Position(),
+					currentSel->End().Position())) {
+					Sci::Position positionInsert = currentSel->Start().Position();
+					std::string text;
+					bool forward = false;
+					if (!currentSel->Empty()) {
+						const Sci::Position selectionLength = currentSel->Length();
+						if (selectionLength) {
+							if (encloseCh) {
+								forward = currentSel->anchor < currentSel->caret;
+								text.resize(selectionLength + 2);
+								text[0] = sv[0];
+								pdoc->GetCharRange(text.data() + 1, positionInsert, selectionLength);
+								text[selectionLength + 1] = encloseCh;
+							}
+							pdoc->DeleteChars(positionInsert, selectionLength);
 							currentSel->ClearVirtualSpace();
+						} else {
+							// Range is all virtual so collapse to start of virtual space
+							currentSel->MinimizeVirtualSpace();
+						}
+					} else if (inOverstrike) {
+						if (positionInsert < pdoc->Length()) {
+							if (!pdoc->IsPositionInLineEnd(positionInsert)) {
+								pdoc->DelChar(positionInsert);
+								currentSel->ClearVirtualSpace();
+							}
 						}
 					}
-				}
-				positionInsert = RealizeVirtualSpace(positionInsert, currentSel->caret.VirtualSpace());
-				if (text.empty()) {
-					const Sci::Position lengthInserted = pdoc->InsertString(positionInsert, sv.data(), sv.length());
-					if (lengthInserted > 0) {
-						currentSel->caret.SetPosition(positionInsert + lengthInserted);
-						currentSel->anchor.SetPosition(positionInsert + lengthInserted);
-					}
-				} else {
-					const Sci::Position lengthInserted = pdoc->InsertString(positionInsert, text.data(), text.length());
-					if (lengthInserted > 0) {
-						handled = true;
-						if (forward) {
-							currentSel->caret.SetPosition(positionInsert + lengthInserted - 1);
-							currentSel->anchor.SetPosition(positionInsert + 1);
-						} else {
-							currentSel->caret.SetPosition(positionInsert + 1);
-							currentSel->anchor.SetPosition(positionInsert + lengthInserted - 1);
+					positionInsert = RealizeVirtualSpace(positionInsert, currentSel->caret.VirtualSpace());
+					if (text.empty()) {
+						const Sci::Position lengthInserted = pdoc->InsertString(positionInsert, sv.data(), sv.length());
+						if (lengthInserted > 0) {
+							currentSel->caret.SetPosition(positionInsert + lengthInserted);
+							currentSel->anchor.SetPosition(positionInsert + lengthInserted);
+						}
+					} else {
+						const Sci::Position lengthInserted = pdoc->InsertString(positionInsert, text.data(), text.length());
+						if (lengthInserted > 0) {
+							handled = true;
+							if (forward) {
+								currentSel->caret.SetPosition(positionInsert + lengthInserted - 1);
+								currentSel->anchor.SetPosition(positionInsert + 1);
+							} else {
+								currentSel->caret.SetPosition(positionInsert + 1);
+								currentSel->anchor.SetPosition(positionInsert + lengthInserted - 1);
+							}
 						}
 					}
-				}
-				currentSel->ClearVirtualSpace();
-				// If in wrap mode rewrap current line so EnsureCaretVisible has accurate information
-				if (Wrapping()) {
-					AutoSurface surface(this);
-					if (surface) {
-						if (WrapOneLine(surface, pdoc->SciLineFromPosition(positionInsert))) {
-							SetScrollBars();
-							SetVerticalScrollPos();
-							Redraw();
+					currentSel->ClearVirtualSpace();
+					// If in wrap mode rewrap current line so EnsureCaretVisible has accurate information
+					if (Wrapping()) {
+						AutoSurface surface(this);
+						if (surface) {
+							if (WrapOneLine(surface, pdoc->SciLineFromPosition(positionInsert))) {
+								SetScrollBars();
+								SetVerticalScrollPos();
+								Redraw();
+							}
 						}
 					}
 				}
@@ -2122,21 +2736,23 @@ void Editor::ClearBeforeTentativeStart() {
 	// Make positions for the first composition string.
 	FilterSelections();
 	UndoGroup ug(pdoc, (sel.Count() > 1) || !sel.Empty() || inOverstrike);
-	for (size_t r = 0; r < sel.Count(); r++) {
-		if (!RangeContainsProtected(sel.Range(r).Start().Position(),
-			sel.Range(r).End().Position())) {
-			const Sci::Position positionInsert = sel.Range(r).Start().Position();
-			if (!sel.Range(r).Empty()) {
-				if (sel.Range(r).Length()) {
-					pdoc->DeleteChars(positionInsert, sel.Range(r).Length());
-					sel.Range(r).ClearVirtualSpace();
+	SelectionBatch batch(sel, selectionBatch);
+	for (size_t index = batch.Count(); index-- > 0;) {
+		SelectionRange &range = batch.Edit(index);
+		if (!RangeContainsProtected(range.Start().Position(),
+			range.End().Position())) {
+			const Sci::Position positionInsert = range.Start().Position();
+			if (!range.Empty()) {
+				if (range.Length()) {
+					pdoc->DeleteChars(positionInsert, range.Length());
+					range.ClearVirtualSpace();
 				} else {
 					// Range is all virtual so collapse to start of virtual space
-					sel.Range(r).MinimizeVirtualSpace();
+					range.MinimizeVirtualSpace();
 				}
 			}
-			RealizeVirtualSpace(positionInsert, sel.Range(r).caret.VirtualSpace());
-			sel.Range(r).ClearVirtualSpace();
+			RealizeVirtualSpace(positionInsert, range.caret.VirtualSpace());
+			range.ClearVirtualSpace();
 		}
 	}
 }
@@ -2151,26 +2767,28 @@ void Editor::InsertPaste(const char *text, Sci::Position len) {
 		}
 	} else {
 		// MultiPaste::Each
-		for (size_t r = 0; r < sel.Count(); r++) {
-			if (!RangeContainsProtected(sel.Range(r).Start().Position(),
-				sel.Range(r).End().Position())) {
-				Sci::Position positionInsert = sel.Range(r).Start().Position();
-				if (!sel.Range(r).Empty()) {
-					if (sel.Range(r).Length()) {
-						pdoc->DeleteChars(positionInsert, sel.Range(r).Length());
-						sel.Range(r).ClearVirtualSpace();
+		SelectionBatch batch(sel, selectionBatch);
+		for (size_t index = batch.Count(); index-- > 0;) {
+			SelectionRange &range = batch.Edit(index);
+			if (!RangeContainsProtected(range.Start().Position(),
+				range.End().Position())) {
+				Sci::Position positionInsert = range.Start().Position();
+				if (!range.Empty()) {
+					if (range.Length()) {
+						pdoc->DeleteChars(positionInsert, range.Length());
+						range.ClearVirtualSpace();
 					} else {
 						// Range is all virtual so collapse to start of virtual space
-						sel.Range(r).MinimizeVirtualSpace();
+						range.MinimizeVirtualSpace();
 					}
 				}
-				positionInsert = RealizeVirtualSpace(positionInsert, sel.Range(r).caret.VirtualSpace());
+				positionInsert = RealizeVirtualSpace(positionInsert, range.caret.VirtualSpace());
 				const Sci::Position lengthInserted = pdoc->InsertString(positionInsert, text, len);
 				if (lengthInserted > 0) {
-					sel.Range(r).caret.SetPosition(positionInsert + lengthInserted);
-					sel.Range(r).anchor.SetPosition(positionInsert + lengthInserted);
+					range.caret.SetPosition(positionInsert + lengthInserted);
+					range.anchor.SetPosition(positionInsert + lengthInserted);
 				}
-				sel.Range(r).ClearVirtualSpace();
+				range.ClearVirtualSpace();
 			}
 		}
 	}
@@ -2210,18 +2828,22 @@ void Editor::ClearSelection(bool retainMultipleSelections) {
 	if (!sel.IsRectangular() && !retainMultipleSelections)
 		FilterSelections();
 	UndoGroup ug(pdoc);
-	for (size_t r = 0; r < sel.Count(); r++) {
-		if (!sel.Range(r).Empty()) {
-			SelectionRange rangeNew = sel.Range(r);
-			if (sel.selType == Selection::SelTypes::lines && sel.Count() == 1) {
-				// remove EOLs
-				rangeNew = LineSelectionRange(rangeNew.caret, rangeNew.anchor, true);
-			}
-			if (!RangeContainsProtected(rangeNew.Start().Position(),
-				rangeNew.End().Position())) {
-				pdoc->DeleteChars(rangeNew.Start().Position(),
-					rangeNew.Length());
-				sel.Range(r) = SelectionRange(rangeNew.Start());
+	if (!ReplaceRectangularSelection({}, false)) {
+		SelectionBatch batch(sel, selectionBatch);
+		for (size_t index = batch.Count(); index-- > 0;) {
+			SelectionRange &range = batch.Edit(index);
+			if (!range.Empty()) {
+				SelectionRange rangeNew = range;
+				if (sel.selType == Selection::SelTypes::lines && sel.Count() == 1) {
+					// remove EOLs
+					rangeNew = LineSelectionRange(rangeNew.caret, rangeNew.anchor, true);
+				}
+				if (!RangeContainsProtected(rangeNew.Start().Position(),
+					rangeNew.End().Position())) {
+					pdoc->DeleteChars(rangeNew.Start().Position(),
+						rangeNew.Length());
+					range = SelectionRange(rangeNew.Start());
+				}
 			}
 		}
 	}
@@ -2338,21 +2960,23 @@ void Editor::Clear() {
 			singleVirtual = true;
 		}
 		UndoGroup ug(pdoc, (sel.Count() > 1) || singleVirtual);
-		for (size_t r = 0; r < sel.Count(); r++) {
-			const Sci::Position caretPosition = sel.Range(r).caret.Position();
+		SelectionBatch batch(sel, selectionBatch);
+		for (size_t index = batch.Count(); index-- > 0;) {
+			SelectionRange &range = batch.Edit(index);
+			const Sci::Position caretPosition = range.caret.Position();
 			if (!RangeContainsProtected(caretPosition, caretPosition + 1)) {
-				if (sel.Range(r).Start().VirtualSpace()) {
-					if (sel.Range(r).anchor < sel.Range(r).caret)
-						sel.Range(r) = SelectionRange(RealizeVirtualSpace(caretPosition, sel.Range(r).anchor.VirtualSpace()));
+				if (range.Start().VirtualSpace()) {
+					if (range.anchor < range.caret)
+						range = SelectionRange(RealizeVirtualSpace(caretPosition, range.anchor.VirtualSpace()));
 					else
-						sel.Range(r) = SelectionRange(RealizeVirtualSpace(caretPosition, sel.Range(r).caret.VirtualSpace()));
+						range = SelectionRange(RealizeVirtualSpace(caretPosition, range.caret.VirtualSpace()));
 				}
 				if ((sel.Count() == 1) || !pdoc->IsPositionInLineEnd(caretPosition)) {
 					pdoc->DelChar(caretPosition);
-					sel.Range(r).ClearVirtualSpace();
+					range.ClearVirtualSpace();
 				}  // else multiple selection so don't eat line ends
 			} else {
-				sel.Range(r).ClearVirtualSpace();
+				range.ClearVirtualSpace();
 			}
 		}
 	} else {
@@ -2431,26 +3055,30 @@ void Editor::DelCharBack(bool allowLineStartDeletion) {
 		allowLineStartDeletion = false;
 	UndoGroup ug(pdoc, (sel.Count() > 1) || !sel.Empty());
 	if (sel.Empty()) {
-		for (size_t r = 0; r < sel.Count(); r++) {
-			const Sci::Position caretPosition = sel.Range(r).caret.Position();
-			if (!RangeContainsProtected(caretPosition - 1, caretPosition)) {
-				if (sel.Range(r).caret.VirtualSpace()) {
-					sel.Range(r).caret.SetVirtualSpace(sel.Range(r).caret.VirtualSpace() - 1);
-					sel.Range(r).anchor.SetVirtualSpace(sel.Range(r).caret.VirtualSpace());
-				} else {
-					const Sci::Line lineCurrentPos = pdoc->SciLineFromPosition(caretPosition);
-					if (allowLineStartDeletion || (pdoc->LineStart(lineCurrentPos) != caretPosition)) {
-						Sci::Position posSelect;
-						if (BackspaceUnindent(lineCurrentPos, caretPosition, &posSelect)) {
-							// SetEmptySelection
-							sel.Range(r) = SelectionRange(posSelect);
-						} else {
-							pdoc->DelCharBack(caretPosition);
+		{
+			SelectionBatch batch(sel, selectionBatch);
+			for (size_t index = batch.Count(); index-- > 0;) {
+				SelectionRange &range = batch.Edit(index);
+				const Sci::Position caretPosition = range.caret.Position();
+				if (!RangeContainsProtected(caretPosition - 1, caretPosition)) {
+					if (range.caret.VirtualSpace()) {
+						range.caret.SetVirtualSpace(range.caret.VirtualSpace() - 1);
+						range.anchor.SetVirtualSpace(range.caret.VirtualSpace());
+					} else {
+						const Sci::Line lineCurrentPos = pdoc->SciLineFromPosition(caretPosition);
+						if (allowLineStartDeletion || (pdoc->LineStart(lineCurrentPos) != caretPosition)) {
+							Sci::Position posSelect;
+							if (BackspaceUnindent(lineCurrentPos, caretPosition, &posSelect)) {
+								// SetEmptySelection
+								range = SelectionRange(posSelect);
+							} else {
+								pdoc->DelCharBack(caretPosition);
+							}
 						}
 					}
+				} else {
+					range.ClearVirtualSpace();
 				}
-			} else {
-				sel.Range(r).ClearVirtualSpace();
 			}
 		}
 		ThinRectangularRange();
@@ -2491,6 +3119,14 @@ void Editor::NotifyErrorOccurred(Document *, void *, Status status) noexcept {
 	errorStatus = status;
 }
 
+void Editor::NotifyStylingDegraded(Document *, void *, Sci::Position position) {
+	NotificationData scn = {};
+	scn.nmhdr.code = Notification::StylingDegraded;
+	scn.position = position;
+	scn.line = pdoc->SciLineFromPosition(position);
+	NotifyParent(scn);
+}
+
 void Editor::NotifyChar(int ch, CharacterSource charSource) noexcept {
 	NotificationData scn = {};
 	scn.nmhdr.code = Notification::CharAdded;
@@ -2679,7 +3315,10 @@ void Editor::CheckModificationForWrap(DocModification mh) {
 	if (FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText)) {
 		view.llc.Invalidate(LineLayout::ValidLevel::checkTextAndStyle);
 		const Sci::Line lineDoc = pdoc->SciLineFromPosition(mh.position);
-		const Sci::Line lines = std::max<Sci::Line>(0, mh.linesAdded);
+		// inserted text may span lines without adding any, see Document::ReplaceRanges()
+		const Sci::Line lines = FlagSet(mh.modificationType, ModificationFlags::InsertText)
+			? (pdoc->SciLineFromPosition(mh.position + mh.length) - lineDoc)
+			: std::max<Sci::Line>(0, mh.linesAdded);
 		if (Wrapping()) {
 			NeedWrapping(lineDoc, lineDoc + lines + 1);
 		}
@@ -2716,9 +3355,49 @@ constexpr Sci::Position MovePositionForDeletion(Sci::Position position, Sci::Pos
 
 }
 
+size_t Editor::MemoryUsage(Scintilla::MemoryUsage usage) const noexcept {
+	switch (usage) {
+	case Scintilla::MemoryUsage::Total: {
+		size_t bytes = 0;
+		for (int part = static_cast<int>(Scintilla::MemoryUsage::Text); part <= static_cast<int>(Scintilla::MemoryUsage::PositionCache); part++) {
+			bytes += MemoryUsage(static_cast<Scintilla::MemoryUsage>(part));
+		}
+		return bytes;
+	}
+	case Scintilla::MemoryUsage::LineData:
+		return pdoc->MemoryUsage(usage) + (view.ldTabstops ? view.ldTabstops->MemoryUsage() : 0);
+	case Scintilla::MemoryUsage::LayoutCache:
+		return view.llc.MemoryUsage();
+	case Scintilla::MemoryUsage::PositionCache:
+		return view.posCache.MemoryUsage();
+	default:
+		return pdoc->MemoryUsage(usage);
+	}
+}
+
+void Editor::MoveSelections(bool insertion, Sci::Position startChange, Sci::Position length) noexcept {
+	if (selectionBatch) {
+		selectionBatch->MovePositions(insertion, startChange, length);
+		if (sel.selType == Selection::SelTypes::rectangle) {
+			sel.Rectangular().MoveForInsertDelete(insertion, startChange, length);
+		}
+	} else {
+		sel.MovePositions(insertion, startChange, length);
+	}
+}
+
 void Editor::NotifyModified(Document *, DocModification mh, void *) {
+	if (FlagSet(mh.modificationType, ModificationFlags::BulkModification)) {
+		NotifyBulkModified(mh);
+		return;
+	}
+	// redraw, scroll bars and text notifications are deferred to the end of bulk modification
+	const bool bulk = pdoc->InBulkModification();
 	if (FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText)) {
 		ContainerNeedsUpdate(Update::Content);
+		if (pdoc->IsTextCompressed()) {
+			QueueIdleWork(WorkItems::packText);
+		}
 	}
 	if (paintState == PaintState::painting) {
 		CheckForChangeOutsidePaint(Range(mh.position, mh.position + mh.length));
@@ -2763,11 +3442,11 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 	} else {
 		// Move selection and brace highlights
 		if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
-			sel.MovePositions(true, mh.position, mh.length);
+			MoveSelections(true, mh.position, mh.length);
 			braces[0] = MovePositionForInsertion(braces[0], mh.position, mh.length);
 			braces[1] = MovePositionForInsertion(braces[1], mh.position, mh.length);
 		} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
-			sel.MovePositions(false, mh.position, mh.length);
+			MoveSelections(false, mh.position, mh.length);
 			braces[0] = MovePositionForDeletion(braces[0], mh.position, mh.length);
 			braces[1] = MovePositionForDeletion(braces[1], mh.position, mh.length);
 		}
@@ -2830,14 +3509,14 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 				}
 			}
 
-			if (paintState == PaintState::notPainting && !CanDeferToLastStep(mh)) {
+			if (paintState == PaintState::notPainting && !CanDeferToLastStep(mh) && !bulk) {
 				if (SynchronousStylingToVisible()) {
 					QueueIdleWork(WorkItems::style, pdoc->Length());
 				}
 				Redraw();
 			}
 		} else {
-			if (paintState == PaintState::notPainting && mh.length && !CanEliminate(mh)) {
+			if (paintState == PaintState::notPainting && mh.length && !CanEliminate(mh) && !bulk) {
 				if (SynchronousStylingToVisible()) {
 					QueueIdleWork(WorkItems::style, mh.position + mh.length);
 				}
@@ -2846,7 +3525,7 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 		}
 	}
 
-	if (mh.linesAdded != 0 && !CanDeferToLastStep(mh)) {
+	if (mh.linesAdded != 0 && !CanDeferToLastStep(mh) && !bulk) {
 		SetScrollBars();
 	}
 
@@ -2871,6 +3550,24 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 	}
 
 	// If client wants to see this modification
+	if (!(bulk && FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText))) {
+		NotifyParentModified(mh);
+	}
+}
+
+void Editor::NotifyBulkModified(const DocModification &mh) {
+	ContainerNeedsUpdate(Update::Content);
+	if (paintState == PaintState::notPainting) {
+		if (SynchronousStylingToVisible()) {
+			QueueIdleWork(WorkItems::style, (mh.linesAdded != 0) ? pdoc->Length() : (mh.position + mh.length));
+		}
+		Redraw();
+	}
+	SetScrollBars();
+	NotifyParentModified(mh);
+}
+
+void Editor::NotifyParentModified(const DocModification &mh) {
 	if (FlagSet(mh.modificationType, modEventMask)) {
 		if (commandEvents) {
 			if ((mh.modificationType & (ModificationFlags::ChangeStyle | ModificationFlags::ChangeIndicator)) == ModificationFlags::None) {
@@ -4027,18 +4724,18 @@ int Editor::KeyCommand(Message iMessage) {
 	case Message::FormFeed:
 		AddChar('\f');
 		break;
-	case Message::ZoomIn:
+	case Message::ZoomIn: {
+		const int zoomPrevious = vs.zoomLevel;
 		if (vs.ZoomIn()) {
-			InvalidateStyleRedraw();
-			NotifyZoom();
+			ZoomChanged(zoomPrevious);
 		}
-		break;
-	case Message::ZoomOut:
+	} break;
+	case Message::ZoomOut: {
+		const int zoomPrevious = vs.zoomLevel;
 		if (vs.ZoomOut()) {
-			InvalidateStyleRedraw();
-			NotifyZoom();
+			ZoomChanged(zoomPrevious);
 		}
-		break;
+	} break;
 
 	case Message::DelWordLeft:
 	case Message::DelWordRight:
@@ -4272,17 +4969,8 @@ Sci::Position Editor::SearchText(
 
 std::string Editor::CaseMapString(const std::string &s, CaseMapping caseMapping) {
 	std::string ret(s);
-	for (char &ch : ret) {
-		switch (caseMapping) {
-		case CaseMapping::upper:
-			ch = MakeUpperCase(ch);
-			break;
-		case CaseMapping::lower:
-			ch = MakeLowerCase(ch);
-			break;
-		default:	// no action
-			break;
-		}
+	if (caseMapping != CaseMapping::same) {
+		CaseConvertASCII(ret.data(), ret.length(), (caseMapping == CaseMapping::upper) ? CaseConversion::upper : CaseConversion::lower);
 	}
 	return ret;
 }
@@ -4348,18 +5036,24 @@ void Editor::CopySelectionRange(SelectionText *ss, bool allowLineCopy) {
 			ss->Copy(text, pdoc->dbcsCodePage, false, true);
 		}
 	} else {
-		std::string text;
 		std::vector<SelectionRange> rangesInOrder = sel.RangesCopy();
-		if (sel.selType == Selection::SelTypes::rectangle)
+		const bool rectangular = sel.selType == Selection::SelTypes::rectangle;
+		if (rectangular)
 			std::sort(rangesInOrder.begin(), rangesInOrder.end());
+		// copy all ranges into one buffer, rectangular selection can have a range for each line
+		const std::string_view eol = rectangular ? StringFromEOLMode(pdoc->eolMode) : std::string_view();
+		size_t length = 0;
 		for (const SelectionRange &current : rangesInOrder) {
-			text.append(RangeText(current.Start().Position(), current.End().Position()));
-			if (sel.selType == Selection::SelTypes::rectangle) {
-				if (pdoc->eolMode != EndOfLine::Lf)
-					text.push_back('\r');
-				if (pdoc->eolMode != EndOfLine::Cr)
-					text.push_back('\n');
-			}
+			length += current.Length() + eol.length();
+		}
+		std::string text(length, '\0');
+		char *ptr = text.data();
+		for (const SelectionRange &current : rangesInOrder) {
+			const Sci::Position lengthRange = current.Length();
+			pdoc->GetCharRange(ptr, current.Start().Position(), lengthRange);
+			ptr += lengthRange;
+			memcpy(ptr, eol.data(), eol.length());
+			ptr += eol.length();
 		}
 		ss->Copy(text, pdoc->dbcsCodePage, sel.IsRectangular(), sel.selType == Selection::SelTypes::lines);
 	}
@@ -4393,6 +5087,7 @@ void Editor::SetDragPosition(SelectionPosition newPos) {
 		MovedCaret(newPos, posDrag, true, dragCaretPolicies);
 
 		caret.on = true;
+		caret.elapsed = 0;
 		FineTickerCancel(TickReason::caret);
 		if ((caret.active) && (caret.period > 0) && (newPos.Position() < 0))
 			FineTickerStart(TickReason::caret, caret.period, caret.period / 10);
@@ -4421,8 +5116,9 @@ void Editor::StartDrag() {
 	//DisplayCursor(Window::Cursor::::arrow);
 }
 
-void Editor::DropAt(SelectionPosition position, const char *value, size_t lengthValue, bool moving, bool rectangular) {
-	//Platform::DebugPrintf("DropAt %d %d\n", inDragDrop, position);
+// Removes dragged out text when moving and adjusts drop position, must be called inside an undo group.
+// Returns false when text is dropped onto the dragged selection.
+bool Editor::PrepareDrop(SelectionPosition &position, bool moving, bool rectangular) {
 	if (inDragDrop == DragDrop::dragging)
 		dropWentOutside = false;
 
@@ -4437,8 +5133,6 @@ void Editor::DropAt(SelectionPosition position, const char *value, size_t length
 		const SelectionPosition selStart = SelectionStart();
 		const SelectionPosition selEnd = SelectionEnd();
 
-		UndoGroup ug(pdoc);
-
 		SelectionPosition positionAfterDeletion = position;
 		if ((inDragDrop == DragDrop::dragging) && moving) {
 			// Remove dragged out text
@@ -4460,27 +5154,40 @@ void Editor::DropAt(SelectionPosition position, const char *value, size_t length
 			ClearSelection();
 		}
 		position = positionAfterDeletion;
-
-		std::string convertedText = Document::TransformLineEnds(value, lengthValue, pdoc->eolMode);
-
-		if (rectangular) {
-			PasteRectangular(position, convertedText.c_str(), convertedText.length());
-			// Should try to select new rectangle but it may not be a rectangle now so just select the drop position
-			SetEmptySelection(position);
-		} else {
+		if (!rectangular) {
 			position = MovePositionOutsideChar(position, sel.MainCaret() - position.Position());
 			position = RealizeVirtualSpace(position);
-			const Sci::Position lengthInserted = pdoc->InsertString(
-				position.Position(), convertedText.c_str(), convertedText.length());
-			if (lengthInserted > 0) {
-				SelectionPosition posAfterInsertion = position;
-				posAfterInsertion.Add(lengthInserted);
-				SetSelection(posAfterInsertion, position);
-			}
 		}
-	} else if (inDragDrop == DragDrop::dragging) {
+		return true;
+	}
+	if (inDragDrop == DragDrop::dragging) {
 		SetEmptySelection(position);
 	}
+	return false;
+}
+
+void Editor::DropAt(SelectionPosition position, const char *value, size_t lengthValue, bool moving, bool rectangular) {
+	//Platform::DebugPrintf("DropAt %d %d\n", inDragDrop, position);
+	UndoGroup ug(pdoc);
+	if (!PrepareDrop(position, moving, rectangular)) {
+		return;
+	}
+
+	std::string convertedText = Document::TransformLineEnds(value, lengthValue, pdoc->eolMode);
+
+	if (rectangular) {
+		PasteRectangular(position, convertedText.c_str(), convertedText.length());
+		// Should try to select new rectangle but it may not be a rectangle now so just select the drop position
+		SetEmptySelection(position);
+	} else {
+		const Sci::Position lengthInserted = pdoc->InsertString(
+			position.Position(), convertedText.c_str(), convertedText.length());
+		if (lengthInserted > 0) {
+			SelectionPosition posAfterInsertion = position;
+			posAfterInsertion.Add(lengthInserted);
+			SetSelection(posAfterInsertion, position);
+		}
+	}
 }
 
 void Editor::DropAt(SelectionPosition position, const char *value, bool moving, bool rectangular) {
@@ -5108,12 +5815,25 @@ void Editor::ButtonUpWithModifiers(Point pt, unsigned int curTime, KeyMod modifi
 	}
 }
 
+namespace {
+
+// bytes of styled text indexed for tags on each idle call.
+constexpr Sci::Position tagIndexIdleLength = 1024*1024;
+
+}
+
 bool Editor::Idle() {
 	NotifyUpdateUI();
 
 	bool needWrap = Wrapping() && wrapPending.NeedsWrap();
 
-	if (needWrap) {
+	if (needWrap && StartBackgroundWrapping()) {
+		// Wrap lines in background, idle is restarted after publishing.
+		needWrap = false;
+		if (needIdleStyling) {
+			IdleStyle();
+		}
+	} else if (needWrap) {
 		// Wrap lines during idle.
 		WrapLines(WrapScope::wsIdle);
 		// No more wrapping
@@ -5122,12 +5842,15 @@ bool Editor::Idle() {
 		IdleStyle();
 	}
 
+	// index tags of styled text for tag matching
+	const bool needTagIndex = pdoc->IndexTags(tagIndexIdleLength);
+
 	// Add more idle things to do here, but make sure idleDone is
 	// set correctly before the function returns. returning
 	// false will stop calling this idle function until SetIdle() is
 	// called again.
 
-	const bool idleDone = !needWrap && !needIdleStyling; // && thatDone && theOtherThingDone...
+	const bool idleDone = !needWrap && !needIdleStyling && !needTagIndex; // && thatDone && theOtherThingDone...
 
 	return !idleDone;
 }
@@ -5139,6 +5862,11 @@ void Editor::TickFor(TickReason reason) {
 		if (caret.active) {
 			InvalidateCaret();
 		}
+		caret.elapsed += caret.period;
+		if (caret.on && caret.timeout > 0 && caret.elapsed >= caret.timeout) {
+			// leave caret shown and stop waking up while user is idle
+			FineTickerCancel(TickReason::caret);
+		}
 		break;
 	case TickReason::scroll:
 		// Auto scroll
@@ -5156,6 +5884,13 @@ void Editor::TickFor(TickReason reason) {
 		}
 		FineTickerCancel(TickReason::dwell);
 		break;
+	case TickReason::wrap:
+		PublishBackgroundWrapping();
+		break;
+	case TickReason::zoom:
+		FineTickerCancel(TickReason::zoom);
+		InvalidateStyleRedraw();
+		break;
 	default:
 		// tickPlatform handled by subclass
 		break;
@@ -5231,7 +5966,10 @@ Sci::Position Editor::PositionAfterMaxStyling(Sci::Position posMax, bool scrolli
 		// Both states do not limit styling
 		return posMax;
 	}
+	return std::min(PositionStylingReach(scrolling), posMax);
+}
 
+Sci::Position Editor::PositionStylingReach(bool scrolling) const noexcept {
 	// Try to keep time taken by styling reasonable so interaction remains smooth.
 	// When scrolling, allow less time to ensure responsive
 	const double secondsAllowed = scrolling ? 0.005 : 0.02;
@@ -5241,11 +5979,11 @@ Sci::Position Editor::PositionAfterMaxStyling(Sci::Position posMax, bool scrolli
 	lineLast = pdoc->LineFromPositionAfter(lineLast, actionsInAllowedTime);
 
 	const Sci::Line stylingMaxLine = std::min(lineLast, pdoc->LinesTotal());
-	return std::min(pdoc->LineStart(stylingMaxLine), posMax);
+	return pdoc->LineStart(stylingMaxLine);
 }
 
 void Editor::StartIdleStyling(bool truncatedLastStyling) noexcept {
-	if ((idleStyling == IdleStyling::All) || (idleStyling == IdleStyling::AfterVisible)) {
+	if (idleStyling >= IdleStyling::AfterVisible) {
 		if (pdoc->GetEndStyled() < pdoc->Length()) {
 			// Style remainder of document in idle time
 			needIdleStyling = true;
@@ -5254,7 +5992,7 @@ void Editor::StartIdleStyling(bool truncatedLastStyling) noexcept {
 		needIdleStyling = true;
 	}
 
-	if (needIdleStyling) {
+	if (needIdleStyling || pdoc->TagIndexPending()) {
 		SetIdle(true);
 	}
 }
@@ -5262,15 +6000,30 @@ void Editor::StartIdleStyling(bool truncatedLastStyling) noexcept {
 // Style for an area but bound the amount of styling to remain responsive
 void Editor::StyleAreaBounded(PRectangle rcArea, bool scrolling) {
 	const Sci::Position posAfterArea = PositionAfterArea(rcArea);
-	const Sci::Position posAfterMax = PositionAfterMaxStyling(posAfterArea, scrolling);
+	const Sci::Position posTop = pdoc->LineStart(pcs->DocFromDisplay(TopLineOfMain()));
+	Sci::Position posAfterMax = PositionAfterMaxStyling(posAfterArea, scrolling);
+	if (idleStyling != IdleStyling::None && posAfterMax > posTop) {
+		// view far after styled text is not styled synchronously even when styling to visible
+		const Sci::Position posReach = PositionStylingReach(scrolling);
+		if (posReach < posTop) {
+			posAfterMax = posReach;
+		}
+	}
 	if (posAfterMax < posAfterArea) {
 		// Idle styling may be performed before current visible area
 		// Style a bit now then style further in idle time
 		pdoc->StyleToAdjustingLineDuration(posAfterMax);
+		// show the view lexed from a guessed state at once, corrected when idle
+		// or background styling catches up
+		pdoc->ColouriseSpeculative(posTop, posAfterArea);
 	} else {
 		// Can style all wanted now.
 		StyleToPositionInView(posAfterArea);
 	}
+	// restore evicted styles for the area
+	pdoc->EnsureStyleWindow(pdoc->LineStart(pcs->DocFromDisplay(TopLineOfMain())), posAfterArea);
+	// fold levels for the margin when folding on demand
+	pdoc->EnsureFoldedTo(posAfterArea);
 	StartIdleStyling(posAfterMax < posAfterArea);
 }
 
@@ -5285,12 +6038,35 @@ void Editor::IdleStyle() {
 	}
 }
 
+namespace {
+
+// text around the view kept unpacked, so scrolling a few pages doesn't decode chunks
+constexpr Sci::Position PackHotMargin = 4*1024*1024;
+
+}
+
+// Compress text away from the view after scrolling or changes, packed chunks are decoded again when accessed.
+void Editor::PackText() {
+	const Sci::Line lineTop = pcs->DocFromDisplay(topLine);
+	const Sci::Line lineBottom = pcs->DocFromDisplay(topLine + LinesOnScreen());
+	const Sci::Position hotStart = pdoc->LineStart(lineTop) - PackHotMargin;
+	const Sci::Position hotEnd = pdoc->LineStart(lineBottom + 1) + PackHotMargin;
+	try {
+		pdoc->PackText(hotStart, hotEnd);
+	} catch (const std::exception &) {
+		// rest of the text is left unpacked
+	}
+}
+
 void Editor::IdleWork() {
 	// Style the line after the modification as this allows modifications that change just the
 	// line of the modification to heal instead of propagating to the rest of the window.
 	if (FlagSet(workNeeded.items, WorkItems::style)) {
 		StyleToPositionInView(pdoc->LineStart(pdoc->LineFromPosition(workNeeded.upTo) + 2));
 	}
+	if (FlagSet(workNeeded.items, WorkItems::packText)) {
+		PackText();
+	}
 	NotifyUpdateUI();
 	workNeeded.Reset();
 }
@@ -5418,11 +6194,53 @@ void Editor::SetDocPointer(Document *document) {
 
 	view.ClearAllTabstops();
 
+	pdoc->SetStyleBudget(styleBudget);
 	pdoc->AddWatcher(this, nullptr);
 	SetScrollBars();
 	Redraw();
 }
 
+void Editor::ConvertToLargeDocument(DocumentOption options) {
+	if (pdoc->IsLarge()) {
+		return;
+	}
+
+	pdoc->ConvertToLarge(options);
+
+	// Recreate the contraction state for 64-bit lines, keeping folded and hidden lines.
+	std::unique_ptr<IContractionState> pcsLarge = ContractionStateCreate(true);
+	const Sci::Line lines = pdoc->LinesTotal();
+	pcsLarge->InsertLines(0, lines - 1);
+	for (Sci::Line line = pcs->ContractedNext(0); line >= 0 && line < lines; line = pcs->ContractedNext(line + 1)) {
+		pcsLarge->SetExpanded(line, false);
+	}
+	if (pcs->HiddenLines()) {
+		for (Sci::Line line = 0; line < lines; line++) {
+			if (!pcs->GetVisible(line)) {
+				Sci::Line lineEnd = line;
+				while (lineEnd + 1 < lines && !pcs->GetVisible(lineEnd + 1)) {
+					lineEnd++;
+				}
+				pcsLarge->SetVisible(line, lineEnd, false);
+				line = lineEnd;
+			}
+		}
+	}
+#if EnablePerLineFoldDisplayText
+	for (Sci::Line line = 0; line < lines; line++) {
+		const char *text = pcs->GetFoldDisplayText(line);
+		if (text) {
+			pcsLarge->SetFoldDisplayText(line, text);
+		}
+	}
+#endif
+	pcs = std::move(pcsLarge);
+	SetAnnotationHeights(0, lines);
+	NeedWrapping();
+	SetScrollBars();
+	Redraw();
+}
+
 void Editor::SetAnnotationVisible(AnnotationVisible visible) {
 	if (vs.annotationVisible != visible) {
 		const bool changedFromOrToHidden = ((vs.annotationVisible != AnnotationVisible::Hidden) != (visible != AnnotationVisible::Hidden));
@@ -5454,18 +6272,24 @@ void Editor::SetEOLAnnotationVisible(EOLAnnotationVisible visible) noexcept {
 Sci::Line Editor::ExpandLine(Sci::Line line) {
 	const Sci::Line lineMaxSubord = pdoc->GetLastChild(line);
 	line++;
+	// show spans of lines up to each child header at once
+	Sci::Line lineShow = line;
 	while (line <= lineMaxSubord) {
-		pcs->SetVisible(line, line, true);
 		const FoldLevel level = pdoc->GetFoldLevel(line);
 		if (LevelIsHeader(level)) {
+			pcs->SetVisible(lineShow, line, true);
 			if (pcs->GetExpanded(line)) {
 				line = ExpandLine(line);
 			} else {
 				line = pdoc->GetLastChild(line);
 			}
+			lineShow = line + 1;
 		}
 		line++;
 	}
+	if (lineShow <= lineMaxSubord) {
+		pcs->SetVisible(lineShow, lineMaxSubord, true);
+	}
 	return lineMaxSubord;
 }
 
@@ -5477,6 +6301,7 @@ void Editor::SetFoldExpanded(Sci::Line lineDoc, bool expanded) {
 
 void Editor::FoldLine(Sci::Line line, FoldAction action) {
 	if (line >= 0) {
+		pdoc->EnsureFoldedTo(pdoc->LineStart(line + 1));
 		if (action == FoldAction::Toggle) {
 			if (!LevelIsHeader(pdoc->GetFoldLevel(line))) {
 				line = pdoc->GetFoldParent(line);
@@ -5612,6 +6437,7 @@ void Editor::EnsureLineVisible(Sci::Line lineDoc, bool enforcePolicy) {
 
 void Editor::FoldAll(FoldAction action) {
 	pdoc->EnsureStyledTo(pdoc->Length());
+	pdoc->EnsureFoldedTo(pdoc->Length());
 	const Sci::Line maxLine = pdoc->LinesTotal();
 	bool expanding = action == FoldAction::Expand;
 	if (action == FoldAction::Toggle) {
@@ -5625,21 +6451,18 @@ void Editor::FoldAll(FoldAction action) {
 	}
 	if (expanding) {
 		pcs->SetVisible(0, maxLine - 1, true);
-		for (int line = 0; line < maxLine; line++) {
-			const FoldLevel levelLine = pdoc->GetFoldLevel(line);
-			if (LevelIsHeader(levelLine)) {
-				SetFoldExpanded(line, true);
-			}
-		}
+		pcs->ExpandAll();
 	} else {
 		for (Sci::Line line = 0; line < maxLine; line++) {
 			const FoldLevel level = pdoc->GetFoldLevel(line);
 			if (LevelIsHeader(level) &&
 				(FoldLevel::Base == LevelNumberPart(level))) {
-				SetFoldExpanded(line, false);
+				pcs->SetExpanded(line, false);
 				const Sci::Line lineMaxSubord = pdoc->GetLastChild(line);
 				if (lineMaxSubord > line) {
 					pcs->SetVisible(line + 1, lineMaxSubord, false);
+					// no base level header inside the fold
+					line = lineMaxSubord;
 				}
 			}
 		}
@@ -5866,7 +6689,56 @@ void Editor::StyleSetMessage(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	default:
 		break;
 	}
-	InvalidateStyleRedraw();
+	InvalidateStyleAttributes();
+}
+
+void Editor::StyleSetDefinitions(const StyleDefinition *definitions, size_t count) {
+	// same as StyleSetMessage() for each attribute, but only invalidate once.
+	for (size_t i = 0; i < count; i++) {
+		const StyleDefinition &def = definitions[i];
+		const int index = def.style;
+		vs.EnsureStyle(index);
+		Style &style = vs.styles[index];
+		const StyleDefinitionMask mask = def.mask;
+		if (FlagSet(mask, StyleDefinitionMask::Font) && def.fontName) {
+			vs.SetStyleFontName(index, def.fontName);
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Size)) {
+			vs.fontsValid = false;
+			style.size = def.sizeFractional;
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Fore)) {
+			style.fore = ColourRGBA::FromIpRGB(def.fore);
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Back)) {
+			style.back = ColourRGBA::FromIpRGB(def.back);
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Weight)) {
+			vs.fontsValid = false;
+			style.weight = static_cast<FontWeight>(def.weight);
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Italic)) {
+			vs.fontsValid = false;
+			style.italic = def.italic != 0;
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Underline)) {
+			style.underline = def.underline != 0;
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Strike)) {
+			style.strike = def.strike != 0;
+		}
+		if (FlagSet(mask, StyleDefinitionMask::EOLFilled)) {
+			style.eolFilled = def.eolFilled != 0;
+		}
+		if (FlagSet(mask, StyleDefinitionMask::Case)) {
+			style.caseForce = static_cast<Style::CaseForce>(def.caseForce);
+		}
+		if (FlagSet(mask, StyleDefinitionMask::CharacterSet)) {
+			vs.fontsValid = false;
+			style.characterSet = static_cast<CharacterSet>(def.characterSet);
+		}
+	}
+	InvalidateStyleAttributes();
 }
 
 sptr_t Editor::StyleGetMessage(Message iMessage, uptr_t wParam, sptr_t lParam) {
@@ -6076,6 +6948,16 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		pdoc->DeleteUndoHistory();
 		return 0;
 
+	case Message::SetUndoMemoryBudget:
+		pdoc->SetUndoMemoryBudget(wParam);
+		break;
+
+	case Message::GetUndoMemoryBudget:
+		return pdoc->GetUndoMemoryBudget();
+
+	case Message::GetUndoMemoryUsage:
+		return pdoc->UndoMemoryUsage();
+
 	case Message::GetFirstVisibleLine:
 		return topLine;
 
@@ -6234,6 +7116,18 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		PLATFORM_ASSERT(lParam);
 		return ReplaceTarget(true, CharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
 
+	case Message::ReplaceRanges:
+		PLATFORM_ASSERT(lParam);
+		return pdoc->ReplaceRanges(static_cast<const TextReplacement *>(PtrFromSPtr(lParam)), PositionFromUPtr(wParam));
+
+	case Message::SubstituteTargetRE: {
+		PLATFORM_ASSERT(wParam);
+		const char *text = ConstCharPtrFromUPtr(wParam);
+		Sci::Position length = strlen(text);
+		text = pdoc->SubstituteByPosition(text, &length);
+		return BytesResult(lParam, reinterpret_cast<const unsigned char *>(text), length);
+	}
+
 	case Message::SearchInTarget:
 		PLATFORM_ASSERT(lParam);
 		return SearchInTarget(CharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
@@ -6425,6 +7319,14 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		pdoc->EndUndoAction();
 		return 0;
 
+	case Message::BeginBulkModification:
+		pdoc->BeginBulkModification();
+		return 0;
+
+	case Message::EndBulkModification:
+		pdoc->EndBulkModification();
+		return 0;
+
 	case Message::GetCaretPeriod:
 		return caret.period;
 
@@ -6487,6 +7389,13 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		pdoc->Allocate(PositionFromUPtr(wParam));
 		break;
 
+	case Message::SetLargePages:
+		VirtualMemory::SetLargePages(wParam != 0);
+		break;
+
+	case Message::GetLargePages:
+		return VirtualMemory::LargePageSize() != 0;
+
 	case Message::GetCharAt:
 		return pdoc->UCharAt(PositionFromUPtr(wParam));
 
@@ -6726,13 +7635,18 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			InvalidateStyleRedraw();
 		break;
 
-	case Message::SetFontQuality:
-		vs.extraFontFlag = static_cast<FontQuality>(
+	case Message::SetFontQuality: {
+		const FontQuality extraFontFlag = static_cast<FontQuality>(
 			(static_cast<int>(vs.extraFontFlag) & ~static_cast<int>(FontQuality::QualityMask)) |
 			(wParam & static_cast<int>(FontQuality::QualityMask)));
-		vs.fontsValid = false;
-		InvalidateStyleRedraw();
-		break;
+		// Short-circuit if the quality is unchanged, to keep line layouts.
+		if (vs.extraFontFlag != extraFontFlag) {
+			vs.extraFontFlag = extraFontFlag;
+			vs.fontsValid = false;
+			InvalidateStyleRedraw();
+		}
+	}
+	break;
 
 	case Message::GetFontQuality:
 		return static_cast<int>(vs.extraFontFlag) & static_cast<int>(FontQuality::QualityMask);
@@ -6758,6 +7672,11 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::ClearTabStops:
 		if (view.ClearTabstops(LineFromUPtr(wParam))) {
+			if (static_cast<sptr_t>(wParam) < 0) {
+				// all lines are laid out again
+				view.llc.Invalidate(LineLayout::ValidLevel::invalid);
+				NeedWrapping();
+			}
 			const DocModification mh(ModificationFlags::ChangeTabStops, 0, 0, 0, nullptr, LineFromUPtr(wParam));
 			NotifyModified(pdoc, mh, nullptr);
 		}
@@ -6765,6 +7684,10 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::AddTabStop:
 		if (view.AddTabstop(LineFromUPtr(wParam), static_cast<int>(lParam))) {
+			if (static_cast<sptr_t>(wParam) < 0) {
+				view.llc.Invalidate(LineLayout::ValidLevel::invalid);
+				NeedWrapping();
+			}
 			const DocModification mh(ModificationFlags::ChangeTabStops, 0, 0, 0, nullptr, LineFromUPtr(wParam));
 			NotifyModified(pdoc, mh, nullptr);
 		}
@@ -6773,6 +7696,17 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetNextTabStop:
 		return view.GetNextTabstop(LineFromUPtr(wParam), static_cast<int>(lParam));
 
+	case Message::SetFieldDelimiter:
+		if (vs.fieldDelimiter != static_cast<int>(wParam)) {
+			// tab is always aligned, multi-byte characters can't be delimiter
+			vs.fieldDelimiter = (wParam < 0x80 && wParam != '\t') ? static_cast<int>(wParam) : 0;
+			InvalidateStyleRedraw();
+		}
+		break;
+
+	case Message::GetFieldDelimiter:
+		return vs.fieldDelimiter;
+
 	case Message::SetIndent:
 		pdoc->indentInChars = static_cast<int>(wParam);
 		if (pdoc->indentInChars != 0)
@@ -6841,6 +7775,23 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetIdleStyling:
 		return static_cast<sptr_t>(idleStyling);
 
+	case Message::SetStyleWindow:
+		pdoc->SetStyleWindow(PositionFromUPtr(wParam));
+		InvalidateStyleRedraw();
+		break;
+
+	case Message::GetStyleWindow:
+		return pdoc->GetStyleWindow();
+
+	case Message::SetStyleBudget:
+		styleBudget = std::max(static_cast<int>(wParam), 0);
+		pdoc->SetStyleBudget(styleBudget);
+		InvalidateStyleRedraw();
+		break;
+
+	case Message::GetStyleBudget:
+		return styleBudget;
+
 	case Message::SetWrapMode:
 		if (vs.SetWrapState(static_cast<Wrap>(wParam))) {
 			xOffset = 0;
@@ -6901,6 +7852,26 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetLayoutCache:
 		return static_cast<sptr_t>(view.llc.GetLevel());
 
+	case Message::SetLayoutCacheBudget:
+		view.llc.SetBudget(wParam);
+		break;
+
+	case Message::GetLayoutCacheBudget:
+		return view.llc.GetBudget();
+
+	case Message::GetLayoutCacheMemory:
+		return view.llc.MemoryUsage();
+
+	case Message::SetPaintTiming:
+		view.paintTiming = wParam != 0;
+		view.posCache.timing = view.paintTiming;
+		view.paintTimingsShown = {};
+		Redraw();
+		break;
+
+	case Message::GetPaintTiming:
+		return view.paintTiming;
+
 	case Message::SetPositionCache:
 		view.posCache.SetSize(wParam);
 		break;
@@ -6908,6 +7879,50 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetPositionCache:
 		return view.posCache.GetSize();
 
+	case Message::SetLayoutThreads:
+		view.SetLayoutThreads(static_cast<unsigned int>(wParam));
+		break;
+
+	case Message::GetLayoutThreads:
+		return view.GetLayoutThreads();
+
+	case Message::GetPositionCacheStatistic: {
+		const PositionCacheStatistics &statistics = view.posCache.GetStatistics();
+		switch (static_cast<PositionCacheStatistic>(wParam)) {
+		case PositionCacheStatistic::Hits:
+			return statistics.hits;
+		case PositionCacheStatistic::Misses:
+			return statistics.misses;
+		case PositionCacheStatistic::Evictions:
+			return statistics.evictions;
+		default:
+			return 0;
+		}
+	}
+
+	case Message::ResetPositionCacheStatistics:
+		view.posCache.ResetStatistics();
+		break;
+
+	case Message::GetMemoryUsage:
+		return MemoryUsage(static_cast<Scintilla::MemoryUsage>(wParam));
+
+	case Message::GetStylingStatistic:
+		switch (static_cast<StylingStatistic>(wParam)) {
+		case StylingStatistic::Duration:
+			return std::lround(pdoc->durationStyleOneUnit.Duration() * 1e9);
+		case StylingStatistic::Bytes:
+			return pdoc->stylingStatistics.bytes;
+		case StylingStatistic::Time:
+			return static_cast<sptr_t>(std::llround(pdoc->stylingStatistics.duration * 1e6));
+		default:
+			return 0;
+		}
+
+	case Message::ResetStylingStatistics:
+		pdoc->stylingStatistics = {};
+		break;
+
 	case Message::SetScrollWidth:
 		PLATFORM_ASSERT(wParam > 0);
 		if ((wParam > 0) && (wParam != static_cast<unsigned int>(scrollWidth))) {
@@ -7075,7 +8090,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			vs.markers[wParam].markType = static_cast<MarkerSymbol>(lParam);
 			vs.CalcLargestMarkerHeight();
 		}
-		InvalidateStyleData();
+		InvalidateColourData();
 		RedrawSelMargin();
 		break;
 
@@ -7088,25 +8103,25 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::MarkerSetForeTranslucent:
 		if (wParam <= MarkerMax)
 			vs.markers[wParam].fore = ColourRGBA(static_cast<unsigned int>(lParam));
-		InvalidateStyleData();
+		InvalidateColourData();
 		RedrawSelMargin();
 		break;
 	case Message::MarkerSetBackTranslucent:
 		if (wParam <= MarkerMax)
 			vs.markers[wParam].back = ColourRGBA(static_cast<unsigned int>(lParam));
-		InvalidateStyleData();
+		InvalidateColourData();
 		RedrawSelMargin();
 		break;
 	case Message::MarkerSetBackSelectedTranslucent:
 		if (wParam <= MarkerMax)
 			vs.markers[wParam].backSelected = ColourRGBA(static_cast<unsigned int>(lParam));
-		InvalidateStyleData();
+		InvalidateColourData();
 		RedrawSelMargin();
 		break;
 	case Message::MarkerSetStrokeWidth:
 		if (wParam <= MarkerMax)
 			vs.markers[wParam].strokeWidth = lParam / 100.0f;
-		InvalidateStyleData();
+		InvalidateColourData();
 		RedrawSelMargin();
 		break;
 	case Message::MarkerEnableHighlight:
@@ -7146,20 +8161,15 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::MarkerNext:
 		return pdoc->MarkerNext(LineFromUPtr(wParam), static_cast<MarkerMask>(lParam));
 
-	case Message::MarkerPrevious: {
-			for (Sci::Line iLine = LineFromUPtr(wParam); iLine >= 0; iLine--) {
-				if ((pdoc->GetMark(iLine) & lParam) != 0)
-					return iLine;
-			}
-		}
-		return -1;
+	case Message::MarkerPrevious:
+		return pdoc->MarkerPrevious(LineFromUPtr(wParam), static_cast<MarkerMask>(lParam));
 
 	case Message::MarkerDefinePixmap:
 		if (wParam <= MarkerMax) {
 			vs.markers[wParam].SetXPM(CharPtrFromSPtr(lParam));
 			vs.CalcLargestMarkerHeight();
 		}
-		InvalidateStyleData();
+		InvalidateColourData();
 		RedrawSelMargin();
 		break;
 
@@ -7180,7 +8190,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			vs.markers[wParam].SetRGBAImage(sizeRGBAImage, scaleRGBAImage / 100.0f, ConstUCharPtrFromSPtr(lParam));
 			vs.CalcLargestMarkerHeight();
 		}
-		InvalidateStyleData();
+		InvalidateColourData();
 		RedrawSelMargin();
 		break;
 
@@ -7254,7 +8264,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::SetMarginBackN:
 		if (ValidMargin(wParam)) {
 			vs.ms[wParam].back = ColourRGBA::FromIpRGB(lParam);
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7274,12 +8284,12 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::StyleClearAll:
 		vs.ClearStyles();
-		InvalidateStyleRedraw();
+		InvalidateStyleAttributes();
 		break;
 
 	case Message::CopyStyles:
 		vs.CopyStyles(wParam, lParam);
-		InvalidateStyleRedraw();
+		InvalidateStyleAttributes();
 		break;
 
 	case Message::StyleSetFore:
@@ -7302,6 +8312,11 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		StyleSetMessage(iMessage, wParam, lParam);
 		break;
 
+	case Message::StyleSetDefinitions:
+		PLATFORM_ASSERT(lParam || !wParam);
+		StyleSetDefinitions(static_cast<const StyleDefinition *>(PtrFromSPtr(lParam)), wParam);
+		break;
+
 	case Message::StyleGetFore:
 	case Message::StyleGetBack:
 	case Message::StyleGetBold:
@@ -7322,12 +8337,12 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::StyleResetDefault:
 		vs.ResetDefaultStyle();
-		InvalidateStyleRedraw();
+		InvalidateStyleAttributes();
 		break;
 
 	case Message::SetElementColour:
 		if (vs.SetElementColour(static_cast<Element>(wParam), ColourRGBA(static_cast<unsigned int>(lParam)))) {
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7336,7 +8351,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::ResetElementColour:
 		if (vs.ResetElement(static_cast<Element>(wParam))) {
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7371,21 +8386,21 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		return vs.caretLine.alwaysShow;
 	case Message::SetCaretLineVisibleAlways:
 		vs.caretLine.alwaysShow = wParam != 0;
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::GetCaretLineHighlightSubLine:
 		return vs.caretLine.subLine;
 	case Message::SetCaretLineHighlightSubLine:
 		vs.caretLine.subLine = wParam != 0;
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::GetCaretLineFrame:
 		return vs.caretLine.frame;
 	case Message::SetCaretLineFrame:
 		vs.caretLine.frame = static_cast<int>(wParam);
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::GetCaretLineLayer:
@@ -7395,7 +8410,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		if (vs.caretLine.layer != static_cast<Layer>(wParam)) {
 			vs.caretLine.layer = static_cast<Layer>(wParam);
 			UpdateBaseElements();
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7418,12 +8433,14 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		}
 
 	case Message::GetFoldLevel:
+		pdoc->EnsureFoldedTo(pdoc->LineStart(LineFromUPtr(wParam) + 1));
 		return pdoc->GetLevel(LineFromUPtr(wParam));
 
 	case Message::GetLastChild:
 		return pdoc->GetLastChild(LineFromUPtr(wParam), OptionalFoldLevel(lParam));
 
 	case Message::GetFoldParent:
+		pdoc->EnsureFoldedTo(pdoc->LineStart(LineFromUPtr(wParam) + 1));
 		return pdoc->GetFoldParent(LineFromUPtr(wParam));
 
 	case Message::ShowLines:
@@ -7496,6 +8513,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		break;
 
 	case Message::FoldChildren:
+		pdoc->EnsureFoldedTo(pdoc->LineStart(LineFromUPtr(wParam) + 1));
 		FoldExpand(LineFromUPtr(wParam), static_cast<FoldAction>(lParam), pdoc->GetFoldLevel(wParam));
 		break;
 
@@ -7550,19 +8568,19 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::SetSelEOLFilled:
 		vs.selection.eolFilled = wParam != 0;
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::SetEOLSelectedWidth:
 		vs.selection.eolSelectedWidth = std::clamp(static_cast<int>(wParam), 0, 100);
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::SetSelectionLayer:
 		if (vs.selection.layer != static_cast<Layer>(wParam)) {
 			vs.selection.layer = static_cast<Layer>(wParam);
 			UpdateBaseElements();
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7575,7 +8593,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		else
 			/* Default to the line caret */
 			vs.caret.style = CaretStyle::Line;
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::GetCaretStyle:
@@ -7584,7 +8602,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::SetCaretWidth:
 		// Windows accessibility allows 20 pixels caret width.
 		vs.caret.width = std::clamp(static_cast<int>(wParam), 0, 20);
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::GetCaretWidth:
@@ -7608,7 +8626,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		if (wParam <= IndicatorMax) {
 			vs.indicators[wParam].sacNormal.style = static_cast<IndicatorStyle>(lParam);
 			vs.indicators[wParam].sacHover.style = static_cast<IndicatorStyle>(lParam);
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7619,7 +8637,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		if (wParam <= IndicatorMax) {
 			vs.indicators[wParam].sacNormal.fore = ColourRGBA::FromIpRGB(lParam);
 			vs.indicators[wParam].sacHover.fore = ColourRGBA::FromIpRGB(lParam);
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7629,7 +8647,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::IndicSetHoverStyle:
 		if (wParam <= IndicatorMax) {
 			vs.indicators[wParam].sacHover.style = static_cast<IndicatorStyle>(lParam);
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7639,7 +8657,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::IndicSetHoverFore:
 		if (wParam <= IndicatorMax) {
 			vs.indicators[wParam].sacHover.fore = ColourRGBA::FromIpRGB(lParam);
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7649,7 +8667,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::IndicSetFlags:
 		if (wParam <= IndicatorMax) {
 			vs.indicators[wParam].SetFlags(static_cast<IndicFlag>(lParam));
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7659,7 +8677,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::IndicSetUnder:
 		if (wParam <= IndicatorMax) {
 			vs.indicators[wParam].under = lParam != 0;
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7669,7 +8687,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::IndicSetAlpha:
 		if (wParam <= IndicatorMax && lParam >=0 && lParam <= 255) {
 			vs.indicators[wParam].fillAlpha = static_cast<int>(lParam);
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7679,7 +8697,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::IndicSetOutlineAlpha:
 		if (wParam <= IndicatorMax && lParam >=0 && lParam <= 255) {
 			vs.indicators[wParam].outlineAlpha = static_cast<int>(lParam);
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7689,7 +8707,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::IndicSetStrokeWidth:
 		if (wParam <= IndicatorMax && lParam >= 0 && lParam <= 1000) {
 			vs.indicators[wParam].strokeWidth = lParam / 100.0f;
-			InvalidateStyleRedraw();
+			InvalidateColourRedraw();
 		}
 		break;
 
@@ -7719,6 +8737,11 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		pdoc->DecorationFillRange(PositionFromUPtr(wParam), 0, lParam);
 		break;
 
+	case Message::IndicatorFillRanges:
+		pdoc->DecorationFillRanges(static_cast<const Sci::Position *>(PtrFromSPtr(lParam)),
+			wParam, pdoc->decorations->GetCurrentValue());
+		break;
+
 	case Message::IndicatorAllOnFor:
 		return pdoc->decorations->AllOnFor(PositionFromUPtr(wParam));
 
@@ -7865,12 +8888,25 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::BraceMatch:
 		// wParam is position of char to find brace for,
-		// lParam is maximum amount of text to restyle to find it
+		// lParam is maximum distance from it to search, 0 for whole document
 		return pdoc->BraceMatch(PositionFromUPtr(wParam), lParam, 0, false);
 
 	case Message::BraceMatchNext:
 		return pdoc->BraceMatch(PositionFromUPtr(wParam), 0, lParam, true);
 
+	case Message::SetTagStyle:
+		pdoc->SetTagStyle(static_cast<int>(wParam), lParam != 0);
+		StartIdleStyling(false);
+		break;
+
+	case Message::SetVoidTags:
+		pdoc->SetVoidTags(wParam != 0, ConstCharPtrFromSPtr(lParam));
+		StartIdleStyling(false);
+		break;
+
+	case Message::FindTag:
+		return pdoc->FindTag(PositionFromUPtr(wParam), static_cast<TagFind>(lParam));
+
 	case Message::GetViewEOL:
 		return vs.viewEOL;
 
@@ -7882,10 +8918,10 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::SetZoom: {
 		const int zoomLevel = std::clamp(static_cast<int>(wParam), MinZoomLevel, MaxZoomLevel);
 		if (zoomLevel != vs.zoomLevel) {
+			const int zoomPrevious = vs.zoomLevel;
 			vs.zoomLevel = zoomLevel;
 			vs.fontsValid = false;
-			InvalidateStyleRedraw();
-			NotifyZoom();
+			ZoomChanged(zoomPrevious);
 		}
 		break;
 	}
@@ -7914,7 +8950,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::SetEdgeColour:
 		vs.theEdge.colour = ColourRGBA::FromIpRGB(SPtrFromUPtr(wParam));
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::MultiEdgeAddLine:
@@ -7970,6 +9006,10 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetDocumentOptions:
 		return static_cast<sptr_t>(pdoc->Options());
 
+	case Message::ConvertToLargeDocument:
+		ConvertToLargeDocument(static_cast<DocumentOption>(wParam));
+		break;
+
 	case Message::CreateLoader: {
 			Document *doc = new Document(static_cast<DocumentOption>(lParam));
 			doc->AddRef();
@@ -7993,9 +9033,18 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetCommandEvents:
 		return commandEvents;
 
-	case Message::ConvertEOLs:
-		pdoc->ConvertLineEnds(static_cast<EndOfLine>(wParam));
-		SetSelection(sel.MainCaret(), sel.MainAnchor());	// Ensure selection inside document
+	case Message::ConvertEOLs: {
+			// line count is unchanged, keep main selection at same line and column
+			const Sci::Position caret = sel.MainCaret();
+			const Sci::Position anchor = sel.MainAnchor();
+			const Sci::Line lineCaret = pdoc->SciLineFromPosition(caret);
+			const Sci::Line lineAnchor = pdoc->SciLineFromPosition(anchor);
+			const Sci::Position columnCaret = caret - pdoc->LineStart(lineCaret);
+			const Sci::Position columnAnchor = anchor - pdoc->LineStart(lineAnchor);
+			pdoc->ConvertLineEnds(static_cast<EndOfLine>(wParam));
+			SetSelection(std::min(pdoc->LineStart(lineCaret) + columnCaret, pdoc->LineEnd(lineCaret)),
+				std::min(pdoc->LineStart(lineAnchor) + columnAnchor, pdoc->LineEnd(lineAnchor)));
+		}
 		return 0;
 
 	case Message::SetLengthForEncode:
@@ -8176,17 +9225,17 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 
 	case Message::SetFoldMarginColour:
 		vs.foldmarginColour = OptionalColour(wParam, lParam);
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::SetFoldMarginHiColour:
 		vs.foldmarginHighlightColour = OptionalColour(wParam, lParam);
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::SetHotspotActiveUnderline:
 		vs.hotspotUnderline = wParam != 0;
-		InvalidateStyleRedraw();
+		InvalidateColourRedraw();
 		break;
 
 	case Message::GetHotspotActiveUnderline:
@@ -8208,25 +9257,60 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		return convertPastes ? 1 : 0;
 
 	case Message::GetCharacterPointer:
+		// pointer stays valid until text is changed, so it's not packed on idle
+		pdoc->PinText(0, pdoc->Length());
 		return reinterpret_cast<sptr_t>(pdoc->BufferPointer());
 
 	case Message::GetRangePointer:
+		pdoc->PinText(PositionFromUPtr(wParam), lParam);
 		return reinterpret_cast<sptr_t>(pdoc->RangePointer(PositionFromUPtr(wParam), lParam));
 
 	case Message::GetGapPosition:
 		return pdoc->GapPosition();
 
+	case Message::GetSegmentPointer: {
+			Sci::Position start = PositionFromUPtr(wParam);
+			Sci::Position end = pdoc->Length();
+			if (start < 0 || start >= end) {
+				return 0;
+			}
+			const char *ptr = pdoc->CharRangePointer(start, &start, &end);
+			if (lParam) {
+				*static_cast<Sci::Position *>(PtrFromSPtr(lParam)) = end;
+			}
+			return reinterpret_cast<sptr_t>(ptr);
+		}
+
+	case Message::GetStyleRangePointer: {
+			const Sci::Position start = PositionFromUPtr(wParam);
+			if (start < 0 || lParam <= 0 || start + lParam > pdoc->Length()) {
+				return 0;
+			}
+			return reinterpret_cast<sptr_t>(pdoc->StyleRangePointer(start, lParam));
+		}
+
+	case Message::AcquireTextSnapshot:
+		return reinterpret_cast<sptr_t>(pdoc->AcquireTextSnapshot());
+
+	case Message::ReleaseTextSnapshot:
+		Document::ReleaseTextSnapshot(ConstCharPtrFromSPtr(lParam));
+		break;
+
 	case Message::SetExtraAscent:
-		vs.extraAscent = static_cast<int>(wParam);
-		InvalidateStyleRedraw();
+		if (vs.extraAscent != static_cast<int>(wParam)) {
+			vs.extraAscent = static_cast<int>(wParam);
+			InvalidateStyleRedraw();
+		}
 		break;
 
 	case Message::GetExtraAscent:
 		return vs.extraAscent;
 
 	case Message::SetExtraDescent:
-		vs.extraDescent = static_cast<int>(wParam);
-		InvalidateStyleRedraw();
+		if (vs.extraDescent != static_cast<int>(wParam)) {
+			vs.extraDescent = static_cast<int>(wParam);
+			InvalidateStyleRedraw();
+		}
 		break;
 
 	case Message::GetExtraDescent:
@@ -41,7 +41,8 @@ public:
 enum class WorkItems {
 	none = 0,
 	style = 1,
-	updateUI = 2
+	updateUI = 2,
+	packText = 4
 };
 
 class WorkNeeded {
@@ -113,6 +114,8 @@ private:
 	}
 };
 
+class BackgroundWrapper;
+
 struct WrapPending {
 	// The range of lines that need to be wrapped
 	enum {
@@ -200,6 +203,10 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	/** Style resources may be expensive to allocate so are cached between uses.
 	 * When a style attribute is changed, this cache is flushed. */
 	bool stylesValid;
+	/** Style attribute changes that may keep line layouts are checked against
+	 * the layout keys of the last refresh before discarding layouts. */
+	bool styleLayoutPending = false;
+	std::vector<StyleLayoutKey> styleLayoutKeys;
 	ViewStyle vs;
 	Scintilla::Technology technology;
 	Point sizeRGBAImage;
@@ -224,6 +231,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool multipleSelection;
 	bool additionalSelectionTyping;
 	Scintilla::MultiPaste multiPasteMode;
+	SelectionBatch *selectionBatch;	///< Multiple selections being edited, moved in a single sweep afterwards
 
 	Scintilla::VirtualSpace virtualSpaceOptions;
 
@@ -277,6 +285,8 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	WorkNeeded workNeeded;
 	Scintilla::IdleStyling idleStyling;
 	bool needIdleStyling;
+	// lexer watchdog budget in milliseconds, applied to each document set into this view
+	int styleBudget;
 
 	Scintilla::ModificationFlags modEventMask;
 	bool commandEvents;
@@ -296,6 +306,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	// Wrapping support
 	WrapPending wrapPending;
 	ActionDuration durationWrapOneUnit;
+	std::shared_ptr<BackgroundWrapper> backgroundWrapper;
 
 	bool convertPastes;
 
@@ -306,6 +317,10 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 
 	void InvalidateStyleData();
 	void InvalidateStyleRedraw();
+	void ZoomChanged(int zoomPrevious);
+	void InvalidateColourData();
+	void InvalidateColourRedraw();
+	void InvalidateStyleAttributes();
 	void RefreshStyleData();
 	void SetRepresentations();
 	void DropGraphics() noexcept;
@@ -407,10 +422,14 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool Wrapping() const noexcept;
 	void NeedWrapping(Sci::Line docLineStart = 0, Sci::Line docLineEnd = WrapPending::lineLarge) noexcept;
 	bool WrapOneLine(Surface *surface, Sci::Line lineToWrap);
+	bool WrapLinesParallel(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd, size_t chunkCount);
 	enum class WrapScope {
 		wsAll, wsVisible, wsIdle
 	};
 	bool WrapLines(WrapScope ws);
+	bool StartBackgroundWrapping();
+	void PublishBackgroundWrapping();
+	void CancelBackgroundWrapping() noexcept;
 	void LinesJoin();
 	void LinesSplit(int pixelWidth);
 
@@ -430,6 +449,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void FilterSelections();
 	Sci::Position RealizeVirtualSpace(Sci::Position position, Sci::Position virtualSpace);
 	SelectionPosition RealizeVirtualSpace(SelectionPosition position);
+	bool ReplaceRectangularSelection(std::string_view text, bool realizeVirtualSpace);
 	void AddChar(char ch);
 	virtual void InsertCharacter(std::string_view sv, Scintilla::CharacterSource charSource);
 	void ClearBeforeTentativeStart();
@@ -492,11 +512,16 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void NotifyModifyAttempt(Document *document, void *userData) noexcept override;
 	void NotifySavePoint(Document *document, void *userData, bool atSavePoint) noexcept override;
 	void CheckModificationForWrap(DocModification mh);
+	size_t MemoryUsage(Scintilla::MemoryUsage usage) const noexcept;
+	void MoveSelections(bool insertion, Sci::Position startChange, Sci::Position length) noexcept;
 	void NotifyModified(Document *document, DocModification mh, void *userData) override;
+	void NotifyBulkModified(const DocModification &mh);
+	void NotifyParentModified(const DocModification &mh);
 	void NotifyDeleted(Document *document, void *userData) noexcept override;
 	void NotifyStyleNeeded(Document *doc, void *userData, Sci::Position endStyleNeeded) override;
 	void NotifyLexerChanged(Document *doc, void *userData) override;
 	void NotifyErrorOccurred(Document *doc, void *userData, Scintilla::Status status) noexcept override;
+	void NotifyStylingDegraded(Document *doc, void *userData, Sci::Position position) override;
 	void NotifyMacroRecord(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam) noexcept;
 
 	void ContainerNeedsUpdate(Scintilla::Update flags) noexcept;
@@ -543,6 +568,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	virtual void DisplayCursor(Window::Cursor c) noexcept;
 	virtual bool SCICALL DragThreshold(Point ptStart, Point ptNow) noexcept;
 	virtual void StartDrag();
+	bool PrepareDrop(SelectionPosition &position, bool moving, bool rectangular);
 	void DropAt(SelectionPosition position, const char *value, size_t lengthValue, bool moving, bool rectangular);
 	void DropAt(SelectionPosition position, const char *value, bool moving, bool rectangular);
 	/** PositionInSelection returns true if position in selection. */
@@ -562,7 +588,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 
 	bool Idle();
 	enum class TickReason {
-		caret, scroll, widen, dwell, platform
+		caret, scroll, widen, dwell, style, wrap, zoom, platform
 	};
 	virtual void TickFor(TickReason reason);
 	virtual bool FineTickerRunning(TickReason reason) noexcept;
@@ -579,12 +605,15 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	Sci::Position SCICALL PositionAfterArea(PRectangle rcArea) const noexcept;
 	void StyleToPositionInView(Sci::Position pos);
 	Sci::Position PositionAfterMaxStyling(Sci::Position posMax, bool scrolling) const noexcept;
+	Sci::Position PositionStylingReach(bool scrolling) const noexcept;
 	void StartIdleStyling(bool truncatedLastStyling) noexcept;
 	void SCICALL StyleAreaBounded(PRectangle rcArea, bool scrolling);
 	constexpr bool SynchronousStylingToVisible() const noexcept {
-		return (idleStyling == Scintilla::IdleStyling::None) || (idleStyling == Scintilla::IdleStyling::AfterVisible);
+		return (idleStyling == Scintilla::IdleStyling::None) || (idleStyling == Scintilla::IdleStyling::AfterVisible)
+			|| (idleStyling == Scintilla::IdleStyling::Background);
 	}
-	void IdleStyle();
+	virtual void IdleStyle();
+	void PackText();
 	virtual void IdleWork();
 	virtual void QueueIdleWork(WorkItems items, Sci::Position upTo = 0) noexcept;
 
@@ -596,6 +625,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 
 	void SetAnnotationHeights(Sci::Line start, Sci::Line end);
 	virtual void SetDocPointer(Document *document);
+	void ConvertToLargeDocument(Scintilla::DocumentOption options);
 
 	void SetAnnotationVisible(Scintilla::AnnotationVisible visible);
 	void SetEOLAnnotationVisible(Scintilla::EOLAnnotationVisible visible) noexcept;
@@ -633,6 +663,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	virtual sptr_t DefWndProc(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam) = 0;
 	bool ValidMargin(Scintilla::uptr_t wParam) const noexcept;
 	void StyleSetMessage(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam);
+	void StyleSetDefinitions(const Scintilla::StyleDefinition *definitions, size_t count);
 	Scintilla::sptr_t StyleGetMessage(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam);
 	void SetSelectionNMessage(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam) noexcept;
 
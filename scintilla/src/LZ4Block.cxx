@@ -0,0 +1,201 @@
+// Scintilla source code edit control
+/** @file LZ4Block.cxx
+ ** Compressor and decompressor for the LZ4 block format.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+/*
+ * Block is a list of sequences, each one is a token byte with literal length in high nibble and
+ * match length minus 4 in low nibble, 15 is continued by bytes added until a byte is not 255.
+ * Literals follow, then 2 bytes little endian offset of the match and the match length bytes.
+ * Last sequence has only literals, last 5 bytes are always literals and the last match starts
+ * at least 12 bytes before end, same as the reference implementation.
+ * Matches are found with a hash table of 4 bytes sequences, taking the first candidate, the
+ * step is increased while nothing matches so incompressible text is skipped quickly.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+
+#include "LZ4Block.h"
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr size_t MinMatch = 4;
+constexpr size_t LastLiterals = 5;
+constexpr size_t MatchFindLimit = 12;
+constexpr size_t MaxDistance = 0xffff;
+constexpr int HashLog = 12;
+constexpr int SkipTrigger = 6;
+
+inline uint32_t Read32(const uint8_t *ptr) noexcept {
+	uint32_t value;
+	memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+inline uint32_t Hash(uint32_t sequence) noexcept {
+	return (sequence * 2654435761U) >> (32 - HashLog);
+}
+
+inline uint8_t *WriteLength(uint8_t *op, size_t length) noexcept {
+	while (length >= 255) {
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = static_cast<uint8_t>(length);
+	return op;
+}
+
+inline bool ReadLength(const uint8_t *&ip, const uint8_t *ipEnd, size_t &length) noexcept {
+	uint8_t value;
+	do {
+		if (ip >= ipEnd) {
+			return false;
+		}
+		value = *ip++;
+		length += value;
+	} while (value == 255);
+	return true;
+}
+
+}
+
+size_t LZ4Block::Compress(const char *source, size_t length, char *dest, size_t capacity) noexcept {
+	const uint8_t * const base = reinterpret_cast<const uint8_t *>(source);
+	const uint8_t * const end = base + length;
+	const uint8_t *ip = base;
+	const uint8_t *anchor = base;
+	uint8_t *op = reinterpret_cast<uint8_t *>(dest);
+	const uint8_t * const opEnd = op + capacity;
+
+	if (length > MatchFindLimit) {
+		const uint8_t * const matchLimit = end - LastLiterals;
+		const uint8_t * const findLimit = end - MatchFindLimit;
+		// positions are verified before use, so zero filled table is fine
+		uint32_t table[1 << HashLog]{};
+		++ip;
+		size_t searched = 1 << SkipTrigger;
+		while (ip < findLimit) {
+			const uint32_t sequence = Read32(ip);
+			const uint32_t hash = Hash(sequence);
+			const uint8_t *ref = base + table[hash];
+			table[hash] = static_cast<uint32_t>(ip - base);
+			if (ref >= ip || static_cast<size_t>(ip - ref) > MaxDistance || Read32(ref) != sequence) {
+				ip += searched++ >> SkipTrigger;
+				continue;
+			}
+			searched = 1 << SkipTrigger;
+
+			while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+				--ip;
+				--ref;
+			}
+			const uint8_t *matchEnd = ip + MinMatch;
+			const uint8_t *refEnd = ref + MinMatch;
+			while (matchEnd < matchLimit && *matchEnd == *refEnd) {
+				++matchEnd;
+				++refEnd;
+			}
+
+			const size_t literalLength = ip - anchor;
+			const size_t matchLength = matchEnd - ip - MinMatch;
+			// token, lengths, literals, offset and the last literals token
+			if (static_cast<size_t>(opEnd - op) < literalLength + literalLength/255 + matchLength/255 + 6) {
+				return 0;
+			}
+			uint8_t * const token = op++;
+			*token = static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchLength, 15));
+			if (literalLength >= 15) {
+				op = WriteLength(op, literalLength - 15);
+			}
+			memcpy(op, anchor, literalLength);
+			op += literalLength;
+			const size_t offset = ip - ref;
+			*op++ = static_cast<uint8_t>(offset);
+			*op++ = static_cast<uint8_t>(offset >> 8);
+			if (matchLength >= 15) {
+				op = WriteLength(op, matchLength - 15);
+			}
+
+			ip = matchEnd;
+			anchor = ip;
+			if (ip < findLimit) {
+				table[Hash(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - base);
+			}
+		}
+	}
+
+	const size_t literalLength = end - anchor;
+	if (static_cast<size_t>(opEnd - op) < literalLength + literalLength/255 + 2) {
+		return 0;
+	}
+	if (literalLength >= 15) {
+		*op++ = 15 << 4;
+		op = WriteLength(op, literalLength - 15);
+	} else {
+		*op++ = static_cast<uint8_t>(literalLength << 4);
+	}
+	memcpy(op, anchor, literalLength);
+	op += literalLength;
+	return op - reinterpret_cast<uint8_t *>(dest);
+}
+
+bool LZ4Block::Decompress(const char *source, size_t sourceLength, char *dest, size_t length) noexcept {
+	const uint8_t *ip = reinterpret_cast<const uint8_t *>(source);
+	const uint8_t * const ipEnd = ip + sourceLength;
+	uint8_t * const base = reinterpret_cast<uint8_t *>(dest);
+	uint8_t *op = base;
+	const uint8_t * const opEnd = base + length;
+
+	while (ip < ipEnd) {
+		const unsigned token = *ip++;
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !ReadLength(ip, ipEnd, literalLength)) {
+			return false;
+		}
+		if (literalLength > static_cast<size_t>(ipEnd - ip) || literalLength > static_cast<size_t>(opEnd - op)) {
+			return false;
+		}
+		memcpy(op, ip, literalLength);
+		op += literalLength;
+		ip += literalLength;
+		if (ip == ipEnd) {
+			break;
+		}
+
+		if (ipEnd - ip < 2) {
+			return false;
+		}
+		const size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > static_cast<size_t>(op - base)) {
+			return false;
+		}
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadLength(ip, ipEnd, matchLength)) {
+			return false;
+		}
+		matchLength += MinMatch;
+		if (matchLength > static_cast<size_t>(opEnd - op)) {
+			return false;
+		}
+		const uint8_t *match = op - offset;
+		if (offset >= matchLength) {
+			memcpy(op, match, matchLength);
+			op += matchLength;
+		} else {
+			// overlapped match repeats last offset bytes
+			const uint8_t * const matchEnd = op + matchLength;
+			while (op < matchEnd) {
+				*op++ = *match++;
+			}
+		}
+	}
+	return op == opEnd;
+}
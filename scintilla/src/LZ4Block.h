@@ -0,0 +1,20 @@
+// Scintilla source code edit control
+/** @file LZ4Block.h
+ ** Compressor and decompressor for the LZ4 block format.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+#pragma once
+
+namespace Scintilla::Internal::LZ4Block {
+
+/// Size of destination buffer that is always big enough to hold length bytes compressed.
+constexpr size_t CompressBound(size_t length) noexcept {
+	return length + length/255 + 16;
+}
+
+/// Compress into dest, returns compressed length, or 0 when it doesn't fit in capacity.
+size_t Compress(const char *source, size_t length, char *dest, size_t capacity) noexcept;
+/// Decompress exactly length bytes into dest, returns false for corrupted data.
+bool Decompress(const char *source, size_t sourceLength, char *dest, size_t length) noexcept;
+
+}
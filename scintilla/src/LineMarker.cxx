@@ -31,44 +31,18 @@
 using namespace Scintilla;
 using namespace Scintilla::Internal;
 
-LineMarker::LineMarker(const LineMarker &other) : LineMarkerPod(other) {
-	CopyImage(other);
-}
-
-LineMarker &LineMarker::operator=(const LineMarker &other) {
-	if (this != &other) {
-		(LineMarkerPod &)(*this) = other;
-		CopyImage(other);
-	}
-	return *this;
-}
-
-void LineMarker::CopyImage(const LineMarker &other) {
-	// Defined to avoid pxpm and image being blindly copied.
-	if (other.pxpm) {
-		pxpm = std::make_unique<XPM>(*other.pxpm);
-	} else {
-		pxpm = nullptr;
-	}
-	if (other.image) {
-		image = std::make_unique<RGBAImage>(*other.image);
-	} else {
-		image = nullptr;
-	}
-}
-
 void LineMarker::SetXPM(const char *textForm) {
-	pxpm = std::make_unique<XPM>(textForm);
+	pxpm = SharedXPM(textForm);
 	markType = MarkerSymbol::Pixmap;
 }
 
 void LineMarker::SetXPM(const char *const *linesForm) {
-	pxpm = std::make_unique<XPM>(linesForm);
+	pxpm = SharedXPM(reinterpret_cast<const char *>(linesForm));
 	markType = MarkerSymbol::Pixmap;
 }
 
 void LineMarker::SetRGBAImage(Point sizeRGBAImage, float scale, const unsigned char *pixelsRGBAImage) {
-	image = std::make_unique<RGBAImage>(static_cast<int>(sizeRGBAImage.x), static_cast<int>(sizeRGBAImage.y), scale, pixelsRGBAImage);
+	image = SharedRGBAImage(static_cast<int>(sizeRGBAImage.x), static_cast<int>(sizeRGBAImage.y), scale, pixelsRGBAImage);
 	markType = MarkerSymbol::RgbaImage;
 }
 
@@ -36,13 +36,14 @@ public:
 		undefined, head, body, tail, headWithTail
 	};
 
-	std::unique_ptr<XPM> pxpm;
-	std::unique_ptr<RGBAImage> image;
+	// Images are immutable and shared with copies and other views, see SharedXPM()
+	std::shared_ptr<const XPM> pxpm;
+	std::shared_ptr<const RGBAImage> image;
 
 	LineMarker() noexcept = default;
-	LineMarker(const LineMarker &other);
+	LineMarker(const LineMarker &) = default;
 	LineMarker(LineMarker &&) noexcept = default;
-	LineMarker &operator=(const LineMarker& other);
+	LineMarker &operator=(const LineMarker &) = default;
 	LineMarker &operator=(LineMarker&&) noexcept = default;
 	~LineMarker() = default;
 
@@ -52,9 +53,6 @@ public:
 	void AlignedPolygon(Surface *surface, const Point *pts, size_t npts) const;
 	void SCICALL Draw(Surface *surface, PRectangle rcWhole, const Font *fontForCharacter, FoldPart part, Scintilla::MarginType marginStyle) const;
 	void SCICALL DrawFoldingMark(Surface *surface, PRectangle rcWhole, FoldPart part) const;
-
-private:
-	void CopyImage(const LineMarker &other);
 };
 
 }
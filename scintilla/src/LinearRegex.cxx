@@ -0,0 +1,1378 @@
+// Scintilla source code edit control
+/** @file LinearRegex.cxx
+ ** Regular expression engine which runs in time linear to the length of searched text.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+/*
+ * Supported syntax, similar to ECMAScript and POSIX ERE:
+ *  .  [...]  [^...]  [:alpha:] etc. inside brackets
+ *  ^  $  \b  \B  \<  \>
+ *  (...)  (?:...)  |
+ *  *  +  ?  {n}  {n,}  {n,m}, followed by ? for lazy repetition
+ *  \d  \D  \w  \W  \s  \S  \a  \e  \f  \n  \r  \t  \v  \xHH  \x{H...}  \uHHHH
+ *
+ * The pattern is parsed into a tree and compiled into a program for a Thompson NFA.
+ * Search runs all threads of the program in lock step (Pike VM), one character at a time.
+ * The visited set ensures each instruction is added at most once per character, so time is
+ * bounded by program size times text length, and nothing recurses on the text.
+ * Thread priority keeps leftmost-first submatch semantics of backtracking engines.
+ * A thread entering a loop again at the same position is dropped by the visited set, which gives
+ * the ECMAScript rule that an iteration matching empty text stops the loop. Differences from
+ * ECMAScript: captures inside a loop are not reset for each iteration, and the visited set also drops
+ * a new iteration of an outer loop reached through a lazy inner loop, so (a*?)* matches "a" in "aa".
+ * Like the other engines, matches don't cross line ends.
+ */
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+
+#include "ScintillaTypes.h"
+
+#include "Debugging.h"
+
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "CaseConvert.h"
+#include "UniConversion.h"
+#include "LinearRegex.h"
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+// invalid UTF-8 byte is treated as a single character outside Unicode range.
+constexpr unsigned int InvalidByteBase = 0x110000;
+
+constexpr size_t MaxProgramSize = 16*1024;
+constexpr int MaxNestingDepth = 128;
+constexpr int MaxRepetition = 1000;
+
+enum {
+	AssertLineStart,
+	AssertLineEnd,
+	AssertWordBoundary,
+	AssertNotWordBoundary,
+	AssertWordStart,
+	AssertWordEnd,
+};
+
+enum {
+	SetWord = 1,
+	SetNotWord = 2,
+	SetSpace = 4,
+	SetNotSpace = 8,
+	SetNotDigit = 16,
+};
+
+constexpr bool IsHexDigit(unsigned char ch) noexcept {
+	return (ch >= '0' && ch <= '9') || ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f');
+}
+
+constexpr unsigned int HexValue(unsigned char ch) noexcept {
+	return (ch <= '9') ? (ch - '0') : ((ch | 0x20) - 'a' + 10);
+}
+
+constexpr bool IsDigitChar(unsigned int ch) noexcept {
+	return ch >= '0' && ch <= '9';
+}
+
+constexpr bool IsLineEndChar(unsigned int ch) noexcept {
+	return ch == '\r' || ch == '\n';
+}
+
+// case conversion result with only one character
+unsigned int SingleCharacter(const char *s, unsigned int ch) noexcept {
+	if (s) {
+		const size_t len = strlen(s);
+		const unsigned char *us = reinterpret_cast<const unsigned char *>(s);
+		const int utf8status = UTF8Classify(us, len);
+		if (!(utf8status & UTF8MaskInvalid) && static_cast<size_t>(utf8status & UTF8MaskWidth) == len) {
+			return UnicodeFromUTF8(us);
+		}
+	}
+	return ch;
+}
+
+void AddRange(std::vector<std::pair<unsigned int, unsigned int>> &ranges, unsigned int *bits, unsigned int first, unsigned int last) {
+	for (unsigned int ch = first; ch <= std::min(last, 255U); ch++) {
+		bits[ch >> 5] |= 1U << (ch & 31);
+	}
+	if (last > 255) {
+		ranges.emplace_back(std::max(first, 256U), last);
+	}
+}
+
+}
+
+namespace Scintilla::Internal {
+
+struct LinearRegex::Node {
+	enum class Type {
+		Empty, Char, Any, Class, Assert, Concat, Alternate, Repeat, Group,
+	};
+	Type type;
+	// character, index of character set, assertion or group number
+	int value;
+	int min;
+	int max;
+	bool greedy;
+	std::vector<int> children;
+};
+
+class LinearRegex::Parser {
+public:
+	LinearRegex &re;
+	const unsigned char * const pattern;
+	const Sci::Position length;
+	Sci::Position pos = 0;
+	int groupCount = 0;
+	int depth = 0;
+	const char *error = nullptr;
+	std::vector<Node> nodes;
+	// program being emitted, reverse program matches the pattern from right to left.
+	std::vector<Inst> *code;
+	bool reverse = false;
+
+	Parser(LinearRegex &re_, const char *pattern_, Sci::Position length_) noexcept :
+		re(re_), pattern(reinterpret_cast<const unsigned char *>(pattern_)), length(length_), code(&re_.program) {}
+
+	bool AtEnd() const noexcept {
+		return pos >= length;
+	}
+	unsigned char Peek(Sci::Position offset = 0) const noexcept {
+		return (pos + offset < length) ? pattern[pos + offset] : '\0';
+	}
+	int Fail(const char *message) noexcept {
+		if (!error) {
+			error = message;
+		}
+		return -1;
+	}
+	int NewNode(Node::Type type, int value = 0) {
+		nodes.push_back({type, value, 0, 0, true, {}});
+		return static_cast<int>(nodes.size() - 1);
+	}
+	void AddChild(int parent, int child) {
+		nodes[parent].children.push_back(child);
+	}
+	int NewSet(CharSet &&set) {
+		re.charSets.push_back(std::move(set));
+		return NewNode(Node::Type::Class, static_cast<int>(re.charSets.size() - 1));
+	}
+	int Push(Op op, int x = 0, int y = 0) {
+		code->push_back({op, x, y});
+		return static_cast<int>(code->size() - 1);
+	}
+	int Here() const noexcept {
+		return static_cast<int>(code->size());
+	}
+
+	unsigned int ReadChar() noexcept;
+	bool ReadNumber(int &value) noexcept;
+	int ReadHex(int maxDigits, unsigned int &value) noexcept;
+	int ParseAlternate();
+	int ParseConcat();
+	int ParseRepeat();
+	int ParseAtom();
+	int ParseEscape();
+	int ParseClass();
+	int ParseClassEscape(CharSet &set, unsigned int &value);
+	int ParsePosixClass(CharSet &set);
+	void Emit(int index);
+};
+
+unsigned int LinearRegex::Parser::ReadChar() noexcept {
+	const unsigned char ch = pattern[pos];
+	if (UTF8IsAscii(ch) || re.encoding.codePage == 0) {
+		pos++;
+		return ch;
+	}
+	if (re.encoding.codePage == CpUtf8) {
+		const int utf8status = UTF8Classify(pattern + pos, length - pos);
+		if (utf8status & UTF8MaskInvalid) {
+			pos++;
+			return InvalidByteBase + ch;
+		}
+		const unsigned int value = UnicodeFromUTF8(pattern + pos);
+		pos += utf8status & UTF8MaskWidth;
+		return value;
+	}
+	if (re.encoding.dbcsCharClass->IsLeadByte(ch) && pos + 1 < length) {
+		const unsigned char trail = pattern[pos + 1];
+		if (re.encoding.dbcsCharClass->IsTrailByte(trail)) {
+			pos += 2;
+			return (ch << 8) | trail;
+		}
+	}
+	pos++;
+	return ch;
+}
+
+bool LinearRegex::Parser::ReadNumber(int &value) noexcept {
+	if (!IsDigitChar(Peek())) {
+		return false;
+	}
+	value = 0;
+	while (IsDigitChar(Peek())) {
+		value = std::min(value*10 + (Peek() - '0'), MaxRepetition + 1);
+		pos++;
+	}
+	return true;
+}
+
+int LinearRegex::Parser::ReadHex(int maxDigits, unsigned int &value) noexcept {
+	int count = 0;
+	value = 0;
+	while (count < maxDigits && IsHexDigit(Peek())) {
+		value = (value << 4) | HexValue(Peek());
+		pos++;
+		count++;
+	}
+	return count;
+}
+
+int LinearRegex::Parser::ParseAlternate() {
+	if (++depth > MaxNestingDepth) {
+		return Fail("Regular expression is nested too deeply");
+	}
+	int node = ParseConcat();
+	if (node >= 0 && Peek() == '|' && !AtEnd()) {
+		const int first = node;
+		node = NewNode(Node::Type::Alternate);
+		AddChild(node, first);
+		while (Peek() == '|' && !AtEnd()) {
+			pos++;
+			const int child = ParseConcat();
+			if (child < 0) {
+				return -1;
+			}
+			AddChild(node, child);
+		}
+	}
+	depth--;
+	return node;
+}
+
+int LinearRegex::Parser::ParseConcat() {
+	const int node = NewNode(Node::Type::Concat);
+	while (!AtEnd() && Peek() != '|' && Peek() != ')') {
+		const int child = ParseRepeat();
+		if (child < 0) {
+			return -1;
+		}
+		AddChild(node, child);
+	}
+	return node;
+}
+
+int LinearRegex::Parser::ParseRepeat() {
+	int atom = ParseAtom();
+	while (atom >= 0 && !AtEnd()) {
+		int min = 0;
+		int max = -1;
+		const unsigned char ch = Peek();
+		if (ch == '*') {
+			pos++;
+		} else if (ch == '+') {
+			pos++;
+			min = 1;
+		} else if (ch == '?') {
+			pos++;
+			max = 1;
+		} else if (ch == '{') {
+			// not a counted repetition is treated as literal brace
+			const Sci::Position start = pos;
+			pos++;
+			if (!ReadNumber(min)) {
+				pos = start;
+				break;
+			}
+			max = min;
+			if (Peek() == ',') {
+				pos++;
+				max = -1;
+				if (Peek() != '}' && !ReadNumber(max)) {
+					pos = start;
+					break;
+				}
+			}
+			if (Peek() != '}') {
+				pos = start;
+				break;
+			}
+			pos++;
+			if (min > MaxRepetition || max > MaxRepetition) {
+				return Fail("Repetition count is too large");
+			}
+			if (max >= 0 && max < min) {
+				return Fail("Invalid repetition count");
+			}
+		} else {
+			break;
+		}
+
+		const int node = NewNode(Node::Type::Repeat);
+		nodes[node].min = min;
+		nodes[node].max = max;
+		if (Peek() == '?' && !AtEnd()) {
+			pos++;
+			nodes[node].greedy = false;
+		}
+		AddChild(node, atom);
+		atom = node;
+	}
+	return atom;
+}
+
+int LinearRegex::Parser::ParseAtom() {
+	const unsigned char ch = Peek();
+	switch (ch) {
+	case '(': {
+		pos++;
+		int group = -1;
+		if (Peek() == '?') {
+			if (Peek(1) != ':') {
+				return Fail("Unsupported group");
+			}
+			pos += 2;
+		} else {
+			group = ++groupCount;
+		}
+		const int child = ParseAlternate();
+		if (child < 0) {
+			return -1;
+		}
+		if (Peek() != ')' || AtEnd()) {
+			return Fail("Missing )");
+		}
+		pos++;
+		const int node = NewNode(Node::Type::Group, group);
+		AddChild(node, child);
+		return node;
+	}
+
+	case '[':
+		pos++;
+		return ParseClass();
+
+	case '.':
+		pos++;
+		return NewNode(Node::Type::Any);
+
+	case '^':
+		pos++;
+		return NewNode(Node::Type::Assert, AssertLineStart);
+
+	case '$':
+		pos++;
+		return NewNode(Node::Type::Assert, AssertLineEnd);
+
+	case '\\':
+		pos++;
+		return ParseEscape();
+
+	case '*':
+	case '+':
+	case '?':
+		return Fail("Nothing to repeat");
+
+	default:
+		return NewNode(Node::Type::Char, ReadChar());
+	}
+}
+
+int LinearRegex::Parser::ParseEscape() {
+	if (AtEnd()) {
+		return Fail("Trailing backslash");
+	}
+	const unsigned char ch = Peek();
+	switch (ch) {
+	case 'b':
+		pos++;
+		return NewNode(Node::Type::Assert, AssertWordBoundary);
+	case 'B':
+		pos++;
+		return NewNode(Node::Type::Assert, AssertNotWordBoundary);
+	case '<':
+		pos++;
+		return NewNode(Node::Type::Assert, AssertWordStart);
+	case '>':
+		pos++;
+		return NewNode(Node::Type::Assert, AssertWordEnd);
+	default:
+		if (ch >= '1' && ch <= '9') {
+			return Fail("Back reference is not supported");
+		}
+		break;
+	}
+
+	CharSet set{};
+	unsigned int value = 0;
+	const int result = ParseClassEscape(set, value);
+	if (result < 0) {
+		return -1;
+	}
+	if (result > 0) {
+		return NewSet(std::move(set));
+	}
+	return NewNode(Node::Type::Char, value);
+}
+
+// returns 1 when a class is added to set, 0 for single character, -1 for error.
+int LinearRegex::Parser::ParseClassEscape(CharSet &set, unsigned int &value) {
+	const unsigned char ch = Peek();
+	pos++;
+	switch (ch) {
+	case 'd':
+		AddRange(set.ranges, set.bits, '0', '9');
+		return 1;
+	case 'D':
+		set.flags |= SetNotDigit;
+		return 1;
+	case 'w':
+		set.flags |= SetWord;
+		return 1;
+	case 'W':
+		set.flags |= SetNotWord;
+		return 1;
+	case 's':
+		set.flags |= SetSpace;
+		return 1;
+	case 'S':
+		set.flags |= SetNotSpace;
+		return 1;
+
+	case 'a':
+		value = '\a';
+		return 0;
+	case 'b':
+		value = '\b';
+		return 0;
+	case 'e':
+		value = 0x1B;
+		return 0;
+	case 'f':
+		value = '\f';
+		return 0;
+	case 'n':
+		value = '\n';
+		return 0;
+	case 'r':
+		value = '\r';
+		return 0;
+	case 't':
+		value = '\t';
+		return 0;
+	case 'v':
+		value = '\v';
+		return 0;
+
+	case 'x':
+		if (Peek() == '{') {
+			pos++;
+			if (ReadHex(6, value) == 0 || Peek() != '}') {
+				return Fail("Invalid hexadecimal escape");
+			}
+			pos++;
+		} else if (ReadHex(2, value) != 2) {
+			return Fail("Invalid hexadecimal escape");
+		}
+		return 0;
+	case 'u':
+		if (ReadHex(4, value) != 4) {
+			return Fail("Invalid Unicode escape");
+		}
+		return 0;
+
+	default:
+		// escaped punctuation or other literal character
+		pos--;
+		value = ReadChar();
+		return 0;
+	}
+}
+
+// returns 1 for [:name:], 0 when it's a literal bracket, -1 for unknown class name.
+int LinearRegex::Parser::ParsePosixClass(CharSet &set) {
+	Sci::Position end = pos + 2;
+	while (end + 1 < length && !(pattern[end] == ':' && pattern[end + 1] == ']')) {
+		if (pattern[end] == ']') {
+			return 0;
+		}
+		end++;
+	}
+	if (end + 1 >= length) {
+		return 0;
+	}
+
+	const std::string_view name(reinterpret_cast<const char *>(pattern + pos + 2), end - pos - 2);
+	auto &ranges = set.ranges;
+	unsigned int * const bits = set.bits;
+	if (name == "alpha" || name == "alnum" || name == "upper" || name == "xdigit") {
+		if (name == "xdigit") {
+			AddRange(ranges, bits, 'A', 'F');
+			AddRange(ranges, bits, 'a', 'f');
+		} else {
+			AddRange(ranges, bits, 'A', 'Z');
+		}
+		if (name[1] == 'l') {
+			AddRange(ranges, bits, 'a', 'z');
+		}
+		if (name[2] == 'n' || name[0] == 'x') {
+			AddRange(ranges, bits, '0', '9');
+		}
+	} else if (name == "lower") {
+		AddRange(ranges, bits, 'a', 'z');
+	} else if (name == "digit") {
+		AddRange(ranges, bits, '0', '9');
+	} else if (name == "space") {
+		set.flags |= SetSpace;
+	} else if (name == "blank") {
+		AddRange(ranges, bits, ' ', ' ');
+		AddRange(ranges, bits, '\t', '\t');
+	} else if (name == "word") {
+		set.flags |= SetWord;
+	} else if (name == "punct") {
+		AddRange(ranges, bits, 0x21, 0x2F);
+		AddRange(ranges, bits, 0x3A, 0x40);
+		AddRange(ranges, bits, 0x5B, 0x60);
+		AddRange(ranges, bits, 0x7B, 0x7E);
+	} else if (name == "cntrl") {
+		AddRange(ranges, bits, 0x00, 0x1F);
+		AddRange(ranges, bits, 0x7F, 0x7F);
+	} else if (name == "print") {
+		AddRange(ranges, bits, 0x20, 0x7E);
+	} else if (name == "graph") {
+		AddRange(ranges, bits, 0x21, 0x7E);
+	} else {
+		return Fail("Unknown character class");
+	}
+	pos = end + 2;
+	return 1;
+}
+
+int LinearRegex::Parser::ParseClass() {
+	CharSet set{};
+	if (Peek() == '^' && !AtEnd()) {
+		pos++;
+		set.negated = true;
+	}
+	bool first = true;
+	while (true) {
+		if (AtEnd()) {
+			return Fail("Missing ]");
+		}
+		const unsigned char ch = Peek();
+		if (ch == ']' && !first) {
+			pos++;
+			break;
+		}
+		first = false;
+		if (ch == '[' && Peek(1) == ':') {
+			const int result = ParsePosixClass(set);
+			if (result < 0) {
+				return -1;
+			}
+			if (result > 0) {
+				continue;
+			}
+		}
+
+		unsigned int low = 0;
+		if (ch == '\\' && pos + 1 < length) {
+			pos++;
+			const int result = ParseClassEscape(set, low);
+			if (result < 0) {
+				return -1;
+			}
+			if (result > 0) {
+				continue;
+			}
+		} else {
+			low = ReadChar();
+		}
+		unsigned int high = low;
+		if (Peek() == '-' && pos + 1 < length && Peek(1) != ']') {
+			pos++;
+			if (Peek() == '\\' && pos + 1 < length) {
+				pos++;
+				CharSet dummy{};
+				if (ParseClassEscape(dummy, high) != 0) {
+					return Fail("Invalid range in character class");
+				}
+			} else {
+				high = ReadChar();
+			}
+			if (high < low) {
+				return Fail("Invalid range in character class");
+			}
+		}
+		AddRange(set.ranges, set.bits, low, high);
+	}
+	return NewSet(std::move(set));
+}
+
+void LinearRegex::Parser::Emit(int index) {
+	if (error) {
+		return;
+	}
+	if (code->size() > MaxProgramSize) {
+		Fail("Regular expression is too large");
+		return;
+	}
+
+	const Node &node = nodes[index];
+	switch (node.type) {
+	case Node::Type::Empty:
+		break;
+
+	case Node::Type::Char:
+		Push(Op::Char, static_cast<int>(re.caseSensitive ? node.value : re.FoldCase(node.value)));
+		break;
+
+	case Node::Type::Any:
+		Push(Op::Any);
+		break;
+
+	case Node::Type::Class:
+		Push(Op::Class, node.value);
+		break;
+
+	case Node::Type::Assert:
+		Push(Op::Assert, node.value);
+		break;
+
+	case Node::Type::Concat:
+		if (reverse) {
+			for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+				Emit(*it);
+			}
+		} else {
+			for (const int child : node.children) {
+				Emit(child);
+			}
+		}
+		break;
+
+	case Node::Type::Alternate: {
+		// split L1, L2; L1: first; jmp end; L2: split ... last; end:
+		std::vector<int> jumps;
+		const size_t last = node.children.size() - 1;
+		for (size_t i = 0; i < last; i++) {
+			const int split = Push(Op::Split, Here() + 1);
+			Emit(node.children[i]);
+			jumps.push_back(Push(Op::Jmp));
+			(*code)[split].y = Here();
+		}
+		Emit(node.children[last]);
+		for (const int jump : jumps) {
+			(*code)[jump].x = Here();
+		}
+	} break;
+
+	case Node::Type::Repeat: {
+		const int child = node.children[0];
+		for (int i = 0; i < node.min; i++) {
+			Emit(child);
+		}
+		if (node.max < 0) {
+			// loop: split body, end; body; jmp loop; end:
+			const int split = Push(Op::Split);
+			Emit(child);
+			Push(Op::Jmp, split);
+			(*code)[split].x = node.greedy ? split + 1 : Here();
+			(*code)[split].y = node.greedy ? Here() : split + 1;
+		} else {
+			// optional copies: split body, end; body; split body, end; body ... end:
+			std::vector<int> splits;
+			for (int i = node.min; i < node.max; i++) {
+				splits.push_back(Push(Op::Split));
+				Emit(child);
+			}
+			const int end = Here();
+			for (const int split : splits) {
+				(*code)[split].x = node.greedy ? split + 1 : end;
+				(*code)[split].y = node.greedy ? end : split + 1;
+			}
+		}
+	} break;
+
+	case Node::Type::Group: {
+		const int slot = 2*node.value;
+		// reverse program only finds match start, groups are filled by forward program
+		const bool capture = !reverse && node.value > 0 && node.value < MaxGroup;
+		if (capture) {
+			Push(Op::Save, slot);
+		}
+		Emit(node.children[0]);
+		if (capture) {
+			Push(Op::Save, slot + 1);
+		}
+	} break;
+	}
+}
+
+void LinearRegex::ThreadList::Resize(int count, int slots) {
+	sparse.assign(count, 0);
+	dense.assign(count, 0);
+	caps.resize(static_cast<size_t>(count)*slots);
+	slotCount = slots;
+	size = 0;
+}
+
+}
+
+LinearRegex::LinearRegex() noexcept : groupStart{}, groupEnd{}, slotCount{0}, caseSensitive{true},
+	encoding{}, firstSet{}, lastSet{} {
+}
+
+void LinearRegex::ClearCache() noexcept {
+	// compiled character classes depend on word characters
+	program.clear();
+	reverseProgram.clear();
+	charSets.clear();
+	cachedPattern.clear();
+}
+
+const char *LinearRegex::Compile(const char *pattern, Sci::Position length, bool caseSensitive_, const Encoding &encoding_) {
+	if (!program.empty() && caseSensitive == caseSensitive_ && encoding.codePage == encoding_.codePage
+		&& cachedPattern == std::string_view(pattern, length)) {
+		return nullptr;
+	}
+
+	ClearCache();
+	caseSensitive = caseSensitive_;
+	encoding = encoding_;
+	Parser parser(*this, pattern, length);
+	const int root = parser.ParseAlternate();
+	if (root >= 0 && !parser.AtEnd()) {
+		parser.Fail("Unmatched )");
+	}
+	if (!parser.error) {
+		slotCount = 2*std::min(parser.groupCount + 1, MaxGroup);
+		parser.Push(Op::Save, 0);
+		parser.Emit(root);
+		parser.Push(Op::Save, 1);
+		parser.Push(Op::Match);
+		if (encoding.codePage == 0 || encoding.codePage == CpUtf8) {
+			parser.code = &reverseProgram;
+			parser.reverse = true;
+			parser.Emit(root);
+			parser.Push(Op::Match);
+		}
+	}
+	if (parser.error) {
+		ClearCache();
+		return parser.error;
+	}
+
+	cachedPattern.assign(pattern, length);
+	const int count = static_cast<int>(std::max(program.size(), reverseProgram.size()));
+	clist.Resize(count, slotCount);
+	nlist.Resize(count, slotCount);
+	stack.reserve(2*count);
+	scratch.resize(slotCount);
+	BuildByteSet(program, false, firstSet);
+	BuildByteSet(reverseProgram, true, lastSet);
+	return nullptr;
+}
+
+LinearRegex::CharInfo LinearRegex::CharAt(const SplitView &view, Sci::Position pos) const noexcept {
+	const unsigned char ch = view.CharAt(pos);
+	if (UTF8IsAscii(ch) || encoding.codePage == 0) {
+		return {ch, 1};
+	}
+	const size_t avail = std::min<size_t>(UTF8MaxBytes, view.length - pos);
+	if (encoding.codePage == CpUtf8) {
+		unsigned char bytes[UTF8MaxBytes] = { ch, 0, 0, 0 };
+		for (size_t i = 1; i < avail; i++) {
+			bytes[i] = view.CharAt(pos + i);
+		}
+		const int utf8status = UTF8Classify(bytes, avail);
+		if (utf8status & UTF8MaskInvalid) {
+			return {InvalidByteBase + ch, 1};
+		}
+		return {static_cast<unsigned int>(UnicodeFromUTF8(bytes)), utf8status & UTF8MaskWidth};
+	}
+	if (encoding.dbcsCharClass->IsLeadByte(ch) && avail > 1) {
+		const unsigned char trail = view.CharAt(pos + 1);
+		if (encoding.dbcsCharClass->IsTrailByte(trail)) {
+			return {static_cast<unsigned int>((ch << 8) | trail), 2};
+		}
+	}
+	return {ch, 1};
+}
+
+// only used for single byte encoding and UTF-8, DBCS can't be decoded backward.
+LinearRegex::CharInfo LinearRegex::CharBefore(const SplitView &view, Sci::Position pos) const noexcept {
+	Sci::Position start = pos - 1;
+	if (encoding.codePage == CpUtf8) {
+		const Sci::Position limit = std::max<Sci::Position>(0, pos - UTF8MaxBytes);
+		while (start > limit && UTF8IsTrailByte(view.CharAt(start))) {
+			start--;
+		}
+		const CharInfo info = CharAt(view, start);
+		if (start + info.width == pos) {
+			return info;
+		}
+		start = pos - 1;
+	}
+	return CharAt(view, start);
+}
+
+unsigned int LinearRegex::FoldCase(unsigned int ch) const {
+	if (ch < 0x80) {
+		return (ch >= 'A' && ch <= 'Z') ? (ch - 'A' + 'a') : ch;
+	}
+	if (encoding.codePage == CpUtf8 && ch < InvalidByteBase) {
+		return SingleCharacter(CaseConvert(ch, CaseConversion::fold), ch);
+	}
+	return ch;
+}
+
+unsigned int LinearRegex::UpperCase(unsigned int ch) const {
+	if (ch < 0x80) {
+		return (ch >= 'a' && ch <= 'z') ? (ch - 'a' + 'A') : ch;
+	}
+	if (encoding.codePage == CpUtf8 && ch < InvalidByteBase) {
+		return SingleCharacter(CaseConvert(ch, CaseConversion::upper), ch);
+	}
+	return ch;
+}
+
+bool LinearRegex::IsWordChar(unsigned int ch) const noexcept {
+	if (ch < 0x80 || (encoding.codePage == 0 && ch < 256)) {
+		return encoding.charClass->IsWord(static_cast<unsigned char>(ch));
+	}
+	CharacterClass cc = CharacterClass::space;
+	if (encoding.codePage == CpUtf8) {
+		if (ch < InvalidByteBase) {
+			cc = CharClassify::ClassifyCharacter(ch);
+		}
+	} else if (encoding.codePage != 0) {
+		cc = encoding.dbcsCharClass->ClassifyCharacter(ch);
+	}
+	return cc == CharacterClass::word || cc == CharacterClass::cjkWord;
+}
+
+bool LinearRegex::IsSpaceChar(unsigned int ch) const noexcept {
+	if (ch == ' ' || (ch >= '\t' && ch <= '\r')) {
+		return true;
+	}
+	if (encoding.codePage == CpUtf8) {
+		return ch == 0x85 || ch == 0xA0 || ch == 0x1680 || (ch >= 0x2000 && ch <= 0x200A)
+			|| ch == 0x2028 || ch == 0x2029 || ch == 0x202F || ch == 0x205F || ch == 0x3000 || ch == 0xFEFF;
+	}
+	return false;
+}
+
+bool LinearRegex::SetContains(const CharSet &set, unsigned int ch) const noexcept {
+	if (ch < 256) {
+		if (set.bits[ch >> 5] & (1U << (ch & 31))) {
+			return true;
+		}
+	} else {
+		for (const auto &range : set.ranges) {
+			if (ch >= range.first && ch <= range.second) {
+				return true;
+			}
+		}
+	}
+	const int flags = set.flags;
+	if (flags) {
+		if (flags & (SetWord | SetNotWord)) {
+			const bool word = IsWordChar(ch);
+			if ((word && (flags & SetWord)) || (!word && (flags & SetNotWord))) {
+				return true;
+			}
+		}
+		if (flags & (SetSpace | SetNotSpace)) {
+			const bool space = IsSpaceChar(ch);
+			if ((space && (flags & SetSpace)) || (!space && (flags & SetNotSpace))) {
+				return true;
+			}
+		}
+		if ((flags & SetNotDigit) && !IsDigitChar(ch)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool LinearRegex::ClassMatches(const CharSet &set, unsigned int ch, unsigned int folded, unsigned int upper) const noexcept {
+	bool matched = SetContains(set, ch);
+	if (!matched && !caseSensitive) {
+		matched = (folded != ch && SetContains(set, folded)) || (upper != ch && SetContains(set, upper));
+	}
+	return matched != set.negated;
+}
+
+LinearRegex::Context LinearRegex::MakeContext(const SplitView &view, Sci::Position pos, CharInfo prev, CharInfo cur) const noexcept {
+	Context ctx;
+	// no line start or end between CR and LF
+	ctx.lineStart = pos == 0 || prev.ch == '\n' || (prev.ch == '\r' && cur.ch != '\n');
+	ctx.lineEnd = static_cast<size_t>(pos) >= view.length || cur.ch == '\r' || (cur.ch == '\n' && prev.ch != '\r');
+	ctx.prevWord = prev.width != 0 && IsWordChar(prev.ch);
+	ctx.curWord = cur.width != 0 && IsWordChar(cur.ch);
+	return ctx;
+}
+
+void LinearRegex::AddThread(const std::vector<Inst> &code, ThreadList &list, int pc, Sci::Position pos, Sci::Position *caps, const Context &ctx) {
+	// explicit stack instead of recursion, entry with slot restores the capture after
+	// all threads following the save instruction are added.
+	stack.clear();
+	stack.push_back({pc, -1, 0});
+	while (!stack.empty()) {
+		const StackEntry entry = stack.back();
+		stack.pop_back();
+		if (entry.slot >= 0) {
+			caps[entry.slot] = entry.value;
+			continue;
+		}
+
+		pc = entry.pc;
+		bool follow = true;
+		while (follow && !list.Contains(pc)) {
+			const int index = list.Insert(pc);
+			const Inst &inst = code[pc];
+			switch (inst.op) {
+			case Op::Jmp:
+				pc = inst.x;
+				break;
+
+			case Op::Split:
+				stack.push_back({inst.y, -1, 0});
+				pc = inst.x;
+				break;
+
+			case Op::Save:
+				stack.push_back({0, inst.x, caps[inst.x]});
+				caps[inst.x] = pos;
+				pc++;
+				break;
+
+			case Op::Assert: {
+				bool matched = false;
+				switch (inst.x) {
+				case AssertLineStart:
+					matched = ctx.lineStart;
+					break;
+				case AssertLineEnd:
+					matched = ctx.lineEnd;
+					break;
+				case AssertWordBoundary:
+					matched = ctx.prevWord != ctx.curWord;
+					break;
+				case AssertNotWordBoundary:
+					matched = ctx.prevWord == ctx.curWord;
+					break;
+				case AssertWordStart:
+					matched = !ctx.prevWord && ctx.curWord;
+					break;
+				case AssertWordEnd:
+					matched = ctx.prevWord && !ctx.curWord;
+					break;
+				default:
+					break;
+				}
+				follow = matched;
+				pc++;
+			} break;
+
+			default:
+				std::copy_n(caps, slotCount, list.Caps(index));
+				follow = false;
+				break;
+			}
+		}
+	}
+}
+
+void LinearRegex::BuildByteSet(const std::vector<Inst> &code, bool reverse, ByteSet &set) {
+	set.enabled = false;
+	if (code.empty() || (encoding.codePage != 0 && encoding.codePage != CpUtf8)) {
+		// can't skip bytes as trail byte of DBCS character may be same as a lead byte.
+		return;
+	}
+
+	bool * const bytes = set.bytes;
+	std::fill_n(bytes, sizeof(set.bytes), false);
+	std::vector<bool> visited(code.size());
+	std::vector<int> pending{0};
+	while (!pending.empty()) {
+		int pc = pending.back();
+		pending.pop_back();
+		bool follow = true;
+		while (follow && !visited[pc]) {
+			visited[pc] = true;
+			const Inst &inst = code[pc];
+			switch (inst.op) {
+			case Op::Match:
+				// empty match, every position is a candidate
+				return;
+
+			case Op::Jmp:
+				pc = inst.x;
+				break;
+
+			case Op::Split:
+				pending.push_back(inst.y);
+				pc = inst.x;
+				break;
+
+			case Op::Save:
+			case Op::Assert:
+				pc++;
+				break;
+
+			case Op::Char: {
+				const unsigned int ch = inst.x;
+				// reverse program is matched from last byte of the character
+				const unsigned char nonAsciiFirst = reverse ? 0x80 : 0xC0;
+				const unsigned char nonAsciiLast = reverse ? 0xBF : 0xFF;
+				if (ch < 0x80) {
+					bytes[ch] = true;
+					if (!caseSensitive) {
+						bytes[UpperCase(ch)] = true;
+						if (encoding.codePage == CpUtf8 && UpperCase(ch) != ch) {
+							// non-ASCII character may fold into ASCII letter, e.g. Kelvin sign
+							std::fill(bytes + nonAsciiFirst, bytes + nonAsciiLast + 1, true);
+						}
+					}
+				} else if (encoding.codePage == 0 || ch >= InvalidByteBase) {
+					bytes[ch & 0xff] = true;
+				} else if (caseSensitive) {
+					char utf8[UTF8MaxBytes + 1]{};
+					UTF8FromUTF32Character(ch, utf8);
+					const size_t index = reverse ? strlen(utf8) - 1 : 0;
+					bytes[static_cast<unsigned char>(utf8[index])] = true;
+				} else {
+					std::fill(bytes + nonAsciiFirst, bytes + nonAsciiLast + 1, true);
+				}
+				follow = false;
+			} break;
+
+			default:
+				// Any or Class
+				for (unsigned int ch = 0; ch < 256; ch++) {
+					if (IsLineEndChar(ch)) {
+						continue;
+					}
+					if (inst.op == Op::Any || (ch >= 0x80 && encoding.codePage == CpUtf8)) {
+						bytes[ch] = true;
+					} else {
+						const unsigned int folded = caseSensitive ? ch : FoldCase(ch);
+						const unsigned int upper = caseSensitive ? ch : UpperCase(ch);
+						bytes[ch] |= ClassMatches(charSets[inst.x], ch, folded, upper);
+					}
+				}
+				follow = false;
+				break;
+			}
+		}
+	}
+
+	set.count = 0;
+	for (unsigned int ch = 0; ch < 256; ch++) {
+		if (bytes[ch]) {
+			set.count++;
+			set.single = static_cast<unsigned char>(ch);
+		}
+	}
+	set.enabled = set.count < 256 - 2;
+}
+
+Sci::Position LinearRegex::NextCandidate(const SplitView &view, Sci::Position pos, Sci::Position endPos) const noexcept {
+	// scan the two contiguous segments directly
+	const Sci::Position length1 = view.length1;
+	while (pos < endPos) {
+		const char *segment = view.segment2;
+		Sci::Position segmentEnd = endPos;
+		if (pos < length1) {
+			segment = view.segment1;
+			segmentEnd = std::min(endPos, length1);
+		}
+		if (firstSet.count == 1) {
+			const void *found = memchr(segment + pos, firstSet.single, segmentEnd - pos);
+			if (found) {
+				return static_cast<const char *>(found) - segment;
+			}
+		} else {
+			for (; pos < segmentEnd; pos++) {
+				if (firstSet.bytes[static_cast<unsigned char>(segment[pos])]) {
+					return pos;
+				}
+			}
+		}
+		pos = segmentEnd;
+	}
+	return endPos;
+}
+
+Sci::Position LinearRegex::PrevCandidate(const SplitView &view, Sci::Position pos, Sci::Position startPos) const noexcept {
+	// returns position after the byte which can end a match
+	const Sci::Position length1 = view.length1;
+	while (pos > startPos) {
+		const char *segment = view.segment1;
+		Sci::Position segmentStart = startPos;
+		if (pos > length1) {
+			segment = view.segment2;
+			segmentStart = std::max(startPos, length1);
+		}
+		for (; pos > segmentStart; pos--) {
+			if (lastSet.bytes[static_cast<unsigned char>(segment[pos - 1])]) {
+				return pos;
+			}
+		}
+	}
+	return startPos;
+}
+
+Sci::Position LinearRegex::ReverseSearch(const SplitView &view, Sci::Position startPos, Sci::Position endPos) {
+	const Sci::Position docLength = view.length;
+	Sci::Position pos = endPos;
+	CharInfo before{0, 0};
+	CharInfo after{0, 0};
+	if (pos > 0) {
+		before = CharBefore(view, pos);
+	}
+	if (pos < docLength) {
+		after = CharAt(view, pos);
+	}
+
+	clist.size = 0;
+	while (true) {
+		if (clist.size == 0 && lastSet.enabled) {
+			Sci::Position prev = PrevCandidate(view, pos, startPos);
+			if (encoding.codePage == CpUtf8) {
+				// skip trail bytes inside valid character
+				while (prev > startPos && UTF8IsTrailByte(view.CharAt(prev - 1))) {
+					Sci::Position start = prev - 1;
+					const Sci::Position limit = std::max<Sci::Position>(0, prev - UTF8MaxBytes);
+					while (start > limit && UTF8IsTrailByte(view.CharAt(start))) {
+						start--;
+					}
+					const CharInfo info = CharAt(view, start);
+					if (start + info.width <= prev) {
+						break;
+					}
+					prev = PrevCandidate(view, start, startPos);
+				}
+			}
+			if (prev <= startPos) {
+				return NotFound;
+			}
+			if (prev != pos) {
+				pos = prev;
+				before = CharBefore(view, pos);
+				after = CharAt(view, pos);
+			}
+		}
+
+		// lowest priority thread for match ending at current position
+		const Context ctx = MakeContext(view, pos, before, after);
+		AddThread(reverseProgram, clist, 0, pos, scratch.data(), ctx);
+
+		const bool consume = pos > startPos && !IsLineEndChar(before.ch);
+		const Sci::Position nextPos = pos - before.width;
+		CharInfo next{0, 0};
+		if (nextPos > 0) {
+			next = CharBefore(view, nextPos);
+		}
+		Context nextCtx{};
+		unsigned int folded = before.ch;
+		unsigned int upper = before.ch;
+		if (consume) {
+			nextCtx = MakeContext(view, nextPos, next, before);
+			if (!caseSensitive) {
+				folded = FoldCase(before.ch);
+				upper = UpperCase(before.ch);
+			}
+		}
+
+		nlist.size = 0;
+		for (int i = 0; i < clist.size; i++) {
+			const int pc = clist.dense[i];
+			const Inst &inst = reverseProgram[pc];
+			bool step = false;
+			switch (inst.op) {
+			case Op::Match:
+				// positions are visited backward, so this is the greatest match start
+				return pos;
+			case Op::Char:
+				step = consume && static_cast<unsigned int>(inst.x) == folded;
+				break;
+			case Op::Any:
+				step = consume;
+				break;
+			case Op::Class:
+				step = consume && ClassMatches(charSets[inst.x], before.ch, folded, upper);
+				break;
+			default:
+				break;
+			}
+			if (step) {
+				AddThread(reverseProgram, nlist, pc + 1, nextPos, scratch.data(), nextCtx);
+			}
+		}
+		std::swap(clist, nlist);
+
+		if (pos <= startPos) {
+			break;
+		}
+		after = before;
+		before = next;
+		pos = nextPos;
+	}
+	return NotFound;
+}
+
+bool LinearRegex::SearchBackward(const SplitView &view, Sci::Position startPos, Sci::Position endPos) {
+	std::fill_n(groupStart, MaxGroup, NotFound);
+	std::fill_n(groupEnd, MaxGroup, NotFound);
+	if (reverseProgram.empty()) {
+		return false;
+	}
+
+	const Sci::Position matchStart = ReverseSearch(view, startPos, endPos);
+	if (matchStart == NotFound) {
+		return false;
+	}
+	// rerun forward program from the start to find match length and fill groups
+	const Sci::Position prevPos = (matchStart > 0) ? matchStart - CharBefore(view, matchStart).width : -1;
+	return Search(view, matchStart, endPos, prevPos, true);
+}
+
+bool LinearRegex::Search(const SplitView &view, Sci::Position startPos, Sci::Position endPos, Sci::Position prevPos, bool anchored) {
+	std::fill_n(groupStart, MaxGroup, NotFound);
+	std::fill_n(groupEnd, MaxGroup, NotFound);
+	if (program.empty()) {
+		return false;
+	}
+
+	const Sci::Position docLength = view.length;
+	Sci::Position pos = startPos;
+	CharInfo prev{0, 0};
+	CharInfo cur{0, 0};
+	if (prevPos >= 0) {
+		prev = CharAt(view, prevPos);
+	}
+	if (pos < docLength) {
+		cur = CharAt(view, pos);
+	}
+
+	bool matched = false;
+	clist.size = 0;
+	while (true) {
+		if (!matched && clist.size == 0 && firstSet.enabled && !anchored) {
+			Sci::Position next = NextCandidate(view, pos, endPos);
+			if (encoding.codePage == CpUtf8) {
+				// skip over trail bytes of valid character
+				while (next < endPos && UTF8IsTrailByte(view.CharAt(next))) {
+					Sci::Position start = next - 1;
+					const Sci::Position limit = std::max<Sci::Position>(0, next - UTF8MaxBytes);
+					while (start > limit && UTF8IsTrailByte(view.CharAt(start))) {
+						start--;
+					}
+					const CharInfo info = CharAt(view, start);
+					if (start + info.width <= next) {
+						// invalid trail byte is a character itself
+						break;
+					}
+					next = NextCandidate(view, start + info.width, endPos);
+				}
+			}
+			if (next >= endPos) {
+				return false;
+			}
+			if (next != pos) {
+				pos = next;
+				prev = CharBefore(view, pos);
+				cur = CharAt(view, pos);
+			}
+		}
+
+		if (!matched && (!anchored || pos == startPos)) {
+			// lowest priority thread for match starting at current position
+			const Context ctx = MakeContext(view, pos, prev, cur);
+			std::fill(scratch.begin(), scratch.end(), NotFound);
+			AddThread(program, clist, 0, pos, scratch.data(), ctx);
+		}
+
+		const bool consume = pos < endPos && !IsLineEndChar(cur.ch);
+		const Sci::Position nextPos = pos + cur.width;
+		CharInfo next{0, 0};
+		if (nextPos < docLength) {
+			next = CharAt(view, nextPos);
+		}
+		Context nextCtx{};
+		unsigned int folded = cur.ch;
+		unsigned int upper = cur.ch;
+		if (consume) {
+			nextCtx = MakeContext(view, nextPos, cur, next);
+			if (!caseSensitive) {
+				folded = FoldCase(cur.ch);
+				upper = UpperCase(cur.ch);
+			}
+		}
+
+		nlist.size = 0;
+		for (int i = 0; i < clist.size; i++) {
+			const int pc = clist.dense[i];
+			const Inst &inst = program[pc];
+			Sci::Position * const caps = clist.Caps(i);
+			bool step = false;
+			switch (inst.op) {
+			case Op::Match:
+				matched = true;
+				for (int slot = 0; slot < slotCount; slot += 2) {
+					groupStart[slot/2] = caps[slot];
+					groupEnd[slot/2] = caps[slot + 1];
+				}
+				break;
+			case Op::Char:
+				step = consume && static_cast<unsigned int>(inst.x) == folded;
+				break;
+			case Op::Any:
+				step = consume;
+				break;
+			case Op::Class:
+				step = consume && ClassMatches(charSets[inst.x], cur.ch, folded, upper);
+				break;
+			default:
+				break;
+			}
+			if (inst.op == Op::Match) {
+				// cut off threads with lower priority
+				break;
+			}
+			if (step) {
+				std::copy_n(caps, slotCount, scratch.data());
+				AddThread(program, nlist, pc + 1, nextPos, scratch.data(), nextCtx);
+			}
+		}
+		std::swap(clist, nlist);
+
+		if (pos >= endPos || (clist.size == 0 && (matched || anchored))) {
+			break;
+		}
+		prev = cur;
+		cur = next;
+		pos = nextPos;
+	}
+	return matched;
+}
@@ -0,0 +1,138 @@
+// Scintilla source code edit control
+/** @file LinearRegex.h
+ ** Regular expression engine which runs in time linear to the length of searched text.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+#pragma once
+
+namespace Scintilla::Internal {
+
+/**
+ * Thompson NFA simulated in lock step (Pike VM), all threads advance one character together,
+ * so each character is examined once per instruction instead of once per backtracking path.
+ * Back references are not supported as they can't be matched in linear time.
+ */
+class LinearRegex {
+public:
+	struct Encoding {
+		int codePage;
+		const CharClassify *charClass;
+		const DBCSCharClassify *dbcsCharClass;
+	};
+
+	static constexpr int MaxGroup = 10;
+	static constexpr int NotFound = -1;
+
+	LinearRegex() noexcept;
+	void ClearCache() noexcept;
+	// returns error message when failed.
+	const char *Compile(const char *pattern, Sci::Position length, bool caseSensitive, const Encoding &encoding);
+	// find leftmost match inside [startPos, endPos] without crossing line ends, reading the two
+	// segments of the buffer directly. prevPos is start of the character before startPos or -1.
+	// anchored search only tries match starting at startPos.
+	bool Search(const SplitView &view, Sci::Position startPos, Sci::Position endPos, Sci::Position prevPos, bool anchored = false);
+	// find the match inside [startPos, endPos] whose start is nearest to endPos by running the reverse
+	// program backward from endPos, so the cost is bounded by distance to the match instead of line length.
+	bool SearchBackward(const SplitView &view, Sci::Position startPos, Sci::Position endPos);
+	// reverse program is not built for DBCS as it can't be decoded backward.
+	bool CanSearchBackward() const noexcept {
+		return !reverseProgram.empty();
+	}
+
+	Sci::Position groupStart[MaxGroup];
+	Sci::Position groupEnd[MaxGroup];
+
+private:
+	enum class Op : unsigned char {
+		Match, Char, Any, Class, Split, Jmp, Save, Assert,
+	};
+	struct Inst {
+		Op op;
+		int x;
+		int y;
+	};
+	struct CharSet {
+		unsigned int bits[256/32];
+		std::vector<std::pair<unsigned int, unsigned int>> ranges;
+		int flags;
+		bool negated;
+	};
+	struct Node;
+	class Parser;
+	class ThreadList {
+	public:
+		std::vector<int> sparse;
+		std::vector<int> dense;
+		std::vector<Sci::Position> caps;
+		int size = 0;
+		int slotCount = 0;
+		void Resize(int count, int slots);
+		bool Contains(int pc) const noexcept {
+			const int index = sparse[pc];
+			return index < size && dense[index] == pc;
+		}
+		int Insert(int pc) noexcept {
+			sparse[pc] = size;
+			dense[size] = pc;
+			return size++;
+		}
+		Sci::Position *Caps(int index) noexcept {
+			return caps.data() + index*slotCount;
+		}
+	};
+	struct StackEntry {
+		int pc;
+		int slot;
+		Sci::Position value;
+	};
+	struct Context {
+		bool lineStart;
+		bool lineEnd;
+		bool prevWord;
+		bool curWord;
+	};
+	struct CharInfo {
+		unsigned int ch;
+		int width;
+	};
+	// bytes which can start (or end for reverse program) a match, used to skip text when no thread is alive.
+	struct ByteSet {
+		bool enabled;
+		int count;
+		unsigned char single;
+		bool bytes[256];
+	};
+
+	CharInfo CharAt(const SplitView &view, Sci::Position pos) const noexcept;
+	CharInfo CharBefore(const SplitView &view, Sci::Position pos) const noexcept;
+	unsigned int FoldCase(unsigned int ch) const;
+	unsigned int UpperCase(unsigned int ch) const;
+	bool IsWordChar(unsigned int ch) const noexcept;
+	bool IsSpaceChar(unsigned int ch) const noexcept;
+	bool SetContains(const CharSet &set, unsigned int ch) const noexcept;
+	bool ClassMatches(const CharSet &set, unsigned int ch, unsigned int folded, unsigned int upper) const noexcept;
+	Context MakeContext(const SplitView &view, Sci::Position pos, CharInfo prev, CharInfo cur) const noexcept;
+	void AddThread(const std::vector<Inst> &code, ThreadList &list, int pc, Sci::Position pos, Sci::Position *caps, const Context &ctx);
+	void BuildByteSet(const std::vector<Inst> &code, bool reverse, ByteSet &set);
+	Sci::Position NextCandidate(const SplitView &view, Sci::Position pos, Sci::Position endPos) const noexcept;
+	Sci::Position PrevCandidate(const SplitView &view, Sci::Position pos, Sci::Position startPos) const noexcept;
+	Sci::Position ReverseSearch(const SplitView &view, Sci::Position startPos, Sci::Position endPos);
+
+	std::vector<Inst> program;
+	std::vector<Inst> reverseProgram;
+	std::vector<CharSet> charSets;
+	int slotCount;
+	bool caseSensitive;
+	Encoding encoding;
+	std::string cachedPattern;
+
+	ByteSet firstSet;
+	ByteSet lastSet;
+
+	ThreadList clist;
+	ThreadList nlist;
+	std::vector<StackEntry> stack;
+	std::vector<Sci::Position> scratch;
+};
+
+}
@@ -114,6 +114,10 @@ public:
 		return PositionFromPartition(Partitions());
 	}
 
+	size_t MemoryUsage() const noexcept {
+		return body->MemoryUsage();
+	}
+
 	void InsertPartition(T partition, T pos) {
 		if (stepPartition < partition) {
 			ApplyStep(partition);
@@ -251,5 +255,236 @@ public:
 #endif
 };
 
+/// Partitioning with 32-bit partition starts relative to the start of the block holding them.
+/// Block starts are held in a Partitioning with 64-bit positions, so memory used is about half
+/// of Partitioning<ptrdiff_t>. A block is split when it has too many partitions or its
+/// relative starts no longer fit in 32 bits.
+class CompactPartitioning {
+	using Offset = unsigned int;
+	static constexpr ptrdiff_t blockSize = 256;
+	static constexpr ptrdiff_t maxOffset = 0xffffffff;
+
+	Partitioning<ptrdiff_t> blockPartitions;	// first partition of each block
+	Partitioning<ptrdiff_t> blockStarts;		// start position of each block
+	std::unique_ptr<SplitVectorWithRangeAdd<Offset>> offsets;
+
+	void Allocate(ptrdiff_t growSize) {
+		offsets = std::make_unique<SplitVectorWithRangeAdd<Offset>>(growSize);
+		offsets->Insert(0, 0);
+		blockPartitions.DeleteAll();
+		blockPartitions.InsertText(0, 1);
+		blockStarts.DeleteAll();
+	}
+
+	ptrdiff_t BlockFromPartition(ptrdiff_t partition) const noexcept {
+		return blockPartitions.PartitionFromPosition(partition);
+	}
+
+	ptrdiff_t OffsetAt(ptrdiff_t partition) const noexcept {
+		return offsets->ValueAt(partition);
+	}
+
+	void SetBlockStart(ptrdiff_t block, ptrdiff_t pos) {
+		// Partitioning::SetPartitionStartPosition() may move step backward
+		blockStarts.RemovePartition(block);
+		blockStarts.InsertPartition(block, pos);
+	}
+
+	/// Make partition at the first partition of a new block after block.
+	void SplitBlock(ptrdiff_t block, ptrdiff_t at) {
+		const ptrdiff_t first = blockPartitions.PositionFromPartition(block);
+		const ptrdiff_t end = blockPartitions.PositionFromPartition(block + 1);
+		if (at <= first || at >= end) {
+			return;
+		}
+		const ptrdiff_t offset = OffsetAt(at);
+		offsets->RangeAddDelta(at, end, static_cast<Offset>(-offset));
+		blockPartitions.InsertPartition(block + 1, at);
+		blockStarts.InsertPartition(block + 1, blockStarts.PositionFromPartition(block) + offset);
+	}
+
+	/// Merge following block into block when the result is small enough.
+	void MergeBlock(ptrdiff_t block) {
+		if (block + 1 >= blockPartitions.Partitions()) {
+			return;
+		}
+		const ptrdiff_t first = blockPartitions.PositionFromPartition(block + 1);
+		const ptrdiff_t end = blockPartitions.PositionFromPartition(block + 2);
+		const ptrdiff_t delta = blockStarts.PositionFromPartition(block + 1) - blockStarts.PositionFromPartition(block);
+		if (end - blockPartitions.PositionFromPartition(block) <= blockSize && delta + OffsetAt(end - 1) <= maxOffset) {
+			offsets->RangeAddDelta(first, end, static_cast<Offset>(delta));
+			blockPartitions.RemovePartition(block + 1);
+			blockStarts.RemovePartition(block + 1);
+		}
+	}
+
+public:
+	explicit CompactPartitioning(int growSize) : blockPartitions(8), blockStarts(8) {
+		Allocate(growSize);
+	}
+
+	// Deleted so CompactPartitioning objects can not be copied.
+	CompactPartitioning(const CompactPartitioning &) = delete;
+	CompactPartitioning(CompactPartitioning &&) = delete;
+	void operator=(const CompactPartitioning &) = delete;
+	void operator=(CompactPartitioning &&) = delete;
+
+	~CompactPartitioning() = default;
+
+	ptrdiff_t Partitions() const noexcept {
+		return blockPartitions.Length();
+	}
+
+	void ReAllocate(ptrdiff_t newSize) {
+		offsets->ReAllocate(newSize + 2);
+		blockPartitions.ReAllocate(newSize/(blockSize/2) + 1);
+		blockStarts.ReAllocate(newSize/(blockSize/2) + 1);
+	}
+
+	ptrdiff_t Length() const noexcept {
+		return blockStarts.Length();
+	}
+
+	size_t MemoryUsage() const noexcept {
+		return offsets->MemoryUsage() + blockPartitions.MemoryUsage() + blockStarts.MemoryUsage();
+	}
+
+	void InsertPartition(ptrdiff_t partition, ptrdiff_t pos) {
+		PLATFORM_ASSERT(partition > 0 && partition <= Partitions());
+		const ptrdiff_t block = BlockFromPartition(partition - 1);
+		const ptrdiff_t offset = pos - blockStarts.PositionFromPartition(block);
+		if (offset > maxOffset) {
+			// new partition starts a new block
+			SplitBlock(block, partition);
+			offsets->Insert(partition, 0);
+			blockPartitions.InsertPartition(block + 1, partition);
+			blockPartitions.InsertText(block + 1, 1);
+			blockStarts.InsertPartition(block + 1, pos);
+			return;
+		}
+		offsets->Insert(partition, static_cast<Offset>(offset));
+		blockPartitions.InsertText(block, 1);
+		const ptrdiff_t first = blockPartitions.PositionFromPartition(block);
+		if (blockPartitions.PositionFromPartition(block + 1) - first > blockSize) {
+			SplitBlock(block, first + blockSize/2);
+		}
+	}
+
+	void InsertPartitions(ptrdiff_t partition, const ptrdiff_t *positions, size_t length) {
+		for (size_t i = 0; i < length; i++) {
+			InsertPartition(partition + i, positions[i]);
+		}
+	}
+
+	void InsertPartitionsWithCast(ptrdiff_t partition, const ptrdiff_t *positions, size_t length) {
+		InsertPartitions(partition, positions, length);
+	}
+
+	void SetPartitionStartPosition(ptrdiff_t partition, ptrdiff_t pos) {
+		if ((partition < 0) || (partition >= Partitions())) {
+			return;
+		}
+		const ptrdiff_t block = BlockFromPartition(partition);
+		const ptrdiff_t first = blockPartitions.PositionFromPartition(block);
+		const ptrdiff_t blockStart = blockStarts.PositionFromPartition(block);
+		if (partition == first) {
+			if (partition != 0) {
+				// rebase the block, positions of other partitions are unchanged
+				const ptrdiff_t end = blockPartitions.PositionFromPartition(block + 1);
+				if (OffsetAt(end - 1) + blockStart - pos > maxOffset) {
+					SplitBlock(block, partition + 1);
+				} else {
+					offsets->RangeAddDelta(partition + 1, end, static_cast<Offset>(blockStart - pos));
+				}
+				SetBlockStart(block, pos);
+			}
+		} else if (pos - blockStart > maxOffset) {
+			SplitBlock(block, partition);
+			SetBlockStart(block + 1, pos);
+		} else {
+			offsets->SetValueAt(partition, static_cast<Offset>(pos - blockStart));
+		}
+	}
+
+	void InsertText(ptrdiff_t partitionInsert, ptrdiff_t delta) {
+		// Point all the partitions after the insertion point further along in the buffer
+		const ptrdiff_t block = BlockFromPartition(partitionInsert);
+		const ptrdiff_t end = blockPartitions.PositionFromPartition(block + 1);
+		if (partitionInsert + 1 < end) {
+			if (OffsetAt(end - 1) + delta > maxOffset) {
+				SplitBlock(block, partitionInsert + 1);
+			} else {
+				offsets->RangeAddDelta(partitionInsert + 1, end, static_cast<Offset>(delta));
+			}
+		}
+		blockStarts.InsertText(block, delta);
+	}
+
+	void RemovePartition(ptrdiff_t partition) {
+		PLATFORM_ASSERT(partition > 0 && partition < Partitions());
+		const ptrdiff_t block = BlockFromPartition(partition);
+		const ptrdiff_t first = blockPartitions.PositionFromPartition(block);
+		const ptrdiff_t end = blockPartitions.PositionFromPartition(block + 1);
+		if (partition == first) {
+			if (end - first == 1) {
+				// remove the block, its text becomes part of previous block
+				offsets->Delete(partition);
+				blockPartitions.InsertText(block, -1);
+				blockPartitions.RemovePartition(block);
+				blockStarts.RemovePartition(block);
+				MergeBlock(block - 1);
+				return;
+			}
+			// next partition becomes first partition of the block
+			const ptrdiff_t offset = OffsetAt(partition + 1);
+			offsets->RangeAddDelta(partition + 2, end, static_cast<Offset>(-offset));
+			offsets->SetValueAt(partition + 1, 0);
+			SetBlockStart(block, blockStarts.PositionFromPartition(block) + offset);
+		}
+		offsets->Delete(partition);
+		blockPartitions.InsertText(block, -1);
+		if (end - first <= blockSize/4) {
+			MergeBlock(block);
+		}
+	}
+
+	ptrdiff_t PositionFromPartition(ptrdiff_t partition) const noexcept {
+		PLATFORM_ASSERT(partition >= 0);
+		PLATFORM_ASSERT(partition <= Partitions());
+		if ((partition < 0) || (partition > Partitions())) {
+			return 0;
+		}
+		if (partition == Partitions()) {
+			return Length();
+		}
+		const ptrdiff_t block = BlockFromPartition(partition);
+		return blockStarts.PositionFromPartition(block) + OffsetAt(partition);
+	}
+
+	/// Return value in range [0 .. Partitions() - 1] even for arguments outside interval
+	ptrdiff_t PartitionFromPosition(ptrdiff_t pos) const noexcept {
+		if (pos >= Length()) {
+			return Partitions() - 1;
+		}
+		const ptrdiff_t block = blockStarts.PartitionFromPosition(pos);
+		const ptrdiff_t offset = pos - blockStarts.PositionFromPartition(block);
+		ptrdiff_t lower = blockPartitions.PositionFromPartition(block);
+		ptrdiff_t upper = blockPartitions.PositionFromPartition(block + 1) - 1;
+		while (lower < upper) {
+			const ptrdiff_t middle = (upper + lower + 1) / 2; 	// Round high
+			if (offset < OffsetAt(middle)) {
+				upper = middle - 1;
+			} else {
+				lower = middle;
+			}
+		}
+		return lower;
+	}
+
+	void DeleteAll() {
+		Allocate(offsets->GetGrowSize());
+	}
+};
+
 
 }
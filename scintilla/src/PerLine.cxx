@@ -7,12 +7,12 @@
 
 #include <cstddef>
 #include <cassert>
+#include <climits>
 #include <cstring>
 
 #include <stdexcept>
 #include <string_view>
 #include <vector>
-#include <forward_list>
 #include <optional>
 #include <algorithm>
 #include <memory>
@@ -26,199 +26,323 @@
 #include "Position.h"
 #include "SplitVector.h"
 #include "Partitioning.h"
+#include "RunStyles.h"
 #include "CellBuffer.h"
 #include "PerLine.h"
 
 using namespace Scintilla::Internal;
 
-MarkerHandleSet::MarkerHandleSet() noexcept = default;
-
-MarkerHandleSet::~MarkerHandleSet() {
-	mhList.clear();
-}
-
-bool MarkerHandleSet::Empty() const noexcept {
-	return mhList.empty();
+void MarkerLines::Clear() noexcept {
+	// release memory
+	std::vector<Sci::Line>().swap(lines);
+	std::vector<int>().swap(handles);
 }
 
-MarkerMask MarkerHandleSet::MarkValue() const noexcept {
-	MarkerMask m = 0;
-	for (const MarkerHandleNumber &mhn : mhList) {
-		m |= (1U << mhn.number);
-	}
-	return m;
-}
-
-bool MarkerHandleSet::Contains(int handle) const noexcept {
-	for (const MarkerHandleNumber &mhn : mhList) {
-		if (mhn.handle == handle) {
-			return true;
-		}
-	}
-	return false;
+bool MarkerLines::Contains(Sci::Line line) const noexcept {
+	return std::binary_search(lines.begin(), lines.end(), line);
 }
 
-MarkerHandleNumber const *MarkerHandleSet::GetMarkerHandleNumber(int which) const noexcept {
-	for (const MarkerHandleNumber &mhn : mhList) {
-		if (which == 0)
-			return &mhn;
-		which--;
-	}
-	return nullptr;
+size_t MarkerLines::LowerBound(Sci::Line line) const noexcept {
+	return std::lower_bound(lines.begin(), lines.end(), line) - lines.begin();
 }
 
-bool MarkerHandleSet::InsertHandle(int handle, int markerNum) {
-	mhList.push_front(MarkerHandleNumber(handle, markerNum));
-	return true;
+void MarkerLines::Insert(Sci::Line line, int handle) {
+	// after other instances on the line, common case of adding in line order appends
+	const size_t index = std::upper_bound(lines.begin(), lines.end(), line) - lines.begin();
+	lines.insert(lines.begin() + index, line);
+	handles.insert(handles.begin() + index, handle);
 }
 
-void MarkerHandleSet::RemoveHandle(int handle) {
-	mhList.remove_if([handle](const MarkerHandleNumber &mhn) noexcept { return mhn.handle == handle; });
+void MarkerLines::Erase(size_t first, size_t last) noexcept {
+	lines.erase(lines.begin() + first, lines.begin() + last);
+	handles.erase(handles.begin() + first, handles.begin() + last);
 }
 
-bool MarkerHandleSet::RemoveNumber(int markerNum, bool all) {
-	bool performedDeletion = false;
-	mhList.remove_if([&](const MarkerHandleNumber &mhn) noexcept {
-		if ((all || !performedDeletion) && (mhn.number == markerNum)) {
-			performedDeletion = true;
-			return true;
-		}
-		return false;
-	});
-	return performedDeletion;
+void MarkerLines::MoveLines(Sci::Line line, Sci::Line delta) noexcept {
+	// move instances at or after line
+	for (size_t index = LowerBound(line); index < lines.size(); index++) {
+		lines[index] += delta;
+	}
 }
 
-void MarkerHandleSet::CombineWith(MarkerHandleSet *other) noexcept {
-	mhList.splice_after(mhList.before_begin(), other->mhList);
+size_t MarkerLines::MemoryUsage() const noexcept {
+	return lines.capacity()*sizeof(Sci::Line) + handles.capacity()*sizeof(int);
 }
 
 LineMarkers::~LineMarkers() = default;
 
 void LineMarkers::Init() {
-	markers.DeleteAll();
+	for (MarkerLines &ml : markers) {
+		ml.Clear();
+	}
+	used = 0;
 }
 
 bool LineMarkers::IsActive() const noexcept {
-	return markers.Length() != 0;
+	return used != 0;
 }
 
-void LineMarkers::InsertLine(Sci::Line line) {
-	if (markers.Length()) {
-		markers.Insert(line, nullptr);
+size_t LineMarkers::MemoryUsage() const noexcept {
+	size_t bytes = 0;
+	for (const MarkerLines &ml : markers) {
+		bytes += ml.MemoryUsage();
 	}
+	return bytes;
+}
+
+void LineMarkers::InsertLine(Sci::Line line) {
+	InsertLines(line, 1);
 }
 
 void LineMarkers::InsertLines(Sci::Line line, Sci::Line lines) {
-	if (markers.Length()) {
-		markers.InsertEmpty(line, lines);
+	for (MarkerMask m = used, number = 0; m; m >>= 1, number++) {
+		if (m & 1) {
+			markers[number].MoveLines(line, lines);
+		}
 	}
 }
 
 void LineMarkers::RemoveLine(Sci::Line line) {
-	// Retain the markers from the deleted line by oring them into the previous line
-	if (markers.Length()) {
-		if (line > 0) {
-			MergeMarkers(line - 1);
+	// Retain the markers from the deleted line by moving them into the previous line
+	for (MarkerMask m = used, number = 0; m; m >>= 1, number++) {
+		if (m & 1) {
+			MarkerLines &ml = markers[number];
+			if (line == 0) {
+				ml.Erase(0, ml.LowerBound(1));
+			}
+			ml.MoveLines(line, -1);
+			if (ml.Empty()) {
+				used &= ~(1U << number);
+			}
 		}
-		markers.Delete(line);
 	}
 }
 
 Sci::Line LineMarkers::LineFromHandle(int markerHandle) const noexcept {
-	for (Sci::Line line = 0; line < markers.Length(); line++) {
-		if (markers[line] && markers[line]->Contains(markerHandle)) {
-			return line;
+	for (MarkerMask m = used, number = 0; m; m >>= 1, number++) {
+		if (m & 1) {
+			const MarkerLines &ml = markers[number];
+			const auto it = std::find(ml.handles.begin(), ml.handles.end(), markerHandle);
+			if (it != ml.handles.end()) {
+				return ml.lines[it - ml.handles.begin()];
+			}
 		}
 	}
 	return -1;
 }
 
-int LineMarkers::HandleFromLine(Sci::Line line, int which) const noexcept {
-	if (markers.Length() && (line >= 0) && (line < markers.Length()) && markers[line]) {
-		MarkerHandleNumber const *pnmh = markers[line]->GetMarkerHandleNumber(which);
-		return pnmh ? pnmh->handle : -1;
+int LineMarkers::FindOnLine(Sci::Line line, int which, int &number) const noexcept {
+	// handles increase, so pick instances from highest handle downward
+	int handleBelow = INT_MAX;
+	int handle = -1;
+	for (; which >= 0; which--) {
+		handle = -1;
+		for (MarkerMask m = used, num = 0; m; m >>= 1, num++) {
+			if (m & 1) {
+				const MarkerLines &ml = markers[num];
+				for (size_t index = ml.LowerBound(line); index < ml.lines.size() && ml.lines[index] == line; index++) {
+					const int h = ml.handles[index];
+					if (h < handleBelow && h > handle) {
+						handle = h;
+						number = static_cast<int>(num);
+					}
+				}
+			}
+		}
+		if (handle < 0) {
+			break;
+		}
+		handleBelow = handle;
 	}
-	return -1;
+	return handle;
 }
 
-int LineMarkers::NumberFromLine(Sci::Line line, int which) const noexcept {
-	if (markers.Length() && (line >= 0) && (line < markers.Length()) && markers[line]) {
-		MarkerHandleNumber const *pnmh = markers[line]->GetMarkerHandleNumber(which);
-		return pnmh ? pnmh->number : -1;
-	}
-	return -1;
+int LineMarkers::HandleFromLine(Sci::Line line, int which) const noexcept {
+	int number = -1;
+	return FindOnLine(line, which, number);
 }
 
-void LineMarkers::MergeMarkers(Sci::Line line) {
-	if (markers[line + 1]) {
-		if (!markers[line])
-			markers[line] = std::make_unique<MarkerHandleSet>();
-		markers[line]->CombineWith(markers[line + 1].get());
-		markers[line + 1].reset();
-	}
+int LineMarkers::NumberFromLine(Sci::Line line, int which) const noexcept {
+	int number = -1;
+	const int handle = FindOnLine(line, which, number);
+	return (handle < 0) ? -1 : number;
 }
 
 MarkerMask LineMarkers::MarkValue(Sci::Line line) const noexcept {
-	if (markers.Length() && (line >= 0) && (line < markers.Length()) && markers[line])
-		return markers[line]->MarkValue();
-	else
-		return 0;
+	MarkerMask value = 0;
+	for (MarkerMask m = used, number = 0; m; m >>= 1, number++) {
+		if ((m & 1) && markers[number].Contains(line)) {
+			value |= 1U << number;
+		}
+	}
+	return value;
 }
 
 Sci::Line LineMarkers::MarkerNext(Sci::Line lineStart, MarkerMask mask) const noexcept {
 	if (lineStart < 0)
 		lineStart = 0;
-	const Sci::Line length = markers.Length();
-	for (Sci::Line iLine = lineStart; iLine < length; iLine++) {
-		const MarkerHandleSet *onLine = markers[iLine].get();
-		if (onLine && ((onLine->MarkValue() & mask) != 0))
-			return iLine;
+	Sci::Line lineNext = -1;
+	for (MarkerMask m = used & mask, number = 0; m; m >>= 1, number++) {
+		if (m & 1) {
+			const MarkerLines &ml = markers[number];
+			const size_t index = ml.LowerBound(lineStart);
+			if (index < ml.lines.size() && (lineNext < 0 || ml.lines[index] < lineNext)) {
+				lineNext = ml.lines[index];
+			}
+		}
 	}
-	return -1;
+	return lineNext;
+}
+
+Sci::Line LineMarkers::MarkerPrevious(Sci::Line lineStart, MarkerMask mask) const noexcept {
+	Sci::Line linePrevious = -1;
+	for (MarkerMask m = used & mask, number = 0; m; m >>= 1, number++) {
+		if (m & 1) {
+			const MarkerLines &ml = markers[number];
+			const size_t index = ml.LowerBound(lineStart + 1);
+			if (index > 0) {
+				linePrevious = std::max(linePrevious, ml.lines[index - 1]);
+			}
+		}
+	}
+	return linePrevious;
 }
 
 int LineMarkers::AddMark(Sci::Line line, int markerNum, Sci::Line lines) {
 	handleCurrent++;
-	if (!markers.Length()) {
-		// No existing markers so allocate one element per line
-		markers.InsertEmpty(0, lines);
-	}
-	if (line >= markers.Length()) {
+	if (line < 0 || line >= lines) {
 		return -1;
 	}
-	if (!markers[line]) {
-		// Need new structure to hold marker handle
-		markers[line] = std::make_unique<MarkerHandleSet>();
-	}
-	markers[line]->InsertHandle(handleCurrent, markerNum);
-
+	markers[markerNum].Insert(line, handleCurrent);
+	used |= 1U << markerNum;
 	return handleCurrent;
 }
 
 bool LineMarkers::DeleteMark(Sci::Line line, int markerNum, bool all) {
 	bool someChanges = false;
-	if (markers.Length() && (line >= 0) && (line < markers.Length()) && markers[line]) {
-		if (markerNum == -1) {
-			someChanges = true;
-			markers[line].reset();
-		} else {
-			someChanges = markers[line]->RemoveNumber(markerNum, all);
-			if (markers[line]->Empty()) {
-				markers[line].reset();
+	for (MarkerMask m = used, number = 0; m; m >>= 1, number++) {
+		if ((m & 1) && (markerNum == -1 || static_cast<int>(number) == markerNum)) {
+			MarkerLines &ml = markers[number];
+			size_t first = ml.LowerBound(line);
+			size_t last = first;
+			while (last < ml.lines.size() && ml.lines[last] == line) {
+				last++;
+			}
+			if (first != last) {
+				if (markerNum != -1 && !all) {
+					// most recently added
+					first = last - 1;
+				}
+				ml.Erase(first, last);
+				if (ml.Empty()) {
+					used &= ~(1U << number);
+				}
+				someChanges = true;
 			}
 		}
 	}
 	return someChanges;
 }
 
+bool LineMarkers::DeleteAllMarks(int markerNum) noexcept {
+	bool someChanges = false;
+	for (MarkerMask m = used, number = 0; m; m >>= 1, number++) {
+		if ((m & 1) && (markerNum == -1 || static_cast<int>(number) == markerNum)) {
+			markers[number].Clear();
+			used &= ~(1U << number);
+			someChanges = true;
+		}
+	}
+	return someChanges;
+}
+
 void LineMarkers::DeleteMarkFromHandle(int markerHandle) {
-	const Sci::Line line = LineFromHandle(markerHandle);
-	if (line >= 0) {
-		markers[line]->RemoveHandle(markerHandle);
-		if (markers[line]->Empty()) {
-			markers[line].reset();
+	for (MarkerMask m = used, number = 0; m; m >>= 1, number++) {
+		if (m & 1) {
+			MarkerLines &ml = markers[number];
+			const auto it = std::find(ml.handles.begin(), ml.handles.end(), markerHandle);
+			if (it != ml.handles.end()) {
+				const size_t index = it - ml.handles.begin();
+				ml.Erase(index, index + 1);
+				if (ml.Empty()) {
+					used &= ~(1U << number);
+				}
+				return;
+			}
+		}
+	}
+}
+
+namespace {
+
+// a run costs about 3 ints, switch a little before runs take more memory than values
+// as reading values is also faster.
+constexpr Sci::Line minRunsForValues = 256;
+constexpr Sci::Line linesPerRunForValues = 4;
+
+}
+
+LineValues::LineValues() : runs(std::make_unique<RunStyles<Sci::Line, int>>()) {
+}
+
+LineValues::~LineValues() = default;
+
+Sci::Line LineValues::Length() const noexcept {
+	return runs ? runs->Length() : values.Length();
+}
+
+int LineValues::ValueAt(Sci::Line line) const noexcept {
+	return runs ? runs->ValueAt(line) : values[line];
+}
+
+void LineValues::SetValueAt(Sci::Line line, int value) {
+	if (runs) {
+		runs->SetValueAt(line, value);
+		const Sci::Line count = runs->Runs();
+		if (count > minRunsForValues && count*linesPerRunForValues > runs->Length()) {
+			SwitchToValues();
 		}
+	} else {
+		values.SetValueAt(line, value);
+	}
+}
+
+void LineValues::InsertValue(Sci::Line line, Sci::Line lines, int value) {
+	if (runs) {
+		runs->InsertSpace(line, lines);
+		runs->FillRange(line, value, lines);
+	} else {
+		values.InsertValue(line, lines, value);
+	}
+}
+
+void LineValues::Delete(Sci::Line line) {
+	if (runs) {
+		runs->DeleteRange(line, 1);
+	} else {
+		values.Delete(line);
+	}
+}
+
+void LineValues::DeleteAll() {
+	runs = std::make_unique<RunStyles<Sci::Line, int>>();
+	values.DeleteAll();
+}
+
+size_t LineValues::MemoryUsage() const noexcept {
+	return runs ? runs->MemoryUsage() : values.MemoryUsage();
+}
+
+void LineValues::SwitchToValues() {
+	const Sci::Line length = runs->Length();
+	values.DeleteAll();
+	values.ReAllocate(length + 1);
+	for (Sci::Line line = 0; line < length;) {
+		const Sci::Line end = runs->EndRun(line);
+		values.InsertValue(line, end - line, runs->ValueAt(line));
+		line = end;
 	}
+	runs.reset();
 }
 
 LineLevels::~LineLevels() = default;
@@ -231,16 +355,20 @@ bool LineLevels::IsActive() const noexcept {
 	return levels.Length() != 0;
 }
 
+size_t LineLevels::MemoryUsage() const noexcept {
+	return levels.MemoryUsage();
+}
+
 void LineLevels::InsertLine(Sci::Line line) {
 	if (levels.Length()) {
-		const int level = (line < levels.Length()) ? levels[line] : static_cast<int>(Scintilla::FoldLevel::Base);
-		levels.Insert(line, level);
+		const int level = (line < levels.Length()) ? levels.ValueAt(line) : static_cast<int>(Scintilla::FoldLevel::Base);
+		levels.InsertValue(line, 1, level);
 	}
 }
 
 void LineLevels::InsertLines(Sci::Line line, Sci::Line lines) {
 	if (levels.Length()) {
-		const int level = (line < levels.Length()) ? levels[line] : static_cast<int>(Scintilla::FoldLevel::Base);
+		const int level = (line < levels.Length()) ? levels.ValueAt(line) : static_cast<int>(Scintilla::FoldLevel::Base);
 		levels.InsertValue(line, lines, level);
 	}
 }
@@ -249,17 +377,16 @@ void LineLevels::RemoveLine(Sci::Line line) {
 	if (levels.Length()) {
 		// Move up following lines but merge header flag from this line
 		// to line before to avoid a temporary disappearance causing expansion.
-		int firstHeader = levels[line] & static_cast<int>(Scintilla::FoldLevel::HeaderFlag);
+		const int firstHeader = levels.ValueAt(line) & static_cast<int>(Scintilla::FoldLevel::HeaderFlag);
 		levels.Delete(line);
 		if (line == levels.Length() - 1) // Last line loses the header flag
-			levels[line - 1] &= ~static_cast<int>(Scintilla::FoldLevel::HeaderFlag);
+			levels.SetValueAt(line - 1, levels.ValueAt(line - 1) & ~static_cast<int>(Scintilla::FoldLevel::HeaderFlag));
 		else if (line > 0)
-			levels[line - 1] |= firstHeader;
+			levels.SetValueAt(line - 1, levels.ValueAt(line - 1) | firstHeader);
 	}
 }
 
 void LineLevels::ExpandLevels(Sci::Line sizeNew) {
-	levels.ReAllocate(sizeNew + 1);
 	levels.InsertValue(levels.Length(), sizeNew - levels.Length(), static_cast<int>(Scintilla::FoldLevel::Base));
 }
 
@@ -273,9 +400,9 @@ int LineLevels::SetLevel(Sci::Line line, int level, Sci::Line lines) {
 		if (!levels.Length()) {
 			ExpandLevels(lines + 1);
 		}
-		prev = levels[line];
+		prev = levels.ValueAt(line);
 		if (prev != level) {
-			levels[line] = level;
+			levels.SetValueAt(line, level);
 		}
 	}
 	return prev;
@@ -283,7 +410,7 @@ int LineLevels::SetLevel(Sci::Line line, int level, Sci::Line lines) {
 
 int LineLevels::GetLevel(Sci::Line line) const noexcept {
 	if ((line >= 0) && (line < levels.Length())) {
-		return levels[line];
+		return levels.ValueAt(line);
 	} else {
 		return static_cast<int>(Scintilla::FoldLevel::Base);
 	}
@@ -299,16 +426,20 @@ bool LineState::IsActive() const noexcept {
 	return lineStates.Length() != 0;
 }
 
+size_t LineState::MemoryUsage() const noexcept {
+	return lineStates.MemoryUsage();
+}
+
 void LineState::InsertLine(Sci::Line line) {
 	if (lineStates.Length()) {
-		const int val = (line < lineStates.Length()) ? lineStates[line] : 0;
-		lineStates.Insert(line, val);
+		const int val = (line < lineStates.Length()) ? lineStates.ValueAt(line) : 0;
+		lineStates.InsertValue(line, 1, val);
 	}
 }
 
 void LineState::InsertLines(Sci::Line line, Sci::Line lines) {
 	if (lineStates.Length()) {
-		const int val = (line < lineStates.Length()) ? lineStates[line] : 0;
+		const int val = (line < lineStates.Length()) ? lineStates.ValueAt(line) : 0;
 		lineStates.InsertValue(line, lines, val);
 	}
 }
@@ -319,11 +450,15 @@ void LineState::RemoveLine(Sci::Line line) {
 	}
 }
 
-int LineState::SetLineState(Sci::Line line, int state, Sci::Line lines) {
-	lineStates.ReAllocate(lines + 2);
-	lineStates.EnsureLength(line + 1);
-	const int stateOld = lineStates[line];
-	lineStates[line] = state;
+int LineState::SetLineState(Sci::Line line, int state, [[maybe_unused]] Sci::Line lines) {
+	const Sci::Line length = lineStates.Length();
+	if (line >= length) {
+		lineStates.InsertValue(length, line + 1 - length, 0);
+	}
+	const int stateOld = lineStates.ValueAt(line);
+	if (stateOld != state) {
+		lineStates.SetValueAt(line, state);
+	}
 	return stateOld;
 }
 
@@ -331,7 +466,7 @@ int LineState::GetLineState(Sci::Line line) const noexcept {
 	if (line < 0 || line >= lineStates.Length()) {
 		return 0;
 	}
-	return lineStates[line];
+	return lineStates.ValueAt(line);
 }
 
 Sci::Line LineState::GetMaxLineState() const noexcept {
@@ -372,6 +507,16 @@ bool LineAnnotation::IsActive() const noexcept {
 	return annotations.Length() != 0;
 }
 
+size_t LineAnnotation::MemoryUsage() const noexcept {
+	size_t bytes = annotations.MemoryUsage();
+	for (Sci::Line line = 0; line < annotations.Length(); line++) {
+		if (annotations[line]) {
+			bytes += sizeof(AnnotationHeader) + Length(line) * (MultipleStyles(line) ? 2 : 1);
+		}
+	}
+	return bytes;
+}
+
 void LineAnnotation::InsertLine(Sci::Line line) {
 	if (annotations.Length()) {
 		annotations.EnsureLength(line);
@@ -499,6 +644,16 @@ bool LineTabstops::IsActive() const noexcept {
 	return tabstops.Length() != 0;
 }
 
+size_t LineTabstops::MemoryUsage() const noexcept {
+	size_t bytes = tabstops.MemoryUsage();
+	for (Sci::Line line = 0; line < tabstops.Length(); line++) {
+		if (tabstops[line]) {
+			bytes += sizeof(TabstopList) + tabstops[line]->capacity() * sizeof(int);
+		}
+	}
+	return bytes;
+}
+
 void LineTabstops::InsertLine(Sci::Line line) {
 	if (tabstops.Length()) {
 		tabstops.EnsureLength(line);
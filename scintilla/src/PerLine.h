@@ -9,45 +9,36 @@
 namespace Scintilla::Internal {
 
 /**
- * This holds the marker identifier and the marker type to display.
- * MarkerHandleNumbers are members of lists.
+ * Lines holding one marker number in ascending order with the handle of each instance,
+ * instances on same line are in order added. Costs 12 bytes per marker on 64-bit.
  */
-struct MarkerHandleNumber {
-	int handle;
-	int number;
-	MarkerHandleNumber(int handle_, int number_) noexcept : handle(handle_), number(number_) {}
-};
-
-/**
- * A marker handle set contains any number of MarkerHandleNumbers.
- */
-class MarkerHandleSet {
-	std::forward_list<MarkerHandleNumber> mhList;
-
-public:
-	MarkerHandleSet() noexcept;
-	// Deleted so MarkerHandleSet objects can not be copied.
-	MarkerHandleSet(const MarkerHandleSet &) = delete;
-	MarkerHandleSet(MarkerHandleSet &&) = delete;
-	void operator=(const MarkerHandleSet &) = delete;
-	void operator=(MarkerHandleSet &&) = delete;
-	~MarkerHandleSet();
-	bool Empty() const noexcept;
-	MarkerMask MarkValue() const noexcept;	///< Bit set of marker numbers.
-	bool Contains(int handle) const noexcept;
-	bool InsertHandle(int handle, int markerNum);
-	void RemoveHandle(int handle);
-	bool RemoveNumber(int markerNum, bool all);
-	void CombineWith(MarkerHandleSet *other) noexcept;
-	MarkerHandleNumber const *GetMarkerHandleNumber(int which) const noexcept;
+struct MarkerLines {
+	std::vector<Sci::Line> lines;
+	std::vector<int> handles;
+	bool Empty() const noexcept {
+		return lines.empty();
+	}
+	void Clear() noexcept;
+	bool Contains(Sci::Line line) const noexcept;
+	// first instance at or after line
+	size_t LowerBound(Sci::Line line) const noexcept;
+	void Insert(Sci::Line line, int handle);
+	void Erase(size_t first, size_t last) noexcept;
+	void MoveLines(Sci::Line line, Sci::Line delta) noexcept;
+	size_t MemoryUsage() const noexcept;
 };
 
 class LineMarkers final : public PerLine {
-	SplitVector<std::unique_ptr<MarkerHandleSet>> markers;
+	// Sorted lines for each marker number, so finding next or previous marker is a binary search
+	// and only marked lines use memory.
+	MarkerLines markers[MarkerMax + 1];
+	MarkerMask used;	///< Bit set of marker numbers with instances.
 	/// Handles are allocated sequentially and should never have to be reused as 32 bit ints are very big.
 	int handleCurrent;
+	// handle and number of which'th instance on line, most recently added first.
+	int FindOnLine(Sci::Line line, int which, int &number) const noexcept;
 public:
-	LineMarkers() noexcept : handleCurrent(0) {}
+	LineMarkers() noexcept : used(0), handleCurrent(0) {}
 	// Deleted so LineMarkers objects can not be copied.
 	LineMarkers(const LineMarkers &) = delete;
 	LineMarkers(LineMarkers &&) = delete;
@@ -59,20 +50,48 @@ public:
 	void InsertLine(Sci::Line line) override;
 	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
+	size_t MemoryUsage() const noexcept override;
 
 	MarkerMask MarkValue(Sci::Line line) const noexcept;
 	Sci::Line MarkerNext(Sci::Line lineStart, MarkerMask mask) const noexcept;
+	Sci::Line MarkerPrevious(Sci::Line lineStart, MarkerMask mask) const noexcept;
 	int AddMark(Sci::Line line, int markerNum, Sci::Line lines);
-	void MergeMarkers(Sci::Line line);
 	bool DeleteMark(Sci::Line line, int markerNum, bool all);
+	bool DeleteAllMarks(int markerNum) noexcept;
 	void DeleteMarkFromHandle(int markerHandle);
 	Sci::Line LineFromHandle(int markerHandle) const noexcept;
 	int HandleFromLine(Sci::Line line, int which) const noexcept;
 	int NumberFromLine(Sci::Line line, int which) const noexcept;
 };
 
+/**
+ * One value for each line, stored as runs of equal values while most lines have the same
+ * value as the line before, like line states of lexers which only store state on a few lines,
+ * switching to one int per line when values change too often for runs to be smaller.
+ */
+class LineValues {
+	std::unique_ptr<RunStyles<Sci::Line, int>> runs;	// nullptr when values are used
+	SplitVector<int> values;
+	void SwitchToValues();
+public:
+	LineValues();
+	// Deleted so LineValues objects can not be copied.
+	LineValues(const LineValues &) = delete;
+	LineValues(LineValues &&) = delete;
+	void operator=(const LineValues &) = delete;
+	void operator=(LineValues &&) = delete;
+	~LineValues();
+	Sci::Line Length() const noexcept;
+	int ValueAt(Sci::Line line) const noexcept;
+	void SetValueAt(Sci::Line line, int value);
+	void InsertValue(Sci::Line line, Sci::Line lines, int value);
+	void Delete(Sci::Line line);
+	void DeleteAll();
+	size_t MemoryUsage() const noexcept;
+};
+
 class LineLevels final : public PerLine {
-	SplitVector<int> levels;
+	LineValues levels;
 public:
 	LineLevels() = default;
 	// Deleted so LineLevels objects can not be copied.
@@ -86,6 +105,7 @@ public:
 	void InsertLine(Sci::Line line) override;
 	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
+	size_t MemoryUsage() const noexcept override;
 
 	void ExpandLevels(Sci::Line sizeNew = -1);
 	void ClearLevels();
@@ -94,7 +114,7 @@ public:
 };
 
 class LineState final : public PerLine {
-	SplitVector<int> lineStates;
+	LineValues lineStates;
 public:
 	LineState() = default;
 	// Deleted so LineState objects can not be copied.
@@ -108,6 +128,7 @@ public:
 	void InsertLine(Sci::Line line) override;
 	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
+	size_t MemoryUsage() const noexcept override;
 
 	int SetLineState(Sci::Line line, int state, Sci::Line lines);
 	int GetLineState(Sci::Line line) const noexcept;
@@ -129,6 +150,7 @@ public:
 	void InsertLine(Sci::Line line) override;
 	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
+	size_t MemoryUsage() const noexcept override;
 
 	bool MultipleStyles(Sci::Line line) const noexcept;
 	int Style(Sci::Line line) const noexcept;
@@ -159,6 +181,7 @@ public:
 	void InsertLine(Sci::Line line) override;
 	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
+	size_t MemoryUsage() const noexcept override;
 
 	bool ClearTabstops(Sci::Line line) noexcept;
 	bool AddTabstop(Sci::Line line, int x);
@@ -21,9 +21,11 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <chrono>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
+#include "ScintillaStructures.h"
 #include "ILoader.h"
 #include "ILexer.h"
 
@@ -52,6 +54,7 @@
 #include "UniConversion.h"
 #include "Selection.h"
 #include "PositionCache.h"
+#include "ElapsedPeriod.h"
 
 using namespace Scintilla;
 using namespace Scintilla::Internal;
@@ -64,9 +67,13 @@ void BidiData::Resize(size_t maxLineLength_) {
 LineLayout::LineLayout(Sci::Line lineNumber_, int maxLineLength_) :
 	lenLineStarts(0),
 	lineNumber(lineNumber_),
+	slotOlder(SIZE_MAX),
+	slotNewer(SIZE_MAX),
+	memoryCounted(0),
 	maxLineLength(-1),
 	numCharsInLine(0),
 	numCharsBeforeEOL(0),
+	indentEnd(0),
 	validity(ValidLevel::invalid),
 	xHighlightGuide(0),
 	highlightColumn(false),
@@ -100,6 +107,15 @@ void LineLayout::Resize(int maxLineLength_) {
 	}
 }
 
+// Reuse buffers for another line.
+void LineLayout::ReSet(Sci::Line lineNumber_, int maxLineLength_) {
+	lineNumber = lineNumber_;
+	Resize(maxLineLength_);
+	validity = ValidLevel::invalid;
+	widthLine = wrapWidthInfinite;
+	lines = 1;
+}
+
 void LineLayout::EnsureBidiData() {
 	if (!bidiData) {
 		bidiData = std::make_unique<BidiData>();
@@ -113,6 +129,19 @@ void LineLayout::Free() noexcept {
 	positions.reset();
 	lineStarts.reset();
 	bidiData.reset();
+	measuredBlocks.clear();
+}
+
+size_t LineLayout::MemoryUsage() const noexcept {
+	size_t size = sizeof(LineLayout) + lenLineStarts*sizeof(int);
+	if (maxLineLength >= 0) {
+		size += (maxLineLength + 1)*(sizeof(char) + sizeof(unsigned char)) + (maxLineLength + 2)*sizeof(XYPOSITION);
+	}
+	if (bidiData) {
+		size += sizeof(BidiData) + bidiData->stylesFonts.capacity()*sizeof(std::shared_ptr<Font>)
+			+ bidiData->widthReprs.capacity()*sizeof(XYPOSITION);
+	}
+	return size;
 }
 
 void LineLayout::Invalidate(ValidLevel validity_) noexcept {
@@ -120,6 +149,17 @@ void LineLayout::Invalidate(ValidLevel validity_) noexcept {
 		validity = validity_;
 }
 
+// Positions of outline fonts scale with font size, scaled positions are kept as measured
+// so only wrapping is redone.
+void LineLayout::Scale(XYPOSITION ratio) noexcept {
+	if (validity != ValidLevel::invalid) {
+		for (int i = 0; i <= numCharsInLine; i++) {
+			positions[i] *= ratio;
+		}
+		Invalidate(ValidLevel::positions);
+	}
+}
+
 Sci::Line LineLayout::LineNumber() const noexcept {
 	return lineNumber;
 }
@@ -364,7 +404,9 @@ XYPOSITION ScreenLine::TabPositionAfter(XYPOSITION xPosition) const noexcept {
 LineLayoutCache::LineLayoutCache() :
 	lastCaretSlot(SIZE_MAX),
 	level(LineCache::None),
-	allInvalidated(false), styleClock(-1) {
+	allInvalidated(false), styleClock(-1),
+	budget(0), memoryCounted(0),
+	slotNewest(SIZE_MAX), slotOldest(SIZE_MAX) {
 }
 
 LineLayoutCache::~LineLayoutCache() = default;
@@ -510,6 +552,13 @@ void LineLayoutCache::AllocateForLevel(Sci::Line linesOnScreen, Sci::Line linesI
 	}
 	if (lengthForLevel != cache.size()) {
 		allInvalidated = false;
+		if (Budgeted()) {
+			for (size_t slot = lengthForLevel; slot < cache.size(); slot++) {
+				if (cache[slot]) {
+					Unlink(slot);
+				}
+			}
+		}
 		cache.resize(lengthForLevel);
 		//printf("%s level=%d, size=%zu/%zu, LineLayout=%zu/%zu, BidiData=%zu, XYPOSITION=%zu\n",
 		//	__func__, level, cache.size(), cache.capacity(), sizeof(LineLayout),
@@ -521,6 +570,9 @@ void LineLayoutCache::AllocateForLevel(Sci::Line linesOnScreen, Sci::Line linesI
 void LineLayoutCache::Deallocate() noexcept {
 	cache.clear();
 	lastCaretSlot = SIZE_MAX;
+	memoryCounted = 0;
+	slotNewest = SIZE_MAX;
+	slotOldest = SIZE_MAX;
 }
 
 void LineLayoutCache::Invalidate(LineLayout::ValidLevel validity_) noexcept {
@@ -536,12 +588,87 @@ void LineLayoutCache::Invalidate(LineLayout::ValidLevel validity_) noexcept {
 	}
 }
 
+void LineLayoutCache::Scale(XYPOSITION ratio) noexcept {
+	if (!allInvalidated) {
+		for (const auto &ll : cache) {
+			if (ll) {
+				ll->Scale(ratio);
+			}
+		}
+	}
+}
+
 void LineLayoutCache::SetLevel(LineCache level_) noexcept {
 	if (level != level_) {
 		level = level_;
 		allInvalidated = false;
-		cache.clear();
-		lastCaretSlot = SIZE_MAX;
+		Deallocate();
+	}
+}
+
+void LineLayoutCache::SetBudget(size_t budget_) noexcept {
+	if (budget != budget_) {
+		// layouts are only linked when budgeted
+		if ((budget == 0 || budget_ == 0) && level == LineCache::Document) {
+			allInvalidated = false;
+			Deallocate();
+		}
+		budget = budget_;
+	}
+}
+
+size_t LineLayoutCache::MemoryUsage() const noexcept {
+	if (Budgeted()) {
+		return memoryCounted + cache.capacity()*sizeof(std::unique_ptr<LineLayout>);
+	}
+	size_t size = cache.capacity()*sizeof(std::unique_ptr<LineLayout>);
+	for (const auto &ll : cache) {
+		if (ll) {
+			size += ll->MemoryUsage();
+		}
+	}
+	return size;
+}
+
+void LineLayoutCache::Unlink(size_t slot) noexcept {
+	LineLayout *ll = cache[slot].get();
+	if (ll->slotOlder != SIZE_MAX) {
+		cache[ll->slotOlder]->slotNewer = ll->slotNewer;
+	} else {
+		slotOldest = ll->slotNewer;
+	}
+	if (ll->slotNewer != SIZE_MAX) {
+		cache[ll->slotNewer]->slotOlder = ll->slotOlder;
+	} else {
+		slotNewest = ll->slotOlder;
+	}
+	ll->slotOlder = SIZE_MAX;
+	ll->slotNewer = SIZE_MAX;
+	memoryCounted -= ll->memoryCounted;
+	ll->memoryCounted = 0;
+}
+
+void LineLayoutCache::LinkNewest(size_t slot) noexcept {
+	LineLayout *ll = cache[slot].get();
+	ll->slotOlder = slotNewest;
+	ll->slotNewer = SIZE_MAX;
+	if (slotNewest != SIZE_MAX) {
+		cache[slotNewest]->slotNewer = slot;
+	} else {
+		slotOldest = slot;
+	}
+	slotNewest = slot;
+	// bidirectional data is allocated after retrieving, so counted on next retrieve.
+	ll->memoryCounted = ll->MemoryUsage();
+	memoryCounted += ll->memoryCounted;
+}
+
+// Discard least recently used layouts until within budget.
+void LineLayoutCache::Trim(size_t slotKeep) noexcept {
+	while (memoryCounted > budget && slotOldest != SIZE_MAX && slotOldest != slotKeep) {
+		const size_t slot = slotOldest;
+		Unlink(slot);
+		cache[slot].reset();
 	}
 }
 
@@ -581,6 +708,10 @@ LineLayout *LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci::Line lineCaret,
 		pos = lineNumber;
 	}
 
+	const bool budgeted = Budgeted();
+	if (budgeted && cache[pos]) {
+		Unlink(pos);
+	}
 	LineLayout *ret = cache[pos].get();
 	if (ret) {
 		if (!ret->CanHold(lineNumber, maxChars)) {
@@ -598,6 +729,10 @@ LineLayout *LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci::Line lineCaret,
 		cache[pos] = std::make_unique<LineLayout>(lineNumber, maxChars);
 		ret = cache[pos].get();
 	}
+	if (budgeted) {
+		LinkNewest(pos);
+		Trim(pos);
+	}
 
 	// LineLineCache::None is not supported, we only use LineCache::Page.
 	return ret;
@@ -633,6 +768,34 @@ constexpr unsigned int representationKeyCrLf = ('\r' << 8) | '\n';
 
 }
 
+SpecialRepresentations::SpecialRepresentations(const SpecialRepresentations &other) {
+	*this = other;
+}
+
+SpecialRepresentations &SpecialRepresentations::operator=(const SpecialRepresentations &other) {
+	if (this != &other) {
+		mapReprs = other.mapReprs;
+		std::copy(std::begin(other.startByteHasReprs), std::end(other.startByteHasReprs), startByteHasReprs);
+		graphicReprs = other.graphicReprs;
+		crlf = other.crlf;
+		// tables point into own map
+		std::fill(std::begin(byteReprs), std::end(byteReprs), nullptr);
+		std::fill(std::begin(c1Reprs), std::end(c1Reprs), nullptr);
+		for (const auto &[key, repr] : mapReprs) {
+			if (const Representation **slot = Slot(key)) {
+				*slot = &repr;
+			}
+		}
+	}
+	return *this;
+}
+
+void SpecialRepresentations::UpdateGraphicReprs() noexcept {
+	graphicReprs = std::any_of(startByteHasReprs + ' ', startByteHasReprs + 0x7f, [](unsigned char count) noexcept {
+		return count != 0;
+	});
+}
+
 void SpecialRepresentations::SetRepresentation(std::string_view charBytes, std::string_view value) {
 	if ((charBytes.length() <= 4) && (value.length() <= Representation::maxLength)) {
 		const unsigned int key = KeyFromString(charBytes);
@@ -641,6 +804,10 @@ void SpecialRepresentations::SetRepresentation(std::string_view charBytes, std::
 			// New entry so increment for first byte
 			const unsigned char ucStart = charBytes.empty() ? 0 : charBytes[0];
 			startByteHasReprs[ucStart]++;
+			UpdateGraphicReprs();
+			if (const Representation **slot = Slot(key)) {
+				*slot = &it->second;
+			}
 			if (key == representationKeyCrLf) {
 				crlf = true;
 			}
@@ -680,9 +847,13 @@ void SpecialRepresentations::ClearRepresentation(std::string_view charBytes) {
 		const unsigned int key = KeyFromString(charBytes);
 		const auto it = mapReprs.find(key);
 		if (it != mapReprs.end()) {
+			if (const Representation **slot = Slot(key)) {
+				*slot = nullptr;
+			}
 			mapReprs.erase(it);
 			const unsigned char ucStart = charBytes.empty() ? 0 : charBytes[0];
 			startByteHasReprs[ucStart]--;
+			UpdateGraphicReprs();
 			if (key == representationKeyCrLf) {
 				crlf = false;
 			}
@@ -691,7 +862,14 @@ void SpecialRepresentations::ClearRepresentation(std::string_view charBytes) {
 }
 
 const Representation *SpecialRepresentations::GetRepresentation(std::string_view charBytes) const {
-	const auto it = mapReprs.find(KeyFromString(charBytes));
+	const unsigned int key = KeyFromString(charBytes);
+	if (key < 0x100) {
+		return byteReprs[key];
+	}
+	if (key - 0xC280 < 0x40) {
+		return c1Reprs[key - 0xC280];
+	}
+	const auto it = mapReprs.find(key);
 	if (it != mapReprs.end()) {
 		return &(it->second);
 	}
@@ -703,10 +881,7 @@ const Representation *SpecialRepresentations::RepresentationFromCharacter(std::s
 		const unsigned char ucStart = charBytes.empty() ? 0 : charBytes[0];
 		if (!startByteHasReprs[ucStart])
 			return nullptr;
-		const auto it = mapReprs.find(KeyFromString(charBytes));
-		if (it != mapReprs.end()) {
-			return &(it->second);
-		}
+		return GetRepresentation(charBytes);
 	}
 	return nullptr;
 }
@@ -716,14 +891,16 @@ bool SpecialRepresentations::Contains(std::string_view charBytes) const {
 	const unsigned char ucStart = charBytes.empty() ? 0 : charBytes[0];
 	if (!startByteHasReprs[ucStart])
 		return false;
-	const auto it = mapReprs.find(KeyFromString(charBytes));
-	return it != mapReprs.end();
+	return GetRepresentation(charBytes) != nullptr;
 }
 
 void SpecialRepresentations::Clear() noexcept {
 	mapReprs.clear();
+	std::fill(std::begin(byteReprs), std::end(byteReprs), nullptr);
+	std::fill(std::begin(c1Reprs), std::end(c1Reprs), nullptr);
 	constexpr unsigned char none = 0;
 	std::fill(startByteHasReprs, std::end(startByteHasReprs), none);
+	graphicReprs = false;
 	crlf = false;
 }
 
@@ -740,7 +917,7 @@ void BreakFinder::Insert(Sci::Position val) {
 }
 
 BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lineRange_, Sci::Position posLineStart_,
-	XYPOSITION xStart, bool breakForSelection, const Document *pdoc_, const SpecialRepresentations *preprs_, const ViewStyle *pvsDraw) :
+	XYPOSITION xStart, bool breakForSelection, const Document *pdoc_, const SpecialRepresentations *preprs_, const ViewStyle *pvsDraw, int fieldDelimiter_) :
 	ll(ll_),
 	lineRange(lineRange_),
 	posLineStart(posLineStart_),
@@ -750,7 +927,8 @@ BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lin
 	subBreak(-1),
 	pdoc(pdoc_),
 	encodingFamily(pdoc_->CodePageFamily()),
-	preprs(preprs_) {
+	preprs(preprs_),
+	fieldDelimiter(static_cast<char>(fieldDelimiter_)) {
 
 	// Search for first visible break
 	// First find the first visible character
@@ -793,10 +971,56 @@ BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lin
 
 BreakFinder::~BreakFinder() = default;
 
+// find first position in [pos, end) which needs checking in Next(): not graphic ASCII,
+// style changed or after field delimiter. pos must be greater than zero.
+int BreakFinder::SkipPlainText(int pos, int end) const noexcept {
+	const char * const chars = ll->chars.get();
+	const unsigned char * const styles = ll->styles.get();
+#if NP2_USE_SSE2
+	if (pos + static_cast<int>(sizeof(__m128i)) <= end) {
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i del = _mm_set1_epi8('\x7f');
+		const __m128i delimiter = _mm_set1_epi8(fieldDelimiter);
+		do {
+			const __m128i chunk = _mm_loadu_si128((const __m128i *)(chars + pos));
+			const __m128i style = _mm_loadu_si128((const __m128i *)(styles + pos));
+			const __m128i stylePrev = _mm_loadu_si128((const __m128i *)(styles + pos - 1));
+			// signed compare also catches bytes >= 0x80
+			uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del)));
+			mask |= _mm_movemask_epi8(_mm_cmpeq_epi8(style, stylePrev)) ^ 0xffff;
+			if (fieldDelimiter) {
+				const __m128i chunkPrev = _mm_loadu_si128((const __m128i *)(chars + pos - 1));
+				mask |= _mm_movemask_epi8(_mm_cmpeq_epi8(chunkPrev, delimiter));
+			}
+			if (mask) {
+				return pos + np2::ctz(mask);
+			}
+			pos += sizeof(__m128i);
+		} while (pos + static_cast<int>(sizeof(__m128i)) <= end);
+	}
+#endif
+	for (; pos < end; pos++) {
+		const unsigned char ch = chars[pos];
+		if (ch < ' ' || ch > '~' || styles[pos] != styles[pos - 1] || (fieldDelimiter && chars[pos - 1] == fieldDelimiter)) {
+			break;
+		}
+	}
+	return pos;
+}
+
 TextSegment BreakFinder::Next() {
 	if (subBreak == -1) {
 		const int prev = nextBreak;
+		// graphic ASCII without representation doesn't break, skip them in bulk
+		const bool skipPlain = !preprs->ContainsGraphic();
 		while (nextBreak < lineRange.end) {
+			if (skipPlain && nextBreak > 0) {
+				const int end = (saeNext > nextBreak) ? std::min(saeNext, static_cast<int>(lineRange.end)) : static_cast<int>(lineRange.end);
+				nextBreak = SkipPlainText(nextBreak, end);
+				if (nextBreak >= lineRange.end) {
+					break;
+				}
+			}
 			int charWidth = 1;
 			const char * const chars = &ll->chars[nextBreak];
 			const unsigned char ch = chars[0];
@@ -816,6 +1040,8 @@ TextSegment BreakFinder::Next() {
 				repr = preprs->GetRepresentation(std::string_view(chars, charWidth));
 			}
 			if (((nextBreak > 0) && (ll->styles[nextBreak] != ll->styles[nextBreak - 1])) ||
+				// text after field delimiter may be moved to next tab stop
+				(fieldDelimiter && (nextBreak > 0) && (ll->chars[nextBreak - 1] == fieldDelimiter)) ||
 				repr ||
 				(nextBreak == saeNext)) {
 				while ((nextBreak >= saeNext) && (saeNext < lineRange.end)) {
@@ -865,12 +1091,12 @@ bool BreakFinder::More() const noexcept {
 }
 
 PositionCacheEntry::PositionCacheEntry() noexcept :
-	styleNumber(0), len(0), clock(0) {
+	styleNumber(0), len(0), chain(0), older(0), newer(0), hash(0) {
 }
 
 // Copy constructor not currently used, but needed for being element in std::vector.
 PositionCacheEntry::PositionCacheEntry(const PositionCacheEntry &other) :
-	styleNumber(other.styleNumber), len(other.styleNumber), clock(other.styleNumber) {
+	styleNumber(other.styleNumber), len(other.len), chain(other.chain), older(other.older), newer(other.newer), hash(other.hash) {
 	if (other.positions) {
 		const size_t lenData = len + (len / sizeof(XYPOSITION)) + 1;
 		positions = std::make_unique<XYPOSITION[]>(lenData);
@@ -879,10 +1105,10 @@ PositionCacheEntry::PositionCacheEntry(const PositionCacheEntry &other) :
 }
 
 void PositionCacheEntry::Set(unsigned int styleNumber_, std::string_view sv,
-	const XYPOSITION *positions_, unsigned int clock_) {
+	const XYPOSITION *positions_, size_t hash_) {
 	styleNumber = styleNumber_;
 	len = static_cast<unsigned int>(sv.length());
-	clock = clock_;
+	hash = hash_;
 	if (sv.data() && positions_) {
 		positions = std::make_unique<XYPOSITION[]>(len + (len / sizeof(XYPOSITION)) + 1);
 		for (unsigned int i = 0; i < len; i++) {
@@ -902,7 +1128,20 @@ void PositionCacheEntry::Clear() noexcept {
 	positions.reset();
 	styleNumber = 0;
 	len = 0;
-	clock = 0;
+	hash = 0;
+}
+
+void PositionCacheEntry::Scale(XYPOSITION ratio) noexcept {
+	if (positions) {
+		for (unsigned int i = 0; i < len; i++) {
+			positions[i] *= ratio;
+		}
+	}
+}
+
+size_t PositionCacheEntry::MemoryUsage() const noexcept {
+	// same allocation size as Set()
+	return positions ? (len + (len / sizeof(XYPOSITION)) + 1) * sizeof(XYPOSITION) : 0;
 }
 
 bool PositionCacheEntry::Retrieve(unsigned int styleNumber_, std::string_view sv, XYPOSITION *positions_) const noexcept {
@@ -923,46 +1162,41 @@ size_t PositionCacheEntry::Hash(unsigned int styleNumber_, std::string_view sv)
 	return h1 ^ (h2 << 1);
 }
 
-bool PositionCacheEntry::NewerThan(const PositionCacheEntry &other) const noexcept {
-	return clock > other.clock;
-}
-
-void PositionCacheEntry::ResetClock() noexcept {
-	if (clock > 0) {
-		clock = 1;
-	}
-}
-
-#define PositionCacheHashSizeUsePowerOfTwo	1
-PositionCache::PositionCache() {
-	clock = 1;
-#if PositionCacheHashSizeUsePowerOfTwo
+PositionCache::PositionCache() : used{0}, newest{invalidIndex}, oldest{invalidIndex}, timing{false} {
 	pces.resize(2048);
-#else
-	pces.resize(2039);
-#endif
-	allClear = true;
+	buckets.resize(pces.size(), invalidIndex);
 }
 
 void PositionCache::Clear() noexcept {
-	if (!allClear) {
-		for (auto &pce : pces) {
-			pce.Clear();
+	if (used != 0) {
+		for (unsigned int index = 0; index < used; index++) {
+			pces[index].Clear();
 		}
+		std::fill(buckets.begin(), buckets.end(), invalidIndex);
+	}
+	used = 0;
+	newest = invalidIndex;
+	oldest = invalidIndex;
+}
+
+void PositionCache::Scale(XYPOSITION ratio) noexcept {
+	for (unsigned int index = 0; index < used; index++) {
+		pces[index].Scale(ratio);
 	}
-	clock = 1;
-	allClear = true;
 }
 
 void PositionCache::SetSize(size_t size_) {
 	Clear();
+	// power of two for masking hash value, index must fit in unsigned int
+	size_ = std::min<size_t>(size_, invalidIndex/2 + 1);
+	if (size_ & (size_ - 1)) {
+		size_ = NextPowerOfTwo(size_);
+	}
 	if (size_ != pces.size()) {
-#if PositionCacheHashSizeUsePowerOfTwo
-		if (size_ & (size_ - 1)) {
-			size_ = NextPowerOfTwo(size_);
-		}
-#endif
+		pces.clear();
 		pces.resize(size_);
+		buckets.resize(size_);
+		Clear();
 	}
 }
 
@@ -970,17 +1204,101 @@ size_t PositionCache::GetSize() const noexcept {
 	return pces.size();
 }
 
+size_t PositionCache::MemoryUsage() const noexcept {
+	size_t size = pces.capacity()*sizeof(PositionCacheEntry) + buckets.capacity()*sizeof(unsigned int);
+	for (const PositionCacheEntry &pce : pces) {
+		size += pce.MemoryUsage();
+	}
+	return size;
+}
+
+void PositionCache::Unlink(unsigned int index) noexcept {
+	PositionCacheEntry &pce = pces[index];
+	if (pce.older != invalidIndex) {
+		pces[pce.older].newer = pce.newer;
+	} else {
+		oldest = pce.newer;
+	}
+	if (pce.newer != invalidIndex) {
+		pces[pce.newer].older = pce.older;
+	} else {
+		newest = pce.older;
+	}
+}
+
+void PositionCache::MakeNewest(unsigned int index) noexcept {
+	PositionCacheEntry &pce = pces[index];
+	pce.older = newest;
+	pce.newer = invalidIndex;
+	if (newest != invalidIndex) {
+		pces[newest].newer = index;
+	} else {
+		oldest = index;
+	}
+	newest = index;
+}
+
+unsigned int PositionCache::Find(size_t hashValue, unsigned int styleNumber, std::string_view sv, XYPOSITION *positions) noexcept {
+	unsigned int index = buckets[hashValue & (buckets.size() - 1)];
+	while (index != invalidIndex) {
+		const PositionCacheEntry &pce = pces[index];
+		if (pce.hash == hashValue && pce.Retrieve(styleNumber, sv, positions)) {
+			if (index != newest) {
+				Unlink(index);
+				MakeNewest(index);
+			}
+			break;
+		}
+		index = pce.chain;
+	}
+	return index;
+}
+
+void PositionCache::Store(size_t hashValue, unsigned int styleNumber, std::string_view sv, const XYPOSITION *positions) {
+	unsigned int index = used;
+	if (used < pces.size()) {
+		used++;
+	} else {
+		// evict least recently used entry
+		index = oldest;
+		Unlink(index);
+		unsigned int *link = &buckets[pces[index].hash & (buckets.size() - 1)];
+		while (*link != index) {
+			link = &pces[*link].chain;
+		}
+		*link = pces[index].chain;
+		statistics.evictions++;
+	}
+	PositionCacheEntry &pce = pces[index];
+	pce.Set(styleNumber, sv, positions, hashValue);
+	unsigned int &bucket = buckets[hashValue & (buckets.size() - 1)];
+	pce.chain = bucket;
+	bucket = index;
+	MakeNewest(index);
+}
+
+void PositionCache::MeasurePlatform(Surface *surface, const Font *font, std::string_view sv, XYPOSITION *positions) {
+	if (timing) {
+		const ElapsedPeriod period;
+		surface->MeasureWidths(font, sv, positions);
+		statistics.measureTime += period.Duration();
+	} else {
+		surface->MeasureWidths(font, sv, positions);
+	}
+}
+
 void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 	std::string_view sv, XYPOSITION *positions) {
 	const Style &style = vstyle.styles[styleNumber];
 	if (style.monospaceASCII && AllGraphicASCII(sv)) {
-		const XYPOSITION aveCharWidth = style.aveCharWidth;
+		// positions computed from measured advance without calling into platform layer
+		const XYPOSITION monospaceCharacterWidth = style.monospaceCharacterWidth;
 		const size_t length = sv.length();
 #if NP2_USE_SSE2
 		if (length >= 2) {
 			XYPOSITION *ptr = positions;
 			const XYPOSITION * const end = ptr + length - 1;
-			const __m128d one = _mm_set1_pd(aveCharWidth);
+			const __m128d one = _mm_set1_pd(monospaceCharacterWidth);
 			const __m128d two = _mm_set1_pd(2);
 			__m128d inc = _mm_setr_pd(1, 2);
 			do {
@@ -992,62 +1310,26 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 				_mm_store_sd(ptr, _mm_mul_sd(one, inc));
 			}
 		} else {
-			positions[0] = aveCharWidth;
+			positions[0] = monospaceCharacterWidth;
 		}
 #else
 		for (size_t i = 0; i < length; i++) {
-			positions[i] = aveCharWidth * (i + 1);
+			positions[i] = monospaceCharacterWidth * (i + 1);
 		}
 #endif
 		return;
 	}
 
-	size_t probe = pces.size();	// Out of bounds
-	if ((sv.length() < 64)) {
-		// Only store short strings in the cache so it doesn't churn with
-		// long comments with only a single comment.
-#if PositionCacheHashSizeUsePowerOfTwo
-		const size_t mask = probe - 1;
-#else
-		const size_t modulo = probe;
-#endif
-		// Two way associative: try two probe positions.
-		const size_t hashValue = PositionCacheEntry::Hash(styleNumber, sv);
-#if PositionCacheHashSizeUsePowerOfTwo
-		probe = hashValue & mask;
-#else
-		probe = hashValue % modulo;
-#endif
-		if (pces[probe].Retrieve(styleNumber, sv, positions)) {
-			return;
-		}
-#if PositionCacheHashSizeUsePowerOfTwo
-		const size_t probe2 = (hashValue * 37) & mask;
-#else
-		const size_t probe2 = (hashValue * 37) % modulo;
-#endif
-		if (pces[probe2].Retrieve(styleNumber, sv, positions)) {
-			return;
-		}
-		// Not found. Choose the oldest of the two slots to replace
-		if (pces[probe].NewerThan(pces[probe2])) {
-			probe = probe2;
-		}
+	if (sv.length() > maxCachedLength || pces.empty()) {
+		MeasurePlatform(surface, style.font.get(), sv, positions);
+		return;
 	}
-
-	surface->MeasureWidths(style.font.get(), sv, positions);
-	if (probe < pces.size()) {
-		// Store into cache
-		clock++;
-		if (clock > 60000) {
-			// Since there are only 16 bits for the clock, wrap it round and
-			// reset all cache entries so none get stuck with a high clock.
-			for (PositionCacheEntry &pce : pces) {
-				pce.ResetClock();
-			}
-			clock = 2;
-		}
-		allClear = false;
-		pces[probe].Set(styleNumber, sv, positions, clock);
+	const size_t hashValue = PositionCacheEntry::Hash(styleNumber, sv);
+	if (Find(hashValue, styleNumber, sv, positions) != invalidIndex) {
+		statistics.hits++;
+		return;
 	}
+	statistics.misses++;
+	MeasurePlatform(surface, style.font.get(), sv, positions);
+	Store(hashValue, styleNumber, sv, positions);
 }
@@ -53,6 +53,10 @@ private:
 	int lenLineStarts;
 	/// Drawing is only performed for @a maxLineLength characters on each line.
 	Sci::Line lineNumber;
+	// links and counted memory for LineLayoutCache with memory budget
+	size_t slotOlder;
+	size_t slotNewer;
+	size_t memoryCounted;
 public:
 	enum {
 		wrapWidthInfinite = 0x7ffffff
@@ -61,6 +65,9 @@ public:
 	int maxLineLength;
 	int numCharsInLine;
 	int numCharsBeforeEOL;
+	// Offset of first character that is not space or tab, indentation guides and indentation
+	// whitespace are only drawn before it.
+	int indentEnd;
 	enum class ValidLevel {
 		invalid, checkTextAndStyle, positions, lines
 	} validity;
@@ -72,6 +79,8 @@ public:
 	std::unique_ptr<unsigned char[]> styles;
 	std::unique_ptr<XYPOSITION[]> positions;
 	char bracePreviousStyles[2];
+	// Measured state of each block of a very long line with estimated positions, empty when all measured
+	std::vector<bool> measuredBlocks;
 
 	std::unique_ptr<BidiData> bidiData;
 
@@ -91,9 +100,12 @@ public:
 	void operator=(LineLayout &&) = delete;
 	~LineLayout();
 	void Resize(int maxLineLength_);
+	void ReSet(Sci::Line lineNumber_, int maxLineLength_);
 	void EnsureBidiData();
 	void Free() noexcept;
+	size_t MemoryUsage() const noexcept;
 	void Invalidate(ValidLevel validity_) noexcept;
+	void Scale(XYPOSITION ratio) noexcept;
 	Sci::Line LineNumber() const noexcept;
 	bool CanHold(Sci::Line lineDoc, int lineLength_) const noexcept;
 	int LineStart(int line) const noexcept;
@@ -154,7 +166,18 @@ private:
 	Scintilla::LineCache level;
 	bool allInvalidated;
 	int styleClock;
+	// memory budget for LineCache::Document level, slots are linked in recently used order.
+	size_t budget;
+	size_t memoryCounted;
+	size_t slotNewest;
+	size_t slotOldest;
 	void AllocateForLevel(Sci::Line linesOnScreen, Sci::Line linesInDoc);
+	bool Budgeted() const noexcept {
+		return budget != 0 && level == Scintilla::LineCache::Document;
+	}
+	void Unlink(size_t slot) noexcept;
+	void LinkNewest(size_t slot) noexcept;
+	void Trim(size_t slotKeep) noexcept;
 public:
 	LineLayoutCache();
 	// Deleted so LineLayoutCache objects can not be copied.
@@ -165,20 +188,31 @@ public:
 	~LineLayoutCache();
 	void Deallocate() noexcept;
 	void Invalidate(LineLayout::ValidLevel validity_) noexcept;
+	void Scale(XYPOSITION ratio) noexcept;
 	void SetLevel(Scintilla::LineCache level_) noexcept;
 	Scintilla::LineCache GetLevel() const noexcept {
 		return level;
 	}
+	void SetBudget(size_t budget_) noexcept;
+	size_t GetBudget() const noexcept {
+		return budget;
+	}
+	size_t MemoryUsage() const noexcept;
 	LineLayout* SCICALL Retrieve(Sci::Line lineNumber, Sci::Line lineCaret, int maxChars, int styleClock_,
 		Sci::Line linesOnScreen, Sci::Line linesInDoc, Sci::Line topLine);
 };
 
 class PositionCacheEntry {
 	unsigned int styleNumber : 8;
-	unsigned int len : 8;
-	unsigned int clock : 16;
+	unsigned int len : 24;
 	std::unique_ptr<XYPOSITION[]> positions;
 public:
+	// links used by PositionCache: next entry in same hash bucket, and neighbours in recently used order.
+	unsigned int chain;
+	unsigned int older;
+	unsigned int newer;
+	size_t hash;
+
 	PositionCacheEntry() noexcept;
 	// Copy constructor not currently used, but needed for being element in std::vector.
 	PositionCacheEntry(const PositionCacheEntry &);
@@ -187,12 +221,12 @@ public:
 	void operator=(const PositionCacheEntry &) = delete;
 	void operator=(PositionCacheEntry &&) = delete;
 	~PositionCacheEntry();
-	void Set(unsigned int styleNumber_, std::string_view sv, const XYPOSITION *positions_, unsigned int clock_);
+	void Set(unsigned int styleNumber_, std::string_view sv, const XYPOSITION *positions_, size_t hash_);
 	void Clear() noexcept;
+	void Scale(XYPOSITION ratio) noexcept;
 	bool Retrieve(unsigned int styleNumber_, std::string_view sv, XYPOSITION *positions_) const noexcept;
+	size_t MemoryUsage() const noexcept;
 	static size_t Hash(unsigned int styleNumber_, std::string_view sv) noexcept;
-	bool NewerThan(const PositionCacheEntry &other) const noexcept;
-	void ResetClock() noexcept;
 };
 
 class Representation {
@@ -209,10 +243,31 @@ typedef std::map<unsigned int, Representation> MapRepresentation;
 
 class SpecialRepresentations {
 	MapRepresentation mapReprs;
+	// direct lookup for single byte keys and two byte keys with 0xC2 lead (C1 controls in UTF-8),
+	// entries point into mapReprs.
+	const Representation *byteReprs[0x100] {};
+	const Representation *c1Reprs[0x40] {};
 	unsigned char startByteHasReprs[0x100] {};
+	// some graphic ASCII character has representation, so runs of them can't be skipped.
+	bool graphicReprs = false;
 	bool crlf = false;
+	const Representation **Slot(unsigned int key) noexcept {
+		if (key < 0x100) {
+			return &byteReprs[key];
+		}
+		if (key - 0xC280 < 0x40) {
+			return &c1Reprs[key - 0xC280];
+		}
+		return nullptr;
+	}
+	void UpdateGraphicReprs() noexcept;
 public:
 	SpecialRepresentations() noexcept {}
+	SpecialRepresentations(const SpecialRepresentations &other);
+	SpecialRepresentations(SpecialRepresentations &&) = delete;
+	SpecialRepresentations &operator=(const SpecialRepresentations &other);
+	SpecialRepresentations &operator=(SpecialRepresentations &&) = delete;
+	~SpecialRepresentations() = default;
 	void SetRepresentation(std::string_view charBytes, std::string_view value);
 	void SetRepresentationAppearance(std::string_view charBytes, RepresentationAppearance appearance);
 	void SetRepresentationColour(std::string_view charBytes, ColourRGBA colour);
@@ -226,6 +281,9 @@ public:
 	bool MayContains(unsigned char ch) const noexcept {
 		return startByteHasReprs[ch] != 0;
 	}
+	bool ContainsGraphic() const noexcept {
+		return graphicReprs;
+	}
 	void Clear() noexcept;
 };
 
@@ -253,7 +311,9 @@ class BreakFinder {
 	const Document *pdoc;
 	EncodingFamily encodingFamily;
 	const SpecialRepresentations *preprs;
+	char fieldDelimiter;
 	void Insert(Sci::Position val);
+	int SkipPlainText(int pos, int end) const noexcept;
 public:
 	// If a whole run is longer than lengthStartSubdivision then subdivide
 	// into smaller runs at spaces or punctuation.
@@ -265,7 +325,7 @@ public:
 		lengthEachSubdivision = 100
 	};
 	BreakFinder(const LineLayout *ll_, const Selection *psel, Range lineRange_, Sci::Position posLineStart_,
-		XYPOSITION xStart, bool breakForSelection, const Document *pdoc_, const SpecialRepresentations *preprs_, const ViewStyle *pvsDraw);
+		XYPOSITION xStart, bool breakForSelection, const Document *pdoc_, const SpecialRepresentations *preprs_, const ViewStyle *pvsDraw, int fieldDelimiter_);
 	// Deleted so BreakFinder objects can not be copied.
 	BreakFinder(const BreakFinder &) = delete;
 	BreakFinder(BreakFinder &&) = delete;
@@ -276,15 +336,46 @@ public:
 	bool More() const noexcept;
 };
 
+struct PositionCacheStatistics {
+	size_t hits = 0;
+	size_t misses = 0;
+	size_t evictions = 0;
+	// seconds spent in platform measuring, only collected when timing
+	double measureTime = 0;
+};
+
+// Hash table of measured runs with least recently used eviction.
 class PositionCache {
+	static constexpr unsigned int invalidIndex = ~0U;
 	std::vector<PositionCacheEntry> pces;
-	unsigned int clock;
-	bool allClear;
+	// first entry for each hash value, same size as pces
+	std::vector<unsigned int> buckets;
+	unsigned int used;
+	unsigned int newest;
+	unsigned int oldest;
+	PositionCacheStatistics statistics;
+	void MeasurePlatform(Surface *surface, const Font *font, std::string_view sv, XYPOSITION *positions);
+	void Unlink(unsigned int index) noexcept;
+	void MakeNewest(unsigned int index) noexcept;
+	unsigned int Find(size_t hashValue, unsigned int styleNumber, std::string_view sv, XYPOSITION *positions) noexcept;
+	void Store(size_t hashValue, unsigned int styleNumber, std::string_view sv, const XYPOSITION *positions);
 public:
+	// BreakFinder subdivides longer runs, so a longer run is almost always unique text.
+	static constexpr size_t maxCachedLength = BreakFinder::lengthStartSubdivision;
+	bool timing;
 	PositionCache();
 	void Clear() noexcept;
+	// approximate positions after zooming an outline font, until text is measured again.
+	void Scale(XYPOSITION ratio) noexcept;
 	void SetSize(size_t size_);
 	size_t GetSize() const noexcept;
+	size_t MemoryUsage() const noexcept;
+	const PositionCacheStatistics &GetStatistics() const noexcept {
+		return statistics;
+	}
+	void ResetStatistics() noexcept {
+		statistics = {};
+	}
 	void MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 		std::string_view sv, XYPOSITION *positions);
 };
@@ -206,6 +206,8 @@
 
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <algorithm>
 #include <iterator>
 
@@ -243,6 +245,14 @@ using namespace Scintilla::Internal;
 
 #define END     0
 
+/*
+ * skip values for CLO XXX to skip past the closure
+ */
+
+#define ANYSKIP 2 	/* [CLO] ANY END          */
+#define CHRSKIP 3	/* [CLO] CHR chr END      */
+#define CCLSKIP 34	/* [CLO] CCL 32 bytes END */
+
 /*
  * The following defines are not meant to be changeable.
  * They are for readability only.
@@ -263,6 +273,8 @@ RESearch::RESearch(const CharClassify *charClassTable) {
 	failure = 0;
 	charClass = charClassTable;
 	sta = NOP;                  /* status of lastpat */
+	nfaLength = 0;
+	hasFirstSet = false;
 	bol = 0;
 	previousPattern = nullptr;
 	previousLength = 0;
@@ -271,6 +283,7 @@ RESearch::RESearch(const CharClassify *charClassTable) {
 	std::fill(bittab, std::end(bittab), nul);
 	std::fill(tagstk, std::end(tagstk), 0);
 	std::fill(nfa, std::end(nfa), '\0');
+	std::fill(firstSet, std::end(firstSet), '\0');
 	Clear();
 }
 
@@ -279,6 +292,8 @@ void RESearch::ClearCache() noexcept {
 	previousPattern = nullptr;
 	previousLength = 0;
 	previousFlags = FindOption::None;
+	// compiled character classes depend on word characters
+	compiledPatterns.clear();
 }
 
 void RESearch::Clear() noexcept {
@@ -458,15 +473,99 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 		return nullptr;
 	}
 
-	const bool posix = FlagSet(flags, FindOption::Posix);
-	const char * const errmsg = DoCompile(pattern, length, caseSensitive, posix);
-	if (errmsg == nullptr) {
-		previousPattern = pattern;
-		previousLength = length;
-		previousFlags = flags;
-		cachedPattern.assign(pattern, length);
+	const std::string_view text(pattern, length);
+	auto it = std::find_if(compiledPatterns.begin(), compiledPatterns.end(), [=](const CompiledPattern &compiled) noexcept {
+		return compiled.flags == flags && compiled.caseSensitive == caseSensitive && compiled.pattern == text;
+	});
+	if (it != compiledPatterns.end()) {
+		// move to front
+		std::rotate(compiledPatterns.begin(), it, it + 1);
+		const CompiledPattern &compiled = compiledPatterns.front();
+		memcpy(nfa, compiled.nfa.data(), compiled.nfa.length());
+		nfaLength = static_cast<int>(compiled.nfa.length());
+		hasFirstSet = compiled.hasFirstSet;
+		memcpy(firstSet, compiled.firstSet, BITBLK);
+		sta = OKP;
+	} else {
+		const bool posix = FlagSet(flags, FindOption::Posix);
+		const char * const errmsg = DoCompile(pattern, length, caseSensitive, posix);
+		if (errmsg) {
+			return errmsg;
+		}
+		BuildFirstSet();
+		if (compiledPatterns.size() == MaxCompiledPatternCount) {
+			compiledPatterns.pop_back();
+		}
+		CompiledPattern compiled;
+		compiled.pattern = text;
+		compiled.nfa.assign(nfa, nfaLength);
+		compiled.flags = flags;
+		compiled.caseSensitive = caseSensitive;
+		compiled.hasFirstSet = hasFirstSet;
+		memcpy(compiled.firstSet, firstSet, BITBLK);
+		compiledPatterns.insert(compiledPatterns.begin(), std::move(compiled));
+	}
+
+	previousPattern = pattern;
+	previousLength = length;
+	previousFlags = flags;
+	cachedPattern.assign(pattern, length);
+	return nullptr;
+}
+
+/*
+ * RESearch::BuildFirstSet:
+ *   collect characters that can start a match, so Execute can skip
+ *   other positions without calling PMatch. Skipped all zero width
+ *   operators before the first consumed character, stop at closure
+ *   over unknown operator or when the pattern can match empty string.
+ */
+void RESearch::BuildFirstSet() noexcept {
+	std::fill(firstSet, std::end(firstSet), '\0');
+	hasFirstSet = false;
+	const char *ap = nfa;
+	while (true) {
+		switch (*ap) {
+		case CHR:
+			firstSet[static_cast<unsigned char>(ap[1]) >> 3] |= 1 << (ap[1] & BITIND);
+			hasFirstSet = true;
+			return;
+		case CCL:
+			for (int n = 0; n < BITBLK; n++) {
+				firstSet[n] |= ap[n + 1];
+			}
+			hasFirstSet = true;
+			return;
+		case BOT:
+			ap += 2;
+			break;
+		case BOW:
+		case EOW:
+		case EXP_MATCH_WORD_START:
+		case EXP_MATCH_WORD_END:
+			ap++;
+			break;
+		case LCLO:
+		case CLQ:
+		case CLO:
+			// [CLO] XXX END, the closure can match empty string
+			if (ap[1] == CHR) {
+				firstSet[static_cast<unsigned char>(ap[2]) >> 3] |= 1 << (ap[2] & BITIND);
+				ap += 1 + CHRSKIP;
+			} else if (ap[1] == CCL) {
+				for (int n = 0; n < BITBLK; n++) {
+					firstSet[n] |= ap[n + 2];
+				}
+				ap += 1 + CCLSKIP;
+			} else {
+				return;
+			}
+			break;
+		default:
+			// ANY, EOL, EOT moves forward, REF and END can match anything.
+			return;
+		}
 	}
-	return errmsg;
 }
 
 const char *RESearch::DoCompile(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) noexcept {
@@ -789,6 +888,7 @@ const char *RESearch::DoCompile(const char *pattern, Sci::Position length, bool
 	if (tagi > 0)
 		return badpat((posix ? "Unmatched (" : "Unmatched \\("));
 	*mp = END;
+	nfaLength = static_cast<int>(mp - nfa) + 1;
 	sta = OKP;
 	return nullptr;
 }
@@ -815,7 +915,6 @@ const char *RESearch::DoCompile(const char *pattern, Sci::Position length, bool
  *
  */
 int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp) {
-	unsigned char c;
 	Sci::Position ep = NOTFOUND;
 	char *ap = nfa;
 
@@ -837,16 +936,15 @@ int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Positio
 		} else {
 			return 0;
 		}
-	case CHR:			/* ordinary char: locate it fast */
-		c = *(ap + 1);
-		while ((lp < endp) && (static_cast<unsigned char>(ci.CharAt(lp)) != c)) {
-			lp++;
-		}
-		if (lp >= endp)	/* if EOS, fail, else fall through. */
-			return 0;
-		[[fallthrough]];
 	default:			/* regular matching all the way. */
 		while (lp < endp) {
+			if (hasFirstSet) {	/* locate possible start fast */
+				while ((lp < endp) && !isinset(firstSet, ci.CharAt(lp))) {
+					lp++;
+				}
+				if (lp >= endp)
+					break;
+			}
 			Sci::Position offset = 1;
 			ep = PMatch(ci, lp, endp, ap, 1, &offset);
 			if (ep != NOTFOUND)
@@ -865,6 +963,48 @@ int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Positio
 	return 1;
 }
 
+/*
+ * ExecuteBackward:
+ *  find the match with greatest start position inside
+ *  [lp, endp), trying start positions backward from endp
+ *  one whole character at a time. Unlike repeatedly
+ *  calling Execute from previous match start plus one,
+ *  a match never starts inside a multi-byte character.
+ */
+int RESearch::ExecuteBackward(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp) {
+	char *ap = nfa;
+
+	switch (*ap) {
+	case BOL:			/* only one candidate */
+	case EOL:
+	case END:
+		return Execute(ci, lp, endp);
+	default:
+		break;
+	}
+
+	bol = lp;
+	failure = 0;
+
+	Clear();
+
+	Sci::Position bp = endp;
+	while (bp > lp) {
+		bp = ci.MovePositionOutsideChar(bp - 1, -1);
+		if (bp < lp)
+			break;
+		if (hasFirstSet && !isinset(firstSet, ci.CharAt(bp)))
+			continue;
+		const Sci::Position ep = PMatch(ci, bp, endp, ap);
+		if (ep != NOTFOUND) {
+			bopat[0] = bp;
+			eopat[0] = ep;
+			return 1;
+		}
+	}
+	return 0;
+}
+
 /*
  * PMatch: internal routine for the hard part
  *
@@ -896,14 +1036,6 @@ int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Positio
 
 //extern void re_fail(const char *, char);
 
-/*
- * skip values for CLO XXX to skip past the closure
- */
-
-#define ANYSKIP 2 	/* [CLO] ANY END          */
-#define CHRSKIP 3	/* [CLO] CHR chr END      */
-#define CCLSKIP 34	/* [CLO] CCL 32 bytes END */
-
 Sci::Position RESearch::PMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, char *ap, int moveDir, Sci::Position *offset) {
 	uint8_t op;
 	uint8_t n;
@@ -23,12 +23,13 @@ public:
 class RESearch {
 public:
 	explicit RESearch(const CharClassify *charClassTable);
-	// No dynamic allocation so default copy constructor and assignment operator are OK.
+	// Default copy constructor and assignment operator are OK.
 	void Clear() noexcept;
 	void ClearCache() noexcept;
 	void GrabMatches(const CharacterIndexer &ci);
 	const char *Compile(const char *pattern, Sci::Position length, bool caseSensitive, Scintilla::FindOption flags);
 	int Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp);
+	int ExecuteBackward(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp);
 
 	static constexpr int MAXTAG = 10;
 	static constexpr int NOTFOUND = -1;
@@ -43,25 +44,42 @@ private:
 	static constexpr int MAXCHR = 256;
 	static constexpr int CHRBIT = 8;
 	static constexpr int BITBLK = MAXCHR / CHRBIT;
+	static constexpr size_t MaxCompiledPatternCount = 8;
+
+	// compiled pattern, most recently used first
+	struct CompiledPattern {
+		std::string pattern;
+		std::string nfa;
+		Scintilla::FindOption flags;
+		bool caseSensitive;
+		bool hasFirstSet;
+		char firstSet[BITBLK];
+	};
 
 	void ChSet(unsigned char c) noexcept;
 	void ChSetWithCase(unsigned char c, bool caseSensitive) noexcept;
 	int GetBackslashExpression(const char *pattern, int &incr) noexcept;
 
 	const char *DoCompile(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) noexcept;
+	void BuildFirstSet() noexcept;
 	Sci::Position PMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, char *ap, int moveDir = 1, Sci::Position *offset = nullptr);
 
 	Sci::Position bol;
 	Sci::Position tagstk[MAXTAG];  /* subpat tag stack */
 	char nfa[MAXNFA];    /* automaton */
+	int nfaLength;
 	int sta;
 	int failure;
+	// whether firstSet contains every character that can start a match
+	bool hasFirstSet;
+	char firstSet[BITBLK];
 
 	// cache for previous pattern with same address, length and flags
 	const char *previousPattern;
 	Sci::Position previousLength;
 	Scintilla::FindOption previousFlags;
 	std::string cachedPattern;
+	std::vector<CompiledPattern> compiledPatterns;
 
 	unsigned char bittab[BITBLK]; /* bit table for CCL pre-set bits */
 	const CharClassify *charClass;
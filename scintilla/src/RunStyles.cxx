@@ -92,6 +92,11 @@ DISTANCE RunStyles<DISTANCE, STYLE>::Length() const noexcept {
 	return starts->Length();
 }
 
+template <typename DISTANCE, typename STYLE>
+size_t RunStyles<DISTANCE, STYLE>::MemoryUsage() const noexcept {
+	return starts->MemoryUsage() + styles->MemoryUsage();
+}
+
 template <typename DISTANCE, typename STYLE>
 STYLE RunStyles<DISTANCE, STYLE>::ValueAt(DISTANCE position) const noexcept {
 	return styles->ValueAt(starts->PartitionFromPosition(position));
@@ -179,6 +184,95 @@ FillResult<DISTANCE> RunStyles<DISTANCE, STYLE>::FillRange(DISTANCE position, ST
 	}
 }
 
+// Fill sorted and non-overlapping (position, length) ranges by merging them with runs
+// over the span in one pass, then replacing the runs of the span.
+template <typename DISTANCE, typename STYLE>
+FillResult<DISTANCE> RunStyles<DISTANCE, STYLE>::FillRanges(const ptrdiff_t *ranges, size_t count, STYLE value) {
+	FillResult<DISTANCE> resultNoChange{ false, 0, 0 };
+	if (count == 0) {
+		return resultNoChange;
+	}
+	const DISTANCE first = static_cast<DISTANCE>(ranges[0]);
+	const DISTANCE last = static_cast<DISTANCE>(ranges[2*count - 2] + ranges[2*count - 1]);
+	resultNoChange.position = first;
+	if (first < 0 || last > Length()) {
+		return resultNoChange;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (ranges[2*i + 1] <= 0 || (i != 0 && ranges[2*i] < ranges[2*i - 2] + ranges[2*i - 1])) {
+			// not sorted or overlapped
+			bool changed = false;
+			for (size_t j = 0; j < count; j++) {
+				changed |= FillRange(static_cast<DISTANCE>(ranges[2*j]), value, static_cast<DISTANCE>(ranges[2*j + 1])).changed;
+			}
+			return { changed, first, last - first };
+		}
+	}
+
+	const DISTANCE runFirst = SplitRun(first);
+	const DISTANCE runLast = SplitRun(last);
+	std::vector<DISTANCE> positions;
+	std::vector<STYLE> values;
+	positions.reserve(2*count + 1);
+	values.reserve(2*count + 1);
+	const auto append = [&positions, &values](DISTANCE position, STYLE style) {
+		if (values.empty() || values.back() != style) {
+			positions.push_back(position);
+			values.push_back(style);
+		}
+	};
+
+	bool changed = false;
+	DISTANCE run = runFirst;
+	DISTANCE position = first;
+	for (size_t i = 0; i < count; i++) {
+		const DISTANCE start = static_cast<DISTANCE>(ranges[2*i]);
+		const DISTANCE end = start + static_cast<DISTANCE>(ranges[2*i + 1]);
+		// copy runs before the range
+		while (position < start) {
+			append(position, styles->ValueAt(run));
+			const DISTANCE runEnd = starts->PositionFromPartition(run + 1);
+			if (runEnd <= start) {
+				run++;
+				position = runEnd;
+			} else {
+				position = start;
+			}
+		}
+		append(start, value);
+		// skip runs covered by the range
+		while (run < runLast && starts->PositionFromPartition(run) < end) {
+			changed |= styles->ValueAt(run) != value;
+			if (starts->PositionFromPartition(run + 1) > end) {
+				break;
+			}
+			run++;
+		}
+		position = end;
+	}
+
+	DISTANCE runEnd = runLast;
+	if (changed) {
+		const DISTANCE runsOld = runLast - runFirst;
+		for (DISTANCE i = 0; i < runsOld; i++) {
+			starts->RemovePartition(runFirst);
+		}
+		styles->DeleteRange(runFirst, runsOld);
+		const DISTANCE runsNew = static_cast<DISTANCE>(positions.size());
+		starts->InsertPartitions(runFirst, positions.data(), positions.size());
+		styles->InsertFromArray(runFirst, values.data(), 0, runsNew);
+		runEnd = runFirst + runsNew;
+	}
+	// remove runs added by splitting at span ends
+	RemoveRunIfEmpty(runEnd);
+	RemoveRunIfSameAsPrevious(runEnd);
+	RemoveRunIfSameAsPrevious(runFirst);
+	if (!changed) {
+		return resultNoChange;
+	}
+	return { true, first, last - first };
+}
+
 template <typename DISTANCE, typename STYLE>
 void RunStyles<DISTANCE, STYLE>::SetValueAt(DISTANCE position, STYLE value) {
 	FillRange(position, value, 1);
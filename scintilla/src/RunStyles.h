@@ -39,12 +39,14 @@ public:
 	void operator=(RunStyles &&) = delete;
 	~RunStyles();
 	DISTANCE Length() const noexcept;
+	size_t MemoryUsage() const noexcept;
 	STYLE ValueAt(DISTANCE position) const noexcept;
 	DISTANCE FindNextChange(DISTANCE position, DISTANCE end) const noexcept;
 	DISTANCE StartRun(DISTANCE position) const noexcept;
 	DISTANCE EndRun(DISTANCE position) const noexcept;
 	// Returns changed=true if some values may have changed
 	FillResult<DISTANCE> FillRange(DISTANCE position, STYLE value, DISTANCE fillLength);
+	FillResult<DISTANCE> FillRanges(const ptrdiff_t *ranges, size_t count, STYLE value);
 	void SetValueAt(DISTANCE position, STYLE value);
 	void InsertSpace(DISTANCE position, DISTANCE insertLength);
 	void DeleteAll();
@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <cstdint>
 #include <cassert>
 #include <cstring>
 #include <cmath>
@@ -20,6 +21,10 @@
 #include <optional>
 #include <algorithm>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -87,6 +92,7 @@ ScintillaBase::ScintillaBase() noexcept {
 ScintillaBase::~ScintillaBase() = default;
 
 void ScintillaBase::Finalise() noexcept {
+	CancelBackgroundStyling();
 	Editor::Finalise();
 #if SCI_EnablePopupMenu
 	popup.Destroy();
@@ -592,11 +598,33 @@ void ScintillaBase::RightButtonDownWithModifiers(Point pt, unsigned int curTime,
 namespace Scintilla::Internal {
 
 class LexState : public LexInterface {
+	// configuration replayed on a new lexer instance for background styling
+	int language = SCLEX_CONTAINER;
+	bool cloneable = false;
+	int generation;
+	std::map<std::string, std::string> properties;
+	std::map<int, std::pair<bool, std::string>> wordLists;
+	void Changed(bool cloneable_) noexcept;
 public:
 	explicit LexState(Document *pdoc_) noexcept;
 	void SetInstance(ILexer5 *instance_);
 	// LexInterface deleted the standard operators and defined the virtual destructor so don't need to here.
 	void SetLexer(int language); //! removed in Scintilla 5
+	void Colourise(Sci::Position start, Sci::Position end) override;
+	void Lex(Sci::Position start, Sci::Position end) override;
+	void FoldTo(Sci::Position end) override;
+	ILexer5 *CloneInstance() const;
+	bool HasSeparateFolder() const noexcept;
+	bool CanLexInParallel() const noexcept;
+	bool HasStaticState() const noexcept;
+	bool FoldOnDemand() const noexcept override;
+	// lines after pos were styled without being folded
+	void SkipFolding(Sci::Position pos) noexcept {
+		foldedEnd = std::min(foldedEnd, pos);
+	}
+	int Generation() const noexcept {
+		return generation;
+	}
 
 	const char *DescribeWordListSets() const noexcept;
 	void SetWordList(int n, bool toLower, const char *wl);
@@ -630,11 +658,60 @@ public:
 
 }
 
-LexState::LexState(Document *pdoc_) noexcept : LexInterface(pdoc_) {
+namespace {
+
+// Some lexers and folders keep state in static variables, so lexing (and folding) with them
+// on the UI thread and on the background styling threads is serialized. Other lexers run on
+// separate instances without locking.
+std::mutex lexerMutex;
+std::mutex folderMutex;
+
+// The UI thread never waits for a background styling thread: while the lexer is busy there,
+// previous styles are kept and styling is retried on next paint or when styles are published.
+class StaticStateLock {
+	std::unique_lock<std::mutex> lexerLock;
+	std::unique_lock<std::mutex> folderLock;
+	bool busy = false;
+public:
+	StaticStateLock(bool staticState, bool folder) {
+		if (staticState) {
+			lexerLock = std::unique_lock<std::mutex>(lexerMutex, std::try_to_lock);
+			if (folder && lexerLock.owns_lock()) {
+				folderLock = std::unique_lock<std::mutex>(folderMutex, std::try_to_lock);
+			}
+			busy = !lexerLock.owns_lock() || (folder && !folderLock.owns_lock());
+		}
+	}
+	bool Busy() const noexcept {
+		return busy;
+	}
+};
+
+// For a huge document whose lexer has a separate folder, lines are only folded when displayed
+// or navigated, instead of computing fold levels for whole document with styles.
+constexpr Sci::Position foldOnDemandLength = 64*1024*1024;
+
+// Generations are unique across documents, so results from a background styling
+// job made for another document or lexer configuration are never published.
+int lastLexerGeneration = 0;
+
+}
+
+LexState::LexState(Document *pdoc_) noexcept : LexInterface(pdoc_), generation(++lastLexerGeneration) {
+}
+
+void LexState::Changed(bool cloneable_) noexcept {
+	cloneable = cloneable_;
+	generation = ++lastLexerGeneration;
 }
 
 void LexState::SetInstance(ILexer5 *instance_) {
 	instance.reset(instance_);
+	// no way to create another instance for a lexer provided by the application
+	language = SCLEX_CONTAINER;
+	properties.clear();
+	wordLists.clear();
+	Changed(false);
 	pdoc->LexerChanged(GetIdentifier() != SCLEX_NULL);
 }
 
@@ -653,9 +730,72 @@ void LexState::SetLexer(int language) { //! removed in Scintilla 5
 		instance_ = lex->Create();
 	}
 	instance.reset(instance_);
+	this->language = language;
+	properties.clear();
+	wordLists.clear();
+	Changed(instance_ != nullptr);
 	pdoc->LexerChanged(language != SCLEX_NULL);
 }
 
+void LexState::Colourise(Sci::Position start, Sci::Position end) {
+	if (!performingStyle) {
+		const StaticStateLock guard(HasStaticState(), true);
+		if (!guard.Busy()) {
+			LexInterface::Colourise(start, end);
+		}
+	}
+}
+
+void LexState::Lex(Sci::Position start, Sci::Position end) {
+	if (!performingStyle) {
+		const StaticStateLock guard(HasStaticState(), false);
+		if (!guard.Busy()) {
+			LexInterface::Lex(start, end);
+		}
+	}
+}
+
+void LexState::FoldTo(Sci::Position end) {
+	if (!performingStyle && foldedEnd < end) {
+		const StaticStateLock guard(HasStaticState(), true);
+		if (!guard.Busy()) {
+			LexInterface::FoldTo(end);
+		}
+	}
+}
+
+bool LexState::FoldOnDemand() const noexcept {
+	// evicted styles are not kept for folding
+	return HasSeparateFolder() && pdoc->Length() >= foldOnDemandLength && pdoc->GetStyleWindow() == 0;
+}
+
+ILexer5 *LexState::CloneInstance() const {
+	if (!instance || !cloneable) {
+		return nullptr;
+	}
+	ILexer5 *clone = LexerModule::Find(language)->Create();
+	for (const auto &[key, value] : properties) {
+		clone->PropertySet(key.c_str(), value.c_str());
+	}
+	for (const auto &[n, wordList] : wordLists) {
+		clone->WordListSet(n, wordList.first, wordList.second.c_str());
+	}
+	return clone;
+}
+
+bool LexState::HasSeparateFolder() const noexcept {
+	return cloneable && LexerModule::Find(language)->HasFolder();
+}
+
+bool LexState::CanLexInParallel() const noexcept {
+	return cloneable && LexerModule::Find(language)->CanLexInParallel();
+}
+
+bool LexState::HasStaticState() const noexcept {
+	// lexer provided by the application never runs on background styling threads
+	return cloneable && LexerModule::Find(language)->HasStaticState();
+}
+
 const char *LexState::DescribeWordListSets() const noexcept {
 	if (instance) {
 		return instance->DescribeWordListSets();
@@ -667,6 +807,8 @@ const char *LexState::DescribeWordListSets() const noexcept {
 void LexState::SetWordList(int n, bool toLower, const char *wl) {
 	if (instance) {
 		const Sci_Position firstModification = instance->WordListSet(n, toLower, wl);
+		wordLists[n] = std::make_pair(toLower, std::string(wl ? wl : ""));
+		Changed(cloneable);
 		if (firstModification >= 0) {
 			pdoc->ModifiedAt(firstModification);
 		}
@@ -689,6 +831,7 @@ const char *LexState::GetName() const noexcept {
 
 void *LexState::PrivateCall(int operation, void *pointer) {
 	if (instance) {
+		Changed(false);
 		return instance->PrivateCall(operation, pointer);
 	} else {
 		return nullptr;
@@ -722,6 +865,8 @@ const char *LexState::DescribeProperty(const char *name) const {
 void LexState::PropSet(const char *key, const char *val) {
 	if (instance) {
 		const Sci_Position firstModification = instance->PropertySet(key, val);
+		properties[key] = val ? val : "";
+		Changed(cloneable);
 		if (firstModification >= 0) {
 			pdoc->ModifiedAt(firstModification);
 		}
@@ -768,6 +913,7 @@ LineEndType LexState::LineEndTypesSupported() const noexcept {
 
 int LexState::AllocateSubStyles(int styleBase, int numberStyles) {
 	if (instance) {
+		Changed(false);
 		return instance->AllocateSubStyles(styleBase, numberStyles);
 	}
 	return -1;
@@ -804,12 +950,14 @@ int LexState::PrimaryStyleFromStyle(int style) const noexcept {
 void LexState::FreeSubStyles() noexcept {
 	if (instance) {
 		instance->FreeSubStyles();
+		Changed(false);
 	}
 }
 
 void LexState::SetIdentifiers(int style, const char *identifiers) {
 	if (instance) {
 		instance->SetIdentifiers(style, identifiers);
+		Changed(false);
 		pdoc->ModifiedAt(0);
 	}
 }
@@ -876,6 +1024,635 @@ void ScintillaBase::NotifyLexerChanged(Document *, void *) {
 	vs.EnsureStyle(0xff);
 }
 
+namespace Scintilla::Internal {
+
+/**
+ * Background styling job: lexes a snapshot of the document on a worker thread
+ * with its own lexer instance. Finished chunks are published on the UI thread
+ * until a modification or a lexer change makes the snapshot stale.
+ * A separate folder runs on another thread one chunk behind the lexer, as
+ * folders may look ahead into the next chunk.
+ * Lexers that can lex in parallel instead have chunks lexed speculatively on
+ * worker threads, each as a separate document starting in default state. The
+ * chunks are then joined in order by relexing lines from chunk start until two
+ * lines agree with the speculative result.
+ * It watches the snapshot to find lines whose state or fold level were changed.
+ * When folding on demand, the job only lexes and fold levels are not published.
+ */
+class BackgroundStyler : public DocWatcher {
+public:
+	// lex in line aligned chunks of about this size, so results are published
+	// progressively and a cancelled job stops soon.
+	static constexpr Sci::Position ChunkSize = 256*1024;
+	// a smaller remainder is styled on idle as usual.
+	static constexpr Sci::Position MinimumLength = 4*1024*1024;
+	// milliseconds to wait after last modification before taking a new snapshot.
+	static constexpr int RestartDelay = 500;
+	static constexpr int PollInterval = 50;
+	static constexpr unsigned MaxWorkerCount = 8;
+	// chunks per worker lexed speculatively ahead of joined chunks.
+	static constexpr size_t SpeculationDepth = 4;
+
+	struct LineChanges {
+		Sci::Line lineStart = 0;
+		std::vector<int> lineStates;
+		std::vector<int> levels;
+		void Publish(Document *pdoc, Sci::Line lineLimit, bool folding) const;
+	};
+
+	struct Chunk {
+		Sci::Position start = 0;
+		Sci::Position end = 0;
+		std::vector<unsigned char> styles;
+		LineChanges lexed;
+		LineChanges folded;
+		// result of parallel lexing, guarded by stageMutex until speculated
+		bool speculated = false;
+		std::vector<unsigned char> speculativeStyles;
+		LineChanges speculative;
+	};
+
+	const int generation;
+	const Sci::Position start;
+	const bool separateFolder;
+	const bool folding;
+	// lexer or folder keeps static state, so lexerMutex and folderMutex are taken
+	const bool staticState;
+	// following two are only accessed on UI thread
+	Sci::Position modifiedAt = PTRDIFF_MAX;
+	size_t applied = 0;
+	std::atomic<bool> cancelled = false;
+	std::atomic<bool> done = false;
+	std::atomic<size_t> published = 0;
+	std::unique_ptr<Chunk[]> chunks;
+
+	BackgroundStyler(Document *pdoc, LexerInstance lexer_, int generation_, Sci::Position start_, bool separateFolder_, bool folding_, bool staticState_, std::vector<LexerInstance> workerLexers_);
+	static void Run(std::shared_ptr<BackgroundStyler> job) noexcept;
+
+	void NotifyModifyAttempt(Document *, void *) noexcept override {}
+	void NotifySavePoint(Document *, void *, bool) noexcept override {}
+	void NotifyModified(Document *, DocModification mh, void *) override {
+		if (changedLines && FlagSet(mh.modificationType, ModificationFlags::ChangeFold | ModificationFlags::ChangeLineState)) {
+			changedLines->start = std::min(changedLines->start, mh.line);
+			changedLines->end = std::max(changedLines->end, mh.line + 1);
+		}
+	}
+	void NotifyDeleted(Document *, void *) noexcept override {}
+	void NotifyStyleNeeded(Document *, void *, Sci::Position) override {}
+	void NotifyLexerChanged(Document *, void *) override {}
+	void NotifyErrorOccurred(Document *, void *, Status) noexcept override {}
+	void NotifyStylingDegraded(Document *, void *, Sci::Position) override {}
+
+private:
+	// snapshot, released once loaded into the worker's document
+	std::unique_ptr<Document> doc;
+	LexerInstance lexer;
+	// one lexer and chunk document per worker thread, text is kept for workers
+	std::vector<LexerInstance> workerLexers;
+	std::vector<std::unique_ptr<Document>> chunkDocs;
+	std::string text;
+	std::vector<unsigned char> styles;
+	std::vector<int> lineStates;
+	std::vector<int> levels;
+	// lines changed by the lexer or the folder running on current thread
+	struct ChangedLines {
+		Sci::Line start;
+		Sci::Line end;
+	};
+	static thread_local ChangedLines *changedLines;
+	// chunks lexed, guarded by stageMutex
+	size_t lexed = 0;
+	bool lexingDone = false;
+	std::mutex stageMutex;
+	std::condition_variable stageChanged;
+	// chunks split up front for parallel lexing, next one is guarded by stageMutex
+	size_t chunkCount = 0;
+	size_t nextChunk = 0;
+
+	void Load();
+	void LexChunks() noexcept;
+	void FoldChunks() noexcept;
+	void LexParallel() noexcept;
+	void SpeculateChunks(size_t worker) noexcept;
+	void JoinChunks();
+	bool SpeculationAgrees(const Chunk &chunk, Sci::Line line) const;
+	ChangedLines ChunkLines(Sci::Position pos, Sci::Position end) const noexcept;
+	void Record(LineChanges &changes, const ChangedLines &lines) const;
+};
+
+thread_local BackgroundStyler::ChangedLines *BackgroundStyler::changedLines = nullptr;
+
+}
+
+BackgroundStyler::BackgroundStyler(Document *pdoc, LexerInstance lexer_, int generation_, Sci::Position start_, bool separateFolder_, bool folding_, bool staticState_, std::vector<LexerInstance> workerLexers_) :
+	generation{generation_}, start{start_}, separateFolder{separateFolder_}, folding{folding_}, staticState{staticState_}, lexer{std::move(lexer_)}, workerLexers{std::move(workerLexers_)} {
+	// created here as code page setup is not thread safe
+	doc = std::make_unique<Document>(pdoc->WorkerOptions());
+	doc->SetUndoCollection(false);
+	doc->SetDBCSCodePage(pdoc->dbcsCodePage);
+	for (size_t worker = 0; worker < workerLexers.size(); worker++) {
+		std::unique_ptr<Document> &chunkDoc = chunkDocs.emplace_back(std::make_unique<Document>(pdoc->WorkerOptions()));
+		chunkDoc->SetUndoCollection(false);
+		chunkDoc->SetDBCSCodePage(pdoc->dbcsCodePage);
+	}
+	const Sci::Position length = pdoc->Length();
+	// copied chunk by chunk, so packed text is neither unpacked nor consolidated
+	text.resize(length);
+	pdoc->GetCharRange(text.data(), 0, length);
+	// lexers may look back at styles, line states and fold levels before start
+	styles.resize(start);
+	pdoc->GetStyleRange(styles.data(), 0, start);
+	const Sci::Line lineStart = pdoc->SciLineFromPosition(start);
+	lineStates.resize(lineStart + 1);
+	levels.resize(lineStart + 1);
+	for (Sci::Line line = 0; line <= lineStart; line++) {
+		lineStates[line] = pdoc->GetLineState(line);
+		levels[line] = pdoc->GetLevel(line);
+	}
+	// every chunk except the last one is at least ChunkSize long
+	chunks = std::make_unique<Chunk[]>((length - start) / ChunkSize + 2);
+}
+
+void BackgroundStyler::Run(std::shared_ptr<BackgroundStyler> job) noexcept {
+	try {
+		job->Load();
+		if (!job->workerLexers.empty()) {
+			job->LexParallel();
+		} else {
+			std::thread folder;
+			if (job->separateFolder && job->folding) {
+				folder = std::thread(&BackgroundStyler::FoldChunks, job.get());
+			}
+			job->LexChunks();
+			if (folder.joinable()) {
+				folder.join();
+			}
+		}
+		job->doc.reset();
+		job->lexer.reset();
+		job->workerLexers.clear();
+		job->chunkDocs.clear();
+	} catch (...) {
+		// publish what has been finished
+	}
+	job->done.store(true, std::memory_order_release);
+}
+
+void BackgroundStyler::Load() {
+	Document &doc = *this->doc;
+	doc.InsertString(0, text.data(), text.length());
+	if (workerLexers.empty()) {
+		std::string().swap(text);
+	}
+
+	doc.StartStyling(0);
+	doc.SetStyles(start, styles.data());
+	std::vector<unsigned char>().swap(styles);
+	const Sci::Line lineStart = static_cast<Sci::Line>(lineStates.size());
+	for (Sci::Line line = 0; line < lineStart; line++) {
+		if (lineStates[line] != 0) {
+			doc.SetLineState(line, lineStates[line]);
+		}
+		if (levels[line] != static_cast<int>(FoldLevel::Base)) {
+			doc.SetLevel(line, levels[line]);
+		}
+	}
+	std::vector<int>().swap(lineStates);
+	std::vector<int>().swap(levels);
+	// allocate all lines up front, so lexer and folder threads never resize them
+	const Sci::Line lines = doc.LinesTotal();
+	doc.SetLineState(lines, doc.GetLineState(lines));
+	doc.SetLevel(0, doc.GetLevel(0));
+	doc.AddWatcher(this, nullptr);
+}
+
+BackgroundStyler::ChangedLines BackgroundStyler::ChunkLines(Sci::Position pos, Sci::Position end) const noexcept {
+	const Sci::Line lineEnd = (end == doc->Length()) ? doc->LinesTotal() : doc->SciLineFromPosition(end);
+	return { doc->SciLineFromPosition(pos), lineEnd };
+}
+
+void BackgroundStyler::Record(LineChanges &changes, const ChangedLines &lines) const {
+	// lexer and folder may also update lines before or after the chunk
+	changes.lineStart = lines.start;
+	changes.lineStates.reserve(lines.end - lines.start);
+	changes.levels.reserve(lines.end - lines.start);
+	for (Sci::Line line = lines.start; line < lines.end; line++) {
+		changes.lineStates.push_back(doc->GetLineState(line));
+		changes.levels.push_back(doc->GetLevel(line));
+	}
+}
+
+void BackgroundStyler::LexChunks() noexcept {
+	try {
+		Document &doc = *this->doc;
+		const Sci::Position length = doc.Length();
+		Sci::Position pos = start;
+		size_t count = 0;
+		while (pos < length && !cancelled.load(std::memory_order_relaxed)) {
+			Sci::Position end = std::min(pos + ChunkSize, length);
+			if (end < length) {
+				end = doc.LineStart(doc.SciLineFromPosition(end) + 1);
+			}
+			const int initStyle = (pos > 0) ? doc.StyleAt(pos - 1) : 0;
+			ChangedLines lines = ChunkLines(pos, end);
+			changedLines = &lines;
+			{
+				std::unique_lock<std::mutex> guard(lexerMutex, std::defer_lock);
+				if (staticState) {
+					guard.lock();
+				}
+				lexer->Lex(pos, end - pos, initStyle, &doc);
+				if (!separateFolder && folding) {
+					lexer->Fold(pos, end - pos, initStyle, &doc);
+				}
+			}
+			changedLines = nullptr;
+
+			Chunk &chunk = chunks[count];
+			chunk.start = pos;
+			chunk.end = end;
+			chunk.styles.resize(end - pos);
+			doc.GetStyleRange(chunk.styles.data(), pos, end - pos);
+			Record(chunk.lexed, lines);
+
+			++count;
+			if (separateFolder && folding) {
+				const std::lock_guard<std::mutex> guard(stageMutex);
+				lexed = count;
+			} else {
+				published.store(count, std::memory_order_release);
+			}
+			stageChanged.notify_one();
+			pos = end;
+		}
+	} catch (...) {
+		// fold and publish what has been lexed
+		changedLines = nullptr;
+	}
+	{
+		const std::lock_guard<std::mutex> guard(stageMutex);
+		lexingDone = true;
+	}
+	stageChanged.notify_one();
+}
+
+void BackgroundStyler::FoldChunks() noexcept {
+	try {
+		Document &doc = *this->doc;
+		size_t count = 0;
+		while (!cancelled.load(std::memory_order_relaxed)) {
+			{
+				std::unique_lock<std::mutex> lock(stageMutex);
+				stageChanged.wait(lock, [this, count] { return lexingDone || lexed > count + 1; });
+				if (count == lexed) {
+					break;
+				}
+			}
+
+			Chunk &chunk = chunks[count];
+			const Sci::Position pos = chunk.start;
+			const Sci::Position end = chunk.end;
+			const int initStyle = (pos > 0) ? doc.StyleAt(pos - 1) : 0;
+			ChangedLines lines = ChunkLines(pos, end);
+			changedLines = &lines;
+			{
+				std::unique_lock<std::mutex> guard(folderMutex, std::defer_lock);
+				if (staticState) {
+					guard.lock();
+				}
+				lexer->Fold(pos, end - pos, initStyle, &doc);
+			}
+			changedLines = nullptr;
+			Record(chunk.folded, lines);
+
+			++count;
+			published.store(count, std::memory_order_release);
+		}
+	} catch (...) {
+		// publish what has been folded
+		changedLines = nullptr;
+	}
+}
+
+void BackgroundStyler::LexParallel() noexcept {
+	std::vector<std::thread> workers;
+	try {
+		// split all chunks up front, so workers can take them in any order
+		const Document &doc = *this->doc;
+		const Sci::Position length = doc.Length();
+		Sci::Position pos = start;
+		while (pos < length) {
+			Sci::Position end = std::min(pos + ChunkSize, length);
+			if (end < length) {
+				end = doc.LineStart(doc.SciLineFromPosition(end) + 1);
+			}
+			Chunk &chunk = chunks[chunkCount];
+			chunk.start = pos;
+			chunk.end = end;
+			chunk.speculative.lineStart = doc.SciLineFromPosition(pos);
+			++chunkCount;
+			pos = end;
+		}
+		for (size_t worker = 0; worker < workerLexers.size(); worker++) {
+			workers.emplace_back(&BackgroundStyler::SpeculateChunks, this, worker);
+		}
+		JoinChunks();
+	} catch (...) {
+		// publish what has been joined
+		changedLines = nullptr;
+	}
+	{
+		const std::lock_guard<std::mutex> guard(stageMutex);
+		lexingDone = true;
+	}
+	stageChanged.notify_all();
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+	std::string().swap(text);
+}
+
+void BackgroundStyler::SpeculateChunks(size_t worker) noexcept {
+	ILexer5 *workerLexer = workerLexers[worker].get();
+	Document &chunkDoc = *chunkDocs[worker];
+	const size_t depth = SpeculationDepth*workerLexers.size();
+	while (true) {
+		size_t index;
+		{
+			std::unique_lock<std::mutex> lock(stageMutex);
+			stageChanged.wait(lock, [this, depth] {
+				return lexingDone || nextChunk == chunkCount || nextChunk < lexed + depth;
+			});
+			if (lexingDone || nextChunk == chunkCount) {
+				break;
+			}
+			index = nextChunk++;
+		}
+
+		Chunk &chunk = chunks[index];
+		try {
+			// lexer module declared it keeps no static state, so no lexerMutex
+			const Sci::Position length = chunk.end - chunk.start;
+			// deleting whole text also resets line states and fold levels
+			chunkDoc.DeleteChars(0, chunkDoc.Length());
+			chunkDoc.InsertString(0, text.data() + chunk.start, length);
+			workerLexer->Lex(0, length, 0, &chunkDoc);
+			if (folding) {
+				workerLexer->Fold(0, length, 0, &chunkDoc);
+			}
+
+			chunk.speculativeStyles.resize(length);
+			chunkDoc.GetStyleRange(chunk.speculativeStyles.data(), 0, length);
+			// same lines as ChunkLines()
+			const Sci::Line lines = (chunk.end == static_cast<Sci::Position>(text.length())) ? chunkDoc.LinesTotal() : chunkDoc.SciLineFromPosition(length);
+			LineChanges &changes = chunk.speculative;
+			changes.lineStates.reserve(lines);
+			changes.levels.reserve(lines);
+			for (Sci::Line line = 0; line < lines; line++) {
+				changes.lineStates.push_back(chunkDoc.GetLineState(line));
+				changes.levels.push_back(chunkDoc.GetLevel(line));
+			}
+		} catch (...) {
+			// whole chunk is lexed when joined
+			chunk.speculativeStyles.clear();
+		}
+		{
+			const std::lock_guard<std::mutex> guard(stageMutex);
+			chunk.speculated = true;
+		}
+		stageChanged.notify_all();
+	}
+}
+
+void BackgroundStyler::JoinChunks() {
+	Document &doc = *this->doc;
+	for (size_t index = 0; index < chunkCount && !cancelled.load(std::memory_order_relaxed); index++) {
+		Chunk &chunk = chunks[index];
+		{
+			std::unique_lock<std::mutex> lock(stageMutex);
+			stageChanged.wait(lock, [&chunk] { return chunk.speculated; });
+		}
+
+		const Sci::Position length = chunk.end - chunk.start;
+		const bool speculated = static_cast<Sci::Position>(chunk.speculativeStyles.size()) == length;
+		ChangedLines lines = ChunkLines(chunk.start, chunk.end);
+		changedLines = &lines;
+		// relex with actual state from chunk start, doubling lines each time,
+		// until last two lines agree with speculative result
+		Sci::Position pos = chunk.start;
+		Sci::Line line = lines.start;
+		Sci::Line step = 1;
+		while (pos < chunk.end) {
+			if (speculated && line >= lines.start + 2 && SpeculationAgrees(chunk, line)) {
+				doc.StartStyling(pos);
+				doc.SetStyles(chunk.end - pos, chunk.speculativeStyles.data() + (pos - chunk.start));
+				const LineChanges &speculative = chunk.speculative;
+				for (; line < lines.end; line++) {
+					const size_t offset = line - speculative.lineStart;
+					if (doc.GetLineState(line) != speculative.lineStates[offset]) {
+						doc.SetLineState(line, speculative.lineStates[offset]);
+					}
+					if (doc.GetLevel(line) != speculative.levels[offset]) {
+						doc.SetLevel(line, speculative.levels[offset]);
+					}
+				}
+				break;
+			}
+			const Sci::Line next = std::min(line + step, lines.end);
+			const Sci::Position end = (next == lines.end) ? chunk.end : doc.LineStart(next);
+			const int initStyle = (pos > 0) ? doc.StyleAt(pos - 1) : 0;
+			lexer->Lex(pos, end - pos, initStyle, &doc);
+			if (folding) {
+				lexer->Fold(pos, end - pos, initStyle, &doc);
+			}
+			pos = end;
+			line = next;
+			step *= 2;
+		}
+		changedLines = nullptr;
+
+		chunk.styles.resize(length);
+		doc.GetStyleRange(chunk.styles.data(), chunk.start, length);
+		Record(chunk.lexed, lines);
+		std::vector<unsigned char>().swap(chunk.speculativeStyles);
+		chunk.speculative = {};
+		{
+			const std::lock_guard<std::mutex> guard(stageMutex);
+			lexed = index + 1;
+		}
+		stageChanged.notify_all();
+		published.store(index + 1, std::memory_order_release);
+	}
+}
+
+bool BackgroundStyler::SpeculationAgrees(const Chunk &chunk, Sci::Line line) const {
+	// lexer and folder look back at most two lines
+	const Document &doc = *this->doc;
+	const LineChanges &speculative = chunk.speculative;
+	for (Sci::Line prev = line - 2; prev < line; prev++) {
+		const size_t offset = prev - speculative.lineStart;
+		if (doc.GetLineState(prev) != speculative.lineStates[offset] || doc.GetLevel(prev) != speculative.levels[offset]) {
+			return false;
+		}
+		const Sci::Position lineEnd = doc.LineStart(prev + 1);
+		for (Sci::Position pos = doc.LineStart(prev); pos < lineEnd; pos++) {
+			if (static_cast<unsigned char>(doc.StyleAt(pos)) != chunk.speculativeStyles[pos - chunk.start]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void BackgroundStyler::LineChanges::Publish(Document *pdoc, Sci::Line lineLimit, bool folding) const {
+	const Sci::Line lineEnd = std::min(lineStart + static_cast<Sci::Line>(levels.size()), lineLimit);
+	for (Sci::Line line = lineStart; line < lineEnd; line++) {
+		const size_t index = line - lineStart;
+		if (pdoc->GetLineState(line) != lineStates[index]) {
+			pdoc->SetLineState(line, lineStates[index]);
+		}
+		if (folding && pdoc->GetLevel(line) != levels[index]) {
+			pdoc->SetLevel(line, levels[index]);
+		}
+	}
+}
+
+void ScintillaBase::NotifyModified(Document *document, DocModification mh, void *userData) {
+	Editor::NotifyModified(document, mh, userData);
+	if (FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText)) {
+		if (backgroundStyler) {
+			// snapshot is stale after the modification
+			backgroundStyler->modifiedAt = std::min(backgroundStyler->modifiedAt, mh.position);
+			backgroundStyler->cancelled = true;
+		} else if (FineTickerRunning(TickReason::style)) {
+			// still editing, delay taking a new snapshot
+			FineTickerStart(TickReason::style, BackgroundStyler::RestartDelay, BackgroundStyler::RestartDelay/10);
+		}
+	}
+}
+
+void ScintillaBase::SetDocPointer(Document *document) {
+	CancelBackgroundStyling();
+	Editor::SetDocPointer(document);
+}
+
+void ScintillaBase::IdleStyle() {
+	if (idleStyling == IdleStyling::Background && StartBackgroundStyling()) {
+		// remainder is styled by the background job
+		needIdleStyling = false;
+		return;
+	}
+	Editor::IdleStyle();
+}
+
+void ScintillaBase::TickFor(TickReason reason) {
+	if (reason == TickReason::style) {
+		PublishBackgroundStyling();
+	} else {
+		Editor::TickFor(reason);
+	}
+}
+
+bool ScintillaBase::StartBackgroundStyling() {
+	if (FineTickerRunning(TickReason::style)) {
+		// job is running, or waiting for editing to pause
+		return true;
+	}
+
+	const Sci::Position lengthDoc = pdoc->Length();
+	const Sci::Position start = pdoc->LineStart(pdoc->SciLineFromPosition(pdoc->GetEndStyled()));
+	// snapshot of whole document defeats the purpose of style window
+	if (lengthDoc - start < BackgroundStyler::MinimumLength || pdoc->GetLineEndTypesActive() != LineEndType::Default
+		|| pdoc->GetStyleWindow() != 0) {
+		return false;
+	}
+	LexState *lexState = DocumentLexState();
+	LexerInstance lexer(lexState->CloneInstance());
+	if (!lexer) {
+		return false;
+	}
+
+	try {
+		std::vector<LexerInstance> workerLexers;
+		if (lexState->CanLexInParallel() && !IsDBCSCodePage(pdoc->dbcsCodePage)) {
+			// joining thread also lexes
+			const unsigned threads = std::min(std::thread::hardware_concurrency(), BackgroundStyler::MaxWorkerCount + 1);
+			for (unsigned i = 1; i < threads; i++) {
+				workerLexers.emplace_back(lexState->CloneInstance());
+			}
+		}
+		backgroundStyler = std::make_shared<BackgroundStyler>(pdoc, std::move(lexer), lexState->Generation(), start, lexState->HasSeparateFolder(), !lexState->FoldOnDemand(), lexState->HasStaticState(), std::move(workerLexers));
+		std::thread(BackgroundStyler::Run, backgroundStyler).detach();
+	} catch (...) {
+		backgroundStyler.reset();
+		return false;
+	}
+	FineTickerStart(TickReason::style, BackgroundStyler::PollInterval, BackgroundStyler::PollInterval/10);
+	return true;
+}
+
+void ScintillaBase::PublishBackgroundStyling() {
+	if (!backgroundStyler) {
+		// editing paused, style remainder again
+		FineTickerCancel(TickReason::style);
+		StartIdleStyling(false);
+		return;
+	}
+
+	BackgroundStyler &job = *backgroundStyler;
+	bool valid = job.generation == DocumentLexState()->Generation();
+	// text before the line of first modification is unchanged
+	Sci::Position limit = pdoc->Length();
+	Sci::Line lineLimit = pdoc->LinesTotal();
+	if (job.modifiedAt != PTRDIFF_MAX) {
+		lineLimit = pdoc->SciLineFromPosition(std::min(job.modifiedAt, limit));
+		limit = pdoc->LineStart(lineLimit);
+	}
+
+	const size_t published = job.published.load(std::memory_order_acquire);
+	while (valid && job.applied < published) {
+		BackgroundStyler::Chunk &chunk = job.chunks[job.applied];
+		++job.applied;
+		// text may have been styled on UI thread since the snapshot was taken
+		const Sci::Position from = pdoc->LineStart(pdoc->SciLineFromPosition(pdoc->GetEndStyled()));
+		const Sci::Position end = std::min(chunk.end, limit);
+		if (from < chunk.start) {
+			valid = false;
+		} else if (from < end) {
+			pdoc->StartStyling(from);
+			pdoc->SetStyles(end - from, chunk.styles.data() + (from - chunk.start));
+			chunk.lexed.Publish(pdoc, lineLimit, job.folding);
+			chunk.folded.Publish(pdoc, lineLimit, job.folding);
+			if (!job.folding) {
+				// published lines are folded on demand
+				DocumentLexState()->SkipFolding(pdoc->LineStart(chunk.lexed.lineStart));
+			}
+		}
+		if (end < chunk.end) {
+			valid = false;
+		}
+		chunk = {};
+	}
+
+	if (!valid || (job.done.load(std::memory_order_acquire) && job.applied == job.published.load(std::memory_order_relaxed))) {
+		const bool modified = job.modifiedAt != PTRDIFF_MAX;
+		CancelBackgroundStyling();
+		if (modified) {
+			FineTickerStart(TickReason::style, BackgroundStyler::RestartDelay, BackgroundStyler::RestartDelay/10);
+		} else {
+			StartIdleStyling(false);
+		}
+	}
+}
+
+void ScintillaBase::CancelBackgroundStyling() noexcept {
+	if (backgroundStyler) {
+		backgroundStyler->cancelled = true;
+		backgroundStyler.reset();
+	}
+	FineTickerCancel(TickReason::style);
+}
+
 sptr_t ScintillaBase::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	switch (iMessage) {
 	case Message::AutoCShow:
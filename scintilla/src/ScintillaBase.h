@@ -11,6 +11,7 @@ namespace Scintilla::Internal {
 #define SCI_EnablePopupMenu	0
 
 class LexState;
+class BackgroundStyler;
 
 /**
  */
@@ -50,6 +51,8 @@ protected:
 	int maxListWidth;		/// Maximum width of list, in average character widths
 	Scintilla::MultiAutoComplete multiAutoCMode; /// Mode for autocompleting when multiple selections are present
 
+	std::shared_ptr<BackgroundStyler> backgroundStyler;
+
 	LexState *DocumentLexState();
 
 	ScintillaBase() noexcept;
@@ -92,6 +95,14 @@ protected:
 
 	void NotifyStyleToNeeded(Sci::Position endStyleNeeded) override;
 	void NotifyLexerChanged(Document *doc, void *userData) override;
+	void NotifyModified(Document *document, DocModification mh, void *userData) override;
+	void SetDocPointer(Document *document) override;
+
+	void IdleStyle() override;
+	void TickFor(TickReason reason) override;
+	bool StartBackgroundStyling();
+	void PublishBackgroundStyling();
+	void CancelBackgroundStyling() noexcept;
 
 public:
 	~ScintillaBase() override;
@@ -190,7 +190,14 @@ void SelectionRange::MinimizeVirtualSpace() noexcept {
 	}
 }
 
-Selection::Selection() noexcept : mainRange(0), moveExtends(false), tentativeMain(false), selType(SelTypes::stream) {
+namespace {
+
+// below this count, scanning all ranges is faster than maintaining the index
+constexpr size_t minIndexedRanges = 32;
+
+}
+
+Selection::Selection() noexcept : mainRange(0), moveExtends(false), tentativeMain(false), indexValid(false), selType(SelTypes::stream) {
 	AddSelection(SelectionRange(SelectionPosition(0)));
 }
 
@@ -247,6 +254,7 @@ void Selection::SetMain(size_t r) noexcept {
 }
 
 SelectionRange &Selection::Range(size_t r) noexcept {
+	InvalidateIndex();
 	return ranges[r];
 }
 
@@ -255,6 +263,7 @@ const SelectionRange &Selection::Range(size_t r) const noexcept {
 }
 
 SelectionRange &Selection::RangeMain() noexcept {
+	InvalidateIndex();
 	return ranges[mainRange];
 }
 
@@ -309,12 +318,67 @@ void Selection::MovePositions(bool insertion, Sci::Position startChange, Sci::Po
 	for (auto &range : ranges) {
 		range.MoveForInsertDelete(insertion, startChange, length);
 	}
+	InvalidateIndex();
 	if (selType == SelTypes::rectangle) {
 		rangeRectangular.MoveForInsertDelete(insertion, startChange, length);
 	}
 }
 
 void Selection::TrimSelection(SelectionRange range) noexcept {
+	if (UseIndex(false)) {
+		// only ranges overlapping or touching range are changed, a range trimmed to empty
+		// no longer overlaps range, so it is recorded and removed here.
+		std::vector<size_t> emptied;
+		bool changed = false;
+		bool complete = false;
+		try {
+			const auto trim = [this, range, &changed, &emptied](size_t i) {
+				if (i != mainRange) {
+					SelectionRange trimmed = ranges[i];
+					if (trimmed.Trim(range)) {
+						emptied.push_back(i);
+					} else if (trimmed == ranges[i]) {
+						return;
+					}
+					ranges[i] = trimmed;
+					changed = true;
+				}
+			};
+			const Sci::Position start = range.Start().Position();
+			for (size_t k = SortedUpperBound(range.End().Position()); k > 0 && maxEnd[k - 1] >= start; k--) {
+				trim(sortedRanges[k - 1]);
+			}
+			for (const size_t i : pendingRanges) {
+				trim(i);
+			}
+			complete = true;
+		} catch (...) {
+			// trim remaining ranges below, trimming a non-empty range again by same range is harmless
+		}
+		if (changed) {
+			InvalidateIndex();
+		}
+		if (!emptied.empty()) {
+			std::sort(emptied.begin(), emptied.end());
+			size_t count = emptied.front();
+			size_t next = 0;
+			for (size_t i = count; i < ranges.size(); i++) {
+				if (next < emptied.size() && emptied[next] == i) {
+					next++;
+				} else {
+					if (i == mainRange) {
+						mainRange = count;
+					}
+					ranges[count++] = ranges[i];
+				}
+			}
+			ranges.resize(count);
+		}
+		if (complete) {
+			return;
+		}
+	}
+	InvalidateIndex();
 	for (size_t i = 0; i < ranges.size();) {
 		if ((i != mainRange) && (ranges[i].Trim(range))) {
 			// Trimmed to empty so remove
@@ -336,9 +400,11 @@ void Selection::TrimOtherSelections(size_t r, SelectionRange range) noexcept {
 			ranges[i].Trim(range);
 		}
 	}
+	InvalidateIndex();
 }
 
 void Selection::SetSelection(SelectionRange range) {
+	InvalidateIndex();
 	ranges.clear();
 	ranges.push_back(range);
 	mainRange = ranges.size() - 1;
@@ -348,11 +414,13 @@ void Selection::AddSelection(SelectionRange range) {
 	TrimSelection(range);
 	ranges.push_back(range);
 	mainRange = ranges.size() - 1;
+	AddToIndex(mainRange);
 }
 
 void Selection::AddSelectionWithoutTrim(SelectionRange range) {
 	ranges.push_back(range);
 	mainRange = ranges.size() - 1;
+	AddToIndex(mainRange);
 }
 
 void Selection::DropSelection(size_t r) noexcept {
@@ -367,6 +435,7 @@ void Selection::DropSelection(size_t r) noexcept {
 		}
 		ranges.erase(ranges.begin() + r);
 		mainRange = mainNew;
+		InvalidateIndex();
 	}
 }
 
@@ -379,6 +448,7 @@ void Selection::TentativeSelection(SelectionRange range) {
 		rangesSaved = ranges;
 	}
 	ranges = rangesSaved;
+	InvalidateIndex();
 	AddSelection(range);
 	TrimSelection(ranges[mainRange]);
 	tentativeMain = true;
@@ -394,6 +464,15 @@ InSelection Selection::RangeType(size_t r) const noexcept {
 }
 
 InSelection Selection::CharacterInSelection(Sci::Position posCharacter) const noexcept {
+	if (UseIndex(true)) {
+		size_t first = ranges.size();
+		for (size_t k = SortedUpperBound(posCharacter); k > 0 && maxEnd[k - 1] > posCharacter; k--) {
+			const size_t r = sortedRanges[k - 1];
+			if (r < first && ranges[r].ContainsCharacter(posCharacter))
+				first = r;
+		}
+		return (first < ranges.size()) ? RangeType(first) : InSelection::inNone;
+	}
 	for (size_t i = 0; i < ranges.size(); i++) {
 		if (ranges[i].ContainsCharacter(posCharacter))
 			return RangeType(i);
@@ -402,6 +481,15 @@ InSelection Selection::CharacterInSelection(Sci::Position posCharacter) const no
 }
 
 InSelection Selection::InSelectionForEOL(Sci::Position pos) const noexcept {
+	if (UseIndex(true)) {
+		size_t first = ranges.size();
+		for (size_t k = SortedUpperBound(pos - 1); k > 0 && maxEnd[k - 1] >= pos; k--) {
+			const size_t r = sortedRanges[k - 1];
+			if (r < first && !ranges[r].Empty() && (pos <= ranges[r].End().Position()))
+				first = r;
+		}
+		return (first < ranges.size()) ? RangeType(first) : InSelection::inNone;
+	}
 	for (size_t i = 0; i < ranges.size(); i++) {
 		if (!ranges[i].Empty() && (pos > ranges[i].Start().Position()) && (pos <= ranges[i].End().Position()))
 			return RangeType(i);
@@ -411,16 +499,44 @@ InSelection Selection::InSelectionForEOL(Sci::Position pos) const noexcept {
 
 Sci::Position Selection::VirtualSpaceFor(Sci::Position pos) const noexcept {
 	Sci::Position virtualSpace = 0;
-	for (const auto &range : ranges) {
+	const auto check = [pos, &virtualSpace](const SelectionRange &range) noexcept {
 		if ((range.caret.Position() == pos) && (virtualSpace < range.caret.VirtualSpace()))
 			virtualSpace = range.caret.VirtualSpace();
 		if ((range.anchor.Position() == pos) && (virtualSpace < range.anchor.VirtualSpace()))
 			virtualSpace = range.anchor.VirtualSpace();
+	};
+	if (UseIndex(true)) {
+		for (size_t k = SortedUpperBound(pos); k > 0 && maxEnd[k - 1] >= pos; k--) {
+			check(ranges[sortedRanges[k - 1]]);
+		}
+	} else {
+		for (const auto &range : ranges) {
+			check(range);
+		}
 	}
 	return virtualSpace;
 }
 
+std::vector<size_t> Selection::RangesTouching(Sci::Position start, Sci::Position end) const {
+	std::vector<size_t> result;
+	if (UseIndex(true)) {
+		for (size_t k = SortedUpperBound(end); k > 0 && maxEnd[k - 1] >= start; k--) {
+			const size_t r = sortedRanges[k - 1];
+			if (ranges[r].End().Position() >= start)
+				result.push_back(r);
+		}
+		std::sort(result.begin(), result.end());
+	} else {
+		for (size_t r = 0; r < ranges.size(); r++) {
+			if ((ranges[r].Start().Position() <= end) && (ranges[r].End().Position() >= start))
+				result.push_back(r);
+		}
+	}
+	return result;
+}
+
 void Selection::Clear() {
+	InvalidateIndex();
 	ranges.clear();
 	ranges.emplace_back();
 	mainRange = ranges.size() - 1;
@@ -438,6 +554,7 @@ void Selection::Reset() noexcept {
 }
 
 void Selection::RemoveDuplicates() noexcept {
+	InvalidateIndex();
 	for (size_t i = 0; i < ranges.size() - 1; i++) {
 		if (ranges[i].Empty()) {
 			size_t j = i + 1;
@@ -459,3 +576,130 @@ void Selection::RotateMain() noexcept {
 	mainRange = (mainRange + 1) % ranges.size();
 }
 
+bool Selection::UseIndex(bool merge) const noexcept {
+	if (ranges.size() < minIndexedRanges) {
+		return false;
+	}
+	try {
+		if (!indexValid) {
+			sortedRanges.clear();
+			pendingRanges.resize(ranges.size());
+			for (size_t r = 0; r < ranges.size(); r++) {
+				pendingRanges[r] = r;
+			}
+			MergePending();
+			indexValid = true;
+		} else if (merge && !pendingRanges.empty()) {
+			MergePending();
+		}
+	} catch (...) {
+		indexValid = false;
+		return false;
+	}
+	return true;
+}
+
+void Selection::MergePending() const {
+	const auto byStart = [this](size_t a, size_t b) noexcept {
+		return ranges[a].Start().Position() < ranges[b].Start().Position();
+	};
+	std::sort(pendingRanges.begin(), pendingRanges.end(), byStart);
+	const size_t middle = sortedRanges.size();
+	sortedRanges.insert(sortedRanges.end(), pendingRanges.begin(), pendingRanges.end());
+	std::inplace_merge(sortedRanges.begin(), sortedRanges.begin() + middle, sortedRanges.end(), byStart);
+	pendingRanges.clear();
+	maxEnd.resize(sortedRanges.size());
+	Sci::Position end = 0;
+	for (size_t k = 0; k < sortedRanges.size(); k++) {
+		end = std::max(end, ranges[sortedRanges[k]].End().Position());
+		maxEnd[k] = end;
+	}
+}
+
+size_t Selection::SortedUpperBound(Sci::Position pos) const noexcept {
+	const auto it = std::upper_bound(sortedRanges.begin(), sortedRanges.end(), pos,
+		[this](Sci::Position position, size_t r) noexcept { return position < ranges[r].Start().Position(); });
+	return it - sortedRanges.begin();
+}
+
+void Selection::AddToIndex(size_t r) noexcept {
+	if (indexValid) {
+		try {
+			pendingRanges.push_back(r);
+			// merge when scanning pending ranges on each trim costs more than merging
+			if (pendingRanges.size()*pendingRanges.size() > sortedRanges.size() + minIndexedRanges*minIndexedRanges) {
+				MergePending();
+			}
+		} catch (...) {
+			indexValid = false;
+		}
+	}
+}
+
+SelectionBatch::SelectionBatch(Selection &sel, SelectionBatch *&active_) :
+	lengthChange(0), current(sel.Count()), active(active_) {
+	for (size_t r = 0; r < sel.Count(); r++) {
+		ranges.push_back(&sel.Range(r));
+	}
+	// Order selections by position in document.
+	std::sort(ranges.begin(), ranges.end(),
+		[](const SelectionRange *a, const SelectionRange *b) noexcept { return *a < *b; });
+	lengthMoved.resize(ranges.size());
+	// moving is only deferred for ranges that do not overlap
+	bool disjoint = ranges.size() > 1;
+	for (size_t i = 1; disjoint && i < ranges.size(); i++) {
+		disjoint = ranges[i - 1]->End().Position() <= ranges[i]->Start().Position();
+	}
+	if (disjoint && active == nullptr) {
+		active = this;
+	}
+}
+
+SelectionBatch::~SelectionBatch() {
+	if (active == this) {
+		for (size_t index = current + 1; index < ranges.size(); index++) {
+			Settle(index);
+		}
+		active = nullptr;
+	}
+}
+
+void SelectionBatch::Settle(size_t index) noexcept {
+	const Sci::Position delta = lengthChange - lengthMoved[index];
+	if (delta != 0) {
+		ranges[index]->caret.Add(delta);
+		ranges[index]->anchor.Add(delta);
+		lengthMoved[index] = lengthChange;
+	}
+}
+
+SelectionRange &SelectionBatch::Edit(size_t index) noexcept {
+	if (current < ranges.size()) {
+		lengthMoved[current] = lengthChange;
+	}
+	current = index;
+	return *ranges[index];
+}
+
+void SelectionBatch::MovePositions(bool insertion, Sci::Position startChange, Sci::Position length) noexcept {
+	const Sci::Position endChange = insertion ? startChange : startChange + length;
+	const Sci::Position delta = insertion ? length : -length;
+	if (current < ranges.size()) {
+		ranges[current]->MoveForInsertDelete(insertion, startChange, length);
+	}
+	// ranges not yet edited are only affected when change reaches them
+	for (size_t index = current; index-- > 0 && ranges[index]->End().Position() >= startChange;) {
+		ranges[index]->MoveForInsertDelete(insertion, startChange, length);
+	}
+	// edited ranges after the change are moved later
+	for (size_t index = current + 1; index < ranges.size(); index++) {
+		Settle(index);
+		if (ranges[index]->Start().Position() > endChange) {
+			break;
+		}
+		ranges[index]->MoveForInsertDelete(insertion, startChange, length);
+		lengthMoved[index] += delta;
+	}
+	lengthChange += delta;
+}
+
@@ -135,6 +135,21 @@ class Selection {
 	size_t mainRange;
 	bool moveExtends;
 	bool tentativeMain;
+	// With many ranges, indices of ranges ordered by start position with running maximum of
+	// end position, so ranges around a position are found by binary search. Ranges added later
+	// are kept unordered in pendingRanges until merged. Discarded when any range may change.
+	mutable bool indexValid;
+	mutable std::vector<size_t> sortedRanges;
+	mutable std::vector<Sci::Position> maxEnd;
+	mutable std::vector<size_t> pendingRanges;
+	void InvalidateIndex() noexcept {
+		indexValid = false;
+	}
+	// merge pending ranges for queries, returns false when index is not used.
+	bool UseIndex(bool merge) const noexcept;
+	void MergePending() const;
+	size_t SortedUpperBound(Sci::Position pos) const noexcept;
+	void AddToIndex(size_t r) noexcept;
 public:
 	enum class SelTypes {
 		none, stream, rectangle, lines, thin
@@ -179,6 +194,8 @@ public:
 	InSelection CharacterInSelection(Sci::Position posCharacter) const noexcept;
 	InSelection InSelectionForEOL(Sci::Position pos) const noexcept;
 	Sci::Position VirtualSpaceFor(Sci::Position pos) const noexcept;
+	// Indices of ranges which start at or before end and end at or after start, in increasing order.
+	std::vector<size_t> RangesTouching(Sci::Position start, Sci::Position end) const;
 	void Clear();
 	void Reset() noexcept;
 	void RemoveDuplicates() noexcept;
@@ -191,4 +208,30 @@ public:
 	}
 };
 
+// Edit multiple selections from last to first with a single sweep to move selections.
+// Ranges edited earlier are moved by the length change of later edits when the batch ends,
+// only ranges next to each change are moved immediately.
+class SelectionBatch {
+	std::vector<SelectionRange *> ranges;	// in document order
+	std::vector<Sci::Position> lengthMoved;	// length change already applied to each edited range
+	Sci::Position lengthChange;
+	size_t current;
+	SelectionBatch *&active;
+	void Settle(size_t index) noexcept;
+public:
+	SelectionBatch(Selection &sel, SelectionBatch *&active_);
+	// Deleted so SelectionBatch objects can not be copied.
+	SelectionBatch(const SelectionBatch &) = delete;
+	SelectionBatch(SelectionBatch &&) = delete;
+	SelectionBatch &operator=(const SelectionBatch &) = delete;
+	SelectionBatch &operator=(SelectionBatch &&) = delete;
+	~SelectionBatch();
+	size_t Count() const noexcept {
+		return ranges.size();
+	}
+	/// Start editing range at index in document order, called with decreasing index.
+	SelectionRange &Edit(size_t index) noexcept;
+	void MovePositions(bool insertion, Sci::Position startChange, Sci::Position length) noexcept;
+};
+
 }
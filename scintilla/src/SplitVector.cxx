@@ -0,0 +1,117 @@
+// Scintilla source code edit control
+/** @file SplitVector.cxx
+ ** Virtual memory functions used by SplitVector to grow large bodies without copying.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+
+#include <stdexcept>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Debugging.h"
+
+#include "SplitVector.h"
+
+namespace Scintilla::Internal::VirtualMemory {
+
+size_t PageSize() noexcept {
+#if defined(_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+void *Reserve(size_t size) noexcept {
+#if defined(_WIN32)
+	return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	void *address = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return (address == MAP_FAILED) ? nullptr : address;
+#endif
+}
+
+bool Commit(void *address, size_t size) noexcept {
+#if defined(_WIN32)
+	return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+	return mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+void Release(void *address, size_t size) noexcept {
+#if defined(_WIN32)
+	(void)size;
+	VirtualFree(address, 0, MEM_RELEASE);
+#else
+	munmap(address, size);
+#endif
+}
+
+namespace {
+
+std::atomic<size_t> largePageSize;
+
+#if defined(_WIN64)
+bool EnableLockMemoryPrivilege() noexcept {
+	HANDLE hToken;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken)) {
+		return false;
+	}
+	TOKEN_PRIVILEGES tp {};
+	tp.PrivilegeCount = 1;
+	tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	bool result = LookupPrivilegeValueW(nullptr, L"SeLockMemoryPrivilege", &tp.Privileges[0].Luid)
+		&& AdjustTokenPrivileges(hToken, FALSE, &tp, 0, nullptr, nullptr)
+		// succeeded without assigning the privilege
+		&& GetLastError() == ERROR_SUCCESS;
+	CloseHandle(hToken);
+	return result;
+}
+#endif
+
+}
+
+bool SetLargePages(bool enable) noexcept {
+	size_t size = 0;
+#if defined(_WIN64)
+	if (enable) {
+		static const bool privilege = EnableLockMemoryPrivilege();
+		if (privilege) {
+			size = GetLargePageMinimum();
+		}
+	}
+#else
+	(void)enable;
+#endif
+	largePageSize.store(size, std::memory_order_relaxed);
+	return size != 0;
+}
+
+size_t LargePageSize() noexcept {
+	return largePageSize.load(std::memory_order_relaxed);
+}
+
+void *AllocateLarge(size_t size) noexcept {
+#if defined(_WIN64)
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+#else
+	(void)size;
+	return nullptr;
+#endif
+}
+
+}
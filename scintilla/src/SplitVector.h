@@ -18,10 +18,187 @@
 
 namespace Scintilla::Internal {
 
+namespace VirtualMemory {
+
+// Implemented in SplitVector.cxx with VirtualAlloc on Win32 and mmap on other systems.
+size_t PageSize() noexcept;
+void *Reserve(size_t size) noexcept;
+bool Commit(void *address, size_t size) noexcept;
+void Release(void *address, size_t size) noexcept;
+
+// Large pages are opt-in and only used on 64-bit Windows with SeLockMemoryPrivilege,
+// LargePageSize() returns 0 when they are not used.
+bool SetLargePages(bool enable) noexcept;
+size_t LargePageSize() noexcept;
+// Reserve and commit whole range with large pages, nullptr when it fails.
+void *AllocateLarge(size_t size) noexcept;
+
+}
+
+/// Storage for the body of a SplitVector.
+/// Large bodies of trivially copyable elements are held in a reserved range of virtual memory,
+/// so growing commits more pages instead of copying the whole body into a new allocation.
+template <typename T>
+class SplitVectorBody {
+	// smaller bodies are held in std::vector
+	static constexpr size_t virtualThreshold = 16*1024*1024;
+	static constexpr size_t commitGranularity = 1024*1024;
+	static constexpr bool virtualElements = std::is_trivially_copyable_v<T>;
+
+	std::vector<T> vec;
+	T *elements = nullptr;
+	size_t length = 0;
+	char *base = nullptr;
+	size_t committed = 0;
+	size_t reserved = 0;
+
+	static constexpr size_t RoundUp(size_t size, size_t granularity) noexcept {
+		return (size + granularity - 1) & ~(granularity - 1);
+	}
+
+	void MoveTo(void *address, size_t commit, size_t size) noexcept {
+		std::copy_n(elements, length, static_cast<T *>(address));
+		if (base) {
+			VirtualMemory::Release(base, reserved);
+		} else {
+			vec.clear();
+			vec.shrink_to_fit();
+		}
+		base = static_cast<char *>(address);
+		committed = commit;
+		reserved = size;
+	}
+
+	/// Move elements into a new reserved range with room to grow.
+	bool Relocate(size_t bytes) noexcept {
+		// fewer TLB misses on scanning whole body, but large pages can not be committed
+		// gradually and are never paged out, so leave less room to grow.
+		const size_t largePage = VirtualMemory::LargePageSize();
+		if (largePage != 0 && bytes >= largePage) {
+			const size_t size = RoundUp(bytes + bytes/8, largePage);
+			void *address = VirtualMemory::AllocateLarge(size);
+			if (address) {
+				MoveTo(address, size, size);
+				return true;
+			}
+		}
+		// address space is scarce for 32-bit, try smaller range when reserving fails.
+		constexpr bool wideAddress = sizeof(size_t) > 4;
+		constexpr size_t minReserve = wideAddress ? 1024*1024*1024 : 64*1024*1024;
+		const size_t wanted[] = {
+			std::max(bytes*(wideAddress ? 4 : 2), minReserve),
+			bytes + bytes/8,
+			bytes,
+		};
+		for (const size_t wantedSize : wanted) {
+			const size_t size = RoundUp(wantedSize, 64*1024);
+			void *address = VirtualMemory::Reserve(size);
+			if (address) {
+				const size_t commit = std::min(size, RoundUp(bytes, commitGranularity));
+				if (!VirtualMemory::Commit(address, commit)) {
+					VirtualMemory::Release(address, size);
+					return false;
+				}
+				MoveTo(address, commit, size);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ResizeVirtual(size_t newSize) noexcept {
+		const size_t bytes = newSize*sizeof(T);
+		if (bytes > reserved) {
+			if (!Relocate(bytes)) {
+				return false;
+			}
+		} else if (bytes > committed) {
+			const size_t commit = std::min(reserved, RoundUp(bytes, commitGranularity));
+			if (!VirtualMemory::Commit(base + committed, commit - committed)) {
+				return false;
+			}
+			committed = commit;
+		}
+		// newly committed pages are zero filled
+		elements = reinterpret_cast<T *>(base);
+		length = newSize;
+		return true;
+	}
+
+public:
+	SplitVectorBody() noexcept = default;
+	// Deleted so SplitVectorBody objects can not be copied.
+	SplitVectorBody(const SplitVectorBody &) = delete;
+	SplitVectorBody(SplitVectorBody &&) = delete;
+	void operator=(const SplitVectorBody &) = delete;
+	void operator=(SplitVectorBody &&) = delete;
+	~SplitVectorBody() {
+		if (base) {
+			VirtualMemory::Release(base, reserved);
+		}
+	}
+
+	T *data() noexcept {
+		return elements;
+	}
+	const T *data() const noexcept {
+		return elements;
+	}
+	size_t size() const noexcept {
+		return length;
+	}
+	T &operator[](size_t index) noexcept {
+		return elements[index];
+	}
+	const T &operator[](size_t index) const noexcept {
+		return elements[index];
+	}
+
+	void reserve(size_t newSize) {
+		if (base == nullptr && !(virtualElements && newSize*sizeof(T) >= virtualThreshold)) {
+			vec.reserve(newSize);
+			elements = vec.data();
+		}
+	}
+
+	void resize(size_t newSize) {
+		if constexpr (virtualElements) {
+			if (base != nullptr || newSize*sizeof(T) >= virtualThreshold) {
+				if (ResizeVirtual(newSize)) {
+					return;
+				}
+				if (base != nullptr) {
+					throw std::bad_alloc();
+				}
+			}
+		}
+		vec.resize(newSize);
+		elements = vec.data();
+		length = vec.size();
+	}
+
+	void clear() noexcept {
+		if (base) {
+			VirtualMemory::Release(base, reserved);
+			base = nullptr;
+			committed = 0;
+			reserved = 0;
+		}
+		vec.clear();
+		elements = vec.data();
+		length = 0;
+	}
+
+	void shrink_to_fit() {
+		vec.shrink_to_fit();
+		elements = vec.data();
+	}
+};
+
 template <typename T>
 class SplitVector {
 protected:
-	std::vector<T> body;
+	SplitVectorBody<T> body;
 	T empty;	/// Returned as the result of out-of-bounds access.
 	ptrdiff_t lengthBody;
 	ptrdiff_t part1Length;
@@ -200,6 +377,11 @@ public:
 		return lengthBody;
 	}
 
+	/// Bytes allocated for elements including the gap.
+	size_t MemoryUsage() const noexcept {
+		return body.size() * sizeof(T);
+	}
+
 	/// Insert a single value into the buffer.
 	/// Inserting at positions outside the current range fails.
 	void Insert(ptrdiff_t position, T v) {
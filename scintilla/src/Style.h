@@ -27,6 +27,7 @@ struct FontMeasurements {
 	XYPOSITION capitalHeight;	// Top of capital letter to baseline: ascent - internal leading
 	XYPOSITION aveCharWidth;
 	XYPOSITION spaceWidth;
+	XYPOSITION monospaceCharacterWidth;	// Advance of each ASCII graphic character when monospaceASCII
 	bool monospaceASCII;
 	int sizeZoomed;
 	FontMeasurements() noexcept;
@@ -6,30 +6,80 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstdlib>
+#include <cstdint>
 
 #include <stdexcept>
 #include <string>
 #include <string_view>
 
+#include "VectorISA.h"
 #include "UniConversion.h"
 
 namespace Scintilla::Internal {
 
+// Vectorized fast paths handle blocks of pure ASCII or of 8 two-byte sequences,
+// other blocks are converted by the scalar code, results are identical.
+
+#if NP2_USE_SSE2
+namespace {
+
+static_assert(sizeof(wchar_t) == sizeof(uint16_t));
+
+// 16 bytes of 8 two-byte sequences: lead byte in [C2, DF], trail byte in [80, BF].
+inline bool IsUTF8TwoByteBlock(__m128i chunk) noexcept {
+	// little endian: lead byte is the low byte of each 16-bit lane
+	const __m128i pattern = _mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xC0E0))), _mm_set1_epi16(static_cast<short>(0x80C0)));
+	// C0 and C1 are invalid lead bytes
+	const __m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16(0x1E)), _mm_setzero_si128());
+	return _mm_movemask_epi8(_mm_andnot_si128(overlong, pattern)) == 0xffff;
+}
+
+// decode 8 two-byte sequences into UTF-16
+inline __m128i UTF16FromUTF8TwoByteBlock(__m128i chunk) noexcept {
+	const __m128i lead = _mm_slli_epi16(_mm_and_si128(chunk, _mm_set1_epi16(0x1F)), 6);
+	const __m128i trail = _mm_and_si128(_mm_srli_epi16(chunk, 8), _mm_set1_epi16(0x3F));
+	return _mm_or_si128(lead, trail);
+}
+
+}
+#endif
+
 size_t UTF8Length(std::wstring_view wsv) noexcept {
 	size_t len = 0;
-	for (size_t i = 0; i < wsv.length() && wsv[i];) {
-		const unsigned int uch = wsv[i];
-		if (uch < 0x80) {
-			len++;
-		} else if (uch < 0x800) {
-			len += 2;
-		} else if ((uch >= SURROGATE_LEAD_FIRST) && (uch <= SURROGATE_TRAIL_LAST)) {
-			len += 4;
-			i++;
-		} else {
-			len += 3;
+	size_t i = 0;
+	const size_t length = wsv.length();
+	while (i < length && wsv[i]) {
+		size_t blockEnd = length;
+#if NP2_USE_SSE2
+		if (i + 8 <= length) {
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(wsv.data() + i));
+			const uint32_t maskNul = _mm_movemask_epi8(_mm_cmpeq_epi16(chunk, zero));
+			const uint32_t maskBelow800 = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xF800))), zero));
+			if (maskNul == 0 && maskBelow800 == 0xffff) {
+				// two bits for each ASCII character
+				const uint32_t maskASCII = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xFF80))), zero));
+				len += 16 - np2::popcount(maskASCII)/2;
+				i += 8;
+				continue;
+			}
+			blockEnd = i + 8;
 		}
-		i++;
+#endif
+		do {
+			const unsigned int uch = wsv[i];
+			if (uch < 0x80) {
+				len++;
+			} else if (uch < 0x800) {
+				len += 2;
+			} else if ((uch >= SURROGATE_LEAD_FIRST) && (uch <= SURROGATE_TRAIL_LAST)) {
+				len += 4;
+				i++;
+			} else {
+				len += 3;
+			}
+			i++;
+		} while (i < blockEnd && wsv[i]);
 	}
 	return len;
 }
@@ -48,27 +98,57 @@ size_t UTF8PositionFromUTF16Position(std::string_view u8Text, size_t positionUTF
 
 void UTF8FromUTF16(std::wstring_view wsv, char *putf, size_t len) noexcept {
 	size_t k = 0;
-	for (size_t i = 0; i < wsv.length() && wsv[i];) {
-		const unsigned int uch = wsv[i];
-		if (uch < 0x80) {
-			putf[k++] = static_cast<char>(uch);
-		} else if (uch < 0x800) {
-			putf[k++] = static_cast<char>(0xC0 | (uch >> 6));
-			putf[k++] = static_cast<char>(0x80 | (uch & 0x3f));
-		} else if ((uch >= SURROGATE_LEAD_FIRST) && (uch <= SURROGATE_TRAIL_LAST)) {
-			// Half a surrogate pair
-			i++;
-			const unsigned int xch = 0x10000 | ((uch & 0x3ff) << 10) | (wsv[i] & 0x3ff);
-			putf[k++] = static_cast<char>(0xF0 | (xch >> 18));
-			putf[k++] = static_cast<char>(0x80 | ((xch >> 12) & 0x3f));
-			putf[k++] = static_cast<char>(0x80 | ((xch >> 6) & 0x3f));
-			putf[k++] = static_cast<char>(0x80 | (xch & 0x3f));
-		} else {
-			putf[k++] = static_cast<char>(0xE0 | (uch >> 12));
-			putf[k++] = static_cast<char>(0x80 | ((uch >> 6) & 0x3f));
-			putf[k++] = static_cast<char>(0x80 | (uch & 0x3f));
+	size_t i = 0;
+	const size_t length = wsv.length();
+	while (i < length && wsv[i]) {
+		size_t blockEnd = length;
+#if NP2_USE_SSE2
+		if (i + 8 <= length) {
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(wsv.data() + i));
+			const uint32_t maskNul = _mm_movemask_epi8(_mm_cmpeq_epi16(chunk, zero));
+			const uint32_t maskASCII = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xFF80))), zero));
+			if (maskNul == 0 && maskASCII == 0xffff) {
+				_mm_storel_epi64(reinterpret_cast<__m128i *>(putf + k), _mm_packus_epi16(chunk, chunk));
+				k += 8;
+				i += 8;
+				continue;
+			}
+			const uint32_t maskBelow800 = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xF800))), zero));
+			if (maskASCII == 0 && maskBelow800 == 0xffff) {
+				// 110xxxxx 10xxxxxx, lead byte in the low byte of each 16-bit lane
+				const __m128i lead = _mm_or_si128(_mm_srli_epi16(chunk, 6), _mm_set1_epi16(0xC0));
+				const __m128i trail = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(chunk, _mm_set1_epi16(0x3F)), 8), _mm_set1_epi16(static_cast<short>(0x8000)));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(putf + k), _mm_or_si128(lead, trail));
+				k += 16;
+				i += 8;
+				continue;
+			}
+			blockEnd = i + 8;
 		}
-		i++;
+#endif
+		do {
+			const unsigned int uch = wsv[i];
+			if (uch < 0x80) {
+				putf[k++] = static_cast<char>(uch);
+			} else if (uch < 0x800) {
+				putf[k++] = static_cast<char>(0xC0 | (uch >> 6));
+				putf[k++] = static_cast<char>(0x80 | (uch & 0x3f));
+			} else if ((uch >= SURROGATE_LEAD_FIRST) && (uch <= SURROGATE_TRAIL_LAST)) {
+				// Half a surrogate pair
+				i++;
+				const unsigned int xch = 0x10000 | ((uch & 0x3ff) << 10) | (wsv[i] & 0x3ff);
+				putf[k++] = static_cast<char>(0xF0 | (xch >> 18));
+				putf[k++] = static_cast<char>(0x80 | ((xch >> 12) & 0x3f));
+				putf[k++] = static_cast<char>(0x80 | ((xch >> 6) & 0x3f));
+				putf[k++] = static_cast<char>(0x80 | (xch & 0x3f));
+			} else {
+				putf[k++] = static_cast<char>(0xE0 | (uch >> 12));
+				putf[k++] = static_cast<char>(0x80 | ((uch >> 6) & 0x3f));
+				putf[k++] = static_cast<char>(0x80 | (uch & 0x3f));
+			}
+			i++;
+		} while (i < blockEnd && wsv[i]);
 	}
 	if (k < len) {
 		putf[k] = '\0';
@@ -99,11 +179,33 @@ size_t UTF16Length(std::string_view svu8) noexcept {
 	size_t ulen = 0;
 	size_t i = 0;
 	unsigned int byteCount = 0;
-	while (i < svu8.length()) {
-		const unsigned char ch = svu8[i];
-		byteCount = UTF8BytesOfLead(ch);
-		i += byteCount;
-		ulen += UTF16LengthFromUTF8ByteCount(byteCount);
+	const size_t length = svu8.length();
+	while (i < length) {
+		size_t blockEnd = length;
+#if NP2_USE_SSE2
+		if (i + sizeof(__m128i) <= length) {
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(svu8.data() + i));
+			if (_mm_movemask_epi8(chunk) == 0) {
+				byteCount = 1;
+				ulen += sizeof(__m128i);
+				i += sizeof(__m128i);
+				continue;
+			}
+			if (IsUTF8TwoByteBlock(chunk)) {
+				byteCount = 2;
+				ulen += sizeof(__m128i)/2;
+				i += sizeof(__m128i);
+				continue;
+			}
+			blockEnd = i + sizeof(__m128i);
+		}
+#endif
+		do {
+			const unsigned char ch = svu8[i];
+			byteCount = UTF8BytesOfLead(ch);
+			i += byteCount;
+			ulen += UTF16LengthFromUTF8ByteCount(byteCount);
+		} while (i < blockEnd);
 	}
 
 	// Invalid 4-bytes UTF-8 lead byte at string end.
@@ -118,58 +220,81 @@ size_t UTF16FromUTF8(std::string_view svu8, wchar_t *tbuf, size_t tlen) {
 	const unsigned char *ptr = reinterpret_cast<const unsigned char *>(svu8.data());
 	const unsigned char * const end = ptr + svu8.length();
 	while (ptr < end) {
-		unsigned char ch = *ptr;
-		const unsigned int byteCount = UTF8BytesOfLead(ch);
-		unsigned int value;
-
-		if (ptr + byteCount > end) {
-			// Trying to read past end but still have space to write
-			if (ui < tlen) {
-				tbuf[ui] = ch;
-				ui++;
+		const unsigned char *blockEnd = end;
+#if NP2_USE_SSE2
+		if (ptr + sizeof(__m128i) <= end) {
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+			if (_mm_movemask_epi8(chunk) == 0 && ui + sizeof(__m128i) <= tlen) {
+				const __m128i zero = _mm_setzero_si128();
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(tbuf + ui), _mm_unpacklo_epi8(chunk, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(tbuf + ui + sizeof(__m128i)/2), _mm_unpackhi_epi8(chunk, zero));
+				ptr += sizeof(__m128i);
+				ui += sizeof(__m128i);
+				continue;
 			}
-			break;
+			if (ui + sizeof(__m128i)/2 <= tlen && IsUTF8TwoByteBlock(chunk)) {
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(tbuf + ui), UTF16FromUTF8TwoByteBlock(chunk));
+				ptr += sizeof(__m128i);
+				ui += sizeof(__m128i)/2;
+				continue;
+			}
+			blockEnd = ptr + sizeof(__m128i);
 		}
+#endif
+		do {
+			unsigned char ch = *ptr;
+			const unsigned int byteCount = UTF8BytesOfLead(ch);
+			unsigned int value;
+
+			if (ptr + byteCount > end) {
+				// Trying to read past end but still have space to write
+				if (ui < tlen) {
+					tbuf[ui] = ch;
+					ui++;
+				}
+				return ui;
+			}
 
-		const size_t outLen = UTF16LengthFromUTF8ByteCount(byteCount);
-		if (ui + outLen > tlen) {
-			throw std::runtime_error("UTF16FromUTF8: attempted write beyond end");
-		}
+			const size_t outLen = UTF16LengthFromUTF8ByteCount(byteCount);
+			if (ui + outLen > tlen) {
+				throw std::runtime_error("UTF16FromUTF8: attempted write beyond end");
+			}
 
-		ptr++;
-		switch (byteCount) {
-		case 1:
-			tbuf[ui] = ch;
-			break;
-		case 2:
-			value = (ch & 0x1F) << 6;
-			ch = *ptr++;
-			value |= ch & 0x3F;
-			tbuf[ui] = static_cast<wchar_t>(value);
-			break;
-		case 3:
-			value = (ch & 0xF) << 12;
-			ch = *ptr++;
-			value |= (ch & 0x3F) << 6;
-			ch = *ptr++;
-			value |= ch & 0x3F;
-			tbuf[ui] = static_cast<wchar_t>(value);
-			break;
-		default:
-			// Outside the BMP so need two surrogates
-			value = (ch & 0x7) << 18;
-			ch = *ptr++;
-			value |= (ch & 0x3F) << 12;
-			ch = *ptr++;
-			value |= (ch & 0x3F) << 6;
-			ch = *ptr++;
-			value |= ch & 0x3F;
-			tbuf[ui] = static_cast<wchar_t>(((value - SUPPLEMENTAL_PLANE_FIRST) >> 10) + SURROGATE_LEAD_FIRST);
+			ptr++;
+			switch (byteCount) {
+			case 1:
+				tbuf[ui] = ch;
+				break;
+			case 2:
+				value = (ch & 0x1F) << 6;
+				ch = *ptr++;
+				value |= ch & 0x3F;
+				tbuf[ui] = static_cast<wchar_t>(value);
+				break;
+			case 3:
+				value = (ch & 0xF) << 12;
+				ch = *ptr++;
+				value |= (ch & 0x3F) << 6;
+				ch = *ptr++;
+				value |= ch & 0x3F;
+				tbuf[ui] = static_cast<wchar_t>(value);
+				break;
+			default:
+				// Outside the BMP so need two surrogates
+				value = (ch & 0x7) << 18;
+				ch = *ptr++;
+				value |= (ch & 0x3F) << 12;
+				ch = *ptr++;
+				value |= (ch & 0x3F) << 6;
+				ch = *ptr++;
+				value |= ch & 0x3F;
+				tbuf[ui] = static_cast<wchar_t>(((value - SUPPLEMENTAL_PLANE_FIRST) >> 10) + SURROGATE_LEAD_FIRST);
+				ui++;
+				tbuf[ui] = static_cast<wchar_t>((value & 0x3ff) + SURROGATE_TRAIL_FIRST);
+				break;
+			}
 			ui++;
-			tbuf[ui] = static_cast<wchar_t>((value & 0x3ff) + SURROGATE_TRAIL_FIRST);
-			break;
-		}
-		ui++;
+		} while (ptr < blockEnd);
 	}
 	return ui;
 }
@@ -74,8 +74,11 @@ void FontRealised::Realise(Surface &surface, int zoomLevel, Technology technolog
 		const XYPOSITION scaledVariance = variance / aveCharWidth;
 		constexpr XYPOSITION monospaceWidthEpsilon = 0.000001;	// May need tweaking if monospace fonts vary more
 		monospaceASCII = scaledVariance < monospaceWidthEpsilon;
+		// measured advance, average width may be rounded (GDI) or include rounding error (DirectWrite)
+		monospaceCharacterWidth = minWidth;
 	} else {
 		monospaceASCII = false;
+		monospaceCharacterWidth = aveCharWidth;
 	}
 }
 
@@ -110,6 +113,7 @@ ViewStyle::ViewStyle(const ViewStyle &source) : markers(MarkerMax + 1), indicato
 
 	controlCharSymbol = source.controlCharSymbol;
 	controlCharWidth = source.controlCharWidth;
+	fieldDelimiter = source.fieldDelimiter;
 	selbar = source.selbar;
 	selbarlight = source.selbarlight;
 	caret = source.caret;
@@ -243,6 +247,7 @@ void ViewStyle::Init(size_t stylesSize_) {
 
 	controlCharSymbol = 0;	/* Draw the control characters */
 	controlCharWidth = 0;
+	fieldDelimiter = 0;
 	selbar = Platform::Chrome();
 	selbarlight = Platform::ChromeHighlight();
 	styles[StyleLineNumber].fore = ColourRGBA(0, 0, 0);
@@ -441,6 +446,14 @@ void ViewStyle::SetFontLocaleName(const char *name) {
 	localeName = name;
 }
 
+void ViewStyle::GetStyleLayoutKeys(std::vector<StyleLayoutKey> &keys) const {
+	keys.clear();
+	keys.reserve(styles.size());
+	for (const Style &style : styles) {
+		keys.emplace_back(style);
+	}
+}
+
 bool ViewStyle::ProtectionActive() const noexcept {
 	return someStylesProtected;
 }
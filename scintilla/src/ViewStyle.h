@@ -91,6 +91,20 @@ struct WrapAppearance {
 	Scintilla::WrapIndentMode indentMode;
 };
 
+// Style attributes that affect measured positions and line layouts, colours are excluded.
+struct StyleLayoutKey {
+	FontSpecification fs;
+	bool checkMonospaced;
+	StylePod::CaseForce caseForce;
+	bool visible;
+	explicit StyleLayoutKey(const Style &style) noexcept :
+		fs(style), checkMonospaced(style.checkMonospaced), caseForce(style.caseForce), visible(style.visible) {}
+	bool operator==(const StyleLayoutKey &other) const noexcept {
+		return fs == other.fs && checkMonospaced == other.checkMonospaced
+			&& caseForce == other.caseForce && visible == other.visible;
+	}
+};
+
 struct EdgeProperties {
 	int column;
 	ColourRGBA colour;
@@ -139,6 +153,7 @@ public:
 
 	int controlCharSymbol;
 	XYPOSITION controlCharWidth;
+	int fieldDelimiter;
 	ColourRGBA selbar;
 	ColourRGBA selbarlight;
 	std::optional<ColourRGBA> foldmarginColour;
@@ -213,6 +228,7 @@ public:
 	void ClearStyles() noexcept;
 	void SetStyleFontName(int styleIndex, const char *name);
 	void SetFontLocaleName(const char *name);
+	void GetStyleLayoutKeys(std::vector<StyleLayoutKey> &keys) const;
 	bool ProtectionActive() const noexcept;
 	int ExternalMarginWidth() const noexcept;
 	int SCICALL MarginFromLocation(Point pt) const noexcept;
@@ -9,13 +9,16 @@
 #include <cstring>
 
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <optional>
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <mutex>
 
 #include "ScintillaTypes.h"
 
@@ -162,7 +165,7 @@ void XPM::Init(const char *const *linesForm) {
 	}
 }
 
-void XPM::Draw(Surface *surface, PRectangle rc) {
+void XPM::Draw(Surface *surface, PRectangle rc) const {
 	if (pixels.empty()) {
 		return;
 	}
@@ -332,14 +335,14 @@ void RGBAImageSet::Clear() noexcept {
 }
 
 /// Add an image.
-void RGBAImageSet::AddImage(int ident, std::unique_ptr<RGBAImage> image) {
+void RGBAImageSet::AddImage(int ident, std::shared_ptr<const RGBAImage> image) {
 	images[ident] = std::move(image);
 	height = -1;
 	width = -1;
 }
 
 /// Get image by id.
-RGBAImage *RGBAImageSet::Get(int ident) const {
+const RGBAImage *RGBAImageSet::Get(int ident) const {
 	const auto it = images.find(ident);
 	if (it != images.end()) {
 		return it->second.get();
@@ -370,3 +373,85 @@ int RGBAImageSet::GetWidth() const noexcept {
 	}
 	return std::max(w, 0);
 }
+
+namespace {
+
+// Images are small and few, the cache is emptied when it grows past this count,
+// images still in use are kept alive by their owners.
+constexpr size_t maxCachedImages = 128;
+
+std::mutex imageCacheMutex;
+std::unordered_map<std::string, std::shared_ptr<const XPM>> xpmCache;
+std::unordered_map<std::string, std::shared_ptr<const RGBAImage>> rgbaCache;
+
+// Key is the XPM content: text form up to NUL, or each line of lines form.
+std::string KeyFromXPM(const char *textForm) {
+	if (0 == memcmp(textForm, "/* X", 4) && 0 == memcmp(textForm, "/* XPM */", 9)) {
+		return std::string(textForm);
+	}
+	const char *const *linesForm = reinterpret_cast<const char *const *>(textForm);
+	const char *line0 = linesForm[0];
+	std::string key(line0, MeasureLength(line0));
+	line0 = NextField(line0);
+	const int height = atoi(line0);
+	line0 = NextField(line0);
+	const int nColours = atoi(line0);
+	line0 = NextField(line0);
+	if (atoi(line0) == 1) {
+		// Only one char per pixel is supported, other lines are ignored otherwise
+		for (int i = 1; i <= nColours + height; i++) {
+			key.push_back('\n');
+			key.append(linesForm[i], MeasureLength(linesForm[i]));
+		}
+	}
+	return key;
+}
+
+template <typename T, typename Creator>
+std::shared_ptr<const T> FindOrCreate(std::unordered_map<std::string, std::shared_ptr<const T>> &cache, std::string &&key, Creator creator) {
+	std::lock_guard<std::mutex> guard(imageCacheMutex);
+	const auto it = cache.find(key);
+	if (it != cache.end()) {
+		return it->second;
+	}
+	if (cache.size() >= maxCachedImages) {
+		cache.clear();
+	}
+	std::shared_ptr<const T> image = creator();
+	cache.emplace(std::move(key), image);
+	return image;
+}
+
+}
+
+namespace Scintilla::Internal {
+
+std::shared_ptr<const XPM> SharedXPM(const char *textForm) {
+	return FindOrCreate(xpmCache, KeyFromXPM(textForm), [textForm]() {
+		return std::make_shared<XPM>(textForm);
+	});
+}
+
+std::shared_ptr<const RGBAImage> SharedRGBAImage(const char *xpmTextForm) {
+	// 'X' prefix separates decoded XPM from raw pixels, which start with 'P'
+	std::string key = "X" + KeyFromXPM(xpmTextForm);
+	return FindOrCreate(rgbaCache, std::move(key), [xpmTextForm]() {
+		const XPM xpmImage(xpmTextForm);
+		return std::make_shared<RGBAImage>(xpmImage);
+	});
+}
+
+std::shared_ptr<const RGBAImage> SharedRGBAImage(int width, int height, float scale, const unsigned char *pixels) {
+	std::string key("P");
+	key.append(reinterpret_cast<const char *>(&width), sizeof(width));
+	key.append(reinterpret_cast<const char *>(&height), sizeof(height));
+	key.append(reinterpret_cast<const char *>(&scale), sizeof(scale));
+	if (pixels) {
+		key.append(reinterpret_cast<const char *>(pixels), static_cast<size_t>(width) * height * RGBAImage::bytesPerPixel);
+	}
+	return FindOrCreate(rgbaCache, std::move(key), [=]() {
+		return std::make_shared<RGBAImage>(width, height, scale, pixels);
+	});
+}
+
+}
@@ -31,7 +31,7 @@ public:
 	void Init(const char *textForm);
 	void Init(const char *const *linesForm);
 	/// Decompose image into runs and use FillRectangle for each run
-	void SCICALL Draw(Surface *surface, PRectangle rc);
+	void SCICALL Draw(Surface *surface, PRectangle rc) const;
 	constexpr int GetHeight() const noexcept {
 		return height;
 	}
@@ -85,7 +85,7 @@ public:
  * A collection of RGBAImage pixmaps indexed by integer id.
  */
 class RGBAImageSet final {
-	typedef std::map<int, std::unique_ptr<RGBAImage>> ImageMap;
+	typedef std::map<int, std::shared_ptr<const RGBAImage>> ImageMap;
 	ImageMap images;
 	mutable int height;	///< Memorize largest height of the set.
 	mutable int width;	///< Memorize largest width of the set.
@@ -100,13 +100,21 @@ public:
 	/// Remove all images.
 	void Clear() noexcept;
 	/// Add an image.
-	void AddImage(int ident, std::unique_ptr<RGBAImage> image);
+	void AddImage(int ident, std::shared_ptr<const RGBAImage> image);
 	/// Get image by id.
-	RGBAImage *Get(int ident) const;
+	const RGBAImage *Get(int ident) const;
 	/// Give the largest height of the set.
 	int GetHeight() const noexcept;
 	/// Give the largest width of the set.
 	int GetWidth() const noexcept;
 };
 
+/**
+ * Decoded images are shared by content, so defining the same image for another view,
+ * or again after restyling, reuses the decoded form instead of parsing it again.
+ */
+std::shared_ptr<const XPM> SharedXPM(const char *textForm);
+std::shared_ptr<const RGBAImage> SharedRGBAImage(const char *xpmTextForm);
+std::shared_ptr<const RGBAImage> SharedRGBAImage(int width, int height, float scale, const unsigned char *pixels);
+
 }
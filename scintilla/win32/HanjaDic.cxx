@@ -8,6 +8,8 @@
 
 #include <string>
 #include <string_view>
+#include <algorithm>
+#include <new>
 
 #include <windows.h>
 #include <ole2.h>
@@ -58,28 +60,56 @@ extern "C" const GUID __declspec(selectany) IID_IHanjaDic =
 
 class HanjaDic {
 private:
-	HRESULT hr;
-	CLSID CLSID_HanjaDic;
+	bool opened = false;
+
+	// one hanja is converted to one hangul, consecutive hanja are converted together.
+	int ConvertRun(wchar_t *text, size_t count) noexcept {
+		BSTR bstrHanja = ::SysAllocStringLen(text, static_cast<UINT>(count));
+		if (!bstrHanja) {
+			return 0;
+		}
+		int changed = 0;
+		BSTR bstrHangul = nullptr;
+		const HRESULT hr = HJinterface->HanjaToHangul(bstrHanja, &bstrHangul);
+		if (SUCCEEDED(hr) && bstrHangul) {
+			if (::SysStringLen(bstrHangul) == count) {
+				std::copy_n(bstrHangul, count, text);
+				changed = static_cast<int>(count);
+			}
+			::SysFreeString(bstrHangul);
+		}
+		::SysFreeString(bstrHanja);
+		if (changed == 0 && count > 1) {
+			for (size_t i = 0; i < count; i++) {
+				changed += ConvertRun(text + i, 1);
+			}
+		}
+		return changed;
+	}
 
 public:
-	IHanjaDic *HJinterface;
+	IHanjaDic *HJinterface = nullptr;
 
-	HanjaDic() noexcept : HJinterface(nullptr) {
-		hr = CLSIDFromProgID(OLESTR("mshjdic.hanjadic"), &CLSID_HanjaDic);
+	HanjaDic() noexcept {
+		CLSID CLSID_HanjaDic;
+		HRESULT hr = CLSIDFromProgID(OLESTR("mshjdic.hanjadic"), &CLSID_HanjaDic);
 		if (SUCCEEDED(hr)) {
 			hr = CoCreateInstance(CLSID_HanjaDic, nullptr,
 				CLSCTX_INPROC_SERVER, IID_IHanjaDic,
 				(LPVOID *)& HJinterface);
 			if (SUCCEEDED(hr)) {
 				hr = HJinterface->OpenMainDic();
+				opened = SUCCEEDED(hr);
 			}
 		}
 	}
 
 	~HanjaDic() {
-		if (SUCCEEDED(hr)) {
-			hr = HJinterface->CloseMainDic();
+		if (HJinterface) {
 			try {
+				if (opened) {
+					HJinterface->CloseMainDic();
+				}
 				// This can never fail but IUnknown::Release is not marked noexcept.
 				HJinterface->Release();
 			} catch (...) {
@@ -89,43 +119,71 @@ public:
 	}
 
 	bool HJdictAvailable() const noexcept {
-		return SUCCEEDED(hr);
+		return opened;
 	}
 
-	bool IsHanja(int hanja) noexcept {
+	bool IsHanja(wchar_t hanja) noexcept {
+		// skip characters outside CJK ideograph blocks without calling into the dictionary
+		if (!((hanja >= 0x3400 && hanja <= 0x9FFF) || (hanja >= 0xF900 && hanja <= 0xFAFF))) {
+			return false;
+		}
 		HANJA_TYPE hanjaType;
-		hr = HJinterface->GetHanjaType(static_cast<unsigned short>(hanja), &hanjaType);
+		const HRESULT hr = HJinterface->GetHanjaType(static_cast<unsigned short>(hanja), &hanjaType);
 		if (SUCCEEDED(hr)) {
 			return (hanjaType > 0);
 		}
 		return false;
 	}
+
+	int ToHangul(wchar_t *inout) noexcept {
+		int changed = 0;
+		const size_t len = lstrlenW(inout);
+		size_t i = 0;
+		while (i < len) {
+			if (IsHanja(inout[i])) { // Pass hanja only!
+				size_t end = i + 1;
+				while (end < len && IsHanja(inout[end])) {
+					++end;
+				}
+				changed += ConvertRun(inout + i, end - i);
+				i = end;
+			} else {
+				++i;
+			}
+		}
+		return changed;
+	}
 };
 
+namespace {
+
+// Created by first conversion and kept until ReleaseHanjaDic(), also when the dictionary is
+// not available. The COM interface is only used on the thread that created it.
+HanjaDic *cachedDict;
+DWORD cachedThreadId;
+
+}
+
 int GetHangulOfHanja(wchar_t *inout) noexcept {
 	// Convert every hanja to hangul.
 	// Return the number of characters converted.
-	int changed = 0;
+	const DWORD threadId = ::GetCurrentThreadId();
+	if (cachedDict == nullptr) {
+		cachedDict = new (std::nothrow) HanjaDic();
+		cachedThreadId = threadId;
+	}
+	if (cachedDict != nullptr && cachedThreadId == threadId) {
+		return cachedDict->HJdictAvailable() ? cachedDict->ToHangul(inout) : 0;
+	}
 	HanjaDic dict;
-	if (dict.HJdictAvailable()) {
-		const size_t len = lstrlenW(inout);
-		wchar_t conv[UTF8MaxBytes]{};
-		BSTR bstrHangul = SysAllocString(conv);
-		for (size_t i = 0; i < len; i++) {
-			if (dict.IsHanja(static_cast<int>(inout[i]))) { // Pass hanja only!
-				conv[0] = inout[i];
-				BSTR bstrHanja = SysAllocString(conv);
-				const HRESULT hr = dict.HJinterface->HanjaToHangul(bstrHanja, &bstrHangul);
-				if (SUCCEEDED(hr)) {
-					inout[i] = static_cast<wchar_t>(bstrHangul[0]);
-					changed += 1;
-				}
-				SysFreeString(bstrHanja);
-			}
-		}
-		SysFreeString(bstrHangul);
+	return dict.HJdictAvailable() ? dict.ToHangul(inout) : 0;
+}
+
+void ReleaseHanjaDic() noexcept {
+	if (cachedDict != nullptr && cachedThreadId == ::GetCurrentThreadId()) {
+		delete cachedDict;
+		cachedDict = nullptr;
 	}
-	return changed;
 }
 
 }
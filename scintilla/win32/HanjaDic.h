@@ -10,5 +10,6 @@
 namespace Scintilla::Internal {
 
 int GetHangulOfHanja(wchar_t *inout) noexcept;
+void ReleaseHanjaDic() noexcept;
 
 }
@@ -38,6 +38,7 @@
 #include "Platform.h"
 #include "VectorISA.h"
 #include "GraphicUtils.h"
+#include "TraceEvents.h"
 #include "XPM.h"
 #include "CharClassify.h"
 #include "UniConversion.h"
@@ -64,6 +65,11 @@ extern UINT g_uSystemDPI;
 extern "C" UINT g_uSystemDPI;
 #endif
 
+#if NP2_ENABLE_TRACELOGGING
+TRACELOGGING_DEFINE_PROVIDER(np2TraceProvider, "Notepad2",
+	(0x61f63ddc, 0x9a6e, 0x5c29, 0xab, 0x53, 0x26, 0x4d, 0xc5, 0xc8, 0x28, 0x33));
+#endif
+
 using namespace Scintilla;
 
 #if !NP2_HAS_GETDPIFORWINDOW
@@ -265,12 +271,89 @@ bool LoadD2D() noexcept {
 
 namespace {
 
+#if defined(USE_D2D)
+// Text layouts recently drawn with a font, so repainting unchanged text after caret blinking,
+// selection change or scrolling reuses shaped glyphs. Only used by the thread drawing text.
+class TextLayoutCache {
+	struct Entry {
+		std::wstring text;
+		IDWriteTextLayout *layout = nullptr;
+		unsigned int clock = 0;
+	};
+	std::unique_ptr<Entry[]> entries;
+	unsigned int clock = 0;
+public:
+	static constexpr size_t size = 1024;
+	// same as BreakFinder::lengthStartSubdivision, longer text is seldom drawn again
+	static constexpr size_t maxLength = 300;
+
+	TextLayoutCache() noexcept = default;
+	TextLayoutCache(const TextLayoutCache &) = delete;
+	TextLayoutCache(TextLayoutCache &&) = delete;
+	TextLayoutCache &operator=(const TextLayoutCache &) = delete;
+	TextLayoutCache &operator=(TextLayoutCache &&) = delete;
+	~TextLayoutCache() noexcept {
+		Clear();
+	}
+	void Clear() noexcept {
+		if (entries) {
+			for (size_t i = 0; i < size; i++) {
+				ReleaseUnknown(entries[i].layout);
+			}
+			entries.reset();
+		}
+		clock = 0;
+	}
+	// Returned layout is owned by cache and only valid until next call.
+	IDWriteTextLayout *Get(IDWriteTextFormat *pTextFormat, std::wstring_view text);
+};
+
+IDWriteTextLayout *TextLayoutCache::Get(IDWriteTextFormat *pTextFormat, std::wstring_view text) {
+	if (!entries) {
+		entries = std::make_unique<Entry[]>(size);
+	}
+	// Two way associative: try two probe positions.
+	const size_t hashValue = std::hash<std::wstring_view>{}(text);
+	const size_t probe = hashValue & (size - 1);
+	const size_t probe2 = (hashValue * 37) & (size - 1);
+	for (const size_t index : {probe, probe2}) {
+		Entry &entry = entries[index];
+		if (entry.layout && entry.text == text) {
+			entry.clock = ++clock;
+			return entry.layout;
+		}
+	}
+
+	// Not found. Choose the oldest of the two slots to replace
+	Entry &entry = entries[(entries[probe].clock > entries[probe2].clock) ? probe2 : probe];
+	ReleaseUnknown(entry.layout);
+	// layout box does not affect drawing as text is not wrapped and aligned to its origin
+	const HRESULT hr = pIDWriteFactory->CreateTextLayout(text.data(), static_cast<UINT32>(text.length()),
+		pTextFormat, 10000.0, 1000.0, &entry.layout);
+	if (!SUCCEEDED(hr)) {
+		entry.layout = nullptr;
+		return nullptr;
+	}
+	entry.text = text;
+	if (clock == UINT_MAX) {
+		// wrap round and reset all entries so none get stuck with a high clock.
+		for (size_t i = 0; i < size; i++) {
+			entries[i].clock = 0;
+		}
+		clock = 0;
+	}
+	entry.clock = ++clock;
+	return entry.layout;
+}
+#endif
+
 // Both GDI and DirectWrite can produce a HFONT for use in list boxes
 struct FontWin final : public Font {
 	LOGFONTW lf;
 	HFONT hfont{};
 #if defined(USE_D2D)
 	IDWriteTextFormat *pTextFormat = nullptr;
+	mutable TextLayoutCache layoutCache;
 #endif
 	FontQuality extraFontFlag;
 	FLOAT yAscent = 2.0f;
@@ -383,17 +466,7 @@ bool GetDWriteFontProperties(const LOGFONTW &lf, std::wstring &wsFamily,
 }
 #endif
 
-}
-
-std::shared_ptr<Font> Font::Allocate(const FontParameters &fp) {
-	LOGFONTW lf {};
-	// The negative is to allow for leading
-	lf.lfHeight = -std::abs(std::lround(fp.size));
-	lf.lfWeight = static_cast<LONG>(fp.weight);
-	lf.lfItalic = fp.italic ? 1 : 0;
-	lf.lfCharSet = static_cast<BYTE>(fp.characterSet);
-	lf.lfQuality = Win32MapFontQuality(fp.extraFontFlag);
-	UTF16FromUTF8(fp.faceName, lf.lfFaceName, LF_FACESIZE);
+std::shared_ptr<Font> CreateFontWin(const LOGFONTW &lf, const FontParameters &fp) {
 	if (fp.technology == Technology::Default) {
 		HFONT hfont = ::CreateFontIndirectW(&lf);
 		return std::make_shared<FontGDI>(lf, hfont, fp.extraFontFlag);
@@ -451,6 +524,53 @@ std::shared_ptr<Font> Font::Allocate(const FontParameters &fp) {
 	return {};
 }
 
+// Styles sharing face, size and weight, other views, call tips and autocomplete list
+// get the same font object, fonts are only created on the thread owning the windows.
+// Entries don't own the font, it's released after last style using it is refreshed.
+struct FontCacheEntry {
+	LOGFONTW lf;
+	XYPOSITION size;
+	Technology technology;
+	FontQuality extraFontFlag;
+	std::string localeName;
+	std::weak_ptr<Font> font;
+};
+
+std::vector<FontCacheEntry> fontCache;
+
+}
+
+std::shared_ptr<Font> Font::Allocate(const FontParameters &fp) {
+	LOGFONTW lf {};
+	// The negative is to allow for leading
+	lf.lfHeight = -std::abs(std::lround(fp.size));
+	lf.lfWeight = static_cast<LONG>(fp.weight);
+	lf.lfItalic = fp.italic ? 1 : 0;
+	lf.lfCharSet = static_cast<BYTE>(fp.characterSet);
+	lf.lfQuality = Win32MapFontQuality(fp.extraFontFlag);
+	UTF16FromUTF8(fp.faceName, lf.lfFaceName, LF_FACESIZE);
+
+	const std::string_view localeName = fp.localeName ? fp.localeName : "";
+	for (auto it = fontCache.begin(); it != fontCache.end();) {
+		std::shared_ptr<Font> font = it->font.lock();
+		if (!font) {
+			it = fontCache.erase(it);
+			continue;
+		}
+		if (it->size == fp.size && it->technology == fp.technology && it->extraFontFlag == fp.extraFontFlag
+			&& memcmp(&it->lf, &lf, sizeof(LOGFONTW)) == 0 && it->localeName == localeName) {
+			return font;
+		}
+		++it;
+	}
+
+	std::shared_ptr<Font> font = CreateFontWin(lf, fp);
+	if (font) {
+		fontCache.push_back({lf, fp.size, fp.technology, fp.extraFontFlag, std::string(localeName), font});
+	}
+	return font;
+}
+
 // Buffer to hold strings and string position arrays without always allocating on heap.
 // May sometimes have string too long to allocate on stack. So use a fixed stack-allocated buffer
 // when less than safe size otherwise allocate on heap and free automatically.
@@ -639,7 +759,7 @@ void SurfaceGDI::Release() noexcept {
 }
 
 bool SurfaceGDI::SupportsFeature(Supports feature) const noexcept {
-	return SupportsGDI == feature;
+	return SupportsGDI == feature || Supports::ThreadSafeMeasureWidths == feature;
 }
 
 bool SurfaceGDI::Initialised() const noexcept {
@@ -1409,7 +1529,8 @@ constexpr unsigned int SupportsD2D =
 	(1 << static_cast<int>(Supports::LineDrawsFinal)) |
 	(1 << static_cast<int>(Supports::FractionalStrokeWidth)) |
 	(1 << static_cast<int>(Supports::TranslucentStroke)) |
-	(1 << static_cast<int>(Supports::PixelModification));
+	(1 << static_cast<int>(Supports::PixelModification)) |
+	(1 << static_cast<int>(Supports::ThreadSafeMeasureWidths));
 
 #if NP2_USE_SSE2
 static_assert(sizeof(D2D_COLOR_F) == sizeof(__m128));
@@ -1447,6 +1568,53 @@ constexpr D2D1_RECT_F RectangleInset(D2D1_RECT_F rect, FLOAT inset) noexcept {
 	};
 }
 
+// Device independent resources shared by all D2D surfaces, released in Platform_Finalise().
+ID2D1StrokeStyle *strokeStyleSquareCap = nullptr;
+ID2D1StrokeStyle *strokeStyleRoundCap = nullptr;
+
+ID2D1StrokeStyle *SolidStrokeStyle(D2D1_CAP_STYLE capStyle) noexcept {
+	ID2D1StrokeStyle *&pStrokeStyle = (capStyle == D2D1_CAP_STYLE_ROUND) ? strokeStyleRoundCap : strokeStyleSquareCap;
+	if (!pStrokeStyle) {
+		D2D1_STROKE_STYLE_PROPERTIES strokeProps {};
+		strokeProps.startCap = capStyle;
+		strokeProps.endCap = capStyle;
+		strokeProps.dashCap = D2D1_CAP_STYLE_FLAT;
+		strokeProps.lineJoin = D2D1_LINE_JOIN_MITER;
+		strokeProps.miterLimit = 4.0f;
+		strokeProps.dashStyle = D2D1_DASH_STYLE_SOLID;
+		strokeProps.dashOffset = 0;
+		const HRESULT hr = pD2DFactory->CreateStrokeStyle(strokeProps, nullptr, 0, &pStrokeStyle);
+		if (FAILED(hr)) {
+			ReleaseUnknown(pStrokeStyle);
+		}
+	}
+	return pStrokeStyle;
+}
+
+// Open geometries of recent PolyLine() calls with points relative to the first point,
+// squiggle indicators of same width are drawn from one geometry with a translation.
+struct PolyLineGeometry {
+	std::vector<Point> shape;
+	ID2D1PathGeometry *geometry = nullptr;
+};
+
+constexpr size_t PolyLineGeometryCacheSize = 16;
+PolyLineGeometry polyLineGeometryCache[PolyLineGeometryCacheSize];
+size_t polyLineGeometryNext = 0;
+
+void ReleaseD2DSharedResources() noexcept {
+	for (PolyLineGeometry &entry : polyLineGeometryCache) {
+		ReleaseUnknown(entry.geometry);
+		entry.shape.clear();
+	}
+	ReleaseUnknown(strokeStyleSquareCap);
+	ReleaseUnknown(strokeStyleRoundCap);
+}
+
+// opaque rectangles with same colour are filled as one geometry once there are this many
+constexpr size_t FillBatchGeometryMinCount = 4;
+constexpr size_t FillBatchMaxCount = 256;
+
 }
 
 class BlobInline;
@@ -1465,12 +1633,20 @@ class SurfaceD2D final : public Surface {
 	FLOAT yInternalLeading = 0;
 
 	ID2D1SolidColorBrush *pBrush = nullptr;
+	ColourRGBA brushColour;
+
+	// pending opaque FillRectangle() calls with same colour, drawn before any other drawing.
+	std::vector<D2D1_RECT_F> fillBatch;
+	ColourRGBA fillBatchColour;
 
 	int logPixelsY = USER_DEFAULT_SCREEN_DPI;
 
 	void Clear() noexcept;
 	void SetFont(const Font *font_) noexcept;
 	HRESULT GetBitmap(ID2D1Bitmap **ppBitmap);
+	void SetBrushColour(ColourRGBA colour) noexcept;
+	void FlushFillBatch() noexcept;
+	static ID2D1PathGeometry *CachedPolyLineGeometry(const Point *pts, size_t npts);
 
 public:
 	SurfaceD2D() noexcept = default;
@@ -1567,6 +1743,8 @@ SurfaceD2D::~SurfaceD2D() noexcept {
 }
 
 void SurfaceD2D::Clear() noexcept {
+	FlushFillBatch();
+	fillBatch.clear();
 	ReleaseUnknown(pBrush);
 	if (pRenderTarget) {
 		while (clipsActive) {
@@ -1617,21 +1795,75 @@ void SurfaceD2D::SetMode(SurfaceMode mode_) noexcept {
 
 HRESULT SurfaceD2D::GetBitmap(ID2D1Bitmap **ppBitmap) {
 	PLATFORM_ASSERT(pBitmapRenderTarget);
+	FlushFillBatch();
 	return pBitmapRenderTarget->GetBitmap(ppBitmap);
 }
 
-void SurfaceD2D::D2DPenColourAlpha(ColourRGBA fore) noexcept {
+void SurfaceD2D::SetBrushColour(ColourRGBA colour) noexcept {
 	if (pRenderTarget) {
-		const D2D_COLOR_F col = ColorFromColourAlpha(fore);
 		if (pBrush) {
-			pBrush->SetColor(col);
+			if (!(colour == brushColour)) {
+				pBrush->SetColor(ColorFromColourAlpha(colour));
+			}
 		} else {
-			const HRESULT hr = pRenderTarget->CreateSolidColorBrush(col, &pBrush);
+			const HRESULT hr = pRenderTarget->CreateSolidColorBrush(ColorFromColourAlpha(colour), &pBrush);
 			if (!SUCCEEDED(hr)) {
 				ReleaseUnknown(pBrush);
 			}
 		}
+		brushColour = colour;
+	}
+}
+
+void SurfaceD2D::FlushFillBatch() noexcept {
+	const size_t count = fillBatch.size();
+	if (count == 0) {
+		return;
+	}
+	SetBrushColour(fillBatchColour);
+	if (pRenderTarget && pBrush) {
+		bool filled = false;
+		if (count >= FillBatchGeometryMinCount) {
+			ID2D1PathGeometry *geometry = nullptr;
+			HRESULT hr = pD2DFactory->CreatePathGeometry(&geometry);
+			if (SUCCEEDED(hr) && geometry) {
+				ID2D1GeometrySink *sink = nullptr;
+				hr = geometry->Open(&sink);
+				if (SUCCEEDED(hr) && sink) {
+					// rectangles are opaque, overlapped area is filled only once.
+					sink->SetFillMode(D2D1_FILL_MODE_WINDING);
+					for (const D2D1_RECT_F &rect : fillBatch) {
+						const D2D1_POINT_2F corners[3] = {
+							{ rect.right, rect.top },
+							{ rect.right, rect.bottom },
+							{ rect.left, rect.bottom },
+						};
+						sink->BeginFigure({ rect.left, rect.top }, D2D1_FIGURE_BEGIN_FILLED);
+						sink->AddLines(corners, 3);
+						sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+					}
+					hr = sink->Close();
+					ReleaseUnknown(sink);
+					if (SUCCEEDED(hr)) {
+						pRenderTarget->FillGeometry(geometry, pBrush);
+						filled = true;
+					}
+				}
+			}
+			ReleaseUnknown(geometry);
+		}
+		if (!filled) {
+			for (const D2D1_RECT_F &rect : fillBatch) {
+				pRenderTarget->FillRectangle(&rect, pBrush);
+			}
+		}
 	}
+	fillBatch.clear();
+}
+
+void SurfaceD2D::D2DPenColourAlpha(ColourRGBA fore) noexcept {
+	FlushFillBatch();
+	SetBrushColour(fore);
 }
 
 void SurfaceD2D::SetFont(const Font *font_) noexcept {
@@ -1669,26 +1901,12 @@ int SurfaceD2D::DeviceHeightFont(int points) const noexcept {
 void SurfaceD2D::LineDraw(Point start, Point end, Stroke stroke) {
 	D2DPenColourAlpha(stroke.colour);
 
-	D2D1_STROKE_STYLE_PROPERTIES strokeProps {};
-	strokeProps.startCap = D2D1_CAP_STYLE_SQUARE;
-	strokeProps.endCap = D2D1_CAP_STYLE_SQUARE;
-	strokeProps.dashCap = D2D1_CAP_STYLE_FLAT;
-	strokeProps.lineJoin = D2D1_LINE_JOIN_MITER;
-	strokeProps.miterLimit = 4.0f;
-	strokeProps.dashStyle = D2D1_DASH_STYLE_SOLID;
-	strokeProps.dashOffset = 0;
-
-	// get the stroke style to apply
-	ID2D1StrokeStyle *pStrokeStyle = nullptr;
-	const HRESULT hr = pD2DFactory->CreateStrokeStyle(
-		strokeProps, nullptr, 0, &pStrokeStyle);
-	if (SUCCEEDED(hr)) {
+	ID2D1StrokeStyle *pStrokeStyle = SolidStrokeStyle(D2D1_CAP_STYLE_SQUARE);
+	if (pStrokeStyle) {
 		pRenderTarget->DrawLine(
 			DPointFromPointEx(start),
 			DPointFromPointEx(end), pBrush, stroke.WidthF(), pStrokeStyle);
 	}
-
-	ReleaseUnknown(pStrokeStyle);
 }
 
 ID2D1PathGeometry *SurfaceD2D::Geometry(const Point *pts, size_t npts, D2D1_FIGURE_BEGIN figureBegin) noexcept {
@@ -1711,37 +1929,58 @@ ID2D1PathGeometry *SurfaceD2D::Geometry(const Point *pts, size_t npts, D2D1_FIGU
 	return geometry;
 }
 
+ID2D1PathGeometry *SurfaceD2D::CachedPolyLineGeometry(const Point *pts, size_t npts) {
+	const Point origin = pts[0];
+	for (const auto &entry : polyLineGeometryCache) {
+		if (entry.geometry && entry.shape.size() == npts) {
+			size_t i = 1;
+			while (i < npts && entry.shape[i] == Point(pts[i].x - origin.x, pts[i].y - origin.y)) {
+				i++;
+			}
+			if (i == npts) {
+				return entry.geometry;
+			}
+		}
+	}
+
+	PolyLineGeometry &entry = polyLineGeometryCache[polyLineGeometryNext];
+	polyLineGeometryNext = (polyLineGeometryNext + 1) % PolyLineGeometryCacheSize;
+	ReleaseUnknown(entry.geometry);
+	entry.shape.resize(npts);
+	for (size_t i = 0; i < npts; i++) {
+		entry.shape[i] = Point(pts[i].x - origin.x, pts[i].y - origin.y);
+	}
+	entry.geometry = Geometry(entry.shape.data(), npts, D2D1_FIGURE_BEGIN_HOLLOW);
+	return entry.geometry;
+}
+
 void SurfaceD2D::PolyLine(const Point *pts, size_t npts, Stroke stroke) {
 	PLATFORM_ASSERT(pRenderTarget && (npts > 1));
 	if (!pRenderTarget || (npts <= 1)) {
 		return;
 	}
 
-	ID2D1PathGeometry *geometry = Geometry(pts, npts, D2D1_FIGURE_BEGIN_HOLLOW);
+	// owned by the cache
+	ID2D1PathGeometry *geometry = CachedPolyLineGeometry(pts, npts);
 	PLATFORM_ASSERT(geometry);
 	if (!geometry) {
 		return;
 	}
 
 	D2DPenColourAlpha(stroke.colour);
-	D2D1_STROKE_STYLE_PROPERTIES strokeProps {};
-	strokeProps.startCap = D2D1_CAP_STYLE_ROUND;
-	strokeProps.endCap = D2D1_CAP_STYLE_ROUND;
-	strokeProps.dashCap = D2D1_CAP_STYLE_FLAT;
-	strokeProps.lineJoin = D2D1_LINE_JOIN_MITER;
-	strokeProps.miterLimit = 4.0f;
-	strokeProps.dashStyle = D2D1_DASH_STYLE_SOLID;
-	strokeProps.dashOffset = 0;
-
-	// get the stroke style to apply
-	ID2D1StrokeStyle *pStrokeStyle = nullptr;
-	const HRESULT hr = pD2DFactory->CreateStrokeStyle(
-		strokeProps, nullptr, 0, &pStrokeStyle);
-	if (SUCCEEDED(hr)) {
+	ID2D1StrokeStyle *pStrokeStyle = SolidStrokeStyle(D2D1_CAP_STYLE_ROUND);
+	if (pStrokeStyle) {
+		// geometry starts at (0, 0), translate it to first point
+		D2D1_MATRIX_3X2_F transform;
+		pRenderTarget->GetTransform(&transform);
+		const D2D1_POINT_2F origin = DPointFromPointEx(pts[0]);
+		D2D1_MATRIX_3X2_F translated = transform;
+		translated._31 += origin.x * transform._11 + origin.y * transform._21;
+		translated._32 += origin.x * transform._12 + origin.y * transform._22;
+		pRenderTarget->SetTransform(&translated);
 		pRenderTarget->DrawGeometry(geometry, pBrush, stroke.WidthF(), pStrokeStyle);
+		pRenderTarget->SetTransform(&transform);
 	}
-	ReleaseUnknown(pStrokeStyle);
-	ReleaseUnknown(geometry);
 }
 
 void SurfaceD2D::Polygon(const Point *pts, size_t npts, FillStroke fillStroke) {
@@ -1784,8 +2023,17 @@ void SurfaceD2D::RectangleFrame(PRectangle rc, Stroke stroke) {
 
 void SurfaceD2D::FillRectangle(PRectangle rc, Fill fill) {
 	if (pRenderTarget) {
-		D2DPenColourAlpha(fill.colour);
 		const D2D1_RECT_F rectangle = RectangleFromPRectangleEx(rc);
+		if (fill.colour.IsOpaque()) {
+			// defer to draw adjacent rectangles with same colour at once
+			if (!fillBatch.empty() && (!(fill.colour == fillBatchColour) || fillBatch.size() == FillBatchMaxCount)) {
+				FlushFillBatch();
+			}
+			fillBatchColour = fill.colour;
+			fillBatch.push_back(rectangle);
+			return;
+		}
+		D2DPenColourAlpha(fill.colour);
 		pRenderTarget->FillRectangle(&rectangle, pBrush);
 	}
 }
@@ -1797,6 +2045,7 @@ void SurfaceD2D::FillRectangleAligned(PRectangle rc, Fill fill) {
 void SurfaceD2D::FillRectangle(PRectangle rc, Surface &surfacePattern) {
 	SurfaceD2D *psurfOther = down_cast<SurfaceD2D *>(&surfacePattern);
 	PLATFORM_ASSERT(psurfOther);
+	FlushFillBatch();
 	ID2D1Bitmap *pBitmap = nullptr;
 	HRESULT hr = psurfOther->GetBitmap(&pBitmap);
 	if (SUCCEEDED(hr) && pBitmap) {
@@ -1859,6 +2108,7 @@ void SurfaceD2D::AlphaRectangle(PRectangle rc, XYPOSITION cornerSize, FillStroke
 
 void SurfaceD2D::GradientRectangle(PRectangle rc, const std::vector<ColourStop> &stops, GradientOptions options) {
 	if (pRenderTarget) {
+		FlushFillBatch();
 		D2D1_LINEAR_GRADIENT_BRUSH_PROPERTIES lgbp {
 			DPointFromPoint(Point(rc.left, rc.top)), {}
 		};
@@ -1897,6 +2147,7 @@ void SurfaceD2D::GradientRectangle(PRectangle rc, const std::vector<ColourStop>
 
 void SurfaceD2D::DrawRGBAImage(PRectangle rc, int width, int height, const unsigned char *pixelsImage) {
 	if (pRenderTarget) {
+		FlushFillBatch();
 		if (rc.Width() > width)
 			rc.left += std::floor((rc.Width() - width) / 2);
 		rc.right = rc.left + width;
@@ -2037,6 +2288,7 @@ void SurfaceD2D::Stadium(PRectangle rc, FillStroke fillStroke, Ends ends) {
 
 void SurfaceD2D::Copy(PRectangle rc, Point from, Surface &surfaceSource) {
 	SurfaceD2D &surfOther = down_cast<SurfaceD2D &>(surfaceSource);
+	FlushFillBatch();
 	ID2D1Bitmap *pBitmap = nullptr;
 	const HRESULT hr = surfOther.GetBitmap(&pBitmap);
 	if (SUCCEEDED(hr) && pBitmap) {
@@ -2447,6 +2699,7 @@ std::unique_ptr<IScreenLineLayout> SurfaceD2D::Layout(const IScreenLine *screenL
 
 void SurfaceD2D::DrawTextCommon(PRectangle rc, const Font *font_, XYPOSITION ybase, std::string_view text, int codePageOverride, UINT fuOptions) {
 	SetFont(font_);
+	const FontDirectWrite *pfm = down_cast<const FontDirectWrite *>(font_);
 
 	// Use Unicode calls
 	const int codePageDraw = codePageOverride ? codePageOverride : mode.codePage;
@@ -2457,17 +2710,25 @@ void SurfaceD2D::DrawTextCommon(PRectangle rc, const Font *font_, XYPOSITION yba
 			pRenderTarget->PushAxisAlignedClip(rcClip, D2D1_ANTIALIAS_MODE_ALIASED);
 		}
 
-		// Explicitly creating a text layout appears a little faster
-		IDWriteTextLayout *pTextLayout = nullptr;
-		const HRESULT hr = pIDWriteFactory->CreateTextLayout(tbuf.buffer, tbuf.tlen,
-			pTextFormat,
-			static_cast<FLOAT>(rc.Width()),
-			static_cast<FLOAT>(rc.Height()),
-			&pTextLayout);
-		if (SUCCEEDED(hr)) {
-			const D2D1_POINT_2F origin = DPointFromPoint(Point(rc.left, ybase - yAscent));
-			pRenderTarget->DrawTextLayout(origin, pTextLayout, pBrush, d2dDrawTextOptions);
-			ReleaseUnknown(pTextLayout);
+		const D2D1_POINT_2F origin = DPointFromPoint(Point(rc.left, ybase - yAscent));
+		if (static_cast<size_t>(tbuf.tlen) <= TextLayoutCache::maxLength) {
+			// reuse text layout when redrawing same text
+			IDWriteTextLayout *pTextLayout = pfm->layoutCache.Get(pTextFormat, std::wstring_view(tbuf.buffer, tbuf.tlen));
+			if (pTextLayout) {
+				pRenderTarget->DrawTextLayout(origin, pTextLayout, pBrush, d2dDrawTextOptions);
+			}
+		} else {
+			// Explicitly creating a text layout appears a little faster
+			IDWriteTextLayout *pTextLayout = nullptr;
+			const HRESULT hr = pIDWriteFactory->CreateTextLayout(tbuf.buffer, tbuf.tlen,
+				pTextFormat,
+				static_cast<FLOAT>(rc.Width()),
+				static_cast<FLOAT>(rc.Height()),
+				&pTextLayout);
+			if (SUCCEEDED(hr)) {
+				pRenderTarget->DrawTextLayout(origin, pTextLayout, pBrush, d2dDrawTextOptions);
+				ReleaseUnknown(pTextLayout);
+			}
 		}
 
 		if (fuOptions & ETO_CLIPPED) {
@@ -2753,6 +3014,7 @@ XYPOSITION SurfaceD2D::AverageCharWidth(const Font *font_) {
 
 void SurfaceD2D::SetClip(PRectangle rc) noexcept {
 	if (pRenderTarget) {
+		FlushFillBatch();
 		const D2D1_RECT_F rcClip = RectangleFromPRectangle(rc);
 		pRenderTarget->PushAxisAlignedClip(rcClip, D2D1_ANTIALIAS_MODE_ALIASED);
 		clipsActive++;
@@ -2762,15 +3024,18 @@ void SurfaceD2D::SetClip(PRectangle rc) noexcept {
 void SurfaceD2D::PopClip() noexcept {
 	if (pRenderTarget) {
 		PLATFORM_ASSERT(clipsActive > 0);
+		FlushFillBatch();
 		pRenderTarget->PopAxisAlignedClip();
 		clipsActive--;
 	}
 }
 
 void SurfaceD2D::FlushCachedState() noexcept {
+	FlushFillBatch();
 }
 
 void SurfaceD2D::FlushDrawing() noexcept {
+	FlushFillBatch();
 	if (pRenderTarget) {
 		pRenderTarget->Flush();
 	}
@@ -3016,6 +3281,10 @@ public:
 		data.push_back(lid);
 	}
 
+	void Reserve(size_t count) {
+		data.reserve(count);
+	}
+
 	char *SetWords(const char *s, size_t length) {
 		words = std::vector<char>(s, s + length + 1);
 		return words.data();
@@ -3267,12 +3536,11 @@ std::string ListBoxX::GetValue(int n) const {
 }
 
 void ListBoxX::RegisterImage(int type, const char *xpm_data) {
-	XPM xpmImage(xpm_data);
-	images.AddImage(type, std::make_unique<RGBAImage>(xpmImage));
+	images.AddImage(type, SharedRGBAImage(xpm_data));
 }
 
 void ListBoxX::RegisterRGBAImage(int type, int width, int height, const unsigned char *pixelsImage) {
-	images.AddImage(type, std::make_unique<RGBAImage>(width, height, 1.0f, pixelsImage));
+	images.AddImage(type, SharedRGBAImage(width, height, 1.0f, pixelsImage));
 }
 
 void ListBoxX::ClearRegisteredImages() noexcept {
@@ -3407,6 +3675,7 @@ void ListBoxX::SetList(const char *list, const char separator, const char typese
 	Clear();
 	const size_t size = strlen(list);
 	char *words = lti.SetWords(list, size);
+	lti.Reserve(std::count(words, words + size, separator) + 1);
 	char *startword = words;
 	char *numword = nullptr;
 	for (size_t i = 0; i < size; i++) {
@@ -3427,12 +3696,10 @@ void ListBoxX::SetList(const char *list, const char separator, const char typese
 		AppendListItem(startword, numword);
 	}
 
-	// Finally populate the listbox itself with the correct number of items
+	// Finally set item count of the listbox, it has no data (LBS_NODATA) and only
+	// visible items are drawn from lti, so a long list doesn't add each item.
 	const int count = lti.Count();
-	::SendMessage(lb, LB_INITSTORAGE, count, 0);
-	for (intptr_t j = 0; j < count; j++) {
-		ListBox_AddItemData(lb, j + 1);
-	}
+	::SendMessage(lb, LB_SETCOUNT, count, 0);
 	SetRedraw(true);
 }
 
@@ -4085,10 +4352,14 @@ void Platform_Initialise(void *hInstance) noexcept {
 }
 
 void Platform_Finalise(bool fromDllMain) noexcept {
+	if (!fromDllMain) {
+		fontCache.clear();
+	}
 #if defined(USE_D2D)
 	if (!fromDllMain) {
 		ReleaseUnknown(defaultRenderingParams);
 		ReleaseUnknown(customClearTypeRenderingParams);
+		ReleaseD2DSharedResources();
 		ReleaseUnknown(gdiInterop);
 		ReleaseUnknown(pIDWriteFactory);
 		ReleaseUnknown(pD2DFactory);
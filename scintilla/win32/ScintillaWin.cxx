@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <cstdint>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -62,6 +63,7 @@ Used by VSCode, Atom etc.
 #include "Geometry.h"
 #include "Platform.h"
 #include "VectorISA.h"
+#include "TraceEvents.h"
 
 //#include "CharacterCategory.h"
 #include "Position.h"
@@ -107,6 +109,9 @@ Used by VSCode, Atom etc.
 #ifndef SPI_GETWHEELSCROLLCHARS
 #define SPI_GETWHEELSCROLLCHARS		0x006C
 #endif
+#ifndef SPI_GETCARETTIMEOUT
+#define SPI_GETCARETTIMEOUT			0x2022
+#endif
 
 using namespace Scintilla;
 using namespace Scintilla::Internal;
@@ -278,6 +283,54 @@ public:
 	STDMETHODIMP Drop(LPDATAOBJECT pIDataSource, DWORD grfKeyState, POINTL pt, PDWORD pdwEffect) override;
 };
 
+/**
+ * Read only stream over dragged text, converted to UTF-16 chunk by chunk when it's read.
+ */
+class TextStream final : public IStream {
+	ULONG ref = 1;
+	const char *data;
+	size_t length;			// including NUL terminator
+	UINT codePage;
+	bool dbcs;
+	std::string owned;		// copy of text when the stream outlives the drag
+	size_t dataPos = 0;
+	ULONGLONG position = 0;	// in bytes of UTF-16 text
+	ULONGLONG size = 0;
+	bool sizeKnown = false;
+	std::wstring buffer;
+	size_t bufferPos = 0;	// in bytes
+
+	size_t ChunkEnd(size_t start) const noexcept;
+	void Convert();
+	void Rewind() noexcept;
+	ULONGLONG TotalSize() noexcept;
+
+public:
+	explicit TextStream(const SelectionText &text) noexcept;
+	virtual ~TextStream() = default;
+	void Detach() noexcept;
+
+	// IUnknown
+	STDMETHODIMP QueryInterface(REFIID riid, PVOID *ppv) noexcept override;
+	STDMETHODIMP_(ULONG)AddRef() noexcept override;
+	STDMETHODIMP_(ULONG)Release() noexcept override;
+
+	// ISequentialStream
+	STDMETHODIMP Read(void *pv, ULONG cb, ULONG *pcbRead) noexcept override;
+	STDMETHODIMP Write(const void *, ULONG, ULONG *) noexcept override;
+
+	// IStream
+	STDMETHODIMP Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER *plibNewPosition) noexcept override;
+	STDMETHODIMP SetSize(ULARGE_INTEGER) noexcept override;
+	STDMETHODIMP CopyTo(IStream *pstm, ULARGE_INTEGER cb, ULARGE_INTEGER *pcbRead, ULARGE_INTEGER *pcbWritten) noexcept override;
+	STDMETHODIMP Commit(DWORD) noexcept override;
+	STDMETHODIMP Revert() noexcept override;
+	STDMETHODIMP LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) noexcept override;
+	STDMETHODIMP UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) noexcept override;
+	STDMETHODIMP Stat(STATSTG *pstatstg, DWORD) noexcept override;
+	STDMETHODIMP Clone(IStream **ppstm) noexcept override;
+};
+
 // InputLanguage() and SetCandidateWindowPos() are based on Chromium's IMM32Manager and InputMethodWinImm32.
 // https://github.com/chromium/chromium/blob/master/ui/base/ime/win/imm32_manager.cc
 // See License.txt or https://github.com/chromium/chromium/blob/master/LICENSE for license details.
@@ -413,6 +466,10 @@ class ScintillaWin final :
 	UINT cfBorlandIDEBlockType;
 	UINT cfLineSelect;
 	UINT cfVSLineTag;
+	// large selection copied with delayed rendering, converted on WM_RENDERFORMAT
+	std::unique_ptr<SelectionText> delayedClipboardText;
+	// streams handed out for large drag, detached from drag text after DoDragDrop
+	std::vector<TextStream *> dragStreams;
 
 #if EnableDrop_VisualStudioProjectItem
 	CLIPFORMAT cfVSStgProjectItem;
@@ -441,6 +498,8 @@ class ScintillaWin final :
 #if defined(USE_D2D)
 	ID2D1RenderTarget *pRenderTarget;
 	bool renderTargetValid;
+	// vertical offset to copy retained content by on next paint
+	int scrollPendingY;
 #endif
 
 	explicit ScintillaWin(HWND hwnd) noexcept;
@@ -449,6 +508,7 @@ class ScintillaWin final :
 	void Finalise() noexcept override;
 #if defined(USE_D2D)
 	void EnsureRenderTarget(HDC hdc) noexcept;
+	bool ScrollRenderTarget(int dy) noexcept;
 #endif
 	void DropRenderTarget() noexcept;
 	HWND MainHWND() const noexcept;
@@ -515,7 +575,7 @@ class ScintillaWin final :
 	void IdleWork() override;
 	void QueueIdleWork(WorkItems items, Sci::Position upTo) noexcept override;
 	bool SetIdle(bool on) noexcept override;
-	UINT_PTR timers[static_cast<int>(TickReason::dwell) + 1]{};
+	UINT_PTR timers[static_cast<int>(TickReason::zoom) + 1]{};
 	bool FineTickerRunning(TickReason reason) noexcept override;
 	void FineTickerStart(TickReason reason, int millis, int tolerance) noexcept override;
 	void FineTickerCancel(TickReason reason) noexcept override;
@@ -557,6 +617,11 @@ class ScintillaWin final :
 	void GetIntelliMouseParameters() noexcept;
 	void CopyToGlobal(GlobalMemory &gmUnicode, const SelectionText &selectedText, CopyEncoding encoding);
 	void CopyToClipboard(const SelectionText &selectedText) override;
+	void SetClipboardShape(const SelectionText &selectedText) noexcept;
+	void DelayCopyToClipboard(std::unique_ptr<SelectionText> selectedText);
+	void RenderClipboardText();
+	void PasteInChunks(std::wstring_view wsv);
+	bool DropStream(IStream *stream, SelectionPosition position, bool moving, bool rectangular);
 	void ScrollMessage(WPARAM wParam);
 	void HorizontalScrollMessage(WPARAM wParam);
 	void FullPaint();
@@ -709,11 +774,17 @@ ScintillaWin::ScintillaWin(HWND hwnd) noexcept {
 #if defined(USE_D2D)
 	pRenderTarget = nullptr;
 	renderTargetValid = true;
+	scrollPendingY = 0;
 #endif
 
 	caret.period = ::GetCaretBlinkTime();
 	if (caret.period < 0)
 		caret.period = 0;
+	// system stops blinking after caret timeout since Windows 10
+	DWORD caretTimeout = 0;
+	if (::SystemParametersInfo(SPI_GETCARETTIMEOUT, 0, &caretTimeout, 0)) {
+		caret.timeout = static_cast<int>(caretTimeout);
+	}
 
 	// Initialize COM.  If the app has already done this it will have
 	// no effect.  If the app hasn't, we really shouldn't ask them to call
@@ -740,7 +811,7 @@ ScintillaWin::~ScintillaWin() {
 
 void ScintillaWin::Finalise() noexcept {
 	ScintillaBase::Finalise();
-	for (TickReason tr = TickReason::caret; tr <= TickReason::dwell;
+	for (TickReason tr = TickReason::caret; tr <= TickReason::zoom;
 		tr = static_cast<TickReason>(static_cast<int>(tr) + 1)) {
 		FineTickerCancel(tr);
 	}
@@ -870,6 +941,11 @@ void ScintillaWin::StartDrag() {
 			ClearSelection();
 		}
 	}
+	for (TextStream *stream : dragStreams) {
+		stream->Detach();
+		stream->Release();
+	}
+	dragStreams.clear();
 	inDragDrop = DragDrop::none;
 	SetDragPosition(SelectionPosition(Sci::invalidPosition));
 }
@@ -1048,11 +1124,21 @@ bool ScintillaWin::PaintDC(HDC hdc) {
 		}
 	} else {
 #if defined(USE_D2D)
+		// content of new render target is empty
+		const bool contentRetained = pRenderTarget && renderTargetValid;
 		EnsureRenderTarget(hdc);
 		if (pRenderTarget) {
 			AutoSurface surfaceWindow(pRenderTarget, this);
 			if (surfaceWindow) {
 				pRenderTarget->BeginDraw();
+				if (scrollPendingY != 0) {
+					if (!paintingAllText && !(contentRetained && ScrollRenderTarget(scrollPendingY))) {
+						// content not copied
+						rcPaint = GetClientRectangle();
+						paintingAllText = true;
+					}
+					scrollPendingY = 0;
+				}
 				Paint(surfaceWindow, rcPaint);
 				surfaceWindow->Release();
 				const HRESULT hr = pRenderTarget->EndDraw();
@@ -2304,6 +2390,26 @@ sptr_t ScintillaWin::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		case WM_SETFOCUS:
 			return FocusMessage(msg, wParam, lParam);
 
+		case WM_RENDERFORMAT:
+			// clipboard is opened by the requester
+			if (wParam == CF_UNICODETEXT) {
+				RenderClipboardText();
+			}
+			break;
+
+		case WM_RENDERALLFORMATS:
+			if (delayedClipboardText && ::OpenClipboardRetry(MainHWND())) {
+				if (::GetClipboardOwner() == MainHWND()) {
+					RenderClipboardText();
+				}
+				::CloseClipboard();
+			}
+			break;
+
+		case WM_DESTROYCLIPBOARD:
+			delayedClipboardText.reset();
+			break;
+
 		case WM_SYSCOLORCHANGE:
 			//Platform::DebugPrintf("Setting Changed\n");
 			UpdateBaseElements();
@@ -2577,15 +2683,65 @@ bool ScintillaWin::PaintContains(PRectangle rc) const noexcept {
 	return true;
 }
 
-void ScintillaWin::ScrollText(Sci::Line /* linesToMove */) {
+// Reuse rendered content when nothing else is waiting to be painted, so only exposed lines are laid out and painted.
+void ScintillaWin::ScrollText(Sci::Line linesToMove) {
 	//Platform::DebugPrintf("ScintillaWin::ScrollText %d\n", linesToMove);
-	//::ScrollWindow(MainHWND(), 0,
-	//	vs.lineHeight * linesToMove, 0, 0);
-	//::UpdateWindow(MainHWND());
-	Redraw();
+	const PRectangle rcClient = GetClientRectangle();
+	const int dy = static_cast<int>(vs.lineHeight * linesToMove);
+	RECT rcUpdate;
+	if (std::abs(dy) >= rcClient.Height() || ::GetUpdateRect(MainHWND(), &rcUpdate, FALSE)) {
+#if defined(USE_D2D)
+		scrollPendingY = 0;
+#endif
+		Redraw();
+	} else if ((technology == Technology::Default) || (technology == Technology::DirectWriteDC)) {
+		// painting with DC render target is clipped to the update region
+		const RECT rcScroll = RectFromPRectangle(rcClient);
+		::ScrollWindowEx(MainHWND(), 0, dy, &rcScroll, &rcScroll, nullptr, nullptr, SW_INVALIDATE);
+		::UpdateWindow(MainHWND());
+#if defined(USE_D2D)
+	} else if (technology == Technology::DirectWriteRetain && pRenderTarget) {
+		// copied inside render target on next paint
+		scrollPendingY = dy;
+		PRectangle rcExposed = rcClient;
+		if (dy > 0) {
+			rcExposed.bottom = rcExposed.top + dy;
+		} else {
+			rcExposed.top = rcExposed.bottom + dy;
+		}
+		RedrawRect(rcExposed);
+		::UpdateWindow(MainHWND());
+#endif
+	} else {
+		// content of other render targets is not retained after presenting
+		Redraw();
+	}
 	UpdateSystemCaret();
 }
 
+#if defined(USE_D2D)
+bool ScintillaWin::ScrollRenderTarget(int dy) noexcept {
+	const D2D1_SIZE_U size = pRenderTarget->GetPixelSize();
+	const UINT32 height = size.height - static_cast<UINT32>(std::abs(dy));
+	const D2D1_BITMAP_PROPERTIES properties = D2D1::BitmapProperties(pRenderTarget->GetPixelFormat());
+	ID2D1Bitmap *bitmap = nullptr;
+	HRESULT hr = pRenderTarget->CreateBitmap(D2D1::SizeU(size.width, height), properties, &bitmap);
+	if (SUCCEEDED(hr)) {
+		const UINT32 top = (dy > 0) ? 0 : static_cast<UINT32>(-dy);
+		const D2D1_POINT_2U origin = D2D1::Point2U(0, 0);
+		const D2D1_RECT_U rcSource = D2D1::RectU(0, top, size.width, top + height);
+		hr = bitmap->CopyFromRenderTarget(&origin, pRenderTarget, &rcSource);
+		if (SUCCEEDED(hr)) {
+			const FLOAT y = static_cast<FLOAT>(std::max(dy, 0));
+			const D2D1_RECT_F rcDest = D2D1::RectF(0, y, static_cast<FLOAT>(size.width), y + height);
+			pRenderTarget->DrawBitmap(bitmap, rcDest, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+		}
+		ReleaseUnknown(bitmap);
+	}
+	return SUCCEEDED(hr);
+}
+#endif
+
 void ScintillaWin::NotifyCaretMove() noexcept {
 	NotifyWinEvent(EVENT_OBJECT_LOCATIONCHANGE, MainHWND(), OBJID_CARET, CHILDID_SELF);
 }
@@ -2867,13 +3023,26 @@ std::string ScintillaWin::CaseMapString(const std::string &s, CaseMapping caseMa
 	return sConverted;
 }
 
+namespace {
+
+// selection larger than this is converted to UTF-16 only when clipboard data is requested.
+constexpr size_t delayedClipboardMinSize = 8*1024*1024;
+// clipboard text larger than this is converted and inserted chunk by chunk.
+constexpr size_t pasteChunkSize = 1024*1024;
+
+}
+
 void ScintillaWin::Copy(bool asBinary) {
 	//Platform::DebugPrintf("Copy\n");
 	if (!sel.Empty()) {
-		SelectionText selectedText;
-		selectedText.asBinary = asBinary;
-		CopySelectionRange(&selectedText);
-		CopyToClipboard(selectedText);
+		std::unique_ptr<SelectionText> selectedText = std::make_unique<SelectionText>();
+		selectedText->asBinary = asBinary;
+		CopySelectionRange(selectedText.get());
+		if (!asBinary && selectedText->Length() >= delayedClipboardMinSize) {
+			DelayCopyToClipboard(std::move(selectedText));
+		} else {
+			CopyToClipboard(*selectedText);
+		}
 	}
 }
 
@@ -2945,18 +3114,61 @@ bool OpenClipboardRetry(HWND hwnd) noexcept {
 	return false;
 }
 
-inline bool IsValidFormatEtc(const FORMATETC *pFE) noexcept {
+inline bool IsValidFormatEtc(const FORMATETC *pFE, DWORD tymed = TYMED_HGLOBAL) noexcept {
 	return pFE->ptd == nullptr
 		&& (pFE->dwAspect & DVASPECT_CONTENT) != 0
 		&& pFE->lindex == -1
-		&& (pFE->tymed & TYMED_HGLOBAL) != 0;
+		&& (pFE->tymed & tymed) != 0;
+}
+
+constexpr DWORD TextMediumType(CLIPFORMAT fmt) noexcept {
+	return (fmt == CF_UNICODETEXT) ? (TYMED_HGLOBAL | TYMED_ISTREAM) : TYMED_HGLOBAL;
 }
 
 inline bool SupportedFormat(const FORMATETC *pFE) noexcept {
 	return (pFE->cfFormat == CF_UNICODETEXT || pFE->cfFormat == CF_TEXT)
-		&& IsValidFormatEtc(pFE);
+		&& IsValidFormatEtc(pFE, TextMediumType(pFE->cfFormat));
 }
 
+// Reads dropped UTF-16 text from a stream in chunks, a chunk doesn't end with
+// high surrogate or CR, reading stops at NUL terminator.
+class DropStreamReader {
+	IStream *stream;
+	std::wstring buffer;
+	size_t consumed = 0;	// in bytes
+	size_t carry = 0;		// in bytes
+	bool finished = false;
+public:
+	explicit DropStreamReader(IStream *stream_) : stream{stream_}, buffer(pasteChunkSize, L'\0') {}
+	bool Next(std::wstring_view &chunk) noexcept {
+		if (finished) {
+			return false;
+		}
+		char *bytes = reinterpret_cast<char *>(buffer.data());
+		if (consumed != 0) {
+			memmove(bytes, bytes + consumed, carry);
+		}
+		ULONG cbRead = 0;
+		const HRESULT hr = stream->Read(bytes + carry, static_cast<ULONG>(buffer.length()*sizeof(wchar_t) - carry), &cbRead);
+		finished = FAILED(hr) || cbRead == 0;
+		const size_t available = carry + cbRead;
+		std::wstring_view wsv(buffer.data(), available / sizeof(wchar_t));
+		const size_t nul = wsv.find(L'\0');
+		if (nul != std::wstring_view::npos) {
+			wsv = wsv.substr(0, nul);
+			finished = true;
+		}
+		if (!finished && !wsv.empty() && (IS_HIGH_SURROGATE(wsv.back()) || wsv.back() == L'\r')) {
+			// keep surrogate pair and CR+LF in same chunk
+			wsv.remove_suffix(1);
+		}
+		consumed = wsv.length()*sizeof(wchar_t);
+		carry = available - consumed;
+		chunk = wsv;
+		return true;
+	}
+};
+
 }
 
 void ScintillaWin::Paste(bool asBinary) {
@@ -2994,14 +3206,87 @@ void ScintillaWin::Paste(bool asBinary) {
 	// Use CF_UNICODETEXT if available
 	GlobalMemory memUSelection(::GetClipboardData(CF_UNICODETEXT));
 	if (const wchar_t *uptr = static_cast<const wchar_t *>(memUSelection.ptr)) {
-		const std::string putf = EncodeWString(uptr);
-		InsertPasteShape(putf.c_str(), putf.length(), pasteShape);
+		const std::wstring_view wsv(uptr);
+		if (pasteShape == PasteShape::stream && wsv.length() > pasteChunkSize
+			&& (multiPasteMode == MultiPaste::Once || sel.Count() == 1)) {
+			PasteInChunks(wsv);
+		} else {
+			const std::string putf = EncodeWString(wsv);
+			InsertPasteShape(putf.c_str(), putf.length(), pasteShape);
+		}
 		memUSelection.Unlock();
 	}
 	::CloseClipboard();
 	Redraw();
 }
 
+// insert huge clipboard text at selection start without converting whole text at once.
+void ScintillaWin::PasteInChunks(std::wstring_view wsv) {
+	const SelectionPosition selStart = RealizeVirtualSpace(sel.Start());
+	const Sci::Position startPos = selStart.Position();
+	Sci::Position position = startPos;
+	size_t start = 0;
+	while (start < wsv.length()) {
+		size_t end = std::min(start + pasteChunkSize, wsv.length());
+		if (end < wsv.length() && (IS_HIGH_SURROGATE(wsv[end - 1]) || wsv[end - 1] == L'\r')) {
+			// keep surrogate pair and CR+LF in same chunk
+			--end;
+		}
+		std::string chunk = EncodeWString(wsv.substr(start, end - start));
+		if (convertPastes) {
+			chunk = Document::TransformLineEnds(chunk.c_str(), chunk.length(), pdoc->eolMode);
+		}
+		position += pdoc->InsertString(position, chunk.c_str(), chunk.length());
+		start = end;
+	}
+	if (position != startPos) {
+		SetEmptySelection(position);
+	}
+}
+
+// Large dropped text is inserted chunk by chunk as it's read from the stream.
+bool ScintillaWin::DropStream(IStream *stream, SelectionPosition position, bool moving, bool rectangular) {
+	DropStreamReader reader(stream);
+	std::wstring_view wsv;
+	if (rectangular) {
+		std::string putf;
+		while (reader.Next(wsv)) {
+			putf += EncodeWString(wsv);
+		}
+		if (putf.empty()) {
+			return false;
+		}
+		DropAt(position, putf.c_str(), putf.size(), moving, true);
+		return true;
+	}
+
+	bool more = reader.Next(wsv);
+	while (more && wsv.empty()) {
+		more = reader.Next(wsv);
+	}
+	if (!more) {
+		return false;
+	}
+
+	UndoGroup ug(pdoc);
+	if (!PrepareDrop(position, moving, false)) {
+		return true;
+	}
+	const Sci::Position startPos = position.Position();
+	Sci::Position pos = startPos;
+	do {
+		if (!wsv.empty()) {
+			const std::string chunk = EncodeWString(wsv);
+			const std::string convertedText = Document::TransformLineEnds(chunk.c_str(), chunk.length(), pdoc->eolMode);
+			pos += pdoc->InsertString(pos, convertedText.c_str(), convertedText.length());
+		}
+	} while (reader.Next(wsv));
+	if (pos != startPos) {
+		SetSelection(SelectionPosition(pos), position);
+	}
+	return true;
+}
+
 void ScintillaWin::CreateCallTipWindow(PRectangle) noexcept {
 	if (!ct.wCallTip.Created()) {
 		HWND wnd = ::CreateWindow(callClassName, L"ACallTip",
@@ -3062,7 +3347,7 @@ STDMETHODIMP FormatEnumerator::Next(ULONG celt, FORMATETC *rgelt, ULONG *pceltFe
 		rgelt->ptd = nullptr;
 		rgelt->dwAspect = DVASPECT_CONTENT;
 		rgelt->lindex = -1;
-		rgelt->tymed = TYMED_HGLOBAL;
+		rgelt->tymed = TextMediumType(formats[pos]);
 		rgelt++;
 		pos++;
 		putPos++;
@@ -3224,6 +3509,250 @@ STDMETHODIMP DropTarget::Drop(LPDATAOBJECT pIDataSource, DWORD grfKeyState, POIN
 	return sci->Drop(pIDataSource, grfKeyState, pt, pdwEffect);
 }
 
+TextStream::TextStream(const SelectionText &text) noexcept :
+	data{text.Data()}, length{text.LengthWithTerminator()}, codePage{static_cast<UINT>(text.codePage)} {
+	CPINFO cpInfo;
+	dbcs = codePage != CP_UTF8 && ::GetCPInfo(codePage, &cpInfo) && cpInfo.MaxCharSize > 1;
+}
+
+// Chunk ends at character boundary, so each chunk can be converted separately.
+size_t TextStream::ChunkEnd(size_t start) const noexcept {
+	size_t end = start + pasteChunkSize;
+	if (end >= length) {
+		return length;
+	}
+	if (codePage == CP_UTF8) {
+		const size_t minEnd = end - (UTF8MaxBytes - 1);
+		while (end > minEnd && UTF8IsTrailByte(data[end])) {
+			--end;
+		}
+	} else if (dbcs) {
+		size_t pos = start;
+		while (true) {
+			const size_t next = pos + (::IsDBCSLeadByteEx(codePage, data[pos]) ? 2 : 1);
+			if (next > end) {
+				break;
+			}
+			pos = next;
+		}
+		end = pos;
+	}
+	return end;
+}
+
+void TextStream::Convert() {
+	const size_t end = ChunkEnd(dataPos);
+	buffer = StringDecode(std::string_view(data + dataPos, end - dataPos), codePage);
+	bufferPos = 0;
+	dataPos = end;
+}
+
+void TextStream::Rewind() noexcept {
+	dataPos = 0;
+	position = 0;
+	buffer.clear();
+	bufferPos = 0;
+}
+
+ULONGLONG TextStream::TotalSize() noexcept {
+	if (!sizeKnown) {
+		size = 0;
+		size_t start = 0;
+		while (start < length) {
+			const size_t end = ChunkEnd(start);
+			size += WideCharLenFromMultiByte(codePage, std::string_view(data + start, end - start)) * sizeof(wchar_t);
+			start = end;
+		}
+		sizeKnown = true;
+	}
+	return size;
+}
+
+// Called after drag finished, copy the text if drop target still holds the stream.
+void TextStream::Detach() noexcept {
+	if (ref > 1 && data != owned.data()) {
+		try {
+			owned.assign(data, length);
+			data = owned.data();
+		} catch (std::bad_alloc &) {
+			length = 0;
+			sizeKnown = false;
+			Rewind();
+		}
+	}
+}
+
+/// Implement IUnknown
+STDMETHODIMP TextStream::QueryInterface(REFIID riid, PVOID *ppv) noexcept {
+	if (riid == IID_IUnknown || riid == IID_ISequentialStream || riid == IID_IStream) {
+		*ppv = this;
+	} else {
+		*ppv = nullptr;
+		return E_NOINTERFACE;
+	}
+	AddRef();
+	return S_OK;
+}
+STDMETHODIMP_(ULONG)TextStream::AddRef() noexcept {
+	return ++ref;
+}
+STDMETHODIMP_(ULONG)TextStream::Release() noexcept {
+	const ULONG refs = --ref;
+	if (refs == 0) {
+		delete this;
+	}
+	return refs;
+}
+
+/// Implement ISequentialStream
+STDMETHODIMP TextStream::Read(void *pv, ULONG cb, ULONG *pcbRead) noexcept {
+	if (!pv) {
+		return STG_E_INVALIDPOINTER;
+	}
+	ULONG done = 0;
+	HRESULT hr = S_OK;
+	try {
+		while (done < cb) {
+			const size_t available = buffer.length()*sizeof(wchar_t) - bufferPos;
+			if (available == 0) {
+				if (dataPos >= length) {
+					break;
+				}
+				Convert();
+				continue;
+			}
+			const ULONG count = static_cast<ULONG>(std::min<size_t>(cb - done, available));
+			memcpy(static_cast<char *>(pv) + done, reinterpret_cast<const char *>(buffer.data()) + bufferPos, count);
+			bufferPos += count;
+			done += count;
+		}
+	} catch (std::bad_alloc &) {
+		hr = E_OUTOFMEMORY;
+	}
+	position += done;
+	if (pcbRead) {
+		*pcbRead = done;
+	}
+	if (FAILED(hr)) {
+		return hr;
+	}
+	return (done == cb) ? S_OK : S_FALSE;
+}
+STDMETHODIMP TextStream::Write(const void *, ULONG, ULONG *) noexcept {
+	return STG_E_ACCESSDENIED;
+}
+
+/// Implement IStream
+STDMETHODIMP TextStream::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER *plibNewPosition) noexcept {
+	LONGLONG target = dlibMove.QuadPart;
+	switch (dwOrigin) {
+	case STREAM_SEEK_SET:
+		break;
+	case STREAM_SEEK_CUR:
+		target += position;
+		break;
+	case STREAM_SEEK_END:
+		target += TotalSize();
+		break;
+	default:
+		return STG_E_INVALIDFUNCTION;
+	}
+	if (target < 0) {
+		return STG_E_INVALIDFUNCTION;
+	}
+
+	const ULONGLONG newPosition = target;
+	if (newPosition < position) {
+		Rewind();
+	}
+	try {
+		// convert and skip text before new position
+		while (position < newPosition) {
+			const size_t available = buffer.length()*sizeof(wchar_t) - bufferPos;
+			if (available == 0) {
+				if (dataPos >= length) {
+					// seek past the end, following Read() returns nothing
+					position = newPosition;
+					break;
+				}
+				Convert();
+				continue;
+			}
+			const size_t count = static_cast<size_t>(std::min<ULONGLONG>(newPosition - position, available));
+			bufferPos += count;
+			position += count;
+		}
+	} catch (std::bad_alloc &) {
+		return E_OUTOFMEMORY;
+	}
+	if (plibNewPosition) {
+		plibNewPosition->QuadPart = position;
+	}
+	return S_OK;
+}
+STDMETHODIMP TextStream::SetSize(ULARGE_INTEGER) noexcept {
+	return STG_E_ACCESSDENIED;
+}
+STDMETHODIMP TextStream::CopyTo(IStream *pstm, ULARGE_INTEGER cb, ULARGE_INTEGER *pcbRead, ULARGE_INTEGER *pcbWritten) noexcept {
+	if (!pstm) {
+		return STG_E_INVALIDPOINTER;
+	}
+	char block[64*1024];
+	ULONGLONG totalRead = 0;
+	ULONGLONG totalWritten = 0;
+	HRESULT hr = S_OK;
+	while (totalRead < cb.QuadPart) {
+		const ULONG request = static_cast<ULONG>(std::min<ULONGLONG>(cb.QuadPart - totalRead, sizeof(block)));
+		ULONG cbRead = 0;
+		hr = Read(block, request, &cbRead);
+		if (FAILED(hr) || cbRead == 0) {
+			break;
+		}
+		totalRead += cbRead;
+		ULONG cbWritten = 0;
+		hr = pstm->Write(block, cbRead, &cbWritten);
+		totalWritten += cbWritten;
+		if (FAILED(hr) || cbWritten != cbRead) {
+			break;
+		}
+	}
+	if (pcbRead) {
+		pcbRead->QuadPart = totalRead;
+	}
+	if (pcbWritten) {
+		pcbWritten->QuadPart = totalWritten;
+	}
+	return FAILED(hr) ? hr : S_OK;
+}
+STDMETHODIMP TextStream::Commit(DWORD) noexcept {
+	return S_OK;
+}
+STDMETHODIMP TextStream::Revert() noexcept {
+	return S_OK;
+}
+STDMETHODIMP TextStream::LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) noexcept {
+	return STG_E_INVALIDFUNCTION;
+}
+STDMETHODIMP TextStream::UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) noexcept {
+	return STG_E_INVALIDFUNCTION;
+}
+STDMETHODIMP TextStream::Stat(STATSTG *pstatstg, DWORD) noexcept {
+	if (!pstatstg) {
+		return STG_E_INVALIDPOINTER;
+	}
+	*pstatstg = {};
+	pstatstg->type = STGTY_STREAM;
+	pstatstg->cbSize.QuadPart = TotalSize();
+	pstatstg->grfMode = STGM_READ;
+	return S_OK;
+}
+STDMETHODIMP TextStream::Clone(IStream **ppstm) noexcept {
+	if (ppstm) {
+		*ppstm = nullptr;
+	}
+	return E_NOTIMPL;
+}
+
 /**
  * DBCS: support Input Method Editor (IME).
  * Called when IME Window opened.
@@ -3422,6 +3951,15 @@ void ScintillaWin::CopyToClipboard(const SelectionText &selectedText) {
 		}
 	}
 
+	SetClipboardShape(selectedText);
+	::CloseClipboard();
+
+	// TODO: notify data loss
+	//if (!selectedText.asBinary && ) {
+	//}
+}
+
+void ScintillaWin::SetClipboardShape(const SelectionText &selectedText) noexcept {
 	if (selectedText.rectangular) {
 		::SetClipboardData(cfColumnSelect, nullptr);
 
@@ -3437,12 +3975,30 @@ void ScintillaWin::CopyToClipboard(const SelectionText &selectedText) {
 		::SetClipboardData(cfLineSelect, nullptr);
 		::SetClipboardData(cfVSLineTag, nullptr);
 	}
+}
+
+void ScintillaWin::DelayCopyToClipboard(std::unique_ptr<SelectionText> selectedText) {
+	if (!::OpenClipboardRetry(MainHWND())) {
+		return;
+	}
+	// previous delayed text is released on WM_DESTROYCLIPBOARD
+	::EmptyClipboard();
 
+	delayedClipboardText = std::move(selectedText);
+	::SetClipboardData(CF_UNICODETEXT, nullptr);
+	SetClipboardShape(*delayedClipboardText);
 	::CloseClipboard();
+}
 
-	// TODO: notify data loss
-	//if (!selectedText.asBinary && ) {
-	//}
+void ScintillaWin::RenderClipboardText() {
+	if (delayedClipboardText) {
+		GlobalMemory uniText;
+		CopyToGlobal(uniText, *delayedClipboardText, CopyEncoding::Unicode);
+		if (uniText) {
+			uniText.SetClip(CF_UNICODETEXT);
+		}
+		delayedClipboardText.reset();
+	}
 }
 
 void ScintillaWin::ScrollMessage(WPARAM wParam) {
@@ -3724,7 +4280,7 @@ STDMETHODIMP ScintillaWin::DragEnter(LPDATAOBJECT pIDataSource, DWORD grfKeyStat
 
 		for (UINT fmtIndex = 0; fmtIndex < dropFormatCount; fmtIndex++) {
 			const CLIPFORMAT fmt = dropFormat[fmtIndex];
-			FORMATETC fmtu = { fmt, nullptr, DVASPECT_CONTENT, -1, TYMED_HGLOBAL };
+			FORMATETC fmtu = { fmt, nullptr, DVASPECT_CONTENT, -1, TextMediumType(fmt) };
 			const HRESULT hrHasUText = pIDataSource->QueryGetData(&fmtu);
 			hasOKText = (hrHasUText == S_OK);
 			if (hasOKText) {
@@ -3780,18 +4336,32 @@ STDMETHODIMP ScintillaWin::Drop(LPDATAOBJECT pIDataSource, DWORD grfKeyState, PO
 
 		SetDragPosition(SelectionPosition(Sci::invalidPosition));
 
+		FORMATETC fmtr = { cfColumnSelect, nullptr, DVASPECT_CONTENT, -1, TYMED_HGLOBAL };
+		const bool isRectangular = S_OK == pIDataSource->QueryGetData(&fmtr);
+
+		POINT rpt = { pt.x, pt.y };
+		::ScreenToClient(MainHWND(), &rpt);
+		const SelectionPosition movePos = SPositionFromLocation(PointFromPOINT(rpt), false, false, UserVirtualSpace());
+		const bool moving = *pdwEffect == DROPEFFECT_MOVE;
+
 		std::string putf;
 		bool fileDrop = false;
+		bool streamDropped = false;
 		HRESULT hr = DV_E_FORMATETC;
 
 		//EnumDataSourceFormat("Drop", pIDataSource);
 		for (UINT fmtIndex = 0; fmtIndex < dropFormatCount; fmtIndex++) {
 			const CLIPFORMAT fmt = dropFormat[fmtIndex];
-			FORMATETC fmtu = { fmt, nullptr, DVASPECT_CONTENT, -1, TYMED_HGLOBAL };
+			FORMATETC fmtu = { fmt, nullptr, DVASPECT_CONTENT, -1, TextMediumType(fmt) };
 			STGMEDIUM medium {};
 			hr = pIDataSource->GetData(&fmtu, &medium);
 
-			if (SUCCEEDED(hr) && medium.hGlobal) {
+			if (SUCCEEDED(hr) && medium.tymed == TYMED_ISTREAM) {
+				// Unicode Text in stream
+				if (medium.pstm && fmt == CF_UNICODETEXT) {
+					streamDropped = DropStream(medium.pstm, movePos, moving, isRectangular);
+				}
+			} else if (SUCCEEDED(hr) && medium.hGlobal) {
 				// File Drop
 				if (fmt == CF_HDROP
 #if EnableDrop_VisualStudioProjectItem
@@ -3855,7 +4425,7 @@ STDMETHODIMP ScintillaWin::Drop(LPDATAOBJECT pIDataSource, DWORD grfKeyState, PO
 			}
 
 			::ReleaseStgMedium(&medium);
-			if (!putf.empty()) {
+			if (streamDropped || !putf.empty()) {
 				break;
 			}
 		}
@@ -3870,14 +4440,7 @@ STDMETHODIMP ScintillaWin::Drop(LPDATAOBJECT pIDataSource, DWORD grfKeyState, PO
 		if (fileDrop) {
 			NotifyURIDropped(putf.c_str());
 		} else {
-			FORMATETC fmtr = { cfColumnSelect, nullptr, DVASPECT_CONTENT, -1, TYMED_HGLOBAL };
-			const bool isRectangular = S_OK == pIDataSource->QueryGetData(&fmtr);
-
-			POINT rpt = { pt.x, pt.y };
-			::ScreenToClient(MainHWND(), &rpt);
-			const SelectionPosition movePos = SPositionFromLocation(PointFromPOINT(rpt), false, false, UserVirtualSpace());
-
-			DropAt(movePos, putf.c_str(), putf.size(), *pdwEffect == DROPEFFECT_MOVE, isRectangular);
+			DropAt(movePos, putf.c_str(), putf.size(), moving, isRectangular);
 		}
 
 		return S_OK;
@@ -3894,6 +4457,24 @@ STDMETHODIMP ScintillaWin::GetData(const FORMATETC *pFEIn, STGMEDIUM *pSTM) {
 		return DATA_E_FORMATETC;
 	}
 
+	if ((pFEIn->tymed & TYMED_ISTREAM) && pFEIn->cfFormat == CF_UNICODETEXT
+		&& inDragDrop == DragDrop::dragging && drag.Length() >= delayedClipboardMinSize) {
+		// large text is converted in chunks when the stream is read
+		try {
+			dragStreams.reserve(dragStreams.size() + 1);
+			TextStream *stream = new TextStream(drag);
+			stream->AddRef();
+			dragStreams.push_back(stream);
+			pSTM->tymed = TYMED_ISTREAM;
+			pSTM->pstm = stream;
+			pSTM->pUnkForRelease = nullptr;
+			return S_OK;
+		} catch (std::bad_alloc &) {
+			errorStatus = Status::BadAlloc;
+			return E_OUTOFMEMORY;
+		}
+	}
+
 	pSTM->tymed = TYMED_HGLOBAL;
 	//Platform::DebugPrintf("DOB GetData OK %d %x %x\n", lenDrag, pFEIn, pSTM);
 
@@ -4176,6 +4757,7 @@ extern "C" {
 // This function is externally visible so it can be called from container when building statically.
 // Must be called once only.
 int Scintilla_RegisterClasses(void *hInstance) {
+	NP2_TRACE_REGISTER();
 	const bool result = ScintillaWin::Register(static_cast<HINSTANCE>(hInstance));
 	return result;
 }
@@ -4183,7 +4765,9 @@ int Scintilla_RegisterClasses(void *hInstance) {
 // This function is externally visible so it can be called from container when building statically.
 int Scintilla_ReleaseResources(void) {
 	const bool result = ScintillaWin::Unregister();
+	ReleaseHanjaDic();
 	Platform_Finalise(false);
+	NP2_TRACE_UNREGISTER();
 	return result;
 }
 
@@ -0,0 +1,502 @@
+// Automation Channel
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "SciCall.h"
+#include "Helpers.h"
+#include "Notepad2.h"
+#include "Edit.h"
+#include "Styles.h"
+#include "HexView.h"
+#include "Automation.h"
+
+// External tools connect to the named pipe and send batches of commands. A batch is one pipe
+// message of UTF-8 lines, arguments are separated by tab, and \t, \r, \n and \\ are escaped:
+//	open	path						absolute path
+//	goto	line	[column]			1-based, line -1 is end of document
+//	find	flags	text				search forward from selection, flags: c case, w word, r regex
+//	replace	flags	text	replacement	replace all in document
+//	insert	text						replace selection
+//	style	[position]					style number, scheme and style name at position or caret
+// A batch is executed on the main thread inside one undo group with redraw suspended, then one
+// message is written back for each command: "ok" followed by tab separated values, or "error"
+// followed by the reason (also "out of memory" when the result can't be stored), and "done"
+// after the batch.
+
+extern HWND hwndEdit;
+
+#define AUTOMATION_BUFFER_SIZE		(64*1024)
+// verb and up to three arguments, tab in the last argument is kept.
+#define AUTOMATION_MAX_ARGUMENT		4
+
+#ifndef PIPE_REJECT_REMOTE_CLIENTS
+#define PIPE_REJECT_REMOTE_CLIENTS	0x00000008
+#endif
+
+typedef struct AutomationBatch {
+	char *lpCommands;
+	char *lpResults;	// lines, allocated on main thread
+	DWORD cbResults;
+	DWORD cbCapacity;
+	DWORD cDropped;		// results after out of memory, written as errors
+	HANDLE hDone;
+} AutomationBatch;
+
+static HWND automationHwnd;
+static HANDLE automationPipe = INVALID_HANDLE_VALUE;
+static HANDLE automationStop;
+static HANDLE automationThread;
+
+// returns FALSE when the operation failed or the channel is stopped.
+static BOOL Automation_Complete(OVERLAPPED *overlapped, BOOL bDone, DWORD *cbTransferred) {
+	*cbTransferred = 0;
+	if (!bDone) {
+		const DWORD dwError = GetLastError();
+		if (dwError == ERROR_IO_PENDING) {
+			const HANDLE handles[2] = { overlapped->hEvent, automationStop };
+			if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+				CancelIo(automationPipe);
+				GetOverlappedResult(automationPipe, overlapped, cbTransferred, TRUE);
+				SetLastError(ERROR_OPERATION_ABORTED);
+				return FALSE;
+			}
+		} else if (dwError != ERROR_MORE_DATA) {
+			return FALSE;
+		}
+	}
+	return GetOverlappedResult(automationPipe, overlapped, cbTransferred, FALSE);
+}
+
+static BOOL Automation_Write(OVERLAPPED *overlapped, const char *message, DWORD cbMessage) {
+	DWORD cbTransferred;
+	const BOOL bDone = WriteFile(automationPipe, message, cbMessage, NULL, overlapped);
+	return Automation_Complete(overlapped, bDone, &cbTransferred) && cbTransferred == cbMessage;
+}
+
+static DWORD WINAPI AutomationThread(LPVOID lpParam) {
+	UNREFERENCED_PARAMETER(lpParam);
+
+	OVERLAPPED overlapped;
+	ZeroMemory(&overlapped, sizeof(overlapped));
+	overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	AutomationBatch batch;
+	ZeroMemory(&batch, sizeof(batch));
+	batch.hDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+	DWORD cbBuffer = AUTOMATION_BUFFER_SIZE;
+	char *buffer = (char *)NP2HeapAlloc(cbBuffer);
+
+	BOOL bRunning = overlapped.hEvent != NULL && batch.hDone != NULL && buffer != NULL;
+	while (bRunning) {
+		// one client at a time
+		DWORD cbTransferred;
+		BOOL bConnected = ConnectNamedPipe(automationPipe, &overlapped);
+		if (!bConnected && GetLastError() == ERROR_PIPE_CONNECTED) {
+			bConnected = TRUE;
+		} else {
+			bConnected = Automation_Complete(&overlapped, bConnected, &cbTransferred);
+		}
+		const BOOL bAccepted = bConnected;
+
+		while (bConnected) {
+			// batch larger than the buffer is read in parts
+			DWORD cbData = 0;
+			BOOL bRead;
+			while (TRUE) {
+				bRead = ReadFile(automationPipe, buffer + cbData, cbBuffer - cbData - 1, NULL, &overlapped);
+				bRead = Automation_Complete(&overlapped, bRead, &cbTransferred);
+				cbData += cbTransferred;
+				if (bRead || GetLastError() != ERROR_MORE_DATA) {
+					break;
+				}
+				char *grown = (char *)NP2HeapReAlloc(buffer, 2*cbBuffer);
+				if (grown == NULL) {
+					break;
+				}
+				buffer = grown;
+				cbBuffer *= 2;
+			}
+			if (!bRead) {
+				// client closed the pipe
+				break;
+			}
+
+			buffer[cbData] = '\0';
+			batch.lpCommands = buffer;
+			batch.lpResults = NULL;
+			batch.cbResults = 0;
+			batch.cbCapacity = 0;
+			batch.cDropped = 0;
+			if (!PostMessage(automationHwnd, APPM_AUTOMATION, 0, (LPARAM)&batch)) {
+				bRunning = FALSE;
+				break;
+			}
+			const HANDLE handles[2] = { batch.hDone, automationStop };
+			if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+				// batch still in message queue is discarded by Automation_Stop()
+				bRunning = FALSE;
+				break;
+			}
+
+			// result of each command is written as one message
+			const char *p = batch.lpResults;
+			const char * const end = p + batch.cbResults;
+			while (bConnected && p < end) {
+				const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+				bConnected = Automation_Write(&overlapped, p, (DWORD)(lineEnd - p));
+				p = lineEnd + 1;
+			}
+			for (DWORD index = 0; bConnected && index < batch.cDropped; index++) {
+				bConnected = Automation_Write(&overlapped, "error\tout of memory", CSTRLEN("error\tout of memory"));
+			}
+			bConnected = bConnected && Automation_Write(&overlapped, "done", CSTRLEN("done"));
+			if (batch.lpResults != NULL) {
+				NP2HeapFree(batch.lpResults);
+			}
+		}
+
+		DisconnectNamedPipe(automationPipe);
+		// avoid busy loop when connecting keeps failing
+		bRunning = bRunning && WaitForSingleObject(automationStop, bAccepted ? 0 : 100) == WAIT_TIMEOUT;
+	}
+
+	if (buffer != NULL) {
+		NP2HeapFree(buffer);
+	}
+	if (batch.hDone != NULL) {
+		CloseHandle(batch.hDone);
+	}
+	if (overlapped.hEvent != NULL) {
+		CloseHandle(overlapped.hEvent);
+	}
+	return 0;
+}
+
+BOOL Automation_Start(HWND hwnd, LPCWSTR lpszName) {
+	WCHAR szPipe[MAX_PATH];
+	if (StrIsEmpty(lpszName)) {
+		wsprintf(szPipe, L"\\\\.\\pipe\\Notepad2.Automation.%u", GetCurrentProcessId());
+	} else {
+		lstrcpy(szPipe, L"\\\\.\\pipe\\");
+		lstrcpyn(szPipe + CSTRLEN(L"\\\\.\\pipe\\"), lpszName, COUNTOF(szPipe) - CSTRLEN(L"\\\\.\\pipe\\"));
+	}
+
+	// default security descriptor only grants write access to creator owner, administrators and LocalSystem.
+	const DWORD dwPipeMode = PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | (IsVistaAndAbove() ? PIPE_REJECT_REMOTE_CLIENTS : 0);
+	HANDLE hPipe = CreateNamedPipe(szPipe, PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+		dwPipeMode, 1, AUTOMATION_BUFFER_SIZE, AUTOMATION_BUFFER_SIZE, 0, NULL);
+	if (hPipe == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+
+	automationStop = CreateEvent(NULL, TRUE, FALSE, NULL);
+	automationHwnd = hwnd;
+	automationPipe = hPipe;
+	automationThread = (automationStop == NULL) ? NULL : CreateThread(NULL, 0, AutomationThread, NULL, 0, NULL);
+	if (automationThread == NULL) {
+		Automation_Stop();
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void Automation_Stop(void) {
+	if (automationThread != NULL) {
+		SetEvent(automationStop);
+		WaitForSingleObject(automationThread, INFINITE);
+		CloseHandle(automationThread);
+		automationThread = NULL;
+
+		// batch belongs to the exited thread
+		MSG msg;
+		while (PeekMessage(&msg, automationHwnd, APPM_AUTOMATION, APPM_AUTOMATION, PM_REMOVE)) {
+		}
+	}
+	if (automationStop != NULL) {
+		CloseHandle(automationStop);
+		automationStop = NULL;
+	}
+	if (automationPipe != INVALID_HANDLE_VALUE) {
+		CloseHandle(automationPipe);
+		automationPipe = INVALID_HANDLE_VALUE;
+	}
+}
+
+// after out of memory, results are counted to keep one reply for each command in order.
+static void Automation_Append(AutomationBatch *batch, const char *result) {
+	const DWORD length = (DWORD)strlen(result);
+	const DWORD required = batch->cbResults + length + 1;
+	if (batch->cDropped != 0) {
+		++batch->cDropped;
+		return;
+	}
+	if (required > batch->cbCapacity) {
+		DWORD capacity = max_u(2*batch->cbCapacity, AUTOMATION_BUFFER_SIZE);
+		while (capacity < required) {
+			capacity *= 2;
+		}
+		char *lpResults = (char *)((batch->lpResults == NULL) ? NP2HeapAlloc(capacity) : NP2HeapReAlloc(batch->lpResults, capacity));
+		if (lpResults == NULL) {
+			batch->cDropped = 1;
+			return;
+		}
+		batch->lpResults = lpResults;
+		batch->cbCapacity = capacity;
+	}
+	memcpy(batch->lpResults + batch->cbResults, result, length);
+	batch->lpResults[required - 1] = '\n';
+	batch->cbResults = required;
+}
+
+static void Automation_Unescape(char *s) {
+	char *d = s;
+	while (*s) {
+		char ch = *s++;
+		if (ch == '\\') {
+			switch (*s) {
+			case 't':
+				ch = '\t';
+				++s;
+				break;
+			case 'r':
+				ch = '\r';
+				++s;
+				break;
+			case 'n':
+				ch = '\n';
+				++s;
+				break;
+			case '\\':
+				++s;
+				break;
+			default:
+				// kept for regex
+				break;
+			}
+		}
+		*d++ = ch;
+	}
+	*d = '\0';
+}
+
+// returns the argument itself when document is UTF-8, otherwise converted copy freed by caller.
+static char *Automation_ToDocument(char *text) {
+	const UINT cpEdit = SciCall_GetCodePage();
+	if (cpEdit == SC_CP_UTF8) {
+		return text;
+	}
+
+	const int wlen = MultiByteToWideChar(CP_UTF8, 0, text, -1, NULL, 0);
+	LPWSTR wch = (LPWSTR)NP2HeapAlloc(wlen * sizeof(WCHAR));
+	MultiByteToWideChar(CP_UTF8, 0, text, -1, wch, wlen);
+	const int len = WideCharToMultiByte(cpEdit, 0, wch, -1, NULL, 0, NULL, NULL);
+	char *converted = (char *)NP2HeapAlloc(len + 1);
+	WideCharToMultiByte(cpEdit, 0, wch, -1, converted, len, NULL, NULL);
+	NP2HeapFree(wch);
+	return converted;
+}
+
+static int Automation_SearchFlags(const char *flags) {
+	int searchFlags = 0;
+	for (; *flags; flags++) {
+		switch (*flags) {
+		case 'c':
+			searchFlags |= SCFIND_MATCHCASE;
+			break;
+		case 'w':
+			searchFlags |= SCFIND_WHOLEWORD;
+			break;
+		case 'r':
+			searchFlags |= SCFIND_REGEXP | SCFIND_POSIX;
+			break;
+		}
+	}
+	return searchFlags;
+}
+
+static void Automation_Open(AutomationBatch *batch, const char *path) {
+	WCHAR wchPath[MAX_PATH];
+	if (StrIsEmptyA(path) || !MultiByteToWideChar(CP_UTF8, 0, path, -1, wchPath, COUNTOF(wchPath))) {
+		Automation_Append(batch, "error\tinvalid path");
+		return;
+	}
+
+	// undo group and suspended redraw belong to the previous document
+	SciCall_EndUndoAction();
+	const BOOL bOpened = FileLoad(FALSE, FALSE, FALSE, FALSE, wchPath);
+	SendMessage(hwndEdit, WM_SETREDRAW, FALSE, 0);
+	SciCall_BeginUndoAction();
+	Automation_Append(batch, bOpened ? "ok" : "error\topen failed");
+}
+
+static void Automation_Find(AutomationBatch *batch, const char *flags, char *text) {
+	char *find = Automation_ToDocument(text);
+	struct Sci_TextToFind ttf = { { SciCall_GetSelectionEnd(), SciCall_GetLength() }, find, { 0, 0 } };
+	const Sci_Position iPos = SciCall_FindText(Automation_SearchFlags(flags), &ttf);
+	if (find != text) {
+		NP2HeapFree(find);
+	}
+
+	if (iPos >= 0) {
+		char result[64];
+		EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
+		sprintf(result, "ok\t%" PRId64 "\t%" PRId64, (int64_t)ttf.chrgText.cpMin, (int64_t)ttf.chrgText.cpMax);
+		Automation_Append(batch, result);
+	} else {
+		Automation_Append(batch, (iPos == -1) ? "error\tnot found" : "error\tinvalid regular expression");
+	}
+}
+
+static void Automation_ReplaceAll(AutomationBatch *batch, const char *flags, char *text, char *replacement) {
+	const int searchFlags = Automation_SearchFlags(flags);
+	const BOOL bRegex = (searchFlags & SCFIND_REGEXP) != 0;
+	char *find = Automation_ToDocument(text);
+	char *replace = Automation_ToDocument(replacement);
+	// same undo grouping and performance as Replace All in the editor
+	const Sci_Position count = EditReplaceAllInRange(searchFlags, find, replace, bRegex, 0, SciCall_GetLength());
+
+	if (find != text) {
+		NP2HeapFree(find);
+	}
+	if (replace != replacement) {
+		NP2HeapFree(replace);
+	}
+	if (count < 0) {
+		Automation_Append(batch, (count == -1) ? "error\tout of memory" : "error\tinvalid regular expression");
+	} else {
+		char result[64];
+		sprintf(result, "ok\t%" PRId64, (int64_t)count);
+		Automation_Append(batch, result);
+	}
+}
+
+static void Automation_Style(AutomationBatch *batch, Sci_Position iPos) {
+	if (iPos < 0 || iPos >= SciCall_GetLength()) {
+		Automation_Append(batch, "error\tinvalid position");
+		return;
+	}
+
+	SciCall_EnsureStyledTo(iPos + 1);
+	const int style = SciCall_GetStyleAt(iPos);
+	WCHAR wchLexer[128];
+	LPCWSTR lpszLexer = Style_GetCurrentLexerName(wchLexer, COUNTOF(wchLexer));
+	LPCWSTR lpszStyle = Style_GetStyleName(style);
+	char lexer[3*COUNTOF(wchLexer)];
+	char name[3*MAX_EDITSTYLE_NAME_SIZE];
+	if (!WideCharToMultiByte(CP_UTF8, 0, lpszLexer, -1, lexer, COUNTOF(lexer), NULL, NULL)) {
+		lexer[0] = '\0';
+	}
+	if (lpszStyle == NULL || !WideCharToMultiByte(CP_UTF8, 0, lpszStyle, -1, name, COUNTOF(name), NULL, NULL)) {
+		name[0] = '\0';
+	}
+
+	char result[32 + COUNTOF(lexer) + COUNTOF(name)];
+	sprintf(result, "ok\t%d\t%s\t%s", style, lexer, name);
+	Automation_Append(batch, result);
+}
+
+static void Automation_Execute(AutomationBatch *batch, char *line) {
+	char *argv[AUTOMATION_MAX_ARGUMENT];
+	int argc = 1;
+	argv[0] = line;
+	while (argc < AUTOMATION_MAX_ARGUMENT) {
+		char *tab = strchr(line, '\t');
+		if (tab == NULL) {
+			break;
+		}
+		*tab = '\0';
+		line = tab + 1;
+		argv[argc++] = line;
+	}
+	for (int i = 1; i < argc; i++) {
+		Automation_Unescape(argv[i]);
+	}
+
+	const char *verb = argv[0];
+	if (strcmp(verb, "open") == 0) {
+		Automation_Open(batch, (argc > 1) ? argv[1] : "");
+		return;
+	}
+	if (HexView_IsActive()) {
+		Automation_Append(batch, "error\thex view");
+		return;
+	}
+
+	if (strcmp(verb, "goto") == 0) {
+		const Sci_Line iLine = (argc > 1) ? (Sci_Line)strtoll(argv[1], NULL, 10) : 0;
+		const Sci_Position iColumn = (argc > 2) ? (Sci_Position)strtoll(argv[2], NULL, 10) : 1;
+		if (iLine == 0 || iColumn <= 0) {
+			Automation_Append(batch, "error\tinvalid position");
+		} else {
+			char result[64];
+			EditJumpTo(iLine, iColumn);
+			sprintf(result, "ok\t%" PRId64, (int64_t)SciCall_GetCurrentPos());
+			Automation_Append(batch, result);
+		}
+	} else if (strcmp(verb, "find") == 0) {
+		if (argc < 3 || StrIsEmptyA(argv[2])) {
+			Automation_Append(batch, "error\tmissing text");
+		} else {
+			Automation_Find(batch, argv[1], argv[2]);
+		}
+	} else if (strcmp(verb, "replace") == 0 || strcmp(verb, "insert") == 0) {
+		const BOOL bReplace = verb[0] == 'r';
+		if (SciCall_GetReadOnly()) {
+			Automation_Append(batch, "error\tread-only");
+		} else if (bReplace && (argc < 4 || StrIsEmptyA(argv[2]))) {
+			Automation_Append(batch, "error\tmissing text");
+		} else if (bReplace) {
+			Automation_ReplaceAll(batch, argv[1], argv[2], argv[3]);
+		} else if (argc < 2) {
+			Automation_Append(batch, "error\tmissing text");
+		} else {
+			char result[64];
+			char *text = Automation_ToDocument(argv[1]);
+			SciCall_ReplaceSel(text);
+			if (text != argv[1]) {
+				NP2HeapFree(text);
+			}
+			sprintf(result, "ok\t%" PRId64, (int64_t)SciCall_GetCurrentPos());
+			Automation_Append(batch, result);
+		}
+	} else if (strcmp(verb, "style") == 0) {
+		const Sci_Position iPos = (argc > 1 && StrNotEmptyA(argv[1])) ? (Sci_Position)strtoll(argv[1], NULL, 10) : SciCall_GetCurrentPos();
+		Automation_Style(batch, iPos);
+	} else {
+		Automation_Append(batch, "error\tunknown command");
+	}
+}
+
+void Automation_OnBatch(LPARAM lParam) {
+	AutomationBatch *batch = (AutomationBatch *)lParam;
+	SendMessage(hwndEdit, WM_SETREDRAW, FALSE, 0);
+	SciCall_BeginUndoAction();
+
+	char *line = batch->lpCommands;
+	while (*line) {
+		char *next = strchr(line, '\n');
+		if (next != NULL) {
+			*next++ = '\0';
+		} else {
+			next = line + strlen(line);
+		}
+		const size_t length = strlen(line);
+		if (length != 0 && line[length - 1] == '\r') {
+			line[length - 1] = '\0';
+		}
+		if (*line) {
+			Automation_Execute(batch, line);
+		}
+		line = next;
+	}
+
+	SciCall_EndUndoAction();
+	SendMessage(hwndEdit, WM_SETREDRAW, TRUE, 0);
+	RedrawWindow(hwndEdit, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
+	UpdateStatusbar();
+
+	// "done" is written by the pipe thread after the results
+	SetEvent(batch->hDone);
+}
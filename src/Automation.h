@@ -0,0 +1,8 @@
+// Automation Channel
+#pragma once
+
+// create pipe \\.\pipe\name, default name is Notepad2.Automation.<process id>.
+BOOL Automation_Start(HWND hwnd, LPCWSTR lpszName);
+void Automation_Stop(void);
+// execute batch posted by the pipe thread with APPM_AUTOMATION.
+void Automation_OnBatch(LPARAM lParam);
@@ -26,6 +26,8 @@
 #include <shellapi.h>
 #include <commctrl.h>
 #include <commdlg.h>
+#include <vector>
+#include <algorithm>
 #include "SciCall.h"
 #if !NP2_FORCE_COMPILE_C_AS_CPP
 extern "C" {
@@ -65,6 +67,57 @@ static HGLOBAL hDevNames {};
 
 static void EditPrintInit() noexcept;
 
+// Start position of each page in last print of whole document, printing a page range
+// or printing again starts at cached page without formatting earlier pages.
+struct PrintPageCache {
+	struct Layout {
+		RECT rc;
+		RECT rcPage;
+		POINT dpi;
+		int zoom;
+		int tabWidth;
+	} layout;
+	std::vector<Sci_Position> pageStart;
+
+	void Validate(const RECT &rc, const RECT &rcPage, POINT dpi) {
+		Layout current;
+		ZeroMemory(&current, sizeof(current));
+		current.rc = rc;
+		current.rcPage = rcPage;
+		current.dpi = dpi;
+		current.zoom = iPrintZoom;
+		current.tabWidth = SciCall_GetTabWidth();
+		if (memcmp(&current, &layout, sizeof(Layout)) != 0) {
+			layout = current;
+			pageStart.clear();
+		}
+	}
+};
+
+static PrintPageCache printPageCache;
+static bool printCancelled;
+
+static bool EditPrintCheckCancel() noexcept {
+	if (DispatchPaintMessages()) {
+		printCancelled = true;
+	}
+	return printCancelled;
+}
+
+// called by GDI while pages are spooled
+static BOOL CALLBACK EditPrintAbortProc(HDC /*hdc*/, int /*iError*/) noexcept {
+	return !EditPrintCheckCancel();
+}
+
+// pages start before the modified line are unchanged.
+extern "C" void EditPrintInvalidatePages(Sci_Position position) {
+	std::vector<Sci_Position> &pageStart = printPageCache.pageStart;
+	if (!pageStart.empty()) {
+		const Sci_Position lineStart = SciCall_PositionFromLine(SciCall_LineFromPosition(position));
+		pageStart.erase(std::lower_bound(pageStart.begin(), pageStart.end(), lineStart), pageStart.end());
+	}
+}
+
 //=============================================================================
 //
 // EditPrint() - Code from SciTEWin::Print()
@@ -228,6 +281,10 @@ extern "C" BOOL EditPrint(HWND hwnd, LPCWSTR pszDocTitle) {
 		footerLineHeight = 0;
 	}
 
+	// Escape cancels printing, checked between pages and while spooling
+	printCancelled = false;
+	SetAbortProc(hdc, EditPrintAbortProc);
+
 	DOCINFO di = {sizeof(DOCINFO), pszDocTitle, nullptr, nullptr, 0};
 	if (StartDoc(hdc, &di) < 0) {
 		DeleteDC(hdc);
@@ -300,12 +357,28 @@ extern "C" BOOL EditPrint(HWND hwnd, LPCWSTR pszDocTitle) {
 	GetString(IDS_PRINT_PAGENUM, tchPageFormat, COUNTOF(tchPageFormat));
 	GetString(IDS_PRINTFILE, tchPageStatus, COUNTOF(tchPageStatus));
 
+	// selection is different for each print, only page breaks for whole document are cached
+	const bool cachePages = !(pdlg.Flags & PD_SELECTION);
+	if (cachePages) {
+		printPageCache.Validate(frPrint.rc, frPrint.rcPage, ptDpi);
+		if (pdlg.Flags & PD_PAGENUMS) {
+			const size_t page = sci::min<size_t>(printPageCache.pageStart.size(), pdlg.nFromPage);
+			if (page != 0) {
+				pageNum = static_cast<int>(page);
+				lengthPrinted = printPageCache.pageStart[page - 1];
+			}
+		}
+	}
+
 	// Show wait cursor...
 	BeginWaitCursor();
 
 	BOOL printEmpty = lengthPrinted == lengthDoc;
 	while (lengthPrinted < lengthDoc || printEmpty) {
 		printEmpty = FALSE;
+		if (cachePages && printPageCache.pageStart.size() == static_cast<size_t>(pageNum - 1)) {
+			printPageCache.pageStart.push_back(lengthPrinted);
+		}
 		const BOOL printPage = !(pdlg.Flags & PD_PAGENUMS) || (pageNum >= pdlg.nFromPage && pageNum <= pdlg.nToPage);
 		WCHAR tchNum[32];
 		_ltow(pageNum, tchNum, 10);
@@ -405,11 +478,18 @@ extern "C" BOOL EditPrint(HWND hwnd, LPCWSTR pszDocTitle) {
 		if ((pdlg.Flags & PD_PAGENUMS) && (pageNum > pdlg.nToPage)) {
 			break;
 		}
+		if (EditPrintCheckCancel()) {
+			break;
+		}
 	}
 
 	SciCall_FormatRange(FALSE, nullptr);
 
-	EndDoc(hdc);
+	if (printCancelled) {
+		AbortDoc(hdc);
+	} else {
+		EndDoc(hdc);
+	}
 	DeleteDC(hdc);
 	if (fontHeader) {
 		DeleteObject(fontHeader);
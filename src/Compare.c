@@ -0,0 +1,790 @@
+// File Compare
+
+#include <windows.h>
+#include <limits.h>
+#include <string.h>
+#include "SciCall.h"
+#include "Helpers.h"
+#include "Notepad2.h"
+#include "Edit.h"
+#include "Compare.h"
+#include "resource.h"
+
+// Lines of both texts are hashed in parallel slices, then numbered with a hash table, so lines
+// with same content get same number and the diff only compares integers. Histogram diff (as in
+// git's xhistogram.c) takes the longest run of common lines around the rarest common line, then
+// diffs both sides of the run, ranges are kept on a stack instead of recursion. It's near linear
+// for real world files, lines repeated many times are not used for the run, small ranges without
+// other common line are compared with LCS table.
+
+extern int iDefaultEncoding;
+
+#define COMPARE_MAX_FILE_SIZE		(512*1024*1024)
+// lines occurring more often are not used to find the run
+#define COMPARE_MAX_OCCURRENCE		64
+// ranges without such line are compared with LCS table when small enough
+#define COMPARE_MAX_LCS_CELLS		(1024*1024)
+#define COMPARE_SLICE_LINES			(16*1024)
+#define COMPARE_PARALLEL_MIN_LINES	(64*1024)
+// removed lines shown for each difference
+#define COMPARE_MAX_ANNOTATION_LINES	100
+// changed characters are only indicated for shorter lines
+#define COMPARE_MAX_INLINE_LENGTH	4096
+#define COMPARE_NO_LINE				UINT_MAX
+
+#define CompareAddedColor			RGB(0x40, 0xC0, 0x40)
+#define CompareChangedColor			RGB(0xFF, 0xB0, 0x00)
+#define CompareRemovedColor			RGB(0xFF, 0x40, 0x40)
+#define CompareLineAlpha			48
+#define CompareCharacterAlpha		100
+
+typedef struct CompareText {
+	const char *text;
+	Sci_Position *starts;	// start of each line, and end of text
+	uint64_t *hashes;
+	uint32_t *ids;			// lines with same content have same number
+	uint8_t *changed;
+	uint32_t lineCount;
+} CompareText;
+
+typedef struct CompareHashWorker {
+	CompareText *sides[2];
+	uint32_t sliceCount[2];
+	volatile LONG nextSlice;
+} CompareHashWorker;
+
+typedef struct CompareLineClass {
+	uint64_t hash;
+	const char *text;
+	Sci_Position length;
+} CompareLineClass;
+
+typedef struct CompareRange {
+	uint32_t a0;
+	uint32_t a1;
+	uint32_t b0;
+	uint32_t b1;
+} CompareRange;
+
+typedef struct CompareDiff {
+	const uint32_t *a;
+	const uint32_t *b;
+	uint32_t *head;			// first occurrence of each line class in current range of a
+	uint32_t *count;		// occurrences of each line class in current range of a
+	uint32_t *next;			// next occurrence of same line class in a
+	CompareRange *stack;
+	uint32_t stackSize;
+	uint32_t stackCapacity;
+} CompareDiff;
+
+typedef struct CompareAnnotation {
+	char *text;
+	size_t length;
+	size_t capacity;
+	Sci_Line line;
+	uint32_t lineCount;
+} CompareAnnotation;
+
+static BOOL bCompareActive;
+
+static inline Sci_Position Compare_LineLength(const CompareText *side, uint32_t line) {
+	const Sci_Position start = side->starts[line];
+	Sci_Position end = side->starts[line + 1];
+	if (end > start && side->text[end - 1] == '\n') {
+		--end;
+	}
+	if (end > start && side->text[end - 1] == '\r') {
+		--end;
+	}
+	return end - start;
+}
+
+static inline uint64_t Compare_HashLine(const char *text, Sci_Position length) {
+	uint64_t hash = 0x9E3779B97F4A7C15ULL ^ (uint64_t)length;
+	while (length >= 8) {
+		uint64_t value;
+		memcpy(&value, text, sizeof(value));
+		hash = (hash ^ value) * 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 32;
+		text += 8;
+		length -= 8;
+	}
+	if (length != 0) {
+		uint64_t value = 0;
+		memcpy(&value, text, length);
+		hash = (hash ^ value) * 0xC4CEB9FE1A85EC53ULL;
+		hash ^= hash >> 29;
+	}
+	return hash;
+}
+
+static DWORD WINAPI Compare_HashThread(LPVOID lpParam) {
+	CompareHashWorker *worker = (CompareHashWorker *)lpParam;
+	const uint32_t sliceCount = worker->sliceCount[0] + worker->sliceCount[1];
+	while (TRUE) {
+		uint32_t slice = (uint32_t)InterlockedIncrement(&worker->nextSlice) - 1;
+		if (slice >= sliceCount) {
+			break;
+		}
+		CompareText *side = worker->sides[0];
+		if (slice >= worker->sliceCount[0]) {
+			slice -= worker->sliceCount[0];
+			side = worker->sides[1];
+		}
+		const uint32_t first = slice*COMPARE_SLICE_LINES;
+		const uint32_t last = min_u(first + COMPARE_SLICE_LINES, side->lineCount);
+		for (uint32_t line = first; line < last; line++) {
+			side->hashes[line] = Compare_HashLine(side->text + side->starts[line], Compare_LineLength(side, line));
+		}
+	}
+	return 0;
+}
+
+static BOOL Compare_AllocLines(CompareText *side) {
+	const size_t count = side->lineCount;
+	side->hashes = (uint64_t *)NP2HeapAlloc(count * sizeof(uint64_t));
+	side->ids = (uint32_t *)NP2HeapAlloc(count * sizeof(uint32_t));
+	side->changed = (uint8_t *)NP2HeapAlloc(count + 1);
+	return side->hashes != NULL && side->ids != NULL && side->changed != NULL;
+}
+
+static void Compare_FreeText(CompareText *side) {
+	if (side->starts) {
+		NP2HeapFree(side->starts);
+	}
+	if (side->hashes) {
+		NP2HeapFree(side->hashes);
+	}
+	if (side->ids) {
+		NP2HeapFree(side->ids);
+	}
+	if (side->changed) {
+		NP2HeapFree(side->changed);
+	}
+}
+
+// lines end with CR+LF, LF or CR, same as document.
+static BOOL Compare_SplitLines(CompareText *side, const char *text, Sci_Position length) {
+	uint32_t lineCount = 1;
+	for (Sci_Position offset = 0; offset < length; offset++) {
+		const char ch = text[offset];
+		if (ch == '\n' || (ch == '\r' && (offset + 1 == length || text[offset + 1] != '\n'))) {
+			++lineCount;
+		}
+	}
+
+	Sci_Position *starts = (Sci_Position *)NP2HeapAlloc((lineCount + 1) * sizeof(Sci_Position));
+	if (starts == NULL) {
+		return FALSE;
+	}
+	uint32_t line = 1;
+	for (Sci_Position offset = 0; offset < length; offset++) {
+		const char ch = text[offset];
+		if (ch == '\n' || (ch == '\r' && (offset + 1 == length || text[offset + 1] != '\n'))) {
+			starts[line++] = offset + 1;
+		}
+	}
+	starts[lineCount] = length;
+	side->text = text;
+	side->starts = starts;
+	side->lineCount = lineCount;
+	return Compare_AllocLines(side);
+}
+
+static BOOL Compare_DocumentLines(CompareText *side) {
+	const Sci_Position length = SciCall_GetLength();
+	const Sci_Line lineCount = SciCall_GetLineCount();
+	Sci_Position *starts = (Sci_Position *)NP2HeapAlloc((lineCount + 1) * sizeof(Sci_Position));
+	if (starts == NULL) {
+		return FALSE;
+	}
+	for (Sci_Line line = 0; line < lineCount; line++) {
+		starts[line] = SciCall_PositionFromLine(line);
+	}
+	starts[lineCount] = length;
+	// document is not modified until comparison is done.
+	side->text = SciCall_GetRangePointer(0, length);
+	side->starts = starts;
+	side->lineCount = (uint32_t)lineCount;
+	return Compare_AllocLines(side);
+}
+
+// number lines of both texts, returns count of distinct lines.
+static uint32_t Compare_NumberLines(CompareText *old, CompareText *cur) {
+	const uint32_t total = old->lineCount + cur->lineCount;
+	uint32_t capacity = 1024;
+	while (capacity < total*2) {
+		capacity <<= 1;
+	}
+	const uint32_t mask = capacity - 1;
+	uint32_t *table = (uint32_t *)NP2HeapAlloc(capacity * sizeof(uint32_t));
+	CompareLineClass *classes = (CompareLineClass *)NP2HeapAlloc(total * sizeof(CompareLineClass));
+	uint32_t classCount = 0;
+	if (table != NULL && classes != NULL) {
+		CompareText * const sides[2] = { old, cur };
+		for (int i = 0; i < 2; i++) {
+			CompareText * const side = sides[i];
+			for (uint32_t line = 0; line < side->lineCount; line++) {
+				const uint64_t hash = side->hashes[line];
+				const char *text = side->text + side->starts[line];
+				const Sci_Position length = Compare_LineLength(side, line);
+				uint32_t index = (uint32_t)(hash ^ (hash >> 32)) & mask;
+				while (TRUE) {
+					const uint32_t slot = table[index];
+					if (slot == 0) {
+						CompareLineClass * const cls = &classes[classCount++];
+						cls->hash = hash;
+						cls->text = text;
+						cls->length = length;
+						table[index] = classCount;
+						side->ids[line] = classCount - 1;
+						break;
+					}
+					const CompareLineClass * const cls = &classes[slot - 1];
+					if (cls->hash == hash && cls->length == length && memcmp(cls->text, text, length) == 0) {
+						side->ids[line] = slot - 1;
+						break;
+					}
+					index = (index + 1) & mask;
+				}
+			}
+		}
+	}
+	if (table != NULL) {
+		NP2HeapFree(table);
+	}
+	if (classes != NULL) {
+		NP2HeapFree(classes);
+	}
+	return classCount;
+}
+
+static BOOL Compare_PushRange(CompareDiff *diff, uint32_t a0, uint32_t a1, uint32_t b0, uint32_t b1) {
+	if (diff->stackSize == diff->stackCapacity) {
+		const uint32_t capacity = max_u(diff->stackCapacity*2, 256);
+		CompareRange *stack = (CompareRange *)((diff->stack == NULL) ? NP2HeapAlloc(capacity * sizeof(CompareRange))
+			: NP2HeapReAlloc(diff->stack, capacity * sizeof(CompareRange)));
+		if (stack == NULL) {
+			return FALSE;
+		}
+		diff->stack = stack;
+		diff->stackCapacity = capacity;
+	}
+	CompareRange * const range = &diff->stack[diff->stackSize++];
+	range->a0 = a0;
+	range->a1 = a1;
+	range->b0 = b0;
+	range->b1 = b1;
+	return TRUE;
+}
+
+// longest run of common lines around the rarest common line.
+static BOOL Compare_FindRun(CompareDiff *diff, const CompareRange *range, CompareRange *run) {
+	const uint32_t * const a = diff->a;
+	const uint32_t * const b = diff->b;
+	uint32_t * const head = diff->head;
+	uint32_t * const count = diff->count;
+	uint32_t * const next = diff->next;
+	for (uint32_t i = range->a1; i > range->a0; ) {
+		--i;
+		const uint32_t id = a[i];
+		next[i] = head[id];
+		head[id] = i;
+		count[id] += 1;
+	}
+
+	BOOL found = FALSE;
+	uint32_t bestCount = UINT_MAX;
+	uint32_t bestLength = 0;
+	for (uint32_t j = range->b0; j < range->b1; ) {
+		uint32_t jNext = j + 1;
+		const uint32_t occurrence = count[b[j]];
+		if (occurrence != 0 && occurrence <= bestCount && occurrence <= COMPARE_MAX_OCCURRENCE) {
+			uint32_t i = head[b[j]];
+			while (i != COMPARE_NO_LINE) {
+				uint32_t as = i;
+				uint32_t bs = j;
+				uint32_t ae = i + 1;
+				uint32_t be = j + 1;
+				uint32_t rc = occurrence;
+				while (as > range->a0 && bs > range->b0 && a[as - 1] == b[bs - 1]) {
+					--as;
+					--bs;
+					if (rc > 1) {
+						rc = min_u(rc, count[a[as]]);
+					}
+				}
+				while (ae < range->a1 && be < range->b1 && a[ae] == b[be]) {
+					if (rc > 1) {
+						rc = min_u(rc, count[a[ae]]);
+					}
+					++ae;
+					++be;
+				}
+				jNext = max_u(jNext, be);
+				if (ae - as > bestLength || rc < bestCount) {
+					run->a0 = as;
+					run->a1 = ae;
+					run->b0 = bs;
+					run->b1 = be;
+					bestLength = ae - as;
+					bestCount = rc;
+					found = TRUE;
+				}
+				// skip occurrences inside the run
+				do {
+					i = next[i];
+				} while (i != COMPARE_NO_LINE && i < ae);
+			}
+		}
+		j = jNext;
+	}
+
+	for (uint32_t i = range->a0; i < range->a1; i++) {
+		head[a[i]] = COMPARE_NO_LINE;
+		count[a[i]] = 0;
+	}
+	return found;
+}
+
+// longest common subsequence for small range without rare common line.
+static BOOL Compare_DiffSmall(const CompareDiff *diff, const CompareRange *range, CompareText *old, CompareText *cur) {
+	const uint32_t rows = range->a1 - range->a0;
+	const uint32_t columns = range->b1 - range->b0;
+	// length of common subsequence of a[i:] and b[j:]
+	uint32_t *table = (uint32_t *)NP2HeapAlloc((size_t)(rows + 1) * (columns + 1) * sizeof(uint32_t));
+	if (table == NULL) {
+		return FALSE;
+	}
+	const uint32_t stride = columns + 1;
+	for (uint32_t i = rows; i > 0; ) {
+		--i;
+		uint32_t * const row = table + (size_t)i * stride;
+		for (uint32_t j = columns; j > 0; ) {
+			--j;
+			if (diff->a[range->a0 + i] == diff->b[range->b0 + j]) {
+				row[j] = row[j + stride + 1] + 1;
+			} else {
+				row[j] = max_u(row[j + stride], row[j + 1]);
+			}
+		}
+	}
+
+	uint32_t i = 0;
+	uint32_t j = 0;
+	while (i < rows && j < columns) {
+		if (diff->a[range->a0 + i] == diff->b[range->b0 + j]) {
+			++i;
+			++j;
+		} else if (table[(size_t)(i + 1) * stride + j] >= table[(size_t)i * stride + j + 1]) {
+			old->changed[range->a0 + i] = TRUE;
+			++i;
+		} else {
+			cur->changed[range->b0 + j] = TRUE;
+			++j;
+		}
+	}
+	memset(old->changed + range->a0 + i, TRUE, rows - i);
+	memset(cur->changed + range->b0 + j, TRUE, columns - j);
+	NP2HeapFree(table);
+	return TRUE;
+}
+
+static BOOL Compare_Diff(CompareText *old, CompareText *cur, uint32_t classCount) {
+	CompareDiff diff;
+	ZeroMemory(&diff, sizeof(diff));
+	diff.a = old->ids;
+	diff.b = cur->ids;
+	diff.head = (uint32_t *)NP2HeapAlloc(classCount * sizeof(uint32_t));
+	diff.count = (uint32_t *)NP2HeapAlloc(classCount * sizeof(uint32_t));
+	diff.next = (uint32_t *)NP2HeapAlloc(old->lineCount * sizeof(uint32_t));
+	BOOL success = diff.head != NULL && diff.count != NULL && diff.next != NULL
+		&& Compare_PushRange(&diff, 0, old->lineCount, 0, cur->lineCount);
+	if (success) {
+		memset(diff.head, 0xff, classCount * sizeof(uint32_t));
+	}
+
+	while (success && diff.stackSize != 0) {
+		CompareRange range = diff.stack[--diff.stackSize];
+		while (range.a0 < range.a1 && range.b0 < range.b1 && diff.a[range.a0] == diff.b[range.b0]) {
+			++range.a0;
+			++range.b0;
+		}
+		while (range.a0 < range.a1 && range.b0 < range.b1 && diff.a[range.a1 - 1] == diff.b[range.b1 - 1]) {
+			--range.a1;
+			--range.b1;
+		}
+		CompareRange run;
+		if (range.a0 == range.a1 || range.b0 == range.b1) {
+			memset(old->changed + range.a0, TRUE, range.a1 - range.a0);
+			memset(cur->changed + range.b0, TRUE, range.b1 - range.b0);
+		} else if (!Compare_FindRun(&diff, &range, &run)) {
+			if ((uint64_t)(range.a1 - range.a0 + 1) * (range.b1 - range.b0 + 1) <= COMPARE_MAX_LCS_CELLS) {
+				success = Compare_DiffSmall(&diff, &range, old, cur);
+			} else {
+				memset(old->changed + range.a0, TRUE, range.a1 - range.a0);
+				memset(cur->changed + range.b0, TRUE, range.b1 - range.b0);
+			}
+		} else {
+			success = Compare_PushRange(&diff, range.a0, run.a0, range.b0, run.b0)
+				&& Compare_PushRange(&diff, run.a1, range.a1, run.b1, range.b1);
+		}
+	}
+
+	if (diff.head) {
+		NP2HeapFree(diff.head);
+	}
+	if (diff.count) {
+		NP2HeapFree(diff.count);
+	}
+	if (diff.next) {
+		NP2HeapFree(diff.next);
+	}
+	if (diff.stack) {
+		NP2HeapFree(diff.stack);
+	}
+	return success;
+}
+
+static void Compare_AppendAnnotation(CompareAnnotation *annotation, const char *text, size_t length) {
+	const size_t needed = annotation->length + length + 2;
+	if (needed > annotation->capacity) {
+		const size_t capacity = max_pos(annotation->capacity*2, needed + 256);
+		char *buffer = (char *)((annotation->text == NULL) ? NP2HeapAlloc(capacity) : NP2HeapReAlloc(annotation->text, capacity));
+		if (buffer == NULL) {
+			return;
+		}
+		annotation->text = buffer;
+		annotation->capacity = capacity;
+	}
+	if (annotation->length != 0) {
+		annotation->text[annotation->length++] = '\n';
+	}
+	memcpy(annotation->text + annotation->length, text, length);
+	annotation->length += length;
+	annotation->text[annotation->length] = '\0';
+}
+
+static void Compare_FlushAnnotation(CompareAnnotation *annotation, UINT cpEdit) {
+	if (annotation->length != 0) {
+		if (annotation->lineCount > COMPARE_MAX_ANNOTATION_LINES) {
+			WCHAR wchFormat[128];
+			WCHAR wchMessage[128];
+			char message[128*kMaxMultiByteCount];
+			GetString(IDS_COMPARE_MORE_LINES, wchFormat, COUNTOF(wchFormat));
+			wsprintf(wchMessage, wchFormat, (int)(annotation->lineCount - COMPARE_MAX_ANNOTATION_LINES));
+			const int length = WideCharToMultiByte(cpEdit, 0, wchMessage, -1, message, COUNTOF(message), NULL, NULL);
+			Compare_AppendAnnotation(annotation, message, max_i(length - 1, 0));
+		}
+		SciCall_AnnotationSetText(annotation->line, annotation->text);
+		SciCall_AnnotationSetStyle(annotation->line, 0);
+	}
+	annotation->length = 0;
+	annotation->lineCount = 0;
+}
+
+// removed lines are shown below previous line.
+static void Compare_AddRemovedLines(CompareAnnotation *annotation, const CompareText *old, uint32_t a0, uint32_t a1, Sci_Line line, UINT cpEdit) {
+	if (line != annotation->line) {
+		Compare_FlushAnnotation(annotation, cpEdit);
+		annotation->line = line;
+	}
+	for (uint32_t i = a0; i < a1; i++) {
+		if (annotation->lineCount < COMPARE_MAX_ANNOTATION_LINES) {
+			Compare_AppendAnnotation(annotation, old->text + old->starts[i], Compare_LineLength(old, i));
+		}
+		++annotation->lineCount;
+	}
+}
+
+// indicate changed characters between common prefix and suffix of paired lines.
+static void Compare_AddChangedCharacters(const CompareText *old, const CompareText *cur, uint32_t a, uint32_t b, BOOL utf8) {
+	const Sci_Position oldLength = Compare_LineLength(old, a);
+	const Sci_Position length = Compare_LineLength(cur, b);
+	if (oldLength > COMPARE_MAX_INLINE_LENGTH || length > COMPARE_MAX_INLINE_LENGTH) {
+		return;
+	}
+	const char *oldText = old->text + old->starts[a];
+	const char *text = cur->text + cur->starts[b];
+	Sci_Position prefix = 0;
+	const Sci_Position shorter = min_pos(oldLength, length);
+	while (prefix < shorter && oldText[prefix] == text[prefix]) {
+		++prefix;
+	}
+	Sci_Position suffix = 0;
+	while (suffix < shorter - prefix && oldText[oldLength - suffix - 1] == text[length - suffix - 1]) {
+		++suffix;
+	}
+	if (utf8) {
+		while (prefix > 0 && prefix < length && (text[prefix] & 0xC0) == 0x80) {
+			--prefix;
+		}
+		while (suffix > 0 && (text[length - suffix] & 0xC0) == 0x80) {
+			--suffix;
+		}
+	}
+	if (length - prefix - suffix > 0) {
+		SciCall_IndicatorFillRange(cur->starts[b] + prefix, length - prefix - suffix);
+	}
+}
+
+static void Compare_SetStyles(void) {
+	SciCall_MarkerSetBackTranslucent(MarkerNumber_DiffAdded, ColorAlpha(CompareAddedColor, CompareLineAlpha));
+	SciCall_MarkerSetLayer(MarkerNumber_DiffAdded, SC_LAYER_OVER_TEXT);
+	SciCall_MarkerDefine(MarkerNumber_DiffAdded, SC_MARK_BACKGROUND);
+	SciCall_MarkerSetBackTranslucent(MarkerNumber_DiffChanged, ColorAlpha(CompareChangedColor, CompareLineAlpha));
+	SciCall_MarkerSetLayer(MarkerNumber_DiffChanged, SC_LAYER_OVER_TEXT);
+	SciCall_MarkerDefine(MarkerNumber_DiffChanged, SC_MARK_BACKGROUND);
+	SciCall_MarkerSetBackTranslucent(MarkerNumber_DiffRemoved, ColorAlpha(CompareRemovedColor, SC_ALPHA_OPAQUE));
+	SciCall_MarkerDefine(MarkerNumber_DiffRemoved, SC_MARK_UNDERLINE);
+
+	SciCall_IndicSetStyle(IndicatorNumber_DiffChange, INDIC_FULLBOX);
+	SciCall_IndicSetFore(IndicatorNumber_DiffChange, CompareChangedColor);
+	SciCall_IndicSetAlpha(IndicatorNumber_DiffChange, CompareCharacterAlpha);
+
+	// removed lines use default font on reddish background
+	const COLORREF back = SciCall_StyleGetBack(STYLE_DEFAULT);
+	const UINT red = (GetRValue(back)*(256 - CompareLineAlpha) + GetRValue(CompareRemovedColor)*CompareLineAlpha) >> 8;
+	const UINT green = (GetGValue(back)*(256 - CompareLineAlpha) + GetGValue(CompareRemovedColor)*CompareLineAlpha) >> 8;
+	const UINT blue = (GetBValue(back)*(256 - CompareLineAlpha) + GetBValue(CompareRemovedColor)*CompareLineAlpha) >> 8;
+	// extended styles are released when document is changed
+	SciCall_ReleaseAllExtendedStyles();
+	const int style = SciCall_AllocateExtendedStyles(1);
+	SciCall_AnnotationSetStyleOffset(style);
+	SciCall_StyleSetFore(style, SciCall_StyleGetFore(STYLE_DEFAULT));
+	SciCall_StyleSetBack(style, RGB(red, green, blue));
+	SciCall_AnnotationSetVisible(ANNOTATION_STANDARD);
+}
+
+// load file text in code page of current document.
+static char *Compare_LoadText(LPCWSTR pszFile, Sci_Position *pcbText) {
+	HANDLE hFile = CreateFile(pszFile,
+					   GENERIC_READ,
+					   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+					   NULL, OPEN_EXISTING,
+					   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+					   NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart > COMPARE_MAX_FILE_SIZE) {
+		CloseHandle(hFile);
+		SetLastError(ERROR_FILE_TOO_LARGE);
+		return NULL;
+	}
+
+	DWORD cbData = (DWORD)fileSize.QuadPart;
+	char *lpData = (char *)NP2HeapAlloc(cbData + 16);
+	DWORD cbRead = 0;
+	const BOOL bRead = lpData != NULL && ReadFile(hFile, lpData, cbData, &cbRead, NULL) && cbRead == cbData;
+	CloseHandle(hFile);
+	if (!bRead) {
+		if (lpData != NULL) {
+			NP2HeapFree(lpData);
+		}
+		return NULL;
+	}
+
+	const UINT cpEdit = SciCall_GetCodePage();
+	LPWSTR lpDataWide = NULL;
+	int cchDataWide = 0;
+	BOOL bBOM = FALSE;
+	BOOL bReverse = FALSE;
+	if (IsUTF8Signature(lpData)) {
+		cbData -= min_u(cbData, 3);
+		memmove(lpData, lpData + 3, cbData);
+		lpData[cbData] = '\0';
+	}
+	if (cbData == 0) {
+		*pcbText = 0;
+		return lpData;
+	}
+	if (IsUnicode(lpData, cbData, &bBOM, &bReverse)) {
+		if (bReverse) {
+			_swab(lpData, lpData, cbData);
+		}
+		lpDataWide = (LPWSTR)lpData;
+		cchDataWide = (int)(cbData / sizeof(WCHAR));
+		if (bBOM) {
+			++lpDataWide;
+			--cchDataWide;
+		}
+	} else {
+		UINT uCodePage = CP_UTF8;
+		if (!IsUTF8(lpData, cbData)) {
+			if (cpEdit != SC_CP_UTF8) {
+				uCodePage = cpEdit;
+			} else {
+				const UINT uFlags = mEncoding[iDefaultEncoding].uFlags;
+				uCodePage = (uFlags & (NCP_8BIT | NCP_7BIT)) ? mEncoding[iDefaultEncoding].uCodePage : CP_ACP;
+				const int iDetected = DetectDBCSEncoding(lpData, cbData);
+				if (iDetected != CPI_NONE) {
+					uCodePage = mEncoding[iDetected].uCodePage;
+				}
+			}
+		}
+		if (uCodePage == cpEdit) {
+			*pcbText = cbData;
+			return lpData;
+		}
+		lpDataWide = (LPWSTR)NP2HeapAlloc((cbData + 1) * sizeof(WCHAR));
+		if (lpDataWide == NULL) {
+			NP2HeapFree(lpData);
+			return NULL;
+		}
+		cchDataWide = MultiByteToWideChar(uCodePage, 0, lpData, cbData, lpDataWide, cbData + 1);
+		NP2HeapFree(lpData);
+		lpData = (char *)lpDataWide;
+	}
+
+	const int cbText = WideCharToMultiByte(cpEdit, 0, lpDataWide, cchDataWide, NULL, 0, NULL, NULL);
+	char *lpText = (char *)NP2HeapAlloc(cbText + 16);
+	if (lpText != NULL) {
+		*pcbText = WideCharToMultiByte(cpEdit, 0, lpDataWide, cchDataWide, lpText, cbText, NULL, NULL);
+	}
+	NP2HeapFree(lpData);
+	return lpText;
+}
+
+BOOL Compare_WithFile(LPCWSTR pszFile) {
+	Sci_Position cbText = 0;
+	char *lpText = Compare_LoadText(pszFile, &cbText);
+	if (lpText == NULL) {
+		return FALSE;
+	}
+
+	Compare_Clear();
+	CompareText old;
+	CompareText cur;
+	ZeroMemory(&old, sizeof(old));
+	ZeroMemory(&cur, sizeof(cur));
+	BOOL success = Compare_SplitLines(&old, lpText, cbText) && Compare_DocumentLines(&cur);
+	if (success) {
+		CompareHashWorker worker;
+		ZeroMemory(&worker, sizeof(worker));
+		worker.sides[0] = &old;
+		worker.sides[1] = &cur;
+		worker.sliceCount[0] = (old.lineCount + COMPARE_SLICE_LINES - 1) / COMPARE_SLICE_LINES;
+		worker.sliceCount[1] = (cur.lineCount + COMPARE_SLICE_LINES - 1) / COMPARE_SLICE_LINES;
+		if (old.lineCount + cur.lineCount >= COMPARE_PARALLEL_MIN_LINES) {
+			RunOnAllProcessors(Compare_HashThread, &worker, worker.sliceCount[0] + worker.sliceCount[1]);
+		} else {
+			Compare_HashThread(&worker);
+		}
+		const uint32_t classCount = Compare_NumberLines(&old, &cur);
+		success = classCount != 0 && Compare_Diff(&old, &cur, classCount);
+	}
+
+	if (success) {
+		const UINT cpEdit = SciCall_GetCodePage();
+		const BOOL utf8 = cpEdit == SC_CP_UTF8;
+		CompareAnnotation annotation;
+		ZeroMemory(&annotation, sizeof(annotation));
+		annotation.line = -1;
+		int differences = 0;
+		int added = 0;
+		int removed = 0;
+		Compare_SetStyles();
+		SciCall_SetIndicatorCurrent(IndicatorNumber_DiffChange);
+
+		uint32_t a = 0;
+		uint32_t b = 0;
+		while (a < old.lineCount || b < cur.lineCount) {
+			if (!old.changed[a] && !cur.changed[b]) {
+				++a;
+				++b;
+				continue;
+			}
+			const uint32_t a0 = a;
+			const uint32_t b0 = b;
+			while (old.changed[a]) {
+				++a;
+			}
+			while (cur.changed[b]) {
+				++b;
+			}
+			++differences;
+			added += b - b0;
+			removed += a - a0;
+			if (a != a0) {
+				const Sci_Line line = (b0 != 0) ? b0 - 1 : 0;
+				Compare_AddRemovedLines(&annotation, &old, a0, a, line, cpEdit);
+				if (b == b0) {
+					SciCall_MarkerAdd(line, MarkerNumber_DiffRemoved);
+				}
+			}
+			const int marker = (a == a0) ? MarkerNumber_DiffAdded : MarkerNumber_DiffChanged;
+			for (uint32_t line = b0; line < b; line++) {
+				SciCall_MarkerAdd(line, marker);
+				if (line - b0 < a - a0) {
+					Compare_AddChangedCharacters(&old, &cur, a0 + line - b0, line, utf8);
+				}
+			}
+		}
+		Compare_FlushAnnotation(&annotation, cpEdit);
+		if (annotation.text) {
+			NP2HeapFree(annotation.text);
+		}
+
+		bCompareActive = differences != 0;
+		if (differences == 0) {
+			ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_COMPARE_IDENTICAL);
+		} else {
+			ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_COMPARE_RESULT, differences, added, removed);
+		}
+	}
+
+	Compare_FreeText(&old);
+	Compare_FreeText(&cur);
+	NP2HeapFree(lpText);
+	if (!success) {
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+	}
+	return success;
+}
+
+void Compare_Clear(void) {
+	if (bCompareActive) {
+		bCompareActive = FALSE;
+		SciCall_MarkerDeleteAll(MarkerNumber_DiffAdded);
+		SciCall_MarkerDeleteAll(MarkerNumber_DiffChanged);
+		SciCall_MarkerDeleteAll(MarkerNumber_DiffRemoved);
+		SciCall_SetIndicatorCurrent(IndicatorNumber_DiffChange);
+		SciCall_IndicatorClearRange(0, SciCall_GetLength());
+		SciCall_AnnotationClearAll();
+		SciCall_AnnotationSetVisible(ANNOTATION_HIDDEN);
+	}
+}
+
+BOOL Compare_IsActive(void) {
+	return bCompareActive;
+}
+
+Sci_Line Compare_FindDifference(BOOL next) {
+	Sci_Line line = SciCall_LineFromPosition(SciCall_GetCurrentPos());
+	if (next) {
+		// skip current difference
+		const Sci_Line current = line;
+		while (SciCall_MarkerGet(line) & MarkerBitmask_DiffLines) {
+			++line;
+		}
+		line = SciCall_MarkerNext(line + (line == current), MarkerBitmask_Diff);
+	} else {
+		while (line > 0 && (SciCall_MarkerGet(line) & SciCall_MarkerGet(line - 1) & MarkerBitmask_DiffLines)) {
+			--line;
+		}
+		line = SciCall_MarkerPrevious(line - 1, MarkerBitmask_Diff);
+		while (line > 0 && (SciCall_MarkerGet(line) & SciCall_MarkerGet(line - 1) & MarkerBitmask_DiffLines)) {
+			--line;
+		}
+	}
+	return line;
+}
+
+void Compare_OnStyleChanged(void) {
+	if (bCompareActive) {
+		Compare_SetStyles();
+	}
+}
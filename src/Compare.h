@@ -0,0 +1,11 @@
+// File Compare
+#pragma once
+
+// compares current document (new text) with a file (old text): added and changed lines are marked,
+// changed characters are indicated, removed lines are shown as annotation below previous line.
+BOOL Compare_WithFile(LPCWSTR pszFile);
+void Compare_Clear(void);
+BOOL Compare_IsActive(void);
+// first line of next or previous difference, -1 when not found.
+Sci_Line Compare_FindDifference(BOOL next);
+void Compare_OnStyleChanged(void);
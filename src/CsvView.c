@@ -0,0 +1,639 @@
+// CSV Column Mode
+
+#include <windows.h>
+#include <string.h>
+#include "SciCall.h"
+#include "VectorISA.h"
+#include "Helpers.h"
+#include "Notepad2.h"
+#include "CsvView.h"
+
+// Fields are aligned to tab stops shared by all lines (SCI_ADDTABSTOP on line -1), Scintilla
+// moves text after each tab, or after each delimiter outside quotes set by SCI_SETFIELDDELIMITER,
+// to the next stop. Stops come from the widest field of each column, which is indexed for
+// blocks of lines: edits only resize blocks and mark blocks of changed lines dirty, dirty blocks
+// are scanned again by a timer in slices, so huge documents stay responsive while indexing.
+
+#define CSV_BLOCK_LINES			1024
+// bytes scanned for each timer tick
+#define CSV_INDEX_SLICE_SIZE	(4*1024*1024)
+#define CSV_INDEX_TIMER_DELAY	10
+#define CSV_MAX_COLUMNS			1024
+// longer field pushes remaining fields of the line to following stops
+#define CSV_MAX_FIELD_WIDTH		64
+// spaces between widest field and next column
+#define CSV_COLUMN_PADDING		2
+#define CSV_SCAN_BLOCK_SIZE		32
+#define CSV_DETECT_SIZE			(64*1024)
+
+typedef struct CsvBlock {
+	Sci_Line lineCount;
+	int columnCount;
+	BOOL dirty;
+	uint8_t *widths;		// widest field of each column in character cells
+} CsvBlock;
+
+typedef struct CsvViewData {
+	HWND hwnd;
+	BOOL enabled;
+	BOOL timer;
+	BOOL utf8;
+	char delimiter;
+	int blockCount;
+	int blockCapacity;
+	int firstDirty;			// blocks before it are indexed
+	CsvBlock *blocks;
+	int charWidth;			// applied tab stops
+	int columnCount;
+	uint8_t widths[CSV_MAX_COLUMNS];
+} CsvViewData;
+
+static CsvViewData csvView;
+
+static void CsvView_IndexSlice(void);
+
+static void CALLBACK CsvView_IndexTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
+	UNREFERENCED_PARAMETER(hwnd);
+	UNREFERENCED_PARAMETER(uMsg);
+	UNREFERENCED_PARAMETER(idEvent);
+	UNREFERENCED_PARAMETER(dwTime);
+	CsvView_IndexSlice();
+}
+
+static void CsvView_StartIndex(void) {
+	CsvViewData * const cv = &csvView;
+	if (!cv->timer) {
+		cv->timer = TRUE;
+		SetTimer(cv->hwnd, ID_CSVINDEXTIMER, CSV_INDEX_TIMER_DELAY, CsvView_IndexTimerProc);
+	}
+}
+
+static void CsvView_StopIndex(void) {
+	CsvViewData * const cv = &csvView;
+	if (cv->timer) {
+		cv->timer = FALSE;
+		KillTimer(cv->hwnd, ID_CSVINDEXTIMER);
+	}
+}
+
+static void CsvView_FreeBlocks(void) {
+	CsvViewData * const cv = &csvView;
+	for (int index = 0; index < cv->blockCount; index++) {
+		if (cv->blocks[index].widths) {
+			NP2HeapFree(cv->blocks[index].widths);
+		}
+	}
+	if (cv->blocks) {
+		NP2HeapFree(cv->blocks);
+	}
+	cv->blocks = NULL;
+	cv->blockCount = 0;
+	cv->blockCapacity = 0;
+}
+
+// insert count empty dirty blocks before index.
+static void CsvView_InsertBlocks(int index, int count) {
+	CsvViewData * const cv = &csvView;
+	if (cv->blockCount + count > cv->blockCapacity) {
+		const int capacity = max_i(cv->blockCount + count, cv->blockCapacity*2);
+		cv->blocks = (CsvBlock *)((cv->blocks == NULL) ? NP2HeapAlloc(capacity * sizeof(CsvBlock))
+			: NP2HeapReAlloc(cv->blocks, capacity * sizeof(CsvBlock)));
+		cv->blockCapacity = capacity;
+	}
+	memmove(cv->blocks + index + count, cv->blocks + index, (cv->blockCount - index) * sizeof(CsvBlock));
+	memset(cv->blocks + index, 0, count * sizeof(CsvBlock));
+	for (int i = 0; i < count; i++) {
+		cv->blocks[index + i].dirty = TRUE;
+	}
+	cv->blockCount += count;
+}
+
+static void CsvView_InitBlocks(void) {
+	CsvViewData * const cv = &csvView;
+	CsvView_FreeBlocks();
+	const Sci_Line lineCount = SciCall_GetLineCount();
+	const int count = (int)((lineCount + CSV_BLOCK_LINES - 1) / CSV_BLOCK_LINES);
+	CsvView_InsertBlocks(0, count);
+	for (int index = 0; index < count; index++) {
+		cv->blocks[index].lineCount = CSV_BLOCK_LINES;
+	}
+	cv->blocks[count - 1].lineCount = lineCount - (Sci_Line)(count - 1)*CSV_BLOCK_LINES;
+	cv->firstDirty = 0;
+	CsvView_StartIndex();
+}
+
+// spread lines of a grown block over blocks of CSV_BLOCK_LINES lines.
+static void CsvView_SplitBlock(int index) {
+	CsvViewData * const cv = &csvView;
+	const Sci_Line lineCount = cv->blocks[index].lineCount;
+	const int count = (int)((lineCount + CSV_BLOCK_LINES - 1) / CSV_BLOCK_LINES);
+	CsvView_InsertBlocks(index + 1, count - 1);
+	for (int i = 0; i < count; i++) {
+		cv->blocks[index + i].lineCount = CSV_BLOCK_LINES;
+	}
+	cv->blocks[index + count - 1].lineCount = lineCount - (Sci_Line)(count - 1)*CSV_BLOCK_LINES;
+}
+
+static void CsvView_RemoveEmptyBlocks(int index) {
+	CsvViewData * const cv = &csvView;
+	int count = index;
+	for (; index < cv->blockCount; index++) {
+		CsvBlock * const block = &cv->blocks[index];
+		if (block->lineCount != 0) {
+			cv->blocks[count++] = *block;
+		} else if (block->widths) {
+			NP2HeapFree(block->widths);
+		}
+	}
+	cv->blockCount = count;
+}
+
+static inline void CsvView_AddField(CsvBlock *block, int column, Sci_Position width) {
+	if (column < CSV_MAX_COLUMNS) {
+		if (block->widths == NULL) {
+			block->widths = (uint8_t *)NP2HeapAlloc(CSV_MAX_COLUMNS);
+		}
+		block->columnCount = max_i(block->columnCount, column + 1);
+		width = min_pos(width, CSV_MAX_FIELD_WIDTH);
+		if (width > block->widths[column]) {
+			block->widths[column] = (uint8_t)width;
+		}
+	}
+}
+
+// mask of delimiter, quote and line endings, mask of UTF-8 trail bytes, and mask of UTF-8 lead bytes
+// for three or four bytes sequences which are mostly wide (CJK, emoji) characters.
+static inline void CsvView_ClassifyBlock(const uint8_t *ptr, char delimiter, uint32_t *special, uint32_t *trail, uint32_t *wide) {
+#if NP2_USE_AVX2
+	const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+	*special = _mm256_movemask_epi8(_mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(delimiter)), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\"'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')))));
+	// 0x80 to 0xBF as signed bytes are less than -64, 0xE0 to 0xFF are greater than -33
+	*trail = _mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(-64), chunk));
+	*wide = _mm256_movemask_epi8(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(-33))) & _mm256_movemask_epi8(chunk);
+#elif NP2_USE_SSE2
+	*special = 0;
+	*trail = 0;
+	*wide = 0;
+	for (uint32_t i = 0; i < CSV_SCAN_BLOCK_SIZE; i += sizeof(__m128i)) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)(ptr + i));
+		*special |= (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(delimiter)), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"'))),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))))) << i;
+		*trail |= (uint32_t)_mm_movemask_epi8(_mm_cmplt_epi8(chunk, _mm_set1_epi8(-64))) << i;
+		*wide |= (uint32_t)(_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(-33))) & _mm_movemask_epi8(chunk)) << i;
+	}
+#elif NP2_USE_NEON
+	*special = 0;
+	*trail = 0;
+	*wide = 0;
+	for (uint32_t i = 0; i < CSV_SCAN_BLOCK_SIZE; i += sizeof(uint8x16_t)) {
+		const uint8x16_t chunk = vld1q_u8(ptr + i);
+		*special |= neon_movemask_epi8(vorrq_u8(
+			vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(delimiter)), vceqq_u8(chunk, vdupq_n_u8('\"'))),
+			vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\r')), vceqq_u8(chunk, vdupq_n_u8('\n'))))) << i;
+		*trail |= neon_movemask_epi8(vandq_u8(vcgeq_u8(chunk, vdupq_n_u8(0x80)), vcltq_u8(chunk, vdupq_n_u8(0xC0)))) << i;
+		*wide |= neon_movemask_epi8(vcgeq_u8(chunk, vdupq_n_u8(0xE0))) << i;
+	}
+#else
+	*special = 0;
+	*trail = 0;
+	*wide = 0;
+	for (uint32_t i = 0; i < CSV_SCAN_BLOCK_SIZE; i++) {
+		const uint32_t bit = 1U << i;
+		const uint8_t ch = ptr[i];
+		if (ch == (uint8_t)delimiter || ch == '\"' || ch == '\r' || ch == '\n') {
+			*special |= bit;
+		} else if (ch >= 0xE0) {
+			*wide |= bit;
+		} else if (ch >= 0x80 && ch < 0xC0) {
+			*trail |= bit;
+		}
+	}
+#endif
+}
+
+// index widest field of each column for lines of the block, returns scanned bytes.
+static Sci_Position CsvView_ScanBlock(CsvBlock *block, Sci_Line line) {
+	CsvViewData * const cv = &csvView;
+	const Sci_Position startPos = SciCall_PositionFromLine(line);
+	const Sci_Position length = SciCall_PositionFromLine(line + block->lineCount) - startPos;
+	const char *text = SciCall_GetRangePointer(startPos, length);
+	const char delimiter = cv->delimiter;
+	const BOOL utf8 = cv->utf8;
+	uint8_t buffer[CSV_SCAN_BLOCK_SIZE];
+
+	if (block->widths) {
+		memset(block->widths, 0, block->columnCount);
+	}
+	block->columnCount = 0;
+	block->dirty = FALSE;
+
+	int column = 0;
+	BOOL quoted = FALSE;
+	Sci_Position fieldStart = 0;	// in character cells
+	Sci_Position adjust = 0;		// cells minus bytes before current block
+	for (Sci_Position offset = 0; offset < length; offset += CSV_SCAN_BLOCK_SIZE) {
+		const uint8_t *ptr = (const uint8_t *)text + offset;
+		if (offset + CSV_SCAN_BLOCK_SIZE > length) {
+			// NUL is not classified
+			memset(buffer, 0, sizeof(buffer));
+			memcpy(buffer, ptr, length - offset);
+			ptr = buffer;
+		}
+		uint32_t special;
+		uint32_t trail;
+		uint32_t wide;
+		CsvView_ClassifyBlock(ptr, delimiter, &special, &trail, &wide);
+		if (!utf8) {
+			trail = 0;
+			wide = 0;
+		}
+		while (special) {
+			const uint32_t index = np2_ctz(special);
+			special &= special - 1;
+			const uint32_t before = (1U << index) - 1;
+			const Sci_Position cells = offset + index + adjust + np2_popcount(wide & before) - np2_popcount(trail & before);
+			const uint8_t ch = ptr[index];
+			if (ch == '\"') {
+				quoted = !quoted;
+			} else if (ch == (uint8_t)delimiter) {
+				if (!quoted) {
+					CsvView_AddField(block, column, cells - fieldStart);
+					++column;
+					fieldStart = cells + 1;
+				}
+			} else {
+				// quote state is not carried over to next line, unbalanced quote only affects current line
+				if (!(ch == '\n' && offset + index != 0 && text[offset + index - 1] == '\r')) {
+					CsvView_AddField(block, column, cells - fieldStart);
+				}
+				column = 0;
+				quoted = FALSE;
+				fieldStart = cells + 1;
+			}
+		}
+		adjust += (Sci_Position)np2_popcount(wide) - np2_popcount(trail);
+	}
+	// last line of document
+	const Sci_Position cells = length + adjust;
+	if (cells > fieldStart) {
+		CsvView_AddField(block, column, cells - fieldStart);
+	}
+	return length;
+}
+
+static void CsvView_UpdateTabStops(void) {
+	CsvViewData * const cv = &csvView;
+	uint8_t widths[CSV_MAX_COLUMNS];
+	int columnCount = 0;
+	memset(widths, 0, sizeof(widths));
+	for (int index = 0; index < cv->blockCount; index++) {
+		const CsvBlock * const block = &cv->blocks[index];
+		columnCount = max_i(columnCount, block->columnCount);
+		for (int column = 0; column < block->columnCount; column++) {
+			widths[column] = (uint8_t)max_u(widths[column], block->widths[column]);
+		}
+	}
+
+	const int charWidth = SciCall_TextWidth(STYLE_DEFAULT, "0");
+	if (charWidth == cv->charWidth && columnCount == cv->columnCount && memcmp(widths, cv->widths, columnCount) == 0) {
+		return;
+	}
+	cv->charWidth = charWidth;
+	cv->columnCount = columnCount;
+	memcpy(cv->widths, widths, columnCount);
+
+	SciCall_ClearTabStops(-1);
+	int x = 0;
+	// no stop after last column
+	for (int column = 0; column + 1 < columnCount; column++) {
+		x += (widths[column] + 1 + CSV_COLUMN_PADDING) * charWidth;
+		SciCall_AddTabStop(-1, x);
+	}
+}
+
+static void CsvView_IndexSlice(void) {
+	CsvViewData * const cv = &csvView;
+	Sci_Line line = 0;
+	for (int index = 0; index < cv->blockCount; index++) {
+		line += cv->blocks[index].lineCount;
+	}
+	if (line != SciCall_GetLineCount()) {
+		// document changed without notification
+		CsvView_InitBlocks();
+	}
+
+	Sci_Position scanned = 0;
+	int index = 0;
+	line = 0;
+	for (; index < cv->firstDirty; index++) {
+		line += cv->blocks[index].lineCount;
+	}
+	for (; index < cv->blockCount && scanned < CSV_INDEX_SLICE_SIZE; index++) {
+		if (cv->blocks[index].dirty) {
+			if (cv->blocks[index].lineCount > 2*CSV_BLOCK_LINES) {
+				CsvView_SplitBlock(index);
+			}
+			scanned += CsvView_ScanBlock(&cv->blocks[index], line);
+		}
+		line += cv->blocks[index].lineCount;
+	}
+	cv->firstDirty = index;
+	while (index < cv->blockCount && !cv->blocks[index].dirty) {
+		++index;
+	}
+	if (index == cv->blockCount) {
+		cv->firstDirty = index;
+		CsvView_StopIndex();
+	}
+	CsvView_UpdateTabStops();
+}
+
+// delimiter occurs most outside quotes on first lines.
+static char CsvView_DetectDelimiter(void) {
+	const char * const candidates = ",\t;|";
+	int counts[4] = { 0, 0, 0, 0 };
+	const Sci_Position length = min_pos(SciCall_GetLength(), CSV_DETECT_SIZE);
+	const char *text = SciCall_GetRangePointer(0, length);
+	BOOL quoted = FALSE;
+	for (Sci_Position offset = 0; offset < length; offset++) {
+		const char ch = text[offset];
+		if (ch == '\"') {
+			quoted = !quoted;
+		} else if (ch == '\r' || ch == '\n') {
+			quoted = FALSE;
+		} else if (!quoted) {
+			const char *p = strchr(candidates, ch);
+			if (p != NULL && ch != '\0') {
+				counts[p - candidates] += 1;
+			}
+		}
+	}
+
+	int best = 0;
+	for (int i = 1; i < 4; i++) {
+		if (counts[i] > counts[best]) {
+			best = i;
+		}
+	}
+	return candidates[best];
+}
+
+void CsvView_Enable(HWND hwnd, BOOL enable) {
+	CsvViewData * const cv = &csvView;
+	if (enable) {
+		cv->hwnd = hwnd;
+		cv->enabled = TRUE;
+		CsvView_Reset();
+	} else if (cv->enabled) {
+		CsvView_StopIndex();
+		CsvView_FreeBlocks();
+		cv->enabled = FALSE;
+		cv->columnCount = 0;
+		SciCall_SetFieldDelimiter(0);
+		SciCall_ClearTabStops(-1);
+	}
+}
+
+BOOL CsvView_IsEnabled(void) {
+	return csvView.enabled;
+}
+
+void CsvView_Reset(void) {
+	CsvViewData * const cv = &csvView;
+	if (!cv->enabled) {
+		return;
+	}
+
+	cv->delimiter = CsvView_DetectDelimiter();
+	cv->utf8 = SciCall_GetCodePage() == SC_CP_UTF8;
+	// tab is aligned by tab stops without field delimiter
+	SciCall_SetFieldDelimiter((cv->delimiter == '\t') ? 0 : cv->delimiter);
+	// force applying tab stops for new document
+	cv->charWidth = 0;
+	cv->columnCount = 0;
+	SciCall_ClearTabStops(-1);
+	CsvView_InitBlocks();
+}
+
+void CsvView_OnModified(Sci_Position position, Sci_Position length, Sci_Line linesAdded) {
+	CsvViewData * const cv = &csvView;
+	if (!cv->enabled || cv->blockCount == 0) {
+		return;
+	}
+
+	const Sci_Line line = SciCall_LineFromPosition(position);
+	Sci_Line lineStart = 0;
+	int index = 0;
+	while (index + 1 < cv->blockCount && lineStart + cv->blocks[index].lineCount <= line) {
+		lineStart += cv->blocks[index].lineCount;
+		++index;
+	}
+
+	if (linesAdded > 0) {
+		cv->blocks[index].lineCount += linesAdded;
+	} else if (linesAdded < 0) {
+		// lines after current line are removed
+		Sci_Line removed = -linesAdded;
+		Sci_Line available = lineStart + cv->blocks[index].lineCount - line - 1;
+		for (int current = index; removed > 0 && current < cv->blockCount; current++) {
+			CsvBlock * const block = &cv->blocks[current];
+			if (current != index) {
+				available = block->lineCount;
+			}
+			const Sci_Line count = min_pos(available, removed);
+			block->lineCount -= count;
+			block->dirty = TRUE;
+			removed -= count;
+		}
+		CsvView_RemoveEmptyBlocks(index + 1);
+	}
+
+	const Sci_Line lineEnd = (length > 0) ? SciCall_LineFromPosition(position + length) : line;
+	for (int current = index; current < cv->blockCount && lineStart <= lineEnd; current++) {
+		cv->blocks[current].dirty = TRUE;
+		lineStart += cv->blocks[current].lineCount;
+	}
+	cv->firstDirty = min_i(cv->firstDirty, index);
+	CsvView_StartIndex();
+}
+
+void CsvView_OnStyleChanged(void) {
+	if (csvView.enabled) {
+		CsvView_UpdateTabStops();
+	}
+}
+
+// end of field starts at offset, delimiter inside quotes is skipped.
+static Sci_Position CsvView_FieldEnd(const char *text, Sci_Position offset, Sci_Position length) {
+	const char delimiter = csvView.delimiter;
+	BOOL quoted = FALSE;
+	while (offset < length) {
+		const char ch = text[offset];
+		if (ch == '\"') {
+			quoted = !quoted;
+		} else if (ch == delimiter && !quoted) {
+			break;
+		}
+		++offset;
+	}
+	return offset;
+}
+
+// field index at position, or range of field with specified index on the line.
+static int CsvView_GetField(Sci_Line line, Sci_Position position, int column, Sci_Position *fieldStart, Sci_Position *fieldEnd) {
+	const Sci_Position lineStart = SciCall_PositionFromLine(line);
+	const Sci_Position length = SciCall_GetLineEndPosition(line) - lineStart;
+	const char *text = SciCall_GetRangePointer(lineStart, length);
+	Sci_Position start = 0;
+	int index = 0;
+	position -= lineStart;
+	while (TRUE) {
+		const Sci_Position end = CsvView_FieldEnd(text, start, length);
+		if (index == column || (column < 0 && position <= end) || end == length) {
+			*fieldStart = lineStart + start;
+			*fieldEnd = lineStart + end;
+			return (index == column || column < 0) ? index : -1;
+		}
+		start = end + 1;
+		++index;
+	}
+}
+
+void CsvView_GotoField(BOOL next) {
+	Sci_Position position = SciCall_GetCurrentPos();
+	Sci_Line line = SciCall_LineFromPosition(position);
+	Sci_Position start;
+	Sci_Position end;
+	CsvView_GetField(line, position, -1, &start, &end);
+	if (next) {
+		if (end < SciCall_GetLineEndPosition(line)) {
+			position = end + 1;
+		} else if (line + 1 < SciCall_GetLineCount()) {
+			position = SciCall_PositionFromLine(line + 1);
+		} else {
+			return;
+		}
+	} else {
+		if (position > start) {
+			position = start;
+		} else if (start > SciCall_PositionFromLine(line)) {
+			// start of previous field
+			CsvView_GetField(line, start - 1, -1, &start, &end);
+			position = start;
+		} else if (line != 0) {
+			// start of last field on previous line
+			--line;
+			end = SciCall_GetLineEndPosition(line);
+			CsvView_GetField(line, end, -1, &start, &end);
+			position = start;
+		} else {
+			return;
+		}
+	}
+	SciCall_GotoPos(position);
+}
+
+// lines of multiple lines selection, or whole document.
+static void CsvView_GetColumnLines(Sci_Line *lineFirst, Sci_Line *lineLast) {
+	*lineFirst = SciCall_LineFromPosition(SciCall_GetSelectionStart());
+	*lineLast = SciCall_LineFromPosition(SciCall_GetSelectionEnd());
+	if (*lineFirst == *lineLast) {
+		*lineFirst = 0;
+		*lineLast = SciCall_GetLineCount() - 1;
+		// empty line after last line break
+		if (*lineLast != 0 && SciCall_PositionFromLine(*lineLast) == SciCall_GetLength()) {
+			--*lineLast;
+		}
+	}
+}
+
+void CsvView_SelectColumn(void) {
+	const Sci_Position position = SciCall_GetCurrentPos();
+	const Sci_Line lineCaret = SciCall_LineFromPosition(position);
+	Sci_Position start;
+	Sci_Position end;
+	const int column = CsvView_GetField(lineCaret, position, -1, &start, &end);
+	Sci_Line lineFirst;
+	Sci_Line lineLast;
+	CsvView_GetColumnLines(&lineFirst, &lineLast);
+
+	size_t selection = 0;
+	size_t mainSelection = 0;
+	for (Sci_Line line = lineFirst; line <= lineLast; line++) {
+		if (CsvView_GetField(line, 0, column, &start, &end) < 0) {
+			continue;
+		}
+		if (line == lineCaret) {
+			mainSelection = selection;
+		}
+		if (selection == 0) {
+			SciCall_SetSelection(end, start);
+		} else {
+			SciCall_AddSelection(end, start);
+		}
+		++selection;
+	}
+	if (selection != 0) {
+		SciCall_SetMainSelection(mainSelection);
+	}
+}
+
+BOOL CsvView_CopyColumn(HWND hwnd) {
+	const Sci_Position position = SciCall_GetCurrentPos();
+	Sci_Position start;
+	Sci_Position end;
+	const int column = CsvView_GetField(SciCall_LineFromPosition(position), position, -1, &start, &end);
+	Sci_Line lineFirst;
+	Sci_Line lineLast;
+	CsvView_GetColumnLines(&lineFirst, &lineLast);
+
+	const int iEOLMode = SciCall_GetEOLMode();
+	const char *eol = (iEOLMode == SC_EOL_CRLF) ? "\r\n" : ((iEOLMode == SC_EOL_CR) ? "\r" : "\n");
+	const Sci_Position cchEOL = (iEOLMode == SC_EOL_CRLF) ? 2 : 1;
+	Sci_Position capacity = 4096;
+	Sci_Position length = 0;
+	char *text = (char *)NP2HeapAlloc(capacity);
+	for (Sci_Line line = lineFirst; line <= lineLast; line++) {
+		if (CsvView_GetField(line, 0, column, &start, &end) < 0) {
+			start = end = 0;
+		}
+		const Sci_Position cch = end - start;
+		if (length + cch + cchEOL + 1 > capacity) {
+			capacity = max_pos(capacity*2, length + cch + cchEOL + 1);
+			text = (char *)NP2HeapReAlloc(text, capacity);
+		}
+		if (cch != 0) {
+			memcpy(text + length, SciCall_GetRangePointer(start, cch), cch);
+			length += cch;
+		}
+		// same as rectangular copy, every line ends with line break
+		memcpy(text + length, eol, cchEOL);
+		length += cchEOL;
+	}
+
+	BOOL success = FALSE;
+	const UINT cpEdit = SciCall_GetCodePage();
+	const int cchText = MultiByteToWideChar(cpEdit, 0, text, (int)length, NULL, 0);
+	HANDLE hData = GlobalAlloc(GMEM_MOVEABLE, (cchText + 1) * sizeof(WCHAR));
+	if (hData != NULL) {
+		LPWSTR pszText = (LPWSTR)GlobalLock(hData);
+		MultiByteToWideChar(cpEdit, 0, text, (int)length, pszText, cchText);
+		pszText[cchText] = L'\0';
+		GlobalUnlock(hData);
+		if (OpenClipboard(hwnd)) {
+			EmptyClipboard();
+			SetClipboardData(CF_UNICODETEXT, hData);
+			// pasted as rectangle
+			SetClipboardData(RegisterClipboardFormat(L"MSDEVColumnSelect"), NULL);
+			CloseClipboard();
+			success = TRUE;
+		} else {
+			GlobalFree(hData);
+		}
+	}
+	NP2HeapFree(text);
+	return success;
+}
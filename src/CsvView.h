@@ -0,0 +1,13 @@
+// CSV Column Mode
+#pragma once
+
+// aligns fields of comma, semicolon, pipe or tab separated values with explicit tab stops,
+// hwnd receives index timer messages.
+void CsvView_Enable(HWND hwnd, BOOL enable);
+BOOL CsvView_IsEnabled(void);
+void CsvView_Reset(void);
+void CsvView_OnModified(Sci_Position position, Sci_Position length, Sci_Line linesAdded);
+void CsvView_OnStyleChanged(void);
+void CsvView_GotoField(BOOL next);
+void CsvView_SelectColumn(void);
+BOOL CsvView_CopyColumn(HWND hwnd);
@@ -0,0 +1,806 @@
+// Decompressor for gzip and zstd files
+
+#include <windows.h>
+#include <shlwapi.h>
+#include <string.h>
+#include "Helpers.h"
+#include "Decompressor.h"
+
+// gzip (RFC 1952) with DEFLATE (RFC 1951) is decoded here, Huffman codes are decoded with a lookup
+// table for the next INFLATE_FAST_BITS bits, longer codes are decoded bit by bit (puff.c).
+// zstd is decoded with ZSTD_decompressStream() from libzstd.dll when the DLL is shipped with program.
+
+#define INFLATE_WINDOW_SIZE			(32*1024)
+// decoded bytes before the window is moved.
+#define INFLATE_OUTPUT_SIZE			(1024*1024)
+#define INFLATE_MAX_MATCH			258
+#define DECOMPRESS_INPUT_SIZE		(256*1024)
+#define INFLATE_FAST_BITS			10
+#define INFLATE_MAX_BITS			15
+
+#define DECOMPRESS_PIPELINE_SLOTS		4
+#define DECOMPRESS_PIPELINE_CHUNK_SIZE	(4*1024*1024)
+
+typedef struct HuffmanTable {
+	uint16_t fast[1 << INFLATE_FAST_BITS];	// (symbol << 4) | length, 0 for longer code
+	uint16_t count[INFLATE_MAX_BITS + 1];	// number of codes of each length
+	uint16_t symbol[288];					// symbols ordered by code
+} HuffmanTable;
+
+enum {
+	InflateState_MemberHeader,
+	InflateState_BlockHeader,
+	InflateState_Stored,
+	InflateState_Huffman,
+	InflateState_MemberTrailer,
+	InflateState_Done,
+};
+
+typedef struct ZSTD_inBuffer {
+	const void *src;
+	size_t size;
+	size_t pos;
+} ZSTD_inBuffer;
+
+typedef struct ZSTD_outBuffer {
+	void *dst;
+	size_t size;
+	size_t pos;
+} ZSTD_outBuffer;
+
+typedef void * (__cdecl *ZSTD_createDStreamSig)(void);
+typedef size_t (__cdecl *ZSTD_freeDStreamSig)(void *zds);
+typedef size_t (__cdecl *ZSTD_decompressStreamSig)(void *zds, ZSTD_outBuffer *output, ZSTD_inBuffer *input);
+typedef unsigned (__cdecl *ZSTD_isErrorSig)(size_t code);
+typedef unsigned long long (__cdecl *ZSTD_getFrameContentSizeSig)(const void *src, size_t srcSize);
+
+static struct ZstdLibrary {
+	int loaded;	// 0: not tried, 1: not found, 2: loaded
+	HMODULE hModule;
+	ZSTD_createDStreamSig createDStream;
+	ZSTD_freeDStreamSig freeDStream;
+	ZSTD_decompressStreamSig decompressStream;
+	ZSTD_isErrorSig isError;
+	ZSTD_getFrameContentSizeSig getFrameContentSize;
+} zstdLibrary;
+
+struct Decompressor {
+	HANDLE hFile;
+	int format;
+	BOOL bInputEnd;
+	DWORD dwError;
+	uint8_t *input;
+	DWORD inputPos;
+	DWORD inputSize;
+
+	// zstd
+	void *zds;
+	size_t zstdResult;	// non-zero when frame is incomplete
+
+	// gzip
+	int state;
+	BOOL bFinalBlock;
+	uint64_t bitBuffer;
+	UINT bitCount;
+	UINT padding;
+	UINT crc;
+	UINT crcPos;
+	UINT memberSize;
+	UINT storedLength;
+	uint8_t *output;
+	UINT outputPos;
+	UINT readPos;
+	HuffmanTable lengthTable;
+	HuffmanTable distanceTable;
+};
+
+struct DecompressPipeline {
+	Decompressor *decompressor;
+	HANDLE hThread;
+	HANDLE semaphoreFilled;
+	HANDLE semaphoreEmpty;
+	volatile LONG cancelled;
+	volatile LONGLONG inputPosition;
+	char *chunks[DECOMPRESS_PIPELINE_SLOTS];
+	DWORD chunkSize[DECOMPRESS_PIPELINE_SLOTS];
+	DWORD chunkError[DECOMPRESS_PIPELINE_SLOTS];	// ERROR_HANDLE_EOF for last chunk
+	UINT readSlot;
+	DWORD readOffset;
+	BOOL bSlotAcquired;
+	DWORD dwError;
+};
+
+static const uint16_t kLengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+static const uint8_t kLengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+static const uint16_t kDistanceBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+static const uint8_t kDistanceExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+static const uint8_t kCodeLengthOrder[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+static UINT crc32Table[256];
+
+static void InitCrc32Table(void) {
+	if (crc32Table[1] == 0) {
+		for (UINT i = 0; i < 256; i++) {
+			UINT value = i;
+			for (int bit = 0; bit < 8; bit++) {
+				value = (value >> 1) ^ ((value & 1) ? 0xEDB88320U : 0);
+			}
+			crc32Table[i] = value;
+		}
+	}
+}
+
+static UINT UpdateCrc32(UINT crc, const uint8_t *ptr, UINT length) {
+	crc = ~crc;
+	const uint8_t * const end = ptr + length;
+	while (ptr < end) {
+		crc = crc32Table[(crc ^ *ptr++) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static BOOL LoadZstdLibrary(void) {
+	if (zstdLibrary.loaded == 0) {
+		zstdLibrary.loaded = 1;
+		// only load the DLL from program folder
+		WCHAR szPath[MAX_PATH];
+		GetModuleFileName(NULL, szPath, COUNTOF(szPath));
+		PathRemoveFileSpec(szPath);
+		PathAppend(szPath, L"libzstd.dll");
+		HMODULE hModule = LoadLibraryEx(szPath, NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+		if (hModule != NULL) {
+			zstdLibrary.createDStream = DLLFunction(ZSTD_createDStreamSig, hModule, "ZSTD_createDStream");
+			zstdLibrary.freeDStream = DLLFunction(ZSTD_freeDStreamSig, hModule, "ZSTD_freeDStream");
+			zstdLibrary.decompressStream = DLLFunction(ZSTD_decompressStreamSig, hModule, "ZSTD_decompressStream");
+			zstdLibrary.isError = DLLFunction(ZSTD_isErrorSig, hModule, "ZSTD_isError");
+			zstdLibrary.getFrameContentSize = DLLFunction(ZSTD_getFrameContentSizeSig, hModule, "ZSTD_getFrameContentSize");
+			if (zstdLibrary.createDStream && zstdLibrary.freeDStream && zstdLibrary.decompressStream
+				&& zstdLibrary.isError && zstdLibrary.getFrameContentSize) {
+				zstdLibrary.hModule = hModule;
+				zstdLibrary.loaded = 2;
+			} else {
+				FreeLibrary(hModule);
+			}
+		}
+	}
+	return zstdLibrary.loaded == 2;
+}
+
+int Decompressor_DetectFormat(const uint8_t *header, DWORD length) {
+	if (length >= 10 && header[0] == 0x1F && header[1] == 0x8B && header[2] == 8) {
+		return CompressionFormat_Gzip;
+	}
+	if (length >= 4 && header[0] == 0x28 && header[1] == 0xB5 && header[2] == 0x2F && header[3] == 0xFD) {
+		if (LoadZstdLibrary()) {
+			return CompressionFormat_Zstd;
+		}
+	}
+	return CompressionFormat_None;
+}
+
+LONGLONG Decompressor_GetContentSize(HANDLE hFile, int format, LONGLONG fileSize) {
+	LONGLONG size = -1;
+	uint8_t buffer[32];
+	DWORD cbRead = 0;
+	LARGE_INTEGER offset;
+	if (format == CompressionFormat_Gzip) {
+		// ISIZE of last member, it's the size modulo 2^32 for single member file.
+		// stored blocks add 5 bytes for every 64 KiB, DEFLATE compresses at most 1032:1.
+		offset.QuadPart = fileSize - 4;
+		if (fileSize >= 18 && fileSize < 0xFFFFFFFF && SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN)
+			&& ReadFile(hFile, buffer, 4, &cbRead, NULL) && cbRead == 4) {
+			size = buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((UINT)buffer[3] << 24);
+			if (size < fileSize - 18 - (fileSize >> 13) || size/1032 > fileSize) {
+				size = -1;
+			}
+		}
+	} else if (format == CompressionFormat_Zstd) {
+		offset.QuadPart = 0;
+		if (SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN) && ReadFile(hFile, buffer, sizeof(buffer), &cbRead, NULL)) {
+			const unsigned long long value = zstdLibrary.getFrameContentSize(buffer, cbRead);
+			// ZSTD_CONTENTSIZE_UNKNOWN and ZSTD_CONTENTSIZE_ERROR
+			if (value < (unsigned long long)INT64_MAX) {
+				size = (LONGLONG)value;
+			}
+		}
+	}
+	offset.QuadPart = 0;
+	SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN);
+	return size;
+}
+
+Decompressor *Decompressor_Create(HANDLE hFile, int format) {
+	Decompressor *decompressor = (Decompressor *)NP2HeapAlloc(sizeof(Decompressor));
+	if (decompressor == NULL) {
+		return NULL;
+	}
+	decompressor->hFile = hFile;
+	decompressor->format = format;
+	decompressor->input = (uint8_t *)NP2HeapAlloc(DECOMPRESS_INPUT_SIZE);
+	BOOL bSuccess = decompressor->input != NULL;
+	if (format == CompressionFormat_Zstd) {
+		decompressor->zds = bSuccess ? zstdLibrary.createDStream() : NULL;
+		bSuccess = decompressor->zds != NULL;
+	} else {
+		InitCrc32Table();
+		decompressor->output = (uint8_t *)NP2HeapAlloc(INFLATE_WINDOW_SIZE + INFLATE_OUTPUT_SIZE + INFLATE_MAX_MATCH);
+		bSuccess = bSuccess && decompressor->output != NULL;
+	}
+	if (!bSuccess) {
+		Decompressor_Destroy(decompressor);
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+		return NULL;
+	}
+	return decompressor;
+}
+
+void Decompressor_Destroy(Decompressor *decompressor) {
+	if (decompressor->zds) {
+		zstdLibrary.freeDStream(decompressor->zds);
+	}
+	if (decompressor->input) {
+		NP2HeapFree(decompressor->input);
+	}
+	if (decompressor->output) {
+		NP2HeapFree(decompressor->output);
+	}
+	NP2HeapFree(decompressor);
+}
+
+static BOOL Decompressor_FillInput(Decompressor *decompressor) {
+	if (decompressor->bInputEnd) {
+		return FALSE;
+	}
+	DWORD cbRead = 0;
+	if (!ReadFile(decompressor->hFile, decompressor->input, DECOMPRESS_INPUT_SIZE, &cbRead, NULL)) {
+		decompressor->dwError = GetLastError();
+		decompressor->bInputEnd = TRUE;
+		return FALSE;
+	}
+	decompressor->inputPos = 0;
+	decompressor->inputSize = cbRead;
+	decompressor->bInputEnd = cbRead == 0;
+	return cbRead != 0;
+}
+
+static inline BOOL Decompressor_HasInput(Decompressor *decompressor) {
+	return decompressor->inputPos < decompressor->inputSize || Decompressor_FillInput(decompressor);
+}
+
+// keep at least 57 bits in bit buffer, zero is appended after end of input.
+static inline void Inflate_FillBits(Decompressor *decompressor) {
+	while (decompressor->bitCount <= 56) {
+		uint64_t value = 0;
+		if (Decompressor_HasInput(decompressor)) {
+			value = decompressor->input[decompressor->inputPos++];
+		} else {
+			++decompressor->padding;
+		}
+		decompressor->bitBuffer |= value << decompressor->bitCount;
+		decompressor->bitCount += 8;
+	}
+}
+
+static inline UINT Inflate_GetBits(Decompressor *decompressor, UINT count) {
+	const UINT value = (UINT)(decompressor->bitBuffer & ((UINT64_C(1) << count) - 1));
+	decompressor->bitBuffer >>= count;
+	decompressor->bitCount -= count;
+	return value;
+}
+
+static inline UINT Inflate_ReadBits(Decompressor *decompressor, UINT count) {
+	Inflate_FillBits(decompressor);
+	return Inflate_GetBits(decompressor, count);
+}
+
+// bits after end of input are used.
+static inline BOOL Inflate_IsTruncated(const Decompressor *decompressor) {
+	return decompressor->padding*8 > decompressor->bitCount;
+}
+
+static inline UINT ReverseBits(UINT code, UINT length) {
+	UINT value = 0;
+	for (UINT i = 0; i < length; i++) {
+		value = (value << 1) | (code & 1);
+		code >>= 1;
+	}
+	return value;
+}
+
+static BOOL Huffman_Build(HuffmanTable *table, const uint8_t *lengths, UINT count) {
+	memset(table->count, 0, sizeof(table->count));
+	for (UINT symbol = 0; symbol < count; symbol++) {
+		table->count[lengths[symbol]] += 1;
+	}
+	table->count[0] = 0;
+
+	int left = 1;
+	uint16_t offsets[INFLATE_MAX_BITS + 1];
+	uint16_t nextCode[INFLATE_MAX_BITS + 1];
+	offsets[1] = 0;
+	nextCode[1] = 0;
+	for (UINT length = 1; length <= INFLATE_MAX_BITS; length++) {
+		left = (left << 1) - table->count[length];
+		if (left < 0) {
+			return FALSE; // over-subscribed
+		}
+		if (length < INFLATE_MAX_BITS) {
+			offsets[length + 1] = offsets[length] + table->count[length];
+			nextCode[length + 1] = (nextCode[length] + table->count[length]) << 1;
+		}
+	}
+
+	memset(table->fast, 0, sizeof(table->fast));
+	for (UINT symbol = 0; symbol < count; symbol++) {
+		const UINT length = lengths[symbol];
+		if (length != 0) {
+			table->symbol[offsets[length]++] = (uint16_t)symbol;
+			const UINT code = nextCode[length]++;
+			if (length <= INFLATE_FAST_BITS) {
+				const uint16_t entry = (uint16_t)((symbol << 4) | length);
+				for (UINT index = ReverseBits(code, length); index < (1 << INFLATE_FAST_BITS); index += 1 << length) {
+					table->fast[index] = entry;
+				}
+			}
+		}
+	}
+	return TRUE;
+}
+
+// at least INFLATE_MAX_BITS bits are in bit buffer, returns -1 for invalid code.
+static inline int Huffman_Decode(Decompressor *decompressor, const HuffmanTable *table) {
+	const UINT entry = table->fast[decompressor->bitBuffer & ((1 << INFLATE_FAST_BITS) - 1)];
+	if (entry != 0) {
+		Inflate_GetBits(decompressor, entry & 15);
+		return entry >> 4;
+	}
+
+	uint64_t bits = decompressor->bitBuffer;
+	int code = 0;
+	int first = 0;
+	int index = 0;
+	for (UINT length = 1; length <= INFLATE_MAX_BITS; length++) {
+		code |= (int)(bits & 1);
+		bits >>= 1;
+		const int count = table->count[length];
+		if (code - count < first) {
+			Inflate_GetBits(decompressor, length);
+			return table->symbol[index + (code - first)];
+		}
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+static BOOL Inflate_BuildFixedTables(Decompressor *decompressor) {
+	uint8_t lengths[288 + 30];
+	memset(lengths, 8, 144);
+	memset(lengths + 144, 9, 256 - 144);
+	memset(lengths + 256, 7, 280 - 256);
+	memset(lengths + 280, 8, 288 - 280);
+	memset(lengths + 288, 5, 30);
+	return Huffman_Build(&decompressor->lengthTable, lengths, 288)
+		&& Huffman_Build(&decompressor->distanceTable, lengths + 288, 30);
+}
+
+static BOOL Inflate_ReadDynamicTables(Decompressor *decompressor) {
+	const UINT lengthCount = Inflate_ReadBits(decompressor, 5) + 257;
+	const UINT distanceCount = Inflate_GetBits(decompressor, 5) + 1;
+	const UINT codeCount = Inflate_GetBits(decompressor, 4) + 4;
+	if (lengthCount > 286 || distanceCount > 30) {
+		return FALSE;
+	}
+
+	uint8_t lengths[288 + 30];
+	memset(lengths, 0, 19);
+	for (UINT i = 0; i < codeCount; i++) {
+		lengths[kCodeLengthOrder[i]] = (uint8_t)Inflate_ReadBits(decompressor, 3);
+	}
+	// code length codes are decoded with length table
+	if (!Huffman_Build(&decompressor->lengthTable, lengths, 19)) {
+		return FALSE;
+	}
+
+	const UINT total = lengthCount + distanceCount;
+	UINT index = 0;
+	while (index < total) {
+		Inflate_FillBits(decompressor);
+		const int symbol = Huffman_Decode(decompressor, &decompressor->lengthTable);
+		if (symbol < 0) {
+			return FALSE;
+		}
+		if (symbol < 16) {
+			lengths[index++] = (uint8_t)symbol;
+			continue;
+		}
+		uint8_t length = 0;
+		UINT repeat;
+		if (symbol == 16) {
+			if (index == 0) {
+				return FALSE;
+			}
+			length = lengths[index - 1];
+			repeat = 3 + Inflate_GetBits(decompressor, 2);
+		} else if (symbol == 17) {
+			repeat = 3 + Inflate_GetBits(decompressor, 3);
+		} else {
+			repeat = 11 + Inflate_GetBits(decompressor, 7);
+		}
+		if (index + repeat > total) {
+			return FALSE;
+		}
+		memset(lengths + index, length, repeat);
+		index += repeat;
+	}
+	if (lengths[256] == 0) {
+		return FALSE; // no end of block code
+	}
+	return Huffman_Build(&decompressor->lengthTable, lengths, lengthCount)
+		&& Huffman_Build(&decompressor->distanceTable, lengths + lengthCount, distanceCount);
+}
+
+static BOOL Inflate_ReadMemberHeader(Decompressor *decompressor) {
+	if (Inflate_ReadBits(decompressor, 16) != 0x8B1F || Inflate_GetBits(decompressor, 8) != 8) {
+		return FALSE;
+	}
+	const UINT flags = Inflate_GetBits(decompressor, 8);
+	// MTIME, XFL, OS
+	Inflate_ReadBits(decompressor, 32);
+	Inflate_ReadBits(decompressor, 16);
+	if (flags & 4) { // FEXTRA
+		UINT length = Inflate_ReadBits(decompressor, 16);
+		while (length != 0 && !Inflate_IsTruncated(decompressor)) {
+			Inflate_ReadBits(decompressor, 8);
+			--length;
+		}
+	}
+	for (UINT mask = 8; mask <= 16; mask <<= 1) { // FNAME, FCOMMENT
+		if (flags & mask) {
+			while (Inflate_ReadBits(decompressor, 8) != 0 && !Inflate_IsTruncated(decompressor)) {
+				// skip zero-terminated string
+			}
+		}
+	}
+	if (flags & 2) { // FHCRC
+		Inflate_ReadBits(decompressor, 16);
+	}
+	decompressor->crc = 0;
+	decompressor->memberSize = 0;
+	return !Inflate_IsTruncated(decompressor);
+}
+
+static void Inflate_UpdateCrc(Decompressor *decompressor) {
+	const UINT length = decompressor->outputPos - decompressor->crcPos;
+	decompressor->crc = UpdateCrc32(decompressor->crc, decompressor->output + decompressor->crcPos, length);
+	decompressor->memberSize += length;
+	decompressor->crcPos = decompressor->outputPos;
+}
+
+// decode until output is full or end of data, returns FALSE for corrupted data.
+static BOOL Inflate_Decode(Decompressor *decompressor) {
+	uint8_t * const output = decompressor->output;
+	const UINT limit = INFLATE_WINDOW_SIZE + INFLATE_OUTPUT_SIZE;
+	UINT outputPos = decompressor->outputPos;
+	while (outputPos < limit) {
+		switch (decompressor->state) {
+		case InflateState_MemberHeader:
+			if (!Inflate_ReadMemberHeader(decompressor)) {
+				return FALSE;
+			}
+			decompressor->state = InflateState_BlockHeader;
+			break;
+
+		case InflateState_BlockHeader: {
+			decompressor->bFinalBlock = Inflate_ReadBits(decompressor, 1);
+			const UINT type = Inflate_GetBits(decompressor, 2);
+			if (type == 0) {
+				// stored block is byte aligned
+				Inflate_GetBits(decompressor, decompressor->bitCount & 7);
+				const UINT length = Inflate_ReadBits(decompressor, 16);
+				if (Inflate_GetBits(decompressor, 16) != (length ^ 0xffff)) {
+					return FALSE;
+				}
+				decompressor->storedLength = length;
+				decompressor->state = InflateState_Stored;
+			} else if (type == 1 || type == 2) {
+				if (!((type == 1) ? Inflate_BuildFixedTables(decompressor) : Inflate_ReadDynamicTables(decompressor))) {
+					return FALSE;
+				}
+				decompressor->state = InflateState_Huffman;
+			} else {
+				return FALSE;
+			}
+			if (Inflate_IsTruncated(decompressor)) {
+				return FALSE;
+			}
+		} break;
+
+		case InflateState_Stored:
+			while (decompressor->storedLength != 0 && outputPos < limit) {
+				output[outputPos++] = (uint8_t)Inflate_ReadBits(decompressor, 8);
+				--decompressor->storedLength;
+			}
+			if (Inflate_IsTruncated(decompressor)) {
+				return FALSE;
+			}
+			if (decompressor->storedLength == 0) {
+				decompressor->state = decompressor->bFinalBlock ? InflateState_MemberTrailer : InflateState_BlockHeader;
+			}
+			break;
+
+		case InflateState_Huffman:
+			while (outputPos < limit) {
+				Inflate_FillBits(decompressor);
+				int symbol = Huffman_Decode(decompressor, &decompressor->lengthTable);
+				if (symbol < 256) {
+					if (symbol < 0) {
+						return FALSE;
+					}
+					output[outputPos++] = (uint8_t)symbol;
+					continue;
+				}
+				if (symbol == 256) {
+					decompressor->state = decompressor->bFinalBlock ? InflateState_MemberTrailer : InflateState_BlockHeader;
+					break;
+				}
+				symbol -= 257;
+				if (symbol >= 29) {
+					return FALSE;
+				}
+				const UINT length = kLengthBase[symbol] + Inflate_GetBits(decompressor, kLengthExtra[symbol]);
+				symbol = Huffman_Decode(decompressor, &decompressor->distanceTable);
+				if (symbol < 0 || symbol >= 30) {
+					return FALSE;
+				}
+				const UINT distance = kDistanceBase[symbol] + Inflate_GetBits(decompressor, kDistanceExtra[symbol]);
+				if (distance > outputPos) {
+					return FALSE;
+				}
+				const uint8_t *src = output + outputPos - distance;
+				uint8_t *dest = output + outputPos;
+				outputPos += length;
+				if (distance >= length) {
+					memcpy(dest, src, length);
+				} else {
+					for (UINT i = 0; i < length; i++) {
+						dest[i] = src[i];
+					}
+				}
+			}
+			if (Inflate_IsTruncated(decompressor)) {
+				return FALSE;
+			}
+			break;
+
+		case InflateState_MemberTrailer: {
+			decompressor->outputPos = outputPos;
+			Inflate_UpdateCrc(decompressor);
+			Inflate_GetBits(decompressor, decompressor->bitCount & 7);
+			const UINT crc = Inflate_ReadBits(decompressor, 32);
+			const UINT size = Inflate_ReadBits(decompressor, 32);
+			if (Inflate_IsTruncated(decompressor) || crc != decompressor->crc || size != decompressor->memberSize) {
+				return FALSE;
+			}
+			// next member starts with ID1 and ID2, other trailing bytes are ignored like gzip.
+			Inflate_FillBits(decompressor);
+			if (Inflate_IsTruncated(decompressor) || (decompressor->bitBuffer & 0xffff) != 0x8B1F) {
+				decompressor->state = InflateState_Done;
+			} else {
+				decompressor->state = InflateState_MemberHeader;
+			}
+		} break;
+
+		default:
+			decompressor->outputPos = outputPos;
+			return TRUE;
+		}
+	}
+	decompressor->outputPos = outputPos;
+	return TRUE;
+}
+
+static BOOL Decompressor_ReadZstd(Decompressor *decompressor, char *buffer, DWORD cbBuffer, DWORD *pcbRead) {
+	ZSTD_outBuffer output = { buffer, cbBuffer, 0 };
+	while (output.pos == 0) {
+		if (decompressor->inputPos == decompressor->inputSize && !Decompressor_FillInput(decompressor)) {
+			if (decompressor->dwError != 0) {
+				SetLastError(decompressor->dwError);
+				return FALSE;
+			}
+			if (decompressor->zstdResult != 0) {
+				SetLastError(ERROR_INVALID_DATA); // truncated frame
+				return FALSE;
+			}
+			break;
+		}
+		ZSTD_inBuffer input = { decompressor->input, decompressor->inputSize, decompressor->inputPos };
+		const size_t result = zstdLibrary.decompressStream(decompressor->zds, &output, &input);
+		if (zstdLibrary.isError(result)) {
+			SetLastError(ERROR_INVALID_DATA);
+			return FALSE;
+		}
+		decompressor->zstdResult = result;
+		decompressor->inputPos = (DWORD)input.pos;
+	}
+	*pcbRead = (DWORD)output.pos;
+	return TRUE;
+}
+
+BOOL Decompressor_Read(Decompressor *decompressor, char *buffer, DWORD cbBuffer, DWORD *pcbRead) {
+	*pcbRead = 0;
+	if (decompressor->format == CompressionFormat_Zstd) {
+		return Decompressor_ReadZstd(decompressor, buffer, cbBuffer, pcbRead);
+	}
+
+	DWORD cbRead = 0;
+	while (cbRead < cbBuffer) {
+		if (decompressor->readPos == decompressor->outputPos) {
+			if (decompressor->state == InflateState_Done) {
+				break;
+			}
+			// keep last window for back references
+			if (decompressor->outputPos > INFLATE_WINDOW_SIZE) {
+				Inflate_UpdateCrc(decompressor);
+				const UINT offset = decompressor->outputPos - INFLATE_WINDOW_SIZE;
+				memmove(decompressor->output, decompressor->output + offset, INFLATE_WINDOW_SIZE);
+				decompressor->outputPos = INFLATE_WINDOW_SIZE;
+				decompressor->readPos = INFLATE_WINDOW_SIZE;
+				decompressor->crcPos = INFLATE_WINDOW_SIZE;
+			}
+			const BOOL bSuccess = Inflate_Decode(decompressor);
+			if (!bSuccess || decompressor->dwError != 0) {
+				SetLastError(bSuccess ? decompressor->dwError : ERROR_INVALID_DATA);
+				return FALSE;
+			}
+		}
+		const DWORD length = min_u(cbBuffer - cbRead, decompressor->outputPos - decompressor->readPos);
+		memcpy(buffer + cbRead, decompressor->output + decompressor->readPos, length);
+		decompressor->readPos += length;
+		cbRead += length;
+	}
+	*pcbRead = cbRead;
+	return TRUE;
+}
+
+static DWORD WINAPI DecompressPipeline_Thread(LPVOID lpParam) {
+	DecompressPipeline *pipeline = (DecompressPipeline *)lpParam;
+	Decompressor *decompressor = pipeline->decompressor;
+	UINT slot = 0;
+	while (WaitForSingleObject(pipeline->semaphoreEmpty, INFINITE) == WAIT_OBJECT_0 && !pipeline->cancelled) {
+		char * const chunk = pipeline->chunks[slot];
+		DWORD cbChunk = 0;
+		DWORD dwError = 0;
+		while (cbChunk < DECOMPRESS_PIPELINE_CHUNK_SIZE) {
+			DWORD cbRead = 0;
+			if (!Decompressor_Read(decompressor, chunk + cbChunk, DECOMPRESS_PIPELINE_CHUNK_SIZE - cbChunk, &cbRead)) {
+				dwError = GetLastError();
+				break;
+			}
+			if (cbRead == 0) {
+				dwError = ERROR_HANDLE_EOF;
+				break;
+			}
+			cbChunk += cbRead;
+		}
+		LARGE_INTEGER position;
+		LARGE_INTEGER offset;
+		offset.QuadPart = 0;
+		if (SetFilePointerEx(decompressor->hFile, offset, &position, FILE_CURRENT)) {
+			pipeline->inputPosition = position.QuadPart;
+		}
+		pipeline->chunkSize[slot] = cbChunk;
+		pipeline->chunkError[slot] = dwError;
+		ReleaseSemaphore(pipeline->semaphoreFilled, 1, NULL);
+		if (dwError != 0) {
+			break;
+		}
+		slot = (slot + 1) % DECOMPRESS_PIPELINE_SLOTS;
+	}
+	return 0;
+}
+
+DecompressPipeline *DecompressPipeline_Create(HANDLE hFile, int format) {
+	DecompressPipeline *pipeline = (DecompressPipeline *)NP2HeapAlloc(sizeof(DecompressPipeline));
+	if (pipeline == NULL) {
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+		return NULL;
+	}
+	pipeline->decompressor = Decompressor_Create(hFile, format);
+	BOOL bSuccess = pipeline->decompressor != NULL;
+	for (UINT slot = 0; bSuccess && slot < DECOMPRESS_PIPELINE_SLOTS; slot++) {
+		pipeline->chunks[slot] = (char *)NP2HeapAlloc(DECOMPRESS_PIPELINE_CHUNK_SIZE);
+		bSuccess = pipeline->chunks[slot] != NULL;
+	}
+	if (bSuccess) {
+		pipeline->semaphoreFilled = CreateSemaphore(NULL, 0, DECOMPRESS_PIPELINE_SLOTS, NULL);
+		pipeline->semaphoreEmpty = CreateSemaphore(NULL, DECOMPRESS_PIPELINE_SLOTS, DECOMPRESS_PIPELINE_SLOTS, NULL);
+		bSuccess = pipeline->semaphoreFilled != NULL && pipeline->semaphoreEmpty != NULL;
+	}
+	if (bSuccess) {
+		pipeline->hThread = CreateThread(NULL, 0, DecompressPipeline_Thread, pipeline, 0, NULL);
+		bSuccess = pipeline->hThread != NULL;
+	}
+	if (!bSuccess) {
+		const DWORD dwError = GetLastError();
+		DecompressPipeline_Destroy(pipeline);
+		SetLastError((dwError == 0) ? ERROR_NOT_ENOUGH_MEMORY : dwError);
+		return NULL;
+	}
+	return pipeline;
+}
+
+BOOL DecompressPipeline_Read(DecompressPipeline *pipeline, char *buffer, DWORD cbBuffer, DWORD *pcbRead) {
+	DWORD cbRead = 0;
+	while (cbRead < cbBuffer && pipeline->dwError == 0) {
+		const UINT slot = pipeline->readSlot;
+		if (!pipeline->bSlotAcquired) {
+			WaitForSingleObject(pipeline->semaphoreFilled, INFINITE);
+			pipeline->bSlotAcquired = TRUE;
+		}
+		const DWORD length = min_u(cbBuffer - cbRead, pipeline->chunkSize[slot] - pipeline->readOffset);
+		memcpy(buffer + cbRead, pipeline->chunks[slot] + pipeline->readOffset, length);
+		pipeline->readOffset += length;
+		cbRead += length;
+		if (pipeline->readOffset == pipeline->chunkSize[slot]) {
+			if (pipeline->chunkError[slot] != 0) {
+				// keep the slot, the thread is finished
+				pipeline->dwError = pipeline->chunkError[slot];
+				break;
+			}
+			pipeline->bSlotAcquired = FALSE;
+			pipeline->readOffset = 0;
+			pipeline->readSlot = (slot + 1) % DECOMPRESS_PIPELINE_SLOTS;
+			ReleaseSemaphore(pipeline->semaphoreEmpty, 1, NULL);
+		}
+	}
+	*pcbRead = cbRead;
+	if (pipeline->dwError != 0 && pipeline->dwError != ERROR_HANDLE_EOF) {
+		SetLastError(pipeline->dwError);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+LONGLONG DecompressPipeline_GetInputPosition(const DecompressPipeline *pipeline) {
+	return pipeline->inputPosition;
+}
+
+void DecompressPipeline_Destroy(DecompressPipeline *pipeline) {
+	if (pipeline->hThread) {
+		InterlockedExchange(&pipeline->cancelled, TRUE);
+		ReleaseSemaphore(pipeline->semaphoreEmpty, 1, NULL);
+		WaitForSingleObject(pipeline->hThread, INFINITE);
+		CloseHandle(pipeline->hThread);
+	}
+	if (pipeline->semaphoreFilled) {
+		CloseHandle(pipeline->semaphoreFilled);
+	}
+	if (pipeline->semaphoreEmpty) {
+		CloseHandle(pipeline->semaphoreEmpty);
+	}
+	for (UINT slot = 0; slot < DECOMPRESS_PIPELINE_SLOTS; slot++) {
+		if (pipeline->chunks[slot]) {
+			NP2HeapFree(pipeline->chunks[slot]);
+		}
+	}
+	if (pipeline->decompressor) {
+		Decompressor_Destroy(pipeline->decompressor);
+	}
+	NP2HeapFree(pipeline);
+}
@@ -0,0 +1,28 @@
+// Decompressor for gzip and zstd files
+#pragma once
+
+enum {
+	CompressionFormat_None,
+	CompressionFormat_Gzip,
+	CompressionFormat_Zstd,
+};
+
+// zstd file is supported when libzstd.dll is found in program folder.
+int Decompressor_DetectFormat(const uint8_t *header, DWORD length);
+// decompressed size from the file, -1 when unknown. File pointer is moved to file start.
+LONGLONG Decompressor_GetContentSize(HANDLE hFile, int format, LONGLONG fileSize);
+
+// decompressor reads compressed data from current file pointer.
+typedef struct Decompressor Decompressor;
+Decompressor *Decompressor_Create(HANDLE hFile, int format);
+// *pcbRead is zero at end of data, returns FALSE and sets last error for read error or corrupted data.
+BOOL Decompressor_Read(Decompressor *decompressor, char *buffer, DWORD cbBuffer, DWORD *pcbRead);
+void Decompressor_Destroy(Decompressor *decompressor);
+
+// decompresses on a worker thread ahead of the reader.
+typedef struct DecompressPipeline DecompressPipeline;
+DecompressPipeline *DecompressPipeline_Create(HANDLE hFile, int format);
+BOOL DecompressPipeline_Read(DecompressPipeline *pipeline, char *buffer, DWORD cbBuffer, DWORD *pcbRead);
+// compressed bytes consumed by the worker thread.
+LONGLONG DecompressPipeline_GetInputPosition(const DecompressPipeline *pipeline);
+void DecompressPipeline_Destroy(DecompressPipeline *pipeline);
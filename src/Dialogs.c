@@ -263,6 +263,31 @@ INT_PTR CALLBACK AboutDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam
 		SetDlgItemText(hwnd, IDC_COPYRIGHT, VERSION_LEGALCOPYRIGHT_SHORT);
 		SetDlgItemText(hwnd, IDC_AUTHORNAME, VERSION_AUTHORNAME);
 
+		{
+			// memory used by current document and its view
+			WCHAR tchUsage[SC_MEMORYUSAGE_POSITION_CACHE + 1][32];
+			for (int usage = SC_MEMORYUSAGE_TOTAL; usage <= SC_MEMORYUSAGE_POSITION_CACHE; usage++) {
+				StrFormatByteSize(SciCall_GetMemoryUsage(usage), tchUsage[usage], COUNTOF(tchUsage[usage]));
+			}
+			WCHAR tchMemory[512];
+			wsprintf(tchMemory, L"Memory: %s (text %s, styles %s, lines %s, undo %s, markers %s, line data %s, indicators %s, layout %s, position cache %s)",
+				tchUsage[SC_MEMORYUSAGE_TOTAL], tchUsage[SC_MEMORYUSAGE_TEXT], tchUsage[SC_MEMORYUSAGE_STYLES],
+				tchUsage[SC_MEMORYUSAGE_LINES], tchUsage[SC_MEMORYUSAGE_UNDO], tchUsage[SC_MEMORYUSAGE_MARKERS],
+				tchUsage[SC_MEMORYUSAGE_LINE_DATA], tchUsage[SC_MEMORYUSAGE_INDICATORS],
+				tchUsage[SC_MEMORYUSAGE_LAYOUT_CACHE], tchUsage[SC_MEMORYUSAGE_POSITION_CACHE]);
+			SetDlgItemText(hwnd, IDC_MEMORY_USAGE, tchMemory);
+
+			// styling cost of current lexer, duration is nanoseconds per KiB, time in microseconds
+			WCHAR tchStyled[32];
+			StrFormatByteSize(SciCall_GetStylingStatistic(SC_STYLINGSTATISTIC_BYTES), tchStyled, COUNTOF(tchStyled));
+			const Sci_Position duration = SciCall_GetStylingStatistic(SC_STYLINGSTATISTIC_DURATION);
+			const Sci_Position time = SciCall_GetStylingStatistic(SC_STYLINGSTATISTIC_TIME);
+			WCHAR tchStyling[256];
+			wsprintf(tchStyling, L"Styling: %d.%03d us/KiB, %s styled in %d.%03d ms",
+				(int)(duration / 1000), (int)(duration % 1000), tchStyled, (int)(time / 1000), (int)(time % 1000));
+			SetDlgItemText(hwnd, IDC_STYLING_STATS, tchStyling);
+		}
+
 		HFONT hFontTitle = (HFONT)SendDlgItemMessage(hwnd, IDC_VERSION, WM_GETFONT, 0, 0);
 		if (hFontTitle == NULL) {
 			hFontTitle = (HFONT)GetStockObject(DEFAULT_GUI_FONT);
@@ -943,77 +968,106 @@ extern BOOL bSaveRecentFiles;
 extern int cxFileMRUDlg;
 extern int cyFileMRUDlg;
 
-static DWORD WINAPI FileMRUIconThread(LPVOID lpParam) {
-	BackgroundWorker *worker = (BackgroundWorker *)lpParam;
-
-	WCHAR tch[MAX_PATH] = L"";
-	DWORD dwFlags = SHGFI_SMALLICON | SHGFI_SYSICONINDEX | SHGFI_ATTRIBUTES | SHGFI_ATTR_SPECIFIED;
-
-	HWND hwnd = worker->hwnd;
-	const int iMaxItem = ListView_GetItemCount(hwnd);
-	int iItem = 0;
-
-	LV_ITEM lvi;
-	ZeroMemory(&lvi, sizeof(LV_ITEM));
-
-	while (iItem < iMaxItem && BackgroundWorker_Continue(worker)) {
-		lvi.mask = LVIF_TEXT;
-		lvi.pszText = tch;
-		lvi.cchTextMax = COUNTOF(tch);
-		lvi.iItem = iItem;
-		if (ListView_GetItem(hwnd, &lvi)) {
-			SHFILEINFO shfi;
-			DWORD dwAttr = 0;
-			if (PathIsUNC(tch) || !PathIsFile(tch)) {
-				dwFlags |= SHGFI_USEFILEATTRIBUTES;
-				dwAttr = FILE_ATTRIBUTE_NORMAL;
-				shfi.dwAttributes = 0;
-				SHGetFileInfo(PathFindFileName(tch), dwAttr, &shfi, sizeof(SHFILEINFO), dwFlags);
-			} else {
-				shfi.dwAttributes = SFGAO_LINK | SFGAO_SHARE;
-				SHGetFileInfo(tch, dwAttr, &shfi, sizeof(SHFILEINFO), dwFlags);
+// Items are shown with icon for their extension first, which is cached for the process and
+// doesn't access the disk. Each item is then resolved on its own thread, so offline shares
+// only delay their own items, results are posted with APPM_FILEMRU_RESOLVED.
+typedef struct FileMRUResolve {
+	HWND hwnd;			// the dialog
+	UINT serial;		// result is ignored after the list is updated again
+	int iItem;
+	int iImage;
+	UINT state;
+	UINT stateMask;
+	WCHAR szPath[MAX_PATH];
+} FileMRUResolve;
+
+#define FILEMRU_ICON_CACHE_SIZE		64
+
+typedef struct FileMRUIconCache {
+	WCHAR szExt[16];
+	int iImage;
+} FileMRUIconCache;
+
+static FileMRUIconCache fileMRUIconCache[FILEMRU_ICON_CACHE_SIZE];
+static int fileMRUIconCacheCount;
+static UINT fileMRUSerial;
+
+static int FileMRU_GetDefaultIcon(LPCWSTR lpszPath) {
+	LPCWSTR lpszExt = PathFindExtension(lpszPath);
+	const BOOL bCache = lstrlen(lpszExt) < (int)COUNTOF(fileMRUIconCache[0].szExt);
+	if (bCache) {
+		for (int i = 0; i < fileMRUIconCacheCount; i++) {
+			if (StrCaseEqual(fileMRUIconCache[i].szExt, lpszExt)) {
+				return fileMRUIconCache[i].iImage;
 			}
+		}
+	}
 
-			lvi.mask = LVIF_IMAGE;
-			lvi.iImage = shfi.iIcon;
-			lvi.stateMask = 0;
-			lvi.state = 0;
+	SHFILEINFO shfi;
+	SHGetFileInfo(PathFindFileName(lpszPath), FILE_ATTRIBUTE_NORMAL, &shfi, sizeof(SHFILEINFO),
+				  SHGFI_USEFILEATTRIBUTES | SHGFI_SMALLICON | SHGFI_SYSICONINDEX);
+	if (bCache && fileMRUIconCacheCount < FILEMRU_ICON_CACHE_SIZE) {
+		lstrcpy(fileMRUIconCache[fileMRUIconCacheCount].szExt, lpszExt);
+		fileMRUIconCache[fileMRUIconCacheCount].iImage = shfi.iIcon;
+		fileMRUIconCacheCount++;
+	}
+	return shfi.iIcon;
+}
 
-			if (shfi.dwAttributes & SFGAO_LINK) {
-				lvi.mask |= LVIF_STATE;
-				lvi.stateMask |= LVIS_OVERLAYMASK;
-				lvi.state |= INDEXTOOVERLAYMASK(2);
-			}
+static DWORD WINAPI FileMRUResolveThread(LPVOID lpParam) {
+	FileMRUResolve *result = (FileMRUResolve *)lpParam;
+	LPCWSTR tch = result->szPath;
 
-			if (shfi.dwAttributes & SFGAO_SHARE) {
-				lvi.mask |= LVIF_STATE;
-				lvi.stateMask |= LVIS_OVERLAYMASK;
-				lvi.state |= INDEXTOOVERLAYMASK(1);
-			}
+	// UNC path and missing file keep the default icon
+	if (!PathIsUNC(tch) && PathIsFile(tch)) {
+		SHFILEINFO shfi;
+		shfi.dwAttributes = SFGAO_LINK | SFGAO_SHARE;
+		SHGetFileInfo(tch, 0, &shfi, sizeof(SHFILEINFO), SHGFI_SMALLICON | SHGFI_SYSICONINDEX | SHGFI_ATTRIBUTES | SHGFI_ATTR_SPECIFIED);
+		result->iImage = shfi.iIcon;
 
-			if (PathIsUNC(tch)) {
-				dwAttr = FILE_ATTRIBUTE_NORMAL;
-			} else {
-				dwAttr = GetFileAttributes(tch);
-			}
+		if (shfi.dwAttributes & SFGAO_LINK) {
+			result->stateMask |= LVIS_OVERLAYMASK;
+			result->state |= INDEXTOOVERLAYMASK(2);
+		}
 
-			if (!flagNoFadeHidden &&
-					dwAttr != INVALID_FILE_ATTRIBUTES &&
-					dwAttr & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) {
-				lvi.mask |= LVIF_STATE;
-				lvi.stateMask |= LVIS_CUT;
-				lvi.state |= LVIS_CUT;
-			}
+		if (shfi.dwAttributes & SFGAO_SHARE) {
+			result->stateMask |= LVIS_OVERLAYMASK;
+			result->state |= INDEXTOOVERLAYMASK(1);
+		}
 
-			lvi.iSubItem = 0;
-			ListView_SetItem(hwnd, &lvi);
+		const DWORD dwAttr = GetFileAttributes(tch);
+		if (!flagNoFadeHidden &&
+				dwAttr != INVALID_FILE_ATTRIBUTES &&
+				dwAttr & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) {
+			result->stateMask |= LVIS_CUT;
+			result->state |= LVIS_CUT;
+		}
+
+		if (PostMessage(result->hwnd, APPM_FILEMRU_RESOLVED, 0, (LPARAM)result)) {
+			return 0;
 		}
-		iItem++;
 	}
 
+	NP2HeapFree(result);
 	return 0;
 }
 
+static void FileMRU_SetResolved(HWND hwnd, const FileMRUResolve *result) {
+	if (result->serial == fileMRUSerial) {
+		LV_ITEM lvi;
+		ZeroMemory(&lvi, sizeof(LV_ITEM));
+		lvi.mask = LVIF_IMAGE;
+		lvi.iItem = result->iItem;
+		lvi.iImage = result->iImage;
+		if (result->stateMask) {
+			lvi.mask |= LVIF_STATE;
+			lvi.stateMask = result->stateMask;
+			lvi.state = result->state;
+		}
+		ListView_SetItem(GetDlgItem(hwnd, IDC_FILEMRU), &lvi);
+	}
+}
+
 static INT_PTR CALLBACK FileMRUDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
 	switch (umsg) {
 	case WM_INITDIALOG: {
@@ -1022,10 +1076,6 @@ static INT_PTR CALLBACK FileMRUDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPAR
 		HWND hwndLV = GetDlgItem(hwnd, IDC_FILEMRU);
 		InitWindowCommon(hwndLV);
 
-		BackgroundWorker *worker = (BackgroundWorker *)GlobalAlloc(GPTR, sizeof(BackgroundWorker));
-		SetProp(hwnd, L"it", (HANDLE)worker);
-		BackgroundWorker_Init(worker, hwndLV);
-
 		ResizeDlg_Init(hwnd, cxFileMRUDlg, cyFileMRUDlg, IDC_RESIZEGRIP);
 
 		SHFILEINFO shfi;
@@ -1058,10 +1108,12 @@ static INT_PTR CALLBACK FileMRUDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPAR
 	return TRUE;
 
 	case WM_DESTROY: {
-		BackgroundWorker *worker = (BackgroundWorker *)GetProp(hwnd, L"it");
-		BackgroundWorker_Destroy(worker);
-		RemoveProp(hwnd, L"it");
-		GlobalFree(worker);
+		// results from threads still running are freed by themselves
+		++fileMRUSerial;
+		MSG msg;
+		while (PeekMessage(&msg, hwnd, APPM_FILEMRU_RESOLVED, APPM_FILEMRU_RESOLVED, PM_REMOVE)) {
+			NP2HeapFree((LPVOID)msg.lParam);
+		}
 
 		bSaveRecentFiles = IsButtonChecked(hwnd, IDC_SAVEMRU);
 
@@ -1091,6 +1143,13 @@ static INT_PTR CALLBACK FileMRUDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPAR
 		ResizeDlg_GetMinMaxInfo(hwnd, lParam);
 		return TRUE;
 
+	case APPM_FILEMRU_RESOLVED: {
+		FileMRUResolve *result = (FileMRUResolve *)lParam;
+		FileMRU_SetResolved(hwnd, result);
+		NP2HeapFree(result);
+	}
+	return TRUE;
+
 	case WM_NOTIFY: {
 		LPNMHDR pnmhdr = (LPNMHDR)lParam;
 		if (pnmhdr->idFrom == IDC_FILEMRU) {
@@ -1180,9 +1239,7 @@ static INT_PTR CALLBACK FileMRUDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPAR
 	case WM_COMMAND:
 		switch (LOWORD(wParam)) {
 		case IDC_FILEMRU_UPDATE_VIEW: {
-			BackgroundWorker *worker = (BackgroundWorker *)GetProp(hwnd, L"it");
-			BackgroundWorker_Cancel(worker);
-
+			const UINT serial = ++fileMRUSerial;
 			HWND hwndLV = GetDlgItem(hwnd, IDC_FILEMRU);
 			ListView_DeleteAllItems(hwndLV);
 
@@ -1190,24 +1247,27 @@ static INT_PTR CALLBACK FileMRUDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPAR
 			ZeroMemory(&lvi, sizeof(LV_ITEM));
 			lvi.mask = LVIF_TEXT | LVIF_IMAGE;
 
-			SHFILEINFO shfi;
-			SHGetFileInfo(L"Icon", FILE_ATTRIBUTE_NORMAL, &shfi, sizeof(SHFILEINFO),
-						  SHGFI_USEFILEATTRIBUTES | SHGFI_SMALLICON | SHGFI_SYSICONINDEX);
-			lvi.iImage = shfi.iIcon;
-
 			WCHAR tch[MAX_PATH];
 			for (int i = 0; i < MRU_GetCount(pFileMRU); i++) {
 				MRU_Enum(pFileMRU, i, tch, COUNTOF(tch));
 				PathAbsoluteFromApp(tch, tch, COUNTOF(tch), TRUE);
 				lvi.iItem = i;
 				lvi.pszText = tch;
+				lvi.iImage = FileMRU_GetDefaultIcon(tch);
 				ListView_InsertItem(hwndLV, &lvi);
+
+				FileMRUResolve *result = (FileMRUResolve *)NP2HeapAlloc(sizeof(FileMRUResolve));
+				result->hwnd = hwnd;
+				result->serial = serial;
+				result->iItem = i;
+				lstrcpy(result->szPath, tch);
+				if (!WorkerPool_Post(FileMRUResolveThread, result, WorkerPriority_Low)) {
+					NP2HeapFree(result);
+				}
 			}
 
 			ListView_SetItemState(hwndLV, 0, LVIS_FOCUSED, LVIS_FOCUSED);
 			ListView_SetColumnWidth(hwndLV, 0, LVSCW_AUTOSIZE_USEHEADER);
-
-			worker->workerThread = CreateThread(NULL, 0, FileMRUIconThread, (LPVOID)worker, 0, NULL);
 		}
 		break;
 
@@ -126,7 +126,7 @@ void DirList_StartIconThread(HWND hwnd) {
 	LPDLDATA lpdl = (LPDLDATA)GetProp(hwnd, pDirListProp);
 
 	BackgroundWorker_Cancel(&lpdl->worker);
-	lpdl->worker.workerThread = CreateThread(NULL, 0, DirList_IconThread, (LPVOID)lpdl, 0, NULL);
+	BackgroundWorker_Start(&lpdl->worker, DirList_IconThread, (LPVOID)lpdl, WorkerPriority_Low);
 }
 
 //=============================================================================
@@ -317,105 +317,203 @@ int DirList_Fill(HWND hwnd, LPCWSTR lpszDir, DWORD grfFlags, LPCWSTR lpszFileSpe
 //
 // DirList_IconThread()
 //
-// Thread to extract file icons in the background
+// Thread to extract file icons in the background, rows in view are resolved
+// first, files sharing an extension are looked up only once.
 //
-DWORD WINAPI DirList_IconThread(LPVOID lpParam) {
-	LPDLDATA lpdl = (LPDLDATA)lpParam;
-	BackgroundWorker *worker = &lpdl->worker;
+#define DLICON_CACHE_SIZE	256		// power of two, half is used at most
+#define DLICON_EXT_SIZE		16
 
-	// Exit immediately if DirList_Fill() hasn't been called
-	if (!lpdl->lpsf) {
-		return 0;
-	}
+typedef struct DLICON_NODE {
+	UINT hash;
+	int iImage;
+	WCHAR szExt[DLICON_EXT_SIZE];	// empty for files without extension
+} DLICON_NODE;
 
-	HWND hwnd = worker->hwnd;
-	const int iMaxItem = ListView_GetItemCount(hwnd);
+typedef struct DLICON_CACHE {
+	UINT count;
+	DLICON_NODE nodes[DLICON_CACHE_SIZE];
+} DLICON_CACHE;
 
-	// Get IShellIcon
+typedef struct DLICON_RESOLVER {
+	LPCDLDATA lpdl;
 	IShellIcon *lpshi;
+	DLICON_CACHE *cache;
+} DLICON_RESOLVER;
+
+// files with these extensions have individual icons
+static BOOL DirList_HasFileIcon(LPCWSTR lpszExt) {
+	static const LPCWSTR fileIconExt[] = {
+		L".exe", L".lnk", L".ico", L".cur", L".ani", L".url", L".scr", L".msc",
+	};
+	for (UINT i = 0; i < COUNTOF(fileIconExt); i++) {
+		if (StrCaseEqual(lpszExt, fileIconExt[i])) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// returns cache node for the extension, or NULL if it can't be cached.
+static DLICON_NODE *DirList_FindIconNode(DLICON_CACHE *cache, LPCWSTR lpszExt) {
+	const UINT length = lstrlen(lpszExt);
+	if (length >= DLICON_EXT_SIZE || DirList_HasFileIcon(lpszExt)) {
+		return NULL;
+	}
+
+	UINT hash = 2166136261U ^ length;
+	for (UINT i = 0; i < length; i++) {
+		UINT ch = lpszExt[i];
+		ch = (ch >= L'A' && ch <= L'Z') ? (ch | 0x20) : ch;
+		hash = (hash ^ ch) * 16777619U;
+	}
+	// zero hash marks empty node
+	hash |= 1;
+
+	UINT index = hash & (DLICON_CACHE_SIZE - 1);
+	DLICON_NODE *node;
+	while ((node = &cache->nodes[index])->hash != 0) {
+		if (node->hash == hash && StrCaseEqual(node->szExt, lpszExt)) {
+			return node;
+		}
+		index = (index + 1) & (DLICON_CACHE_SIZE - 1);
+	}
+	if (cache->count >= DLICON_CACHE_SIZE/2) {
+		return NULL;
+	}
+	// new node, iImage is set by caller
+	cache->count++;
+	node->hash = hash;
+	node->iImage = -1;
+	lstrcpy(node->szExt, lpszExt);
+	return node;
+}
+
+static void DirList_ResolveIcon(HWND hwnd, const DLICON_RESOLVER *resolver, int iItem) {
+	LV_ITEM lvi;
+	lvi.iItem = iItem;
+	lvi.iSubItem = 0;
+	lvi.mask = LVIF_PARAM;
+	if (!ListView_GetItem(hwnd, &lvi)) {
+		return;
+	}
+
+	LPCDLDATA lpdl = resolver->lpdl;
+	IShellIcon *lpshi = resolver->lpshi;
+	LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
+	lvi.mask = LVIF_IMAGE;
+
+	WIN32_FIND_DATA fd;
+	const BOOL bFindData = S_OK == SHGetDataFromIDList(lplvid->lpsf, lplvid->pidl, SHGDFIL_FINDDATA, &fd, sizeof(WIN32_FIND_DATA));
+	DLICON_NODE *node = NULL;
+	if (bFindData && !(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		node = DirList_FindIconNode(resolver->cache, PathFindExtension(fd.cFileName));
+	}
+
+	if (node != NULL && node->iImage >= 0) {
+		lvi.iImage = node->iImage;
+	} else {
 #if defined(__cplusplus)
-	lpdl->lpsf->QueryInterface(IID_IShellIcon, (void **)(&lpshi));
+		if (!lpshi || S_OK != lpshi->GetIconOf(lplvid->pidl, GIL_FORSHELL, &lvi.iImage)) {
+			SHFILEINFO shfi;
+			LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, lplvid->pidl, 0);
+			SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
+			CoTaskMemFree(pidl);
+			lvi.iImage = shfi.iIcon;
+		}
 #else
-	lpdl->lpsf->lpVtbl->QueryInterface(lpdl->lpsf, &IID_IShellIcon, (void **)(&lpshi));
+		if (!lpshi || S_OK != lpshi->lpVtbl->GetIconOf(lpshi, lplvid->pidl, GIL_FORSHELL, &lvi.iImage)) {
+			SHFILEINFO shfi;
+			LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, lplvid->pidl, 0);
+			SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
+			CoTaskMemFree((LPVOID)pidl);
+			lvi.iImage = shfi.iIcon;
+		}
 #endif
+		if (node != NULL) {
+			node->iImage = lvi.iImage;
+		}
+	}
 
-	int iItem = 0;
-	while (iItem < iMaxItem && BackgroundWorker_Continue(worker)) {
-		LV_ITEM lvi;
-		lvi.iItem = iItem;
-		lvi.mask = LVIF_PARAM;
-		if (ListView_GetItem(hwnd, &lvi)) {
-			LPLV_ITEMDATA lplvid = (LPLV_ITEMDATA)lvi.lParam;
-			lvi.mask = LVIF_IMAGE;
+	// It proved necessary to reset the state bits...
+	lvi.stateMask = 0;
+	lvi.state = 0;
 
+	DWORD dwAttributes = SFGAO_LINK | SFGAO_SHARE;
+	// Link and Share Overlay
 #if defined(__cplusplus)
-			if (!lpshi || S_OK != lpshi->GetIconOf(lplvid->pidl, GIL_FORSHELL, &lvi.iImage)) {
-				SHFILEINFO shfi;
-				LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, lplvid->pidl, 0);
-				SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
-				CoTaskMemFree(pidl);
-				lvi.iImage = shfi.iIcon;
-			}
+	lplvid->lpsf->GetAttributesOf(1, (LPCITEMIDLIST *)(&lplvid->pidl), &dwAttributes);
 #else
-			if (!lpshi || S_OK != lpshi->lpVtbl->GetIconOf(lpshi, lplvid->pidl, GIL_FORSHELL, &lvi.iImage)) {
-				SHFILEINFO shfi;
-				LPITEMIDLIST pidl = IL_Create(lpdl->pidl, lpdl->cbidl, lplvid->pidl, 0);
-				SHGetFileInfo((LPCWSTR)pidl, 0, &shfi, sizeof(SHFILEINFO), SHGFI_PIDL | SHGFI_SYSICONINDEX | SHGFI_SMALLICON);
-				CoTaskMemFree((LPVOID)pidl);
-				lvi.iImage = shfi.iIcon;
-			}
+	lplvid->lpsf->lpVtbl->GetAttributesOf(lplvid->lpsf, 1, (LPCITEMIDLIST *)(&lplvid->pidl), &dwAttributes);
 #endif
 
-			// It proved necessary to reset the state bits...
-			lvi.stateMask = 0;
-			lvi.state = 0;
+	if (dwAttributes & SFGAO_LINK) {
+		lvi.mask |= LVIF_STATE;
+		lvi.stateMask |= LVIS_OVERLAYMASK;
+		lvi.state |= INDEXTOOVERLAYMASK(2);
+	}
 
-			DWORD dwAttributes = SFGAO_LINK | SFGAO_SHARE;
-			// Link and Share Overlay
+	if (dwAttributes & SFGAO_SHARE) {
+		lvi.mask |= LVIF_STATE;
+		lvi.stateMask |= LVIS_OVERLAYMASK;
+		lvi.state |= INDEXTOOVERLAYMASK(1);
+	}
+
+	// Fade hidden/system files
+	if (!lpdl->bNoFadeHidden && bFindData) {
+		if ((fd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) ||
+				(fd.dwFileAttributes & FILE_ATTRIBUTE_SYSTEM)) {
+			lvi.mask |= LVIF_STATE;
+			lvi.stateMask |= LVIS_CUT;
+			lvi.state |= LVIS_CUT;
+		}
+	}
+	ListView_SetItem(hwnd, &lvi);
+}
+
+DWORD WINAPI DirList_IconThread(LPVOID lpParam) {
+	LPDLDATA lpdl = (LPDLDATA)lpParam;
+	BackgroundWorker *worker = &lpdl->worker;
+
+	// Exit immediately if DirList_Fill() hasn't been called
+	if (!lpdl->lpsf) {
+		return 0;
+	}
+
+	HWND hwnd = worker->hwnd;
+	const int iMaxItem = ListView_GetItemCount(hwnd);
+
+	DLICON_RESOLVER resolver;
+	resolver.lpdl = lpdl;
+	resolver.cache = (DLICON_CACHE *)NP2HeapAlloc(sizeof(DLICON_CACHE));
+
+	// Get IShellIcon
+	resolver.lpshi = NULL;
 #if defined(__cplusplus)
-			lplvid->lpsf->GetAttributesOf(1, (LPCITEMIDLIST *)(&lplvid->pidl), &dwAttributes);
+	lpdl->lpsf->QueryInterface(IID_IShellIcon, (void **)(&resolver.lpshi));
 #else
-			lplvid->lpsf->lpVtbl->GetAttributesOf(lplvid->lpsf, 1, (LPCITEMIDLIST *)(&lplvid->pidl), &dwAttributes);
+	lpdl->lpsf->lpVtbl->QueryInterface(lpdl->lpsf, &IID_IShellIcon, (void **)(&resolver.lpshi));
 #endif
 
-			if (dwAttributes & SFGAO_LINK) {
-				lvi.mask |= LVIF_STATE;
-				lvi.stateMask |= LVIS_OVERLAYMASK;
-				lvi.state |= INDEXTOOVERLAYMASK(2);
-			}
-
-			if (dwAttributes & SFGAO_SHARE) {
-				lvi.mask |= LVIF_STATE;
-				lvi.stateMask |= LVIS_OVERLAYMASK;
-				lvi.state |= INDEXTOOVERLAYMASK(1);
-			}
-
-			// Fade hidden/system files
-			if (!lpdl->bNoFadeHidden) {
-				WIN32_FIND_DATA fd;
-				if (S_OK == SHGetDataFromIDList(lplvid->lpsf, lplvid->pidl,
-												   SHGDFIL_FINDDATA, &fd, sizeof(WIN32_FIND_DATA))) {
-					if ((fd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) ||
-							(fd.dwFileAttributes & FILE_ATTRIBUTE_SYSTEM)) {
-						lvi.mask |= LVIF_STATE;
-						lvi.stateMask |= LVIS_CUT;
-						lvi.state |= LVIS_CUT;
-					}
-				}
-			}
-			lvi.iSubItem = 0;
-			ListView_SetItem(hwnd, &lvi);
+	// rows in view first, then the remaining rows
+	const int iFirst = max_i(ListView_GetTopIndex(hwnd), 0);
+	const int iLast = min_i(iFirst + ListView_GetCountPerPage(hwnd) + 1, iMaxItem);
+	for (int iItem = iFirst; iItem < iLast && BackgroundWorker_Continue(worker); iItem++) {
+		DirList_ResolveIcon(hwnd, &resolver, iItem);
+	}
+	for (int iItem = 0; iItem < iMaxItem && BackgroundWorker_Continue(worker); iItem++) {
+		if (iItem < iFirst || iItem >= iLast) {
+			DirList_ResolveIcon(hwnd, &resolver, iItem);
 		}
-		iItem++;
 	}
 
-	if (lpshi) {
+	if (resolver.lpshi) {
 #if defined(__cplusplus)
-		lpshi->Release();
+		resolver.lpshi->Release();
 #else
-		lpshi->lpVtbl->Release(lpshi);
+		resolver.lpshi->lpVtbl->Release(resolver.lpshi);
 #endif
 	}
+	NP2HeapFree(resolver.cache);
 
 	return 0;
 }
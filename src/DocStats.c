@@ -0,0 +1,511 @@
+// Document Statistics
+
+#include <windows.h>
+#include "SciCall.h"
+#include "VectorISA.h"
+#include "TraceEvents.h"
+#include "Helpers.h"
+#include "Notepad2.h"
+#include "Edit.h"
+#include "Dialogs.h"
+#include "DocStats.h"
+#include "resource.h"
+
+// Document is split into slices. Counts of a slice only depend on its bytes and one byte on
+// each side (for word start and CR+LF), so slices are counted independently on all processors,
+// and an edit only invalidates slices around it. Invalidated slices are counted again from the
+// document when they are small, otherwise over a new snapshot on worker threads.
+
+extern HWND hwndMain;
+
+#define DOCSTATS_SLICE_SIZE			(4*1024*1024)
+// invalidated slice larger than this is split
+#define DOCSTATS_MAX_SLICE_SIZE		(4*DOCSTATS_SLICE_SIZE)
+// invalidated text not larger than this is counted on UI thread
+#define DOCSTATS_SYNC_COUNT_SIZE	DOCSTATS_SLICE_SIZE
+
+enum {
+	DocStatsEncoding_SBCS,
+	DocStatsEncoding_UTF8,
+	// not split as trail byte can't be distinguished from lead byte
+	DocStatsEncoding_DBCS,
+};
+
+typedef struct DocStatsSlice {
+	Sci_Position start;
+	DocStatistics stats;
+	BOOL dirty;		// needs to be counted again
+	BOOL touched;	// modified after snapshot of the counting job
+} DocStatsSlice;
+
+typedef struct DocStatsTask {
+	UINT index;
+	Sci_Position start;
+	Sci_Position end;
+	DocStatistics stats;
+} DocStatsTask;
+
+typedef struct DocStatsBuilder {
+	BackgroundWorker worker;
+	const char *snapshot;	// shared copy from SciCall_AcquireTextSnapshot()
+	DocStatsTask *tasks;
+	UINT taskCount;
+	volatile LONG nextTask;
+	volatile LONG finishedTask;
+	BOOL active;
+} DocStatsBuilder;
+
+typedef struct DocStatsStatus {
+	DocStatsSlice *slices;	// NULL when not counted
+	UINT sliceCount;
+	UINT cpEdit;
+	int encoding;
+	Sci_Position docLength;
+	BOOL showResult;		// show result after counting is finished
+	DocStatsBuilder builder;
+	uint8_t leadByte[256];
+} DocStatsStatus;
+
+static DocStatsStatus docStats;
+
+// word start is counted at first word character, CR is counted when not followed by LF.
+static void DocStats_CountText(const uint8_t *ptr, Sci_Position length, uint8_t prev, uint8_t next, DocStatistics *stats) {
+	const uint8_t * const end = ptr + length;
+	const int encoding = docStats.encoding;
+	size_t characters = 0;
+	size_t words = 0;
+	size_t lineEnds = 0;
+	size_t whitespace = 0;
+	size_t nonASCII = 0;
+	uint32_t prevWord = IsDefaultWordChar(prev);
+
+#if NP2_USE_AVX2
+	if (encoding != DocStatsEncoding_DBCS) {
+		const __m256i vectCR = _mm256_set1_epi8('\r');
+		const __m256i vectLF = _mm256_set1_epi8('\n');
+		const __m256i vectSpace = _mm256_set1_epi8(' ');
+		const __m256i vectTab = _mm256_set1_epi8('\t');
+		const __m256i vectUnderscore = _mm256_set1_epi8('_');
+		const __m256i vectCaseBit = _mm256_set1_epi8(0x20);
+		// range check with signed comparison: ch - low - 128 < count - 128
+		const __m256i vectAlphaBias = _mm256_set1_epi8(0x80 - 'a');
+		const __m256i vectAlphaCount = _mm256_set1_epi8(26 - 128);
+		const __m256i vectDigitBias = _mm256_set1_epi8(0x80 - '0');
+		const __m256i vectDigitCount = _mm256_set1_epi8(10 - 128);
+		// UTF-8 trail byte 0x80 ~ 0xBF
+		const __m256i vectTrailMax = _mm256_set1_epi8(0xBF - 256);
+		// one more byte is read for CR+LF
+		while (ptr + sizeof(__m256i) < end) {
+			const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+			const uint32_t maskHigh = _mm256_movemask_epi8(chunk);
+			const uint32_t maskLead = _mm256_movemask_epi8(_mm256_cmpgt_epi8(chunk, vectTrailMax));
+			const uint32_t maskCR = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vectCR));
+			const uint32_t maskLF = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vectLF));
+			const uint32_t maskBlank = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectSpace), _mm256_cmpeq_epi8(chunk, vectTab)));
+			__m256i word = _mm256_cmpgt_epi8(vectAlphaCount, _mm256_add_epi8(_mm256_or_si256(chunk, vectCaseBit), vectAlphaBias));
+			word = _mm256_or_si256(word, _mm256_cmpgt_epi8(vectDigitCount, _mm256_add_epi8(chunk, vectDigitBias)));
+			word = _mm256_or_si256(word, _mm256_cmpeq_epi8(chunk, vectUnderscore));
+			const uint32_t maskWord = _mm256_movemask_epi8(word) | maskHigh;
+			const uint32_t nextLF = ptr[sizeof(__m256i)] == '\n';
+			ptr += sizeof(__m256i);
+
+			characters += np2_popcount(maskLead);
+			words += np2_popcount(maskWord & ~((maskWord << 1) | prevWord));
+			prevWord = maskWord >> 31;
+			lineEnds += np2_popcount(maskLF) + np2_popcount(maskCR & ~((maskLF >> 1) | (nextLF << 31)));
+			whitespace += np2_popcount(maskBlank | maskCR | maskLF);
+			nonASCII += np2_popcount(maskHigh);
+		}
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	if (encoding != DocStatsEncoding_DBCS) {
+		const __m128i vectCR = _mm_set1_epi8('\r');
+		const __m128i vectLF = _mm_set1_epi8('\n');
+		const __m128i vectSpace = _mm_set1_epi8(' ');
+		const __m128i vectTab = _mm_set1_epi8('\t');
+		const __m128i vectUnderscore = _mm_set1_epi8('_');
+		const __m128i vectCaseBit = _mm_set1_epi8(0x20);
+		// range check with signed comparison: ch - low - 128 < count - 128
+		const __m128i vectAlphaBias = _mm_set1_epi8(0x80 - 'a');
+		const __m128i vectAlphaCount = _mm_set1_epi8(26 - 128);
+		const __m128i vectDigitBias = _mm_set1_epi8(0x80 - '0');
+		const __m128i vectDigitCount = _mm_set1_epi8(10 - 128);
+		// UTF-8 trail byte 0x80 ~ 0xBF
+		const __m128i vectTrailMax = _mm_set1_epi8(0xBF - 256);
+		// one more byte is read for CR+LF
+		while (ptr + sizeof(__m128i) < end) {
+			const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+			const uint32_t maskHigh = _mm_movemask_epi8(chunk);
+			const uint32_t maskLead = _mm_movemask_epi8(_mm_cmpgt_epi8(chunk, vectTrailMax));
+			const uint32_t maskCR = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vectCR));
+			const uint32_t maskLF = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vectLF));
+			const uint32_t maskBlank = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, vectSpace), _mm_cmpeq_epi8(chunk, vectTab)));
+			__m128i word = _mm_cmpgt_epi8(vectAlphaCount, _mm_add_epi8(_mm_or_si128(chunk, vectCaseBit), vectAlphaBias));
+			word = _mm_or_si128(word, _mm_cmpgt_epi8(vectDigitCount, _mm_add_epi8(chunk, vectDigitBias)));
+			word = _mm_or_si128(word, _mm_cmpeq_epi8(chunk, vectUnderscore));
+			const uint32_t maskWord = _mm_movemask_epi8(word) | maskHigh;
+			const uint32_t nextLF = ptr[sizeof(__m128i)] == '\n';
+			ptr += sizeof(__m128i);
+
+			characters += np2_popcount(maskLead);
+			words += np2_popcount(maskWord & ~((maskWord << 1) | prevWord));
+			prevWord = maskWord >> 15;
+			lineEnds += np2_popcount(maskLF) + np2_popcount(maskCR & ~((maskLF >> 1) | (nextLF << 15)));
+			whitespace += np2_popcount(maskBlank | maskCR | maskLF);
+			nonASCII += np2_popcount(maskHigh);
+		}
+	}
+	// end NP2_USE_SSE2
+#endif
+
+	const BOOL dbcs = encoding == DocStatsEncoding_DBCS;
+	while (ptr < end) {
+		const uint8_t ch = *ptr++;
+		const uint32_t word = IsDefaultWordChar(ch);
+		words += word & ~prevWord;
+		prevWord = word;
+		if (ch & 0x80) {
+			++nonASCII;
+			if (dbcs) {
+				++characters;
+				if (docStats.leadByte[ch] && ptr < end) {
+					++ptr;
+					++nonASCII;
+				}
+			} else {
+				characters += (ch & 0x40) >> 6;
+			}
+		} else {
+			++characters;
+			if (ch <= ' ') {
+				if (ch == ' ' || ch == '\t') {
+					++whitespace;
+				} else if (ch == '\n') {
+					++whitespace;
+					++lineEnds;
+				} else if (ch == '\r') {
+					++whitespace;
+					lineEnds += ((ptr < end) ? *ptr : next) != '\n';
+				}
+			}
+		}
+	}
+
+	stats->bytes = length;
+	stats->characters = (encoding == DocStatsEncoding_SBCS) ? length : (Sci_Position)characters;
+	stats->words = words;
+	stats->lineEnds = lineEnds;
+	stats->whitespace = whitespace;
+	stats->nonASCII = nonASCII;
+}
+
+static inline Sci_Position DocStats_SliceEnd(UINT index) {
+	return (index + 1 < docStats.sliceCount) ? docStats.slices[index + 1].start : docStats.docLength;
+}
+
+// find last slice starts not after position.
+static UINT DocStats_FindSlice(Sci_Position position) {
+	UINT lower = 0;
+	UINT upper = docStats.sliceCount - 1;
+	while (lower < upper) {
+		const UINT middle = (lower + upper + 1)/2;
+		if (docStats.slices[middle].start <= position) {
+			lower = middle;
+		} else {
+			upper = middle - 1;
+		}
+	}
+	return lower;
+}
+
+static inline void DocStats_Invalidate(UINT index) {
+	docStats.slices[index].dirty = TRUE;
+	docStats.slices[index].touched = TRUE;
+}
+
+static void DocStats_Reset(Sci_Position length, UINT cpEdit) {
+	if (docStats.slices) {
+		NP2HeapFree(docStats.slices);
+	}
+	// whole document as one invalidated slice, split by DocStats_Reslice()
+	docStats.slices = (DocStatsSlice *)NP2HeapAlloc(sizeof(DocStatsSlice));
+	docStats.slices[0].dirty = TRUE;
+	docStats.sliceCount = 1;
+	docStats.docLength = length;
+	docStats.cpEdit = cpEdit;
+	if (cpEdit == SC_CP_UTF8) {
+		docStats.encoding = DocStatsEncoding_UTF8;
+	} else if (IsDBCSCodePage(cpEdit)) {
+		docStats.encoding = DocStatsEncoding_DBCS;
+		for (UINT ch = 0x80; ch < 0x100; ch++) {
+			docStats.leadByte[ch] = (uint8_t)IsDBCSLeadByteEx(cpEdit, (BYTE)ch);
+		}
+	} else {
+		docStats.encoding = DocStatsEncoding_SBCS;
+	}
+}
+
+// drop empty slices and split large invalidated slices, counts of other slices are kept.
+static void DocStats_Reslice(void) {
+	const UINT sliceCount = docStats.sliceCount;
+	const DocStatsSlice * const slices = docStats.slices;
+	const BOOL splittable = docStats.encoding != DocStatsEncoding_DBCS;
+	UINT count = 0;
+	BOOL changed = FALSE;
+	for (UINT index = 0; index < sliceCount; index++) {
+		const Sci_Position size = DocStats_SliceEnd(index) - slices[index].start;
+		if (size == 0) {
+			changed = TRUE;
+		} else if (splittable && slices[index].dirty && size > DOCSTATS_MAX_SLICE_SIZE) {
+			count += (UINT)((size - 1)/DOCSTATS_SLICE_SIZE + 1);
+			changed = TRUE;
+		} else {
+			++count;
+		}
+	}
+	if (!changed) {
+		return;
+	}
+
+	// empty document has one empty slice
+	DocStatsSlice *result = (DocStatsSlice *)NP2HeapAlloc(max_u(count, 1)*sizeof(DocStatsSlice));
+	count = 0;
+	for (UINT index = 0; index < sliceCount; index++) {
+		Sci_Position start = slices[index].start;
+		const Sci_Position end = DocStats_SliceEnd(index);
+		if (start == end) {
+			continue;
+		}
+		if (splittable && slices[index].dirty && end - start > DOCSTATS_MAX_SLICE_SIZE) {
+			do {
+				result[count].start = start;
+				result[count].dirty = TRUE;
+				++count;
+				start += DOCSTATS_SLICE_SIZE;
+			} while (start < end);
+		} else {
+			result[count++] = slices[index];
+		}
+	}
+
+	NP2HeapFree(docStats.slices);
+	docStats.slices = result;
+	docStats.sliceCount = max_u(count, 1);
+}
+
+static void DocStats_StopBuilder(DocStatsBuilder *builder) {
+	if (builder->active) {
+		// APPM_DOCSTATISTICS dispatched while waiting is ignored
+		builder->active = FALSE;
+		BackgroundWorker_Destroy(&builder->worker);
+		SciCall_ReleaseTextSnapshot(builder->snapshot);
+		builder->snapshot = NULL;
+		NP2HeapFree(builder->tasks);
+		builder->tasks = NULL;
+	}
+}
+
+static DWORD WINAPI DocStatsSliceThread(LPVOID lpParam) {
+	DocStatsBuilder *builder = (DocStatsBuilder *)lpParam;
+	const uint8_t * const text = (const uint8_t *)builder->snapshot;
+
+	while (BackgroundWorker_Continue(&builder->worker)) {
+		const UINT index = (UINT)InterlockedIncrement(&builder->nextTask) - 1;
+		if (index >= builder->taskCount) {
+			break;
+		}
+		DocStatsTask *task = &builder->tasks[index];
+		const uint8_t prev = (task->start == 0) ? 0 : text[task->start - 1];
+		// snapshot is NUL terminated
+		DocStats_CountText(text + task->start, task->end - task->start, prev, text[task->end], &task->stats);
+		InterlockedIncrement(&builder->finishedTask);
+	}
+	return 0;
+}
+
+static DWORD WINAPI DocStatsBuildThread(LPVOID lpParam) {
+	DocStatsBuilder *builder = (DocStatsBuilder *)lpParam;
+
+	NP2_TRACE_START("DocStatsBuild", NP2_TRACE_INT64(builder->taskCount, "slices"));
+	RunOnAllProcessors(DocStatsSliceThread, builder, builder->taskCount);
+	NP2_TRACE_STOP("DocStatsBuild", NP2_TRACE_INT64(builder->finishedTask, "counted"));
+	PostMessage(builder->worker.hwnd, APPM_DOCSTATISTICS, 0, 0);
+	return 0;
+}
+
+static BOOL DocStats_StartBuilder(UINT taskCount) {
+	const char *snapshot = SciCall_AcquireTextSnapshot();
+	if (snapshot == NULL) {
+		return FALSE;
+	}
+
+	DocStatsTask *tasks = (DocStatsTask *)NP2HeapAlloc(taskCount*sizeof(DocStatsTask));
+	if (tasks == NULL) {
+		SciCall_ReleaseTextSnapshot(snapshot);
+		return FALSE;
+	}
+	UINT count = 0;
+	for (UINT index = 0; index < docStats.sliceCount; index++) {
+		DocStatsSlice *slice = &docStats.slices[index];
+		if (slice->dirty) {
+			slice->touched = FALSE;
+			tasks[count].index = index;
+			tasks[count].start = slice->start;
+			tasks[count].end = DocStats_SliceEnd(index);
+			++count;
+		}
+	}
+
+	DocStatsBuilder *builder = &docStats.builder;
+	ZeroMemory(builder, sizeof(DocStatsBuilder));
+	BackgroundWorker_Init(&builder->worker, hwndMain);
+	builder->snapshot = snapshot;
+	builder->tasks = tasks;
+	builder->taskCount = count;
+	builder->active = TRUE;
+	if (!BackgroundWorker_Start(&builder->worker, DocStatsBuildThread, builder, WorkerPriority_High)) {
+		DocStats_StopBuilder(builder);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+BOOL DocStats_Get(DocStatistics *stats) {
+	if (docStats.builder.active) {
+		return FALSE;
+	}
+
+	const UINT cpEdit = SciCall_GetCodePage();
+	const Sci_Position length = SciCall_GetLength();
+	if (docStats.slices == NULL || docStats.cpEdit != cpEdit || docStats.docLength != length) {
+		// not counted, or document changed without notification
+		DocStats_Reset(length, cpEdit);
+	}
+	DocStats_Reslice();
+
+	Sci_Position dirtySize = 0;
+	UINT dirtyCount = 0;
+	for (UINT index = 0; index < docStats.sliceCount; index++) {
+		if (docStats.slices[index].dirty) {
+			dirtySize += DocStats_SliceEnd(index) - docStats.slices[index].start;
+			++dirtyCount;
+		}
+	}
+	if (dirtySize > DOCSTATS_SYNC_COUNT_SIZE && DocStats_StartBuilder(dirtyCount)) {
+		return FALSE;
+	}
+
+	ZeroMemory(stats, sizeof(DocStatistics));
+	for (UINT index = 0; index < docStats.sliceCount; index++) {
+		DocStatsSlice *slice = &docStats.slices[index];
+		if (slice->dirty) {
+			const Sci_Position start = slice->start;
+			const Sci_Position end = DocStats_SliceEnd(index);
+			const uint8_t prev = (start == 0) ? 0 : (uint8_t)SciCall_GetCharAt(start - 1);
+			const uint8_t next = (uint8_t)SciCall_GetCharAt(end);
+			const char *text = SciCall_GetRangePointer(start, end - start);
+			DocStats_CountText((const uint8_t *)text, end - start, prev, next, &slice->stats);
+			slice->dirty = FALSE;
+		}
+		stats->bytes += slice->stats.bytes;
+		stats->characters += slice->stats.characters;
+		stats->words += slice->stats.words;
+		stats->lineEnds += slice->stats.lineEnds;
+		stats->whitespace += slice->stats.whitespace;
+		stats->nonASCII += slice->stats.nonASCII;
+	}
+	return TRUE;
+}
+
+void DocStats_Show(void) {
+	DocStatistics stats;
+	if (!DocStats_Get(&stats)) {
+		docStats.showResult = TRUE;
+		return;
+	}
+
+	WCHAR tchWords[32];
+	WCHAR tchChars[32];
+	WCHAR tchNonBlank[32];
+	WCHAR tchLines[32];
+	WCHAR tchBytes[32];
+	WCHAR tchNonASCII[32];
+	PosToStrW(stats.words, tchWords);
+	PosToStrW(stats.characters, tchChars);
+	PosToStrW(stats.characters - stats.whitespace, tchNonBlank);
+	PosToStrW(stats.lineEnds + 1, tchLines);
+	PosToStrW(stats.bytes, tchBytes);
+	PosToStrW(stats.nonASCII, tchNonASCII);
+	FormatNumberStr(tchWords);
+	FormatNumberStr(tchChars);
+	FormatNumberStr(tchNonBlank);
+	FormatNumberStr(tchLines);
+	FormatNumberStr(tchBytes);
+	FormatNumberStr(tchNonASCII);
+	MsgBoxInfo(MB_OK, IDS_DOCSTATISTICS, tchWords, tchChars, tchNonBlank, tchLines, tchBytes, tchNonASCII);
+}
+
+void DocStats_OnCounted(void) {
+	DocStatsBuilder *builder = &docStats.builder;
+	if (!builder->active) {
+		return;
+	}
+
+	// the thread exits after posting the message
+	WaitForSingleObject(builder->worker.workerThread, INFINITE);
+	if ((UINT)builder->finishedTask == builder->taskCount) {
+		// slices modified after the snapshot are counted again
+		for (UINT i = 0; i < builder->taskCount; i++) {
+			const DocStatsTask *task = &builder->tasks[i];
+			DocStatsSlice *slice = &docStats.slices[task->index];
+			if (!slice->touched) {
+				slice->stats = task->stats;
+				slice->dirty = FALSE;
+			}
+		}
+	}
+	DocStats_StopBuilder(builder);
+	if (docStats.showResult) {
+		docStats.showResult = FALSE;
+		DocStats_Show();
+	}
+}
+
+void DocStats_OnModified(BOOL insert, Sci_Position position, Sci_Position length) {
+	if (docStats.slices == NULL || length == 0) {
+		return;
+	}
+
+	DocStatsSlice * const slices = docStats.slices;
+	UINT index = DocStats_FindSlice(position);
+	DocStats_Invalidate(index);
+	const Sci_Position end = position + length;
+	for (UINT i = index + 1; i < docStats.sliceCount; i++) {
+		if (insert) {
+			slices[i].start += length;
+		} else if (slices[i].start <= end) {
+			// byte before the slice is changed
+			slices[i].start = position;
+			DocStats_Invalidate(i);
+		} else {
+			slices[i].start -= length;
+		}
+	}
+	// byte after previous slice is changed
+	while (index != 0 && slices[index].start == position) {
+		--index;
+		DocStats_Invalidate(index);
+	}
+	docStats.docLength += insert ? length : -length;
+}
+
+void DocStats_Discard(void) {
+	DocStats_StopBuilder(&docStats.builder);
+	if (docStats.slices) {
+		NP2HeapFree(docStats.slices);
+		docStats.slices = NULL;
+	}
+	docStats.sliceCount = 0;
+	docStats.showResult = FALSE;
+}
@@ -0,0 +1,20 @@
+// Document Statistics
+#pragma once
+
+typedef struct DocStatistics {
+	Sci_Position bytes;
+	Sci_Position characters;
+	Sci_Position words;			// runs of word characters, see IsDefaultWordChar()
+	Sci_Position lineEnds;		// CR+LF is counted once
+	Sci_Position whitespace;	// space, tab, CR and LF
+	Sci_Position nonASCII;		// bytes of characters outside ASCII
+} DocStatistics;
+
+// counts changed text, returns FALSE when it's counted on worker threads over
+// a snapshot, APPM_DOCSTATISTICS is posted when finished.
+BOOL DocStats_Get(DocStatistics *stats);
+// show statistics now or after counting is finished.
+void DocStats_Show(void);
+void DocStats_OnCounted(void);
+void DocStats_OnModified(BOOL insert, Sci_Position position, Sci_Position length);
+void DocStats_Discard(void);
@@ -34,15 +34,22 @@
 #include <inttypes.h>
 #include "SciCall.h"
 #include "VectorISA.h"
+#include "TraceEvents.h"
 #include "Helpers.h"
 #include "Notepad2.h"
 #include "Edit.h"
 #include "Styles.h"
 #include "Dialogs.h"
+#include "CsvView.h"
+#include "Compare.h"
+#include "MarkTerms.h"
+#include "Decompressor.h"
+#include "DocStats.h"
 #include "resource.h"
 
 extern HWND hwndMain;
 extern HWND hwndEdit;
+extern HWND hwndStatus;
 extern DWORD dwLastIOError;
 extern HWND hDlgFindReplace;
 extern UINT cpLastFind;
@@ -66,6 +73,7 @@ extern int iSrcEncoding;
 extern int iWeakSrcEncoding;
 
 extern int g_DOSEncoding;
+extern DWORD dwFileMappingMinSize;
 
 extern LPMRULIST mruFind;
 extern LPMRULIST mruReplace;
@@ -93,6 +101,10 @@ static HMODULE hELSCoreDLL = NULL;
 #endif
 
 #define MAX_NON_UTF8_SIZE	(UINT_MAX/2 - 16)
+// styles are only kept around current view and lexing position for streamed file
+#define STREAMING_LOAD_STYLE_WINDOW	(256*1024*1024)
+// layout cached for whole document with large file profile is limited to this size
+#define LARGE_FILE_LAYOUT_CACHE_BUDGET	(128*1024*1024)
 
 void Edit_ReleaseResources(void) {
 	DStringW_Free(&wchPrefixSelection);
@@ -119,13 +131,42 @@ extern BOOL bFreezeAppTitle;
 extern BOOL bLockedForEditing;
 #if defined(_WIN64)
 extern BOOL bLargeFileMode;
+extern DWORD dwCompressTextMinSize;
+
+// options for document of huge file, text away from the view is compressed above CompressTextMinSize.
+static int EditLargeDocumentOptions(UINT64 cbText) {
+	int options = SC_DOCUMENTOPTION_TEXT_LARGE | SC_DOCUMENTOPTION_STYLES_NONE | SC_DOCUMENTOPTION_STYLES_COMPRESSED | SC_DOCUMENTOPTION_LINES_COMPACT;
+	if (dwCompressTextMinSize != 0 && cbText >= ((UINT64)dwCompressTextMinSize << 20)) {
+		options |= SC_DOCUMENTOPTION_TEXT_COMPRESSED;
+	}
+	return options;
+}
 #endif
+extern DWORD dwLargeFileProfileSize;
+extern DWORD dwLargeFileProfileLines;
+extern BOOL bLargeFileProfile;
 extern FILEVARS fvCurFile;
 extern EditTabSettings tabSettings;
 extern int iWrapColumn;
 extern int iWordWrapIndent;
+extern int iWordWrapMode;
+
+void EditApplyLargeFileProfile(void) {
+	if (bLargeFileProfile) {
+		// only style visible text, reuse layout when scrolling back
+		SciCall_SetIdleStyling(SC_IDLESTYLING_TOVISIBLE);
+		SciCall_SetLayoutCacheBudget(LARGE_FILE_LAYOUT_CACHE_BUDGET);
+		SciCall_SetLayoutCache(SC_CACHE_DOCUMENT);
+		SciCall_SetWrapMode(SC_WRAP_NONE);
+	} else {
+		SciCall_SetIdleStyling(SC_IDLESTYLING_BACKGROUND);
+		SciCall_SetLayoutCache(SC_CACHE_PAGE);
+		SciCall_SetWrapMode(fvCurFile.fWordWrap ? iWordWrapMode : SC_WRAP_NONE);
+	}
+}
 
 void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
+	EditPipeSource_Stop();
 	bFreezeAppTitle = TRUE;
 	bLockedForEditing = FALSE;
 	iWrapColumn = 0;
@@ -134,14 +175,18 @@ void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
 	SciCall_Cancel();
 	SciCall_SetUndoCollection(FALSE);
 	SciCall_EmptyUndoBuffer();
+	Compare_Clear();
+	MarkTerms_Clear();
 	SciCall_ClearAll();
 	SciCall_ClearMarker();
 	SciCall_SetXOffset(0);
+	// allocated again by UpdateStatusbar() when large selection is counted
+	SciCall_ReleaseLineCharacterIndex(SC_LINECHARACTERINDEX_UTF32);
 
 #if defined(_WIN64)
 	// enable conversion between line endings
 	if (bLargeFileMode || cbText + lineCount >= MAX_NON_UTF8_SIZE) {
-		const int mask = SC_DOCUMENTOPTION_TEXT_LARGE | SC_DOCUMENTOPTION_STYLES_NONE;
+		const int mask = EditLargeDocumentOptions(cbText);
 		const int options = SciCall_GetDocumentOptions();
 		if ((options & mask) != mask) {
 			HANDLE pdoc = SciCall_CreateDocument(cbText + 1, options | mask);
@@ -151,6 +196,18 @@ void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
 	}
 #endif
 
+	bLargeFileProfile = (dwLargeFileProfileSize != 0 && cbText >= ((UINT64)dwLargeFileProfileSize << 20))
+		|| (dwLargeFileProfileLines != 0 && (UINT64)lineCount >= dwLargeFileProfileLines);
+	if (bLargeFileProfile) {
+		// run-length style store, styles are mostly default for unvisited text
+		const int options = SciCall_GetDocumentOptions();
+		if (!(options & (SC_DOCUMENTOPTION_STYLES_NONE | SC_DOCUMENTOPTION_STYLES_COMPRESSED))) {
+			HANDLE pdoc = SciCall_CreateDocument(cbText + 1, options | SC_DOCUMENTOPTION_STYLES_COMPRESSED);
+			EditReplaceDocument(pdoc);
+		}
+	}
+	EditApplyLargeFileProfile();
+
 	FileVars_Apply(&fvCurFile);
 
 	if (cbText > 0) {
@@ -166,7 +223,7 @@ void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
 		StopWatch_Stop(watch);
 		StopWatch_ShowLog(&watch, "AddText time");
 #endif
-		SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
+		SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_BULKMODIFICATION);
 		SendMessage(hwndEdit, WM_SETREDRAW, TRUE, 0);
 		RedrawWindow(hwndEdit, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
 	}
@@ -174,10 +231,113 @@ void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
 	SciCall_SetUndoCollection(TRUE);
 	SciCall_EmptyUndoBuffer();
 	SciCall_SetSavePoint();
+	CsvView_Reset();
 
 	bFreezeAppTitle = FALSE;
 }
 
+// encoding conversion is split into chunks at character boundary of source code page, chunks are
+// converted on all processors, then appended in order as they are done, so no whole document UTF-16
+// buffer is required.
+#define NP2_CONVERT_TEXT_CHUNK_SIZE		(4*1024*1024)
+
+typedef struct TextConversionChunk {
+	Sci_Position start;
+	Sci_Position end;
+	char *lpOut;
+	int cbOut;
+	volatile LONG done;
+} TextConversionChunk;
+
+typedef struct TextConversionWorker {
+	const char *pchText;
+	UINT cpSource;
+	UINT cpDest;
+	TextConversionChunk *chunks;
+	DWORD chunkCount;
+	volatile LONG nextChunk;
+	HANDLE eventDone;
+} TextConversionWorker;
+
+// chunk can be split after any byte which is a single byte character in source code page.
+static Sci_Position GetTextConversionBoundary(const char *pchText, Sci_Position start, Sci_Position end, UINT cpSource) {
+	if (cpSource == CP_UTF8) {
+		// skip back at most 3 continuation bytes
+		const Sci_Position minPos = max_pos(start, end - 3);
+		Sci_Position pos = end;
+		while (pos > minPos && ((uint8_t)pchText[pos] & 0xC0) == 0x80) {
+			--pos;
+		}
+		return pos;
+	}
+	if (IsDBCSCodePage(cpSource)) {
+		// bytes below 0x30 are neither lead nor trail byte of any DBCS, see IsDBCSCodePage().
+		for (Sci_Position pos = end; pos > start; pos--) {
+			if ((uint8_t)pchText[pos - 1] < 0x30) {
+				return pos;
+			}
+		}
+		// merge with next chunk
+		return start;
+	}
+	return end;
+}
+
+static DWORD WINAPI TextConversionThread(LPVOID lpParam) {
+	TextConversionWorker *worker = (TextConversionWorker *)lpParam;
+	const UINT cpSource = worker->cpSource;
+	const UINT cpDest = worker->cpDest;
+	LPWSTR lpDataWide = NULL;
+
+	while (TRUE) {
+		const DWORD index = (DWORD)InterlockedIncrement(&worker->nextChunk) - 1;
+		if (index >= worker->chunkCount) {
+			break;
+		}
+
+		TextConversionChunk *chunk = &worker->chunks[index];
+		const int cbData = (int)(chunk->end - chunk->start);
+		if (cbData != 0) {
+			const char *lpData = worker->pchText + chunk->start;
+			if (lpDataWide == NULL || NP2HeapSize(lpDataWide) < (cbData + 1) * sizeof(WCHAR)) {
+				if (lpDataWide != NULL) {
+					NP2HeapFree(lpDataWide);
+				}
+				lpDataWide = (LPWSTR)NP2HeapAlloc((cbData + 1) * sizeof(WCHAR));
+			}
+			if (lpDataWide != NULL) {
+				int cchDataWide;
+				if (cpSource == CP_UTF8) {
+					cchDataWide = (int)UTF8ToUTF16(lpData, cbData, lpDataWide);
+				} else {
+					cchDataWide = MultiByteToWideChar(cpSource, 0, lpData, cbData, lpDataWide, cbData + 1);
+				}
+				if (cpDest == CP_UTF8) {
+					chunk->lpOut = (char *)NP2HeapAlloc(cchDataWide * kMaxMultiByteCount + 1);
+					if (chunk->lpOut != NULL) {
+						BOOL bLossy = FALSE;
+						chunk->cbOut = (int)UTF16ToUTF8(lpDataWide, cchDataWide, chunk->lpOut, &bLossy);
+					}
+				} else {
+					const int cbOut = WideCharToMultiByte(cpDest, 0, lpDataWide, cchDataWide, NULL, 0, NULL, NULL);
+					chunk->lpOut = (char *)NP2HeapAlloc(cbOut + 1);
+					if (chunk->lpOut != NULL) {
+						chunk->cbOut = WideCharToMultiByte(cpDest, 0, lpDataWide, cchDataWide, chunk->lpOut, cbOut, NULL, NULL);
+					}
+				}
+			}
+		}
+
+		InterlockedExchange(&chunk->done, TRUE);
+		SetEvent(worker->eventDone);
+	}
+
+	if (lpDataWide != NULL) {
+		NP2HeapFree(lpDataWide);
+	}
+	return 0;
+}
+
 //=============================================================================
 //
 // EditConvertText()
@@ -188,21 +348,56 @@ BOOL EditConvertText(UINT cpSource, UINT cpDest, BOOL bSetSavePoint) {
 	}
 
 	const Sci_Position length = SciCall_GetLength();
-	if (length >= (int)MAX_NON_UTF8_SIZE) {
-		return TRUE;
-	}
-
 	char *pchText = NULL;
-	int cbText = 0;
+	TextConversionWorker worker;
+	ZeroMemory(&worker, sizeof(worker));
+	HANDLE workerThreads[MAXIMUM_WAIT_OBJECTS];
+	DWORD threadCount = 0;
 	if (length > 0) {
-		// DBCS: length -> WCHAR: sizeof(WCHAR) * (length / 2) -> UTF-8: kMaxMultiByteCount * (length / 2)
-		pchText = (char *)NP2HeapAlloc((length + 1) * sizeof(WCHAR));
-		SciCall_GetText(NP2HeapSize(pchText), pchText);
+		pchText = (char *)NP2HeapAlloc(length + 1);
+		if (pchText == NULL) {
+			return FALSE;
+		}
+		SciCall_GetText(length + 1, pchText);
+
+		const DWORD chunkCount = (DWORD)((length - 1)/NP2_CONVERT_TEXT_CHUNK_SIZE + 1);
+		TextConversionChunk *chunks = (TextConversionChunk *)NP2HeapAlloc(chunkCount * sizeof(TextConversionChunk));
+		if (chunks == NULL) {
+			NP2HeapFree(pchText);
+			return FALSE;
+		}
 
-		WCHAR *pwchText = (WCHAR *)NP2HeapAlloc((length + 1) * sizeof(WCHAR));
-		const int cbwText = MultiByteToWideChar(cpSource, 0, pchText, (int)length, pwchText, (int)(NP2HeapSize(pwchText) / sizeof(WCHAR)));
-		cbText = WideCharToMultiByte(cpDest, 0, pwchText, cbwText, pchText, (int)(NP2HeapSize(pchText)), NULL, NULL);
-		NP2HeapFree(pwchText);
+		Sci_Position start = 0;
+		for (DWORD index = 0; index < chunkCount; index++) {
+			const Sci_Position end = (index + 1 == chunkCount) ? length
+				: GetTextConversionBoundary(pchText, start, (Sci_Position)(index + 1)*NP2_CONVERT_TEXT_CHUNK_SIZE, cpSource);
+			chunks[index].start = start;
+			chunks[index].end = end;
+			start = end;
+		}
+
+		worker.pchText = pchText;
+		worker.cpSource = cpSource;
+		worker.cpDest = cpDest;
+		worker.chunks = chunks;
+		worker.chunkCount = chunkCount;
+		worker.eventDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if (chunkCount > 1 && worker.eventDone != NULL) {
+			// current thread appends converted chunks to the document
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			DWORD count = min_u(info.dwNumberOfProcessors, MAXIMUM_WAIT_OBJECTS);
+			count = min_u(count, chunkCount);
+			for (DWORD i = 0; i < count; i++) {
+				HANDLE workerThread = WorkerPool_Submit(TextConversionThread, &worker, WorkerPriority_High);
+				if (workerThread) {
+					workerThreads[threadCount++] = workerThread;
+				}
+			}
+		}
+		if (threadCount == 0) {
+			TextConversionThread(&worker);
+		}
 	}
 
 	bLockedForEditing = FALSE;
@@ -210,19 +405,47 @@ BOOL EditConvertText(UINT cpSource, UINT cpDest, BOOL bSetSavePoint) {
 	SciCall_Cancel();
 	SciCall_SetUndoCollection(FALSE);
 	SciCall_EmptyUndoBuffer();
+	Compare_Clear();
+	MarkTerms_Clear();
 	SciCall_ClearAll();
 	SciCall_ClearMarker();
 	SciCall_SetCodePage(cpDest);
 
-	if (cbText > 0) {
+	if (length > 0) {
 		SendMessage(hwndEdit, WM_SETREDRAW, FALSE, 0);
 		SciCall_SetModEventMask(SC_MOD_NONE);
-		SciCall_AppendText(cbText, pchText);
-		SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
+#if defined(_WIN64)
+		Sci_Position cbText = 0;
+#endif
+		for (DWORD index = 0; index < worker.chunkCount; index++) {
+			TextConversionChunk *chunk = &worker.chunks[index];
+			while (!chunk->done) {
+				WaitForSingleObject(worker.eventDone, INFINITE);
+			}
+			if (chunk->lpOut != NULL) {
+#if defined(_WIN64)
+				cbText += chunk->cbOut;
+				if (cbText >= (Sci_Position)MAX_NON_UTF8_SIZE) {
+					EditConvertToLargeMode();
+				}
+#endif
+				SciCall_AppendText(chunk->cbOut, chunk->lpOut);
+				NP2HeapFree(chunk->lpOut);
+				chunk->lpOut = NULL;
+			}
+		}
+		SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_BULKMODIFICATION);
 		SendMessage(hwndEdit, WM_SETREDRAW, TRUE, 0);
 		RedrawWindow(hwndEdit, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
-	}
-	if (pchText != NULL) {
+
+		for (DWORD i = 0; i < threadCount; i++) {
+			WorkerPool_Wait(workerThreads[i]);
+			CloseHandle(workerThreads[i]);
+		}
+		if (worker.eventDone != NULL) {
+			CloseHandle(worker.eventDone);
+		}
+		NP2HeapFree(worker.chunks);
 		NP2HeapFree(pchText);
 	}
 
@@ -237,48 +460,13 @@ BOOL EditConvertText(UINT cpSource, UINT cpDest, BOOL bSetSavePoint) {
 
 #if defined(_WIN64)
 void EditConvertToLargeMode(void) {
-	int options = SciCall_GetDocumentOptions();
+	const int options = SciCall_GetDocumentOptions();
 	if (options & SC_DOCUMENTOPTION_TEXT_LARGE) {
 		return;
 	}
 
-	options |= SC_DOCUMENTOPTION_TEXT_LARGE;
-	const Sci_Position length = SciCall_GetLength();
-	HANDLE pdoc = SciCall_CreateDocument(length + 1, options);
-	char *pchText = NULL;
-	if (length > 0) {
-		pchText = (char *)NP2HeapAlloc(length + 1);
-		SciCall_GetText(NP2HeapSize(pchText), pchText);
-	}
-
-	bLockedForEditing = FALSE;
-	SciCall_SetReadOnly(FALSE);
-	SciCall_Cancel();
-	SciCall_SetUndoCollection(FALSE);
-	SciCall_EmptyUndoBuffer();
-	SciCall_ClearAll();
-	SciCall_ClearMarker();
-
-	EditReplaceDocument(pdoc);
-	FileVars_Apply(&fvCurFile);
-
-	if (length > 0) {
-		SendMessage(hwndEdit, WM_SETREDRAW, FALSE, 0);
-		SciCall_SetModEventMask(SC_MOD_NONE);
-		SciCall_AppendText(length, pchText);
-		SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
-		SendMessage(hwndEdit, WM_SETREDRAW, TRUE, 0);
-		RedrawWindow(hwndEdit, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
-	}
-	if (pchText != NULL) {
-		NP2HeapFree(pchText);
-	}
-
-	SciCall_SetUndoCollection(TRUE);
-	SciCall_EmptyUndoBuffer();
-	SciCall_SetSavePoint();
-
-	Style_SetLexer(pLexCurrent, TRUE);
+	// convert in place, text, styles, undo history and save point are kept
+	SciCall_ConvertToLargeDocument(SC_DOCUMENTOPTION_TEXT_LARGE | SC_DOCUMENTOPTION_STYLES_COMPRESSED | SC_DOCUMENTOPTION_LINES_COMPACT);
 	bLargeFileMode = TRUE;
 }
 #endif
@@ -454,353 +642,8 @@ BOOL EditCopyAppend(HWND hwnd) {
 
 //=============================================================================
 //
-// EditDetectEOLMode()
+// EditDetectIndentation()
 //
-void EditDetectEOLMode(LPCSTR lpData, DWORD cbData, EditFileIOStatus *status) {
-	/* '\r' and '\n' is not reused (e.g. as trailing byte in DBCS) by any known encoding,
-	it's safe to check whole data byte by byte.*/
-
-	size_t lineCountCRLF = 0;
-	size_t lineCountCR = 0;
-	size_t lineCountLF = 0;
-#if 0
-	StopWatch watch;
-	StopWatch_Start(watch);
-#endif
-
-	const uint8_t *ptr = (const uint8_t *)lpData;
-	// No NULL-terminated requirement for *ptr == '\n'
-#if NP2_USE_SSE2 || NP2_USE_AVX2
-	const uint8_t * const end = ptr + cbData;
-#else
-	const uint8_t * const end = ptr + cbData - 1;
-#endif
-
-#if NP2_USE_AVX2
-	const __m256i vectCR = _mm256_set1_epi8('\r');
-	const __m256i vectLF = _mm256_set1_epi8('\n');
-	while (ptr + 2*sizeof(__m256i) < end) {
-		// unaligned loading: line starts at random position.
-		const __m256i chunk1 = _mm256_loadu_si256((__m256i *)ptr);
-		const __m256i chunk2 = _mm256_loadu_si256((__m256i *)(ptr + sizeof(__m256i)));
-		ptr += 2*sizeof(__m256i);
-		uint64_t maskCR = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectCR));
-		uint64_t maskLF = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectLF));
-		maskLF |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m256i);
-		maskCR |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m256i);
-
-		if (maskCR) {
-			if (_addcarry_u64(0, maskCR, maskCR, &maskCR)) {
-				if (*ptr == '\n') {
-					// CR+LF across boundary
-					++ptr;
-					++lineCountCRLF;
-				} else {
-					++lineCountCR;
-				}
-			}
-
-			// maskCR and maskLF never have some bit set. after shifting maskCR by 1 bit,
-			// the bits both set in maskCR and maskLF represents CR+LF;
-			// the bits only set in maskCR or maskLF represents individual CR or LF.
-			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
-			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
-			maskLF = maskCR_LF & maskLF; // LF alone
-			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
-			if (maskCRLF) {
-				lineCountCRLF += np2_popcount64(maskCRLF);
-			}
-			if (maskCR) {
-				lineCountCR += np2_popcount64(maskCR);
-			}
-		}
-		if (maskLF) {
-			lineCountLF += np2_popcount64(maskLF);
-		}
-	}
-
-	if (ptr < end) {
-		NP2_alignas(32) uint8_t buffer[2*sizeof(__m256i)];
-		ZeroMemory_32x2(buffer);
-		__movsb(buffer, ptr, end - ptr);
-
-		const __m256i chunk1 = _mm256_load_si256((__m256i *)buffer);
-		const __m256i chunk2 = _mm256_load_si256((__m256i *)(buffer + sizeof(__m256i)));
-		uint64_t maskCR = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectCR));
-		uint64_t maskLF = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectLF));
-		maskLF |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m256i);
-		maskCR |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m256i);
-
-		if (maskCR) {
-			const uint8_t lastCR = _addcarry_u64(0, maskCR, maskCR, &maskCR);
-			_addcarry_u64(lastCR, lineCountCR, 0, &lineCountCR);
-			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
-			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
-			maskLF = maskCR_LF & maskLF; // LF alone
-			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
-			if (maskCRLF) {
-				lineCountCRLF += np2_popcount64(maskCRLF);
-			}
-			if (maskCR) {
-				lineCountCR += np2_popcount64(maskCR);
-			}
-		}
-		if (maskLF) {
-			lineCountLF += np2_popcount64(maskLF);
-		}
-	}
-	// end NP2_USE_AVX2
-#elif NP2_USE_SSE2
-#if defined(_WIN64)
-	const __m128i vectCR = _mm_set1_epi8('\r');
-	const __m128i vectLF = _mm_set1_epi8('\n');
-	while (ptr + 4*sizeof(__m128i) < end) {
-		// unaligned loading: line starts at random position.
-		const __m128i chunk1 = _mm_loadu_si128((__m128i *)ptr);
-		const __m128i chunk2 = _mm_loadu_si128((__m128i *)(ptr + sizeof(__m128i)));
-		const __m128i chunk3 = _mm_loadu_si128((__m128i *)(ptr + 2*sizeof(__m128i)));
-		const __m128i chunk4 = _mm_loadu_si128((__m128i *)(ptr + 3*sizeof(__m128i)));
-		ptr += 4*sizeof(__m128i);
-		uint64_t maskCR = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
-		uint64_t maskLF = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
-		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
-		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
-		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectCR))) << 2*sizeof(__m128i);
-		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectLF))) << 2*sizeof(__m128i);
-		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectLF))) << 3*sizeof(__m128i);
-		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectCR))) << 3*sizeof(__m128i);
-
-		if (maskCR) {
-			if (_addcarry_u64(0, maskCR, maskCR, &maskCR)) {
-				if (*ptr == '\n') {
-					// CR+LF across boundary
-					++ptr;
-					++lineCountCRLF;
-				} else {
-					++lineCountCR;
-				}
-			}
-
-			// maskCR and maskLF never have some bit set. after shifting maskCR by 1 bit,
-			// the bits both set in maskCR and maskLF represents CR+LF;
-			// the bits only set in maskCR or maskLF represents individual CR or LF.
-			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
-			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
-			maskLF = maskCR_LF & maskLF; // LF alone
-			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
-			if (maskCRLF) {
-				lineCountCRLF += np2_popcount64(maskCRLF);
-			}
-			if (maskCR) {
-				lineCountCR += np2_popcount64(maskCR);
-			}
-		}
-		if (maskLF) {
-			lineCountLF += np2_popcount64(maskLF);
-		}
-	}
-
-	if (ptr < end) {
-		NP2_alignas(16) uint8_t buffer[4*sizeof(__m128i)];
-		ZeroMemory_16x4(buffer);
-		__movsb(buffer, ptr, end - ptr);
-
-		const __m128i chunk1 = _mm_load_si128((__m128i *)buffer);
-		const __m128i chunk2 = _mm_load_si128((__m128i *)(buffer + sizeof(__m128i)));
-		const __m128i chunk3 = _mm_load_si128((__m128i *)(buffer + 2*sizeof(__m128i)));
-		const __m128i chunk4 = _mm_load_si128((__m128i *)(buffer + 3*sizeof(__m128i)));
-		uint64_t maskCR = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
-		uint64_t maskLF = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
-		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
-		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
-		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectCR))) << 2*sizeof(__m128i);
-		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectLF))) << 2*sizeof(__m128i);
-		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectLF))) << 3*sizeof(__m128i);
-		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectCR))) << 3*sizeof(__m128i);
-
-		if (maskCR) {
-			const uint8_t lastCR = _addcarry_u64(0, maskCR, maskCR, &maskCR);
-			_addcarry_u64(lastCR, lineCountCR, 0, &lineCountCR);
-			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
-			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
-			maskLF = maskCR_LF & maskLF; // LF alone
-			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
-			if (maskCRLF) {
-				lineCountCRLF += np2_popcount64(maskCRLF);
-			}
-			if (maskCR) {
-				lineCountCR += np2_popcount64(maskCR);
-			}
-		}
-		if (maskLF) {
-			lineCountLF += np2_popcount64(maskLF);
-		}
-	}
-	// end _WIN64 NP2_USE_SSE2
-#else
-	const __m128i vectCR = _mm_set1_epi8('\r');
-	const __m128i vectLF = _mm_set1_epi8('\n');
-	while (ptr + 2*sizeof(__m128i) < end) {
-		// unaligned loading: line starts at random position.
-		const __m128i chunk1 = _mm_loadu_si128((__m128i *)ptr);
-		const __m128i chunk2 = _mm_loadu_si128((__m128i *)(ptr + sizeof(__m128i)));
-		ptr += 2*sizeof(__m128i);
-		uint32_t maskCR = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
-		uint32_t maskLF = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
-		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
-		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
-
-		if (maskCR) {
-			if (_addcarry_u32(0, maskCR, maskCR, &maskCR)) {
-				if (*ptr == '\n') {
-					// CR+LF across boundary
-					++ptr;
-					++lineCountCRLF;
-				} else {
-					++lineCountCR;
-				}
-			}
-
-			// maskCR and maskLF never have some bit set. after shifting maskCR by 1 bit,
-			// the bits both set in maskCR and maskLF represents CR+LF;
-			// the bits only set in maskCR or maskLF represents individual CR or LF.
-			const uint32_t maskCRLF = maskCR & maskLF; // CR+LF
-			const uint32_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
-			maskLF = maskCR_LF & maskLF; // LF alone
-			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
-			if (maskCRLF) {
-				lineCountCRLF += np2_popcount(maskCRLF);
-			}
-			if (maskCR) {
-				lineCountCR += np2_popcount(maskCR);
-			}
-		}
-		if (maskLF) {
-			lineCountLF += np2_popcount(maskLF);
-		}
-	}
-
-	if (ptr < end) {
-		NP2_alignas(16) uint8_t buffer[2*sizeof(__m128i)];
-		ZeroMemory_16x2(buffer);
-		__movsb(buffer, ptr, end - ptr);
-
-		const __m128i chunk1 = _mm_load_si128((__m128i *)buffer);
-		const __m128i chunk2 = _mm_load_si128((__m128i *)(buffer + sizeof(__m128i)));
-		uint32_t maskCR = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
-		uint32_t maskLF = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
-		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
-		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
-
-		if (maskCR) {
-			const uint8_t lastCR = _addcarry_u32(0, maskCR, maskCR, &maskCR);
-			_addcarry_u32(lastCR, lineCountCR, 0, &lineCountCR);
-			const uint32_t maskCRLF = maskCR & maskLF; // CR+LF
-			const uint32_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
-			maskLF = maskCR_LF & maskLF; // LF alone
-			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
-			if (maskCRLF) {
-				lineCountCRLF += np2_popcount(maskCRLF);
-			}
-			if (maskCR) {
-				lineCountCR += np2_popcount(maskCR);
-			}
-		}
-		if (maskLF) {
-			lineCountLF += np2_popcount(maskLF);
-		}
-	}
-#endif
-	// end NP2_USE_SSE2
-#else
-
-#if defined(__clang__) || defined(__GNUC__) || defined(__ICL) || !defined(_MSC_VER)
-	while (ptr < end) {
-		const uint8_t ch = *ptr++;
-		const uint32_t mask = ((1 << '\r') - 1) ^ (1 << '\n');
-		if (ch > '\r' || ((mask >> ch) & 1) != 0) {
-			continue;
-		}
-		if (ch == '\n') {
-			++lineCountLF;
-		} else {
-			if (*ptr == '\n') {
-				++ptr;
-				++lineCountCRLF;
-			} else {
-				++lineCountCR;
-			}
-		}
-	}
-#else
-	do {
-		// skip to line end
-		uint8_t ch = 0;
-#if 1
-		const uint32_t mask = ((1 << '\r') - 1) ^ (1 << '\n');
-		while (ptr < end && ((ch = *ptr++) > '\r' || ((mask >> ch) & 1) != 0)) {
-			// nop
-		}
-#else
-		while (ptr < end && ((ch = *ptr++) > '\r' || ch < '\n')) {
-			// nop
-		}
-#endif
-		switch (ch) {
-		case '\n':
-			++lineCountLF;
-			break;
-		case '\r':
-			if (*ptr == '\n') {
-				++ptr;
-				++lineCountCRLF;
-			} else {
-				++lineCountCR;
-			}
-			break;
-		}
-	} while (ptr < end);
-#endif
-	if (ptr == end) {
-		switch (*ptr) {
-		case '\n':
-			++lineCountLF;
-			break;
-		case '\r':
-			++lineCountCR;
-			break;
-		}
-	}
-#endif
-
-	const size_t linesMax = max_z(max_z(lineCountCRLF, lineCountCR), lineCountLF);
-	// values must kept in same order as SC_EOL_CRLF, SC_EOL_CR, SC_EOL_LF
-	const size_t linesCount[3] = { lineCountCRLF, lineCountCR, lineCountLF };
-	int iEOLMode = status->iEOLMode;
-	if (linesMax != linesCount[iEOLMode]) {
-		if (linesMax == lineCountCRLF) {
-			iEOLMode = SC_EOL_CRLF;
-		} else if (linesMax == lineCountLF) {
-			iEOLMode = SC_EOL_LF;
-		} else {
-			iEOLMode = SC_EOL_CR;
-		}
-	}
-
-#if 0
-	StopWatch_Stop(watch);
-	StopWatch_ShowLog(&watch, "EOL time");
-	printf("%s CR+LF:%u, LF: %u, CR: %u\n", __func__, (UINT)lineCountCRLF, (UINT)lineCountLF, (UINT)lineCountCR);
-#endif
-
-	status->iEOLMode = iEOLMode;
-	status->bInconsistent = ((!!lineCountCRLF) + (!!lineCountCR) + (!!lineCountLF)) > 1;
-	status->totalLineCount = lineCountCRLF + lineCountCR + lineCountLF + 1;
-	status->linesCount[0] = lineCountCRLF;
-	status->linesCount[1] = lineCountLF;
-	status->linesCount[2] = lineCountCR;
-}
-
 void EditDetectIndentation(LPCSTR lpData, DWORD cbData, LPFILEVARS lpfv) {
 	if ((lpfv->mask & FV_MaskHasFileTabSettings) == FV_MaskHasFileTabSettings) {
 		return;
@@ -1048,6 +891,14 @@ int EditDetermineEncoding(LPCWSTR pszFile, char *lpData, DWORD cbData, BOOL bSki
 		return iEncoding;
 	}
 
+	// legacy DBCS file from other locale
+	if (iSrcEncoding == -1 && !bSkipEncodingDetection && !(fvCurFile.mask & FV_ENCODING) && cbData < MAX_NON_UTF8_SIZE) {
+		const int iDetected = DetectDBCSEncoding(lpData, cbData);
+		if (iDetected != CPI_NONE) {
+			return iDetected;
+		}
+	}
+
 	if (cbData < MAX_NON_UTF8_SIZE && iEncoding != CPI_DEFAULT) {
 		const UINT uFlags = mEncoding[iEncoding].uFlags;
 		if ((uFlags & NCP_8BIT) || ((uFlags & NCP_7BIT) && IsUTF7(lpData, cbData))) {
@@ -1059,36 +910,648 @@ int EditDetermineEncoding(LPCWSTR pszFile, char *lpData, DWORD cbData, BOOL bSki
 	return CPI_DEFAULT;
 }
 
-//=============================================================================
-//
-// EditLoadFile()
-//
-BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus *status) {
-	HANDLE hFile = CreateFile(pszFile,
-					   GENERIC_READ,
-					   FILE_SHARE_READ | FILE_SHARE_WRITE,
-					   NULL, OPEN_EXISTING,
-					   FILE_ATTRIBUTE_NORMAL,
-					   NULL);
-	dwLastIOError = GetLastError();
+// the view is page aligned and the remaining bytes in last page are zero,
+// SIMD routines (e.g. IsUTF7()) may access up to 64 bytes after the data.
+#define NP2_MAPPED_FILE_PADDING		64
 
-	if (hFile == INVALID_HANDLE_VALUE) {
-		iSrcEncoding = -1;
-		iWeakSrcEncoding = -1;
+static BOOL EditShouldMapFile(LPCWSTR pszFile, LONGLONG fileSize) {
+	if (dwFileMappingMinSize == 0 || fileSize < ((LONGLONG)dwFileMappingMinSize << 20)
+		|| fileSize > (LONGLONG)(MAXDWORD - NP2_MAPPED_FILE_PADDING)) {
 		return FALSE;
 	}
-
-	LARGE_INTEGER fileSize;
-	fileSize.QuadPart = 0;
-	if (!GetFileSizeEx(hFile, &fileSize)) {
-		dwLastIOError = GetLastError();
-		CloseHandle(hFile);
-		iSrcEncoding = -1;
-		iWeakSrcEncoding = -1;
+	// access to view of a file on disconnected network share raises EXCEPTION_IN_PAGE_ERROR.
+	if (PathIsNetworkPath(pszFile)) {
 		return FALSE;
 	}
 
-	// display real path name
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const DWORD remain = (DWORD)(fileSize & (info.dwPageSize - 1));
+	return remain != 0 && remain <= info.dwPageSize - NP2_MAPPED_FILE_PADDING;
+}
+
+static inline void EditFreeFileBuffer(char *lpData, BOOL bMapped) {
+	if (bMapped) {
+		UnmapViewOfFile(lpData);
+	} else {
+		NP2HeapFree(lpData);
+	}
+}
+
+// read file on a worker thread to keep the window responsive (e.g. slow network share),
+// the load can be cancelled with Esc.
+#define NP2_BACKGROUND_READ_CHUNK_SIZE	(4*1024*1024)
+
+typedef struct FileReadWorker {
+	BackgroundWorker worker;
+	HANDLE hFile;
+	Decompressor *decompressor;	// NULL for uncompressed file
+	char *lpData;
+	DWORD cbToRead;
+	DWORD cbMaxData;	// buffer for decompressed data grows up to this size
+	DWORD cbData;
+	BOOL bSuccess;
+	DWORD dwError;
+	HANDLE workerThread;
+	BOOL bCancelled;
+} FileReadWorker;
+
+// decompressed size is only an estimate, grow the buffer when it's full.
+static BOOL FileReadWorker_Grow(FileReadWorker *reader) {
+	if (reader->cbToRead >= reader->cbMaxData) {
+		SetLastError(ERROR_FILE_TOO_LARGE);
+		return FALSE;
+	}
+	const ULONGLONG cbGrow = (ULONGLONG)reader->cbToRead*2 + NP2_BACKGROUND_READ_CHUNK_SIZE;
+	const DWORD cbToRead = (cbGrow < reader->cbMaxData) ? (DWORD)cbGrow : reader->cbMaxData;
+	char *lpData = (char *)NP2HeapReAlloc(reader->lpData, cbToRead + 16);
+	if (lpData == NULL) {
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+		return FALSE;
+	}
+	reader->lpData = lpData;
+	reader->cbToRead = cbToRead;
+	return TRUE;
+}
+
+static DWORD WINAPI FileReadThread(LPVOID lpParam) {
+	FileReadWorker *reader = (FileReadWorker *)lpParam;
+	BackgroundWorker *worker = &reader->worker;
+
+	BOOL bSuccess = TRUE;
+	DWORD cbData = 0;
+	while (BackgroundWorker_Continue(worker)) {
+		if (cbData == reader->cbToRead && (reader->decompressor == NULL || !(bSuccess = FileReadWorker_Grow(reader)))) {
+			break;
+		}
+		const DWORD cbChunk = min_u(reader->cbToRead - cbData, NP2_BACKGROUND_READ_CHUNK_SIZE);
+		DWORD cbRead = 0;
+		if (reader->decompressor != NULL) {
+			bSuccess = Decompressor_Read(reader->decompressor, reader->lpData + cbData, cbChunk, &cbRead);
+		} else {
+			bSuccess = ReadFile(reader->hFile, reader->lpData + cbData, cbChunk, &cbRead, NULL);
+		}
+		cbData += cbRead;
+		if (!bSuccess || cbRead == 0) {
+			break;
+		}
+	}
+
+	reader->bSuccess = bSuccess;
+	reader->dwError = GetLastError();
+	reader->cbData = cbData;
+	return 0;
+}
+
+static void FileReadWorker_Cancel(LPVOID lpParam) {
+	FileReadWorker *reader = (FileReadWorker *)lpParam;
+	if (!reader->bCancelled) {
+		reader->bCancelled = TRUE;
+		SetEvent(reader->worker.eventCancel);
+		// abort pending ReadFile() on the worker thread, since Windows Vista
+#if _WIN32_WINNT >= _WIN32_WINNT_VISTA
+		CancelSynchronousIo(reader->workerThread);
+#else
+		typedef BOOL (WINAPI *CancelSynchronousIoSig)(HANDLE hThread);
+		CancelSynchronousIoSig pfnCancelSynchronousIo =
+			DLLFunctionEx(CancelSynchronousIoSig, L"kernel32.dll", "CancelSynchronousIo");
+		if (pfnCancelSynchronousIo) {
+			pfnCancelSynchronousIo(reader->workerThread);
+		}
+#endif
+	}
+}
+
+// compressed file is decompressed on the worker thread, buffer may be reallocated.
+static BOOL EditReadFileInBackground(HANDLE hFile, Decompressor *decompressor, char **plpData, DWORD cbToRead, DWORD cbMaxData, DWORD *pcbData, BOOL *pbCancelled) {
+	FileReadWorker reader;
+	ZeroMemory(&reader, sizeof(reader));
+	BackgroundWorker_Init(&reader.worker, hwndMain);
+	reader.hFile = hFile;
+	reader.decompressor = decompressor;
+	reader.lpData = *plpData;
+	reader.cbToRead = cbToRead;
+	reader.cbMaxData = cbMaxData;
+
+	HANDLE workerThread = CreateThread(NULL, 0, FileReadThread, &reader, 0, NULL);
+	if (workerThread == NULL) {
+		FileReadThread(&reader);
+	} else {
+		reader.workerThread = workerThread;
+		WaitForObjectDispatchPaint(workerThread, FileReadWorker_Cancel, &reader);
+		CloseHandle(workerThread);
+	}
+	BackgroundWorker_Destroy(&reader.worker);
+
+	const BOOL bCancelled = reader.bCancelled;
+	*plpData = reader.lpData;
+	*pcbData = reader.cbData;
+	*pbCancelled = bCancelled;
+	if (bCancelled) {
+		dwLastIOError = ERROR_CANCELLED;
+		return FALSE;
+	}
+	dwLastIOError = reader.dwError;
+	return reader.bSuccess;
+}
+
+// files larger than MAX_NON_UTF8_SIZE are loaded as UTF-8 or ANSI without encoding conversion,
+// read them in chunks and display the first chunk before remaining chunks are loaded.
+#define NP2_STREAMING_LOAD_CHUNK_SIZE	(64*1024*1024)
+// text is saved in chunks of this size when encoding conversion is required.
+#define NP2_STREAMING_SAVE_CHUNK_SIZE	(4*1024*1024)
+
+// bytes kept for next chunk: trailing CR for CR+LF across chunks, or incomplete UTF-8 sequence.
+static DWORD EditGetChunkTailLength(const uint8_t *ptr, DWORD cbData) {
+	if (ptr[cbData - 1] == '\r') {
+		return 1;
+	}
+
+	DWORD tail = 0;
+	while (tail < 3 && tail < cbData && (ptr[cbData - 1 - tail] & 0xC0) == 0x80) {
+		++tail;
+	}
+	if (tail < cbData) {
+		const uint8_t lead = ptr[cbData - 1 - tail];
+		if (lead >= 0xC0) {
+			const DWORD count = (lead >= 0xF0) ? 4 : ((lead >= 0xE0) ? 3 : 2);
+			if (tail + 1 < count) {
+				return tail + 1;
+			}
+		}
+	}
+	return 0;
+}
+
+// bytes of the loaded file, text appended to the file is loaded when bytes before size are unchanged.
+#define EDIT_FILE_TAIL_CHECK_SIZE	4096
+// larger appended text is loaded by reloading the whole file.
+#define EDIT_FILE_TAIL_MAX_APPEND	(64*1024*1024)
+
+typedef struct EditFileTail {
+	LONGLONG size;	// 0 when unknown
+	UINT hash;		// FNV-1a of last EDIT_FILE_TAIL_CHECK_SIZE bytes before size
+} EditFileTail;
+
+static EditFileTail fileTail;
+
+static UINT EditFileTail_Hash(const char *ptr, DWORD length) {
+	UINT hash = 2166136261U;
+	const char * const end = ptr + length;
+	while (ptr < end) {
+		hash = (hash ^ (uint8_t)(*ptr++)) * 16777619U;
+	}
+	return hash;
+}
+
+// data is the loaded file content ending at size.
+static void EditFileTail_Update(const char *lpData, DWORD cbData, LONGLONG size) {
+	const DWORD length = min_u(cbData, EDIT_FILE_TAIL_CHECK_SIZE);
+	fileTail.size = size;
+	fileTail.hash = EditFileTail_Hash(lpData + cbData - length, length);
+}
+
+// file pointer is moved to size on success.
+static BOOL EditFileTail_ReadHash(HANDLE hFile, LONGLONG size, UINT *hash) {
+	char buffer[EDIT_FILE_TAIL_CHECK_SIZE];
+	const DWORD length = (size < EDIT_FILE_TAIL_CHECK_SIZE) ? (DWORD)size : EDIT_FILE_TAIL_CHECK_SIZE;
+	LARGE_INTEGER offset;
+	offset.QuadPart = size - length;
+	DWORD cbRead = 0;
+	if (!SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN) || !ReadFile(hFile, buffer, length, &cbRead, NULL) || cbRead != length) {
+		return FALSE;
+	}
+	*hash = EditFileTail_Hash(buffer, length);
+	return TRUE;
+}
+
+#if defined(_WIN64)
+// compressed file is decompressed on a worker thread while previous chunk is added to the document,
+// contentSize is the estimated size after decompression.
+static BOOL EditLoadFileStreaming(HANDLE hFile, LPCWSTR pszFile, LONGLONG fileSize, LONGLONG contentSize, int compression, EditFileIOStatus *status) {
+	DecompressPipeline *pipeline = NULL;
+	if (compression != CompressionFormat_None) {
+		pipeline = DecompressPipeline_Create(hFile, compression);
+		if (pipeline == NULL) {
+			dwLastIOError = GetLastError();
+			iSrcEncoding = -1;
+			iWeakSrcEncoding = -1;
+			return FALSE;
+		}
+	}
+
+	char *lpData = (char *)NP2HeapAlloc(NP2_STREAMING_LOAD_CHUNK_SIZE + 16);
+	status->iEOLMode = GetScintillaEOLMode(iDefaultEOLMode);
+	status->bInconsistent = FALSE;
+	status->totalLineCount = 1;
+
+	WCHAR tchStatus[MAX_PATH + 128];
+	WCHAR fmt[128];
+	FormatString(tchStatus, fmt, IDS_LOADFILE, pszFile);
+	LPWSTR const pszPercent = StrEnd(tchStatus);
+
+	BOOL bSuccess = TRUE;
+	BOOL bFirst = TRUE;
+	BOOL bCheckUTF8 = FALSE;
+	BOOL bUTF8 = FALSE;
+	BOOL bBOM = FALSE;
+	DWORD cbTail = 0;
+	LONGLONG cbTotal = 0;
+	size_t linesCount[3] = { 0, 0, 0 };
+
+	while (TRUE) {
+		DWORD cbRead = 0;
+		const BOOL bRead = (pipeline != NULL)
+			? DecompressPipeline_Read(pipeline, lpData + cbTail, NP2_STREAMING_LOAD_CHUNK_SIZE - cbTail, &cbRead)
+			: ReadFile(hFile, lpData + cbTail, NP2_STREAMING_LOAD_CHUNK_SIZE - cbTail, &cbRead, NULL);
+		if (!bRead) {
+			dwLastIOError = GetLastError();
+			bSuccess = FALSE;
+			break;
+		}
+
+		cbTotal += cbRead;
+		DWORD cbData = cbTail + cbRead;
+		cbTail = (cbRead == 0 || cbData == 0) ? 0 : EditGetChunkTailLength((const uint8_t *)lpData, cbData);
+		cbData -= cbTail;
+		char *lpChunk = lpData;
+
+		const BOOL bFirstChunk = bFirst;
+		if (bFirst) {
+			bFirst = FALSE;
+			bBOM = IsUTF8Signature(lpData);
+			if (iSrcEncoding == -1) {
+				bUTF8 = TRUE;
+				bCheckUTF8 = !(bBOM || bLoadANSIasUTF8);
+			} else {
+				bUTF8 = iSrcEncoding == CPI_UTF8 || iSrcEncoding == CPI_UTF8SIGN;
+			}
+			if (bBOM && bUTF8) {
+				lpChunk += 3;
+				cbData -= 3;
+			}
+		}
+		if (bCheckUTF8 && bUTF8) {
+			bUTF8 = IsUTF8(lpChunk, cbData);
+		}
+
+		if (cbData != 0) {
+			EditFileIOStatus chunkStatus;
+			chunkStatus.iEOLMode = status->iEOLMode;
+			EditDetectEOLMode(lpChunk, cbData, &chunkStatus);
+			linesCount[0] += chunkStatus.linesCount[0];
+			linesCount[1] += chunkStatus.linesCount[1];
+			linesCount[2] += chunkStatus.linesCount[2];
+		}
+
+		if (bFirstChunk) {
+			// first chunk, create large document with enough space for the whole file.
+			FileVars_Init(lpChunk, cbData, &fvCurFile);
+			EditDetectIndentation(lpChunk, cbData, &fvCurFile);
+			const int mask = EditLargeDocumentOptions(contentSize);
+			HANDLE pdoc = SciCall_CreateDocument((Sci_Position)contentSize + 1, SciCall_GetDocumentOptions() | mask);
+			EditReplaceDocument(pdoc);
+			bLargeFileMode = TRUE;
+			SciCall_SetStyleWindow(STREAMING_LOAD_STYLE_WINDOW);
+			SciCall_SetCodePage(bUTF8 ? SC_CP_UTF8 : iDefaultCodePage);
+			const size_t lineCount = linesCount[0] + linesCount[1] + linesCount[2] + 1;
+			EditSetNewText(lpChunk, cbData, (Sci_Line)lineCount);
+			UpdateWindow(hwndEdit);
+			SciCall_SetUndoCollection(FALSE);
+		} else if (cbData != 0) {
+			SciCall_SetModEventMask(SC_MOD_NONE);
+			SciCall_AppendText(cbData, lpChunk);
+			SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_BULKMODIFICATION);
+		}
+
+		if (cbRead == 0) {
+			break;
+		}
+		if (cbTail != 0) {
+			memmove(lpData, lpChunk + cbData, cbTail);
+		}
+
+		const LONGLONG position = (pipeline != NULL) ? DecompressPipeline_GetInputPosition(pipeline) : cbTotal;
+		wsprintf(pszPercent, L" %d%%", (int)(position * 100 / fileSize));
+		StatusSetText(hwndStatus, STATUS_HELP, tchStatus);
+		UpdateWindow(hwndStatus);
+	}
+
+	NP2HeapFree(lpData);
+	if (pipeline != NULL) {
+		DecompressPipeline_Destroy(pipeline);
+	}
+	iSrcEncoding = -1;
+	iWeakSrcEncoding = -1;
+	if (!bSuccess) {
+		EditSetEmptyText();
+		return FALSE;
+	}
+
+	SciCall_SetUndoCollection(TRUE);
+	SciCall_EmptyUndoBuffer();
+	SciCall_SetSavePoint();
+	// appended text can't be loaded from compressed file
+	if (compression == CompressionFormat_None && EditFileTail_ReadHash(hFile, cbTotal, &fileTail.hash)) {
+		fileTail.size = cbTotal;
+	}
+	if (!bUTF8) {
+		// invalid UTF-8 found in later chunks.
+		SciCall_SetCodePage(iDefaultCodePage);
+	}
+
+	status->iEncoding = bUTF8 ? (bBOM ? CPI_UTF8SIGN : CPI_UTF8) : CPI_DEFAULT;
+	EditSetEOLModeFromLineCount(status, linesCount[0], linesCount[1], linesCount[2]);
+	return TRUE;
+}
+#endif
+
+//=============================================================================
+//
+// EditReloadText()
+//
+// reloaded text is applied as difference of lines: common prefix and suffix are skipped, remaining
+// lines are compared with Myers' O(ND) algorithm, then changed hunks are replaced as one undo action,
+// so undo history, markers and fold state of unchanged lines are kept, only changed lines are styled.
+#define EDIT_RELOAD_DIFF_MAX_EDIT	1024
+// limit comparison count for the middle part, which is about (N + M)*D.
+#define EDIT_RELOAD_DIFF_MAX_COST	(64*1024*1024)
+
+typedef struct DiffLines {
+	const char *text;
+	Sci_Position *starts;	// count + 1 line starts
+	UINT *hashes;
+	Sci_Line count;
+} DiffLines;
+
+// line is ended by LF, or CR not followed by LF.
+static inline BOOL DiffIsLineEnd(const char *text, Sci_Position pos, Sci_Position end) {
+	return text[pos] == '\n' || (text[pos] == '\r' && (pos + 1 == end || text[pos + 1] != '\n'));
+}
+
+static BOOL DiffLines_Init(DiffLines *lines, const char *text, Sci_Position start, Sci_Position end) {
+	Sci_Line count = 0;
+	for (Sci_Position pos = start; pos < end; pos++) {
+		count += DiffIsLineEnd(text, pos, end);
+	}
+	if (end != start && !DiffIsLineEnd(text, end - 1, end)) {
+		++count;
+	}
+
+	lines->text = text;
+	lines->count = count;
+	lines->starts = (Sci_Position *)NP2HeapAlloc((count + 1) * sizeof(Sci_Position));
+	lines->hashes = (UINT *)NP2HeapAlloc((count + 1) * sizeof(UINT));
+	if (lines->starts == NULL || lines->hashes == NULL) {
+		return FALSE;
+	}
+
+	Sci_Line line = 0;
+	UINT hash = 2166136261U;
+	lines->starts[0] = start;
+	for (Sci_Position pos = start; pos < end; pos++) {
+		// FNV-1a
+		hash = (hash ^ (uint8_t)text[pos]) * 16777619U;
+		if (DiffIsLineEnd(text, pos, end) || pos + 1 == end) {
+			lines->hashes[line++] = hash;
+			lines->starts[line] = pos + 1;
+			hash = 2166136261U;
+		}
+	}
+	return TRUE;
+}
+
+static void DiffLines_Free(DiffLines *lines) {
+	if (lines->starts != NULL) {
+		NP2HeapFree(lines->starts);
+	}
+	if (lines->hashes != NULL) {
+		NP2HeapFree(lines->hashes);
+	}
+}
+
+static inline BOOL DiffLines_Equal(const DiffLines *a, Sci_Line i, const DiffLines *b, Sci_Line j) {
+	const Sci_Position length = a->starts[i + 1] - a->starts[i];
+	return a->hashes[i] == b->hashes[j] && length == b->starts[j + 1] - b->starts[j]
+		&& memcmp(a->text + a->starts[i], b->text + b->starts[j], length) == 0;
+}
+
+// mark deleted lines in a and inserted lines in b, returns FALSE when more than maxEdit lines changed.
+static BOOL DiffLines_Compare(const DiffLines *a, const DiffLines *b, Sci_Line maxEdit, BYTE *deleted, BYTE *inserted) {
+	const Sci_Line N = a->count;
+	const Sci_Line M = b->count;
+	// furthest x on diagonal k = x - y, trace of step d is saved at d*d for k in [-d, d].
+	Sci_Line *V = (Sci_Line *)NP2HeapAlloc((maxEdit*2 + 3) * sizeof(Sci_Line));
+	Sci_Line *trace = (Sci_Line *)NP2HeapAlloc((maxEdit + 1) * (maxEdit + 1) * sizeof(Sci_Line));
+	if (V == NULL || trace == NULL) {
+		if (V != NULL) {
+			NP2HeapFree(V);
+		}
+		if (trace != NULL) {
+			NP2HeapFree(trace);
+		}
+		return FALSE;
+	}
+
+	const Sci_Line offset = maxEdit + 1;
+	Sci_Line editCount = -1;
+	V[offset + 1] = 0;
+	for (Sci_Line d = 0; d <= maxEdit && editCount < 0; d++) {
+		for (Sci_Line k = -d; k <= d; k += 2) {
+			Sci_Line x;
+			if (k == -d || (k != d && V[offset + k - 1] < V[offset + k + 1])) {
+				x = V[offset + k + 1];
+			} else {
+				x = V[offset + k - 1] + 1;
+			}
+			Sci_Line y = x - k;
+			while (x < N && y < M && DiffLines_Equal(a, x, b, y)) {
+				++x;
+				++y;
+			}
+			V[offset + k] = x;
+			if (x >= N && y >= M) {
+				editCount = d;
+			}
+		}
+		memcpy(trace + d*d, V + offset - d, (d*2 + 1) * sizeof(Sci_Line));
+	}
+
+	if (editCount >= 0) {
+		Sci_Line x = N;
+		Sci_Line y = M;
+		for (Sci_Line d = editCount; d > 0; d--) {
+			const Sci_Line *prev = trace + (d - 1)*(d - 1) + (d - 1);
+			const Sci_Line k = x - y;
+			Sci_Line prevK;
+			if (k == -d || (k != d && prev[k - 1] < prev[k + 1])) {
+				prevK = k + 1;
+			} else {
+				prevK = k - 1;
+			}
+			const Sci_Line prevX = prev[prevK];
+			const Sci_Line prevY = prevX - prevK;
+			if (prevK == k + 1) {
+				inserted[prevY] = TRUE;
+			} else {
+				deleted[prevX] = TRUE;
+			}
+			x = prevX;
+			y = prevY;
+		}
+	}
+
+	NP2HeapFree(V);
+	NP2HeapFree(trace);
+	return editCount >= 0;
+}
+
+static BOOL EditReloadText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
+#if defined(_WIN64)
+	if (!bLargeFileMode && cbText + lineCount >= MAX_NON_UTF8_SIZE) {
+		return FALSE;
+	}
+#else
+	UNREFERENCED_PARAMETER(lineCount);
+#endif
+	const Sci_Position cbDoc = SciCall_GetLength();
+	const char *pszDoc = SciCall_GetRangePointer(0, cbDoc);
+	if (pszDoc == NULL && cbDoc != 0) {
+		return FALSE;
+	}
+
+	// common prefix and suffix, both end at beginning of a line in both texts
+	const Sci_Position cbMin = min_pos(cbDoc, cbText);
+	Sci_Position prefix = 0;
+	while (prefix < cbMin && pszDoc[prefix] == lpstrText[prefix]) {
+		++prefix;
+	}
+	while (prefix != 0 && !(DiffIsLineEnd(pszDoc, prefix - 1, cbDoc) && DiffIsLineEnd(lpstrText, prefix - 1, cbText))) {
+		--prefix;
+	}
+	Sci_Position suffix = 0;
+	while (suffix < cbMin - prefix && pszDoc[cbDoc - 1 - suffix] == lpstrText[cbText - 1 - suffix]) {
+		++suffix;
+	}
+	Sci_Position docEnd = cbDoc - suffix;
+	Sci_Position textEnd = cbText - suffix;
+	if (!((docEnd == prefix || DiffIsLineEnd(pszDoc, docEnd - 1, cbDoc)) && (textEnd == prefix || DiffIsLineEnd(lpstrText, textEnd - 1, cbText)))) {
+		// line ends inside the suffix are same for both texts
+		while (docEnd < cbDoc && !DiffIsLineEnd(pszDoc, docEnd, cbDoc)) {
+			++docEnd;
+		}
+		docEnd = min_pos(docEnd + 1, cbDoc);
+		textEnd = cbText - (cbDoc - docEnd);
+	}
+
+	struct Sci_TextReplacement *ranges = NULL;
+	Sci_Position rangeCount = 0;
+	if (docEnd != prefix || textEnd != prefix) {
+		DiffLines a;
+		DiffLines b;
+		ZeroMemory(&a, sizeof(a));
+		ZeroMemory(&b, sizeof(b));
+		BOOL bDiff = DiffLines_Init(&a, pszDoc, prefix, docEnd) && DiffLines_Init(&b, lpstrText, prefix, textEnd);
+		BYTE *deleted = NULL;
+		BYTE *inserted = NULL;
+		if (bDiff) {
+			const Sci_Line total = a.count + b.count;
+			const Sci_Line maxEdit = min_pos(total, min_pos(EDIT_RELOAD_DIFF_MAX_EDIT, EDIT_RELOAD_DIFF_MAX_COST/total));
+			deleted = (BYTE *)NP2HeapAlloc(a.count + 1);
+			inserted = (BYTE *)NP2HeapAlloc(b.count + 1);
+			bDiff = deleted != NULL && inserted != NULL && DiffLines_Compare(&a, &b, maxEdit, deleted, inserted);
+		}
+		if (bDiff) {
+			ranges = (struct Sci_TextReplacement *)NP2HeapAlloc((min_pos(a.count, b.count) + 1) * sizeof(struct Sci_TextReplacement));
+			Sci_Line i = 0;
+			Sci_Line j = 0;
+			while (ranges != NULL && (i < a.count || j < b.count)) {
+				if (i < a.count && j < b.count && !deleted[i] && !inserted[j]) {
+					++i;
+					++j;
+					continue;
+				}
+				const Sci_Line i0 = i;
+				const Sci_Line j0 = j;
+				while (i < a.count && deleted[i]) {
+					++i;
+				}
+				while (j < b.count && inserted[j]) {
+					++j;
+				}
+				struct Sci_TextReplacement *range = &ranges[rangeCount++];
+				range->position = a.starts[i0];
+				range->deleteLength = a.starts[i] - a.starts[i0];
+				range->insertLength = b.starts[j] - b.starts[j0];
+				range->text = lpstrText + b.starts[j0];
+			}
+		}
+		if (ranges == NULL) {
+			// too many changes, replace the middle part
+			ranges = (struct Sci_TextReplacement *)NP2HeapAlloc(sizeof(struct Sci_TextReplacement));
+			rangeCount = 1;
+			ranges->position = prefix;
+			ranges->deleteLength = docEnd - prefix;
+			ranges->insertLength = textEnd - prefix;
+			ranges->text = lpstrText + prefix;
+		}
+		if (deleted != NULL) {
+			NP2HeapFree(deleted);
+		}
+		if (inserted != NULL) {
+			NP2HeapFree(inserted);
+		}
+		DiffLines_Free(&a);
+		DiffLines_Free(&b);
+	}
+
+	bFreezeAppTitle = TRUE;
+	bLockedForEditing = FALSE;
+	SciCall_SetReadOnly(FALSE);
+	SciCall_Cancel();
+	FileVars_Apply(&fvCurFile);
+	if (rangeCount != 0) {
+		SciCall_ReplaceRanges(rangeCount, ranges);
+		NP2HeapFree(ranges);
+	}
+	SciCall_SetSavePoint();
+	bFreezeAppTitle = FALSE;
+	return TRUE;
+}
+
+static BOOL EditSetLoadedText(LPCWSTR pszFile, char *lpData, DWORD cbData, BOOL bMapped, BOOL bSkipEncodingDetection, EditFileIOStatus *status);
+
+//=============================================================================
+//
+// EditLoadFile()
+//
+BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus *status) {
+	fileTail.size = 0;
+	HANDLE hFile = CreateFile(pszFile,
+					   GENERIC_READ,
+					   FILE_SHARE_READ | FILE_SHARE_WRITE,
+					   NULL, OPEN_EXISTING,
+					   FILE_ATTRIBUTE_NORMAL,
+					   NULL);
+	dwLastIOError = GetLastError();
+
+	if (hFile == INVALID_HANDLE_VALUE) {
+		iSrcEncoding = -1;
+		iWeakSrcEncoding = -1;
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize;
+	fileSize.QuadPart = 0;
+	if (!GetFileSizeEx(hFile, &fileSize)) {
+		dwLastIOError = GetLastError();
+		CloseHandle(hFile);
+		iSrcEncoding = -1;
+		iWeakSrcEncoding = -1;
+		return FALSE;
+	}
+
+	// display real path name
 	{
 		WCHAR path[MAX_PATH] = L"";
 		// since Windows Vista
@@ -1112,20 +1575,47 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		}
 	}
 
+	// gzip or zstd file is decompressed while loading, and the estimated size is used for size check.
+	LONGLONG loadSize = fileSize.QuadPart;
+	BOOL bUnknownSize = FALSE;
+	int compression = CompressionFormat_None;
+	{
+		uint8_t header[16];
+		DWORD cbHeader = 0;
+		if (ReadFile(hFile, header, sizeof(header), &cbHeader, NULL)) {
+			compression = Decompressor_DetectFormat(header, cbHeader);
+		}
+		if (compression != CompressionFormat_None) {
+			status->bCompressed = TRUE;
+			const LONGLONG contentSize = Decompressor_GetContentSize(hFile, compression, fileSize.QuadPart);
+			if (contentSize >= 0) {
+				loadSize = contentSize;
+			} else {
+				bUnknownSize = TRUE;
+			}
+		} else {
+			LARGE_INTEGER offset;
+			offset.QuadPart = 0;
+			SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN);
+		}
+	}
+
 	// Check if a warning message should be displayed for large files
 #if defined(_WIN64)
 	// less than 1/2 available physical memory:
 	//     1. Buffers we allocated below or when saving file, depends on encoding.
 	//     2. Scintilla's content buffer and style buffer, see CellBuffer class.
 	//        The style buffer is disabled when using SCLEX_NULL (Text File, 2nd Text File, ANSI Art).
+	//        For large file the style buffer is run-length compressed (SC_DOCUMENTOPTION_STYLES_COMPRESSED),
+	//        memory it requires depends on number of style runs instead of fileSize.
 	//        i.e. when default scheme is Text File or 2nd Text File, memory required to load the file
 	//        is about fileSize*2, buffers we allocated below can be reused by system to served
 	//        as Scintilla's style buffer when calling SciCall_SetLexer() inside Style_SetLexer().
 	//     3. Extra memory when moving gaps on editing, it may requires more than 2/3 physical memory.
 	// large file TODO: https://github.com/zufuliu/notepad2/issues/125
-	// [ ] [> 4 GiB] use SetFilePointerEx() and ReadFile()/WriteFile() to read/write file.
+	// [x] [> 4 GiB] use SetFilePointerEx() and ReadFile()/WriteFile() to read/write file.
 	// [-] [> 2 GiB] fix encoding conversion with MultiByteToWideChar() and WideCharToMultiByte().
-	LONGLONG maxFileSize = INT64_C(0x100000000);
+	LONGLONG maxFileSize = INT64_MAX;
 #else
 	// 2 GiB: ptrdiff_t / Sci_Position used in Scintilla
 	LONGLONG maxFileSize = INT64_C(0x80000000);
@@ -1142,7 +1632,7 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		dwLastIOError = GetLastError();
 	}
 
-	if (fileSize.QuadPart > maxFileSize) {
+	if (loadSize > maxFileSize) {
 		CloseHandle(hFile);
 		status->bFileTooBig = TRUE;
 		iSrcEncoding = -1;
@@ -1151,9 +1641,9 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		WCHAR tchMaxSize[32];
 		WCHAR tchDocBytes[32];
 		WCHAR tchMaxBytes[32];
-		StrFormatByteSize(fileSize.QuadPart, tchDocSize, COUNTOF(tchDocSize));
+		StrFormatByteSize(loadSize, tchDocSize, COUNTOF(tchDocSize));
 		StrFormatByteSize(maxFileSize, tchMaxSize, COUNTOF(tchMaxSize));
-		_i64tow(fileSize.QuadPart, tchDocBytes, 10);
+		_i64tow(loadSize, tchDocBytes, 10);
 		_i64tow(maxFileSize, tchMaxBytes, 10);
 		FormatNumberStr(tchDocBytes);
 		FormatNumberStr(tchMaxBytes);
@@ -1161,12 +1651,64 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		return FALSE;
 	}
 
-	char *lpData = (char *)NP2HeapAlloc((SIZE_T)(fileSize.QuadPart) + 16);
+#if defined(_WIN64)
+	if (loadSize >= MAX_NON_UTF8_SIZE) {
+		const BOOL bSuccess = EditLoadFileStreaming(hFile, pszFile, fileSize.QuadPart, loadSize, compression, status);
+		CloseHandle(hFile);
+		return bSuccess;
+	}
+#endif
+
+	char *lpData = NULL;
 	DWORD cbData = 0;
-	// prevent unsigned integer overflow.
-	const DWORD readLen = max_u((DWORD)(NP2HeapSize(lpData) - 2), (DWORD)fileSize.QuadPart);
-	const BOOL bReadSuccess = ReadFile(hFile, lpData, readLen, &cbData, NULL);
-	dwLastIOError = GetLastError();
+	BOOL bReadSuccess = FALSE;
+	BOOL bMapped = FALSE;
+	if (compression != CompressionFormat_None) {
+		Decompressor *decompressor = Decompressor_Create(hFile, compression);
+		if (decompressor != NULL) {
+			// unknown size is assumed as 4:1 compression ratio, buffer is grown when needed.
+			const DWORD cbMaxData = (DWORD)((maxFileSize < MAX_NON_UTF8_SIZE) ? maxFileSize : MAX_NON_UTF8_SIZE);
+			const LONGLONG estimated = bUnknownSize ? loadSize*4 : loadSize;
+			const DWORD cbToRead = (DWORD)((estimated < cbMaxData) ? estimated : cbMaxData);
+			lpData = (char *)NP2HeapAlloc(cbToRead + 16);
+			bReadSuccess = EditReadFileInBackground(hFile, decompressor, &lpData, cbToRead, cbMaxData, &cbData, &status->bLoadCancelled);
+			Decompressor_Destroy(decompressor);
+#if defined(_WIN64)
+			// estimated size is too small, load it again as large file.
+			if (!bReadSuccess && dwLastIOError == ERROR_FILE_TOO_LARGE) {
+				NP2HeapFree(lpData);
+				LARGE_INTEGER offset;
+				offset.QuadPart = 0;
+				SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN);
+				const BOOL bSuccess = EditLoadFileStreaming(hFile, pszFile, fileSize.QuadPart, MAX_NON_UTF8_SIZE, compression, status);
+				CloseHandle(hFile);
+				return bSuccess;
+			}
+#endif
+		} else {
+			dwLastIOError = GetLastError();
+		}
+	} else if (EditShouldMapFile(pszFile, fileSize.QuadPart)) {
+		// copy-on-write view, encoding detection may modify the buffer in place, e.g. _swab().
+		HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (hMapping != NULL) {
+			lpData = (char *)MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+			dwLastIOError = GetLastError();
+			// the view holds a reference to the mapping object.
+			CloseHandle(hMapping);
+			if (lpData != NULL) {
+				bMapped = TRUE;
+				bReadSuccess = TRUE;
+				cbData = (DWORD)fileSize.QuadPart;
+			}
+		}
+	}
+	if (!bMapped) {
+		lpData = (char *)NP2HeapAlloc((SIZE_T)(fileSize.QuadPart) + 16);
+		// prevent unsigned integer overflow.
+		const DWORD readLen = max_u((DWORD)(NP2HeapSize(lpData) - 2), (DWORD)fileSize.QuadPart);
+		bReadSuccess = EditReadFileInBackground(hFile, NULL, &lpData, readLen, readLen, &cbData, &status->bLoadCancelled);
+	}
 	CloseHandle(hFile);
 
 	if (!bReadSuccess) {
@@ -1176,6 +1718,17 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		return FALSE;
 	}
 
+	NP2_TRACE_MARK("LoadFileRead", NP2_TRACE_INT64(cbData, "bytes"), NP2_TRACE_INT64(bMapped, "mapped"));
+	// before encoding detection, which may modify the buffer
+	if (compression == CompressionFormat_None) {
+		EditFileTail_Update(lpData, cbData, cbData);
+	}
+	return EditSetLoadedText(pszFile, lpData, cbData, bMapped, bSkipEncodingDetection, status);
+}
+
+// detect encoding of the loaded data, convert it to UTF-8 (or ANSI) and set as document text,
+// the buffer is freed.
+static BOOL EditSetLoadedText(LPCWSTR pszFile, char *lpData, DWORD cbData, BOOL bMapped, BOOL bSkipEncodingDetection, EditFileIOStatus *status) {
 	status->iEOLMode = GetScintillaEOLMode(iDefaultEOLMode);
 	status->bInconsistent = FALSE;
 	status->totalLineCount = 1;
@@ -1183,6 +1736,7 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 	BOOL bBOM = FALSE;
 	const int iEncoding = EditDetermineEncoding(pszFile, lpData, cbData, bSkipEncodingDetection, &bBOM);
 	status->iEncoding = iEncoding;
+	NP2_TRACE_MARK("LoadFileEncoding", NP2_TRACE_INT64(iEncoding, "encoding"));
 
 	iSrcEncoding = -1;
 	iWeakSrcEncoding = -1;
@@ -1201,19 +1755,11 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		// cbData/2 => WCHAR, WCHAR*3 => UTF-8
 		lpDataUTF8 = (char *)NP2HeapAlloc((cbData + 1)*sizeof(WCHAR));
 		LPCWSTR pszTextW = bBOM ? ((LPWSTR)lpData + 1) : (LPWSTR)lpData;
-		// NOTE: requires two extra trailing NULL bytes.
-		const DWORD cchTextW = bBOM ? (cbData / sizeof(WCHAR)) : ((cbData / sizeof(WCHAR)) + 1);
-		cbData = WideCharToMultiByte(CP_UTF8, 0, pszTextW, cchTextW, lpDataUTF8, (int)NP2HeapSize(lpDataUTF8), NULL, NULL);
-		if (cbData == 0) {
-			cbData = WideCharToMultiByte(CP_ACP, 0, pszTextW, -1, lpDataUTF8, (int)NP2HeapSize(lpDataUTF8), NULL, NULL);
-			status->bUnicodeErr = TRUE;
-		}
-		if (cbData != 0) {
-			// remove the NULL terminator.
-			cbData -= 1;
-		}
+		const size_t cchTextW = (cbData / sizeof(WCHAR)) - (bBOM ? 1 : 0);
+		cbData = (DWORD)UTF16ToUTF8(pszTextW, cchTextW, lpDataUTF8, &status->bUnicodeErr);
 
-		NP2HeapFree(lpData);
+		EditFreeFileBuffer(lpData, bMapped);
+		bMapped = FALSE;
 		lpData = lpDataUTF8;
 		FileVars_Init(lpData, cbData, &fvCurFile);
 	} else if (uFlags & NCP_UTF8) {
@@ -1225,7 +1771,8 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		const UINT uCodePage = mEncoding[iEncoding].uCodePage;
 		LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
 		const int cbDataWide = MultiByteToWideChar(uCodePage, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
-		NP2HeapFree(lpData);
+		EditFreeFileBuffer(lpData, bMapped);
+		bMapped = FALSE;
 
 		lpData = (char *)NP2HeapAlloc(cbDataWide * kMaxMultiByteCount + 16);
 		cbData = WideCharToMultiByte(CP_UTF8, 0, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, NULL);
@@ -1233,27 +1780,511 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		lpDataUTF8 = lpData;
 	}
 
+	NP2_TRACE_MARK("LoadFileConvert", NP2_TRACE_INT64(cbData, "bytes"));
 	if (cbData) {
 		EditDetectEOLMode(lpDataUTF8, cbData, status);
 		EditDetectIndentation(lpDataUTF8, cbData, &fvCurFile);
 	}
-	SciCall_SetCodePage((uFlags & NCP_DEFAULT) ? iDefaultCodePage : SC_CP_UTF8);
-	EditSetNewText(lpDataUTF8, cbData, status->totalLineCount);
+	NP2_TRACE_MARK("LoadFileDetectEOL", NP2_TRACE_INT64(status->iEOLMode, "eolMode"), NP2_TRACE_INT64(status->totalLineCount, "lines"));
+	const UINT cpEdit = (uFlags & NCP_DEFAULT) ? iDefaultCodePage : SC_CP_UTF8;
+	if (!(status->bReload && cpEdit == SciCall_GetCodePage() && EditReloadText(lpDataUTF8, cbData, status->totalLineCount))) {
+		SciCall_SetCodePage(cpEdit);
+		EditSetNewText(lpDataUTF8, cbData, status->totalLineCount);
+	}
 
-	NP2HeapFree(lpData);
+	EditFreeFileBuffer(lpData, bMapped);
 	return TRUE;
 }
 
 //=============================================================================
 //
-// EditSaveFile()
-//
-BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *status) {
+// EditLoadFileRange()
+//
+// line offsets are located by counting line endings of fixed size slices on all processors, slices
+// are counted in batches until the last requested line is reached. counts for the last file are kept,
+// so opening another range of the same file only scans slices not counted yet.
+#define EDIT_RANGE_SLICE_SIZE	(16*1024*1024)
+
+typedef struct FileLineIndex {
+	WCHAR szFile[MAX_PATH];
+	LONGLONG fileSize;
+	FILETIME ftLastWrite;
+	DWORD sliceCount;	// total slices of the file
+	DWORD countedCount;	// slices counted from file start
+	LONGLONG *lineEnds;	// line endings in each slice
+	uint8_t *startLF;	// slice starts with LF of a CR+LF counted in previous slice
+} FileLineIndex;
+
+static FileLineIndex lineIndex;
+
+typedef struct LineIndexWorker {
+	FileLineIndex *index;
+	DWORD sliceEnd;
+	volatile LONG nextSlice;
+	volatile LONG failed;
+} LineIndexWorker;
+
+static DWORD WINAPI LineIndexThread(LPVOID lpParam) {
+	LineIndexWorker *worker = (LineIndexWorker *)lpParam;
+	FileLineIndex *index = worker->index;
+	HANDLE hFile = CreateFile(index->szFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		InterlockedExchange(&worker->failed, TRUE);
+		return 0;
+	}
+
+	// one more byte to check whether next slice starts with LF
+	char *buffer = (char *)NP2HeapAlloc(EDIT_RANGE_SLICE_SIZE + 16);
+	while (!worker->failed) {
+		const DWORD slice = (DWORD)InterlockedIncrement(&worker->nextSlice) - 1;
+		if (slice >= worker->sliceEnd) {
+			break;
+		}
+		LARGE_INTEGER offset;
+		offset.QuadPart = (LONGLONG)slice * EDIT_RANGE_SLICE_SIZE;
+		DWORD cbData = 0;
+		if (!SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN) || !ReadFile(hFile, buffer, EDIT_RANGE_SLICE_SIZE + 1, &cbData, NULL)) {
+			InterlockedExchange(&worker->failed, TRUE);
+			break;
+		}
+		const DWORD cbSlice = min_u(cbData, EDIT_RANGE_SLICE_SIZE);
+		index->lineEnds[slice] = (cbSlice == 0) ? 0 : (LONGLONG)EditCountLineEnds(buffer, cbSlice);
+		if (cbData > cbSlice && buffer[cbSlice - 1] == '\r' && buffer[cbSlice] == '\n') {
+			index->startLF[slice + 1] = TRUE;
+		}
+	}
+	NP2HeapFree(buffer);
+	CloseHandle(hFile);
+	return 0;
+}
+
+static void FileLineIndex_Clear(FileLineIndex *index) {
+	if (index->lineEnds != NULL) {
+		NP2HeapFree(index->lineEnds);
+		NP2HeapFree(index->startLF);
+	}
+	ZeroMemory(index, sizeof(FileLineIndex));
+}
+
+static BOOL FileLineIndex_Open(FileLineIndex *index, LPCWSTR pszFile, HANDLE hFile, LONGLONG fileSize) {
+	BY_HANDLE_FILE_INFORMATION info;
+	if (!GetFileInformationByHandle(hFile, &info)) {
+		return FALSE;
+	}
+	if (index->lineEnds != NULL && index->fileSize == fileSize && StrCaseEqual(index->szFile, pszFile)
+		&& CompareFileTime(&index->ftLastWrite, &info.ftLastWriteTime) == 0) {
+		return TRUE;
+	}
+
+	FileLineIndex_Clear(index);
+	lstrcpyn(index->szFile, pszFile, COUNTOF(index->szFile));
+	index->fileSize = fileSize;
+	index->ftLastWrite = info.ftLastWriteTime;
+	index->sliceCount = (DWORD)((fileSize + EDIT_RANGE_SLICE_SIZE - 1) / EDIT_RANGE_SLICE_SIZE);
+	index->lineEnds = (LONGLONG *)NP2HeapAlloc((index->sliceCount + 1) * sizeof(LONGLONG));
+	index->startLF = (uint8_t *)NP2HeapAlloc(index->sliceCount + 1);
+	return TRUE;
+}
+
+// returns offset after specified count of line endings, or file size when the file has fewer lines.
+static LONGLONG FileLineIndex_Locate(FileLineIndex *index, HANDLE hFile, LONGLONG lineEnds, LPCWSTR pszStatus) {
+	if (lineEnds <= 0) {
+		return 0;
+	}
+
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo(&sysInfo);
+	const DWORD batch = max_u(sysInfo.dwNumberOfProcessors, 1)*2;
+	DWORD slice = 0;
+	LONGLONG counted = 0;
+	while (TRUE) {
+		if (slice == index->countedCount) {
+			if (slice == index->sliceCount) {
+				return index->fileSize;
+			}
+			LineIndexWorker worker = { index, min_u(slice + batch, index->sliceCount), (LONG)slice, FALSE };
+			RunOnAllProcessors(LineIndexThread, &worker, worker.sliceEnd - slice);
+			if (worker.failed) {
+				return -1;
+			}
+			index->countedCount = worker.sliceEnd;
+
+			WCHAR tchStatus[MAX_PATH + 128];
+			wsprintf(tchStatus, L"%s %d%%", pszStatus, (int)((LONGLONG)index->countedCount * 100 / index->sliceCount));
+			StatusSetText(hwndStatus, STATUS_HELP, tchStatus);
+			UpdateWindow(hwndStatus);
+		}
+		const LONGLONG count = index->lineEnds[slice] - index->startLF[slice];
+		if (counted + count >= lineEnds) {
+			break;
+		}
+		counted += count;
+		++slice;
+	}
+
+	// find the line ending inside the slice
+	LONGLONG offset = (LONGLONG)slice * EDIT_RANGE_SLICE_SIZE;
+	lineEnds -= counted;
+	char *buffer = (char *)NP2HeapAlloc(EDIT_RANGE_SLICE_SIZE + 16);
+	LARGE_INTEGER pos;
+	pos.QuadPart = offset;
+	DWORD cbData = 0;
+	if (!SetFilePointerEx(hFile, pos, NULL, FILE_BEGIN) || !ReadFile(hFile, buffer, EDIT_RANGE_SLICE_SIZE + 1, &cbData, NULL)) {
+		NP2HeapFree(buffer);
+		return -1;
+	}
+
+	DWORD i = index->startLF[slice];
+	while (i < cbData) {
+		const char ch = buffer[i++];
+		if (ch == '\n' || (ch == '\r' && (i == cbData || buffer[i] != '\n'))) {
+			if (--lineEnds == 0) {
+				break;
+			}
+		}
+	}
+	NP2HeapFree(buffer);
+	return offset + i;
+}
+
+// keep whole UTF-8 character at both ends of byte range.
+static void EditAdjustByteRange(HANDLE hFile, LONGLONG *start, LONGLONG *end, LONGLONG fileSize) {
+	uint8_t buffer[4];
+	DWORD cbData = 0;
+	LARGE_INTEGER pos;
+	if (*start != 0 && *start < *end) {
+		pos.QuadPart = *start;
+		if (SetFilePointerEx(hFile, pos, NULL, FILE_BEGIN) && ReadFile(hFile, buffer, sizeof(buffer), &cbData, NULL)) {
+			DWORD skip = 0;
+			while (skip < 3 && skip < cbData && (buffer[skip] & 0xC0) == 0x80) {
+				++skip;
+			}
+			*start += (skip == 3 || skip == cbData) ? 0 : skip;
+		}
+	}
+	if (*end != fileSize && *end - *start >= 4) {
+		pos.QuadPart = *end - 4;
+		if (SetFilePointerEx(hFile, pos, NULL, FILE_BEGIN) && ReadFile(hFile, buffer, sizeof(buffer), &cbData, NULL) && cbData == 4
+			&& buffer[3] != '\r') {
+			*end -= EditGetChunkTailLength(buffer, 4);
+		}
+	}
+}
+
+BOOL EditLoadFileRange(LPCWSTR pszFile, EditFileRange *range, EditFileIOStatus *status) {
+	fileTail.size = 0;
+	HANDLE hFile = CreateFile(pszFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		dwLastIOError = GetLastError();
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize)) {
+		dwLastIOError = GetLastError();
+		CloseHandle(hFile);
+		return FALSE;
+	}
+
+	LONGLONG start;
+	LONGLONG end;
+	if (range->bLines) {
+		if (!FileLineIndex_Open(&lineIndex, pszFile, hFile, fileSize.QuadPart)) {
+			dwLastIOError = GetLastError();
+			CloseHandle(hFile);
+			return FALSE;
+		}
+
+		WCHAR tchStatus[MAX_PATH + 128];
+		WCHAR fmt[128];
+		FormatString(tchStatus, fmt, IDS_LOADFILE, pszFile);
+		start = FileLineIndex_Locate(&lineIndex, hFile, range->start - 1, tchStatus);
+		end = (start < 0) ? -1 : ((range->end <= 0) ? fileSize.QuadPart : FileLineIndex_Locate(&lineIndex, hFile, range->end, tchStatus));
+		if (start < 0 || end < 0) {
+			dwLastIOError = GetLastError();
+			FileLineIndex_Clear(&lineIndex);
+			CloseHandle(hFile);
+			return FALSE;
+		}
+	} else {
+		start = (range->start <= 0) ? 0 : ((range->start < fileSize.QuadPart) ? range->start : fileSize.QuadPart);
+		end = (range->end <= 0 || range->end > fileSize.QuadPart) ? fileSize.QuadPart : range->end;
+		end = (end < start) ? start : end;
+		EditAdjustByteRange(hFile, &start, &end, fileSize.QuadPart);
+	}
+
+	// same limit as loading whole file without large file mode.
+	const LONGLONG length = end - start;
+	if (length >= MAX_NON_UTF8_SIZE) {
+		CloseHandle(hFile);
+		dwLastIOError = ERROR_FILE_TOO_LARGE;
+		status->bFileTooBig = TRUE;
+		return FALSE;
+	}
+
+	LARGE_INTEGER offset;
+	offset.QuadPart = start;
+	char *lpData = (char *)NP2HeapAlloc((SIZE_T)length + 16);
+	DWORD cbData = 0;
+	BOOL bSuccess = SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN);
+	if (!bSuccess) {
+		dwLastIOError = GetLastError();
+	} else if (length != 0) {
+		bSuccess = EditReadFileInBackground(hFile, NULL, &lpData, (DWORD)length, (DWORD)length, &cbData, &status->bLoadCancelled);
+	}
+	CloseHandle(hFile);
+	if (!bSuccess) {
+		NP2HeapFree(lpData);
+		return FALSE;
+	}
+
+	if (!EditSetLoadedText(pszFile, lpData, cbData, FALSE, FALSE, status)) {
+		return FALSE;
+	}
+
+	// range actually loaded
+	if (range->bLines) {
+		Sci_Line lines = SciCall_GetLineCount();
+		if (lines > 1 && SciCall_PositionFromLine(lines - 1) == SciCall_GetLength()) {
+			--lines;
+		}
+		range->end = range->start + lines - 1;
+	} else {
+		range->start = start;
+		range->end = end;
+	}
+	return TRUE;
+}
+
+// file is written with overlapped I/O from two page aligned buffers: next chunk is converted
+// while previous chunk is being written, paint messages are dispatched while waiting.
+#define NP2_OVERLAPPED_WRITE_CHUNK_SIZE	(4*1024*1024)
+
+typedef struct FileWriter {
+	HANDLE hFile;
+	char *buffer[2];
+	OVERLAPPED overlapped[2];
+	DWORD cbPending[2];
+	UINT current;
+	DWORD cbBuffer;
+	LONGLONG offset;
+	LONGLONG total;
+	BOOL bCancelable;
+	BOOL bCancelled;
+	BOOL bSuccess;
+	DWORD dwError;
+	int percent;
+	LPWSTR pszPercent;
+	WCHAR tchStatus[MAX_PATH + 128];
+} FileWriter;
+
+static void FileWriter_Init(FileWriter *writer, HANDLE hFile, LPCWSTR pszFile, BOOL bCancelable) {
+	ZeroMemory(writer, sizeof(FileWriter));
+	writer->hFile = hFile;
+	writer->bCancelable = bCancelable;
+	writer->bSuccess = TRUE;
+	writer->percent = -1;
+	for (UINT index = 0; index < 2; index++) {
+		writer->buffer[index] = (char *)VirtualAlloc(NULL, NP2_OVERLAPPED_WRITE_CHUNK_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+		writer->overlapped[index].hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		if (writer->buffer[index] == NULL || writer->overlapped[index].hEvent == NULL) {
+			writer->bSuccess = FALSE;
+			writer->dwError = ERROR_NOT_ENOUGH_MEMORY;
+		}
+	}
+
+	WCHAR fmt[128];
+	FormatString(writer->tchStatus, fmt, IDS_SAVEFILE, pszFile);
+	writer->pszPercent = StrEnd(writer->tchStatus);
+}
+
+static void FileWriter_Cancel(LPVOID lpParam) {
+	FileWriter *writer = (FileWriter *)lpParam;
+	if (writer->bCancelable && !writer->bCancelled) {
+		// pending writes were issued from this thread
+		writer->bCancelled = TRUE;
+		CancelIo(writer->hFile);
+	}
+}
+
+static void FileWriter_Wait(FileWriter *writer, UINT index) {
+	const DWORD cbPending = writer->cbPending[index];
+	if (cbPending == 0) {
+		return;
+	}
+
+	writer->cbPending[index] = 0;
+	LPOVERLAPPED lpOverlapped = &writer->overlapped[index];
+	WaitForObjectDispatchPaint(lpOverlapped->hEvent, FileWriter_Cancel, writer);
+
+	DWORD cbWritten = 0;
+	if (!GetOverlappedResult(writer->hFile, lpOverlapped, &cbWritten, TRUE) || cbWritten != cbPending) {
+		if (writer->bSuccess) {
+			writer->bSuccess = FALSE;
+			writer->dwError = writer->bCancelled ? ERROR_CANCELLED : GetLastError();
+		}
+	}
+}
+
+static void FileWriter_Flush(FileWriter *writer) {
+	const DWORD cbBuffer = writer->cbBuffer;
+	if (cbBuffer != 0 && writer->bSuccess) {
+		const UINT index = writer->current;
+		LPOVERLAPPED lpOverlapped = &writer->overlapped[index];
+		lpOverlapped->Offset = (DWORD)writer->offset;
+		lpOverlapped->OffsetHigh = (DWORD)(writer->offset >> 32);
+		ResetEvent(lpOverlapped->hEvent);
+		if (WriteFile(writer->hFile, writer->buffer[index], cbBuffer, NULL, lpOverlapped) || GetLastError() == ERROR_IO_PENDING) {
+			writer->cbPending[index] = cbBuffer;
+			writer->offset += cbBuffer;
+		} else {
+			writer->bSuccess = FALSE;
+			writer->dwError = GetLastError();
+		}
+
+		// fill the other buffer while this one is being written
+		writer->current = index ^ 1;
+		FileWriter_Wait(writer, writer->current);
+
+		if (writer->total != 0) {
+			const LONGLONG offset = (writer->offset < writer->total) ? writer->offset : writer->total;
+			const int percent = (int)(offset * 100 / writer->total);
+			if (percent != writer->percent) {
+				writer->percent = percent;
+				wsprintf(writer->pszPercent, L" %d%%", percent);
+				StatusSetText(hwndStatus, STATUS_HELP, writer->tchStatus);
+				UpdateWindow(hwndStatus);
+			}
+		}
+	}
+	writer->cbBuffer = 0;
+}
+
+static BOOL FileWriter_Write(FileWriter *writer, const void *data, size_t size) {
+	const char *ptr = (const char *)data;
+	while (size != 0 && writer->bSuccess) {
+		const DWORD cbCopy = (DWORD)min_z(size, NP2_OVERLAPPED_WRITE_CHUNK_SIZE - writer->cbBuffer);
+		memcpy(writer->buffer[writer->current] + writer->cbBuffer, ptr, cbCopy);
+		writer->cbBuffer += cbCopy;
+		ptr += cbCopy;
+		size -= cbCopy;
+		if (writer->cbBuffer == NP2_OVERLAPPED_WRITE_CHUNK_SIZE) {
+			FileWriter_Flush(writer);
+		}
+	}
+	return writer->bSuccess;
+}
+
+// write remaining data, truncate the file at written size, and release buffers.
+static BOOL FileWriter_Finish(FileWriter *writer) {
+	FileWriter_Flush(writer);
+	FileWriter_Wait(writer, 0);
+	FileWriter_Wait(writer, 1);
+	if (writer->bSuccess) {
+		LARGE_INTEGER offset;
+		offset.QuadPart = writer->offset;
+		if (!(SetFilePointerEx(writer->hFile, offset, NULL, FILE_BEGIN) && SetEndOfFile(writer->hFile))) {
+			writer->bSuccess = FALSE;
+			writer->dwError = GetLastError();
+		}
+	}
+
+	for (UINT index = 0; index < 2; index++) {
+		if (writer->buffer[index] != NULL) {
+			VirtualFree(writer->buffer[index], 0, MEM_RELEASE);
+		}
+		if (writer->overlapped[index].hEvent != NULL) {
+			CloseHandle(writer->overlapped[index].hEvent);
+		}
+	}
+	dwLastIOError = writer->dwError;
+	return writer->bSuccess;
+}
+
+// write document text directly from Scintilla's buffer segments, without moving the gap.
+static BOOL EditWriteDocumentText(FileWriter *writer, Sci_Position length) {
+	writer->total += length;
+	Sci_Position position = 0;
+	while (writer->bSuccess && position < length) {
+		Sci_Position end = 0;
+		const char *ptr = SciCall_GetSegmentPointer(position, &end);
+		end = min_pos(end, position + NP2_STREAMING_LOAD_CHUNK_SIZE);
+		FileWriter_Write(writer, ptr, end - position);
+		position = end;
+	}
+	return writer->bSuccess;
+}
+
+// convert UTF-8 document text to UTF-16 or uCodePage in chunks. When writer is NULL,
+// nothing is written, only check whether the conversion would lose any character.
+static BOOL EditWriteConvertedText(FileWriter *writer, Sci_Position length, UINT uFlags, UINT uCodePage, DWORD dwFlags, BOOL *pbDataLoss) {
+	char *lpData = (char *)NP2HeapAlloc(NP2_STREAMING_SAVE_CHUNK_SIZE + 16);
+	LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc((NP2_STREAMING_SAVE_CHUNK_SIZE + 16) * sizeof(WCHAR));
+	char *lpDataMB = NULL;
+	if (writer != NULL) {
+		// estimated output size for progress
+		writer->total += (uFlags & NCP_UNICODE) ? 2*length : length;
+		if (!(uFlags & NCP_UNICODE)) {
+			lpDataMB = (char *)NP2HeapAlloc(NP2_STREAMING_SAVE_CHUNK_SIZE * 4 + 16);
+		}
+	}
+
+	BOOL bWriteSuccess = TRUE;
+	Sci_Position position = 0;
+	while (bWriteSuccess && position < length) {
+		struct Sci_TextRange tr = { { position, min_pos(length, position + NP2_STREAMING_SAVE_CHUNK_SIZE) }, lpData };
+		DWORD cbData = (DWORD)SciCall_GetTextRange(&tr);
+		if (tr.chrg.cpMax < length) {
+			// keep incomplete UTF-8 sequence for next chunk
+			cbData -= EditGetChunkTailLength((const uint8_t *)lpData, cbData);
+		}
+		position += cbData;
+
+		const int cbDataWide = (int)UTF8ToUTF16(lpData, cbData, lpDataWide);
+		if (uFlags & NCP_UNICODE) {
+			if (uFlags & NCP_UNICODE_REVERSE) {
+				_swab((char *)lpDataWide, (char *)lpDataWide, (int)(cbDataWide * sizeof(WCHAR)));
+			}
+			bWriteSuccess = FileWriter_Write(writer, lpDataWide, cbDataWide * sizeof(WCHAR));
+		} else if (writer == NULL) {
+			BOOL bDataLoss = FALSE;
+			WideCharToMultiByte(uCodePage, dwFlags, lpDataWide, cbDataWide, NULL, 0, NULL, &bDataLoss);
+			if (bDataLoss) {
+				*pbDataLoss = TRUE;
+				break;
+			}
+		} else {
+			cbData = WideCharToMultiByte(uCodePage, dwFlags, lpDataWide, cbDataWide, lpDataMB, (int)NP2HeapSize(lpDataMB), NULL, NULL);
+			bWriteSuccess = FileWriter_Write(writer, lpDataMB, cbData);
+		}
+	}
+
+	if (lpDataMB != NULL) {
+		NP2HeapFree(lpDataMB);
+	}
+	NP2HeapFree(lpDataWide);
+	NP2HeapFree(lpData);
+	return bWriteSuccess;
+}
+
+#if defined(_WIN64)
+// text larger than 4 GiB is saved as UTF-8 or ANSI directly from Scintilla's buffer.
+static BOOL EditSaveLargeText(FileWriter *writer, Sci_Position length, int iEncoding) {
+	if (mEncoding[iEncoding].uFlags & (NCP_UTF8_SIGN | NCP_UNICODE_BOM)) {
+		FileWriter_Write(writer, "\xEF\xBB\xBF", 3);
+	}
+	return EditWriteDocumentText(writer, length);
+}
+#endif
+
+static HANDLE EditOpenSaveFile(LPCWSTR pszFile) {
 	HANDLE hFile = CreateFile(pszFile,
 					   GENERIC_WRITE,
 					   FILE_SHARE_READ | FILE_SHARE_WRITE,
 					   NULL, OPEN_ALWAYS,
-					   FILE_ATTRIBUTE_NORMAL,
+					   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
 					   NULL);
 	dwLastIOError = GetLastError();
 
@@ -1267,36 +2298,85 @@ BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *
 							   FILE_SHARE_READ | FILE_SHARE_WRITE,
 							   NULL,
 							   OPEN_ALWAYS,
-							   FILE_ATTRIBUTE_NORMAL | dwAttributes,
+							   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | dwAttributes,
 							   NULL);
 			dwLastIOError = GetLastError();
 		}
 	}
+	return hFile;
+}
 
-	if (hFile == INVALID_HANDLE_VALUE) {
-		return FALSE;
+// create a temporary file in the same directory (so it can be renamed onto the target),
+// file with links or read-only file is written in place to keep its identity or error.
+static HANDLE EditCreateTempSaveFile(LPCWSTR pszFile, LPWSTR pszTempFile) {
+	const DWORD dwAttributes = GetFileAttributes(pszFile);
+	if (dwAttributes != INVALID_FILE_ATTRIBUTES) {
+		if (dwAttributes & (FILE_ATTRIBUTE_READONLY | FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_REPARSE_POINT)) {
+			return INVALID_HANDLE_VALUE;
+		}
+		HANDLE hFile = CreateFile(pszFile, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+								  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return INVALID_HANDLE_VALUE;
+		}
+		BY_HANDLE_FILE_INFORMATION info;
+		const BOOL bLinked = !GetFileInformationByHandle(hFile, &info) || info.nNumberOfLinks > 1;
+		CloseHandle(hFile);
+		if (bLinked) {
+			return INVALID_HANDLE_VALUE;
+		}
 	}
 
-	// ensure consistent line endings
-	if (bFixLineEndings) {
-		EditEnsureConsistentLineEndings();
+	WCHAR tchDirectory[MAX_PATH];
+	lstrcpyn(tchDirectory, pszFile, COUNTOF(tchDirectory));
+	PathRemoveFileSpec(tchDirectory);
+	if (!GetTempFileName(StrIsEmpty(tchDirectory) ? L"." : tchDirectory, L"np2", 0, pszTempFile)) {
+		return INVALID_HANDLE_VALUE;
 	}
 
-	// strip trailing blanks
-	if (bAutoStripBlanks) {
-		EditStripTrailingBlanks(hwnd, TRUE);
+	HANDLE hFile = CreateFile(pszTempFile,
+					   GENERIC_WRITE,
+					   0,
+					   NULL, CREATE_ALWAYS,
+					   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+					   NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		DeleteFile(pszTempFile);
 	}
+	return hFile;
+}
 
-	BOOL bWriteSuccess;
-	// get text
-	DWORD cbData = (DWORD)SciCall_GetLength();
-	char *lpData = NULL;
-
-	if (cbData == 0) {
-		bWriteSuccess = SetEndOfFile(hFile);
+// swap the temporary file in, ReplaceFile() keeps attributes, ACL and creation time of existing file.
+static BOOL EditReplaceSavedFile(LPCWSTR pszFile, LPCWSTR pszTempFile) {
+	BOOL bSuccess;
+	if (GetFileAttributes(pszFile) == INVALID_FILE_ATTRIBUTES) {
+		bSuccess = MoveFileEx(pszTempFile, pszFile, MOVEFILE_WRITE_THROUGH);
+	} else {
+		bSuccess = ReplaceFile(pszFile, pszTempFile, NULL, REPLACEFILE_IGNORE_MERGE_ERRORS, NULL, NULL);
+	}
+	if (!bSuccess) {
 		dwLastIOError = GetLastError();
+	}
+	return bSuccess;
+}
+
+static BOOL EditWriteSaveFile(HANDLE hFile, LPCWSTR pszFile, BOOL bTempFile, EditFileIOStatus *status) {
+	FileWriter writer;
+	// writing in place can't be cancelled, as the file would be left truncated
+	FileWriter_Init(&writer, hFile, pszFile, bTempFile);
+
+	BOOL bWriteSuccess = writer.bSuccess;
+	// text is written or converted directly from Scintilla's buffer, without copying whole document
+	const Sci_Position length = SciCall_GetLength();
+	const DWORD cbData = (DWORD)length;
+
+	if (!bWriteSuccess || length == 0) {
+		// empty file is truncated by FileWriter_Finish()
+#if defined(_WIN64)
+	} else if (length > (Sci_Position)MAXDWORD) {
+		bWriteSuccess = EditSaveLargeText(&writer, length, status->iEncoding);
+#endif
 	} else {
-		DWORD dwBytesWritten;
 		int iEncoding = status->iEncoding;
 		UINT uFlags = mEncoding[iEncoding].uFlags;
 		if (cbData >= MAX_NON_UTF8_SIZE) {
@@ -1311,110 +2391,107 @@ BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *
 			}
 		}
 
-		lpData = (char *)NP2HeapAlloc(cbData + 1);
-		SciCall_GetText(NP2HeapSize(lpData), lpData);
-		// FIXME: move checks in front of disk file access
-		/*if ((uFlags & NCP_UNICODE) == 0 && (uFlags & NCP_UTF8_SIGN) == 0) {
-				BOOL bEncodingMismatch = TRUE;
-				FILEVARS fv;
-				FileVars_Init(lpData, cbData, &fv);
-				if (fv.mask & FV_ENCODING) {
-					int iAltEncoding;
-					if (FileVars_IsValidEncoding(&fv)) {
-						iAltEncoding = FileVars_GetEncoding(&fv);
-						if (iAltEncoding == iEncoding)
-							bEncodingMismatch = FALSE;
-						else if ((mEncoding[iAltEncoding].uFlags & NCP_UTF8) && (uFlags & NCP_UTF8))
-							bEncodingMismatch = FALSE;
-					}
-					if (bEncodingMismatch) {
-						Encoding_GetLabel(iAltEncoding);
-						Encoding_GetLabel(iEncoding);
-						InfoBoxWarn(MB_OK, L"MsgEncodingMismatch", IDS_ENCODINGMISMATCH,
-							mEncoding[iAltEncoding].wchLabel,
-							mEncoding[iEncoding].wchLabel);
-					}
-				}
-			}*/
 		if (uFlags & NCP_UNICODE) {
-			SetEndOfFile(hFile);
-
-			LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
-			const int cbDataWide = MultiByteToWideChar(CP_UTF8, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
-
 			if (uFlags & NCP_UNICODE_BOM) {
 				if (uFlags & NCP_UNICODE_REVERSE) {
-					WriteFile(hFile, (LPCVOID)"\xFE\xFF", 2, &dwBytesWritten, NULL);
+					FileWriter_Write(&writer, "\xFE\xFF", 2);
 				} else {
-					WriteFile(hFile, (LPCVOID)"\xFF\xFE", 2, &dwBytesWritten, NULL);
+					FileWriter_Write(&writer, "\xFF\xFE", 2);
 				}
 			}
 
-			if (uFlags & NCP_UNICODE_REVERSE) {
-				_swab((char *)lpDataWide, (char *)lpDataWide, (int)(cbDataWide * sizeof(WCHAR)));
-			}
-
-			bWriteSuccess = WriteFile(hFile, lpDataWide, cbDataWide * sizeof(WCHAR), &dwBytesWritten, NULL);
-			dwLastIOError = GetLastError();
-
-			NP2HeapFree(lpDataWide);
+			bWriteSuccess = EditWriteConvertedText(&writer, length, uFlags, CP_UTF8, 0, NULL);
 		} else if (uFlags & NCP_UTF8) {
-			SetEndOfFile(hFile);
-
 			if (uFlags & NCP_UTF8_SIGN) {
-				WriteFile(hFile, (LPCVOID)"\xEF\xBB\xBF", 3, &dwBytesWritten, NULL);
+				FileWriter_Write(&writer, "\xEF\xBB\xBF", 3);
 			}
 
-			bWriteSuccess = WriteFile(hFile, lpData, cbData, &dwBytesWritten, NULL);
-			dwLastIOError = GetLastError();
+			bWriteSuccess = EditWriteDocumentText(&writer, length);
 		} else if (uFlags & (NCP_8BIT | NCP_7BIT)) {
 			BOOL bCancelDataLoss = FALSE;
 			const UINT uCodePage = mEncoding[iEncoding].uCodePage;
 			const BOOL zeroFlags = IsZeroFlagsCodePage(uCodePage);
-
-			LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
-			const int cbDataWide = MultiByteToWideChar(CP_UTF8, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
-
-			if (zeroFlags) {
-				NP2HeapFree(lpData);
-				lpData = (char *)NP2HeapAlloc(NP2HeapSize(lpDataWide) * 2);
-			} else {
-				ZeroMemory(lpData, NP2HeapSize(lpData));
-			}
-
-			if (zeroFlags) {
-				cbData = WideCharToMultiByte(uCodePage, 0, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, NULL);
-			} else {
-				cbData = WideCharToMultiByte(uCodePage, WC_NO_BEST_FIT_CHARS, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, &bCancelDataLoss);
-				if (!bCancelDataLoss) {
-					cbData = WideCharToMultiByte(uCodePage, 0, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, NULL);
-					bCancelDataLoss = FALSE;
+			DWORD dwFlags = 0;
+			if (!zeroFlags) {
+				// check data loss before overwriting the file
+				EditWriteConvertedText(NULL, length, uFlags, uCodePage, WC_NO_BEST_FIT_CHARS, &bCancelDataLoss);
+				if (bCancelDataLoss) {
+					dwFlags = WC_NO_BEST_FIT_CHARS;
 				}
 			}
-			NP2HeapFree(lpDataWide);
 
 			if (!bCancelDataLoss || InfoBoxWarn(MB_OKCANCEL, L"MsgConv3", IDS_ERR_UNICODE2) == IDOK) {
-				SetEndOfFile(hFile);
-				bWriteSuccess = WriteFile(hFile, lpData, cbData, &dwBytesWritten, NULL);
-				dwLastIOError = GetLastError();
+				bWriteSuccess = EditWriteConvertedText(&writer, length, uFlags, uCodePage, dwFlags, NULL);
 			} else {
 				bWriteSuccess = FALSE;
 				status->bCancelDataLoss = TRUE;
 			}
 		} else {
-			SetEndOfFile(hFile);
-			bWriteSuccess = WriteFile(hFile, lpData, cbData, &dwBytesWritten, NULL);
-			dwLastIOError = GetLastError();
+			bWriteSuccess = EditWriteDocumentText(&writer, length);
 		}
 	}
 
-	if (lpData != NULL) {
-		NP2HeapFree(lpData);
+	if (status->bCancelDataLoss) {
+		// keep existing file unchanged
+		writer.bSuccess = FALSE;
+		writer.dwError = ERROR_CANCELLED;
+	}
+	bWriteSuccess = FileWriter_Finish(&writer) && bWriteSuccess;
+	return bWriteSuccess;
+}
+
+//=============================================================================
+//
+// EditSaveFile()
+//
+BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *status) {
+	// write to a temporary file then replace the target, so a failed save won't destroy existing file.
+	WCHAR tchTempFile[MAX_PATH];
+	HANDLE hFile = EditCreateTempSaveFile(pszFile, tchTempFile);
+	const BOOL bTempFile = hFile != INVALID_HANDLE_VALUE;
+	if (!bTempFile) {
+		hFile = EditOpenSaveFile(pszFile);
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return FALSE;
+		}
+	}
+
+	// ensure consistent line endings
+	if (bFixLineEndings) {
+		EditEnsureConsistentLineEndings();
+	}
+
+	// strip trailing blanks
+	if (bAutoStripBlanks) {
+		EditStripTrailingBlanks(TRUE);
 	}
 
+	NP2_TRACE_MARK("SaveFilePrepare", NP2_TRACE_INT64(bTempFile, "tempFile"));
+	BOOL bWriteSuccess = EditWriteSaveFile(hFile, pszFile, bTempFile, status);
 	CloseHandle(hFile);
+	NP2_TRACE_MARK("SaveFileWrite", NP2_TRACE_INT64(bWriteSuccess, "success"));
+	if (bTempFile) {
+		if (bWriteSuccess) {
+			bWriteSuccess = EditReplaceSavedFile(pszFile, tchTempFile);
+		}
+		if (!bWriteSuccess) {
+			const DWORD dwError = dwLastIOError;
+			DeleteFile(tchTempFile);
+			dwLastIOError = dwError;
+			// target may be opened by other program without delete sharing, write it in place.
+			if (!status->bCancelDataLoss && dwError != ERROR_CANCELLED) {
+				hFile = EditOpenSaveFile(pszFile);
+				if (hFile != INVALID_HANDLE_VALUE) {
+					bWriteSuccess = EditWriteSaveFile(hFile, pszFile, FALSE, status);
+					CloseHandle(hFile);
+				}
+			}
+		}
+	}
+
 	if (bWriteSuccess) {
 		if (!bSaveCopy) {
+			fileTail.size = 0;
 			SciCall_SetSavePoint();
 		}
 		return TRUE;
@@ -1423,68 +2500,371 @@ BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *
 	return FALSE;
 }
 
-void EditReplaceRange(Sci_Position iSelStart, Sci_Position iSelEnd, Sci_Position cchText, LPCSTR pszText) {
-	Sci_Position iCurPos = SciCall_GetCurrentPos();
-	Sci_Position iAnchorPos = SciCall_GetAnchor();
+//=============================================================================
+//
+// EditLoadFileTail()
+//
+// load text appended to the file since it was loaded or last appended, returns FALSE when
+// the file must be reloaded: loaded part of the file changed, or the encoding has states.
+BOOL EditLoadFileTail(LPCWSTR pszFile, int iEncoding) {
+	const UINT uFlags = mEncoding[iEncoding].uFlags;
+	if (fileTail.size == 0 || (uFlags & NCP_7BIT)) {
+		return FALSE;
+	}
 
-	if (iAnchorPos > iCurPos) {
-		iCurPos = iSelStart;
-		iAnchorPos = iSelStart + cchText;
-	} else {
-		iAnchorPos = iSelStart;
-		iCurPos = iSelStart + cchText;
+	HANDLE hFile = CreateFile(pszFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return FALSE;
 	}
 
-	SciCall_BeginUndoAction();
-	SciCall_SetTargetRange(iSelStart, iSelEnd);
-	SciCall_ReplaceTarget(cchText, pszText);
-	SciCall_SetSel(iAnchorPos, iCurPos);
-	SciCall_EndUndoAction();
-}
+	LARGE_INTEGER fileSize;
+	UINT hash = 0;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart < fileTail.size
+		|| fileSize.QuadPart - fileTail.size > EDIT_FILE_TAIL_MAX_APPEND
+		|| !EditFileTail_ReadHash(hFile, fileTail.size, &hash) || hash != fileTail.hash) {
+		CloseHandle(hFile);
+		return FALSE;
+	}
 
-void EditReplaceMainSelection(Sci_Position cchText, LPCSTR pszText) {
-	EditReplaceRange(SciCall_GetSelectionStart(), SciCall_GetSelectionEnd(), cchText, pszText);
+	const DWORD cbAppend = (DWORD)(fileSize.QuadPart - fileTail.size);
+	if (cbAppend == 0) {
+		CloseHandle(hFile);
+		return TRUE;
+	}
+
+	char *lpData = (char *)NP2HeapAlloc(cbAppend + 16);
+	DWORD cbData = 0;
+	if (!ReadFile(hFile, lpData, cbAppend, &cbData, NULL)) {
+		CloseHandle(hFile);
+		NP2HeapFree(lpData);
+		return FALSE;
+	}
+
+	// keep incomplete character or trailing CR for next time
+	const UINT cpFile = (uFlags & NCP_UTF8) ? CP_UTF8 : ((uFlags & NCP_DEFAULT) ? iDefaultCodePage : mEncoding[iEncoding].uCodePage);
+	if (uFlags & NCP_UNICODE) {
+		cbData &= ~1U;
+		if (cbData != 0 && (uFlags & NCP_UNICODE_REVERSE)) {
+			_swab(lpData, lpData, cbData);
+		}
+		if (cbData != 0) {
+			const WCHAR ch = ((const WCHAR *)lpData)[cbData/sizeof(WCHAR) - 1];
+			if (ch == L'\r' || (ch >= 0xD800 && ch <= 0xDBFF)) {
+				cbData -= sizeof(WCHAR);
+			}
+		}
+	} else if (cpFile == CP_UTF8) {
+		cbData -= (cbData == 0) ? 0 : EditGetChunkTailLength((const uint8_t *)lpData, cbData);
+	} else if (IsDBCSCodePage(cpFile) || cpFile == 54936) {
+		// bytes below 0x30 are neither lead nor trail byte, see IsDBCSCodePage().
+		while (cbData != 0 && ((uint8_t)lpData[cbData - 1] >= 0x30 || lpData[cbData - 1] == '\r')) {
+			--cbData;
+		}
+	} else if (cbData != 0 && lpData[cbData - 1] == '\r') {
+		--cbData;
+	}
+	if (cbData != 0) {
+		const LONGLONG size = fileTail.size + cbData;
+		fileTail.size = EditFileTail_ReadHash(hFile, size, &fileTail.hash) ? size : 0;
+	}
+	CloseHandle(hFile);
+	if (cbData == 0) {
+		NP2HeapFree(lpData);
+		return TRUE;
+	}
+
+	char *lpDataUTF8 = lpData;
+	DWORD cbDataUTF8 = cbData;
+	if (uFlags & NCP_UNICODE) {
+		lpDataUTF8 = (char *)NP2HeapAlloc((cbData/sizeof(WCHAR))*kMaxMultiByteCount + 16);
+		BOOL bLossy = FALSE;
+		cbDataUTF8 = (DWORD)UTF16ToUTF8((LPCWSTR)lpData, cbData/sizeof(WCHAR), lpDataUTF8, &bLossy);
+	} else if (cpFile != SciCall_GetCodePage()) {
+		LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
+		const int cchDataWide = MultiByteToWideChar(cpFile, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
+		lpDataUTF8 = (char *)NP2HeapAlloc(cchDataWide * kMaxMultiByteCount + 16);
+		cbDataUTF8 = WideCharToMultiByte(CP_UTF8, 0, lpDataWide, cchDataWide, lpDataUTF8, (int)NP2HeapSize(lpDataUTF8), NULL, NULL);
+		NP2HeapFree(lpDataWide);
+	}
+
+	// only the appended lines are styled, as lexer resumes from end of styled text.
+	SciCall_SetUndoCollection(FALSE);
+	SciCall_AppendText(cbDataUTF8, lpDataUTF8);
+	SciCall_SetUndoCollection(TRUE);
+	SciCall_EmptyUndoBuffer();
+	SciCall_SetSavePoint();
+
+	if (lpDataUTF8 != lpData) {
+		NP2HeapFree(lpDataUTF8);
+	}
+	NP2HeapFree(lpData);
+	return TRUE;
 }
 
 //=============================================================================
 //
-// EditInvertCase()
-//
-void EditInvertCase(void) {
-	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
-	if (iSelCount == 0) {
+// EditPipeSource_Start()
+//
+// text from stdin or a named pipe is read on a dedicated thread, as ReadFile() blocks until the writer
+// outputs more text, each read is posted to the main window and appended to the document.
+#define NP2_PIPE_READ_SIZE		(64*1024)
+// reader waits when the main window is behind by this number of reads.
+#define NP2_PIPE_MAX_PENDING	64
+
+typedef struct PipeSourceChunk {
+	DWORD cbData;
+	char data[4 + NP2_PIPE_READ_SIZE]; // leading bytes for tail of previous read
+} PipeSourceChunk;
+
+typedef struct PipeSource {
+	HWND hwnd;
+	HANDLE hPipe;
+	BOOL bClosePipe;
+	UINT generation;
+	volatile LONG refCount;	// reader thread and main window
+	volatile LONG cancelled;
+	volatile LONG pending;
+	DWORD dwError;
+} PipeSource;
+
+static PipeSource *pipeSource;
+static HANDLE pipeSourceThread;
+static UINT pipeSourceGeneration;
+static BOOL pipeSourceFirst;
+static BOOL pipeSourceCheckUTF8;
+static DWORD pipeSourceTail;
+static char pipeSourceTailBytes[4];
+
+static void PipeSource_Release(PipeSource *source) {
+	if (InterlockedDecrement(&source->refCount) == 0) {
+		if (source->bClosePipe) {
+			CloseHandle(source->hPipe);
+		}
+		NP2HeapFree(source);
+	}
+}
+
+static DWORD WINAPI PipeSourceThread(LPVOID lpParam) {
+	PipeSource *source = (PipeSource *)lpParam;
+	DWORD dwError = ERROR_SUCCESS;
+	while (!source->cancelled) {
+		if (source->pending >= NP2_PIPE_MAX_PENDING) {
+			Sleep(10);
+			continue;
+		}
+
+		PipeSourceChunk *chunk = (PipeSourceChunk *)NP2HeapAlloc(sizeof(PipeSourceChunk));
+		DWORD cbRead = 0;
+		if (!ReadFile(source->hPipe, chunk->data + 4, NP2_PIPE_READ_SIZE, &cbRead, NULL)) {
+			dwError = GetLastError();
+			NP2HeapFree(chunk);
+			break;
+		}
+		if (cbRead == 0) {
+			// end of redirected file, or zero-length message
+			NP2HeapFree(chunk);
+			if (GetFileType(source->hPipe) != FILE_TYPE_PIPE) {
+				break;
+			}
+			continue;
+		}
+
+		chunk->cbData = cbRead;
+		InterlockedIncrement(&source->pending);
+		if (!PostMessage(source->hwnd, APPM_PIPESOURCE, source->generation, (LPARAM)chunk)) {
+			InterlockedDecrement(&source->pending);
+			NP2HeapFree(chunk);
+		}
+	}
+
+	// writer closed the pipe
+	if (dwError == ERROR_BROKEN_PIPE || dwError == ERROR_PIPE_NOT_CONNECTED) {
+		dwError = ERROR_SUCCESS;
+	}
+	source->dwError = dwError;
+	PostMessage(source->hwnd, APPM_PIPESOURCE, source->generation, 0);
+	PipeSource_Release(source);
+	return 0;
+}
+
+BOOL EditPipeSource_Start(HWND hwnd, HANDLE hPipe, BOOL bClosePipe, BOOL bCheckUTF8) {
+	EditPipeSource_Stop();
+
+	PipeSource *source = (PipeSource *)NP2HeapAlloc(sizeof(PipeSource));
+	source->hwnd = hwnd;
+	source->hPipe = hPipe;
+	source->bClosePipe = bClosePipe;
+	source->generation = ++pipeSourceGeneration;
+	source->refCount = 2;
+
+	HANDLE hThread = CreateThread(NULL, 0, PipeSourceThread, source, 0, NULL);
+	if (hThread == NULL) {
+		// pipe is closed by caller
+		dwLastIOError = GetLastError();
+		NP2HeapFree(source);
+		return FALSE;
+	}
+
+	pipeSource = source;
+	pipeSourceThread = hThread;
+	pipeSourceFirst = TRUE;
+	pipeSourceCheckUTF8 = bCheckUTF8;
+	pipeSourceTail = 0;
+	return TRUE;
+}
+
+void EditPipeSource_Stop(void) {
+	PipeSource *source = pipeSource;
+	if (source == NULL) {
 		return;
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+
+	pipeSource = NULL;
+	InterlockedExchange(&source->cancelled, TRUE);
+	// abort pending ReadFile() on the reader thread, since Windows Vista.
+	// the thread is left running when it's still blocked, it releases the source on exit.
+	for (int retry = 0; retry < 10; retry++) {
+#if _WIN32_WINNT >= _WIN32_WINNT_VISTA
+		CancelSynchronousIo(pipeSourceThread);
+#else
+		typedef BOOL (WINAPI *CancelSynchronousIoSig)(HANDLE hThread);
+		CancelSynchronousIoSig pfnCancelSynchronousIo =
+			DLLFunctionEx(CancelSynchronousIoSig, L"kernel32.dll", "CancelSynchronousIo");
+		if (pfnCancelSynchronousIo) {
+			pfnCancelSynchronousIo(pipeSourceThread);
+		}
+#endif
+		if (WaitForSingleObject(pipeSourceThread, 20) == WAIT_OBJECT_0) {
+			break;
+		}
+	}
+	CloseHandle(pipeSourceThread);
+	pipeSourceThread = NULL;
+	PipeSource_Release(source);
+
+	MSG msg;
+	while (PeekMessage(&msg, NULL, APPM_PIPESOURCE, APPM_PIPESOURCE, PM_REMOVE)) {
+		if (msg.lParam) {
+			NP2HeapFree((PipeSourceChunk *)msg.lParam);
+		}
+	}
+}
+
+BOOL EditPipeSource_IsActive(void) {
+	return pipeSource != NULL;
+}
+
+static void EditPipeSource_Append(const char *lpData, DWORD cbData, UINT *state, BOOL bSavePoint) {
+	const Sci_Position length = SciCall_GetLength();
+#if defined(_WIN64)
+	if (length + cbData >= (Sci_Position)MAX_NON_UTF8_SIZE) {
+		EditConvertToLargeMode();
+	}
+#else
+	if (length + cbData >= (Sci_Position)MAX_NON_UTF8_SIZE) {
+		*state |= PipeSourceState_Failed;
 		return;
 	}
+#endif
 
-	char *pszText = (char *)NP2HeapAlloc(iSelCount*kMaxMultiByteCount + 1);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
+	// caret at end of document follows the output
+	const BOOL bIsTail = SciCall_GetCurrentPos() == length && SciCall_GetAnchor() == length;
+	// undo history is kept as text is only inserted after it.
+	SciCall_SetUndoCollection(FALSE);
+	SciCall_AppendText(cbData, lpData);
+	SciCall_SetUndoCollection(TRUE);
+	if (bSavePoint) {
+		SciCall_SetSavePoint();
+	}
+	if (bIsTail) {
+		SciCall_DocumentEnd();
+	}
+	*state |= PipeSourceState_Data;
+}
 
-	SciCall_GetSelText(pszText);
-	const UINT cpEdit = SciCall_GetCodePage();
-	const int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
+// returns PipeSourceState flags, stale messages for previous source are discarded.
+UINT EditPipeSource_OnData(WPARAM wParam, LPARAM lParam, BOOL bSavePoint) {
+	PipeSource * const source = pipeSource;
+	PipeSourceChunk * const chunk = (PipeSourceChunk *)lParam;
+	if (source == NULL || (UINT)wParam != source->generation) {
+		if (chunk != NULL) {
+			NP2HeapFree(chunk);
+		}
+		return PipeSourceState_None;
+	}
 
-	BOOL bChanged = FALSE;
-	for (int i = 0; i < cchTextW; i++) {
-		if (IsCharUpper(pszTextW[i])) {
-			pszTextW[i] = LOWORD(CharLower((LPWSTR)(LONG_PTR)MAKELONG(pszTextW[i], 0)));
-			bChanged = TRUE;
-		} else if (IsCharLower(pszTextW[i])) {
-			pszTextW[i] = LOWORD(CharUpper((LPWSTR)(LONG_PTR)MAKELONG(pszTextW[i], 0)));
-			bChanged = TRUE;
+	UINT state = PipeSourceState_None;
+	if (chunk == NULL) {
+		// flush incomplete character or trailing CR
+		if (pipeSourceTail != 0) {
+			EditPipeSource_Append(pipeSourceTailBytes, pipeSourceTail, &state, bSavePoint);
 		}
+		dwLastIOError = source->dwError;
+		state |= (source->dwError == ERROR_SUCCESS) ? PipeSourceState_Finished : PipeSourceState_Failed;
+		pipeSource = NULL;
+		WaitForSingleObject(pipeSourceThread, INFINITE);
+		CloseHandle(pipeSourceThread);
+		pipeSourceThread = NULL;
+		PipeSource_Release(source);
+		return state;
 	}
 
-	if (bChanged) {
-		const int cchText = WideCharToMultiByte(cpEdit, 0, pszTextW, cchTextW, pszText, (int)NP2HeapSize(pszText), NULL, NULL);
-		EditReplaceMainSelection(cchText, pszText);
+	InterlockedDecrement(&source->pending);
+	char *lpData = chunk->data + 4 - pipeSourceTail;
+	memcpy(lpData, pipeSourceTailBytes, pipeSourceTail);
+	DWORD cbData = pipeSourceTail + chunk->cbData;
+	pipeSourceTail = EditGetChunkTailLength((const uint8_t *)lpData, cbData);
+	cbData -= pipeSourceTail;
+	memcpy(pipeSourceTailBytes, lpData + cbData, pipeSourceTail);
+
+	if (pipeSourceFirst && cbData != 0) {
+		pipeSourceFirst = FALSE;
+		if (cbData >= 3 && IsUTF8Signature(lpData) && SciCall_GetCodePage() == SC_CP_UTF8) {
+			lpData += 3;
+			cbData -= 3;
+			pipeSourceCheckUTF8 = FALSE;
+			state |= PipeSourceState_BOM;
+		}
+	}
+	if (pipeSourceCheckUTF8 && cbData != 0 && !IsUTF8(lpData, cbData)) {
+		// text already appended is shown in ANSI code page, same as streaming load.
+		pipeSourceCheckUTF8 = FALSE;
+		SciCall_SetCodePage(iDefaultCodePage);
+		state |= PipeSourceState_ANSI;
+	}
+	if (cbData != 0) {
+		EditPipeSource_Append(lpData, cbData, &state, bSavePoint);
+	}
+	NP2HeapFree(chunk);
+	if (state & PipeSourceState_Failed) {
+		dwLastIOError = ERROR_FILE_TOO_LARGE;
+		EditPipeSource_Stop();
 	}
+	return state;
+}
 
-	NP2HeapFree(pszText);
-	NP2HeapFree(pszTextW);
+void EditReplaceRange(Sci_Position iSelStart, Sci_Position iSelEnd, Sci_Position cchText, LPCSTR pszText) {
+	Sci_Position iCurPos = SciCall_GetCurrentPos();
+	Sci_Position iAnchorPos = SciCall_GetAnchor();
+
+	if (iAnchorPos > iCurPos) {
+		iCurPos = iSelStart;
+		iAnchorPos = iSelStart + cchText;
+	} else {
+		iAnchorPos = iSelStart;
+		iCurPos = iSelStart + cchText;
+	}
+
+	SciCall_BeginUndoAction();
+	SciCall_SetTargetRange(iSelStart, iSelEnd);
+	SciCall_ReplaceTarget(cchText, pszText);
+	SciCall_SetSel(iAnchorPos, iCurPos);
+	SciCall_EndUndoAction();
+}
+
+void EditReplaceMainSelection(Sci_Position cchText, LPCSTR pszText) {
+	EditReplaceRange(SciCall_GetSelectionStart(), SciCall_GetSelectionEnd(), cchText, pszText);
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/intl/transliteration-services
@@ -1525,18 +2905,27 @@ static const GUID ELS_GUID_TRANSLITERATION_BENGALI_TO_LATIN =
 static const GUID WIN10_ELS_GUID_TRANSLITERATION_HANGUL_DECOMPOSITION =
 	{ 0x4BA2A721, 0xE43D, 0x41b7, { 0xB3, 0x30, 0x53, 0x6A, 0xE1, 0xE4, 0x88, 0x63 } };
 
-static int TransliterateText(const GUID *pGuid, LPCWSTR pszTextW, int cchTextW, LPWSTR *pszMappedW) {
 #if NP2_DYNAMIC_LOAD_ELSCORE_DLL
 typedef HRESULT (WINAPI *MappingGetServicesSig)(PMAPPING_ENUM_OPTIONS pOptions, PMAPPING_SERVICE_INFO *prgServices, DWORD *pdwServicesCount);
 typedef HRESULT (WINAPI *MappingFreeServicesSig)(PMAPPING_SERVICE_INFO pServiceInfo);
 typedef HRESULT (WINAPI *MappingRecognizeTextSig)(PMAPPING_SERVICE_INFO pServiceInfo, LPCWSTR pszText, DWORD dwLength, DWORD dwIndex, PMAPPING_OPTIONS pOptions, PMAPPING_PROPERTY_BAG pbag);
 typedef HRESULT (WINAPI *MappingFreePropertyBagSig)(PMAPPING_PROPERTY_BAG pBag);
 
+static MappingGetServicesSig pfnMappingGetServices;
+static MappingFreeServicesSig pfnMappingFreeServices;
+static MappingRecognizeTextSig pfnMappingRecognizeText;
+static MappingFreePropertyBagSig pfnMappingFreePropertyBag;
+#else
+#define pfnMappingGetServices		MappingGetServices
+#define pfnMappingFreeServices		MappingFreeServices
+#define pfnMappingRecognizeText		MappingRecognizeText
+#define pfnMappingFreePropertyBag	MappingFreePropertyBag
+#endif
+
+// service is queried once and shared by all chunk threads, see EditMapTextChunks().
+static PMAPPING_SERVICE_INFO GetTransliterationService(const GUID *pGuid) {
+#if NP2_DYNAMIC_LOAD_ELSCORE_DLL
 	static int triedLoadingELSCore = 0;
-	static MappingGetServicesSig pfnMappingGetServices;
-	static MappingFreeServicesSig pfnMappingFreeServices;
-	static MappingRecognizeTextSig pfnMappingRecognizeText;
-	static MappingFreePropertyBagSig pfnMappingFreePropertyBag;
 
 	if (triedLoadingELSCore == 0) {
 		triedLoadingELSCore = 1;
@@ -1549,13 +2938,13 @@ typedef HRESULT (WINAPI *MappingFreePropertyBagSig)(PMAPPING_PROPERTY_BAG pBag);
 			if (pfnMappingGetServices == NULL || pfnMappingFreeServices == NULL || pfnMappingRecognizeText == NULL || pfnMappingFreePropertyBag == NULL) {
 				FreeLibrary(hELSCoreDLL);
 				hELSCoreDLL = NULL;
-				return 0;
+				return NULL;
 			}
 			triedLoadingELSCore = 2;
 		}
 	}
 	if (triedLoadingELSCore != 2) {
-		return 0;
+		return NULL;
 	}
 #endif
 
@@ -1567,44 +2956,35 @@ typedef HRESULT (WINAPI *MappingFreePropertyBagSig)(PMAPPING_PROPERTY_BAG pBag);
 	enumOptions.Size = sizeof(MAPPING_ENUM_OPTIONS);
 	enumOptions.pGuid = (GUID *)pGuid;
 
-#if NP2_DYNAMIC_LOAD_ELSCORE_DLL
-	HRESULT hr = pfnMappingGetServices(&enumOptions, &prgServices, &dwServicesCount);
-#else
-	HRESULT hr = MappingGetServices(&enumOptions, &prgServices, &dwServicesCount);
-#endif
-	dwServicesCount = 0;
+	const HRESULT hr = pfnMappingGetServices(&enumOptions, &prgServices, &dwServicesCount);
+	return SUCCEEDED(hr) ? prgServices : NULL;
+}
+
+static int TransliterateText(PMAPPING_SERVICE_INFO prgServices, LPCWSTR pszTextW, int cchTextW, LPWSTR *pszMappedW) {
+	int cchMappedW = 0;
+	MAPPING_PROPERTY_BAG bag;
+	ZeroMemory(&bag, sizeof (MAPPING_PROPERTY_BAG));
+	bag.Size = sizeof (MAPPING_PROPERTY_BAG);
+	const HRESULT hr = pfnMappingRecognizeText(prgServices, pszTextW, cchTextW, 0, NULL, &bag);
 	if (SUCCEEDED(hr)) {
-		MAPPING_PROPERTY_BAG bag;
-		ZeroMemory(&bag, sizeof (MAPPING_PROPERTY_BAG));
-		bag.Size = sizeof (MAPPING_PROPERTY_BAG);
-#if NP2_DYNAMIC_LOAD_ELSCORE_DLL
-		hr = pfnMappingRecognizeText(prgServices, pszTextW, cchTextW, 0, NULL, &bag);
-#else
-		hr = MappingRecognizeText(prgServices, pszTextW, cchTextW, 0, NULL, &bag);
-#endif
-		if (SUCCEEDED(hr)) {
-			const DWORD dwDataSize = bag.prgResultRanges[0].dwDataSize;
-			dwServicesCount = dwDataSize/sizeof(WCHAR);
-			pszTextW = (LPCWSTR)bag.prgResultRanges[0].pData;
-			if (dwServicesCount != 0 && pszTextW[0] != L'\0') {
-				LPWSTR pszConvW = (LPWSTR)NP2HeapAlloc(dwDataSize + sizeof(WCHAR));
-				CopyMemory(pszConvW, pszTextW, dwDataSize);
+		LPCWSTR pszDataW = (LPCWSTR)bag.prgResultRanges[0].pData;
+		cchMappedW = bag.prgResultRanges[0].dwDataSize/sizeof(WCHAR);
+		// result may have terminating NUL, which must not be inserted for every chunk
+		if (cchMappedW != 0 && pszDataW[cchMappedW - 1] == L'\0' && pszTextW[cchTextW - 1] != L'\0') {
+			--cchMappedW;
+		}
+		if (cchMappedW != 0) {
+			LPWSTR pszConvW = (LPWSTR)NP2HeapAlloc((cchMappedW + 1)*sizeof(WCHAR));
+			if (pszConvW != NULL) {
+				CopyMemory(pszConvW, pszDataW, cchMappedW*sizeof(WCHAR));
 				*pszMappedW = pszConvW;
+			} else {
+				cchMappedW = 0;
 			}
-#if NP2_DYNAMIC_LOAD_ELSCORE_DLL
-			pfnMappingFreePropertyBag(&bag);
-#else
-			MappingFreePropertyBag(&bag);
-#endif
 		}
-#if NP2_DYNAMIC_LOAD_ELSCORE_DLL
-		pfnMappingFreeServices(prgServices);
-#else
-		MappingFreeServices(prgServices);
-#endif
+		pfnMappingFreePropertyBag(&bag);
 	}
-
-	return dwServicesCount;
+	return cchMappedW;
 }
 
 #if _WIN32_WINNT < _WIN32_WINNT_WIN7
@@ -1669,135 +3049,208 @@ static BOOL EditTitleCase(LPWSTR pszTextW, int cchTextW) {
 
 //=============================================================================
 //
-// EditMapTextCase()
+// EditMapTextChunks()
 //
-void EditMapTextCase(int menu) {
-	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
-	if (iSelCount == 0) {
-		return;
+// selection is mapped in chunks that end after line break or separator (on character boundary
+// when there is none), so each chunk starts in initial state of the mapping and its length fits in int.
+#define TEXT_MAP_CHUNK_SIZE			(1024*1024)
+// larger selection is mapped on all processors, Escape key cancels the mapping.
+#define TEXT_MAP_PARALLEL_MIN_SIZE	(4*1024*1024)
+
+enum {
+	TextMap_InvertCase,
+	TextMap_SentenceCase,
+	TextMap_TitleCase,
+	TextMap_LCMap,		// transliteration service or LCMapString() with flags
+};
+
+typedef struct TextMapChunk {
+	Sci_Position offset;
+	Sci_Position length;
+	char *lpOut;		// NULL when chunk is not changed
+	int cbOut;
+} TextMapChunk;
+
+typedef struct TextMapWorker {
+	BackgroundWorker worker;
+	const char *pszText;
+	TextMapChunk *chunks;
+	DWORD chunkCount;
+	volatile LONG nextChunk;
+	UINT cpEdit;
+	int mapping;
+	DWORD flags;
+	PMAPPING_SERVICE_INFO prgServices;
+	BOOL bFailed;
+	BOOL bCancelled;
+} TextMapWorker;
+
+// find first ch1 or ch2 in [ptr, end), return end when not found.
+static const char *FindEitherChar(const char *ptr, const char *end, char ch1, char ch2) {
+#if NP2_USE_AVX2
+	const __m256i vect1 = _mm256_set1_epi8(ch1);
+	const __m256i vect2 = _mm256_set1_epi8(ch2);
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+		const uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vect1), _mm256_cmpeq_epi8(chunk, vect2)));
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m256i);
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+#elif NP2_USE_SSE2
+	const __m128i vect1 = _mm_set1_epi8(ch1);
+	const __m128i vect2 = _mm_set1_epi8(ch2);
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		const uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, vect1), _mm_cmpeq_epi8(chunk, vect2)));
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m128i);
 	}
-
-	DWORD flags = 0;
-	const GUID *pGuid = NULL;
-	switch (menu) {
-	case IDM_EDIT_TITLECASE:
-		flags = IsWin7AndAbove() ? (LCMAP_LINGUISTIC_CASING | LCMAP_TITLECASE) : 0;
-		break;
-	case IDM_EDIT_MAP_FULLWIDTH:
-		flags = LCMAP_FULLWIDTH;
-		break;
-	case IDM_EDIT_MAP_HALFWIDTH:
-		flags = LCMAP_HALFWIDTH;
-		break;
-	case IDM_EDIT_MAP_SIMPLIFIED_CHINESE:
-		flags = LCMAP_SIMPLIFIED_CHINESE;
-		pGuid = &ELS_GUID_TRANSLITERATION_HANT_TO_HANS;
-		break;
-	case IDM_EDIT_MAP_TRADITIONAL_CHINESE:
-		flags = LCMAP_TRADITIONAL_CHINESE;
-		pGuid = &ELS_GUID_TRANSLITERATION_HANS_TO_HANT;
-		break;
-	case IDM_EDIT_MAP_HIRAGANA:
-		flags = LCMAP_HIRAGANA;
-		break;
-	case IDM_EDIT_MAP_KATAKANA:
-		flags = LCMAP_KATAKANA;
-		break;
-	case IDM_EDIT_MAP_MALAYALAM_LATIN:
-		pGuid = &ELS_GUID_TRANSLITERATION_MALAYALAM_TO_LATIN;
-		break;
-	case IDM_EDIT_MAP_DEVANAGARI_LATIN:
-		pGuid = &ELS_GUID_TRANSLITERATION_DEVANAGARI_TO_LATIN;
-		break;
-	case IDM_EDIT_MAP_CYRILLIC_LATIN:
-		pGuid = &ELS_GUID_TRANSLITERATION_CYRILLIC_TO_LATIN;
-		break;
-	case IDM_EDIT_MAP_BENGALI_LATIN:
-		pGuid = &ELS_GUID_TRANSLITERATION_BENGALI_TO_LATIN;
-		break;
-	case IDM_EDIT_MAP_HANGUL_DECOMPOSITION:
-		pGuid = &WIN10_ELS_GUID_TRANSLITERATION_HANGUL_DECOMPOSITION;
-		break;
-	default:
-		NP2_unreachable();
+#endif
+	while (ptr < end && *ptr != ch1 && *ptr != ch2) {
+		++ptr;
 	}
+	return ptr;
+}
 
-	char *pszText = (char *)NP2HeapAlloc(iSelCount*kMaxMultiByteCount + 1);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
-
-	SciCall_GetSelText(pszText);
-	const UINT cpEdit = SciCall_GetCodePage();
-	int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
+static Sci_Position GetTextMapChunkEnd(const char *pszText, Sci_Position start, Sci_Position length, UINT cpEdit, char separator) {
+	Sci_Position offset = start + TEXT_MAP_CHUNK_SIZE;
+	if (offset >= length) {
+		return length;
+	}
 
-	BOOL bChanged = FALSE;
-	if (flags != 0 || pGuid != NULL) {
-		int charsConverted = 0;
-		LPWSTR pszMappedW = NULL;
-		if (pGuid != NULL && IsWin7AndAbove()) {
-			charsConverted = TransliterateText(pGuid, pszTextW, cchTextW, &pszMappedW);
+	const char *end = pszText + min_pos(length, offset + TEXT_MAP_CHUNK_SIZE);
+	const char *ptr = FindEitherChar(pszText + offset, end, '\n', separator);
+	if (ptr != end) {
+		// ASCII punctuation is not DBCS trail byte
+		return ptr + 1 - pszText;
+	}
+	if (cpEdit == SC_CP_UTF8) {
+		while (offset < length && ((uint8_t)pszText[offset] & 0xC0) == 0x80) {
+			++offset;
 		}
-		if (pszMappedW == NULL && flags != 0) {
-			charsConverted = LCMapString(LOCALE_USER_DEFAULT, flags, pszTextW, cchTextW, NULL, 0);
-			if (charsConverted) {
-				pszMappedW = (LPWSTR)NP2HeapAlloc((charsConverted + 1)*sizeof(WCHAR));
-				charsConverted = LCMapString(LOCALE_USER_DEFAULT, flags, pszTextW, cchTextW, pszMappedW, charsConverted);
-			}
+	} else if (cpEdit != 0) {
+		Sci_Position pos = start;
+		while (pos < offset) {
+			pos += IsDBCSLeadByteEx(cpEdit, (uint8_t)pszText[pos]) ? 2 : 1;
 		}
+		offset = min_pos(pos, length);
+	}
+	return offset;
+}
 
-		bChanged = !(charsConverted == 0 || StrIsEmpty(pszMappedW) || StrEqual(pszTextW, pszMappedW));
-		if (bChanged) {
-			NP2HeapFree(pszTextW);
-			pszTextW = pszMappedW;
-			cchTextW = charsConverted;
-			if (charsConverted > iSelCount) {
-				NP2HeapFree(pszText);
-				pszText = (char *)NP2HeapAlloc(charsConverted*kMaxMultiByteCount + 1);
-			}
-		} else if (pszMappedW != NULL) {
-			NP2HeapFree(pszMappedW);
+static BOOL IsASCIIChunk(const char *ptr, const char *end) {
+#if NP2_USE_AVX2
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+		if (_mm256_movemask_epi8(chunk) != 0) {
+			return FALSE;
 		}
+		ptr += sizeof(__m256i);
 	}
-
-#if _WIN32_WINNT < _WIN32_WINNT_WIN7
-	else if (menu == IDM_EDIT_TITLECASE) {
-		bChanged = EditTitleCase(pszTextW, cchTextW);
+#elif NP2_USE_SSE2
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		if (_mm_movemask_epi8(chunk) != 0) {
+			return FALSE;
+		}
+		ptr += sizeof(__m128i);
 	}
 #endif
-
-	if (bChanged) {
-		const int cchText = WideCharToMultiByte(cpEdit, 0, pszTextW, cchTextW, pszText, (int)NP2HeapSize(pszText), NULL, NULL);
-		EditReplaceMainSelection(cchText, pszText);
+	while (ptr < end) {
+		if ((uint8_t)(*ptr++) & 0x80) {
+			return FALSE;
+		}
 	}
-
-	NP2HeapFree(pszText);
-	NP2HeapFree(pszTextW);
+	return TRUE;
 }
 
-//=============================================================================
-//
-// EditSentenceCase()
-//
-void EditSentenceCase(void) {
-	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
-	if (iSelCount == 0) {
-		return;
+// toggle case of ASCII letters, returns FALSE when no letter found.
+static BOOL InvertCaseASCII(const char *ptr, const char *end, char *out) {
+	uint32_t changed = 0;
+#if NP2_USE_AVX2
+	const __m256i vectCase = _mm256_set1_epi8(0x20);
+	const __m256i vectA = _mm256_set1_epi8('A' - 1);
+	const __m256i vectZ = _mm256_set1_epi8('Z' + 1);
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+		// fold lower case letters, then check for 'A' to 'Z'
+		const __m256i upper = _mm256_andnot_si256(vectCase, chunk);
+		const __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi8(upper, vectA), _mm256_cmpgt_epi8(vectZ, upper));
+		_mm256_storeu_si256((__m256i *)out, _mm256_xor_si256(chunk, _mm256_and_si256(mask, vectCase)));
+		changed |= _mm256_movemask_epi8(mask);
+		ptr += sizeof(__m256i);
+		out += sizeof(__m256i);
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+#elif NP2_USE_SSE2
+	const __m128i vectCase = _mm_set1_epi8(0x20);
+	const __m128i vectA = _mm_set1_epi8('A' - 1);
+	const __m128i vectZ = _mm_set1_epi8('Z' + 1);
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		// fold lower case letters, then check for 'A' to 'Z'
+		const __m128i upper = _mm_andnot_si128(vectCase, chunk);
+		const __m128i mask = _mm_and_si128(_mm_cmpgt_epi8(upper, vectA), _mm_cmplt_epi8(upper, vectZ));
+		_mm_storeu_si128((__m128i *)out, _mm_xor_si128(chunk, _mm_and_si128(mask, vectCase)));
+		changed |= _mm_movemask_epi8(mask);
+		ptr += sizeof(__m128i);
+		out += sizeof(__m128i);
+	}
+#endif
+	while (ptr < end) {
+		const char ch = *ptr++;
+		if (IsAlpha(ch)) {
+			*out++ = ch ^ 0x20;
+			changed = TRUE;
+		} else {
+			*out++ = ch;
+		}
 	}
+	return changed != 0;
+}
 
-	char *pszText = (char *)NP2HeapAlloc(iSelCount*kMaxMultiByteCount + 1);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
+static BOOL SentenceCaseASCII(const char *ptr, const char *end, char *out) {
+	BOOL bNewSentence = TRUE;
+	BOOL bChanged = FALSE;
+	while (ptr < end) {
+		char ch = *ptr++;
+		if (ch == '.' || ch == ';' || ch == '!' || ch == '?' || ch == '\r' || ch == '\n') {
+			bNewSentence = TRUE;
+		} else if (IsAlphaNumeric(ch)) {
+			if (bNewSentence) {
+				if (IsLowerCase(ch)) {
+					ch -= 'a' - 'A';
+					bChanged = TRUE;
+				}
+				bNewSentence = FALSE;
+			} else if (IsUpperCase(ch)) {
+				ch += 'a' - 'A';
+				bChanged = TRUE;
+			}
+		}
+		*out++ = ch;
+	}
+	return bChanged;
+}
 
-	SciCall_GetSelText(pszText);
-	const UINT cpEdit = SciCall_GetCodePage();
-	const int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
+static BOOL InvertCaseW(LPWSTR pszTextW, int cchTextW) {
+	BOOL bChanged = FALSE;
+	for (int i = 0; i < cchTextW; i++) {
+		if (IsCharUpper(pszTextW[i])) {
+			pszTextW[i] = LOWORD(CharLower((LPWSTR)(LONG_PTR)MAKELONG(pszTextW[i], 0)));
+			bChanged = TRUE;
+		} else if (IsCharLower(pszTextW[i])) {
+			pszTextW[i] = LOWORD(CharUpper((LPWSTR)(LONG_PTR)MAKELONG(pszTextW[i], 0)));
+			bChanged = TRUE;
+		}
+	}
+	return bChanged;
+}
 
+static BOOL SentenceCaseW(LPWSTR pszTextW, int cchTextW) {
 	BOOL bNewSentence = TRUE;
 	BOOL bChanged = FALSE;
 	for (int i = 0; i < cchTextW; i++) {
@@ -1821,94 +3274,139 @@ void EditSentenceCase(void) {
 			}
 		}
 	}
+	return bChanged;
+}
 
-	if (bChanged) {
-		const int cchText = WideCharToMultiByte(cpEdit, 0, pszTextW, cchTextW, pszText, (int)NP2HeapSize(pszText), NULL, NULL);
-		EditReplaceMainSelection(cchText, pszText);
-	}
+// returns mapped text (pszTextW when mapped in place) or NULL when text is not changed.
+static LPWSTR EditMapTextW(const TextMapWorker *worker, LPWSTR pszTextW, int *pcchTextW) {
+	const int cchTextW = *pcchTextW;
+	switch (worker->mapping) {
+	case TextMap_InvertCase:
+		return InvertCaseW(pszTextW, cchTextW) ? pszTextW : NULL;
 
-	NP2HeapFree(pszText);
-	NP2HeapFree(pszTextW);
-}
+	case TextMap_SentenceCase:
+		return SentenceCaseW(pszTextW, cchTextW) ? pszTextW : NULL;
 
-#ifndef URL_ESCAPE_AS_UTF8		// (NTDDI_VERSION >= NTDDI_WIN7)
-#define URL_ESCAPE_AS_UTF8		0x00040000
-#endif
-#ifndef URL_UNESCAPE_AS_UTF8	// (NTDDI_VERSION >= NTDDI_WIN8)
-#define URL_UNESCAPE_AS_UTF8	URL_ESCAPE_AS_UTF8
+#if _WIN32_WINNT < _WIN32_WINNT_WIN7
+	case TextMap_TitleCase:
+		return EditTitleCase(pszTextW, cchTextW) ? pszTextW : NULL;
 #endif
 
-//=============================================================================
-//
-// EditURLEncode()
-//
-LPWSTR EditURLEncodeSelection(int *pcchEscaped) {
-	*pcchEscaped = 0;
-	const Sci_Position iSelCount = SciCall_GetSelTextLength();
-	if (iSelCount <= 1) {
-		return NULL;
+	case TextMap_LCMap: {
+		int charsConverted = 0;
+		LPWSTR pszMappedW = NULL;
+		if (worker->prgServices != NULL) {
+			charsConverted = TransliterateText(worker->prgServices, pszTextW, cchTextW, &pszMappedW);
+		}
+		if (pszMappedW == NULL && worker->flags != 0) {
+			charsConverted = LCMapString(LOCALE_USER_DEFAULT, worker->flags, pszTextW, cchTextW, NULL, 0);
+			if (charsConverted) {
+				pszMappedW = (LPWSTR)NP2HeapAlloc((charsConverted + 1)*sizeof(WCHAR));
+				if (pszMappedW != NULL) {
+					charsConverted = LCMapString(LOCALE_USER_DEFAULT, worker->flags, pszTextW, cchTextW, pszMappedW, charsConverted);
+				}
+			}
+		}
+		if (pszMappedW != NULL) {
+			if (charsConverted != 0 && !(charsConverted == cchTextW && memcmp(pszTextW, pszMappedW, cchTextW*sizeof(WCHAR)) == 0)) {
+				*pcchTextW = charsConverted;
+				return pszMappedW;
+			}
+			NP2HeapFree(pszMappedW);
+		}
+	} break;
 	}
+	return NULL;
+}
 
-	char *pszText = (char *)NP2HeapAlloc(iSelCount);
-	SciCall_GetSelText(pszText);
-
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc(iSelCount * sizeof(WCHAR));
-	const UINT cpEdit = SciCall_GetCodePage();
-	MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
-	NP2HeapFree(pszText);
-	// TODO: trim all C0 and C1 control characters.
-	StrTrim(pszTextW, L" \a\b\f\n\r\t\v");
-	if (StrIsEmpty(pszTextW)) {
-		NP2HeapFree(pszTextW);
-		return NULL;
-	}
+static void EditMapTextChunk(TextMapWorker *worker, TextMapChunk *chunk) {
+	const char *pszText = worker->pszText + chunk->offset;
+	const int cchText = (int)chunk->length;
 
-	// https://docs.microsoft.com/en-us/windows/desktop/api/shlwapi/nf-shlwapi-urlescapew
-	LPWSTR pszEscapedW = (LPWSTR)NP2HeapAlloc(NP2HeapSize(pszTextW) * kMaxMultiByteCount * 3); // '&', H1, H0
+	if (IsASCIIChunk(pszText, pszText + cchText)) {
+		switch (worker->mapping) {
+		case TextMap_InvertCase:
+		case TextMap_SentenceCase: {
+			char *lpOut = (char *)NP2HeapAlloc(cchText + 1);
+			if (lpOut == NULL) {
+				worker->bFailed = TRUE;
+				return;
+			}
+			const BOOL bChanged = (worker->mapping == TextMap_InvertCase)
+				? InvertCaseASCII(pszText, pszText + cchText, lpOut)
+				: SentenceCaseASCII(pszText, pszText + cchText, lpOut);
+			if (bChanged) {
+				chunk->lpOut = lpOut;
+				chunk->cbOut = cchText;
+			} else {
+				NP2HeapFree(lpOut);
+			}
+		} return;
 
-	DWORD cchEscapedW = (int)NP2HeapSize(pszEscapedW) / sizeof(WCHAR);
-	UrlEscape(pszTextW, pszEscapedW, &cchEscapedW, URL_ESCAPE_AS_UTF8);
-	if (!IsWin7AndAbove()) {
-		// TODO: encode some URL parts as UTF-8 then percent-escape these UTF-8 bytes.
-		//ParseURL(pszEscapedW, &ppu);
+		case TextMap_LCMap:
+			// only full width and title case mapping change ASCII characters
+			if ((worker->flags & (LCMAP_FULLWIDTH | LCMAP_TITLECASE)) == 0) {
+				return;
+			}
+			break;
+		}
 	}
 
-	NP2HeapFree(pszTextW);
-	*pcchEscaped = cchEscapedW;
-	return pszEscapedW;
-}
-
-void EditURLEncode(void) {
-	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
-	if (iSelCount == 0) {
+	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((cchText + 1)*sizeof(WCHAR));
+	if (pszTextW == NULL) {
+		worker->bFailed = TRUE;
 		return;
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+
+	const UINT cpEdit = worker->cpEdit;
+	int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, cchText, pszTextW, cchText);
+	LPWSTR pszMappedW = EditMapTextW(worker, pszTextW, &cchTextW);
+	if (pszMappedW != NULL) {
+		const int cbOut = WideCharToMultiByte(cpEdit, 0, pszMappedW, cchTextW, NULL, 0, NULL, NULL);
+		char *lpOut = (char *)NP2HeapAlloc(cbOut + 1);
+		if (lpOut != NULL) {
+			chunk->cbOut = WideCharToMultiByte(cpEdit, 0, pszMappedW, cchTextW, lpOut, cbOut, NULL, NULL);
+			chunk->lpOut = lpOut;
+		} else {
+			worker->bFailed = TRUE;
+		}
+		if (pszMappedW != pszTextW) {
+			NP2HeapFree(pszMappedW);
+		}
 	}
+	NP2HeapFree(pszTextW);
+}
 
-	int cchEscapedW;
-	LPWSTR pszEscapedW = EditURLEncodeSelection(&cchEscapedW);
-	if (pszEscapedW == NULL) {
-		return;
+static DWORD WINAPI EditMapTextThread(LPVOID lpParam) {
+	TextMapWorker *worker = (TextMapWorker *)lpParam;
+	while (BackgroundWorker_Continue(&worker->worker)) {
+		const DWORD index = (DWORD)InterlockedIncrement(&worker->nextChunk) - 1;
+		if (index >= worker->chunkCount) {
+			break;
+		}
+		EditMapTextChunk(worker, &worker->chunks[index]);
 	}
+	return 0;
+}
 
-	const UINT cpEdit = SciCall_GetCodePage();
-	char *pszEscaped = (char *)NP2HeapAlloc(cchEscapedW * kMaxMultiByteCount);
-	const int cchEscaped = WideCharToMultiByte(cpEdit, 0, pszEscapedW, cchEscapedW, pszEscaped, (int)NP2HeapSize(pszEscaped), NULL, NULL);
-	EditReplaceMainSelection(cchEscaped, pszEscaped);
+static DWORD WINAPI EditMapTextDispatchThread(LPVOID lpParam) {
+	TextMapWorker *worker = (TextMapWorker *)lpParam;
+	RunOnAllProcessors(EditMapTextThread, worker, worker->chunkCount);
+	return 0;
+}
 
-	NP2HeapFree(pszEscaped);
-	NP2HeapFree(pszEscapedW);
+static void EditMapTextCancel(LPVOID lpParam) {
+	TextMapWorker *worker = (TextMapWorker *)lpParam;
+	if (!worker->bCancelled) {
+		worker->bCancelled = TRUE;
+		SetEvent(worker->worker.eventCancel);
+	}
 }
 
-//=============================================================================
-//
-// EditURLDecode()
-//
-void EditURLDecode(void) {
-	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
+static void EditMapTextChunks(int mapping, DWORD flags, const GUID *pGuid) {
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	const Sci_Position iSelCount = iSelEnd - iSelStart;
 	if (iSelCount == 0) {
 		return;
 	}
@@ -1917,363 +3415,456 @@ void EditURLDecode(void) {
 		return;
 	}
 
-	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
-
-	SciCall_GetSelText(pszText);
-	const UINT cpEdit = SciCall_GetCodePage();
-	MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
-
-	char *pszUnescaped = (char *)NP2HeapAlloc(NP2HeapSize(pszText) * 3);
-	LPWSTR pszUnescapedW = (LPWSTR)NP2HeapAlloc(NP2HeapSize(pszTextW) * 3);
-
-	DWORD cchUnescapedW = (DWORD)(NP2HeapSize(pszUnescapedW) / sizeof(WCHAR));
-	int cchUnescaped = cchUnescapedW;
-	UrlUnescape(pszTextW, pszUnescapedW, &cchUnescapedW, URL_UNESCAPE_AS_UTF8);
-	if (!IsWin8AndAbove()) {
-		char *ptr = pszUnescaped;
-		WCHAR *t = pszUnescapedW;
-		WCHAR ch;
-		while ((ch = *t++) != 0) {
-			if (ch > 0xff) {
-				break;
-			}
-			*ptr++ = (char)ch;
-		}
-		*ptr = '\0';
-		if (ptr == pszUnescaped + cchUnescapedW && IsUTF8(pszUnescaped, cchUnescapedW)) {
-			cchUnescapedW = MultiByteToWideChar(CP_UTF8, 0, pszUnescaped, cchUnescapedW, pszUnescapedW, cchUnescaped);
-		}
+	TextMapWorker worker;
+	ZeroMemory(&worker, sizeof(worker));
+	worker.mapping = mapping;
+	worker.flags = flags;
+	if (pGuid != NULL && IsWin7AndAbove()) {
+		worker.prgServices = GetTransliterationService(pGuid);
 	}
-
-	cchUnescaped = WideCharToMultiByte(cpEdit, 0, pszUnescapedW, cchUnescapedW, pszUnescaped, (int)NP2HeapSize(pszUnescaped), NULL, NULL);
-	EditReplaceMainSelection(cchUnescaped, pszUnescaped);
-
-	NP2HeapFree(pszText);
-	NP2HeapFree(pszTextW);
-	NP2HeapFree(pszUnescaped);
-	NP2HeapFree(pszUnescapedW);
-}
-
-//=============================================================================
-//
-// EditEscapeCChars()
-//
-void EditEscapeCChars(HWND hwnd) {
-	if (SciCall_IsSelectionEmpty()) {
+	if (mapping == TextMap_LCMap && worker.prgServices == NULL && flags == 0) {
 		return;
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+
+	DWORD chunkCount = (DWORD)(iSelCount/TEXT_MAP_CHUNK_SIZE) + 1;
+	TextMapChunk *chunks = (TextMapChunk *)NP2HeapAlloc(chunkCount*sizeof(TextMapChunk));
+	if (chunks == NULL) {
+		if (worker.prgServices != NULL) {
+			pfnMappingFreeServices(worker.prgServices);
+		}
 		return;
 	}
 
-#if NP2_USE_DESIGNATED_INITIALIZER
-	EDITFINDREPLACE efr = {
-		.hwnd = hwnd,
-	};
-#else
-	EDITFINDREPLACE efr = { "", "", "", "", hwnd };
-#endif
-
-	SciCall_BeginUndoAction();
-
-	strcpy(efr.szFind, "\\");
-	strcpy(efr.szReplace, "\\\\");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "\"");
-	strcpy(efr.szReplace, "\\\"");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+	// document is not modified until all chunks are mapped.
+	const char *pszText = SciCall_GetRangePointer(iSelStart, iSelCount);
+	const UINT cpEdit = SciCall_GetCodePage();
+	const char separator = (mapping == TextMap_SentenceCase) ? '.' : ' ';
+	chunkCount = 0;
+	Sci_Position offset = 0;
+	while (offset < iSelCount) {
+		const Sci_Position next = GetTextMapChunkEnd(pszText, offset, iSelCount, cpEdit, separator);
+		chunks[chunkCount].offset = offset;
+		chunks[chunkCount].length = next - offset;
+		++chunkCount;
+		offset = next;
+	}
+
+	worker.pszText = pszText;
+	worker.chunks = chunks;
+	worker.chunkCount = chunkCount;
+	worker.cpEdit = cpEdit;
+	BackgroundWorker_Init(&worker.worker, hwndMain);
+
+	HANDLE dispatchThread = NULL;
+	if (iSelCount >= TEXT_MAP_PARALLEL_MIN_SIZE) {
+		dispatchThread = WorkerPool_Submit(EditMapTextDispatchThread, &worker, WorkerPriority_High);
+	}
+	if (dispatchThread == NULL) {
+		EditMapTextThread(&worker);
+	} else {
+		BeginWaitCursor();
+		WaitForObjectDispatchPaint(dispatchThread, EditMapTextCancel, &worker);
+		CloseHandle(dispatchThread);
+		EndWaitCursor();
+	}
+	BackgroundWorker_Destroy(&worker.worker);
+	if (worker.prgServices != NULL) {
+		pfnMappingFreeServices(worker.prgServices);
+	}
 
-	strcpy(efr.szFind, "\'");
-	strcpy(efr.szReplace, "\\\'");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+	Sci_Position cbOut = 0;
+	BOOL bChanged = FALSE;
+	for (DWORD index = 0; index < chunkCount; index++) {
+		const TextMapChunk *chunk = &chunks[index];
+		cbOut += (chunk->lpOut != NULL) ? chunk->cbOut : chunk->length;
+		bChanged |= chunk->lpOut != NULL;
+	}
+	if (bChanged && !worker.bCancelled && !worker.bFailed) {
+		char *pszOut = (char *)NP2HeapAlloc(cbOut + 1);
+		if (pszOut != NULL) {
+			char *ptr = pszOut;
+			for (DWORD index = 0; index < chunkCount; index++) {
+				const TextMapChunk *chunk = &chunks[index];
+				if (chunk->lpOut != NULL) {
+					memcpy(ptr, chunk->lpOut, chunk->cbOut);
+					ptr += chunk->cbOut;
+				} else {
+					memcpy(ptr, pszText + chunk->offset, chunk->length);
+					ptr += chunk->length;
+				}
+			}
+			EditReplaceRange(iSelStart, iSelEnd, cbOut, pszOut);
+			NP2HeapFree(pszOut);
+		}
+	}
 
-	SciCall_EndUndoAction();
+	for (DWORD index = 0; index < chunkCount; index++) {
+		if (chunks[index].lpOut != NULL) {
+			NP2HeapFree(chunks[index].lpOut);
+		}
+	}
+	NP2HeapFree(chunks);
 }
 
 //=============================================================================
 //
-// EditUnescapeCChars()
+// EditInvertCase()
 //
-void EditUnescapeCChars(HWND hwnd) {
-	if (SciCall_IsSelectionEmpty()) {
-		return;
-	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
-	}
-
-#if NP2_USE_DESIGNATED_INITIALIZER
-	EDITFINDREPLACE efr = {
-		.hwnd = hwnd,
-	};
-#else
-	EDITFINDREPLACE efr = { "", "", "", "", hwnd };
-#endif
-
-	SciCall_BeginUndoAction();
-
-	strcpy(efr.szFind, "\\\\");
-	strcpy(efr.szReplace, "\\");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "\\\"");
-	strcpy(efr.szReplace, "\"");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "\\\'");
-	strcpy(efr.szReplace, "\'");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	SciCall_EndUndoAction();
+void EditInvertCase(void) {
+	EditMapTextChunks(TextMap_InvertCase, 0, NULL);
 }
 
-// XML/HTML predefined entity
-// https://en.wikipedia.org/wiki/List_of_XML_and_HTML_character_entity_references
-// &quot;	["]
-// &amp;	[&]
-// &apos;	[']
-// &lt;		[<]
-// &gt;		[>]
-// &nbsp;	[ ]
-// &emsp;	[\t]
 //=============================================================================
 //
-// EditEscapeXHTMLChars()
+// EditMapTextCase()
 //
-void EditEscapeXHTMLChars(HWND hwnd) {
-	if (SciCall_IsSelectionEmpty()) {
-		return;
-	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
-	}
-
-#if NP2_USE_DESIGNATED_INITIALIZER
-	EDITFINDREPLACE efr = {
-		.hwnd = hwnd,
-	};
-#else
-	EDITFINDREPLACE efr = { "", "", "", "", hwnd };
+void EditMapTextCase(int menu) {
+	DWORD flags = 0;
+	const GUID *pGuid = NULL;
+	int mapping = TextMap_LCMap;
+	switch (menu) {
+	case IDM_EDIT_TITLECASE:
+#if _WIN32_WINNT < _WIN32_WINNT_WIN7
+		if (!IsWin7AndAbove()) {
+			mapping = TextMap_TitleCase;
+			break;
+		}
 #endif
+		flags = LCMAP_LINGUISTIC_CASING | LCMAP_TITLECASE;
+		break;
+	case IDM_EDIT_MAP_FULLWIDTH:
+		flags = LCMAP_FULLWIDTH;
+		break;
+	case IDM_EDIT_MAP_HALFWIDTH:
+		flags = LCMAP_HALFWIDTH;
+		break;
+	case IDM_EDIT_MAP_SIMPLIFIED_CHINESE:
+		flags = LCMAP_SIMPLIFIED_CHINESE;
+		pGuid = &ELS_GUID_TRANSLITERATION_HANT_TO_HANS;
+		break;
+	case IDM_EDIT_MAP_TRADITIONAL_CHINESE:
+		flags = LCMAP_TRADITIONAL_CHINESE;
+		pGuid = &ELS_GUID_TRANSLITERATION_HANS_TO_HANT;
+		break;
+	case IDM_EDIT_MAP_HIRAGANA:
+		flags = LCMAP_HIRAGANA;
+		break;
+	case IDM_EDIT_MAP_KATAKANA:
+		flags = LCMAP_KATAKANA;
+		break;
+	case IDM_EDIT_MAP_MALAYALAM_LATIN:
+		pGuid = &ELS_GUID_TRANSLITERATION_MALAYALAM_TO_LATIN;
+		break;
+	case IDM_EDIT_MAP_DEVANAGARI_LATIN:
+		pGuid = &ELS_GUID_TRANSLITERATION_DEVANAGARI_TO_LATIN;
+		break;
+	case IDM_EDIT_MAP_CYRILLIC_LATIN:
+		pGuid = &ELS_GUID_TRANSLITERATION_CYRILLIC_TO_LATIN;
+		break;
+	case IDM_EDIT_MAP_BENGALI_LATIN:
+		pGuid = &ELS_GUID_TRANSLITERATION_BENGALI_TO_LATIN;
+		break;
+	case IDM_EDIT_MAP_HANGUL_DECOMPOSITION:
+		pGuid = &WIN10_ELS_GUID_TRANSLITERATION_HANGUL_DECOMPOSITION;
+		break;
+	default:
+		NP2_unreachable();
+	}
 
-	SciCall_BeginUndoAction();
-
-	strcpy(efr.szFind, "&");
-	strcpy(efr.szReplace, "&amp;");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "\"");
-	strcpy(efr.szReplace, "&quot;");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+	EditMapTextChunks(mapping, flags, pGuid);
+}
 
-	strcpy(efr.szFind, "\'");
-	strcpy(efr.szReplace, "&apos;");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+//=============================================================================
+//
+// EditSentenceCase()
+//
+void EditSentenceCase(void) {
+	EditMapTextChunks(TextMap_SentenceCase, 0, NULL);
+}
 
-	strcpy(efr.szFind, "<");
-	strcpy(efr.szReplace, "&lt;");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+#ifndef URL_ESCAPE_AS_UTF8		// (NTDDI_VERSION >= NTDDI_WIN7)
+#define URL_ESCAPE_AS_UTF8		0x00040000
+#endif
+#ifndef URL_UNESCAPE_AS_UTF8	// (NTDDI_VERSION >= NTDDI_WIN8)
+#define URL_UNESCAPE_AS_UTF8	URL_ESCAPE_AS_UTF8
+#endif
 
-	strcpy(efr.szFind, ">");
-	strcpy(efr.szReplace, "&gt;");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+//=============================================================================
+//
+// EditEscapeText()
+//
+// find first byte in [ptr, end) that is one of count (at most 8) bytes in set, return end when not found.
+static const char *FindAnyChar(const char *ptr, const char *end, const char *set, int count) {
+#if NP2_USE_AVX2
+	__m256i vects[8];
+	for (int i = 0; i < count; i++) {
+		vects[i] = _mm256_set1_epi8(set[i]);
+	}
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+		__m256i result = _mm256_cmpeq_epi8(chunk, vects[0]);
+		for (int i = 1; i < count; i++) {
+			result = _mm256_or_si256(result, _mm256_cmpeq_epi8(chunk, vects[i]));
+		}
+		const uint32_t mask = _mm256_movemask_epi8(result);
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m256i);
+	}
+#elif NP2_USE_SSE2
+	__m128i vects[8];
+	for (int i = 0; i < count; i++) {
+		vects[i] = _mm_set1_epi8(set[i]);
+	}
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		__m128i result = _mm_cmpeq_epi8(chunk, vects[0]);
+		for (int i = 1; i < count; i++) {
+			result = _mm_or_si128(result, _mm_cmpeq_epi8(chunk, vects[i]));
+		}
+		const uint32_t mask = _mm_movemask_epi8(result);
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m128i);
+	}
+#endif
+	while (ptr < end && memchr(set, *ptr, count) == NULL) {
+		++ptr;
+	}
+	return ptr;
+}
 
-	if (pLexCurrent->iLexer != SCLEX_XML) {
-		strcpy(efr.szFind, " ");
-		strcpy(efr.szReplace, "&nbsp;");
-		EditReplaceAllInSelection(hwnd, &efr, FALSE);
+// replace every byte in set with corresponding text in replacement in one pass,
+// returns NULL when no byte is replaced.
+static char *EscapeText(const char *pszText, Sci_Position cchText, const char *set, int count, const char * const *replacement, Sci_Position *pcbOut) {
+	const char * const end = pszText + cchText;
+	Sci_Position cbOut = cchText;
+	BOOL bChanged = FALSE;
+	for (const char *ptr = FindAnyChar(pszText, end, set, count); ptr < end; ptr = FindAnyChar(ptr + 1, end, set, count)) {
+		const int index = (int)((const char *)memchr(set, *ptr, count) - set);
+		cbOut += strlen(replacement[index]) - 1;
+		bChanged = TRUE;
+	}
+	if (!bChanged) {
+		return NULL;
+	}
 
-		strcpy(efr.szFind, "\t");
-		strcpy(efr.szReplace, "&emsp;");
-		EditReplaceAllInSelection(hwnd, &efr, FALSE);
+	char *pszOut = (char *)NP2HeapAlloc(cbOut + 1);
+	if (pszOut == NULL) {
+		return NULL;
+	}
+	char *out = pszOut;
+	const char *ptr = pszText;
+	while (ptr < end) {
+		const char *next = FindAnyChar(ptr, end, set, count);
+		memcpy(out, ptr, next - ptr);
+		out += next - ptr;
+		if (next == end) {
+			break;
+		}
+		const char *text = replacement[(const char *)memchr(set, *next, count) - set];
+		const size_t length = strlen(text);
+		memcpy(out, text, length);
+		out += length;
+		ptr = next + 1;
 	}
 
-	SciCall_EndUndoAction();
+	*pcbOut = cbOut;
+	return pszOut;
 }
 
-//=============================================================================
-//
-// EditUnescapeXHTMLChars()
-//
-void EditUnescapeXHTMLChars(HWND hwnd) {
+// get selection for escape or unescape, returns NULL when selection is empty or rectangular.
+// returned text points into document buffer, it's valid until the document is modified.
+static const char *EditGetEscapeSelection(Sci_Position *piSelStart, Sci_Position *piSelEnd) {
 	if (SciCall_IsSelectionEmpty()) {
-		return;
+		return NULL;
 	}
 	if (SciCall_IsRectangleSelection()) {
 		NotifyRectangleSelection();
-		return;
+		return NULL;
 	}
 
-#if NP2_USE_DESIGNATED_INITIALIZER
-	EDITFINDREPLACE efr = {
-		.hwnd = hwnd,
-	};
-#else
-	EDITFINDREPLACE efr = { "", "", "", "", hwnd };
-#endif
-
-	SciCall_BeginUndoAction();
-
-	strcpy(efr.szFind, "&quot;");
-	strcpy(efr.szReplace, "\"");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "&apos;");
-	strcpy(efr.szReplace, "\'");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "&lt;");
-	strcpy(efr.szReplace, "<");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "&gt;");
-	strcpy(efr.szReplace, ">");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-
-	strcpy(efr.szFind, "&nbsp;");
-	strcpy(efr.szReplace, " ");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	*piSelStart = iSelStart;
+	*piSelEnd = iSelEnd;
+	return SciCall_GetRangePointer(iSelStart, iSelEnd - iSelStart);
+}
 
-	strcpy(efr.szFind, "&amp;");
-	strcpy(efr.szReplace, "&");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
+static void EditEscapeSelection(const char *set, int count, const char * const *replacement) {
+	Sci_Position iSelStart;
+	Sci_Position iSelEnd;
+	const char *pszText = EditGetEscapeSelection(&iSelStart, &iSelEnd);
+	if (pszText == NULL) {
+		return;
+	}
 
-	strcpy(efr.szFind, "&emsp;");
-	strcpy(efr.szReplace, "\t");
-	EditReplaceAllInSelection(hwnd, &efr, FALSE);
-	SciCall_EndUndoAction();
+	Sci_Position cbOut = 0;
+	char *pszOut = EscapeText(pszText, iSelEnd - iSelStart, set, count, replacement, &cbOut);
+	if (pszOut != NULL) {
+		EditReplaceRange(iSelStart, iSelEnd, cbOut, pszOut);
+		NP2HeapFree(pszOut);
+	}
 }
 
 //=============================================================================
 //
-// EditChar2Hex()
+// EditURLEncode()
 //
+// C0 controls, space, DEL, non-ASCII bytes and unsafe characters escaped by UrlEscape().
+static inline BOOL IsURLEscapeChar(uint8_t ch) {
+	return ch <= ' ' || ch >= 0x7F || strchr("\"<>[\\]^`{|}", ch) != NULL;
+}
 
-/*				C/C++	C#	Java	JS	JSON	Python	PHP	Lua		Go
-\ooo		3	1			1					1		1	1/ddd	1
-\xHH		2	1		1			1			1		1			1
-\uHHHH		4	1			1		1	1		1					1
-\UHHHHHHHH	8	1								1					1
-\xHHHH		4			1
-\uHHHHHH	6				1
-*/
-#define MAX_ESCAPE_HEX_DIGIT	4
-
-void EditChar2Hex(void) {
-	Sci_Position count = SciCall_GetSelTextLength() - 1;
-	if (count == 0) {
-		return;
+static const char *FindURLEscapeChar(const char *ptr, const char *end) {
+#if NP2_USE_AVX2
+	const __m256i vectSpace = _mm256_set1_epi8(' ' + 1);
+	const __m256i vectDEL = _mm256_set1_epi8(0x7F);
+	const __m256i vectQuote = _mm256_set1_epi8('\"');
+	const __m256i vectLess = _mm256_set1_epi8('<');
+	const __m256i vectGreater = _mm256_set1_epi8('>');
+	const __m256i vectBackslash = _mm256_set1_epi8('\\');
+	const __m256i vectCaret = _mm256_set1_epi8('^');
+	const __m256i vectBacktick = _mm256_set1_epi8('`');
+	const __m256i vectBar = _mm256_set1_epi8('|');
+	const __m256i vectBracket = _mm256_set1_epi8(0x20);
+	const __m256i vectLeftBracket = _mm256_set1_epi8('[' | 0x20);
+	const __m256i vectRightBracket = _mm256_set1_epi8(']' | 0x20);
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+		// signed compare: bytes less than '!' and non-ASCII bytes
+		__m256i result = _mm256_or_si256(_mm256_cmpgt_epi8(vectSpace, chunk), _mm256_cmpeq_epi8(chunk, vectDEL));
+		result = _mm256_or_si256(result, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectQuote), _mm256_cmpeq_epi8(chunk, vectLess)));
+		result = _mm256_or_si256(result, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectGreater), _mm256_cmpeq_epi8(chunk, vectBackslash)));
+		result = _mm256_or_si256(result, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectCaret), _mm256_cmpeq_epi8(chunk, vectBacktick)));
+		// '[' and '{', ']' and '}' differ in bit 0x20
+		const __m256i folded = _mm256_or_si256(chunk, vectBracket);
+		result = _mm256_or_si256(result, _mm256_or_si256(_mm256_cmpeq_epi8(folded, vectLeftBracket), _mm256_cmpeq_epi8(folded, vectRightBracket)));
+		result = _mm256_or_si256(result, _mm256_cmpeq_epi8(chunk, vectBar));
+		const uint32_t mask = _mm256_movemask_epi8(result);
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m256i);
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+#elif NP2_USE_SSE2
+	const __m128i vectSpace = _mm_set1_epi8(' ' + 1);
+	const __m128i vectDEL = _mm_set1_epi8(0x7F);
+	const __m128i vectQuote = _mm_set1_epi8('\"');
+	const __m128i vectLess = _mm_set1_epi8('<');
+	const __m128i vectGreater = _mm_set1_epi8('>');
+	const __m128i vectBackslash = _mm_set1_epi8('\\');
+	const __m128i vectCaret = _mm_set1_epi8('^');
+	const __m128i vectBacktick = _mm_set1_epi8('`');
+	const __m128i vectBar = _mm_set1_epi8('|');
+	const __m128i vectBracket = _mm_set1_epi8(0x20);
+	const __m128i vectLeftBracket = _mm_set1_epi8('[' | 0x20);
+	const __m128i vectRightBracket = _mm_set1_epi8(']' | 0x20);
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		// signed compare: bytes less than '!' and non-ASCII bytes
+		__m128i result = _mm_or_si128(_mm_cmplt_epi8(chunk, vectSpace), _mm_cmpeq_epi8(chunk, vectDEL));
+		result = _mm_or_si128(result, _mm_or_si128(_mm_cmpeq_epi8(chunk, vectQuote), _mm_cmpeq_epi8(chunk, vectLess)));
+		result = _mm_or_si128(result, _mm_or_si128(_mm_cmpeq_epi8(chunk, vectGreater), _mm_cmpeq_epi8(chunk, vectBackslash)));
+		result = _mm_or_si128(result, _mm_or_si128(_mm_cmpeq_epi8(chunk, vectCaret), _mm_cmpeq_epi8(chunk, vectBacktick)));
+		// '[' and '{', ']' and '}' differ in bit 0x20
+		const __m128i folded = _mm_or_si128(chunk, vectBracket);
+		result = _mm_or_si128(result, _mm_or_si128(_mm_cmpeq_epi8(folded, vectLeftBracket), _mm_cmpeq_epi8(folded, vectRightBracket)));
+		result = _mm_or_si128(result, _mm_cmpeq_epi8(chunk, vectBar));
+		const uint32_t mask = _mm_movemask_epi8(result);
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m128i);
 	}
-
-	count *= 2 + MAX_ESCAPE_HEX_DIGIT;
-	char *ch = (char *)NP2HeapAlloc(count + 10);
-	WCHAR *wch = (WCHAR *)NP2HeapAlloc((count + 1) * sizeof(WCHAR));
-	SciCall_GetSelText(ch);
-
-	if (ch[0] == 0) {
-		strcpy(ch, "\\x00");
-	} else {
-		const UINT cpEdit = SciCall_GetCodePage();
-		char uesc = 'u';
-		if (pLexCurrent->rid == NP2LEX_CSHARP) {
-			uesc = 'x';
-		}
-		count = MultiByteToWideChar(cpEdit, 0, ch, -1, wch, (int)(count + 1)) - 1; // '\0'
-		int j = 0;
-		for (Sci_Position i = 0; i < count; i++) {
-			if (wch[i] <= 0xFF) {
-				sprintf(ch + j, "\\x%02X", wch[i] & 0xFF); // \xhh
-				j += 4;
-			} else {
-				sprintf(ch + j, "\\%c%04X", uesc, wch[i]); // \uhhhh \xhhhh
-				j += 6;
-			}
-		}
-		if (count == 2 && IS_SURROGATE_PAIR(wch[0], wch[1])) {
-			const UINT ucc = UTF16_TO_UTF32(wch[0], wch[1]);
-			sprintf(ch + j, " U+%X", ucc);
-		}
+#endif
+	while (ptr < end && !IsURLEscapeChar((uint8_t)(*ptr))) {
+		++ptr;
 	}
-
-	EditReplaceMainSelection(strlen(ch), ch);
-
-	NP2HeapFree(ch);
-	NP2HeapFree(wch);
+	return ptr;
 }
 
-//=============================================================================
-//
-// EditHex2Char()
-//
-void EditHex2Char(void) {
-	Sci_Position count = SciCall_GetSelTextLength() - 1;
-	if (count == 0) {
-		return;
+// percent-encode trimmed selection as UTF-8, result is ASCII.
+static char *EditURLEncodeSelectionUTF8(Sci_Position *pcbEscaped) {
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	const char *pszText = SciCall_GetRangePointer(iSelStart, iSelEnd - iSelStart);
+	const char *end = pszText + (iSelEnd - iSelStart);
+	// TODO: trim all C0 and C1 control characters.
+	while (pszText < end && strchr(" \a\b\f\n\r\t\v", *pszText) != NULL && *pszText != '\0') {
+		++pszText;
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+	while (end > pszText && strchr(" \a\b\f\n\r\t\v", end[-1]) != NULL && end[-1] != '\0') {
+		--end;
+	}
+	if (pszText == end) {
+		return NULL;
 	}
 
-	count *= 2 + MAX_ESCAPE_HEX_DIGIT;
-	char *ch = (char *)NP2HeapAlloc(count + 1);
-	WCHAR *wch = (WCHAR *)NP2HeapAlloc((count + 1) * sizeof(WCHAR));
+	char *pszUTF8 = NULL;
 	const UINT cpEdit = SciCall_GetCodePage();
-	int ci = 0;
-	int cch = 0;
+	if (cpEdit != SC_CP_UTF8 && FindURLEscapeChar(pszText, end) != end) {
+		const int cchText = (int)(end - pszText);
+		LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((cchText + 1) * sizeof(WCHAR));
+		const int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, cchText, pszTextW, cchText);
+		pszUTF8 = (char *)NP2HeapAlloc(cchTextW * kMaxMultiByteCount + 1);
+		const int cbUTF8 = WideCharToMultiByte(CP_UTF8, 0, pszTextW, cchTextW, pszUTF8, (int)NP2HeapSize(pszUTF8), NULL, NULL);
+		NP2HeapFree(pszTextW);
+		pszText = pszUTF8;
+		end = pszUTF8 + cbUTF8;
+	}
 
-	SciCall_GetSelText(ch);
+	Sci_Position cbEscaped = end - pszText;
+	for (const char *ptr = FindURLEscapeChar(pszText, end); ptr < end; ptr = FindURLEscapeChar(ptr + 1, end)) {
+		cbEscaped += 2;
+	}
 
-	const uint8_t *p = (const uint8_t *)ch;
-	while (*p) {
-		if (*p == '\\') {
-			p++;
-			if (*p == 'x' || *p == 'u') {
-				p++;
-				ci = 0;
-				int ucc = 0;
-				while (*p && (ucc++ < MAX_ESCAPE_HEX_DIGIT)) {
-					const int hex = GetHexDigit(*p);
-					if (hex < 0) {
-						break;
-					}
-					ci = (ci << 4) | hex;
-					p++;
-				}
-			} else {
-				wch[cch++] = L'\\';
-				ci = *p++;
-			}
-		} else {
-			ci = *p++;
-		}
-		wch[cch++] = (WCHAR)ci;
-		if (ci == 0) {
+	char *pszEscaped = (char *)NP2HeapAlloc(cbEscaped + 1);
+	char *out = pszEscaped;
+	const char *ptr = pszText;
+	while (ptr < end) {
+		const char *next = FindURLEscapeChar(ptr, end);
+		memcpy(out, ptr, next - ptr);
+		out += next - ptr;
+		if (next == end) {
 			break;
 		}
+		const uint8_t ch = *next;
+		out[0] = '%';
+		out[1] = "0123456789ABCDEF"[ch >> 4];
+		out[2] = "0123456789ABCDEF"[ch & 15];
+		out += 3;
+		ptr = next + 1;
 	}
 
-	wch[cch] = L'\0';
-	cch = WideCharToMultiByte(cpEdit, 0, wch, -1, ch, (int)(count + 1), NULL, NULL) - 1; // '\0'
-	EditReplaceMainSelection(cch, ch);
+	if (pszUTF8 != NULL) {
+		NP2HeapFree(pszUTF8);
+	}
+	*pcbEscaped = cbEscaped;
+	return pszEscaped;
+}
 
-	NP2HeapFree(ch);
-	NP2HeapFree(wch);
+LPWSTR EditURLEncodeSelection(int *pcchEscaped) {
+	*pcchEscaped = 0;
+	Sci_Position cbEscaped = 0;
+	char *pszEscaped = EditURLEncodeSelectionUTF8(&cbEscaped);
+	if (pszEscaped == NULL) {
+		return NULL;
+	}
+
+	LPWSTR pszEscapedW = (LPWSTR)NP2HeapAlloc((cbEscaped + 1) * sizeof(WCHAR));
+	for (Sci_Position i = 0; i < cbEscaped; i++) {
+		pszEscapedW[i] = pszEscaped[i];
+	}
+	NP2HeapFree(pszEscaped);
+	*pcchEscaped = (int)cbEscaped;
+	return pszEscapedW;
 }
 
-void EditShowHex(void) {
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-	const Sci_Position count = SciCall_GetSelTextLength() - 1;
-	if (count == 0) {
+void EditURLEncode(void) {
+	if (SciCall_IsSelectionEmpty()) {
 		return;
 	}
 	if (SciCall_IsRectangleSelection()) {
@@ -2281,3409 +3872,5924 @@ void EditShowHex(void) {
 		return;
 	}
 
-	char *ch = (char *)NP2HeapAlloc(count + 1);
-	char *cch = (char *)NP2HeapAlloc(count * 3 + 3);
-	SciCall_GetSelText(ch);
-	const uint8_t *p = (const uint8_t *)ch;
-	char *t = cch;
-	*t++ = '[';
-	while (*p) {
-		int c = *p++;
-		int v = c >> 4;
-		*t++ = (char)((v >= 10) ? v - 10 + 'a' : v + '0');
-		v = c & 0x0f;
-		*t++ = (char)((v >= 10) ? v - 10 + 'a' : v + '0');
-		*t++ = ' ';
+	Sci_Position cbEscaped = 0;
+	char *pszEscaped = EditURLEncodeSelectionUTF8(&cbEscaped);
+	if (pszEscaped != NULL) {
+		EditReplaceMainSelection(cbEscaped, pszEscaped);
+		NP2HeapFree(pszEscaped);
 	}
-	*--t = ']';
-
-	SciCall_InsertText(iSelEnd, cch);
-	SciCall_SetSel(iSelEnd, iSelEnd + strlen(cch));
-	NP2HeapFree(ch);
-	NP2HeapFree(cch);
 }
 
 //=============================================================================
 //
-// EditConvertNumRadix()
+// EditURLDecode()
 //
-static int ConvertNumRadix(char *tch, uint64_t num, int radix) {
-	switch (radix) {
-	case 16:
-		return sprintf(tch, "0x%" PRIx64, num);
+static void EditURLDecodeW(void) {
+	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
+	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1);
+	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
 
-	case 10:
-		return sprintf(tch, "%" PRIu64, num);
+	SciCall_GetSelText(pszText);
+	const UINT cpEdit = SciCall_GetCodePage();
+	MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
 
-	case 8: {
-		char buf[2 + 22 + 1] = "";
-		int index = 2 + 22;
-		int length = 0;
-		while (num) {
-			const int bit = (int)(num & 7);
-			num >>= 3;
-			buf[index--] = (char)('0' + bit);
-			++length;
-		}
-		if (length == 0) {
-			buf[index--] = '0';
-			++length;
-		}
-		buf[index--] = 'O';
-		buf[index] = '0';
-		length += 2;
-		strcat(tch, buf + index);
-		return length;
-	}
-	break;
+	char *pszUnescaped = (char *)NP2HeapAlloc(NP2HeapSize(pszText) * 3);
+	LPWSTR pszUnescapedW = (LPWSTR)NP2HeapAlloc(NP2HeapSize(pszTextW) * 3);
 
-	case 2: {
-		char buf[2 + 64 + 8 + 1] = "";
-		int index = 2 + 64 + 8;
-		int length = 0;
-		int bit_count = 0;
-		while (num) {
-			const int bit = (int)(num & 1);
-			num >>= 1;
-			buf[index--] = (char)('0' + bit);
-			++bit_count;
-			++length;
-			if (num && (bit_count & 7) == 0) {
-				buf[index--] = '_';
-				++length;
+	DWORD cchUnescapedW = (DWORD)(NP2HeapSize(pszUnescapedW) / sizeof(WCHAR));
+	int cchUnescaped = cchUnescapedW;
+	UrlUnescape(pszTextW, pszUnescapedW, &cchUnescapedW, URL_UNESCAPE_AS_UTF8);
+	if (!IsWin8AndAbove()) {
+		char *ptr = pszUnescaped;
+		WCHAR *t = pszUnescapedW;
+		WCHAR ch;
+		while ((ch = *t++) != 0) {
+			if (ch > 0xff) {
+				break;
 			}
+			*ptr++ = (char)ch;
 		}
-		if (length == 0) {
-			buf[index--] = '0';
-			++length;
+		*ptr = '\0';
+		if (ptr == pszUnescaped + cchUnescapedW && IsUTF8(pszUnescaped, cchUnescapedW)) {
+			cchUnescapedW = MultiByteToWideChar(CP_UTF8, 0, pszUnescaped, cchUnescapedW, pszUnescapedW, cchUnescaped);
 		}
-		buf[index--] = 'b';
-		buf[index] = '0';
-		length += 2;
-		strcat(tch, buf + index);
-		return length;
 	}
-	break;
 
-	}
-	return 0;
+	cchUnescaped = WideCharToMultiByte(cpEdit, 0, pszUnescapedW, cchUnescapedW, pszUnescaped, (int)NP2HeapSize(pszUnescaped), NULL, NULL);
+	EditReplaceMainSelection(cchUnescaped, pszUnescaped);
+
+	NP2HeapFree(pszText);
+	NP2HeapFree(pszTextW);
+	NP2HeapFree(pszUnescaped);
+	NP2HeapFree(pszUnescapedW);
 }
 
-void EditConvertNumRadix(int radix) {
-	const Sci_Position count = SciCall_GetSelTextLength() - 1;
-	if (count == 0) {
+void EditURLDecode(void) {
+	Sci_Position iSelStart;
+	Sci_Position iSelEnd;
+	const char *pszText = EditGetEscapeSelection(&iSelStart, &iSelEnd);
+	if (pszText == NULL) {
 		return;
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+
+	const char * const end = pszText + (iSelEnd - iSelStart);
+	const char *ptr = FindEitherChar(pszText, end, '%', '%');
+	if (ptr == end) {
 		return;
 	}
 
-	char *ch = (char *)NP2HeapAlloc(count + 1);
-	char *tch = (char *)NP2HeapAlloc(2 + count * 4 + 8 + 1);
-	Sci_Position cch = 0;
-	char *p = ch;
-	uint64_t ci = 0;
-
-	SciCall_GetSelText(ch);
-
-	while (*p) {
-		if (*p == '0') {
-			ci = 0;
-			p++;
-			if ((*p == 'x' || *p == 'X') && radix != 16) {
-				p++;
-				while (*p) {
-					if (*p == '_') {
-						p++;
-					} else {
-						const int hex = GetHexDigit(*p);
-						if (hex < 0) {
-							break;
-						}
-						ci = (ci << 4) | hex;
-						p++;
-					}
-				}
-				cch += ConvertNumRadix(tch + cch, ci, radix);
-			} else if ((*p == 'o' || *p == 'O') && radix != 8) {
-				p++;
-				while (*p) {
-					if (*p >= '0' && *p <= '7') {
-						ci <<= 3;
-						ci += (*p++ - '0');
-					} else if (*p == '_') {
-						p++;
-					} else {
-						break;
-					}
-				}
-				cch += ConvertNumRadix(tch + cch, ci, radix);
-			} else if ((*p == 'b' || *p == 'B') && radix != 2) {
-				p++;
-				while (*p) {
-					if (*p == '0') {
-						ci <<= 1;
-						p++;
-					} else if (*p == '1') {
-						ci <<= 1;
-						ci |= 1;
-						p++;
-					} else if (*p == '_') {
-						p++;
-					} else {
-						break;
-					}
-				}
-				cch += ConvertNumRadix(tch + cch, ci, radix);
-			} else if ((*p >= '0' && *p <= '9') && radix != 10) {
-				ci = *p++ - '0';
-				while (*p) {
-					if (*p >= '0' && *p <= '9') {
-						ci *= 10;
-						ci += (*p++ - '0');
-					} else if (*p == '_') {
-						p++;
-					} else {
-						break;
-					}
-				}
-				cch += ConvertNumRadix(tch + cch, ci, radix);
-			} else {
-				tch[cch++] = '0';
-			}
-		} else if ((*p >= '1' && *p <= '9') && radix != 10) {
-			ci = *p++ - '0';
-			while (*p) {
-				if (*p >= '0' && *p <= '9') {
-					ci *= 10;
-					ci += (*p++ - '0');
-				} else if (*p == '_') {
-					p++;
-				} else {
-					break;
-				}
-			}
-			cch += ConvertNumRadix(tch + cch, ci, radix);
-		} else if (IsAlphaNumeric(*p) || *p == '_') {
-			// radix and number prefix matches, no conversion
-			tch[cch++] = *p++;
-			while (IsAlphaNumeric(*p) || *p == '_') {
-				tch[cch++] = *p++;
-			}
+	char *pszUnescaped = (char *)NP2HeapAlloc(iSelEnd - iSelStart + 1);
+	char *out = pszUnescaped;
+	BOOL bNonASCII = FALSE;
+	BOOL bChanged = FALSE;
+	memcpy(out, pszText, ptr - pszText);
+	out += ptr - pszText;
+	while (ptr < end) {
+		const char *next = FindEitherChar(ptr, end, '%', '%');
+		memcpy(out, ptr, next - ptr);
+		out += next - ptr;
+		if (next == end) {
+			break;
+		}
+		const int high = (end - next > 2) ? GetHexDigit(next[1]) : -1;
+		const int low = (high >= 0) ? GetHexDigit(next[2]) : -1;
+		if (low >= 0) {
+			const uint8_t ch = (uint8_t)((high << 4) | low);
+			bNonASCII |= ch >= 0x80;
+			*out++ = (char)ch;
+			bChanged = TRUE;
+			ptr = next + 3;
 		} else {
-			tch[cch++] = *p++;
+			*out++ = '%';
+			ptr = next + 1;
 		}
 	}
-	tch[cch] = '\0';
 
-	EditReplaceMainSelection(cch, tch);
+	const Sci_Position cbUnescaped = out - pszUnescaped;
+	if (bNonASCII && !(SciCall_GetCodePage() == SC_CP_UTF8 && cbUnescaped < UINT_MAX && IsUTF8(pszUnescaped, (DWORD)cbUnescaped))) {
+		// decoded bytes are not in document encoding
+		NP2HeapFree(pszUnescaped);
+		EditURLDecodeW();
+		return;
+	}
+	if (bChanged) {
+		EditReplaceRange(iSelStart, iSelEnd, cbUnescaped, pszUnescaped);
+	}
+	NP2HeapFree(pszUnescaped);
+}
 
-	NP2HeapFree(ch);
-	NP2HeapFree(tch);
+//=============================================================================
+//
+// EditEscapeCChars()
+//
+void EditEscapeCChars(void) {
+	static const char * const replacement[] = { "\\\\", "\\\"", "\\\'" };
+	EditEscapeSelection("\\\"\'", COUNTOF(replacement), replacement);
 }
 
 //=============================================================================
 //
-// EditModifyNumber()
+// EditUnescapeCChars()
 //
-void EditModifyNumber(BOOL bIncrease) {
-	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
-	if (iSelCount == 0) {
-		return;
-	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+void EditUnescapeCChars(void) {
+	Sci_Position iSelStart;
+	Sci_Position iSelEnd;
+	const char *pszText = EditGetEscapeSelection(&iSelStart, &iSelEnd);
+	if (pszText == NULL) {
 		return;
 	}
 
-	if (iSelCount < 32) {
-		char chNumber[32] = "";
-		SciCall_GetSelText(chNumber);
-		if (strchr(chNumber, '-')) {
-			return;
-		}
-
-		const char *ptr = strpbrk(chNumber, "xX");
-		const int radix = (ptr != NULL) ? 16 : 10;
-		char *end;
-		int iNumber = (int)strtol(chNumber, &end, radix);
-		if (end == chNumber || iNumber < 0) {
-			return;
+	const char * const end = pszText + (iSelEnd - iSelStart);
+	char *pszUnescaped = NULL;
+	char *out = NULL;
+	const char *ptr = pszText;
+	while (ptr < end) {
+		const char *next = FindEitherChar(ptr, end, '\\', '\\');
+		if (next + 1 < end && (next[1] == '\\' || next[1] == '\"' || next[1] == '\'')) {
+			if (pszUnescaped == NULL) {
+				pszUnescaped = (char *)NP2HeapAlloc(iSelEnd - iSelStart + 1);
+				memcpy(pszUnescaped, pszText, ptr - pszText);
+				out = pszUnescaped + (ptr - pszText);
+			}
+			memcpy(out, ptr, next - ptr);
+			out += next - ptr;
+			*out++ = next[1];
+			ptr = next + 2;
+		} else {
+			if (next < end) {
+				++next;
+			}
+			if (out != NULL) {
+				memcpy(out, ptr, next - ptr);
+				out += next - ptr;
+			}
+			ptr = next;
 		}
+	}
 
-		if (bIncrease && iNumber < INT_MAX) {
-			iNumber++;
-		}
-		if (!bIncrease && iNumber > 0) {
-			iNumber--;
-		}
+	if (pszUnescaped != NULL) {
+		EditReplaceRange(iSelStart, iSelEnd, out - pszUnescaped, pszUnescaped);
+		NP2HeapFree(pszUnescaped);
+	}
+}
 
-		const int iWidth = (int)strlen(chNumber) - ((ptr != NULL) ? 2 : 0);
-		if (ptr != NULL) {
-			if (*ptr == 'X') {
-				sprintf(chNumber, "%#0*X", iWidth, iNumber);
-			} else {
-				sprintf(chNumber, "%#0*x", iWidth, iNumber);
-			}
-		} else {
-			sprintf(chNumber, "%0*i", iWidth, iNumber);
-		}
-		EditReplaceMainSelection(strlen(chNumber), chNumber);
-	}
+// XML/HTML predefined entity
+// https://en.wikipedia.org/wiki/List_of_XML_and_HTML_character_entity_references
+// &quot;	["]
+// &amp;	[&]
+// &apos;	[']
+// &lt;		[<]
+// &gt;		[>]
+// &nbsp;	[ ]
+// &emsp;	[\t]
+//=============================================================================
+//
+// EditEscapeXHTMLChars()
+//
+void EditEscapeXHTMLChars(void) {
+	static const char * const replacement[] = { "&amp;", "&quot;", "&apos;", "&lt;", "&gt;", "&nbsp;", "&emsp;" };
+	// space and tab are kept for XML
+	const int count = (pLexCurrent->iLexer == SCLEX_XML) ? 5 : COUNTOF(replacement);
+	EditEscapeSelection("&\"\'<> \t", count, replacement);
 }
 
 //=============================================================================
 //
-// EditTabsToSpaces()
+// EditUnescapeXHTMLChars()
 //
-void EditTabsToSpaces(int nTabWidth, BOOL bOnlyIndentingWS) {
-	if (SciCall_IsSelectionEmpty()) {
-		return;
-	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+void EditUnescapeXHTMLChars(void) {
+	// entity without leading '&', matched case insensitively
+	static const char * const entity[] = { "quot;", "apos;", "lt;", "gt;", "nbsp;", "amp;", "emsp;" };
+	static const char unescaped[] = "\"\'<> &\t";
+
+	Sci_Position iSelStart;
+	Sci_Position iSelEnd;
+	const char *pszText = EditGetEscapeSelection(&iSelStart, &iSelEnd);
+	if (pszText == NULL) {
 		return;
 	}
 
-	Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-
-	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
-	iSelStart = SciCall_PositionFromLine(iLine);
-
-	const Sci_Position iSelCount = iSelEnd - iSelStart;
-	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
-
-	struct Sci_TextRange tr = { { iSelStart, iSelEnd }, pszText};
-	SciCall_GetTextRange(&tr);
-
-	const UINT cpEdit = SciCall_GetCodePage();
-	const int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
-	NP2HeapFree(pszText);
-
-	LPWSTR pszConvW = (LPWSTR)NP2HeapAlloc(cchTextW * sizeof(WCHAR) * nTabWidth + 2);
-	int cchConvW = 0;
-
-	BOOL bIsLineStart = TRUE;
-	BOOL bModified = FALSE;
-	// Contributed by Homam, Thank you very much!
-	int i = 0;
-	for (int iTextW = 0; iTextW < cchTextW; iTextW++) {
-		const WCHAR w = pszTextW[iTextW];
-		if (w == L'\t' && (!bOnlyIndentingWS || bIsLineStart)) {
-			for (int j = 0; j < nTabWidth - (i % nTabWidth); j++) {
-				pszConvW[cchConvW++] = L' ';
-			}
-			i = 0;
-			bModified = TRUE;
+	const char * const end = pszText + (iSelEnd - iSelStart);
+	char *pszUnescaped = NULL;
+	char *out = NULL;
+	const char *ptr = pszText;
+	while (ptr < end) {
+		const char *next = FindEitherChar(ptr, end, '&', '&');
+		int index = COUNTOF(entity);
+		if (next < end) {
+			const size_t remain = end - next - 1;
+			for (index = 0; index < (int)COUNTOF(entity); index++) {
+				const size_t length = strlen(entity[index]);
+				if (length <= remain && StrStartsWithCaseEx(next + 1, entity[index], length)) {
+					break;
+				}
+			}
+		}
+		if (index < (int)COUNTOF(entity)) {
+			if (pszUnescaped == NULL) {
+				pszUnescaped = (char *)NP2HeapAlloc(iSelEnd - iSelStart + 1);
+				memcpy(pszUnescaped, pszText, ptr - pszText);
+				out = pszUnescaped + (ptr - pszText);
+			}
+			memcpy(out, ptr, next - ptr);
+			out += next - ptr;
+			*out++ = unescaped[index];
+			ptr = next + 1 + strlen(entity[index]);
 		} else {
-			i++;
-			if (w == L'\n' || w == L'\r') {
-				i = 0;
-				bIsLineStart = TRUE;
-			} else if (w != L' ') {
-				bIsLineStart = FALSE;
+			if (next < end) {
+				++next;
 			}
-			pszConvW[cchConvW++] = w;
+			if (out != NULL) {
+				memcpy(out, ptr, next - ptr);
+				out += next - ptr;
+			}
+			ptr = next;
 		}
 	}
 
-	NP2HeapFree(pszTextW);
-
-	if (bModified) {
-		pszText = (char *)NP2HeapAlloc(cchConvW * kMaxMultiByteCount);
-		const int cchText = WideCharToMultiByte(cpEdit, 0, pszConvW, cchConvW, pszText, (int)NP2HeapSize(pszText), NULL, NULL);
-		EditReplaceRange(iSelStart, iSelEnd, cchText, pszText);
-		NP2HeapFree(pszText);
+	if (pszUnescaped != NULL) {
+		EditReplaceRange(iSelStart, iSelEnd, out - pszUnescaped, pszUnescaped);
+		NP2HeapFree(pszUnescaped);
 	}
-
-	NP2HeapFree(pszConvW);
 }
 
 //=============================================================================
 //
-// EditSpacesToTabs()
-//
-void EditSpacesToTabs(int nTabWidth, BOOL bOnlyIndentingWS) {
-	if (SciCall_IsSelectionEmpty()) {
-		return;
+// EditFormatJSON()
+//
+// Like simdjson, text is classified in blocks into bit masks of quotes, backslashes, structural
+// characters and white space, escaped quotes and string content are resolved with bit operations.
+// Only structural characters and runs of white space outside strings are visited, strings and
+// other values are copied as a whole.
+#define JSON_BLOCK_SIZE		32
+
+typedef struct JsonBlock {
+	uint32_t quote;
+	uint32_t backslash;
+	uint32_t structural;	// {}[],:
+	uint32_t space;
+	uint32_t unsupported;	// comment and single quoted string
+} JsonBlock;
+
+typedef struct JsonWriter {
+	char *text;
+	Sci_Position length;
+	Sci_Position capacity;
+	int depth;
+	int indentWidth;		// zero to indent with tab
+	BOOL bMinify;
+	BOOL bLineBreak;		// line break before next value
+	BOOL bEmpty;			// nothing after opening bracket
+	int cchEOL;
+	char chaEOL[2];
+} JsonWriter;
+
+static inline void JsonClassifyBlock(const uint8_t *ptr, JsonBlock *block) {
+#if NP2_USE_AVX2
+	const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+	// `[` and `]` differ from `{` and `}` by 0x20
+	const __m256i lower = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+	block->quote = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\"')));
+	block->backslash = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')));
+	block->structural = _mm256_movemask_epi8(_mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')))));
+	block->space = _mm256_movemask_epi8(_mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')))));
+	block->unsupported = _mm256_movemask_epi8(_mm256_or_si256(
+		_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('/')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\''))));
+#elif NP2_USE_SSE2
+	memset(block, 0, sizeof(JsonBlock));
+	for (uint32_t i = 0; i < JSON_BLOCK_SIZE; i += sizeof(__m128i)) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)(ptr + i));
+		const __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+		block->quote |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"'))) << i;
+		block->backslash |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))) << i;
+		block->structural |= (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(':'))))) << i;
+		block->space |= (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))))) << i;
+		block->unsupported |= (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+			_mm_cmpeq_epi8(chunk, _mm_set1_epi8('/')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\'')))) << i;
+	}
+#elif NP2_USE_NEON
+	memset(block, 0, sizeof(JsonBlock));
+	for (uint32_t i = 0; i < JSON_BLOCK_SIZE; i += sizeof(uint8x16_t)) {
+		const uint8x16_t chunk = vld1q_u8(ptr + i);
+		const uint8x16_t lower = vorrq_u8(chunk, vdupq_n_u8(0x20));
+		block->quote |= neon_movemask_epi8(vceqq_u8(chunk, vdupq_n_u8('\"'))) << i;
+		block->backslash |= neon_movemask_epi8(vceqq_u8(chunk, vdupq_n_u8('\\'))) << i;
+		block->structural |= neon_movemask_epi8(vorrq_u8(
+			vorrq_u8(vceqq_u8(lower, vdupq_n_u8('{')), vceqq_u8(lower, vdupq_n_u8('}'))),
+			vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(',')), vceqq_u8(chunk, vdupq_n_u8(':'))))) << i;
+		block->space |= neon_movemask_epi8(vorrq_u8(
+			vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(' ')), vceqq_u8(chunk, vdupq_n_u8('\t'))),
+			vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\r')), vceqq_u8(chunk, vdupq_n_u8('\n'))))) << i;
+		block->unsupported |= neon_movemask_epi8(vorrq_u8(
+			vceqq_u8(chunk, vdupq_n_u8('/')), vceqq_u8(chunk, vdupq_n_u8('\'')))) << i;
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+#else
+	memset(block, 0, sizeof(JsonBlock));
+	for (uint32_t i = 0; i < JSON_BLOCK_SIZE; i++) {
+		const uint32_t bit = 1U << i;
+		switch (ptr[i]) {
+		case '\"':
+			block->quote |= bit;
+			break;
+		case '\\':
+			block->backslash |= bit;
+			break;
+		case '{': case '}': case '[': case ']': case ',': case ':':
+			block->structural |= bit;
+			break;
+		case ' ': case '\t': case '\r': case '\n':
+			block->space |= bit;
+			break;
+		case '/': case '\'':
+			block->unsupported |= bit;
+			break;
+		}
 	}
+#endif
+}
 
-	Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-
-	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
-	iSelStart = SciCall_PositionFromLine(iLine);
+// characters escaped by odd length runs of backslashes, from simdjson.
+static inline uint32_t JsonEscapedMask(uint32_t backslash, uint32_t *prevEscaped) {
+	const uint32_t evenBits = 0x55555555U;
+	backslash &= ~*prevEscaped;
+	const uint32_t followsEscape = (backslash << 1) | *prevEscaped;
+	const uint32_t oddStarts = backslash & ~evenBits & ~followsEscape;
+	const uint32_t evenStarts = oddStarts + backslash;
+	*prevEscaped = evenStarts < oddStarts;
+	return (evenBits ^ (evenStarts << 1)) & followsEscape;
+}
 
-	const Sci_Position iSelCount = iSelEnd - iSelStart;
-	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
+// bit n is xor of bit 0 to n, set from opening quote to the byte before closing quote.
+static inline uint32_t JsonPrefixXor(uint32_t mask) {
+	mask ^= mask << 1;
+	mask ^= mask << 2;
+	mask ^= mask << 4;
+	mask ^= mask << 8;
+	mask ^= mask << 16;
+	return mask;
+}
 
-	struct Sci_TextRange tr = { { iSelStart, iSelEnd }, pszText };
-	SciCall_GetTextRange(&tr);
+static char *JsonWriter_Append(JsonWriter *writer, Sci_Position count) {
+	const Sci_Position length = writer->length + count;
+	if (length > writer->capacity) {
+		const Sci_Position capacity = max_pos(length, 2*writer->capacity);
+		char *text = (char *)NP2TempReAlloc(writer->text, capacity);
+		if (text == NULL) {
+			return NULL;
+		}
+		writer->text = text;
+		writer->capacity = capacity;
+	}
+	char *ptr = writer->text + writer->length;
+	writer->length = length;
+	return ptr;
+}
 
-	const UINT cpEdit = SciCall_GetCodePage();
+static BOOL JsonWriter_LineBreak(JsonWriter *writer, int depth) {
+	const int indent = writer->indentWidth ? depth*writer->indentWidth : depth;
+	char *ptr = JsonWriter_Append(writer, writer->cchEOL + indent);
+	if (ptr == NULL) {
+		return FALSE;
+	}
+	memcpy(ptr, writer->chaEOL, writer->cchEOL);
+	memset(ptr + writer->cchEOL, writer->indentWidth ? ' ' : '\t', indent);
+	return TRUE;
+}
 
-	const int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
-	NP2HeapFree(pszText);
+// start of value or opening bracket
+static BOOL JsonWriter_BeginValue(JsonWriter *writer) {
+	BOOL bLineBreak = writer->bLineBreak;
+	if (writer->depth == 0 && writer->length != 0) {
+		// one top level value per line, e.g. JSON Lines
+		bLineBreak = TRUE;
+	}
+	writer->bLineBreak = FALSE;
+	writer->bEmpty = FALSE;
+	return !bLineBreak || JsonWriter_LineBreak(writer, writer->depth);
+}
 
-	LPWSTR pszConvW = (LPWSTR)NP2HeapAlloc(cchTextW * sizeof(WCHAR) + 2);
-	int cchConvW = 0;
+static BOOL JsonWriter_Value(JsonWriter *writer, const char *ptr, Sci_Position count) {
+	if (!JsonWriter_BeginValue(writer)) {
+		return FALSE;
+	}
+	char *out = JsonWriter_Append(writer, count);
+	if (out == NULL) {
+		return FALSE;
+	}
+	memcpy(out, ptr, count);
+	return TRUE;
+}
 
-	BOOL bIsLineStart = TRUE;
-	BOOL bModified = FALSE;
-	// Contributed by Homam, Thank you very much!
-	int i = 0;
-	int j = 0;
-	WCHAR space[256];
-	for (int iTextW = 0; iTextW < cchTextW; iTextW++) {
-		const WCHAR w = pszTextW[iTextW];
-		if ((w == L' ' || w == L'\t') && (!bOnlyIndentingWS || bIsLineStart)) {
-			space[j++] = w;
-			if (j == nTabWidth - (i % nTabWidth) || w == L'\t') {
-				if (j > 1 || pszTextW[iTextW + 1] == L' ' || pszTextW[iTextW + 1] == L'\t') {
-					pszConvW[cchConvW++] = L'\t';
-				} else {
-					pszConvW[cchConvW++] = w;
-				}
-				i = j = 0;
-				bModified = bModified || (w != pszConvW[cchConvW - 1]);
-			}
-		} else {
-			i += j + 1;
-			if (j > 0) {
-				//space[j] = '\0';
-				for (int t = 0; t < j; t++) {
-					pszConvW[cchConvW++] = space[t];
-				}
-				j = 0;
-			}
-			if (w == L'\n' || w == L'\r') {
-				i = 0;
-				bIsLineStart = TRUE;
-			} else {
-				bIsLineStart = FALSE;
-			}
-			pszConvW[cchConvW++] = w;
+static BOOL JsonWriter_Structural(JsonWriter *writer, char ch) {
+	char *out;
+	switch (ch) {
+	case '{':
+	case '[':
+		if (!JsonWriter_BeginValue(writer) || (out = JsonWriter_Append(writer, 1)) == NULL) {
+			return FALSE;
 		}
-	}
+		*out = ch;
+		writer->depth++;
+		writer->bLineBreak = !writer->bMinify;
+		writer->bEmpty = TRUE;
+		return TRUE;
 
-	if (j > 0) {
-		for (int t = 0; t < j; t++) {
-			pszConvW[cchConvW++] = space[t];
+	case '}':
+	case ']':
+		if (writer->depth == 0) {
+			return FALSE;
 		}
-	}
+		writer->depth--;
+		// empty object and array are kept on same line
+		if (!writer->bMinify && !writer->bEmpty && !JsonWriter_LineBreak(writer, writer->depth)) {
+			return FALSE;
+		}
+		writer->bLineBreak = FALSE;
+		writer->bEmpty = FALSE;
+		break;
 
-	NP2HeapFree(pszTextW);
+	case ',':
+		writer->bLineBreak = !writer->bMinify;
+		break;
 
-	if (bModified || cchConvW != cchTextW) {
-		pszText = (char *)NP2HeapAlloc(cchConvW * kMaxMultiByteCount + 1);
-		const int cchText = WideCharToMultiByte(cpEdit, 0, pszConvW, cchConvW, pszText, (int)NP2HeapSize(pszText), NULL, NULL);
-		EditReplaceRange(iSelStart, iSelEnd, cchText, pszText);
-		NP2HeapFree(pszText);
+	default: // ':'
+		if (!writer->bMinify) {
+			if ((out = JsonWriter_Append(writer, 2)) == NULL) {
+				return FALSE;
+			}
+			out[0] = ':';
+			out[1] = ' ';
+			return TRUE;
+		}
+		break;
 	}
 
-	NP2HeapFree(pszConvW);
+	if ((out = JsonWriter_Append(writer, 1)) == NULL) {
+		return FALSE;
+	}
+	*out = ch;
+	return TRUE;
 }
 
-//=============================================================================
-//
-// EditMoveUp()
-//
-void EditMoveUp(void) {
-	Sci_Position iCurPos = SciCall_GetCurrentPos();
-	Sci_Position iAnchorPos = SciCall_GetAnchor();
-	const Sci_Line iCurLine = SciCall_LineFromPosition(iCurPos);
-	const Sci_Line iAnchorLine = SciCall_LineFromPosition(iAnchorPos);
-
-	if (iCurLine == iAnchorLine) {
-		const Sci_Position iLineCurPos = iCurPos - SciCall_PositionFromLine(iCurLine);
-		const Sci_Position iLineAnchorPos = iAnchorPos - SciCall_PositionFromLine(iAnchorLine);
-		//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
-		//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
-		//if (iLineCur == iLineAnchor) {
-		//}
+static BOOL JsonWriter_Format(JsonWriter *writer, const char *pszText, Sci_Position length) {
+	NP2_alignas(32) uint8_t buffer[JSON_BLOCK_SIZE];
+	JsonBlock block;
+	uint32_t prevEscaped = 0;
+	uint32_t prevInString = 0;
+	Sci_Position runStart = 0;
+	for (Sci_Position base = 0; base < length; base += JSON_BLOCK_SIZE) {
+		const uint8_t *ptr = (const uint8_t *)pszText + base;
+		if (base + JSON_BLOCK_SIZE > length) {
+			// padding white space is dropped
+			memset(buffer, ' ', sizeof(buffer));
+			memcpy(buffer, ptr, length - base);
+			ptr = buffer;
+		}
+		JsonClassifyBlock(ptr, &block);
+		const uint32_t quote = block.quote & ~JsonEscapedMask(block.backslash, &prevEscaped);
+		const uint32_t inString = JsonPrefixXor(quote) ^ prevInString;
+		prevInString = (uint32_t)((int32_t)inString >> 31);
+		if (block.unsupported & ~inString) {
+			return FALSE;
+		}
 
-		if (iCurLine > 0) {
-			SciCall_BeginUndoAction();
-			SciCall_LineTranspose();
-			SciCall_SetSel(SciCall_PositionFromLine(iAnchorLine - 1) + iLineAnchorPos, SciCall_PositionFromLine(iCurLine - 1) + iLineCurPos);
-			SciCall_ChooseCaretX();
-			SciCall_EndUndoAction();
+		const uint32_t space = block.space & ~inString;
+		// structural characters and start of white space runs
+		uint32_t mask = (block.structural & ~inString) | (space & ~(space << 1));
+		while (mask) {
+			const uint32_t index = np2_ctz(mask);
+			mask &= mask - 1;
+			const Sci_Position offset = base + index;
+			if (offset > runStart && !JsonWriter_Value(writer, pszText + runStart, offset - runStart)) {
+				return FALSE;
+			}
+			if (space & (1U << index)) {
+				const uint32_t rest = ~(space >> index);
+				runStart = offset + (rest ? np2_ctz(rest) : JSON_BLOCK_SIZE);
+			} else {
+				if (!JsonWriter_Structural(writer, pszText[offset])) {
+					return FALSE;
+				}
+				runStart = offset + 1;
+			}
 		}
-		return;
 	}
 
+	if (runStart < length && !JsonWriter_Value(writer, pszText + runStart, length - runStart)) {
+		return FALSE;
+	}
+	// unterminated string or unclosed bracket
+	return prevInString == 0 && writer->depth == 0;
+}
+
+void EditFormatJSON(BOOL bMinify) {
 	if (SciCall_IsRectangleSelection()) {
 		NotifyRectangleSelection();
 		return;
 	}
 
-	const Sci_Line iLineSrc = min_pos(iCurLine, iAnchorLine) - 1;
-	//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
-	//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
-	//if (iLineCur == iLineAnchor) {
-	//}
-
-	if (iLineSrc >= 0) {
-		const Sci_Position cLine = SciCall_GetLineLength(iLineSrc);
-		char *pLine = (char *)NP2HeapAlloc(cLine + 1);
-		SciCall_GetLine(iLineSrc, pLine);
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	const BOOL bSelection = iSelStart != iSelEnd;
+	if (!bSelection) {
+		iSelStart = 0;
+		iSelEnd = SciCall_GetLength();
+	}
+	const Sci_Position length = iSelEnd - iSelStart;
+	if (length == 0) {
+		return;
+	}
 
-		const Sci_Position iLineSrcStart = SciCall_PositionFromLine(iLineSrc);
-		const Sci_Position iLineSrcEnd = SciCall_PositionFromLine(iLineSrc + 1);
+	JsonWriter writer;
+	memset(&writer, 0, sizeof(writer));
+	writer.bMinify = bMinify;
+	writer.indentWidth = fvCurFile.bTabsAsSpaces ? fvCurFile.iIndentWidth : 0;
+	const int iEOLMode = SciCall_GetEOLMode();
+	writer.cchEOL = (iEOLMode == SC_EOL_CRLF) ? 2 : 1;
+	writer.chaEOL[0] = (iEOLMode == SC_EOL_LF) ? '\n' : '\r';
+	writer.chaEOL[1] = '\n';
+	// minified text is never longer, formatted text usually fits in twice of the length
+	writer.capacity = bMinify ? length : 2*length;
+	writer.text = (char *)NP2TempAlloc(writer.capacity);
+	if (writer.text == NULL) {
+		return;
+	}
 
-		Sci_Line iLineDest = max_pos(iCurLine, iAnchorLine);
-		if (max_pos(iCurPos, iAnchorPos) <= SciCall_PositionFromLine(iLineDest)) {
-			if (iLineDest >= 1) {
-				iLineDest--;
-			}
-		}
+	const char *pszText = SciCall_GetRangePointer(iSelStart, length);
+	if (!JsonWriter_Format(&writer, pszText, length)) {
+		NP2TempFree(writer.text);
+		MsgBoxWarn(MB_OK, IDS_JSON_INVALID);
+		return;
+	}
 
+	if (writer.length != length || memcmp(writer.text, pszText, length) != 0) {
 		SciCall_BeginUndoAction();
-
-		SciCall_SetTargetRange(iLineSrcStart, iLineSrcEnd);
-		SciCall_ReplaceTarget(0, "");
-
-		const Sci_Position iLineDestStart = SciCall_PositionFromLine(iLineDest);
-		SciCall_InsertText(iLineDestStart, pLine);
-		NP2HeapFree(pLine);
-
-		if (iLineDest == SciCall_GetLineCount() - 1) {
-			char chaEOL[] = "\r\n";
-			const int iEOLMode = SciCall_GetEOLMode();
-			if (iEOLMode == SC_EOL_CR) {
-				chaEOL[1] = 0;
-			} else if (iEOLMode == SC_EOL_LF) {
-				chaEOL[0] = '\n';
-				chaEOL[1] = 0;
-			}
-
-			SciCall_InsertText(iLineDestStart, chaEOL);
-			SciCall_SetTargetRange(SciCall_GetLineEndPosition(iLineDest), SciCall_GetLength());
-			SciCall_ReplaceTarget(0, "");
+		SciCall_SetTargetRange(iSelStart, iSelEnd);
+		SciCall_ReplaceTarget(writer.length, writer.text);
+		if (bSelection) {
+			SciCall_SetSel(iSelStart, iSelStart + writer.length);
 		}
+		SciCall_EndUndoAction();
+	}
+	NP2TempFree(writer.text);
 
-		if (iCurPos < iAnchorPos) {
-			iCurPos = SciCall_PositionFromLine(iCurLine - 1);
-			iAnchorPos = SciCall_PositionFromLine(iLineDest);
-		} else {
-			iAnchorPos = SciCall_PositionFromLine(iAnchorLine - 1);
-			iCurPos = SciCall_PositionFromLine(iLineDest);
+	// switch to JSON scheme when the whole document was formatted as JSON
+	if (!bSelection && pLexCurrent->iLexer != SCLEX_JSON) {
+		PEDITLEXER pLexSniffed = Style_AutoDetect(FALSE);
+		if (pLexSniffed != NULL && pLexSniffed->rid == NP2LEX_JSON) {
+			Style_SetLexer(pLexSniffed, TRUE);
 		}
-
-		SciCall_SetSel(iAnchorPos, iCurPos);
-
-		SciCall_EndUndoAction();
 	}
 }
 
 //=============================================================================
 //
-// EditMoveDown()
+// EditChar2Hex()
 //
-void EditMoveDown(void) {
-	Sci_Position iCurPos = SciCall_GetCurrentPos();
-	Sci_Position iAnchorPos = SciCall_GetAnchor();
-	const Sci_Line iCurLine = SciCall_LineFromPosition(iCurPos);
-	const Sci_Line iAnchorLine = SciCall_LineFromPosition(iAnchorPos);
 
-	if (iCurLine == iAnchorLine) {
-		const Sci_Position iLineCurPos = iCurPos - SciCall_PositionFromLine(iCurLine);
-		const Sci_Position iLineAnchorPos = iAnchorPos - SciCall_PositionFromLine(iAnchorLine);
-		//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
-		//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
-		//if (iLineCur == iLineAnchor) {
-		//}
+/*				C/C++	C#	Java	JS	JSON	Python	PHP	Lua		Go
+\ooo		3	1			1					1		1	1/ddd	1
+\xHH		2	1		1			1			1		1			1
+\uHHHH		4	1			1		1	1		1					1
+\UHHHHHHHH	8	1								1					1
+\xHHHH		4			1
+\uHHHHHH	6				1
+*/
+#define MAX_ESCAPE_HEX_DIGIT	4
 
-		if (iCurLine < SciCall_GetLineCount() - 1) {
-			SciCall_BeginUndoAction();
-			SciCall_GotoLine(iCurLine + 1);
-			SciCall_LineTranspose();
-			SciCall_SetSel(SciCall_PositionFromLine(iAnchorLine + 1) + iLineAnchorPos, SciCall_PositionFromLine(iCurLine + 1) + iLineCurPos);
-			SciCall_ChooseCaretX();
-			SciCall_EndUndoAction();
-		}
+void EditChar2Hex(void) {
+	Sci_Position count = SciCall_GetSelTextLength() - 1;
+	if (count == 0) {
 		return;
 	}
-
 	if (SciCall_IsRectangleSelection()) {
 		NotifyRectangleSelection();
 		return;
 	}
 
-	Sci_Line iLineSrc = max_pos(iCurLine, iAnchorLine) + 1;
-	//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
-	//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
-	//if (iLineCur == iLineAnchor) {
-	//}
-
-	if (max_pos(iCurPos, iAnchorPos) <= SciCall_PositionFromLine(iLineSrc - 1)) {
-		if (iLineSrc >= 1) {
-			iLineSrc--;
-		}
-	}
-
-	if (iLineSrc <= SciCall_GetLineCount() - 1) {
-		const BOOL bLastLine = (iLineSrc == SciCall_GetLineCount() - 1);
+	count *= 2 + MAX_ESCAPE_HEX_DIGIT;
+	char *ch = (char *)NP2HeapAlloc(count + 10);
+	WCHAR *wch = (WCHAR *)NP2HeapAlloc((count + 1) * sizeof(WCHAR));
+	SciCall_GetSelText(ch);
 
-		if (bLastLine &&
-				(SciCall_GetLineEndPosition(iLineSrc) == SciCall_PositionFromLine(iLineSrc)) &&
-				(SciCall_GetLineEndPosition(iLineSrc - 1) == SciCall_PositionFromLine(iLineSrc - 1))) {
-			return;
+	if (ch[0] == 0) {
+		strcpy(ch, "\\x00");
+	} else {
+		const UINT cpEdit = SciCall_GetCodePage();
+		char uesc = 'u';
+		if (pLexCurrent->rid == NP2LEX_CSHARP) {
+			uesc = 'x';
 		}
-
-		if (bLastLine) {
-			char chaEOL[] = "\r\n";
-			const int iEOLMode = SciCall_GetEOLMode();
-			if (iEOLMode == SC_EOL_CR) {
-				chaEOL[1] = 0;
-			} else if (iEOLMode == SC_EOL_LF) {
-				chaEOL[0] = '\n';
-				chaEOL[1] = 0;
+		count = MultiByteToWideChar(cpEdit, 0, ch, -1, wch, (int)(count + 1)) - 1; // '\0'
+		int j = 0;
+		for (Sci_Position i = 0; i < count; i++) {
+			if (wch[i] <= 0xFF) {
+				sprintf(ch + j, "\\x%02X", wch[i] & 0xFF); // \xhh
+				j += 4;
+			} else {
+				sprintf(ch + j, "\\%c%04X", uesc, wch[i]); // \uhhhh \xhhhh
+				j += 6;
 			}
-			SciCall_AppendText(strlen(chaEOL), chaEOL);
-		}
-
-		const Sci_Position cLine = SciCall_GetLineLength(iLineSrc);
-		char *pLine = (char *)NP2HeapAlloc(cLine + 3);
-		SciCall_GetLine(iLineSrc, pLine);
-
-		const Sci_Position iLineSrcStart = SciCall_PositionFromLine(iLineSrc);
-		const Sci_Position iLineSrcEnd = SciCall_PositionFromLine(iLineSrc + 1);
-		const Sci_Line iLineDest = min_pos(iCurLine, iAnchorLine);
-
-		SciCall_BeginUndoAction();
-
-		SciCall_SetTargetRange(iLineSrcStart, iLineSrcEnd);
-		SciCall_ReplaceTarget(0, "");
-
-		const Sci_Position iLineDestStart = SciCall_PositionFromLine(iLineDest);
-		SciCall_InsertText(iLineDestStart, pLine);
-
-		if (bLastLine) {
-			SciCall_SetTargetRange(SciCall_GetLineEndPosition(SciCall_GetLineCount() - 2), SciCall_GetLength());
-			SciCall_ReplaceTarget(0, "");
 		}
-
-		NP2HeapFree(pLine);
-
-		if (iCurPos < iAnchorPos) {
-			iCurPos = SciCall_PositionFromLine(iCurLine + 1);
-			iAnchorPos = SciCall_PositionFromLine(iLineSrc + 1);
-		} else {
-			iAnchorPos = SciCall_PositionFromLine(iAnchorLine + 1);
-			iCurPos = SciCall_PositionFromLine(iLineSrc + 1);
+		if (count == 2 && IS_SURROGATE_PAIR(wch[0], wch[1])) {
+			const UINT ucc = UTF16_TO_UTF32(wch[0], wch[1]);
+			sprintf(ch + j, " U+%X", ucc);
 		}
+	}
 
-		SciCall_SetSel(iAnchorPos, iCurPos);
+	EditReplaceMainSelection(strlen(ch), ch);
 
-		SciCall_EndUndoAction();
-	}
+	NP2HeapFree(ch);
+	NP2HeapFree(wch);
 }
 
-// only convert CR+LF
-static void ConvertWinEditLineEndingsEx(char *s, int iEOLMode, int *lineCount) {
-	int count = 0;
-	if (iEOLMode != SC_EOL_CRLF) {
-		char *p = s;
-		const char chaEOL = (iEOLMode == SC_EOL_LF) ? '\n' : '\r';
-		while (*s) {
-			switch (*s) {
-			case '\r':
-				++count;
-				if (s[1] == '\n') {
-					++s;
-					*p++ = chaEOL;
-				} else {
-					*p++ = '\r';
-				}
-				++s;
-				break;
+//=============================================================================
+//
+// EditHex2Char()
+//
+void EditHex2Char(void) {
+	Sci_Position count = SciCall_GetSelTextLength() - 1;
+	if (count == 0) {
+		return;
+	}
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
 
-			case '\n':
-				++count;
-				*p++ = '\n';
-				++s;
-				break;
+	count *= 2 + MAX_ESCAPE_HEX_DIGIT;
+	char *ch = (char *)NP2HeapAlloc(count + 1);
+	WCHAR *wch = (WCHAR *)NP2HeapAlloc((count + 1) * sizeof(WCHAR));
+	const UINT cpEdit = SciCall_GetCodePage();
+	int ci = 0;
+	int cch = 0;
 
-			default:
-				*p++ = *s++;
-				break;
-			}
-		}
+	SciCall_GetSelText(ch);
 
-		*p = '\0';
-		if (lineCount != NULL) {
-			*lineCount = count;
-		}
-	} else if (lineCount != NULL) {
-		while (*s) {
-			switch (*s++) {
-			case '\r':
-				++count;
-				if (*s == '\n') {
-					++s;
+	const uint8_t *p = (const uint8_t *)ch;
+	while (*p) {
+		if (*p == '\\') {
+			p++;
+			if (*p == 'x' || *p == 'u') {
+				p++;
+				ci = 0;
+				int ucc = 0;
+				while (*p && (ucc++ < MAX_ESCAPE_HEX_DIGIT)) {
+					const int hex = GetHexDigit(*p);
+					if (hex < 0) {
+						break;
+					}
+					ci = (ci << 4) | hex;
+					p++;
 				}
-				break;
-
-			case '\n':
-				++count;
-				break;
+			} else {
+				wch[cch++] = L'\\';
+				ci = *p++;
 			}
+		} else {
+			ci = *p++;
+		}
+		wch[cch++] = (WCHAR)ci;
+		if (ci == 0) {
+			break;
 		}
-		*lineCount = count;
 	}
-}
 
-static inline void ConvertWinEditLineEndings(char *s, int iEOLMode) {
-	ConvertWinEditLineEndingsEx(s, iEOLMode, NULL);
+	wch[cch] = L'\0';
+	cch = WideCharToMultiByte(cpEdit, 0, wch, -1, ch, (int)(count + 1), NULL, NULL) - 1; // '\0'
+	EditReplaceMainSelection(cch, ch);
+
+	NP2HeapFree(ch);
+	NP2HeapFree(wch);
 }
 
-//=============================================================================
-//
-// EditModifyLines()
-//
-void EditModifyLines(LPCWSTR pwszPrefix, LPCWSTR pwszAppend) {
+void EditShowHex(void) {
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	const Sci_Position count = SciCall_GetSelTextLength() - 1;
+	if (count == 0) {
+		return;
+	}
 	if (SciCall_IsRectangleSelection()) {
 		NotifyRectangleSelection();
 		return;
 	}
-	if (StrIsEmpty(pwszPrefix) && StrIsEmpty(pwszAppend)) {
-		return;
+
+	char *ch = (char *)NP2HeapAlloc(count + 1);
+	char *cch = (char *)NP2HeapAlloc(count * 3 + 3);
+	SciCall_GetSelText(ch);
+	const uint8_t *p = (const uint8_t *)ch;
+	char *t = cch;
+	*t++ = '[';
+	while (*p) {
+		int c = *p++;
+		int v = c >> 4;
+		*t++ = (char)((v >= 10) ? v - 10 + 'a' : v + '0');
+		v = c & 0x0f;
+		*t++ = (char)((v >= 10) ? v - 10 + 'a' : v + '0');
+		*t++ = ' ';
 	}
+	*--t = ']';
 
-	BeginWaitCursor();
+	SciCall_InsertText(iSelEnd, cch);
+	SciCall_SetSel(iSelEnd, iSelEnd + strlen(cch));
+	NP2HeapFree(ch);
+	NP2HeapFree(cch);
+}
 
-	const UINT cpEdit = SciCall_GetCodePage();
-	const int iEOLMode = SciCall_GetEOLMode();
+//=============================================================================
+//
+// EditConvertNumRadix()
+//
+static int ConvertNumRadix(char *tch, uint64_t num, int radix) {
+	switch (radix) {
+	case 16:
+		return sprintf(tch, "0x%" PRIx64, num);
 
-	const int iPrefixLen = lstrlen(pwszPrefix);
-	char *mszPrefix1 = NULL;
-	int iPrefixLine = 0;
-	if (iPrefixLen != 0) {
-		const int size = iPrefixLen * kMaxMultiByteCount + 1;
-		mszPrefix1 = (char *)NP2HeapAlloc(size);
-		WideCharToMultiByte(cpEdit, 0, pwszPrefix, -1, mszPrefix1, size, NULL, NULL);
-		ConvertWinEditLineEndingsEx(mszPrefix1, iEOLMode, &iPrefixLine);
-	}
+	case 10:
+		return sprintf(tch, "%" PRIu64, num);
+
+	case 8: {
+		char buf[2 + 22 + 1] = "";
+		int index = 2 + 22;
+		int length = 0;
+		while (num) {
+			const int bit = (int)(num & 7);
+			num >>= 3;
+			buf[index--] = (char)('0' + bit);
+			++length;
+		}
+		if (length == 0) {
+			buf[index--] = '0';
+			++length;
+		}
+		buf[index--] = 'O';
+		buf[index] = '0';
+		length += 2;
+		strcat(tch, buf + index);
+		return length;
+	}
+	break;
+
+	case 2: {
+		char buf[2 + 64 + 8 + 1] = "";
+		int index = 2 + 64 + 8;
+		int length = 0;
+		int bit_count = 0;
+		while (num) {
+			const int bit = (int)(num & 1);
+			num >>= 1;
+			buf[index--] = (char)('0' + bit);
+			++bit_count;
+			++length;
+			if (num && (bit_count & 7) == 0) {
+				buf[index--] = '_';
+				++length;
+			}
+		}
+		if (length == 0) {
+			buf[index--] = '0';
+			++length;
+		}
+		buf[index--] = 'b';
+		buf[index] = '0';
+		length += 2;
+		strcat(tch, buf + index);
+		return length;
+	}
+	break;
+
+	}
+	return 0;
+}
+
+void EditConvertNumRadix(int radix) {
+	const Sci_Position count = SciCall_GetSelTextLength() - 1;
+	if (count == 0) {
+		return;
+	}
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	char *ch = (char *)NP2HeapAlloc(count + 1);
+	char *tch = (char *)NP2HeapAlloc(2 + count * 4 + 8 + 1);
+	Sci_Position cch = 0;
+	char *p = ch;
+	uint64_t ci = 0;
+
+	SciCall_GetSelText(ch);
+
+	while (*p) {
+		if (*p == '0') {
+			ci = 0;
+			p++;
+			if ((*p == 'x' || *p == 'X') && radix != 16) {
+				p++;
+				while (*p) {
+					if (*p == '_') {
+						p++;
+					} else {
+						const int hex = GetHexDigit(*p);
+						if (hex < 0) {
+							break;
+						}
+						ci = (ci << 4) | hex;
+						p++;
+					}
+				}
+				cch += ConvertNumRadix(tch + cch, ci, radix);
+			} else if ((*p == 'o' || *p == 'O') && radix != 8) {
+				p++;
+				while (*p) {
+					if (*p >= '0' && *p <= '7') {
+						ci <<= 3;
+						ci += (*p++ - '0');
+					} else if (*p == '_') {
+						p++;
+					} else {
+						break;
+					}
+				}
+				cch += ConvertNumRadix(tch + cch, ci, radix);
+			} else if ((*p == 'b' || *p == 'B') && radix != 2) {
+				p++;
+				while (*p) {
+					if (*p == '0') {
+						ci <<= 1;
+						p++;
+					} else if (*p == '1') {
+						ci <<= 1;
+						ci |= 1;
+						p++;
+					} else if (*p == '_') {
+						p++;
+					} else {
+						break;
+					}
+				}
+				cch += ConvertNumRadix(tch + cch, ci, radix);
+			} else if ((*p >= '0' && *p <= '9') && radix != 10) {
+				ci = *p++ - '0';
+				while (*p) {
+					if (*p >= '0' && *p <= '9') {
+						ci *= 10;
+						ci += (*p++ - '0');
+					} else if (*p == '_') {
+						p++;
+					} else {
+						break;
+					}
+				}
+				cch += ConvertNumRadix(tch + cch, ci, radix);
+			} else {
+				tch[cch++] = '0';
+			}
+		} else if ((*p >= '1' && *p <= '9') && radix != 10) {
+			ci = *p++ - '0';
+			while (*p) {
+				if (*p >= '0' && *p <= '9') {
+					ci *= 10;
+					ci += (*p++ - '0');
+				} else if (*p == '_') {
+					p++;
+				} else {
+					break;
+				}
+			}
+			cch += ConvertNumRadix(tch + cch, ci, radix);
+		} else if (IsAlphaNumeric(*p) || *p == '_') {
+			// radix and number prefix matches, no conversion
+			tch[cch++] = *p++;
+			while (IsAlphaNumeric(*p) || *p == '_') {
+				tch[cch++] = *p++;
+			}
+		} else {
+			tch[cch++] = *p++;
+		}
+	}
+	tch[cch] = '\0';
+
+	EditReplaceMainSelection(cch, tch);
+
+	NP2HeapFree(ch);
+	NP2HeapFree(tch);
+}
+
+//=============================================================================
+//
+// EditModifyNumber()
+//
+void EditModifyNumber(BOOL bIncrease) {
+	const Sci_Position iSelCount = SciCall_GetSelTextLength() - 1;
+	if (iSelCount == 0) {
+		return;
+	}
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	if (iSelCount < 32) {
+		char chNumber[32] = "";
+		SciCall_GetSelText(chNumber);
+		if (strchr(chNumber, '-')) {
+			return;
+		}
+
+		const char *ptr = strpbrk(chNumber, "xX");
+		const int radix = (ptr != NULL) ? 16 : 10;
+		char *end;
+		int iNumber = (int)strtol(chNumber, &end, radix);
+		if (end == chNumber || iNumber < 0) {
+			return;
+		}
+
+		if (bIncrease && iNumber < INT_MAX) {
+			iNumber++;
+		}
+		if (!bIncrease && iNumber > 0) {
+			iNumber--;
+		}
+
+		const int iWidth = (int)strlen(chNumber) - ((ptr != NULL) ? 2 : 0);
+		if (ptr != NULL) {
+			if (*ptr == 'X') {
+				sprintf(chNumber, "%#0*X", iWidth, iNumber);
+			} else {
+				sprintf(chNumber, "%#0*x", iWidth, iNumber);
+			}
+		} else {
+			sprintf(chNumber, "%0*i", iWidth, iNumber);
+		}
+		EditReplaceMainSelection(strlen(chNumber), chNumber);
+	}
+}
+
+//=============================================================================
+//
+// EditTabsToSpaces()
+//
+// find first tab, CR, LF or (when bSpace is TRUE) space in [ptr, end), return end when not found.
+static const char *FindTabOrLineEnd(const char *ptr, const char *end, BOOL bSpace) {
+	const char space = bSpace ? ' ' : '\t';
+#if NP2_USE_AVX2
+	const __m256i vectTab = _mm256_set1_epi8('\t');
+	const __m256i vectCR = _mm256_set1_epi8('\r');
+	const __m256i vectLF = _mm256_set1_epi8('\n');
+	const __m256i vectSpace = _mm256_set1_epi8(space);
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i *)ptr);
+		const __m256i result = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectTab), _mm256_cmpeq_epi8(chunk, vectSpace)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectCR), _mm256_cmpeq_epi8(chunk, vectLF)));
+		const uint32_t mask = _mm256_movemask_epi8(result);
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m256i);
+	}
+#elif NP2_USE_SSE2
+	const __m128i vectTab = _mm_set1_epi8('\t');
+	const __m128i vectCR = _mm_set1_epi8('\r');
+	const __m128i vectLF = _mm_set1_epi8('\n');
+	const __m128i vectSpace = _mm_set1_epi8(space);
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		const __m128i result = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, vectTab), _mm_cmpeq_epi8(chunk, vectSpace)),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, vectCR), _mm_cmpeq_epi8(chunk, vectLF)));
+		const uint32_t mask = _mm_movemask_epi8(result);
+		if (mask != 0) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m128i);
+	}
+#endif
+	while (ptr < end && *ptr != '\t' && *ptr != space && *ptr != '\r' && *ptr != '\n') {
+		++ptr;
+	}
+	return ptr;
+}
+
+// character count in [ptr, end), a DBCS character or an UTF-8 sequence counts as one column.
+static Sci_Position CountColumns(const char *ptr, const char *end, UINT cpEdit) {
+	Sci_Position count = end - ptr;
+	if (cpEdit == SC_CP_UTF8) {
+		while (ptr < end) {
+			count -= ((uint8_t)(*ptr++) & 0xC0) == 0x80;
+		}
+	} else if (cpEdit != 0) {
+		while (ptr < end) {
+			if (IsDBCSLeadByteEx(cpEdit, (uint8_t)(*ptr++)) && ptr < end) {
+				++ptr;
+				--count;
+			}
+		}
+	}
+	return count;
+}
+
+void EditTabsToSpaces(int nTabWidth, BOOL bOnlyIndentingWS) {
+	if (SciCall_IsSelectionEmpty()) {
+		return;
+	}
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+
+	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
+	iSelStart = SciCall_PositionFromLine(iLine);
+
+	const Sci_Position iSelCount = iSelEnd - iSelStart;
+	const char *pszText = SciCall_GetRangePointer(iSelStart, iSelCount);
+	const char * const end = pszText + iSelCount;
+	const UINT cpEdit = SciCall_GetCodePage();
+
+	Sci_Position tabCount = 0;
+	for (const char *ptr = FindEitherChar(pszText, end, '\t', '\t'); ptr < end; ptr = FindEitherChar(ptr + 1, end, '\t', '\t')) {
+		++tabCount;
+	}
+	if (tabCount == 0) {
+		return;
+	}
+
+	char *pszConv = (char *)NP2HeapAlloc(iSelCount + tabCount*(nTabWidth - 1) + 1);
+	char *out = pszConv;
+	BOOL bModified = FALSE;
+	// column is counted from line start or last tab
+	const char *column = pszText;
+	const char *ptr = pszText;
+	while (ptr < end) {
+		const char *next = FindTabOrLineEnd(ptr, end, FALSE);
+		if (bOnlyIndentingWS) {
+			const char *p = ptr;
+			while (p < next && *p == ' ') {
+				++p;
+			}
+			if (p != next) {
+				// skip to line end after indentation
+				next = FindEitherChar(p, end, '\r', '\n');
+				memcpy(out, ptr, next - ptr);
+				out += next - ptr;
+				ptr = next;
+				if (ptr < end) {
+					*out++ = *ptr++;
+				}
+				column = ptr;
+				continue;
+			}
+		}
+		memcpy(out, ptr, next - ptr);
+		out += next - ptr;
+		if (next == end) {
+			break;
+		}
+		if (*next == '\t') {
+			const int count = nTabWidth - (int)(CountColumns(column, next, cpEdit) % nTabWidth);
+			memset(out, ' ', count);
+			out += count;
+			bModified = TRUE;
+		} else {
+			*out++ = *next;
+		}
+		ptr = next + 1;
+		column = ptr;
+	}
+
+	if (bModified) {
+		EditReplaceRange(iSelStart, iSelEnd, out - pszConv, pszConv);
+	}
+	NP2HeapFree(pszConv);
+}
+
+//=============================================================================
+//
+// EditSpacesToTabs()
+//
+void EditSpacesToTabs(int nTabWidth, BOOL bOnlyIndentingWS) {
+	if (SciCall_IsSelectionEmpty()) {
+		return;
+	}
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+
+	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
+	iSelStart = SciCall_PositionFromLine(iLine);
+
+	const Sci_Position iSelCount = iSelEnd - iSelStart;
+	const char *pszText = SciCall_GetRangePointer(iSelStart, iSelCount);
+	const char * const end = pszText + iSelCount;
+	const UINT cpEdit = SciCall_GetCodePage();
+
+	char *pszConv = (char *)NP2HeapAlloc(iSelCount + 1);
+	char *out = pszConv;
+	BOOL bIsLineStart = TRUE;
+	BOOL bModified = FALSE;
+	// column of first pending blank, pending blanks are kept when not reach next tab stop.
+	Sci_Position column = 0;
+	const char *pending = pszText;
+	int pendingCount = 0;
+	const char *ptr = pszText;
+	while (ptr < end) {
+		const char *next = (bOnlyIndentingWS && !bIsLineStart) ? FindEitherChar(ptr, end, '\r', '\n') : FindTabOrLineEnd(ptr, end, TRUE);
+		if (next != ptr) {
+			// flush pending blanks before other characters
+			memcpy(out, pending, pendingCount);
+			out += pendingCount;
+			column += pendingCount + CountColumns(ptr, next, cpEdit);
+			memcpy(out, ptr, next - ptr);
+			out += next - ptr;
+			pendingCount = 0;
+			bIsLineStart = FALSE;
+		}
+		if (next == end) {
+			break;
+		}
+
+		const char ch = *next;
+		ptr = next + 1;
+		if (ch == '\r' || ch == '\n') {
+			memcpy(out, pending, pendingCount);
+			out += pendingCount;
+			*out++ = ch;
+			pendingCount = 0;
+			column = 0;
+			bIsLineStart = TRUE;
+		} else if (bOnlyIndentingWS && !bIsLineStart) {
+			// blank after other characters is kept
+			*out++ = ch;
+		} else {
+			if (pendingCount == 0) {
+				pending = next;
+			}
+			++pendingCount;
+			if (pendingCount == nTabWidth - (column % nTabWidth) || ch == '\t') {
+				if (pendingCount > 1 || (ptr < end && (*ptr == ' ' || *ptr == '\t'))) {
+					*out++ = '\t';
+					bModified = bModified || pendingCount != 1 || ch != '\t';
+				} else {
+					*out++ = ch;
+				}
+				column = 0;
+				pendingCount = 0;
+			}
+		}
+	}
+	memcpy(out, pending, pendingCount);
+	out += pendingCount;
+
+	if (bModified) {
+		EditReplaceRange(iSelStart, iSelEnd, out - pszConv, pszConv);
+	}
+	NP2HeapFree(pszConv);
+}
+
+//=============================================================================
+//
+// EditMoveUp()
+//
+void EditMoveUp(void) {
+	Sci_Position iCurPos = SciCall_GetCurrentPos();
+	Sci_Position iAnchorPos = SciCall_GetAnchor();
+	const Sci_Line iCurLine = SciCall_LineFromPosition(iCurPos);
+	const Sci_Line iAnchorLine = SciCall_LineFromPosition(iAnchorPos);
+
+	if (iCurLine == iAnchorLine) {
+		const Sci_Position iLineCurPos = iCurPos - SciCall_PositionFromLine(iCurLine);
+		const Sci_Position iLineAnchorPos = iAnchorPos - SciCall_PositionFromLine(iAnchorLine);
+		//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
+		//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
+		//if (iLineCur == iLineAnchor) {
+		//}
+
+		if (iCurLine > 0) {
+			SciCall_BeginUndoAction();
+			SciCall_LineTranspose();
+			SciCall_SetSel(SciCall_PositionFromLine(iAnchorLine - 1) + iLineAnchorPos, SciCall_PositionFromLine(iCurLine - 1) + iLineCurPos);
+			SciCall_ChooseCaretX();
+			SciCall_EndUndoAction();
+		}
+		return;
+	}
+
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	const Sci_Line iLineSrc = min_pos(iCurLine, iAnchorLine) - 1;
+	//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
+	//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
+	//if (iLineCur == iLineAnchor) {
+	//}
+
+	if (iLineSrc >= 0) {
+		const Sci_Position cLine = SciCall_GetLineLength(iLineSrc);
+		char *pLine = (char *)NP2HeapAlloc(cLine + 1);
+		SciCall_GetLine(iLineSrc, pLine);
+
+		const Sci_Position iLineSrcStart = SciCall_PositionFromLine(iLineSrc);
+		const Sci_Position iLineSrcEnd = SciCall_PositionFromLine(iLineSrc + 1);
+
+		Sci_Line iLineDest = max_pos(iCurLine, iAnchorLine);
+		if (max_pos(iCurPos, iAnchorPos) <= SciCall_PositionFromLine(iLineDest)) {
+			if (iLineDest >= 1) {
+				iLineDest--;
+			}
+		}
+
+		SciCall_BeginUndoAction();
+
+		SciCall_SetTargetRange(iLineSrcStart, iLineSrcEnd);
+		SciCall_ReplaceTarget(0, "");
+
+		const Sci_Position iLineDestStart = SciCall_PositionFromLine(iLineDest);
+		SciCall_InsertText(iLineDestStart, pLine);
+		NP2HeapFree(pLine);
+
+		if (iLineDest == SciCall_GetLineCount() - 1) {
+			char chaEOL[] = "\r\n";
+			const int iEOLMode = SciCall_GetEOLMode();
+			if (iEOLMode == SC_EOL_CR) {
+				chaEOL[1] = 0;
+			} else if (iEOLMode == SC_EOL_LF) {
+				chaEOL[0] = '\n';
+				chaEOL[1] = 0;
+			}
+
+			SciCall_InsertText(iLineDestStart, chaEOL);
+			SciCall_SetTargetRange(SciCall_GetLineEndPosition(iLineDest), SciCall_GetLength());
+			SciCall_ReplaceTarget(0, "");
+		}
+
+		if (iCurPos < iAnchorPos) {
+			iCurPos = SciCall_PositionFromLine(iCurLine - 1);
+			iAnchorPos = SciCall_PositionFromLine(iLineDest);
+		} else {
+			iAnchorPos = SciCall_PositionFromLine(iAnchorLine - 1);
+			iCurPos = SciCall_PositionFromLine(iLineDest);
+		}
+
+		SciCall_SetSel(iAnchorPos, iCurPos);
+
+		SciCall_EndUndoAction();
+	}
+}
+
+//=============================================================================
+//
+// EditMoveDown()
+//
+void EditMoveDown(void) {
+	Sci_Position iCurPos = SciCall_GetCurrentPos();
+	Sci_Position iAnchorPos = SciCall_GetAnchor();
+	const Sci_Line iCurLine = SciCall_LineFromPosition(iCurPos);
+	const Sci_Line iAnchorLine = SciCall_LineFromPosition(iAnchorPos);
+
+	if (iCurLine == iAnchorLine) {
+		const Sci_Position iLineCurPos = iCurPos - SciCall_PositionFromLine(iCurLine);
+		const Sci_Position iLineAnchorPos = iAnchorPos - SciCall_PositionFromLine(iAnchorLine);
+		//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
+		//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
+		//if (iLineCur == iLineAnchor) {
+		//}
+
+		if (iCurLine < SciCall_GetLineCount() - 1) {
+			SciCall_BeginUndoAction();
+			SciCall_GotoLine(iCurLine + 1);
+			SciCall_LineTranspose();
+			SciCall_SetSel(SciCall_PositionFromLine(iAnchorLine + 1) + iLineAnchorPos, SciCall_PositionFromLine(iCurLine + 1) + iLineCurPos);
+			SciCall_ChooseCaretX();
+			SciCall_EndUndoAction();
+		}
+		return;
+	}
+
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	Sci_Line iLineSrc = max_pos(iCurLine, iAnchorLine) + 1;
+	//const Sci_Line iLineCur = SciCall_DocLineFromVisible(iCurLine);
+	//const Sci_Line iLineAnchor = SciCall_DocLineFromVisible(iAnchorLine);
+	//if (iLineCur == iLineAnchor) {
+	//}
+
+	if (max_pos(iCurPos, iAnchorPos) <= SciCall_PositionFromLine(iLineSrc - 1)) {
+		if (iLineSrc >= 1) {
+			iLineSrc--;
+		}
+	}
+
+	if (iLineSrc <= SciCall_GetLineCount() - 1) {
+		const BOOL bLastLine = (iLineSrc == SciCall_GetLineCount() - 1);
+
+		if (bLastLine &&
+				(SciCall_GetLineEndPosition(iLineSrc) == SciCall_PositionFromLine(iLineSrc)) &&
+				(SciCall_GetLineEndPosition(iLineSrc - 1) == SciCall_PositionFromLine(iLineSrc - 1))) {
+			return;
+		}
+
+		if (bLastLine) {
+			char chaEOL[] = "\r\n";
+			const int iEOLMode = SciCall_GetEOLMode();
+			if (iEOLMode == SC_EOL_CR) {
+				chaEOL[1] = 0;
+			} else if (iEOLMode == SC_EOL_LF) {
+				chaEOL[0] = '\n';
+				chaEOL[1] = 0;
+			}
+			SciCall_AppendText(strlen(chaEOL), chaEOL);
+		}
+
+		const Sci_Position cLine = SciCall_GetLineLength(iLineSrc);
+		char *pLine = (char *)NP2HeapAlloc(cLine + 3);
+		SciCall_GetLine(iLineSrc, pLine);
+
+		const Sci_Position iLineSrcStart = SciCall_PositionFromLine(iLineSrc);
+		const Sci_Position iLineSrcEnd = SciCall_PositionFromLine(iLineSrc + 1);
+		const Sci_Line iLineDest = min_pos(iCurLine, iAnchorLine);
+
+		SciCall_BeginUndoAction();
+
+		SciCall_SetTargetRange(iLineSrcStart, iLineSrcEnd);
+		SciCall_ReplaceTarget(0, "");
+
+		const Sci_Position iLineDestStart = SciCall_PositionFromLine(iLineDest);
+		SciCall_InsertText(iLineDestStart, pLine);
+
+		if (bLastLine) {
+			SciCall_SetTargetRange(SciCall_GetLineEndPosition(SciCall_GetLineCount() - 2), SciCall_GetLength());
+			SciCall_ReplaceTarget(0, "");
+		}
+
+		NP2HeapFree(pLine);
+
+		if (iCurPos < iAnchorPos) {
+			iCurPos = SciCall_PositionFromLine(iCurLine + 1);
+			iAnchorPos = SciCall_PositionFromLine(iLineSrc + 1);
+		} else {
+			iAnchorPos = SciCall_PositionFromLine(iAnchorLine + 1);
+			iCurPos = SciCall_PositionFromLine(iLineSrc + 1);
+		}
+
+		SciCall_SetSel(iAnchorPos, iCurPos);
+
+		SciCall_EndUndoAction();
+	}
+}
+
+// only convert CR+LF
+static void ConvertWinEditLineEndingsEx(char *s, int iEOLMode, int *lineCount) {
+	int count = 0;
+	if (iEOLMode != SC_EOL_CRLF) {
+		char *p = s;
+		const char chaEOL = (iEOLMode == SC_EOL_LF) ? '\n' : '\r';
+		while (*s) {
+			switch (*s) {
+			case '\r':
+				++count;
+				if (s[1] == '\n') {
+					++s;
+					*p++ = chaEOL;
+				} else {
+					*p++ = '\r';
+				}
+				++s;
+				break;
+
+			case '\n':
+				++count;
+				*p++ = '\n';
+				++s;
+				break;
+
+			default:
+				*p++ = *s++;
+				break;
+			}
+		}
+
+		*p = '\0';
+		if (lineCount != NULL) {
+			*lineCount = count;
+		}
+	} else if (lineCount != NULL) {
+		while (*s) {
+			switch (*s++) {
+			case '\r':
+				++count;
+				if (*s == '\n') {
+					++s;
+				}
+				break;
+
+			case '\n':
+				++count;
+				break;
+			}
+		}
+		*lineCount = count;
+	}
+}
+
+static inline void ConvertWinEditLineEndings(char *s, int iEOLMode) {
+	ConvertWinEditLineEndingsEx(s, iEOLMode, NULL);
+}
+
+//=============================================================================
+//
+// LineEditList: replacements applied as one document change and undo action.
+//
+typedef struct LineEditList {
+	struct Sci_TextReplacement *ranges;
+	Sci_Position count;
+	Sci_Position capacity;
+	char *text;
+	Sci_Position length;
+	Sci_Position size;
+} LineEditList;
+
+static void LineEditList_Free(LineEditList *list) {
+	if (list->ranges != NULL) {
+		NP2HeapFree(list->ranges);
+	}
+	if (list->text != NULL) {
+		NP2HeapFree(list->text);
+	}
+	ZeroMemory(list, sizeof(LineEditList));
+}
+
+// a list is failed after out of memory, it's empty and ignores further replacements.
+static inline BOOL LineEditList_Failed(const LineEditList *list) {
+	return list->capacity < 0;
+}
+
+static void LineEditList_Fail(LineEditList *list) {
+	LineEditList_Free(list);
+	list->capacity = -1;
+}
+
+// positions are before any replacement and must be added in ascending order,
+// returns buffer for the inserted text, which is valid until next call, or NULL when out of memory.
+static char *LineEditList_Add(LineEditList *list, Sci_Position position, Sci_Position deleteLength, Sci_Position insertLength) {
+	if (LineEditList_Failed(list)) {
+		return NULL;
+	}
+	if (list->count == list->capacity) {
+		const Sci_Position capacity = max_pos(1024, 2*list->capacity);
+		const size_t size = capacity * sizeof(struct Sci_TextReplacement);
+		struct Sci_TextReplacement *ranges = (struct Sci_TextReplacement *)(list->ranges ? NP2HeapReAlloc(list->ranges, size) : NP2HeapAlloc(size));
+		if (ranges == NULL) {
+			LineEditList_Fail(list);
+			return NULL;
+		}
+		list->ranges = ranges;
+		list->capacity = capacity;
+	}
+	const Sci_Position length = list->length + insertLength;
+	if (length >= list->size) {
+		const Sci_Position size = max_pos(length + 1, max_pos(64*1024, 2*list->size));
+		char *text = (char *)(list->text ? NP2HeapReAlloc(list->text, size) : NP2HeapAlloc(size));
+		if (text == NULL) {
+			LineEditList_Fail(list);
+			return NULL;
+		}
+		list->text = text;
+		list->size = size;
+	}
+	struct Sci_TextReplacement *range = list->ranges + list->count;
+	range->position = position;
+	range->deleteLength = deleteLength;
+	range->insertLength = insertLength;
+	++list->count;
+	char *ptr = list->text + list->length;
+	list->length = length;
+	return ptr;
+}
+
+static inline BOOL LineEditList_AddText(LineEditList *list, Sci_Position position, Sci_Position deleteLength, const char *text, Sci_Position length) {
+	char *ptr = LineEditList_Add(list, position, deleteLength, length);
+	if (ptr != NULL) {
+		memcpy(ptr, text, length);
+	}
+	return ptr != NULL;
+}
+
+// document is not changed when the list is failed, returns change in document length.
+static Sci_Position LineEditList_Apply(LineEditList *list) {
+	Sci_Position delta = 0;
+	if (list->count != 0) {
+		// inserted text is stored in order of ranges
+		const char *text = list->text;
+		for (Sci_Position index = 0; index < list->count; index++) {
+			list->ranges[index].text = text;
+			text += list->ranges[index].insertLength;
+		}
+		delta = SciCall_ReplaceRanges(list->count, list->ranges);
+	}
+	LineEditList_Free(list);
+	return delta;
+}
+
+//=============================================================================
+//
+// EditModifyLines()
+//
+void EditModifyLines(LPCWSTR pwszPrefix, LPCWSTR pwszAppend) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+	if (StrIsEmpty(pwszPrefix) && StrIsEmpty(pwszAppend)) {
+		return;
+	}
+
+	BeginWaitCursor();
+
+	const UINT cpEdit = SciCall_GetCodePage();
+	const int iEOLMode = SciCall_GetEOLMode();
+
+	const int iPrefixLen = lstrlen(pwszPrefix);
+	char *mszPrefix1 = NULL;
+	int iPrefixLine = 0;
+	if (iPrefixLen != 0) {
+		const int size = iPrefixLen * kMaxMultiByteCount + 1;
+		mszPrefix1 = (char *)NP2HeapAlloc(size);
+		WideCharToMultiByte(cpEdit, 0, pwszPrefix, -1, mszPrefix1, size, NULL, NULL);
+		ConvertWinEditLineEndingsEx(mszPrefix1, iEOLMode, &iPrefixLine);
+	}
+
+	const int iAppendLen = lstrlen(pwszAppend);
+	char *mszAppend1 = NULL;
+	int iAppendLine = 0;
+	if (iAppendLen != 0) {
+		const int size = iAppendLen * kMaxMultiByteCount + 1;
+		mszAppend1 = (char *)NP2HeapAlloc(size);
+		WideCharToMultiByte(cpEdit, 0, pwszAppend, -1, mszAppend1, size, NULL, NULL);
+		ConvertWinEditLineEndingsEx(mszAppend1, iEOLMode, &iAppendLine);
+	}
+
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+
+	const Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
+	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+
+	//if (iSelStart > SciCall_PositionFromLine(iLineStart)) {
+	//	iLineStart++;
+	//}
+
+	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
+		if (iLineEnd - iLineStart >= 1) {
+			iLineEnd--;
+		}
+	}
+
+	BOOL bPrefixNumPadZero = FALSE;
+	char *mszPrefix2 = NULL;
+	Sci_Line iPrefixNum = 0;
+	int iPrefixNumWidth = 1;
+	BOOL bPrefixNum = FALSE;
+
+	BOOL bAppendNumPadZero = FALSE;
+	char *mszAppend2 = NULL;
+	Sci_Line iAppendNum = 0;
+	int iAppendNumWidth = 1;
+	BOOL bAppendNum = FALSE;
+
+	if (iPrefixLen != 0) {
+		char *p = mszPrefix1;
+		Sci_Line lineCount = 0;
+		mszPrefix2 = (char *)NP2HeapAlloc(iPrefixLen * kMaxMultiByteCount + 1);
+		while (!bPrefixNum && (p = strstr(p, "$(")) != NULL) {
+			if (StrStartsWith(p, "$(I)")) {
+				*p = 0;
+				strcpy(mszPrefix2, p + CSTRLEN("$(I)"));
+				bPrefixNum = TRUE;
+				iPrefixNum = 0;
+				lineCount = iLineEnd - iLineStart;
+				bPrefixNumPadZero = FALSE;
+			} else if (StrStartsWith(p, "$(0I)")) {
+				*p = 0;
+				strcpy(mszPrefix2, p + CSTRLEN("$(0I)"));
+				bPrefixNum = TRUE;
+				iPrefixNum = 0;
+				lineCount = iLineEnd - iLineStart;
+				bPrefixNumPadZero = TRUE;
+			} else if (StrStartsWith(p, "$(N)")) {
+				*p = 0;
+				strcpy(mszPrefix2, p + CSTRLEN("$(N)"));
+				bPrefixNum = TRUE;
+				iPrefixNum = 1;
+				lineCount = iLineEnd - iLineStart + 1;
+				bPrefixNumPadZero = FALSE;
+			} else if (StrStartsWith(p, "$(0N)")) {
+				*p = 0;
+				strcpy(mszPrefix2, p + CSTRLEN("$(0N)"));
+				bPrefixNum = TRUE;
+				iPrefixNum = 1;
+				lineCount = iLineEnd - iLineStart + 1;
+				bPrefixNumPadZero = TRUE;
+			} else if (StrStartsWith(p, "$(L)")) {
+				*p = 0;
+				strcpy(mszPrefix2, p + CSTRLEN("$(L)"));
+				bPrefixNum = TRUE;
+				iPrefixNum = iLineStart + 1;
+				lineCount = iLineEnd + 1;
+				bPrefixNumPadZero = FALSE;
+			} else if (StrStartsWith(p, "$(0L)")) {
+				*p = 0;
+				strcpy(mszPrefix2, p + CSTRLEN("$(0L)"));
+				bPrefixNum = TRUE;
+				iPrefixNum = iLineStart + 1;
+				lineCount = iLineEnd + 1;
+				bPrefixNumPadZero = TRUE;
+			}
+			p += CSTRLEN("$(");
+		}
+		if (bPrefixNum) {
+			while (lineCount >= 10) {
+				++iPrefixNumWidth;
+				lineCount /= 10;
+			}
+		}
+	}
 
-	const int iAppendLen = lstrlen(pwszAppend);
-	char *mszAppend1 = NULL;
-	int iAppendLine = 0;
 	if (iAppendLen != 0) {
-		const int size = iAppendLen * kMaxMultiByteCount + 1;
-		mszAppend1 = (char *)NP2HeapAlloc(size);
-		WideCharToMultiByte(cpEdit, 0, pwszAppend, -1, mszAppend1, size, NULL, NULL);
-		ConvertWinEditLineEndingsEx(mszAppend1, iEOLMode, &iAppendLine);
+		char *p = mszAppend1;
+		Sci_Line lineCount = 0;
+		mszAppend2 = (char *)NP2HeapAlloc(iAppendLen * kMaxMultiByteCount + 1);
+		while (!bAppendNum && (p = strstr(p, "$(")) != NULL) {
+			if (StrStartsWith(p, "$(I)")) {
+				*p = 0;
+				strcpy(mszAppend2, p + CSTRLEN("$(I)"));
+				bAppendNum = TRUE;
+				iAppendNum = 0;
+				lineCount = iLineEnd - iLineStart;
+				bAppendNumPadZero = FALSE;
+			} else if (StrStartsWith(p, "$(0I)")) {
+				*p = 0;
+				strcpy(mszAppend2, p + CSTRLEN("$(0I)"));
+				bAppendNum = TRUE;
+				iAppendNum = 0;
+				lineCount = iLineEnd - iLineStart;
+				bAppendNumPadZero = TRUE;
+			} else if (StrStartsWith(p, "$(N)")) {
+				*p = 0;
+				strcpy(mszAppend2, p + CSTRLEN("$(N)"));
+				bAppendNum = TRUE;
+				iAppendNum = 1;
+				lineCount = iLineEnd - iLineStart + 1;
+				bAppendNumPadZero = FALSE;
+			} else if (StrStartsWith(p, "$(0N)")) {
+				*p = 0;
+				strcpy(mszAppend2, p + CSTRLEN("$(0N)"));
+				bAppendNum = TRUE;
+				iAppendNum = 1;
+				lineCount = iLineEnd - iLineStart + 1;
+				bAppendNumPadZero = TRUE;
+			} else if (StrStartsWith(p, "$(L)")) {
+				*p = 0;
+				strcpy(mszAppend2, p + CSTRLEN("$(L)"));
+				bAppendNum = TRUE;
+				iAppendNum = iLineStart + 1;
+				lineCount = iLineEnd + 1;
+				bAppendNumPadZero = FALSE;
+			} else if (StrStartsWith(p, "$(0L)")) {
+				*p = 0;
+				strcpy(mszAppend2, p + CSTRLEN("$(0L)"));
+				bAppendNum = TRUE;
+				iAppendNum = iLineStart + 1;
+				lineCount = iLineEnd + 1;
+				bAppendNumPadZero = TRUE;
+			}
+			p += CSTRLEN("$(");
+		}
+		if (bAppendNum) {
+			while (lineCount >= 10) {
+				++iAppendNumWidth;
+				lineCount /= 10;
+			}
+		}
+	}
+
+	char *mszInsert = (char *)NP2HeapAlloc(2 * max_i(iPrefixLen, iAppendLen) * kMaxMultiByteCount + 1);
+	LineEditList list = { NULL, 0, 0, NULL, 0, 0 };
+	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd && !LineEditList_Failed(&list); iLine++) {
+		if (iPrefixLen != 0) {
+			strcpy(mszInsert, mszPrefix1);
+
+			if (bPrefixNum) {
+				char tchNum[64];
+#if defined(_WIN64)
+				if (bPrefixNumPadZero) {
+					sprintf(tchNum, "%0*" PRId64, iPrefixNumWidth, iPrefixNum);
+				} else {
+					sprintf(tchNum, "%*" PRId64, iPrefixNumWidth, iPrefixNum);
+				}
+#else
+				if (bPrefixNumPadZero) {
+					sprintf(tchNum, "%0*d", iPrefixNumWidth, (int)iPrefixNum);
+				} else {
+					sprintf(tchNum, "%*d", iPrefixNumWidth, (int)iPrefixNum);
+				}
+#endif
+				strcat(mszInsert, tchNum);
+				strcat(mszInsert, mszPrefix2);
+				iPrefixNum++;
+			}
+
+			const Sci_Position iPos = SciCall_PositionFromLine(iLine);
+			LineEditList_AddText(&list, iPos, 0, mszInsert, strlen(mszInsert));
+		}
+
+		if (iAppendLen != 0) {
+			strcpy(mszInsert, mszAppend1);
+
+			if (bAppendNum) {
+				char tchNum[64];
+#if defined(_WIN64)
+				if (bAppendNumPadZero) {
+					sprintf(tchNum, "%0*" PRId64, iAppendNumWidth, iAppendNum);
+				} else {
+					sprintf(tchNum, "%*" PRId64, iAppendNumWidth, iAppendNum);
+				}
+#else
+				if (bAppendNumPadZero) {
+					sprintf(tchNum, "%0*d", iAppendNumWidth, (int)iAppendNum);
+				} else {
+					sprintf(tchNum, "%*d", iAppendNumWidth, (int)iAppendNum);
+				}
+#endif
+				strcat(mszInsert, tchNum);
+				strcat(mszInsert, mszAppend2);
+				iAppendNum++;
+			}
+
+			const Sci_Position iPos = SciCall_GetLineEndPosition(iLine);
+			LineEditList_AddText(&list, iPos, 0, mszInsert, strlen(mszInsert));
+		}
+	}
+	LineEditList_Apply(&list);
+	iLineEnd += (iLineEnd - iLineStart + 1) * (iPrefixLine + iAppendLine);
+
+	//// Fix selection
+	//if (iSelStart != iSelEnd && SciCall_GetTargetEnd() > SciCall_GetSelectionEnd()) {
+	//	Sci_Position iCurPos = SciCall_GetCurrentPos();
+	//	Sci_Position iAnchorPos = SciCall_GetAnchor();
+	//	if (iCurPos > iAnchorPos)
+	//		iCurPos = SciCall_GetTargetEnd();
+	//	else
+	//		iAnchorPos = SciCall_GetTargetEnd();
+	//	SciCall_SetSel(iAnchorPos, iCurPos);
+	//}
+
+	// extend selection to start of first line
+	// the above code is not required when last line has been excluded
+	if (iSelStart != iSelEnd) {
+		Sci_Position iCurPos = SciCall_GetCurrentPos();
+		Sci_Position iAnchorPos = SciCall_GetAnchor();
+		if (iCurPos < iAnchorPos) {
+			iCurPos = SciCall_PositionFromLine(iLineStart);
+			iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
+		} else {
+			iAnchorPos = SciCall_PositionFromLine(iLineStart);
+			iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
+		}
+		SciCall_SetSel(iAnchorPos, iCurPos);
+	}
+
+	EndWaitCursor();
+	if (mszPrefix1 != NULL) {
+		NP2HeapFree(mszPrefix1);
+	}
+	if (mszAppend1 != NULL) {
+		NP2HeapFree(mszAppend1);
+	}
+	if (mszPrefix2 != NULL) {
+		NP2HeapFree(mszPrefix2);
+	}
+	if (mszAppend2 != NULL) {
+		NP2HeapFree(mszAppend2);
+	}
+	NP2HeapFree(mszInsert);
+}
+
+//=============================================================================
+//
+// EditAlignText()
+//
+static void EditAlignTextReplaceLine(LineEditList *list, Sci_Line iLine, const char *pszIndent, Sci_Position cchIndent, const char *pszText) {
+	const Sci_Position iStartPos = SciCall_PositionFromLine(iLine);
+	const Sci_Position iEndPos = SciCall_GetLineEndPosition(iLine);
+	const Sci_Position cchText = strlen(pszText);
+	char *ptr = LineEditList_Add(list, iStartPos, iEndPos - iStartPos, cchIndent + cchText);
+	if (ptr != NULL) {
+		memcpy(ptr, pszIndent, cchIndent);
+		memcpy(ptr + cchIndent, pszText, cchText);
+	}
+}
+
+void EditAlignText(int nMode) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+#define BUFSIZE_ALIGN 1024
+
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	Sci_Position iCurPos = SciCall_GetCurrentPos();
+	Sci_Position iAnchorPos = SciCall_GetAnchor();
+	const UINT cpEdit = SciCall_GetCodePage();
+
+	const Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
+	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+
+	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
+		if (iLineEnd - iLineStart >= 1) {
+			iLineEnd--;
+		}
+	}
+
+	Sci_Position iMinIndent = BUFSIZE_ALIGN;
+	Sci_Position iMaxLength = 0;
+	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
+		Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iLine);
+		const Sci_Position iLineIndentPos = SciCall_GetLineIndentPosition(iLine);
+
+		if (iLineIndentPos != iLineEndPos) {
+			const Sci_Position iIndentCol = SciCall_GetLineIndentation(iLine);
+			Sci_Position iTail = iLineEndPos - 1;
+			int ch = SciCall_GetCharAt(iTail);
+			while (iTail >= iLineStart && (ch == ' ' || ch == '\t')) {
+				iTail--;
+				ch = SciCall_GetCharAt(iTail);
+				iLineEndPos--;
+			}
+
+			const Sci_Position iEndCol = SciCall_GetColumn(iLineEndPos);
+			iMinIndent = min_pos(iMinIndent, iIndentCol);
+			iMaxLength = max_pos(iMaxLength, iEndCol);
+		}
+	}
+
+	if (iMaxLength < BUFSIZE_ALIGN) {
+		// same tabs and spaces as SCI_SETLINEINDENTATION
+		char tchIndent[BUFSIZE_ALIGN];
+		Sci_Position cchIndent = 0;
+		Sci_Position count = iMinIndent;
+		const int tabWidth = fvCurFile.iTabWidth;
+		if (!fvCurFile.bTabsAsSpaces && tabWidth > 0) {
+			cchIndent = iMinIndent / tabWidth;
+			FillMemory(tchIndent, cchIndent, '\t');
+			count -= cchIndent * tabWidth;
+		}
+		FillMemory(tchIndent + cchIndent, count, ' ');
+		cchIndent += count;
+
+		LineEditList list = { NULL, 0, 0, NULL, 0, 0 };
+		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd && !LineEditList_Failed(&list); iLine++) {
+			const Sci_Position iIndentPos = SciCall_GetLineIndentPosition(iLine);
+			const Sci_Position iEndPos = SciCall_GetLineEndPosition(iLine);
+
+			if (iIndentPos == iEndPos) {
+				const Sci_Position iStartPos = SciCall_PositionFromLine(iLine);
+				if (iEndPos > iStartPos) {
+					LineEditList_Add(&list, iStartPos, iEndPos - iStartPos, 0);
+				}
+			} else {
+				char tchLineBuf[BUFSIZE_ALIGN * kMaxMultiByteCount] = "";
+				WCHAR wchLineBuf[BUFSIZE_ALIGN] = L"";
+				WCHAR *pWords[BUFSIZE_ALIGN];
+				WCHAR *p = wchLineBuf;
+
+				int iWords = 0;
+				Sci_Position iWordsLength = 0;
+				const Sci_Position cchLine = SciCall_GetLine(iLine, tchLineBuf);
+
+				MultiByteToWideChar(cpEdit, 0, tchLineBuf, (int)cchLine, wchLineBuf, COUNTOF(wchLineBuf));
+				StrTrim(wchLineBuf, L"\r\n\t ");
+
+				while (*p) {
+					if (*p != L' ' && *p != L'\t') {
+						pWords[iWords++] = p++;
+						iWordsLength++;
+						while (*p && *p != L' ' && *p != L'\t') {
+							p++;
+							iWordsLength++;
+						}
+					} else {
+						*p++ = 0;
+					}
+				}
+
+				if (iWords > 0) {
+					if (nMode == ALIGN_JUSTIFY || nMode == ALIGN_JUSTIFY_EX) {
+						BOOL bNextLineIsBlank = FALSE;
+						if (nMode == ALIGN_JUSTIFY_EX) {
+							if (SciCall_GetLineCount() <= iLine + 1) {
+								bNextLineIsBlank = TRUE;
+							} else {
+								const Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iLine + 1);
+								const Sci_Position iLineIndentPos = SciCall_GetLineIndentPosition(iLine + 1);
+								if (iLineIndentPos == iLineEndPos) {
+									bNextLineIsBlank = TRUE;
+								}
+							}
+						}
+
+						if ((nMode == ALIGN_JUSTIFY || nMode == ALIGN_JUSTIFY_EX) &&
+								iWords > 1 && iWordsLength >= 2 &&
+								((nMode != ALIGN_JUSTIFY_EX || !bNextLineIsBlank || iLineStart == iLineEnd) ||
+								 (bNextLineIsBlank && iWordsLength*4 > (iMaxLength - iMinIndent)*3))) {
+							const int iGaps = iWords - 1;
+							const Sci_Position iSpacesPerGap = (iMaxLength - iMinIndent - iWordsLength) / iGaps;
+							const Sci_Position iExtraSpaces = (iMaxLength - iMinIndent - iWordsLength) % iGaps;
+
+							WCHAR wchNewLineBuf[BUFSIZE_ALIGN * 3];
+							lstrcpy(wchNewLineBuf, pWords[0]);
+							p = StrEnd(wchNewLineBuf);
+
+							for (int i = 1; i < iWords; i++) {
+								for (Sci_Position j = 0; j < iSpacesPerGap; j++) {
+									*p++ = L' ';
+									*p = 0;
+								}
+								if (i > iGaps - iExtraSpaces) {
+									*p++ = L' ';
+									*p = 0;
+								}
+								lstrcat(p, pWords[i]);
+								p = StrEnd(p);
+							}
+
+							WideCharToMultiByte(cpEdit, 0, wchNewLineBuf, -1, tchLineBuf, COUNTOF(tchLineBuf), NULL, NULL);
+							EditAlignTextReplaceLine(&list, iLine, tchIndent, cchIndent, tchLineBuf);
+						} else {
+							WCHAR wchNewLineBuf[BUFSIZE_ALIGN];
+							lstrcpy(wchNewLineBuf, pWords[0]);
+							p = StrEnd(wchNewLineBuf);
+
+							for (int i = 1; i < iWords; i++) {
+								*p++ = L' ';
+								*p = 0;
+								lstrcat(wchNewLineBuf, pWords[i]);
+								p = StrEnd(p);
+							}
+
+							WideCharToMultiByte(cpEdit, 0, wchNewLineBuf, -1, tchLineBuf, COUNTOF(tchLineBuf), NULL, NULL);
+							EditAlignTextReplaceLine(&list, iLine, tchIndent, cchIndent, tchLineBuf);
+						}
+					} else {
+						const Sci_Position iExtraSpaces = iMaxLength - iMinIndent - iWordsLength - iWords + 1;
+						Sci_Position iOddSpaces = iExtraSpaces % 2;
+
+						WCHAR wchNewLineBuf[BUFSIZE_ALIGN * 3] = L"";
+						p = wchNewLineBuf;
+
+						if (nMode == ALIGN_RIGHT) {
+							for (Sci_Position i = 0; i < iExtraSpaces; i++) {
+								*p++ = L' ';
+							}
+							*p = 0;
+						}
+
+						if (nMode == ALIGN_CENTER) {
+							for (Sci_Position i = 1; i < iExtraSpaces - iOddSpaces; i += 2) {
+								*p++ = L' ';
+							}
+							*p = 0;
+						}
+
+						for (int i = 0; i < iWords; i++) {
+							lstrcat(p, pWords[i]);
+							if (i < iWords - 1) {
+								lstrcat(p, L" ");
+							}
+							if (nMode == ALIGN_CENTER && iWords > 1 && iOddSpaces > 0 && i + 1 >= iWords / 2) {
+								lstrcat(p, L" ");
+								iOddSpaces--;
+							}
+							p = StrEnd(p);
+						}
+
+						WideCharToMultiByte(cpEdit, 0, wchNewLineBuf, -1, tchLineBuf, COUNTOF(tchLineBuf), NULL, NULL);
+						EditAlignTextReplaceLine(&list, iLine, tchIndent, cchIndent, tchLineBuf);
+					}
+				}
+			}
+		}
+		LineEditList_Apply(&list);
+	} else {
+		MsgBoxInfo(MB_OK, IDS_BUFFERTOOSMALL);
+	}
+
+	if (iCurPos < iAnchorPos) {
+		iCurPos = SciCall_PositionFromLine(iLineStart);
+		iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
+	} else {
+		iAnchorPos = SciCall_PositionFromLine(iLineStart);
+		iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
+	}
+	SciCall_SetSel(iAnchorPos, iCurPos);
+}
+
+//=============================================================================
+//
+// EditEncloseSelection()
+//
+void EditEncloseSelection(LPCWSTR pwszOpen, LPCWSTR pwszClose) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+	if (StrIsEmpty(pwszOpen) && StrIsEmpty(pwszClose)) {
+		return;
+	}
+
+	BeginWaitCursor();
+
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	const UINT cpEdit = SciCall_GetCodePage();
+	const int iEOLMode = SciCall_GetEOLMode();
+
+	char *mszOpen = NULL;
+	int len = lstrlen(pwszOpen);
+	if (len != 0) {
+		const int size = kMaxMultiByteCount * len + 1;
+		mszOpen = (char *)NP2HeapAlloc(size);
+		WideCharToMultiByte(cpEdit, 0, pwszOpen, -1, mszOpen, size, NULL, NULL);
+		ConvertWinEditLineEndings(mszOpen, iEOLMode);
+	}
+
+	char *mszClose = NULL;
+	len = lstrlen(pwszClose);
+	if (len != 0) {
+		const int size = kMaxMultiByteCount * len + 1;
+		mszClose = (char *)NP2HeapAlloc(size);
+		WideCharToMultiByte(cpEdit, 0, pwszClose, -1, mszClose, size, NULL, NULL);
+		ConvertWinEditLineEndings(mszClose, iEOLMode);
+	}
+
+	SciCall_BeginUndoAction();
+	len = 0;
+
+	if (StrNotEmptyA(mszOpen)) {
+		len = (int)strlen(mszOpen);
+		SciCall_SetTargetRange(iSelStart, iSelStart);
+		SciCall_ReplaceTarget(len, mszOpen);
+	}
+
+	if (StrNotEmptyA(mszClose)) {
+		SciCall_SetTargetRange(iSelEnd + len, iSelEnd + len);
+		SciCall_ReplaceTarget(strlen(mszClose), mszClose);
+	}
+
+	SciCall_EndUndoAction();
+
+	// Fix selection
+	if (iSelStart == iSelEnd) {
+		SciCall_SetSel(iSelStart + len, iSelStart + len);
+	} else {
+		Sci_Position iCurPos = SciCall_GetCurrentPos();
+		Sci_Position iAnchorPos = SciCall_GetAnchor();
+
+		if (iCurPos < iAnchorPos) {
+			iCurPos = iSelStart + len;
+			iAnchorPos = iSelEnd + len;
+		} else {
+			iAnchorPos = iSelStart + len;
+			iCurPos = iSelEnd + len;
+		}
+		SciCall_SetSel(iAnchorPos, iCurPos);
+	}
+
+	EndWaitCursor();
+	if (mszOpen != NULL) {
+		NP2HeapFree(mszOpen);
+	}
+	if (mszClose != NULL) {
+		NP2HeapFree(mszClose);
+	}
+}
+
+//=============================================================================
+//
+// EditToggleLineComments()
+//
+void EditToggleLineComments(LPCWSTR pwszComment, BOOL bInsertAtStart) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	BeginWaitCursor();
+
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	Sci_Position iCurPos = SciCall_GetCurrentPos();
+
+	char mszComment[256] = "";
+	const UINT cpEdit = SciCall_GetCodePage();
+	WideCharToMultiByte(cpEdit, 0, pwszComment, -1, mszComment, COUNTOF(mszComment), NULL, NULL);
+
+	const int cchComment = (int)strlen(mszComment);
+	const Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
+	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+
+	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
+		if (iLineEnd - iLineStart >= 1) {
+			iLineEnd--;
+		}
+	}
+
+	Sci_Position iCommentCol = 0;
+	if (!bInsertAtStart) {
+		iCommentCol = 1024;
+		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
+			const Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iLine);
+			const Sci_Position iLineIndentPos = SciCall_GetLineIndentPosition(iLine);
+
+			if (iLineIndentPos != iLineEndPos) {
+				const Sci_Position iIndentColumn = SciCall_GetColumn(iLineIndentPos);
+				iCommentCol = min_pos(iCommentCol, iIndentColumn);
+			}
+		}
+	}
+
+	LineEditList list = { NULL, 0, 0, NULL, 0, 0 };
+	int iAction = 0;
+
+	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd && !LineEditList_Failed(&list); iLine++) {
+		const Sci_Position iIndentPos = SciCall_GetLineIndentPosition(iLine);
+		BOOL bWhitespaceLine = FALSE;
+		// a line with [space/tab] only
+		if (iCommentCol && iIndentPos == SciCall_GetLineEndPosition(iLine)) {
+			//continue;
+			bWhitespaceLine = TRUE;
+		}
+
+		char tchBuf[32] = "";
+		struct Sci_TextRange tr = { { iIndentPos, iIndentPos + min_i(31, cchComment) }, tchBuf };
+		SciCall_GetTextRange(&tr);
+
+		Sci_Position iCommentPos;
+		if (StrStartsWithCaseEx(tchBuf, mszComment, cchComment)) {
+			int ch;
+			switch (iAction) {
+			case 0:
+				iAction = 2;
+				FALLTHROUGH_ATTR;
+				// fall through
+			case 2:
+				iCommentPos = iIndentPos;
+				// a line with [space/tab] comment only
+				ch = SciCall_GetCharAt(iIndentPos + cchComment);
+				if (ch == '\n' || ch == '\r') {
+					iCommentPos = SciCall_PositionFromLine(iLine);
+				}
+				LineEditList_Add(&list, iCommentPos, iIndentPos + cchComment - iCommentPos, 0);
+				break;
+			case 1:
+				iCommentPos = SciCall_FindColumn(iLine, iCommentCol);
+				ch = SciCall_GetCharAt(iCommentPos);
+				if (ch == '\t' || ch == ' ') {
+					LineEditList_AddText(&list, iCommentPos, 0, mszComment, cchComment);
+				}
+				break;
+			}
+		} else {
+			switch (iAction) {
+			case 0:
+				iAction = 1;
+				FALLTHROUGH_ATTR;
+				// fall through
+			case 1:
+				iCommentPos = SciCall_FindColumn(iLine, iCommentCol);
+				if (!bWhitespaceLine || (iLineStart == iLineEnd)) {
+					LineEditList_AddText(&list, iCommentPos, 0, mszComment, cchComment);
+				} else {
+					Sci_Position tab = 0;
+					Sci_Position count = iCommentCol;
+					const int tabWidth = fvCurFile.iTabWidth;
+					if (!fvCurFile.bTabsAsSpaces && tabWidth > 0) {
+						tab = iCommentCol / tabWidth;
+						count -= tab * tabWidth;
+					}
+					char *ptr = LineEditList_Add(&list, iCommentPos, 0, tab + count + cchComment);
+					if (ptr != NULL) {
+						FillMemory(ptr, tab, '\t');
+						FillMemory(ptr + tab, count, ' ');
+						memcpy(ptr + tab + count, mszComment, cchComment);
+					}
+				}
+				break;
+			case 2:
+				break;
+			}
+		}
 	}
 
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	LineEditList_Apply(&list);
 
-	const Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
-	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+	if (iSelStart != iSelEnd) {
+		Sci_Position iAnchorPos;
+		if (iCurPos == iSelStart) {
+			iCurPos = SciCall_PositionFromLine(iLineStart);
+			iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
+		} else {
+			iAnchorPos = SciCall_PositionFromLine(iLineStart);
+			iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
+		}
+		SciCall_SetSel(iAnchorPos, iCurPos);
+	}
 
-	//if (iSelStart > SciCall_PositionFromLine(iLineStart)) {
-	//	iLineStart++;
-	//}
+	EndWaitCursor();
+}
 
-	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
-		if (iLineEnd - iLineStart >= 1) {
-			iLineEnd--;
+//=============================================================================
+//
+// EditPadWithSpaces()
+//
+void EditPadWithSpaces(BOOL bSkipEmpty) {
+	Sci_Position iMaxColumn = 0;
+	BOOL bReducedSelection = FALSE;
+
+	Sci_Position iSelStart = 0;
+	Sci_Position iSelEnd = 0;
+
+	Sci_Line iLineStart = 0;
+	Sci_Line iLineEnd = 0;
+
+	Sci_Line iRcCurLine = 0;
+	Sci_Line iRcAnchorLine = 0;
+	Sci_Position iRcCurCol = 0;
+	Sci_Position iRcAnchorCol = 0;
+
+	const BOOL bIsRectangular = SciCall_IsRectangleSelection();
+	if (!bIsRectangular ) {
+		iSelStart = SciCall_GetSelectionStart();
+		iSelEnd = SciCall_GetSelectionEnd();
+
+		iLineStart = SciCall_LineFromPosition(iSelStart);
+		iLineEnd = SciCall_LineFromPosition(iSelEnd);
+
+		if (iLineStart == iLineEnd) {
+			iLineStart = 0;
+			iLineEnd = SciCall_GetLineCount() - 1;
+		} else {
+			if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
+				if (iLineEnd - iLineStart >= 1) {
+					iLineEnd--;
+					bReducedSelection = TRUE;
+				}
+			}
+		}
+
+		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
+			const Sci_Position iPos = SciCall_GetLineEndPosition(iLine);
+			iMaxColumn = max_pos(iMaxColumn, SciCall_GetColumn(iPos));
+		}
+	} else {
+		const Sci_Position iCurPos = SciCall_GetCurrentPos();
+		const Sci_Position iAnchorPos = SciCall_GetAnchor();
+
+		iRcCurLine = SciCall_LineFromPosition(iCurPos);
+		iRcAnchorLine = SciCall_LineFromPosition(iAnchorPos);
+
+		iRcCurCol = SciCall_GetColumn(iCurPos);
+		iRcAnchorCol = SciCall_GetColumn(iAnchorPos);
+
+		iLineStart = 0;
+		iLineEnd = SciCall_GetLineCount() - 1;
+
+		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
+			const Sci_Position iPos = SciCall_GetLineSelEndPosition(iLine);
+			if (iPos >= 0) {
+				iMaxColumn = max_pos(iMaxColumn, SciCall_GetColumn(iPos));
+			}
 		}
 	}
 
-	BOOL bPrefixNumPadZero = FALSE;
-	char *mszPrefix2 = NULL;
-	Sci_Line iPrefixNum = 0;
-	int iPrefixNumWidth = 1;
-	BOOL bPrefixNum = FALSE;
+	LineEditList list = { NULL, 0, 0, NULL, 0, 0 };
+	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd && !LineEditList_Failed(&list); iLine++) {
+		const Sci_Position iLineSelEndPos = SciCall_GetLineSelEndPosition(iLine);
+		if (bIsRectangular && iLineSelEndPos < 0) {
+			continue;
+		}
 
-	BOOL bAppendNumPadZero = FALSE;
-	char *mszAppend2 = NULL;
-	Sci_Line iAppendNum = 0;
-	int iAppendNumWidth = 1;
-	BOOL bAppendNum = FALSE;
+		const Sci_Position iPos = SciCall_GetLineEndPosition(iLine);
+		if (bIsRectangular && iPos > iLineSelEndPos) {
+			continue;
+		}
 
-	if (iPrefixLen != 0) {
-		char *p = mszPrefix1;
-		Sci_Line lineCount = 0;
-		mszPrefix2 = (char *)NP2HeapAlloc(iPrefixLen * kMaxMultiByteCount + 1);
-		while (!bPrefixNum && (p = strstr(p, "$(")) != NULL) {
-			if (StrStartsWith(p, "$(I)")) {
-				*p = 0;
-				strcpy(mszPrefix2, p + CSTRLEN("$(I)"));
-				bPrefixNum = TRUE;
-				iPrefixNum = 0;
-				lineCount = iLineEnd - iLineStart;
-				bPrefixNumPadZero = FALSE;
-			} else if (StrStartsWith(p, "$(0I)")) {
-				*p = 0;
-				strcpy(mszPrefix2, p + CSTRLEN("$(0I)"));
-				bPrefixNum = TRUE;
-				iPrefixNum = 0;
-				lineCount = iLineEnd - iLineStart;
-				bPrefixNumPadZero = TRUE;
-			} else if (StrStartsWith(p, "$(N)")) {
-				*p = 0;
-				strcpy(mszPrefix2, p + CSTRLEN("$(N)"));
-				bPrefixNum = TRUE;
-				iPrefixNum = 1;
-				lineCount = iLineEnd - iLineStart + 1;
-				bPrefixNumPadZero = FALSE;
-			} else if (StrStartsWith(p, "$(0N)")) {
-				*p = 0;
-				strcpy(mszPrefix2, p + CSTRLEN("$(0N)"));
-				bPrefixNum = TRUE;
-				iPrefixNum = 1;
-				lineCount = iLineEnd - iLineStart + 1;
-				bPrefixNumPadZero = TRUE;
-			} else if (StrStartsWith(p, "$(L)")) {
-				*p = 0;
-				strcpy(mszPrefix2, p + CSTRLEN("$(L)"));
-				bPrefixNum = TRUE;
-				iPrefixNum = iLineStart + 1;
-				lineCount = iLineEnd + 1;
-				bPrefixNumPadZero = FALSE;
-			} else if (StrStartsWith(p, "$(0L)")) {
-				*p = 0;
-				strcpy(mszPrefix2, p + CSTRLEN("$(0L)"));
-				bPrefixNum = TRUE;
-				iPrefixNum = iLineStart + 1;
-				lineCount = iLineEnd + 1;
-				bPrefixNumPadZero = TRUE;
+		if (bSkipEmpty && SciCall_PositionFromLine(iLine) >= iPos) {
+			continue;
+		}
+
+		const Sci_Position iPadLen = iMaxColumn - SciCall_GetColumn(iPos);
+		if (iPadLen > 0) {
+			char *ptr = LineEditList_Add(&list, iPos, 0, iPadLen);
+			if (ptr != NULL) {
+				FillMemory(ptr, iPadLen, ' ');
 			}
-			p += CSTRLEN("$(");
 		}
-		if (bPrefixNum) {
-			while (lineCount >= 10) {
-				++iPrefixNumWidth;
-				lineCount /= 10;
+	}
+
+	LineEditList_Apply(&list);
+
+	if (!bIsRectangular && SciCall_LineFromPosition(iSelStart) != SciCall_LineFromPosition(iSelEnd)) {
+		Sci_Position iCurPos = SciCall_GetCurrentPos();
+		Sci_Position iAnchorPos = SciCall_GetAnchor();
+
+		if (iCurPos < iAnchorPos) {
+			iCurPos = SciCall_PositionFromLine(iLineStart);
+			if (!bReducedSelection) {
+				iAnchorPos = SciCall_GetLineEndPosition(iLineEnd);
+			} else {
+				iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
+			}
+		} else {
+			iAnchorPos = SciCall_PositionFromLine(iLineStart);
+			if (!bReducedSelection) {
+				iCurPos = SciCall_GetLineEndPosition(iLineEnd);
+			} else {
+				iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
 			}
 		}
+		SciCall_SetSel(iAnchorPos, iCurPos);
+	} else if (bIsRectangular) {
+		const Sci_Position iCurPos = SciCall_FindColumn(iRcCurLine, iRcCurCol);
+		const Sci_Position iAnchorPos = SciCall_FindColumn(iRcAnchorLine, iRcAnchorCol);
+
+		SciCall_SetRectangularSelectionCaret(iCurPos);
+		SciCall_SetRectangularSelectionAnchor(iAnchorPos);
+	}
+}
+
+//=============================================================================
+//
+// EditStripFirstCharacter()
+//
+void EditStripFirstCharacter(void) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+
+	Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
+	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+
+	if (iLineStart != iLineEnd) {
+		if (iSelStart > SciCall_PositionFromLine(iLineStart)) {
+			iLineStart++;
+		}
+
+		if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
+			iLineEnd--;
+		}
+	}
+
+	SciCall_BeginUndoAction();
+	EditBeginBulkModification();
+
+	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
+		const Sci_Position iPos = SciCall_PositionFromLine(iLine);
+		if (SciCall_GetLineEndPosition(iLine) > iPos) {
+			SciCall_SetTargetRange(iPos, SciCall_PositionAfter(iPos));
+			SciCall_ReplaceTarget(0, "");
+		}
 	}
+	EditEndBulkModification();
+	SciCall_EndUndoAction();
+}
 
-	if (iAppendLen != 0) {
-		char *p = mszAppend1;
-		Sci_Line lineCount = 0;
-		mszAppend2 = (char *)NP2HeapAlloc(iAppendLen * kMaxMultiByteCount + 1);
-		while (!bAppendNum && (p = strstr(p, "$(")) != NULL) {
-			if (StrStartsWith(p, "$(I)")) {
-				*p = 0;
-				strcpy(mszAppend2, p + CSTRLEN("$(I)"));
-				bAppendNum = TRUE;
-				iAppendNum = 0;
-				lineCount = iLineEnd - iLineStart;
-				bAppendNumPadZero = FALSE;
-			} else if (StrStartsWith(p, "$(0I)")) {
-				*p = 0;
-				strcpy(mszAppend2, p + CSTRLEN("$(0I)"));
-				bAppendNum = TRUE;
-				iAppendNum = 0;
-				lineCount = iLineEnd - iLineStart;
-				bAppendNumPadZero = TRUE;
-			} else if (StrStartsWith(p, "$(N)")) {
-				*p = 0;
-				strcpy(mszAppend2, p + CSTRLEN("$(N)"));
-				bAppendNum = TRUE;
-				iAppendNum = 1;
-				lineCount = iLineEnd - iLineStart + 1;
-				bAppendNumPadZero = FALSE;
-			} else if (StrStartsWith(p, "$(0N)")) {
-				*p = 0;
-				strcpy(mszAppend2, p + CSTRLEN("$(0N)"));
-				bAppendNum = TRUE;
-				iAppendNum = 1;
-				lineCount = iLineEnd - iLineStart + 1;
-				bAppendNumPadZero = TRUE;
-			} else if (StrStartsWith(p, "$(L)")) {
-				*p = 0;
-				strcpy(mszAppend2, p + CSTRLEN("$(L)"));
-				bAppendNum = TRUE;
-				iAppendNum = iLineStart + 1;
-				lineCount = iLineEnd + 1;
-				bAppendNumPadZero = FALSE;
-			} else if (StrStartsWith(p, "$(0L)")) {
-				*p = 0;
-				strcpy(mszAppend2, p + CSTRLEN("$(0L)"));
-				bAppendNum = TRUE;
-				iAppendNum = iLineStart + 1;
-				lineCount = iLineEnd + 1;
-				bAppendNumPadZero = TRUE;
-			}
-			p += CSTRLEN("$(");
+//=============================================================================
+//
+// EditStripLastCharacter()
+//
+void EditStripLastCharacter(void) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+
+	Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
+	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+
+	if (iLineStart != iLineEnd) {
+		if (iSelStart >= SciCall_GetLineEndPosition(iLineStart)) {
+			iLineStart++;
 		}
-		if (bAppendNum) {
-			while (lineCount >= 10) {
-				++iAppendNumWidth;
-				lineCount /= 10;
-			}
+
+		if (iSelEnd < SciCall_GetLineEndPosition(iLineEnd)) {
+			iLineEnd--;
 		}
 	}
 
-	char *mszInsert = (char *)NP2HeapAlloc(2 * max_i(iPrefixLen, iAppendLen) * kMaxMultiByteCount + 1);
 	SciCall_BeginUndoAction();
-	for (Sci_Line iLine = iLineStart, iLineDest = iLineStart; iLine <= iLineEnd; iLine++, iLineDest++) {
-		if (iPrefixLen != 0) {
-			strcpy(mszInsert, mszPrefix1);
+	EditBeginBulkModification();
 
-			if (bPrefixNum) {
-				char tchNum[64];
-#if defined(_WIN64)
-				if (bPrefixNumPadZero) {
-					sprintf(tchNum, "%0*" PRId64, iPrefixNumWidth, iPrefixNum);
-				} else {
-					sprintf(tchNum, "%*" PRId64, iPrefixNumWidth, iPrefixNum);
+	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
+		const Sci_Position iStartPos = SciCall_PositionFromLine(iLine);
+		const Sci_Position iEndPos = SciCall_GetLineEndPosition(iLine);
+
+		if (iEndPos > iStartPos) {
+			SciCall_SetTargetRange(SciCall_PositionBefore(iEndPos), iEndPos);
+			SciCall_ReplaceTarget(0, "");
+		}
+	}
+	EditEndBulkModification();
+	SciCall_EndUndoAction();
+}
+
+//=============================================================================
+//
+// EditTransformLines()
+//
+enum {
+	LineTransform_TrimTrailing,
+	LineTransform_TrimLeading,
+	LineTransform_CompressSpaces,
+	LineTransform_RemoveBlank,
+	LineTransform_MergeBlank,
+};
+
+static inline BOOL IsBlankChar(char ch) {
+	return ch == ' ' || ch == '\t';
+}
+
+// transform lines in [iStartPos, iEndPos) with one pass over the range, only changed part
+// is replaced, main caret and anchor are moved into the new text.
+// bTrailingEmptyLine: range ends with the empty last line of the document.
+static BOOL EditTransformLines(Sci_Position iStartPos, Sci_Position iEndPos, int transform, BOOL bTrailingEmptyLine) {
+	const Sci_Position length = iEndPos - iStartPos;
+	if (length <= 0) {
+		return FALSE;
+	}
+
+	// first segment may start in middle of a line, last segment may stop in middle of a line.
+	const BOOL bRangeLineStart = iStartPos == SciCall_PositionFromLine(SciCall_LineFromPosition(iStartPos));
+	const BOOL bRangeLineEnd = iEndPos == SciCall_GetLineEndPosition(SciCall_LineFromPosition(iEndPos));
+	Sci_Position positions[2] = { SciCall_GetCurrentPos(), SciCall_GetAnchor() };
+	BOOL mapped[2] = { FALSE, FALSE };
+
+	// pszText points into document buffer, changed part of pszResult is replaced after the loop.
+	const char * const pszText = SciCall_GetRangePointer(iStartPos, length);
+	const char * const end = pszText + length;
+	char * const pszResult = (char *)NP2HeapAlloc(length + 1);
+	if (pszResult == NULL) {
+		return FALSE;
+	}
+
+	Sci_Position firstChange = -1;
+	Sci_Position lastChange = 0;
+	char *out = pszResult;
+	const char *ptr = pszText;
+	while (ptr < end) {
+		const char *lineEnd = FindEitherChar(ptr, end, '\r', '\n');
+		const char *next = lineEnd;
+		if (next < end) {
+			if (*next++ == '\r' && next < end && *next == '\n') {
+				++next;
+			}
+		}
+		const BOOL bLineStart = ptr != pszText || bRangeLineStart;
+		const BOOL bLineEnd = lineEnd != end || bRangeLineEnd;
+
+		Sci_Position lead = 0;
+		Sci_Position keep = lineEnd - ptr;
+		BOOL bDrop = FALSE;
+		char * const outStart = out;
+		switch (transform) {
+		case LineTransform_TrimTrailing:
+			if (bLineEnd) {
+				while (keep != 0 && IsBlankChar(ptr[keep - 1])) {
+					--keep;
 				}
-#else
-				if (bPrefixNumPadZero) {
-					sprintf(tchNum, "%0*d", iPrefixNumWidth, (int)iPrefixNum);
-				} else {
-					sprintf(tchNum, "%*d", iPrefixNumWidth, (int)iPrefixNum);
+			}
+			break;
+
+		case LineTransform_TrimLeading:
+			if (bLineStart) {
+				while (lead < keep && IsBlankChar(ptr[lead])) {
+					++lead;
 				}
-#endif
-				strcat(mszInsert, tchNum);
-				strcat(mszInsert, mszPrefix2);
-				iPrefixNum++;
+				keep -= lead;
 			}
+			break;
+
+		case LineTransform_CompressSpaces: {
+			// replace blanks with one space, remove blanks at line start and line end.
+			const char *p = ptr;
+			if (bLineStart) {
+				while (p < lineEnd && IsBlankChar(*p)) {
+					++p;
+				}
+				lead = p - ptr;
+			}
+			while (p < lineEnd) {
+				const char *blank = FindEitherChar(p, lineEnd, ' ', '\t');
+				memcpy(out, p, blank - p);
+				out += blank - p;
+				p = blank;
+				if (p < lineEnd) {
+					const char *stop = p;
+					while (stop < lineEnd && IsBlankChar(*stop)) {
+						++stop;
+					}
+					if (!(stop == lineEnd && bLineEnd)) {
+						*out++ = ' ';
+					}
+					p = stop;
+				}
+			}
+			keep = out - outStart;
+		} break;
 
-			const Sci_Position iPos = SciCall_PositionFromLine(iLineDest);
-			SciCall_SetTargetRange(iPos, iPos);
-			SciCall_ReplaceTarget(strlen(mszInsert), mszInsert);
-			iLineDest += iPrefixLine;
+		case LineTransform_RemoveBlank:
+			bDrop = keep == 0;
+			break;
+
+		case LineTransform_MergeBlank:
+			// keep last blank line of consecutive blank lines
+			if (keep == 0) {
+				bDrop = (next < end) ? (*next == '\r' || *next == '\n') : bTrailingEmptyLine;
+			}
+			break;
 		}
 
-		if (iAppendLen != 0) {
-			strcpy(mszInsert, mszAppend1);
+		const Sci_Position offset = ptr - pszText;
+		if (!bDrop && transform != LineTransform_CompressSpaces) {
+			memcpy(out, ptr + lead, keep);
+			out += keep;
+		}
+		if (!bDrop) {
+			memcpy(out, lineEnd, next - lineEnd);
+			out += next - lineEnd;
+		}
+		if ((out - outStart) != (next - ptr) || (transform == LineTransform_CompressSpaces && memcmp(outStart, ptr, out - outStart) != 0)) {
+			if (firstChange < 0) {
+				firstChange = offset;
+			}
+			lastChange = next - pszText;
+		}
 
-			if (bAppendNum) {
-				char tchNum[64];
-#if defined(_WIN64)
-				if (bAppendNumPadZero) {
-					sprintf(tchNum, "%0*" PRId64, iAppendNumWidth, iAppendNum);
-				} else {
-					sprintf(tchNum, "%*" PRId64, iAppendNumWidth, iAppendNum);
-				}
-#else
-				if (bAppendNumPadZero) {
-					sprintf(tchNum, "%0*d", iAppendNumWidth, (int)iAppendNum);
-				} else {
-					sprintf(tchNum, "%*d", iAppendNumWidth, (int)iAppendNum);
+		for (int i = 0; i < 2; i++) {
+			const Sci_Position pos = positions[i] - iStartPos;
+			if (!mapped[i] && pos >= offset && pos < next - pszText) {
+				mapped[i] = TRUE;
+				Sci_Position newPos = outStart - pszResult;
+				if (!bDrop) {
+					if (ptr + pos - offset <= lineEnd) {
+						newPos += min_pos(max_pos(pos - offset - lead, 0), keep);
+					} else {
+						newPos += keep + (ptr + pos - offset - lineEnd);
+					}
 				}
-#endif
-				strcat(mszInsert, tchNum);
-				strcat(mszInsert, mszAppend2);
-				iAppendNum++;
+				positions[i] = iStartPos + newPos;
 			}
+		}
+		ptr = next;
+	}
+
+	if (firstChange < 0) {
+		NP2HeapFree(pszResult);
+		return FALSE;
+	}
 
-			const Sci_Position iPos = SciCall_GetLineEndPosition(iLineDest);
-			SciCall_SetTargetRange(iPos, iPos);
-			SciCall_ReplaceTarget(strlen(mszInsert), mszInsert);
-			iLineDest += iAppendLine;
+	const Sci_Position delta = (out - pszResult) - length;
+	for (int i = 0; i < 2; i++) {
+		if (!mapped[i] && positions[i] >= iEndPos) {
+			positions[i] += delta;
 		}
 	}
+
+	const BOOL bIsRectangular = SciCall_IsRectangleSelection();
+	SciCall_BeginUndoAction();
+	SciCall_SetTargetRange(iStartPos + firstChange, iStartPos + lastChange);
+	SciCall_ReplaceTarget(lastChange - firstChange + delta, pszResult + firstChange);
+	if (!bIsRectangular) {
+		SciCall_SetSel(positions[1], positions[0]);
+	}
 	SciCall_EndUndoAction();
+	NP2HeapFree(pszResult);
+	return TRUE;
+}
 
-	//// Fix selection
-	//if (iSelStart != iSelEnd && SciCall_GetTargetEnd() > SciCall_GetSelectionEnd()) {
-	//	Sci_Position iCurPos = SciCall_GetCurrentPos();
-	//	Sci_Position iAnchorPos = SciCall_GetAnchor();
-	//	if (iCurPos > iAnchorPos)
-	//		iCurPos = SciCall_GetTargetEnd();
-	//	else
-	//		iAnchorPos = SciCall_GetTargetEnd();
-	//	SciCall_SetSel(iAnchorPos, iCurPos);
-	//}
+//=============================================================================
+//
+// EditStripTrailingBlanks()
+//
+void EditStripTrailingBlanks(BOOL bIgnoreSelection) {
+	Sci_Position iStartPos = 0;
+	Sci_Position iEndPos = SciCall_GetLength();
+	if (!bIgnoreSelection && !SciCall_IsSelectionEmpty() && !SciCall_IsRectangleSelection()) {
+		iStartPos = SciCall_GetSelectionStart();
+		iEndPos = SciCall_GetSelectionEnd();
+	}
+	EditTransformLines(iStartPos, iEndPos, LineTransform_TrimTrailing, FALSE);
+}
 
-	// extend selection to start of first line
-	// the above code is not required when last line has been excluded
-	if (iSelStart != iSelEnd) {
-		Sci_Position iCurPos = SciCall_GetCurrentPos();
-		Sci_Position iAnchorPos = SciCall_GetAnchor();
-		if (iCurPos < iAnchorPos) {
-			iCurPos = SciCall_PositionFromLine(iLineStart);
-			iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
-		} else {
-			iAnchorPos = SciCall_PositionFromLine(iLineStart);
-			iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
-		}
-		SciCall_SetSel(iAnchorPos, iCurPos);
+//=============================================================================
+//
+// EditStripLeadingBlanks()
+//
+void EditStripLeadingBlanks(BOOL bIgnoreSelection) {
+	Sci_Position iStartPos = 0;
+	Sci_Position iEndPos = SciCall_GetLength();
+	if (!bIgnoreSelection && !SciCall_IsSelectionEmpty() && !SciCall_IsRectangleSelection()) {
+		iStartPos = SciCall_GetSelectionStart();
+		iEndPos = SciCall_GetSelectionEnd();
+	}
+	EditTransformLines(iStartPos, iEndPos, LineTransform_TrimLeading, FALSE);
+}
+
+//=============================================================================
+//
+// EditCompressSpaces()
+//
+void EditCompressSpaces(void) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	Sci_Position iStartPos = SciCall_GetSelectionStart();
+	Sci_Position iEndPos = SciCall_GetSelectionEnd();
+	if (iStartPos == iEndPos) {
+		iStartPos = 0;
+		iEndPos = SciCall_GetLength();
+	}
+	EditTransformLines(iStartPos, iEndPos, LineTransform_CompressSpaces, FALSE);
+}
+
+//=============================================================================
+//
+// EditRemoveBlankLines()
+//
+void EditRemoveBlankLines(BOOL bMerge) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
+
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+
+	if (iSelStart == iSelEnd) {
+		iSelStart = 0;
+		iSelEnd = SciCall_GetLength();
+	}
+
+	Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
+	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+
+	if (iSelStart > SciCall_PositionFromLine(iLineStart)) {
+		iLineStart++;
 	}
 
-	EndWaitCursor();
-	if (mszPrefix1 != NULL) {
-		NP2HeapFree(mszPrefix1);
-	}
-	if (mszAppend1 != NULL) {
-		NP2HeapFree(mszAppend1);
-	}
-	if (mszPrefix2 != NULL) {
-		NP2HeapFree(mszPrefix2);
+	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd) && iLineEnd != SciCall_GetLineCount() - 1) {
+		iLineEnd--;
 	}
-	if (mszAppend2 != NULL) {
-		NP2HeapFree(mszAppend2);
+	if (iLineStart > iLineEnd) {
+		return;
 	}
-	NP2HeapFree(mszInsert);
+
+	const Sci_Position iStartPos = SciCall_PositionFromLine(iLineStart);
+	const Sci_Position iEndPos = SciCall_PositionFromLine(iLineEnd + 1);
+	const BOOL bTrailingEmptyLine = iLineEnd > iLineStart && SciCall_PositionFromLine(iLineEnd) == iEndPos;
+	EditTransformLines(iStartPos, iEndPos, bMerge ? LineTransform_MergeBlank : LineTransform_RemoveBlank, bTrailingEmptyLine);
 }
 
 //=============================================================================
 //
-// EditAlignText()
+// EditRemoveDuplicateLines()
 //
-void EditAlignText(int nMode) {
+typedef struct DuplicateLineEntry {
+	Sci_Position offset;
+	UINT length;
+	UINT hash;
+} DuplicateLineEntry;
+
+static inline UINT DuplicateLine_Hash(const uint8_t *ptr, UINT length, BOOL bIgnoreCase) {
+	// FNV-1a, ASCII letters are folded when ignoring case.
+	UINT hash = 2166136261U;
+	if (bIgnoreCase) {
+		for (UINT i = 0; i < length; i++) {
+			uint8_t ch = *ptr++;
+			if (ch >= 'A' && ch <= 'Z') {
+				ch = ch + 'a' - 'A';
+			}
+			hash = (hash ^ ch) * 16777619U;
+		}
+	} else {
+		for (UINT i = 0; i < length; i++) {
+			hash = (hash ^ *ptr++) * 16777619U;
+		}
+	}
+	return hash;
+}
+
+static BOOL DuplicateLine_Equal(const uint8_t *s1, const uint8_t *s2, UINT length, BOOL bIgnoreCase) {
+	if (!bIgnoreCase) {
+		return memcmp(s1, s2, length) == 0;
+	}
+	for (UINT i = 0; i < length; i++) {
+		uint8_t ch1 = s1[i];
+		uint8_t ch2 = s2[i];
+		if (ch1 != ch2) {
+			if (ch1 >= 'A' && ch1 <= 'Z') {
+				ch1 = ch1 + 'a' - 'A';
+			}
+			if (ch2 >= 'A' && ch2 <= 'Z') {
+				ch2 = ch2 + 'a' - 'A';
+			}
+			if (ch1 != ch2) {
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
+// keep first occurrence of each line and the order of lines, line ending is not compared.
+void EditRemoveDuplicateLines(BOOL bIgnoreCase) {
 	if (SciCall_IsRectangleSelection()) {
 		NotifyRectangleSelection();
 		return;
 	}
 
-#define BUFSIZE_ALIGN 1024
-
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-	Sci_Position iCurPos = SciCall_GetCurrentPos();
-	Sci_Position iAnchorPos = SciCall_GetAnchor();
-	const UINT cpEdit = SciCall_GetCodePage();
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	const BOOL bSelection = iSelStart != iSelEnd;
+	if (!bSelection) {
+		iSelStart = 0;
+		iSelEnd = SciCall_GetLength();
+	}
 
-	BOOL bModified = FALSE;
 	const Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
 	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+	if (iLineEnd > iLineStart && iSelEnd == SciCall_PositionFromLine(iLineEnd)) {
+		iLineEnd--;
+	}
+	const Sci_Line iLineCount = iLineEnd - iLineStart + 1;
+	if (iLineCount < 2 || iLineCount >= UINT_MAX/2) {
+		return;
+	}
 
-	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
-		if (iLineEnd - iLineStart >= 1) {
-			iLineEnd--;
+	size_t slotCount = 16;
+	while (slotCount < (size_t)iLineCount*2) {
+		slotCount <<= 1;
+	}
+	const Sci_Position iStartPos = SciCall_PositionFromLine(iLineStart);
+	const Sci_Position iEndPos = SciCall_PositionFromLine(iLineEnd + 1);
+	UINT *slots = (UINT *)NP2HeapAlloc(slotCount * sizeof(UINT));
+	DuplicateLineEntry *entries = (DuplicateLineEntry *)NP2HeapAlloc(iLineCount * sizeof(DuplicateLineEntry));
+	char *pszResult = (char *)NP2HeapAlloc(iEndPos - iStartPos + 1);
+	if (slots == NULL || entries == NULL || pszResult == NULL) {
+		if (slots) {
+			NP2HeapFree(slots);
+		}
+		if (entries) {
+			NP2HeapFree(entries);
 		}
+		if (pszResult) {
+			NP2HeapFree(pszResult);
+		}
+		return;
 	}
 
-	Sci_Position iMinIndent = BUFSIZE_ALIGN;
-	Sci_Position iMaxLength = 0;
+	// entries keep offsets into pszText for comparing duplicates, pszResult replaces the lines after all lines are checked.
+	const char *pszText = SciCall_GetRangePointer(iStartPos, iEndPos - iStartPos);
+	const size_t mask = slotCount - 1;
+	UINT count = 0;
+	Sci_Position length = 0;
+	Sci_Position cchLastEOL = 0;
+	BOOL bLastLineNoEOL = FALSE;
+	Sci_Position iLinePos = iStartPos;
 	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-		Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iLine);
-		const Sci_Position iLineIndentPos = SciCall_GetLineIndentPosition(iLine);
-
-		if (iLineIndentPos != iLineEndPos) {
-			const Sci_Position iIndentCol = SciCall_GetLineIndentation(iLine);
-			Sci_Position iTail = iLineEndPos - 1;
-			int ch = SciCall_GetCharAt(iTail);
-			while (iTail >= iLineStart && (ch == ' ' || ch == '\t')) {
-				iTail--;
-				ch = SciCall_GetCharAt(iTail);
-				iLineEndPos--;
+		const Sci_Position iNextPos = SciCall_PositionFromLine(iLine + 1);
+		const Sci_Position offset = iLinePos - iStartPos;
+		const uint8_t *ptr = (const uint8_t *)pszText + offset;
+		const Sci_Position cchLine = iNextPos - iLinePos;
+		Sci_Position cchText = cchLine;
+		if (cchText != 0 && (ptr[cchText - 1] == '\n' || ptr[cchText - 1] == '\r')) {
+			--cchText;
+			if (cchText != 0 && ptr[cchText - 1] == '\r') {
+				--cchText;
+			}
+		}
+		iLinePos = iNextPos;
+		bLastLineNoEOL = cchText == cchLine;
+
+		const UINT hash = DuplicateLine_Hash(ptr, (UINT)cchText, bIgnoreCase);
+		size_t slot = hash & mask;
+		UINT index;
+		BOOL bDuplicate = FALSE;
+		while ((index = slots[slot]) != 0) {
+			const DuplicateLineEntry *entry = &entries[index - 1];
+			if (entry->hash == hash && entry->length == (UINT)cchText
+				&& DuplicateLine_Equal((const uint8_t *)pszText + entry->offset, ptr, (UINT)cchText, bIgnoreCase)) {
+				bDuplicate = TRUE;
+				break;
 			}
-
-			const Sci_Position iEndCol = SciCall_GetColumn(iLineEndPos);
-			iMinIndent = min_pos(iMinIndent, iIndentCol);
-			iMaxLength = max_pos(iMaxLength, iEndCol);
+			slot = (slot + 1) & mask;
+		}
+		if (bDuplicate) {
+			continue;
 		}
-	}
 
-	if (iMaxLength < BUFSIZE_ALIGN) {
-		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-			const Sci_Position iIndentPos = SciCall_GetLineIndentPosition(iLine);
-			const Sci_Position iEndPos = SciCall_GetLineEndPosition(iLine);
+		DuplicateLineEntry *entry = &entries[count];
+		entry->offset = offset;
+		entry->length = (UINT)cchText;
+		entry->hash = hash;
+		slots[slot] = ++count;
+		memcpy(pszResult + length, ptr, cchLine);
+		length += cchLine;
+		cchLastEOL = cchLine - cchText;
+	}
 
-			if (iIndentPos == iEndPos && iEndPos > 0) {
-				if (!bModified) {
-					SciCall_BeginUndoAction();
-					bModified = TRUE;
-				}
+	if (count != iLineCount) {
+		// last line without line ending is removed, also remove line ending from last kept line.
+		if (bLastLineNoEOL) {
+			length -= cchLastEOL;
+		}
 
-				SciCall_SetTargetRange(SciCall_PositionFromLine(iLine), iEndPos);
-				SciCall_ReplaceTarget(0, "");
-			} else {
-				char tchLineBuf[BUFSIZE_ALIGN * kMaxMultiByteCount] = "";
-				WCHAR wchLineBuf[BUFSIZE_ALIGN] = L"";
-				WCHAR *pWords[BUFSIZE_ALIGN];
-				WCHAR *p = wchLineBuf;
+		SciCall_BeginUndoAction();
+		SciCall_SetTargetRange(iStartPos, iEndPos);
+		SciCall_ReplaceTarget(length, pszResult);
+		SciCall_EndUndoAction();
+		if (bSelection) {
+			SciCall_SetSel(iStartPos, iStartPos + length);
+		}
+	}
 
-				int iWords = 0;
-				Sci_Position iWordsLength = 0;
-				const Sci_Position cchLine = SciCall_GetLine(iLine, tchLineBuf);
+	NP2HeapFree(slots);
+	NP2HeapFree(entries);
+	NP2HeapFree(pszResult);
+}
 
-				if (!bModified) {
-					SciCall_BeginUndoAction();
-					bModified = TRUE;
-				}
+//=============================================================================
+//
+// EditWrapToColumn()
+//
+// East Asian Wide (W) and Fullwidth (F) ranges, other characters take one column.
+static const uint32_t EastAsianWideRanges[] = {
+	0x1100, 0x115F,
+	0x231A, 0x231B,
+	0x2329, 0x232A,
+	0x23E9, 0x23EC,
+	0x25FD, 0x25FE,
+	0x2614, 0x2615,
+	0x2E80, 0x303E,
+	0x3041, 0x33FF,
+	0x3400, 0x4DBF,
+	0x4E00, 0x9FFF,
+	0xA000, 0xA4CF,
+	0xA960, 0xA97F,
+	0xAC00, 0xD7A3,
+	0xF900, 0xFAFF,
+	0xFE10, 0xFE19,
+	0xFE30, 0xFE6F,
+	0xFF00, 0xFF60,
+	0xFFE0, 0xFFE6,
+	0x16FE0, 0x18CFF,
+	0x1B000, 0x1B2FF,
+	0x1F300, 0x1F64F,
+	0x1F900, 0x1F9FF,
+	0x20000, 0x2FFFD,
+	0x30000, 0x3FFFD,
+};
 
-				MultiByteToWideChar(cpEdit, 0, tchLineBuf, (int)cchLine, wchLineBuf, COUNTOF(wchLineBuf));
-				StrTrim(wchLineBuf, L"\r\n\t ");
+static int GetCodePointWidth(uint32_t ch) {
+	if (ch >= EastAsianWideRanges[0]) {
+		for (UINT index = 0; index < COUNTOF(EastAsianWideRanges); index += 2) {
+			if (ch < EastAsianWideRanges[index]) {
+				break;
+			}
+			if (ch <= EastAsianWideRanges[index + 1]) {
+				return 2;
+			}
+		}
+	}
+	return 1;
+}
 
-				while (*p) {
-					if (*p != L' ' && *p != L'\t') {
-						pWords[iWords++] = p++;
-						iWordsLength++;
-						while (*p && *p != L' ' && *p != L'\t') {
-							p++;
-							iWordsLength++;
-						}
-					} else {
-						*p++ = 0;
+// display width of the word (text up to next space or line break) starting at ptr.
+static const uint8_t *GetWordWidth(const uint8_t *ptr, const uint8_t *end, UINT cpEdit, Sci_Position *width) {
+	Sci_Position count = 0;
+	while (ptr < end && !IsASpace(*ptr)) {
+		const uint8_t ch = *ptr++;
+		++count;
+		if (ch >= 0x80) {
+			if (cpEdit == SC_CP_UTF8) {
+				if (ch >= 0xE0) {
+					// only three and four bytes sequences are wide
+					const int trail = (ch >= 0xF0) ? 3 : 2;
+					uint32_t value = ch & ((ch >= 0xF0) ? 0x07 : 0x0F);
+					int index = 0;
+					while (index < trail && ptr < end && (*ptr & 0xC0) == 0x80) {
+						value = (value << 6) | (*ptr++ & 0x3F);
+						++index;
+					}
+					if (index == trail) {
+						count += GetCodePointWidth(value) - 1;
+					}
+				} else {
+					while (ptr < end && (*ptr & 0xC0) == 0x80) {
+						++ptr;
 					}
 				}
+			} else if (cpEdit != 0 && IsDBCSLeadByteEx(cpEdit, ch) && ptr < end) {
+				++ptr;
+				++count;
+			}
+		}
+	}
+	*width = count;
+	return ptr;
+}
 
-				if (iWords > 0) {
-					if (nMode == ALIGN_JUSTIFY || nMode == ALIGN_JUSTIFY_EX) {
-						BOOL bNextLineIsBlank = FALSE;
-						if (nMode == ALIGN_JUSTIFY_EX) {
-							if (SciCall_GetLineCount() <= iLine + 1) {
-								bNextLineIsBlank = TRUE;
-							} else {
-								const Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iLine + 1);
-								const Sci_Position iLineIndentPos = SciCall_GetLineIndentPosition(iLine + 1);
-								if (iLineIndentPos == iLineEndPos) {
-									bNextLineIsBlank = TRUE;
-								}
-							}
-						}
-
-						if ((nMode == ALIGN_JUSTIFY || nMode == ALIGN_JUSTIFY_EX) &&
-								iWords > 1 && iWordsLength >= 2 &&
-								((nMode != ALIGN_JUSTIFY_EX || !bNextLineIsBlank || iLineStart == iLineEnd) ||
-								 (bNextLineIsBlank && iWordsLength*4 > (iMaxLength - iMinIndent)*3))) {
-							const int iGaps = iWords - 1;
-							const Sci_Position iSpacesPerGap = (iMaxLength - iMinIndent - iWordsLength) / iGaps;
-							const Sci_Position iExtraSpaces = (iMaxLength - iMinIndent - iWordsLength) % iGaps;
-
-							WCHAR wchNewLineBuf[BUFSIZE_ALIGN * 3];
-							lstrcpy(wchNewLineBuf, pWords[0]);
-							p = StrEnd(wchNewLineBuf);
-
-							for (int i = 1; i < iWords; i++) {
-								for (Sci_Position j = 0; j < iSpacesPerGap; j++) {
-									*p++ = L' ';
-									*p = 0;
-								}
-								if (i > iGaps - iExtraSpaces) {
-									*p++ = L' ';
-									*p = 0;
-								}
-								lstrcat(p, pWords[i]);
-								p = StrEnd(p);
-							}
-
-							WideCharToMultiByte(cpEdit, 0, wchNewLineBuf, -1, tchLineBuf, COUNTOF(tchLineBuf), NULL, NULL);
-
-							SciCall_SetTargetRange(SciCall_PositionFromLine(iLine), SciCall_GetLineEndPosition(iLine));
-							SciCall_ReplaceTarget(strlen(tchLineBuf), tchLineBuf);
-
-							SciCall_SetLineIndentation(iLine, iMinIndent);
-						} else {
-							WCHAR wchNewLineBuf[BUFSIZE_ALIGN];
-							lstrcpy(wchNewLineBuf, pWords[0]);
-							p = StrEnd(wchNewLineBuf);
-
-							for (int i = 1; i < iWords; i++) {
-								*p++ = L' ';
-								*p = 0;
-								lstrcat(wchNewLineBuf, pWords[i]);
-								p = StrEnd(p);
-							}
-
-							WideCharToMultiByte(cpEdit, 0, wchNewLineBuf, -1, tchLineBuf, COUNTOF(tchLineBuf), NULL, NULL);
-
-							SciCall_SetTargetRange(SciCall_PositionFromLine(iLine), SciCall_GetLineEndPosition(iLine));
-							SciCall_ReplaceTarget(strlen(tchLineBuf), tchLineBuf);
-
-							SciCall_SetLineIndentation(iLine, iMinIndent);
-						}
-					} else {
-						const Sci_Position iExtraSpaces = iMaxLength - iMinIndent - iWordsLength - iWords + 1;
-						Sci_Position iOddSpaces = iExtraSpaces % 2;
-
-						WCHAR wchNewLineBuf[BUFSIZE_ALIGN * 3] = L"";
-						p = wchNewLineBuf;
-
-						if (nMode == ALIGN_RIGHT) {
-							for (Sci_Position i = 0; i < iExtraSpaces; i++) {
-								*p++ = L' ';
-							}
-							*p = 0;
-						}
+void EditWrapToColumn(int nColumn/*, int nTabWidth*/) {
+	if (SciCall_IsSelectionEmpty()) {
+		return;
+	}
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
+		return;
+	}
 
-						if (nMode == ALIGN_CENTER) {
-							for (Sci_Position i = 1; i < iExtraSpaces - iOddSpaces; i += 2) {
-								*p++ = L' ';
-							}
-							*p = 0;
-						}
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
 
-						for (int i = 0; i < iWords; i++) {
-							lstrcat(p, pWords[i]);
-							if (i < iWords - 1) {
-								lstrcat(p, L" ");
-							}
-							if (nMode == ALIGN_CENTER && iWords > 1 && iOddSpaces > 0 && i + 1 >= iWords / 2) {
-								lstrcat(p, L" ");
-								iOddSpaces--;
-							}
-							p = StrEnd(p);
-						}
+	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
+	iSelStart = SciCall_PositionFromLine(iLine);
 
-						WideCharToMultiByte(cpEdit, 0, wchNewLineBuf, -1, tchLineBuf, COUNTOF(tchLineBuf), NULL, NULL);
+	const Sci_Position iSelCount = iSelEnd - iSelStart;
+	const UINT cpEdit = SciCall_GetCodePage();
+	const uint8_t *ptr = (const uint8_t *)SciCall_GetRangePointer(iSelStart, iSelCount);
+	const uint8_t * const end = ptr + iSelCount;
+	// each run of spaces and tabs is replaced with at most one line break
+	char *pszConv = (char *)NP2HeapAlloc(2*iSelCount + 1);
+	char *out = pszConv;
 
-						Sci_Position iPos;
-						if (nMode == ALIGN_RIGHT || nMode == ALIGN_CENTER) {
-							SciCall_SetLineIndentation(iLine, iMinIndent);
-							iPos = SciCall_GetLineIndentPosition(iLine);
-						} else {
-							iPos = SciCall_PositionFromLine(iLine);
-						}
+	char szEOL[] = "\r\n";
+	int cchEOL = 2;
+	const int iEOLMode = SciCall_GetEOLMode();
+	if (iEOLMode == SC_EOL_CR) {
+		cchEOL = 1;
+	} else if (iEOLMode == SC_EOL_LF) {
+		cchEOL = 1;
+		szEOL[0] = '\n';
+	}
 
-						SciCall_SetTargetRange(iPos, SciCall_GetLineEndPosition(iLine));
-						SciCall_ReplaceTarget(strlen(tchLineBuf), tchLineBuf);
+	Sci_Position iLineWidth = 0;
+	BOOL bModified = FALSE;
+	while (ptr < end) {
+		const uint8_t ch = *ptr;
+		if (IsASpaceOrTab(ch)) {
+			++ptr;
+			while (ptr < end && IsASpaceOrTab(*ptr)) {
+				++ptr;
+				bModified = TRUE;
+			} // Modified: left out some whitespaces
 
-						if (nMode == ALIGN_LEFT) {
-							SciCall_SetLineIndentation(iLine, iMinIndent);
-						}
-					}
+			Sci_Position iNextWordWidth;
+			const uint8_t *word = GetWordWidth(ptr, end, cpEdit, &iNextWordWidth);
+			if (iNextWordWidth > 0) {
+				if (iLineWidth + iNextWordWidth + 1 > nColumn) {
+					memcpy(out, szEOL, cchEOL);
+					out += cchEOL;
+					iLineWidth = 0;
+					bModified = TRUE;
+				} else if (iLineWidth > 0) {
+					*out++ = ' ';
+					iLineWidth++;
 				}
+				memcpy(out, ptr, word - ptr);
+				out += word - ptr;
+				iLineWidth += iNextWordWidth;
+				ptr = word;
+			}
+		} else if (IsASpace(ch)) {
+			*out++ = ch;
+			++ptr;
+			if (IsEOLChar(ch)) {
+				iLineWidth = 0;
+			} else {
+				iLineWidth++;
 			}
+		} else {
+			Sci_Position iWordWidth;
+			const uint8_t *word = GetWordWidth(ptr, end, cpEdit, &iWordWidth);
+			memcpy(out, ptr, word - ptr);
+			out += word - ptr;
+			iLineWidth += iWordWidth;
+			ptr = word;
 		}
-		if (bModified) {
-			SciCall_EndUndoAction();
-		}
-	} else {
-		MsgBoxInfo(MB_OK, IDS_BUFFERTOOSMALL);
 	}
 
-	if (iCurPos < iAnchorPos) {
-		iCurPos = SciCall_PositionFromLine(iLineStart);
-		iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
-	} else {
-		iAnchorPos = SciCall_PositionFromLine(iLineStart);
-		iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
+	if (bModified) {
+		EditReplaceRange(iSelStart, iSelEnd, out - pszConv, pszConv);
 	}
-	SciCall_SetSel(iAnchorPos, iCurPos);
+
+	NP2HeapFree(pszConv);
 }
 
 //=============================================================================
 //
-// EditEncloseSelection()
+// EditJoinLinesEx()
 //
-void EditEncloseSelection(LPCWSTR pwszOpen, LPCWSTR pwszClose) {
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+void EditJoinLinesEx(void) {
+	if (SciCall_IsSelectionEmpty()) {
 		return;
 	}
-	if (StrIsEmpty(pwszOpen) && StrIsEmpty(pwszClose)) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
 		return;
 	}
 
-	BeginWaitCursor();
-
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
 	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-	const UINT cpEdit = SciCall_GetCodePage();
-	const int iEOLMode = SciCall_GetEOLMode();
-
-	char *mszOpen = NULL;
-	int len = lstrlen(pwszOpen);
-	if (len != 0) {
-		const int size = kMaxMultiByteCount * len + 1;
-		mszOpen = (char *)NP2HeapAlloc(size);
-		WideCharToMultiByte(cpEdit, 0, pwszOpen, -1, mszOpen, size, NULL, NULL);
-		ConvertWinEditLineEndings(mszOpen, iEOLMode);
-	}
-
-	char *mszClose = NULL;
-	len = lstrlen(pwszClose);
-	if (len != 0) {
-		const int size = kMaxMultiByteCount * len + 1;
-		mszClose = (char *)NP2HeapAlloc(size);
-		WideCharToMultiByte(cpEdit, 0, pwszClose, -1, mszClose, size, NULL, NULL);
-		ConvertWinEditLineEndings(mszClose, iEOLMode);
-	}
-
-	SciCall_BeginUndoAction();
-	len = 0;
+	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
+	iSelStart = SciCall_PositionFromLine(iLine);
 
-	if (StrNotEmptyA(mszOpen)) {
-		len = (int)strlen(mszOpen);
-		SciCall_SetTargetRange(iSelStart, iSelStart);
-		SciCall_ReplaceTarget(len, mszOpen);
-	}
+	const Sci_Position iSelCount = iSelEnd - iSelStart;
+	const char *ptr = SciCall_GetRangePointer(iSelStart, iSelCount);
+	const char * const end = ptr + iSelCount;
+	// a paragraph break is replaced with two line breaks
+	char *pszJoin = (char *)NP2HeapAlloc(2*iSelCount + 4);
+	char *out = pszJoin;
 
-	if (StrNotEmptyA(mszClose)) {
-		SciCall_SetTargetRange(iSelEnd + len, iSelEnd + len);
-		SciCall_ReplaceTarget(strlen(mszClose), mszClose);
+	char szEOL[] = "\r\n";
+	int cchEOL = 2;
+	const int iEOLMode = SciCall_GetEOLMode();
+	if (iEOLMode == SC_EOL_CR) {
+		cchEOL = 1;
+	} else if (iEOLMode == SC_EOL_LF) {
+		cchEOL = 1;
+		szEOL[0] = '\n';
 	}
 
-	SciCall_EndUndoAction();
-
-	// Fix selection
-	if (iSelStart == iSelEnd) {
-		SciCall_SetSel(iSelStart + len, iSelStart + len);
-	} else {
-		Sci_Position iCurPos = SciCall_GetCurrentPos();
-		Sci_Position iAnchorPos = SciCall_GetAnchor();
+	BOOL bModified = FALSE;
+	while (ptr < end) {
+		const char *eol = ptr;
+		while (eol < end && !IsEOLChar(*eol)) {
+			++eol;
+		}
+		memcpy(out, ptr, eol - ptr);
+		out += eol - ptr;
+		if (eol == end) {
+			break;
+		}
 
-		if (iCurPos < iAnchorPos) {
-			iCurPos = iSelStart + len;
-			iAnchorPos = iSelEnd + len;
+		ptr = eol + 1;
+		if (*eol == '\r' && ptr < end && *ptr == '\n') {
+			++ptr;
+		}
+		if (ptr < end && !IsEOLChar(*ptr)) {
+			*out++ = ' ';
+			bModified = TRUE;
 		} else {
-			iAnchorPos = iSelStart + len;
-			iCurPos = iSelEnd + len;
+			while (ptr < end && IsEOLChar(*ptr)) {
+				++ptr;
+				bModified = TRUE;
+			}
+			if (ptr < end) {
+				const BOOL bParagraph = (out - pszJoin) != 0;
+				memcpy(out, szEOL, cchEOL);
+				out += cchEOL;
+				if (bParagraph) {
+					memcpy(out, szEOL, cchEOL);
+					out += cchEOL;
+				}
+			}
 		}
-		SciCall_SetSel(iAnchorPos, iCurPos);
 	}
 
-	EndWaitCursor();
-	if (mszOpen != NULL) {
-		NP2HeapFree(mszOpen);
-	}
-	if (mszClose != NULL) {
-		NP2HeapFree(mszClose);
+	if (bModified) {
+		EditReplaceRange(iSelStart, iSelEnd, out - pszJoin, pszJoin);
 	}
+
+	NP2HeapFree(pszJoin);
 }
 
 //=============================================================================
 //
-// EditToggleLineComments()
+// EditSortLines()
 //
-void EditToggleLineComments(LPCWSTR pwszComment, BOOL bInsertAtStart) {
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+typedef struct SORTLINE {
+	WCHAR *pwszLine;
+	WCHAR *pwszSortEntry;
+	const BYTE *pKey;		// sort key for pwszSortEntry, NULL to compare strings
+	const char *pszLine;	// line in document buffer, without line ending
+	Sci_Position cchLine;
+	double numKey;			// number or date value of the field, valid when bNumKey is set
+	DWORD cbKey;
+	int cchSortEntry;		// length of the field for field sort, -1 for rest of the line
+	BOOL bNumKey;
+} SORTLINE;
+
+typedef int (__stdcall *FNSTRCMP)(LPCWSTR, LPCWSTR);
+typedef int (__cdecl *QSortCmp)(const void *, const void *);
+
+static int __cdecl CmpStd(const void *p1, const void *p2) {
+	const SORTLINE *s1 = (const SORTLINE *)p1;
+	const SORTLINE *s2 = (const SORTLINE *)p2;
+	const int cmp = StrCmpW(s1->pwszSortEntry, s2->pwszSortEntry);
+	return cmp ? cmp : StrCmpW(s1->pwszLine, s2->pwszLine);
+}
+
+static int __cdecl CmpIStd(const void *p1, const void *p2) {
+	const SORTLINE *s1 = (const SORTLINE *)p1;
+	const SORTLINE *s2 = (const SORTLINE *)p2;
+	const int cmp = StrCmpIW(s1->pwszSortEntry, s2->pwszSortEntry);
+	return cmp ? cmp : StrCmpIW(s1->pwszLine, s2->pwszLine);
+}
+
+static int __cdecl CmpLogical(const void *p1, const void *p2) {
+	const SORTLINE *s1 = (const SORTLINE *)p1;
+	const SORTLINE *s2 = (const SORTLINE *)p2;
+	int cmp = StrCmpLogicalW(s1->pwszSortEntry, s2->pwszSortEntry);
+	if (cmp == 0) {
+		cmp = StrCmpLogicalW(s1->pwszLine, s2->pwszLine);
 	}
+	return cmp ? cmp : CmpStd(p1, p2);
+}
 
-	BeginWaitCursor();
+static int __cdecl CmpILogical(const void *p1, const void *p2) {
+	const SORTLINE *s1 = (const SORTLINE *)p1;
+	const SORTLINE *s2 = (const SORTLINE *)p2;
+	int cmp = StrCmpLogicalW(s1->pwszSortEntry, s2->pwszSortEntry);
+	if (cmp == 0) {
+		cmp = StrCmpLogicalW(s1->pwszLine, s2->pwszLine);
+	}
+	return cmp ? cmp : CmpIStd(p1, p2);
+}
 
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-	Sci_Position iCurPos = SciCall_GetCurrentPos();
+// string comparison for lines with same sort key, only changed before sorting.
+static QSortCmp pfnSortLinesCmp;
 
-	char mszComment[256] = "";
-	const UINT cpEdit = SciCall_GetCodePage();
-	WideCharToMultiByte(cpEdit, 0, pwszComment, -1, mszComment, COUNTOF(mszComment), NULL, NULL);
+// sort keys from LCMapString() are compared bytewise, same as CompareString() for the strings.
+static int __cdecl CmpSortKey(const void *p1, const void *p2) {
+	const SORTLINE *s1 = (const SORTLINE *)p1;
+	const SORTLINE *s2 = (const SORTLINE *)p2;
+	if (s1->pKey && s2->pKey) {
+		const int cmp = memcmp(s1->pKey, s2->pKey, min_u(s1->cbKey, s2->cbKey));
+		if (cmp || s1->cbKey != s2->cbKey) {
+			return cmp ? cmp : ((s1->cbKey < s2->cbKey) ? -1 : 1);
+		}
+	}
+	return pfnSortLinesCmp(p1, p2);
+}
 
-	const int cchComment = (int)strlen(mszComment);
-	const Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
-	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+static int __cdecl CmpSortKeyRev(const void *p1, const void *p2) {
+	return CmpSortKey(p2, p1);
+}
 
-	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
-		if (iLineEnd - iLineStart >= 1) {
-			iLineEnd--;
+// fallback for field text without sort key, only changed before sorting.
+static int (__stdcall *pfnSortFieldCmp)(LPCWSTR, LPCWSTR, int);
+
+static int CmpSortFieldKey(const SORTLINE *s1, const SORTLINE *s2) {
+	if (s1->bNumKey || s2->bNumKey) {
+		// fields without number or date are placed after all others
+		if (s1->bNumKey != s2->bNumKey) {
+			return s1->bNumKey ? -1 : 1;
 		}
+		return (s1->numKey < s2->numKey) ? -1 : (s1->numKey > s2->numKey);
+	}
+	if (s1->pKey && s2->pKey) {
+		const int cmp = memcmp(s1->pKey, s2->pKey, min_u(s1->cbKey, s2->cbKey));
+		return cmp ? cmp : ((s1->cbKey < s2->cbKey) ? -1 : (s1->cbKey > s2->cbKey));
 	}
+	const int cmp = pfnSortFieldCmp(s1->pwszSortEntry, s2->pwszSortEntry, min_i(s1->cchSortEntry, s2->cchSortEntry));
+	return cmp ? cmp : ((s1->cchSortEntry < s2->cchSortEntry) ? -1 : (s1->cchSortEntry > s2->cchSortEntry));
+}
 
-	Sci_Position iCommentCol = 0;
-	if (!bInsertAtStart) {
-		iCommentCol = 1024;
-		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-			const Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iLine);
-			const Sci_Position iLineIndentPos = SciCall_GetLineIndentPosition(iLine);
+// lines with same field keep their order, lines are in document order before sorting.
+static int __cdecl CmpSortField(const void *p1, const void *p2) {
+	const SORTLINE *s1 = (const SORTLINE *)p1;
+	const SORTLINE *s2 = (const SORTLINE *)p2;
+	const int cmp = CmpSortFieldKey(s1, s2);
+	return cmp ? cmp : ((s1->pszLine < s2->pszLine) ? -1 : (s1->pszLine > s2->pszLine));
+}
 
-			if (iLineIndentPos != iLineEndPos) {
-				const Sci_Position iIndentColumn = SciCall_GetColumn(iLineIndentPos);
-				iCommentCol = min_pos(iCommentCol, iIndentColumn);
+static int __cdecl CmpSortFieldRev(const void *p1, const void *p2) {
+	const SORTLINE *s1 = (const SORTLINE *)p1;
+	const SORTLINE *s2 = (const SORTLINE *)p2;
+	const int cmp = CmpSortFieldKey(s2, s1);
+	return cmp ? cmp : ((s1->pszLine < s2->pszLine) ? -1 : (s1->pszLine > s2->pszLine));
+}
+
+#ifndef SORT_DIGITSASNUMBERS
+#define SORT_DIGITSASNUMBERS	0x00000008
+#endif
+
+// lines are split into runs, each run is converted and sorted on a worker thread,
+// then runs are merged pairwise until only one left.
+#define EditSortLines_ParallelMinCount	(64*1024)
+
+typedef struct SortLinesWorker {
+	SORTLINE *pLines;
+	SORTLINE *pTemp;
+	MemoryArena *arena;
+	Sci_Line *runs;		// runCount + 1 boundaries
+	BYTE **keyBuffers;	// sort keys for each run
+	DWORD runCount;
+	DWORD taskCount;
+	volatile LONG nextTask;
+	UINT cpEdit;
+	DWORD dwMapFlags;	// LCMapString() flags, 0 when sort key is not used
+	BOOL bSortColumn;
+	Sci_Position iSortColumn;
+	int tabWidth;
+	BOOL bSortField;
+	int iSortField;
+	int iFieldType;
+	int iDateOrder;		// LOCALE_IDATE: 0 M-D-Y, 1 D-M-Y, 2 Y-M-D
+	WCHAR chDelimiter;
+	QSortCmp cmpFunc;
+} SortLinesWorker;
+
+static WCHAR *EditSortLines_FindColumn(WCHAR *pwszLine, Sci_Position iSortColumn, int tabWidth) {
+	Sci_Position col = 0;
+	Sci_Position tabs = tabWidth;
+	while (*pwszLine) {
+		if (*pwszLine == L'\t') {
+			if (col + tabs <= iSortColumn) {
+				col += tabs;
+				tabs = tabWidth;
+				pwszLine = CharNext(pwszLine);
+			} else {
+				break;
 			}
+		} else if (col < iSortColumn) {
+			col++;
+			if (--tabs == 0) {
+				tabs = tabWidth;
+			}
+			pwszLine = CharNext(pwszLine);
+		} else {
+			break;
 		}
 	}
+	return pwszLine;
+}
 
-	SciCall_BeginUndoAction();
-	int iAction = 0;
+// find field in CSV or TSV line, fields may be quoted with doubled quote inside.
+static void EditSortLines_FindField(SORTLINE *line, int iSortField, WCHAR chDelimiter) {
+	WCHAR *p = line->pwszLine;
+	WCHAR *start = p;
+	WCHAR *end = p;
+	for (int i = 0; i <= iSortField; i++) {
+		start = p;
+		if (*p == L'"') {
+			start = ++p;
+			while (*p && !(*p == L'"' && p[1] != L'"')) {
+				p += (*p == L'"') ? 2 : 1;
+			}
+			end = p;
+			while (*p && *p != chDelimiter) {
+				++p;
+			}
+		} else {
+			while (*p && *p != chDelimiter) {
+				++p;
+			}
+			end = p;
+		}
+		if (*p == L'\0') {
+			if (i != iSortField) {
+				start = end = p;
+			}
+			break;
+		}
+		++p;
+	}
+	line->pwszSortEntry = start;
+	line->cchSortEntry = (int)(end - start);
+}
 
-	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-		const Sci_Position iIndentPos = SciCall_GetLineIndentPosition(iLine);
-		BOOL bWhitespaceLine = FALSE;
-		// a line with [space/tab] only
-		if (iCommentCol && iIndentPos == SciCall_GetLineEndPosition(iLine)) {
-			//continue;
-			bWhitespaceLine = TRUE;
+static BOOL EditSortLines_ParseNumber(const WCHAR *p, const WCHAR *end, double *value) {
+	char buf[64];
+	int len = 0;
+	while (p < end && (*p == L' ' || *p == L'\t')) {
+		++p;
+	}
+	if (p < end && (*p == L'+' || *p == L'-')) {
+		buf[len++] = (char)*p++;
+	}
+	BOOL digit = FALSE;
+	BOOL dot = FALSE;
+	while (p < end && len < (int)sizeof(buf) - 8) {
+		if (*p >= L'0' && *p <= L'9') {
+			digit = TRUE;
+		} else if (*p == L'.' && !dot) {
+			dot = TRUE;
+		} else {
+			break;
+		}
+		buf[len++] = (char)*p++;
+	}
+	if (!digit) {
+		return FALSE;
+	}
+	if (p + 1 < end && (*p == L'e' || *p == L'E')) {
+		const WCHAR *q = p + 1;
+		int exp = 0;
+		buf[len++] = 'e';
+		if (*q == L'+' || *q == L'-') {
+			buf[len++] = (char)*q++;
+		}
+		while (q < end && *q >= L'0' && *q <= L'9' && exp < 4) {
+			buf[len++] = (char)*q++;
+			++exp;
+		}
+		if (exp == 0) {
+			len -= (int)(q - p);
+		}
+	}
+	buf[len] = '\0';
+	*value = strtod(buf, NULL);
+	return TRUE;
+}
+
+// date and optional time are combined into YYYYMMDDhhmmss.
+static BOOL EditSortLines_ParseDate(const WCHAR *p, const WCHAR *end, int iDateOrder, double *value) {
+	int parts[6] = { 0 };
+	int count = 0;
+	int yearDigits = 0;
+	while (p < end && (*p == L' ' || *p == L'\t')) {
+		++p;
+	}
+	while (p < end && count < 6) {
+		if (*p < L'0' || *p > L'9') {
+			break;
+		}
+		int number = 0;
+		int digits = 0;
+		while (p < end && *p >= L'0' && *p <= L'9' && digits < 4) {
+			number = number*10 + (*p++ - L'0');
+			++digits;
+		}
+		if (count == 0 && digits == 4) {
+			iDateOrder = 2;
+			yearDigits = 4;
+		} else if (count == 2 && iDateOrder != 2) {
+			yearDigits = digits;
+		}
+		parts[count++] = number;
+		// separators: 2024-01-31, 31.01.2024, 01/31/2024, 2024-01-31T12:30:00
+		if (p < end && (*p == L'-' || *p == L'/' || *p == L'.' || *p == L':' || *p == L' ' || *p == L'T')) {
+			++p;
+		}
+	}
+	if (count < 3) {
+		return FALSE;
+	}
+	int year;
+	int month;
+	int day;
+	if (iDateOrder == 2) {
+		year = parts[0]; month = parts[1]; day = parts[2];
+	} else if (iDateOrder == 1) {
+		day = parts[0]; month = parts[1]; year = parts[2];
+	} else {
+		month = parts[0]; day = parts[1]; year = parts[2];
+	}
+	if (yearDigits <= 2) {
+		year += (year < 50) ? 2000 : 1900;
+	}
+	if (month < 1 || month > 12 || day < 1 || day > 31) {
+		return FALSE;
+	}
+	const int64_t date = ((int64_t)year*10000 + month*100 + day)*1000000 + parts[3]*10000 + parts[4]*100 + parts[5];
+	*value = (double)date;
+	return TRUE;
+}
+
+// detect delimiter from first line: tab for TSV, otherwise the most used one.
+static WCHAR EditSortLines_GetDelimiter(int delimiter, const char *pszLine, Sci_Position cchLine) {
+	switch (delimiter) {
+	case SortFieldDelimiterComma:
+		return L',';
+	case SortFieldDelimiterTab:
+		return L'\t';
+	case SortFieldDelimiterSemicolon:
+		return L';';
+	case SortFieldDelimiterVerticalBar:
+		return L'|';
+	default:
+		break;
+	}
+
+	Sci_Position counts[3] = { 0 };
+	for (Sci_Position i = 0; i < cchLine; i++) {
+		switch (pszLine[i]) {
+		case '\t':
+			return L'\t';
+		case ',':
+			counts[0]++;
+			break;
+		case ';':
+			counts[1]++;
+			break;
+		case '|':
+			counts[2]++;
+			break;
 		}
+	}
+	if (counts[1] > counts[0] && counts[1] >= counts[2]) {
+		return L';';
+	}
+	return (counts[2] > counts[0]) ? L'|' : L',';
+}
 
-		char tchBuf[32] = "";
-		struct Sci_TextRange tr = { { iIndentPos, iIndentPos + min_i(31, cchComment) }, tchBuf };
-		SciCall_GetTextRange(&tr);
+static void EditSortLines_SortRun(SortLinesWorker *worker, DWORD run) {
+	SORTLINE * const pLines = worker->pLines;
+	const Sci_Line iStart = worker->runs[run];
+	const Sci_Line iEnd = worker->runs[run + 1];
 
-		Sci_Position iCommentPos;
-		if (StrStartsWithCaseEx(tchBuf, mszComment, cchComment)) {
-			int ch;
-			switch (iAction) {
-			case 0:
-				iAction = 2;
-				FALLTHROUGH_ATTR;
-				// fall through
-			case 2:
-				iCommentPos = iIndentPos;
-				// a line with [space/tab] comment only
-				ch = SciCall_GetCharAt(iIndentPos + cchComment);
-				if (ch == '\n' || ch == '\r') {
-					iCommentPos = SciCall_PositionFromLine(iLine);
-				}
-				SciCall_SetTargetRange(iCommentPos, iIndentPos + cchComment);
-				SciCall_ReplaceTarget(0, "");
-				break;
-			case 1:
-				iCommentPos = SciCall_FindColumn(iLine, iCommentCol);
-				ch = SciCall_GetCharAt(iCommentPos);
-				if (ch == '\t' || ch == ' ') {
-					SciCall_InsertText(iCommentPos, mszComment);
-				}
-				break;
+	size_t cbBuffer = 0;
+	size_t cbUsed = 0;
+	BYTE *pKeys = NULL;
+	if (worker->dwMapFlags) {
+		cbBuffer = (size_t)(pLines[iEnd - 1].pszLine + pLines[iEnd - 1].cchLine - pLines[iStart].pszLine)*2 + 1024;
+		pKeys = (BYTE *)NP2TempAlloc(cbBuffer);
+	}
+	for (Sci_Line i = iStart; i < iEnd; i++) {
+		SORTLINE *line = &pLines[i];
+		const int cchLine = (int)line->cchLine;
+		const int cchw = (cchLine == 0) ? 0 : MultiByteToWideChar(worker->cpEdit, 0, line->pszLine, cchLine, line->pwszLine, cchLine);
+		line->pwszLine[cchw] = L'\0';
+		line->cchSortEntry = -1;
+		if (worker->bSortField) {
+			EditSortLines_FindField(line, worker->iSortField, worker->chDelimiter);
+			const WCHAR *end = line->pwszSortEntry + line->cchSortEntry;
+			if (worker->iFieldType == SortFieldTypeNumber) {
+				line->bNumKey = EditSortLines_ParseNumber(line->pwszSortEntry, end, &line->numKey);
+			} else if (worker->iFieldType == SortFieldTypeDate) {
+				line->bNumKey = EditSortLines_ParseDate(line->pwszSortEntry, end, worker->iDateOrder, &line->numKey);
 			}
 		} else {
-			switch (iAction) {
-			case 0:
-				iAction = 1;
-				FALLTHROUGH_ATTR;
-				// fall through
-			case 1:
-				iCommentPos = SciCall_FindColumn(iLine, iCommentCol);
-				if (!bWhitespaceLine || (iLineStart == iLineEnd)) {
-					SciCall_InsertText(iCommentPos, mszComment);
-				} else {
-					char tchComment[1024] = "";
-					Sci_Position tab = 0;
-					Sci_Position count = iCommentCol;
-					const int tabWidth = fvCurFile.iTabWidth;
-					if (!fvCurFile.bTabsAsSpaces && tabWidth > 0) {
-						tab = iCommentCol / tabWidth;
-						FillMemory(tchComment, tab, '\t');
-						count -= tab * tabWidth;
-					}
-					FillMemory(tchComment + tab, count, ' ');
-					strcat(tchComment, mszComment);
-					SciCall_InsertText(iCommentPos, tchComment);
-				}
+			line->pwszSortEntry = worker->bSortColumn ? EditSortLines_FindColumn(line->pwszLine, worker->iSortColumn, worker->tabWidth) : line->pwszLine;
+		}
+		while (pKeys != NULL && !line->bNumKey) {
+			const int cbKey = LCMapString(LOCALE_USER_DEFAULT, worker->dwMapFlags, line->pwszSortEntry, line->cchSortEntry,
+				(LPWSTR)(pKeys + cbUsed), (int)min_z(cbBuffer - cbUsed, INT_MAX));
+			if (cbKey != 0) {
+				line->cbKey = cbKey;
+				cbUsed += cbKey;
 				break;
-			case 2:
+			}
+			if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
 				break;
 			}
+			BYTE *pNewKeys = (BYTE *)NP2HeapReAlloc(pKeys, cbBuffer*2);
+			if (pNewKeys == NULL) {
+				break;
+			}
+			pKeys = pNewKeys;
+			cbBuffer *= 2;
 		}
 	}
-
-	SciCall_EndUndoAction();
-
-	if (iSelStart != iSelEnd) {
-		Sci_Position iAnchorPos;
-		if (iCurPos == iSelStart) {
-			iCurPos = SciCall_PositionFromLine(iLineStart);
-			iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
-		} else {
-			iAnchorPos = SciCall_PositionFromLine(iLineStart);
-			iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
+	if (pKeys != NULL) {
+		const BYTE *pKey = pKeys;
+		for (Sci_Line i = iStart; i < iEnd; i++) {
+			SORTLINE *line = &pLines[i];
+			if (line->cbKey) {
+				line->pKey = pKey;
+				pKey += line->cbKey;
+			}
 		}
-		SciCall_SetSel(iAnchorPos, iCurPos);
+		worker->keyBuffers[run] = pKeys;
 	}
+	qsort(pLines + iStart, iEnd - iStart, sizeof(SORTLINE), worker->cmpFunc);
+}
 
-	EndWaitCursor();
+static DWORD WINAPI EditSortLines_SortThread(LPVOID lpParam) {
+	SortLinesWorker *worker = (SortLinesWorker *)lpParam;
+	while (TRUE) {
+		const DWORD run = (DWORD)InterlockedIncrement(&worker->nextTask) - 1;
+		if (run >= worker->runCount) {
+			break;
+		}
+		EditSortLines_SortRun(worker, run);
+	}
+	return 0;
 }
 
-//=============================================================================
-//
-// EditPadWithSpaces()
-//
-void EditPadWithSpaces(BOOL bSkipEmpty, BOOL bNoUndoGroup) {
-	Sci_Position iMaxColumn = 0;
-	BOOL bReducedSelection = FALSE;
+// merge run 2*task and 2*task + 1 from pLines into pTemp.
+static DWORD WINAPI EditSortLines_MergeThread(LPVOID lpParam) {
+	SortLinesWorker *worker = (SortLinesWorker *)lpParam;
+	const QSortCmp cmpFunc = worker->cmpFunc;
+	while (TRUE) {
+		const DWORD task = (DWORD)InterlockedIncrement(&worker->nextTask) - 1;
+		if (task >= worker->taskCount) {
+			break;
+		}
+		const DWORD run = task*2;
+		const Sci_Line iStart = worker->runs[run];
+		const Sci_Line iMiddle = worker->runs[run + 1];
+		const Sci_Line iEnd = (run + 1 < worker->runCount) ? worker->runs[run + 2] : iMiddle;
+		const SORTLINE *pLines = worker->pLines;
+		SORTLINE *pTemp = worker->pTemp + iStart;
+		Sci_Line left = iStart;
+		Sci_Line right = iMiddle;
+		while (left < iMiddle && right < iEnd) {
+			if (cmpFunc(&pLines[right], &pLines[left]) < 0) {
+				*pTemp++ = pLines[right++];
+			} else {
+				*pTemp++ = pLines[left++];
+			}
+		}
+		memcpy(pTemp, pLines + left, (iMiddle - left)*sizeof(SORTLINE));
+		pTemp += iMiddle - left;
+		memcpy(pTemp, pLines + right, (iEnd - right)*sizeof(SORTLINE));
+	}
+	return 0;
+}
 
-	Sci_Position iSelStart = 0;
-	Sci_Position iSelEnd = 0;
+static SORTLINE *EditSortLines_Sort(SortLinesWorker *worker, Sci_Line iLineCount) {
+	worker->nextTask = 0;
+	RunOnAllProcessors(EditSortLines_SortThread, worker, worker->runCount);
+	while (worker->runCount > 1) {
+		if (worker->pTemp == NULL) {
+			worker->pTemp = (SORTLINE *)MemoryArena_Alloc(worker->arena, sizeof(SORTLINE) * iLineCount);
+			if (worker->pTemp == NULL) {
+				// sort whole array, runs are already sorted
+				qsort(worker->pLines, iLineCount, sizeof(SORTLINE), worker->cmpFunc);
+				break;
+			}
+		}
+		worker->taskCount = (worker->runCount + 1)/2;
+		worker->nextTask = 0;
+		RunOnAllProcessors(EditSortLines_MergeThread, worker, worker->taskCount);
+		SORTLINE *pLines = worker->pLines;
+		worker->pLines = worker->pTemp;
+		worker->pTemp = pLines;
+		for (DWORD i = 1; i <= worker->taskCount; i++) {
+			worker->runs[i] = worker->runs[min_u(i*2, worker->runCount)];
+		}
+		worker->runCount = worker->taskCount;
+	}
+	return worker->pLines;
+}
 
-	Sci_Line iLineStart = 0;
-	Sci_Line iLineEnd = 0;
+void EditSortLines(int iSortFlags) {
+	Sci_Position iCurPos = SciCall_GetCurrentPos();
+	Sci_Position iAnchorPos = SciCall_GetAnchor();
+	if (iCurPos == iAnchorPos) {
+		return;
+	}
 
 	Sci_Line iRcCurLine = 0;
 	Sci_Line iRcAnchorLine = 0;
 	Sci_Position iRcCurCol = 0;
 	Sci_Position iRcAnchorCol = 0;
 
-	const BOOL bIsRectangular = SciCall_IsRectangleSelection();
-	if (!bIsRectangular ) {
-		iSelStart = SciCall_GetSelectionStart();
-		iSelEnd = SciCall_GetSelectionEnd();
-
-		iLineStart = SciCall_LineFromPosition(iSelStart);
-		iLineEnd = SciCall_LineFromPosition(iSelEnd);
-
-		if (iLineStart == iLineEnd) {
-			iLineStart = 0;
-			iLineEnd = SciCall_GetLineCount() - 1;
-		} else {
-			if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
-				if (iLineEnd - iLineStart >= 1) {
-					iLineEnd--;
-					bReducedSelection = TRUE;
-				}
-			}
-		}
-
-		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-			const Sci_Position iPos = SciCall_GetLineEndPosition(iLine);
-			iMaxColumn = max_pos(iMaxColumn, SciCall_GetColumn(iPos));
-		}
-	} else {
-		const Sci_Position iCurPos = SciCall_GetCurrentPos();
-		const Sci_Position iAnchorPos = SciCall_GetAnchor();
+	Sci_Position iSelStart = 0;
+	Sci_Line iLineStart;
+	Sci_Line iLineEnd;
+	Sci_Position iSortColumn;
 
+	const BOOL bIsRectangular = SciCall_IsRectangleSelection();
+	if (bIsRectangular) {
 		iRcCurLine = SciCall_LineFromPosition(iCurPos);
 		iRcAnchorLine = SciCall_LineFromPosition(iAnchorPos);
 
 		iRcCurCol = SciCall_GetColumn(iCurPos);
 		iRcAnchorCol = SciCall_GetColumn(iAnchorPos);
 
-		iLineStart = 0;
-		iLineEnd = SciCall_GetLineCount() - 1;
-
-		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-			const Sci_Position iPos = SciCall_GetLineSelEndPosition(iLine);
-			if (iPos >= 0) {
-				iMaxColumn = max_pos(iMaxColumn, SciCall_GetColumn(iPos));
-			}
-		}
-	}
-
-	char *pmszPadStr = (char *)NP2HeapAlloc((iMaxColumn + 1) * sizeof(char));
-	if (pmszPadStr) {
-		FillMemory(pmszPadStr, NP2HeapSize(pmszPadStr), ' ');
-
-		if (!bNoUndoGroup) {
-			SciCall_BeginUndoAction();
-		}
-
-		for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-			const Sci_Position iLineSelEndPos = SciCall_GetLineSelEndPosition(iLine);
-			if (bIsRectangular && iLineSelEndPos < 0) {
-				continue;
-			}
-
-			const Sci_Position iPos = SciCall_GetLineEndPosition(iLine);
-			if (bIsRectangular && iPos > iLineSelEndPos) {
-				continue;
-			}
+		iLineStart = min_pos(iRcCurLine, iRcAnchorLine);
+		iLineEnd = max_pos(iRcCurLine, iRcAnchorLine);
+		iSortColumn = min_pos(iRcCurCol, iRcAnchorCol);
+	} else {
+		iSelStart = SciCall_GetSelectionStart();
+		const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
 
-			if (bSkipEmpty && SciCall_PositionFromLine(iLine) >= iPos) {
-				continue;
-			}
+		const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
+		iSelStart = SciCall_PositionFromLine(iLine);
 
-			const Sci_Position iPadLen = iMaxColumn - SciCall_GetColumn(iPos);
+		iLineStart = SciCall_LineFromPosition(iSelStart);
+		iLineEnd = SciCall_LineFromPosition(iSelEnd);
 
-			SciCall_SetTargetRange(iPos, iPos);
-			SciCall_ReplaceTarget(iPadLen, pmszPadStr);
+		if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
+			iLineEnd--;
 		}
 
-		NP2HeapFree(pmszPadStr);
+		iSortColumn = SciCall_GetColumn(iCurPos);
+	}
 
-		if (!bNoUndoGroup) {
-			SciCall_EndUndoAction();
-		}
+	const Sci_Line iLineCount = iLineEnd - iLineStart + 1;
+	if (iLineCount < 2) {
+		return;
 	}
 
-	if (!bIsRectangular && SciCall_LineFromPosition(iSelStart) != SciCall_LineFromPosition(iSelEnd)) {
-		Sci_Position iCurPos = SciCall_GetCurrentPos();
-		Sci_Position iAnchorPos = SciCall_GetAnchor();
+	char mszEOL[] = "\r\n";
+	const UINT cpEdit = SciCall_GetCodePage();
+	const int iEOLMode = SciCall_GetEOLMode();
+	if (iEOLMode == SC_EOL_CR) {
+		mszEOL[1] = 0;
+	} else if (iEOLMode == SC_EOL_LF) {
+		mszEOL[0] = '\n';
+		mszEOL[1] = 0;
+	}
+	const int cchEOL = (int)strlen(mszEOL);
 
-		if (iCurPos < iAnchorPos) {
-			iCurPos = SciCall_PositionFromLine(iLineStart);
-			if (!bReducedSelection) {
-				iAnchorPos = SciCall_GetLineEndPosition(iLineEnd);
-			} else {
-				iAnchorPos = SciCall_PositionFromLine(iLineEnd + 1);
-			}
-		} else {
-			iAnchorPos = SciCall_PositionFromLine(iLineStart);
-			if (!bReducedSelection) {
-				iCurPos = SciCall_GetLineEndPosition(iLineEnd);
-			} else {
-				iCurPos = SciCall_PositionFromLine(iLineEnd + 1);
+	const BOOL bSortField = (iSortFlags & (SORT_FIELD | SORT_SHUFFLE)) == SORT_FIELD;
+	SciCall_BeginUndoAction();
+	EditBeginBulkModification();
+	if (bIsRectangular && !bSortField) {
+		EditPadWithSpaces(!(iSortFlags & SORT_SHUFFLE));
+	}
+
+	// sorted lines point into document buffer until they are copied into pmszResult, which replaces the lines.
+	const Sci_Position iStartPos = SciCall_PositionFromLine(iLineStart);
+	const Sci_Position iEndPos = SciCall_PositionFromLine(iLineEnd + 1);
+	const char *pszText = SciCall_GetRangePointer(iStartPos, iEndPos - iStartPos);
+	MemoryArena arena;
+	MemoryArena_Init(&arena);
+	SORTLINE *pLines = (SORTLINE *)MemoryArena_Alloc(&arena, sizeof(SORTLINE) * iLineCount);
+	Sci_Position iLinePos = iStartPos;
+	for (Sci_Line i = 0, iLine = iLineStart; iLine <= iLineEnd; i++, iLine++) {
+		const Sci_Position iNextPos = SciCall_PositionFromLine(iLine + 1);
+		const char *pszLine = pszText + (iLinePos - iStartPos);
+		Sci_Position cchLine = iNextPos - iLinePos;
+		// remove EOL
+		if (cchLine != 0 && (pszLine[cchLine - 1] == '\n' || pszLine[cchLine - 1] == '\r')) {
+			--cchLine;
+			if (cchLine != 0 && pszLine[cchLine - 1] == '\r') {
+				--cchLine;
 			}
 		}
-		SciCall_SetSel(iAnchorPos, iCurPos);
-	} else if (bIsRectangular) {
-		const Sci_Position iCurPos = SciCall_FindColumn(iRcCurLine, iRcCurCol);
-		const Sci_Position iAnchorPos = SciCall_FindColumn(iRcAnchorLine, iRcAnchorCol);
-
-		SciCall_SetRectangularSelectionCaret(iCurPos);
-		SciCall_SetRectangularSelectionAnchor(iAnchorPos);
+		pLines[i].pszLine = pszLine;
+		pLines[i].cchLine = cchLine;
+		iLinePos = iNextPos;
 	}
-}
 
-//=============================================================================
-//
-// EditStripFirstCharacter()
-//
-void EditStripFirstCharacter(void) {
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
-	}
+	WCHAR *pwszText = NULL;
+	BYTE *keyBuffers[MAXIMUM_WAIT_OBJECTS] = { NULL };
+	if (iSortFlags & SORT_SHUFFLE) {
+		srand(GetTickCount());
+		for (Sci_Line i = iLineCount - 1; i > 0; i--) {
+			const Sci_Line j = rand() % i;
+			const SORTLINE sLine = pLines[i];
+			pLines[i] = pLines[j];
+			pLines[j] = sLine;
+		}
+	} else {
+		// each line converted in place, a byte is at most one UTF-16 code unit.
+		pwszText = (WCHAR *)MemoryArena_Alloc(&arena, sizeof(WCHAR) * (iEndPos - iStartPos + iLineCount));
+		for (Sci_Line i = 0; i < iLineCount; i++) {
+			pLines[i].pwszLine = pwszText + (pLines[i].pszLine - pszText) + i;
+		}
 
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+		pfnSortLinesCmp = (iSortFlags & SORT_LOGICAL)
+			? ((iSortFlags & SORT_NOCASE) ? CmpILogical : CmpLogical)
+			: ((iSortFlags & SORT_NOCASE) ? CmpIStd : CmpStd);
+		// StrCmpLogicalW() ignores case, digits are compared as numbers since Windows 7,
+		// older system rejects SORT_DIGITSASNUMBERS, then lines are compared as strings.
+		DWORD dwMapFlags = LCMAP_SORTKEY | ((iSortFlags & SORT_LOGICAL) ? (SORT_DIGITSASNUMBERS | NORM_IGNORECASE)
+			: ((iSortFlags & SORT_NOCASE) ? NORM_IGNORECASE : 0));
+		BYTE probe[64];
+		if (LCMapString(LOCALE_USER_DEFAULT, dwMapFlags, L"a1", -1, (LPWSTR)probe, sizeof(probe)) == 0) {
+			dwMapFlags = 0;
+		}
+
+		DWORD runCount = 1;
+		if (iLineCount >= EditSortLines_ParallelMinCount) {
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			runCount = min_u(info.dwNumberOfProcessors, MAXIMUM_WAIT_OBJECTS);
+		}
+		Sci_Line runs[MAXIMUM_WAIT_OBJECTS + 1];
+		for (DWORD i = 0; i <= runCount; i++) {
+			runs[i] = (iLineCount * i) / runCount;
+		}
+
+		SortLinesWorker worker;
+		ZeroMemory(&worker, sizeof(worker));
+		worker.pLines = pLines;
+		worker.arena = &arena;
+		worker.runs = runs;
+		worker.keyBuffers = keyBuffers;
+		worker.runCount = runCount;
+		worker.cpEdit = cpEdit;
+		worker.dwMapFlags = dwMapFlags;
+		worker.bSortColumn = (iSortFlags & SORT_COLUMN) != 0;
+		worker.iSortColumn = iSortColumn;
+		worker.tabWidth = fvCurFile.iTabWidth;
+		worker.cmpFunc = (iSortFlags & SORT_DESCENDING) ? CmpSortKeyRev : CmpSortKey;
+		if (bSortField) {
+			worker.bSortColumn = FALSE;
+			worker.bSortField = TRUE;
+			worker.iSortField = (iSortFlags >> SORT_FIELD_INDEX_SHIFT) & SORT_FIELD_INDEX_MASK;
+			worker.iFieldType = (iSortFlags >> SORT_FIELD_TYPE_SHIFT) & SORT_FIELD_TYPE_MASK;
+			worker.chDelimiter = EditSortLines_GetDelimiter((iSortFlags >> SORT_FIELD_DELIMITER_SHIFT) & SORT_FIELD_DELIMITER_MASK,
+				pLines[0].pszLine, pLines[0].cchLine);
+			if (worker.iFieldType == SortFieldTypeDate) {
+				WCHAR tchOrder[4] = L"";
+				GetLocaleInfo(LOCALE_USER_DEFAULT, LOCALE_IDATE, tchOrder, COUNTOF(tchOrder));
+				worker.iDateOrder = tchOrder[0] - L'0';
+			}
+			pfnSortFieldCmp = (iSortFlags & SORT_NOCASE) ? StrCmpNIW : StrCmpNW;
+			worker.cmpFunc = (iSortFlags & SORT_DESCENDING) ? CmpSortFieldRev : CmpSortField;
+		}
+		pLines = EditSortLines_Sort(&worker, iLineCount);
+	}
+
+	char *pmszResult = (char *)MemoryArena_Alloc(&arena, iEndPos - iStartPos + 2 * iLineCount + 1);
+	FNSTRCMP pfnStrCmp = (iSortFlags & SORT_NOCASE) ? StrCmpIW : StrCmpW;
+
+	Sci_Position length = 0;
+	BOOL bLastDup = FALSE;
+	for (Sci_Line i = 0; i < iLineCount; i++) {
+		if ((iSortFlags & SORT_SHUFFLE) || StrNotEmpty(pLines[i].pwszLine)) {
+			BOOL bDropLine = FALSE;
+			if (!(iSortFlags & SORT_SHUFFLE)) {
+				if (iSortFlags & (SORT_MERGEDUP | SORT_UNIQDUP | SORT_UNIQUNIQ)) {
+					if (i < iLineCount - 1) {
+						if (pfnStrCmp(pLines[i].pwszLine, pLines[i + 1].pwszLine) == 0) {
+							bLastDup = TRUE;
+							bDropLine = iSortFlags & (SORT_MERGEDUP | SORT_UNIQDUP);
+						} else {
+							bDropLine = (!bLastDup && (iSortFlags & SORT_UNIQUNIQ)) || (bLastDup && (iSortFlags & SORT_UNIQDUP));
+							bLastDup = FALSE;
+						}
+					} else {
+						bDropLine = (!bLastDup && (iSortFlags & SORT_UNIQUNIQ)) || (bLastDup && (iSortFlags & SORT_UNIQDUP));
+						bLastDup = FALSE;
+					}
+				}
+			}
 
-	Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
-	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+			if (!bDropLine) {
+				memcpy(pmszResult + length, pLines[i].pszLine, pLines[i].cchLine);
+				length += pLines[i].cchLine;
+				memcpy(pmszResult + length, mszEOL, cchEOL);
+				length += cchEOL;
+			}
+		}
+	}
 
-	if (iLineStart != iLineEnd) {
-		if (iSelStart > SciCall_PositionFromLine(iLineStart)) {
-			iLineStart++;
+	for (DWORD i = 0; i < MAXIMUM_WAIT_OBJECTS; i++) {
+		if (keyBuffers[i]) {
+			NP2TempFree(keyBuffers[i]);
 		}
+	}
 
-		if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
-			iLineEnd--;
+	if (!bIsRectangular) {
+		if (iAnchorPos > iCurPos) {
+			iCurPos = iSelStart;
+			iAnchorPos = iSelStart + length;
+		} else {
+			iAnchorPos = iSelStart;
+			iCurPos = iSelStart + length;
 		}
 	}
 
-	SciCall_BeginUndoAction();
+	SciCall_SetTargetRange(iStartPos, iEndPos);
+	SciCall_ReplaceTarget(length, pmszResult);
+	EditEndBulkModification();
+	SciCall_EndUndoAction();
 
-	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-		const Sci_Position iPos = SciCall_PositionFromLine(iLine);
-		if (SciCall_GetLineEndPosition(iLine) > iPos) {
-			SciCall_SetTargetRange(iPos, SciCall_PositionAfter(iPos));
-			SciCall_ReplaceTarget(0, "");
+	MemoryArena_Release(&arena);
+
+	if (!bIsRectangular) {
+		SciCall_SetSel(iAnchorPos, iCurPos);
+	} else {
+		const Sci_Position iTargetStart = SciCall_GetTargetStart();
+		Sci_Position iTargetEnd = SciCall_GetTargetEnd();
+		SciCall_ClearSelections();
+		if (iTargetStart != iTargetEnd) {
+			iTargetEnd -= cchEOL;
+			if (iRcAnchorLine > iRcCurLine) {
+				iCurPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetStart), iRcCurCol);
+				iAnchorPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetEnd), iRcAnchorCol);
+			} else {
+				iCurPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetEnd), iRcCurCol);
+				iAnchorPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetStart), iRcAnchorCol);
+			}
+			if (iCurPos != iAnchorPos) {
+				SciCall_SetRectangularSelectionCaret(iCurPos);
+				SciCall_SetRectangularSelectionAnchor(iAnchorPos);
+			} else {
+				SciCall_SetSel(iTargetStart, iTargetStart);
+			}
+		} else {
+			SciCall_SetSel(iTargetStart, iTargetStart);
 		}
 	}
-	SciCall_EndUndoAction();
 }
 
 //=============================================================================
 //
-// EditStripLastCharacter()
+// EditJumpTo()
 //
-void EditStripLastCharacter(void) {
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+void EditJumpTo(Sci_Line iNewLine, Sci_Position iNewCol) {
+	const Sci_Line iMaxLine = SciCall_GetLineCount();
+
+	// Jumpt to end with line set to -1
+	if (iNewLine < 0 || iNewLine >= iMaxLine) {
+		SciCall_DocumentEnd();
 		return;
 	}
 
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-
-	Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
-	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
+	const Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iNewLine - 1);
+	iNewCol = min_pos(iNewCol, iLineEndPos);
+	const Sci_Position iNewPos = SciCall_FindColumn(iNewLine - 1, iNewCol - 1);
+	// SciCall_GotoPos(pos) is equivalent to SciCall_SetSel(-1, pos)
+	EditSelectEx(INVALID_POSITION, iNewPos);
+	SciCall_ChooseCaretX();
+}
 
-	if (iLineStart != iLineEnd) {
-		if (iSelStart >= SciCall_GetLineEndPosition(iLineStart)) {
-			iLineStart++;
-		}
+//=============================================================================
+//
+// EditSelectEx()
+//
+void EditSelectEx(Sci_Position iAnchorPos, Sci_Position iCurrentPos) {
+	const Sci_Line iNewLine = SciCall_LineFromPosition(iCurrentPos);
+	const Sci_Line iAnchorLine = SciCall_LineFromPosition(iAnchorPos);
 
-		if (iSelEnd < SciCall_GetLineEndPosition(iLineEnd)) {
-			iLineEnd--;
-		}
+	if (iAnchorLine == iNewLine) {
+		// TODO: center current line on screen when it's not visible
+		SciCall_EnsureVisible(iAnchorLine);
+	} else {
+		// Ensure that the first and last lines of a selection are always unfolded
+		// This needs to be done *before* the SciCall_SetSel() message
+		SciCall_EnsureVisible(iAnchorLine);
+		SciCall_EnsureVisible(iNewLine);
 	}
 
-	SciCall_BeginUndoAction();
-
-	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd; iLine++) {
-		const Sci_Position iStartPos = SciCall_PositionFromLine(iLine);
-		const Sci_Position iEndPos = SciCall_GetLineEndPosition(iLine);
-
-		if (iEndPos > iStartPos) {
-			SciCall_SetTargetRange(SciCall_PositionBefore(iEndPos), iEndPos);
-			SciCall_ReplaceTarget(0, "");
-		}
-	}
-	SciCall_EndUndoAction();
+	SciCall_SetXCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 50);
+	SciCall_SetYCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 5);
+	SciCall_SetSel(iAnchorPos, iCurrentPos);
+	SciCall_SetXCaretPolicy(CARET_SLOP | CARET_EVEN, 50);
+	SciCall_SetYCaretPolicy(CARET_EVEN, 0);
 }
 
 //=============================================================================
 //
-// EditStripTrailingBlanks()
+// EditFixPositions()
 //
-void EditStripTrailingBlanks(HWND hwnd, BOOL bIgnoreSelection) {
-	// Check if there is any selection... simply use a regular expression replace!
-	if (!bIgnoreSelection && !SciCall_IsSelectionEmpty()) {
-		if (!SciCall_IsRectangleSelection()) {
-#if NP2_USE_DESIGNATED_INITIALIZER
-			EDITFINDREPLACE efrTrim = {
-				.szFind = "[ \t]+$",
-				.hwnd = hwnd,
-				.fuFlags = SCFIND_REGEXP,
-			};
-#else
-			EDITFINDREPLACE efrTrim = { "[ \t]+$", "", "", "", hwnd, SCFIND_REGEXP };
-#endif
-			if (EditReplaceAllInSelection(hwnd, &efrTrim, FALSE)) {
-				return;
-			}
+void EditFixPositions(void) {
+	const Sci_Position iMaxPos = SciCall_GetLength();
+	Sci_Position iCurrentPos = SciCall_GetCurrentPos();
+	const Sci_Position iAnchorPos = SciCall_GetAnchor();
+
+	if (iCurrentPos > 0 && iCurrentPos < iMaxPos) {
+		const Sci_Position iNewPos = SciCall_PositionAfter(SciCall_PositionBefore(iCurrentPos));
+		if (iNewPos != iCurrentPos) {
+			SciCall_SetCurrentPos(iNewPos);
+			iCurrentPos = iNewPos;
 		}
 	}
 
-	// Code from SciTE...
-	SciCall_BeginUndoAction();
-	const Sci_Line maxLines = SciCall_GetLineCount();
-	for (Sci_Line line = 0; line < maxLines; line++) {
-		const Sci_Position lineStart = SciCall_PositionFromLine(line);
-		const Sci_Position lineEnd = SciCall_GetLineEndPosition(line);
-		Sci_Position i = lineEnd - 1;
-		int ch = SciCall_GetCharAt(i);
-		while ((i >= lineStart) && (ch == ' ' || ch == '\t')) {
-			i--;
-			ch = SciCall_GetCharAt(i);
-		}
-		if (i < (lineEnd - 1)) {
-			SciCall_SetTargetRange(i + 1, lineEnd);
-			SciCall_ReplaceTarget(0, "");
+	if (iAnchorPos != iCurrentPos && iAnchorPos > 0 && iAnchorPos < iMaxPos) {
+		const Sci_Position iNewPos = SciCall_PositionAfter(SciCall_PositionBefore(iAnchorPos));
+		if (iNewPos != iAnchorPos) {
+			SciCall_SetAnchor(iNewPos);
 		}
 	}
-	SciCall_EndUndoAction();
 }
 
 //=============================================================================
 //
-// EditStripLeadingBlanks()
+// EditEnsureSelectionVisible()
 //
-void EditStripLeadingBlanks(HWND hwnd, BOOL bIgnoreSelection) {
-	// Check if there is any selection... simply use a regular expression replace!
-	if (!bIgnoreSelection && !SciCall_IsSelectionEmpty()) {
-		if (!SciCall_IsRectangleSelection()) {
-#if NP2_USE_DESIGNATED_INITIALIZER
-			EDITFINDREPLACE efrTrim = {
-				.szFind = "^[ \t]+",
-				.hwnd = hwnd,
-				.fuFlags = SCFIND_REGEXP,
-			};
-#else
-			EDITFINDREPLACE efrTrim = { "^[ \t]+", "", "", "", hwnd, SCFIND_REGEXP };
-#endif
-			if (EditReplaceAllInSelection(hwnd, &efrTrim, FALSE)) {
+void EditEnsureSelectionVisible(void) {
+	const Sci_Position iAnchorPos = SciCall_GetAnchor();
+	const Sci_Position iCurrentPos = SciCall_GetCurrentPos();
+	EditSelectEx(iAnchorPos, iCurrentPos);
+}
+
+void EditEnsureConsistentLineEndings(void) {
+	const int iEOLMode = SciCall_GetEOLMode();
+	if (iEOLMode == SC_EOL_CRLF) {
+#if defined(_WIN64)
+		const int options = SciCall_GetDocumentOptions();
+		if (!(options & SC_DOCUMENTOPTION_TEXT_LARGE)) {
+			const Sci_Position dwLength = SciCall_GetLength() + SciCall_GetLineCount();
+			if (dwLength >= INT_MAX) {
 				return;
 			}
 		}
-	}
-
-	// Code from SciTE...
-	SciCall_BeginUndoAction();
-	const Sci_Line maxLines = SciCall_GetLineCount();
-	for (Sci_Line line = 0; line < maxLines; line++) {
-		const Sci_Position lineStart = SciCall_PositionFromLine(line);
-		const Sci_Position lineEnd = SciCall_GetLineEndPosition(line);
-		Sci_Position i = lineStart;
-		int ch = SciCall_GetCharAt(i);
-		while ((i <= lineEnd - 1) && (ch == ' ' || ch == '\t')) {
-			i++;
-			ch = SciCall_GetCharAt(i);
-		}
-		if (i > lineStart) {
-			SciCall_SetTargetRange(lineStart, i);
-			SciCall_ReplaceTarget(0, "");
+#else
+		const DWORD dwLength = (DWORD)SciCall_GetLength() + (DWORD)SciCall_GetLineCount();
+		if (dwLength >= INT_MAX) {
+			return;
 		}
+#endif
 	}
-	SciCall_EndUndoAction();
+
+	SciCall_ConvertEOLs(iEOLMode);
+	EditFixPositions();
 }
 
 //=============================================================================
 //
-// EditCompressSpaces()
+// EditGetExcerpt()
 //
-void EditCompressSpaces(void) {
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+void EditGetExcerpt(LPWSTR lpszExcerpt, DWORD cchExcerpt) {
+	if (SciCall_IsSelectionEmpty() || SciCall_IsRectangleSelection()) {
+		lstrcpy(lpszExcerpt, L"");
 		return;
 	}
 
+	WCHAR tch[256] = L"";
+	DWORD cch = 0;
 	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-	Sci_Position iCurPos = SciCall_GetCurrentPos();
-	Sci_Position iAnchorPos = SciCall_GetAnchor();
+	const Sci_Position iSelEnd = min_pos(min_pos(SciCall_GetSelectionEnd(), iSelStart + COUNTOF(tch)), SciCall_GetLength());
+	const Sci_Position iSelCount = iSelEnd - iSelStart;
 
-	char *pszIn;
-	char *pszOut;
-	BOOL bIsLineStart;
-	BOOL bIsLineEnd;
+	char *pszText = (char *)NP2HeapAlloc(iSelCount + 2);
+	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
 
-	if (iSelStart != iSelEnd) {
-		const Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
-		const Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
-		const Sci_Position cch = SciCall_GetSelTextLength();
-		pszIn = (char *)NP2HeapAlloc(cch);
-		pszOut = (char *)NP2HeapAlloc(cch);
-		SciCall_GetSelText(pszIn);
-		bIsLineStart = (iSelStart == SciCall_PositionFromLine(iLineStart));
-		bIsLineEnd = (iSelEnd == SciCall_GetLineEndPosition(iLineEnd));
-	} else {
-		const Sci_Position cch = SciCall_GetLength() + 1;
-		pszIn = (char *)NP2HeapAlloc(cch);
-		pszOut = (char *)NP2HeapAlloc(cch);
-		SciCall_GetText(cch, pszIn);
-		bIsLineStart = TRUE;
-		bIsLineEnd = TRUE;
-	}
+	struct Sci_TextRange tr = { { iSelStart, iSelEnd }, pszText };
+	SciCall_GetTextRange(&tr);
+	const UINT cpEdit = SciCall_GetCodePage();
+	MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
 
-	BOOL bModified = FALSE;
-	char *ci;
-	char *co = pszOut;
-	for (ci = pszIn; *ci; ci++) {
-		if (*ci == ' ' || *ci == '\t') {
-			if (*ci == '\t') {
-				bModified = TRUE;
-			}
-			while (*(ci + 1) == ' ' || *(ci + 1) == '\t') {
-				ci++;
-				bModified = TRUE;
-			}
-			if (!bIsLineStart && (*(ci + 1) != '\n' && *(ci + 1) != '\r')) {
-				*co++ = ' ';
-			} else {
-				bModified = TRUE;
+	for (WCHAR *p = pszTextW; *p && cch < COUNTOF(tch) - 1; p++) {
+		if (*p == L'\r' || *p == L'\n' || *p == L'\t' || *p == L' ') {
+			tch[cch++] = L' ';
+			while (*(p + 1) == L'\r' || *(p + 1) == L'\n' || *(p + 1) == L'\t' || *(p + 1) == L' ') {
+				p++;
 			}
 		} else {
-			if (*ci == '\n' || *ci == '\r') {
-				bIsLineStart = TRUE;
-			} else {
-				bIsLineStart = FALSE;
-			}
-			*co++ = *ci;
+			tch[cch++] = *p;
 		}
 	}
-	if (bIsLineEnd && co > pszOut && *(co - 1) == ' ') {
-		*--co = 0;
-		bModified = TRUE;
+	tch[cch++] = L'\0';
+	StrTrim(tch, L" ");
+
+	if (cch == 1) {
+		lstrcpy(tch, L" ... ");
 	}
 
-	if (bModified) {
-		if (iSelStart != iSelEnd) {
-			SciCall_TargetFromSelection();
+	if (cch > cchExcerpt) {
+		tch[cchExcerpt - 2] = L'.';
+		tch[cchExcerpt - 3] = L'.';
+		tch[cchExcerpt - 4] = L'.';
+	}
+	lstrcpyn(lpszExcerpt, tch, cchExcerpt);
+
+	NP2HeapFree(pszText);
+	NP2HeapFree(pszTextW);
+}
+
+void EditSelectWord(void) {
+	const Sci_Position iPos = SciCall_GetCurrentPos();
+
+	if (SciCall_IsSelectionEmpty()) {
+		Sci_Position iWordStart = SciCall_WordStartPosition(iPos, TRUE);
+		Sci_Position iWordEnd = SciCall_WordEndPosition(iPos, TRUE);
+
+		if (iWordStart == iWordEnd) {// we are in whitespace salad...
+			iWordStart = SciCall_WordEndPosition(iPos, FALSE);
+			iWordEnd = SciCall_WordEndPosition(iWordStart, TRUE);
+			if (iWordStart != iWordEnd) {
+				//if (IsDocWordChar(SciCall_GetCharAt(iWordStart - 1))) {
+				//	--iWordStart;
+				//}
+				SciCall_SetSel(iWordStart, iWordEnd);
+			}
 		} else {
-			SciCall_TargetWholeDocument();
+			//if (IsDocWordChar(SciCall_GetCharAt(iWordStart - 1))) {
+			//	--iWordStart;
+			//}
+			SciCall_SetSel(iWordStart, iWordEnd);
 		}
-		SciCall_BeginUndoAction();
-		SciCall_ReplaceTarget(-1, pszOut);
-		if (iCurPos > iAnchorPos) {
-			iCurPos = SciCall_GetTargetEnd();
-			iAnchorPos = SciCall_GetTargetStart();
-		} else if (iCurPos < iAnchorPos) {
-			iCurPos = SciCall_GetTargetStart();
-			iAnchorPos = SciCall_GetTargetEnd();
+
+		if (!SciCall_IsSelectionEmpty()) {
+			return;
 		}
-		SciCall_SetSel(iAnchorPos, iCurPos);
-		SciCall_EndUndoAction();
 	}
 
-	NP2HeapFree(pszIn);
-	NP2HeapFree(pszOut);
+	const Sci_Line iLine = SciCall_LineFromPosition(iPos);
+	const Sci_Position iLineStart = SciCall_GetLineIndentPosition(iLine);
+	const Sci_Position iLineEnd = SciCall_GetLineEndPosition(iLine);
+	SciCall_SetSel(iLineStart, iLineEnd);
 }
 
-//=============================================================================
-//
-// EditRemoveBlankLines()
-//
-void EditRemoveBlankLines(BOOL bMerge) {
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
+void EditSelectLines(BOOL currentBlock, BOOL lineSelection) {
+	if (lineSelection && !currentBlock) {
+		SciCall_SetSelectionMode(SC_SEL_LINES);
 		return;
 	}
 
-	Sci_Position iSelStart = SciCall_GetSelectionStart();
-	Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-
-	if (iSelStart == iSelEnd) {
-		iSelStart = 0;
-		iSelEnd = SciCall_GetLength();
-	}
-
-	Sci_Line iLineStart = SciCall_LineFromPosition(iSelStart);
-	Sci_Line iLineEnd = SciCall_LineFromPosition(iSelEnd);
-
-	if (iSelStart > SciCall_PositionFromLine(iLineStart)) {
-		iLineStart++;
-	}
-
-	if (iSelEnd <= SciCall_PositionFromLine(iLineEnd) && iLineEnd != SciCall_GetLineCount() - 1) {
-		iLineEnd--;
-	}
+	// see Editor::LineSelectionRange()
+	Sci_Position iCurrentPos = SciCall_GetCurrentPos();
+	Sci_Position iAnchorPos = SciCall_GetAnchor();
+	BOOL backward = (iCurrentPos < iAnchorPos);
 
-	SciCall_BeginUndoAction();
+	Sci_Line iLineAnchorPos = SciCall_LineFromPosition(iAnchorPos);
+	Sci_Line iLineCurPos = SciCall_LineFromPosition(iCurrentPos);
 
-	for (Sci_Line iLine = iLineStart; iLine <= iLineEnd;) {
-		Sci_Line nBlanks = 0;
-		while (iLine + nBlanks <= iLineEnd && SciCall_PositionFromLine(iLine + nBlanks) == SciCall_GetLineEndPosition(iLine + nBlanks)) {
-			nBlanks++;
+	if (currentBlock) {
+		Sci_Line iLineStart = iLineCurPos;
+		const int level = SciCall_GetFoldLevel(iLineStart);
+		if (!(level & SC_FOLDLEVELHEADERFLAG)) {
+			iLineStart = SciCall_GetFoldParent(iLineStart);
+			if (iLineStart < 0) {
+				SciCall_SelectAll();
+				return;
+			}
 		}
 
-		if (nBlanks == 0 || (nBlanks == 1 && bMerge)) {
-			iLine += nBlanks + 1;
+		const Sci_Line iLineEnd = SciCall_GetLastChild(iLineStart);
+		backward = backward || (iCurrentPos == iAnchorPos && iLineEnd - iLineCurPos > iLineCurPos - iLineStart);
+		if (backward) {
+			iLineCurPos = iLineStart;
+			iLineAnchorPos = iLineEnd;
 		} else {
-			if (bMerge) {
-				nBlanks--;
-			}
+			iLineCurPos = iLineEnd;
+			iLineAnchorPos = iLineStart;
+		}
+	}
 
-			const Sci_Position iTargetStart = SciCall_PositionFromLine(iLine);
-			const Sci_Position iTargetEnd = SciCall_PositionFromLine(iLine + nBlanks);
+	const Sci_Line offset = lineSelection ? 0 : 1;
+	if (backward) {
+		iCurrentPos = SciCall_PositionFromLine(iLineCurPos);
+		iAnchorPos = SciCall_PositionFromLine(iLineAnchorPos + offset);
+	} else {
+		iAnchorPos = SciCall_PositionFromLine(iLineAnchorPos);
+		iCurrentPos = SciCall_PositionFromLine(iLineCurPos + offset);
+	}
 
-			SciCall_SetTargetRange(iTargetStart, iTargetEnd);
-			SciCall_ReplaceTarget(0, "");
+	SciCall_SetSel(iAnchorPos, iCurrentPos);
+	if (lineSelection) {
+		SciCall_SetSelectionMode(SC_SEL_LINES);
+	}
+	SciCall_ChooseCaretX();
+}
 
-			if (bMerge) {
-				iLine++;
-			}
-			iLineEnd -= nBlanks;
+void EditSelectTagContents(void) {
+	const Sci_Position iPos = SciCall_GetCurrentPos();
+	Sci_Position iOpen = SciCall_FindTag(iPos, SC_TAGFIND_START);
+	if (iOpen >= 0 && iOpen != iPos) {
+		// inside start or end tag
+		const Sci_Position iMatch = SciCall_FindTag(iPos, SC_TAGFIND_MATCH);
+		if (iMatch < 0) {
+			return;
 		}
+		iOpen = min_pos(iOpen, iMatch);
+	} else {
+		iOpen = SciCall_FindTag(iPos, SC_TAGFIND_ENCLOSING);
 	}
-	SciCall_EndUndoAction();
-}
 
-//=============================================================================
-//
-// EditWrapToColumn()
-//
-void EditWrapToColumn(int nColumn/*, int nTabWidth*/) {
-	if (SciCall_IsSelectionEmpty()) {
+	const Sci_Position iClose = (iOpen < 0) ? INVALID_POSITION : SciCall_FindTag(iOpen, SC_TAGFIND_MATCH);
+	if (iClose < 0) {
 		return;
 	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+	const Sci_Position iStart = SciCall_FindTag(iOpen, SC_TAGFIND_END);
+	if (SciCall_GetSelectionStart() == iStart && SciCall_GetSelectionEnd() == iClose) {
+		// contents already selected, select the element
+		SciCall_SetSel(iOpen, SciCall_FindTag(iClose, SC_TAGFIND_END));
+	} else {
+		SciCall_SetSel(iStart, iClose);
 	}
+	SciCall_ChooseCaretX();
+}
 
-	Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-
-	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
-	iSelStart = SciCall_PositionFromLine(iLine);
-
-	const Sci_Position iSelCount = iSelEnd - iSelStart;
-	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1 + 2);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1 + 2) * sizeof(WCHAR));
-
-	struct Sci_TextRange tr = { { iSelStart, iSelEnd }, pszText };
-	SciCall_GetTextRange(&tr);
-
-	const UINT cpEdit = SciCall_GetCodePage();
-	const int cchTextW = MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
-	NP2HeapFree(pszText);
-
-	LPWSTR pszConvW = (LPWSTR)NP2HeapAlloc(cchTextW * sizeof(WCHAR) * 3 + 2);
-
-	WCHAR wszEOL[] = L"\r\n";
-	int cchEOL = 2;
-	const int iEOLMode = SciCall_GetEOLMode();
-	if (iEOLMode == SC_EOL_CR) {
-		cchEOL = 1;
-	} else if (iEOLMode == SC_EOL_LF) {
-		cchEOL = 1;
-		wszEOL[0] = L'\n';
+Sci_Position EditFindMatchingTag(Sci_Position iPos, Sci_Position *piTag) {
+	// caret before '<' is handled by brace matching
+	const Sci_Position iTag = SciCall_FindTag(iPos, SC_TAGFIND_START);
+	if (iTag < 0 || iTag == iPos) {
+		return INVALID_POSITION;
 	}
+	const Sci_Position iMatch = SciCall_FindTag(iPos, SC_TAGFIND_MATCH);
+	if (iMatch >= 0) {
+		*piTag = iTag;
+	}
+	return iMatch;
+}
 
-#define ISDELIMITER(wc) StrChr(L",;.:-+%&\xA6|/*?!\"\'~\xB4#=", wc)
-#define ISWHITE(wc)		IsASpaceOrTab(wc)
-#define ISWORDEND(wc)	(/*ISDELIMITER(wc) ||*/ IsASpace(wc))
-
-	int cchConvW = 0;
-	int iLineLength = 0;
-	BOOL bModified = FALSE;
-	for (int iTextW = 0; iTextW < cchTextW; iTextW++) {
-		const WCHAR w = pszTextW[iTextW];
-
-		//if (ISDELIMITER(w)) {
-		//	int iNextWordLen = 0;
-		//	WCHAR w2 = pszTextW[iTextW + 1];
-
-		//	if (iLineLength + iNextWordLen + 1 > nColumn) {
-		//		pszConvW[cchConvW++] = wszEOL[0];
-		//		if (cchEOL > 1)
-		//			pszConvW[cchConvW++] = wszEOL[1];
-		//		iLineLength = 0;
-		//		bModified = TRUE;
-		//	}
-
-		//	while (w2 != L'\0' && !ISWORDEND(w2)) {
-		//		iNextWordLen++;
-		//		w2 = pszTextW[iTextW + iNextWordLen + 1];
-		//	}
-
-		//	if (ISDELIMITER(w2) && iNextWordLen > 0) // delimiters go with the word
-		//		iNextWordLen++;
-
-		//	pszConvW[cchConvW++] = w;
-		//	iLineLength++;
-
-		//	if (iNextWordLen > 0) {
-		//		if (iLineLength + iNextWordLen + 1 > nColumn) {
-		//			pszConvW[cchConvW++] = wszEOL[0];
-		//			if (cchEOL > 1)
-		//				pszConvW[cchConvW++] = wszEOL[1];
-		//			iLineLength = 0;
-		//			bModified = TRUE;
-		//		}
-		//	}
-		//}
-
-		if (ISWHITE(w)) {
-			while (IsASpaceOrTab(pszTextW[iTextW + 1])) {
-				iTextW++;
-				bModified = TRUE;
-			} // Modified: left out some whitespaces
-
-			WCHAR w2 = pszTextW[iTextW + 1];
-			int iNextWordLen = 0;
-
-			while (w2 != L'\0' && !ISWORDEND(w2)) {
-				iNextWordLen++;
-				w2 = pszTextW[iTextW + iNextWordLen + 1];
-			}
+static LRESULT CALLBACK AddBackslashEditProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData) {
+	UNREFERENCED_PARAMETER(dwRefData);
 
-			//if (ISDELIMITER(w2) /*&& iNextWordLen > 0*/) // delimiters go with the word
-			//	iNextWordLen++;
-			if (iNextWordLen > 0) {
-				if (iLineLength + iNextWordLen + 1 > nColumn) {
-					pszConvW[cchConvW++] = wszEOL[0];
-					if (cchEOL > 1) {
-						pszConvW[cchConvW++] = wszEOL[1];
-					}
-					iLineLength = 0;
-					bModified = TRUE;
-				} else {
-					if (iLineLength > 0) {
-						pszConvW[cchConvW++] = L' ';
-						iLineLength++;
-					}
-				}
-			}
-		} else {
-			pszConvW[cchConvW++] = w;
-			if (w == L'\r' || w == L'\n') {
-				iLineLength = 0;
-			} else {
-				iLineLength++;
+	switch (umsg) {
+	case WM_PASTE: {
+		BOOL done = FALSE;
+		LPWSTR lpsz = EditGetClipboardTextW();
+		if (StrNotEmpty(lpsz)) {
+			const int len = lstrlen(lpsz);
+			LPWSTR lpszEsc = (LPWSTR)NP2HeapAlloc((2*len + 1)*sizeof(WCHAR));
+			if (lpszEsc != NULL) {
+				AddBackslashW(lpszEsc, lpsz);
+				SendMessage(hwnd, EM_REPLACESEL, TRUE, (LPARAM)(lpszEsc));
+				NP2HeapFree(lpszEsc);
+				done = TRUE;
 			}
 		}
+		if (lpsz != NULL) {
+			NP2HeapFree(lpsz);
+		}
+		if (done) {
+			return TRUE;
+		}
 	}
+	break;
 
-	NP2HeapFree(pszTextW);
-
-	if (bModified) {
-		pszText = (char *)NP2HeapAlloc(cchConvW * kMaxMultiByteCount);
-		const int cchText = WideCharToMultiByte(cpEdit, 0, pszConvW, cchConvW, pszText, (int)NP2HeapSize(pszText), NULL, NULL);
-		EditReplaceRange(iSelStart, iSelEnd, cchText, pszText);
-		NP2HeapFree(pszText);
+	case WM_NCDESTROY:
+		RemoveWindowSubclass(hwnd, AddBackslashEditProc, uIdSubclass);
+		break;
 	}
 
-	NP2HeapFree(pszConvW);
+	return DefSubclassProc(hwnd, umsg, wParam, lParam);
 }
 
-//=============================================================================
-//
-// EditJoinLinesEx()
-//
-void EditJoinLinesEx(void) {
-	if (SciCall_IsSelectionEmpty()) {
-		return;
-	}
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return;
+void AddBackslashComboBoxSetup(HWND hwndDlg, int nCtlId) {
+	HWND hwnd = GetDlgItem(hwndDlg, nCtlId);
+	COMBOBOXINFO info;
+	info.cbSize = sizeof(COMBOBOXINFO);
+	if (GetComboBoxInfo(hwnd, &info)) {
+		SetWindowSubclass(info.hwndItem, AddBackslashEditProc, 0, 0);
 	}
+}
 
-	Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-	const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
-	iSelStart = SciCall_PositionFromLine(iLine);
+extern BOOL bFindReplaceTransparentMode;
+extern int iFindReplaceOpacityLevel;
+extern BOOL bFindReplaceUseMonospacedFont;
+extern BOOL bFindReplaceFindAllBookmark;
+extern BOOL bLinearRegexSearch;
 
-	const Sci_Position iSelCount = iSelEnd - iSelStart;
-	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1 + 2);
-	char *pszJoin = (char *)NP2HeapAlloc(NP2HeapSize(pszText));
+static void FindReplaceSetFont(HWND hwnd, BOOL monospaced, HFONT *hFontFindReplaceEdit) {
+	HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+	HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
+	HFONT font = NULL;
+	if (monospaced) {
+		font = *hFontFindReplaceEdit;
+		if (font == NULL) {
+			*hFontFindReplaceEdit = font = Style_CreateCodeFont(g_uCurrentDPI);
+		}
+	}
+	if (font == NULL) {
+		// use font from parent window
+		font = GetWindowFont(hwnd);
+	}
+	SetWindowFont(hwndFind, font, TRUE);
+	if (hwndRepl) {
+		SetWindowFont(hwndRepl, font, TRUE);
+	}
+}
 
-	struct Sci_TextRange tr = { { iSelStart, iSelEnd }, pszText };
-	SciCall_GetTextRange(&tr);
+static BOOL CopySelectionAsFindText(HWND hwnd, LPEDITFINDREPLACE lpefr, BOOL bFirstTime) {
+	const Sci_Position cchSelection = SciCall_GetSelTextLength() - 1;
+	char *lpszSelection = NULL;
 
-	char szEOL[] = "\r\n";
-	int cchEOL = 2;
-	const int iEOLMode = SciCall_GetEOLMode();
-	if (iEOLMode == SC_EOL_CR) {
-		cchEOL = 1;
-	} else if (iEOLMode == SC_EOL_LF) {
-		cchEOL = 1;
-		szEOL[0] = '\n';
+	if (cchSelection != 0 && cchSelection <= NP2_FIND_REPLACE_LIMIT) {
+		lpszSelection = (char *)NP2HeapAlloc(cchSelection + 1);
+		SciCall_GetSelText(lpszSelection);
 	}
 
-	Sci_Position cchJoin = 0;
-	BOOL bModified = FALSE;
-	for (Sci_Position i = 0; i < iSelCount; i++) {
-		if (IsEOLChar(pszText[i])) {
-			if (pszText[i] == '\r' && pszText[i + 1] == '\n') {
-				i++;
-			}
-			if (!IsEOLChar(pszText[i + 1]) && pszText[i + 1] != '\0') {
-				pszJoin[cchJoin++] = ' ';
-				bModified = TRUE;
-			} else {
-				while (IsEOLChar(pszText[i + 1])) {
-					i++;
-					bModified = TRUE;
-				}
-				if (pszText[i + 1] != 0) {
-					pszJoin[cchJoin++] = szEOL[0];
-					if (cchEOL > 1) {
-						pszJoin[cchJoin++] = szEOL[1];
-					}
-					if (cchJoin > cchEOL) {
-						pszJoin[cchJoin++] = szEOL[0];
-						if (cchEOL > 1) {
-							pszJoin[cchJoin++] = szEOL[1];
-						}
-					}
-				}
+	// only for manually selected text
+	const BOOL hasFindText = StrNotEmptyA(lpszSelection);
+
+	// First time you bring up find/replace dialog,
+	// copy content from clipboard to find box when nothing is selected in the editor.
+	if (!hasFindText && bFirstTime) {
+		char *pClip = EditGetClipboardText(hwnd);
+		if (pClip != NULL) {
+			const size_t len = strlen(pClip);
+			if (len > 0 && len <= NP2_FIND_REPLACE_LIMIT) {
+				NP2HeapFree(lpszSelection);
+				lpszSelection = (char *)NP2HeapAlloc(len + 2);
+				strcpy(lpszSelection, pClip);
 			}
-		} else {
-			pszJoin[cchJoin++] = pszText[i];
+			LocalFree(pClip);
 		}
 	}
 
-	NP2HeapFree(pszText);
+	if (StrNotEmptyA(lpszSelection)) {
+		const UINT cpEdit = SciCall_GetCodePage();
+		// Check lpszSelection and truncate bad chars
+		//char *lpsz = strpbrk(lpszSelection, "\r\n\t");
+		//if (lpsz) {
+		//	*lpsz = '\0';
+		//}
+
+		char *lpszEscSel = (char *)NP2HeapAlloc((2 * NP2_FIND_REPLACE_LIMIT));
+		lpefr->bTransformBS = AddBackslashA(lpszEscSel, lpszSelection);
 
-	if (bModified) {
-		EditReplaceRange(iSelStart, iSelEnd, cchJoin, pszJoin);
+		SetDlgItemTextA2W(cpEdit, hwnd, IDC_FINDTEXT, lpszEscSel);
+		NP2HeapFree(lpszEscSel);
 	}
 
-	NP2HeapFree(pszJoin);
+	if (lpszSelection != NULL) {
+		NP2HeapFree(lpszSelection);
+	}
+	return hasFindText;
 }
 
 //=============================================================================
 //
-// EditSortLines()
+// EditFindReplaceDlgProc()
 //
-typedef struct SORTLINE {
-	WCHAR *pwszLine;
-	WCHAR *pwszSortEntry;
-} SORTLINE;
+static INT_PTR CALLBACK EditFindReplaceDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
+	static int bSwitchedFindReplace = 0;
+	static int xFindReplaceDlgSave;
+	static int yFindReplaceDlgSave;
+	static EDITFINDREPLACE efrSave;
+	static HFONT hFontFindReplaceEdit;
 
-typedef int (__stdcall *FNSTRCMP)(LPCWSTR, LPCWSTR);
-typedef int (__cdecl *QSortCmp)(const void *, const void *);
+	WCHAR tch[NP2_FIND_REPLACE_LIMIT + 32];
 
-static int __cdecl CmpStd(const void *p1, const void *p2) {
-	const SORTLINE *s1 = (const SORTLINE *)p1;
-	const SORTLINE *s2 = (const SORTLINE *)p2;
-	const int cmp = StrCmpW(s1->pwszSortEntry, s2->pwszSortEntry);
-	return cmp ? cmp : StrCmpW(s1->pwszLine, s2->pwszLine);
-}
+	switch (umsg) {
+	case WM_INITDIALOG: {
+		SetWindowLongPtr(hwnd, DWLP_USER, lParam);
+		ResizeDlg_InitX(hwnd, cxFindReplaceDlg, IDC_RESIZEGRIP2);
 
-static int __cdecl CmpIStd(const void *p1, const void *p2) {
-	const SORTLINE *s1 = (const SORTLINE *)p1;
-	const SORTLINE *s2 = (const SORTLINE *)p2;
-	const int cmp = StrCmpIW(s1->pwszSortEntry, s2->pwszSortEntry);
-	return cmp ? cmp : StrCmpIW(s1->pwszLine, s2->pwszLine);
-}
+		HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+		AddBackslashComboBoxSetup(hwnd, IDC_FINDTEXT);
 
-static int __cdecl CmpStdRev(const void *p1, const void *p2) {
-	return CmpStd(p2, p1);
-}
+		// Load MRUs
+		for (int i = 0; i < MRU_GetCount(mruFind); i++) {
+			MRU_Enum(mruFind, i, tch, COUNTOF(tch));
+			ComboBox_AddString(hwndFind, tch);
+		}
 
-static int __cdecl CmpIStdRev(const void *p1, const void *p2) {
-	return CmpIStd(p2, p1);
-}
+		LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)lParam;
+		// don't copy selection after toggle find & replace on this window.
+		BOOL hasFindText = FALSE;
+		if (bSwitchedFindReplace != 3) {
+			hasFindText = CopySelectionAsFindText(hwnd, lpefr, TRUE);
+		}
+		if (!GetWindowTextLength(hwndFind)) {
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
+		}
 
-static int __cdecl CmpLogical(const void *p1, const void *p2) {
-	const SORTLINE *s1 = (const SORTLINE *)p1;
-	const SORTLINE *s2 = (const SORTLINE *)p2;
-	int cmp = StrCmpLogicalW(s1->pwszSortEntry, s2->pwszSortEntry);
-	if (cmp == 0) {
-		cmp = StrCmpLogicalW(s1->pwszLine, s2->pwszLine);
-	}
-	return cmp ? cmp : CmpStd(p1, p2);
-}
+		ComboBox_LimitText(hwndFind, NP2_FIND_REPLACE_LIMIT);
+		ComboBox_SetExtendedUI(hwndFind, TRUE);
 
-static int __cdecl CmpILogical(const void *p1, const void *p2) {
-	const SORTLINE *s1 = (const SORTLINE *)p1;
-	const SORTLINE *s2 = (const SORTLINE *)p2;
-	int cmp = StrCmpLogicalW(s1->pwszSortEntry, s2->pwszSortEntry);
-	if (cmp == 0) {
-		cmp = StrCmpLogicalW(s1->pwszLine, s2->pwszLine);
-	}
-	return cmp ? cmp : CmpIStd(p1, p2);
-}
+		HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
+		if (hwndRepl) {
+			AddBackslashComboBoxSetup(hwnd, IDC_REPLACETEXT);
+			for (int i = 0; i < MRU_GetCount(mruReplace); i++) {
+				MRU_Enum(mruReplace, i, tch, COUNTOF(tch));
+				ComboBox_AddString(hwndRepl, tch);
+			}
 
-static int __cdecl CmpLogicalRev(const void *p1, const void *p2) {
-	return CmpLogical(p2, p1);
-}
+			ComboBox_LimitText(hwndRepl, NP2_FIND_REPLACE_LIMIT);
+			ComboBox_SetExtendedUI(hwndRepl, TRUE);
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8);
+		}
 
-static int __cdecl CmpILogicalRev(const void *p1, const void *p2) {
-	return CmpILogical(p2, p1);
-}
+		// focus on replace box when selected text is not empty.
+		PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)((hasFindText && hwndRepl)? hwndRepl : hwndFind), 1);
 
-void EditSortLines(int iSortFlags) {
-	Sci_Position iCurPos = SciCall_GetCurrentPos();
-	Sci_Position iAnchorPos = SciCall_GetAnchor();
-	if (iCurPos == iAnchorPos) {
-		return;
-	}
+		if (lpefr->fuFlags & SCFIND_MATCHCASE) {
+			CheckDlgButton(hwnd, IDC_FINDCASE, BST_CHECKED);
+		}
 
-	Sci_Line iRcCurLine = 0;
-	Sci_Line iRcAnchorLine = 0;
-	Sci_Position iRcCurCol = 0;
-	Sci_Position iRcAnchorCol = 0;
+		if (lpefr->fuFlags & SCFIND_WHOLEWORD) {
+			CheckDlgButton(hwnd, IDC_FINDWORD, BST_CHECKED);
+		}
 
-	Sci_Position iSelStart = 0;
-	Sci_Line iLineStart;
-	Sci_Line iLineEnd;
-	Sci_Position iSortColumn;
+		if (lpefr->fuFlags & SCFIND_WORDSTART) {
+			CheckDlgButton(hwnd, IDC_FINDSTART, BST_CHECKED);
+		}
 
-	const BOOL bIsRectangular = SciCall_IsRectangleSelection();
-	if (bIsRectangular) {
-		iRcCurLine = SciCall_LineFromPosition(iCurPos);
-		iRcAnchorLine = SciCall_LineFromPosition(iAnchorPos);
+		if (lpefr->fuFlags & SCFIND_REGEXP) {
+			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_CHECKED);
+		}
 
-		iRcCurCol = SciCall_GetColumn(iCurPos);
-		iRcAnchorCol = SciCall_GetColumn(iAnchorPos);
+		if (lpefr->bTransformBS) {
+			CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_CHECKED);
+		}
 
-		iLineStart = min_pos(iRcCurLine, iRcAnchorLine);
-		iLineEnd = max_pos(iRcCurLine, iRcAnchorLine);
-		iSortColumn = min_pos(iRcCurCol, iRcAnchorCol);
-	} else {
-		iSelStart = SciCall_GetSelectionStart();
-		const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+		if (lpefr->bWildcardSearch) {
+			CheckDlgButton(hwnd, IDC_WILDCARDSEARCH, BST_CHECKED);
+			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
+		}
 
-		const Sci_Line iLine = SciCall_LineFromPosition(iSelStart);
-		iSelStart = SciCall_PositionFromLine(iLine);
+		if (lpefr->bNoFindWrap) {
+			CheckDlgButton(hwnd, IDC_NOWRAP, BST_CHECKED);
+		}
 
-		iLineStart = SciCall_LineFromPosition(iSelStart);
-		iLineEnd = SciCall_LineFromPosition(iSelEnd);
+		if (hwndRepl) {
+			if (bSwitchedFindReplace) {
+				if (lpefr->bFindClose) {
+					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
+				}
+			} else {
+				if (lpefr->bReplaceClose) {
+					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
+				}
+			}
+		} else {
+			if (bSwitchedFindReplace) {
+				if (lpefr->bReplaceClose) {
+					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
+				}
+			} else {
+				if (lpefr->bFindClose) {
+					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
+				}
+			}
+		}
 
-		if (iSelEnd <= SciCall_PositionFromLine(iLineEnd)) {
-			iLineEnd--;
+		if (!bSwitchedFindReplace) {
+			if (xFindReplaceDlg == 0 || yFindReplaceDlg == 0) {
+				CenterDlgInParent(hwnd);
+			} else {
+				SetDlgPos(hwnd, xFindReplaceDlg, yFindReplaceDlg);
+			}
+		} else {
+			SetDlgPos(hwnd, xFindReplaceDlgSave, yFindReplaceDlgSave);
+			bSwitchedFindReplace = 0;
+			CopyMemory(lpefr, &efrSave, sizeof(EDITFINDREPLACE));
 		}
 
-		iSortColumn = SciCall_GetColumn(iCurPos);
+		if (bFindReplaceTransparentMode) {
+			CheckDlgButton(hwnd, IDC_TRANSPARENT, BST_CHECKED);
+		}
+		if (bFindReplaceFindAllBookmark) {
+			CheckDlgButton(hwnd, IDC_FINDALLBOOKMARK, BST_CHECKED);
+		}
+		if (bFindReplaceUseMonospacedFont) {
+			CheckDlgButton(hwnd, IDC_USEMONOSPACEDFONT, BST_CHECKED);
+			FindReplaceSetFont(hwnd, TRUE, &hFontFindReplaceEdit);
+		}
 	}
+	return TRUE;
 
-	const Sci_Line iLineCount = iLineEnd - iLineStart + 1;
-	if (iLineCount < 2) {
-		return;
+	case WM_COPYDATA: {
+		HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+		HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
+		LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
+
+		const BOOL hasFindText = CopySelectionAsFindText(hwnd, lpefr, FALSE);
+		if (!GetWindowTextLength(hwndFind)) {
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
+		}
+		if (lpefr->bTransformBS) {
+			CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_CHECKED);
+		}
+		// focus on replace box when selected text is not empty.
+		PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)((hasFindText && hwndRepl)? hwndRepl : hwndFind), 1);
 	}
+	break;
 
-	char mszEOL[] = "\r\n";
-	const UINT cpEdit = SciCall_GetCodePage();
-	const int iEOLMode = SciCall_GetEOLMode();
-	if (iEOLMode == SC_EOL_CR) {
-		mszEOL[1] = 0;
-	} else if (iEOLMode == SC_EOL_LF) {
-		mszEOL[0] = '\n';
-		mszEOL[1] = 0;
+	case WM_DESTROY:
+		if (hFontFindReplaceEdit) {
+			DeleteObject(hFontFindReplaceEdit);
+			hFontFindReplaceEdit = NULL;
+		}
+		ResizeDlg_Destroy(hwnd, &cxFindReplaceDlg, NULL);
+		return FALSE;
+
+	case WM_SIZE: {
+		int dx;
+
+		const BOOL isReplace = GetDlgItem(hwnd, IDC_REPLACETEXT) != NULL;
+		ResizeDlg_Size(hwnd, lParam, &dx, NULL);
+		HDWP hdwp = BeginDeferWindowPos(isReplace ? 13 : 9);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_RESIZEGRIP2, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDOK, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDTEXT, dx, 0, SWP_NOMOVE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_CLEAR_FIND, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDPREV, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_SAVEPOSITION, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_RESETPOSITION, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDALL, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACEALL, dx, 0, SWP_NOSIZE);
+		if (isReplace) {
+			hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACETEXT, dx, 0, SWP_NOMOVE);
+			hdwp = DeferCtlPos(hdwp, hwnd, IDC_CLEAR_REPLACE, dx, 0, SWP_NOSIZE);
+			hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACE, dx, 0, SWP_NOSIZE);
+			hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACEINSEL, dx, 0, SWP_NOSIZE);
+		}
+		EndDeferWindowPos(hdwp);
 	}
+	return TRUE;
+
+	case WM_GETMINMAXINFO:
+		ResizeDlg_GetMinMaxInfo(hwnd, lParam);
+		return TRUE;
 
-	SciCall_BeginUndoAction();
-	if (bIsRectangular) {
-		EditPadWithSpaces(!(iSortFlags & SORT_SHUFFLE), TRUE);
-	}
+	case WM_COMMAND:
+		switch (LOWORD(wParam)) {
+		case IDC_FINDTEXT:
+		case IDC_REPLACETEXT: {
+			HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+			const BOOL bEnable = ComboBox_HasText(hwndFind);
 
-	SORTLINE *pLines = (SORTLINE *)NP2HeapAlloc(sizeof(SORTLINE) * iLineCount);
-	Sci_Position cchTotal = 0;
-	Sci_Position ichlMax = 3;
-	for (Sci_Line i = 0, iLine = iLineStart; iLine <= iLineEnd; i++, iLine++) {
-		const Sci_Position cchm = SciCall_GetLineLength(iLine);
-		char *pmsz = (char *)NP2HeapAlloc(cchm + 1);
-		SciCall_GetLine(iLine, pmsz);
+			EnableWindow(GetDlgItem(hwnd, IDOK), bEnable);
+			EnableWindow(GetDlgItem(hwnd, IDC_FINDPREV), bEnable);
+			EnableWindow(GetDlgItem(hwnd, IDC_FINDALL), bEnable);
+			EnableWindow(GetDlgItem(hwnd, IDC_REPLACE), bEnable);
+			EnableWindow(GetDlgItem(hwnd, IDC_REPLACEALL), bEnable);
+			EnableWindow(GetDlgItem(hwnd, IDC_REPLACEINSEL), bEnable);
 
-		// remove EOL
-		char *p = pmsz + cchm - 1;
-		if (*p == '\n' || *p == '\r') {
-			*p-- = '\0';
-		}
-		if (*p == '\r') {
-			*p-- = '\0';
-		}
-
-		cchTotal += cchm;
-		ichlMax = max_pos(ichlMax, cchm);
-
-		const int cchw = MultiByteToWideChar(cpEdit, 0, pmsz, -1, NULL, 0) - 1;
-		if (cchw > 0) {
-			LPWSTR pwszLine = (LPWSTR)LocalAlloc(LPTR, sizeof(WCHAR) * (cchw + 1));
-			MultiByteToWideChar(cpEdit, 0, pmsz, -1, pwszLine, (int)(LocalSize(pwszLine) / sizeof(WCHAR)));
-			pLines[i].pwszLine = pwszLine;
-
-			if (iSortFlags & SORT_COLUMN) {
-				const int tabWidth = fvCurFile.iTabWidth;
-				Sci_Position col = 0;
-				Sci_Position tabs = tabWidth;
-				while (*pwszLine) {
-					if (*pwszLine == L'\t') {
-						if (col + tabs <= iSortColumn) {
-							col += tabs;
-							tabs = tabWidth;
-							pwszLine = CharNext(pwszLine);
-						} else {
-							break;
-						}
-					} else if (col < iSortColumn) {
-						col++;
-						if (--tabs == 0) {
-							tabs = tabWidth;
-						}
-						pwszLine = CharNext(pwszLine);
-					} else {
-						break;
-					}
-				}
+			if (HIWORD(wParam) == CBN_CLOSEUP) {
+				HWND hwndCtl = GetDlgItem(hwnd, LOWORD(wParam));
+				const DWORD lSelEnd = ComboBox_GetEditSelEnd(hwndCtl);
+				ComboBox_SetEditSel(hwndCtl, lSelEnd, lSelEnd);
 			}
-			pLines[i].pwszSortEntry = pwszLine;
-		} else {
-			pLines[i].pwszLine = StrDup(L"");
-			pLines[i].pwszSortEntry = pLines[i].pwszLine;
 		}
-		NP2HeapFree(pmsz);
-	}
-
-	if (iSortFlags & SORT_DESCENDING) {
-		QSortCmp cmpFunc = (iSortFlags & SORT_LOGICAL)
-			? ((iSortFlags & SORT_NOCASE) ? CmpILogicalRev : CmpLogicalRev)
-			: ((iSortFlags & SORT_NOCASE) ? CmpIStdRev : CmpStdRev);
-		qsort(pLines, iLineCount, sizeof(SORTLINE), cmpFunc);
-	} else if (iSortFlags & SORT_SHUFFLE) {
-		srand(GetTickCount());
-		for (Sci_Line i = iLineCount - 1; i > 0; i--) {
-			const Sci_Line j = rand() % i;
-			const SORTLINE sLine = pLines[i];
-			pLines[i] = pLines[j];
-			pLines[j] = sLine;
-		}
-	} else {
-		QSortCmp cmpFunc = (iSortFlags & SORT_LOGICAL)
-			? ((iSortFlags & SORT_NOCASE) ? CmpILogical : CmpLogical)
-			: ((iSortFlags & SORT_NOCASE) ? CmpIStd : CmpStd);
-		qsort(pLines, iLineCount, sizeof(SORTLINE), cmpFunc);
-	}
-
-	char *pmszResult = (char *)NP2HeapAlloc(cchTotal + 2 * iLineCount + 1);
-	char *pmszBuf = (char *)NP2HeapAlloc(ichlMax + 1);
-	const int cbPmszBuf = (int)NP2HeapSize(pmszBuf);
-	const int cbPmszResult = (int)NP2HeapSize(pmszResult);
-	FNSTRCMP pfnStrCmp = (iSortFlags & SORT_NOCASE) ? StrCmpIW : StrCmpW;
+		break;
 
-	BOOL bLastDup = FALSE;
-	for (Sci_Line i = 0; i < iLineCount; i++) {
-		if (pLines[i].pwszLine && ((iSortFlags & SORT_SHUFFLE) || StrNotEmpty(pLines[i].pwszLine))) {
-			BOOL bDropLine = FALSE;
-			if (!(iSortFlags & SORT_SHUFFLE)) {
-				if (iSortFlags & (SORT_MERGEDUP | SORT_UNIQDUP | SORT_UNIQUNIQ)) {
-					if (i < iLineCount - 1) {
-						if (pfnStrCmp(pLines[i].pwszLine, pLines[i + 1].pwszLine) == 0) {
-							bLastDup = TRUE;
-							bDropLine = iSortFlags & (SORT_MERGEDUP | SORT_UNIQDUP);
-						} else {
-							bDropLine = (!bLastDup && (iSortFlags & SORT_UNIQUNIQ)) || (bLastDup && (iSortFlags & SORT_UNIQDUP));
-							bLastDup = FALSE;
-						}
-					} else {
-						bDropLine = (!bLastDup && (iSortFlags & SORT_UNIQUNIQ)) || (bLastDup && (iSortFlags & SORT_UNIQDUP));
-						bLastDup = FALSE;
-					}
-				}
+		case IDC_FINDREGEXP:
+			if (IsButtonChecked(hwnd, IDC_FINDREGEXP)) {
+				CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_UNCHECKED);
+				// Can not use wildcard search together with regexp
+				CheckDlgButton(hwnd, IDC_WILDCARDSEARCH, BST_UNCHECKED);
 			}
+			break;
 
-			if (!bDropLine) {
-				WideCharToMultiByte(cpEdit, 0, pLines[i].pwszLine, -1, pmszBuf, cbPmszBuf, NULL, NULL);
-				strncat(pmszResult, pmszBuf, cbPmszResult);
-				strncat(pmszResult, mszEOL, cbPmszResult);
+		case IDC_FINDTRANSFORMBS:
+			if (IsButtonChecked(hwnd, IDC_FINDTRANSFORMBS)) {
+				CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
 			}
-		}
-	}
+			break;
 
-	NP2HeapFree(pmszBuf);
-	for (Sci_Line i = 0; i < iLineCount; i++) {
-		if (pLines[i].pwszLine) {
-			LocalFree(pLines[i].pwszLine);
-		}
-	}
-	NP2HeapFree(pLines);
+		case IDC_WILDCARDSEARCH:
+			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
+			//if (IsButtonChecked(hwnd, IDC_FINDWILDCARDS))
+			//	CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
+			break;
 
-	const Sci_Position length = strlen(pmszResult);
-	if (!bIsRectangular) {
-		if (iAnchorPos > iCurPos) {
-			iCurPos = iSelStart;
-			iAnchorPos = iSelStart + length;
-		} else {
-			iAnchorPos = iSelStart;
-			iCurPos = iSelStart + length;
-		}
-	}
+		case IDC_TRANSPARENT:
+			bFindReplaceTransparentMode = IsButtonChecked(hwnd, IDC_TRANSPARENT);
+			break;
 
-	SciCall_SetTargetRange(SciCall_PositionFromLine(iLineStart), SciCall_PositionFromLine(iLineEnd + 1));
-	SciCall_ReplaceTarget(length, pmszResult);
-	SciCall_EndUndoAction();
+		case IDC_FINDALLBOOKMARK:
+			bFindReplaceFindAllBookmark = IsButtonChecked(hwnd, IDC_FINDALLBOOKMARK);
+			break;
 
-	NP2HeapFree(pmszResult);
+		case IDOK:
+		case IDC_FINDPREV:
+		case IDC_FINDALL:
+		case IDC_REPLACE:
+		case IDC_REPLACEALL:
+		case IDC_REPLACEINSEL:
+		case IDACC_SELTONEXT:
+		case IDACC_SELTOPREV: {
+			LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
+			HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+			HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
+			const BOOL bIsFindDlg = (hwndRepl == NULL);
+			// Get current code page for Unicode conversion
+			const UINT cpEdit = SciCall_GetCodePage();
+			cpLastFind = cpEdit;
 
-	if (!bIsRectangular) {
-		SciCall_SetSel(iAnchorPos, iCurPos);
-	} else {
-		const Sci_Position iTargetStart = SciCall_GetTargetStart();
-		Sci_Position iTargetEnd = SciCall_GetTargetEnd();
-		SciCall_ClearSelections();
-		if (iTargetStart != iTargetEnd) {
-			iTargetEnd -= strlen(mszEOL);
-			if (iRcAnchorLine > iRcCurLine) {
-				iCurPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetStart), iRcCurCol);
-				iAnchorPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetEnd), iRcAnchorCol);
-			} else {
-				iCurPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetEnd), iRcCurCol);
-				iAnchorPos = SciCall_FindColumn(SciCall_LineFromPosition(iTargetStart), iRcAnchorCol);
-			}
-			if (iCurPos != iAnchorPos) {
-				SciCall_SetRectangularSelectionCaret(iCurPos);
-				SciCall_SetRectangularSelectionAnchor(iAnchorPos);
-			} else {
-				SciCall_SetSel(iTargetStart, iTargetStart);
+			if (!GetDlgItemTextA2W(cpEdit, hwnd, IDC_FINDTEXT, lpefr->szFind, COUNTOF(lpefr->szFind))) {
+				EnableWindow(GetDlgItem(hwnd, IDOK), FALSE);
+				EnableWindow(GetDlgItem(hwnd, IDC_FINDPREV), FALSE);
+				EnableWindow(GetDlgItem(hwnd, IDC_FINDALL), FALSE);
+				EnableWindow(GetDlgItem(hwnd, IDC_REPLACE), FALSE);
+				EnableWindow(GetDlgItem(hwnd, IDC_REPLACEALL), FALSE);
+				EnableWindow(GetDlgItem(hwnd, IDC_REPLACEINSEL), FALSE);
+				return TRUE;
 			}
-		} else {
-			SciCall_SetSel(iTargetStart, iTargetStart);
-		}
-	}
-}
-
-//=============================================================================
-//
-// EditJumpTo()
-//
-void EditJumpTo(Sci_Line iNewLine, Sci_Position iNewCol) {
-	const Sci_Line iMaxLine = SciCall_GetLineCount();
 
-	// Jumpt to end with line set to -1
-	if (iNewLine < 0 || iNewLine >= iMaxLine) {
-		SciCall_DocumentEnd();
-		return;
-	}
+			if (!bIsFindDlg) {
+				GetDlgItemTextA2W(cpEdit, hwnd, IDC_REPLACETEXT, lpefr->szReplace, COUNTOF(lpefr->szReplace));
+			}
 
-	const Sci_Position iLineEndPos = SciCall_GetLineEndPosition(iNewLine - 1);
-	iNewCol = min_pos(iNewCol, iLineEndPos);
-	const Sci_Position iNewPos = SciCall_FindColumn(iNewLine - 1, iNewCol - 1);
-	// SciCall_GotoPos(pos) is equivalent to SciCall_SetSel(-1, pos)
-	EditSelectEx(INVALID_POSITION, iNewPos);
-	SciCall_ChooseCaretX();
-}
+			lpefr->bWildcardSearch = IsButtonChecked(hwnd, IDC_WILDCARDSEARCH);
+			lpefr->fuFlags = 0;
 
-//=============================================================================
-//
-// EditSelectEx()
-//
-void EditSelectEx(Sci_Position iAnchorPos, Sci_Position iCurrentPos) {
-	const Sci_Line iNewLine = SciCall_LineFromPosition(iCurrentPos);
-	const Sci_Line iAnchorLine = SciCall_LineFromPosition(iAnchorPos);
+			if (IsButtonChecked(hwnd, IDC_FINDCASE)) {
+				lpefr->fuFlags |= SCFIND_MATCHCASE;
+			}
 
-	if (iAnchorLine == iNewLine) {
-		// TODO: center current line on screen when it's not visible
-		SciCall_EnsureVisible(iAnchorLine);
-	} else {
-		// Ensure that the first and last lines of a selection are always unfolded
-		// This needs to be done *before* the SciCall_SetSel() message
-		SciCall_EnsureVisible(iAnchorLine);
-		SciCall_EnsureVisible(iNewLine);
-	}
+			if (IsButtonChecked(hwnd, IDC_FINDWORD)) {
+				lpefr->fuFlags |= SCFIND_WHOLEWORD;
+			}
 
-	SciCall_SetXCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 50);
-	SciCall_SetYCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 5);
-	SciCall_SetSel(iAnchorPos, iCurrentPos);
-	SciCall_SetXCaretPolicy(CARET_SLOP | CARET_EVEN, 50);
-	SciCall_SetYCaretPolicy(CARET_EVEN, 0);
-}
+			if (IsButtonChecked(hwnd, IDC_FINDSTART)) {
+				lpefr->fuFlags |= SCFIND_WORDSTART;
+			}
 
-//=============================================================================
-//
-// EditFixPositions()
-//
-void EditFixPositions(void) {
-	const Sci_Position iMaxPos = SciCall_GetLength();
-	Sci_Position iCurrentPos = SciCall_GetCurrentPos();
-	const Sci_Position iAnchorPos = SciCall_GetAnchor();
+			if (IsButtonChecked(hwnd, IDC_FINDREGEXP)) {
+				lpefr->fuFlags |= SCFIND_REGEXP | SCFIND_POSIX;
+			}
 
-	if (iCurrentPos > 0 && iCurrentPos < iMaxPos) {
-		const Sci_Position iNewPos = SciCall_PositionAfter(SciCall_PositionBefore(iCurrentPos));
-		if (iNewPos != iCurrentPos) {
-			SciCall_SetCurrentPos(iNewPos);
-			iCurrentPos = iNewPos;
-		}
-	}
+			lpefr->bTransformBS = IsButtonChecked(hwnd, IDC_FINDTRANSFORMBS);
+			lpefr->bNoFindWrap = IsButtonChecked(hwnd, IDC_NOWRAP);
 
-	if (iAnchorPos != iCurrentPos && iAnchorPos > 0 && iAnchorPos < iMaxPos) {
-		const Sci_Position iNewPos = SciCall_PositionAfter(SciCall_PositionBefore(iAnchorPos));
-		if (iNewPos != iAnchorPos) {
-			SciCall_SetAnchor(iNewPos);
-		}
-	}
-}
+			if (bIsFindDlg) {
+				lpefr->bFindClose = IsButtonChecked(hwnd, IDC_FINDCLOSE);
+			} else {
+				lpefr->bReplaceClose = IsButtonChecked(hwnd, IDC_FINDCLOSE);
+			}
 
-//=============================================================================
-//
-// EditEnsureSelectionVisible()
-//
-void EditEnsureSelectionVisible(void) {
-	const Sci_Position iAnchorPos = SciCall_GetAnchor();
-	const Sci_Position iCurrentPos = SciCall_GetCurrentPos();
-	EditSelectEx(iAnchorPos, iCurrentPos);
-}
+			// Save MRUs
+			if (StrNotEmptyA(lpefr->szFind)) {
+				if (GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8, COUNTOF(lpefr->szFindUTF8))) {
+					ComboBox_GetText(hwndFind, tch, COUNTOF(tch));
+					MRU_AddMultiline(mruFind, tch);
+				}
+			}
+			if (StrNotEmptyA(lpefr->szReplace)) {
+				if (GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8, COUNTOF(lpefr->szReplaceUTF8))) {
+					ComboBox_GetText(hwndRepl, tch, COUNTOF(tch));
+					MRU_AddMultiline(mruReplace, tch);
+				}
+			} else {
+				strcpy(lpefr->szReplaceUTF8, "");
+			}
 
-void EditEnsureConsistentLineEndings(void) {
-	const int iEOLMode = SciCall_GetEOLMode();
-	if (iEOLMode == SC_EOL_CRLF) {
-#if defined(_WIN64)
-		const int options = SciCall_GetDocumentOptions();
-		if (!(options & SC_DOCUMENTOPTION_TEXT_LARGE)) {
-			const Sci_Position dwLength = SciCall_GetLength() + SciCall_GetLineCount();
-			if (dwLength >= INT_MAX) {
-				return;
+			BOOL bCloseDlg;
+			if (bIsFindDlg) {
+				bCloseDlg = lpefr->bFindClose;
+			} else {
+				if (LOWORD(wParam) == IDOK) {
+					bCloseDlg = FALSE;
+				} else {
+					bCloseDlg = lpefr->bReplaceClose;
+				}
 			}
-		}
-#else
-		const DWORD dwLength = (DWORD)SciCall_GetLength() + (DWORD)SciCall_GetLineCount();
-		if (dwLength >= INT_MAX) {
-			return;
-		}
-#endif
-	}
 
-	SciCall_ConvertEOLs(iEOLMode);
-	EditFixPositions();
-}
+			// Reload MRUs
+			ComboBox_ResetContent(hwndFind);
+			ComboBox_ResetContent(hwndRepl);
 
-//=============================================================================
-//
-// EditGetExcerpt()
-//
-void EditGetExcerpt(LPWSTR lpszExcerpt, DWORD cchExcerpt) {
-	if (SciCall_IsSelectionEmpty() || SciCall_IsRectangleSelection()) {
-		lstrcpy(lpszExcerpt, L"");
-		return;
-	}
+			for (int i = 0; i < MRU_GetCount(mruFind); i++) {
+				MRU_Enum(mruFind, i, tch, COUNTOF(tch));
+				ComboBox_AddString(hwndFind, tch);
+			}
 
-	WCHAR tch[256] = L"";
-	DWORD cch = 0;
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = min_pos(min_pos(SciCall_GetSelectionEnd(), iSelStart + COUNTOF(tch)), SciCall_GetLength());
-	const Sci_Position iSelCount = iSelEnd - iSelStart;
+			for (int i = 0; i < MRU_GetCount(mruReplace); i++) {
+				MRU_Enum(mruReplace, i, tch, COUNTOF(tch));
+				ComboBox_AddString(hwndRepl, tch);
+			}
 
-	char *pszText = (char *)NP2HeapAlloc(iSelCount + 2);
-	LPWSTR pszTextW = (LPWSTR)NP2HeapAlloc((iSelCount + 1) * sizeof(WCHAR));
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8);
 
-	struct Sci_TextRange tr = { { iSelStart, iSelEnd }, pszText };
-	SciCall_GetTextRange(&tr);
-	const UINT cpEdit = SciCall_GetCodePage();
-	MultiByteToWideChar(cpEdit, 0, pszText, (int)iSelCount, pszTextW, (int)(NP2HeapSize(pszTextW) / sizeof(WCHAR)));
+			SendMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetFocus()), 1);
 
-	for (WCHAR *p = pszTextW; *p && cch < COUNTOF(tch) - 1; p++) {
-		if (*p == L'\r' || *p == L'\n' || *p == L'\t' || *p == L' ') {
-			tch[cch++] = L' ';
-			while (*(p + 1) == L'\r' || *(p + 1) == L'\n' || *(p + 1) == L'\t' || *(p + 1) == L' ') {
-				p++;
+			if (bCloseDlg) {
+				DestroyWindow(hwnd);
+				hDlgFindReplace = NULL;
 			}
-		} else {
-			tch[cch++] = *p;
-		}
-	}
-	tch[cch++] = L'\0';
-	StrTrim(tch, L" ");
 
-	if (cch == 1) {
-		lstrcpy(tch, L" ... ");
-	}
+			switch (LOWORD(wParam)) {
+			case IDOK: // find next
+			case IDACC_SELTONEXT:
+				if (!bIsFindDlg) {
+					bReplaceInitialized = TRUE;
+				}
+				EditFindNext(lpefr, LOWORD(wParam) == IDACC_SELTONEXT || KeyboardIsKeyDown(VK_SHIFT));
+				break;
 
-	if (cch > cchExcerpt) {
-		tch[cchExcerpt - 2] = L'.';
-		tch[cchExcerpt - 3] = L'.';
-		tch[cchExcerpt - 4] = L'.';
-	}
-	lstrcpyn(lpszExcerpt, tch, cchExcerpt);
+			case IDC_FINDPREV: // find previous
+			case IDACC_SELTOPREV:
+				if (!bIsFindDlg) {
+					bReplaceInitialized = TRUE;
+				}
+				EditFindPrev(lpefr, LOWORD(wParam) == IDACC_SELTOPREV || KeyboardIsKeyDown(VK_SHIFT));
+				break;
 
-	NP2HeapFree(pszText);
-	NP2HeapFree(pszTextW);
-}
+			case IDC_REPLACE:
+				bReplaceInitialized = TRUE;
+				EditReplace(lpefr->hwnd, lpefr);
+				break;
 
-void EditSelectWord(void) {
-	const Sci_Position iPos = SciCall_GetCurrentPos();
+			case IDC_FINDALL:
+				EditFindAll(lpefr, FALSE);
+				break;
 
-	if (SciCall_IsSelectionEmpty()) {
-		Sci_Position iWordStart = SciCall_WordStartPosition(iPos, TRUE);
-		Sci_Position iWordEnd = SciCall_WordEndPosition(iPos, TRUE);
+			case IDC_REPLACEALL:
+				if (bIsFindDlg) {
+					EditFindAll(lpefr, TRUE);
+				} else {
+					bReplaceInitialized = TRUE;
+					EditReplaceAll(lpefr->hwnd, lpefr, TRUE);
+				}
+				break;
 
-		if (iWordStart == iWordEnd) {// we are in whitespace salad...
-			iWordStart = SciCall_WordEndPosition(iPos, FALSE);
-			iWordEnd = SciCall_WordEndPosition(iWordStart, TRUE);
-			if (iWordStart != iWordEnd) {
-				//if (IsDocWordChar(SciCall_GetCharAt(iWordStart - 1))) {
-				//	--iWordStart;
-				//}
-				SciCall_SetSel(iWordStart, iWordEnd);
+			case IDC_REPLACEINSEL:
+				bReplaceInitialized = TRUE;
+				EditReplaceAllInSelection(lpefr->hwnd, lpefr, TRUE);
+				break;
 			}
-		} else {
-			//if (IsDocWordChar(SciCall_GetCharAt(iWordStart - 1))) {
-			//	--iWordStart;
-			//}
-			SciCall_SetSel(iWordStart, iWordEnd);
 		}
+		break;
 
-		if (!SciCall_IsSelectionEmpty()) {
-			return;
-		}
-	}
+		case IDCANCEL:
+			DestroyWindow(hwnd);
+			break;
 
-	const Sci_Line iLine = SciCall_LineFromPosition(iPos);
-	const Sci_Position iLineStart = SciCall_GetLineIndentPosition(iLine);
-	const Sci_Position iLineEnd = SciCall_GetLineEndPosition(iLine);
-	SciCall_SetSel(iLineStart, iLineEnd);
-}
+		case IDACC_FIND:
+			PostWMCommand(hwndMain, IDM_EDIT_FIND);
+			break;
 
-void EditSelectLines(BOOL currentBlock, BOOL lineSelection) {
-	if (lineSelection && !currentBlock) {
-		SciCall_SetSelectionMode(SC_SEL_LINES);
-		return;
-	}
+		case IDACC_REPLACE:
+			PostWMCommand(hwndMain, IDM_EDIT_REPLACE);
+			break;
 
-	// see Editor::LineSelectionRange()
-	Sci_Position iCurrentPos = SciCall_GetCurrentPos();
-	Sci_Position iAnchorPos = SciCall_GetAnchor();
-	BOOL backward = (iCurrentPos < iAnchorPos);
+		case IDACC_FINDNEXT:
+			PostWMCommand(hwnd, IDOK);
+			break;
 
-	Sci_Line iLineAnchorPos = SciCall_LineFromPosition(iAnchorPos);
-	Sci_Line iLineCurPos = SciCall_LineFromPosition(iCurrentPos);
+		case IDACC_FINDPREV:
+			PostWMCommand(hwnd, IDC_FINDPREV);
+			break;
 
-	if (currentBlock) {
-		Sci_Line iLineStart = iLineCurPos;
-		const int level = SciCall_GetFoldLevel(iLineStart);
-		if (!(level & SC_FOLDLEVELHEADERFLAG)) {
-			iLineStart = SciCall_GetFoldParent(iLineStart);
-			if (iLineStart < 0) {
-				SciCall_SelectAll();
-				return;
+		case IDACC_REPLACENEXT:
+			if (GetDlgItem(hwnd, IDC_REPLACETEXT) != NULL) {
+				PostWMCommand(hwnd, IDC_REPLACE);
 			}
+			break;
+
+		case IDACC_SAVEFIND: {
+			SendWMCommand(hwndMain, IDM_EDIT_SAVEFIND);
+			LPCEDITFINDREPLACE lpefr = (LPCEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
+			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
+			CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_UNCHECKED);
+			PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetDlgItem(hwnd, IDC_FINDTEXT)), 1);
 		}
+		break;
 
-		const Sci_Line iLineEnd = SciCall_GetLastChild(iLineStart);
-		backward = backward || (iCurrentPos == iAnchorPos && iLineEnd - iLineCurPos > iLineCurPos - iLineStart);
-		if (backward) {
-			iLineCurPos = iLineStart;
-			iLineAnchorPos = iLineEnd;
-		} else {
-			iLineCurPos = iLineEnd;
-			iLineAnchorPos = iLineStart;
+		case IDC_TOGGLEFINDREPLACE: {
+			bSwitchedFindReplace |= 2;
+			LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
+			GetDlgPos(hwnd, &xFindReplaceDlgSave, &yFindReplaceDlgSave);
+			CopyMemory(&efrSave, lpefr, sizeof(EDITFINDREPLACE));
+			GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8, COUNTOF(lpefr->szFindUTF8));
+			if (!GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8, COUNTOF(lpefr->szReplaceUTF8))) {
+				strcpy(lpefr->szReplaceUTF8, "");
+			}
 		}
-	}
+		break;
+
+		case IDC_USEMONOSPACEDFONT:
+			bFindReplaceUseMonospacedFont = IsButtonChecked(hwnd, IDC_USEMONOSPACEDFONT);
+			FindReplaceSetFont(hwnd, bFindReplaceUseMonospacedFont, &hFontFindReplaceEdit);
+			break;
+		}
+		return TRUE;
+
+	case WM_NOTIFY: {
+		LPNMHDR pnmhdr = (LPNMHDR)lParam;
+		switch (pnmhdr->code) {
+		case NM_CLICK:
+		case NM_RETURN:
+			switch (pnmhdr->idFrom) {
+			case IDC_TOGGLEFINDREPLACE:
+				bSwitchedFindReplace = 1;
+				if (GetDlgItem(hwnd, IDC_REPLACETEXT)) {
+					PostWMCommand(hwndMain, IDM_EDIT_FIND);
+				} else {
+					PostWMCommand(hwndMain, IDM_EDIT_REPLACE);
+				}
+				break;
+
+			// Display help messages in the find/replace windows
+			case IDC_BACKSLASHHELP:
+				MsgBoxInfo(MB_OK, IDS_BACKSLASHHELP);
+				//ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_BACKSLASHHELP);
+				break;
+
+			case IDC_REGEXPHELP:
+				MsgBoxInfo(MB_OK, IDS_REGEXPHELP);
+				//ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_REGEXPHELP);
+				break;
 
-	const Sci_Line offset = lineSelection ? 0 : 1;
-	if (backward) {
-		iCurrentPos = SciCall_PositionFromLine(iLineCurPos);
-		iAnchorPos = SciCall_PositionFromLine(iLineAnchorPos + offset);
-	} else {
-		iAnchorPos = SciCall_PositionFromLine(iLineAnchorPos);
-		iCurrentPos = SciCall_PositionFromLine(iLineCurPos + offset);
-	}
+			case IDC_WILDCARDHELP:
+				MsgBoxInfo(MB_OK, IDS_WILDCARDHELP);
+				//ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_WILDCARDHELP);
+				break;
 
-	SciCall_SetSel(iAnchorPos, iCurrentPos);
-	if (lineSelection) {
-		SciCall_SetSelectionMode(SC_SEL_LINES);
-	}
-	SciCall_ChooseCaretX();
-}
+			case IDC_CLEAR_FIND: {
+				HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+				ComboBox_GetText(hwndFind, tch, COUNTOF(tch));
+				ComboBox_ResetContent(hwndFind);
+				MRU_Empty(mruFind);
+				MRU_Save(mruFind);
+				ComboBox_SetText(hwndFind, tch);
+			}
+			break;
 
-static LRESULT CALLBACK AddBackslashEditProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData) {
-	UNREFERENCED_PARAMETER(dwRefData);
+			case IDC_CLEAR_REPLACE: {
+				HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
+				ComboBox_GetText(hwndRepl, tch, COUNTOF(tch));
+				ComboBox_ResetContent(hwndRepl);
+				MRU_Empty(mruReplace);
+				MRU_Save(mruReplace);
+				ComboBox_SetText(hwndRepl, tch);
+			}
+			break;
 
-	switch (umsg) {
-	case WM_PASTE: {
-		BOOL done = FALSE;
-		LPWSTR lpsz = EditGetClipboardTextW();
-		if (StrNotEmpty(lpsz)) {
-			const int len = lstrlen(lpsz);
-			LPWSTR lpszEsc = (LPWSTR)NP2HeapAlloc((2*len + 1)*sizeof(WCHAR));
-			if (lpszEsc != NULL) {
-				AddBackslashW(lpszEsc, lpsz);
-				SendMessage(hwnd, EM_REPLACESEL, TRUE, (LPARAM)(lpszEsc));
-				NP2HeapFree(lpszEsc);
-				done = TRUE;
+			case IDC_SAVEPOSITION:
+				GetDlgPos(hwnd, &xFindReplaceDlg, &yFindReplaceDlg);
+				break;
+
+			case IDC_RESETPOSITION:
+				CenterDlgInParent(hwnd);
+				xFindReplaceDlg = yFindReplaceDlg = 0;
+				break;
 			}
-		}
-		if (lpsz != NULL) {
-			NP2HeapFree(lpsz);
-		}
-		if (done) {
-			return TRUE;
+			break;
 		}
 	}
 	break;
 
-	case WM_NCDESTROY:
-		RemoveWindowSubclass(hwnd, AddBackslashEditProc, uIdSubclass);
+	case WM_ACTIVATE :
+		SetWindowTransparentMode(hwnd, (LOWORD(wParam) == WA_INACTIVE && bFindReplaceTransparentMode), iFindReplaceOpacityLevel);
 		break;
 	}
 
-	return DefSubclassProc(hwnd, umsg, wParam, lParam);
+	return FALSE;
 }
 
-void AddBackslashComboBoxSetup(HWND hwndDlg, int nCtlId) {
-	HWND hwnd = GetDlgItem(hwndDlg, nCtlId);
-	COMBOBOXINFO info;
-	info.cbSize = sizeof(COMBOBOXINFO);
-	if (GetComboBoxInfo(hwnd, &info)) {
-		SetWindowSubclass(info.hwndItem, AddBackslashEditProc, 0, 0);
-	}
+//=============================================================================
+//
+// EditFindReplaceDlg()
+//
+HWND EditFindReplaceDlg(HWND hwnd, LPEDITFINDREPLACE lpefr, BOOL bReplace) {
+	lpefr->hwnd = hwnd;
+	HWND hDlg = CreateThemedDialogParam(g_hInstance,
+								   (bReplace) ? MAKEINTRESOURCE(IDD_REPLACE) : MAKEINTRESOURCE(IDD_FIND),
+								   GetParent(hwnd),
+								   EditFindReplaceDlgProc,
+								   (LPARAM)lpefr);
+
+	ShowWindow(hDlg, SW_SHOW);
+	return hDlg;
 }
 
-extern BOOL bFindReplaceTransparentMode;
-extern int iFindReplaceOpacityLevel;
-extern BOOL bFindReplaceUseMonospacedFont;
-extern BOOL bFindReplaceFindAllBookmark;
+// Wildcard search uses the regexp engine to perform a simple search with * ?
+// as wildcards instead of more advanced and user-unfriendly regexp syntax.
+static void EscapeWildcards(char *szFind2) {
+	char szWildcardEscaped[NP2_FIND_REPLACE_LIMIT];
+	int iSource = 0;
+	int iDest = 0;
 
-static void FindReplaceSetFont(HWND hwnd, BOOL monospaced, HFONT *hFontFindReplaceEdit) {
-	HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
-	HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
-	HFONT font = NULL;
-	if (monospaced) {
-		font = *hFontFindReplaceEdit;
-		if (font == NULL) {
-			*hFontFindReplaceEdit = font = Style_CreateCodeFont(g_uCurrentDPI);
+	while (szFind2[iSource]) {
+		const char c = szFind2[iSource];
+		if (c == '*') {
+			szWildcardEscaped[iDest++] = '.';
+			szWildcardEscaped[iDest] = '*';
+		} else if (c == '?') {
+			szWildcardEscaped[iDest] = '.';
+		} else {
+			if (c == '.' || c == '^' || c == '$' || c == '\\' || c == '[' || c == ']' || c == '+') {
+				szWildcardEscaped[iDest++] = '\\';
+			}
+			szWildcardEscaped[iDest] = c;
 		}
+		iSource++;
+		iDest++;
 	}
-	if (font == NULL) {
-		// use font from parent window
-		font = GetWindowFont(hwnd);
-	}
-	SetWindowFont(hwndFind, font, TRUE);
-	if (hwndRepl) {
-		SetWindowFont(hwndRepl, font, TRUE);
-	}
+	szWildcardEscaped[iDest] = 0;
+	strncpy(szFind2, szWildcardEscaped, COUNTOF(szWildcardEscaped));
 }
 
-static BOOL CopySelectionAsFindText(HWND hwnd, LPEDITFINDREPLACE lpefr, BOOL bFirstTime) {
-	const Sci_Position cchSelection = SciCall_GetSelTextLength() - 1;
-	char *lpszSelection = NULL;
-
-	if (cchSelection != 0 && cchSelection <= NP2_FIND_REPLACE_LIMIT) {
-		lpszSelection = (char *)NP2HeapAlloc(cchSelection + 1);
-		SciCall_GetSelText(lpszSelection);
+// pszFind is encoded in cpEdit, i.e. szFind for current document or szFindUTF8 for UTF-8 document.
+static int EditPrepareFindEx(char *szFind2, LPCSTR pszFind, UINT cpEdit, LPCEDITFINDREPLACE lpefr) {
+	if (StrIsEmptyA(pszFind)) {
+		return NP2_InvalidSearchFlags;
 	}
 
-	// only for manually selected text
-	const BOOL hasFindText = StrNotEmptyA(lpszSelection);
-
-	// First time you bring up find/replace dialog,
-	// copy content from clipboard to find box when nothing is selected in the editor.
-	if (!hasFindText && bFirstTime) {
-		char *pClip = EditGetClipboardText(hwnd);
-		if (pClip != NULL) {
-			const size_t len = strlen(pClip);
-			if (len > 0 && len <= NP2_FIND_REPLACE_LIMIT) {
-				NP2HeapFree(lpszSelection);
-				lpszSelection = (char *)NP2HeapAlloc(len + 2);
-				strcpy(lpszSelection, pClip);
-			}
-			LocalFree(pClip);
-		}
+	int searchFlags = lpefr->fuFlags;
+	strncpy(szFind2, pszFind, NP2_FIND_REPLACE_LIMIT);
+	if (lpefr->bTransformBS) {
+		TransformBackslashes(szFind2, (searchFlags & SCFIND_REGEXP), cpEdit);
+	}
+	if (StrIsEmptyA(szFind2)) {
+		InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
+		return NP2_InvalidSearchFlags;
+	}
+	if (lpefr->bWildcardSearch) {
+		EscapeWildcards(szFind2);
+		searchFlags |= SCFIND_REGEXP;
+	} else if (!(searchFlags & (SCFIND_REGEXP | SCFIND_MATCHCASE))) {
+		const BOOL sensitive = IsStringCaseSensitiveA(szFind2);
+		//printf("%s sensitive=%d\n", __func__, sensitive);
+		searchFlags |= ((sensitive - 1) & SCFIND_MATCHCASE);
+	}
+	// wildcard search is escaped for the built-in syntax without POSIX groups.
+	if (bLinearRegexSearch && (searchFlags & (SCFIND_REGEXP | SCFIND_POSIX)) == (SCFIND_REGEXP | SCFIND_POSIX)) {
+		searchFlags |= SCFIND_LINEARREGEX;
 	}
+	return searchFlags;
+}
 
-	if (StrNotEmptyA(lpszSelection)) {
-		const UINT cpEdit = SciCall_GetCodePage();
-		// Check lpszSelection and truncate bad chars
-		//char *lpsz = strpbrk(lpszSelection, "\r\n\t");
-		//if (lpsz) {
-		//	*lpsz = '\0';
-		//}
+int EditPrepareFind(char *szFind2, LPCEDITFINDREPLACE lpefr) {
+	return EditPrepareFindEx(szFind2, lpefr->szFind, SciCall_GetCodePage(), lpefr);
+}
 
-		char *lpszEscSel = (char *)NP2HeapAlloc((2 * NP2_FIND_REPLACE_LIMIT));
-		lpefr->bTransformBS = AddBackslashA(lpszEscSel, lpszSelection);
+int EditPrepareReplace(HWND hwnd, char *szFind2, char **pszReplace2, BOOL *bReplaceRE, LPCEDITFINDREPLACE lpefr) {
+	const int searchFlags = EditPrepareFind(szFind2, lpefr);
+	if (searchFlags == NP2_InvalidSearchFlags) {
+		return searchFlags;
+	}
 
-		SetDlgItemTextA2W(cpEdit, hwnd, IDC_FINDTEXT, lpszEscSel);
-		NP2HeapFree(lpszEscSel);
+	*bReplaceRE = (searchFlags & SCFIND_REGEXP);
+	if (StrEqualA(lpefr->szReplace, "^c")) {
+		*bReplaceRE = FALSE;
+		*pszReplace2 = EditGetClipboardText(hwnd);
+	} else {
+		*pszReplace2 = StrDupA(lpefr->szReplace);
+		if (lpefr->bTransformBS) {
+			const UINT cpEdit = SciCall_GetCodePage();
+			TransformBackslashes(*pszReplace2, *bReplaceRE, cpEdit);
+		}
 	}
 
-	if (lpszSelection != NULL) {
-		NP2HeapFree(lpszSelection);
+	if (*pszReplace2 == NULL) {
+		*pszReplace2 = StrDupA("");
 	}
-	return hasFindText;
+	return searchFlags;
 }
 
 //=============================================================================
 //
-// EditFindReplaceDlgProc()
-//
-static INT_PTR CALLBACK EditFindReplaceDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
-	static int bSwitchedFindReplace = 0;
-	static int xFindReplaceDlgSave;
-	static int yFindReplaceDlgSave;
-	static EDITFINDREPLACE efrSave;
-	static HFONT hFontFindReplaceEdit;
-
-	WCHAR tch[NP2_FIND_REPLACE_LIMIT + 32];
-
-	switch (umsg) {
-	case WM_INITDIALOG: {
-		SetWindowLongPtr(hwnd, DWLP_USER, lParam);
-		ResizeDlg_InitX(hwnd, cxFindReplaceDlg, IDC_RESIZEGRIP2);
-
-		HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
-		AddBackslashComboBoxSetup(hwnd, IDC_FINDTEXT);
-
-		// Load MRUs
-		for (int i = 0; i < MRU_GetCount(mruFind); i++) {
-			MRU_Enum(mruFind, i, tch, COUNTOF(tch));
-			ComboBox_AddString(hwndFind, tch);
-		}
-
-		LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)lParam;
-		// don't copy selection after toggle find & replace on this window.
-		BOOL hasFindText = FALSE;
-		if (bSwitchedFindReplace != 3) {
-			hasFindText = CopySelectionAsFindText(hwnd, lpefr, TRUE);
-		}
-		if (!GetWindowTextLength(hwndFind)) {
-			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
-		}
-
-		ComboBox_LimitText(hwndFind, NP2_FIND_REPLACE_LIMIT);
-		ComboBox_SetExtendedUI(hwndFind, TRUE);
-
-		HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
-		if (hwndRepl) {
-			AddBackslashComboBoxSetup(hwnd, IDC_REPLACETEXT);
-			for (int i = 0; i < MRU_GetCount(mruReplace); i++) {
-				MRU_Enum(mruReplace, i, tch, COUNTOF(tch));
-				ComboBox_AddString(hwndRepl, tch);
-			}
+// EditFindNext()
+//
+void EditFindNext(LPCEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
+	char szFind2[NP2_FIND_REPLACE_LIMIT];
+	const int searchFlags = EditPrepareFind(szFind2, lpefr);
+	if (searchFlags == NP2_InvalidSearchFlags) {
+		return;
+	}
 
-			ComboBox_LimitText(hwndRepl, NP2_FIND_REPLACE_LIMIT);
-			ComboBox_SetExtendedUI(hwndRepl, TRUE);
-			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8);
-		}
+	const Sci_Position iSelPos = SciCall_GetCurrentPos();
+	const Sci_Position iSelAnchor = SciCall_GetAnchor();
 
-		// focus on replace box when selected text is not empty.
-		PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)((hasFindText && hwndRepl)? hwndRepl : hwndFind), 1);
+	struct Sci_TextToFind ttf = { { SciCall_GetSelectionEnd(), SciCall_GetLength() }, szFind2, { 0, 0 } };
+	Sci_Position iPos = SciCall_FindText(searchFlags, &ttf);
+	BOOL bSuppressNotFound = FALSE;
 
-		if (lpefr->fuFlags & SCFIND_MATCHCASE) {
-			CheckDlgButton(hwnd, IDC_FINDCASE, BST_CHECKED);
+	if (iPos < 0 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap && !fExtendSelection) {
+		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap1", IDS_FIND_WRAPFW)) {
+			ttf.chrg.cpMin = 0;
+			iPos = SciCall_FindText(searchFlags, &ttf);
+		} else {
+			bSuppressNotFound = TRUE;
 		}
+	}
 
-		if (lpefr->fuFlags & SCFIND_WHOLEWORD) {
-			CheckDlgButton(hwnd, IDC_FINDWORD, BST_CHECKED);
+	if (iPos < 0) {
+		// not found
+		if (!bSuppressNotFound) {
+			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
 		}
-
-		if (lpefr->fuFlags & SCFIND_WORDSTART) {
-			CheckDlgButton(hwnd, IDC_FINDSTART, BST_CHECKED);
+	} else {
+		if (!fExtendSelection) {
+			EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
+		} else {
+			EditSelectEx(min_pos(iSelAnchor, iSelPos), ttf.chrgText.cpMax);
 		}
+	}
 
-		if (lpefr->fuFlags & SCFIND_REGEXP) {
-			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_CHECKED);
-		}
+}
 
-		if (lpefr->bTransformBS) {
-			CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_CHECKED);
-		}
+//=============================================================================
+//
+// EditFindPrev()
+//
+void EditFindPrev(LPCEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
+	char szFind2[NP2_FIND_REPLACE_LIMIT];
+	const int searchFlags = EditPrepareFind(szFind2, lpefr);
+	if (searchFlags == NP2_InvalidSearchFlags) {
+		return;
+	}
 
-		if (lpefr->bWildcardSearch) {
-			CheckDlgButton(hwnd, IDC_WILDCARDSEARCH, BST_CHECKED);
-			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
-		}
+	const Sci_Position iSelPos = SciCall_GetCurrentPos();
+	const Sci_Position iSelAnchor = SciCall_GetAnchor();
 
-		if (lpefr->bNoFindWrap) {
-			CheckDlgButton(hwnd, IDC_NOWRAP, BST_CHECKED);
-		}
+	struct Sci_TextToFind ttf = { { SciCall_GetSelectionStart(), 0 }, szFind2, { 0, 0 } };
+	Sci_Position iPos = SciCall_FindText(searchFlags, &ttf);
+	const Sci_Position iLength = SciCall_GetLength();
+	BOOL bSuppressNotFound = FALSE;
 
-		if (hwndRepl) {
-			if (bSwitchedFindReplace) {
-				if (lpefr->bFindClose) {
-					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
-				}
-			} else {
-				if (lpefr->bReplaceClose) {
-					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
-				}
-			}
+	if (iPos < 0 && ttf.chrg.cpMin < iLength && !lpefr->bNoFindWrap && !fExtendSelection) {
+		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap2", IDS_FIND_WRAPRE)) {
+			ttf.chrg.cpMin = iLength;
+			iPos = SciCall_FindText(searchFlags, &ttf);
 		} else {
-			if (bSwitchedFindReplace) {
-				if (lpefr->bReplaceClose) {
-					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
-				}
-			} else {
-				if (lpefr->bFindClose) {
-					CheckDlgButton(hwnd, IDC_FINDCLOSE, BST_CHECKED);
-				}
-			}
+			bSuppressNotFound = TRUE;
 		}
+	}
 
-		if (!bSwitchedFindReplace) {
-			if (xFindReplaceDlg == 0 || yFindReplaceDlg == 0) {
-				CenterDlgInParent(hwnd);
-			} else {
-				SetDlgPos(hwnd, xFindReplaceDlg, yFindReplaceDlg);
-			}
+	if (iPos < 0) {
+		// not found
+		if (!bSuppressNotFound) {
+			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
+		}
+	} else {
+		if (!fExtendSelection) {
+			EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
 		} else {
-			SetDlgPos(hwnd, xFindReplaceDlgSave, yFindReplaceDlgSave);
-			bSwitchedFindReplace = 0;
-			CopyMemory(lpefr, &efrSave, sizeof(EDITFINDREPLACE));
+			EditSelectEx(max_pos(iSelPos, iSelAnchor), ttf.chrgText.cpMin);
 		}
+	}
+}
 
-		if (bFindReplaceTransparentMode) {
-			CheckDlgButton(hwnd, IDC_TRANSPARENT, BST_CHECKED);
-		}
-		if (bFindReplaceFindAllBookmark) {
-			CheckDlgButton(hwnd, IDC_FINDALLBOOKMARK, BST_CHECKED);
-		}
-		if (bFindReplaceUseMonospacedFont) {
-			CheckDlgButton(hwnd, IDC_USEMONOSPACEDFONT, BST_CHECKED);
-			FindReplaceSetFont(hwnd, TRUE, &hFontFindReplaceEdit);
-		}
+//=============================================================================
+//
+// EditReplace()
+//
+BOOL EditReplace(HWND hwnd, LPCEDITFINDREPLACE lpefr) {
+	BOOL bReplaceRE;
+	char szFind2[NP2_FIND_REPLACE_LIMIT];
+	char *pszReplace2;
+	const int searchFlags = EditPrepareReplace(hwnd, szFind2, &pszReplace2, &bReplaceRE, lpefr);
+	if (searchFlags == NP2_InvalidSearchFlags) {
+		return FALSE;
 	}
-	return TRUE;
 
-	case WM_COPYDATA: {
-		HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
-		HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
-		LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
 
-		const BOOL hasFindText = CopySelectionAsFindText(hwnd, lpefr, FALSE);
-		if (!GetWindowTextLength(hwndFind)) {
-			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
-		}
-		if (lpefr->bTransformBS) {
-			CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_CHECKED);
+	struct Sci_TextToFind ttf = { { iSelStart, SciCall_GetLength() }, szFind2, { 0, 0 } };
+	Sci_Position iPos = SciCall_FindText(searchFlags, &ttf);
+	BOOL bSuppressNotFound = FALSE;
+
+	if (iPos < 0 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap) {
+		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap1", IDS_FIND_WRAPFW)) {
+			ttf.chrg.cpMin = 0;
+			iPos = SciCall_FindText(searchFlags, &ttf);
+		} else {
+			bSuppressNotFound = TRUE;
 		}
-		// focus on replace box when selected text is not empty.
-		PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)((hasFindText && hwndRepl)? hwndRepl : hwndFind), 1);
 	}
-	break;
 
-	case WM_DESTROY:
-		if (hFontFindReplaceEdit) {
-			DeleteObject(hFontFindReplaceEdit);
-			hFontFindReplaceEdit = NULL;
+	if (iPos < 0) {
+		// not found
+		LocalFree(pszReplace2);
+		if (!bSuppressNotFound) {
+			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
 		}
-		ResizeDlg_Destroy(hwnd, &cxFindReplaceDlg, NULL);
 		return FALSE;
+	}
 
-	case WM_SIZE: {
-		int dx;
+	if (iSelStart != ttf.chrgText.cpMin || iSelEnd != ttf.chrgText.cpMax) {
+		LocalFree(pszReplace2);
+		EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
+		return FALSE;
+	}
 
-		const BOOL isReplace = GetDlgItem(hwnd, IDC_REPLACETEXT) != NULL;
-		ResizeDlg_Size(hwnd, lParam, &dx, NULL);
-		HDWP hdwp = BeginDeferWindowPos(isReplace ? 13 : 9);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_RESIZEGRIP2, dx, 0, SWP_NOSIZE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDOK, dx, 0, SWP_NOSIZE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDTEXT, dx, 0, SWP_NOMOVE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_CLEAR_FIND, dx, 0, SWP_NOSIZE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDPREV, dx, 0, SWP_NOSIZE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_SAVEPOSITION, dx, 0, SWP_NOSIZE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_RESETPOSITION, dx, 0, SWP_NOSIZE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDALL, dx, 0, SWP_NOSIZE);
-		hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACEALL, dx, 0, SWP_NOSIZE);
-		if (isReplace) {
-			hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACETEXT, dx, 0, SWP_NOMOVE);
-			hdwp = DeferCtlPos(hdwp, hwnd, IDC_CLEAR_REPLACE, dx, 0, SWP_NOSIZE);
-			hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACE, dx, 0, SWP_NOSIZE);
-			hdwp = DeferCtlPos(hdwp, hwnd, IDC_REPLACEINSEL, dx, 0, SWP_NOSIZE);
+	SciCall_SetTargetRange(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
+	SciCall_ReplaceTargetEx(bReplaceRE, -1, pszReplace2);
+
+	ttf.chrg.cpMin = SciCall_GetTargetEnd();
+	ttf.chrg.cpMax = SciCall_GetLength();
+
+	iPos = SciCall_FindText(searchFlags, &ttf);
+	bSuppressNotFound = FALSE;
+
+	if (iPos < 0 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap) {
+		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap1", IDS_FIND_WRAPFW)) {
+			ttf.chrg.cpMin = 0;
+			iPos = SciCall_FindText(searchFlags, &ttf);
+		} else {
+			bSuppressNotFound = TRUE;
+		}
+	}
+
+	if (iPos >= 0) {
+		EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
+	} else {
+		iPos = SciCall_GetTargetEnd();
+		EditSelectEx(iPos, iPos); //?
+		if (!bSuppressNotFound) {
+			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
 		}
-		EndDeferWindowPos(hdwp);
 	}
+
+	LocalFree(pszReplace2);
 	return TRUE;
+}
 
-	case WM_GETMINMAXINFO:
-		ResizeDlg_GetMinMaxInfo(hwnd, lParam);
-		return TRUE;
+//=============================================================================
+//
+// EditMarkAll()
+// Mark all occurrences of the text currently selected (originally by Aleksandar Lekov)
+//
 
-	case WM_COMMAND:
-		switch (LOWORD(wParam)) {
-		case IDC_FINDTEXT:
-		case IDC_REPLACETEXT: {
-			HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
-			const BOOL bEnable = ComboBox_HasText(hwndFind);
+extern EditMarkAllStatus editMarkAllStatus;
+extern HANDLE idleTaskTimer;
+#define EditMarkAll_MeasuredSize		(1024*1024)
+#define EditMarkAll_MinDuration			1
+// (100 / 64) => 2 MiB on second search.
+// increment search size will return to normal after several runs
+// when selection no longer changed, this make continuous selecting smooth.
+#define EditMarkAll_DefaultDuration		64
+#define EditMarkAll_RangeCacheCount		1024
+#define EditMarkAll_MaxIndexedMatches	(4*1024*1024)
+#define EditMarkAll_ParallelMinSize		(16*1024*1024)
+#define EditMarkAll_PackedWindowSize	(64*1024*1024)
+//static UINT EditMarkAll_Runs;
+
+void EditMarkAll_DiscardIndex(EditMarkAllStatus *status) {
+	if (status->matchPositions) {
+		NP2HeapFree(status->matchPositions);
+		status->matchPositions = NULL;
+	}
+	status->indexCapacity = -1;
+}
+
+static BOOL EditMarkAll_GrowIndex(EditMarkAllStatus *status, Sci_Position count) {
+	if (count > EditMarkAll_MaxIndexedMatches) {
+		EditMarkAll_DiscardIndex(status);
+		return FALSE;
+	}
 
-			EnableWindow(GetDlgItem(hwnd, IDOK), bEnable);
-			EnableWindow(GetDlgItem(hwnd, IDC_FINDPREV), bEnable);
-			EnableWindow(GetDlgItem(hwnd, IDC_FINDALL), bEnable);
-			EnableWindow(GetDlgItem(hwnd, IDC_REPLACE), bEnable);
-			EnableWindow(GetDlgItem(hwnd, IDC_REPLACEALL), bEnable);
-			EnableWindow(GetDlgItem(hwnd, IDC_REPLACEINSEL), bEnable);
+	Sci_Position capacity = max_pos(1024, 2*status->indexCapacity);
+	capacity = min_pos(max_pos(capacity, count), EditMarkAll_MaxIndexedMatches);
+	const size_t size = capacity*sizeof(Sci_Position);
+	Sci_Position *positions = (Sci_Position *)(status->matchPositions ? NP2HeapReAlloc(status->matchPositions, size) : NP2HeapAlloc(size));
+	if (positions == NULL) {
+		EditMarkAll_DiscardIndex(status);
+		return FALSE;
+	}
+	status->matchPositions = positions;
+	status->indexCapacity = capacity;
+	return TRUE;
+}
 
-			if (HIWORD(wParam) == CBN_CLOSEUP) {
-				HWND hwndCtl = GetDlgItem(hwnd, LOWORD(wParam));
-				const DWORD lSelEnd = ComboBox_GetEditSelEnd(hwndCtl);
-				ComboBox_SetEditSel(hwndCtl, lSelEnd, lSelEnd);
-			}
+static inline void EditMarkAll_IndexMatch(EditMarkAllStatus *status, Sci_Position index, Sci_Position iPos) {
+	if (index < status->indexCapacity || EditMarkAll_GrowIndex(status, index + 1)) {
+		status->matchPositions[index] = iPos;
+	}
+}
+
+static Sci_Position EditMarkAll_LowerBound(const Sci_Position *positions, Sci_Position count, Sci_Position iPos) {
+	Sci_Position lower = 0;
+	while (lower < count) {
+		const Sci_Position middle = lower + (count - lower)/2;
+		if (positions[middle] < iPos) {
+			lower = middle + 1;
+		} else {
+			count = middle;
 		}
-		break;
+	}
+	return lower;
+}
 
-		case IDC_FINDREGEXP:
-			if (IsButtonChecked(hwnd, IDC_FINDREGEXP)) {
-				CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_UNCHECKED);
-				// Can not use wildcard search together with regexp
-				CheckDlgButton(hwnd, IDC_WILDCARDSEARCH, BST_UNCHECKED);
-			}
-			break;
+void EditMarkAll_OnModified(EditMarkAllStatus *status, BOOL insert, Sci_Position position, Sci_Position length) {
+	Sci_Position dirtyStart = status->dirtyStart;
+	Sci_Position dirtyEnd = status->dirtyEnd;
+	if (insert) {
+		status->dirtyDelta += length;
+		if (dirtyStart < 0) {
+			dirtyStart = position;
+			dirtyEnd = position + length;
+		} else if (position < dirtyStart) {
+			dirtyStart = position;
+			dirtyEnd += length;
+		} else if (position <= dirtyEnd) {
+			dirtyEnd += length;
+		} else {
+			dirtyEnd = position + length;
+		}
+	} else {
+		status->dirtyDelta -= length;
+		if (dirtyStart < 0) {
+			dirtyStart = position;
+			dirtyEnd = position;
+		} else {
+			dirtyStart = min_pos(dirtyStart, position);
+			dirtyEnd = (dirtyEnd >= position + length) ? (dirtyEnd - length) : position;
+		}
+	}
+	status->dirtyStart = dirtyStart;
+	status->dirtyEnd = dirtyEnd;
+}
 
-		case IDC_FINDTRANSFORMBS:
-			if (IsButtonChecked(hwnd, IDC_FINDTRANSFORMBS)) {
-				CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
-			}
-			break;
+// text changes between EditBeginBulkModification() and EditEndBulkModification() are notified
+// once by SC_MOD_BULKMODIFICATION, display is also updated once.
+static int bulkModificationDepth;
+static Sci_Position bulkModificationLength;
 
-		case IDC_WILDCARDSEARCH:
-			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
-			//if (IsButtonChecked(hwnd, IDC_FINDWILDCARDS))
-			//	CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
-			break;
+void EditBeginBulkModification(void) {
+	if (bulkModificationDepth++ == 0) {
+		bulkModificationLength = SciCall_GetLength();
+	}
+	SciCall_BeginBulkModification();
+}
 
-		case IDC_TRANSPARENT:
-			bFindReplaceTransparentMode = IsButtonChecked(hwnd, IDC_TRANSPARENT);
-			break;
+void EditEndBulkModification(void) {
+	--bulkModificationDepth;
+	SciCall_EndBulkModification();
+}
 
-		case IDC_FINDALLBOOKMARK:
-			bFindReplaceFindAllBookmark = IsButtonChecked(hwnd, IDC_FINDALLBOOKMARK);
-			break;
+void EditOnBulkModified(Sci_Position position, Sci_Position length, Sci_Line linesAdded) {
+	// changed range as one deletion followed by one insertion
+	const Sci_Position deleted = length - (SciCall_GetLength() - bulkModificationLength);
+	if (editMarkAllStatus.indexCapacity >= 0) {
+		EditMarkAll_OnModified(&editMarkAllStatus, FALSE, position, deleted);
+		EditMarkAll_OnModified(&editMarkAllStatus, TRUE, position, length);
+	}
+	// text is not available, indexes without a pending builder are discarded
+	AutoC_OnDocumentModified(FALSE, position, deleted, NULL, 0);
+	AutoC_OnDocumentModified(TRUE, position, length, NULL, linesAdded);
+	DocStats_OnModified(FALSE, position, deleted);
+	DocStats_OnModified(TRUE, position, length);
+}
 
-		case IDOK:
-		case IDC_FINDPREV:
-		case IDC_FINDALL:
-		case IDC_REPLACE:
-		case IDC_REPLACEALL:
-		case IDC_REPLACEINSEL:
-		case IDACC_SELTONEXT:
-		case IDACC_SELTOPREV: {
-			LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
-			HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
-			HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
-			const BOOL bIsFindDlg = (hwndRepl == NULL);
-			// Get current code page for Unicode conversion
-			const UINT cpEdit = SciCall_GetCodePage();
-			cpLastFind = cpEdit;
+// search again only on changed lines, returns FALSE when whole document needs to be searched again.
+static BOOL EditMarkAll_Update(EditMarkAllStatus *status) {
+	if (status->indexCapacity < 0) {
+		return FALSE;
+	}
+	const Sci_Position iLength = SciCall_GetLength();
+	const Sci_Position delta = status->dirtyDelta;
+	if (status->docLength + delta != iLength) {
+		// document changed without notification
+		return FALSE;
+	}
+	if (status->dirtyStart < 0) {
+		// only styles or markers changed
+		return TRUE;
+	}
 
-			if (!GetDlgItemTextA2W(cpEdit, hwnd, IDC_FINDTEXT, lpefr->szFind, COUNTOF(lpefr->szFind))) {
-				EnableWindow(GetDlgItem(hwnd, IDOK), FALSE);
-				EnableWindow(GetDlgItem(hwnd, IDC_FINDPREV), FALSE);
-				EnableWindow(GetDlgItem(hwnd, IDC_FINDALL), FALSE);
-				EnableWindow(GetDlgItem(hwnd, IDC_REPLACE), FALSE);
-				EnableWindow(GetDlgItem(hwnd, IDC_REPLACEALL), FALSE);
-				EnableWindow(GetDlgItem(hwnd, IDC_REPLACEINSEL), FALSE);
-				return TRUE;
-			}
+	const Sci_Position iStartPos = SciCall_PositionFromLine(SciCall_LineFromPosition(status->dirtyStart));
+	const Sci_Position iEndPos = SciCall_PositionFromLine(SciCall_LineFromPosition(status->dirtyEnd) + 1);
+	if (iEndPos - iStartPos > EditMarkAll_MeasuredSize) {
+		// large change, e.g. replace all
+		return FALSE;
+	}
 
-			if (!bIsFindDlg) {
-				GetDlgItemTextA2W(cpEdit, hwnd, IDC_REPLACETEXT, lpefr->szReplace, COUNTOF(lpefr->szReplace));
-			}
+	const Sci_Position iEndPosOld = iEndPos - delta;
+	const Sci_Position matchCount = status->matchCount;
+	const Sci_Position first = EditMarkAll_LowerBound(status->matchPositions, matchCount, iStartPos);
+	status->docLength = iLength;
+	status->dirtyStart = -1;
+	status->dirtyDelta = 0;
 
-			lpefr->bWildcardSearch = IsButtonChecked(hwnd, IDC_WILDCARDSEARCH);
-			lpefr->fuFlags = 0;
+	SciCall_SetIndicatorCurrent(IndicatorNumber_MarkOccurrence);
+	if (status->pending && iEndPosOld > status->iStartPos) {
+		if (iStartPos < status->iStartPos) {
+			// changed lines overlap not searched text, continue searching from first changed line.
+			SciCall_IndicatorClearRange(iStartPos, iEndPos - iStartPos);
+			status->matchCount = first;
+			status->lastMatchPos = iStartPos;
+			status->iStartPos = iStartPos;
+		}
+		return TRUE;
+	}
 
-			if (IsButtonChecked(hwnd, IDC_FINDCASE)) {
-				lpefr->fuFlags |= SCFIND_MATCHCASE;
+	SciCall_IndicatorClearRange(iStartPos, iEndPos - iStartPos);
+	Sci_Position *matches = NULL;
+	Sci_Position count = 0;
+	Sci_Position capacity = 0;
+	Sci_Position cpMin = iStartPos;
+	struct Sci_TextToFind ttf = { { cpMin, iEndPos }, status->pszText, { 0, 0 } };
+	const int findFlag = status->findFlag;
+	while (cpMin < iEndPos) {
+		ttf.chrg.cpMin = cpMin;
+		const Sci_Position iPos = SciCall_FindText(findFlag, &ttf);
+		if (iPos < 0) {
+			break;
+		}
+		if (count == capacity) {
+			capacity = max_pos(256, 2*capacity);
+			const size_t size = capacity*sizeof(Sci_Position);
+			Sci_Position *grown = (Sci_Position *)(matches ? NP2HeapReAlloc(matches, size) : NP2HeapAlloc(size));
+			if (grown == NULL) {
+				// out of memory, search whole document again without index
+				if (matches) {
+					NP2HeapFree(matches);
+				}
+				EditMarkAll_DiscardIndex(status);
+				return FALSE;
 			}
+			matches = grown;
+		}
+		matches[count++] = iPos;
+		const Sci_Position iSelCount = ttf.chrgText.cpMax - iPos;
+		if (iSelCount == 0) {
+			// empty regex
+			cpMin = SciCall_PositionAfter(iPos);
+			continue;
+		}
+		SciCall_IndicatorFillRange(iPos, iSelCount);
+		cpMin = ttf.chrgText.cpMax;
+	}
 
-			if (IsButtonChecked(hwnd, IDC_FINDWORD)) {
-				lpefr->fuFlags |= SCFIND_WHOLEWORD;
+	// replace matches on changed lines, move following matches.
+	const Sci_Position last = EditMarkAll_LowerBound(status->matchPositions, matchCount, iEndPosOld);
+	const Sci_Position newCount = matchCount - (last - first) + count;
+	if (newCount != 0 && (newCount <= status->indexCapacity || EditMarkAll_GrowIndex(status, newCount))) {
+		Sci_Position *positions = status->matchPositions;
+		memmove(positions + first + count, positions + last, (matchCount - last)*sizeof(Sci_Position));
+		if (count != 0) {
+			memcpy(positions + first, matches, count*sizeof(Sci_Position));
+		}
+		if (delta != 0) {
+			for (Sci_Position index = first + count; index < newCount; index++) {
+				positions[index] += delta;
 			}
+		}
+	}
+	if (matches) {
+		NP2HeapFree(matches);
+	}
 
-			if (IsButtonChecked(hwnd, IDC_FINDSTART)) {
-				lpefr->fuFlags |= SCFIND_WORDSTART;
-			}
+	status->matchCount = newCount;
+	status->iStartPos += delta;
+	if (status->lastMatchPos >= iEndPosOld) {
+		status->lastMatchPos += delta;
+	}
+	return TRUE;
+}
 
-			if (IsButtonChecked(hwnd, IDC_FINDREGEXP)) {
-				lpefr->fuFlags |= SCFIND_REGEXP | SCFIND_POSIX;
+void EditMarkAll_ClearEx(int findFlag, Sci_Position iSelCount, LPSTR pszText) {
+	if (editMarkAllStatus.matchCount != 0) {
+		// clear existing indicator
+		SciCall_SetIndicatorCurrent(IndicatorNumber_MarkOccurrence);
+		SciCall_IndicatorClearRange(0, SciCall_GetLength());
+	}
+	if (editMarkAllStatus.bookmarkLine >= 0 || editMarkAllStatus.bookmarkForFindAll) {
+		if ((findFlag | editMarkAllStatus.findFlag) & NP2_MarkAllBookmark) {
+			if ((findFlag & (NP2_MarkAllBookmark | NP2_FromFindAll)) != 0 || !editMarkAllStatus.bookmarkForFindAll) {
+				SciCall_MarkerDeleteAll(MarkerNumber_Bookmark);
 			}
+		}
+	}
+	if (editMarkAllStatus.pszText) {
+		NP2HeapFree(editMarkAllStatus.pszText);
+	}
 
-			lpefr->bTransformBS = IsButtonChecked(hwnd, IDC_FINDTRANSFORMBS);
-			lpefr->bNoFindWrap = IsButtonChecked(hwnd, IDC_NOWRAP);
+	editMarkAllStatus.pending = FALSE;
+	editMarkAllStatus.ignoreSelectionUpdate = FALSE;
+	editMarkAllStatus.findFlag = findFlag;
+	editMarkAllStatus.incrementSize = 1;
+	editMarkAllStatus.iSelCount= iSelCount;
+	editMarkAllStatus.pszText = pszText;
+	// timing for increment search is only useful for current search.
+	editMarkAllStatus.duration = EditMarkAll_DefaultDuration;
+	editMarkAllStatus.matchCount = 0;
+	editMarkAllStatus.lastMatchPos = 0;
+	editMarkAllStatus.iStartPos = 0;
+	editMarkAllStatus.bookmarkLine = -1;
 
-			if (bIsFindDlg) {
-				lpefr->bFindClose = IsButtonChecked(hwnd, IDC_FINDCLOSE);
-			} else {
-				lpefr->bReplaceClose = IsButtonChecked(hwnd, IDC_FINDCLOSE);
-			}
+	EditMarkAll_DiscardIndex(&editMarkAllStatus);
+	// bookmarks and selections are not updated incrementally.
+	if (pszText != NULL && (findFlag & (NP2_MarkAllBookmark | NP2_MarkAllSelectAll | NP2_MarkAllMultiline)) == 0) {
+		editMarkAllStatus.indexCapacity = 0;
+	}
+	editMarkAllStatus.docLength = SciCall_GetLength();
+	editMarkAllStatus.dirtyStart = -1;
+	editMarkAllStatus.dirtyEnd = -1;
+	editMarkAllStatus.dirtyDelta = 0;
+}
 
-			// Save MRUs
-			if (StrNotEmptyA(lpefr->szFind)) {
-				if (GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8, COUNTOF(lpefr->szFindUTF8))) {
-					ComboBox_GetText(hwndFind, tch, COUNTOF(tch));
-					MRU_AddMultiline(mruFind, tch);
-				}
-			}
-			if (StrNotEmptyA(lpefr->szReplace)) {
-				if (GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8, COUNTOF(lpefr->szReplaceUTF8))) {
-					ComboBox_GetText(hwndRepl, tch, COUNTOF(tch));
-					MRU_AddMultiline(mruReplace, tch);
-				}
-			} else {
-				strcpy(lpefr->szReplaceUTF8, "");
-			}
+BOOL EditMarkAll_Start(BOOL bChanged, int findFlag, Sci_Position iSelCount, LPSTR pszText) {
+	if (findFlag == editMarkAllStatus.findFlag
+		&& iSelCount == editMarkAllStatus.iSelCount
+		// _stricmp() is not safe for DBCS string.
+		&& memcmp(pszText, editMarkAllStatus.pszText, iSelCount) == 0) {
+		if (!bChanged || EditMarkAll_Update(&editMarkAllStatus)) {
+			NP2HeapFree(pszText);
+			return FALSE;
+		}
+	}
 
-			BOOL bCloseDlg;
-			if (bIsFindDlg) {
-				bCloseDlg = lpefr->bFindClose;
-			} else {
-				if (LOWORD(wParam) == IDOK) {
-					bCloseDlg = FALSE;
-				} else {
-					bCloseDlg = lpefr->bReplaceClose;
-				}
-			}
+	EditMarkAll_ClearEx(findFlag, iSelCount, pszText);
+	if ((findFlag & SCFIND_REGEXP) && iSelCount == 1) {
+		const char ch = *pszText;
+		if (ch == '^' || ch == '$') {
+			const Sci_Line lineCount = SciCall_GetLineCount();
+			EditMarkAll_DiscardIndex(&editMarkAllStatus);
+			editMarkAllStatus.matchCount = lineCount - (ch == '^');
+			UpdateStatusbar();
+			return TRUE;
+		}
+	}
 
-			// Reload MRUs
-			ComboBox_ResetContent(hwndFind);
-			ComboBox_ResetContent(hwndRepl);
+	//EditMarkAll_Runs = 0;
+	if (findFlag & NP2_MarkAllBookmark) {
+		editMarkAllStatus.bookmarkForFindAll = findFlag & NP2_FromFindAll;
+		Style_SetBookmark();
+	}
+	return EditMarkAll_Continue(&editMarkAllStatus, idleTaskTimer);
+}
 
-			for (int i = 0; i < MRU_GetCount(mruFind); i++) {
-				MRU_Enum(mruFind, i, tch, COUNTOF(tch));
-				ComboBox_AddString(hwndFind, tch);
+static Sci_Line EditMarkAll_Bookmark(Sci_Line bookmarkLine, const Sci_Position *ranges, UINT index, int findFlag, Sci_Position matchCount) {
+	if (findFlag & NP2_MarkAllSelectAll) {
+		UINT i = 0;
+		if (matchCount == (Sci_Position)(index/2)) {
+			i = 2;
+			SciCall_SetSelection(ranges[0] + ranges[1], ranges[0]);
+		}
+		for (; i < index; i += 2) {
+			SciCall_AddSelection(ranges[i] + ranges[i + 1], ranges[i]);
+		}
+	} else {
+		SciCall_IndicatorFillRanges(index/2, ranges);
+	}
+	if (!(findFlag & NP2_MarkAllBookmark)) {
+		return bookmarkLine;
+	}
+	if (findFlag & NP2_MarkAllMultiline) {
+		for (UINT i = 0; i < index; i += 2) {
+			Sci_Line line = SciCall_LineFromPosition(ranges[i]);
+			const Sci_Line lineEnd = SciCall_LineFromPosition(ranges[i] + ranges[i + 1]);
+			line = max_pos(bookmarkLine + 1, line);
+			while (line <= lineEnd) {
+				SciCall_MarkerAdd(line, MarkerNumber_Bookmark);
+				++line;
+			}
+			bookmarkLine = lineEnd;
+		}
+	} else {
+		for (UINT i = 0; i < index; i += 2) {
+			const Sci_Line line = SciCall_LineFromPosition(ranges[i]);
+			if (line != bookmarkLine) {
+				SciCall_MarkerAdd(line, MarkerNumber_Bookmark);
+				bookmarkLine = line;
 			}
+		}
+	}
+	return bookmarkLine;
+}
 
-			for (int i = 0; i < MRU_GetCount(mruReplace); i++) {
-				MRU_Enum(mruReplace, i, tch, COUNTOF(tch));
-				ComboBox_AddString(hwndRepl, tch);
+// find first match starts in [pos, end).
+static Sci_Position EditMarkAll_FindNext(const char *text, Sci_Position length, Sci_Position pos, Sci_Position end, const char *pattern, Sci_Position patternLen) {
+	end = min_pos(end, length - patternLen + 1);
+	const char ch = *pattern;
+	while (pos < end) {
+		const char *ptr = (const char *)memchr(text + pos, ch, end - pos);
+		if (ptr == NULL) {
+			break;
+		}
+		pos = ptr - text;
+		if (memcmp(ptr + 1, pattern + 1, patternLen - 1) == 0) {
+			return pos;
+		}
+		++pos;
+	}
+	return -1;
+}
+
+typedef struct MarkAllWorker {
+	const char *text;
+	Sci_Position length;
+	Sci_Position start;			// search range for match start
+	Sci_Position end;
+	const char *pattern;
+	Sci_Position patternLen;
+	Sci_Position *matches;		// match start positions
+	Sci_Position count;
+	Sci_Position capacity;
+	BOOL failed;				// out of memory
+} MarkAllWorker;
+
+static DWORD WINAPI EditMarkAll_SearchThread(LPVOID lpParam) {
+	MarkAllWorker *worker = (MarkAllWorker *)lpParam;
+	Sci_Position pos = worker->start;
+	while ((pos = EditMarkAll_FindNext(worker->text, worker->length, pos, worker->end, worker->pattern, worker->patternLen)) >= 0) {
+		if (worker->count == worker->capacity) {
+			const Sci_Position capacity = max_pos(1024, 2*worker->capacity);
+			const size_t size = capacity*sizeof(Sci_Position);
+			Sci_Position *matches = (Sci_Position *)(worker->matches ? NP2HeapReAlloc(worker->matches, size) : NP2HeapAlloc(size));
+			if (matches == NULL) {
+				worker->failed = TRUE;
+				break;
 			}
+			worker->matches = matches;
+			worker->capacity = capacity;
+		}
+		worker->matches[worker->count++] = pos;
+		pos += worker->patternLen;
+	}
+	return 0;
+}
 
-			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
-			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8);
+typedef struct MarkAllMerger {
+	EditMarkAllStatus *status;
+	Sci_Position matchCount;
+	Sci_Position lastEnd;		// end of previous match
+	Sci_Line bookmarkLine;
+	UINT index;
+	Sci_Position ranges[EditMarkAll_RangeCacheCount*2];
+} MarkAllMerger;
 
-			SendMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetFocus()), 1);
+static void EditMarkAll_MergeMatch(MarkAllMerger *merger, Sci_Position iPos) {
+	EditMarkAllStatus *status = merger->status;
+	const Sci_Position iSelCount = status->iSelCount;
+	const int findFlag = status->findFlag;
+	if (status->indexCapacity >= 0) {
+		EditMarkAll_IndexMatch(status, merger->matchCount, iPos);
+	}
+	++merger->matchCount;
 
-			if (bCloseDlg) {
-				DestroyWindow(hwnd);
-				hDlgFindReplace = NULL;
+	UINT index = merger->index;
+	if (index != 0 && iPos == merger->lastEnd && (findFlag & NP2_MarkAllSelectAll) == 0) {
+		// merge adjacent indicator ranges
+		merger->ranges[index - 1] += iSelCount;
+	} else {
+		merger->ranges[index] = iPos;
+		merger->ranges[index + 1] = iSelCount;
+		index += 2;
+		if (index == COUNTOF(merger->ranges)) {
+			merger->bookmarkLine = EditMarkAll_Bookmark(merger->bookmarkLine, merger->ranges, index, findFlag, merger->matchCount);
+			index = 0;
+		}
+	}
+	merger->index = index;
+	merger->lastEnd = iPos + iSelCount;
+}
+
+// search part of the document on worker threads and merge results. text holds length bytes
+// from document position offset, matches start before end.
+// returns FALSE when out of memory, matches in the part are not merged.
+static BOOL EditMarkAll_SearchPart(MarkAllMerger *merger, const char *text, Sci_Position offset, Sci_Position length, Sci_Position end, DWORD threadCount) {
+	EditMarkAllStatus *status = merger->status;
+	MarkAllWorker workers[MAXIMUM_WAIT_OBJECTS];
+	HANDLE workerThreads[MAXIMUM_WAIT_OBJECTS];
+	DWORD count = 0;
+	ZeroMemory(workers, threadCount*sizeof(MarkAllWorker));
+	const Sci_Position partLength = end - offset;
+	const Sci_Position chunkSize = partLength / threadCount;
+	for (DWORD i = 0; i < threadCount; i++) {
+		MarkAllWorker *worker = &workers[i];
+		worker->text = text;
+		worker->length = length;
+		worker->start = i*chunkSize;
+		worker->end = (i + 1 == threadCount) ? partLength : (worker->start + chunkSize);
+		worker->pattern = status->pszText;
+		worker->patternLen = status->iSelCount;
+		if (i != 0) {
+			HANDLE workerThread = WorkerPool_Submit(EditMarkAll_SearchThread, worker, WorkerPriority_High);
+			if (workerThread) {
+				workerThreads[count++] = workerThread;
+			} else {
+				EditMarkAll_SearchThread(worker);
 			}
+		}
+	}
+	EditMarkAll_SearchThread(&workers[0]);
+	for (DWORD i = 0; i < count; i++) {
+		WorkerPool_Wait(workerThreads[i]);
+		CloseHandle(workerThreads[i]);
+	}
 
-			switch (LOWORD(wParam)) {
-			case IDOK: // find next
-			case IDACC_SELTONEXT:
-				if (!bIsFindDlg) {
-					bReplaceInitialized = TRUE;
-				}
-				EditFindNext(lpefr, LOWORD(wParam) == IDACC_SELTONEXT || KeyboardIsKeyDown(VK_SHIFT));
-				break;
+	BOOL failed = FALSE;
+	for (DWORD i = 0; i < threadCount; i++) {
+		failed |= workers[i].failed;
+	}
+	if (failed) {
+		for (DWORD i = 0; i < threadCount; i++) {
+			if (workers[i].matches) {
+				NP2HeapFree(workers[i].matches);
+			}
+		}
+		return FALSE;
+	}
 
-			case IDC_FINDPREV: // find previous
-			case IDACC_SELTOPREV:
-				if (!bIsFindDlg) {
-					bReplaceInitialized = TRUE;
+	for (DWORD i = 0; i < threadCount; i++) {
+		MarkAllWorker *worker = &workers[i];
+		Sci_Position index = 0;
+		if (worker->count != 0 && worker->matches[0] + offset < merger->lastEnd) {
+			// first matches overlap with last match in previous part, search again
+			// from the last match until reaching a match found by the worker.
+			Sci_Position pos = merger->lastEnd - offset;
+			while ((pos = EditMarkAll_FindNext(text, length, pos, worker->end, worker->pattern, worker->patternLen)) >= 0) {
+				while (index < worker->count && worker->matches[index] < pos) {
+					++index;
 				}
-				EditFindPrev(lpefr, LOWORD(wParam) == IDACC_SELTOPREV || KeyboardIsKeyDown(VK_SHIFT));
-				break;
-
-			case IDC_REPLACE:
-				bReplaceInitialized = TRUE;
-				EditReplace(lpefr->hwnd, lpefr);
-				break;
-
-			case IDC_FINDALL:
-				EditFindAll(lpefr, FALSE);
-				break;
-
-			case IDC_REPLACEALL:
-				if (bIsFindDlg) {
-					EditFindAll(lpefr, TRUE);
-				} else {
-					bReplaceInitialized = TRUE;
-					EditReplaceAll(lpefr->hwnd, lpefr, TRUE);
+				if (index < worker->count && worker->matches[index] == pos) {
+					break;
 				}
-				break;
-
-			case IDC_REPLACEINSEL:
-				bReplaceInitialized = TRUE;
-				EditReplaceAllInSelection(lpefr->hwnd, lpefr, TRUE);
-				break;
+				EditMarkAll_MergeMatch(merger, pos + offset);
+				pos += worker->patternLen;
+			}
+			if (pos < 0) {
+				index = worker->count;
 			}
 		}
-		break;
-
-		case IDCANCEL:
-			DestroyWindow(hwnd);
-			break;
-
-		case IDACC_FIND:
-			PostWMCommand(hwndMain, IDM_EDIT_FIND);
-			break;
+		for (; index < worker->count; index++) {
+			EditMarkAll_MergeMatch(merger, worker->matches[index] + offset);
+		}
+		if (worker->matches) {
+			NP2HeapFree(worker->matches);
+		}
+	}
+	return TRUE;
+}
 
-		case IDACC_REPLACE:
-			PostWMCommand(hwndMain, IDM_EDIT_REPLACE);
-			break;
+// plain text search on large document: each processor searches a part of the document,
+// then results are merged into indicator ranges on current thread.
+// packed text of compressed document is copied in windows, instead of unpacking the whole document.
+static BOOL EditMarkAll_SearchParallel(EditMarkAllStatus *status, Sci_Position iLength) {
+	if (iLength < EditMarkAll_ParallelMinSize || status->iStartPos != 0 || status->matchCount != 0 || status->iSelCount == 0) {
+		return FALSE;
+	}
+	// case sensitive and not word based, so matching can be done by comparing bytes.
+	if ((status->findFlag & (SCFIND_REGEXP | SCFIND_WHOLEWORD | SCFIND_WORDSTART | SCFIND_MATCHCASE)) != SCFIND_MATCHCASE) {
+		return FALSE;
+	}
+	// byte matching may start inside DBCS character.
+	const UINT cpEdit = SciCall_GetCodePage();
+	if (!(cpEdit == SC_CP_UTF8 || cpEdit == CP_ACP)) {
+		return FALSE;
+	}
 
-		case IDACC_FINDNEXT:
-			PostWMCommand(hwnd, IDOK);
-			break;
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const DWORD threadCount = min_u(info.dwNumberOfProcessors, MAXIMUM_WAIT_OBJECTS);
+	if (threadCount <= 1) {
+		return FALSE;
+	}
 
-		case IDACC_FINDPREV:
-			PostWMCommand(hwnd, IDC_FINDPREV);
-			break;
+	const Sci_Position patternLen = status->iSelCount;
+	const BOOL packed = (SciCall_GetDocumentOptions() & SC_DOCUMENTOPTION_TEXT_COMPRESSED) != 0;
+	Sci_Position windowSize = iLength;
+	char *window = NULL;
+	const char *text;
+	if (packed) {
+		windowSize = EditMarkAll_PackedWindowSize;
+		window = (char *)NP2HeapAlloc(windowSize + patternLen);
+		if (window == NULL) {
+			return FALSE;
+		}
+		text = window;
+	} else {
+		// document is not modified while waiting for worker threads.
+		text = SciCall_GetRangePointer(0, iLength);
+	}
 
-		case IDACC_REPLACENEXT:
-			if (GetDlgItem(hwnd, IDC_REPLACETEXT) != NULL) {
-				PostWMCommand(hwnd, IDC_REPLACE);
-			}
+	MarkAllMerger merger;
+	merger.status = status;
+	merger.matchCount = 0;
+	merger.lastEnd = 0;
+	merger.bookmarkLine = status->bookmarkLine;
+	merger.index = 0;
+	SciCall_SetIndicatorCurrent(IndicatorNumber_MarkOccurrence);
+	Sci_Position searched = 0;
+	while (searched < iLength) {
+		const Sci_Position end = min_pos(searched + windowSize, iLength);
+		Sci_Position offset = 0;
+		Sci_Position length = iLength;
+		if (packed) {
+			// windows overlap by pattern length, so match across end of window is found.
+			offset = searched;
+			length = min_pos(end + patternLen - 1, iLength) - offset;
+			struct Sci_TextRange tr = { { offset, offset + length }, window };
+			SciCall_GetTextRange(&tr);
+		}
+		if (!EditMarkAll_SearchPart(&merger, text, offset, length, end, threadCount)) {
 			break;
-
-		case IDACC_SAVEFIND: {
-			SendWMCommand(hwndMain, IDM_EDIT_SAVEFIND);
-			LPCEDITFINDREPLACE lpefr = (LPCEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
-			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
-			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
-			CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_UNCHECKED);
-			PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetDlgItem(hwnd, IDC_FINDTEXT)), 1);
 		}
-		break;
+		searched = end;
+	}
+	if (window) {
+		NP2HeapFree(window);
+	}
+	if (merger.index) {
+		merger.bookmarkLine = EditMarkAll_Bookmark(merger.bookmarkLine, merger.ranges, merger.index, status->findFlag, merger.matchCount);
+	}
+	if (searched == 0) {
+		// out of memory, nothing is marked yet, fall back to increment search
+		return FALSE;
+	}
 
-		case IDC_TOGGLEFINDREPLACE: {
-			bSwitchedFindReplace |= 2;
-			LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
-			GetDlgPos(hwnd, &xFindReplaceDlgSave, &yFindReplaceDlgSave);
-			CopyMemory(&efrSave, lpefr, sizeof(EDITFINDREPLACE));
-			GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8, COUNTOF(lpefr->szFindUTF8));
-			if (!GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_REPLACETEXT, lpefr->szReplaceUTF8, COUNTOF(lpefr->szReplaceUTF8))) {
-				strcpy(lpefr->szReplaceUTF8, "");
-			}
-		}
-		break;
+	status->pending = searched < iLength;
+	status->ignoreSelectionUpdate = merger.matchCount ? (status->findFlag & NP2_MarkAllSelectAll) : FALSE;
+	status->lastMatchPos = merger.lastEnd;
+	// out of memory in later window, increment search continues after merged matches
+	status->iStartPos = max_pos(searched, merger.lastEnd);
+	status->bookmarkLine = merger.bookmarkLine;
+	status->matchCount = merger.matchCount;
+	UpdateStatusbar();
+	return !status->pending;
+}
 
-		case IDC_USEMONOSPACEDFONT:
-			bFindReplaceUseMonospacedFont = IsButtonChecked(hwnd, IDC_USEMONOSPACEDFONT);
-			FindReplaceSetFont(hwnd, bFindReplaceUseMonospacedFont, &hFontFindReplaceEdit);
-			break;
-		}
+BOOL EditMarkAll_Continue(EditMarkAllStatus *status, HANDLE timer) {
+	// use increment search to ensure FindText() terminated in expected time.
+	//++EditMarkAll_Runs;
+	//printf("match %3u %s\n", EditMarkAll_Runs, GetCurrentLogTime());
+	QueryPerformanceCounter(&status->watch.begin);
+	const Sci_Position iLength = SciCall_GetLength();
+	if (EditMarkAll_SearchParallel(status, iLength)) {
 		return TRUE;
+	}
 
-	case WM_NOTIFY: {
-		LPNMHDR pnmhdr = (LPNMHDR)lParam;
-		switch (pnmhdr->code) {
-		case NM_CLICK:
-		case NM_RETURN:
-			switch (pnmhdr->idFrom) {
-			case IDC_TOGGLEFINDREPLACE:
-				bSwitchedFindReplace = 1;
-				if (GetDlgItem(hwnd, IDC_REPLACETEXT)) {
-					PostWMCommand(hwndMain, IDM_EDIT_FIND);
-				} else {
-					PostWMCommand(hwndMain, IDM_EDIT_REPLACE);
-				}
-				break;
-
-			// Display help messages in the find/replace windows
-			case IDC_BACKSLASHHELP:
-				MsgBoxInfo(MB_OK, IDS_BACKSLASHHELP);
-				//ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_BACKSLASHHELP);
-				break;
+	Sci_Position iStartPos = status->iStartPos;
+	Sci_Position iMaxLength = status->incrementSize * EditMarkAll_MeasuredSize;
+	iMaxLength += iStartPos + status->iSelCount;
+	iMaxLength = min_pos(iMaxLength, iLength);
+	if (iMaxLength < iLength) {
+		// match on whole line to avoid rewinding.
+		iMaxLength = SciCall_PositionFromLine(SciCall_LineFromPosition(iMaxLength) + 1);
+		if (iMaxLength + EditMarkAll_MeasuredSize >= iLength) {
+			iMaxLength = iLength;
+		}
+	}
 
-			case IDC_REGEXPHELP:
-				MsgBoxInfo(MB_OK, IDS_REGEXPHELP);
-				//ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_REGEXPHELP);
-				break;
+	// rewind start position
+	const int findFlag = status->findFlag;
+	if (findFlag & NP2_MarkAllMultiline) {
+		iStartPos = max_pos(iStartPos - status->iSelCount + 1, status->lastMatchPos);
+	}
 
-			case IDC_WILDCARDHELP:
-				MsgBoxInfo(MB_OK, IDS_WILDCARDHELP);
-				//ShowNotificationMessage(SC_NOTIFICATIONPOSITION_CENTER, IDS_WILDCARDHELP);
-				break;
+	Sci_Position cpMin = iStartPos;
+	struct Sci_TextToFind ttf = { { cpMin, iMaxLength }, status->pszText, { 0, 0 } };
 
-			case IDC_CLEAR_FIND: {
-				HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
-				ComboBox_GetText(hwndFind, tch, COUNTOF(tch));
-				ComboBox_ResetContent(hwndFind);
-				MRU_Empty(mruFind);
-				MRU_Save(mruFind);
-				ComboBox_SetText(hwndFind, tch);
-			}
-			break;
+	Sci_Position matchCount = status->matchCount;
+	UINT index = 0;
+	Sci_Position ranges[EditMarkAll_RangeCacheCount*2];
+	Sci_Line bookmarkLine = status->bookmarkLine;
 
-			case IDC_CLEAR_REPLACE: {
-				HWND hwndRepl = GetDlgItem(hwnd, IDC_REPLACETEXT);
-				ComboBox_GetText(hwndRepl, tch, COUNTOF(tch));
-				ComboBox_ResetContent(hwndRepl);
-				MRU_Empty(mruReplace);
-				MRU_Save(mruReplace);
-				ComboBox_SetText(hwndRepl, tch);
-			}
+	NP2_TRACE_START("MarkAll", NP2_TRACE_INT64(cpMin, "start"), NP2_TRACE_INT64(iMaxLength, "end"));
+	SciCall_SetIndicatorCurrent(IndicatorNumber_MarkOccurrence);
+	WaitableTimer_Set(timer, WaitableTimer_IdleTaskTimeSlot);
+	while (cpMin < iMaxLength && WaitableTimer_Continue(timer)) {
+		ttf.chrg.cpMin = cpMin;
+		const Sci_Position iPos = SciCall_FindText(findFlag, &ttf);
+		if (iPos < 0) {
+			iStartPos = iMaxLength;
 			break;
+		}
 
-			case IDC_SAVEPOSITION:
-				GetDlgPos(hwnd, &xFindReplaceDlg, &yFindReplaceDlg);
-				break;
+		if (status->indexCapacity >= 0) {
+			EditMarkAll_IndexMatch(status, matchCount, iPos);
+		}
+		++matchCount;
+		const Sci_Position iSelCount = ttf.chrgText.cpMax - iPos;
+		if (iSelCount == 0) {
+			// empty regex
+			cpMin = SciCall_PositionAfter(iPos);
+			continue;
+		}
 
-			case IDC_RESETPOSITION:
-				CenterDlgInParent(hwnd);
-				xFindReplaceDlg = yFindReplaceDlg = 0;
-				break;
+		if (index != 0 && iPos == cpMin && (findFlag & NP2_MarkAllSelectAll) == 0) {
+			// merge adjacent indicator ranges
+			ranges[index - 1] += iSelCount;
+		} else {
+			ranges[index] = iPos;
+			ranges[index + 1] = iSelCount;
+			index += 2;
+			if (index == COUNTOF(ranges)) {
+				bookmarkLine = EditMarkAll_Bookmark(bookmarkLine, ranges, index, findFlag, matchCount);
+				index = 0;
 			}
-			break;
 		}
+		cpMin = ttf.chrgText.cpMax;
 	}
-	break;
+	if (index) {
+		bookmarkLine = EditMarkAll_Bookmark(bookmarkLine, ranges, index, findFlag, matchCount);
+	}
+	NP2_TRACE_STOP("MarkAll", NP2_TRACE_INT64(cpMin, "position"), NP2_TRACE_INT64(matchCount, "matchCount"));
 
-	case WM_ACTIVATE :
-		SetWindowTransparentMode(hwnd, (LOWORD(wParam) == WA_INACTIVE && bFindReplaceTransparentMode), iFindReplaceOpacityLevel);
-		break;
+	iStartPos = max_pos(iStartPos, cpMin);
+	const BOOL pending = iStartPos < iLength;
+	if (pending) {
+		// dynamic compute increment search size, see ActionDuration in Scintilla.
+		QueryPerformanceCounter(&status->watch.end);
+		const double period = StopWatch_Get(&status->watch);
+		iMaxLength = iStartPos - status->iStartPos;
+		const double durationOne = (EditMarkAll_MeasuredSize * period) / iMaxLength;
+		const double alpha = 0.25;
+		const double duration_ = alpha * durationOne + (1.0 - alpha) * status->duration;
+		const double duration = max_d(duration_, EditMarkAll_MinDuration);
+		const int incrementSize = 1 + (int)(WaitableTimer_IdleTaskTimeSlot / duration);
+		//printf("match %3u (%zd, %zd) length=%.3f / %zd, one=%.3f, duration=%.3f / %.3f, increment=%d\n", EditMarkAll_Runs,
+		//	status->iStartPos, iStartPos, period, iMaxLength, durationOne, duration, duration_, incrementSize);
+		status->incrementSize = incrementSize;
+		status->duration = duration;
 	}
 
+	status->pending = pending;
+	status->ignoreSelectionUpdate = matchCount ? (findFlag & NP2_MarkAllSelectAll) : FALSE;
+	status->lastMatchPos = cpMin;
+	status->iStartPos = iStartPos;
+	status->bookmarkLine = bookmarkLine;
+	if (!pending || matchCount != status->matchCount) {
+		status->matchCount = matchCount;
+		UpdateStatusbar();
+		return TRUE;
+	}
 	return FALSE;
 }
 
-//=============================================================================
-//
-// EditFindReplaceDlg()
-//
-HWND EditFindReplaceDlg(HWND hwnd, LPEDITFINDREPLACE lpefr, BOOL bReplace) {
-	lpefr->hwnd = hwnd;
-	HWND hDlg = CreateThemedDialogParam(g_hInstance,
-								   (bReplace) ? MAKEINTRESOURCE(IDD_REPLACE) : MAKEINTRESOURCE(IDD_FIND),
-								   GetParent(hwnd),
-								   EditFindReplaceDlgProc,
-								   (LPARAM)lpefr);
-
-	ShowWindow(hDlg, SW_SHOW);
-	return hDlg;
-}
-
-// Wildcard search uses the regexp engine to perform a simple search with * ?
-// as wildcards instead of more advanced and user-unfriendly regexp syntax.
-static void EscapeWildcards(char *szFind2) {
-	char szWildcardEscaped[NP2_FIND_REPLACE_LIMIT];
-	int iSource = 0;
-	int iDest = 0;
+BOOL EditMarkAll(BOOL bChanged, BOOL matchCase, BOOL wholeWord, BOOL bookmark) {
+	// get current selection
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	Sci_Position iSelCount = iSelEnd - iSelStart;
 
-	while (szFind2[iSource]) {
-		const char c = szFind2[iSource];
-		if (c == '*') {
-			szWildcardEscaped[iDest++] = '.';
-			szWildcardEscaped[iDest] = '*';
-		} else if (c == '?') {
-			szWildcardEscaped[iDest] = '.';
-		} else {
-			if (c == '.' || c == '^' || c == '$' || c == '\\' || c == '[' || c == ']' || c == '+') {
-				szWildcardEscaped[iDest++] = '\\';
-			}
-			szWildcardEscaped[iDest] = c;
-		}
-		iSource++;
-		iDest++;
+	// if nothing selected or multiple lines are selected exit
+	if (iSelCount == 0 || SciCall_LineFromPosition(iSelStart) != SciCall_LineFromPosition(iSelEnd)) {
+		EditMarkAll_Clear();
+		return FALSE;
 	}
-	szWildcardEscaped[iDest] = 0;
-	strncpy(szFind2, szWildcardEscaped, COUNTOF(szWildcardEscaped));
-}
 
-int EditPrepareFind(char *szFind2, LPCEDITFINDREPLACE lpefr) {
-	if (StrIsEmptyA(lpefr->szFind)) {
-		return NP2_InvalidSearchFlags;
-	}
+	// scintilla/src/Editor.h SelectionText.LengthWithTerminator()
+	iSelCount = SciCall_GetSelTextLength() - 1;
+	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1);
+	SciCall_GetSelText(pszText);
 
-	int searchFlags = lpefr->fuFlags;
-	strncpy(szFind2, lpefr->szFind, NP2_FIND_REPLACE_LIMIT);
-	if (lpefr->bTransformBS) {
+	// exit if selection is not a word and Match whole words only is enabled
+	if (wholeWord) {
 		const UINT cpEdit = SciCall_GetCodePage();
-		TransformBackslashes(szFind2, (searchFlags & SCFIND_REGEXP), cpEdit);
-	}
-	if (StrIsEmptyA(szFind2)) {
-		InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
-		return NP2_InvalidSearchFlags;
+		const BOOL dbcs = !(cpEdit == CP_UTF8 || cpEdit == 0);
+		// CharClassify::SetDefaultCharClasses()
+		for (iSelStart = 0; iSelStart < iSelCount; ++iSelStart) {
+			const unsigned char ch = pszText[iSelStart];
+			if (dbcs && IsDBCSLeadByteEx(cpEdit, ch)) {
+				++iSelStart;
+			} else if (!(ch >= 0x80 || IsDocWordChar(ch))) {
+				NP2HeapFree(pszText);
+				EditMarkAll_Clear();
+				return FALSE;
+			}
+		}
 	}
-	if (lpefr->bWildcardSearch) {
-		EscapeWildcards(szFind2);
-		searchFlags |= SCFIND_REGEXP;
-	} else if (!(searchFlags & (SCFIND_REGEXP | SCFIND_MATCHCASE))) {
-		const BOOL sensitive = IsStringCaseSensitiveA(szFind2);
+	if (!matchCase) {
+		const BOOL sensitive = IsStringCaseSensitiveA(pszText);
 		//printf("%s sensitive=%d\n", __func__, sensitive);
-		searchFlags |= ((sensitive - 1) & SCFIND_MATCHCASE);
+		matchCase = sensitive ^ 1;
 	}
-	return searchFlags;
+
+	const int findFlag = (matchCase * SCFIND_MATCHCASE)
+		| (wholeWord * SCFIND_WHOLEWORD)
+		| (bookmark * NP2_MarkAllBookmark);
+	return EditMarkAll_Start(bChanged, findFlag, iSelCount, pszText);
 }
 
-int EditPrepareReplace(HWND hwnd, char *szFind2, char **pszReplace2, BOOL *bReplaceRE, LPCEDITFINDREPLACE lpefr) {
-	const int searchFlags = EditPrepareFind(szFind2, lpefr);
+void EditFindAll(LPCEDITFINDREPLACE lpefr, BOOL selectAll) {
+	char *szFind2 = (char *)NP2HeapAlloc(NP2_FIND_REPLACE_LIMIT);
+	int searchFlags = EditPrepareFind(szFind2, lpefr);
 	if (searchFlags == NP2_InvalidSearchFlags) {
-		return searchFlags;
-	}
-
-	*bReplaceRE = (searchFlags & SCFIND_REGEXP);
-	if (StrEqualA(lpefr->szReplace, "^c")) {
-		*bReplaceRE = FALSE;
-		*pszReplace2 = EditGetClipboardText(hwnd);
-	} else {
-		*pszReplace2 = StrDupA(lpefr->szReplace);
-		if (lpefr->bTransformBS) {
-			const UINT cpEdit = SciCall_GetCodePage();
-			TransformBackslashes(*pszReplace2, *bReplaceRE, cpEdit);
-		}
+		NP2HeapFree(szFind2);
+		return;
 	}
 
-	if (*pszReplace2 == NULL) {
-		*pszReplace2 = StrDupA("");
+	searchFlags |= (bFindReplaceFindAllBookmark * NP2_MarkAllBookmark)
+		| (selectAll * NP2_MarkAllSelectAll)
+		| NP2_FromFindAll;
+	// rewind start position when transform backslash is checked,
+	// all other searching doesn't across lines.
+	// NOTE: complex fix is needed when multiline regex is supported.
+	if (lpefr->bTransformBS && strpbrk(szFind2, "\r\n") != NULL) {
+		searchFlags |= NP2_MarkAllMultiline;
 	}
-	return searchFlags;
+	EditMarkAll_Start(FALSE, searchFlags, strlen(szFind2), szFind2);
 }
 
-//=============================================================================
-//
-// EditFindNext()
-//
-void EditFindNext(LPCEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
-	char szFind2[NP2_FIND_REPLACE_LIMIT];
-	const int searchFlags = EditPrepareFind(szFind2, lpefr);
-	if (searchFlags == NP2_InvalidSearchFlags) {
-		return;
+void EditToggleBookmarkAt(Sci_Position iPos) {
+	if (iPos < 0) {
+		iPos = SciCall_GetCurrentPos();
 	}
 
-	const Sci_Position iSelPos = SciCall_GetCurrentPos();
-	const Sci_Position iSelAnchor = SciCall_GetAnchor();
-
-	struct Sci_TextToFind ttf = { { SciCall_GetSelectionEnd(), SciCall_GetLength() }, szFind2, { 0, 0 } };
-	Sci_Position iPos = SciCall_FindText(searchFlags, &ttf);
-	BOOL bSuppressNotFound = FALSE;
+	const Sci_Line iLine = SciCall_LineFromPosition(iPos);
+	const Sci_MarkerMask bitmask = SciCall_MarkerGet(iLine);
+	if (bitmask & MarkerBitmask_Bookmark) {
+		SciCall_MarkerDelete(iLine, MarkerNumber_Bookmark);
+	} else {
+		Style_SetBookmark();
+		SciCall_MarkerAdd(iLine, MarkerNumber_Bookmark);
+	}
+}
 
-	if (iPos < 0 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap && !fExtendSelection) {
-		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap1", IDS_FIND_WRAPFW)) {
-			ttf.chrg.cpMin = 0;
-			iPos = SciCall_FindText(searchFlags, &ttf);
-		} else {
-			bSuppressNotFound = TRUE;
+void EditBookmarkSelectAll(void) {
+	Sci_Line line = SciCall_MarkerNext(0, MarkerBitmask_Bookmark);
+	if (line >= 0) {
+		editMarkAllStatus.ignoreSelectionUpdate = TRUE;
+		const Sci_Line iCurLine = SciCall_LineFromPosition(SciCall_GetCurrentPos());
+		SciCall_SetSelection(SciCall_PositionFromLine(line), SciCall_PositionFromLine(line + 1));
+		// set main selection near current line to ensure caret is visible after delete selected lines.
+		size_t main = 0;
+		size_t selection = 0;
+		Sci_Line minDiff = abs_pos(line - iCurLine);
+		while ((line = SciCall_MarkerNext(line + 1, MarkerBitmask_Bookmark)) >= 0) {
+			SciCall_AddSelection(SciCall_PositionFromLine(line), SciCall_PositionFromLine(line + 1));
+			++selection;
+			const Sci_Line diff = abs_pos(line - iCurLine);
+			if (diff < minDiff) {
+				minDiff = diff;
+				main = selection;
+			}
 		}
+		SciCall_SetMainSelection(main);
 	}
+}
 
-	if (iPos < 0) {
-		// not found
-		if (!bSuppressNotFound) {
-			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
-		}
+static void ShwowReplaceCount(Sci_Position iCount) {
+	if (iCount > 0) {
+		WCHAR tchNum[32];
+		PosToStrW(iCount, tchNum);
+		FormatNumberStr(tchNum);
+		InfoBoxInfo(MB_OK, L"MsgReplaceCount", IDS_REPLCOUNT, tchNum);
 	} else {
-		if (!fExtendSelection) {
-			EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
-		} else {
-			EditSelectEx(min_pos(iSelAnchor, iSelPos), ttf.chrgText.cpMax);
-		}
+		InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
 	}
-
 }
 
 //=============================================================================
 //
-// EditFindPrev()
+// EditReplaceAllInRange()
 //
-void EditFindPrev(LPCEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
-	char szFind2[NP2_FIND_REPLACE_LIMIT];
-	const int searchFlags = EditPrepareFind(szFind2, lpefr);
-	if (searchFlags == NP2_InvalidSearchFlags) {
-		return;
-	}
+// Find all matches in the range on unchanged document, then replace them in a single document
+// change and undo action, text, markers and indicators between matches are kept.
+// target is set to the range from first match start to last match end after replacement.
+Sci_Position EditReplaceAllInRange(int searchFlags, char *szFind2, const char *pszReplace2, BOOL bReplaceRE, Sci_Position iStart, Sci_Position iEnd) {
+	const BOOL bRegexStartOfLine = bReplaceRE && (szFind2[0] == '^');
+	const Sci_Position iLength = SciCall_GetLength();
+	const Sci_Position cchReplace = strlen(pszReplace2);
+	struct Sci_TextToFind ttf = { { iStart, iLength }, szFind2, { 0, 0 } };
+	LineEditList list = { NULL, 0, 0, NULL, 0, 0 };
+	Sci_Position iSpanStart = 0;
+	Sci_Position iSpanEnd = 0;
+	Sci_Position iPos;
+	while ((iPos = SciCall_FindText(searchFlags, &ttf)) >= 0) {
+		if (ttf.chrgText.cpMax > iEnd) {
+			// gone across range
+			break;
+		}
+		if (list.count == 0) {
+			iSpanStart = ttf.chrgText.cpMin;
+		}
+		iSpanEnd = ttf.chrgText.cpMax;
+		const Sci_Position deleteLength = ttf.chrgText.cpMax - ttf.chrgText.cpMin;
+		if (bReplaceRE) {
+			// substitute \d patterns with last match before searching again
+			const Sci_Position count = SciCall_SubstituteTargetRE(pszReplace2, NULL);
+			char *text = LineEditList_Add(&list, ttf.chrgText.cpMin, deleteLength, count);
+			if (text == NULL) {
+				break;
+			}
+			if (count != 0) {
+				SciCall_SubstituteTargetRE(pszReplace2, text);
+			}
+		} else if (!LineEditList_AddText(&list, ttf.chrgText.cpMin, deleteLength, pszReplace2, cchReplace)) {
+			break;
+		}
 
-	const Sci_Position iSelPos = SciCall_GetCurrentPos();
-	const Sci_Position iSelAnchor = SciCall_GetAnchor();
+		ttf.chrg.cpMin = ttf.chrgText.cpMax;
+		if (ttf.chrg.cpMin == ttf.chrg.cpMax) {
+			break;
+		}
 
-	struct Sci_TextToFind ttf = { { SciCall_GetSelectionStart(), 0 }, szFind2, { 0, 0 } };
-	Sci_Position iPos = SciCall_FindText(searchFlags, &ttf);
-	const Sci_Position iLength = SciCall_GetLength();
-	BOOL bSuppressNotFound = FALSE;
+		if (ttf.chrgText.cpMin == ttf.chrgText.cpMax && !bRegexStartOfLine) {
+			// move to next character after the empty match.
+			ttf.chrg.cpMin = SciCall_PositionAfter(ttf.chrg.cpMin);
+		}
+
+		if (bRegexStartOfLine) {
+			const Sci_Line iLine = SciCall_LineFromPosition(ttf.chrg.cpMin);
+			const Sci_Position ilPos = SciCall_PositionFromLine(iLine);
 
-	if (iPos < 0 && ttf.chrg.cpMin < iLength && !lpefr->bNoFindWrap && !fExtendSelection) {
-		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap2", IDS_FIND_WRAPRE)) {
-			ttf.chrg.cpMin = iLength;
-			iPos = SciCall_FindText(searchFlags, &ttf);
-		} else {
-			bSuppressNotFound = TRUE;
+			if (ilPos == ttf.chrg.cpMin) {
+				ttf.chrg.cpMin = SciCall_PositionFromLine(iLine + 1);
+			}
+			if (ttf.chrg.cpMin == ttf.chrg.cpMax) {
+				break;
+			}
 		}
 	}
 
-	if (iPos < 0) {
-		// not found
-		if (!bSuppressNotFound) {
-			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
-		}
-	} else {
-		if (!fExtendSelection) {
-			EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
-		} else {
-			EditSelectEx(max_pos(iSelPos, iSelAnchor), ttf.chrgText.cpMin);
-		}
+	if (LineEditList_Failed(&list)) {
+		// out of memory, document is unchanged
+		return -1;
 	}
+	const Sci_Position iCount = list.count;
+	if (iCount != 0) {
+		const Sci_Position delta = LineEditList_Apply(&list);
+		SciCall_SetTargetRange(iSpanStart, iSpanEnd + delta);
+	} else if (iPos < -1) {
+		// invalid regular expression
+		return iPos;
+	}
+	return iCount;
 }
 
 //=============================================================================
 //
-// EditReplace()
+// EditReplaceAll()
 //
-BOOL EditReplace(HWND hwnd, LPCEDITFINDREPLACE lpefr) {
+BOOL EditReplaceAll(HWND hwnd, LPCEDITFINDREPLACE lpefr, BOOL bShowInfo) {
 	BOOL bReplaceRE;
 	char szFind2[NP2_FIND_REPLACE_LIMIT];
 	char *pszReplace2;
@@ -5692,63 +9798,82 @@ BOOL EditReplace(HWND hwnd, LPCEDITFINDREPLACE lpefr) {
 		return FALSE;
 	}
 
-	const Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	// Show wait cursor...
+	BeginWaitCursor();
+	SendMessage(hwnd, WM_SETREDRAW, FALSE, 0);
 
-	struct Sci_TextToFind ttf = { { iSelStart, SciCall_GetLength() }, szFind2, { 0, 0 } };
-	Sci_Position iPos = SciCall_FindText(searchFlags, &ttf);
-	BOOL bSuppressNotFound = FALSE;
+	const Sci_Position iCount = EditReplaceAllInRange(searchFlags, szFind2, pszReplace2, bReplaceRE, 0, SciCall_GetLength());
 
-	if (iPos < 0 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap) {
-		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap1", IDS_FIND_WRAPFW)) {
-			ttf.chrg.cpMin = 0;
-			iPos = SciCall_FindText(searchFlags, &ttf);
-		} else {
-			bSuppressNotFound = TRUE;
-		}
+	SendMessage(hwnd, WM_SETREDRAW, TRUE, 0);
+	if (iCount > 0) {
+		RedrawWindow(hwnd, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
 	}
 
-	if (iPos < 0) {
-		// not found
-		LocalFree(pszReplace2);
-		if (!bSuppressNotFound) {
-			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
-		}
+	// Remove wait cursor
+	EndWaitCursor();
+
+	if (iCount == -1) {
+		dwLastIOError = ERROR_NOT_ENOUGH_MEMORY;
+		MsgBoxLastError(MB_OK, IDS_ERR_REPLACEALL);
+	} else if (bShowInfo) {
+		ShwowReplaceCount(iCount);
+	}
+
+	LocalFree(pszReplace2);
+	return TRUE;
+}
+
+//=============================================================================
+//
+// EditReplaceAllInSelection()
+//
+BOOL EditReplaceAllInSelection(HWND hwnd, LPCEDITFINDREPLACE lpefr, BOOL bShowInfo) {
+	if (SciCall_IsRectangleSelection()) {
+		NotifyRectangleSelection();
 		return FALSE;
 	}
 
-	if (iSelStart != ttf.chrgText.cpMin || iSelEnd != ttf.chrgText.cpMax) {
-		LocalFree(pszReplace2);
-		EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
+	BOOL bReplaceRE;
+	char szFind2[NP2_FIND_REPLACE_LIMIT];
+	char *pszReplace2;
+	const int searchFlags = EditPrepareReplace(hwnd, szFind2, &pszReplace2, &bReplaceRE, lpefr);
+	if (searchFlags == NP2_InvalidSearchFlags) {
 		return FALSE;
 	}
 
-	SciCall_SetTargetRange(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
-	SciCall_ReplaceTargetEx(bReplaceRE, -1, pszReplace2);
+	// Show wait cursor...
+	BeginWaitCursor();
+	SendMessage(hwnd, WM_SETREDRAW, FALSE, 0);
 
-	ttf.chrg.cpMin = SciCall_GetTargetEnd();
-	ttf.chrg.cpMax = SciCall_GetLength();
+	const Sci_Position iCount = EditReplaceAllInRange(searchFlags, szFind2, pszReplace2, bReplaceRE, SciCall_GetSelectionStart(), SciCall_GetSelectionEnd());
 
-	iPos = SciCall_FindText(searchFlags, &ttf);
-	bSuppressNotFound = FALSE;
+	SendMessage(hwnd, WM_SETREDRAW, TRUE, 0);
+	if (iCount > 0) {
+		const Sci_Position iPos = SciCall_GetTargetEnd();
+		if (SciCall_GetSelectionEnd() <	iPos) {
+			Sci_Position iAnchorPos = SciCall_GetAnchor();
+			Sci_Position iCurrentPos = SciCall_GetCurrentPos();
 
-	if (iPos < 0 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap) {
-		if (IDOK == InfoBoxInfo(MB_OKCANCEL, L"MsgFindWrap1", IDS_FIND_WRAPFW)) {
-			ttf.chrg.cpMin = 0;
-			iPos = SciCall_FindText(searchFlags, &ttf);
-		} else {
-			bSuppressNotFound = TRUE;
+			if (iAnchorPos > iCurrentPos) {
+				iAnchorPos = iPos;
+			} else {
+				iCurrentPos = iPos;
+			}
+
+			EditSelectEx(iAnchorPos, iCurrentPos);
 		}
+
+		RedrawWindow(hwnd, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
 	}
 
-	if (iPos >= 0) {
-		EditSelectEx(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
-	} else {
-		iPos = SciCall_GetTargetEnd();
-		EditSelectEx(iPos, iPos); //?
-		if (!bSuppressNotFound) {
-			InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
-		}
+	// Remove wait cursor
+	EndWaitCursor();
+
+	if (iCount == -1) {
+		dwLastIOError = ERROR_NOT_ENOUGH_MEMORY;
+		MsgBoxLastError(MB_OK, IDS_ERR_REPLACEALL);
+	} else if (bShowInfo) {
+		ShwowReplaceCount(iCount);
 	}
 
 	LocalFree(pszReplace2);
@@ -5757,496 +9882,882 @@ BOOL EditReplace(HWND hwnd, LPCEDITFINDREPLACE lpefr) {
 
 //=============================================================================
 //
-// EditMarkAll()
-// Mark all occurrences of the text currently selected (originally by Aleksandar Lekov)
-//
+// EditFindInFilesDlg()
+//
+// Files are listed on a worker thread with FindFirstFileEx(), then searched on all processors.
+// Each searcher thread owns a message-only Scintilla window, so matching is done by the same
+// search engine (literal, wildcard and regex) as EditFindNext().
+extern HWND hDlgFindInFiles;
+extern int cxFindInFilesDlg;
+extern int cyFindInFilesDlg;
+extern WCHAR tchFindInFilesFilter[MAX_PATH];
+extern BOOL bFindInFilesSubfolders;
+
+#define FIND_IN_FILES_MAX_FILE_SIZE		(256*1024*1024)
+#define FIND_IN_FILES_MAX_HIT_COUNT		100000
+#define FIND_IN_FILES_MAX_FILTER_COUNT	32
+#define FIND_IN_FILES_EXCERPT_SIZE		256
+#define FIND_IN_FILES_BINARY_CHECK_SIZE	4096
+
+typedef struct FindInFilesItem {
+	struct FindInFilesItem *next;
+	LPWSTR pszPath;
+	LPWSTR pszText;		// leading part of the matched line
+	int cchRoot;		// path is displayed relative to search directory
+	Sci_Line line;
+	Sci_Position column;	// in characters
+	Sci_Position length;	// in characters
+} FindInFilesItem;
+
+typedef struct FindInFilesWorker {
+	BackgroundWorker worker;	// where HWND is the dialog
+	LPWSTR pszPathBuf;			// NUL separated file paths
+	DWORD *pathOffsets;
+	DWORD cchPathBuf;
+	DWORD cchPathCapacity;
+	DWORD pathCount;
+	DWORD pathCapacity;
+	volatile LONG nextPath;
+	volatile LONG searchedCount;
+	volatile LONG hitCount;
+	BOOL bTruncated;
+	BOOL bSubfolders;
+	BOOL bMapFile;
+	BOOL bLargeFetch;
+	BOOL bExcludeFilter;
+	int filterCount;
+	int cchRoot;
+	int searchFlags;
+	int cchPattern;			// ASCII prefilter, zero when disabled
+	BOOL bPatternCase;
+	UINT cpAnsi;
+	DWORD dwPageSize;
+	LPCWSTR pFilter[FIND_IN_FILES_MAX_FILTER_COUNT];
+	WCHAR szFilterBuf[MAX_PATH];
+	WCHAR szRoot[MAX_PATH];
+	char szFind[NP2_FIND_REPLACE_LIMIT];
+	char szPattern[NP2_FIND_REPLACE_LIMIT];
+} FindInFilesWorker;
+
+static void FindInFiles_FreeItems(FindInFilesItem *item) {
+	while (item != NULL) {
+		FindInFilesItem *next = item->next;
+		NP2HeapFree(item);
+		item = next;
+	}
+}
+
+// same semantic as DirList_CreateFilter() in metapath: a leading '!' excludes the listed types.
+static void FindInFiles_InitFilter(FindInFilesWorker *worker, LPCWSTR lpszFileSpec) {
+	LPWSTR p = worker->szFilterBuf;
+	lstrcpyn(p, lpszFileSpec, COUNTOF(worker->szFilterBuf));
+	StrTrim(p, L" ");
+	worker->filterCount = 0;
+	worker->bExcludeFilter = FALSE;
+	if (*p == L'!') {
+		worker->bExcludeFilter = TRUE;
+		++p;
+	}
+	if (StrIsEmpty(p) || StrEqual(p, L"*.*") || StrEqual(p, L"*")) {
+		return;
+	}
 
-extern EditMarkAllStatus editMarkAllStatus;
-extern HANDLE idleTaskTimer;
-#define EditMarkAll_MeasuredSize		(1024*1024)
-#define EditMarkAll_MinDuration			1
-// (100 / 64) => 2 MiB on second search.
-// increment search size will return to normal after several runs
-// when selection no longer changed, this make continuous selecting smooth.
-#define EditMarkAll_DefaultDuration		64
-#define EditMarkAll_RangeCacheCount		256
-//static UINT EditMarkAll_Runs;
+	while (p != NULL && worker->filterCount < FIND_IN_FILES_MAX_FILTER_COUNT) {
+		LPWSTR next = StrChr(p, L';');
+		if (next != NULL) {
+			*next++ = L'\0';
+		}
+		StrTrim(p, L" ");
+		if (*p) {
+			worker->pFilter[worker->filterCount++] = p;
+		}
+		p = next;
+	}
+}
 
-void EditMarkAll_ClearEx(int findFlag, Sci_Position iSelCount, LPSTR pszText) {
-	if (editMarkAllStatus.matchCount != 0) {
-		// clear existing indicator
-		SciCall_SetIndicatorCurrent(IndicatorNumber_MarkOccurrence);
-		SciCall_IndicatorClearRange(0, SciCall_GetLength());
+static BOOL FindInFiles_MatchFilter(const FindInFilesWorker *worker, LPCWSTR lpszName) {
+	for (int i = 0; i < worker->filterCount; i++) {
+		if (PathMatchSpec(lpszName, worker->pFilter[i])) {
+			return !worker->bExcludeFilter;
+		}
 	}
-	if (editMarkAllStatus.bookmarkLine >= 0 || editMarkAllStatus.bookmarkForFindAll) {
-		if ((findFlag | editMarkAllStatus.findFlag) & NP2_MarkAllBookmark) {
-			if ((findFlag & (NP2_MarkAllBookmark | NP2_FromFindAll)) != 0 || !editMarkAllStatus.bookmarkForFindAll) {
-				SciCall_MarkerDeleteAll(MarkerNumber_Bookmark);
-			}
+	return worker->filterCount == 0 || worker->bExcludeFilter;
+}
+
+static BOOL FindInFiles_AddPath(FindInFilesWorker *worker, LPCWSTR szPath, DWORD cchPath) {
+	if (worker->pathCount == worker->pathCapacity) {
+		const DWORD capacity = max_u(worker->pathCapacity*2, 1024);
+		DWORD *pathOffsets = (DWORD *)((worker->pathOffsets == NULL) ? NP2HeapAlloc(capacity*sizeof(DWORD))
+			: NP2HeapReAlloc(worker->pathOffsets, capacity*sizeof(DWORD)));
+		if (pathOffsets == NULL) {
+			return FALSE;
 		}
+		worker->pathOffsets = pathOffsets;
+		worker->pathCapacity = capacity;
 	}
-	if (editMarkAllStatus.pszText) {
-		NP2HeapFree(editMarkAllStatus.pszText);
+	if (worker->cchPathBuf + cchPath + 1 > worker->cchPathCapacity) {
+		const DWORD capacity = max_u(worker->cchPathCapacity*2, 64*1024);
+		LPWSTR pszPathBuf = (LPWSTR)((worker->pszPathBuf == NULL) ? NP2HeapAlloc(capacity*sizeof(WCHAR))
+			: NP2HeapReAlloc(worker->pszPathBuf, capacity*sizeof(WCHAR)));
+		if (pszPathBuf == NULL) {
+			return FALSE;
+		}
+		worker->pszPathBuf = pszPathBuf;
+		worker->cchPathCapacity = capacity;
 	}
 
-	editMarkAllStatus.pending = FALSE;
-	editMarkAllStatus.ignoreSelectionUpdate = FALSE;
-	editMarkAllStatus.findFlag = findFlag;
-	editMarkAllStatus.incrementSize = 1;
-	editMarkAllStatus.iSelCount= iSelCount;
-	editMarkAllStatus.pszText = pszText;
-	// timing for increment search is only useful for current search.
-	editMarkAllStatus.duration = EditMarkAll_DefaultDuration;
-	editMarkAllStatus.matchCount = 0;
-	editMarkAllStatus.lastMatchPos = 0;
-	editMarkAllStatus.iStartPos = 0;
-	editMarkAllStatus.bookmarkLine = -1;
+	worker->pathOffsets[worker->pathCount++] = worker->cchPathBuf;
+	memcpy(worker->pszPathBuf + worker->cchPathBuf, szPath, cchPath*sizeof(WCHAR));
+	worker->cchPathBuf += cchPath;
+	worker->pszPathBuf[worker->cchPathBuf++] = L'\0';
+	return TRUE;
 }
 
-BOOL EditMarkAll_Start(BOOL bChanged, int findFlag, Sci_Position iSelCount, LPSTR pszText) {
-	if (!bChanged && (findFlag == editMarkAllStatus.findFlag
-		&& iSelCount == editMarkAllStatus.iSelCount
-		// _stricmp() is not safe for DBCS string.
-		&& memcmp(pszText, editMarkAllStatus.pszText, iSelCount) == 0)) {
-		NP2HeapFree(pszText);
-		return FALSE;
+// szPath ends with backslash, hidden or system items and directory links are skipped.
+static BOOL FindInFiles_ListFiles(FindInFilesWorker *worker, LPWSTR szPath, int cchPath) {
+	if (cchPath + 2 > MAX_PATH) {
+		return TRUE;
 	}
 
-	EditMarkAll_ClearEx(findFlag, iSelCount, pszText);
-	if ((findFlag & SCFIND_REGEXP) && iSelCount == 1) {
-		const char ch = *pszText;
-		if (ch == '^' || ch == '$') {
-			const Sci_Line lineCount = SciCall_GetLineCount();
-			editMarkAllStatus.matchCount = lineCount - (ch == '^');
-			UpdateStatusbar();
-			return TRUE;
-		}
+	szPath[cchPath] = L'*';
+	szPath[cchPath + 1] = L'\0';
+	WIN32_FIND_DATA fd;
+	// FindExInfoBasic and FIND_FIRST_EX_LARGE_FETCH are supported since Windows 7.
+	HANDLE hFind = FindFirstFileEx(szPath, worker->bLargeFetch ? FindExInfoBasic : FindExInfoStandard, &fd,
+		FindExSearchNameMatch, NULL, worker->bLargeFetch ? FIND_FIRST_EX_LARGE_FETCH : 0);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return TRUE;
 	}
 
-	//EditMarkAll_Runs = 0;
-	if (findFlag & NP2_MarkAllBookmark) {
-		editMarkAllStatus.bookmarkForFindAll = findFlag & NP2_FromFindAll;
-		Style_SetBookmark();
-	}
-	return EditMarkAll_Continue(&editMarkAllStatus, idleTaskTimer);
+	BOOL bSuccess = TRUE;
+	do {
+		const DWORD dwAttr = fd.dwFileAttributes;
+		if (dwAttr & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) {
+			continue;
+		}
+
+		const int cchName = lstrlen(fd.cFileName);
+		if (cchPath + cchName + 2 > MAX_PATH) {
+			continue;
+		}
+		if (dwAttr & FILE_ATTRIBUTE_DIRECTORY) {
+			if (!worker->bSubfolders || (dwAttr & FILE_ATTRIBUTE_REPARSE_POINT)
+				|| (fd.cFileName[0] == L'.' && (fd.cFileName[1] == L'\0' || (fd.cFileName[1] == L'.' && fd.cFileName[2] == L'\0')))) {
+				continue;
+			}
+			memcpy(szPath + cchPath, fd.cFileName, cchName*sizeof(WCHAR));
+			szPath[cchPath + cchName] = L'\\';
+			bSuccess = FindInFiles_ListFiles(worker, szPath, cchPath + cchName + 1);
+		} else if (fd.nFileSizeHigh == 0 && fd.nFileSizeLow != 0 && fd.nFileSizeLow <= FIND_IN_FILES_MAX_FILE_SIZE
+			&& FindInFiles_MatchFilter(worker, fd.cFileName)) {
+			memcpy(szPath + cchPath, fd.cFileName, (cchName + 1)*sizeof(WCHAR));
+			bSuccess = FindInFiles_AddPath(worker, szPath, cchPath + cchName);
+		}
+	} while (bSuccess && BackgroundWorker_Continue(&worker->worker) && FindNextFile(hFind, &fd));
+
+	FindClose(hFind);
+	return bSuccess;
 }
 
-static Sci_Line EditMarkAll_Bookmark(Sci_Line bookmarkLine, const Sci_Position *ranges, UINT index, int findFlag, Sci_Position matchCount) {
-	if (findFlag & NP2_MarkAllSelectAll) {
-		UINT i = 0;
-		if (matchCount == (Sci_Position)(index/2)) {
-			i = 2;
-			SciCall_SetSelection(ranges[0] + ranges[1], ranges[0]);
+// the pattern has no regex meta characters, skip the file when it's not found in raw text.
+static BOOL FindInFiles_ContainsPattern(const FindInFilesWorker *worker, const char *ptr, DWORD cbText) {
+	const int cchPattern = worker->cchPattern;
+	if (cchPattern == 0) {
+		return TRUE;
+	}
+	if (cbText < (DWORD)cchPattern) {
+		return FALSE;
+	}
+
+	const char *pattern = worker->szPattern;
+	const char *end = ptr + cbText - cchPattern + 1;
+	const char ch = pattern[0];
+	const char chUpper = worker->bPatternCase ? ch : ((ch >= 'a' && ch <= 'z') ? (ch - 'a' + 'A') : ch);
+	while (ptr < end) {
+		ptr = FindEitherChar(ptr, end, ch, chUpper);
+		if (ptr == end) {
+			break;
 		}
-		for (; i < index; i += 2) {
-			SciCall_AddSelection(ranges[i] + ranges[i + 1], ranges[i]);
+		int i = 1;
+		if (worker->bPatternCase) {
+			while (i < cchPattern && ptr[i] == pattern[i]) {
+				i++;
+			}
+		} else {
+			while (i < cchPattern) {
+				char chText = ptr[i];
+				if (chText >= 'A' && chText <= 'Z') {
+					chText = chText - 'A' + 'a';
+				}
+				if (chText != pattern[i]) {
+					break;
+				}
+				i++;
+			}
 		}
-	} else {
-		for (UINT i = 0; i < index; i += 2) {
-			SciCall_IndicatorFillRange(ranges[i], ranges[i + 1]);
+		if (i == cchPattern) {
+			return TRUE;
 		}
+		++ptr;
 	}
-	if (!(findFlag & NP2_MarkAllBookmark)) {
-		return bookmarkLine;
+	return FALSE;
+}
+
+// convert file content to UTF-8 with same detection steps as EditDetermineEncoding() for files
+// without file variables and forced encoding, return NULL for binary and unconvertible file.
+static char *FindInFiles_DecodeText(const FindInFilesWorker *worker, char *lpData, DWORD cbData, DWORD *pcbText) {
+	if (IsUTF8Signature(lpData)) {
+		*pcbText = cbData - min_u(cbData, 3);
+		return lpData + 3;
 	}
-	if (findFlag & NP2_MarkAllMultiline) {
-		for (UINT i = 0; i < index; i += 2) {
-			Sci_Line line = SciCall_LineFromPosition(ranges[i]);
-			const Sci_Line lineEnd = SciCall_LineFromPosition(ranges[i] + ranges[i + 1]);
-			line = max_pos(bookmarkLine + 1, line);
-			while (line <= lineEnd) {
-				SciCall_MarkerAdd(line, MarkerNumber_Bookmark);
-				++line;
+
+	BOOL bBOM = FALSE;
+	BOOL bReverse = FALSE;
+	if (IsUnicode(lpData, cbData, &bBOM, &bReverse)) {
+		char *lpDataW = lpData;
+		if (bReverse) {
+			// view of the file is read only
+			lpDataW = (char *)NP2HeapAlloc(cbData + 16);
+			if (lpDataW == NULL) {
+				return NULL;
 			}
-			bookmarkLine = lineEnd;
+			_swab(lpData, lpDataW, cbData);
 		}
-	} else {
-		for (UINT i = 0; i < index; i += 2) {
-			const Sci_Line line = SciCall_LineFromPosition(ranges[i]);
-			if (line != bookmarkLine) {
-				SciCall_MarkerAdd(line, MarkerNumber_Bookmark);
-				bookmarkLine = line;
-			}
+		char *lpText = (char *)NP2HeapAlloc((cbData + 1)*sizeof(WCHAR));
+		if (lpText != NULL) {
+			LPCWSTR pszTextW = bBOM ? ((LPCWSTR)lpDataW + 1) : (LPCWSTR)lpDataW;
+			const size_t cchTextW = (cbData / sizeof(WCHAR)) - (bBOM ? 1 : 0);
+			BOOL bLossy = FALSE;
+			*pcbText = (DWORD)UTF16ToUTF8(pszTextW, cchTextW, lpText, &bLossy);
 		}
+		if (lpDataW != lpData) {
+			NP2HeapFree(lpDataW);
+		}
+		return lpText;
+	}
+
+	if (memchr(lpData, 0, min_u(cbData, FIND_IN_FILES_BINARY_CHECK_SIZE)) != NULL) {
+		return NULL;
+	}
+	if (IsUTF8(lpData, cbData)) {
+		*pcbText = cbData;
+		return lpData;
+	}
+
+	UINT uCodePage = worker->cpAnsi;
+	const int iDetected = DetectDBCSEncoding(lpData, cbData);
+	if (iDetected != CPI_NONE) {
+		uCodePage = mEncoding[iDetected].uCodePage;
 	}
-	return bookmarkLine;
+
+	LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
+	if (lpDataWide == NULL) {
+		return NULL;
+	}
+	const int cbDataWide = MultiByteToWideChar(uCodePage, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
+	char *lpText = (char *)NP2HeapAlloc(cbDataWide * kMaxMultiByteCount + 16);
+	if (lpText != NULL) {
+		*pcbText = WideCharToMultiByte(CP_UTF8, 0, lpDataWide, cbDataWide, lpText, (int)NP2HeapSize(lpText), NULL, NULL);
+	}
+	NP2HeapFree(lpDataWide);
+	return lpText;
 }
 
-BOOL EditMarkAll_Continue(EditMarkAllStatus *status, HANDLE timer) {
-	// use increment search to ensure FindText() terminated in expected time.
-	//++EditMarkAll_Runs;
-	//printf("match %3u %s\n", EditMarkAll_Runs, GetCurrentLogTime());
-	QueryPerformanceCounter(&status->watch.begin);
-	const Sci_Position iLength = SciCall_GetLength();
-	Sci_Position iStartPos = status->iStartPos;
-	Sci_Position iMaxLength = status->incrementSize * EditMarkAll_MeasuredSize;
-	iMaxLength += iStartPos + status->iSelCount;
-	iMaxLength = min_pos(iMaxLength, iLength);
-	if (iMaxLength < iLength) {
-		// match on whole line to avoid rewinding.
-		iMaxLength = SciCall_PositionFromLine(SciCall_LineFromPosition(iMaxLength) + 1);
-		if (iMaxLength + EditMarkAll_MeasuredSize >= iLength) {
-			iMaxLength = iLength;
+static FindInFilesItem *FindInFiles_NewItem(const FindInFilesWorker *worker, HANDLE hSci, LPCWSTR pszPath, Sci_Position iStart, Sci_Position iEnd) {
+	const Sci_Line iLine = Scintilla_DirectFunction(hSci, SCI_LINEFROMPOSITION, iStart, 0);
+	const Sci_Position iLineStart = Scintilla_DirectFunction(hSci, SCI_POSITIONFROMLINE, iLine, 0);
+	const Sci_Position iLineEnd = Scintilla_DirectFunction(hSci, SCI_GETLINEENDPOSITION, iLine, 0);
+	const Sci_Position cbLine = min_pos(iLineEnd - iLineStart, 4*FIND_IN_FILES_EXCERPT_SIZE);
+	const char *ptr = (const char *)Scintilla_DirectFunction(hSci, SCI_GETRANGEPOINTER, iLineStart, cbLine);
+
+	// skip leading indentation, cut excerpt on character boundary.
+	int offset = 0;
+	while (offset < cbLine && IsASpaceOrTab(ptr[offset])) {
+		++offset;
+	}
+	int cbExcerpt = (int)min_pos(cbLine - offset, FIND_IN_FILES_EXCERPT_SIZE);
+	if (offset + cbExcerpt < cbLine) {
+		while (cbExcerpt > 0 && (ptr[offset + cbExcerpt] & 0xC0) == 0x80) {
+			--cbExcerpt;
 		}
 	}
 
-	// rewind start position
-	const int findFlag = status->findFlag;
-	if (findFlag & NP2_MarkAllMultiline) {
-		iStartPos = max_pos(iStartPos - status->iSelCount + 1, status->lastMatchPos);
+	const int cchPath = lstrlen(pszPath);
+	FindInFilesItem *item = (FindInFilesItem *)NP2HeapAlloc(sizeof(FindInFilesItem) + (cchPath + cbExcerpt + 2)*sizeof(WCHAR));
+	if (item == NULL) {
+		return NULL;
 	}
 
-	Sci_Position cpMin = iStartPos;
-	struct Sci_TextToFind ttf = { { cpMin, iMaxLength }, status->pszText, { 0, 0 } };
+	item->pszPath = (LPWSTR)(item + 1);
+	item->pszText = item->pszPath + cchPath + 1;
+	memcpy(item->pszPath, pszPath, cchPath*sizeof(WCHAR));
+	const int cchText = MultiByteToWideChar(CP_UTF8, 0, ptr + offset, cbExcerpt, item->pszText, cbExcerpt + 1);
+	for (int i = 0; i < cchText; i++) {
+		if (item->pszText[i] == L'\t') {
+			item->pszText[i] = L' ';
+		}
+	}
+	item->cchRoot = worker->cchRoot;
+	item->line = iLine;
+	item->column = Scintilla_DirectFunction(hSci, SCI_COUNTCHARACTERS, iLineStart, iStart);
+	item->length = Scintilla_DirectFunction(hSci, SCI_COUNTCHARACTERS, iStart, iEnd);
+	return item;
+}
 
-	Sci_Position matchCount = status->matchCount;
-	UINT index = 0;
-	Sci_Position ranges[EditMarkAll_RangeCacheCount*2];
-	Sci_Line bookmarkLine = status->bookmarkLine;
+static void FindInFiles_SearchFile(FindInFilesWorker *worker, HANDLE hSci, LPCWSTR pszPath) {
+	HANDLE hFile = CreateFile(pszPath,
+					   GENERIC_READ,
+					   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+					   NULL, OPEN_EXISTING,
+					   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+					   NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return;
+	}
 
-	SciCall_SetIndicatorCurrent(IndicatorNumber_MarkOccurrence);
-	WaitableTimer_Set(timer, WaitableTimer_IdleTaskTimeSlot);
-	while (cpMin < iMaxLength && WaitableTimer_Continue(timer)) {
-		ttf.chrg.cpMin = cpMin;
-		const Sci_Position iPos = SciCall_FindText(findFlag, &ttf);
-		if (iPos < 0) {
-			iStartPos = iMaxLength;
-			break;
-		}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0 || fileSize.QuadPart > FIND_IN_FILES_MAX_FILE_SIZE) {
+		CloseHandle(hFile);
+		return;
+	}
 
-		++matchCount;
-		const Sci_Position iSelCount = ttf.chrgText.cpMax - iPos;
-		if (iSelCount == 0) {
-			// empty regex
-			cpMin = SciCall_PositionAfter(iPos);
-			continue;
+	const DWORD cbData = (DWORD)fileSize.QuadPart;
+	char *lpData = NULL;
+	BOOL bMapped = FALSE;
+	// see EditShouldMapFile(), the view must have room for NP2_MAPPED_FILE_PADDING.
+	const DWORD remain = cbData & (worker->dwPageSize - 1);
+	if (worker->bMapFile && remain != 0 && remain <= worker->dwPageSize - NP2_MAPPED_FILE_PADDING) {
+		HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (hMapping != NULL) {
+			lpData = (char *)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(hMapping);
+			bMapped = lpData != NULL;
+		}
+	}
+	if (!bMapped) {
+		lpData = (char *)NP2HeapAlloc(cbData + NP2_MAPPED_FILE_PADDING);
+		DWORD cbRead = 0;
+		if (lpData != NULL && !(ReadFile(hFile, lpData, cbData, &cbRead, NULL) && cbRead == cbData)) {
+			NP2HeapFree(lpData);
+			lpData = NULL;
 		}
+	}
+	CloseHandle(hFile);
+	if (lpData == NULL) {
+		return;
+	}
 
-		if (index != 0 && iPos == cpMin && (findFlag & NP2_MarkAllSelectAll) == 0) {
-			// merge adjacent indicator ranges
-			ranges[index - 1] += iSelCount;
-		} else {
-			ranges[index] = iPos;
-			ranges[index + 1] = iSelCount;
-			index += 2;
-			if (index == COUNTOF(ranges)) {
-				bookmarkLine = EditMarkAll_Bookmark(bookmarkLine, ranges, index, findFlag, matchCount);
-				index = 0;
+	DWORD cbText = 0;
+	char *lpText = FindInFiles_DecodeText(worker, lpData, cbData, &cbText);
+	FindInFilesItem *head = NULL;
+	FindInFilesItem **tail = &head;
+	if (lpText != NULL && cbText != 0 && FindInFiles_ContainsPattern(worker, lpText, cbText)) {
+		Scintilla_DirectFunction(hSci, SCI_APPENDTEXT, cbText, (LPARAM)lpText);
+		struct Sci_TextToFind ttf = { { 0, cbText }, worker->szFind, { 0, 0 } };
+		while (ttf.chrg.cpMin < ttf.chrg.cpMax && BackgroundWorker_Continue(&worker->worker)) {
+			if (Scintilla_DirectFunction(hSci, SCI_FINDTEXT, worker->searchFlags, (LPARAM)&ttf) < 0) {
+				break;
 			}
+			if (InterlockedIncrement(&worker->hitCount) > FIND_IN_FILES_MAX_HIT_COUNT) {
+				worker->bTruncated = TRUE;
+				SetEvent(worker->worker.eventCancel);
+				break;
+			}
+
+			FindInFilesItem *item = FindInFiles_NewItem(worker, hSci, pszPath, ttf.chrgText.cpMin, ttf.chrgText.cpMax);
+			if (item != NULL) {
+				*tail = item;
+				tail = &item->next;
+			}
+			// skip current character for empty match
+			ttf.chrg.cpMin = (ttf.chrgText.cpMax > ttf.chrgText.cpMin) ? ttf.chrgText.cpMax
+				: Scintilla_DirectFunction(hSci, SCI_POSITIONAFTER, ttf.chrgText.cpMax, 0);
 		}
-		cpMin = ttf.chrgText.cpMax;
+		Scintilla_DirectFunction(hSci, SCI_CLEARALL, 0, 0);
 	}
-	if (index) {
-		bookmarkLine = EditMarkAll_Bookmark(bookmarkLine, ranges, index, findFlag, matchCount);
+
+	if (lpText != NULL && lpText != lpData && lpText != lpData + 3) {
+		NP2HeapFree(lpText);
 	}
+	EditFreeFileBuffer(lpData, bMapped);
+	if (head != NULL && !PostMessage(worker->worker.hwnd, APPM_FINDINFILES, 0, (LPARAM)head)) {
+		FindInFiles_FreeItems(head);
+	}
+}
 
-	iStartPos = max_pos(iStartPos, cpMin);
-	const BOOL pending = iStartPos < iLength;
-	if (pending) {
-		// dynamic compute increment search size, see ActionDuration in Scintilla.
-		QueryPerformanceCounter(&status->watch.end);
-		const double period = StopWatch_Get(&status->watch);
-		iMaxLength = iStartPos - status->iStartPos;
-		const double durationOne = (EditMarkAll_MeasuredSize * period) / iMaxLength;
-		const double alpha = 0.25;
-		const double duration_ = alpha * durationOne + (1.0 - alpha) * status->duration;
-		const double duration = max_d(duration_, EditMarkAll_MinDuration);
-		const int incrementSize = 1 + (int)(WaitableTimer_IdleTaskTimeSlot / duration);
-		//printf("match %3u (%zd, %zd) length=%.3f / %zd, one=%.3f, duration=%.3f / %.3f, increment=%d\n", EditMarkAll_Runs,
-		//	status->iStartPos, iStartPos, period, iMaxLength, durationOne, duration, duration_, incrementSize);
-		status->incrementSize = incrementSize;
-		status->duration = duration;
+static DWORD WINAPI FindInFilesSearchThread(LPVOID lpParam) {
+	FindInFilesWorker *worker = (FindInFilesWorker *)lpParam;
+	HWND hwndSci = CreateWindowEx(0, L"Scintilla", NULL, 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, g_hInstance, NULL);
+	if (hwndSci == NULL) {
+		return 0;
 	}
 
-	status->pending = pending;
-	status->ignoreSelectionUpdate = matchCount ? (findFlag & NP2_MarkAllSelectAll) : FALSE;
-	status->lastMatchPos = cpMin;
-	status->iStartPos = iStartPos;
-	status->bookmarkLine = bookmarkLine;
-	if (!pending || matchCount != status->matchCount) {
-		status->matchCount = matchCount;
-		UpdateStatusbar();
-		return TRUE;
+	HANDLE hSci = (HANDLE)SendMessage(hwndSci, SCI_GETDIRECTPOINTER, 0, 0);
+	Scintilla_DirectFunction(hSci, SCI_SETCODEPAGE, SC_CP_UTF8, 0);
+	Scintilla_DirectFunction(hSci, SCI_SETUNDOCOLLECTION, FALSE, 0);
+	Scintilla_DirectFunction(hSci, SCI_SETMODEVENTMASK, SC_MOD_NONE, 0);
+	while (BackgroundWorker_Continue(&worker->worker)) {
+		const DWORD index = (DWORD)InterlockedIncrement(&worker->nextPath) - 1;
+		if (index >= worker->pathCount) {
+			break;
+		}
+		FindInFiles_SearchFile(worker, hSci, worker->pszPathBuf + worker->pathOffsets[index]);
+		InterlockedIncrement(&worker->searchedCount);
 	}
-	return FALSE;
+	DestroyWindow(hwndSci);
+	return 0;
 }
 
-BOOL EditMarkAll(BOOL bChanged, BOOL matchCase, BOOL wholeWord, BOOL bookmark) {
-	// get current selection
-	Sci_Position iSelStart = SciCall_GetSelectionStart();
-	const Sci_Position iSelEnd = SciCall_GetSelectionEnd();
-	Sci_Position iSelCount = iSelEnd - iSelStart;
+static DWORD WINAPI FindInFilesThread(LPVOID lpParam) {
+	FindInFilesWorker *worker = (FindInFilesWorker *)lpParam;
+	WCHAR szPath[MAX_PATH];
+	lstrcpy(szPath, worker->szRoot);
+	PathAddBackslash(szPath);
+	if (FindInFiles_ListFiles(worker, szPath, lstrlen(szPath)) && worker->pathCount != 0) {
+		RunOnAllProcessors(FindInFilesSearchThread, worker, worker->pathCount);
+	}
+	// notify search is finished
+	PostMessage(worker->worker.hwnd, APPM_FINDINFILES, 0, 0);
+	return 0;
+}
 
-	// if nothing selected or multiple lines are selected exit
-	if (iSelCount == 0 || SciCall_LineFromPosition(iSelStart) != SciCall_LineFromPosition(iSelEnd)) {
-		EditMarkAll_Clear();
+static void FindInFiles_UpdateStatus(HWND hwnd, const FindInFilesWorker *worker) {
+	WCHAR tchSearched[32];
+	WCHAR tchTotal[32];
+	WCHAR tchHit[32];
+	_ltow(worker->searchedCount, tchSearched, 10);
+	_ltow((LONG)worker->pathCount, tchTotal, 10);
+	_ltow(min_i(worker->hitCount, FIND_IN_FILES_MAX_HIT_COUNT), tchHit, 10);
+	FormatNumberStr(tchSearched);
+	FormatNumberStr(tchTotal);
+	FormatNumberStr(tchHit);
+
+	WCHAR fmt[128];
+	WCHAR tch[256];
+	FormatString(tch, fmt, IDS_FINDINFILES_STATUS, tchSearched, tchTotal, tchHit);
+	SetDlgItemText(hwnd, IDC_FINDINFILES_STATUS, tch);
+}
+
+// stop current search, pending results are discarded.
+static void FindInFiles_Cancel(HWND hwnd, FindInFilesWorker *worker) {
+	BackgroundWorker_Cancel(&worker->worker);
+	KillTimer(hwnd, ID_FINDINFILESTIMER);
+	MSG msg;
+	while (PeekMessage(&msg, hwnd, APPM_FINDINFILES, APPM_FINDINFILES, PM_REMOVE)) {
+		FindInFiles_FreeItems((FindInFilesItem *)msg.lParam);
+	}
+	if (worker->pszPathBuf != NULL) {
+		NP2HeapFree(worker->pszPathBuf);
+	}
+	if (worker->pathOffsets != NULL) {
+		NP2HeapFree(worker->pathOffsets);
+	}
+
+	worker->pszPathBuf = NULL;
+	worker->pathOffsets = NULL;
+	worker->cchPathBuf = 0;
+	worker->cchPathCapacity = 0;
+	worker->pathCount = 0;
+	worker->pathCapacity = 0;
+	worker->nextPath = 0;
+	worker->searchedCount = 0;
+	worker->hitCount = 0;
+	worker->bTruncated = FALSE;
+	EnableWindow(GetDlgItem(hwnd, IDC_FINDINFILES_STOP), FALSE);
+}
+
+static BOOL FindInFiles_Start(HWND hwnd, FindInFilesWorker *worker, LPCEDITFINDREPLACE lpefr) {
+	FindInFiles_Cancel(hwnd, worker);
+	ListView_DeleteAllItems(GetDlgItem(hwnd, IDC_FINDINFILES_RESULT));
+	SetDlgItemText(hwnd, IDC_FINDINFILES_STATUS, L"");
+
+	GetDlgItemText(hwnd, IDC_FINDINFILES_DIR, worker->szRoot, COUNTOF(worker->szRoot));
+	StrTrim(worker->szRoot, L" \"");
+	PathRemoveBackslash(worker->szRoot);
+	if (!PathIsDirectory(worker->szRoot)) {
+		MessageBeep(MB_ICONWARNING);
+		PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetDlgItem(hwnd, IDC_FINDINFILES_DIR)), 1);
 		return FALSE;
 	}
 
-	// scintilla/src/Editor.h SelectionText.LengthWithTerminator()
-	iSelCount = SciCall_GetSelTextLength() - 1;
-	char *pszText = (char *)NP2HeapAlloc(iSelCount + 1);
-	SciCall_GetSelText(pszText);
+	const int searchFlags = EditPrepareFindEx(worker->szFind, lpefr->szFindUTF8, CP_UTF8, lpefr);
+	if (searchFlags == NP2_InvalidSearchFlags) {
+		return FALSE;
+	}
 
-	// exit if selection is not a word and Match whole words only is enabled
-	if (wholeWord) {
-		const UINT cpEdit = SciCall_GetCodePage();
-		const BOOL dbcs = !(cpEdit == CP_UTF8 || cpEdit == 0);
-		// CharClassify::SetDefaultCharClasses()
-		for (iSelStart = 0; iSelStart < iSelCount; ++iSelStart) {
-			const unsigned char ch = pszText[iSelStart];
-			if (dbcs && IsDBCSLeadByteEx(cpEdit, ch)) {
-				++iSelStart;
-			} else if (!(ch >= 0x80 || IsDocWordChar(ch))) {
-				NP2HeapFree(pszText);
-				EditMarkAll_Clear();
-				return FALSE;
+	worker->searchFlags = searchFlags;
+	worker->cchPattern = 0;
+	worker->bPatternCase = (searchFlags & SCFIND_MATCHCASE) != 0;
+	if (!(searchFlags & SCFIND_REGEXP)) {
+		const char *p = worker->szFind;
+		int length = 0;
+		BOOL bASCII = TRUE;
+		while (p[length]) {
+			bASCII &= ((uint8_t)p[length] < 0x80);
+			++length;
+		}
+		if (bASCII || worker->bPatternCase) {
+			for (int i = 0; i <= length; i++) {
+				char ch = p[i];
+				if (!worker->bPatternCase && ch >= 'A' && ch <= 'Z') {
+					ch = ch - 'A' + 'a';
+				}
+				worker->szPattern[i] = ch;
 			}
+			worker->cchPattern = length;
 		}
 	}
-	if (!matchCase) {
-		const BOOL sensitive = IsStringCaseSensitiveA(pszText);
-		//printf("%s sensitive=%d\n", __func__, sensitive);
-		matchCase = sensitive ^ 1;
+
+	GetDlgItemText(hwnd, IDC_FINDINFILES_FILTER, tchFindInFilesFilter, COUNTOF(tchFindInFilesFilter));
+	bFindInFilesSubfolders = IsButtonChecked(hwnd, IDC_FINDINFILES_SUBDIR);
+	FindInFiles_InitFilter(worker, tchFindInFilesFilter);
+
+	const UINT uFlags = mEncoding[iDefaultEncoding].uFlags;
+	worker->cpAnsi = (uFlags & (NCP_8BIT | NCP_7BIT)) ? mEncoding[iDefaultEncoding].uCodePage : CP_ACP;
+	worker->cchRoot = lstrlen(worker->szRoot) + 1;
+	worker->bSubfolders = bFindInFilesSubfolders;
+	worker->bLargeFetch = IsWin7AndAbove();
+	// access to view of a file on disconnected network share raises EXCEPTION_IN_PAGE_ERROR.
+	worker->bMapFile = !PathIsNetworkPath(worker->szRoot);
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	worker->dwPageSize = info.dwPageSize;
+
+	if (!BackgroundWorker_Start(&worker->worker, FindInFilesThread, worker, WorkerPriority_Normal)) {
+		return FALSE;
 	}
 
-	const int findFlag = (matchCase * SCFIND_MATCHCASE)
-		| (wholeWord * SCFIND_WHOLEWORD)
-		| (bookmark * NP2_MarkAllBookmark);
-	return EditMarkAll_Start(bChanged, findFlag, iSelCount, pszText);
+	EnableWindow(GetDlgItem(hwnd, IDC_FINDINFILES_STOP), TRUE);
+	SetTimer(hwnd, ID_FINDINFILESTIMER, 250, NULL);
+	return TRUE;
 }
 
-void EditFindAll(LPCEDITFINDREPLACE lpefr, BOOL selectAll) {
-	char *szFind2 = (char *)NP2HeapAlloc(NP2_FIND_REPLACE_LIMIT);
-	int searchFlags = EditPrepareFind(szFind2, lpefr);
-	if (searchFlags == NP2_InvalidSearchFlags) {
-		NP2HeapFree(szFind2);
+static void FindInFiles_OpenItem(HWND hwnd) {
+	HWND hwndLV = GetDlgItem(hwnd, IDC_FINDINFILES_RESULT);
+	LV_ITEM lvi;
+	ZeroMemory(&lvi, sizeof(LV_ITEM));
+	lvi.mask = LVIF_PARAM;
+	lvi.iItem = ListView_GetNextItem(hwndLV, -1, LVNI_ALL | LVNI_SELECTED);
+	if (lvi.iItem < 0 || !ListView_GetItem(hwndLV, &lvi)) {
 		return;
 	}
 
-	searchFlags |= (bFindReplaceFindAllBookmark * NP2_MarkAllBookmark)
-		| (selectAll * NP2_MarkAllSelectAll)
-		| NP2_FromFindAll;
-	// rewind start position when transform backslash is checked,
-	// all other searching doesn't across lines.
-	// NOTE: complex fix is needed when multiline regex is supported.
-	if (lpefr->bTransformBS && strpbrk(szFind2, "\r\n") != NULL) {
-		searchFlags |= NP2_MarkAllMultiline;
-	}
-	EditMarkAll_Start(FALSE, searchFlags, strlen(szFind2), szFind2);
-}
-
-void EditToggleBookmarkAt(Sci_Position iPos) {
-	if (iPos < 0) {
-		iPos = SciCall_GetCurrentPos();
+	const FindInFilesItem *item = (const FindInFilesItem *)lvi.lParam;
+	if (!StrCaseEqual(item->pszPath, szCurFile)) {
+		if (!FileLoad(FALSE, FALSE, FALSE, FALSE, item->pszPath)) {
+			return;
+		}
 	}
 
-	const Sci_Line iLine = SciCall_LineFromPosition(iPos);
-	const Sci_MarkerMask bitmask = SciCall_MarkerGet(iLine);
-	if (bitmask & MarkerBitmask_Bookmark) {
-		SciCall_MarkerDelete(iLine, MarkerNumber_Bookmark);
-	} else {
-		Style_SetBookmark();
-		SciCall_MarkerAdd(iLine, MarkerNumber_Bookmark);
+	EditJumpTo(item->line + 1, 1);
+	if (item->line < SciCall_GetLineCount()) {
+		// the file is loaded as UTF-8 or ANSI, match position is restored from character offsets.
+		const Sci_Position iLineStart = SciCall_PositionFromLine(item->line);
+		const Sci_Position iStart = SciCall_PositionRelative(iLineStart, item->column);
+		const Sci_Position iEnd = SciCall_PositionRelative(iStart, item->length);
+		if (iStart >= iLineStart && iEnd >= iStart) {
+			EditSelectEx(iStart, iEnd);
+		}
 	}
 }
 
-void EditBookmarkSelectAll(void) {
-	Sci_Line line = SciCall_MarkerNext(0, MarkerBitmask_Bookmark);
-	if (line >= 0) {
-		editMarkAllStatus.ignoreSelectionUpdate = TRUE;
-		const Sci_Line iCurLine = SciCall_LineFromPosition(SciCall_GetCurrentPos());
-		SciCall_SetSelection(SciCall_PositionFromLine(line), SciCall_PositionFromLine(line + 1));
-		// set main selection near current line to ensure caret is visible after delete selected lines.
-		size_t main = 0;
-		size_t selection = 0;
-		Sci_Line minDiff = abs_pos(line - iCurLine);
-		while ((line = SciCall_MarkerNext(line + 1, MarkerBitmask_Bookmark)) >= 0) {
-			SciCall_AddSelection(SciCall_PositionFromLine(line), SciCall_PositionFromLine(line + 1));
-			++selection;
-			const Sci_Line diff = abs_pos(line - iCurLine);
-			if (diff < minDiff) {
-				minDiff = diff;
-				main = selection;
-			}
+static INT_PTR CALLBACK EditFindInFilesDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
+	WCHAR tch[NP2_FIND_REPLACE_LIMIT + 32];
+
+	switch (umsg) {
+	case WM_INITDIALOG: {
+		SetWindowLongPtr(hwnd, DWLP_USER, lParam);
+		ResizeDlg_Init(hwnd, cxFindInFilesDlg, cyFindInFilesDlg, IDC_RESIZEGRIP);
+
+		FindInFilesWorker *worker = (FindInFilesWorker *)NP2HeapAlloc(sizeof(FindInFilesWorker));
+		SetProp(hwnd, L"it", (HANDLE)worker);
+		BackgroundWorker_Init(&worker->worker, hwnd);
+
+		HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+		AddBackslashComboBoxSetup(hwnd, IDC_FINDTEXT);
+		for (int i = 0; i < MRU_GetCount(mruFind); i++) {
+			MRU_Enum(mruFind, i, tch, COUNTOF(tch));
+			ComboBox_AddString(hwndFind, tch);
+		}
+
+		LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)lParam;
+		CopySelectionAsFindText(hwnd, lpefr, FALSE);
+		if (!GetWindowTextLength(hwndFind)) {
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
+		}
+		ComboBox_LimitText(hwndFind, NP2_FIND_REPLACE_LIMIT);
+		ComboBox_SetExtendedUI(hwndFind, TRUE);
+
+		if (lpefr->fuFlags & SCFIND_MATCHCASE) {
+			CheckDlgButton(hwnd, IDC_FINDCASE, BST_CHECKED);
+		}
+		if (lpefr->fuFlags & SCFIND_WHOLEWORD) {
+			CheckDlgButton(hwnd, IDC_FINDWORD, BST_CHECKED);
+		}
+		if (lpefr->fuFlags & SCFIND_REGEXP) {
+			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_CHECKED);
+		}
+		if (lpefr->bTransformBS) {
+			CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_CHECKED);
+		}
+		if (lpefr->bWildcardSearch) {
+			CheckDlgButton(hwnd, IDC_WILDCARDSEARCH, BST_CHECKED);
+			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
+		}
+
+		// search in directory of current file
+		if (StrNotEmpty(szCurFile)) {
+			lstrcpy(tch, szCurFile);
+			PathRemoveFileSpec(tch);
+		} else {
+			GetCurrentDirectory(COUNTOF(tch), tch);
+		}
+		SetDlgItemText(hwnd, IDC_FINDINFILES_DIR, tch);
+		SHAutoComplete(GetDlgItem(hwnd, IDC_FINDINFILES_DIR), SHACF_FILESYS_DIRS);
+		SetDlgItemText(hwnd, IDC_FINDINFILES_FILTER, tchFindInFilesFilter);
+		if (bFindInFilesSubfolders) {
+			CheckDlgButton(hwnd, IDC_FINDINFILES_SUBDIR, BST_CHECKED);
 		}
-		SciCall_SetMainSelection(main);
-	}
-}
 
-static void ShwowReplaceCount(Sci_Position iCount) {
-	if (iCount > 0) {
-		WCHAR tchNum[32];
-		PosToStrW(iCount, tchNum);
-		FormatNumberStr(tchNum);
-		InfoBoxInfo(MB_OK, L"MsgReplaceCount", IDS_REPLCOUNT, tchNum);
-	} else {
-		InfoBoxWarn(MB_OK, L"MsgNotFound", IDS_NOTFOUND);
-	}
-}
+		HWND hwndLV = GetDlgItem(hwnd, IDC_FINDINFILES_RESULT);
+		InitWindowCommon(hwndLV);
+		ListView_SetExtendedListViewStyle(hwndLV, LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER | LVS_EX_LABELTIP);
+		LVCOLUMN lvc = { LVCF_FMT | LVCF_TEXT, LVCFMT_LEFT, 0, NULL, -1, 0, 0, 0
+#if (NTDDI_VERSION >= NTDDI_VISTA)
+			, 0, 0, 0
+#endif
+		};
+		ListView_InsertColumn(hwndLV, 0, &lvc);
+		ListView_SetColumnWidth(hwndLV, 0, LVSCW_AUTOSIZE_USEHEADER);
 
-//=============================================================================
-//
-// EditReplaceAll()
-//
-BOOL EditReplaceAll(HWND hwnd, LPCEDITFINDREPLACE lpefr, BOOL bShowInfo) {
-	BOOL bReplaceRE;
-	char szFind2[NP2_FIND_REPLACE_LIMIT];
-	char *pszReplace2;
-	const int searchFlags = EditPrepareReplace(hwnd, szFind2, &pszReplace2, &bReplaceRE, lpefr);
-	if (searchFlags == NP2_InvalidSearchFlags) {
-		return FALSE;
+		PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)hwndFind, 1);
+		CenterDlgInParent(hwnd);
 	}
+	return TRUE;
 
-	// Show wait cursor...
-	BeginWaitCursor();
-	SendMessage(hwnd, WM_SETREDRAW, FALSE, 0);
+	case WM_DESTROY: {
+		FindInFilesWorker *worker = (FindInFilesWorker *)GetProp(hwnd, L"it");
+		FindInFiles_Cancel(hwnd, worker);
+		ListView_DeleteAllItems(GetDlgItem(hwnd, IDC_FINDINFILES_RESULT));
+		BackgroundWorker_Destroy(&worker->worker);
+		RemoveProp(hwnd, L"it");
+		NP2HeapFree(worker);
 
-	const BOOL bRegexStartOfLine = bReplaceRE && (szFind2[0] == '^');
-	struct Sci_TextToFind ttf = { { 0, SciCall_GetLength() }, szFind2, { 0, 0 } };
-	Sci_Position iCount = 0;
-	while (SciCall_FindText(searchFlags, &ttf) >= 0) {
-		if (++iCount == 1) {
-			SciCall_BeginUndoAction();
-		}
+		GetDlgItemText(hwnd, IDC_FINDINFILES_FILTER, tchFindInFilesFilter, COUNTOF(tchFindInFilesFilter));
+		bFindInFilesSubfolders = IsButtonChecked(hwnd, IDC_FINDINFILES_SUBDIR);
+		ResizeDlg_Destroy(hwnd, &cxFindInFilesDlg, &cyFindInFilesDlg);
+		hDlgFindInFiles = NULL;
+	}
+	return FALSE;
 
-		SciCall_SetTargetRange(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
-		const Sci_Position iReplacedLen = SciCall_ReplaceTargetEx(bReplaceRE, -1, pszReplace2);
+	case WM_SIZE: {
+		int dx;
+		int dy;
 
-		ttf.chrg.cpMin = (ttf.chrgText.cpMin + iReplacedLen);
-		ttf.chrg.cpMax = SciCall_GetLength();
+		ResizeDlg_Size(hwnd, lParam, &dx, &dy);
+		HDWP hdwp = BeginDeferWindowPos(11);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_RESIZEGRIP, dx, dy, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDOK, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDINFILES_STOP, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDCANCEL, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDTEXT, dx, 0, SWP_NOMOVE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_CLEAR_FIND, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDINFILES_DIR, dx, 0, SWP_NOMOVE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDINFILES_BROWSE, dx, 0, SWP_NOSIZE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDINFILES_FILTER, dx, 0, SWP_NOMOVE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDINFILES_RESULT, dx, dy, SWP_NOMOVE);
+		hdwp = DeferCtlPos(hdwp, hwnd, IDC_FINDINFILES_STATUS, 0, dy, SWP_NOSIZE);
+		EndDeferWindowPos(hdwp);
+		ListView_SetColumnWidth(GetDlgItem(hwnd, IDC_FINDINFILES_RESULT), 0, LVSCW_AUTOSIZE_USEHEADER);
+	}
+	return TRUE;
 
-		if (ttf.chrg.cpMin == ttf.chrg.cpMax) {
-			break;
-		}
+	case WM_GETMINMAXINFO:
+		ResizeDlg_GetMinMaxInfo(hwnd, lParam);
+		return TRUE;
 
-		if (ttf.chrgText.cpMin == ttf.chrgText.cpMax && !bRegexStartOfLine) {
-			// move to next line after the replacement.
-			ttf.chrg.cpMin = SciCall_PositionAfter(ttf.chrg.cpMin);
+	case WM_TIMER:
+		if (wParam == ID_FINDINFILESTIMER) {
+			FindInFiles_UpdateStatus(hwnd, (const FindInFilesWorker *)GetProp(hwnd, L"it"));
 		}
+		return TRUE;
 
-		if (bRegexStartOfLine) {
-			const Sci_Line iLine = SciCall_LineFromPosition(ttf.chrg.cpMin);
-			const Sci_Position ilPos = SciCall_PositionFromLine(iLine);
-
-			if (ilPos == ttf.chrg.cpMin) {
-				ttf.chrg.cpMin = SciCall_PositionFromLine(iLine + 1);
+	case APPM_FINDINFILES: {
+		FindInFilesItem *item = (FindInFilesItem *)lParam;
+		if (item != NULL) {
+			HWND hwndLV = GetDlgItem(hwnd, IDC_FINDINFILES_RESULT);
+			LV_ITEM lvi;
+			ZeroMemory(&lvi, sizeof(LV_ITEM));
+			lvi.mask = LVIF_TEXT | LVIF_PARAM;
+			lvi.pszText = LPSTR_TEXTCALLBACK;
+			lvi.iItem = ListView_GetItemCount(hwndLV);
+			while (item != NULL) {
+				// item is freed by LVN_DELETEITEM
+				FindInFilesItem *next = item->next;
+				lvi.lParam = (LPARAM)item;
+				if (ListView_InsertItem(hwndLV, &lvi) < 0) {
+					NP2HeapFree(item);
+				}
+				++lvi.iItem;
+				item = next;
 			}
-			if (ttf.chrg.cpMin == ttf.chrg.cpMax) {
-				break;
+		} else {
+			const FindInFilesWorker *worker = (const FindInFilesWorker *)GetProp(hwnd, L"it");
+			KillTimer(hwnd, ID_FINDINFILESTIMER);
+			EnableWindow(GetDlgItem(hwnd, IDC_FINDINFILES_STOP), FALSE);
+			FindInFiles_UpdateStatus(hwnd, worker);
+			if (worker->bTruncated || ListView_GetItemCount(GetDlgItem(hwnd, IDC_FINDINFILES_RESULT)) == 0) {
+				MessageBeep(MB_ICONWARNING);
 			}
 		}
 	}
+	return TRUE;
 
-	SendMessage(hwnd, WM_SETREDRAW, TRUE, 0);
-	if (iCount) {
-		SciCall_EndUndoAction();
-		RedrawWindow(hwnd, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
-	}
+	case WM_COMMAND:
+		switch (LOWORD(wParam)) {
+		case IDC_FINDTEXT:
+			EnableWindow(GetDlgItem(hwnd, IDOK), ComboBox_HasText(GetDlgItem(hwnd, IDC_FINDTEXT)));
+			if (HIWORD(wParam) == CBN_CLOSEUP) {
+				HWND hwndCtl = GetDlgItem(hwnd, IDC_FINDTEXT);
+				const DWORD lSelEnd = ComboBox_GetEditSelEnd(hwndCtl);
+				ComboBox_SetEditSel(hwndCtl, lSelEnd, lSelEnd);
+			}
+			break;
 
-	// Remove wait cursor
-	EndWaitCursor();
+		case IDC_FINDREGEXP:
+			if (IsButtonChecked(hwnd, IDC_FINDREGEXP)) {
+				CheckDlgButton(hwnd, IDC_FINDTRANSFORMBS, BST_UNCHECKED);
+				CheckDlgButton(hwnd, IDC_WILDCARDSEARCH, BST_UNCHECKED);
+			}
+			break;
 
-	if (bShowInfo) {
-		ShwowReplaceCount(iCount);
-	}
+		case IDC_FINDTRANSFORMBS:
+			if (IsButtonChecked(hwnd, IDC_FINDTRANSFORMBS)) {
+				CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
+			}
+			break;
 
-	LocalFree(pszReplace2);
-	return TRUE;
-}
+		case IDC_WILDCARDSEARCH:
+			CheckDlgButton(hwnd, IDC_FINDREGEXP, BST_UNCHECKED);
+			break;
 
-//=============================================================================
-//
-// EditReplaceAllInSelection()
-//
-BOOL EditReplaceAllInSelection(HWND hwnd, LPCEDITFINDREPLACE lpefr, BOOL bShowInfo) {
-	if (SciCall_IsRectangleSelection()) {
-		NotifyRectangleSelection();
-		return FALSE;
-	}
+		case IDC_FINDINFILES_BROWSE:
+			GetDlgItemText(hwnd, IDC_FINDINFILES_DIR, tch, MAX_PATH);
+			if (GetDirectory(hwnd, IDS_FINDINFILES_DIR, tch, tch)) {
+				SetDlgItemText(hwnd, IDC_FINDINFILES_DIR, tch);
+			}
+			break;
 
-	BOOL bReplaceRE;
-	char szFind2[NP2_FIND_REPLACE_LIMIT];
-	char *pszReplace2;
-	const int searchFlags = EditPrepareReplace(hwnd, szFind2, &pszReplace2, &bReplaceRE, lpefr);
-	if (searchFlags == NP2_InvalidSearchFlags) {
-		return FALSE;
-	}
+		case IDOK: {
+			// Enter on result list opens the selected match
+			if (GetFocus() == GetDlgItem(hwnd, IDC_FINDINFILES_RESULT)) {
+				FindInFiles_OpenItem(hwnd);
+				break;
+			}
 
-	// Show wait cursor...
-	BeginWaitCursor();
-	SendMessage(hwnd, WM_SETREDRAW, FALSE, 0);
+			LPEDITFINDREPLACE lpefr = (LPEDITFINDREPLACE)GetWindowLongPtr(hwnd, DWLP_USER);
+			HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+			const UINT cpEdit = SciCall_GetCodePage();
+			cpLastFind = cpEdit;
+			if (!GetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8, COUNTOF(lpefr->szFindUTF8))) {
+				EnableWindow(GetDlgItem(hwnd, IDOK), FALSE);
+				break;
+			}
+			GetDlgItemTextA2W(cpEdit, hwnd, IDC_FINDTEXT, lpefr->szFind, COUNTOF(lpefr->szFind));
 
-	const BOOL bRegexStartOfLine = bReplaceRE && (szFind2[0] == '^');
-	struct Sci_TextToFind ttf = { { SciCall_GetSelectionStart(), SciCall_GetLength() }, szFind2, { 0, 0 } };
-	Sci_Position iCount = 0;
-	BOOL fCancel = FALSE;
-	while (!fCancel && SciCall_FindText(searchFlags, &ttf) >= 0) {
-		if (ttf.chrgText.cpMin >= SciCall_GetSelectionStart() && ttf.chrgText.cpMax <= SciCall_GetSelectionEnd()) {
-			if (++iCount == 1) {
-				SciCall_BeginUndoAction();
+			lpefr->bWildcardSearch = IsButtonChecked(hwnd, IDC_WILDCARDSEARCH);
+			lpefr->bTransformBS = IsButtonChecked(hwnd, IDC_FINDTRANSFORMBS);
+			lpefr->fuFlags = 0;
+			if (IsButtonChecked(hwnd, IDC_FINDCASE)) {
+				lpefr->fuFlags |= SCFIND_MATCHCASE;
+			}
+			if (IsButtonChecked(hwnd, IDC_FINDWORD)) {
+				lpefr->fuFlags |= SCFIND_WHOLEWORD;
+			}
+			if (IsButtonChecked(hwnd, IDC_FINDREGEXP)) {
+				lpefr->fuFlags |= SCFIND_REGEXP | SCFIND_POSIX;
 			}
 
-			SciCall_SetTargetRange(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
-			const Sci_Position iReplacedLen = SciCall_ReplaceTargetEx(bReplaceRE, -1, pszReplace2);
+			// Save MRUs
+			ComboBox_GetText(hwndFind, tch, COUNTOF(tch));
+			MRU_AddMultiline(mruFind, tch);
+			ComboBox_ResetContent(hwndFind);
+			for (int i = 0; i < MRU_GetCount(mruFind); i++) {
+				MRU_Enum(mruFind, i, tch, COUNTOF(tch));
+				ComboBox_AddString(hwndFind, tch);
+			}
+			SetDlgItemTextA2W(CP_UTF8, hwnd, IDC_FINDTEXT, lpefr->szFindUTF8);
 
-			ttf.chrg.cpMin = (ttf.chrgText.cpMin + iReplacedLen);
-			ttf.chrg.cpMax = SciCall_GetLength();
+			FindInFilesWorker *worker = (FindInFilesWorker *)GetProp(hwnd, L"it");
+			FindInFiles_Start(hwnd, worker, lpefr);
+		}
+		break;
 
-			if (ttf.chrg.cpMin == ttf.chrg.cpMax) {
-				fCancel = TRUE;
-			}
+		case IDC_FINDINFILES_STOP: {
+			FindInFilesWorker *worker = (FindInFilesWorker *)GetProp(hwnd, L"it");
+			SetEvent(worker->worker.eventCancel);
+		}
+		break;
 
-			if (ttf.chrgText.cpMin == ttf.chrgText.cpMax && !bRegexStartOfLine) {
-				// move to next line after the replacement.
-				ttf.chrg.cpMin = SciCall_PositionAfter(ttf.chrg.cpMin);
-			}
+		case IDCANCEL:
+			DestroyWindow(hwnd);
+			break;
+		}
+		return TRUE;
 
-			if (bRegexStartOfLine) {
-				const Sci_Line iLine = SciCall_LineFromPosition(ttf.chrg.cpMin);
-				const Sci_Position ilPos = SciCall_PositionFromLine(iLine);
+	case WM_NOTIFY: {
+		LPNMHDR pnmhdr = (LPNMHDR)lParam;
+		if (pnmhdr->idFrom == IDC_FINDINFILES_RESULT) {
+			switch (pnmhdr->code) {
+			case NM_DBLCLK:
+				FindInFiles_OpenItem(hwnd);
+				break;
 
-				if (ilPos == ttf.chrg.cpMin) {
-					ttf.chrg.cpMin = SciCall_PositionFromLine(iLine + 1);
-				}
-				if (ttf.chrg.cpMin == ttf.chrg.cpMax) {
-					break;
+			case LVN_GETDISPINFO: {
+				LV_DISPINFO *lpdi = (LV_DISPINFO *)lParam;
+				if (lpdi->item.mask & LVIF_TEXT) {
+					const FindInFilesItem *item = (const FindInFilesItem *)lpdi->item.lParam;
+					wsprintf(tch, L"%s(%d): %s", item->pszPath + item->cchRoot, (int)(item->line + 1), item->pszText);
+					lstrcpyn(lpdi->item.pszText, tch, lpdi->item.cchTextMax);
 				}
 			}
-		} else { // gone across selection, cancel
-			fCancel = TRUE;
-		}
-	}
+			break;
 
-	SendMessage(hwnd, WM_SETREDRAW, TRUE, 0);
-	if (iCount) {
-		const Sci_Position iPos = SciCall_GetTargetEnd();
-		if (SciCall_GetSelectionEnd() <	iPos) {
-			Sci_Position iAnchorPos = SciCall_GetAnchor();
-			Sci_Position iCurrentPos = SciCall_GetCurrentPos();
+			case LVN_DELETEALLITEMS:
+				// LVN_DELETEITEM is required to free each item
+				SetWindowLongPtr(hwnd, DWLP_MSGRESULT, FALSE);
+				break;
 
-			if (iAnchorPos > iCurrentPos) {
-				iAnchorPos = iPos;
-			} else {
-				iCurrentPos = iPos;
+			case LVN_DELETEITEM: {
+				LPNMLISTVIEW pnmlv = (LPNMLISTVIEW)lParam;
+				NP2HeapFree((FindInFilesItem *)pnmlv->lParam);
 			}
-
-			EditSelectEx(iAnchorPos, iCurrentPos);
+			break;
+			}
+		} else if (pnmhdr->idFrom == IDC_CLEAR_FIND && (pnmhdr->code == NM_CLICK || pnmhdr->code == NM_RETURN)) {
+			HWND hwndFind = GetDlgItem(hwnd, IDC_FINDTEXT);
+			ComboBox_GetText(hwndFind, tch, COUNTOF(tch));
+			ComboBox_ResetContent(hwndFind);
+			MRU_Empty(mruFind);
+			MRU_Save(mruFind);
+			ComboBox_SetText(hwndFind, tch);
 		}
-
-		SciCall_EndUndoAction();
-		RedrawWindow(hwnd, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_FRAME | RDW_ALLCHILDREN);
+	}
+	return TRUE;
 	}
 
-	// Remove wait cursor
-	EndWaitCursor();
+	return FALSE;
+}
 
-	if (bShowInfo) {
-		ShwowReplaceCount(iCount);
-	}
+HWND EditFindInFilesDlg(HWND hwnd, LPEDITFINDREPLACE lpefr) {
+	HWND hDlg = CreateThemedDialogParam(g_hInstance,
+								   MAKEINTRESOURCE(IDD_FINDINFILES),
+								   GetParent(hwnd),
+								   EditFindInFilesDlgProc,
+								   (LPARAM)lpefr);
 
-	LocalFree(pszReplace2);
-	return TRUE;
+	ShowWindow(hDlg, SW_SHOW);
+	return hDlg;
 }
 
 //=============================================================================
@@ -6367,6 +10878,75 @@ BOOL EditLineNumDlg(HWND hwnd) {
 	return iResult == IDOK;
 }
 
+//=============================================================================
+//
+// EditOpenRangeDlgProc()
+//
+static INT_PTR CALLBACK EditOpenRangeDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
+	switch (umsg) {
+	case WM_INITDIALOG: {
+		SetWindowLongPtr(hwnd, DWLP_USER, lParam);
+		const EditFileRange * const range = (const EditFileRange *)lParam;
+		CheckRadioButton(hwnd, IDC_OPENRANGE_LINES, IDC_OPENRANGE_BYTES, range->bLines ? IDC_OPENRANGE_LINES : IDC_OPENRANGE_BYTES);
+
+		WCHAR tch[32];
+		_i64tow(range->start, tch, 10);
+		SetDlgItemText(hwnd, IDC_OPENRANGE_FROM, tch);
+		if (range->end > 0) {
+			_i64tow(range->end, tch, 10);
+			SetDlgItemText(hwnd, IDC_OPENRANGE_TO, tch);
+		}
+		CenterDlgInParent(hwnd);
+	}
+	return TRUE;
+
+	case WM_COMMAND:
+		switch (LOWORD(wParam)) {
+		case IDOK: {
+			const BOOL bLines = IsButtonChecked(hwnd, IDC_OPENRANGE_LINES);
+			WCHAR tch[32];
+			int64_t start = 0;
+			int64_t end = 0;
+			GetDlgItemText(hwnd, IDC_OPENRANGE_FROM, tch, COUNTOF(tch));
+			if (!CRTStrToInt64(tch, &start) || start < (bLines ? 1 : 0)) {
+				PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetDlgItem(hwnd, IDC_OPENRANGE_FROM)), 1);
+				return TRUE;
+			}
+			// empty for end of file
+			GetDlgItemText(hwnd, IDC_OPENRANGE_TO, tch, COUNTOF(tch));
+			if (StrNotEmpty(tch) && (!CRTStrToInt64(tch, &end) || end < start)) {
+				PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetDlgItem(hwnd, IDC_OPENRANGE_TO)), 1);
+				return TRUE;
+			}
+
+			EditFileRange * const range = (EditFileRange *)GetWindowLongPtr(hwnd, DWLP_USER);
+			range->bLines = bLines;
+			range->start = start;
+			range->end = end;
+			EndDialog(hwnd, IDOK);
+		}
+		break;
+
+		case IDCANCEL:
+			EndDialog(hwnd, IDCANCEL);
+			break;
+		}
+
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+//=============================================================================
+//
+// EditOpenRangeDlg()
+//
+BOOL EditOpenRangeDlg(HWND hwnd, EditFileRange *range) {
+	const INT_PTR iResult = ThemedDialogBoxParam(g_hInstance, MAKEINTRESOURCE(IDD_OPENRANGE), hwnd, EditOpenRangeDlgProc, (LPARAM)range);
+	return iResult == IDOK;
+}
+
 //=============================================================================
 //
 // EditModifyLinesDlg()
@@ -7037,6 +11617,34 @@ static INT_PTR CALLBACK EditSortDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPA
 			*piSortFlags |= SORT_COLUMN;
 			CheckDlgButton(hwnd, IDC_SORT_COLUMN, BST_CHECKED);
 		}
+
+		WCHAR tch[256];
+		for (int i = 0; i < 2; i++) {
+			HWND hwndCtl = GetDlgItem(hwnd, IDC_SORT_FIELD_DELIMITER + i);
+			GetDlgItemText(hwnd, IDC_SORT_FIELD_DELIMITER_OPTIONS + i, tch, COUNTOF(tch));
+			lstrcat(tch, L"|");
+			LPWSTR p1 = tch;
+			LPWSTR p2;
+			while ((p2 = StrChr(p1, L'|')) != NULL) {
+				*p2++ = L'\0';
+				if (*p1) {
+					ComboBox_AddString(hwndCtl, p1);
+				}
+				p1 = p2;
+			}
+		}
+
+		const BOOL bSortField = (iSortFlags & SORT_FIELD) != 0;
+		SendDlgItemMessage(hwnd, IDC_SORT_FIELD_DELIMITER, CB_SETCURSEL, (iSortFlags >> SORT_FIELD_DELIMITER_SHIFT) & SORT_FIELD_DELIMITER_MASK, 0);
+		SendDlgItemMessage(hwnd, IDC_SORT_FIELD_TYPE, CB_SETCURSEL, (iSortFlags >> SORT_FIELD_TYPE_SHIFT) & SORT_FIELD_TYPE_MASK, 0);
+		SetDlgItemInt(hwnd, IDC_SORT_FIELD_INDEX, ((iSortFlags >> SORT_FIELD_INDEX_SHIFT) & SORT_FIELD_INDEX_MASK) + 1, FALSE);
+		if (bSortField) {
+			CheckDlgButton(hwnd, IDC_SORT_FIELD, BST_CHECKED);
+			CheckDlgButton(hwnd, IDC_SORT_COLUMN, BST_UNCHECKED);
+		}
+		EnableWindow(GetDlgItem(hwnd, IDC_SORT_FIELD_INDEX), bSortField);
+		EnableWindow(GetDlgItem(hwnd, IDC_SORT_FIELD_DELIMITER), bSortField);
+		EnableWindow(GetDlgItem(hwnd, IDC_SORT_FIELD_TYPE), bSortField);
 		CenterDlgInParent(hwnd);
 	}
 	return TRUE;
@@ -7070,6 +11678,15 @@ static INT_PTR CALLBACK EditSortDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPA
 			if (IsButtonChecked(hwnd, IDC_SORT_COLUMN)) {
 				iSortFlags |= SORT_COLUMN;
 			}
+			if (IsButtonChecked(hwnd, IDC_SORT_FIELD)) {
+				iSortFlags |= SORT_FIELD;
+			}
+			const int iField = (int)GetDlgItemInt(hwnd, IDC_SORT_FIELD_INDEX, NULL, FALSE);
+			const int iDelimiter = (int)SendDlgItemMessage(hwnd, IDC_SORT_FIELD_DELIMITER, CB_GETCURSEL, 0, 0);
+			const int iFieldType = (int)SendDlgItemMessage(hwnd, IDC_SORT_FIELD_TYPE, CB_GETCURSEL, 0, 0);
+			iSortFlags |= (clamp_i(iField, 1, SORT_FIELD_INDEX_MASK + 1) - 1) << SORT_FIELD_INDEX_SHIFT;
+			iSortFlags |= max_i(iDelimiter, 0) << SORT_FIELD_DELIMITER_SHIFT;
+			iSortFlags |= max_i(iFieldType, 0) << SORT_FIELD_TYPE_SHIFT;
 			*piSortFlags = iSortFlags;
 			EndDialog(hwnd, IDOK);
 		}
@@ -7099,6 +11716,19 @@ static INT_PTR CALLBACK EditSortDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPA
 		case IDC_SORT_REMOVE_DUP:
 			EnableWindow(GetDlgItem(hwnd, IDC_SORT_MERGE_DUP), !IsButtonChecked(hwnd, IDC_SORT_REMOVE_DUP));
 			break;
+
+		case IDC_SORT_COLUMN:
+		case IDC_SORT_FIELD: {
+			// column sort and field sort are exclusive
+			if (IsButtonChecked(hwnd, LOWORD(wParam))) {
+				CheckDlgButton(hwnd, (LOWORD(wParam) == IDC_SORT_FIELD) ? IDC_SORT_COLUMN : IDC_SORT_FIELD, BST_UNCHECKED);
+			}
+			const BOOL bSortField = IsButtonChecked(hwnd, IDC_SORT_FIELD);
+			EnableWindow(GetDlgItem(hwnd, IDC_SORT_FIELD_INDEX), bSortField);
+			EnableWindow(GetDlgItem(hwnd, IDC_SORT_FIELD_DELIMITER), bSortField);
+			EnableWindow(GetDlgItem(hwnd, IDC_SORT_FIELD_TYPE), bSortField);
+		}
+		break;
 		}
 		return TRUE;
 	}
@@ -7501,7 +12131,6 @@ void EditOpenSelection(int type) {
 extern BOOL bNoEncodingTags;
 extern int fNoFileVariables;
 extern BOOL fWordWrapG;
-extern int iWordWrapMode;
 extern int iLongLinesLimitG;
 
 void FileVars_Init(LPCSTR lpData, DWORD cbData, LPFILEVARS lpfv) {
@@ -7678,7 +12307,7 @@ void FileVars_Apply(LPFILEVARS lpfv) {
 	SciCall_SetTabIndents(lpfv->bTabIndents);
 	SciCall_SetBackSpaceUnIndents(tabSettings.bBackspaceUnindents);
 
-	SciCall_SetWrapMode(lpfv->fWordWrap ? iWordWrapMode : SC_WRAP_NONE);
+	SciCall_SetWrapMode((lpfv->fWordWrap && !bLargeFileProfile) ? iWordWrapMode : SC_WRAP_NONE);
 	EditSetWrapIndentMode(lpfv->iTabWidth, lpfv->iIndentWidth);
 
 	SciCall_SetEdgeColumn(lpfv->iLongLinesLimit);
@@ -62,6 +62,28 @@ typedef const EDITFINDREPLACE * LPCEDITFINDREPLACE;
 #define SORT_NOCASE			32
 #define SORT_LOGICAL		64
 #define SORT_COLUMN			128
+#define SORT_FIELD			256
+// field sort options: delimiter, key type and zero based field index
+#define SORT_FIELD_DELIMITER_SHIFT	9
+#define SORT_FIELD_DELIMITER_MASK	7
+#define SORT_FIELD_TYPE_SHIFT		12
+#define SORT_FIELD_TYPE_MASK		3
+#define SORT_FIELD_INDEX_SHIFT		16
+#define SORT_FIELD_INDEX_MASK		0x7fff
+
+enum {
+	SortFieldDelimiterAuto = 0,
+	SortFieldDelimiterComma = 1,
+	SortFieldDelimiterTab = 2,
+	SortFieldDelimiterSemicolon = 3,
+	SortFieldDelimiterVerticalBar = 4,
+};
+
+enum {
+	SortFieldTypeText = 0,
+	SortFieldTypeNumber = 1,
+	SortFieldTypeDate = 2,
+};
 
 // wrap indent
 enum {
@@ -108,6 +130,7 @@ static inline void EditSetEmptyText(void) {
 BOOL	EditConvertText(UINT cpSource, UINT cpDest, BOOL bSetSavePoint);
 void	EditConvertToLargeMode(void);
 void	EditReplaceDocument(HANDLE pdoc);
+void	EditApplyLargeFileProfile(void);
 
 char*	EditGetClipboardText(HWND hwnd); // LocalFree()
 BOOL	EditCopyAppend(HWND hwnd);
@@ -119,8 +142,37 @@ static inline int GetScintillaEOLMode(int mode) {
 
 struct EditFileIOStatus;
 void 	EditDetectEOLMode(LPCSTR lpData, DWORD cbData, struct EditFileIOStatus *status);
+size_t	EditCountLineEnds(LPCSTR lpData, DWORD cbData);
+void	EditSetEOLModeFromLineCount(struct EditFileIOStatus *status, size_t lineCountCRLF, size_t lineCountLF, size_t lineCountCR);
 BOOL	EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, struct EditFileIOStatus *status);
+
+// part of a file, lines are 1-based with inclusive end, bytes are 0-based with exclusive end.
+typedef struct EditFileRange {
+	BOOL bLines;
+	LONGLONG start;
+	LONGLONG end;	// 0 for end of file
+} EditFileRange;
+
+// range is updated to the loaded part.
+BOOL	EditLoadFileRange(LPCWSTR pszFile, EditFileRange *range, struct EditFileIOStatus *status);
+BOOL	EditOpenRangeDlg(HWND hwnd, EditFileRange *range);
 BOOL	EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, struct EditFileIOStatus *status);
+BOOL	EditLoadFileTail(LPCWSTR pszFile, int iEncoding);
+
+// text read from stdin or a named pipe is appended to the document as it arrives.
+enum {
+	PipeSourceState_None = 0,
+	PipeSourceState_Data = 1,
+	PipeSourceState_BOM = 2,		// UTF-8 signature is skipped
+	PipeSourceState_ANSI = 4,		// invalid UTF-8 found, switched to ANSI code page
+	PipeSourceState_Finished = 8,
+	PipeSourceState_Failed = 16,
+};
+
+BOOL	EditPipeSource_Start(HWND hwnd, HANDLE hPipe, BOOL bClosePipe, BOOL bCheckUTF8);
+void	EditPipeSource_Stop(void);
+BOOL	EditPipeSource_IsActive(void);
+UINT	EditPipeSource_OnData(WPARAM wParam, LPARAM lParam, BOOL bSavePoint);
 
 void	EditInvertCase(void);
 void	EditMapTextCase(int menu);
@@ -128,10 +180,11 @@ void	EditSentenceCase(void);
 
 void	EditURLEncode(void);
 void	EditURLDecode(void);
-void	EditEscapeCChars(HWND hwnd);
-void	EditUnescapeCChars(HWND hwnd);
-void	EditEscapeXHTMLChars(HWND hwnd);
-void	EditUnescapeXHTMLChars(HWND hwnd);
+void	EditEscapeCChars(void);
+void	EditUnescapeCChars(void);
+void	EditEscapeXHTMLChars(void);
+void	EditUnescapeXHTMLChars(void);
+void	EditFormatJSON(BOOL bMinify);
 void	EditChar2Hex(void);
 void	EditHex2Char(void);
 void	EditShowHex(void);
@@ -147,13 +200,14 @@ void	EditModifyLines(LPCWSTR pwszPrefix, LPCWSTR pwszAppend);
 void	EditAlignText(int nMode);
 void	EditEncloseSelection(LPCWSTR pwszOpen, LPCWSTR pwszClose);
 void	EditToggleLineComments(LPCWSTR pwszComment, BOOL bInsertAtStart);
-void	EditPadWithSpaces(BOOL bSkipEmpty, BOOL bNoUndoGroup);
+void	EditPadWithSpaces(BOOL bSkipEmpty);
 void	EditStripFirstCharacter(void);
 void	EditStripLastCharacter(void);
-void	EditStripTrailingBlanks(HWND hwnd, BOOL bIgnoreSelection);
-void	EditStripLeadingBlanks(HWND hwnd, BOOL bIgnoreSelection);
+void	EditStripTrailingBlanks(BOOL bIgnoreSelection);
+void	EditStripLeadingBlanks(BOOL bIgnoreSelection);
 void	EditCompressSpaces(void);
 void	EditRemoveBlankLines(BOOL bMerge);
+void	EditRemoveDuplicateLines(BOOL bIgnoreCase);
 void	EditWrapToColumn(int nColumn/*, int nTabWidth*/);
 void	EditJoinLinesEx(void);
 void	EditSortLines(int iSortFlags);
@@ -167,11 +221,18 @@ void	EditGetExcerpt(LPWSTR lpszExcerpt, DWORD cchExcerpt);
 
 void	EditSelectWord(void);
 void	EditSelectLines(BOOL currentBlock, BOOL lineSelection);
+void	EditSelectTagContents(void);
+// start of the tag paired with the start or end tag containing iPos.
+Sci_Position EditFindMatchingTag(Sci_Position iPos, Sci_Position *piTag);
 HWND	EditFindReplaceDlg(HWND hwnd, LPEDITFINDREPLACE lpefr, BOOL bReplace);
+HWND	EditFindInFilesDlg(HWND hwnd, LPEDITFINDREPLACE lpefr);
 void	EditFindNext(LPCEDITFINDREPLACE lpefr, BOOL fExtendSelection);
 void	EditFindPrev(LPCEDITFINDREPLACE lpefr, BOOL fExtendSelection);
 void	EditFindAll(LPCEDITFINDREPLACE lpefr, BOOL selectAll);
 BOOL	EditReplace(HWND hwnd, LPCEDITFINDREPLACE lpefr);
+// returns count of replacements, -1 when out of memory (document is unchanged),
+// or negative result of SciCall_FindText() for invalid regular expression.
+Sci_Position EditReplaceAllInRange(int searchFlags, char *szFind2, const char *pszReplace2, BOOL bReplaceRE, Sci_Position iStart, Sci_Position iEnd);
 BOOL	EditReplaceAll(HWND hwnd, LPCEDITFINDREPLACE lpefr, BOOL bShowInfo);
 BOOL	EditReplaceAllInSelection(HWND hwnd, LPCEDITFINDREPLACE lpefr, BOOL bShowInfo);
 BOOL	EditLineNumDlg(HWND hwnd);
@@ -195,6 +256,7 @@ extern "C" {
 
 BOOL	EditPrint(HWND hwnd, LPCWSTR pszDocTitle);
 void	EditPrintSetup(HWND hwnd);
+void	EditPrintInvalidatePages(Sci_Position position);
 
 #ifdef __cplusplus
 }
@@ -202,11 +264,16 @@ void	EditPrintSetup(HWND hwnd);
 
 enum {
 	MarkerNumber_Bookmark = 0,
+	MarkerNumber_DiffAdded = 1,
+	MarkerNumber_DiffChanged = 2,
+	MarkerNumber_DiffRemoved = 3,
 
 	// [0, INDICATOR_CONTAINER) are reserved for lexer.
 	IndicatorNumber_MarkOccurrence = INDICATOR_CONTAINER + 0,
 	IndicatorNumber_MatchBrace = INDICATOR_CONTAINER + 1,
 	IndicatorNumber_MatchBraceError = INDICATOR_CONTAINER + 2,
+	IndicatorNumber_DiffChange = INDICATOR_CONTAINER + 3,
+	IndicatorNumber_MarkTerms = INDICATOR_CONTAINER + 4,
 	// [INDICATOR_IME, INDICATOR_IME_MAX] are reserved for IME.
 
 	MarginNumber_LineNumber = 0,
@@ -214,6 +281,8 @@ enum {
 	MarginNumber_CodeFolding = 2,
 
 	MarkerBitmask_Bookmark = 1 << MarkerNumber_Bookmark,
+	MarkerBitmask_DiffLines = (1 << MarkerNumber_DiffAdded) | (1 << MarkerNumber_DiffChanged),
+	MarkerBitmask_Diff = MarkerBitmask_DiffLines | (1 << MarkerNumber_DiffRemoved),
 };
 
 typedef struct EditMarkAllStatus {
@@ -230,6 +299,13 @@ typedef struct EditMarkAllStatus {
 	Sci_Position iStartPos;		// previous stop position
 	Sci_Line bookmarkLine;		// previous bookmark line
 	StopWatch watch;			// used to dynamic compute increment size
+	// sorted start positions for matches, used to rescan only changed lines.
+	Sci_Position *matchPositions;
+	Sci_Position indexCapacity;	// -1 when match index is disabled
+	Sci_Position docLength;		// document length when match index was updated
+	Sci_Position dirtyStart;	// changed range since last update, -1 when unchanged
+	Sci_Position dirtyEnd;
+	Sci_Position dirtyDelta;	// total length of inserted text minus total length of deleted text
 } EditMarkAllStatus;
 
 void EditMarkAll_ClearEx(int findFlag, Sci_Position iSelCount, LPSTR pszText);
@@ -238,6 +314,11 @@ NP2_inline void EditMarkAll_Clear(void) {
 }
 BOOL EditMarkAll_Start(BOOL bChanged, int findFlag, Sci_Position iSelCount, LPSTR pszText);
 BOOL EditMarkAll_Continue(EditMarkAllStatus *status, HANDLE timer);
+void EditMarkAll_OnModified(EditMarkAllStatus *status, BOOL insert, Sci_Position position, Sci_Position length);
+void EditBeginBulkModification(void);
+void EditEndBulkModification(void);
+void EditOnBulkModified(Sci_Position position, Sci_Position length, Sci_Line linesAdded);
+void EditMarkAll_DiscardIndex(EditMarkAllStatus *status);
 BOOL EditMarkAll(BOOL bChanged, BOOL matchCase, BOOL wholeWord, BOOL bookmark);
 void EditToggleBookmarkAt(Sci_Position iPos);
 void EditBookmarkSelectAll(void);
@@ -291,6 +372,7 @@ typedef struct EditAutoCompletionConfig {
 	UINT dwScanWordsTimeout;
 	BOOL bEnglistIMEModeOnly;
 	BOOL bIgnoreCase;
+	BOOL bFuzzyMatch;
 	BOOL bLaTeXInputMethod;
 	UINT iVisibleItemCount;
 	int iMinWordLength;
@@ -313,10 +395,17 @@ enum {
 void	EditCompleteUpdateConfig(void);
 BOOL	IsDocWordChar(int ch);
 BOOL	IsAutoCompletionWordCharacter(int ch);
+void	AutoC_ResetWordCharTable(void);
 void	EditCompleteWord(int iCondition, BOOL autoInsert);
+void	AutoC_OnDocumentModified(BOOL insert, Sci_Position position, Sci_Position length, const char *text, Sci_Line linesAdded);
+void	AutoC_DiscardDocWordIndex(void);
+void	AutoC_OnDocWordIndexBuilt(void);
+void	AutoC_DiscardSignatureIndex(void);
+void	AutoC_OnSignatureIndexBuilt(void);
 BOOL	EditIsOpenBraceMatched(Sci_Position pos, Sci_Position startPos);
 void	EditAutoCloseBraceQuote(int ch);
 void	EditAutoCloseXMLTag(void);
+BOOL	EditAutoCloseEndTag(void);
 void	EditAutoIndent(void);
 void	EditToggleCommentLine(void);
 void	EditToggleCommentBlock(void);
@@ -404,6 +493,10 @@ BOOL	Encoding_GetFromComboboxEx(HWND hwnd, int *pidEncoding);
 BOOL	IsUnicode(const char *pBuffer, DWORD cb, LPBOOL lpbBOM, LPBOOL lpbReverse);
 BOOL	IsUTF8(const char *pTest, DWORD nLength);
 BOOL	IsUTF7(const char *pTest, DWORD nLength);
+void	RunOnAllProcessors(LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, DWORD sliceCount);
+int		DetectDBCSEncoding(const char *pTest, DWORD nLength);
+size_t	UTF16ToUTF8(LPCWSTR pwszText, size_t cchText, char *lpOut, BOOL *pbLossy);
+size_t	UTF8ToUTF16(const char *lpText, size_t cbText, LPWSTR pwszOut);
 //INT		UTF8_mbslen(LPCSTR source, INT byte_length);
 //INT		UTF8_mbslen_bytes(LPCSTR utf8_string);
 
@@ -11,31 +11,30 @@
 #include <stdio.h>
 #include "SciCall.h"
 #include "VectorISA.h"
+#include "TraceEvents.h"
 #include "Helpers.h"
+#include "Notepad2.h"
 #include "Edit.h"
 #include "Styles.h"
 #include "resource.h"
 #include "EditAutoC_Data0.h"
 #include "LaTeXInput.h"
 
+//! print duration of auto-completion stages, with p50/p99 of recent requests
+#define NP2_AUTOC_PROFILE			0
+
 #define NP2_AUTOC_USE_STRING_ORDER	1
 // scintilla/src/AutoComplete.h AutoComplete::maxItemLen
 #define NP2_AUTOC_MAX_WORD_LENGTH	(1024 - 3 - 1 - 16)	// SP + '(' + ')' + '\0'
 #define NP2_AUTOC_INIT_BUF_SIZE		(4096)
-#define NP2_AUTOC_MAX_BUF_COUNT		20
-#define NP2_AUTOC_INIT_CACHE_BYTES	(4096)
-#define NP2_AUTOC_MAX_CACHE_COUNT	18
+#define NP2_AUTOC_INIT_WORD_COUNT	(256)
 /*
-word buffer:
-(2**20 - 1)*4096 => 4 GiB
-
-node cache:
-a = [4096*2**i for i in range(18)] => 1 GiB
-x64: sum(i//40 for i in a) => 26843434 nodes
-x86: sum(i//24 for i in a) => 44739063 nodes
+all words are stored in one buffer (up to 4 GiB), and indexed by a flat array
+of WordEntry, duplicate words are found with hash table of entry index.
+the array is sorted once in WordList_GetList().
 */
 
-struct WordNode;
+struct WordEntry;
 struct WordList {
 	char wordBuf[1024];
 	int (__cdecl *WL_strcmp)(LPCSTR, LPCSTR);
@@ -43,27 +42,23 @@ struct WordList {
 #if NP2_AUTOC_USE_STRING_ORDER
 	uint32_t (*WL_OrderFunc)(const void *, uint32_t);
 #endif
-	struct WordNode *pListHead;
 	LPCSTR pWordStart;
+	BOOL bIgnoreCase;
 
-	char *bufferList[NP2_AUTOC_MAX_BUF_COUNT];
 	char *buffer;
-	int bufferCount;
 	UINT offset;
 	UINT capacity;
 
+	struct WordEntry *entries;
+	UINT entryCapacity;
+	UINT *slots;		// entry index + 1, 0 for empty slot
+	UINT slotMask;
+
 	UINT nWordCount;
 	UINT nTotalLen;
 	UINT orderStart;
 	int iStartLen;
 	int iMaxLength;
-
-	struct WordNode *nodeCacheList[NP2_AUTOC_MAX_CACHE_COUNT];
-	struct WordNode *nodeCache;
-	int cacheCount;
-	UINT cacheIndex;
-	UINT cacheCapacity;
-	UINT cacheBytes;
 };
 
 // TODO: replace _stricmp() and _strnicmp() with other functions
@@ -123,145 +118,89 @@ uint32_t WordList_OrderCase(const void *pWord, uint32_t len) {
 }
 #endif
 
-// Tree
-struct WordNode {
-	union {
-		struct WordNode *link[2];
-		struct {
-			struct WordNode *left;
-			struct WordNode *right;
-		};
-	};
-	char *word;
+struct WordEntry {
 #if NP2_AUTOC_USE_STRING_ORDER
 	UINT order;
 #endif
+	UINT hash;
+	UINT offset;
 	int len;
-	int level;
 };
 
-#define NP2_TREE_HEIGHT_LIMIT	32
-// TODO: since the tree is sorted, nodes greater than some level can be deleted to reduce total words.
-// or only limit word count in WordList_GetList().
-
-// Andersson Tree, source from https://www.eternallyconfuzzled.com/tuts/datastructures/jsw_tut_andersson.aspx
-// see also https://en.wikipedia.org/wiki/AA_tree
-#define aa_tree_skew(t) \
-	if ((t)->level && (t)->left && (t)->level == (t)->left->level) {\
-		struct WordNode *save = (t)->left;					\
-		(t)->left = save->right;							\
-		save->right = (t);									\
-		(t) = save;											\
-	}
-#define aa_tree_split(t) \
-	if ((t)->level && (t)->right && (t)->right->right && (t)->level == (t)->right->right->level) {\
-		struct WordNode *save = (t)->right;					\
-		(t)->right = save->left;							\
-		save->left = (t);									\
-		(t) = save;											\
-		++(t)->level;										\
-	}
-
-static inline void WordList_AddBuffer(struct WordList *pWList) {
-	char *buffer = (char *)NP2HeapAlloc(pWList->capacity);
-	pWList->bufferList[pWList->bufferCount] = buffer;
-	pWList->buffer = buffer;
-	pWList->bufferCount++;
-	pWList->offset = 0;
-}
-
-static inline void WordList_AddCache(struct WordList *pWList) {
-	struct WordNode *node = (struct WordNode *)NP2HeapAlloc(pWList->cacheBytes);
-	pWList->nodeCacheList[pWList->cacheCount] = node;
-	pWList->nodeCache = node;
-	pWList->cacheCount++;
-	pWList->cacheIndex = 0;
-	pWList->cacheCapacity = pWList->cacheBytes / (sizeof(struct WordNode));
-}
-
-void WordList_AddWord(struct WordList *pWList, LPCSTR pWord, int len) {
-	struct WordNode *root = pWList->pListHead;
-#if NP2_AUTOC_USE_STRING_ORDER
-	const UINT order = (pWList->iStartLen > NP2_AUTOC_ORDER_LENGTH) ? 0 : pWList->WL_OrderFunc(pWord, len);
-#endif
-	if (root == NULL) {
-		struct WordNode *node;
-		node = pWList->nodeCache + pWList->cacheIndex++;
-		node->word = pWList->buffer + pWList->offset;
-
-		CopyMemory(node->word, pWord, len);
-#if NP2_AUTOC_USE_STRING_ORDER
-		node->order = order;
-#endif
-		node->len = len;
-		node->level = 1;
-		root = node;
-	} else {
-		struct WordNode *iter = root;
-		struct WordNode *path[NP2_TREE_HEIGHT_LIMIT] = { NULL };
-		int top = 0;
-		int dir;
-
-		// find a spot and save the path
-		for (;;) {
-			path[top++] = iter;
-#if NP2_AUTOC_USE_STRING_ORDER
-			dir = (int)(iter->order - order);
-			if (dir == 0 && (len > NP2_AUTOC_ORDER_LENGTH || iter->len > NP2_AUTOC_ORDER_LENGTH)) {
-				dir = pWList->WL_strcmp(iter->word, pWord);
-			}
-#else
-			dir = pWList->WL_strcmp(iter->word, pWord);
-#endif
-			if (dir == 0) {
-				return;
-			}
-			dir = dir < 0;
-			if (iter->link[dir] == NULL) {
-				break;
+static inline UINT WordList_Hash(const struct WordList *pWList, LPCSTR pWord, int len) {
+	// FNV-1a, ASCII letters are folded to match _stricmp() / strcasecmp().
+	UINT hash = 2166136261U;
+	const uint8_t *ptr = (const uint8_t *)pWord;
+	if (pWList->bIgnoreCase) {
+		for (int i = 0; i < len; i++) {
+			uint8_t ch = *ptr++;
+			if (ch >= 'A' && ch <= 'Z') {
+				ch = ch + 'a' - 'A';
 			}
-			iter = iter->link[dir];
+			hash = (hash ^ ch) * 16777619U;
+		}
+	} else {
+		for (int i = 0; i < len; i++) {
+			hash = (hash ^ *ptr++) * 16777619U;
 		}
+	}
+	return hash;
+}
 
-		if (pWList->cacheIndex + 1 > pWList->cacheCapacity) {
-			pWList->cacheBytes <<= 1;
-			WordList_AddCache(pWList);
+static void WordList_Rehash(struct WordList *pWList, UINT slotCount) {
+	UINT *slots = (UINT *)NP2HeapAlloc(slotCount * sizeof(UINT));
+	const UINT mask = slotCount - 1;
+	for (UINT i = 0; i < pWList->nWordCount; i++) {
+		UINT slot = pWList->entries[i].hash & mask;
+		while (slots[slot]) {
+			slot = (slot + 1) & mask;
 		}
-		if (pWList->capacity < pWList->offset + len + 1) {
-			pWList->capacity <<= 1;
-			WordList_AddBuffer(pWList);
+		slots[slot] = i + 1;
+	}
+	if (pWList->slots) {
+		NP2HeapFree(pWList->slots);
+	}
+	pWList->slots = slots;
+	pWList->slotMask = mask;
+}
+
+void WordList_AddWord(struct WordList *pWList, LPCSTR pWord, int len) {
+	const UINT hash = WordList_Hash(pWList, pWord, len);
+	UINT slot = hash & pWList->slotMask;
+	UINT index;
+	while ((index = pWList->slots[slot]) != 0) {
+		const struct WordEntry *entry = &pWList->entries[index - 1];
+		if (entry->hash == hash && entry->len == len
+			&& pWList->WL_strncmp(pWList->buffer + entry->offset, pWord, len) == 0) {
+			return;
 		}
+		slot = (slot + 1) & pWList->slotMask;
+	}
 
-		struct WordNode *node = pWList->nodeCache + pWList->cacheIndex++;
-		node->word = pWList->buffer + pWList->offset;
+	if (pWList->nWordCount == pWList->entryCapacity) {
+		pWList->entryCapacity <<= 1;
+		pWList->entries = (struct WordEntry *)NP2HeapReAlloc(pWList->entries, pWList->entryCapacity * sizeof(struct WordEntry));
+	}
+	if (pWList->capacity < pWList->offset + align_up(len + 1)) {
+		pWList->capacity = max_u(pWList->capacity << 1, pWList->offset + align_up(len + 1));
+		pWList->buffer = (char *)NP2HeapReAlloc(pWList->buffer, pWList->capacity);
+	}
 
-		CopyMemory(node->word, pWord, len);
+	char *word = pWList->buffer + pWList->offset;
+	CopyMemory(word, pWord, len);
+	word[len] = '\0';
+	struct WordEntry *entry = &pWList->entries[pWList->nWordCount];
 #if NP2_AUTOC_USE_STRING_ORDER
-		node->order = order;
+	entry->order = (pWList->iStartLen > NP2_AUTOC_ORDER_LENGTH) ? 0 : pWList->WL_OrderFunc(pWord, len);
 #endif
-		node->len = len;
-		node->level = 1;
-		iter->link[dir] = node;
-
-		// walk back and rebalance
-		while (--top >= 0) {
-			// which child?
-			if (top != 0) {
-				dir = path[top - 1]->right == path[top];
-			}
-			aa_tree_skew(path[top]);
-			aa_tree_split(path[top]);
-			// fix the parent
-			if (top != 0) {
-				path[top - 1]->link[dir] = path[top];
-			} else {
-				root = path[top];
-			}
-		}
+	entry->hash = hash;
+	entry->offset = pWList->offset;
+	entry->len = len;
+	pWList->slots[slot] = ++pWList->nWordCount;
+	if (pWList->nWordCount*4 > (pWList->slotMask + 1)*3) {
+		WordList_Rehash(pWList, (pWList->slotMask + 1)*2);
 	}
 
-	pWList->pListHead = root;
-	pWList->nWordCount++;
 	pWList->nTotalLen += len + 1;
 	pWList->offset += align_up(len + 1);
 	if (len > pWList->iMaxLength) {
@@ -270,32 +209,72 @@ void WordList_AddWord(struct WordList *pWList, LPCSTR pWord, int len) {
 }
 
 void WordList_Free(struct WordList *pWList) {
-	for (int i = 0; i < pWList->cacheCount; i++) {
-		NP2HeapFree(pWList->nodeCacheList[i]);
+	NP2HeapFree(pWList->buffer);
+	NP2HeapFree(pWList->entries);
+	NP2HeapFree(pWList->slots);
+}
+
+static inline int WordList_Compare(const struct WordList *pWList, const struct WordEntry *a, const struct WordEntry *b) {
+#if NP2_AUTOC_USE_STRING_ORDER
+	if (a->order != b->order) {
+		return (a->order < b->order) ? -1 : 1;
+	}
+#endif
+	return pWList->WL_strcmp(pWList->buffer + a->offset, pWList->buffer + b->offset);
+}
+
+// merge sort, temp has room for half of the entries.
+static void WordList_Sort(const struct WordList *pWList, struct WordEntry *entries, struct WordEntry *temp, UINT count) {
+	if (count <= 8) {
+		for (UINT i = 1; i < count; i++) {
+			const struct WordEntry entry = entries[i];
+			UINT j = i;
+			while (j > 0 && WordList_Compare(pWList, &entry, &entries[j - 1]) < 0) {
+				entries[j] = entries[j - 1];
+				--j;
+			}
+			entries[j] = entry;
+		}
+		return;
+	}
+
+	const UINT half = count / 2;
+	WordList_Sort(pWList, entries, temp, half);
+	WordList_Sort(pWList, entries + half, temp, count - half);
+	if (WordList_Compare(pWList, &entries[half], &entries[half - 1]) > 0) {
+		return;
 	}
-	for (int i = 0; i < pWList->bufferCount; i++) {
-		NP2HeapFree(pWList->bufferList[i]);
+
+	CopyMemory(temp, entries, half * sizeof(struct WordEntry));
+	UINT i = 0;
+	UINT j = half;
+	UINT k = 0;
+	while (i < half && j < count) {
+		if (WordList_Compare(pWList, &entries[j], &temp[i]) < 0) {
+			entries[k++] = entries[j++];
+		} else {
+			entries[k++] = temp[i++];
+		}
+	}
+	while (i < half) {
+		entries[k++] = temp[i++];
 	}
 }
 
 char* WordList_GetList(struct WordList *pWList) {
-	struct WordNode *root = pWList->pListHead;
-	struct WordNode *path[NP2_TREE_HEIGHT_LIMIT] = { NULL };
-	int top = 0;
+	struct WordEntry * const entries = pWList->entries;
+	const UINT count = pWList->nWordCount;
+	struct WordEntry *temp = (struct WordEntry *)NP2HeapAlloc((count/2 + 1) * sizeof(struct WordEntry));
+	WordList_Sort(pWList, entries, temp, count);
+	NP2HeapFree(temp);
+
 	char *buf = (char *)NP2HeapAlloc(pWList->nTotalLen + 1);// additional separator
 	char * const pList = buf;
-
-	while (root || top > 0) {
-		if (root) {
-			path[top++] = root;
-			root = root->left;
-		} else {
-			root = path[--top];
-			CopyMemory(buf, root->word, root->len);
-			buf += root->len;
-			*buf++ = '\n'; // the separator char
-			root = root->right;
-		}
+	for (UINT i = 0; i < count; i++) {
+		const struct WordEntry *entry = &entries[i];
+		CopyMemory(buf, pWList->buffer + entry->offset, entry->len);
+		buf += entry->len;
+		*buf++ = '\n'; // the separator char
 	}
 	// trim last separator char
 	if (buf != pList) {
@@ -306,8 +285,8 @@ char* WordList_GetList(struct WordList *pWList) {
 
 struct WordList *WordList_Alloc(LPCSTR pRoot, int iRootLen, BOOL bIgnoreCase) {
 	struct WordList *pWList = (struct WordList *)NP2HeapAlloc(sizeof(struct WordList));
-	pWList->pListHead = NULL;
 	pWList->pWordStart = pRoot;
+	pWList->bIgnoreCase = bIgnoreCase;
 	pWList->nWordCount = 0;
 	pWList->nTotalLen = 0;
 	pWList->iStartLen = iRootLen;
@@ -331,9 +310,10 @@ struct WordList *WordList_Alloc(LPCSTR pRoot, int iRootLen, BOOL bIgnoreCase) {
 #endif
 
 	pWList->capacity = NP2_AUTOC_INIT_BUF_SIZE;
-	WordList_AddBuffer(pWList);
-	pWList->cacheBytes = NP2_AUTOC_INIT_CACHE_BYTES;
-	WordList_AddCache(pWList);
+	pWList->buffer = (char *)NP2HeapAlloc(pWList->capacity);
+	pWList->entryCapacity = NP2_AUTOC_INIT_WORD_COUNT;
+	pWList->entries = (struct WordEntry *)NP2HeapAlloc(pWList->entryCapacity * sizeof(struct WordEntry));
+	WordList_Rehash(pWList, NP2_AUTOC_INIT_WORD_COUNT*2);
 	return pWList;
 }
 
@@ -511,17 +491,12 @@ static inline BOOL IsSpecialStartChar(int ch, int chPrev) {
 //
 extern EditAutoCompletionConfig autoCompletionConfig;
 
-// CharClassify::SetDefaultCharClasses()
-static inline BOOL IsDefaultWordChar(int ch) {
-	return ch >= 0x80 || IsAlphaNumeric(ch) || ch == '_';
-}
-
-BOOL IsDocWordChar(int ch) {
+static BOOL IsLexerWordChar(int rid, int ch) {
 	if (IsAlphaNumeric(ch) || ch == '_' || ch == '.') {
 		return TRUE;
 	}
 
-	switch (pLexCurrent->rid) {
+	switch (rid) {
 	case NP2LEX_TEXTFILE:
 	case NP2LEX_2NDTEXTFILE:
 	case NP2LEX_ANSI:
@@ -603,8 +578,62 @@ BOOL IsDocWordChar(int ch) {
 	return FALSE;
 }
 
+// word character tables: ASCII bitmap for current lexer, and lazily filled
+// bitmap for other BMP characters, which only depends on code page.
+static struct WordCharTable {
+	int rid;
+	uint32_t ascii[128/32];
+	uint32_t known[0x10000/32];
+	uint32_t word[0x10000/32];
+} wordCharTable;
+
+static inline BOOL BitmapTest(const uint32_t *bitmap, UINT index) {
+	return (bitmap[index >> 5] >> (index & 31)) & 1;
+}
+
+static inline void BitmapSet(uint32_t *bitmap, UINT index) {
+	bitmap[index >> 5] |= 1U << (index & 31);
+}
+
+static void WordCharTable_Update(int rid) {
+	wordCharTable.rid = rid;
+	ZeroMemory(wordCharTable.ascii, sizeof(wordCharTable.ascii));
+	for (int ch = 0; ch < 0x80; ch++) {
+		if (IsLexerWordChar(rid, ch)) {
+			BitmapSet(wordCharTable.ascii, ch);
+		}
+	}
+}
+
+BOOL IsDocWordChar(int ch) {
+	if ((UINT)ch >= 0x80) {
+		return FALSE;
+	}
+	if (wordCharTable.rid != pLexCurrent->rid) {
+		WordCharTable_Update(pLexCurrent->rid);
+	}
+	return BitmapTest(wordCharTable.ascii, ch);
+}
+
 BOOL IsAutoCompletionWordCharacter(int ch) {
-	return (ch < 0x80) ? IsDocWordChar(ch) : SciCall_IsAutoCompletionWordCharacter(ch);
+	if (ch < 0x80) {
+		return IsDocWordChar(ch);
+	}
+	if (ch >= 0x10000) {
+		return SciCall_IsAutoCompletionWordCharacter(ch);
+	}
+	if (!BitmapTest(wordCharTable.known, ch)) {
+		BitmapSet(wordCharTable.known, ch);
+		if (SciCall_IsAutoCompletionWordCharacter(ch)) {
+			BitmapSet(wordCharTable.word, ch);
+		}
+	}
+	return BitmapTest(wordCharTable.word, ch);
+}
+
+void AutoC_ResetWordCharTable(void) {
+	ZeroMemory(wordCharTable.known, sizeof(wordCharTable.known));
+	ZeroMemory(wordCharTable.word, sizeof(wordCharTable.word));
 }
 
 static inline BOOL IsWordStyleToIgnore(int style) {
@@ -697,93 +726,1133 @@ static inline BOOL IsEscapeCharEx(int ch, int style) {
 		return !(style == SCE_C_STRINGRAW || style == SCE_C_VERBATIM
 			|| style == SCE_C_COMMENTDOC_TAG);
 
-	case SCLEX_PYTHON:
-		// not in raw string
-		return !(style >= SCE_PY_STRING_SQ && (style & 7) > 3);
+	case SCLEX_PYTHON:
+		// not in raw string
+		return !(style >= SCE_PY_STRING_SQ && (style & 7) > 3);
+	}
+	return TRUE;
+}
+
+static inline BOOL NeedSpaceAfterKeyword(const char *word, Sci_Position length) {
+	const char *p = strstr(
+		" if for try using while elseif switch foreach synchronized "
+		, word);
+	return p != NULL && p[-1] == ' ' && p[length] == ' ';
+}
+
+#define HTML_TEXT_BLOCK_TAG		0
+#define HTML_TEXT_BLOCK_CDATA	1
+#define HTML_TEXT_BLOCK_JS		2
+#define HTML_TEXT_BLOCK_VBS		3
+#define HTML_TEXT_BLOCK_PYTHON	4
+#define HTML_TEXT_BLOCK_PHP		5
+#define HTML_TEXT_BLOCK_CSS		6
+#define HTML_TEXT_BLOCK_SGML	7
+
+enum {
+	InnoLineStatePreprocessor = 8,
+	InnoLineStateCodeSection = 16,
+};
+
+extern EDITLEXER lexCSS;
+extern EDITLEXER lexJavaScript;
+extern EDITLEXER lexJulia;
+extern EDITLEXER lexPHP;
+extern EDITLEXER lexPython;
+extern EDITLEXER lexVBS;
+extern HWND hwndMain;
+extern HANDLE idleTaskTimer;
+
+static int GetCurrentHtmlTextBlockEx(int iCurrentStyle) {
+	if (iCurrentStyle == SCE_H_CDATA) {
+		return HTML_TEXT_BLOCK_CDATA;
+	}
+	if ((iCurrentStyle >= SCE_HJ_START && iCurrentStyle <= SCE_HJ_TEMPLATELITERAL)
+		|| (iCurrentStyle >= SCE_HJA_START && iCurrentStyle <= SCE_HJA_TEMPLATELITERAL)) {
+		return HTML_TEXT_BLOCK_JS;
+	}
+	if ((iCurrentStyle >= SCE_HB_START && iCurrentStyle <= SCE_HB_OPERATOR)
+		|| (iCurrentStyle >= SCE_HBA_START && iCurrentStyle <= SCE_HBA_OPERATOR)) {
+		return HTML_TEXT_BLOCK_VBS;
+	}
+	if ((iCurrentStyle >= SCE_HP_START && iCurrentStyle <= SCE_HP_IDENTIFIER)
+		|| (iCurrentStyle >= SCE_HPA_START && iCurrentStyle <= SCE_HPA_IDENTIFIER)) {
+		return HTML_TEXT_BLOCK_PYTHON;
+	}
+	if ((iCurrentStyle >= SCE_HPHP_DEFAULT && iCurrentStyle <= SCE_HPHP_COMPLEX_VARIABLE)) {
+		return HTML_TEXT_BLOCK_PHP;
+	}
+	if ((iCurrentStyle >= SCE_H_SGML_DEFAULT && iCurrentStyle <= SCE_H_SGML_BLOCK_DEFAULT)) {
+		return HTML_TEXT_BLOCK_SGML;
+	}
+	return HTML_TEXT_BLOCK_TAG;
+}
+
+static int GetCurrentHtmlTextBlock(void) {
+	const Sci_Position iCurrentPos = SciCall_GetCurrentPos();
+	const int iCurrentStyle = SciCall_GetStyleAt(iCurrentPos);
+	return GetCurrentHtmlTextBlockEx(iCurrentStyle);
+}
+
+static void EscapeRegex(LPSTR pszOut, LPCSTR pszIn) {
+	char ch;
+	while ((ch = *pszIn++) != '\0') {
+		if (ch == '.'		// any character
+			|| ch == '^'	// start of line
+			|| ch == '$'	// end of line
+			|| ch == '?'	// 0 or 1 times
+			|| ch == '*'	// 0 or more times
+			|| ch == '+'	// 1 or more times
+			|| ch == '[' || ch == ']'
+			|| ch == '(' || ch == ')'
+			) {
+			*pszOut++ = '\\';
+		}
+		*pszOut++ = ch;
+	}
+	*pszOut++ = '\0';
+}
+
+// document word index for large document, built on background thread
+// from a snapshot of the text, then updated from SCN_MODIFIED.
+// words are runs of IsDefaultWordChar(), so the index is independent of lexer.
+#define NP2_AUTOC_INDEX_MIN_DOC_SIZE	(1024*1024)
+#define NP2_AUTOC_INDEX_INIT_CAPACITY	(4096)
+#define NP2_AUTOC_INDEX_BUILD_CHUNK_SIZE	(1024*1024)
+
+struct DocWordEntry {
+	UINT hash;
+	UINT len;
+	UINT count;	// 0 for deleted word
+	UINT offset;	// offset into pool of NUL terminated word
+};
+
+struct DocWordIndex {
+	struct DocWordEntry *table;
+	char *pool;
+	UINT capacity;		// power of 2, 0 when index not built
+	UINT used;			// used entries, including deleted words
+	UINT poolSize;
+	UINT poolCapacity;
+	Sci_Position docLength;
+};
+
+typedef struct DocWordIndexBuilder {
+	BackgroundWorker worker;
+	struct DocWordIndex index;
+	const char *snapshot;	// shared copy from SciCall_AcquireTextSnapshot()
+	Sci_Position snapshotLength;
+	BOOL active;
+	BOOL success;
+	// changed range since snapshot, [dirtyStart, dirtyEnd) in document
+	// is [dirtyStart, dirtyEnd - dirtyDelta) in snapshot.
+	Sci_Position dirtyStart;	// -1 for unchanged
+	Sci_Position dirtyEnd;
+	Sci_Position dirtyDelta;
+} DocWordIndexBuilder;
+
+static struct DocWordIndex docWordIndex;
+static DocWordIndexBuilder docWordIndexBuilder;
+
+static inline UINT DocWordIndex_Hash(const char *word, UINT len) {
+	// FNV-1a
+	UINT hash = 2166136261U;
+	for (UINT i = 0; i < len; i++) {
+		hash = (hash ^ (uint8_t)word[i]) * 16777619U;
+	}
+	return hash;
+}
+
+static void DocWordIndex_Free(struct DocWordIndex *index) {
+	if (index->table) {
+		NP2HeapFree(index->table);
+		NP2HeapFree(index->pool);
+	}
+	ZeroMemory(index, sizeof(struct DocWordIndex));
+}
+
+static void DocWordIndexBuilder_Stop(DocWordIndexBuilder *builder) {
+	if (builder->active) {
+		// APPM_DOCWORDINDEX dispatched while waiting is ignored
+		builder->active = FALSE;
+		BackgroundWorker_Destroy(&builder->worker);
+		DocWordIndex_Free(&builder->index);
+		SciCall_ReleaseTextSnapshot(builder->snapshot);
+		builder->snapshot = NULL;
+	}
+}
+
+void AutoC_DiscardDocWordIndex(void) {
+	DocWordIndexBuilder_Stop(&docWordIndexBuilder);
+	DocWordIndex_Free(&docWordIndex);
+}
+
+static BOOL DocWordIndex_Rehash(struct DocWordIndex *index, UINT capacity) {
+	UINT poolCapacity = NP2_AUTOC_INIT_BUF_SIZE;
+	for (UINT i = 0; i < index->capacity; i++) {
+		const struct DocWordEntry *entry = &index->table[i];
+		if (entry->count) {
+			poolCapacity += entry->len + 1;
+		}
+	}
+	struct DocWordEntry *table = (struct DocWordEntry *)NP2HeapAlloc(capacity * sizeof(struct DocWordEntry));
+	char *pool = (char *)NP2HeapAlloc(poolCapacity);
+	if (table == NULL || pool == NULL) {
+		if (table) {
+			NP2HeapFree(table);
+		}
+		if (pool) {
+			NP2HeapFree(pool);
+		}
+		return FALSE;
+	}
+
+	// drop deleted words and compact the pool
+	UINT used = 0;
+	UINT poolSize = 0;
+	for (UINT i = 0; i < index->capacity; i++) {
+		const struct DocWordEntry *entry = &index->table[i];
+		if (entry->count) {
+			UINT slot = entry->hash & (capacity - 1);
+			while (table[slot].len) {
+				slot = (slot + 1) & (capacity - 1);
+			}
+			table[slot] = *entry;
+			table[slot].offset = poolSize;
+			CopyMemory(pool + poolSize, index->pool + entry->offset, entry->len + 1);
+			poolSize += entry->len + 1;
+			++used;
+		}
+	}
+
+	if (index->table) {
+		NP2HeapFree(index->table);
+		NP2HeapFree(index->pool);
+	}
+	index->table = table;
+	index->pool = pool;
+	index->capacity = capacity;
+	index->used = used;
+	index->poolSize = poolSize;
+	index->poolCapacity = poolCapacity;
+	return TRUE;
+}
+
+static BOOL DocWordIndex_Update(struct DocWordIndex *index, const char *word, UINT len, BOOL add) {
+	const UINT hash = DocWordIndex_Hash(word, len);
+	UINT slot = hash & (index->capacity - 1);
+	struct DocWordEntry *entry;
+	while ((entry = &index->table[slot])->len != 0) {
+		if (entry->hash == hash && entry->len == len && memcmp(index->pool + entry->offset, word, len) == 0) {
+			if (add) {
+				++entry->count;
+			} else if (entry->count) {
+				--entry->count;
+			}
+			return TRUE;
+		}
+		slot = (slot + 1) & (index->capacity - 1);
+	}
+	if (!add) {
+		// not indexed, ignore
+		return TRUE;
+	}
+
+	if ((index->used + 1)*4 > index->capacity*3) {
+		if (!DocWordIndex_Rehash(index, index->capacity*2)) {
+			return FALSE;
+		}
+		return DocWordIndex_Update(index, word, len, add);
+	}
+	if (index->poolSize + len + 1 > index->poolCapacity) {
+		const UINT poolCapacity = max_u(index->poolCapacity*2, index->poolSize + len + 1);
+		char *pool = (char *)NP2HeapReAlloc(index->pool, poolCapacity);
+		if (pool == NULL) {
+			return FALSE;
+		}
+		index->pool = pool;
+		index->poolCapacity = poolCapacity;
+	}
+
+	entry->hash = hash;
+	entry->len = len;
+	entry->count = 1;
+	entry->offset = index->poolSize;
+	CopyMemory(index->pool + index->poolSize, word, len);
+	index->pool[index->poolSize + len] = '\0';
+	index->poolSize += len + 1;
+	++index->used;
+	return TRUE;
+}
+
+static BOOL DocWordIndex_UpdateText(struct DocWordIndex *index, const char *text, Sci_Position length, BOOL add) {
+	const char * const end = text + length;
+	while (text < end) {
+		while (text < end && !IsDefaultWordChar((uint8_t)*text)) {
+			++text;
+		}
+		const char * const word = text;
+		while (text < end && IsDefaultWordChar((uint8_t)*text)) {
+			++text;
+		}
+		const Sci_Position len = text - word;
+		if (len != 0 && len <= NP2_AUTOC_MAX_WORD_LENGTH) {
+			if (!DocWordIndex_Update(index, word, (UINT)len, add)) {
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
+static DWORD WINAPI DocWordIndexBuildThread(LPVOID lpParam) {
+	DocWordIndexBuilder *builder = (DocWordIndexBuilder *)lpParam;
+	BackgroundWorker *worker = &builder->worker;
+	struct DocWordIndex *index = &builder->index;
+	const char * const text = builder->snapshot;
+	const Sci_Position length = builder->snapshotLength;
+
+	NP2_TRACE_START("DocWordIndexBuild", NP2_TRACE_INT64(length, "length"));
+	BOOL success = DocWordIndex_Rehash(index, NP2_AUTOC_INDEX_INIT_CAPACITY);
+	Sci_Position pos = 0;
+	while (success && pos < length && BackgroundWorker_Continue(worker)) {
+		// don't split word run between chunks
+		Sci_Position end = min_pos(pos + NP2_AUTOC_INDEX_BUILD_CHUNK_SIZE, length);
+		while (end < length && IsDefaultWordChar((uint8_t)text[end])) {
+			++end;
+		}
+		success = DocWordIndex_UpdateText(index, text + pos, end - pos, TRUE);
+		pos = end;
+	}
+
+	builder->success = success && pos == length;
+	NP2_TRACE_STOP("DocWordIndexBuild", NP2_TRACE_INT64(pos, "position"), NP2_TRACE_INT64(builder->success, "success"));
+	PostMessage(worker->hwnd, APPM_DOCWORDINDEX, 0, 0);
+	return 0;
+}
+
+static void DocWordIndexBuilder_Start(DocWordIndexBuilder *builder) {
+	const Sci_Position iDocLen = SciCall_GetLength();
+	const char *snapshot = SciCall_AcquireTextSnapshot();
+	if (snapshot == NULL) {
+		return;
+	}
+
+	ZeroMemory(builder, sizeof(DocWordIndexBuilder));
+	BackgroundWorker_Init(&builder->worker, hwndMain);
+	builder->snapshot = snapshot;
+	builder->snapshotLength = iDocLen;
+	builder->dirtyStart = -1;
+	builder->active = TRUE;
+	if (!BackgroundWorker_Start(&builder->worker, DocWordIndexBuildThread, builder, WorkerPriority_Low)) {
+		DocWordIndexBuilder_Stop(builder);
+	}
+}
+
+// record changed range since snapshot
+static void DocWordIndexBuilder_OnModified(DocWordIndexBuilder *builder, BOOL insert, Sci_Position position, Sci_Position length) {
+	if (builder->dirtyStart < 0) {
+		builder->dirtyStart = position;
+		builder->dirtyEnd = position;
+	} else if (builder->dirtyEnd > position) {
+		builder->dirtyEnd = insert ? (builder->dirtyEnd + length) : max_pos(position, builder->dirtyEnd - length);
+	}
+	builder->dirtyStart = min_pos(builder->dirtyStart, position);
+	builder->dirtyEnd = max_pos(builder->dirtyEnd, insert ? (position + length) : position);
+	builder->dirtyDelta += insert ? length : -length;
+}
+
+void AutoC_OnDocWordIndexBuilt(void) {
+	DocWordIndexBuilder *builder = &docWordIndexBuilder;
+	if (!builder->active) {
+		return;
+	}
+
+	// the thread exits after posting the message
+	WaitForSingleObject(builder->worker.workerThread, INFINITE);
+	BackgroundWorker_Destroy(&builder->worker);
+	builder->active = FALSE;
+	struct DocWordIndex *index = &builder->index;
+	const Sci_Position iDocLen = SciCall_GetLength();
+	BOOL success = builder->success && builder->snapshotLength + builder->dirtyDelta == iDocLen;
+	if (success && builder->dirtyStart >= 0) {
+		// replace words in changed range, text outside it is same in snapshot and document
+		const char * const snapshot = builder->snapshot;
+		const Sci_Position snapshotLength = builder->snapshotLength;
+		Sci_Position start = builder->dirtyStart;
+		Sci_Position end = builder->dirtyEnd - builder->dirtyDelta;
+		while (start > 0 && IsDefaultWordChar((uint8_t)snapshot[start - 1])) {
+			--start;
+		}
+		while (end < snapshotLength && IsDefaultWordChar((uint8_t)snapshot[end])) {
+			++end;
+		}
+		success = DocWordIndex_UpdateText(index, snapshot + start, end - start, FALSE);
+		end += builder->dirtyDelta;
+		if (success && end > start) {
+			success = DocWordIndex_UpdateText(index, SciCall_GetRangePointer(start, end - start), end - start, TRUE);
+		}
+	}
+
+	SciCall_ReleaseTextSnapshot(builder->snapshot);
+	builder->snapshot = NULL;
+	if (success) {
+		DocWordIndex_Free(&docWordIndex);
+		index->docLength = iDocLen;
+		docWordIndex = *index;
+		ZeroMemory(index, sizeof(struct DocWordIndex));
+		// refresh current list with document words
+		if (SciCall_AutoCActive()) {
+			EditCompleteWord(AutoCompleteCondition_Normal, FALSE);
+		}
+	} else {
+		DocWordIndex_Free(index);
+	}
+}
+
+// find the word run around position, return FALSE when it too long to be indexed.
+static BOOL DocWordIndex_ExtendRange(Sci_Position *startPos, Sci_Position *endPos) {
+	Sci_Position start = *startPos;
+	Sci_Position end = *endPos;
+	const Sci_Position minPos = max_pos(0, start - NP2_AUTOC_MAX_WORD_LENGTH - 1);
+	const Sci_Position maxPos = min_pos(SciCall_GetLength(), end + NP2_AUTOC_MAX_WORD_LENGTH + 1);
+	while (start > minPos && IsDefaultWordChar(SciCall_GetCharAt(start - 1))) {
+		--start;
+	}
+	while (end < maxPos && IsDefaultWordChar(SciCall_GetCharAt(end))) {
+		++end;
+	}
+	*startPos = start;
+	*endPos = end;
+	return (start == 0 || start > minPos) && (end == SciCall_GetLength() || end < maxPos);
+}
+
+// call tip signature index, function definitions are found line by line from a snapshot
+// of the document on background thread, then updated for edited lines from SCN_MODIFIED.
+// the snapshot has no styles, so definitions are recognized with simple text rules.
+#define NP2_CALLTIP_INDEX_INIT_CAPACITY		(256)
+#define NP2_CALLTIP_MAX_LINE_LENGTH			(1024)
+#define NP2_CALLTIP_MAX_NAME_LENGTH			(128)
+#define NP2_CALLTIP_MAX_SIGNATURE_LENGTH	(256)
+#define NP2_CALLTIP_MAX_OVERLOAD_COUNT		8
+
+enum {
+	SignatureMode_None = 0,
+	SignatureMode_Keyword,	// def name(), function name()
+	SignatureMode_CLike,	// type name(), also keyword
+};
+
+struct SignatureEntry {
+	Sci_Line line;
+	UINT offset;	// into pool of NUL terminated name, followed by NUL terminated signature
+	UINT nameLen;
+	UINT textLen;
+};
+
+struct SignatureIndex {
+	struct SignatureEntry *entries;	// sorted by line, NULL when index not built
+	UINT *order;	// entry index sorted by name, NULL when outdated
+	char *pool;
+	UINT count;
+	UINT capacity;
+	UINT poolSize;
+	UINT poolCapacity;
+	UINT poolUsed;	// bytes used by current entries
+	int mode;
+	Sci_Line lineCount;
+	Sci_Position docLength;
+};
+
+typedef struct SignatureIndexBuilder {
+	BackgroundWorker worker;
+	struct SignatureIndex index;
+	const char *snapshot;	// shared copy from SciCall_AcquireTextSnapshot()
+	Sci_Position snapshotLength;
+	BOOL active;
+	BOOL success;
+	// changed lines since snapshot, [dirtyFirst, dirtyLast] in document
+	// is [dirtyFirst, dirtyLast - dirtyDelta] in snapshot.
+	Sci_Line dirtyFirst;	// -1 for unchanged
+	Sci_Line dirtyLast;
+	Sci_Line dirtyDelta;
+} SignatureIndexBuilder;
+
+static struct SignatureIndex signatureIndex;
+static SignatureIndexBuilder signatureIndexBuilder;
+
+static int GetCurrentSignatureMode(void) {
+	switch (pLexCurrent->iLexer) {
+	case SCLEX_CPP:
+	case SCLEX_DART:
+	case SCLEX_JAVA:
+		return SignatureMode_CLike;
+
+	case SCLEX_AWK:
+	case SCLEX_GO:
+	case SCLEX_GROOVY:
+	case SCLEX_HAXE:
+	case SCLEX_JAVASCRIPT:
+	case SCLEX_JULIA:
+	case SCLEX_KOTLIN:
+	case SCLEX_LUA:
+	case SCLEX_PYTHON:
+	case SCLEX_RUBY:
+	case SCLEX_RUST:
+	case SCLEX_SWIFT:
+		return SignatureMode_Keyword;
+	}
+	return SignatureMode_None;
+}
+
+static inline BOOL IsSignatureWordChar(int ch) {
+	return IsDefaultWordChar(ch) || ch == '$';
+}
+
+static BOOL IsWordInSpaceList(LPCSTR list, LPCSTR word, int len) {
+	char buf[16 + 4];
+	if (len >= 16) {
+		return FALSE;
+	}
+	buf[0] = ' ';
+	memcpy(buf + 1, word, len);
+	buf[len + 1] = ' ';
+	buf[len + 2] = '\0';
+	return strstr(list, buf) != NULL;
+}
+
+static inline BOOL IsDefinitionKeyword(LPCSTR word, int len) {
+	return IsWordInSpaceList(" def fn fun func function macro proc procedure sub ", word, len);
+}
+
+// words can't start a declaration in C-like language
+static inline BOOL IsDeclarationStopWord(LPCSTR word, int len) {
+	return IsWordInSpaceList(" assert await case catch delete do else elif for foreach goto if lock new"
+		" return sizeof switch throw typeof using when while with yield ", word, len);
+}
+
+// skip balanced brackets starting at text[pos], return -1 when not closed in the line.
+static int SkipSignatureBracket(const char *text, int pos, int length, char chOpen, char chClose) {
+	int depth = 0;
+	do {
+		const char ch = text[pos++];
+		if (ch == chOpen) {
+			++depth;
+		} else if (ch == chClose) {
+			--depth;
+		}
+	} while (depth != 0 && pos < length);
+	return (depth == 0) ? pos : -1;
+}
+
+// find function definition in a line, signature is text from first word to the close parenthesis.
+static BOOL FindSignatureInLine(const char *text, int length, int mode, int *nameStart, int *nameEnd, int *textStart, int *textEnd) {
+	int pos = 0;
+	while (pos < length && IsASpaceOrTab(text[pos])) {
+		++pos;
+	}
+	const int start = pos;
+	int name = -1;
+	int nameLen = 0;
+	int words = 0; // not counting qualified name part
+	BOOL keyword = FALSE;
+	BOOL lastIsName = FALSE;
+	BOOL qualified = FALSE;
+	BOOL separator = FALSE;
+
+	if (pos < length && text[pos] == '#') {
+		// function-like macro: #define name(
+		if (mode != SignatureMode_CLike) {
+			return FALSE;
+		}
+		++pos;
+		while (pos < length && IsASpaceOrTab(text[pos])) {
+			++pos;
+		}
+		if (length - pos < 7 || memcmp(text + pos, "define", 6) != 0 || !IsASpaceOrTab(text[pos + 6])) {
+			return FALSE;
+		}
+		pos += 7;
+		while (pos < length && IsASpaceOrTab(text[pos])) {
+			++pos;
+		}
+		name = pos;
+		while (pos < length && IsSignatureWordChar((uint8_t)text[pos])) {
+			++pos;
+		}
+		nameLen = pos - name;
+		if (nameLen == 0 || pos == length || text[pos] != '(') {
+			return FALSE;
+		}
+		keyword = TRUE;
+		lastIsName = TRUE;
+	}
+
+	while (pos < length) {
+		const uint8_t ch = text[pos];
+		if (IsSignatureWordChar(ch)) {
+			const int word = pos;
+			do {
+				++pos;
+			} while (pos < length && IsSignatureWordChar((uint8_t)text[pos]));
+			const int len = pos - word;
+			if (IsDefinitionKeyword(text + word, len)) {
+				keyword = TRUE;
+				name = -1;
+				lastIsName = FALSE;
+			} else if (!keyword && IsDeclarationStopWord(text + word, len)) {
+				return FALSE;
+			} else {
+				qualified = separator && name >= 0;
+				if (!separator) {
+					++words;
+				}
+				name = word;
+				nameLen = len;
+				lastIsName = TRUE;
+			}
+			separator = FALSE;
+		} else if (ch == '(') {
+			if (name >= 0 && lastIsName && (keyword || mode == SignatureMode_CLike)) {
+				break;
+			}
+			if (!(keyword || mode == SignatureMode_Keyword)) {
+				return FALSE;
+			}
+			// Go method receiver, Rust pub(crate)
+			pos = SkipSignatureBracket(text, pos, length, '(', ')');
+			if (pos < 0) {
+				return FALSE;
+			}
+			lastIsName = FALSE;
+		} else if (ch == '<') {
+			// generic parameters
+			pos = SkipSignatureBracket(text, pos, length, '<', '>');
+			if (pos < 0) {
+				return FALSE;
+			}
+		} else if (ch == ':' || (ch == '.' && keyword)) {
+			separator = TRUE;
+			lastIsName = FALSE;
+			++pos;
+		} else if (ch == '*' || ch == '&' || ch == '[' || ch == ']' || ch == '~' || ch == '?' || ch == '^') {
+			separator = ch == '~';
+			lastIsName = FALSE;
+			++pos;
+		} else if (IsASpaceOrTab(ch)) {
+			++pos;
+		} else {
+			return FALSE;
+		}
+	}
+	if (pos >= length || !(keyword || mode == SignatureMode_CLike)) {
+		return FALSE;
+	}
+
+	const int end = SkipSignatureBracket(text, pos, length, '(', ')');
+	if (!keyword) {
+		if (words < 2 && !qualified) {
+			return FALSE;
+		}
+		if (end > 0) {
+			// reject function call and expression
+			int next = end;
+			while (next < length && IsASpaceOrTab(text[next])) {
+				++next;
+			}
+			if (next < length) {
+				const char chNext = text[next];
+				if (chNext == ';' ? (words < 2) : !(chNext == '{' || chNext == ':' || chNext == '='
+					|| chNext == '/' || (chNext == '-' && next + 1 < length && text[next + 1] == '>') || IsSignatureWordChar((uint8_t)chNext))) {
+					return FALSE;
+				}
+			}
+		}
+	}
+
+	*nameStart = name;
+	*nameEnd = name + nameLen;
+	*textStart = start;
+	*textEnd = (end > 0) ? end : length;
+	return TRUE;
+}
+
+static void SignatureIndex_Free(struct SignatureIndex *index) {
+	if (index->entries) {
+		NP2HeapFree(index->entries);
+	}
+	if (index->order) {
+		NP2HeapFree(index->order);
+	}
+	if (index->pool) {
+		NP2HeapFree(index->pool);
+	}
+	ZeroMemory(index, sizeof(struct SignatureIndex));
+}
+
+static BOOL SignatureIndex_Reserve(struct SignatureIndex *index, UINT count, UINT poolSize) {
+	if (index->count + count > index->capacity) {
+		const UINT capacity = max_u(max_u(index->capacity*2, NP2_CALLTIP_INDEX_INIT_CAPACITY), index->count + count);
+		struct SignatureEntry *entries = (struct SignatureEntry *)((index->entries == NULL)
+			? NP2HeapAlloc(capacity * sizeof(struct SignatureEntry))
+			: NP2HeapReAlloc(index->entries, capacity * sizeof(struct SignatureEntry)));
+		if (entries == NULL) {
+			return FALSE;
+		}
+		index->entries = entries;
+		index->capacity = capacity;
+	}
+	if (index->poolSize + poolSize > index->poolCapacity) {
+		const UINT poolCapacity = max_u(max_u(index->poolCapacity*2, NP2_AUTOC_INIT_BUF_SIZE), index->poolSize + poolSize);
+		char *pool = (char *)((index->pool == NULL) ? NP2HeapAlloc(poolCapacity) : NP2HeapReAlloc(index->pool, poolCapacity));
+		if (pool == NULL) {
+			return FALSE;
+		}
+		index->pool = pool;
+		index->poolCapacity = poolCapacity;
+	}
+	return TRUE;
+}
+
+static BOOL SignatureIndex_Add(struct SignatureIndex *index, Sci_Line line, const char *name, UINT nameLen, const char *text, UINT textLen) {
+	const UINT size = nameLen + 1 + textLen + 1;
+	if (!SignatureIndex_Reserve(index, 1, size)) {
+		return FALSE;
+	}
+
+	struct SignatureEntry *entry = &index->entries[index->count++];
+	entry->line = line;
+	entry->offset = index->poolSize;
+	entry->nameLen = nameLen;
+	entry->textLen = textLen;
+	char *pool = index->pool + index->poolSize;
+	CopyMemory(pool, name, nameLen);
+	pool[nameLen] = '\0';
+	CopyMemory(pool + nameLen + 1, text, textLen);
+	pool[nameLen + 1 + textLen] = '\0';
+	index->poolSize += size;
+	index->poolUsed += size;
+	return TRUE;
+}
+
+// add definitions in text, line is the line number of text.
+static BOOL SignatureIndex_AddText(struct SignatureIndex *index, const char *text, Sci_Position length, Sci_Line line, BackgroundWorker *worker) {
+	const char * const end = text + length;
+	while (text < end) {
+		const char *lineEnd = text;
+		while (lineEnd < end && *lineEnd != '\r' && *lineEnd != '\n') {
+			++lineEnd;
+		}
+
+		int nameStart;
+		int nameEnd;
+		int textStart;
+		int textEnd;
+		const int lineLength = (int)min_pos(lineEnd - text, NP2_CALLTIP_MAX_LINE_LENGTH);
+		if (FindSignatureInLine(text, lineLength, index->mode, &nameStart, &nameEnd, &textStart, &textEnd)) {
+			const int nameLen = nameEnd - nameStart;
+			if (nameLen <= NP2_CALLTIP_MAX_NAME_LENGTH) {
+				const int textLen = min_i(textEnd - textStart, NP2_CALLTIP_MAX_SIGNATURE_LENGTH);
+				if (!SignatureIndex_Add(index, line, text + nameStart, nameLen, text + textStart, textLen)) {
+					return FALSE;
+				}
+			}
+		}
+
+		if (lineEnd < end && *lineEnd == '\r' && lineEnd + 1 < end && lineEnd[1] == '\n') {
+			++lineEnd;
+		}
+		text = lineEnd + 1;
+		++line;
+		if (worker != NULL && (line & 0xfff) == 0 && !BackgroundWorker_Continue(worker)) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+// first entry with line >= given line
+static UINT SignatureIndex_LowerBound(const struct SignatureIndex *index, Sci_Line line) {
+	UINT low = 0;
+	UINT high = index->count;
+	while (low < high) {
+		const UINT mid = (low + high) / 2;
+		if (index->entries[mid].line < line) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+static void SignatureIndex_Compact(struct SignatureIndex *index) {
+	char *pool = (char *)NP2HeapAlloc(index->poolUsed + NP2_AUTOC_INIT_BUF_SIZE);
+	if (pool == NULL) {
+		return;
+	}
+	UINT poolSize = 0;
+	for (UINT i = 0; i < index->count; i++) {
+		struct SignatureEntry *entry = &index->entries[i];
+		const UINT size = entry->nameLen + 1 + entry->textLen + 1;
+		CopyMemory(pool + poolSize, index->pool + entry->offset, size);
+		entry->offset = poolSize;
+		poolSize += size;
+	}
+	NP2HeapFree(index->pool);
+	index->pool = pool;
+	index->poolSize = poolSize;
+	index->poolCapacity = index->poolUsed + NP2_AUTOC_INIT_BUF_SIZE;
+}
+
+// replace signatures in old lines [first, lastOld] with definitions in document lines [first, lastNew].
+static BOOL SignatureIndex_ReplaceLines(struct SignatureIndex *index, Sci_Line first, Sci_Line lastOld, Sci_Line lastNew) {
+	struct SignatureIndex added;
+	ZeroMemory(&added, sizeof(added));
+	added.mode = index->mode;
+	const Sci_Position startPos = SciCall_PositionFromLine(first);
+	const Sci_Position endPos = SciCall_PositionFromLine(lastNew + 1);
+	BOOL success = SignatureIndex_AddText(&added, SciCall_GetRangePointer(startPos, endPos - startPos), endPos - startPos, first, NULL);
+	if (success) {
+		success = SignatureIndex_Reserve(index, added.count, added.poolSize);
+	}
+	if (!success) {
+		SignatureIndex_Free(&added);
+		return FALSE;
+	}
+
+	const UINT low = SignatureIndex_LowerBound(index, first);
+	const UINT high = SignatureIndex_LowerBound(index, lastOld + 1);
+	struct SignatureEntry * const entries = index->entries;
+	for (UINT i = low; i < high; i++) {
+		index->poolUsed -= entries[i].nameLen + 1 + entries[i].textLen + 1;
+	}
+	if (added.count != high - low) {
+		MoveMemory(entries + low + added.count, entries + high, (index->count - high) * sizeof(struct SignatureEntry));
+		index->count = index->count - (high - low) + added.count;
+	}
+	for (UINT i = 0; i < added.count; i++) {
+		struct SignatureEntry *entry = &entries[low + i];
+		*entry = added.entries[i];
+		entry->offset += index->poolSize;
+	}
+	if (added.count != 0) {
+		CopyMemory(index->pool + index->poolSize, added.pool, added.poolSize);
+		index->poolSize += added.poolSize;
+		index->poolUsed += added.poolSize;
+	}
+	const Sci_Line delta = lastNew - lastOld;
+	if (delta != 0) {
+		for (UINT i = low + added.count; i < index->count; i++) {
+			entries[i].line += delta;
+		}
+	}
+	if ((high != low || added.count != 0) && index->order != NULL) {
+		NP2HeapFree(index->order);
+		index->order = NULL;
+	}
+	if (index->poolSize > NP2_AUTOC_INIT_BUF_SIZE && index->poolSize/2 > index->poolUsed) {
+		SignatureIndex_Compact(index);
+	}
+	SignatureIndex_Free(&added);
+	return TRUE;
+}
+
+static void SignatureIndexBuilder_Stop(SignatureIndexBuilder *builder) {
+	if (builder->active) {
+		// APPM_SIGNATUREINDEX dispatched while waiting is ignored
+		builder->active = FALSE;
+		BackgroundWorker_Destroy(&builder->worker);
+		SignatureIndex_Free(&builder->index);
+		SciCall_ReleaseTextSnapshot(builder->snapshot);
+		builder->snapshot = NULL;
+	}
+}
+
+void AutoC_DiscardSignatureIndex(void) {
+	SignatureIndexBuilder_Stop(&signatureIndexBuilder);
+	SignatureIndex_Free(&signatureIndex);
+}
+
+static DWORD WINAPI SignatureIndexBuildThread(LPVOID lpParam) {
+	SignatureIndexBuilder *builder = (SignatureIndexBuilder *)lpParam;
+	BackgroundWorker *worker = &builder->worker;
+	struct SignatureIndex *index = &builder->index;
+
+	BOOL success = SignatureIndex_Reserve(index, NP2_CALLTIP_INDEX_INIT_CAPACITY, NP2_AUTOC_INIT_BUF_SIZE);
+	if (success) {
+		success = SignatureIndex_AddText(index, builder->snapshot, builder->snapshotLength, 0, worker);
+	}
+	builder->success = success;
+	PostMessage(worker->hwnd, APPM_SIGNATUREINDEX, 0, 0);
+	return 0;
+}
+
+static void SignatureIndexBuilder_Start(SignatureIndexBuilder *builder, int mode) {
+	const Sci_Position iDocLen = SciCall_GetLength();
+	const char *snapshot = SciCall_AcquireTextSnapshot();
+	if (snapshot == NULL) {
+		return;
+	}
+
+	ZeroMemory(builder, sizeof(SignatureIndexBuilder));
+	BackgroundWorker_Init(&builder->worker, hwndMain);
+	builder->index.mode = mode;
+	builder->index.lineCount = SciCall_GetLineCount();
+	builder->snapshot = snapshot;
+	builder->snapshotLength = iDocLen;
+	builder->dirtyFirst = -1;
+	builder->active = TRUE;
+	if (!BackgroundWorker_Start(&builder->worker, SignatureIndexBuildThread, builder, WorkerPriority_Low)) {
+		SignatureIndexBuilder_Stop(builder);
+	}
+}
+
+void AutoC_OnSignatureIndexBuilt(void) {
+	SignatureIndexBuilder *builder = &signatureIndexBuilder;
+	if (!builder->active) {
+		return;
+	}
+
+	// the thread exits after posting the message
+	WaitForSingleObject(builder->worker.workerThread, INFINITE);
+	BackgroundWorker_Destroy(&builder->worker);
+	builder->active = FALSE;
+	SciCall_ReleaseTextSnapshot(builder->snapshot);
+	builder->snapshot = NULL;
+
+	struct SignatureIndex *index = &builder->index;
+	const Sci_Line lineCount = SciCall_GetLineCount();
+	BOOL success = builder->success && index->lineCount + builder->dirtyDelta == lineCount;
+	if (success && builder->dirtyFirst >= 0) {
+		// lines outside changed range are same in snapshot and document
+		success = SignatureIndex_ReplaceLines(index, builder->dirtyFirst, builder->dirtyLast - builder->dirtyDelta, builder->dirtyLast);
+	}
+	if (success) {
+		SignatureIndex_Free(&signatureIndex);
+		index->lineCount = lineCount;
+		index->docLength = SciCall_GetLength();
+		signatureIndex = *index;
+		ZeroMemory(index, sizeof(struct SignatureIndex));
+	} else {
+		SignatureIndex_Free(index);
+	}
+}
+
+static void AutoC_OnSignatureIndexModified(BOOL insert, Sci_Position position, Sci_Position length, const char *text, Sci_Line linesAdded) {
+	SignatureIndexBuilder *builder = &signatureIndexBuilder;
+	struct SignatureIndex *index = &signatureIndex;
+	if (!builder->active && index->entries == NULL) {
+		return;
+	}
+	if (text == NULL) {
+		// bulk change with undo collection disabled, text may also be added without notification
+		AutoC_DiscardSignatureIndex();
+		return;
+	}
+
+	// also rescan previous line, which is changed when CR + LF is joined or split
+	const Sci_Line line = SciCall_LineFromPosition(position);
+	const Sci_Line first = max_pos(0, line - 1);
+	const Sci_Line lastNew = insert ? SciCall_LineFromPosition(position + length) : line;
+	const Sci_Line lastOld = lastNew - linesAdded;
+	if (builder->active) {
+		// record changed lines since snapshot
+		if (builder->dirtyFirst < 0) {
+			builder->dirtyFirst = first;
+			builder->dirtyLast = lastNew;
+		} else if (builder->dirtyLast > lastOld) {
+			builder->dirtyLast += linesAdded;
+		}
+		builder->dirtyFirst = min_pos(builder->dirtyFirst, first);
+		builder->dirtyLast = max_pos(builder->dirtyLast, lastNew);
+		builder->dirtyDelta += linesAdded;
+		return;
+	}
+
+	if (SignatureIndex_ReplaceLines(index, first, lastOld, lastNew)) {
+		index->lineCount += linesAdded;
+		index->docLength += insert ? length : -length;
+	} else {
+		AutoC_DiscardSignatureIndex();
 	}
-	return TRUE;
 }
 
-static inline BOOL NeedSpaceAfterKeyword(const char *word, Sci_Position length) {
-	const char *p = strstr(
-		" if for try using while elseif switch foreach synchronized "
-		, word);
-	return p != NULL && p[-1] == ' ' && p[length] == ' ';
+static const struct SignatureIndex *pSortingSignatureIndex;
+static int __cdecl CmpSignatureName(const void *p1, const void *p2) {
+	const struct SignatureIndex *index = pSortingSignatureIndex;
+	const struct SignatureEntry *entry1 = &index->entries[*(const UINT *)p1];
+	const struct SignatureEntry *entry2 = &index->entries[*(const UINT *)p2];
+	const int cmp = strcmp(index->pool + entry1->offset, index->pool + entry2->offset);
+	// keep document order for overloaded function
+	return cmp ? cmp : ((entry1->line < entry2->line) ? -1 : (entry1->line > entry2->line));
 }
 
-#define HTML_TEXT_BLOCK_TAG		0
-#define HTML_TEXT_BLOCK_CDATA	1
-#define HTML_TEXT_BLOCK_JS		2
-#define HTML_TEXT_BLOCK_VBS		3
-#define HTML_TEXT_BLOCK_PYTHON	4
-#define HTML_TEXT_BLOCK_PHP		5
-#define HTML_TEXT_BLOCK_CSS		6
-#define HTML_TEXT_BLOCK_SGML	7
+static BOOL SignatureIndex_SortByName(struct SignatureIndex *index) {
+	UINT *order = (UINT *)NP2HeapAlloc((index->count + 1) * sizeof(UINT));
+	if (order == NULL) {
+		return FALSE;
+	}
+	for (UINT i = 0; i < index->count; i++) {
+		order[i] = i;
+	}
+	pSortingSignatureIndex = index;
+	qsort(order, index->count, sizeof(UINT), CmpSignatureName);
+	pSortingSignatureIndex = NULL;
+	index->order = order;
+	return TRUE;
+}
 
-enum {
-	InnoLineStatePreprocessor = 8,
-	InnoLineStateCodeSection = 16,
-};
+// append signatures of the function to buffer, return number of signatures.
+static int SignatureIndex_Find(struct SignatureIndex *index, LPCSTR name, char *buffer, int bufferSize) {
+	if (index->order == NULL && !SignatureIndex_SortByName(index)) {
+		return 0;
+	}
 
-extern EDITLEXER lexCSS;
-extern EDITLEXER lexJavaScript;
-extern EDITLEXER lexJulia;
-extern EDITLEXER lexPHP;
-extern EDITLEXER lexPython;
-extern EDITLEXER lexVBS;
-extern HANDLE idleTaskTimer;
+	const UINT * const order = index->order;
+	UINT low = 0;
+	UINT high = index->count;
+	while (low < high) {
+		const UINT mid = (low + high) / 2;
+		if (strcmp(index->pool + index->entries[order[mid]].offset, name) < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
 
-static int GetCurrentHtmlTextBlockEx(int iCurrentStyle) {
-	if (iCurrentStyle == SCE_H_CDATA) {
-		return HTML_TEXT_BLOCK_CDATA;
+	int found = 0;
+	int length = (int)strlen(buffer);
+	for (; low < index->count && found < NP2_CALLTIP_MAX_OVERLOAD_COUNT; low++) {
+		const struct SignatureEntry *entry = &index->entries[order[low]];
+		LPCSTR pName = index->pool + entry->offset;
+		if (strcmp(pName, name) != 0) {
+			break;
+		}
+		if (length + (int)entry->textLen + 2 > bufferSize) {
+			break;
+		}
+		if (length != 0) {
+			buffer[length++] = '\n';
+		}
+		CopyMemory(buffer + length, pName + entry->nameLen + 1, entry->textLen + 1);
+		length += entry->textLen;
+		++found;
 	}
-	if ((iCurrentStyle >= SCE_HJ_START && iCurrentStyle <= SCE_HJ_TEMPLATELITERAL)
-		|| (iCurrentStyle >= SCE_HJA_START && iCurrentStyle <= SCE_HJA_TEMPLATELITERAL)) {
-		return HTML_TEXT_BLOCK_JS;
+	return found;
+}
+
+void AutoC_OnDocumentModified(BOOL insert, Sci_Position position, Sci_Position length, const char *text, Sci_Line linesAdded) {
+	AutoC_OnSignatureIndexModified(insert, position, length, text, linesAdded);
+	if (docWordIndexBuilder.active) {
+		DocWordIndexBuilder_OnModified(&docWordIndexBuilder, insert, position, length);
+		return;
 	}
-	if ((iCurrentStyle >= SCE_HB_START && iCurrentStyle <= SCE_HB_OPERATOR)
-		|| (iCurrentStyle >= SCE_HBA_START && iCurrentStyle <= SCE_HBA_OPERATOR)) {
-		return HTML_TEXT_BLOCK_VBS;
+	struct DocWordIndex *index = &docWordIndex;
+	if (index->capacity == 0) {
+		return;
 	}
-	if ((iCurrentStyle >= SCE_HP_START && iCurrentStyle <= SCE_HP_IDENTIFIER)
-		|| (iCurrentStyle >= SCE_HPA_START && iCurrentStyle <= SCE_HPA_IDENTIFIER)) {
-		return HTML_TEXT_BLOCK_PYTHON;
+	if (text == NULL) {
+		// deleted text not available when undo collection is disabled
+		AutoC_DiscardDocWordIndex();
+		return;
 	}
-	if ((iCurrentStyle >= SCE_HPHP_DEFAULT && iCurrentStyle <= SCE_HPHP_COMPLEX_VARIABLE)) {
-		return HTML_TEXT_BLOCK_PHP;
+
+	// words outside [start, end) not changed
+	Sci_Position start = position;
+	Sci_Position end = insert ? (position + length) : position;
+	if (!DocWordIndex_ExtendRange(&start, &end)) {
+		AutoC_DiscardDocWordIndex();
+		return;
 	}
-	if ((iCurrentStyle >= SCE_H_SGML_DEFAULT && iCurrentStyle <= SCE_H_SGML_BLOCK_DEFAULT)) {
-		return HTML_TEXT_BLOCK_SGML;
+
+	// remove words in old text: text before, deleted text, text after
+	const Sci_Position before = position - start;
+	const Sci_Position after = insert ? (end - position - length) : (end - position);
+	const Sci_Position oldLength = before + (insert ? 0 : length) + after;
+	BOOL success = TRUE;
+	if (oldLength != 0) {
+		char *buffer = (char *)NP2HeapAlloc(oldLength + 1);
+		success = buffer != NULL;
+		if (success) {
+			struct Sci_TextRange tr = { { start, position }, buffer };
+			SciCall_GetTextRange(&tr);
+			if (!insert) {
+				CopyMemory(buffer + before, text, length);
+			}
+			tr.chrg.cpMin = end - after;
+			tr.chrg.cpMax = end;
+			tr.lpstrText = buffer + oldLength - after;
+			SciCall_GetTextRange(&tr);
+			success = DocWordIndex_UpdateText(index, buffer, oldLength, FALSE);
+			NP2HeapFree(buffer);
+		}
 	}
-	return HTML_TEXT_BLOCK_TAG;
-}
 
-static int GetCurrentHtmlTextBlock(void) {
-	const Sci_Position iCurrentPos = SciCall_GetCurrentPos();
-	const int iCurrentStyle = SciCall_GetStyleAt(iCurrentPos);
-	return GetCurrentHtmlTextBlockEx(iCurrentStyle);
+	// add words in new text
+	if (success && end > start) {
+		success = DocWordIndex_UpdateText(index, SciCall_GetRangePointer(start, end - start), end - start, TRUE);
+	}
+	if (success) {
+		index->docLength += insert ? length : -length;
+	} else {
+		AutoC_DiscardDocWordIndex();
+	}
 }
 
-static void EscapeRegex(LPSTR pszOut, LPCSTR pszIn) {
-	char ch;
-	while ((ch = *pszIn++) != '\0') {
-		if (ch == '.'		// any character
-			|| ch == '^'	// start of line
-			|| ch == '$'	// end of line
-			|| ch == '?'	// 0 or 1 times
-			|| ch == '*'	// 0 or more times
-			|| ch == '+'	// 1 or more times
-			|| ch == '[' || ch == ']'
-			|| ch == '(' || ch == ')'
-			) {
-			*pszOut++ = '\\';
+static BOOL AutoC_AddIndexedDocWord(struct WordList *pWList, char prefix) {
+	const int iRootLen = pWList->iStartLen;
+	if (prefix || iRootLen == 0 || IsDBCSCodePage(SciCall_GetCodePage())) {
+		return FALSE;
+	}
+	const Sci_Position iDocLen = SciCall_GetLength();
+	struct DocWordIndex *index = &docWordIndex;
+	if (index->capacity == 0 && iDocLen < NP2_AUTOC_INDEX_MIN_DOC_SIZE) {
+		return FALSE;
+	}
+	LPCSTR const pRoot = pWList->pWordStart;
+	for (int i = 0; i < iRootLen; i++) {
+		if (!IsDefaultWordChar((uint8_t)pRoot[i])) {
+			return FALSE;
 		}
-		*pszOut++ = ch;
 	}
-	*pszOut++ = '\0';
+	if (index->capacity != 0 && index->docLength != iDocLen) {
+		// text changed without notification
+		DocWordIndex_Free(index);
+	}
+	if (index->capacity == 0) {
+		// use regex scan until the index is built
+		if (!docWordIndexBuilder.active) {
+			DocWordIndexBuilder_Start(&docWordIndexBuilder);
+		}
+		return FALSE;
+	}
+
+	// skip current word when it only appears once
+	Sci_Position iStartPos = SciCall_GetCurrentPos() - iRootLen;
+	Sci_Position iEndPos = iStartPos + iRootLen;
+	DocWordIndex_ExtendRange(&iStartPos, &iEndPos);
+	const Sci_Position iCurrentLen = iEndPos - iStartPos;
+	const char *pCurrent = SciCall_GetRangePointer(iStartPos, iCurrentLen);
+	for (UINT i = 0; i < index->capacity; i++) {
+		const struct DocWordEntry *entry = &index->table[i];
+		if (entry->count && entry->len >= (UINT)iRootLen) {
+			LPCSTR pWord = index->pool + entry->offset;
+			if (WordList_StartsWith(pWList, pWord)) {
+				if (entry->count == 1 && entry->len == (UINT)iCurrentLen && memcmp(pWord, pCurrent, iCurrentLen) == 0) {
+					continue;
+				}
+				WordList_AddWord(pWList, pWord, entry->len);
+			}
+		}
+	}
+	return TRUE;
 }
 
 void AutoC_AddDocWord(struct WordList *pWList, BOOL bIgnoreCase, char prefix) {
+	if (AutoC_AddIndexedDocWord(pWList, prefix)) {
+		return;
+	}
+
 	LPCSTR const pRoot = pWList->pWordStart;
 	const int iRootLen = pWList->iStartLen;
 
@@ -971,14 +2040,187 @@ void AutoC_AddDocWord(struct WordList *pWList, BOOL bIgnoreCase, char prefix) {
 	}
 }
 
-void AutoC_AddKeyword(struct WordList *pWList, int iCurrentStyle) {
+/*
+keywords of a lexer split once with the same rules as WordList_AddListEx(), and sorted
+case insensitively, so words starting with the root are found with binary search.
+*/
+struct KeywordIndex {
+	LPCEDITLEXER pLex;
+	char *buffer;
+	UINT offset;
+	UINT capacity;
+	UINT *offsets;
+	UINT count;
+	UINT entryCapacity;
+	LPCSTR *words;
+};
+
+static struct KeywordIndex lexerKeywordIndex;
+static struct KeywordIndex embeddedKeywordIndex;
+
+static void KeywordIndex_Free(struct KeywordIndex *pIndex) {
+	if (pIndex->buffer) {
+		NP2HeapFree(pIndex->buffer);
+	}
+	if (pIndex->offsets) {
+		NP2HeapFree(pIndex->offsets);
+	}
+	if (pIndex->words) {
+		NP2HeapFree(pIndex->words);
+	}
+	ZeroMemory(pIndex, sizeof(struct KeywordIndex));
+}
+
+static void KeywordIndex_AddWord(struct KeywordIndex *pIndex, LPCSTR pWord, int len) {
+	// 4 bytes padding for WordList_Order()
+	const UINT size = align_up(len + 1 + 4);
+	if (pIndex->capacity < pIndex->offset + size) {
+		pIndex->capacity = max_u(pIndex->capacity << 1, pIndex->offset + size);
+		pIndex->buffer = (char *)NP2HeapReAlloc(pIndex->buffer, pIndex->capacity);
+	}
+	if (pIndex->count == pIndex->entryCapacity) {
+		pIndex->entryCapacity <<= 1;
+		pIndex->offsets = (UINT *)NP2HeapReAlloc(pIndex->offsets, pIndex->entryCapacity * sizeof(UINT));
+	}
+
+	char *word = pIndex->buffer + pIndex->offset;
+	CopyMemory(word, pWord, len);
+	ZeroMemory(word + len, size - len);
+	pIndex->offsets[pIndex->count++] = pIndex->offset;
+	pIndex->offset += size;
+}
+
+// same as WordList_AddListEx() with empty root.
+static void KeywordIndex_AddList(struct KeywordIndex *pIndex, LPCSTR pList) {
+	char word[1024];
+	int len = 0;
+	do {
+		const char *sub = strpbrk(pList, " \t.,();^\n\r");
+		if (sub) {
+			int lenSub = (int)(sub - pList);
+			lenSub = min_i(NP2_AUTOC_MAX_WORD_LENGTH - len, lenSub);
+			memcpy(word + len, pList, lenSub);
+			len += lenSub;
+			if (len != 0) {
+				if (*sub == '(') {
+					word[len++] = '(';
+					word[len++] = ')';
+				}
+				KeywordIndex_AddWord(pIndex, word, len);
+			}
+			if (*sub == '^') {
+				word[len++] = ' ';
+			} else if (*sub != '.') {
+				len = 0;
+			} else {
+				word[len++] = '.';
+			}
+			pList = ++sub;
+		} else {
+			int lenSub = (int)strlen(pList);
+			lenSub = min_i(NP2_AUTOC_MAX_WORD_LENGTH - len, lenSub);
+			memcpy(word + len, pList, lenSub);
+			len += lenSub;
+			if (len != 0) {
+				KeywordIndex_AddWord(pIndex, word, len);
+			}
+			break;
+		}
+	} while (*pList);
+}
+
+static int __cdecl CmpKeywordIndexWord(const void *p1, const void *p2) {
+	return _stricmp(*(LPCSTR *)p1, *(LPCSTR *)p2);
+}
+
+static void KeywordIndex_Build(struct KeywordIndex *pIndex, LPCEDITLEXER pLex, const uint8_t *attr) {
+	KeywordIndex_Free(pIndex);
+	pIndex->pLex = pLex;
+	pIndex->capacity = NP2_AUTOC_INIT_BUF_SIZE;
+	pIndex->buffer = (char *)NP2HeapAlloc(pIndex->capacity);
+	pIndex->entryCapacity = NP2_AUTOC_INIT_WORD_COUNT;
+	pIndex->offsets = (UINT *)NP2HeapAlloc(pIndex->entryCapacity * sizeof(UINT));
 	for (int i = 0; i < NUMKEYWORD; i++) {
-		const char *pKeywords = pLexCurrent->pKeyWords->pszKeyWords[i];
-		if (StrNotEmptyA(pKeywords) && !(currentLexKeywordAttr[i] & KeywordAttr_NoAutoComp)) {
-			WordList_AddListEx(pWList, pKeywords);
+		const char *pKeywords = pLex->pKeyWords->pszKeyWords[i];
+		if (StrNotEmptyA(pKeywords) && !(attr != NULL && (attr[i] & KeywordAttr_NoAutoComp))) {
+			KeywordIndex_AddList(pIndex, pKeywords);
+		}
+	}
+
+	// buffer is no longer resized
+	const UINT count = pIndex->count;
+	LPCSTR *words = (LPCSTR *)NP2HeapAlloc((count + 1) * sizeof(LPCSTR));
+	for (UINT i = 0; i < count; i++) {
+		words[i] = pIndex->buffer + pIndex->offsets[i];
+	}
+	qsort(words, count, sizeof(LPCSTR), CmpKeywordIndexWord);
+	pIndex->words = words;
+	NP2HeapFree(pIndex->offsets);
+	pIndex->offsets = NULL;
+}
+
+static void KeywordIndex_AddMatches(const struct KeywordIndex *pIndex, struct WordList *pWList) {
+	LPCSTR const pRoot = pWList->pWordStart;
+	const int iRootLen = pWList->iStartLen;
+	LPCSTR const *words = pIndex->words;
+	const UINT count = pIndex->count;
+	UINT low = 0;
+	UINT high = count;
+	while (low < high) {
+		const UINT mid = (low + high) / 2;
+		if (_strnicmp(words[mid], pRoot, iRootLen) < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
 		}
 	}
 
+	for (; low < count; low++) {
+		LPCSTR word = words[low];
+		if (_strnicmp(word, pRoot, iRootLen) != 0) {
+			break;
+		}
+		if (WordList_StartsWith(pWList, word)) {
+			WordList_AddWord(pWList, word, (int)strlen(word));
+		}
+	}
+}
+
+static BOOL KeywordIndex_Contains(const struct KeywordIndex *pIndex, LPCSTR word) {
+	LPCSTR const *words = pIndex->words;
+	UINT low = 0;
+	UINT high = pIndex->count;
+	while (low < high) {
+		const UINT mid = (low + high) / 2;
+		if (_stricmp(words[mid], word) < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	for (; low < pIndex->count && _stricmp(words[low], word) == 0; low++) {
+		if (strcmp(words[low], word) == 0) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// index is rebuilt on first auto-completion or call tip after lexer changed.
+void Style_ResetLexerKeywordIndex(void) {
+	KeywordIndex_Free(&lexerKeywordIndex);
+}
+
+static inline void AutoC_EnsureKeywordIndex(void) {
+	if (lexerKeywordIndex.pLex != pLexCurrent) {
+		KeywordIndex_Build(&lexerKeywordIndex, pLexCurrent, currentLexKeywordAttr);
+	}
+}
+
+void AutoC_AddKeyword(struct WordList *pWList, int iCurrentStyle) {
+	AutoC_EnsureKeywordIndex();
+	KeywordIndex_AddMatches(&lexerKeywordIndex, pWList);
+
 	// additional keywords
 	if (np2_LexKeyword && !(pLexCurrent->iLexer == SCLEX_CPP && !IsCppCommentStyle(iCurrentStyle))) {
 		WordList_AddList(pWList, (*np2_LexKeyword)[0]);
@@ -1012,12 +2254,10 @@ void AutoC_AddKeyword(struct WordList *pWList, int iCurrentStyle) {
 		pLex = &lexJavaScript;
 	}
 	if (pLex != NULL) {
-		for (int i = 0; i < NUMKEYWORD; i++) {
-			const char *pKeywords = pLex->pKeyWords->pszKeyWords[i];
-			if (StrNotEmptyA(pKeywords)) {
-				WordList_AddListEx(pWList, pKeywords);
-			}
+		if (embeddedKeywordIndex.pLex != pLex) {
+			KeywordIndex_Build(&embeddedKeywordIndex, pLex, NULL);
 		}
+		KeywordIndex_AddMatches(&embeddedKeywordIndex, pWList);
 	}
 }
 
@@ -1263,6 +2503,83 @@ void EditCompleteUpdateConfig(void) {
 	autoCompletionConfig.wszAutoCompleteFillUp[k] = L'\0';
 }
 
+#if NP2_AUTOC_PROFILE
+#define NP2_AUTOC_PROFILE_SAMPLE_COUNT	64
+
+enum {
+	AutoCProfileStage_Keyword,	// keywords and special words
+	AutoCProfileStage_DocWord,	// scan or index lookup of document words
+	AutoCProfileStage_Sort,		// WordList_GetList()
+	AutoCProfileStage_Show,		// SCI_AUTOCSHOW, list box population
+	AutoCProfileStage_Total,
+	AutoCProfileStage_Count,
+};
+
+typedef struct AutoCProfile {
+	StopWatch watch;
+	double elapsed[AutoCProfileStage_Count];
+	double samples[AutoCProfileStage_Count][NP2_AUTOC_PROFILE_SAMPLE_COUNT];
+	UINT sampleCount;
+	UINT sampleIndex;
+} AutoCProfile;
+
+static AutoCProfile autoCompletionProfile;
+
+static void AutoCProfile_Start(AutoCProfile *profile) {
+	ZeroMemory(profile->elapsed, sizeof(profile->elapsed));
+	StopWatch_Start(profile->watch);
+}
+
+static void AutoCProfile_Mark(AutoCProfile *profile, int stage) {
+	StopWatch_Stop(profile->watch);
+	const double elapsed = StopWatch_Get(&profile->watch);
+	profile->elapsed[stage] += elapsed;
+	profile->elapsed[AutoCProfileStage_Total] += elapsed;
+	StopWatch_Restart(profile->watch);
+}
+
+static int __cdecl CmpDouble(const void *p1, const void *p2) {
+	const double d1 = *(const double *)p1;
+	const double d2 = *(const double *)p2;
+	return (d1 < d2) ? -1 : (d1 > d2);
+}
+
+static void AutoCProfile_Finish(AutoCProfile *profile, UINT wordCount, UINT totalLen) {
+	const UINT index = profile->sampleIndex;
+	for (int stage = 0; stage < AutoCProfileStage_Count; stage++) {
+		profile->samples[stage][index] = profile->elapsed[stage];
+	}
+	profile->sampleIndex = (index + 1) % NP2_AUTOC_PROFILE_SAMPLE_COUNT;
+	if (profile->sampleCount < NP2_AUTOC_PROFILE_SAMPLE_COUNT) {
+		++profile->sampleCount;
+	}
+
+	static const char * const stageName[AutoCProfileStage_Count] = {
+		"keyword", "doc", "sort", "show", "total",
+	};
+	const UINT count = profile->sampleCount;
+	char msg[512];
+	int len = sprintf(msg, "AutoC(%u, %u, %u)", wordCount, totalLen, count);
+	for (int stage = 0; stage < AutoCProfileStage_Count; stage++) {
+		double sorted[NP2_AUTOC_PROFILE_SAMPLE_COUNT];
+		CopyMemory(sorted, profile->samples[stage], count * sizeof(double));
+		qsort(sorted, count, sizeof(double), CmpDouble);
+		len += sprintf(msg + len, " %s=%.3f/%.3f/%.3f", stageName[stage],
+			profile->elapsed[stage], sorted[(count - 1)/2], sorted[(count - 1)*99/100]);
+	}
+	// same format as StopWatch_ShowLog(), time in milliseconds: current/p50/p99
+	printf("%s %s\n", "Notepad2", msg);
+}
+
+#define AutoC_ProfileStart()			AutoCProfile_Start(&autoCompletionProfile)
+#define AutoC_ProfileMark(stage)		AutoCProfile_Mark(&autoCompletionProfile, AutoCProfileStage_##stage)
+#define AutoC_ProfileFinish(pWList)		AutoCProfile_Finish(&autoCompletionProfile, (pWList)->nWordCount, (pWList)->nTotalLen)
+#else
+#define AutoC_ProfileStart()
+#define AutoC_ProfileMark(stage)
+#define AutoC_ProfileFinish(pWList)
+#endif
+
 static BOOL EditCompleteWordCore(int iCondition, BOOL autoInsert) {
 	const Sci_Position iCurrentPos = SciCall_GetCurrentPos();
 	const int iCurrentStyle = SciCall_GetStyleAt(iCurrentPos);
@@ -1387,11 +2704,7 @@ static BOOL EditCompleteWordCore(int iCondition, BOOL autoInsert) {
 	SciCall_GetTextRange(&tr);
 	iRootLen = (int)strlen(pRoot);
 
-#if 0
-	StopWatch watch;
-	StopWatch_Start(watch);
-#endif
-
+	AutoC_ProfileStart();
 	BOOL bIgnore = iRootLen != 0 && (pRoot[0] >= '0' && pRoot[0] <= '9'); // number
 	const BOOL bIgnoreCase = bIgnore || autoCompletionConfig.bIgnoreCase;
 	struct WordList *pWList = WordList_Alloc(pRoot, iRootLen, bIgnoreCase);
@@ -1413,12 +2726,14 @@ static BOOL EditCompleteWordCore(int iCondition, BOOL autoInsert) {
 		}
 	}
 
+	AutoC_ProfileMark(Keyword);
 	BOOL retry = FALSE;
 	const BOOL bScanWordsInDocument = autoCompletionConfig.bScanWordsInDocument;
 	do {
 		if (!bIgnore) {
 			// keywords
 			AutoC_AddKeyword(pWList, iCurrentStyle);
+			AutoC_ProfileMark(Keyword);
 		}
 		if (bScanWordsInDocument) {
 			if (!bIgnoreDoc || pWList->nWordCount == 0) {
@@ -1428,6 +2743,7 @@ static BOOL EditCompleteWordCore(int iCondition, BOOL autoInsert) {
 				prefix = '\0';
 				AutoC_AddDocWord(pWList, bIgnoreCase, prefix);
 			}
+			AutoC_ProfileMark(DocWord);
 		}
 
 		retry = FALSE;
@@ -1449,12 +2765,6 @@ static BOOL EditCompleteWordCore(int iCondition, BOOL autoInsert) {
 		}
 	} while (retry);
 
-#if 0
-	StopWatch_Stop(watch);
-	const double elapsed = StopWatch_Get(&watch);
-	printf("Notepad2 AddDocWord(%u, %u): %.6f\n", pWList->nWordCount, pWList->nTotalLen, elapsed);
-#endif
-
 	const BOOL bShow = pWList->nWordCount > 0 && !(pWList->nWordCount == 1 && pWList->iMaxLength == iRootLen);
 	const BOOL bUpdated = (autoCompletionConfig.iPreviousItemCount == 0)
 		// deleted some words. leave some words that no longer matches current input at the top.
@@ -1465,7 +2775,8 @@ static BOOL EditCompleteWordCore(int iCondition, BOOL autoInsert) {
 	if (bShow && bUpdated) {
 		autoCompletionConfig.iPreviousItemCount = pWList->nWordCount;
 		char *pList = WordList_GetList(pWList);
-		SciCall_AutoCSetOptions(SC_AUTOCOMPLETE_FIXED_SIZE);
+		AutoC_ProfileMark(Sort);
+		SciCall_AutoCSetOptions(SC_AUTOCOMPLETE_FIXED_SIZE | (autoCompletionConfig.bFuzzyMatch ? SC_AUTOCOMPLETE_FUZZY_MATCH : 0));
 		SciCall_AutoCSetOrder(SC_ORDER_PRESORTED); // pre-sorted
 		SciCall_AutoCSetIgnoreCase(bIgnoreCase); // case sensitivity
 		//if (bIgnoreCase) {
@@ -1480,7 +2791,9 @@ static BOOL EditCompleteWordCore(int iCondition, BOOL autoInsert) {
 		SciCall_AutoCSetChooseSingle(autoInsert);
 		SciCall_AutoCShow(pWList->iStartLen, pList);
 		NP2HeapFree(pList);
+		AutoC_ProfileMark(Show);
 	}
+	AutoC_ProfileFinish(pWList);
 
 	if (pRoot != onStack) {
 		NP2HeapFree(pRoot);
@@ -1502,7 +2815,9 @@ void EditCompleteWord(int iCondition, BOOL autoInsert) {
 		autoCompletionConfig.iPreviousItemCount = 0; // recreate list
 	}
 
+	NP2_TRACE_START("CompleteWord", NP2_TRACE_INT64(iCondition, "condition"));
 	BOOL bShow = EditCompleteWordCore(iCondition, autoInsert);
+	NP2_TRACE_STOP("CompleteWord", NP2_TRACE_INT64(bShow, "show"));
 	if (!bShow) {
 		autoCompletionConfig.iPreviousItemCount = 0;
 		if (iCondition != AutoCompleteCondition_Normal) {
@@ -1791,6 +3106,39 @@ void EditAutoCloseXMLTag(void) {
 	}
 }
 
+BOOL EditAutoCloseEndTag(void) {
+	const Sci_Position iCurPos = SciCall_GetCurrentPos();
+	const Sci_Position iTagStart = iCurPos - 2;
+	if (iTagStart < 0 || SciCall_GetCharAt(iTagStart) != '<' || IsHtmlTagChar(SciCall_GetCharAt(iCurPos))) {
+		return FALSE;
+	}
+
+	// tags are indexed from styled text, find the innermost open element before "</"
+	SciCall_EnsureStyledTo(iTagStart);
+	const Sci_Position iOpen = SciCall_FindTag(iTagStart, SC_TAGFIND_ENCLOSING);
+	if (iOpen < 0) {
+		return FALSE;
+	}
+
+	char tchIns[128];
+	int cchIns = 0;
+	Sci_Position iPos = iOpen + 1;
+	int ch = SciCall_GetCharAt(iPos);
+	// UTF-8 bytes are copied as is
+	while ((IsHtmlTagChar(ch) || ch >= 0x80) && cchIns < (int)COUNTOF(tchIns) - 2) {
+		tchIns[cchIns++] = (char)ch;
+		ch = SciCall_GetCharAt(++iPos);
+	}
+	if (cchIns == 0 || IsHtmlTagChar(ch) || ch >= 0x80) {
+		return FALSE;
+	}
+
+	tchIns[cchIns++] = '>';
+	tchIns[cchIns] = '\0';
+	SciCall_ReplaceSel(tchIns);
+	return TRUE;
+}
+
 BOOL IsIndentKeywordStyle(int style) {
 	switch (pLexCurrent->iLexer) {
 	//case SCLEX_AU3:
@@ -2581,19 +3929,41 @@ void EditInsertScriptShebangLine(void) {
 }
 
 void EditShowCallTips(Sci_Position position) {
-	const Sci_Line iLine = SciCall_LineFromPosition(position);
-	const Sci_Position iDocLen = SciCall_GetLineLength(iLine);
-	char *pLine = (char *)NP2HeapAlloc(iDocLen + 1);
-	SciCall_GetLine(iLine, pLine);
-	StrTrimA(pLine, " \t\r\n");
-	char *text = (char *)NP2HeapAlloc(iDocLen + 1 + 128);
-#if defined(_WIN64)
-	sprintf(text, "ShowCallTips(%" PRId64 ", %" PRId64 ", %" PRId64 ")\n\n\002%s", iLine + 1, position, iDocLen, pLine);
-#else
-	sprintf(text, "ShowCallTips(%d, %d, %d)\n\n\002%s", (int)(iLine + 1), (int)position, (int)iDocLen, pLine);
-#endif
+	const Sci_Position iStartPos = SciCall_WordStartPosition(position, TRUE);
+	const Sci_Position iWordLen = SciCall_WordEndPosition(position, TRUE) - iStartPos;
+	if (iWordLen == 0 || iWordLen > NP2_CALLTIP_MAX_NAME_LENGTH) {
+		return;
+	}
+
+	char name[NP2_CALLTIP_MAX_NAME_LENGTH + 4];
+	memcpy(name, SciCall_GetRangePointer(iStartPos, iWordLen), iWordLen);
+	name[iWordLen] = '\0';
+	char text[NP2_CALLTIP_MAX_OVERLOAD_COUNT*(NP2_CALLTIP_MAX_SIGNATURE_LENGTH + 1) + 4] = "";
+
+	const int mode = GetCurrentSignatureMode();
+	struct SignatureIndex *index = &signatureIndex;
+	if (index->entries != NULL && (index->mode != mode
+		|| index->lineCount != SciCall_GetLineCount() || index->docLength != SciCall_GetLength())) {
+		// lexer changed, or text changed without notification
+		AutoC_DiscardSignatureIndex();
+	}
+	if (mode != SignatureMode_None) {
+		if (index->entries != NULL) {
+			SignatureIndex_Find(index, name, text, COUNTOF(text));
+		} else if (!signatureIndexBuilder.active) {
+			// only lexer API list is used until the index is built
+			SignatureIndexBuilder_Start(&signatureIndexBuilder, mode);
+		}
+	}
+	if (StrIsEmptyA(text)) {
+		AutoC_EnsureKeywordIndex();
+		strcat(name, "()");
+		if (!KeywordIndex_Contains(&lexerKeywordIndex, name)) {
+			return;
+		}
+		strcpy(text, name);
+	}
+
 	SciCall_CallTipUseStyle(fvCurFile.iTabWidth);
-	SciCall_CallTipShow(position, text);
-	NP2HeapFree(pLine);
-	NP2HeapFree(text);
+	SciCall_CallTipShow(iStartPos, text);
 }
@@ -17,6 +17,8 @@
 extern BOOL bSkipUnicodeDetection;
 extern int iDefaultCodePage;
 extern int iDefaultCharSet;
+extern DWORD dwEOLSampleMinSize;
+extern int iEOLSampleBlockCount;
 
 int g_DOSEncoding;
 
@@ -509,6 +511,7 @@ void EditOnCodePageChanged(UINT oldCodePage) {
 
 	const char *text = GetFoldDisplayEllipsis(cpEdit, acp);
 	SciCall_SetDefaultFoldDisplayText(text);
+	AutoC_ResetWordCharTable();
 }
 
 //=============================================================================
@@ -1004,35 +1007,162 @@ BOOL Encoding_GetFromComboboxEx(HWND hwnd, int *pidEncoding) {
 #endif
 
 
+// BOM-less UTF-16 is detected from parity of zero bytes (high byte of ASCII characters) and
+// surrogate pairing, collected on a bounded sample and on whole buffer only when the sample is ambiguous.
+#define UTF16_DETECTION_SAMPLE_SIZE		(64*1024)
+
+enum {
+	UTF16Detection_None,
+	UTF16Detection_LittleEndian,
+	UTF16Detection_BigEndian,
+	UTF16Detection_Ambiguous,
+};
+
+typedef struct UTF16Statistics {
+	DWORD units;
+	DWORD zeroEven;		// zero byte at even offset, high byte of big endian unit
+	DWORD zeroOdd;		// zero byte at odd offset, high byte of little endian unit
+	DWORD nullUnit;
+	DWORD badLE;		// unpaired surrogate
+	DWORD badBE;
+	BOOL pendingLE;		// last unit is high surrogate
+	BOOL pendingBE;
+} UTF16Statistics;
+
+static inline void UTF16_CheckSurrogate(UINT unit, BOOL *pending, DWORD *bad) {
+	const UINT kind = unit & 0xFC00;
+	if (*pending != (kind == 0xDC00)) {
+		++*bad;
+	}
+	*pending = kind == 0xD800;
+}
+
+static void UTF16_CheckSurrogates(UTF16Statistics *stat, const uint8_t *ptr, const uint8_t *end) {
+	do {
+		UTF16_CheckSurrogate(ptr[0] | (ptr[1] << 8), &stat->pendingLE, &stat->badLE);
+		UTF16_CheckSurrogate((ptr[0] << 8) | ptr[1], &stat->pendingBE, &stat->badBE);
+		ptr += 2;
+	} while (ptr < end);
+}
+
+static void UTF16_Collect(UTF16Statistics *stat, const uint8_t *ptr, const uint8_t *end) {
+	stat->units += (DWORD)(end - ptr)/2;
+#if NP2_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i surrogateMask = _mm_set1_epi8((char)0xF8);
+	const __m128i surrogate = _mm_set1_epi8((char)0xD8);
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)ptr);
+		const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+		stat->zeroEven += np2_popcount(mask & 0x5555);
+		stat->zeroOdd += np2_popcount(mask & 0xaaaa);
+		stat->nullUnit += np2_popcount(mask & (mask >> 1) & 0x5555);
+		// only pair surrogates when some byte is in 0xD8 to 0xDF
+		const uint32_t high = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(chunk, surrogateMask), surrogate));
+		if (high || stat->pendingLE || stat->pendingBE) {
+			UTF16_CheckSurrogates(stat, ptr, ptr + sizeof(__m128i));
+		}
+		ptr += sizeof(__m128i);
+	}
+	// end NP2_USE_SSE2
+#endif
+	while (ptr < end) {
+		const BOOL zeroEven = ptr[0] == 0;
+		const BOOL zeroOdd = ptr[1] == 0;
+		stat->zeroEven += zeroEven;
+		stat->zeroOdd += zeroOdd;
+		stat->nullUnit += zeroEven & zeroOdd;
+		UTF16_CheckSurrogates(stat, ptr, ptr + 2);
+		ptr += 2;
+	}
+}
+
+static int UTF16_Classify(const UTF16Statistics *stat) {
+	// NUL is rare in text
+	if (stat->nullUnit > stat->units/64) {
+		return UTF16Detection_None;
+	}
+	// ASCII in UTF-16 has zero byte on one side only, 8-bit text has almost no zero byte.
+	const DWORD zeroLE = stat->zeroOdd - stat->nullUnit;
+	const DWORD zeroBE = stat->zeroEven - stat->nullUnit;
+	const DWORD minimum = stat->units/256 + 1;
+	if (zeroLE > zeroBE*16) {
+		if (stat->badLE != 0) {
+			return UTF16Detection_None;
+		}
+		return (zeroLE >= minimum) ? UTF16Detection_LittleEndian : UTF16Detection_Ambiguous;
+	}
+	if (zeroBE > zeroLE*16) {
+		if (stat->badBE != 0) {
+			return UTF16Detection_None;
+		}
+		return (zeroBE >= minimum) ? UTF16Detection_BigEndian : UTF16Detection_Ambiguous;
+	}
+	// zero bytes on both sides is binary data
+	return (zeroLE | zeroBE) ? UTF16Detection_None : UTF16Detection_Ambiguous;
+}
+
+// text with few or no ASCII characters, e.g. CJK without line breaks.
+static int UTF16_DetectBySystem(const char *pBuffer, DWORD cb) {
+	int i = 0xFFFF;
+	const BOOL bIsTextUnicode = IsTextUnicode(pBuffer, cb, &i);
+	if (i == 0xFFFF) { // i doesn't seem to have been modified ...
+		i = 0;
+	}
+
+	if (bIsTextUnicode ||
+			((i & (IS_TEXT_UNICODE_UNICODE_MASK | IS_TEXT_UNICODE_REVERSE_MASK)) &&
+			 !((i & IS_TEXT_UNICODE_UNICODE_MASK) && (i & IS_TEXT_UNICODE_REVERSE_MASK)) &&
+			 !(i & IS_TEXT_UNICODE_ODD_LENGTH) &&
+			 !(i & IS_TEXT_UNICODE_ILLEGAL_CHARS && !(i & IS_TEXT_UNICODE_REVERSE_SIGNATURE)) &&
+			 !((i & IS_TEXT_UNICODE_REVERSE_MASK) == IS_TEXT_UNICODE_REVERSE_STATISTICS))) {
+		return (i & IS_TEXT_UNICODE_REVERSE_MASK) ? UTF16Detection_BigEndian : UTF16Detection_LittleEndian;
+	}
+	return UTF16Detection_None;
+}
+
 BOOL IsUnicode(const char *pBuffer, DWORD cb, LPBOOL lpbBOM, LPBOOL lpbReverse) {
 	if (pBuffer == NULL || cb < 2 || (cb & 1) != 0) {
 		// reject odd bytes
 		return FALSE;
 	}
 
-	int i = 0xFFFF;
-	const BOOL bIsTextUnicode = bSkipUnicodeDetection ? FALSE : IsTextUnicode(pBuffer, cb, &i);
 	//const BOOL bHasBOM = (pBuffer[0] == '\xFF' && pBuffer[1] == '\xFE');
 	//const BOOL bHasRBOM = (pBuffer[0] == '\xFE' && pBuffer[1] == '\xFF');
 	const BOOL bHasBOM = (*(const WORD *)pBuffer) == 0xFEFF;
 	const BOOL bHasRBOM = (*(const WORD *)pBuffer) == 0xFFFE;
 
-	if (i == 0xFFFF) { // i doesn't seem to have been modified ...
-		i = 0;
+	int result = bHasBOM ? UTF16Detection_LittleEndian : (bHasRBOM ? UTF16Detection_BigEndian : UTF16Detection_None);
+	if (result == UTF16Detection_None && !bSkipUnicodeDetection) {
+#if 0
+		StopWatch watch;
+		StopWatch_Start(watch);
+#endif
+		const uint8_t * const ptr = (const uint8_t *)pBuffer;
+		const DWORD cbSample = min_u(cb, UTF16_DETECTION_SAMPLE_SIZE);
+		UTF16Statistics stat;
+		memset(&stat, 0, sizeof(stat));
+		UTF16_Collect(&stat, ptr, ptr + cbSample);
+		result = UTF16_Classify(&stat);
+		if (result == UTF16Detection_Ambiguous && cbSample < cb) {
+			UTF16_Collect(&stat, ptr + cbSample, ptr + cb);
+			result = UTF16_Classify(&stat);
+		}
+		if (result == UTF16Detection_Ambiguous) {
+			result = UTF16_DetectBySystem(pBuffer, cbSample);
+		}
+#if 0
+		StopWatch_Stop(watch);
+		StopWatch_ShowLog(&watch, "UTF16 time");
+#endif
 	}
 
-	if (bIsTextUnicode || bHasBOM || bHasRBOM ||
-			((i & (IS_TEXT_UNICODE_UNICODE_MASK | IS_TEXT_UNICODE_REVERSE_MASK)) &&
-			 !((i & IS_TEXT_UNICODE_UNICODE_MASK) && (i & IS_TEXT_UNICODE_REVERSE_MASK)) &&
-			 !(i & IS_TEXT_UNICODE_ODD_LENGTH) &&
-			 !(i & IS_TEXT_UNICODE_ILLEGAL_CHARS && !(i & IS_TEXT_UNICODE_REVERSE_SIGNATURE)) &&
-			 !((i & IS_TEXT_UNICODE_REVERSE_MASK) == IS_TEXT_UNICODE_REVERSE_STATISTICS))) {
+	if (result != UTF16Detection_None) {
 		if (lpbBOM) {
-			*lpbBOM = bHasBOM || bHasRBOM ||
-					   (i & (IS_TEXT_UNICODE_SIGNATURE | IS_TEXT_UNICODE_REVERSE_SIGNATURE));
+			*lpbBOM = bHasBOM || bHasRBOM;
 		}
 		if (lpbReverse) {
-			*lpbReverse = bHasRBOM || (i & IS_TEXT_UNICODE_REVERSE_MASK);
+			*lpbReverse = result == UTF16Detection_BigEndian;
 		}
 		return TRUE;
 	}
@@ -1223,9 +1353,9 @@ BOOL IsUTF8(const char *pTest, DWORD nLength) {
 // bytes, we AND them together. Only when all three have an error bit in common
 // do we fail validation.
 
-#if NP2_USE_AVX2
+#if NP2_USE_AVX2 || NP2_DYNAMIC_AVX2
 #if defined(__GNUC__) || defined(__clang__)
-__attribute__((__always_inline__)) static inline
+NP2_TARGET_AVX2 __attribute__((__always_inline__)) static inline
 #else
 static __forceinline
 #endif
@@ -1317,7 +1447,8 @@ int z_validate_vec_avx2(__m256i bytes, __m256i shifted_bytes, uint32_t *last_con
 	return 1;
 }
 
-static inline int z_validate_utf8_avx2(const char *data, uint32_t len) {
+NP2_TARGET_AVX2
+static int z_validate_utf8_avx2(const char *data, uint32_t len) {
 	// Keep continuation bits from the previous iteration that carry over to
 	// each input chunk vector
 	uint32_t last_cont = 0;
@@ -1337,6 +1468,7 @@ static inline int z_validate_utf8_avx2(const char *data, uint32_t len) {
 		// Loop over input in sizeof(__m256i)-byte chunks, as long as we can safely read
 		// that far into memory
 		for (; offset + sizeof(__m256i) < len; offset += sizeof(__m256i)) {
+			NP2_PREFETCH(data + offset + NP2_PREFETCH_DISTANCE);
 			__m256i bytes = _mm256_loadu_si256((__m256i *)(data + offset));
 			if (!z_validate_vec_avx2(bytes, shifted_bytes, &last_cont)) {
 				return 0;
@@ -1369,7 +1501,9 @@ static inline int z_validate_utf8_avx2(const char *data, uint32_t len) {
 }
 
 // end NP2_USE_AVX2
-#elif NP2_USE_SSE2
+#endif
+
+#if NP2_USE_SSE2 && !NP2_USE_AVX2
 #if defined(__clang__)
 #include <tmmintrin.h>
 #endif
@@ -1473,7 +1607,7 @@ int z_validate_vec_sse4(__m128i bytes, __m128i shifted_bytes, uint32_t *last_con
 #if defined(__GNUC__) || defined(__clang__)
 __attribute__((__target__("ssse3")))
 #endif
-static inline int z_validate_utf8_sse4(const char *data, uint32_t len) {
+static int z_validate_utf8_sse4(const char *data, uint32_t len) {
 	// Keep continuation bits from the previous iteration that carry over to
 	// each input chunk vector
 	uint32_t last_cont = 0;
@@ -1492,6 +1626,7 @@ static inline int z_validate_utf8_sse4(const char *data, uint32_t len) {
 		// Loop over input in sizeof(__m128i)-byte chunks, as long as we can safely read
 		// that far into memory
 		for (; offset + sizeof(__m128i) < len; offset += sizeof(__m128i)) {
+			NP2_PREFETCH(data + offset + NP2_PREFETCH_DISTANCE);
 			__m128i bytes = _mm_loadu_si128((__m128i *)(data + offset));
 			if (!z_validate_vec_sse4(bytes, shifted_bytes, &last_cont)) {
 				return 0;
@@ -1528,13 +1663,137 @@ static inline int did_cpu_supports_ssse3(void) {
 	__cpuid(info, 0x00000001);
 	return info[2] & 0x0000200;
 }
+
+typedef int (*ValidateUTF8Proc)(const char *data, uint32_t len);
+
+// selected on first use, NULL for the DFA below.
+static ValidateUTF8Proc GetValidateUTF8Proc(void) {
+	static BOOL selected = FALSE;
+	static ValidateUTF8Proc proc = NULL;
+	if (!selected) {
+#if NP2_DYNAMIC_AVX2
+		if (np2_cpu_supports_avx2()) {
+			proc = z_validate_utf8_avx2;
+		} else
+#endif
+		if (did_cpu_supports_ssse3()) {
+			proc = z_validate_utf8_sse4;
+		}
+		selected = TRUE;
+	}
+	return proc;
+}
 // end NP2_USE_SSE2
 #endif
 
+#if NP2_USE_NEON
+// like _mm_movemask_epi8(), mask for high bit of each byte.
+static inline uint32_t neon_highbit_mask(uint8x16_t bytes) {
+	return neon_movemask_epi8(vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(bytes), 7)));
+}
+
+// same as z_validate_vec_sse4(), vqtbl1q_u8() replaces _mm_shuffle_epi8().
+static inline int z_validate_vec_neon(uint8x16_t bytes, uint8x16_t shifted_bytes, uint32_t *last_cont) {
+	// Error lookup tables for the first, second, and third nibbles
+	static const uint8_t error_1_table[16] = {
+		0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x06, 0x38
+	};
+	static const uint8_t error_2_table[16] = {
+		0x0B, 0x01, 0x00, 0x00,
+		0x10, 0x20, 0x20, 0x20,
+		0x20, 0x20, 0x20, 0x20,
+		0x20, 0x24, 0x20, 0x20
+	};
+	static const uint8_t error_3_table[16] = {
+		0x29, 0x29, 0x29, 0x29,
+		0x29, 0x29, 0x29, 0x29,
+		0x2B, 0x33, 0x35, 0x35,
+		0x31, 0x31, 0x31, 0x31
+	};
+
+	// Quick skip for ascii-only input.
+	if (vmaxvq_u8(bytes) < 0x80) {
+		return *last_cont == 0;
+	}
+
+	// Which bytes are required to be continuation bytes
+	const uint32_t high = neon_highbit_mask(bytes);
+	uint32_t req = *last_cont;
+
+	// see z_validate_vec_sse4() for the continuation mask computation,
+	// a byte shift is used as there is no carry between bytes to care about.
+	uint32_t set = high;
+	set &= neon_highbit_mask(vshlq_n_u8(bytes, 1));
+	const uint32_t cont = high ^ set;
+	req += set << 1;
+	set &= neon_highbit_mask(vshlq_n_u8(bytes, 2));
+	req += set << 2;
+	set &= neon_highbit_mask(vshlq_n_u8(bytes, 3));
+	req += set << 3;
+
+	// Check that continuation bytes match
+	if (cont != (uint16_t)req) {
+		return 0;
+	}
+
+	// Look up error masks for three consecutive nibbles.
+	const uint8x16_t e_1 = vqtbl1q_u8(vld1q_u8(error_1_table), vshrq_n_u8(shifted_bytes, 4));
+	const uint8x16_t e_2 = vqtbl1q_u8(vld1q_u8(error_2_table), vandq_u8(shifted_bytes, vdupq_n_u8(0x0F)));
+	const uint8x16_t e_3 = vqtbl1q_u8(vld1q_u8(error_3_table), vshrq_n_u8(bytes, 4));
+
+	// Check if any bits are set in all three error masks
+	if (vmaxvq_u8(vandq_u8(vandq_u8(e_1, e_2), e_3)) != 0) {
+		return 0;
+	}
+
+	// Save continuation bits and input bytes for the next round
+	*last_cont = req >> sizeof(uint8x16_t);
+	return 1;
+}
+
+static int z_validate_utf8_neon(const char *data, uint32_t len) {
+	uint32_t last_cont = 0;
+
+	uint32_t offset = 0;
+	if (len >= sizeof(uint8x16_t)) {
+		// first chunk shifted forward one byte, without reading memory before data.
+		uint8x16_t shifted_bytes = vextq_u8(vdupq_n_u8(0), vld1q_u8((const uint8_t *)data), 15);
+		for (; offset + sizeof(uint8x16_t) < len; offset += sizeof(uint8x16_t)) {
+			const uint8x16_t bytes = vld1q_u8((const uint8_t *)(data + offset));
+			if (!z_validate_vec_neon(bytes, shifted_bytes, &last_cont)) {
+				return 0;
+			}
+			shifted_bytes = vld1q_u8((const uint8_t *)(data + offset + sizeof(uint8x16_t) - 1));
+		}
+	}
+
+	if (offset < len) {
+		uint8_t buffer[sizeof(uint8x16_t) + 1];
+		ZeroMemory(buffer, sizeof(buffer));
+		if (offset != 0) {
+			buffer[0] = data[offset - 1];
+		}
+		CopyMemory(buffer + 1, data + offset, len - offset);
+
+		const uint8x16_t shifted_bytes = vld1q_u8(buffer);
+		const uint8x16_t bytes = vld1q_u8(buffer + 1);
+		if (!z_validate_vec_neon(bytes, shifted_bytes, &last_cont)) {
+			return 0;
+		}
+	}
+
+	return last_cont == 0;
+}
+// end NP2_USE_NEON
+#endif
+
 // Copyright (c) 2008-2010 Bjoern Hoehrmann <bjoern@hoehrmann.de>
 // See https://bjoern.hoehrmann.de/utf-8/decoder/dfa/ for details.
 
-BOOL IsUTF8(const char *pTest, DWORD nLength) {
+static BOOL IsUTF8Slice(const char *pTest, DWORD nLength) {
 #if 0
 	StopWatch watch;
 	StopWatch_Start(watch);
@@ -1548,11 +1807,20 @@ BOOL IsUTF8(const char *pTest, DWORD nLength) {
 #endif
 	return result;
 	// end NP2_USE_AVX2
+#elif NP2_USE_NEON
+	const BOOL result = z_validate_utf8_neon(pTest, nLength);
+#if 0
+	StopWatch_Stop(watch);
+	StopWatch_ShowLog(&watch, "UTF8 time");
+#endif
+	return result;
+	// end NP2_USE_NEON
 #else
 
 #if NP2_USE_SSE2
-	if (did_cpu_supports_ssse3()) {
-		const BOOL result = z_validate_utf8_sse4(pTest, nLength);
+	const ValidateUTF8Proc validate = GetValidateUTF8Proc();
+	if (validate != NULL) {
+		const BOOL result = validate(pTest, nLength);
 #if 0
 		StopWatch_Stop(watch);
 		StopWatch_ShowLog(&watch, "UTF8 time");
@@ -1642,13 +1910,14 @@ BOOL IsUTF8(const char *pTest, DWORD nLength) {
 	}
 	// end NP2_USE_SSE2
 #elif defined(_WIN64)
+	// words are read only inside the slice, tail is validated byte by byte.
 	const uint8_t * const ptr = (const uint8_t *)align_ptr_ex(pt, sizeof(uint64_t));
-	while (pt < ptr) {
+	while (pt < ptr && pt < end) {
 		state = utf8_dfa[256 + state + utf8_dfa[*pt++]];
 	}
 
 	const uint64_t *temp = (const uint64_t *)pt;
-	const uint64_t * const temp_end = (const uint64_t *)end;
+	const uint64_t * const temp_end = (const uint64_t *)(((uintptr_t)end) & ~(uintptr_t)(sizeof(uint64_t) - 1));
 	while (temp < temp_end) {
 		const uint64_t val = *temp;
 		if (val & UINT64_C(0x8080808080808080)) {
@@ -1684,13 +1953,14 @@ BOOL IsUTF8(const char *pTest, DWORD nLength) {
 	pt = (const uint8_t *)temp;
 	// end _WIN64
 #else
+	// words are read only inside the slice, tail is validated byte by byte.
 	const uint8_t * const ptr = (const uint8_t *)align_ptr_ex(pt, sizeof(uint32_t));
-	while (pt < ptr) {
+	while (pt < ptr && pt < end) {
 		state = utf8_dfa[256 + state + utf8_dfa[*pt++]];
 	}
 
 	const uint32_t *temp = (const uint32_t *)pt;
-	const uint32_t * const temp_end = (const uint32_t *)end;
+	const uint32_t * const temp_end = (const uint32_t *)(((uintptr_t)end) & ~(uintptr_t)(sizeof(uint32_t) - 1));
 	while (temp < temp_end) {
 		const uint32_t val = *temp;
 		if (val & 0x80808080U) {
@@ -1732,6 +2002,79 @@ BOOL IsUTF8(const char *pTest, DWORD nLength) {
 #endif // !NP2_USE_AVX2
 }
 
+// large buffer is split into slices and validated on all processors,
+// each slice starts at a character boundary, so slices can be validated independently.
+#define UTF8_PARALLEL_MIN_SIZE		(16*1024*1024)
+#define UTF8_PARALLEL_SLICE_SIZE	(4*1024*1024)
+
+typedef struct UTF8ValidationWorker {
+	const char *pTest;
+	DWORD nLength;
+	DWORD sliceCount;
+	volatile LONG nextSlice;
+	volatile LONG invalid;
+} UTF8ValidationWorker;
+
+static inline DWORD GetUTF8SliceBoundary(const char *pTest, DWORD nLength, DWORD offset) {
+	// skip at most 3 continuation bytes, a slice starts with more continuation bytes is invalid.
+	const DWORD end = min_u(offset + 3, nLength);
+	while (offset < end && ((uint8_t)pTest[offset] & 0xC0) == 0x80) {
+		++offset;
+	}
+	return offset;
+}
+
+static DWORD WINAPI UTF8ValidationThread(LPVOID lpParam) {
+	UTF8ValidationWorker *worker = (UTF8ValidationWorker *)lpParam;
+	const char *pTest = worker->pTest;
+	const DWORD nLength = worker->nLength;
+
+	while (!worker->invalid) {
+		const DWORD slice = (DWORD)InterlockedIncrement(&worker->nextSlice) - 1;
+		if (slice >= worker->sliceCount) {
+			break;
+		}
+		const DWORD start = (slice == 0) ? 0 : GetUTF8SliceBoundary(pTest, nLength, slice*UTF8_PARALLEL_SLICE_SIZE);
+		const DWORD end = (slice + 1 == worker->sliceCount) ? nLength : GetUTF8SliceBoundary(pTest, nLength, (slice + 1)*UTF8_PARALLEL_SLICE_SIZE);
+		if (start < end && !IsUTF8Slice(pTest + start, end - start)) {
+			InterlockedExchange(&worker->invalid, TRUE);
+		}
+	}
+	return 0;
+}
+
+// run the slice worker on extra pool threads (one less than processor count) and current thread.
+void RunOnAllProcessors(LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, DWORD sliceCount) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	DWORD threadCount = min_u(info.dwNumberOfProcessors, MAXIMUM_WAIT_OBJECTS);
+	threadCount = min_u(threadCount, sliceCount);
+	HANDLE workerThreads[MAXIMUM_WAIT_OBJECTS];
+	DWORD count = 0;
+	for (DWORD i = 1; i < threadCount; i++) {
+		HANDLE workerThread = WorkerPool_Submit(lpStartAddress, lpParam, WorkerPriority_High);
+		if (workerThread) {
+			workerThreads[count++] = workerThread;
+		}
+	}
+	// current thread also works on slices.
+	lpStartAddress(lpParam);
+	for (DWORD i = 0; i < count; i++) {
+		WorkerPool_Wait(workerThreads[i]);
+		CloseHandle(workerThreads[i]);
+	}
+}
+
+BOOL IsUTF8(const char *pTest, DWORD nLength) {
+	if (nLength >= UTF8_PARALLEL_MIN_SIZE) {
+		const DWORD sliceCount = (nLength - 1)/UTF8_PARALLEL_SLICE_SIZE + 1;
+		UTF8ValidationWorker worker = { pTest, nLength, sliceCount, 0, FALSE };
+		RunOnAllProcessors(UTF8ValidationThread, &worker, sliceCount);
+		return !worker.invalid;
+	}
+	return IsUTF8Slice(pTest, nLength);
+}
+
 BOOL IsUTF7(const char *pTest, DWORD nLength) {
 	const uint8_t *pt = (const uint8_t *)pTest;
 
@@ -1853,6 +2196,939 @@ BOOL IsUTF7(const char *pTest, DWORD nLength) {
 #endif
 }
 
+// detect legacy DBCS text (Shift-JIS, GBK, Big5, UHC) from other locale by scoring byte pairs
+// (lead and trail byte) in frequently used ranges of each code page, somewhat like uchardet.
+// only leading bytes are sampled, detection stops early once one code page clearly wins.
+#define DBCS_DETECT_SAMPLE_SIZE		(256*1024)
+#define DBCS_DETECT_WINDOW_SIZE		4096
+#define DBCS_DETECT_MIN_CHARACTER	64
+#define DBCS_DETECT_CANDIDATE_COUNT	4
+
+typedef struct DBCSDetector {
+	UINT codePage;
+	DWORD offset;		// next byte to check, may beyond window end by one trail byte
+	UINT characters;	// valid non-ASCII characters
+	UINT common;		// characters in frequently used ranges
+	UINT invalid;		// invalid byte sequences
+} DBCSDetector;
+
+static inline int DBCSDetector_Score(const DBCSDetector *detector) {
+	// common - rare - 8*invalid
+	return (int)(2*detector->common) - (int)detector->characters - 8*(int)detector->invalid;
+}
+
+static inline BOOL DBCSDetector_Eliminated(const DBCSDetector *detector) {
+	return detector->invalid*16 > detector->characters + 16;
+}
+
+// returns 0 for invalid byte pair, 1 for rarely used character, 2 for frequently used character.
+static int ClassifyDBCSCharacter(UINT cp, uint8_t lead, uint8_t trail) {
+	switch (cp) {
+	case 932: // Shift-JIS
+		if (!((lead >= 0x81 && lead <= 0x9F) || (lead >= 0xE0 && lead <= 0xFC))
+			|| !(trail >= 0x40 && trail <= 0xFC && trail != 0x7F)) {
+			return 0;
+		}
+		// punctuation, full width alphanumeric, Hiragana, Katakana; JIS level 1 Kanji
+		return (lead <= 0x83 || (lead >= 0x88 && lead <= 0x9F)) ? 2 : 1;
+
+	case 936: // GBK
+		if (lead < 0x81 || lead > 0xFE || trail < 0x40 || trail > 0xFE || trail == 0x7F) {
+			return 0;
+		}
+		// punctuation and full width characters; GB2312 level 1 Hanzi
+		return (trail >= 0xA1 && ((lead >= 0xA1 && lead <= 0xA3) || (lead >= 0xB0 && lead <= 0xD7))) ? 2 : 1;
+
+	case 949: // UHC
+		if (lead < 0x81 || lead > 0xFE || !((trail >= 0x41 && trail <= 0x5A) || (trail >= 0x61 && trail <= 0x7A) || (trail >= 0x81 && trail <= 0xFE))) {
+			return 0;
+		}
+		// punctuation and full width characters; KS X 1001 Hangul
+		return (trail >= 0xA1 && ((lead >= 0xA1 && lead <= 0xA3) || (lead >= 0xB0 && lead <= 0xC8))) ? 2 : 1;
+
+	default: // Big5
+		if (lead < 0x81 || lead > 0xFE || !((trail >= 0x40 && trail <= 0x7E) || (trail >= 0xA1 && trail <= 0xFE))) {
+			return 0;
+		}
+		// punctuation and frequently used Hanzi
+		return (lead >= 0xA1 && lead <= 0xC6) ? 2 : 1;
+	}
+}
+
+static void DBCSDetector_Check(DBCSDetector *detector, const uint8_t *ptr, DWORD end, DWORD length) {
+	const UINT cp = detector->codePage;
+	DWORD offset = detector->offset;
+	while (offset < end) {
+		// skip ASCII
+#if NP2_USE_AVX2
+		while (offset + sizeof(__m256i) <= end) {
+			const __m256i chunk = _mm256_loadu_si256((__m256i *)(ptr + offset));
+			const uint32_t mask = _mm256_movemask_epi8(chunk);
+			if (mask) {
+				offset += np2_ctz(mask);
+				break;
+			}
+			offset += sizeof(__m256i);
+		}
+#elif NP2_USE_SSE2
+		while (offset + sizeof(__m128i) <= end) {
+			const __m128i chunk = _mm_loadu_si128((__m128i *)(ptr + offset));
+			const uint32_t mask = _mm_movemask_epi8(chunk);
+			if (mask) {
+				offset += np2_ctz(mask);
+				break;
+			}
+			offset += sizeof(__m128i);
+		}
+#endif
+		while (offset < end && ptr[offset] < 0x80) {
+			++offset;
+		}
+		if (offset >= end) {
+			break;
+		}
+
+		const uint8_t lead = ptr[offset];
+		if (cp == 932 && lead >= 0xA1 && lead <= 0xDF) {
+			// half width Katakana
+			++detector->characters;
+			++offset;
+			continue;
+		}
+		if (offset + 1 >= length) {
+			// truncated character at end of sample
+			++offset;
+			break;
+		}
+		const int type = ClassifyDBCSCharacter(cp, lead, ptr[offset + 1]);
+		if (type == 0) {
+			++detector->invalid;
+			++offset;
+		} else {
+			++detector->characters;
+			detector->common += type >> 1;
+			offset += 2;
+		}
+	}
+	detector->offset = offset;
+}
+
+int DetectDBCSEncoding(const char *pTest, DWORD nLength) {
+	// on tie, Hangul only uses the first part of GB2312 level 1 Hanzi ranges, so UHC wins over GBK.
+	DBCSDetector detectors[DBCS_DETECT_CANDIDATE_COUNT] = {
+		{ 949, 0, 0, 0, 0 },
+		{ 932, 0, 0, 0, 0 },
+		{ 950, 0, 0, 0, 0 },
+		{ 936, 0, 0, 0, 0 },
+	};
+
+	const uint8_t * const ptr = (const uint8_t *)pTest;
+	nLength = min_u(nLength, DBCS_DETECT_SAMPLE_SIZE);
+	const DBCSDetector *best = NULL;
+	int bestScore = 0;
+	for (DWORD window = 0; window < nLength; window += DBCS_DETECT_WINDOW_SIZE) {
+		const DWORD end = min_u(window + DBCS_DETECT_WINDOW_SIZE, nLength);
+		best = NULL;
+		bestScore = 0;
+		int secondScore = INT_MIN;
+		UINT alive = 0;
+		for (int i = 0; i < DBCS_DETECT_CANDIDATE_COUNT; i++) {
+			DBCSDetector *detector = &detectors[i];
+			if (DBCSDetector_Eliminated(detector)) {
+				continue;
+			}
+			DBCSDetector_Check(detector, ptr, end, nLength);
+			if (DBCSDetector_Eliminated(detector)) {
+				continue;
+			}
+			++alive;
+			const int score = DBCSDetector_Score(detector);
+			if (best == NULL || score > bestScore) {
+				secondScore = (best == NULL) ? INT_MIN : bestScore;
+				best = detector;
+				bestScore = score;
+			} else if (score > secondScore) {
+				secondScore = score;
+			}
+		}
+		if (alive == 0) {
+			return CPI_NONE;
+		}
+		// confidence: score gap relative to character count,
+		// early exit when the best is the only one left or leads others by 25%.
+		if (best->characters >= DBCS_DETECT_MIN_CHARACTER && bestScore > 0
+			&& (alive == 1 || (INT64)(bestScore - secondScore)*4 >= (INT64)best->characters)) {
+			break;
+		}
+	}
+
+	// require enough characters and most of them in frequently used ranges
+	if (best == NULL || bestScore <= 0 || best->characters < DBCS_DETECT_MIN_CHARACTER/4) {
+		return CPI_NONE;
+	}
+	if (best->codePage == (UINT)iDefaultCodePage) {
+		return CPI_DEFAULT;
+	}
+	const int iEncoding = Encoding_GetIndex(best->codePage);
+	return Encoding_IsValid(iEncoding) ? iEncoding : CPI_NONE;
+}
+
+//=============================================================================
+//
+// EditDetectEOLMode()
+//
+// linesCount: CR+LF, LF, CR
+static void EditCountLineEndings(LPCSTR lpData, DWORD cbData, size_t linesCount[3]) {
+	/* '\r' and '\n' is not reused (e.g. as trailing byte in DBCS) by any known encoding,
+	it's safe to check whole data byte by byte.*/
+
+	size_t lineCountCRLF = 0;
+	size_t lineCountCR = 0;
+	size_t lineCountLF = 0;
+#if 0
+	StopWatch watch;
+	StopWatch_Start(watch);
+#endif
+
+	const uint8_t *ptr = (const uint8_t *)lpData;
+	// No NULL-terminated requirement for *ptr == '\n'
+#if NP2_USE_SSE2 || NP2_USE_AVX2 || NP2_USE_NEON
+	const uint8_t * const end = ptr + cbData;
+#else
+	const uint8_t * const end = ptr + cbData - 1;
+#endif
+
+#if NP2_USE_AVX2
+	const __m256i vectCR = _mm256_set1_epi8('\r');
+	const __m256i vectLF = _mm256_set1_epi8('\n');
+	while (ptr + 2*sizeof(__m256i) < end) {
+		// unaligned loading: line starts at random position.
+		const __m256i chunk1 = _mm256_loadu_si256((__m256i *)ptr);
+		const __m256i chunk2 = _mm256_loadu_si256((__m256i *)(ptr + sizeof(__m256i)));
+		ptr += 2*sizeof(__m256i);
+		uint64_t maskCR = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectCR));
+		uint64_t maskLF = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectLF));
+		maskLF |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m256i);
+		maskCR |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m256i);
+
+		if (maskCR) {
+			if (_addcarry_u64(0, maskCR, maskCR, &maskCR)) {
+				if (*ptr == '\n') {
+					// CR+LF across boundary
+					++ptr;
+					++lineCountCRLF;
+				} else {
+					++lineCountCR;
+				}
+			}
+
+			// maskCR and maskLF never have some bit set. after shifting maskCR by 1 bit,
+			// the bits both set in maskCR and maskLF represents CR+LF;
+			// the bits only set in maskCR or maskLF represents individual CR or LF.
+			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount64(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount64(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount64(maskLF);
+		}
+	}
+
+	if (ptr < end) {
+		NP2_alignas(32) uint8_t buffer[2*sizeof(__m256i)];
+		ZeroMemory_32x2(buffer);
+		__movsb(buffer, ptr, end - ptr);
+
+		const __m256i chunk1 = _mm256_load_si256((__m256i *)buffer);
+		const __m256i chunk2 = _mm256_load_si256((__m256i *)(buffer + sizeof(__m256i)));
+		uint64_t maskCR = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectCR));
+		uint64_t maskLF = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, vectLF));
+		maskLF |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m256i);
+		maskCR |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m256i);
+
+		if (maskCR) {
+			const uint8_t lastCR = _addcarry_u64(0, maskCR, maskCR, &maskCR);
+			_addcarry_u64(lastCR, lineCountCR, 0, &lineCountCR);
+			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount64(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount64(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount64(maskLF);
+		}
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+#if defined(_WIN64)
+	const __m128i vectCR = _mm_set1_epi8('\r');
+	const __m128i vectLF = _mm_set1_epi8('\n');
+	while (ptr + 4*sizeof(__m128i) < end) {
+		// unaligned loading: line starts at random position.
+		const __m128i chunk1 = _mm_loadu_si128((__m128i *)ptr);
+		const __m128i chunk2 = _mm_loadu_si128((__m128i *)(ptr + sizeof(__m128i)));
+		const __m128i chunk3 = _mm_loadu_si128((__m128i *)(ptr + 2*sizeof(__m128i)));
+		const __m128i chunk4 = _mm_loadu_si128((__m128i *)(ptr + 3*sizeof(__m128i)));
+		ptr += 4*sizeof(__m128i);
+		uint64_t maskCR = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
+		uint64_t maskLF = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
+		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
+		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
+		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectCR))) << 2*sizeof(__m128i);
+		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectLF))) << 2*sizeof(__m128i);
+		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectLF))) << 3*sizeof(__m128i);
+		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectCR))) << 3*sizeof(__m128i);
+
+		if (maskCR) {
+			if (_addcarry_u64(0, maskCR, maskCR, &maskCR)) {
+				if (*ptr == '\n') {
+					// CR+LF across boundary
+					++ptr;
+					++lineCountCRLF;
+				} else {
+					++lineCountCR;
+				}
+			}
+
+			// maskCR and maskLF never have some bit set. after shifting maskCR by 1 bit,
+			// the bits both set in maskCR and maskLF represents CR+LF;
+			// the bits only set in maskCR or maskLF represents individual CR or LF.
+			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount64(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount64(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount64(maskLF);
+		}
+	}
+
+	if (ptr < end) {
+		NP2_alignas(16) uint8_t buffer[4*sizeof(__m128i)];
+		ZeroMemory_16x4(buffer);
+		__movsb(buffer, ptr, end - ptr);
+
+		const __m128i chunk1 = _mm_load_si128((__m128i *)buffer);
+		const __m128i chunk2 = _mm_load_si128((__m128i *)(buffer + sizeof(__m128i)));
+		const __m128i chunk3 = _mm_load_si128((__m128i *)(buffer + 2*sizeof(__m128i)));
+		const __m128i chunk4 = _mm_load_si128((__m128i *)(buffer + 3*sizeof(__m128i)));
+		uint64_t maskCR = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
+		uint64_t maskLF = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
+		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
+		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
+		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectCR))) << 2*sizeof(__m128i);
+		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk3, vectLF))) << 2*sizeof(__m128i);
+		maskLF |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectLF))) << 3*sizeof(__m128i);
+		maskCR |= ((uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk4, vectCR))) << 3*sizeof(__m128i);
+
+		if (maskCR) {
+			const uint8_t lastCR = _addcarry_u64(0, maskCR, maskCR, &maskCR);
+			_addcarry_u64(lastCR, lineCountCR, 0, &lineCountCR);
+			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount64(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount64(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount64(maskLF);
+		}
+	}
+	// end _WIN64 NP2_USE_SSE2
+#else
+	const __m128i vectCR = _mm_set1_epi8('\r');
+	const __m128i vectLF = _mm_set1_epi8('\n');
+	while (ptr + 2*sizeof(__m128i) < end) {
+		// unaligned loading: line starts at random position.
+		const __m128i chunk1 = _mm_loadu_si128((__m128i *)ptr);
+		const __m128i chunk2 = _mm_loadu_si128((__m128i *)(ptr + sizeof(__m128i)));
+		ptr += 2*sizeof(__m128i);
+		uint32_t maskCR = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
+		uint32_t maskLF = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
+		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
+		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
+
+		if (maskCR) {
+			if (_addcarry_u32(0, maskCR, maskCR, &maskCR)) {
+				if (*ptr == '\n') {
+					// CR+LF across boundary
+					++ptr;
+					++lineCountCRLF;
+				} else {
+					++lineCountCR;
+				}
+			}
+
+			// maskCR and maskLF never have some bit set. after shifting maskCR by 1 bit,
+			// the bits both set in maskCR and maskLF represents CR+LF;
+			// the bits only set in maskCR or maskLF represents individual CR or LF.
+			const uint32_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint32_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount(maskLF);
+		}
+	}
+
+	if (ptr < end) {
+		NP2_alignas(16) uint8_t buffer[2*sizeof(__m128i)];
+		ZeroMemory_16x2(buffer);
+		__movsb(buffer, ptr, end - ptr);
+
+		const __m128i chunk1 = _mm_load_si128((__m128i *)buffer);
+		const __m128i chunk2 = _mm_load_si128((__m128i *)(buffer + sizeof(__m128i)));
+		uint32_t maskCR = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectCR));
+		uint32_t maskLF = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, vectLF));
+		maskLF |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectLF))) << sizeof(__m128i);
+		maskCR |= ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk2, vectCR))) << sizeof(__m128i);
+
+		if (maskCR) {
+			const uint8_t lastCR = _addcarry_u32(0, maskCR, maskCR, &maskCR);
+			_addcarry_u32(lastCR, lineCountCR, 0, &lineCountCR);
+			const uint32_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint32_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount(maskLF);
+		}
+	}
+#endif
+	// end NP2_USE_SSE2
+#elif NP2_USE_NEON
+	const uint8x16_t vectCR = vdupq_n_u8('\r');
+	const uint8x16_t vectLF = vdupq_n_u8('\n');
+	while (ptr + 4*sizeof(uint8x16_t) < end) {
+		const uint8x16_t chunk1 = vld1q_u8(ptr);
+		const uint8x16_t chunk2 = vld1q_u8(ptr + sizeof(uint8x16_t));
+		const uint8x16_t chunk3 = vld1q_u8(ptr + 2*sizeof(uint8x16_t));
+		const uint8x16_t chunk4 = vld1q_u8(ptr + 3*sizeof(uint8x16_t));
+		ptr += 4*sizeof(uint8x16_t);
+		uint64_t maskCR = neon_movemask_epi8x4(vceqq_u8(chunk1, vectCR), vceqq_u8(chunk2, vectCR), vceqq_u8(chunk3, vectCR), vceqq_u8(chunk4, vectCR));
+		uint64_t maskLF = neon_movemask_epi8x4(vceqq_u8(chunk1, vectLF), vceqq_u8(chunk2, vectLF), vceqq_u8(chunk3, vectLF), vceqq_u8(chunk4, vectLF));
+
+		if (maskCR) {
+			const uint64_t lastCR = maskCR >> 63;
+			maskCR <<= 1;
+			if (lastCR) {
+				if (*ptr == '\n') {
+					// CR+LF across boundary
+					++ptr;
+					++lineCountCRLF;
+				} else {
+					++lineCountCR;
+				}
+			}
+
+			// see SSE2 code above
+			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount64(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount64(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount64(maskLF);
+		}
+	}
+
+	if (ptr < end) {
+		uint8_t buffer[4*sizeof(uint8x16_t)];
+		ZeroMemory(buffer, sizeof(buffer));
+		CopyMemory(buffer, ptr, end - ptr);
+
+		const uint8x16_t chunk1 = vld1q_u8(buffer);
+		const uint8x16_t chunk2 = vld1q_u8(buffer + sizeof(uint8x16_t));
+		const uint8x16_t chunk3 = vld1q_u8(buffer + 2*sizeof(uint8x16_t));
+		const uint8x16_t chunk4 = vld1q_u8(buffer + 3*sizeof(uint8x16_t));
+		uint64_t maskCR = neon_movemask_epi8x4(vceqq_u8(chunk1, vectCR), vceqq_u8(chunk2, vectCR), vceqq_u8(chunk3, vectCR), vceqq_u8(chunk4, vectCR));
+		uint64_t maskLF = neon_movemask_epi8x4(vceqq_u8(chunk1, vectLF), vceqq_u8(chunk2, vectLF), vceqq_u8(chunk3, vectLF), vceqq_u8(chunk4, vectLF));
+
+		if (maskCR) {
+			lineCountCR += maskCR >> 63;
+			maskCR <<= 1;
+			const uint64_t maskCRLF = maskCR & maskLF; // CR+LF
+			const uint64_t maskCR_LF = maskCR ^ maskLF;// CR alone or LF alone
+			maskLF = maskCR_LF & maskLF; // LF alone
+			maskCR = maskCR_LF ^ maskLF; // CR alone (with one position offset)
+			if (maskCRLF) {
+				lineCountCRLF += np2_popcount64(maskCRLF);
+			}
+			if (maskCR) {
+				lineCountCR += np2_popcount64(maskCR);
+			}
+		}
+		if (maskLF) {
+			lineCountLF += np2_popcount64(maskLF);
+		}
+	}
+	// end NP2_USE_NEON
+#else
+
+#if defined(__clang__) || defined(__GNUC__) || defined(__ICL) || !defined(_MSC_VER)
+	while (ptr < end) {
+		const uint8_t ch = *ptr++;
+		const uint32_t mask = ((1 << '\r') - 1) ^ (1 << '\n');
+		if (ch > '\r' || ((mask >> ch) & 1) != 0) {
+			continue;
+		}
+		if (ch == '\n') {
+			++lineCountLF;
+		} else {
+			if (*ptr == '\n') {
+				++ptr;
+				++lineCountCRLF;
+			} else {
+				++lineCountCR;
+			}
+		}
+	}
+#else
+	do {
+		// skip to line end
+		uint8_t ch = 0;
+#if 1
+		const uint32_t mask = ((1 << '\r') - 1) ^ (1 << '\n');
+		while (ptr < end && ((ch = *ptr++) > '\r' || ((mask >> ch) & 1) != 0)) {
+			// nop
+		}
+#else
+		while (ptr < end && ((ch = *ptr++) > '\r' || ch < '\n')) {
+			// nop
+		}
+#endif
+		switch (ch) {
+		case '\n':
+			++lineCountLF;
+			break;
+		case '\r':
+			if (*ptr == '\n') {
+				++ptr;
+				++lineCountCRLF;
+			} else {
+				++lineCountCR;
+			}
+			break;
+		}
+	} while (ptr < end);
+#endif
+	if (ptr == end) {
+		switch (*ptr) {
+		case '\n':
+			++lineCountLF;
+			break;
+		case '\r':
+			++lineCountCR;
+			break;
+		}
+	}
+#endif
+
+#if 0
+	StopWatch_Stop(watch);
+	StopWatch_ShowLog(&watch, "EOL time");
+	printf("%s CR+LF:%u, LF: %u, CR: %u\n", __func__, (UINT)lineCountCRLF, (UINT)lineCountLF, (UINT)lineCountCR);
+#endif
+
+	linesCount[0] += lineCountCRLF;
+	linesCount[1] += lineCountLF;
+	linesCount[2] += lineCountCR;
+}
+
+#define EOL_SAMPLE_BLOCK_SIZE	(64*1024)
+
+// detect line endings for huge file from head, tail and some pseudo random interior blocks,
+// returns FALSE when sampled blocks contain different line endings or too few lines.
+static BOOL EditSampleLineEndings(LPCSTR lpData, DWORD cbData, size_t linesCount[3]) {
+	const UINT blockCount = (UINT)iEOLSampleBlockCount + 2;
+	if (dwEOLSampleMinSize == 0 || iEOLSampleBlockCount <= 0 || cbData < ((UINT64)dwEOLSampleMinSize << 20)
+		|| cbData / blockCount < 2*EOL_SAMPLE_BLOCK_SIZE) {
+		return FALSE;
+	}
+
+#if 0
+	StopWatch watch;
+	StopWatch_Start(watch);
+#endif
+
+	const DWORD stride = (cbData - EOL_SAMPLE_BLOCK_SIZE) / (blockCount - 1);
+	size_t sampleCount[3] = { 0, 0, 0 };
+	DWORD cbSampled = 0;
+	UINT blockWithLine = 0;
+	uint32_t seed = cbData;
+	for (UINT i = 0; i < blockCount; i++) {
+		DWORD offset = 0;
+		if (i + 1 == blockCount) {
+			offset = cbData - EOL_SAMPLE_BLOCK_SIZE;
+		} else if (i != 0) {
+			// deterministic offset inside the stride, same file always gets same result
+			seed = seed*1103515245U + 12345U;
+			offset = i*stride + (seed >> 8) % (stride - EOL_SAMPLE_BLOCK_SIZE);
+		}
+		DWORD length = EOL_SAMPLE_BLOCK_SIZE;
+		// don't split CR+LF between blocks
+		if (offset != 0 && lpData[offset] == '\n' && lpData[offset - 1] == '\r') {
+			++offset;
+			--length;
+		}
+		if (offset + length < cbData && lpData[offset + length - 1] == '\r' && lpData[offset + length] == '\n') {
+			++length;
+		}
+
+		size_t count[3] = { 0, 0, 0 };
+		EditCountLineEndings(lpData + offset, length, count);
+		if (count[0] + count[1] + count[2] != 0) {
+			++blockWithLine;
+		}
+		sampleCount[0] += count[0];
+		sampleCount[1] += count[1];
+		sampleCount[2] += count[2];
+		cbSampled += length;
+	}
+
+	// confidence: percentage of sampled blocks contains line ending
+	const UINT confidence = blockWithLine*100/blockCount;
+	const UINT kinds = (!!sampleCount[0]) + (!!sampleCount[1]) + (!!sampleCount[2]);
+
+#if 0
+	StopWatch_Stop(watch);
+	StopWatch_ShowLog(&watch, "EOL sample time");
+	printf("%s CR+LF:%u, LF: %u, CR: %u, confidence: %u%%\n", __func__, (UINT)sampleCount[0], (UINT)sampleCount[1], (UINT)sampleCount[2], confidence);
+#endif
+
+	if (kinds != 1 || confidence < 75) {
+		return FALSE;
+	}
+
+	// estimated line count, only used to reserve line index.
+	const UINT index = sampleCount[0] ? 0 : (sampleCount[1] ? 1 : 2);
+	linesCount[index] = (size_t)((UINT64)sampleCount[index] * cbData / cbSampled);
+	return TRUE;
+}
+
+void EditSetEOLModeFromLineCount(EditFileIOStatus *status, size_t lineCountCRLF, size_t lineCountLF, size_t lineCountCR) {
+	const size_t linesMax = max_z(max_z(lineCountCRLF, lineCountCR), lineCountLF);
+	// values must kept in same order as SC_EOL_CRLF, SC_EOL_CR, SC_EOL_LF
+	const size_t linesCount[3] = { lineCountCRLF, lineCountCR, lineCountLF };
+	int iEOLMode = status->iEOLMode;
+	if (linesMax != linesCount[iEOLMode]) {
+		if (linesMax == lineCountCRLF) {
+			iEOLMode = SC_EOL_CRLF;
+		} else if (linesMax == lineCountLF) {
+			iEOLMode = SC_EOL_LF;
+		} else {
+			iEOLMode = SC_EOL_CR;
+		}
+	}
+
+	status->iEOLMode = iEOLMode;
+	status->bInconsistent = ((!!lineCountCRLF) + (!!lineCountCR) + (!!lineCountLF)) > 1;
+	status->totalLineCount = lineCountCRLF + lineCountCR + lineCountLF + 1;
+	status->linesCount[0] = lineCountCRLF;
+	status->linesCount[1] = lineCountLF;
+	status->linesCount[2] = lineCountCR;
+}
+
+void EditDetectEOLMode(LPCSTR lpData, DWORD cbData, EditFileIOStatus *status) {
+	size_t linesCount[3] = { 0, 0, 0 };
+	if (!EditSampleLineEndings(lpData, cbData, linesCount)) {
+		EditCountLineEndings(lpData, cbData, linesCount);
+	}
+	EditSetEOLModeFromLineCount(status, linesCount[0], linesCount[1], linesCount[2]);
+}
+
+// number of line endings, CR+LF is counted once.
+size_t EditCountLineEnds(LPCSTR lpData, DWORD cbData) {
+	size_t linesCount[3] = { 0, 0, 0 };
+	EditCountLineEndings(lpData, cbData, linesCount);
+	return linesCount[0] + linesCount[1] + linesCount[2];
+}
+
+// UTF-8 <=> UTF-16 conversion with size_t length, ASCII runs are converted with SIMD.
+// like MultiByteToWideChar() and WideCharToMultiByte(), invalid UTF-8 sequence (maximal subpart)
+// and unpaired surrogate are replaced with U+FFFD.
+
+static size_t UTF16ToUTF8Slice(LPCWSTR pwszText, size_t cchText, char *lpOut, BOOL *pbLossy) {
+	const uint16_t *src = (const uint16_t *)pwszText;
+	const uint16_t * const end = src + cchText;
+	uint8_t *dest = (uint8_t *)lpOut;
+	while (src < end) {
+#if NP2_USE_AVX2
+		while (src + sizeof(__m256i)/sizeof(uint16_t) <= end) {
+			const __m256i chunk = _mm256_loadu_si256((__m256i *)src);
+			if (!_mm256_testz_si256(chunk, _mm256_set1_epi16((short)0xFF80))) {
+				break;
+			}
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(chunk, chunk), 0x08);
+			_mm_storeu_si128((__m128i *)dest, _mm256_castsi256_si128(packed));
+			src += sizeof(__m256i)/sizeof(uint16_t);
+			dest += sizeof(__m128i);
+		}
+		// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+		while (src + sizeof(__m128i)/sizeof(uint16_t) <= end) {
+			const __m128i chunk = _mm_loadu_si128((__m128i *)src);
+			const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16((short)0xFF80)), _mm_setzero_si128());
+			if (_mm_movemask_epi8(ascii) != 0xFFFF) {
+				break;
+			}
+			_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(chunk, chunk));
+			src += sizeof(__m128i)/sizeof(uint16_t);
+			dest += sizeof(__m128i)/sizeof(uint16_t);
+		}
+		// end NP2_USE_SSE2
+#endif
+		if (src == end) {
+			break;
+		}
+
+		uint32_t ch = *src++;
+		if (ch < 0x80) {
+			*dest++ = (uint8_t)ch;
+		} else if (ch < 0x800) {
+			dest[0] = (uint8_t)(0xC0 | (ch >> 6));
+			dest[1] = (uint8_t)(0x80 | (ch & 0x3F));
+			dest += 2;
+		} else {
+			if ((ch & 0xF800) == 0xD800) {
+				if (ch < 0xDC00 && src < end && (*src & 0xFC00) == 0xDC00) {
+					ch = 0x10000 + ((ch - 0xD800) << 10) + (*src++ - 0xDC00);
+					dest[0] = (uint8_t)(0xF0 | (ch >> 18));
+					dest[1] = (uint8_t)(0x80 | ((ch >> 12) & 0x3F));
+					dest[2] = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+					dest[3] = (uint8_t)(0x80 | (ch & 0x3F));
+					dest += 4;
+					continue;
+				}
+				ch = 0xFFFD;
+				*pbLossy = TRUE;
+			}
+			dest[0] = (uint8_t)(0xE0 | (ch >> 12));
+			dest[1] = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+			dest[2] = (uint8_t)(0x80 | (ch & 0x3F));
+			dest += 3;
+		}
+	}
+	return dest - (uint8_t *)lpOut;
+}
+
+static size_t UTF16ToUTF8Length(LPCWSTR pwszText, size_t cchText) {
+	const uint16_t *src = (const uint16_t *)pwszText;
+	const uint16_t * const end = src + cchText;
+	size_t length = cchText;
+	while (src < end) {
+		const uint32_t ch = *src++;
+		if (ch >= 0x80) {
+			if (ch < 0x800) {
+				length += 1;
+			} else if (ch < 0xDC00 && ch >= 0xD800 && src < end && (*src & 0xFC00) == 0xDC00) {
+				// 2 UTF-16 code units to 4 bytes
+				++src;
+				length += 2;
+			} else {
+				length += 2;
+			}
+		}
+	}
+	return length;
+}
+
+// large text is split into slices and converted on all processors: first pass computes
+// output length of each slice, second pass converts slices to their output offsets.
+#define UTF16_PARALLEL_MIN_SIZE		(8*1024*1024)
+#define UTF16_PARALLEL_SLICE_SIZE	(2*1024*1024)
+
+typedef struct UTF16ConversionWorker {
+	LPCWSTR pwszText;
+	size_t cchText;
+	char *lpOut;
+	size_t *sliceOffset;
+	DWORD sliceCount;
+	volatile LONG nextSlice;
+	BOOL convert;
+	BOOL lossy;
+} UTF16ConversionWorker;
+
+static inline size_t GetUTF16SliceBoundary(LPCWSTR pwszText, size_t cchText, size_t offset) {
+	// don't split surrogate pair
+	if (offset < cchText && IS_LOW_SURROGATE(pwszText[offset]) && IS_HIGH_SURROGATE(pwszText[offset - 1])) {
+		++offset;
+	}
+	return offset;
+}
+
+static DWORD WINAPI UTF16ConversionThread(LPVOID lpParam) {
+	UTF16ConversionWorker *worker = (UTF16ConversionWorker *)lpParam;
+	LPCWSTR pwszText = worker->pwszText;
+	const size_t cchText = worker->cchText;
+
+	while (TRUE) {
+		const DWORD slice = (DWORD)InterlockedIncrement(&worker->nextSlice) - 1;
+		if (slice >= worker->sliceCount) {
+			break;
+		}
+		const size_t start = (slice == 0) ? 0 : GetUTF16SliceBoundary(pwszText, cchText, (size_t)slice*UTF16_PARALLEL_SLICE_SIZE);
+		const size_t end = (slice + 1 == worker->sliceCount) ? cchText : GetUTF16SliceBoundary(pwszText, cchText, (size_t)(slice + 1)*UTF16_PARALLEL_SLICE_SIZE);
+		if (worker->convert) {
+			BOOL lossy = FALSE;
+			UTF16ToUTF8Slice(pwszText + start, end - start, worker->lpOut + worker->sliceOffset[slice], &lossy);
+			if (lossy) {
+				worker->lossy = TRUE;
+			}
+		} else {
+			worker->sliceOffset[slice + 1] = UTF16ToUTF8Length(pwszText + start, end - start);
+		}
+	}
+	return 0;
+}
+
+// lpOut requires at most 3*cchText bytes, returns bytes written.
+// *pbLossy is set to TRUE when unpaired surrogate is replaced.
+size_t UTF16ToUTF8(LPCWSTR pwszText, size_t cchText, char *lpOut, BOOL *pbLossy) {
+	if (cchText >= UTF16_PARALLEL_MIN_SIZE) {
+		const DWORD sliceCount = (DWORD)((cchText - 1)/UTF16_PARALLEL_SLICE_SIZE + 1);
+		size_t *sliceOffset = (size_t *)NP2HeapAlloc((sliceCount + 1) * sizeof(size_t));
+		if (sliceOffset != NULL) {
+			UTF16ConversionWorker worker = { pwszText, cchText, lpOut, sliceOffset, sliceCount, 0, FALSE, FALSE };
+			RunOnAllProcessors(UTF16ConversionThread, &worker, sliceCount);
+			for (DWORD slice = 0; slice < sliceCount; slice++) {
+				sliceOffset[slice + 1] += sliceOffset[slice];
+			}
+			worker.nextSlice = 0;
+			worker.convert = TRUE;
+			RunOnAllProcessors(UTF16ConversionThread, &worker, sliceCount);
+			const size_t cbOut = sliceOffset[sliceCount];
+			NP2HeapFree(sliceOffset);
+			if (worker.lossy) {
+				*pbLossy = TRUE;
+			}
+			return cbOut;
+		}
+	}
+	return UTF16ToUTF8Slice(pwszText, cchText, lpOut, pbLossy);
+}
+
+// pwszOut requires at most cbText characters, returns characters written.
+size_t UTF8ToUTF16(const char *lpText, size_t cbText, LPWSTR pwszOut) {
+	const uint8_t *src = (const uint8_t *)lpText;
+	const uint8_t * const end = src + cbText;
+	uint16_t *dest = (uint16_t *)pwszOut;
+	while (src < end) {
+#if NP2_USE_AVX2
+		while (src + sizeof(__m256i) <= end) {
+			const __m256i chunk = _mm256_loadu_si256((__m256i *)src);
+			if (_mm256_movemask_epi8(chunk)) {
+				break;
+			}
+			_mm256_storeu_si256((__m256i *)dest, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(chunk)));
+			_mm256_storeu_si256((__m256i *)(dest + sizeof(__m128i)), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(chunk, 1)));
+			src += sizeof(__m256i);
+			dest += sizeof(__m256i);
+		}
+		// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+		while (src + sizeof(__m128i) <= end) {
+			const __m128i chunk = _mm_loadu_si128((__m128i *)src);
+			if (_mm_movemask_epi8(chunk)) {
+				break;
+			}
+			_mm_storeu_si128((__m128i *)dest, _mm_unpacklo_epi8(chunk, _mm_setzero_si128()));
+			_mm_storeu_si128((__m128i *)(dest + sizeof(__m128i)/sizeof(uint16_t)), _mm_unpackhi_epi8(chunk, _mm_setzero_si128()));
+			src += sizeof(__m128i);
+			dest += sizeof(__m128i);
+		}
+		// end NP2_USE_SSE2
+#endif
+		if (src == end) {
+			break;
+		}
+
+		uint32_t ch = *src++;
+		if (ch >= 0x80) {
+			uint32_t lower = 0x80;
+			uint32_t upper = 0xBF;
+			uint32_t trail;
+			if (ch >= 0xC2 && ch <= 0xDF) {
+				trail = 1;
+				ch &= 0x1F;
+			} else if (ch >= 0xE0 && ch <= 0xEF) {
+				trail = 2;
+				lower = (ch == 0xE0) ? 0xA0 : 0x80;
+				upper = (ch == 0xED) ? 0x9F : 0xBF;
+				ch &= 0x0F;
+			} else if (ch >= 0xF0 && ch <= 0xF4) {
+				trail = 3;
+				lower = (ch == 0xF0) ? 0x90 : 0x80;
+				upper = (ch == 0xF4) ? 0x8F : 0xBF;
+				ch &= 0x07;
+			} else {
+				trail = 0;
+				ch = 0xFFFD;
+			}
+			for (; trail != 0; trail--) {
+				if (src == end || *src < lower || *src > upper) {
+					ch = 0xFFFD;
+					break;
+				}
+				ch = (ch << 6) | (*src++ & 0x3F);
+				lower = 0x80;
+				upper = 0xBF;
+			}
+			if (ch >= 0x10000) {
+				ch -= 0x10000;
+				*dest++ = (uint16_t)(0xD800 + (ch >> 10));
+				ch = 0xDC00 + (ch & 0x3FF);
+			}
+		}
+		*dest++ = (uint16_t)ch;
+	}
+	return dest - (uint16_t *)pwszOut;
+}
+
 #if 0
 /* byte length of UTF-8 sequence based on value of first byte.
 	 for UTF-16 (21-bit space), max. code length is 4, so we only need to look
@@ -0,0 +1,542 @@
+// Styled Export
+
+#include <windows.h>
+#include <limits.h>
+#include <string.h>
+#include "SciCall.h"
+#include "Helpers.h"
+#include "Exporter.h"
+
+// Text and style bytes of the copied range are captured when copying, clipboard formats
+// are rendered only when requested by the pasting application. Rendering walks runs of
+// style bytes which map to the same entry of deduplicated style table, each run is
+// converted and escaped in chunks, output is appended to a growing buffer.
+
+// bytes of text converted at once
+#define EXPORT_CHUNK_SIZE		(64*1024)
+#define EXPORT_FONT_NAME_SIZE	(LF_FACESIZE*3)
+
+typedef struct ExportStyle {
+	COLORREF fore;
+	COLORREF back;
+	int size;		// hundredths of a point
+	int weight;
+	BOOL italic;
+	BOOL underline;
+	int font;		// index into fontNames
+} ExportStyle;
+
+typedef struct ExportSnapshot {
+	char *text;
+	unsigned char *styles;
+	Sci_Position length;
+	UINT cpEdit;
+	int styleCount;
+	int fontCount;
+	ExportStyle defaultStyle;
+	BYTE styleMap[256];		// style byte to index into styleTable
+	ExportStyle styleTable[256];
+	// default style and each used style may have different font
+	char fontNames[256 + 1][EXPORT_FONT_NAME_SIZE];
+} ExportSnapshot;
+
+typedef struct ExportBuffer {
+	char *ptr;
+	size_t length;
+	size_t capacity;
+} ExportBuffer;
+
+static ExportSnapshot *exportSnapshot;
+static UINT cfExportRTF;
+static UINT cfExportHTML;
+
+static char *ExportBuffer_Reserve(ExportBuffer *buffer, size_t count) {
+	const size_t length = buffer->length + count;
+	if (length >= buffer->capacity) {
+		size_t capacity = max_z(64*1024, 2*buffer->capacity);
+		capacity = max_z(capacity, length + 1);
+		char *ptr = (char *)(buffer->ptr ? NP2TempReAlloc(buffer->ptr, capacity) : NP2TempAlloc(capacity));
+		if (ptr == NULL) {
+			return NULL;
+		}
+		buffer->ptr = ptr;
+		buffer->capacity = capacity;
+	}
+	return buffer->ptr + buffer->length;
+}
+
+static void ExportBuffer_Append(ExportBuffer *buffer, const char *text, size_t count) {
+	char *ptr = ExportBuffer_Reserve(buffer, count);
+	if (ptr != NULL) {
+		memcpy(ptr, text, count);
+		buffer->length += count;
+	}
+}
+
+static inline void ExportBuffer_AppendString(ExportBuffer *buffer, const char *text) {
+	ExportBuffer_Append(buffer, text, strlen(text));
+}
+
+static HANDLE ExportBuffer_Detach(ExportBuffer *buffer) {
+	HANDLE hData = NULL;
+	if (buffer->ptr != NULL) {
+		hData = GlobalAlloc(GMEM_MOVEABLE, buffer->length + 1);
+		if (hData != NULL) {
+			char *ptr = (char *)GlobalLock(hData);
+			memcpy(ptr, buffer->ptr, buffer->length);
+			ptr[buffer->length] = '\0';
+			GlobalUnlock(hData);
+		}
+		NP2TempFree(buffer->ptr);
+	}
+	return hData;
+}
+
+static void Exporter_GetStyle(ExportSnapshot *snapshot, int style, ExportStyle *exportStyle) {
+	char fontName[EXPORT_FONT_NAME_SIZE] = "";
+	ZeroMemory(exportStyle, sizeof(ExportStyle));
+	exportStyle->fore = SciCall_StyleGetFore(style);
+	exportStyle->back = SciCall_StyleGetBack(style);
+	exportStyle->size = SciCall_StyleGetSizeFractional(style);
+	exportStyle->weight = SciCall_StyleGetWeight(style);
+	exportStyle->italic = SciCall_StyleGetItalic(style);
+	exportStyle->underline = SciCall_StyleGetUnderline(style);
+	SciCall_StyleGetFont(style, fontName);
+
+	int font = 0;
+	while (font < snapshot->fontCount && strcmp(snapshot->fontNames[font], fontName) != 0) {
+		++font;
+	}
+	if (font == snapshot->fontCount) {
+		strcpy(snapshot->fontNames[font], fontName);
+		snapshot->fontCount++;
+	}
+	exportStyle->font = font;
+}
+
+// end of chunk which doesn't split a character
+static Sci_Position Exporter_ChunkEnd(const ExportSnapshot *snapshot, Sci_Position start, Sci_Position end) {
+	if (end - start <= EXPORT_CHUNK_SIZE) {
+		return end;
+	}
+	const char *text = snapshot->text;
+	if (snapshot->cpEdit == SC_CP_UTF8) {
+		Sci_Position pos = start + EXPORT_CHUNK_SIZE;
+		while (pos > start && (text[pos] & 0xC0) == 0x80) {
+			--pos;
+		}
+		return pos;
+	}
+	if (snapshot->cpEdit != 0) {
+		Sci_Position pos = start;
+		while (pos < start + EXPORT_CHUNK_SIZE) {
+			pos += IsDBCSLeadByteEx(snapshot->cpEdit, (BYTE)text[pos]) ? 2 : 1;
+		}
+		return min_pos(pos, end);
+	}
+	return start + EXPORT_CHUNK_SIZE;
+}
+
+static inline int Exporter_ToWide(const ExportSnapshot *snapshot, Sci_Position start, Sci_Position end, WCHAR *wch) {
+	return MultiByteToWideChar(snapshot->cpEdit, 0, snapshot->text + start, (int)(end - start), wch, EXPORT_CHUNK_SIZE + 1);
+}
+
+// next run of styles mapped to same entry of style table
+static inline Sci_Position Exporter_RunEnd(const ExportSnapshot *snapshot, Sci_Position pos, int entry) {
+	const unsigned char * const styles = snapshot->styles;
+	const Sci_Position length = snapshot->length;
+	while (pos < length && snapshot->styleMap[styles[pos]] == entry) {
+		++pos;
+	}
+	return pos;
+}
+
+//=============================================================================
+//
+// Rich Text Format
+//
+static void Exporter_AppendRTFText(ExportBuffer *buffer, const WCHAR *wch, int count) {
+	// at most "\\u-32768?" for each UTF-16 code unit
+	char *ptr = ExportBuffer_Reserve(buffer, (size_t)count*9);
+	if (ptr == NULL) {
+		return;
+	}
+	char * const start = ptr;
+	for (int i = 0; i < count; i++) {
+		const WCHAR ch = wch[i];
+		if (ch == L'\\' || ch == L'{' || ch == L'}') {
+			*ptr++ = '\\';
+			*ptr++ = (char)ch;
+		} else if (ch == L'\r' || ch == L'\n') {
+			if (ch == L'\r' && i + 1 < count && wch[i + 1] == L'\n') {
+				continue;
+			}
+			memcpy(ptr, "\\par\r\n", 6);
+			ptr += 6;
+		} else if (ch == L'\t') {
+			memcpy(ptr, "\\tab ", 5);
+			ptr += 5;
+		} else if (ch < 0x80) {
+			*ptr++ = (char)ch;
+		} else {
+			ptr += wsprintfA(ptr, "\\u%d?", (short)ch);
+		}
+	}
+	buffer->length += ptr - start;
+}
+
+static int Exporter_AddColor(COLORREF *colors, int *colorCount, COLORREF color) {
+	for (int i = 0; i < *colorCount; i++) {
+		if (colors[i] == color) {
+			return i + 1;
+		}
+	}
+	colors[*colorCount] = color;
+	return ++*colorCount;
+}
+
+static HANDLE Exporter_RenderRTF(const ExportSnapshot *snapshot) {
+	ExportBuffer buffer = { NULL, 0, 0 };
+	WCHAR *wch = (WCHAR *)NP2TempAlloc(sizeof(WCHAR) * (EXPORT_CHUNK_SIZE + 1));
+	if (wch == NULL) {
+		return NULL;
+	}
+
+	char tch[256];
+	ExportBuffer_AppendString(&buffer, "{\\rtf1\\ansi\\ansicpg1252\\deff0\\deflang1033\r\n{\\fonttbl");
+	for (int font = 0; font < snapshot->fontCount; font++) {
+		const char *fontName = snapshot->fontNames[font];
+		WCHAR wszName[LF_FACESIZE];
+		const int count = MultiByteToWideChar(CP_UTF8, 0, fontName, -1, wszName, COUNTOF(wszName));
+		wsprintfA(tch, "{\\f%d\\fmodern\\fcharset0 ", font);
+		ExportBuffer_AppendString(&buffer, tch);
+		Exporter_AppendRTFText(&buffer, wszName, max_i(count - 1, 0));
+		ExportBuffer_AppendString(&buffer, ";}");
+	}
+	ExportBuffer_AppendString(&buffer, "}\r\n");
+
+	// control words for each entry of style table, colors are deduplicated again
+	COLORREF colors[2*256 + 2];
+	int colorCount = 0;
+	char (*controls)[128] = (char (*)[128])NP2TempAlloc(128 * snapshot->styleCount);
+	if (controls == NULL) {
+		NP2TempFree(wch);
+		return NULL;
+	}
+	for (int entry = 0; entry < snapshot->styleCount; entry++) {
+		const ExportStyle *style = &snapshot->styleTable[entry];
+		const int fore = Exporter_AddColor(colors, &colorCount, style->fore);
+		const int back = Exporter_AddColor(colors, &colorCount, style->back);
+		wsprintfA(controls[entry], "\\plain\\f%d\\fs%d\\cf%d\\cb%d\\highlight%d%s%s%s ",
+			style->font, style->size*2/SC_FONT_SIZE_MULTIPLIER, fore, back, back,
+			(style->weight >= FW_SEMIBOLD) ? "\\b" : "", style->italic ? "\\i" : "", style->underline ? "\\ul" : "");
+	}
+	const int pageBack = Exporter_AddColor(colors, &colorCount, snapshot->defaultStyle.back);
+
+	ExportBuffer_AppendString(&buffer, "{\\colortbl;");
+	for (int i = 0; i < colorCount; i++) {
+		const COLORREF color = colors[i];
+		wsprintfA(tch, "\\red%d\\green%d\\blue%d;", GetRValue(color), GetGValue(color), GetBValue(color));
+		ExportBuffer_AppendString(&buffer, tch);
+	}
+	wsprintfA(tch, "}\r\n\\viewkind4\\uc1\\pard\\cbpat%d\r\n", pageBack);
+	ExportBuffer_AppendString(&buffer, tch);
+
+	Sci_Position pos = 0;
+	while (pos < snapshot->length) {
+		const int entry = snapshot->styleMap[snapshot->styles[pos]];
+		const Sci_Position runEnd = Exporter_RunEnd(snapshot, pos, entry);
+		ExportBuffer_AppendString(&buffer, controls[entry]);
+		while (pos < runEnd) {
+			const Sci_Position chunkEnd = Exporter_ChunkEnd(snapshot, pos, runEnd);
+			const int count = Exporter_ToWide(snapshot, pos, chunkEnd, wch);
+			Exporter_AppendRTFText(&buffer, wch, count);
+			pos = chunkEnd;
+		}
+	}
+
+	ExportBuffer_AppendString(&buffer, "\r\n}\r\n");
+	NP2TempFree(controls);
+	NP2TempFree(wch);
+	return ExportBuffer_Detach(&buffer);
+}
+
+//=============================================================================
+//
+// HTML Format
+//
+static void Exporter_AppendHTMLText(ExportBuffer *buffer, const char *text, size_t count) {
+	// at most "&quot;" for each byte
+	char *ptr = ExportBuffer_Reserve(buffer, count*6);
+	if (ptr == NULL) {
+		return;
+	}
+	char * const start = ptr;
+	for (size_t i = 0; i < count; i++) {
+		const char ch = text[i];
+		switch (ch) {
+		case '&':
+			memcpy(ptr, "&amp;", 5);
+			ptr += 5;
+			break;
+		case '<':
+			memcpy(ptr, "&lt;", 4);
+			ptr += 4;
+			break;
+		case '>':
+			memcpy(ptr, "&gt;", 4);
+			ptr += 4;
+			break;
+		case '\"':
+			memcpy(ptr, "&quot;", 6);
+			ptr += 6;
+			break;
+		default:
+			*ptr++ = ch;
+			break;
+		}
+	}
+	buffer->length += ptr - start;
+}
+
+static void Exporter_FormatCSS(const ExportSnapshot *snapshot, const ExportStyle *style, const ExportStyle *parent, char *css) {
+	char *ptr = css;
+	if (parent == NULL || style->font != parent->font) {
+		ptr += wsprintfA(ptr, "font-family:'%s';", snapshot->fontNames[style->font]);
+	}
+	if (parent == NULL || style->size != parent->size) {
+		ptr += wsprintfA(ptr, "font-size:%d.%02dpt;", style->size/SC_FONT_SIZE_MULTIPLIER, style->size%SC_FONT_SIZE_MULTIPLIER);
+	}
+	if (parent == NULL || style->fore != parent->fore) {
+		ptr += wsprintfA(ptr, "color:#%02x%02x%02x;", GetRValue(style->fore), GetGValue(style->fore), GetBValue(style->fore));
+	}
+	if (parent == NULL || style->back != parent->back) {
+		ptr += wsprintfA(ptr, "background:#%02x%02x%02x;", GetRValue(style->back), GetGValue(style->back), GetBValue(style->back));
+	}
+	if (style->weight >= FW_SEMIBOLD) {
+		ptr += wsprintfA(ptr, "font-weight:bold;");
+	}
+	if (style->italic) {
+		ptr += wsprintfA(ptr, "font-style:italic;");
+	}
+	if (style->underline) {
+		ptr += wsprintfA(ptr, "text-decoration:underline;");
+	}
+	*ptr = '\0';
+}
+
+static HANDLE Exporter_RenderHTML(const ExportSnapshot *snapshot) {
+	ExportBuffer buffer = { NULL, 0, 0 };
+	const BOOL bUTF8 = snapshot->cpEdit == SC_CP_UTF8;
+	WCHAR *wch = NULL;
+	char *utf8 = NULL;
+	if (!bUTF8) {
+		wch = (WCHAR *)NP2TempAlloc(sizeof(WCHAR) * (EXPORT_CHUNK_SIZE + 1));
+		utf8 = (char *)NP2TempAlloc(3*(EXPORT_CHUNK_SIZE + 1));
+		if (wch == NULL || utf8 == NULL) {
+			if (wch != NULL) {
+				NP2TempFree(wch);
+			}
+			if (utf8 != NULL) {
+				NP2TempFree(utf8);
+			}
+			return NULL;
+		}
+	}
+
+	// offsets are filled after the document is built, each takes 10 digits
+	static const char header[] = "Version:0.9\r\nStartHTML:%010u\r\nEndHTML:%010u\r\nStartFragment:%010u\r\nEndFragment:%010u\r\n";
+	char tch[512];
+	const int headerLength = wsprintfA(tch, header, 0, 0, 0, 0);
+	ExportBuffer_Append(&buffer, tch, headerLength);
+	const size_t startHTML = buffer.length;
+	ExportBuffer_AppendString(&buffer, "<html>\r\n<head>\r\n<meta charset=\"utf-8\">\r\n</head>\r\n<body>\r\n<!--StartFragment-->");
+	const size_t startFragment = buffer.length;
+
+	char css[256];
+	Exporter_FormatCSS(snapshot, &snapshot->defaultStyle, NULL, css);
+	wsprintfA(tch, "<pre style=\"%s\">", css);
+	ExportBuffer_AppendString(&buffer, tch);
+
+	Sci_Position pos = 0;
+	while (pos < snapshot->length) {
+		const int entry = snapshot->styleMap[snapshot->styles[pos]];
+		const Sci_Position runEnd = Exporter_RunEnd(snapshot, pos, entry);
+		Exporter_FormatCSS(snapshot, &snapshot->styleTable[entry], &snapshot->defaultStyle, css);
+		if (css[0] != '\0') {
+			wsprintfA(tch, "<span style=\"%s\">", css);
+			ExportBuffer_AppendString(&buffer, tch);
+		}
+		if (bUTF8) {
+			Exporter_AppendHTMLText(&buffer, snapshot->text + pos, runEnd - pos);
+			pos = runEnd;
+		} else {
+			while (pos < runEnd) {
+				const Sci_Position chunkEnd = Exporter_ChunkEnd(snapshot, pos, runEnd);
+				const int count = Exporter_ToWide(snapshot, pos, chunkEnd, wch);
+				const int cbUTF8 = WideCharToMultiByte(CP_UTF8, 0, wch, count, utf8, 3*(EXPORT_CHUNK_SIZE + 1), NULL, NULL);
+				Exporter_AppendHTMLText(&buffer, utf8, cbUTF8);
+				pos = chunkEnd;
+			}
+		}
+		if (css[0] != '\0') {
+			ExportBuffer_AppendString(&buffer, "</span>");
+		}
+	}
+
+	ExportBuffer_AppendString(&buffer, "</pre>");
+	const size_t endFragment = buffer.length;
+	ExportBuffer_AppendString(&buffer, "<!--EndFragment-->\r\n</body>\r\n</html>\r\n");
+	if (buffer.ptr != NULL) {
+		wsprintfA(tch, header, (UINT)startHTML, (UINT)buffer.length, (UINT)startFragment, (UINT)endFragment);
+		memcpy(buffer.ptr, tch, headerLength);
+	}
+
+	if (!bUTF8) {
+		NP2TempFree(wch);
+		NP2TempFree(utf8);
+	}
+	return ExportBuffer_Detach(&buffer);
+}
+
+static HANDLE Exporter_RenderText(const ExportSnapshot *snapshot) {
+	const int cchText = MultiByteToWideChar(snapshot->cpEdit, 0, snapshot->text, (int)snapshot->length, NULL, 0);
+	HANDLE hData = GlobalAlloc(GMEM_MOVEABLE, sizeof(WCHAR) * (cchText + 1));
+	if (hData != NULL) {
+		WCHAR *pszText = (WCHAR *)GlobalLock(hData);
+		MultiByteToWideChar(snapshot->cpEdit, 0, snapshot->text, (int)snapshot->length, pszText, cchText);
+		pszText[cchText] = L'\0';
+		GlobalUnlock(hData);
+	}
+	return hData;
+}
+
+//=============================================================================
+//
+// Clipboard
+//
+BOOL Exporter_CopySelection(HWND hwndOwner) {
+	Sci_Position iSelStart = SciCall_GetSelectionStart();
+	Sci_Position iSelEnd = SciCall_GetSelectionEnd();
+	if (iSelStart == iSelEnd) {
+		iSelStart = 0;
+		iSelEnd = SciCall_GetLength();
+	}
+	const Sci_Position length = iSelEnd - iSelStart;
+	// clipboard functions take int for text length
+	if (length == 0 || length >= INT_MAX/2) {
+		return FALSE;
+	}
+
+	BeginWaitCursor();
+	ExportSnapshot *snapshot = (ExportSnapshot *)NP2HeapAlloc(sizeof(ExportSnapshot));
+	char *text = (char *)NP2TempAlloc(length + 1);
+	unsigned char *styles = (unsigned char *)NP2TempAlloc(length + 1);
+	if (snapshot == NULL || text == NULL || styles == NULL) {
+		if (snapshot != NULL) {
+			NP2HeapFree(snapshot);
+		}
+		if (text != NULL) {
+			NP2TempFree(text);
+		}
+		if (styles != NULL) {
+			NP2TempFree(styles);
+		}
+		EndWaitCursor();
+		return FALSE;
+	}
+
+	SciCall_EnsureStyledTo(iSelEnd);
+	memcpy(text, SciCall_GetRangePointer(iSelStart, length), length);
+	memcpy(styles, SciCall_GetStyleRangePointer(iSelStart, length), length);
+	snapshot->text = text;
+	snapshot->styles = styles;
+	snapshot->length = length;
+	snapshot->cpEdit = SciCall_GetCodePage();
+	Exporter_GetStyle(snapshot, STYLE_DEFAULT, &snapshot->defaultStyle);
+
+	// only used styles are queried, styles with same attributes share one entry
+	BYTE used[256];
+	ZeroMemory(used, sizeof(used));
+	for (Sci_Position i = 0; i < length; i++) {
+		used[styles[i]] = TRUE;
+	}
+	for (int style = 0; style < 256; style++) {
+		if (used[style]) {
+			ExportStyle exportStyle;
+			Exporter_GetStyle(snapshot, style, &exportStyle);
+			int entry = 0;
+			while (entry < snapshot->styleCount && memcmp(&snapshot->styleTable[entry], &exportStyle, sizeof(ExportStyle)) != 0) {
+				++entry;
+			}
+			if (entry == snapshot->styleCount) {
+				snapshot->styleTable[entry] = exportStyle;
+				snapshot->styleCount++;
+			}
+			snapshot->styleMap[style] = (BYTE)entry;
+		}
+	}
+
+	BOOL succ = FALSE;
+	if (OpenClipboard(hwndOwner)) {
+		if (cfExportRTF == 0) {
+			cfExportRTF = RegisterClipboardFormat(L"Rich Text Format");
+			cfExportHTML = RegisterClipboardFormat(L"HTML Format");
+		}
+		// previous snapshot is discarded by WM_DESTROYCLIPBOARD
+		EmptyClipboard();
+		exportSnapshot = snapshot;
+		SetClipboardData(cfExportRTF, NULL);
+		SetClipboardData(cfExportHTML, NULL);
+		SetClipboardData(CF_UNICODETEXT, NULL);
+		CloseClipboard();
+		succ = TRUE;
+	} else {
+		exportSnapshot = snapshot;
+		Exporter_Discard();
+	}
+	EndWaitCursor();
+	return succ;
+}
+
+// clipboard is opened by the requesting application
+void Exporter_RenderFormat(UINT format) {
+	const ExportSnapshot *snapshot = exportSnapshot;
+	if (snapshot == NULL) {
+		return;
+	}
+
+	HANDLE hData = NULL;
+	if (format == cfExportRTF) {
+		hData = Exporter_RenderRTF(snapshot);
+	} else if (format == cfExportHTML) {
+		hData = Exporter_RenderHTML(snapshot);
+	} else if (format == CF_UNICODETEXT) {
+		hData = Exporter_RenderText(snapshot);
+	}
+	if (hData != NULL && SetClipboardData(format, hData) == NULL) {
+		GlobalFree(hData);
+	}
+}
+
+// render all formats before owner window is destroyed
+void Exporter_RenderAllFormats(HWND hwndOwner) {
+	if (exportSnapshot != NULL && OpenClipboard(hwndOwner)) {
+		if (GetClipboardOwner() == hwndOwner) {
+			Exporter_RenderFormat(cfExportRTF);
+			Exporter_RenderFormat(cfExportHTML);
+			Exporter_RenderFormat(CF_UNICODETEXT);
+		}
+		CloseClipboard();
+	}
+}
+
+void Exporter_Discard(void) {
+	ExportSnapshot *snapshot = exportSnapshot;
+	if (snapshot != NULL) {
+		exportSnapshot = NULL;
+		NP2TempFree(snapshot->text);
+		NP2TempFree(snapshot->styles);
+		NP2HeapFree(snapshot);
+	}
+}
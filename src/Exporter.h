@@ -0,0 +1,9 @@
+// Styled Export
+#pragma once
+
+// copy selection (or whole document) as RTF, HTML and plain text with delayed rendering,
+// hwndOwner receives WM_RENDERFORMAT, WM_RENDERALLFORMATS and WM_DESTROYCLIPBOARD.
+BOOL Exporter_CopySelection(HWND hwndOwner);
+void Exporter_RenderFormat(UINT format);
+void Exporter_RenderAllFormats(HWND hwndOwner);
+void Exporter_Discard(void);
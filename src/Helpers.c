@@ -63,6 +63,74 @@ void StopWatch_ShowLog(const StopWatch *watch, LPCSTR msg) {
 #endif
 }
 
+#define MAX_STARTUP_TIMING_STAGE	32
+
+static struct StartupTiming {
+	StopWatch watch;
+	UINT count;
+	UINT fontCount;
+	LONGLONG fontTime;
+	LPCSTR stage[MAX_STARTUP_TIMING_STAGE];
+	LONGLONG time[MAX_STARTUP_TIMING_STAGE];
+} startupTiming;
+
+void StartupTiming_Start(void) {
+	StopWatch_Start(startupTiming.watch);
+}
+
+void StartupTiming_Mark(LPCSTR stage) {
+	// only record counter here, formatting and I/O are deferred to StartupTiming_Report().
+	const UINT count = startupTiming.count;
+	if (count < MAX_STARTUP_TIMING_STAGE) {
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		startupTiming.stage[count] = stage;
+		startupTiming.time[count] = now.QuadPart;
+		startupTiming.count = count + 1;
+	}
+}
+
+static void StartupTiming_Write(FILE *fp, const char *buf) {
+	if (fp) {
+		fputs(buf, fp);
+	} else {
+		DebugPrint(buf);
+	}
+}
+
+void StartupTiming_Report(LPCWSTR lpszFile) {
+	FILE *fp = NULL;
+	BOOL bConsole = FALSE;
+	if (StrNotEmpty(lpszFile)) {
+		fp = _wfopen(lpszFile, L"a");
+	} else if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+		fp = _wfopen(L"CONOUT$", L"w");
+		bConsole = TRUE;
+	}
+
+	const double freq = (double)(startupTiming.watch.freq.QuadPart);
+	LONGLONG last = startupTiming.watch.begin.QuadPart;
+	char buf[256];
+	snprintf(buf, COUNTOF(buf), "\n%s Notepad2 startup timing (ms)\n%-28s %10s %10s\n", GetCurrentLogTime(), "stage", "elapsed", "total");
+	StartupTiming_Write(fp, buf);
+	for (UINT i = 0; i < startupTiming.count; i++) {
+		const LONGLONG time = startupTiming.time[i];
+		snprintf(buf, COUNTOF(buf), "%-28s %10.3f %10.3f\n", startupTiming.stage[i],
+			((time - last) * 1000) / freq, ((time - startupTiming.watch.begin.QuadPart) * 1000) / freq);
+		last = time;
+		StartupTiming_Write(fp, buf);
+	}
+	snprintf(buf, COUNTOF(buf), "%-28s %10.3f %10u calls\n", "(IsFontAvailable)",
+		(startupTiming.fontTime * 1000) / freq, startupTiming.fontCount);
+	StartupTiming_Write(fp, buf);
+	if (fp) {
+		fclose(fp);
+	}
+	if (bConsole) {
+		FreeConsole();
+	}
+}
+
 void DebugPrintf(const char *fmt, ...) {
 	char buf[1024] = "";
 	va_list va;
@@ -72,6 +140,35 @@ void DebugPrintf(const char *fmt, ...) {
 	DebugPrint(buf);
 }
 
+UINT64 IniSectionHash(LPCWSTR lpSection, LPCWSTR lpBuf) {
+	// 64-bit FNV-1a, include terminating NUL of each string
+	UINT64 hash = 14695981039346656037ULL;
+	LPCWSTR p = lpSection;
+	do {
+		hash = (hash ^ *p) * 1099511628211ULL;
+	} while (*p++);
+
+	p = lpBuf;
+	while (*p) {
+		do {
+			hash = (hash ^ *p) * 1099511628211ULL;
+		} while (*p++);
+	}
+	return hash;
+}
+
+BOOL SaveIniSectionIfChanged(LPCWSTR lpSection, LPCWSTR lpBuf, UINT64 *hash) {
+	const UINT64 value = IniSectionHash(lpSection, lpBuf);
+	if (value == *hash) {
+		return TRUE;
+	}
+	if (SaveIniSection(lpSection, lpBuf)) {
+		*hash = value;
+		return TRUE;
+	}
+	return FALSE;
+}
+
 void IniClearSectionEx(LPCWSTR lpSection, LPCWSTR lpszIniFile, BOOL bDelete) {
 	if (StrIsEmpty(lpszIniFile)) {
 		return;
@@ -137,6 +234,15 @@ BOOL IniSectionParseArray(IniSection *section, LPWSTR lpCachedIniSection, BOOL q
 	return count != 0;
 }
 
+// FNV-1a hash of key characters and length
+static inline UINT IniSectionHashKey(LPCWSTR key, UINT keyLen) {
+	UINT hash = 2166136261U ^ keyLen;
+	for (UINT i = 0; i < keyLen; i++) {
+		hash = (hash ^ key[i]) * 16777619U;
+	}
+	return hash;
+}
+
 BOOL IniSectionParse(IniSection *section, LPWSTR lpCachedIniSection) {
 	IniSectionClear(section);
 	if (StrIsEmpty(lpCachedIniSection)) {
@@ -144,6 +250,9 @@ BOOL IniSectionParse(IniSection *section, LPWSTR lpCachedIniSection) {
 	}
 
 	const int capacity = section->capacity;
+	const UINT mask = section->mask;
+	IniKeyValueNode **table = section->hashTable;
+	ZeroMemory(table, (mask + 1) * sizeof(IniKeyValueNode *));
 	LPWSTR p = lpCachedIniSection;
 	int count = 0;
 
@@ -153,32 +262,24 @@ BOOL IniSectionParse(IniSection *section, LPWSTR lpCachedIniSection) {
 			*v++ = L'\0';
 			const UINT keyLen = (UINT)(v - p - 1);
 			IniKeyValueNode *node = &section->nodeList[count];
-			node->hash = keyLen | ((*(const UINT *)p) << 8);
+			const UINT hash = IniSectionHashKey(p, keyLen);
+			node->hash = hash;
 			node->key = p;
 			node->value = v;
+			// duplicate key is placed after previous one, and found by next lookup of same key.
+			UINT index = hash & mask;
+			while (table[index] != NULL) {
+				index = (index + 1) & mask;
+			}
+			table[index] = node;
 			++count;
 			p = v;
 		}
 		p = StrEnd(p) + 1;
 	} while (*p && count < capacity);
 
-	if (count == 0) {
-		return FALSE;
-	}
-
 	section->count = count;
-	section->head = &section->nodeList[0];
-	--count;
-#if IniSectionImplUseSentinelNode
-	section->nodeList[count].next = section->sentinel;
-#else
-	section->nodeList[count].next = NULL;
-#endif
-	while (count != 0) {
-		section->nodeList[count - 1].next = &section->nodeList[count];
-		--count;
-	}
-	return TRUE;
+	return count != 0;
 }
 
 LPCWSTR IniSectionUnsafeGetValue(IniSection *section, LPCWSTR key, int keyLen) {
@@ -186,47 +287,21 @@ LPCWSTR IniSectionUnsafeGetValue(IniSection *section, LPCWSTR key, int keyLen) {
 		keyLen = lstrlen(key);
 	}
 
-	const UINT hash = keyLen | ((*(const UINT *)key) << 8);
-	IniKeyValueNode *node = section->head;
-	IniKeyValueNode *prev = NULL;
-#if IniSectionImplUseSentinelNode
-	section->sentinel->hash = hash;
-	while (TRUE) {
-		if (node->hash == hash) {
-			if (node == section->sentinel) {
-				return NULL;
-			}
-			if (StrEqual(node->key, key)) {
-				// remove the node
-				--section->count;
-				if (prev == NULL) {
-					section->head = node->next;
-				} else {
-					prev->next = node->next;
-				}
-				return node->value;
-			}
-		}
-		prev = node;
-		node = node->next;
-	}
-#else
-	do {
-		if (node->hash == hash && StrEqual(node->key, key)) {
-			// remove the node
+	const UINT hash = IniSectionHashKey(key, keyLen);
+	const UINT mask = section->mask;
+	IniKeyValueNode * const *table = section->hashTable;
+	UINT index = hash & mask;
+	IniKeyValueNode *node;
+	while ((node = table[index]) != NULL) {
+		if (node->hash == hash && node->key != NULL && StrEqual(node->key, key)) {
+			// keep the slot to not break probe sequence, only mark the node as consumed.
 			--section->count;
-			if (prev == NULL) {
-				section->head = node->next;
-			} else {
-				prev->next = node->next;
-			}
+			node->key = NULL;
 			return node->value;
 		}
-		prev = node;
-		node = node->next;
-	} while (node);
+		index = (index + 1) & mask;
+	}
 	return NULL;
-#endif
 }
 
 void IniSectionGetStringImpl(IniSection *section, LPCWSTR key, int keyLen, LPCWSTR lpDefault, LPWSTR lpReturnedString, int cchReturnedString) {
@@ -459,6 +534,230 @@ HBITMAP ResizeImageForDPI(HBITMAP hbmp, UINT dpi, int height) {
 	return hbmp;
 }
 
+//=============================================================================
+//
+// MemoryArena
+//
+// Blocks are allocated from temporary heap, request larger than block size
+// gets its own block, which is put behind current block to keep its free space.
+typedef struct MemoryArenaBlock {
+	struct MemoryArenaBlock *prev;
+	size_t used;
+	size_t capacity;
+} MemoryArenaBlock;
+
+#define MemoryArena_BlockSize		(64*1024)
+#define MemoryArena_Alignment		16
+#define MemoryArena_HeaderSize		((sizeof(MemoryArenaBlock) + MemoryArena_Alignment - 1) & ~(size_t)(MemoryArena_Alignment - 1))
+// decommit free pages of temporary heap after releasing this many bytes
+#define MemoryArena_CompactSize		(16*1024*1024)
+
+void *MemoryArena_Alloc(MemoryArena *arena, size_t size) {
+	size = (size + MemoryArena_Alignment - 1) & ~(size_t)(MemoryArena_Alignment - 1);
+	MemoryArenaBlock *block = arena->block;
+	if (block == NULL || block->capacity - block->used < size) {
+		const size_t capacity = (size > MemoryArena_BlockSize) ? size : MemoryArena_BlockSize;
+		block = (MemoryArenaBlock *)NP2TempAlloc(MemoryArena_HeaderSize + capacity);
+		if (block == NULL) {
+			return NULL;
+		}
+		block->capacity = capacity;
+		if (arena->block != NULL && capacity > MemoryArena_BlockSize) {
+			block->prev = arena->block->prev;
+			arena->block->prev = block;
+		} else {
+			block->prev = arena->block;
+			arena->block = block;
+		}
+	}
+
+	char *ptr = (char *)block + MemoryArena_HeaderSize + block->used;
+	block->used += size;
+	return ptr;
+}
+
+void MemoryArena_Release(MemoryArena *arena) {
+	size_t total = 0;
+	MemoryArenaBlock *block = arena->block;
+	while (block != NULL) {
+		MemoryArenaBlock * const prev = block->prev;
+		total += block->capacity;
+		NP2TempFree(block);
+		block = prev;
+	}
+	arena->block = NULL;
+	if (total >= MemoryArena_CompactSize) {
+		HeapCompact(g_hTempHeap, 0);
+	}
+}
+
+//=============================================================================
+//
+// WorkerPool
+//
+// One thread for each processor takes tasks from per priority queues, tasks of
+// higher priority are started first. A task not started yet can be taken back
+// and run on current thread, so waiting for it never depends on a free thread.
+typedef struct WorkerTask {
+	struct WorkerTask *next;
+	LPTHREAD_START_ROUTINE lpStartAddress;
+	LPVOID lpParam;
+	HANDLE task;		// handle returned by WorkerPool_Submit(), NULL for posted task
+	HANDLE eventDone;	// duplicate of task owned by the pool
+} WorkerTask;
+
+static struct WorkerPool {
+	volatile LONG state;	// 0: not started, 1: starting, 2: running, 3: failed
+	CRITICAL_SECTION lock;
+	HANDLE semaphore;
+	WorkerTask *head[WorkerPriority_Count];
+	WorkerTask *tail[WorkerPriority_Count];
+} workerPool;
+
+static void WorkerPool_RunTask(WorkerTask *task) {
+	task->lpStartAddress(task->lpParam);
+	if (task->eventDone) {
+		SetEvent(task->eventDone);
+		CloseHandle(task->eventDone);
+	}
+	NP2HeapFree(task);
+}
+
+static DWORD WINAPI WorkerPool_Thread(LPVOID lpParam) {
+	UNREFERENCED_PARAMETER(lpParam);
+	while (WaitForSingleObject(workerPool.semaphore, INFINITE) == WAIT_OBJECT_0) {
+		WorkerTask *task = NULL;
+		EnterCriticalSection(&workerPool.lock);
+		for (int priority = 0; priority < WorkerPriority_Count; priority++) {
+			task = workerPool.head[priority];
+			if (task != NULL) {
+				workerPool.head[priority] = task->next;
+				if (task->next == NULL) {
+					workerPool.tail[priority] = NULL;
+				}
+				break;
+			}
+		}
+		LeaveCriticalSection(&workerPool.lock);
+		// NULL when the task was taken back by WorkerPool_RunIfQueued()
+		if (task != NULL) {
+			WorkerPool_RunTask(task);
+		}
+	}
+	return 0;
+}
+
+static BOOL WorkerPool_Start(void) {
+	LONG state = InterlockedCompareExchange(&workerPool.state, 1, 0);
+	if (state == 0) {
+		InitializeCriticalSection(&workerPool.lock);
+		workerPool.semaphore = CreateSemaphore(NULL, 0, MAXLONG, NULL);
+		DWORD count = 0;
+		if (workerPool.semaphore != NULL) {
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			const DWORD threadCount = max_u(info.dwNumberOfProcessors, 2);
+			for (DWORD i = 0; i < threadCount; i++) {
+				HANDLE hThread = CreateThread(NULL, 0, WorkerPool_Thread, NULL, 0, NULL);
+				if (hThread != NULL) {
+					CloseHandle(hThread);
+					++count;
+				}
+			}
+		}
+		state = (count != 0) ? 2 : 3;
+		InterlockedExchange(&workerPool.state, state);
+	}
+	while (state == 1) {
+		Sleep(0);
+		state = workerPool.state;
+	}
+	return state == 2;
+}
+
+static BOOL WorkerPool_Queue(LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, int priority, HANDLE *pTask) {
+	if (!WorkerPool_Start()) {
+		return FALSE;
+	}
+	WorkerTask *task = (WorkerTask *)NP2HeapAlloc(sizeof(WorkerTask));
+	if (task == NULL) {
+		return FALSE;
+	}
+	task->lpStartAddress = lpStartAddress;
+	task->lpParam = lpParam;
+	if (pTask != NULL) {
+		HANDLE hProcess = GetCurrentProcess();
+		task->task = CreateEvent(NULL, TRUE, FALSE, NULL);
+		if (task->task == NULL || !DuplicateHandle(hProcess, task->task, hProcess, &task->eventDone, 0, FALSE, DUPLICATE_SAME_ACCESS)) {
+			if (task->task != NULL) {
+				CloseHandle(task->task);
+			}
+			NP2HeapFree(task);
+			return FALSE;
+		}
+		*pTask = task->task;
+	}
+
+	EnterCriticalSection(&workerPool.lock);
+	if (workerPool.tail[priority] != NULL) {
+		workerPool.tail[priority]->next = task;
+	} else {
+		workerPool.head[priority] = task;
+	}
+	workerPool.tail[priority] = task;
+	LeaveCriticalSection(&workerPool.lock);
+	ReleaseSemaphore(workerPool.semaphore, 1, NULL);
+	return TRUE;
+}
+
+HANDLE WorkerPool_Submit(LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, int priority) {
+	HANDLE task = NULL;
+	WorkerPool_Queue(lpStartAddress, lpParam, priority, &task);
+	return task;
+}
+
+BOOL WorkerPool_Post(LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, int priority) {
+	return WorkerPool_Queue(lpStartAddress, lpParam, priority, NULL);
+}
+
+// run the task on current thread when no pool thread has started it.
+BOOL WorkerPool_RunIfQueued(HANDLE task) {
+	if (workerPool.state != 2) {
+		// thread not from the pool, e.g. file watching
+		return FALSE;
+	}
+	WorkerTask *found = NULL;
+	EnterCriticalSection(&workerPool.lock);
+	for (int priority = 0; priority < WorkerPriority_Count && found == NULL; priority++) {
+		WorkerTask *prev = NULL;
+		for (WorkerTask *node = workerPool.head[priority]; node != NULL; prev = node, node = node->next) {
+			if (node->task == task) {
+				if (prev != NULL) {
+					prev->next = node->next;
+				} else {
+					workerPool.head[priority] = node->next;
+				}
+				if (workerPool.tail[priority] == node) {
+					workerPool.tail[priority] = prev;
+				}
+				found = node;
+				break;
+			}
+		}
+	}
+	LeaveCriticalSection(&workerPool.lock);
+	if (found != NULL) {
+		WorkerPool_RunTask(found);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+// safe on pool threads, the waited task is either running or run by current thread.
+void WorkerPool_Wait(HANDLE task) {
+	WorkerPool_RunIfQueued(task);
+	WaitForSingleObject(task, INFINITE);
+}
 
 void BackgroundWorker_Init(BackgroundWorker *worker, HWND hwnd) {
 	worker->hwnd = hwnd;
@@ -466,10 +765,19 @@ void BackgroundWorker_Init(BackgroundWorker *worker, HWND hwnd) {
 	worker->workerThread = NULL;
 }
 
+// eventCancel is the cancellation token, completion is posted to hwnd by lpStartAddress.
+BOOL BackgroundWorker_Start(BackgroundWorker *worker, LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, int priority) {
+	HANDLE task = WorkerPool_Submit(lpStartAddress, lpParam, priority);
+	worker->workerThread = task;
+	return task != NULL;
+}
+
 void BackgroundWorker_Stop(BackgroundWorker *worker) {
 	SetEvent(worker->eventCancel);
 	HANDLE workerThread = InterlockedExchangePointer(&worker->workerThread, NULL);
 	if (workerThread) {
+		// cancelled task not started yet returns early on current thread
+		WorkerPool_RunIfQueued(workerThread);
 		while (WaitForSingleObject(workerThread, 0) != WAIT_OBJECT_0) {
 			MSG msg;
 			if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
@@ -491,6 +799,30 @@ void BackgroundWorker_Destroy(BackgroundWorker *worker) {
 	CloseHandle(worker->eventCancel);
 }
 
+BOOL DispatchPaintMessages(void) {
+	BOOL bEscape = FALSE;
+	MSG msg;
+	while (PeekMessage(&msg, NULL, WM_KEYFIRST, WM_KEYLAST, PM_REMOVE)) {
+		if (msg.message == WM_KEYDOWN && msg.wParam == VK_ESCAPE) {
+			bEscape = TRUE;
+		}
+	}
+	while (PeekMessage(&msg, NULL, WM_MOUSEFIRST, WM_MOUSELAST, PM_REMOVE)) {}
+	while (PeekMessage(&msg, NULL, WM_NCMOUSEMOVE, WM_NCXBUTTONDBLCLK, PM_REMOVE)) {}
+	while (PeekMessage(&msg, NULL, WM_PAINT, WM_PAINT, PM_REMOVE)) {
+		DispatchMessage(&msg);
+	}
+	return bEscape;
+}
+
+void WaitForObjectDispatchPaint(HANDLE hObject, void (*onEscape)(LPVOID lpParam), LPVOID lpParam) {
+	while (MsgWaitForMultipleObjects(1, &hObject, FALSE, INFINITE, QS_INPUT | QS_PAINT | QS_SENDMESSAGE) == WAIT_OBJECT_0 + 1) {
+		if (DispatchPaintMessages() && onEscape != NULL) {
+			onEscape(lpParam);
+		}
+	}
+}
+
 //=============================================================================
 //
 // PrivateSetCurrentProcessExplicitAppUserModelID()
@@ -578,6 +910,33 @@ BOOL BitmapMergeAlpha(HBITMAP hbmp, COLORREF crDest) {
 				*prgba = color | 0xff000000U;
 			}
 
+#elif NP2_USE_NEON
+			#define BitmapMergeAlpha_Tag	"neon 16x1"
+			const ULONG count = bmp.bmHeight * bmp.bmWidth;
+			RGBQUAD *prgba = (RGBQUAD *)bmp.bmBits;
+
+			const uint8x8_t blue = vdup_n_u8(GetBValue(crDest));
+			const uint8x8_t green = vdup_n_u8(GetGValue(crDest));
+			const uint8x8_t red = vdup_n_u8(GetRValue(crDest));
+			ULONG x = 0;
+			for (; x + 16 <= count; x += 16) {
+				// deinterleave into blue, green, red and alpha
+				uint8x16x4_t pixel = vld4q_u8((const uint8_t *)(prgba + x));
+				const uint8x16_t alpha = pixel.val[3];
+				pixel.val[0] = neon_alpha_blend_u8x16(pixel.val[0], alpha, blue);
+				pixel.val[1] = neon_alpha_blend_u8x16(pixel.val[1], alpha, green);
+				pixel.val[2] = neon_alpha_blend_u8x16(pixel.val[2], alpha, red);
+				pixel.val[3] = vdupq_n_u8(0xff);
+				vst4q_u8((uint8_t *)(prgba + x), pixel);
+			}
+			for (; x < count; x++) {
+				const BYTE alpha = prgba[x].rgbReserved;
+				prgba[x].rgbRed = ((prgba[x].rgbRed * alpha) + (GetRValue(crDest) * (255 ^ alpha))) / 255;
+				prgba[x].rgbGreen = ((prgba[x].rgbGreen * alpha) + (GetGValue(crDest) * (255 ^ alpha))) / 255;
+				prgba[x].rgbBlue = ((prgba[x].rgbBlue * alpha) + (GetBValue(crDest) * (255 ^ alpha))) / 255;
+				prgba[x].rgbReserved = 0xFF;
+			}
+
 #else
 			#define BitmapMergeAlpha_Tag	"scalar"
 			const ULONG count = bmp.bmHeight * bmp.bmWidth;
@@ -686,6 +1045,30 @@ BOOL BitmapAlphaBlend(HBITMAP hbmp, COLORREF crDest, BYTE alpha) {
 				_mm_storeu_si128(prgba, i32x4Fore);
 			}
 
+#elif NP2_USE_NEON
+			#define BitmapAlphaBlend_Tag	"neon 16x1"
+			const ULONG count = bmp.bmHeight * bmp.bmWidth;
+			RGBQUAD *prgba = (RGBQUAD *)bmp.bmBits;
+
+			const uint8x16_t i8x16Alpha = vdupq_n_u8(alpha);
+			const uint8x8_t blue = vdup_n_u8(GetBValue(crDest));
+			const uint8x8_t green = vdup_n_u8(GetGValue(crDest));
+			const uint8x8_t red = vdup_n_u8(GetRValue(crDest));
+			ULONG x = 0;
+			for (; x + 16 <= count; x += 16) {
+				// deinterleave into blue, green, red and alpha, alpha channel is kept
+				uint8x16x4_t pixel = vld4q_u8((const uint8_t *)(prgba + x));
+				pixel.val[0] = neon_alpha_blend_u8x16(pixel.val[0], i8x16Alpha, blue);
+				pixel.val[1] = neon_alpha_blend_u8x16(pixel.val[1], i8x16Alpha, green);
+				pixel.val[2] = neon_alpha_blend_u8x16(pixel.val[2], i8x16Alpha, red);
+				vst4q_u8((uint8_t *)(prgba + x), pixel);
+			}
+			for (; x < count; x++) {
+				prgba[x].rgbRed = ((prgba[x].rgbRed * alpha) + (GetRValue(crDest) * (255 ^ alpha))) / 255;
+				prgba[x].rgbGreen = ((prgba[x].rgbGreen * alpha) + (GetGValue(crDest) * (255 ^ alpha))) / 255;
+				prgba[x].rgbBlue = ((prgba[x].rgbBlue * alpha) + (GetBValue(crDest) * (255 ^ alpha))) / 255;
+			}
+
 #else
 			#define BitmapAlphaBlend_Tag	"scalar"
 			const ULONG count = bmp.bmHeight * bmp.bmWidth;
@@ -720,9 +1103,70 @@ BOOL BitmapGrayScale(HBITMAP hbmp) {
 		if (bmp.bmBitsPixel == 32) {
 			const ULONG count = bmp.bmHeight * bmp.bmWidth;
 			RGBQUAD *prgba = (RGBQUAD *)bmp.bmBits;
+			ULONG x = 0;
 
-			for (ULONG x = 0; x < count; x++) {
-				// gray = 0.299*red + 0.587*green + 0.114*blue
+			// gray = 0.299*red + 0.587*green + 0.114*blue, then blend with 0xD0 at alpha 0x80
+#if NP2_USE_AVX2
+			const __m256i i16x16Weight1 = _mm256_set1_epi32(15 | (38 << 16));	// blue, red
+			const __m256i i16x16Weight2 = _mm256_set1_epi32(75);				// green, alpha
+			const __m256i i32x8Back = _mm256_set1_epi32(0xD0 * (255 ^ 0x80));
+			const __m256i i32x8Mask = _mm256_set1_epi32(0x00ff00ff);
+			for (; x + 8 <= count; x += 8) {
+				const __m256i origin = _mm256_loadu_si256((__m256i *)(prgba + x));
+				const __m256i even = _mm256_and_si256(origin, i32x8Mask);
+				const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(origin, 8), i32x8Mask);
+				__m256i gray = _mm256_add_epi32(_mm256_madd_epi16(even, i16x16Weight1), _mm256_madd_epi16(odd, i16x16Weight2));
+				gray = _mm256_srli_epi32(gray, 7);
+				gray = _mm256_srli_epi32(_mm256_add_epi32(_mm256_slli_epi32(gray, 7), i32x8Back), 8);
+				gray = _mm256_or_si256(gray, _mm256_or_si256(_mm256_slli_epi32(gray, 8), _mm256_slli_epi32(gray, 16)));
+				gray = _mm256_or_si256(gray, _mm256_andnot_si256(_mm256_set1_epi32(0x00ffffff), origin));
+				_mm256_storeu_si256((__m256i *)(prgba + x), gray);
+			}
+
+#elif NP2_USE_SSE2
+			const __m128i i16x8Weight1 = _mm_set1_epi32(15 | (38 << 16));	// blue, red
+			const __m128i i16x8Weight2 = _mm_set1_epi32(75);				// green, alpha
+			const __m128i i32x4Back = _mm_set1_epi32(0xD0 * (255 ^ 0x80));
+			const __m128i i32x4Mask = _mm_set1_epi32(0x00ff00ff);
+			for (; x + 4 <= count; x += 4) {
+				const __m128i origin = _mm_loadu_si128((__m128i *)(prgba + x));
+				const __m128i even = _mm_and_si128(origin, i32x4Mask);
+				const __m128i odd = _mm_and_si128(_mm_srli_epi32(origin, 8), i32x4Mask);
+				__m128i gray = _mm_add_epi32(_mm_madd_epi16(even, i16x8Weight1), _mm_madd_epi16(odd, i16x8Weight2));
+				gray = _mm_srli_epi32(gray, 7);
+				gray = _mm_srli_epi32(_mm_add_epi32(_mm_slli_epi32(gray, 7), i32x4Back), 8);
+				gray = _mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8), _mm_slli_epi32(gray, 16)));
+				gray = _mm_or_si128(gray, _mm_andnot_si128(_mm_set1_epi32(0x00ffffff), origin));
+				_mm_storeu_si128((__m128i *)(prgba + x), gray);
+			}
+
+#elif NP2_USE_NEON
+			const uint8x8_t blue = vdup_n_u8(15);
+			const uint8x8_t green = vdup_n_u8(75);
+			const uint8x8_t red = vdup_n_u8(38);
+			const uint16x8_t back = vdupq_n_u16(0xD0 * (255 ^ 0x80));
+			for (; x + 16 <= count; x += 16) {
+				// deinterleave into blue, green, red and alpha, alpha channel is kept
+				uint8x16x4_t pixel = vld4q_u8((const uint8_t *)(prgba + x));
+				uint16x8_t lo = vmull_u8(vget_low_u8(pixel.val[0]), blue);
+				lo = vmlal_u8(lo, vget_low_u8(pixel.val[1]), green);
+				lo = vmlal_u8(lo, vget_low_u8(pixel.val[2]), red);
+				uint16x8_t hi = vmull_u8(vget_high_u8(pixel.val[0]), blue);
+				hi = vmlal_u8(hi, vget_high_u8(pixel.val[1]), green);
+				hi = vmlal_u8(hi, vget_high_u8(pixel.val[2]), red);
+				lo = vshrq_n_u16(lo, 7);
+				hi = vshrq_n_u16(hi, 7);
+				lo = vshrq_n_u16(vaddq_u16(vshlq_n_u16(lo, 7), back), 8);
+				hi = vshrq_n_u16(vaddq_u16(vshlq_n_u16(hi, 7), back), 8);
+				const uint8x16_t gray = vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+				pixel.val[0] = gray;
+				pixel.val[1] = gray;
+				pixel.val[2] = gray;
+				vst4q_u8((uint8_t *)(prgba + x), pixel);
+			}
+#endif
+
+			for (; x < count; x++) {
 				BYTE gray = (prgba[x].rgbRed * 38 + prgba[x].rgbGreen * 75 + prgba[x].rgbBlue * 15) >> 7;
 				gray = ((gray * 0x80) + (0xD0 * (255 ^ 0x80))) >> 8;
 				prgba[x].rgbRed = prgba[x].rgbGreen = prgba[x].rgbBlue = gray;
@@ -784,6 +1228,9 @@ static int CALLBACK EnumFontFamExProc(CONST LOGFONT *plf, CONST TEXTMETRIC *ptm,
 
 BOOL IsFontAvailable(LPCWSTR lpszFontName) {
 	BOOL fFound = FALSE;
+	LARGE_INTEGER begin;
+	LARGE_INTEGER end;
+	QueryPerformanceCounter(&begin);
 
 	LOGFONT lf;
 	ZeroMemory(&lf, sizeof(lf));
@@ -794,6 +1241,10 @@ BOOL IsFontAvailable(LPCWSTR lpszFontName) {
 	EnumFontFamiliesEx(hDC, &lf, EnumFontFamExProc, (LPARAM)&fFound, 0);
 	ReleaseDC(NULL, hDC);
 
+	// accumulated for StartupTiming_Report(), font enumeration is spread over several startup stages.
+	QueryPerformanceCounter(&end);
+	startupTiming.fontTime += end.QuadPart - begin.QuadPart;
+	++startupTiming.fontCount;
 	return fFound;
 }
 
@@ -1424,6 +1875,17 @@ LRESULT SendWMSize(HWND hwnd) {
 	return SendMessage(hwnd, WM_SIZE, SIZE_RESTORED, MAKELPARAM(rc.right, rc.bottom));
 }
 
+#if _WIN32_WINNT < _WIN32_WINNT_WIN8
+UINT_PTR SetCoalescableTimerEx(HWND hwnd, UINT_PTR nIDEvent, UINT uElapse, TIMERPROC lpTimerFunc, ULONG uToleranceDelay) {
+	typedef UINT_PTR (WINAPI *SetCoalescableTimerSig)(HWND hwnd, UINT_PTR nIDEvent, UINT uElapse, TIMERPROC lpTimerFunc, ULONG uToleranceDelay);
+	SetCoalescableTimerSig pfnSetCoalescableTimer = DLLFunctionEx(SetCoalescableTimerSig, L"user32.dll", "SetCoalescableTimer");
+	if (pfnSetCoalescableTimer != NULL) {
+		return pfnSetCoalescableTimer(hwnd, nIDEvent, uElapse, lpTimerFunc, uToleranceDelay);
+	}
+	return SetTimer(hwnd, nIDEvent, uElapse, lpTimerFunc);
+}
+#endif
+
 //=============================================================================
 //
 // StatusSetTextID()
@@ -2535,6 +2997,7 @@ BOOL MRU_Load(LPMRULIST pmru) {
 	IniSectionInit(pIniSection, MRU_MAXITEMS);
 
 	LoadIniSection(pmru->szRegKey, pIniSectionBuf, cchIniSection);
+	pmru->hash = IniSectionHash(pmru->szRegKey, pIniSectionBuf);
 	IniSectionParseArray(pIniSection, pIniSectionBuf, pmru->iFlags & MRUFlags_QuoteValue);
 	const int count = pIniSection->count;
 	const int size = pmru->iSize;
@@ -2552,12 +3015,16 @@ BOOL MRU_Load(LPMRULIST pmru) {
 	return TRUE;
 }
 
-BOOL MRU_Save(LPCMRULIST pmru) {
+BOOL MRU_Save(LPMRULIST pmru) {
 	if (StrIsEmpty(szIniFile)) {
 		return TRUE;
 	}
 	if (MRU_GetCount(pmru) == 0) {
-		IniClearSection(pmru->szRegKey);
+		const UINT64 hash = IniSectionHash(pmru->szRegKey, L"");
+		if (hash != pmru->hash) {
+			IniClearSection(pmru->szRegKey);
+			pmru->hash = hash;
+		}
 		return TRUE;
 	}
 
@@ -2579,7 +3046,7 @@ BOOL MRU_Save(LPCMRULIST pmru) {
 		}
 	}
 
-	SaveIniSection(pmru->szRegKey, pIniSectionBuf);
+	SaveIniSectionIfChanged(pmru->szRegKey, pIniSectionBuf, &pmru->hash);
 	NP2HeapFree(pIniSectionBuf);
 	return TRUE;
 }
@@ -148,6 +148,11 @@ NP2_inline BOOL IsAlphaNumeric(int ch) {
 		|| (ch >= 'A' && ch <= 'Z');
 }
 
+// word character class shared with CharClassify::SetDefaultCharClasses()
+NP2_inline BOOL IsDefaultWordChar(int ch) {
+	return ch >= 0x80 || IsAlphaNumeric(ch) || ch == '_';
+}
+
 NP2_inline BOOL IsPunctuation(int ch) {
 	return (ch > 32 && ch < '0')
 		|| (ch > '9' && ch < 'A')
@@ -278,6 +283,11 @@ NP2_inline double StopWatch_Get(const StopWatch *watch) {
 void StopWatch_Show(const StopWatch *watch, LPCWSTR msg);
 void StopWatch_ShowLog(const StopWatch *watch, LPCSTR msg);
 
+// startup stage profiler, stages are always recorded, report is only written with /timing.
+void StartupTiming_Start(void);
+void StartupTiming_Mark(LPCSTR stage);
+void StartupTiming_Report(LPCWSTR lpszFile);
+
 #define DebugPrint(msg)		OutputDebugStringA(msg)
 #if defined(__GNUC__) || defined(__clang__)
 void DebugPrintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
@@ -287,6 +297,7 @@ void DebugPrintf(const char *fmt, ...);
 
 extern HINSTANCE g_hInstance;
 extern HANDLE g_hDefaultHeap;
+extern HANDLE g_hTempHeap;
 #if _WIN32_WINNT < _WIN32_WINNT_WIN8
 extern DWORD g_uWinVer;
 #endif
@@ -419,6 +430,22 @@ NP2_inline DWORD GetCurrentIconHandleFlags(void) {
 #define NP2HeapFree(hMem)			HeapFree(g_hDefaultHeap, 0, (hMem))
 #define NP2HeapSize(hMem)			HeapSize(g_hDefaultHeap, 0, (hMem))
 
+// private heap for large buffers that only live during one command,
+// keeps them from fragmenting process heap used by long lived data.
+#define NP2TempAlloc(size)			HeapAlloc(g_hTempHeap, HEAP_ZERO_MEMORY, (size))
+#define NP2TempReAlloc(hMem, size)	HeapReAlloc(g_hTempHeap, HEAP_ZERO_MEMORY, (hMem), (size))
+#define NP2TempFree(hMem)			HeapFree(g_hTempHeap, 0, (hMem))
+
+// bump allocator for temporaries of one command, not thread safe.
+// all allocations are released together by MemoryArena_Release().
+typedef struct MemoryArena {
+	struct MemoryArenaBlock *block;
+} MemoryArena;
+
+#define MemoryArena_Init(arena)		((arena)->block = NULL)
+void *MemoryArena_Alloc(MemoryArena *arena, size_t size);
+void MemoryArena_Release(MemoryArena *arena);
+
 #define IniGetString(lpSection, lpName, lpDefault, lpReturnedStr, nSize) \
 	GetPrivateProfileString(lpSection, lpName, lpDefault, lpReturnedStr, nSize, szIniFile)
 #define IniGetInt(lpSection, lpName, nDefault) \
@@ -461,38 +488,37 @@ NP2_inline void IniSetBoolEx(LPCWSTR lpSection, LPCWSTR lpName, BOOL b, BOOL bDe
 #define SaveIniSection(lpSection, lpBuf) \
 	WritePrivateProfileSection(lpSection, lpBuf, szIniFile)
 
-struct IniKeyValueNode;
+// hash of section name and content (as returned by GetPrivateProfileSection), computed on load and save
+// to skip rewriting unchanged section, which is slow on roaming or redirected profile.
+UINT64 IniSectionHash(LPCWSTR lpSection, LPCWSTR lpBuf);
+BOOL SaveIniSectionIfChanged(LPCWSTR lpSection, LPCWSTR lpBuf, UINT64 *hash);
+
 typedef struct IniKeyValueNode {
-	struct IniKeyValueNode *next;
 	UINT hash;
-	LPCWSTR key;
+	LPCWSTR key;	// NULL after the value is returned by lookup
 	LPCWSTR value;
 } IniKeyValueNode;
 
-// https://en.wikipedia.org/wiki/Sentinel_node
-// https://en.wikipedia.org/wiki/Sentinel_value
-#define IniSectionImplUseSentinelNode	1
-
+// https://en.wikipedia.org/wiki/Open_addressing
+// hash index of nodeList built by IniSectionParse(), linear probing with load factor at most 50%.
 typedef struct IniSection {
 	int count;
 	int capacity;
-	IniKeyValueNode *head;
-#if IniSectionImplUseSentinelNode
-	IniKeyValueNode *sentinel;
-#endif
+	UINT mask;
 	IniKeyValueNode *nodeList;
+	IniKeyValueNode **hashTable;
 } IniSection;
 
 NP2_inline void IniSectionInit(IniSection *section, int capacity) {
+	UINT size = 16;
+	while (size < 2 * (UINT)capacity) {
+		size <<= 1;
+	}
 	section->count = 0;
 	section->capacity = capacity;
-	section->head = NULL;
-#if IniSectionImplUseSentinelNode
-	section->nodeList = (IniKeyValueNode *)NP2HeapAlloc((capacity + 1) * sizeof(IniKeyValueNode));
-	section->sentinel = &section->nodeList[capacity];
-#else
-	section->nodeList = (IniKeyValueNode *)NP2HeapAlloc(capacity * sizeof(IniKeyValueNode));
-#endif
+	section->mask = size - 1;
+	section->nodeList = (IniKeyValueNode *)NP2HeapAlloc(capacity * sizeof(IniKeyValueNode) + size * sizeof(IniKeyValueNode *));
+	section->hashTable = (IniKeyValueNode **)(section->nodeList + capacity);
 }
 
 NP2_inline void IniSectionFree(IniSection *section) {
@@ -501,7 +527,6 @@ NP2_inline void IniSectionFree(IniSection *section) {
 
 NP2_inline void IniSectionClear(IniSection *section) {
 	section->count = 0;
-	section->head = NULL;
 }
 
 NP2_inline BOOL IniSectionIsEmpty(const IniSection *section) {
@@ -644,12 +669,33 @@ typedef struct BackgroundWorker {
 	HANDLE workerThread;
 } BackgroundWorker;
 
+// process wide pool of worker threads shared by background jobs and parallel slices.
+enum {
+	WorkerPriority_High,	// user is waiting for the result
+	WorkerPriority_Normal,
+	WorkerPriority_Low,		// indexing, icons and other idle jobs
+	WorkerPriority_Count,
+};
+
+// returned handle is signaled after lpStartAddress returns, caller closes it.
+HANDLE WorkerPool_Submit(LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, int priority);
+BOOL WorkerPool_Post(LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, int priority);
+BOOL WorkerPool_RunIfQueued(HANDLE task);
+void WorkerPool_Wait(HANDLE task);
+
 void BackgroundWorker_Init(BackgroundWorker *worker, HWND hwnd);
+BOOL BackgroundWorker_Start(BackgroundWorker *worker, LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParam, int priority);
 void BackgroundWorker_Cancel(BackgroundWorker *worker);
 void BackgroundWorker_Destroy(BackgroundWorker *worker);
 #define BackgroundWorker_Continue(worker)	\
 	(WaitForSingleObject((worker)->eventCancel, 0) != WAIT_OBJECT_0)
 
+// modal wait on current thread: only paint messages are dispatched, keyboard and mouse input
+// is discarded to prevent reentrance. returns TRUE when Esc was pressed.
+BOOL DispatchPaintMessages(void);
+// onEscape (can be NULL) is called for each Esc press before hObject is signaled.
+void WaitForObjectDispatchPaint(HANDLE hObject, void (*onEscape)(LPVOID lpParam), LPVOID lpParam);
+
 HRESULT PrivateSetCurrentProcessExplicitAppUserModelID(PCWSTR AppID);
 BOOL IsElevated(void);
 
@@ -766,6 +812,14 @@ int Toolbar_SetButtons(HWND hwnd, LPCWSTR lpszButtons, LPCTBBUTTON ptbb, int ctb
 
 LRESULT SendWMSize(HWND hwnd);
 
+// timer may fire up to tolerance late, lets the system coalesce wake-ups. since Windows 8
+#if _WIN32_WINNT >= _WIN32_WINNT_WIN8
+#define SetCoalescableTimerEx(hwnd, nIDEvent, uElapse, lpTimerFunc, uToleranceDelay) \
+		SetCoalescableTimer((hwnd), (nIDEvent), (uElapse), (lpTimerFunc), (uToleranceDelay))
+#else
+UINT_PTR SetCoalescableTimerEx(HWND hwnd, UINT_PTR nIDEvent, UINT uElapse, TIMERPROC lpTimerFunc, ULONG uToleranceDelay);
+#endif
+
 #define EnableCmd(hmenu, id, b)	EnableMenuItem(hmenu, id, (b)? (MF_BYCOMMAND | MF_ENABLED) : (MF_BYCOMMAND | MF_GRAYED))
 #define CheckCmd(hmenu, id, b)	CheckMenuItem(hmenu, id, (b)? (MF_BYCOMMAND | MF_CHECKED) : (MF_BYCOMMAND | MF_UNCHECKED))
 
@@ -864,6 +918,7 @@ typedef struct MRULIST {
 	LPCWSTR szRegKey;
 	int		iFlags;
 	int		iSize;
+	UINT64	hash;	// IniSectionHash() of last loaded or saved section
 	LPWSTR pszItems[MRU_MAXITEMS];
 } MRULIST, *PMRULIST, *LPMRULIST;
 
@@ -882,7 +937,7 @@ NP2_inline int MRU_GetCount(LPCMRULIST pmru) {
 	return MRU_Enum(pmru, 0, NULL, 0);
 }
 BOOL	MRU_Load(LPMRULIST pmru);
-BOOL	MRU_Save(LPCMRULIST pmru);
+BOOL	MRU_Save(LPMRULIST pmru);
 BOOL	MRU_MergeSave(LPCMRULIST pmru, BOOL bAddFiles, BOOL bRelativePath, BOOL bUnexpandMyDocs);
 
 //==== Themed Dialogs =========================================================
@@ -0,0 +1,880 @@
+// Hex View
+
+#include <windows.h>
+#include <windowsx.h>
+#include <shlwapi.h>
+#include <commctrl.h>
+#include <inttypes.h>
+#include "SciCall.h"
+#include "Helpers.h"
+#include "Styles.h"
+#include "Decompressor.h"
+#include "HexView.h"
+
+// The hex view maps a window of the file read-only and formats the offset, hex and
+// ASCII columns of visible rows while painting, the file is never copied into a
+// Scintilla document. Modified bytes are kept in a sorted sparse overlay, which is
+// written back into the file in place on save.
+
+#define WC_NP2HEXVIEW			L"Notepad2HexView"
+#define HEXVIEW_BYTES_PER_ROW	16
+// size of mapped view or read buffer, multiple of allocation granularity.
+#define HEXVIEW_WINDOW_SIZE		(4*1024*1024)
+// keep scroll bar position inside int range for files with billions of rows.
+#define HEXVIEW_MAX_SCROLL_POS	0x3FFFFFFF
+#define HEXVIEW_MAX_ROW_LENGTH	128
+
+#define HEXVIEW_COLOR_MODIFIED	RGB(0xE0, 0x00, 0x00)
+
+typedef struct HexViewData {
+	HWND hwnd;
+	HFONT hFont;
+	int cxChar;
+	int cyChar;
+	int visibleRows;
+	int wheelDelta;
+
+	HANDLE hFile;
+	HANDLE hMapping;		// NULL when the file is read with ReadFile(), e.g. on network share
+	uint8_t *lpBuffer;		// read buffer when not mapped
+	uint64_t fileSize;
+	BOOL bWritable;			// file is opened with write access
+	BOOL bReadOnly;
+	int offsetDigits;
+	DWORD dwGranularity;
+
+	// window of the file currently mapped or read
+	const uint8_t *lpView;
+	uint64_t viewOffset;
+	DWORD cbView;
+
+	// sparse overlay of modified bytes, sorted by offset
+	uint64_t *patchOffset;
+	uint8_t *patchValue;
+	UINT patchCount;
+	UINT patchCapacity;
+
+	uint64_t caret;
+	uint64_t topRow;
+	uint64_t scrollScale;
+	BOOL bLowNibble;
+	BOOL bAsciiPane;
+} HexViewData;
+
+static HexViewData hexView;
+static const char HexDigits[] = "0123456789ABCDEF";
+
+static inline uint64_t HexView_RowCount(void) {
+	return (hexView.fileSize + HEXVIEW_BYTES_PER_ROW - 1) / HEXVIEW_BYTES_PER_ROW;
+}
+
+static inline int HexView_HexColumn(void) {
+	return hexView.offsetDigits + 2;
+}
+
+static inline int HexView_AsciiColumn(void) {
+	return hexView.offsetDigits + 2 + HEXVIEW_BYTES_PER_ROW*3 + 2;
+}
+
+static inline int HexView_HexCellColumn(UINT index) {
+	return HexView_HexColumn() + index*3 + (index >= HEXVIEW_BYTES_PER_ROW/2);
+}
+
+static void HexView_Notify(UINT code) {
+	HWND hwnd = hexView.hwnd;
+	NMHDR nmhdr;
+	nmhdr.hwndFrom = hwnd;
+	nmhdr.idFrom = GetDlgCtrlID(hwnd);
+	nmhdr.code = code;
+	SendMessage(GetParent(hwnd), WM_NOTIFY, nmhdr.idFrom, (LPARAM)&nmhdr);
+}
+
+// returns original bytes of [offset, offset + count), count is not larger than one row.
+static const uint8_t *HexView_GetView(uint64_t offset, UINT count) {
+	HexViewData * const hv = &hexView;
+	if (offset < hv->viewOffset || offset + count > hv->viewOffset + hv->cbView) {
+		const uint64_t base = offset & ~(uint64_t)(hv->dwGranularity - 1);
+		const uint64_t remain = hv->fileSize - base;
+		DWORD cbView = (remain < HEXVIEW_WINDOW_SIZE) ? (DWORD)remain : HEXVIEW_WINDOW_SIZE;
+		if (hv->hMapping != NULL) {
+			if (hv->lpView != NULL) {
+				UnmapViewOfFile(hv->lpView);
+			}
+			hv->lpView = (const uint8_t *)MapViewOfFile(hv->hMapping, FILE_MAP_READ, (DWORD)(base >> 32), (DWORD)base, cbView);
+		} else {
+			OVERLAPPED overlapped;
+			ZeroMemory(&overlapped, sizeof(overlapped));
+			overlapped.Offset = (DWORD)base;
+			overlapped.OffsetHigh = (DWORD)(base >> 32);
+			DWORD cbRead = 0;
+			if (!ReadFile(hv->hFile, hv->lpBuffer, cbView, &cbRead, &overlapped)) {
+				cbRead = 0;
+			}
+			cbView = cbRead;
+			hv->lpView = (cbRead != 0) ? hv->lpBuffer : NULL;
+		}
+		if (hv->lpView == NULL) {
+			hv->cbView = 0;
+			return NULL;
+		}
+		hv->viewOffset = base;
+		hv->cbView = cbView;
+		if (offset + count > base + cbView) {
+			return NULL; // file was truncated by other process
+		}
+	}
+	return hv->lpView + (offset - hv->viewOffset);
+}
+
+static UINT HexView_LowerBound(uint64_t offset) {
+	const uint64_t * const patchOffset = hexView.patchOffset;
+	UINT lower = 0;
+	UINT upper = hexView.patchCount;
+	while (lower < upper) {
+		const UINT middle = (lower + upper) / 2;
+		if (patchOffset[middle] < offset) {
+			lower = middle + 1;
+		} else {
+			upper = middle;
+		}
+	}
+	return lower;
+}
+
+// copy bytes with modified bytes applied.
+static BOOL HexView_ReadBytes(uint64_t offset, uint8_t *buffer, UINT count) {
+	const uint8_t *ptr = HexView_GetView(offset, count);
+	if (ptr == NULL) {
+		return FALSE;
+	}
+	memcpy(buffer, ptr, count);
+	const HexViewData * const hv = &hexView;
+	for (UINT index = HexView_LowerBound(offset); index < hv->patchCount && hv->patchOffset[index] < offset + count; index++) {
+		buffer[hv->patchOffset[index] - offset] = hv->patchValue[index];
+	}
+	return TRUE;
+}
+
+static void HexView_SetByte(uint64_t offset, uint8_t value) {
+	HexViewData * const hv = &hexView;
+	const uint8_t *original = HexView_GetView(offset, 1);
+	if (original == NULL) {
+		return;
+	}
+
+	const BOOL modified = hv->patchCount != 0;
+	const UINT index = HexView_LowerBound(offset);
+	const BOOL found = index < hv->patchCount && hv->patchOffset[index] == offset;
+	if (value == *original) {
+		// restoring original value removes the patch
+		if (found) {
+			const UINT count = hv->patchCount - index - 1;
+			memmove(hv->patchOffset + index, hv->patchOffset + index + 1, count*sizeof(uint64_t));
+			memmove(hv->patchValue + index, hv->patchValue + index + 1, count);
+			hv->patchCount--;
+		}
+	} else if (found) {
+		hv->patchValue[index] = value;
+	} else {
+		if (hv->patchCount == hv->patchCapacity) {
+			const UINT capacity = max_u(256, hv->patchCapacity*2);
+			uint64_t *patchOffset;
+			uint8_t *patchValue;
+			if (hv->patchOffset == NULL) {
+				patchOffset = (uint64_t *)NP2HeapAlloc(capacity*sizeof(uint64_t));
+				patchValue = (uint8_t *)NP2HeapAlloc(capacity);
+			} else {
+				patchOffset = (uint64_t *)NP2HeapReAlloc(hv->patchOffset, capacity*sizeof(uint64_t));
+				patchValue = (uint8_t *)NP2HeapReAlloc(hv->patchValue, capacity);
+			}
+			if (patchOffset != NULL) {
+				hv->patchOffset = patchOffset;
+			}
+			if (patchValue != NULL) {
+				hv->patchValue = patchValue;
+			}
+			if (patchOffset == NULL || patchValue == NULL) {
+				return;
+			}
+			hv->patchCapacity = capacity;
+		}
+
+		const UINT count = hv->patchCount - index;
+		memmove(hv->patchOffset + index + 1, hv->patchOffset + index, count*sizeof(uint64_t));
+		memmove(hv->patchValue + index + 1, hv->patchValue + index, count);
+		hv->patchOffset[index] = offset;
+		hv->patchValue[index] = value;
+		hv->patchCount++;
+	}
+
+	if (modified != (hv->patchCount != 0)) {
+		HexView_Notify(HVN_SAVEPOINT);
+	}
+}
+
+static void HexView_UpdateScrollBar(void) {
+	HexViewData * const hv = &hexView;
+	const uint64_t rows = HexView_RowCount();
+	hv->scrollScale = rows/HEXVIEW_MAX_SCROLL_POS + 1;
+
+	SCROLLINFO si;
+	si.cbSize = sizeof(SCROLLINFO);
+	si.fMask = SIF_ALL | SIF_DISABLENOSCROLL;
+	si.nMin = 0;
+	si.nMax = (int)((rows == 0) ? 0 : (rows - 1)/hv->scrollScale);
+	si.nPage = (UINT)max_i(1, (int)(hv->visibleRows/hv->scrollScale));
+	si.nPos = (int)(hv->topRow/hv->scrollScale);
+	si.nTrackPos = 0;
+	SetScrollInfo(hv->hwnd, SB_VERT, &si, TRUE);
+}
+
+static void HexView_ScrollTo(uint64_t row) {
+	HexViewData * const hv = &hexView;
+	const uint64_t rows = HexView_RowCount();
+	const uint64_t maxRow = (rows > (uint64_t)hv->visibleRows) ? rows - hv->visibleRows : 0;
+	if (row > maxRow) {
+		row = maxRow;
+	}
+	if (row != hv->topRow) {
+		hv->topRow = row;
+		HexView_UpdateScrollBar();
+		InvalidateRect(hv->hwnd, NULL, FALSE);
+	}
+}
+
+static void HexView_ScrollBy(int64_t rows) {
+	const uint64_t topRow = hexView.topRow;
+	if (rows < 0 && (uint64_t)(-rows) > topRow) {
+		HexView_ScrollTo(0);
+	} else {
+		HexView_ScrollTo(topRow + rows);
+	}
+}
+
+static void HexView_MoveCaret(uint64_t caret, BOOL bLowNibble) {
+	HexViewData * const hv = &hexView;
+	if (hv->fileSize == 0) {
+		return;
+	}
+	if (caret >= hv->fileSize) {
+		caret = hv->fileSize - 1;
+	}
+	hv->caret = caret;
+	hv->bLowNibble = bLowNibble;
+
+	const uint64_t row = caret/HEXVIEW_BYTES_PER_ROW;
+	if (row < hv->topRow) {
+		HexView_ScrollTo(row);
+	} else if (row >= hv->topRow + hv->visibleRows) {
+		HexView_ScrollTo(row - hv->visibleRows + 1);
+	}
+	InvalidateRect(hv->hwnd, NULL, FALSE);
+	HexView_Notify(HVN_CARETMOVED);
+}
+
+static void HexView_UpdateFont(void) {
+	HexViewData * const hv = &hexView;
+	if (hv->hFont != NULL) {
+		DeleteObject(hv->hFont);
+	}
+	hv->hFont = Style_CreateCodeFont(g_uCurrentDPI);
+
+	HDC hdc = GetDC(hv->hwnd);
+	HFONT hFontOld = SelectFont(hdc, hv->hFont);
+	TEXTMETRIC tm;
+	GetTextMetrics(hdc, &tm);
+	SIZE size;
+	GetTextExtentPoint32(hdc, L"0", 1, &size);
+	SelectFont(hdc, hFontOld);
+	ReleaseDC(hv->hwnd, hdc);
+
+	hv->cxChar = max_i(1, size.cx);
+	hv->cyChar = max_i(1, tm.tmHeight + tm.tmExternalLeading);
+}
+
+static int HexView_FormatRow(uint64_t offset, const uint8_t *bytes, UINT count, WCHAR *line) {
+	int len = 0;
+	for (int shift = (hexView.offsetDigits - 1)*4; shift >= 0; shift -= 4) {
+		line[len++] = HexDigits[(offset >> shift) & 15];
+	}
+	line[len++] = L' ';
+	line[len++] = L' ';
+	for (UINT index = 0; index < HEXVIEW_BYTES_PER_ROW; index++) {
+		if (index == HEXVIEW_BYTES_PER_ROW/2) {
+			line[len++] = L' ';
+		}
+		if (index < count) {
+			line[len++] = HexDigits[bytes[index] >> 4];
+			line[len++] = HexDigits[bytes[index] & 15];
+		} else {
+			line[len++] = L' ';
+			line[len++] = L' ';
+		}
+		line[len++] = L' ';
+	}
+	line[len++] = L' ';
+	for (UINT index = 0; index < count; index++) {
+		const uint8_t ch = bytes[index];
+		line[len++] = (ch >= 0x20 && ch < 0x7F) ? ch : L'.';
+	}
+	return len;
+}
+
+static void HexView_DrawCell(HDC hdc, int column, int y, const WCHAR *text, int len, const INT *dx) {
+	const int x = column*hexView.cxChar;
+	RECT rc = { x, y, x + len*hexView.cxChar, y + hexView.cyChar };
+	ExtTextOut(hdc, x, y, ETO_OPAQUE, &rc, text, len, dx);
+}
+
+static void HexView_Paint(HWND hwnd) {
+	HexViewData * const hv = &hexView;
+	PAINTSTRUCT ps;
+	HDC hdc = BeginPaint(hwnd, &ps);
+	RECT rcClient;
+	GetClientRect(hwnd, &rcClient);
+
+	HFONT hFontOld = SelectFont(hdc, hv->hFont);
+	const COLORREF foreColor = GetSysColor(COLOR_WINDOWTEXT);
+	const COLORREF backColor = GetSysColor(COLOR_WINDOW);
+	const BOOL bFocus = GetFocus() == hwnd;
+
+	// fixed cell width, keeps columns aligned with proportional code font
+	INT dx[HEXVIEW_MAX_ROW_LENGTH];
+	for (UINT index = 0; index < COUNTOF(dx); index++) {
+		dx[index] = hv->cxChar;
+	}
+
+	const int firstRow = ps.rcPaint.top/hv->cyChar;
+	const int lastRow = (ps.rcPaint.bottom + hv->cyChar - 1)/hv->cyChar;
+	for (int visibleRow = firstRow; visibleRow < lastRow; visibleRow++) {
+		const int y = visibleRow*hv->cyChar;
+		RECT rcLine = { rcClient.left, y, rcClient.right, y + hv->cyChar };
+		const uint64_t offset = (hv->topRow + visibleRow)*HEXVIEW_BYTES_PER_ROW;
+		uint8_t bytes[HEXVIEW_BYTES_PER_ROW];
+		UINT count = 0;
+		if (hv->hFile != NULL && offset < hv->fileSize) {
+			const uint64_t remain = hv->fileSize - offset;
+			count = (remain < HEXVIEW_BYTES_PER_ROW) ? (UINT)remain : HEXVIEW_BYTES_PER_ROW;
+			if (!HexView_ReadBytes(offset, bytes, count)) {
+				count = 0;
+			}
+		}
+
+		SetTextColor(hdc, foreColor);
+		SetBkColor(hdc, backColor);
+		if (count == 0) {
+			ExtTextOut(hdc, 0, y, ETO_OPAQUE, &rcLine, L"", 0, NULL);
+			continue;
+		}
+
+		WCHAR line[HEXVIEW_MAX_ROW_LENGTH];
+		const int len = HexView_FormatRow(offset, bytes, count, line);
+		ExtTextOut(hdc, 0, y, ETO_OPAQUE, &rcLine, line, len, dx);
+
+		// modified bytes
+		SetTextColor(hdc, HEXVIEW_COLOR_MODIFIED);
+		for (UINT index = HexView_LowerBound(offset); index < hv->patchCount && hv->patchOffset[index] < offset + count; index++) {
+			const UINT cell = (UINT)(hv->patchOffset[index] - offset);
+			HexView_DrawCell(hdc, HexView_HexCellColumn(cell), y, line + HexView_HexCellColumn(cell), 2, dx);
+			HexView_DrawCell(hdc, HexView_AsciiColumn() + cell, y, line + HexView_AsciiColumn() + cell, 1, dx);
+		}
+
+		// caret, the nibble or character being edited uses selection color
+		if (hv->caret >= offset && hv->caret < offset + count) {
+			const UINT cell = (UINT)(hv->caret - offset);
+			const COLORREF activeFore = GetSysColor(bFocus ? COLOR_HIGHLIGHTTEXT : COLOR_BTNTEXT);
+			const COLORREF activeBack = GetSysColor(bFocus ? COLOR_HIGHLIGHT : COLOR_BTNFACE);
+			int column = HexView_HexCellColumn(cell);
+			if (hv->bAsciiPane) {
+				SetTextColor(hdc, foreColor);
+				SetBkColor(hdc, GetSysColor(COLOR_BTNFACE));
+				HexView_DrawCell(hdc, column, y, line + column, 2, dx);
+				column = HexView_AsciiColumn() + cell;
+				SetTextColor(hdc, activeFore);
+				SetBkColor(hdc, activeBack);
+				HexView_DrawCell(hdc, column, y, line + column, 1, dx);
+			} else {
+				SetTextColor(hdc, activeFore);
+				SetBkColor(hdc, activeBack);
+				HexView_DrawCell(hdc, column + hv->bLowNibble, y, line + column + hv->bLowNibble, 1, dx);
+				SetTextColor(hdc, foreColor);
+				SetBkColor(hdc, GetSysColor(COLOR_BTNFACE));
+				HexView_DrawCell(hdc, column + !hv->bLowNibble, y, line + column + !hv->bLowNibble, 1, dx);
+				column = HexView_AsciiColumn() + cell;
+				HexView_DrawCell(hdc, column, y, line + column, 1, dx);
+			}
+		}
+	}
+
+	SelectFont(hdc, hFontOld);
+	EndPaint(hwnd, &ps);
+}
+
+static void HexView_OnLButtonDown(int x, int y) {
+	HexViewData * const hv = &hexView;
+	SetFocus(hv->hwnd);
+	if (hv->fileSize == 0) {
+		return;
+	}
+
+	const int column = x/hv->cxChar;
+	const uint64_t offset = (hv->topRow + y/hv->cyChar)*HEXVIEW_BYTES_PER_ROW;
+	const int asciiColumn = HexView_AsciiColumn();
+	if (column >= asciiColumn) {
+		hv->bAsciiPane = TRUE;
+		HexView_MoveCaret(offset + min_i(column - asciiColumn, HEXVIEW_BYTES_PER_ROW - 1), FALSE);
+	} else {
+		int cell = column - HexView_HexColumn();
+		if (cell >= (HEXVIEW_BYTES_PER_ROW/2)*3) {
+			--cell; // extra space in the middle
+		}
+		cell = clamp_i(cell, 0, HEXVIEW_BYTES_PER_ROW*3 - 1);
+		hv->bAsciiPane = FALSE;
+		HexView_MoveCaret(offset + cell/3, (cell % 3) == 1);
+	}
+}
+
+static BOOL HexView_OnKeyDown(UINT key) {
+	HexViewData * const hv = &hexView;
+	if (hv->fileSize == 0) {
+		return FALSE;
+	}
+
+	const BOOL bControl = GetKeyState(VK_CONTROL) < 0;
+	const uint64_t pageBytes = (uint64_t)hv->visibleRows*HEXVIEW_BYTES_PER_ROW;
+	uint64_t caret = hv->caret;
+	switch (key) {
+	case VK_LEFT:
+		if (!hv->bAsciiPane && hv->bLowNibble) {
+			HexView_MoveCaret(caret, FALSE);
+			return TRUE;
+		}
+		if (caret != 0) {
+			--caret;
+		}
+		break;
+
+	case VK_RIGHT:
+		++caret;
+		break;
+
+	case VK_UP:
+		if (bControl) {
+			HexView_ScrollBy(-1);
+			return TRUE;
+		}
+		if (caret >= HEXVIEW_BYTES_PER_ROW) {
+			caret -= HEXVIEW_BYTES_PER_ROW;
+		}
+		break;
+
+	case VK_DOWN:
+		if (bControl) {
+			HexView_ScrollBy(1);
+			return TRUE;
+		}
+		if (hv->fileSize - caret > HEXVIEW_BYTES_PER_ROW) {
+			caret += HEXVIEW_BYTES_PER_ROW;
+		}
+		break;
+
+	case VK_PRIOR:
+		caret = (caret > pageBytes) ? caret - pageBytes : caret % HEXVIEW_BYTES_PER_ROW;
+		HexView_ScrollBy(-hv->visibleRows);
+		break;
+
+	case VK_NEXT:
+		if (hv->fileSize - caret > pageBytes) {
+			caret += pageBytes;
+		} else {
+			caret = hv->fileSize - 1;
+		}
+		HexView_ScrollBy(hv->visibleRows);
+		break;
+
+	case VK_HOME:
+		caret = bControl ? 0 : caret & ~(uint64_t)(HEXVIEW_BYTES_PER_ROW - 1);
+		break;
+
+	case VK_END:
+		caret = bControl ? hv->fileSize - 1 : caret | (HEXVIEW_BYTES_PER_ROW - 1);
+		break;
+
+	case VK_TAB:
+		hv->bAsciiPane = !hv->bAsciiPane;
+		break;
+
+	default:
+		return FALSE;
+	}
+
+	HexView_MoveCaret(caret, FALSE);
+	return TRUE;
+}
+
+static void HexView_OnChar(UINT ch) {
+	HexViewData * const hv = &hexView;
+	if (hv->fileSize == 0 || ch < 0x20) {
+		return;
+	}
+	if (hv->bReadOnly) {
+		MessageBeep(MB_OK);
+		return;
+	}
+
+	const uint64_t caret = hv->caret;
+	if (hv->bAsciiPane) {
+		if (ch < 0x7F) {
+			HexView_SetByte(caret, (uint8_t)ch);
+			HexView_MoveCaret(caret + 1, FALSE);
+		}
+		return;
+	}
+
+	UINT digit;
+	if (ch >= '0' && ch <= '9') {
+		digit = ch - '0';
+	} else {
+		ch |= 0x20; // lower case
+		if (ch < 'a' || ch > 'f') {
+			return;
+		}
+		digit = ch - 'a' + 10;
+	}
+
+	uint8_t value;
+	if (HexView_ReadBytes(caret, &value, 1)) {
+		if (hv->bLowNibble) {
+			value = (uint8_t)((value & 0xF0) | digit);
+		} else {
+			value = (uint8_t)((digit << 4) | (value & 0x0F));
+		}
+		HexView_SetByte(caret, value);
+		if (hv->bLowNibble) {
+			HexView_MoveCaret(caret + 1, FALSE);
+		} else {
+			HexView_MoveCaret(caret, TRUE);
+		}
+	}
+}
+
+static void HexView_OnVScroll(UINT code) {
+	HexViewData * const hv = &hexView;
+	switch (code) {
+	case SB_LINEUP:
+		HexView_ScrollBy(-1);
+		break;
+
+	case SB_LINEDOWN:
+		HexView_ScrollBy(1);
+		break;
+
+	case SB_PAGEUP:
+		HexView_ScrollBy(-hv->visibleRows);
+		break;
+
+	case SB_PAGEDOWN:
+		HexView_ScrollBy(hv->visibleRows);
+		break;
+
+	case SB_TOP:
+		HexView_ScrollTo(0);
+		break;
+
+	case SB_BOTTOM:
+		HexView_ScrollTo(UINT64_MAX);
+		break;
+
+	case SB_THUMBTRACK:
+	case SB_THUMBPOSITION: {
+		SCROLLINFO si;
+		si.cbSize = sizeof(SCROLLINFO);
+		si.fMask = SIF_TRACKPOS;
+		if (GetScrollInfo(hv->hwnd, SB_VERT, &si)) {
+			HexView_ScrollTo((uint64_t)si.nTrackPos*hv->scrollScale);
+		}
+	} break;
+	}
+}
+
+static LRESULT CALLBACK HexView_WndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
+	HexViewData * const hv = &hexView;
+	switch (umsg) {
+	case WM_PAINT:
+		HexView_Paint(hwnd);
+		return 0;
+
+	case WM_ERASEBKGND:
+		return 1;
+
+	case WM_SIZE:
+		if (hv->cyChar == 0) {
+			return 0; // sent inside CreateWindowEx()
+		}
+		hv->visibleRows = max_i(1, HIWORD(lParam)/hv->cyChar);
+		HexView_UpdateScrollBar();
+		HexView_ScrollTo(hv->topRow);
+		return 0;
+
+	case WM_SETFOCUS:
+	case WM_KILLFOCUS:
+		InvalidateRect(hwnd, NULL, FALSE);
+		return 0;
+
+	case WM_GETDLGCODE:
+		return DLGC_WANTARROWS | DLGC_WANTCHARS | DLGC_WANTTAB;
+
+	case WM_KEYDOWN:
+		if (HexView_OnKeyDown((UINT)wParam)) {
+			return 0;
+		}
+		break;
+
+	case WM_CHAR:
+		HexView_OnChar((UINT)wParam);
+		return 0;
+
+	case WM_LBUTTONDOWN:
+		HexView_OnLButtonDown(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+		return 0;
+
+	case WM_VSCROLL:
+		HexView_OnVScroll(LOWORD(wParam));
+		return 0;
+
+	case WM_MOUSEWHEEL: {
+		UINT lines = 3;
+		SystemParametersInfo(SPI_GETWHEELSCROLLLINES, 0, &lines, 0);
+		hv->wheelDelta += GET_WHEEL_DELTA_WPARAM(wParam);
+		const int rows = hv->wheelDelta/WHEEL_DELTA;
+		if (rows != 0) {
+			hv->wheelDelta -= rows*WHEEL_DELTA;
+			if (lines == WHEEL_PAGESCROLL) {
+				HexView_ScrollBy(-(int64_t)rows*hv->visibleRows);
+			} else {
+				HexView_ScrollBy(-(int64_t)rows*lines);
+			}
+		}
+	} return 0;
+
+	case WM_DESTROY:
+		HexView_Close();
+		if (hv->hFont != NULL) {
+			DeleteObject(hv->hFont);
+			hv->hFont = NULL;
+		}
+		return 0;
+	}
+	return DefWindowProc(hwnd, umsg, wParam, lParam);
+}
+
+HWND HexView_Create(HWND hwndParent, HINSTANCE hInstance, UINT id) {
+	WNDCLASSEX wc;
+	ZeroMemory(&wc, sizeof(WNDCLASSEX));
+	wc.cbSize = sizeof(WNDCLASSEX);
+	wc.lpfnWndProc = HexView_WndProc;
+	wc.hInstance = hInstance;
+	wc.hCursor = LoadCursor(NULL, IDC_IBEAM);
+	wc.lpszClassName = WC_NP2HEXVIEW;
+	RegisterClassEx(&wc);
+
+	HWND hwnd = CreateWindowEx(0, WC_NP2HEXVIEW, NULL,
+						WS_CHILD | WS_CLIPSIBLINGS | WS_VSCROLL,
+						0, 0, 0, 0, hwndParent, (HMENU)(UINT_PTR)id, hInstance, NULL);
+	if (hwnd != NULL) {
+		hexView.hwnd = hwnd;
+		hexView.visibleRows = 1;
+		HexView_UpdateFont();
+	}
+	return hwnd;
+}
+
+BOOL HexView_Open(LPCWSTR lpszFile, BOOL bReadOnly) {
+	HexView_Close();
+
+	// deny writing from other processes, truncated file raises EXCEPTION_IN_PAGE_ERROR on access to the view.
+	BOOL bWritable = TRUE;
+	BOOL bShared = FALSE;
+	HANDLE hFile = CreateFile(lpszFile, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+							  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		bWritable = FALSE;
+		hFile = CreateFile(lpszFile, GENERIC_READ, FILE_SHARE_READ,
+						   NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	}
+	if (hFile == INVALID_HANDLE_VALUE) {
+		// opened for writing by other process, read it without mapping
+		bShared = TRUE;
+		hFile = CreateFile(lpszFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+						   NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	}
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize)) {
+		CloseHandle(hFile);
+		return FALSE;
+	}
+
+	HANDLE hMapping = NULL;
+	uint8_t *lpBuffer = NULL;
+	// access to view of a file on disconnected network share raises EXCEPTION_IN_PAGE_ERROR.
+	if (!bShared && fileSize.QuadPart != 0 && !PathIsNetworkPath(lpszFile)) {
+		hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (hMapping == NULL) {
+		lpBuffer = (uint8_t *)NP2HeapAlloc(HEXVIEW_WINDOW_SIZE);
+		if (lpBuffer == NULL) {
+			CloseHandle(hFile);
+			return FALSE;
+		}
+	}
+
+	HexViewData * const hv = &hexView;
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	hv->dwGranularity = info.dwAllocationGranularity;
+	hv->hFile = hFile;
+	hv->hMapping = hMapping;
+	hv->lpBuffer = lpBuffer;
+	hv->fileSize = fileSize.QuadPart;
+	hv->bWritable = bWritable && !bShared;
+	hv->bReadOnly = bReadOnly || !hv->bWritable;
+
+	int digits = 8;
+	while (digits < 16 && (hv->fileSize >> (digits*4)) != 0) {
+		++digits;
+	}
+	hv->offsetDigits = digits;
+
+	HexView_UpdateScrollBar();
+	InvalidateRect(hv->hwnd, NULL, FALSE);
+	return TRUE;
+}
+
+void HexView_Close(void) {
+	HexViewData * const hv = &hexView;
+	if (hv->hFile == NULL) {
+		return;
+	}
+	if (hv->hMapping != NULL) {
+		if (hv->lpView != NULL) {
+			UnmapViewOfFile(hv->lpView);
+		}
+		CloseHandle(hv->hMapping);
+	}
+	if (hv->lpBuffer != NULL) {
+		NP2HeapFree(hv->lpBuffer);
+	}
+	if (hv->patchOffset != NULL) {
+		NP2HeapFree(hv->patchOffset);
+		NP2HeapFree(hv->patchValue);
+	}
+	CloseHandle(hv->hFile);
+
+	HWND hwnd = hv->hwnd;
+	HFONT hFont = hv->hFont;
+	const int cxChar = hv->cxChar;
+	const int cyChar = hv->cyChar;
+	const int visibleRows = hv->visibleRows;
+	ZeroMemory(hv, sizeof(HexViewData));
+	hv->hwnd = hwnd;
+	hv->hFont = hFont;
+	hv->cxChar = cxChar;
+	hv->cyChar = cyChar;
+	hv->visibleRows = visibleRows;
+}
+
+BOOL HexView_IsActive(void) {
+	return hexView.hFile != NULL;
+}
+
+BOOL HexView_IsModified(void) {
+	return hexView.patchCount != 0;
+}
+
+BOOL HexView_Save(void) {
+	HexViewData * const hv = &hexView;
+	if (hv->patchCount == 0) {
+		return TRUE;
+	}
+	if (!hv->bWritable) {
+		SetLastError(ERROR_ACCESS_DENIED);
+		return FALSE;
+	}
+
+	// write runs of adjacent modified bytes, the mapped view sees the change.
+	uint8_t buffer[4096];
+	UINT index = 0;
+	while (index < hv->patchCount) {
+		const uint64_t offset = hv->patchOffset[index];
+		DWORD length = 0;
+		do {
+			buffer[length++] = hv->patchValue[index++];
+		} while (index < hv->patchCount && length < sizeof(buffer) && hv->patchOffset[index] == offset + length);
+
+		OVERLAPPED overlapped;
+		ZeroMemory(&overlapped, sizeof(overlapped));
+		overlapped.Offset = (DWORD)offset;
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		DWORD cbWritten = 0;
+		if (!WriteFile(hv->hFile, buffer, length, &cbWritten, &overlapped) || cbWritten != length) {
+			return FALSE;
+		}
+	}
+
+	hv->patchCount = 0;
+	if (hv->hMapping == NULL) {
+		hv->cbView = 0; // discard read buffer
+	}
+	InvalidateRect(hv->hwnd, NULL, FALSE);
+	HexView_Notify(HVN_SAVEPOINT);
+	return TRUE;
+}
+
+void HexView_SetReadOnly(BOOL bReadOnly) {
+	hexView.bReadOnly = bReadOnly || !hexView.bWritable;
+}
+
+void HexView_GetStatus(HexViewStatus *status) {
+	const HexViewData * const hv = &hexView;
+	status->caret = hv->caret;
+	status->fileSize = hv->fileSize;
+	status->patchCount = hv->patchCount;
+	uint8_t value;
+	status->value = (hv->caret < hv->fileSize && HexView_ReadBytes(hv->caret, &value, 1)) ? value : -1;
+}
+
+void HexView_OnDPIChanged(void) {
+	HexViewData * const hv = &hexView;
+	HexView_UpdateFont();
+	RECT rc;
+	GetClientRect(hv->hwnd, &rc);
+	hv->visibleRows = max_i(1, rc.bottom/hv->cyChar);
+	HexView_UpdateScrollBar();
+	InvalidateRect(hv->hwnd, NULL, FALSE);
+}
+
+BOOL HexView_MaybeBinaryFile(LPCWSTR lpszFile) {
+	HANDLE hFile = CreateFile(lpszFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+
+	BOOL binary = FALSE;
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart >= NP2_HEXVIEW_MIN_BINARY_SIZE) {
+		uint8_t header[1024];
+		DWORD cbRead = 0;
+		if (ReadFile(hFile, header, sizeof(header), &cbRead, NULL) && cbRead > 1) {
+			// compressed text file is decompressed into text view
+			binary = Decompressor_DetectFormat(header, cbRead) == CompressionFormat_None
+				&& Style_MaybeBinaryHeader(header, cbRead - 1);
+		}
+	}
+	CloseHandle(hFile);
+	return binary;
+}
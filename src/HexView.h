@@ -0,0 +1,27 @@
+// Hex View
+#pragma once
+
+// notification codes sent with WM_NOTIFY from the hex view window
+#define HVN_CARETMOVED		1	// caret moved or the view scrolled
+#define HVN_SAVEPOINT		2	// modified state of the patch overlay changed
+
+// files smaller than this are loaded as text even when they look binary
+#define NP2_HEXVIEW_MIN_BINARY_SIZE	(64*1024*1024)
+
+typedef struct HexViewStatus {
+	uint64_t caret;
+	uint64_t fileSize;
+	UINT patchCount;
+	int value; // byte under caret, -1 at end of file
+} HexViewStatus;
+
+HWND HexView_Create(HWND hwndParent, HINSTANCE hInstance, UINT id);
+BOOL HexView_Open(LPCWSTR lpszFile, BOOL bReadOnly);
+void HexView_Close(void);
+BOOL HexView_IsActive(void);
+BOOL HexView_IsModified(void);
+BOOL HexView_Save(void);
+void HexView_SetReadOnly(BOOL bReadOnly);
+void HexView_GetStatus(HexViewStatus *status);
+void HexView_OnDPIChanged(void);
+BOOL HexView_MaybeBinaryFile(LPCWSTR lpszFile);
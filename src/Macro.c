@@ -0,0 +1,215 @@
+// Keyboard Macro
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SciCall.h"
+#include "Helpers.h"
+#include "Notepad2.h"
+#include "Edit.h"
+#include "Dialogs.h"
+#include "Macro.h"
+#include "resource.h"
+
+// Actions are recorded from SCN_MACRORECORD, each is one Scintilla message,
+// typed text is recorded as SCI_REPLACESEL. Replay with timing sends one action
+// every NP2_MACRO_REPLAY_INTERVAL milliseconds through the edit window's message
+// procedure and then paints synchronously, the latency of an action covers
+// handling the message, notifications to Notepad2, layout and painting.
+
+extern HWND hwndMain;
+extern HWND hwndEdit;
+
+typedef struct MacroAction {
+	UINT message;
+	WPARAM wParam;
+	LPARAM lParam;
+	char *text;			// copy of string parameter, NULL for other messages
+} MacroAction;
+
+typedef struct MacroData {
+	MacroAction *actions;
+	UINT count;
+	UINT capacity;
+	BOOL bRecording;
+	// replay with timing
+	UINT replayIndex;
+	double *latency;	// milliseconds of each replayed action
+	LARGE_INTEGER freq;
+} MacroData;
+
+static MacroData macro;
+
+static void Macro_Clear(void) {
+	for (UINT i = 0; i < macro.count; i++) {
+		if (macro.actions[i].text != NULL) {
+			NP2HeapFree(macro.actions[i].text);
+		}
+	}
+	macro.count = 0;
+}
+
+static inline LPARAM Macro_ActionParam(const MacroAction *action) {
+	return (action->text != NULL) ? (LPARAM)action->text : action->lParam;
+}
+
+void Macro_StartRecord(void) {
+	if (macro.bRecording || Macro_IsReplaying()) {
+		return;
+	}
+	Macro_Clear();
+	macro.bRecording = TRUE;
+	SciCall_StartRecord();
+}
+
+void Macro_StopRecord(void) {
+	if (macro.bRecording) {
+		macro.bRecording = FALSE;
+		SciCall_StopRecord();
+	}
+}
+
+BOOL Macro_IsRecording(void) {
+	return macro.bRecording;
+}
+
+BOOL Macro_IsReplaying(void) {
+	return macro.latency != NULL;
+}
+
+BOOL Macro_CanPlay(void) {
+	return macro.count != 0 && !macro.bRecording && macro.latency == NULL;
+}
+
+void Macro_OnRecord(UINT message, WPARAM wParam, LPARAM lParam) {
+	if (!macro.bRecording) {
+		return;
+	}
+
+	char *text = NULL;
+	switch (message) {
+	case SCI_ADDTEXT:
+	case SCI_APPENDTEXT:
+		// text of wParam bytes, not terminated
+		text = (char *)NP2HeapAlloc(wParam + 1);
+		if (text == NULL) {
+			return;
+		}
+		memcpy(text, (const char *)lParam, wParam);
+		break;
+
+	case SCI_REPLACESEL:
+	case SCI_INSERTTEXT:
+	case SCI_SEARCHNEXT:
+	case SCI_SEARCHPREV: {
+		const size_t len = strlen((const char *)lParam);
+		text = (char *)NP2HeapAlloc(len + 1);
+		if (text == NULL) {
+			return;
+		}
+		memcpy(text, (const char *)lParam, len);
+	} break;
+	}
+
+	if (macro.count == macro.capacity) {
+		const UINT capacity = max_u(macro.capacity*2, 256);
+		MacroAction *actions = (MacroAction *)((macro.actions == NULL) ? NP2HeapAlloc(capacity * sizeof(MacroAction))
+			: NP2HeapReAlloc(macro.actions, capacity * sizeof(MacroAction)));
+		if (actions == NULL) {
+			if (text != NULL) {
+				NP2HeapFree(text);
+			}
+			return;
+		}
+		macro.actions = actions;
+		macro.capacity = capacity;
+	}
+
+	MacroAction *action = macro.actions + macro.count;
+	action->message = message;
+	action->wParam = wParam;
+	action->lParam = (text != NULL) ? 0 : lParam;
+	action->text = text;
+	++macro.count;
+}
+
+void Macro_Play(void) {
+	if (!Macro_CanPlay()) {
+		return;
+	}
+
+	SciCall_BeginUndoAction();
+	for (UINT i = 0; i < macro.count; i++) {
+		const MacroAction *action = macro.actions + i;
+		SciCall(action->message, action->wParam, Macro_ActionParam(action));
+	}
+	SciCall_EndUndoAction();
+}
+
+static int __cdecl CmpDouble(const void *p1, const void *p2) {
+	const double d1 = *(const double *)p1;
+	const double d2 = *(const double *)p2;
+	return (d1 < d2) ? -1 : (d1 > d2);
+}
+
+static void Macro_ShowReplayTiming(void) {
+	const UINT count = macro.count;
+	double *latency = macro.latency;
+	qsort(latency, count, sizeof(double), CmpDouble);
+
+	WCHAR tchCount[32];
+	WCHAR tchTime[4][32];
+	const double percentile[4] = {
+		latency[(count - 1)/2],
+		latency[(count - 1)*90/100],
+		latency[(count - 1)*99/100],
+		latency[count - 1],
+	};
+	wsprintf(tchCount, L"%u", count);
+	FormatNumberStr(tchCount);
+	for (int i = 0; i < 4; i++) {
+		swprintf(tchTime[i], COUNTOF(tchTime[i]), L"%.3f", percentile[i]);
+	}
+
+	macro.latency = NULL;
+	NP2HeapFree(latency);
+	MsgBoxInfo(MB_OK, IDS_MACRO_REPLAY_TIMING, tchCount, NP2_MACRO_REPLAY_INTERVAL,
+		tchTime[0], tchTime[1], tchTime[2], tchTime[3]);
+}
+
+static void CALLBACK Macro_ReplayTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
+	UNREFERENCED_PARAMETER(uMsg);
+	UNREFERENCED_PARAMETER(dwTime);
+
+	const UINT index = macro.replayIndex;
+	const MacroAction *action = macro.actions + index;
+	LARGE_INTEGER begin;
+	LARGE_INTEGER end;
+	QueryPerformanceCounter(&begin);
+	SendMessage(hwndEdit, action->message, action->wParam, Macro_ActionParam(action));
+	// paint now instead of waiting for the message queue to become empty
+	RedrawWindow(hwndMain, NULL, NULL, RDW_UPDATENOW | RDW_ALLCHILDREN);
+	QueryPerformanceCounter(&end);
+	macro.latency[index] = ((end.QuadPart - begin.QuadPart) * 1000) / (double)(macro.freq.QuadPart);
+
+	macro.replayIndex = index + 1;
+	if (macro.replayIndex == macro.count) {
+		KillTimer(hwnd, idEvent);
+		Macro_ShowReplayTiming();
+	}
+}
+
+void Macro_ReplayTimed(HWND hwnd) {
+	if (!Macro_CanPlay()) {
+		return;
+	}
+
+	macro.latency = (double *)NP2HeapAlloc(macro.count * sizeof(double));
+	if (macro.latency == NULL) {
+		return;
+	}
+	QueryPerformanceFrequency(&macro.freq);
+	macro.replayIndex = 0;
+	SetTimer(hwnd, ID_MACROREPLAYTIMER, NP2_MACRO_REPLAY_INTERVAL, Macro_ReplayTimerProc);
+}
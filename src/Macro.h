@@ -0,0 +1,14 @@
+// Keyboard Macro
+#pragma once
+
+// interval in milliseconds between actions replayed with timing
+#define NP2_MACRO_REPLAY_INTERVAL	30
+
+void Macro_StartRecord(void);
+void Macro_StopRecord(void);
+BOOL Macro_IsRecording(void);
+BOOL Macro_IsReplaying(void);
+BOOL Macro_CanPlay(void);
+void Macro_OnRecord(UINT message, WPARAM wParam, LPARAM lParam);
+void Macro_Play(void);
+void Macro_ReplayTimed(HWND hwnd);
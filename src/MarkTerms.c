@@ -0,0 +1,544 @@
+// Mark Terms
+
+#include <windows.h>
+#include <commdlg.h>
+#include <limits.h>
+#include <stdint.h>
+#include "SciCall.h"
+#include "TraceEvents.h"
+#include "Helpers.h"
+#include "Notepad2.h"
+#include "Edit.h"
+#include "Dialogs.h"
+#include "MarkTerms.h"
+#include "resource.h"
+
+// Terms are compiled into an Aho-Corasick automaton: a trie of the terms where every state has
+// a transition for each byte class, missing ones are taken from the longest proper suffix that is
+// also in the trie, so the document is scanned once with one table lookup per byte regardless of
+// count of terms. Bytes not used by any term share class 0, when case is ignored upper case ASCII
+// letters share class with their lower case. Each term remembers end of its last match and its
+// matches don't overlap, same as marking each term separately.
+
+extern DWORD dwLastIOError;
+
+#define MARKTERMS_COLOR_COUNT			10
+#define MARKTERMS_RANGE_CACHE_COUNT		1024
+#define MARKTERMS_MAX_FILE_SIZE			(16*1024*1024)
+// keep state table below 2 GiB
+#define MARKTERMS_MAX_TABLE_SIZE		(INT_MAX/sizeof(UINT))
+// terms listed in the result message
+#define MARKTERMS_RESULT_LENGTH			640
+#define MARKTERMS_RESULT_TERM_LENGTH	40
+#define MarkTermsAlpha					100
+#define MarkTermsOutlineAlpha			160
+
+static const COLORREF markTermsColors[MARKTERMS_COLOR_COUNT] = {
+	RGB(0xFF, 0xD7, 0x00),
+	RGB(0x00, 0xC8, 0xFF),
+	RGB(0x7F, 0xFF, 0x00),
+	RGB(0xFF, 0x69, 0xB4),
+	RGB(0xFF, 0x8C, 0x00),
+	RGB(0x93, 0x70, 0xDB),
+	RGB(0x00, 0xFA, 0x9A),
+	RGB(0x1E, 0x90, 0xFF),
+	RGB(0xFF, 0x45, 0x00),
+	RGB(0xBD, 0xB7, 0x6B),
+};
+
+typedef struct MarkTerm {
+	const char *text;
+	UINT length;
+	Sci_Position count;
+	Sci_Position lastEnd;	// end of last match
+} MarkTerm;
+
+typedef struct TermAutomaton {
+	uint8_t classes[256];	// byte to class
+	UINT classCount;
+	UINT stateCount;
+	UINT stateCapacity;
+	UINT *next;				// next[state*classCount + class], state 0 is the root
+	UINT *ends;				// 1 + index of term ends at the state, 0 for none
+	UINT *outputs;			// nearest state on suffix chain where a term ends, 0 for none
+} TermAutomaton;
+
+// matches of terms with same color are filled together
+typedef struct MarkTermsRanges {
+	UINT index[MARKTERMS_COLOR_COUNT];
+	Sci_Position ranges[MARKTERMS_COLOR_COUNT][MARKTERMS_RANGE_CACHE_COUNT*2];
+} MarkTermsRanges;
+
+static BOOL bMarkTermsActive;
+static BOOL bMarkTermsMatchCase;
+static BOOL bMarkTermsWholeWord;
+static LPWSTR lpMarkTermsList;
+
+static void TermAutomaton_Free(TermAutomaton *ac) {
+	if (ac->next != NULL) {
+		NP2HeapFree(ac->next);
+	}
+	if (ac->ends != NULL) {
+		NP2HeapFree(ac->ends);
+	}
+	if (ac->outputs != NULL) {
+		NP2HeapFree(ac->outputs);
+	}
+}
+
+static void *TermAutomaton_Realloc(void *block, size_t size) {
+	return (block == NULL) ? NP2HeapAlloc(size) : NP2HeapReAlloc(block, size);
+}
+
+static BOOL TermAutomaton_Grow(TermAutomaton *ac) {
+	const UINT capacity = max_u(256, ac->stateCapacity*2);
+	if (capacity <= ac->stateCapacity || (uint64_t)capacity*ac->classCount > MARKTERMS_MAX_TABLE_SIZE) {
+		return FALSE;
+	}
+	// new memory is zeroed
+	UINT *next = (UINT *)TermAutomaton_Realloc(ac->next, (size_t)capacity*ac->classCount*sizeof(UINT));
+	if (next == NULL) {
+		return FALSE;
+	}
+	ac->next = next;
+	UINT *ends = (UINT *)TermAutomaton_Realloc(ac->ends, capacity*sizeof(UINT));
+	if (ends == NULL) {
+		return FALSE;
+	}
+	ac->ends = ends;
+	UINT *outputs = (UINT *)TermAutomaton_Realloc(ac->outputs, capacity*sizeof(UINT));
+	if (outputs == NULL) {
+		return FALSE;
+	}
+	ac->outputs = outputs;
+	ac->stateCapacity = capacity;
+	return TRUE;
+}
+
+static BOOL TermAutomaton_Build(TermAutomaton *ac, const MarkTerm *terms, UINT termCount, BOOL matchCase) {
+	uint8_t used[256];
+	ZeroMemory(used, sizeof(used));
+	for (UINT i = 0; i < termCount; i++) {
+		const uint8_t *text = (const uint8_t *)terms[i].text;
+		for (UINT j = 0; j < terms[i].length; j++) {
+			const uint8_t ch = text[j];
+			used[(!matchCase && ch >= 'A' && ch <= 'Z') ? (ch - 'A' + 'a') : ch] = TRUE;
+		}
+	}
+	UINT classCount = 1;
+	for (UINT ch = 0; ch < 256; ch++) {
+		ac->classes[ch] = used[ch] ? (uint8_t)classCount++ : 0;
+	}
+	if (!matchCase) {
+		for (UINT ch = 'A'; ch <= 'Z'; ch++) {
+			ac->classes[ch] = ac->classes[ch - 'A' + 'a'];
+		}
+	}
+	ac->classCount = classCount;
+	ac->stateCount = 1;
+	if (!TermAutomaton_Grow(ac)) {
+		return FALSE;
+	}
+
+	// trie
+	for (UINT i = 0; i < termCount; i++) {
+		const uint8_t *text = (const uint8_t *)terms[i].text;
+		UINT state = 0;
+		for (UINT j = 0; j < terms[i].length; j++) {
+			const size_t slot = (size_t)state*classCount + ac->classes[text[j]];
+			if (ac->next[slot] == 0) {
+				if (ac->stateCount == ac->stateCapacity && !TermAutomaton_Grow(ac)) {
+					return FALSE;
+				}
+				ac->next[slot] = ac->stateCount++;
+			}
+			state = ac->next[slot];
+		}
+		// duplicate term is only matched as the first one
+		if (ac->ends[state] == 0) {
+			ac->ends[state] = i + 1;
+		}
+	}
+
+	// breadth first, fail state of a state is always processed before the state
+	const UINT stateCount = ac->stateCount;
+	UINT *fail = (UINT *)NP2HeapAlloc(stateCount*sizeof(UINT));
+	UINT *queue = (UINT *)NP2HeapAlloc(stateCount*sizeof(UINT));
+	if (fail == NULL || queue == NULL) {
+		if (fail != NULL) {
+			NP2HeapFree(fail);
+		}
+		if (queue != NULL) {
+			NP2HeapFree(queue);
+		}
+		return FALSE;
+	}
+	UINT head = 0;
+	UINT tail = 0;
+	for (UINT cls = 1; cls < classCount; cls++) {
+		const UINT state = ac->next[cls];
+		if (state != 0) {
+			queue[tail++] = state;
+		}
+	}
+	while (head < tail) {
+		const UINT state = queue[head++];
+		UINT * const row = ac->next + (size_t)state*classCount;
+		const UINT * const failRow = ac->next + (size_t)fail[state]*classCount;
+		for (UINT cls = 1; cls < classCount; cls++) {
+			const UINT child = row[cls];
+			if (child != 0) {
+				const UINT suffix = failRow[cls];
+				fail[child] = suffix;
+				ac->outputs[child] = ac->ends[suffix] ? suffix : ac->outputs[suffix];
+				queue[tail++] = child;
+			} else {
+				row[cls] = failRow[cls];
+			}
+		}
+	}
+	NP2HeapFree(fail);
+	NP2HeapFree(queue);
+	return TRUE;
+}
+
+static inline BOOL IsTermWordChar(uint8_t ch) {
+	return ch >= 0x80 || IsDocWordChar(ch);
+}
+
+static BOOL MarkTerms_IsWholeWord(const char *text, Sci_Position length, Sci_Position start, Sci_Position end) {
+	if (start != 0 && IsTermWordChar(text[start - 1]) && IsTermWordChar(text[start])) {
+		return FALSE;
+	}
+	if (end != length && IsTermWordChar(text[end - 1]) && IsTermWordChar(text[end])) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void MarkTerms_FillRanges(MarkTermsRanges *cache, UINT color) {
+	SciCall_SetIndicatorValue(SC_INDICVALUEBIT | markTermsColors[color]);
+	SciCall_IndicatorFillRanges(cache->index[color]/2, cache->ranges[color]);
+	cache->index[color] = 0;
+}
+
+static void MarkTerms_AddRange(MarkTermsRanges *cache, UINT color, Sci_Position start, Sci_Position end) {
+	Sci_Position * const ranges = cache->ranges[color];
+	UINT index = cache->index[color];
+	// matches are found in order of end position, so a longer match may cover previous ones,
+	// keep ranges sorted and not overlapped for the fast path of filling.
+	while (index != 0 && start <= ranges[index - 2]) {
+		index -= 2;
+	}
+	if (index != 0 && start <= ranges[index - 2] + ranges[index - 1]) {
+		ranges[index - 1] = end - ranges[index - 2];
+		cache->index[color] = index;
+	} else {
+		ranges[index] = start;
+		ranges[index + 1] = end - start;
+		cache->index[color] = index + 2;
+		if (index + 2 == COUNTOF(cache->ranges[color])) {
+			MarkTerms_FillRanges(cache, color);
+		}
+	}
+}
+
+static void MarkTerms_Scan(const TermAutomaton *ac, MarkTerm *terms, const char *text, Sci_Position length, BOOL wholeWord, MarkTermsRanges *cache) {
+	// byte matching may start inside DBCS character.
+	const UINT cpEdit = SciCall_GetCodePage();
+	const BOOL dbcs = !(cpEdit == SC_CP_UTF8 || cpEdit == CP_ACP);
+	const UINT * const next = ac->next;
+	const UINT classCount = ac->classCount;
+	UINT state = 0;
+	for (Sci_Position pos = 0; pos < length; pos++) {
+		state = next[(size_t)state*classCount + ac->classes[(uint8_t)text[pos]]];
+		UINT match = ac->ends[state] ? state : ac->outputs[state];
+		while (match != 0) {
+			const UINT index = ac->ends[match] - 1;
+			MarkTerm *term = &terms[index];
+			const Sci_Position end = pos + 1;
+			const Sci_Position start = end - term->length;
+			if (start >= term->lastEnd
+				&& (!wholeWord || MarkTerms_IsWholeWord(text, length, start, end))
+				&& (!dbcs || start == 0 || SciCall_PositionAfter(SciCall_PositionBefore(start)) == start)) {
+				term->lastEnd = end;
+				++term->count;
+				MarkTerms_AddRange(cache, index % MARKTERMS_COLOR_COUNT, start, end);
+			}
+			match = ac->outputs[match];
+		}
+	}
+}
+
+static void MarkTerms_SetStyles(void) {
+	SciCall_IndicSetStyle(IndicatorNumber_MarkTerms, INDIC_ROUNDBOX);
+	SciCall_IndicSetFlags(IndicatorNumber_MarkTerms, SC_INDICFLAG_VALUEFORE);
+	SciCall_IndicSetAlpha(IndicatorNumber_MarkTerms, MarkTermsAlpha);
+	SciCall_IndicSetOutlineAlpha(IndicatorNumber_MarkTerms, MarkTermsOutlineAlpha);
+}
+
+static void MarkTerms_ShowResult(const MarkTerm *terms, UINT termCount) {
+	const UINT cpEdit = SciCall_GetCodePage();
+	Sci_Position total = 0;
+	WCHAR tchList[MARKTERMS_RESULT_LENGTH + 2*MARKTERMS_RESULT_TERM_LENGTH + 64];
+	tchList[0] = L'\0';
+	int length = 0;
+	for (UINT i = 0; i < termCount; i++) {
+		const MarkTerm *term = &terms[i];
+		total += term->count;
+		if (length >= MARKTERMS_RESULT_LENGTH) {
+			if (i + 1 == termCount) {
+				lstrcpy(tchList + length, L"...");
+			}
+			continue;
+		}
+
+		WCHAR tchTerm[2*MARKTERMS_RESULT_TERM_LENGTH + 4];
+		int cchTerm = MultiByteToWideChar(cpEdit, 0, term->text, min_u(term->length, 2*MARKTERMS_RESULT_TERM_LENGTH), tchTerm, COUNTOF(tchTerm) - 1);
+		if (cchTerm > MARKTERMS_RESULT_TERM_LENGTH || term->length > 2*MARKTERMS_RESULT_TERM_LENGTH) {
+			cchTerm = min_i(cchTerm, MARKTERMS_RESULT_TERM_LENGTH);
+			tchTerm[cchTerm++] = L'\x2026';
+		}
+		tchTerm[cchTerm] = L'\0';
+		WCHAR tchCount[32];
+		PosToStrW(term->count, tchCount);
+		FormatNumberStr(tchCount);
+		length += wsprintf(tchList + length, L"\n%s: %s", tchTerm, tchCount);
+	}
+
+	WCHAR tchTotal[32];
+	WCHAR tchTerms[32];
+	PosToStrW(total, tchTotal);
+	PosToStrW(termCount, tchTerms);
+	FormatNumberStr(tchTotal);
+	FormatNumberStr(tchTerms);
+	MsgBoxInfo(MB_OK, IDS_MARKTERMS_RESULT, tchTotal, tchTerms, tchList);
+}
+
+BOOL MarkTerms_Apply(LPCWSTR lpszTerms, BOOL matchCase, BOOL wholeWord) {
+	MarkTerms_Clear();
+	const UINT cpEdit = SciCall_GetCodePage();
+	const int cchTerms = lstrlen(lpszTerms);
+	const int cbTerms = WideCharToMultiByte(cpEdit, 0, lpszTerms, cchTerms, NULL, 0, NULL, NULL);
+	char *lpTerms = (char *)NP2HeapAlloc(cbTerms + 1);
+	if (lpTerms == NULL) {
+		return FALSE;
+	}
+	WideCharToMultiByte(cpEdit, 0, lpszTerms, cchTerms, lpTerms, cbTerms, NULL, NULL);
+
+	// one term per line, empty lines are ignored
+	UINT maxCount = 1;
+	for (int i = 0; i < cbTerms; i++) {
+		maxCount += lpTerms[i] == '\n' || lpTerms[i] == '\r';
+	}
+	MarkTerm *terms = (MarkTerm *)NP2HeapAlloc(maxCount*sizeof(MarkTerm));
+	if (terms == NULL) {
+		NP2HeapFree(lpTerms);
+		return FALSE;
+	}
+	UINT termCount = 0;
+	for (char *p = lpTerms; *p;) {
+		char *end = p;
+		while (*end && *end != '\r' && *end != '\n') {
+			++end;
+		}
+		if (end != p) {
+			terms[termCount].text = p;
+			terms[termCount].length = (UINT)(end - p);
+			++termCount;
+		}
+		while (*end == '\r' || *end == '\n') {
+			*end++ = '\0';
+		}
+		p = end;
+	}
+
+	TermAutomaton ac;
+	ZeroMemory(&ac, sizeof(ac));
+	MarkTermsRanges *cache = NULL;
+	BOOL success = TRUE;
+	if (termCount != 0) {
+		BeginWaitCursor();
+		cache = (MarkTermsRanges *)NP2HeapAlloc(sizeof(MarkTermsRanges));
+		success = cache != NULL && TermAutomaton_Build(&ac, terms, termCount, matchCase);
+		if (success) {
+			const Sci_Position length = SciCall_GetLength();
+			NP2_TRACE_START("MarkTerms", NP2_TRACE_INT64(termCount, "terms"), NP2_TRACE_INT64(ac.stateCount, "states"));
+			// document is not modified while scanning.
+			const char *text = SciCall_GetRangePointer(0, length);
+			MarkTerms_SetStyles();
+			SciCall_SetIndicatorCurrent(IndicatorNumber_MarkTerms);
+			MarkTerms_Scan(&ac, terms, text, length, wholeWord, cache);
+			for (UINT color = 0; color < MARKTERMS_COLOR_COUNT; color++) {
+				if (cache->index[color] != 0) {
+					MarkTerms_FillRanges(cache, color);
+				}
+			}
+			SciCall_SetIndicatorValue(1);
+			bMarkTermsActive = TRUE;
+			NP2_TRACE_STOP("MarkTerms", NP2_TRACE_INT64(length, "bytes"));
+		}
+		EndWaitCursor();
+	}
+	if (success && termCount != 0) {
+		MarkTerms_ShowResult(terms, termCount);
+	}
+
+	TermAutomaton_Free(&ac);
+	if (cache != NULL) {
+		NP2HeapFree(cache);
+	}
+	NP2HeapFree(terms);
+	NP2HeapFree(lpTerms);
+	return success;
+}
+
+void MarkTerms_Clear(void) {
+	if (bMarkTermsActive) {
+		bMarkTermsActive = FALSE;
+		SciCall_SetIndicatorCurrent(IndicatorNumber_MarkTerms);
+		SciCall_IndicatorClearRange(0, SciCall_GetLength());
+	}
+}
+
+BOOL MarkTerms_IsActive(void) {
+	return bMarkTermsActive;
+}
+
+void MarkTerms_OnStyleChanged(void) {
+	if (bMarkTermsActive) {
+		MarkTerms_SetStyles();
+	}
+}
+
+// load term list from a UTF-16, UTF-8 or ANSI text file.
+static BOOL MarkTerms_LoadFile(HWND hwnd, LPCWSTR pszFile) {
+	HANDLE hFile = CreateFile(pszFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		dwLastIOError = GetLastError();
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart > MARKTERMS_MAX_FILE_SIZE) {
+		dwLastIOError = (fileSize.QuadPart > MARKTERMS_MAX_FILE_SIZE) ? ERROR_FILE_TOO_LARGE : GetLastError();
+		CloseHandle(hFile);
+		return FALSE;
+	}
+
+	DWORD cbData = (DWORD)fileSize.QuadPart;
+	char *lpData = (char *)NP2HeapAlloc(cbData + 16);
+	DWORD cbRead = 0;
+	const BOOL bRead = lpData != NULL && ReadFile(hFile, lpData, cbData, &cbRead, NULL) && cbRead == cbData;
+	dwLastIOError = GetLastError();
+	CloseHandle(hFile);
+	if (!bRead) {
+		if (lpData != NULL) {
+			NP2HeapFree(lpData);
+		}
+		return FALSE;
+	}
+
+	LPCWSTR lpText;
+	LPWSTR lpTextWide = NULL;
+	BOOL bBOM = FALSE;
+	BOOL bReverse = FALSE;
+	if (cbData != 0 && IsUnicode(lpData, cbData, &bBOM, &bReverse)) {
+		if (bReverse) {
+			_swab(lpData, lpData, cbData);
+		}
+		lpText = (LPCWSTR)lpData + bBOM;
+	} else {
+		const char *lpBytes = lpData;
+		if (IsUTF8Signature(lpData)) {
+			lpBytes += 3;
+			cbData -= 3;
+		}
+		const UINT uCodePage = IsUTF8(lpBytes, cbData) ? CP_UTF8 : CP_ACP;
+		lpTextWide = (LPWSTR)NP2HeapAlloc((cbData + 1)*sizeof(WCHAR));
+		MultiByteToWideChar(uCodePage, 0, lpBytes, cbData, lpTextWide, cbData + 1);
+		lpText = lpTextWide;
+	}
+	SetDlgItemText(hwnd, IDC_MARKTERMS_LIST, lpText);
+	if (lpTextWide != NULL) {
+		NP2HeapFree(lpTextWide);
+	}
+	NP2HeapFree(lpData);
+	return TRUE;
+}
+
+static INT_PTR CALLBACK MarkTermsDlgProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
+	UNREFERENCED_PARAMETER(lParam);
+
+	switch (umsg) {
+	case WM_INITDIALOG: {
+		HWND hwndList = GetDlgItem(hwnd, IDC_MARKTERMS_LIST);
+		// default limit is 32K characters
+		SendMessage(hwndList, EM_LIMITTEXT, 0, 0);
+		if (lpMarkTermsList != NULL) {
+			SetWindowText(hwndList, lpMarkTermsList);
+		}
+		CheckDlgButton(hwnd, IDC_FINDCASE, bMarkTermsMatchCase ? BST_CHECKED : BST_UNCHECKED);
+		CheckDlgButton(hwnd, IDC_FINDWORD, bMarkTermsWholeWord ? BST_CHECKED : BST_UNCHECKED);
+		CenterDlgInParent(hwnd);
+	}
+	return TRUE;
+
+	case WM_COMMAND:
+		switch (LOWORD(wParam)) {
+		case IDC_MARKTERMS_LOAD: {
+			WCHAR szFile[MAX_PATH] = L"";
+			WCHAR szFilter[256];
+			GetString(IDS_FILTER_ALL, szFilter, COUNTOF(szFilter));
+			PrepareFilterStr(szFilter);
+
+			OPENFILENAME ofn;
+			ZeroMemory(&ofn, sizeof(OPENFILENAME));
+			ofn.lStructSize = sizeof(OPENFILENAME);
+			ofn.hwndOwner = hwnd;
+			ofn.lpstrFilter = szFilter;
+			ofn.lpstrFile = szFile;
+			ofn.nMaxFile = COUNTOF(szFile);
+			ofn.Flags = OFN_FILEMUSTEXIST | OFN_HIDEREADONLY | OFN_NOCHANGEDIR | OFN_DONTADDTORECENT
+						| OFN_PATHMUSTEXIST | OFN_SHAREAWARE;
+			if (GetOpenFileName(&ofn) && !MarkTerms_LoadFile(hwnd, szFile)) {
+				MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, szFile);
+			}
+		}
+		break;
+
+		case IDOK: {
+			HWND hwndList = GetDlgItem(hwnd, IDC_MARKTERMS_LIST);
+			const int cchList = GetWindowTextLength(hwndList);
+			LPWSTR lpList = (LPWSTR)NP2HeapAlloc((cchList + 1)*sizeof(WCHAR));
+			GetWindowText(hwndList, lpList, cchList + 1);
+			if (lpMarkTermsList != NULL) {
+				NP2HeapFree(lpMarkTermsList);
+			}
+			lpMarkTermsList = lpList;
+			bMarkTermsMatchCase = IsButtonChecked(hwnd, IDC_FINDCASE);
+			bMarkTermsWholeWord = IsButtonChecked(hwnd, IDC_FINDWORD);
+			EndDialog(hwnd, IDOK);
+		}
+		break;
+
+		case IDCANCEL:
+			EndDialog(hwnd, IDCANCEL);
+			break;
+		}
+
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+void MarkTerms_ShowDialog(HWND hwnd) {
+	if (ThemedDialogBox(g_hInstance, MAKEINTRESOURCE(IDD_MARKTERMS), hwnd, MarkTermsDlgProc) == IDOK) {
+		if (!MarkTerms_Apply(lpMarkTermsList, bMarkTermsMatchCase, bMarkTermsWholeWord)) {
+			dwLastIOError = ERROR_NOT_ENOUGH_MEMORY;
+			MsgBoxLastError(MB_OK, IDS_ERR_MARKTERMS);
+		}
+	}
+}
@@ -0,0 +1,11 @@
+// Mark Terms
+#pragma once
+
+// marks every term of the list (one term per line) in one pass over the document, each term with
+// its own color, returns FALSE when out of memory.
+BOOL MarkTerms_Apply(LPCWSTR lpszTerms, BOOL matchCase, BOOL wholeWord);
+void MarkTerms_Clear(void);
+BOOL MarkTerms_IsActive(void);
+void MarkTerms_OnStyleChanged(void);
+// edit term list and options, then mark the terms.
+void MarkTerms_ShowDialog(HWND hwnd);
@@ -0,0 +1,408 @@
+// Document Map
+
+#include <windows.h>
+#include <windowsx.h>
+#include "SciCall.h"
+#include "Helpers.h"
+#include "MiniMap.h"
+
+// The document map paints the document as colored blocks, each byte takes the
+// foreground color of its style read from Scintilla's style buffer, text is never
+// laid out. Documents taller than the pane are downsampled to one line per pixel
+// row. Rows are rendered into a cached DIB section, changed lines only invalidate
+// their rows, so the cost of painting is bounded by the size of the pane instead
+// of the size of the document.
+
+#define WC_NP2MINIMAP				L"Notepad2MiniMap"
+// poll end of styled text while idle styling is catching up.
+#define MINIMAP_STYLE_TIMER_ID		1
+#define MINIMAP_STYLE_TIMER_DELAY	250
+// stop polling when styling makes no progress, e.g. for document without styles.
+#define MINIMAP_STYLE_IDLE_POLLS	8
+
+extern HWND hwndEdit;
+
+typedef struct MiniMapData {
+	HWND hwnd;
+	HDC hdcCache;
+	HBITMAP hbmCache;
+	HBITMAP hbmOld;
+	DWORD *pixels;			// top-down 32-bit rows of the cached bitmap
+	int cxCache;
+	int cyCache;
+	int cxPixel;			// pixels per character
+	int cyLine;				// pixels per line when the document is not downsampled
+	BOOL bScaled;			// document is downsampled to fit the pane
+	BOOL bStyleTimer;
+	int idlePolls;
+	Sci_Line lineCount;		// line count used for current row mapping
+	Sci_Position styledTo;	// end styled when rows were last invalidated
+	// invalid rows [dirtyFirst, dirtyLast) of the cached bitmap
+	int dirtyFirst;
+	int dirtyLast;
+	COLORREF colorViewport;
+	DWORD colorBack;
+	DWORD colorFore[STYLE_MAX + 1];
+} MiniMapData;
+
+static MiniMapData miniMap;
+
+static inline DWORD MiniMap_PixelColor(COLORREF color) {
+	return ((color & 0xff) << 16) | (color & 0xff00) | ((color >> 16) & 0xff);
+}
+
+static inline BOOL MiniMap_IsActive(void) {
+	return miniMap.hbmCache != NULL && (GetWindowStyle(miniMap.hwnd) & WS_VISIBLE) != 0;
+}
+
+static inline Sci_Line MiniMap_LineFromRow(int row) {
+	if (miniMap.bScaled) {
+		return (Sci_Line)(((int64_t)row * miniMap.lineCount) / miniMap.cyCache);
+	}
+	return row / miniMap.cyLine;
+}
+
+// first row sampling the line, or the row after last line.
+static inline int MiniMap_RowFromLine(Sci_Line line) {
+	if (line >= miniMap.lineCount) {
+		return miniMap.bScaled ? miniMap.cyCache : (int)miniMap.lineCount * miniMap.cyLine;
+	}
+	if (miniMap.bScaled) {
+		return (int)(((int64_t)line * miniMap.cyCache + miniMap.lineCount - 1) / miniMap.lineCount);
+	}
+	return (int)line * miniMap.cyLine;
+}
+
+static void MiniMap_InvalidateRows(int first, int last) {
+	MiniMapData * const mm = &miniMap;
+	first = max_i(first, 0);
+	last = min_i(last, mm->cyCache);
+	if (first < last) {
+		mm->dirtyFirst = min_i(mm->dirtyFirst, first);
+		mm->dirtyLast = max_i(mm->dirtyLast, last);
+		InvalidateRect(mm->hwnd, NULL, FALSE);
+	}
+}
+
+static inline void MiniMap_InvalidateLines(Sci_Line first, Sci_Line last) {
+	MiniMap_InvalidateRows(MiniMap_RowFromLine(first), MiniMap_RowFromLine(last + 1));
+}
+
+static void MiniMap_UpdateLayout(void) {
+	MiniMapData * const mm = &miniMap;
+	const Sci_Line lineCount = SciCall_GetLineCount();
+	const BOOL bScaled = (int64_t)lineCount * mm->cyLine > mm->cyCache;
+	mm->lineCount = lineCount;
+	mm->bScaled = bScaled;
+}
+
+static void MiniMap_UpdateColors(void) {
+	MiniMapData * const mm = &miniMap;
+	for (int style = 0; style <= STYLE_MAX; style++) {
+		mm->colorFore[style] = MiniMap_PixelColor(SciCall_StyleGetFore(style));
+	}
+	mm->colorBack = MiniMap_PixelColor(SciCall_StyleGetBack(STYLE_DEFAULT));
+	mm->colorViewport = SciCall_StyleGetFore(STYLE_DEFAULT) & 0xffffff;
+}
+
+// invalidate lines styled since last check, keep polling until whole document is styled.
+static void MiniMap_CheckStyling(void) {
+	MiniMapData * const mm = &miniMap;
+	const Sci_Position endStyled = SciCall_GetEndStyled();
+	if (endStyled > mm->styledTo) {
+		mm->idlePolls = 0;
+		MiniMap_InvalidateLines(SciCall_LineFromPosition(mm->styledTo), SciCall_LineFromPosition(endStyled));
+	} else {
+		mm->idlePolls++;
+	}
+	// an edit moves end styled backward, the edited lines are invalidated by MiniMap_OnModified().
+	mm->styledTo = endStyled;
+
+	const BOOL bStyleTimer = endStyled < SciCall_GetLength() && mm->idlePolls < MINIMAP_STYLE_IDLE_POLLS;
+	if (bStyleTimer != mm->bStyleTimer) {
+		mm->bStyleTimer = bStyleTimer;
+		if (bStyleTimer) {
+			SetTimer(mm->hwnd, MINIMAP_STYLE_TIMER_ID, MINIMAP_STYLE_TIMER_DELAY, NULL);
+		} else {
+			KillTimer(mm->hwnd, MINIMAP_STYLE_TIMER_ID);
+		}
+	}
+}
+
+static void MiniMap_RenderLine(DWORD *pixel, Sci_Line line, int columns, int tabWidth) {
+	MiniMapData * const mm = &miniMap;
+	const Sci_Position startPos = SciCall_PositionFromLine(line);
+	Sci_Position length = SciCall_GetLineEndPosition(line) - startPos;
+	// up to 4 bytes for each UTF-8 character
+	length = min_pos(length, 4*(Sci_Position)columns);
+	if (length <= 0) {
+		return;
+	}
+
+	const uint8_t *text = (const uint8_t *)SciCall_GetRangePointer(startPos, length);
+	// NULL when the document has no styles, e.g. in large file mode.
+	const uint8_t *styles = SciCall_GetStyleRangePointer(startPos, length);
+	const DWORD colorDefault = mm->colorFore[STYLE_DEFAULT];
+	const int cxPixel = mm->cxPixel;
+	int column = 0;
+	for (Sci_Position index = 0; index < length && column < columns; index++) {
+		const uint8_t ch = text[index];
+		if (ch == '\t') {
+			column = (column/tabWidth + 1)*tabWidth;
+		} else if ((ch & 0xC0) != 0x80) {
+			if (ch != ' ') {
+				const DWORD color = (styles != NULL) ? mm->colorFore[styles[index]] : colorDefault;
+				DWORD *ptr = pixel + column*cxPixel;
+				for (int x = 0; x < cxPixel; x++) {
+					ptr[x] = color;
+				}
+			}
+			++column;
+		}
+	}
+}
+
+static void MiniMap_RenderRows(void) {
+	MiniMapData * const mm = &miniMap;
+	if (mm->dirtyFirst >= mm->dirtyLast) {
+		return;
+	}
+
+	GdiFlush();
+	const int cxCache = mm->cxCache;
+	const int columns = cxCache / mm->cxPixel;
+	const int tabWidth = max_i(1, SciCall_GetTabWidth());
+	Sci_Line prevLine = -1;
+	for (int row = mm->dirtyFirst; row < mm->dirtyLast; row++) {
+		DWORD *pixel = mm->pixels + (size_t)row*cxCache;
+		Sci_Line line = MiniMap_LineFromRow(row);
+		// leave a blank row between lines when they are not downsampled.
+		if (line >= mm->lineCount || (!mm->bScaled && (row % mm->cyLine) == mm->cyLine - 1)) {
+			line = -1;
+		} else if (line == prevLine) {
+			memcpy(pixel, pixel - cxCache, cxCache*sizeof(DWORD));
+			continue;
+		}
+		prevLine = line;
+		for (int x = 0; x < cxCache; x++) {
+			pixel[x] = mm->colorBack;
+		}
+		if (line >= 0) {
+			MiniMap_RenderLine(pixel, line, columns, tabWidth);
+		}
+	}
+	mm->dirtyFirst = mm->cyCache;
+	mm->dirtyLast = 0;
+}
+
+static void MiniMap_Paint(HWND hwnd) {
+	MiniMapData * const mm = &miniMap;
+	PAINTSTRUCT ps;
+	HDC hdc = BeginPaint(hwnd, &ps);
+	if (mm->hbmCache != NULL) {
+		MiniMap_RenderRows();
+		BitBlt(hdc, 0, 0, mm->cxCache, mm->cyCache, mm->hdcCache, 0, 0, SRCCOPY);
+
+		// frame of lines shown in the edit window
+		const Sci_Line firstLine = SciCall_GetFirstVisibleLine();
+		const Sci_Line docFirst = SciCall_DocLineFromVisible(firstLine);
+		const Sci_Line docLast = SciCall_DocLineFromVisible(firstLine + SciCall_LinesOnScreen() - 1);
+		RECT rc;
+		rc.left = 0;
+		rc.right = mm->cxCache;
+		rc.top = MiniMap_RowFromLine(docFirst);
+		rc.bottom = max_i(MiniMap_RowFromLine(docLast + 1), rc.top + 2);
+		HBRUSH hbr = CreateSolidBrush(mm->colorViewport);
+		FrameRect(hdc, &rc, hbr);
+		DeleteObject(hbr);
+	}
+	EndPaint(hwnd, &ps);
+}
+
+static void MiniMap_DeleteCache(void) {
+	MiniMapData * const mm = &miniMap;
+	if (mm->hdcCache != NULL) {
+		SelectObject(mm->hdcCache, mm->hbmOld);
+		DeleteObject(mm->hbmCache);
+		DeleteDC(mm->hdcCache);
+		mm->hdcCache = NULL;
+		mm->hbmCache = NULL;
+		mm->pixels = NULL;
+	}
+	mm->cxCache = 0;
+	mm->cyCache = 0;
+}
+
+static void MiniMap_CreateCache(int cx, int cy) {
+	MiniMapData * const mm = &miniMap;
+	MiniMap_DeleteCache();
+	if (cx <= 0 || cy <= 0) {
+		return;
+	}
+
+	BITMAPINFO bmi;
+	ZeroMemory(&bmi, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = cx;
+	bmi.bmiHeader.biHeight = -cy;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	HDC hdc = GetDC(mm->hwnd);
+	mm->hdcCache = CreateCompatibleDC(hdc);
+	mm->hbmCache = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, (void **)(&mm->pixels), NULL, 0);
+	ReleaseDC(mm->hwnd, hdc);
+	if (mm->hbmCache == NULL) {
+		DeleteDC(mm->hdcCache);
+		mm->hdcCache = NULL;
+		mm->pixels = NULL;
+		return;
+	}
+
+	mm->hbmOld = SelectBitmap(mm->hdcCache, mm->hbmCache);
+	mm->cxCache = cx;
+	mm->cyCache = cy;
+	mm->dirtyFirst = cy;
+	mm->dirtyLast = 0;
+}
+
+static void MiniMap_ScrollToRow(int row) {
+	MiniMapData * const mm = &miniMap;
+	if (mm->cyCache <= 0) {
+		return;
+	}
+
+	row = clamp_i(row, 0, mm->cyCache - 1);
+	Sci_Line line = MiniMap_LineFromRow(row);
+	line = min_pos(line, mm->lineCount - 1);
+	// center the line in edit window
+	const Sci_Line top = SciCall_VisibleFromDocLine(line) - SciCall_LinesOnScreen()/2;
+	SciCall_SetFirstVisibleLine(max_pos(top, 0));
+}
+
+static LRESULT CALLBACK MiniMap_WndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam) {
+	MiniMapData * const mm = &miniMap;
+	switch (umsg) {
+	case WM_PAINT:
+		MiniMap_Paint(hwnd);
+		return 0;
+
+	case WM_ERASEBKGND:
+		return 1;
+
+	case WM_SIZE: {
+		const int cx = LOWORD(lParam);
+		const int cy = HIWORD(lParam);
+		const int cxPixel = max_i(1, g_uCurrentDPI/USER_DEFAULT_SCREEN_DPI);
+		const int cyLine = max_i(2, 2*g_uCurrentDPI/USER_DEFAULT_SCREEN_DPI);
+		if (cx != mm->cxCache || cy != mm->cyCache || cxPixel != mm->cxPixel || cyLine != mm->cyLine) {
+			mm->cxPixel = cxPixel;
+			mm->cyLine = cyLine;
+			MiniMap_CreateCache(cx, cy);
+			if (MiniMap_IsActive()) {
+				MiniMap_Reset();
+			}
+		}
+	} return 0;
+
+	case WM_TIMER:
+		if (wParam == MINIMAP_STYLE_TIMER_ID) {
+			if (MiniMap_IsActive()) {
+				MiniMap_CheckStyling();
+			} else {
+				mm->bStyleTimer = FALSE;
+				KillTimer(hwnd, MINIMAP_STYLE_TIMER_ID);
+			}
+		}
+		return 0;
+
+	case WM_LBUTTONDOWN:
+		SetCapture(hwnd);
+		MiniMap_ScrollToRow(GET_Y_LPARAM(lParam));
+		return 0;
+
+	case WM_MOUSEMOVE:
+		if (GetCapture() == hwnd) {
+			MiniMap_ScrollToRow(GET_Y_LPARAM(lParam));
+		}
+		return 0;
+
+	case WM_LBUTTONUP:
+		if (GetCapture() == hwnd) {
+			ReleaseCapture();
+		}
+		return 0;
+
+	case WM_MOUSEWHEEL:
+		return SendMessage(hwndEdit, umsg, wParam, lParam);
+
+	case WM_DESTROY:
+		KillTimer(hwnd, MINIMAP_STYLE_TIMER_ID);
+		MiniMap_DeleteCache();
+		return 0;
+	}
+	return DefWindowProc(hwnd, umsg, wParam, lParam);
+}
+
+HWND MiniMap_Create(HWND hwndParent, HINSTANCE hInstance, UINT id) {
+	WNDCLASSEX wc;
+	ZeroMemory(&wc, sizeof(WNDCLASSEX));
+	wc.cbSize = sizeof(WNDCLASSEX);
+	wc.lpfnWndProc = MiniMap_WndProc;
+	wc.hInstance = hInstance;
+	wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+	wc.lpszClassName = WC_NP2MINIMAP;
+	RegisterClassEx(&wc);
+
+	HWND hwnd = CreateWindowEx(0, WC_NP2MINIMAP, NULL,
+						WS_CHILD | WS_CLIPSIBLINGS,
+						0, 0, 0, 0, hwndParent, (HMENU)(UINT_PTR)id, hInstance, NULL);
+	miniMap.hwnd = hwnd;
+	return hwnd;
+}
+
+// called when the document is replaced, or styles are changed.
+void MiniMap_Reset(void) {
+	MiniMapData * const mm = &miniMap;
+	if (MiniMap_IsActive()) {
+		MiniMap_UpdateColors();
+		MiniMap_UpdateLayout();
+		mm->styledTo = 0;
+		mm->idlePolls = 0;
+		mm->dirtyFirst = 0;
+		mm->dirtyLast = mm->cyCache;
+		MiniMap_CheckStyling();
+		InvalidateRect(mm->hwnd, NULL, FALSE);
+	}
+}
+
+void MiniMap_OnModified(Sci_Position position, Sci_Line linesAdded) {
+	if (MiniMap_IsActive()) {
+		const Sci_Line line = SciCall_LineFromPosition(position);
+		if (linesAdded == 0) {
+			MiniMap_InvalidateLines(line, line);
+		} else {
+			// following lines are shifted, all rows are resampled when downsampled.
+			MiniMap_UpdateLayout();
+			MiniMap_InvalidateRows(miniMap.bScaled ? 0 : MiniMap_RowFromLine(line), miniMap.cyCache);
+		}
+	}
+}
+
+void MiniMap_OnUpdateUI(int updated) {
+	MiniMapData * const mm = &miniMap;
+	if (MiniMap_IsActive()) {
+		if (updated & (SC_UPDATE_CONTENT | SC_UPDATE_V_SCROLL)) {
+			// text replaced with modification events disabled, e.g. on loading file.
+			if ((updated & SC_UPDATE_CONTENT) && mm->lineCount != SciCall_GetLineCount()) {
+				MiniMap_UpdateLayout();
+				MiniMap_InvalidateRows(0, mm->cyCache);
+			}
+			// scrolling styles newly visible lines
+			mm->idlePolls = 0;
+			MiniMap_CheckStyling();
+			InvalidateRect(mm->hwnd, NULL, FALSE);
+		}
+	}
+}
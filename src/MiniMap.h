@@ -0,0 +1,10 @@
+// Document Map
+#pragma once
+
+// pane width in pixels at 96 DPI
+#define NP2_MINIMAP_WIDTH	96
+
+HWND MiniMap_Create(HWND hwndParent, HINSTANCE hInstance, UINT id);
+void MiniMap_Reset(void);
+void MiniMap_OnModified(Sci_Position position, Sci_Line linesAdded);
+void MiniMap_OnUpdateUI(int updated);
@@ -31,12 +31,22 @@
 #include <inttypes.h>
 #include "SciCall.h"
 #include "VectorISA.h"
+#include "TraceEvents.h"
 #include "config.h"
 #include "Helpers.h"
 #include "Notepad2.h"
 #include "Edit.h"
 #include "Styles.h"
 #include "Dialogs.h"
+#include "HexView.h"
+#include "MiniMap.h"
+#include "Exporter.h"
+#include "CsvView.h"
+#include "Compare.h"
+#include "MarkTerms.h"
+#include "Macro.h"
+#include "DocStats.h"
+#include "Automation.h"
 #include "resource.h"
 
 //! show fold level
@@ -55,9 +65,12 @@ static HWND hwndToolbar;
 static HWND hwndReBar;
 HWND	hwndEdit;
 static HWND hwndEditFrame;
+static HWND hwndHexView;
+static HWND hwndMiniMap;
 HWND	hwndMain;
 static HWND hwndNextCBChain = NULL;
 HWND	hDlgFindReplace = NULL;
+HWND	hDlgFindInFiles = NULL;
 static BOOL bInitDone = FALSE;
 static HACCEL hAccMain;
 static HACCEL hAccFindReplace;
@@ -102,9 +115,13 @@ static WCHAR szIniFile2[MAX_PATH] = L"";
 static BOOL bSaveSettings;
 BOOL	bSaveRecentFiles;
 static BOOL bSaveFindReplace;
+static UINT64 hashSettingsSection;
+static UINT64 hashWindowPositionSection;
 static WCHAR tchLastSaveCopyDir[MAX_PATH] = L"";
 WCHAR	tchOpenWithDir[MAX_PATH];
 WCHAR	tchFavoritesDir[MAX_PATH];
+WCHAR	tchFindInFilesFilter[MAX_PATH];
+BOOL	bFindInFilesSubfolders;
 static WCHAR tchDefaultDir[MAX_PATH];
 static WCHAR tchToolbarButtons[MAX_TOOLBAR_BUTTON_CONFIG_BUFFER_SIZE];
 static LPWSTR tchToolbarBitmap = NULL;
@@ -172,6 +189,18 @@ BOOL	bFileWatchingKeepAtEnd;
 BOOL	bResetFileWatching;
 static DWORD dwFileCheckInterval;
 static DWORD dwAutoReloadTimeout;
+static DWORD dwAutoSaveInterval;
+static WCHAR tchAutoSaveDir[MAX_PATH];
+DWORD	dwFileMappingMinSize;
+DWORD	dwCompressTextMinSize;
+DWORD	dwEOLSampleMinSize;
+int		iEOLSampleBlockCount;
+static BOOL bUseLargePages;
+static int iStyleBudget;
+// large file profile, applied when document is larger than either threshold.
+DWORD	dwLargeFileProfileSize;
+DWORD	dwLargeFileProfileLines;
+BOOL	bLargeFileProfile;
 BOOL bUseXPFileDialog;
 static int iEscFunction;
 static BOOL bAlwaysOnTop;
@@ -181,6 +210,7 @@ static int	iEndAtLastLine;
 BOOL	bFindReplaceTransparentMode;
 BOOL	bFindReplaceUseMonospacedFont;
 BOOL	bFindReplaceFindAllBookmark;
+BOOL	bLinearRegexSearch;
 static BOOL bEditLayoutRTL;
 BOOL	bWindowLayoutRTL;
 static int iRenderingTechnology;
@@ -189,6 +219,7 @@ static int iBidirectional;
 static BOOL bShowToolbar;
 static BOOL bAutoScaleToolbar;
 static BOOL bShowStatusbar;
+static BOOL bShowMiniMap;
 static BOOL bInFullScreenMode;
 static int iFullScreenMode;
 
@@ -226,6 +257,8 @@ int		cyInsertTagDlg;
 int		xFindReplaceDlg;
 int		yFindReplaceDlg;
 int		cxFindReplaceDlg;
+int		cxFindInFilesDlg;
+int		cyFindInFilesDlg;
 
 extern int cxStyleSelectDlg;
 extern int cyStyleSelectDlg;
@@ -239,6 +272,10 @@ static LPWSTR lpFileArg = NULL;
 static LPWSTR lpSchemeArg = NULL;
 static LPWSTR lpMatchArg = NULL;
 static LPWSTR lpEncodingArg = NULL;
+static LPWSTR lpTimingArg = NULL;
+static LPWSTR lpAutomationArg = NULL;
+static LPWSTR lpSessionArg = NULL;
+static EditFileRange rangeArg = { TRUE, 1, 0 };
 LPMRULIST	pFileMRU;
 LPMRULIST	mruFind;
 LPMRULIST	mruReplace;
@@ -249,6 +286,8 @@ FILEVARS	fvCurFile;
 static BOOL bModified;
 static BOOL bReadOnly = FALSE;
 BOOL bLockedForEditing = FALSE; // save call to SciCall_GetReadOnly()
+static BOOL bCompressedFile = FALSE; // decompressed text can't be saved back to the file
+static BOOL bSkipHexView = FALSE; // load large binary file as text
 static int iOriginalEncoding;
 static int iEOLMode;
 
@@ -263,14 +302,36 @@ static int iInitialLexer;
 
 static BOOL bLastCopyFromMe = FALSE;
 static DWORD dwLastCopyTime;
+// delay after last clipboard change before pasting in paste board mode
+#define NP2_PASTEBOARD_DELAY	200
 
 static UINT uidsAppTitle = IDS_APPTITLE;
 static WCHAR szTitleExcerpt[128] = L"";
 static int fKeepTitleExcerpt = 0;
 
-static HANDLE hChangeHandle = NULL;
+// directory of current file is watched on a worker thread, which posts APPM_CHANGENOTIFY
+// with wParam set when the current file is reported as changed.
+enum {
+	FileWatchNotify_Changed = 1,
+	FileWatchNotify_Failed = 2,	// directory can't be watched, e.g. on some network shares
+};
+
+typedef struct FileWatchStatus {
+	BackgroundWorker worker;
+	HANDLE hDirectory;
+	volatile LONG pending;	// notification posted but not handled
+	WCHAR szFileName[MAX_PATH];
+} FileWatchStatus;
+
+static FileWatchStatus fileWatch;
 static BOOL bRunningWatch = FALSE;
 static DWORD dwChangeNotifyTime = 0;
+static BOOL bWatchTimer = FALSE;		// ID_WATCHTIMER is wanted, it's stopped while minimized
+static BOOL bTimersSuspended = FALSE;
+static void CheckCurrentFileChangedOutsideApp(void);
+static void SetWatchTimer(void);
+static void KillWatchTimer(void);
+static void SuspendPollingTimers(BOOL suspend);
 
 static UINT msgTaskbarCreated = 0;
 
@@ -299,6 +360,7 @@ enum StatusBarUpdateMask {
 	StatusBarUpdateMask_OVRMode = 8,
 	StatusBarUpdateMask_DocZoom = 16,
 	StatusBarUpdateMask_LineColumn = 32,
+	StatusBarUpdateMask_DocPos = 64,
 };
 // rarely changed statusbar items
 struct CachedStatusItem {
@@ -308,6 +370,10 @@ struct CachedStatusItem {
 	Sci_Line iLine;
 	Sci_Position iLineChar;
 	Sci_Position iLineColumn;
+	// character count of last stream selection, invalid after document changed
+	Sci_Position iSelStart;
+	Sci_Position iSelEnd;
+	Sci_Position iSelChar;
 
 	LPCWSTR pszLexerName;
 	LPCWSTR pszEOLMode;
@@ -316,12 +382,48 @@ struct CachedStatusItem {
 
 	WCHAR tchLexerName[MAX_EDITLEXER_NAME_SIZE];
 	WCHAR tchDocPosFmt[96];
+	WCHAR tchHexPosFmt[64];
+	WCHAR tchLargeFileFmt[32];
+	// text last sent to the frequently changed panes
+	WCHAR tchDocPos[256];
+	WCHAR tchDocSize[64];
 } cachedStatusItem;
 
 #define UpdateStatusBarCacheLineColumn()	cachedStatusItem.updateMask |= StatusBarUpdateMask_LineColumn
 
+// toolbar button states last sent, bit index is button id - IDT_FILE_NEW
+static struct CachedToolbarState {
+	BOOL valid;
+	UINT enabled;
+	UINT checked;
+} cachedToolbarState;
+
+// toolbar image lists are kept per scaled DPI and face color, so moving the window between
+// monitors or switching theme back reuses them instead of loading, scaling and blending bitmaps again.
+#define TOOLBAR_IMAGE_CACHE_SIZE	4
+typedef struct ToolbarImageCache {
+	UINT dpi;		// 0 for unused slot
+	COLORREF crFace;
+	HIMAGELIST himlNormal;
+	HIMAGELIST himlHot;
+	HIMAGELIST himlDisabled;
+} ToolbarImageCache;
+static ToolbarImageCache toolbarImageCache[TOOLBAR_IMAGE_CACHE_SIZE];
+static UINT toolbarImageCacheNext;
+
+// toolbar and statusbar updates from SCN_UPDATEUI are coalesced on a timer
+enum PendingUIUpdate {
+	PendingUIUpdate_Toolbar = 1,
+	PendingUIUpdate_Statusbar = 2,
+};
+static UINT pendingUIUpdate;
+#define NP2_UPDATEUI_DELAY			16
+// matching brace farther than this is not searched with large file profile
+#define NP2_LARGE_FILE_BRACE_DISTANCE	(64*1024)
+
 HINSTANCE	g_hInstance;
 HANDLE		g_hDefaultHeap;
+HANDLE		g_hTempHeap;
 HANDLE		g_hScintilla;
 #if _WIN32_WINNT < _WIN32_WINNT_WIN8
 DWORD		g_uWinVer;
@@ -348,7 +450,12 @@ static int	flagReuseWindow			= 0;
 static BOOL bSingleFileInstance		= TRUE;
 static BOOL bReuseWindow			= FALSE;
 static BOOL bStickyWindowPosition	= FALSE;
+static BOOL bResidentInstance		= FALSE;
+static BOOL bRestoreSession			= FALSE;
+static BOOL bViewStateCache			= TRUE;
 static int	flagMultiFileArg		= 0;
+static BOOL flagStdinSource			= FALSE;
+static BOOL flagRangeArg			= FALSE;
 static int	flagSingleFileInstance	= 1;
 static int	flagStartAsTrayIcon		= 0;
 static int	flagAlwaysOnTop			= 0;
@@ -376,9 +483,12 @@ static int	flagQuietCreate			= 0;
 int			flagUseSystemMRU		= 0;
 static int	flagRelaunchElevated	= 0;
 static int	flagDisplayHelp			= 0;
+static int	flagStartupTiming		= 0;
+static int	flagAutomation			= 0;
+static int	flagResidentStandby		= 0;
 
 static inline BOOL IsDocumentModified(void) {
-	return bModified || iEncoding != iOriginalEncoding;
+	return bModified || iEncoding != iOriginalEncoding || HexView_IsModified();
 }
 
 static inline BOOL IsTopMost(void) {
@@ -460,6 +570,11 @@ static void DispatchMessageMain(MSG *msg) {
 			return;
 		}
 	}
+	if (IsWindow(hDlgFindInFiles) && (msg->hwnd == hDlgFindInFiles || IsChild(hDlgFindInFiles, msg->hwnd))) {
+		if (IsDialogMessage(hDlgFindInFiles, msg)) {
+			return;
+		}
+	}
 
 	if (!TranslateAccelerator(hwndMain, hAccMain, msg)) {
 		TranslateMessage(msg);
@@ -478,6 +593,7 @@ BOOL WINAPI ConsoleHandlerRoutine(DWORD dwCtrlType) {
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nShowCmd) {
 	UNREFERENCED_PARAMETER(hPrevInstance);
 	UNREFERENCED_PARAMETER(lpCmdLine);
+	StartupTiming_Start();
 #if 0 // used for Clang UBSan or printing debug message on console.
 	if (AttachConsole(ATTACH_PARENT_PROCESS)) {
 		SetConsoleCtrlHandler(ConsoleHandlerRoutine, TRUE);
@@ -502,6 +618,11 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 #endif
 
 	g_hDefaultHeap = GetProcessHeap();
+	// growable and serialized, shared by worker threads
+	g_hTempHeap = HeapCreate(0, 0, 0);
+	if (g_hTempHeap == NULL) {
+		g_hTempHeap = g_hDefaultHeap;
+	}
 	// https://docs.microsoft.com/en-us/windows/desktop/Memory/low-fragmentation-heap
 #if 0 // default enabled since Vista
 	{
@@ -527,13 +648,16 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 
 	// Default Encodings (may already be used for command line parsing)
 	Encoding_InitDefaults();
+	StartupTiming_Mark("Encoding_InitDefaults");
 
 	// Command Line, Ini File and Flags
 	ParseCommandLine();
+	StartupTiming_Mark("ParseCommandLine");
 	FindIniFile();
 	TestIniFile();
 	CreateIniFile(szIniFile);
 	LoadFlags();
+	StartupTiming_Mark("FindIniFile, LoadFlags");
 
 	// set AppUserModelID
 	PrivateSetCurrentProcessExplicitAppUserModelID(g_wchAppUserModelID);
@@ -573,11 +697,19 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 		return 0;
 	}
 
+	// Restore windows of last session
+	RestoreSession();
+
 	// Try to activate another window
 	if (ActivatePrevInst()) {
 		return 0;
 	}
 
+	// Try to hand over to the standby instance
+	if (ActivateResidentInst()) {
+		return 0;
+	}
+
 	// Init OLE and Common Controls
 	OleInitialize(NULL);
 
@@ -587,6 +719,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	InitCommonControlsEx(&icex);
 
 	msgTaskbarCreated = RegisterWindowMessage(L"TaskbarCreated");
+	StartupTiming_Mark("OleInitialize, InitCommon");
 
 #if _WIN32_WINNT < _WIN32_WINNT_WIN8
 	// see LoadD2D() in PlatWin.cxx
@@ -607,14 +740,17 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	Scintilla_LoadDpiForWindow();
 #endif
 	Scintilla_RegisterClasses(hInstance);
+	StartupTiming_Mark("Scintilla_RegisterClasses");
 
 	// Load Settings
 	LoadSettings();
+	StartupTiming_Mark("Style_Load");
 
 	if (!InitApplication(hInstance)) {
 		CleanUpResources(FALSE);
 		return FALSE;
 	}
+	StartupTiming_Mark("InitApplication");
 
 	// create the timer first, to make flagMatchText working.
 	HANDLE timer = idleTaskTimer = WaitableTimer_Create();
@@ -622,6 +758,32 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 	InitInstance(hInstance, nShowCmd);
 	hAccMain = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDR_MAINWND));
 	hAccFindReplace = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDR_ACCFINDREPLACE));
+	StartupTiming_Mark("InitInstance");
+	if (flagResidentStandby) {
+		SetProp(hwndMain, PROP_RESIDENT_STANDBY, (HANDLE)TRUE);
+	} else {
+		StartResidentInst();
+	}
+	if (flagStartupTiming) {
+		WCHAR tchFile[MAX_PATH] = L"";
+		if (lpTimingArg) {
+			// relative to the directory where Notepad2 was launched
+			PathCombine(tchFile, g_wchWorkingDirectory, lpTimingArg);
+			LocalFree(lpTimingArg);
+			lpTimingArg = NULL;
+		}
+		StartupTiming_Report(tchFile);
+	}
+	if (flagAutomation) {
+		if (!Automation_Start(hwndMain, lpAutomationArg)) {
+			dwLastIOError = GetLastError();
+			MsgBoxLastError(MB_OK, IDS_ERR_AUTOMATION);
+		}
+		if (lpAutomationArg) {
+			LocalFree(lpAutomationArg);
+			lpAutomationArg = NULL;
+		}
+	}
 	MSG msg;
 
 	while (TRUE) {
@@ -681,6 +843,14 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 	StopWatch watch;
 	StopWatch_Start(watch);
 #endif
+	// window position is recorded in session entry
+	BOOL bSessionPending = FALSE;
+	if (lpSessionArg) {
+		bSessionPending = Session_LoadEntry(lpSessionArg);
+		LocalFree(lpSessionArg);
+		lpSessionArg = NULL;
+	}
+
 	const BOOL defaultPos = (wi.x == CW_USEDEFAULT || wi.y == CW_USEDEFAULT || wi.cx == CW_USEDEFAULT || wi.cy == CW_USEDEFAULT);
 	RECT rc = { wi.x, wi.y, (defaultPos ? CW_USEDEFAULT : (wi.x + wi.cx)), (defaultPos ? CW_USEDEFAULT : (wi.y + wi.cy)) };
 
@@ -795,6 +965,9 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 		SetWindowTransparentMode(hwndMain, TRUE, iOpacityLevel);
 	}
 
+	AutoSave_Init();
+	StartupTiming_Mark("CreateWindow: MainWnd");
+
 	if (!flagStartAsTrayIcon) {
 		ShowWindow(hwndMain, nCmdShow);
 		UpdateWindow(hwndMain);
@@ -802,6 +975,7 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 		ShowWindow(hwndMain, SW_HIDE); // trick ShowWindow()
 		ShowNotifyIcon(hwndMain, TRUE);
 	}
+	StartupTiming_Mark("ShowWindow");
 
 	// Source Encoding
 	if (lpEncodingArg) {
@@ -813,7 +987,10 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 	BOOL bOpened = FALSE;
 	BOOL bFileLoadCalled = FALSE;
 	// Pathname parameter
-	if (lpFileArg /*&& !flagNewFromClipboard*/) {
+	if (flagStdinSource) {
+		bOpened = FileLoadPipe(TRUE, NULL);
+		bFileLoadCalled = bOpened;
+	} else if (lpFileArg /*&& !flagNewFromClipboard*/) {
 
 		// Open from Directory
 		if (PathIsDirectory(lpFileArg)) {
@@ -822,6 +999,9 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 				bOpened = FileLoad(FALSE, FALSE, FALSE, FALSE, tchFile);
 				bFileLoadCalled = TRUE;
 			}
+		} else if (flagRangeArg) {
+			bOpened = FileLoadRange(FALSE, lpFileArg, &rangeArg);
+			bFileLoadCalled = bOpened;
 		} else {
 			if ((bOpened = FileLoad(FALSE, FALSE, FALSE, FALSE, lpFileArg)) != FALSE) {
 				bFileLoadCalled = TRUE;
@@ -844,6 +1024,11 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 				InstallFileWatching(FALSE);
 			}
 		}
+	} else if (bSessionPending) {
+		// file is loaded when the window is activated
+		Session_ShowPreview();
+		bOpened = TRUE;
+		bFileLoadCalled = TRUE;
 	} else {
 		if (iSrcEncoding != -1) {
 			iEncoding = iSrcEncoding;
@@ -860,6 +1045,7 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 		UpdateStatusBarCache(STATUS_EOLMODE);
 		UpdateStatusBarCacheLineColumn();
 	}
+	StartupTiming_Mark("FileLoad");
 
 	// reset
 	iSrcEncoding = -1;
@@ -939,7 +1125,6 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 		UpdateWindowTitle();
 		bLastCopyFromMe = FALSE;
 		dwLastCopyTime = 0;
-		SetTimer(hwndMain, ID_PASTEBOARDTIMER, 100, PasteBoardTimer);
 	}
 
 	// check if a lexer was specified from the command line
@@ -959,6 +1144,11 @@ void InitInstance(HINSTANCE hInstance, int nCmdShow) {
 		SetNotifyIconTitle(hwndMain);
 	}
 
+	// snapshots are offered on next start without restoring session
+	if (!bSessionPending) {
+		AutoSave_Recover();
+	}
+
 	if (!bInitDone) {
 		bInitDone = TRUE;
 		UpdateStatusBarWidth();
@@ -984,6 +1174,9 @@ static inline void NP2RestoreWind(HWND hwnd) {
 	ShowNotifyIcon(hwnd, FALSE);
 	RestoreWndFromTray(hwnd);
 	ShowOwnedPopups(hwnd, TRUE);
+	if (flagResidentStandby) {
+		LeaveResidentStandby(hwnd);
+	}
 }
 
 static inline void EditMarkAll_Stop(void) {
@@ -1064,7 +1257,13 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		if (!bShutdownOK) {
 			WINDOWPLACEMENT wndpl;
 
+			Automation_Stop();
+			EditPipeSource_Stop();
 			EditMarkAll_Stop();
+			AutoC_DiscardDocWordIndex();
+			AutoC_DiscardSignatureIndex();
+			DocStats_Discard();
+			AutoSave_Shutdown(umsg == WM_ENDSESSION);
 			// Terminate file watching
 			InstallFileWatching(TRUE);
 
@@ -1078,6 +1277,11 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 			wi.cy = wndpl.rcNormalPosition.bottom - wndpl.rcNormalPosition.top;
 			wi.max = (IsZoomed(hwnd) || (wndpl.flags & WPF_RESTORETOMAXIMIZED));
 
+			ViewState_Save();
+			if (umsg == WM_ENDSESSION && wParam) {
+				Session_Save();
+			}
+
 			DragAcceptFiles(hwnd, FALSE);
 
 			// Terminate clipboard watching
@@ -1085,14 +1289,24 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 				KillTimer(hwnd, ID_PASTEBOARDTIMER);
 				ChangeClipboardChain(hwnd, hwndNextCBChain);
 			}
+			if (pendingUIUpdate) {
+				pendingUIUpdate = 0;
+				KillTimer(hwnd, ID_UPDATEUITIMER);
+			}
 
 			// Destroy find / replace dialog
 			if (IsWindow(hDlgFindReplace)) {
 				DestroyWindow(hDlgFindReplace);
 			}
+			if (IsWindow(hDlgFindInFiles)) {
+				DestroyWindow(hDlgFindInFiles);
+			}
 
 			// call SaveSettings() when hwndToolbar is still valid
-			SaveSettings(FALSE);
+			// an unused standby instance has nothing new to save
+			if (!flagResidentStandby) {
+				SaveSettings(FALSE);
+			}
 
 			if (StrNotEmpty(szIniFile)) {
 
@@ -1191,8 +1405,15 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		}
 		return DefWindowProc(hwnd, umsg, wParam, lParam);
 
+	case WM_ACTIVATE:
+		// load file of restored window outside of activation
+		if (LOWORD(wParam) != WA_INACTIVE && Session_IsPending()) {
+			PostMessage(hwnd, APPM_SESSIONLOAD, 0, 0);
+		}
+		return DefWindowProc(hwnd, umsg, wParam, lParam);
+
 	case WM_SETFOCUS:
-		SetFocus(hwndEdit);
+		SetFocus(HexView_IsActive() ? hwndHexView : hwndEdit);
 		//if (bPendingChangeNotify)
 		//	PostMessage(hwnd, APPM_CHANGENOTIFY, 0, 0);
 		break;
@@ -1301,6 +1522,13 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 			NP2HeapFree(params);
 
 			UpdateStatusbar();
+
+			if (flagResidentStandby) {
+				ShowNotifyIcon(hwnd, FALSE);
+				ShowWindow(hwnd, wi.max ? SW_SHOWMAXIMIZED : SW_SHOWNORMAL);
+				SetForegroundWindow(hwnd);
+				LeaveResidentStandby(hwnd);
+			}
 		}
 	}
 	return TRUE;
@@ -1382,20 +1610,42 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		return DefWindowProc(hwnd, umsg, wParam, lParam);
 
 	case APPM_CHANGENOTIFY:
+		if (wParam) {
+			// from directory watcher, check whether size or time of current file changed
+			InterlockedExchange(&fileWatch.pending, 0);
+			if (bRunningWatch && dwChangeNotifyTime == 0) {
+				if (wParam == FileWatchNotify_Failed) {
+					SetWatchTimer();
+				}
+				CheckCurrentFileChangedOutsideApp();
+			}
+			break;
+		}
+
 		if (iFileWatchingMode == 1 || IsDocumentModified()) {
 			SetForegroundWindow(hwnd);
 		}
 
 		if (PathIsFile(szCurFile)) {
-			if ((iFileWatchingMode == 2 && !IsDocumentModified()) || MsgBoxWarn(MB_YESNO, IDS_FILECHANGENOTIFY) == IDYES) {
+			const BOOL bFollowTail = iFileWatchingMode == 2 && !IsDocumentModified();
+			if (bFollowTail || MsgBoxWarn(MB_YESNO, IDS_FILECHANGENOTIFY) == IDYES) {
 				const BOOL bIsTail = (iFileWatchingMode == 2) && (bFileWatchingKeepAtEnd || (SciCall_LineFromPosition(SciCall_GetCurrentPos()) + 1 == SciCall_GetLineCount()));
 
-				iWeakSrcEncoding = iEncoding;
-				if (FileLoad(TRUE, FALSE, TRUE, FALSE, szCurFile)) {
+				// only read appended text when the loaded part of the file is unchanged
+				if (bFollowTail && EditLoadFileTail(szCurFile, iEncoding)) {
 					if (bIsTail) {
 						SciCall_DocumentEnd();
 						EditEnsureSelectionVisible();
 					}
+					UpdateStatusbar();
+				} else {
+					iWeakSrcEncoding = iEncoding;
+					if (FileLoad(TRUE, FALSE, TRUE, FALSE, szCurFile)) {
+						if (bIsTail) {
+							SciCall_DocumentEnd();
+							EditEnsureSelectionVisible();
+						}
+					}
 				}
 			}
 		} else {
@@ -1416,7 +1666,9 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 
 	case WM_DRAWCLIPBOARD:
 		if (!bLastCopyFromMe) {
+			// paste after the clipboard is quiet, instead of polling it
 			dwLastCopyTime = GetTickCount();
+			SetTimer(hwnd, ID_PASTEBOARDTIMER, NP2_PASTEBOARD_DELAY, PasteBoardTimer);
 		} else {
 			bLastCopyFromMe = FALSE;
 		}
@@ -1434,6 +1686,19 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		}
 		break;
 
+	// delayed rendering for Copy as RTF
+	case WM_RENDERFORMAT:
+		Exporter_RenderFormat((UINT)wParam);
+		break;
+
+	case WM_RENDERALLFORMATS:
+		Exporter_RenderAllFormats(hwnd);
+		break;
+
+	case WM_DESTROYCLIPBOARD:
+		Exporter_Discard();
+		break;
+
 	case APPM_TRAYMESSAGE:
 		switch (lParam) {
 		case WM_RBUTTONUP: {
@@ -1466,6 +1731,48 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		}
 		break;
 
+	case APPM_DOCWORDINDEX:
+		AutoC_OnDocWordIndexBuilt();
+		break;
+
+	case APPM_SIGNATUREINDEX:
+		AutoC_OnSignatureIndexBuilt();
+		break;
+
+	case APPM_DOCSTATISTICS:
+		DocStats_OnCounted();
+		break;
+
+	case APPM_AUTOMATION:
+		Automation_OnBatch(lParam);
+		break;
+
+	case APPM_AUTOSAVE:
+		AutoSave_OnSnapshotWritten();
+		break;
+
+	case APPM_SESSIONLOAD:
+		Session_LoadPending();
+		break;
+
+	case APPM_PIPESOURCE: {
+		const UINT state = EditPipeSource_OnData(wParam, lParam, !bModified);
+		if (state & (PipeSourceState_BOM | PipeSourceState_ANSI)) {
+			iEncoding = (state & PipeSourceState_ANSI) ? CPI_DEFAULT : CPI_UTF8SIGN;
+			iOriginalEncoding = iEncoding;
+			UpdateStatusBarCache(STATUS_CODEPAGE);
+		}
+		if (state & PipeSourceState_Data) {
+			UpdateLineNumberWidth();
+			UpdateStatusbar();
+		}
+		if (state & PipeSourceState_Finished) {
+			ShowNotificationMessage(SC_NOTIFICATIONPOSITION_BOTTOMRIGHT, IDS_PIPESOURCE_FINISHED, szTitleExcerpt);
+		} else if (state & PipeSourceState_Failed) {
+			MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, szTitleExcerpt);
+		}
+	} break;
+
 	case APPM_CENTER_MESSAGE_BOX: {
 		HWND box = FindWindow(L"#32770", NULL);
 		HWND parent = GetParent(box);
@@ -1601,11 +1908,23 @@ HWND EditCreate(HWND hwndParent) {
 
 	InitScintillaHandle(hwnd);
 	Style_InitDefaultColor();
+	StartupTiming_Mark("EditCreate: CreateWindow");
+	// loads Direct2D and DirectWrite on first call
 	SciCall_SetTechnology(iRenderingTechnology);
+	StartupTiming_Mark("EditCreate: SetTechnology");
 	SciCall_SetBidirectional(iBidirectional);
+	{
+		// wrap long documents on all processors
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		SciCall_SetLayoutThreads(info.dwNumberOfProcessors);
+	}
+	if (bUseLargePages) {
+		SciCall_SetLargePages(TRUE);
+	}
 	SciCall_SetIMEInteraction(bUseInlineIME);
 	SciCall_SetPasteConvertEndings(TRUE);
-	SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
+	SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_BULKMODIFICATION);
 	SciCall_SetCommandEvents(FALSE);
 	SciCall_UsePopUp(SC_POPUP_NEVER);
 	SciCall_SetScrollWidthTracking(TRUE);
@@ -1619,10 +1938,12 @@ HWND EditCreate(HWND hwndParent) {
 	SciCall_SetVirtualSpaceOptions(SCVS_RECTANGULARSELECTION);
 	SciCall_SetAdditionalCaretsBlink(TRUE);
 	SciCall_SetAdditionalCaretsVisible(TRUE);
-	// style both before and after the visible text in the background
-	SciCall_SetIdleStyling(SC_IDLESTYLING_ALL);
+	// style both before and after the visible text in the background,
+	// large remainder is styled on a worker thread
+	SciCall_SetIdleStyling(SC_IDLESTYLING_BACKGROUND);
 	// profile lexer performance
 	//SciCall_SetIdleStyling(SC_IDLESTYLING_NONE);
+	SciCall_SetStyleBudget(iStyleBudget);
 
 	SciCall_AssignCmdKey((SCK_NEXT + (SCMOD_CTRL << 16)), SCI_PARADOWN);
 	SciCall_AssignCmdKey((SCK_PRIOR + (SCMOD_CTRL << 16)), SCI_PARAUP);
@@ -1719,11 +2040,20 @@ HWND EditCreate(HWND hwndParent) {
 
 void EditReplaceDocument(HANDLE pdoc) {
 	const UINT cpEdit = SciCall_GetCodePage();
+	Compare_Clear();
+	MarkTerms_Clear();
 	SciCall_SetDocPointer(pdoc);
 	// reduce reference count to 1
 	SciCall_ReleaseDocument(pdoc);
+	EditMarkAll_DiscardIndex(&editMarkAllStatus);
+	AutoC_DiscardDocWordIndex();
+	AutoC_DiscardSignatureIndex();
+	DocStats_Discard();
+	AutoSave_Discard();
 	SciCall_SetCodePage(cpEdit);
 	SciCall_SetEOLMode(iEOLMode);
+	MiniMap_Reset();
+	CsvView_Reset();
 }
 
 //=============================================================================
@@ -1757,8 +2087,15 @@ LRESULT MsgCreate(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 	EditFrameOnThemeChanged();
 
+	// hidden until a file is shown in hex view
+	hwndHexView = HexView_Create(hwnd, hInstance, IDC_HEXVIEW);
+	// shown by MsgSize()
+	hwndMiniMap = MiniMap_Create(hwnd, hInstance, IDC_MINIMAP);
+
 	// Create Toolbar and Statusbar
+	StartupTiming_Mark("EditCreate");
 	CreateBars(hwnd, hInstance);
+	StartupTiming_Mark("CreateBars");
 
 	// Window Initialization
 
@@ -1809,20 +2146,7 @@ LRESULT MsgCreate(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	return 0;
 }
 
-//=============================================================================
-//
-// CreateBars() - Create Toolbar and Statusbar
-//
-//
-void CreateBars(HWND hwnd, HINSTANCE hInstance) {
-	const BOOL bIsAppThemed = IsAppThemed();
-
-	const DWORD dwToolbarStyle = WS_TOOLBAR;
-	hwndToolbar = CreateWindowEx(0, TOOLBARCLASSNAME, NULL, dwToolbarStyle,
-								 0, 0, 0, 0, hwnd, (HMENU)IDC_TOOLBAR, hInstance, NULL);
-
-	SendMessage(hwndToolbar, TB_BUTTONSTRUCTSIZE, (WPARAM)sizeof(TBBUTTON), 0);
-
+static void LoadToolbarImages(HINSTANCE hInstance, ToolbarImageCache *cache) {
 	BOOL bExternalBitmap = FALSE;
 	// Add normal Toolbar Bitmap
 	HBITMAP hbmp = NULL;
@@ -1847,7 +2171,7 @@ void CreateBars(HWND hwnd, HINSTANCE hInstance) {
 	HIMAGELIST himl = ImageList_Create(bmp.bmHeight, bmp.bmHeight, ILC_COLOR32 | ILC_MASK, 0, 0);
 	ImageList_AddMasked(himl, hbmp, CLR_DEFAULT);
 	DeleteObject(hbmp);
-	SendMessage(hwndToolbar, TB_SETIMAGELIST, 0, (LPARAM)himl);
+	cache->himlNormal = himl;
 
 	// Optionally add hot Toolbar Bitmap
 	if (tchToolbarBitmapHot != NULL) {
@@ -1860,7 +2184,7 @@ void CreateBars(HWND hwnd, HINSTANCE hInstance) {
 			himl = ImageList_Create(bmp.bmHeight, bmp.bmHeight, ILC_COLOR32 | ILC_MASK, 0, 0);
 			ImageList_AddMasked(himl, hbmp, CLR_DEFAULT);
 			DeleteObject(hbmp);
-			SendMessage(hwndToolbar, TB_SETHOTIMAGELIST, 0, (LPARAM)himl);
+			cache->himlHot = himl;
 		}
 	}
 
@@ -1875,22 +2199,76 @@ void CreateBars(HWND hwnd, HINSTANCE hInstance) {
 			himl = ImageList_Create(bmp.bmHeight, bmp.bmHeight, ILC_COLOR32 | ILC_MASK, 0, 0);
 			ImageList_AddMasked(himl, hbmp, CLR_DEFAULT);
 			DeleteObject(hbmp);
-			SendMessage(hwndToolbar, TB_SETDISABLEDIMAGELIST, 0, (LPARAM)himl);
+			cache->himlDisabled = himl;
 			bExternalBitmap = TRUE;
 		}
 	}
 
 	if (!bExternalBitmap) {
-		const BOOL fProcessed = BitmapAlphaBlend(hbmpCopy, GetSysColor(COLOR_3DFACE), 0x60);
+		const BOOL fProcessed = BitmapAlphaBlend(hbmpCopy, cache->crFace, 0x60);
 		if (fProcessed) {
 			himl = ImageList_Create(bmp.bmHeight, bmp.bmHeight, ILC_COLOR32 | ILC_MASK, 0, 0);
 			ImageList_AddMasked(himl, hbmpCopy, CLR_DEFAULT);
-			SendMessage(hwndToolbar, TB_SETDISABLEDIMAGELIST, 0, (LPARAM)himl);
+			cache->himlDisabled = himl;
 		}
 	}
 	if (hbmpCopy) {
 		DeleteObject(hbmpCopy);
 	}
+}
+
+static const ToolbarImageCache *GetToolbarImages(HINSTANCE hInstance) {
+	// bitmaps are only scaled above default DPI
+	const UINT dpi = bAutoScaleToolbar ? max_u(g_uCurrentDPI, USER_DEFAULT_SCREEN_DPI) : USER_DEFAULT_SCREEN_DPI;
+	const COLORREF crFace = GetSysColor(COLOR_3DFACE);
+	for (UINT i = 0; i < TOOLBAR_IMAGE_CACHE_SIZE; i++) {
+		const ToolbarImageCache *cache = &toolbarImageCache[i];
+		if (cache->dpi == dpi && cache->crFace == crFace) {
+			return cache;
+		}
+	}
+
+	// replace the oldest slot, its image lists are no longer used by the destroyed toolbar
+	ToolbarImageCache *cache = &toolbarImageCache[toolbarImageCacheNext];
+	toolbarImageCacheNext = (toolbarImageCacheNext + 1) % TOOLBAR_IMAGE_CACHE_SIZE;
+	if (cache->himlNormal != NULL) {
+		ImageList_Destroy(cache->himlNormal);
+	}
+	if (cache->himlHot != NULL) {
+		ImageList_Destroy(cache->himlHot);
+	}
+	if (cache->himlDisabled != NULL) {
+		ImageList_Destroy(cache->himlDisabled);
+	}
+	ZeroMemory(cache, sizeof(ToolbarImageCache));
+	cache->dpi = dpi;
+	cache->crFace = crFace;
+	LoadToolbarImages(hInstance, cache);
+	return cache;
+}
+
+//=============================================================================
+//
+// CreateBars() - Create Toolbar and Statusbar
+//
+//
+void CreateBars(HWND hwnd, HINSTANCE hInstance) {
+	const BOOL bIsAppThemed = IsAppThemed();
+
+	const DWORD dwToolbarStyle = WS_TOOLBAR;
+	hwndToolbar = CreateWindowEx(0, TOOLBARCLASSNAME, NULL, dwToolbarStyle,
+								 0, 0, 0, 0, hwnd, (HMENU)IDC_TOOLBAR, hInstance, NULL);
+
+	SendMessage(hwndToolbar, TB_BUTTONSTRUCTSIZE, (WPARAM)sizeof(TBBUTTON), 0);
+
+	const ToolbarImageCache *images = GetToolbarImages(hInstance);
+	SendMessage(hwndToolbar, TB_SETIMAGELIST, 0, (LPARAM)images->himlNormal);
+	if (images->himlHot != NULL) {
+		SendMessage(hwndToolbar, TB_SETHOTIMAGELIST, 0, (LPARAM)images->himlHot);
+	}
+	if (images->himlDisabled != NULL) {
+		SendMessage(hwndToolbar, TB_SETDISABLEDIMAGELIST, 0, (LPARAM)images->himlDisabled);
+	}
 
 #if NP2_ENABLE_CUSTOMIZE_TOOLBAR_LABELS
 	// Load toolbar labels
@@ -1936,6 +2314,8 @@ void CreateBars(HWND hwnd, HINSTANCE hInstance) {
 	//SendMessage(hwndToolbar, TB_SETINDENT, 2, 0);
 
 	GetString(IDS_DOCPOS, cachedStatusItem.tchDocPosFmt, COUNTOF(cachedStatusItem.tchDocPosFmt));
+	GetString(IDS_HEXVIEW_DOCPOS, cachedStatusItem.tchHexPosFmt, COUNTOF(cachedStatusItem.tchHexPosFmt));
+	GetString(IDS_LARGEFILE_DOCSIZE, cachedStatusItem.tchLargeFileFmt, COUNTOF(cachedStatusItem.tchLargeFileFmt));
 	const DWORD dwStatusbarStyle = bShowStatusbar ? (WS_CHILD | WS_CLIPSIBLINGS | WS_VISIBLE) : (WS_CHILD | WS_CLIPSIBLINGS);
 	hwndStatus = CreateStatusWindow(dwStatusbarStyle, NULL, hwnd, IDC_STATUSBAR);
 
@@ -1975,6 +2355,7 @@ void CreateBars(HWND hwnd, HINSTANCE hInstance) {
 
 void RecreateBars(HWND hwnd, HINSTANCE hInstance) {
 	cachedStatusItem.updateMask = UINT_MAX;
+	cachedToolbarState.valid = FALSE;
 	Toolbar_GetButtons(hwndToolbar, TOOLBAR_COMMAND_BASE, tchToolbarButtons, COUNTOF(tchToolbarButtons));
 
 	DestroyWindow(hwndToolbar);
@@ -2000,6 +2381,7 @@ void MsgDPIChanged(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	UpdateStatusBarWidth();
 	Style_OnDPIChanged(pLexCurrent);
 	SendMessage(hwndEdit, WM_DPICHANGED, wParam, lParam);
+	HexView_OnDPIChanged();
 	UpdateLineNumberWidth();
 	UpdateBookmarkMarginWidth();
 	UpdateFoldMarginWidth();
@@ -2047,6 +2429,7 @@ static void OnStyleThemeChanged(int theme) {
 void MsgSize(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	UNREFERENCED_PARAMETER(hwnd);
 
+	SuspendPollingTimers(wParam == SIZE_MINIMIZED);
 	if (wParam == SIZE_MINIMIZED) {
 		return;
 	}
@@ -2084,15 +2467,31 @@ void MsgSize(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		cy -= (rc.bottom - rc.top);
 	}
 
-	HDWP hdwp = BeginDeferWindowPos(2);
+	// document map is placed at right side inside the edit frame
+	const BOOL bMiniMap = bShowMiniMap && !HexView_IsActive();
+	const BOOL bMiniMapShown = (GetWindowStyle(hwndMiniMap) & WS_VISIBLE) != 0;
+	const int cxClient = cx - 2 * cxEditFrame;
+	const int cxMiniMap = bMiniMap ? min_i(cxClient / 2, MulDiv(NP2_MINIMAP_WIDTH, g_uCurrentDPI, USER_DEFAULT_SCREEN_DPI)) : 0;
+
+	HDWP hdwp = BeginDeferWindowPos(4);
 
 	DeferWindowPos(hdwp, hwndEditFrame, NULL, x, y, cx, cy, SWP_NOZORDER | SWP_NOACTIVATE);
 
 	DeferWindowPos(hdwp, hwndEdit, NULL, x + cxEditFrame, y + cyEditFrame,
-				   cx - 2 * cxEditFrame, cy - 2 * cyEditFrame, SWP_NOZORDER | SWP_NOACTIVATE);
+				   cxClient - cxMiniMap, cy - 2 * cyEditFrame, SWP_NOZORDER | SWP_NOACTIVATE);
+
+	DeferWindowPos(hdwp, hwndMiniMap, NULL, x + cxEditFrame + cxClient - cxMiniMap, y + cyEditFrame,
+				   cxMiniMap, cy - 2 * cyEditFrame, SWP_NOZORDER | SWP_NOACTIVATE | (bMiniMap ? SWP_SHOWWINDOW : SWP_HIDEWINDOW));
+
+	DeferWindowPos(hdwp, hwndHexView, NULL, x + cxEditFrame, y + cyEditFrame,
+				   cxClient, cy - 2 * cyEditFrame, SWP_NOZORDER | SWP_NOACTIVATE);
 
 	EndDeferWindowPos(hdwp);
 
+	if (bMiniMap && !bMiniMapShown) {
+		MiniMap_Reset();
+	}
+
 	// Statusbar width
 	UpdateStatusBarWidth();
 }
@@ -2139,8 +2538,13 @@ void UpdateStatusBarWidth(void) {
 	aWidth[3] = StatusCalcPaneWidth(hwndStatus, L"CR+LF");
 	aWidth[4] = StatusCalcPaneWidth(hwndStatus, L"OVR");
 	aWidth[5] = StatusCalcPaneWidth(hwndStatus, L"500%");
-	aWidth[6] = StatusCalcPaneWidth(hwndStatus, ((iBytes < 1024)? L"1,023 Bytes" : L"99.9 MiB"))
-		+ SystemMetricsForDpi(SM_CXHTHUMB, g_uCurrentDPI);
+	LPCWSTR pszDocSize = (iBytes < 1024)? L"1,023 Bytes" : L"99.9 MiB";
+	WCHAR tchDocSize[64];
+	if (bLargeFileProfile) {
+		wsprintf(tchDocSize, cachedStatusItem.tchLargeFileFmt, pszDocSize);
+		pszDocSize = tchDocSize;
+	}
+	aWidth[6] = StatusCalcPaneWidth(hwndStatus, pszDocSize) + SystemMetricsForDpi(SM_CXHTHUMB, g_uCurrentDPI);
 
 	aWidth[0] = max_i(120, cx - (aWidth[1] + aWidth[2] + aWidth[3] + aWidth[4] + aWidth[5] + aWidth[6]));
 	aWidth[1] += aWidth[0];
@@ -2259,6 +2663,9 @@ void MsgNotifyZoom(void) {
 
 	UpdateStatusBarCache(STATUS_DOCZOOM);
 	Style_OnDPIChanged(pLexCurrent);
+	CsvView_OnStyleChanged();
+	Compare_OnStyleChanged();
+	MarkTerms_OnStyleChanged();
 	UpdateLineNumberWidth();
 	UpdateBookmarkMarginWidth();
 	UpdateFoldMarginWidth();
@@ -2291,7 +2698,12 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	EnableCmd(hmenu, IDM_FILE_LAUNCH, i);
 	EnableCmd(hmenu, IDM_FILE_PROPERTIES, i);
 	EnableCmd(hmenu, IDM_FILE_CREATELINK, i);
+	EnableCmd(hmenu, IDM_FILE_STATISTICS, !HexView_IsActive());
 	EnableCmd(hmenu, IDM_FILE_ADDTOFAV, i);
+	EnableCmd(hmenu, IDM_FILE_COMPARE_SAVED, i);
+	EnableCmd(hmenu, IDM_FILE_COMPARE_NEXT, Compare_IsActive());
+	EnableCmd(hmenu, IDM_FILE_COMPARE_PREV, Compare_IsActive());
+	EnableCmd(hmenu, IDM_FILE_COMPARE_CLEAR, Compare_IsActive());
 
 	EnableCmd(hmenu, IDM_FILE_RELAUNCH_ELEVATED, IsVistaAndAbove() && !fIsElevated);
 	EnableCmd(hmenu, IDM_FILE_OPEN_CONTAINING_FOLDER, i);
@@ -2356,6 +2768,10 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	EnableCmd(hmenu, IDM_EDIT_DELETE, nonEmpty /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_CLEARDOCUMENT, nonEmpty /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_COPYRTF, i /*&& !bReadOnly*/);
+	EnableCmd(hmenu, IDM_EDIT_CSV_COPY_COLUMN, CsvView_IsEnabled());
+	EnableCmd(hmenu, IDM_EDIT_CSV_SELECT_COLUMN, CsvView_IsEnabled());
+	EnableCmd(hmenu, IDM_EDIT_CSV_NEXT_FIELD, CsvView_IsEnabled());
+	EnableCmd(hmenu, IDM_EDIT_CSV_PREV_FIELD, CsvView_IsEnabled());
 
 	OpenClipboard(hwnd);
 	EnableCmd(hmenu, IDM_EDIT_CLEARCLIPBOARD, CountClipboardFormats());
@@ -2422,6 +2838,8 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 	EnableCmd(hmenu, IDM_EDIT_XHTML_ESCAPE_CHAR, i /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_XHTML_UNESCAPE_CHAR, i /*&& !bReadOnly*/);
+	EnableCmd(hmenu, IDM_EDIT_FORMAT_JSON, i /*&& !bReadOnly*/);
+	EnableCmd(hmenu, IDM_EDIT_MINIFY_JSON, i /*&& !bReadOnly*/);
 
 	EnableCmd(hmenu, IDM_EDIT_ESCAPECCHARS, i /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_UNESCAPECCHARS, i /*&& !bReadOnly*/);
@@ -2430,6 +2848,11 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	EnableCmd(hmenu, IDM_EDIT_HEX2CHAR, i /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_SHOW_HEX, i /*&& !bReadOnly*/);
 
+	CheckCmd(hmenu, IDM_EDIT_MACRO_RECORD, Macro_IsRecording());
+	EnableCmd(hmenu, IDM_EDIT_MACRO_RECORD, !Macro_IsReplaying());
+	EnableCmd(hmenu, IDM_EDIT_MACRO_PLAY, Macro_CanPlay() && !bReadOnly);
+	EnableCmd(hmenu, IDM_EDIT_MACRO_REPLAY_TIMING, Macro_CanPlay() && !bReadOnly);
+
 	EnableCmd(hmenu, IDM_EDIT_NUM2HEX, i /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_NUM2DEC, i /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_NUM2BIN, i /*&& !bReadOnly*/);
@@ -2457,9 +2880,12 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	EnableCmd(hmenu, IDM_EDIT_FINDPREV, i && StrNotEmptyA(efrData.szFind));
 	EnableCmd(hmenu, IDM_EDIT_REPLACE, i /*&& !bReadOnly*/);
 	EnableCmd(hmenu, IDM_EDIT_REPLACENEXT, i);
+	EnableCmd(hmenu, IDM_EDIT_MARKTERMS, i);
+	EnableCmd(hmenu, IDM_EDIT_MARKTERMS_CLEAR, MarkTerms_IsActive());
 	EnableCmd(hmenu, IDM_EDIT_SELECTWORD, i);
 	EnableCmd(hmenu, IDM_EDIT_SELECTLINE, i);
 	EnableCmd(hmenu, IDM_EDIT_SELECTLINE_BLOCK, i);
+	EnableCmd(hmenu, IDM_EDIT_SELECTTAGCONTENTS, i && (pLexCurrent->iLexer == SCLEX_HTML || pLexCurrent->iLexer == SCLEX_XML));
 	EnableCmd(hmenu, IDM_EDIT_SELTODOCEND, i);
 	EnableCmd(hmenu, IDM_EDIT_SELTODOCSTART, i);
 	EnableCmd(hmenu, IDM_EDIT_SELTONEXT, i && StrNotEmptyA(efrData.szFind));
@@ -2507,6 +2933,10 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	CheckMenuRadioItem(hmenu, IDM_VIEW_STYLE_THEME_DEFAULT, IDM_VIEW_STYLE_THEME_DARK, i, MF_BYCOMMAND);
 
 	CheckCmd(hmenu, IDM_VIEW_WORDWRAP, fvCurFile.fWordWrap);
+	EnableCmd(hmenu, IDM_VIEW_HEXVIEW, StrNotEmpty(szCurFile));
+	CheckCmd(hmenu, IDM_VIEW_HEXVIEW, HexView_IsActive());
+	CheckCmd(hmenu, IDM_VIEW_MINIMAP, bShowMiniMap);
+	CheckCmd(hmenu, IDM_VIEW_CSV_COLUMNS, CsvView_IsEnabled());
 	i = IDM_VIEW_FONTQUALITY_DEFAULT + iFontQuality;
 	CheckMenuRadioItem(hmenu, IDM_VIEW_FONTQUALITY_DEFAULT, IDM_VIEW_FONTQUALITY_CLEARTYPE, i, MF_BYCOMMAND);
 	CheckCmd(hmenu, IDM_VIEW_CARET_STYLE_BLOCK_OVR, iOvrCaretStyle);
@@ -2678,6 +3108,13 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		FileLoad(FALSE, FALSE, FALSE, FALSE, L"");
 		break;
 
+	case IDM_FILE_OPENRANGE: {
+		WCHAR tchFile[MAX_PATH];
+		if (OpenFileDlg(hwnd, tchFile, COUNTOF(tchFile), NULL) && EditOpenRangeDlg(hwnd, &rangeArg)) {
+			FileLoadRange(FALSE, tchFile, &rangeArg);
+		}
+	} break;
+
 	case IDM_FILE_REVERT:
 		if (StrNotEmpty(szCurFile)) {
 			if (IsDocumentModified() && MsgBoxWarn(MB_OKCANCEL, IDS_ASK_REVERT) != IDOK) {
@@ -2701,6 +3138,48 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		FileSave(TRUE, FALSE, TRUE, TRUE);
 		break;
 
+	case IDM_FILE_COMPARE_FILE:
+	case IDM_FILE_COMPARE_SAVED: {
+		WCHAR tchFile[MAX_PATH];
+		if (LOWORD(wParam) == IDM_FILE_COMPARE_SAVED) {
+			if (StrIsEmpty(szCurFile)) {
+				break;
+			}
+			lstrcpy(tchFile, szCurFile);
+		} else {
+			const BOOL selected = OpenFileDlg(hwnd, tchFile, COUNTOF(tchFile), NULL);
+			// lexer selected in the dialog is not for current document
+			flagLexerSpecified = 0;
+			iInitialLexer = 0;
+			if (!selected) {
+				break;
+			}
+		}
+		BeginWaitCursor();
+		const BOOL success = Compare_WithFile(tchFile);
+		EndWaitCursor();
+		if (!success) {
+			MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, tchFile);
+		}
+	} break;
+
+	case IDM_FILE_COMPARE_NEXT:
+	case IDM_FILE_COMPARE_PREV: {
+		const Sci_Line iLine = Compare_FindDifference(LOWORD(wParam) == IDM_FILE_COMPARE_NEXT);
+		if (iLine >= 0) {
+			editMarkAllStatus.ignoreSelectionUpdate = TRUE;
+			SciCall_EnsureVisible(iLine);
+			SciCall_GotoLine(iLine);
+			SciCall_SetYCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 10);
+			SciCall_ScrollCaret();
+			SciCall_SetYCaretPolicy(CARET_EVEN, 0);
+		}
+	} break;
+
+	case IDM_FILE_COMPARE_CLEAR:
+		Compare_Clear();
+		break;
+
 	case IDM_FILE_READONLY:
 		if (StrNotEmpty(szCurFile)) {
 			DWORD dwFileAttributes = GetFileAttributes(szCurFile);
@@ -2725,7 +3204,11 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 	case IDM_FILE_LOCK_EDITING:
 		bLockedForEditing = !bLockedForEditing;
-		SciCall_SetReadOnly(bLockedForEditing);
+		if (HexView_IsActive()) {
+			HexView_SetReadOnly(bLockedForEditing);
+		} else {
+			SciCall_SetReadOnly(bLockedForEditing);
+		}
 		UpdateWindowTitle();
 		break;
 
@@ -2869,6 +3352,10 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	}
 	break;
 
+	case IDM_FILE_STATISTICS:
+		DocStats_Show();
+		break;
+
 	case IDM_FILE_CREATELINK: {
 		if (StrIsEmpty(szCurFile)) {
 			break;
@@ -3106,6 +3593,35 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		UpdateToolbar();
 		break;
 
+	case IDM_EDIT_COPYRTF:
+		if (flagPasteBoard) {
+			bLastCopyFromMe = TRUE;
+		}
+		Exporter_CopySelection(hwnd);
+		UpdateToolbar();
+		break;
+
+	case IDM_EDIT_CSV_COPY_COLUMN:
+		if (flagPasteBoard) {
+			bLastCopyFromMe = TRUE;
+		}
+		BeginWaitCursor();
+		CsvView_CopyColumn(hwnd);
+		EndWaitCursor();
+		UpdateToolbar();
+		break;
+
+	case IDM_EDIT_CSV_SELECT_COLUMN:
+		BeginWaitCursor();
+		CsvView_SelectColumn();
+		EndWaitCursor();
+		break;
+
+	case IDM_EDIT_CSV_NEXT_FIELD:
+	case IDM_EDIT_CSV_PREV_FIELD:
+		CsvView_GotoField(LOWORD(wParam) == IDM_EDIT_CSV_NEXT_FIELD);
+		break;
+
 	case IDM_EDIT_PASTE:
 	//case IDM_EDIT_PASTE_BINARY:
 		SciCall_Paste(LOWORD(wParam) == IDM_EDIT_PASTE_BINARY);
@@ -3173,6 +3689,10 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		EditSelectLines(LOWORD(wParam) == IDM_EDIT_SELECTLINE_BLOCK, bEnableLineSelectionMode);
 		break;
 
+	case IDM_EDIT_SELECTTAGCONTENTS:
+		EditSelectTagContents();
+		break;
+
 	case IDM_EDIT_MOVELINEUP:
 		EditMoveUp();
 		break;
@@ -3254,7 +3774,7 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 	case IDM_EDIT_PADWITHSPACES:
 		BeginWaitCursor();
-		EditPadWithSpaces(FALSE, FALSE);
+		EditPadWithSpaces(FALSE);
 		EndWaitCursor();
 		break;
 
@@ -3272,13 +3792,13 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 	case IDM_EDIT_TRIMLINES:
 		BeginWaitCursor();
-		EditStripTrailingBlanks(hwndEdit, FALSE);
+		EditStripTrailingBlanks(FALSE);
 		EndWaitCursor();
 		break;
 
 	case IDM_EDIT_TRIMLEAD:
 		BeginWaitCursor();
-		EditStripLeadingBlanks(hwndEdit, FALSE);
+		EditStripLeadingBlanks(FALSE);
 		EndWaitCursor();
 		break;
 
@@ -3300,6 +3820,13 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		EndWaitCursor();
 		break;
 
+	case IDM_EDIT_REMOVEDUPLICATELINES:
+	case IDM_EDIT_REMOVEDUPLICATELINES_NOCASE:
+		BeginWaitCursor();
+		EditRemoveDuplicateLines(LOWORD(wParam) == IDM_EDIT_REMOVEDUPLICATELINES_NOCASE);
+		EndWaitCursor();
+		break;
+
 	case IDM_EDIT_MODIFYLINES:
 		EditModifyLinesDlg(hwnd);
 		break;
@@ -3624,25 +4151,32 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 	case IDM_EDIT_ESCAPECCHARS:
 		BeginWaitCursor();
-		EditEscapeCChars(hwndEdit);
+		EditEscapeCChars();
 		EndWaitCursor();
 		break;
 
 	case IDM_EDIT_UNESCAPECCHARS:
 		BeginWaitCursor();
-		EditUnescapeCChars(hwndEdit);
+		EditUnescapeCChars();
 		EndWaitCursor();
 		break;
 
 	case IDM_EDIT_XHTML_ESCAPE_CHAR:
 		BeginWaitCursor();
-		EditEscapeXHTMLChars(hwndEdit);
+		EditEscapeXHTMLChars();
 		EndWaitCursor();
 		break;
 
 	case IDM_EDIT_XHTML_UNESCAPE_CHAR:
 		BeginWaitCursor();
-		EditUnescapeXHTMLChars(hwndEdit);
+		EditUnescapeXHTMLChars();
+		EndWaitCursor();
+		break;
+
+	case IDM_EDIT_FORMAT_JSON:
+	case IDM_EDIT_MINIFY_JSON:
+		BeginWaitCursor();
+		EditFormatJSON(LOWORD(wParam) == IDM_EDIT_MINIFY_JSON);
 		EndWaitCursor();
 		break;
 
@@ -3664,6 +4198,28 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		EndWaitCursor();
 		break;
 
+	case IDM_EDIT_MACRO_RECORD:
+		if (Macro_IsRecording()) {
+			Macro_StopRecord();
+		} else {
+			Macro_StartRecord();
+		}
+		break;
+
+	case IDM_EDIT_MACRO_PLAY:
+		if (!bReadOnly) {
+			BeginWaitCursor();
+			Macro_Play();
+			EndWaitCursor();
+		}
+		break;
+
+	case IDM_EDIT_MACRO_REPLAY_TIMING:
+		if (!bReadOnly) {
+			Macro_ReplayTimed(hwnd);
+		}
+		break;
+
 	case IDM_EDIT_NUM2HEX:
 		BeginWaitCursor();
 		EditConvertNumRadix(16);
@@ -3694,6 +4250,9 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		int ch = SciCall_GetCharAt(iPos);
 		if (IsBraceMatchChar(ch)) {
 			iBrace2 = SciCall_BraceMatch(iPos);
+		} else if ((iBrace2 = EditFindMatchingTag(iPos, &iPos)) >= 0) {
+			// keep caret inside the tag
+			iBrace2 += 1;
 		} else { // Try one before
 			iPos = SciCall_PositionBefore(iPos);
 			ch = SciCall_GetCharAt(iPos);
@@ -3713,6 +4272,14 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		int ch = SciCall_GetCharAt(iPos);
 		if (IsBraceMatchChar(ch)) {
 			iBrace2 = SciCall_BraceMatch(iPos);
+		} else if ((iBrace2 = EditFindMatchingTag(iPos, &iPos)) >= 0) {
+			// select the element with both tags
+			if (iBrace2 > iPos) {
+				SciCall_SetSel(iPos, SciCall_FindTag(iBrace2, SC_TAGFIND_END));
+			} else {
+				SciCall_SetSel(SciCall_FindTag(iPos, SC_TAGFIND_END), iBrace2);
+			}
+			break;
 		} else { // Try one before
 			iPos = SciCall_PositionBefore(iPos);
 			ch = SciCall_GetCharAt(iPos);
@@ -3802,6 +4369,24 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	}
 	break;
 
+	case IDM_EDIT_FINDINFILES:
+		if (!IsWindow(hDlgFindInFiles)) {
+			hDlgFindInFiles = EditFindInFilesDlg(hwndEdit, &efrData);
+		} else {
+			SetForegroundWindow(hDlgFindInFiles);
+		}
+		break;
+
+	case IDM_EDIT_MARKTERMS:
+		if (SciCall_GetLength() != 0) {
+			MarkTerms_ShowDialog(hwnd);
+		}
+		break;
+
+	case IDM_EDIT_MARKTERMS_CLEAR:
+		MarkTerms_Clear();
+		break;
+
 	case IDM_EDIT_FINDNEXT:
 	case IDM_EDIT_FINDPREV:
 	case IDM_EDIT_REPLACENEXT:
@@ -3927,6 +4512,18 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		Style_SetDefaultFont(hwndEdit, LOWORD(wParam) == IDM_VIEW_DEFAULT_CODE_FONT);
 		break;
 
+	case IDM_VIEW_HEXVIEW:
+		if (FileSave(FALSE, TRUE, FALSE, FALSE)) {
+			if (HexView_IsActive()) {
+				bSkipHexView = TRUE;
+				FileLoad(TRUE, FALSE, TRUE, FALSE, szCurFile);
+				bSkipHexView = FALSE;
+			} else if (StrNotEmpty(szCurFile) && !FileLoadHexView(szCurFile, bLockedForEditing)) {
+				MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, szCurFile);
+			}
+		}
+		break;
+
 	case IDM_VIEW_WORDWRAP:
 		fWordWrapG = fvCurFile.fWordWrap = !fvCurFile.fWordWrap;
 		SciCall_SetWrapMode(fvCurFile.fWordWrap ? iWordWrapMode : SC_WRAP_NONE);
@@ -4188,6 +4785,15 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		}
 		break;
 
+	case IDM_VIEW_MINIMAP:
+		bShowMiniMap = !bShowMiniMap;
+		SendWMSize(hwnd);
+		break;
+
+	case IDM_VIEW_CSV_COLUMNS:
+		CsvView_Enable(hwnd, !CsvView_IsEnabled());
+		break;
+
 	case IDM_VIEW_STATUSBAR:
 		bShowStatusbar = !bShowStatusbar;
 		if (bShowStatusbar) {
@@ -4904,8 +5510,9 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	case IDC_EDIT:
 		switch (pnmh->code) {
 		case SCN_UPDATEUI:
+			MiniMap_OnUpdateUI(scn->updated);
 			if (scn->updated & ~(SC_UPDATE_V_SCROLL | SC_UPDATE_H_SCROLL)) {
-				UpdateToolbar();
+				UINT pending = PendingUIUpdate_Toolbar;
 
 				BOOL updated = FALSE;
 				if (scn->updated & (SC_UPDATE_SELECTION)) {
@@ -4913,7 +5520,7 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 					// mark occurrences of text currently selected
 					if (editMarkAllStatus.ignoreSelectionUpdate) {
 						editMarkAllStatus.ignoreSelectionUpdate = FALSE;
-					} else if (bMarkOccurrences) {
+					} else if (bMarkOccurrences && !bLargeFileProfile) {
 						if (SciCall_IsSelectionEmpty()) {
 							if (editMarkAllStatus.matchCount) {
 								EditMarkAll_Clear();
@@ -4928,34 +5535,53 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 					}
 				}
 				if (!updated) {
-					UpdateStatusbar();
+					pending |= PendingUIUpdate_Statusbar;
 				}
+				if (pendingUIUpdate == 0) {
+					SetTimer(hwnd, ID_UPDATEUITIMER, NP2_UPDATEUI_DELAY, UpdateUITimerProc);
+				}
+				pendingUIUpdate |= pending;
 
 				// Brace Match
 				if (bMatchBraces) {
+					// large file profile doesn't search distant matching brace
+					const Sci_Position maxDistance = bLargeFileProfile ? NP2_LARGE_FILE_BRACE_DISTANCE : 0;
 					Sci_Position iPos = SciCall_GetCurrentPos();
 					int ch = SciCall_GetCharAt(iPos);
+					Sci_Position iTag2;
 					if (IsBraceMatchChar(ch)) {
-						const Sci_Position iBrace2 = SciCall_BraceMatch(iPos);
+						const Sci_Position iBrace2 = SciCall_BraceMatchWithin(iPos, maxDistance);
 						if (iBrace2 >= 0) {
 							const Sci_Position col1 = SciCall_GetColumn(iPos);
 							const Sci_Position col2 = SciCall_GetColumn(iBrace2);
 							SciCall_BraceHighlight(iPos, iBrace2);
 							SciCall_SetHighlightGuide(min_pos(col1, col2));
+						} else if (maxDistance) {
+							SciCall_BraceHighlight(INVALID_POSITION, INVALID_POSITION);
+							SciCall_SetHighlightGuide(0);
 						} else {
 							SciCall_BraceBadLight(iPos);
 							SciCall_SetHighlightGuide(0);
 						}
+					} else if ((iTag2 = EditFindMatchingTag(iPos, &iPos)) >= 0) {
+						// caret inside start or end tag, highlight '<' of both tags
+						const Sci_Position col1 = SciCall_GetColumn(iPos);
+						const Sci_Position col2 = SciCall_GetColumn(iTag2);
+						SciCall_BraceHighlight(iPos, iTag2);
+						SciCall_SetHighlightGuide(min_pos(col1, col2));
 					} else { // Try one before
 						iPos = SciCall_PositionBefore(iPos);
 						ch = SciCall_GetCharAt(iPos);
 						if (IsBraceMatchChar(ch)) {
-							const Sci_Position iBrace2 = SciCall_BraceMatch(iPos);
+							const Sci_Position iBrace2 = SciCall_BraceMatchWithin(iPos, maxDistance);
 							if (iBrace2 >= 0) {
 								const Sci_Position col1 = SciCall_GetColumn(iPos);
 								const Sci_Position col2 = SciCall_GetColumn(iBrace2);
 								SciCall_BraceHighlight(iPos, iBrace2);
 								SciCall_SetHighlightGuide(min_pos(col1, col2));
+							} else if (maxDistance) {
+								SciCall_BraceHighlight(INVALID_POSITION, INVALID_POSITION);
+								SciCall_SetHighlightGuide(0);
 							} else {
 								SciCall_BraceBadLight(iPos);
 								SciCall_SetHighlightGuide(0);
@@ -4992,6 +5618,12 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 					}
 					return 0;
 				}
+				// Auto close end tag of innermost open element
+				if (ch == '/' && autoCompletionConfig.bCloseTags
+					&& (pLexCurrent->iLexer == SCLEX_HTML || pLexCurrent->iLexer == SCLEX_XML)
+					&& EditAutoCloseEndTag()) {
+					return 0;
+				}
 				// Auto close braces/quotes
 				if (ch == '(' || ch == '[' || ch == '{' || ch == '<' || ch == '\"' || ch == '\'' || ch == '`' || ch == ',') {
 					if (autoCompletionConfig.fAutoInsertMask) {
@@ -5108,6 +5740,19 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 			if (scn->linesAdded) {
 				UpdateLineNumberWidth();
 			}
+			if (scn->modificationType & SC_MOD_BULKMODIFICATION) {
+				EditOnBulkModified(scn->position, scn->length, scn->linesAdded);
+			} else {
+				if (editMarkAllStatus.indexCapacity >= 0) {
+					EditMarkAll_OnModified(&editMarkAllStatus, (scn->modificationType & SC_MOD_INSERTTEXT), scn->position, scn->length);
+				}
+				AutoC_OnDocumentModified((scn->modificationType & SC_MOD_INSERTTEXT), scn->position, scn->length, scn->text, scn->linesAdded);
+				DocStats_OnModified((scn->modificationType & SC_MOD_INSERTTEXT), scn->position, scn->length);
+			}
+			AutoSave_OnModified(scn->position);
+			MiniMap_OnModified(scn->position, scn->linesAdded);
+			CsvView_OnModified(scn->position, (scn->modificationType & SC_MOD_INSERTTEXT) ? scn->length : 0, scn->linesAdded);
+			EditPrintInvalidatePages(scn->position);
 			break;
 
 		case SCN_ZOOM:
@@ -5116,6 +5761,7 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 
 		case SCN_SAVEPOINTREACHED:
 			bModified = FALSE;
+			AutoSave_Discard();
 			UpdateDocumentModificationStatus();
 			break;
 
@@ -5137,6 +5783,10 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 			}
 			break;
 
+		case SCN_MACRORECORD:
+			Macro_OnRecord(scn->message, scn->wParam, scn->lParam);
+			break;
+
 		case SCN_SAVEPOINTLEFT:
 			bModified = TRUE;
 			UpdateDocumentModificationStatus();
@@ -5153,12 +5803,23 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		case SCN_CODEPAGECHANGED:
 			EditOnCodePageChanged(scn->oldCodePage);
 			break;
+
+		case SCN_STYLINGDEGRADED: {
+			WCHAR tchLexerName[MAX_EDITLEXER_NAME_SIZE];
+			LPCWSTR pszLexerName = Style_GetCurrentLexerName(tchLexerName, COUNTOF(tchLexerName));
+			DebugPrintf("lexer %ls exceeded style budget at position %" PRId64 ", line %" PRId64 "\n",
+				pszLexerName, (int64_t)scn->position, (int64_t)scn->line + 1);
+			ShowNotificationMessage(SC_NOTIFICATIONPOSITION_BOTTOMRIGHT, IDS_STYLING_DEGRADED, pszLexerName, (int)(scn->line + 1));
+		}
+		break;
 		}
 		break;
 
 	case IDC_TOOLBAR:
 		switch (pnmh->code) {
 		case TBN_ENDADJUST:
+			// inserted buttons have default state
+			cachedToolbarState.valid = FALSE;
 			UpdateToolbar();
 			break;
 
@@ -5200,6 +5861,19 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		}
 		break;
 
+	case IDC_HEXVIEW:
+		switch (pnmh->code) {
+		case HVN_CARETMOVED:
+			UpdateStatusbar();
+			break;
+
+		case HVN_SAVEPOINT:
+			UpdateDocumentModificationStatus();
+			UpdateStatusbar();
+			break;
+		}
+		break;
+
 	case IDC_STATUSBAR:
 		switch (pnmh->code) {
 		case NM_CLICK: {
@@ -5213,6 +5887,18 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 				ZoomLevelDlg(hwnd, TRUE);
 				return TRUE;
 
+			case STATUS_DOCSIZE:
+				// override large file profile for current document
+				bLargeFileProfile = !bLargeFileProfile;
+				if (bLargeFileProfile) {
+					EditMarkAll_Clear();
+				}
+				EditApplyLargeFileProfile();
+				UpdateStatusBarWidth();
+				cachedStatusItem.updateMask |= StatusBarUpdateMask_DocPos;
+				UpdateStatusbar();
+				return TRUE;
+
 			default:
 				return FALSE;
 			}
@@ -5299,6 +5985,7 @@ void LoadSettings(void) {
 	IniSectionInit(pIniSection, 128);
 
 	LoadIniSection(INI_SECTION_NAME_SETTINGS, pIniSectionBuf, cchIniSection);
+	hashSettingsSection = IniSectionHash(INI_SECTION_NAME_SETTINGS, pIniSectionBuf);
 	IniSectionParse(pIniSection, pIniSectionBuf);
 
 	//const int iSettingsVersion = IniSectionGetInt(pIniSection, L"SettingsVersion", NP2SettingsVersion_Current);
@@ -5312,6 +5999,8 @@ void LoadSettings(void) {
 	efrData.bFindClose = IniSectionGetBool(pIniSection, L"CloseFind", 0);
 	efrData.bReplaceClose = IniSectionGetBool(pIniSection, L"CloseReplace", 0);
 	efrData.bNoFindWrap = IniSectionGetBool(pIniSection, L"NoFindWrap", 0);
+	IniSectionGetString(pIniSection, L"FindInFilesFilter", L"*.*", tchFindInFilesFilter, COUNTOF(tchFindInFilesFilter));
+	bFindInFilesSubfolders = IniSectionGetBool(pIniSection, L"FindInFilesSubfolders", 1);
 
 	if (bSaveFindReplace) {
 		efrData.fuFlags = 0;
@@ -5395,6 +6084,7 @@ void LoadSettings(void) {
 	autoCompletionConfig.dwScanWordsTimeout = max_i(iValue, AUTOC_SCAN_WORDS_MIN_TIMEOUT);
 	autoCompletionConfig.bEnglistIMEModeOnly = IniSectionGetBool(pIniSection, L"AutoCEnglishIMEModeOnly", 0);
 	autoCompletionConfig.bIgnoreCase = IniSectionGetBool(pIniSection, L"AutoCIgnoreCase", 0);
+	autoCompletionConfig.bFuzzyMatch = IniSectionGetBool(pIniSection, L"AutoCFuzzyMatch", 0);
 	autoCompletionConfig.bLaTeXInputMethod = IniSectionGetBool(pIniSection, L"LaTeXInputMethod", 0);
 	iValue = IniSectionGetInt(pIniSection, L"AutoCVisibleItemCount", 16);
 	autoCompletionConfig.iVisibleItemCount = max_i(iValue, MIN_AUTO_COMPLETION_VISIBLE_ITEM_COUNT);
@@ -5548,6 +6238,7 @@ void LoadSettings(void) {
 	bShowToolbar = IniSectionGetBool(pIniSection, L"ShowToolbar", 1);
 	bAutoScaleToolbar = IniSectionGetBool(pIniSection, L"AutoScaleToolbar", 1);
 	bShowStatusbar = IniSectionGetBool(pIniSection, L"ShowStatusbar", 1);
+	bShowMiniMap = IniSectionGetBool(pIniSection, L"ShowMiniMap", 0);
 
 	iValue = IniSectionGetInt(pIniSection, L"FullScreenMode", FullScreenMode_Default);
 	iFullScreenMode = iValue;
@@ -5577,6 +6268,7 @@ void LoadSettings(void) {
 		WCHAR sectionName[96];
 		GetWindowPositionSectionName(sectionName);
 		LoadIniSection(sectionName, pIniSectionBuf, cchIniSection);
+		hashWindowPositionSection = IniSectionHash(sectionName, pIniSectionBuf);
 		IniSectionParse(pIniSection, pIniSectionBuf);
 
 		// ignore window position if /p was specified
@@ -5610,6 +6302,8 @@ void LoadSettings(void) {
 		xFindReplaceDlg = IniSectionGetInt(pIniSection, L"FindReplaceDlgPosX", 0);
 		yFindReplaceDlg = IniSectionGetInt(pIniSection, L"FindReplaceDlgPosY", 0);
 		cxFindReplaceDlg = IniSectionGetInt(pIniSection, L"FindReplaceDlgSizeX", 0);
+		cxFindInFilesDlg = IniSectionGetInt(pIniSection, L"FindInFilesDlgSizeX", 0);
+		cyFindInFilesDlg = IniSectionGetInt(pIniSection, L"FindInFilesDlgSizeY", 0);
 
 		cxStyleSelectDlg = IniSectionGetInt(pIniSection, L"StyleSelectDlgSizeX", 0);
 		cyStyleSelectDlg = IniSectionGetInt(pIniSection, L"StyleSelectDlgSizeY", 0);
@@ -5619,6 +6313,7 @@ void LoadSettings(void) {
 
 	IniSectionFree(pIniSection);
 	NP2HeapFree(pIniSectionBuf);
+	StartupTiming_Mark("LoadSettings");
 
 	// Scintilla Styles
 	Style_Load();
@@ -5643,6 +6338,8 @@ void SaveSettingsNow(BOOL bOnlySaveStyle, BOOL bQuiet) {
 	if (!bCreateFailure) {
 		LPCWSTR section = bOnlySaveStyle ? INI_SECTION_NAME_STYLES : INI_SECTION_NAME_SETTINGS;
 		if (WritePrivateProfileString(section, L"WriteTest", L"ok", szIniFile)) {
+			// remove test key, or unchanged section will not be rewritten.
+			WritePrivateProfileString(section, L"WriteTest", NULL, szIniFile);
 			BeginWaitCursor();
 			StatusSetTextID(hwndStatus, STATUS_HELP, IDS_SAVINGSETTINGS);
 			StatusSetSimple(hwndStatus, TRUE);
@@ -5701,6 +6398,8 @@ void SaveSettings(BOOL bSaveSettingsNow) {
 	IniSectionSetBoolEx(pIniSection, L"CloseFind", efrData.bFindClose, 0);
 	IniSectionSetBoolEx(pIniSection, L"CloseReplace", efrData.bReplaceClose, 0);
 	IniSectionSetBoolEx(pIniSection, L"NoFindWrap", efrData.bNoFindWrap, 0);
+	IniSectionSetStringEx(pIniSection, L"FindInFilesFilter", tchFindInFilesFilter, L"*.*");
+	IniSectionSetBoolEx(pIniSection, L"FindInFilesSubfolders", bFindInFilesSubfolders, 1);
 	IniSectionSetBoolEx(pIniSection, L"FindReplaceTransparentMode", bFindReplaceTransparentMode, 1);
 	IniSectionSetBoolEx(pIniSection, L"FindReplaceUseMonospacedFont", bFindReplaceUseMonospacedFont, 0);
 	IniSectionSetBoolEx(pIniSection, L"FindReplaceFindAllBookmark", bFindReplaceFindAllBookmark, 0);
@@ -5738,6 +6437,7 @@ void SaveSettings(BOOL bSaveSettingsNow) {
 	IniSectionSetIntEx(pIniSection, L"AutoCScanWordsTimeout", autoCompletionConfig.dwScanWordsTimeout, AUTOC_SCAN_WORDS_DEFAULT_TIMEOUT);
 	IniSectionSetBoolEx(pIniSection, L"AutoCEnglishIMEModeOnly", autoCompletionConfig.bEnglistIMEModeOnly, 0);
 	IniSectionSetBoolEx(pIniSection, L"AutoCIgnoreCase", autoCompletionConfig.bIgnoreCase, 0);
+	IniSectionSetBoolEx(pIniSection, L"AutoCFuzzyMatch", autoCompletionConfig.bFuzzyMatch, 0);
 	IniSectionSetBoolEx(pIniSection, L"LaTeXInputMethod", autoCompletionConfig.bLaTeXInputMethod, 0);
 	IniSectionSetIntEx(pIniSection, L"AutoCVisibleItemCount", autoCompletionConfig.iVisibleItemCount, 16);
 	IniSectionSetIntEx(pIniSection, L"AutoCMinWordLength", autoCompletionConfig.iMinWordLength, 1);
@@ -5813,9 +6513,10 @@ void SaveSettings(BOOL bSaveSettingsNow) {
 	IniSectionSetBoolEx(pIniSection, L"ShowToolbar", bShowToolbar, 1);
 	IniSectionSetBoolEx(pIniSection, L"AutoScaleToolbar", bAutoScaleToolbar, 1);
 	IniSectionSetBoolEx(pIniSection, L"ShowStatusbar", bShowStatusbar, 1);
+	IniSectionSetBoolEx(pIniSection, L"ShowMiniMap", bShowMiniMap, 0);
 	IniSectionSetIntEx(pIniSection, L"FullScreenMode", iFullScreenMode, FullScreenMode_Default);
 
-	SaveIniSection(INI_SECTION_NAME_SETTINGS, pIniSectionBuf);
+	SaveIniSectionIfChanged(INI_SECTION_NAME_SETTINGS, pIniSectionBuf, &hashSettingsSection);
 	if (!bStickyWindowPosition) {
 		SaveWindowPosition(bSaveSettingsNow, pIniSectionBuf);
 	}
@@ -5877,13 +6578,15 @@ void SaveWindowPosition(BOOL bSaveSettingsNow, WCHAR *pIniSectionBuf) {
 	IniSectionSetIntEx(pIniSection, L"FindReplaceDlgPosX", xFindReplaceDlg, 0);
 	IniSectionSetIntEx(pIniSection, L"FindReplaceDlgPosY", yFindReplaceDlg, 0);
 	IniSectionSetIntEx(pIniSection, L"FindReplaceDlgSizeX", cxFindReplaceDlg, 0);
+	IniSectionSetIntEx(pIniSection, L"FindInFilesDlgSizeX", cxFindInFilesDlg, 0);
+	IniSectionSetIntEx(pIniSection, L"FindInFilesDlgSizeY", cyFindInFilesDlg, 0);
 
 	IniSectionSetIntEx(pIniSection, L"StyleSelectDlgSizeX", cxStyleSelectDlg, 0);
 	IniSectionSetIntEx(pIniSection, L"StyleSelectDlgSizeY", cyStyleSelectDlg, 0);
 	IniSectionSetIntEx(pIniSection, L"StyleCustomizeDlgSizeX", cxStyleCustomizeDlg, 0);
 	IniSectionSetIntEx(pIniSection, L"StyleCustomizeDlgSizeY", cyStyleCustomizeDlg, 0);
 
-	SaveIniSection(sectionName, pIniSectionBuf);
+	SaveIniSectionIfChanged(sectionName, pIniSectionBuf, &hashWindowPositionSection);
 	NP2HeapFree(pIniSectionBuf);
 }
 
@@ -5910,6 +6613,8 @@ void ClearWindowPositionHistory(void) {
 	xFindReplaceDlg = 0;
 	yFindReplaceDlg = 0;
 	cxFindReplaceDlg = 0;
+	cxFindInFilesDlg = 0;
+	cyFindInFilesDlg = 0;
 
 	cxStyleSelectDlg = 0;
 	cyStyleSelectDlg = 0;
@@ -5949,6 +6654,20 @@ int ParseCommandLineEncoding(LPCWSTR opt, int idmLE, int idmBE) {
 	return 0;
 }
 
+// /lines=first[,last] or /bytes=start[,end]
+static int ParseCommandLineRange(LPCWSTR opt, BOOL bLines) {
+	int64_t value[2] = { 0, 0 };
+	const int itok = ParseCommaList64(opt, value, COUNTOF(value));
+	if (itok == 0 || value[0] < (bLines ? 1 : 0) || (itok == 2 && value[1] < value[0])) {
+		return 0;
+	}
+	rangeArg.bLines = bLines;
+	rangeArg.start = value[0];
+	rangeArg.end = (itok == 2) ? value[1] : 0;
+	flagRangeArg = TRUE;
+	return 1;
+}
+
 int ParseCommandLineOption(LPWSTR lp1, LPWSTR lp2, BOOL *bIsNotepadReplacement) {
 	LPWSTR opt = lp1 + 1;
 	// only accept /opt, -opt, --opt
@@ -6209,8 +6928,29 @@ int ParseCommandLineOption(LPWSTR lp1, LPWSTR lp2, BOOL *bIsNotepadReplacement)
 				lstrcpy(g_wchAppUserModelID, MY_APPUSERMODELID);
 			}
 			state = 1;
-		}
-		break;
+		} else if (StrCaseEqual(opt, L"automation") || StrHasPrefixCase(opt, L"automation=")) {
+			// pipe belongs to this window, same as /n
+			if (opt[CSTRLEN(L"automation")] == L'=') {
+				opt += CSTRLEN(L"automation=");
+				if (lpAutomationArg) {
+					LocalFree(lpAutomationArg);
+				}
+				lpAutomationArg = StrDup(opt);
+				StrTrim(lpAutomationArg, L"\" ");
+			}
+			flagAutomation = 1;
+			flagReuseWindow = 0;
+			flagNoReuseWindow = 1;
+			flagSingleFileInstance = 0;
+			state = 1;
+		}
+		break;
+
+	case L'B':
+		if (StrHasPrefixCase(opt, L"bytes=")) {
+			state = ParseCommandLineRange(opt + CSTRLEN(L"bytes="), FALSE);
+		}
+		break;
 
 	case L'C':
 		if (opt[1] == L'R' || opt[1] == L'r') {
@@ -6225,6 +6965,12 @@ int ParseCommandLineOption(LPWSTR lp1, LPWSTR lp2, BOOL *bIsNotepadReplacement)
 		}
 		break;
 
+	case L'L':
+		if (StrHasPrefixCase(opt, L"lines=")) {
+			state = ParseCommandLineRange(opt + CSTRLEN(L"lines="), TRUE);
+		}
+		break;
+
 	case L'M':
 		if (StrCaseEqual(opt, L"MBCS")) {
 			flagSetEncoding = IDM_ENCODING_ANSI - IDM_ENCODING_ANSI + 1;
@@ -6401,6 +7147,28 @@ int ParseCommandLineOption(LPWSTR lp1, LPWSTR lp2, BOOL *bIsNotepadReplacement)
 	break;
 
 	case L'S':
+		if (StrHasPrefixCase(opt, L"session=")) {
+			// started by RestoreSession(), show preview of the recorded window
+			opt += CSTRLEN(L"session=");
+			if (lpSessionArg) {
+				LocalFree(lpSessionArg);
+			}
+			lpSessionArg = StrDup(opt);
+			StrTrim(lpSessionArg, L"\" ");
+			flagNoReuseWindow = 1;
+			flagSingleFileInstance = 0;
+			state = 1;
+			break;
+		}
+		if (StrCaseEqual(opt, L"standby")) {
+			// started by StartResidentInst(), wait hidden in tray for next launch
+			flagResidentStandby = 1;
+			flagStartAsTrayIcon = 1;
+			flagNoReuseWindow = 1;
+			flagSingleFileInstance = 0;
+			state = 1;
+			break;
+		}
 		// Shell integration
 		if (StrHasPrefixCase(opt, L"sysmru=")) {
 			opt += CSTRLEN(L"sysmru=");
@@ -6420,6 +7188,23 @@ int ParseCommandLineOption(LPWSTR lp1, LPWSTR lp2, BOOL *bIsNotepadReplacement)
 		}
 		break;
 
+	case L'T':
+		if (StrCaseEqual(opt, L"timing")) {
+			flagStartupTiming = 1;
+			state = 1;
+		} else if (StrHasPrefixCase(opt, L"timing=")) {
+			// append report to specified file instead of console
+			opt += CSTRLEN(L"timing=");
+			if (lpTimingArg) {
+				LocalFree(lpTimingArg);
+			}
+			lpTimingArg = StrDup(opt);
+			StrTrim(lpTimingArg, L"\" ");
+			flagStartupTiming = 1;
+			state = 1;
+		}
+		break;
+
 	case L'U':
 		if (StrHasPrefixCase(opt, L"UTF")) {
 			opt += CSTRLEN(L"UTF");
@@ -6499,6 +7284,8 @@ void ParseCommandLine(void) {
 					flagMultiFileArg = 1;
 					bIsFileArg = TRUE;
 					state = 1;
+					// no file after "-", read text from stdin
+					flagStdinSource = *lp2 == L'\0';
 					break;
 				}
 			} else if (*lp1 == L'/' || *lp1 == L'-') {
@@ -6585,6 +7372,13 @@ void LoadFlags(void) {
 	bSingleFileInstance = IniSectionGetBool(pIniSection, L"SingleFileInstance", 1);
 	bReuseWindow = IniSectionGetBool(pIniSection, L"ReuseWindow", 0);
 	bStickyWindowPosition = IniSectionGetBool(pIniSection, L"StickyWindowPosition", 0);
+	bResidentInstance = IniSectionGetBool(pIniSection, L"ResidentInstance", 0);
+	// reopen windows left open when the system restarts or shuts down.
+	bRestoreSession = IniSectionGetBool(pIniSection, L"RestoreSession", 0);
+	// remember encoding, lexer, folds and bookmarks of recently closed files.
+	bViewStateCache = IniSectionGetBool(pIniSection, L"ViewStateCache", 1);
+	// search regex with the linear-time engine, which has no back references.
+	bLinearRegexSearch = IniSectionGetBool(pIniSection, L"LinearRegexSearch", 0);
 
 	if (!flagReuseWindow && !flagNoReuseWindow) {
 		flagNoReuseWindow = !bReuseWindow;
@@ -6604,6 +7398,23 @@ void LoadFlags(void) {
 
 	dwFileCheckInterval = IniSectionGetInt(pIniSection, L"FileCheckInterval", 1000);
 	dwAutoReloadTimeout = IniSectionGetInt(pIniSection, L"AutoReloadTimeout", 1000);
+	// in MiB, 0 to always read whole file into heap buffer.
+	dwFileMappingMinSize = IniSectionGetInt(pIniSection, L"FileMappingMinSize", 64);
+	// in MiB, 0 to always scan whole file to detect line endings.
+	dwEOLSampleMinSize = IniSectionGetInt(pIniSection, L"LineEndingSampleMinSize", 256);
+	iEOLSampleBlockCount = IniSectionGetInt(pIniSection, L"LineEndingSampleBlockCount", 32);
+	// large pages for huge documents, requires "Lock pages in memory" user right.
+	bUseLargePages = IniSectionGetBool(pIniSection, L"UseLargePages", 0);
+	// in milliseconds, lexing batch taking longer leaves rest of the document unstyled, 0 to disable.
+	iStyleBudget = IniSectionGetInt(pIniSection, L"StyleBudget", 1000);
+	// in MiB and lines, documents above either one use large file profile, 0 to ignore the threshold.
+	dwLargeFileProfileSize = IniSectionGetInt(pIniSection, L"LargeFileProfileSize", 64);
+	dwLargeFileProfileLines = IniSectionGetInt(pIniSection, L"LargeFileProfileLines", 1000000);
+	// in MiB, larger documents keep text away from the view LZ4 compressed, 0 to disable.
+	dwCompressTextMinSize = IniSectionGetInt(pIniSection, L"CompressTextMinSize", 0);
+	// in seconds, 0 to disable snapshot of modified document for recovery.
+	dwAutoSaveInterval = IniSectionGetInt(pIniSection, L"AutoSaveInterval", 60) * 1000;
+	IniSectionGetString(pIniSection, L"AutoSaveDirectory", L"", tchAutoSaveDir, COUNTOF(tchAutoSaveDir));
 
 	if (IsVistaAndAbove()) {
 		bUseXPFileDialog = IniSectionGetBool(pIniSection, L"UseXPFileDialog", 0);
@@ -6875,45 +7686,125 @@ BOOL CreateIniFile(LPCWSTR lpszIniFile) {
 //
 #define EnableTool(id, b)		SendMessage(hwndToolbar, TB_ENABLEBUTTON, id, MAKELPARAM(((b) ? 1 : 0), 0))
 #define CheckTool(id, b)		SendMessage(hwndToolbar, TB_CHECKBUTTON, id, MAKELPARAM(b, 0))
+#define ToolBit(id, b)			((b) ? (1U << ((id) - IDT_FILE_NEW)) : 0)
 
 void UpdateToolbar(void) {
+	pendingUIUpdate &= ~PendingUIUpdate_Toolbar;
 	if (!bShowToolbar || !bInitDone) {
 		return;
 	}
 
-	EnableTool(IDT_FILE_ADDTOFAV, StrNotEmpty(szCurFile));
-
-	EnableTool(IDT_FILE_SAVE, IsDocumentModified());
-	EnableTool(IDT_EDIT_UNDO, SciCall_CanUndo() /*&& !bReadOnly*/);
-	EnableTool(IDT_EDIT_REDO, SciCall_CanRedo() /*&& !bReadOnly*/);
-	EnableTool(IDT_EDIT_PASTE, SciCall_CanPaste() /*&& !bReadOnly*/);
-
-	int i = SciCall_GetLength() != 0;
-	EnableTool(IDT_EDIT_CUT, i /*&& !bReadOnly*/);
-	EnableTool(IDT_EDIT_COPY, i);
-	EnableTool(IDT_EDIT_FIND, i);
-	//EnableTool(IDT_EDIT_FINDNEXT, i);
-	//EnableTool(IDT_EDIT_FINDPREV, i && StrNotEmptyA(efrData.szFind));
-	EnableTool(IDT_EDIT_REPLACE, i /*&& !bReadOnly*/);
-	EnableTool(IDT_EDIT_DELETE, i /*&& !bReadOnly*/);
+	UINT enabled = ToolBit(IDT_FILE_ADDTOFAV, StrNotEmpty(szCurFile));
+
+	enabled |= ToolBit(IDT_FILE_SAVE, IsDocumentModified());
+	enabled |= ToolBit(IDT_EDIT_UNDO, SciCall_CanUndo() /*&& !bReadOnly*/);
+	enabled |= ToolBit(IDT_EDIT_REDO, SciCall_CanRedo() /*&& !bReadOnly*/);
+	enabled |= ToolBit(IDT_EDIT_PASTE, SciCall_CanPaste() /*&& !bReadOnly*/);
+
+	const int i = SciCall_GetLength() != 0;
+	enabled |= ToolBit(IDT_EDIT_CUT, i /*&& !bReadOnly*/);
+	enabled |= ToolBit(IDT_EDIT_COPY, i);
+	enabled |= ToolBit(IDT_EDIT_FIND, i);
+	//enabled |= ToolBit(IDT_EDIT_FINDNEXT, i);
+	//enabled |= ToolBit(IDT_EDIT_FINDPREV, i && StrNotEmptyA(efrData.szFind));
+	enabled |= ToolBit(IDT_EDIT_REPLACE, i /*&& !bReadOnly*/);
+	enabled |= ToolBit(IDT_EDIT_DELETE, i /*&& !bReadOnly*/);
+
+	enabled |= ToolBit(IDT_VIEW_TOGGLEFOLDS, i && bShowCodeFolding);
+	enabled |= ToolBit(IDT_FILE_LAUNCH, i);
+
+	UINT checked = ToolBit(IDT_VIEW_WORDWRAP, fvCurFile.fWordWrap);
+	checked |= ToolBit(IDT_VIEW_ALWAYSONTOP, IsTopMost());
+
+	// only send messages for buttons whose state changed
+	const UINT enabledMask = ToolBit(IDT_FILE_ADDTOFAV, TRUE) | ToolBit(IDT_FILE_SAVE, TRUE)
+		| ToolBit(IDT_EDIT_UNDO, TRUE) | ToolBit(IDT_EDIT_REDO, TRUE) | ToolBit(IDT_EDIT_PASTE, TRUE)
+		| ToolBit(IDT_EDIT_CUT, TRUE) | ToolBit(IDT_EDIT_COPY, TRUE) | ToolBit(IDT_EDIT_FIND, TRUE)
+		| ToolBit(IDT_EDIT_REPLACE, TRUE) | ToolBit(IDT_EDIT_DELETE, TRUE)
+		| ToolBit(IDT_VIEW_TOGGLEFOLDS, TRUE) | ToolBit(IDT_FILE_LAUNCH, TRUE);
+	const UINT checkedMask = ToolBit(IDT_VIEW_WORDWRAP, TRUE) | ToolBit(IDT_VIEW_ALWAYSONTOP, TRUE);
+	UINT changed = enabledMask;
+	UINT changedCheck = checkedMask;
+	if (cachedToolbarState.valid) {
+		changed = enabled ^ cachedToolbarState.enabled;
+		changedCheck = checked ^ cachedToolbarState.checked;
+	}
+	cachedToolbarState.valid = TRUE;
+	cachedToolbarState.enabled = enabled;
+	cachedToolbarState.checked = checked;
+
+	while (changed) {
+		const UINT index = np2_ctz(changed);
+		changed &= changed - 1;
+		EnableTool(IDT_FILE_NEW + index, enabled & (1U << index));
+	}
+	while (changedCheck) {
+		const UINT index = np2_ctz(changedCheck);
+		changedCheck &= changedCheck - 1;
+		CheckTool(IDT_FILE_NEW + index, (checked >> index) & 1);
+	}
+}
 
-	EnableTool(IDT_VIEW_TOGGLEFOLDS, i && bShowCodeFolding);
-	EnableTool(IDT_FILE_LAUNCH, i);
+// count characters in selection, adjust count of last selection by characters around moved ends.
+static Sci_Position CountSelectionCharacters(Sci_Position iSelStart, Sci_Position iSelEnd) {
+	// whole lines are counted with the line character index
+	if (iSelEnd - iSelStart >= 1024*1024 && SciCall_GetCodePage() == SC_CP_UTF8
+		&& !(SciCall_GetLineCharacterIndex() & SC_LINECHARACTERINDEX_UTF32)) {
+		SciCall_AllocateLineCharacterIndex(SC_LINECHARACTERINDEX_UTF32);
+	}
+
+	const Sci_Position iCachedStart = cachedStatusItem.iSelStart;
+	const Sci_Position iCachedEnd = cachedStatusItem.iSelEnd;
+	Sci_Position iSel;
+	if (iCachedStart != iCachedEnd && abs_pos(iSelStart - iCachedStart) + abs_pos(iSelEnd - iCachedEnd) < iSelEnd - iSelStart) {
+		iSel = cachedStatusItem.iSelChar;
+		if (iSelStart < iCachedStart) {
+			iSel += SciCall_CountCharacters(iSelStart, iCachedStart);
+		} else if (iSelStart > iCachedStart) {
+			iSel -= SciCall_CountCharacters(iCachedStart, iSelStart);
+		}
+		if (iSelEnd > iCachedEnd) {
+			iSel += SciCall_CountCharacters(iCachedEnd, iSelEnd);
+		} else if (iSelEnd < iCachedEnd) {
+			iSel -= SciCall_CountCharacters(iSelEnd, iCachedEnd);
+		}
+	} else {
+		iSel = SciCall_CountCharacters(iSelStart, iSelEnd);
+	}
 
-	CheckTool(IDT_VIEW_WORDWRAP, fvCurFile.fWordWrap);
-	CheckTool(IDT_VIEW_ALWAYSONTOP, IsTopMost());
+	cachedStatusItem.iSelStart = iSelStart;
+	cachedStatusItem.iSelEnd = iSelEnd;
+	cachedStatusItem.iSelChar = iSel;
+	return iSel;
 }
 
-//=============================================================================
-//
-// UpdateStatusbar()
-//
-//
-void UpdateStatusbar(void) {
-	if (!bShowStatusbar || !bInitDone) {
-		return;
+static void FormatHexViewStatus(LPWSTR tchDocPos, LPWSTR tchDocSize) {
+	HexViewStatus status;
+	HexView_GetStatus(&status);
+
+	WCHAR tchOffset[32];
+	WCHAR tchSize[32];
+	WCHAR tchValue[8];
+	WCHAR tchPatched[32];
+	lstrcpy(tchOffset, L"0x");
+	_ui64tow(status.caret, tchOffset + 2, 16);
+	CharUpper(tchOffset);
+	lstrcpy(tchSize, L"0x");
+	_ui64tow(status.fileSize, tchSize + 2, 16);
+	CharUpper(tchSize);
+	if (status.value < 0) {
+		lstrcpy(tchValue, L"--");
+	} else {
+		wsprintf(tchValue, L"0x%02X", status.value);
 	}
+	PosToStrW(status.patchCount, tchPatched);
+	FormatNumberStr(tchPatched);
+
+	wsprintf(tchDocPos, cachedStatusItem.tchHexPosFmt, tchOffset, tchSize, tchValue, tchPatched);
+	StrFormatByteSize(status.fileSize, tchDocSize, 32);
+}
 
+static void FormatDocumentStatus(LPWSTR tchDocPos, LPWSTR tchDocSize, UINT updateMask) {
 	const Sci_Position iPos = SciCall_GetCurrentPos();
 	const Sci_Line iLine = SciCall_LineFromPosition(iPos);
 	const Sci_Line iLines = SciCall_GetLineCount();
@@ -6929,7 +7820,10 @@ void UpdateStatusbar(void) {
 	Sci_Position iLineChar;
 	Sci_Position iLineColumn;
 
-	const UINT updateMask = cachedStatusItem.updateMask;
+	if (updateMask & StatusBarUpdateMask_LineColumn) {
+		// document changed, discard cached selection count
+		cachedStatusItem.iSelEnd = cachedStatusItem.iSelStart;
+	}
 	if ((updateMask & StatusBarUpdateMask_LineColumn) || (iLine != cachedStatusItem.iLine)) {
 		ft.chrg.cpMin = ft.chrg.cpMax;
 		ft.chrg.cpMax = SciCall_GetLineEndPosition(iLine);
@@ -6980,7 +7874,7 @@ void UpdateStatusbar(void) {
 		Sci_Position iSel = SciCall_GetSelTextLength() - 1;
 		PosToStrW(iSel, tchSelByte);
 		FormatNumberStr(tchSelByte);
-		iSel = SciCall_CountCharacters(iSelStart, iSelEnd);
+		iSel = CountSelectionCharacters(iSelStart, iSelEnd);
 		PosToStrW(iSel, tchSelChar);
 		FormatNumberStr(tchSelChar);
 	} else {
@@ -7012,17 +7906,49 @@ void UpdateStatusbar(void) {
 		lstrcat(tchMatchesCount, L" ...");
 	}
 
-	WCHAR tchDocPos[256];
 	wsprintf(tchDocPos, cachedStatusItem.tchDocPosFmt, tchCurLine, tchDocLine,
 				 tchCurColumn, tchLineColumn, tchCurChar, tchLineChar,
 				 tchSelChar, tchSelByte, tchLinesSelected, tchMatchesCount);
 
-	WCHAR tchDocSize[32];
 	const Sci_Position iBytes = SciCall_GetLength();
-	StrFormatByteSize(iBytes, tchDocSize, COUNTOF(tchDocSize));
+	if (bLargeFileProfile) {
+		WCHAR tchBytes[32];
+		StrFormatByteSize(iBytes, tchBytes, COUNTOF(tchBytes));
+		wsprintf(tchDocSize, cachedStatusItem.tchLargeFileFmt, tchBytes);
+	} else {
+		StrFormatByteSize(iBytes, tchDocSize, 32);
+	}
+}
+
+//=============================================================================
+//
+// UpdateStatusbar()
+//
+//
+void UpdateStatusbar(void) {
+	pendingUIUpdate &= ~PendingUIUpdate_Statusbar;
+	if (!bShowStatusbar || !bInitDone) {
+		return;
+	}
+
+	WCHAR tchDocPos[256];
+	WCHAR tchDocSize[64];
+	const UINT updateMask = cachedStatusItem.updateMask;
+	if (HexView_IsActive()) {
+		FormatHexViewStatus(tchDocPos, tchDocSize);
+	} else {
+		FormatDocumentStatus(tchDocPos, tchDocSize, updateMask);
+	}
 
-	StatusSetText(hwndStatus, STATUS_DOCPOS, tchDocPos);
-	StatusSetText(hwndStatus, STATUS_DOCSIZE, tchDocSize);
+	// skip panes whose text is unchanged
+	if ((updateMask & StatusBarUpdateMask_DocPos) || !StrEqual(tchDocPos, cachedStatusItem.tchDocPos)) {
+		lstrcpy(cachedStatusItem.tchDocPos, tchDocPos);
+		StatusSetText(hwndStatus, STATUS_DOCPOS, tchDocPos);
+	}
+	if ((updateMask & StatusBarUpdateMask_DocPos) || !StrEqual(tchDocSize, cachedStatusItem.tchDocSize)) {
+		lstrcpy(cachedStatusItem.tchDocSize, tchDocSize);
+		StatusSetText(hwndStatus, STATUS_DOCSIZE, tchDocSize);
+	}
 	if (updateMask & StatusBarUpdateMask_Lexer) {
 		StatusSetText(hwndStatus, STATUS_LEXER, cachedStatusItem.pszLexerName);
 	}
@@ -7154,7 +8080,16 @@ BOOL FileIO(BOOL fLoad, LPWSTR pszFile, BOOL bFlag, EditFileIOStatus *status) {
 	InvalidateRect(hwndStatus, NULL, TRUE);
 	UpdateWindow(hwndStatus);
 
-	const BOOL fSuccess = fLoad ? EditLoadFile(pszFile, bFlag, status) : EditSaveFile(hwndEdit, pszFile, bFlag, status);
+	BOOL fSuccess;
+	if (fLoad) {
+		NP2_TRACE_START("LoadFile", NP2_TRACE_INT64(bFlag, "skipEncodingDetection"));
+		fSuccess = EditLoadFile(pszFile, bFlag, status);
+		NP2_TRACE_STOP("LoadFile", NP2_TRACE_INT64(fSuccess, "success"), NP2_TRACE_INT64(SciCall_GetLength(), "length"));
+	} else {
+		NP2_TRACE_START("SaveFile", NP2_TRACE_INT64(SciCall_GetLength(), "length"));
+		fSuccess = EditSaveFile(hwndEdit, pszFile, bFlag, status);
+		NP2_TRACE_STOP("SaveFile", NP2_TRACE_INT64(fSuccess, "success"));
+	}
 	const DWORD dwFileAttributes = GetFileAttributes(pszFile);
 	bReadOnly = (dwFileAttributes != INVALID_FILE_ATTRIBUTES) && (dwFileAttributes & FILE_ATTRIBUTE_READONLY);
 
@@ -7164,6 +8099,196 @@ BOOL FileIO(BOOL fLoad, LPWSTR pszFile, BOOL bFlag, EditFileIOStatus *status) {
 	return fSuccess;
 }
 
+//=============================================================================
+//
+// FileLoadHexView()
+//
+//
+BOOL FileLoadHexView(LPCWSTR lpszFile, BOOL bLocked) {
+	if (!HexView_Open(lpszFile, bLocked)) {
+		dwLastIOError = GetLastError();
+		return FALSE;
+	}
+
+	// release the text, commands from accelerators still go to the hidden edit control.
+	EditSetEmptyText();
+	SciCall_SetReadOnly(TRUE);
+	bLockedForEditing = bLocked;
+	bCompressedFile = FALSE;
+	bModified = FALSE;
+	iOriginalEncoding = iEncoding;
+
+	if (lpszFile != szCurFile) {
+		lstrcpy(szCurFile, lpszFile);
+		lstrcpy(szTitleExcerpt, L"");
+		// lexer is kept when the file is reloaded as text
+		np2LexLangIndex = 0;
+		Style_SetLexerFromFile(szCurFile);
+	}
+	SetDlgItemText(hwndMain, IDC_FILENAME, szCurFile);
+	SetDlgItemInt(hwndMain, IDC_REUSELOCK, GetTickCount(), FALSE);
+	MRU_AddFile(pFileMRU, szCurFile, flagRelativeFileMRU, flagPortableMyDocs);
+	if (flagUseSystemMRU == 2) {
+		SHAddToRecentDocs(SHARD_PATHW, szCurFile);
+	}
+	InstallFileWatching(FALSE);
+
+	const BOOL bFocus = GetFocus() == hwndEdit;
+	ShowWindow(hwndEdit, SW_HIDE);
+	SetWindowPos(hwndHexView, HWND_TOP, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_SHOWWINDOW);
+	if (bFocus) {
+		SetFocus(hwndHexView);
+	}
+	// hide document map
+	SendWMSize(hwndMain);
+
+	UpdateStatusBarCacheLineColumn();
+	UpdateDocumentModificationStatus();
+	UpdateStatusbar();
+	return TRUE;
+}
+
+static void CloseHexView(void) {
+	if (HexView_IsActive()) {
+		const BOOL bFocus = GetFocus() == hwndHexView;
+		HexView_Close();
+		ShowWindow(hwndHexView, SW_HIDE);
+		ShowWindow(hwndEdit, SW_SHOW);
+		if (bFocus) {
+			SetFocus(hwndEdit);
+		}
+		SendWMSize(hwndMain);
+		bLockedForEditing = FALSE;
+		SciCall_SetReadOnly(FALSE);
+		UpdateStatusBarCacheLineColumn();
+	}
+}
+
+//=============================================================================
+//
+// FileLoadPipe()
+//
+// text is appended as it arrives, document is untitled as the pipe can't be reloaded or saved.
+BOOL FileLoadPipe(BOOL bDontSave, LPCWSTR lpszPipe) {
+	HANDLE hPipe;
+	if (lpszPipe == NULL) {
+		hPipe = GetStdHandle(STD_INPUT_HANDLE);
+		// console input is not redirected
+		const DWORD type = (hPipe == NULL || hPipe == INVALID_HANDLE_VALUE) ? FILE_TYPE_UNKNOWN : GetFileType(hPipe);
+		if (type != FILE_TYPE_PIPE && type != FILE_TYPE_DISK) {
+			dwLastIOError = ERROR_INVALID_HANDLE;
+			MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, L"stdin");
+			return FALSE;
+		}
+	} else {
+		hPipe = CreateFile(lpszPipe, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+		if (hPipe == INVALID_HANDLE_VALUE) {
+			dwLastIOError = GetLastError();
+			MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, lpszPipe);
+			return FALSE;
+		}
+	}
+
+	const int iSrc = iSrcEncoding;
+	iSrcEncoding = -1;
+	iWeakSrcEncoding = -1;
+	if (!FileLoad(bDontSave, TRUE, FALSE, FALSE, L"")) {
+		if (lpszPipe != NULL) {
+			CloseHandle(hPipe);
+		}
+		return FALSE;
+	}
+
+	// only UTF-8 and ANSI are supported, as encoding can't be detected before text arrives.
+	const BOOL bUTF8 = iSrc == -1 || iSrc == CPI_UTF8 || iSrc == CPI_UTF8SIGN;
+	iEncoding = bUTF8 ? CPI_UTF8 : CPI_DEFAULT;
+	iOriginalEncoding = iEncoding;
+	SciCall_SetCodePage(bUTF8 ? SC_CP_UTF8 : iDefaultCodePage);
+	if (!EditPipeSource_Start(hwndMain, hPipe, lpszPipe != NULL, bUTF8 && iSrc == -1 && !bLoadANSIasUTF8)) {
+		if (lpszPipe != NULL) {
+			CloseHandle(hPipe);
+		}
+		MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, (lpszPipe == NULL) ? L"stdin" : lpszPipe);
+		return FALSE;
+	}
+
+	lstrcpyn(szTitleExcerpt, (lpszPipe == NULL) ? L"stdin" : PathFindFileName(lpszPipe), COUNTOF(szTitleExcerpt));
+	UpdateStatusBarCache(STATUS_CODEPAGE);
+	UpdateDocumentModificationStatus();
+	UpdateStatusbar();
+	return TRUE;
+}
+
+//=============================================================================
+//
+// FileLoadRange()
+//
+// the part is shown as untitled document locked for editing, so saving it won't overwrite the whole file.
+BOOL FileLoadRange(BOOL bDontSave, LPCWSTR lpszFile, EditFileRange *range) {
+	WCHAR szFileName[MAX_PATH];
+	if (PathIsRelative(lpszFile)) {
+		lstrcpyn(szFileName, g_wchWorkingDirectory, COUNTOF(szFileName));
+		PathAppend(szFileName, lpszFile);
+	} else {
+		lstrcpyn(szFileName, lpszFile, COUNTOF(szFileName));
+	}
+	PathCanonicalizeEx(szFileName);
+	if (!FileLoad(bDontSave, TRUE, FALSE, FALSE, L"")) {
+		return FALSE;
+	}
+
+#if NP2_USE_DESIGNATED_INITIALIZER
+	EditFileIOStatus status = {
+		.iEncoding = iEncoding,
+		.iEOLMode = iEOLMode,
+	};
+#else
+	EditFileIOStatus status = { iEncoding, iEOLMode };
+#endif
+
+	BeginWaitCursor();
+	WCHAR tch[MAX_PATH + 128];
+	WCHAR fmt[128];
+	FormatString(tch, fmt, IDS_LOADFILE, szFileName);
+	StatusSetText(hwndStatus, STATUS_HELP, tch);
+	StatusSetSimple(hwndStatus, TRUE);
+	UpdateWindow(hwndStatus);
+
+	const BOOL fSuccess = EditLoadFileRange(szFileName, range, &status);
+	StatusSetSimple(hwndStatus, FALSE);
+	EndWaitCursor();
+	if (!fSuccess) {
+		if (!status.bLoadCancelled) {
+			MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, szFileName);
+		}
+		return FALSE;
+	}
+
+	iEncoding = status.iEncoding;
+	iOriginalEncoding = iEncoding;
+	iEOLMode = status.iEOLMode;
+	SciCall_SetEOLMode(iEOLMode);
+	Style_SetLexerFromFile(szFileName);
+
+	WCHAR tchStart[32];
+	WCHAR tchEnd[32];
+	_i64tow(range->start, tchStart, 10);
+	_i64tow(range->end, tchEnd, 10);
+	FormatNumberStr(tchStart);
+	FormatNumberStr(tchEnd);
+	FormatString(tch, fmt, (range->bLines ? IDS_OPENRANGE_LINES : IDS_OPENRANGE_BYTES), PathFindFileName(szFileName), tchStart, tchEnd);
+	lstrcpyn(szTitleExcerpt, tch, COUNTOF(szTitleExcerpt));
+
+	bLockedForEditing = TRUE;
+	SciCall_SetReadOnly(TRUE);
+	UpdateStatusBarCache(STATUS_CODEPAGE);
+	UpdateStatusBarCache(STATUS_EOLMODE);
+	UpdateStatusBarCacheLineColumn();
+	UpdateDocumentModificationStatus();
+	UpdateStatusbar();
+	return TRUE;
+}
+
 //=============================================================================
 //
 // FileLoad()
@@ -7182,7 +8307,11 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 	int iXOffset = 0;
 	int keepTitleExcerpt = fKeepTitleExcerpt;
 	BOOL keepCurrentLexer = FALSE;
+	BOOL bCachedView = FALSE;
 
+	if (!bNew && !bReload && StrNotEmpty(lpszFile) && StrHasPrefixCase(lpszFile, L"\\\\.\\pipe\\")) {
+		return FileLoadPipe(bDontSave, lpszFile);
+	}
 	if (!bNew && StrNotEmpty(lpszFile)) {
 		lstrcpy(tch, lpszFile);
 		if (lpszFile == szCurFile || StrCaseEqual(lpszFile, szCurFile)) {
@@ -7205,6 +8334,13 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		}
 	}
 
+	if (!keepCurrentLexer) {
+		ViewState_Save();
+	}
+	const BOOL bHexView = HexView_IsActive();
+	CloseHexView();
+	Session_Discard();
+
 	if (bNew) {
 		lstrcpy(szCurFile, L"");
 		SetDlgItemText(hwndMain, IDC_FILENAME, szCurFile);
@@ -7216,6 +8352,7 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		EditSetEmptyText();
 		bModified = FALSE;
 		bReadOnly = FALSE;
+		bCompressedFile = FALSE;
 		iEOLMode = GetScintillaEOLMode(iDefaultEOLMode);
 		SciCall_SetEOLMode(iEOLMode);
 		iEncoding = iDefaultEncoding;
@@ -7268,6 +8405,7 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 #else
 	EditFileIOStatus status = { iEncoding, iEOLMode };
 #endif
+	status.bReload = bReload && keepCurrentLexer;
 
 	// Ask to create a new file...
 	if (!bReload && !PathIsFile(szFileName)) {
@@ -7301,7 +8439,17 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		} else {
 			return FALSE;
 		}
+	} else if (!bSkipHexView && iSrcEncoding == -1 && HexView_MaybeBinaryFile(szFileName)) {
+		// large binary file is shown in hex view without loading it as text
+		fSuccess = FileLoadHexView(szFileName, TRUE);
+		if (fSuccess) {
+			return TRUE;
+		}
 	} else {
+		// detection is skipped for unchanged file
+		if (!keepCurrentLexer && !bNoEncDetect && iSrcEncoding == -1) {
+			bCachedView = ViewState_Load(szFileName, &iSrcEncoding);
+		}
 		fSuccess = FileIO(TRUE, szFileName, bNoEncDetect, &status);
 		if (fSuccess) {
 			iEncoding = status.iEncoding;
@@ -7318,6 +8466,7 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		}
 		iOriginalEncoding = iEncoding;
 		bModified = FALSE;
+		bCompressedFile = status.bCompressed;
 		SciCall_SetEOLMode(iEOLMode);
 		UpdateStatusBarCache(STATUS_CODEPAGE);
 		UpdateStatusBarCache(STATUS_EOLMODE);
@@ -7338,7 +8487,17 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 				flagLexerSpecified = 0;
 			} else {
 				np2LexLangIndex = 0;
-				bUnknownFile = !Style_SetLexerFromFile(szCurFile);
+				if (bCachedView) {
+					ViewState_ApplyLexer();
+				} else if (bCompressedFile) {
+					// detect lexer from inner file name, e.g. access.log.gz
+					WCHAR szInnerFile[MAX_PATH];
+					lstrcpy(szInnerFile, szCurFile);
+					PathRemoveExtension(szInnerFile);
+					bUnknownFile = !Style_SetLexerFromFile(szInnerFile);
+				} else {
+					bUnknownFile = !Style_SetLexerFromFile(szCurFile);
+				}
 			}
 		} else {
 			UpdateLineNumberWidth();
@@ -7356,7 +8515,7 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		InstallFileWatching(FALSE);
 
 		// check for binary file (file with unknown encoding: ANSI)
-		const BOOL binary = (iEncoding == CPI_DEFAULT) && Style_MaybeBinaryFile(szCurFile);
+		const BOOL binary = (iEncoding == CPI_DEFAULT) && !bCompressedFile && Style_MaybeBinaryFile(szCurFile);
 		if (binary || pLexCurrent->iLexer == SCLEX_DIFF) {
 			// ignore auto "detected" Tab settings for binary file and diff file.
 			if (fvCurFile.mask & FV_MaskHasFileTabSettings) {
@@ -7365,8 +8524,8 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 				FileVars_Apply(&fvCurFile);
 			}
 		}
-		// lock binary file for editing
-		if (binary) {
+		// lock binary file and compressed file for editing
+		if (binary || bCompressedFile) {
 			bLockedForEditing = TRUE;
 			SciCall_SetReadOnly(TRUE);
 		} else {
@@ -7395,6 +8554,8 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 					SciCall_SetXOffset(iXOffset);
 				}
 				EditEnsureSelectionVisible();
+			} else if (bCachedView) {
+				ViewState_ApplyView();
 			}
 		}
 
@@ -7425,8 +8586,14 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 				ConvertLineEndings(iNewEOLMode);
 			}
 		}
-	} else if (!status.bFileTooBig) {
-		MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, szFileName);
+	} else {
+		if (!(status.bFileTooBig || status.bLoadCancelled)) {
+			MsgBoxLastError(MB_OK, IDS_ERR_LOADFILE, szFileName);
+		}
+		// the empty document must not be saved over the file closed in hex view
+		if (bHexView) {
+			FileLoad(TRUE, TRUE, FALSE, FALSE, L"");
+		}
 	}
 
 	return fSuccess;
@@ -7438,6 +8605,31 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 //
 //
 BOOL FileSave(BOOL bSaveAlways, BOOL bAsk, BOOL bSaveAs, BOOL bSaveCopy) {
+	// hex view writes modified bytes into the file in place, it can't save to other file.
+	if (HexView_IsActive()) {
+		if (bSaveAs || bSaveCopy) {
+			MessageBeep(MB_ICONEXCLAMATION);
+			return FALSE;
+		}
+		if (!HexView_IsModified()) {
+			return TRUE;
+		}
+		if (bAsk) {
+			switch (MsgBoxAsk(MB_YESNOCANCEL, IDS_ASK_SAVE, szCurFile)) {
+			case IDCANCEL:
+				return FALSE;
+			case IDNO:
+				return TRUE;
+			}
+		}
+		if (!HexView_Save()) {
+			MsgBoxLastError(MB_OK, IDS_ERR_SAVEFILE, szCurFile);
+			return FALSE;
+		}
+		InstallFileWatching(FALSE);
+		return TRUE;
+	}
+
 	const BOOL Untitled = StrIsEmpty(szCurFile);
 	BOOL bIsEmptyNewFile = FALSE;
 
@@ -7487,6 +8679,11 @@ BOOL FileSave(BOOL bSaveAlways, BOOL bAsk, BOOL bSaveAs, BOOL bSaveCopy) {
 	EditFileIOStatus status = { iEncoding, iEOLMode };
 #endif
 
+	// compressed file is never overwritten with decompressed text
+	if (bCompressedFile && !bSaveCopy) {
+		bSaveAs = TRUE;
+	}
+
 	// Read only...
 	if (!bSaveAs && !bSaveCopy && !Untitled) {
 		const DWORD dwFileAttributes = GetFileAttributes(szCurFile);
@@ -7516,12 +8713,16 @@ BOOL FileSave(BOOL bSaveAlways, BOOL bAsk, BOOL bSaveAs, BOOL bSaveCopy) {
 			PathAppend(tchFile, PathFindFileName(szCurFile));
 		} else {
 			lstrcpy(tchFile, szCurFile);
+			if (bCompressedFile) {
+				PathRemoveExtension(tchFile);
+			}
 		}
 
 		if (SaveFileDlg(hwndMain, Untitled, tchFile, COUNTOF(tchFile), tchInitialDir)) {
 			fSuccess = FileIO(FALSE, tchFile, bSaveCopy, &status);
 			if (fSuccess) {
 				if (!bSaveCopy) {
+					bCompressedFile = FALSE;
 					lstrcpy(szCurFile, tchFile);
 					SetDlgItemText(hwndMain, IDC_FILENAME, szCurFile);
 					SetDlgItemInt(hwndMain, IDC_REUSELOCK, GetTickCount(), FALSE);
@@ -7715,7 +8916,7 @@ BOOL CALLBACK EnumWndProc(HWND hwnd, LPARAM lParam) {
 	WCHAR szClassName[64];
 
 	if (GetClassName(hwnd, szClassName, COUNTOF(szClassName))) {
-		if (StrCaseEqual(szClassName, wchWndClass)) {
+		if (StrCaseEqual(szClassName, wchWndClass) && GetProp(hwnd, PROP_RESIDENT_STANDBY) == NULL) {
 			const DWORD dwReuseLock = GetDlgItemInt(hwnd, IDC_REUSELOCK, NULL, FALSE);
 			if (GetTickCount() - dwReuseLock >= REUSEWINDOWLOCKTIMEOUT) {
 				*(HWND *)lParam = hwnd;
@@ -7733,7 +8934,7 @@ BOOL CALLBACK EnumWndProc2(HWND hwnd, LPARAM lParam) {
 	WCHAR szClassName[64];
 
 	if (GetClassName(hwnd, szClassName, COUNTOF(szClassName))) {
-		if (StrCaseEqual(szClassName, wchWndClass)) {
+		if (StrCaseEqual(szClassName, wchWndClass) && GetProp(hwnd, PROP_RESIDENT_STANDBY) == NULL) {
 			const DWORD dwReuseLock = GetDlgItemInt(hwnd, IDC_REUSELOCK, NULL, FALSE);
 			if (GetTickCount() - dwReuseLock >= REUSEWINDOWLOCKTIMEOUT) {
 				if (IsWindowEnabled(hwnd)) {
@@ -7753,21 +8954,83 @@ BOOL CALLBACK EnumWndProc2(HWND hwnd, LPARAM lParam) {
 	return bContinue;
 }
 
+static void MakeFileArgAbsolute(void) {
+	ExpandEnvironmentStringsEx(lpFileArg, (DWORD)(NP2HeapSize(lpFileArg) / sizeof(WCHAR)));
+
+	if (PathIsRelative(lpFileArg)) {
+		WCHAR tchTmp[MAX_PATH];
+		lstrcpyn(tchTmp, g_wchWorkingDirectory, COUNTOF(tchTmp));
+		PathAppend(tchTmp, lpFileArg);
+		lstrcpy(lpFileArg, tchTmp);
+	}
+}
+
+// send file and related command line arguments to another instance.
+static void SendParamsToInst(HWND hwnd) {
+	DWORD cb = sizeof(NP2PARAMS);
+	if (lpFileArg) {
+		MakeFileArgAbsolute();
+		cb += (lstrlen(lpFileArg) + 1) * sizeof(WCHAR);
+	}
+
+	if (lpSchemeArg) {
+		cb += (lstrlen(lpSchemeArg) + 1) * sizeof(WCHAR);
+	}
+
+	const int cchTitleExcerpt = lstrlen(szTitleExcerpt);
+	if (cchTitleExcerpt) {
+		cb += (cchTitleExcerpt + 1) * sizeof(WCHAR);
+	}
+
+	LPNP2PARAMS params = (LPNP2PARAMS)GlobalAlloc(GPTR, cb);
+	params->flagFileSpecified = lpFileArg != NULL;
+	if (lpFileArg) {
+		lstrcpy(&params->wchData, lpFileArg);
+	}
+	params->flagChangeNotify = flagChangeNotify;
+	params->flagQuietCreate = flagQuietCreate;
+	params->flagLexerSpecified = flagLexerSpecified;
+	if (flagLexerSpecified && lpSchemeArg) {
+		lstrcpy(StrEnd(&params->wchData) + 1, lpSchemeArg);
+		params->iInitialLexer = 0;
+	} else {
+		params->iInitialLexer = iInitialLexer;
+	}
+	params->flagJumpTo = flagJumpTo;
+	params->iInitialLine = iInitialLine;
+	params->iInitialColumn = iInitialColumn;
+
+	params->iSrcEncoding = (lpEncodingArg) ? Encoding_Match(lpEncodingArg) : -1;
+	params->flagSetEncoding = flagSetEncoding;
+	params->flagSetEOLMode = flagSetEOLMode;
+
+	if (cchTitleExcerpt) {
+		lstrcpy(StrEnd(&params->wchData) + 1, szTitleExcerpt);
+		params->flagTitleExcerpt = 1;
+	} else {
+		params->flagTitleExcerpt = 0;
+	}
+
+	COPYDATASTRUCT cds;
+	cds.dwData = DATA_NOTEPAD2_PARAMS;
+	cds.cbData = (DWORD)GlobalSize(params);
+	cds.lpData = params;
+
+	SendMessage(hwnd, WM_COPYDATA, 0, (LPARAM)&cds);
+	GlobalFree(params);
+	if (lpFileArg) {
+		NP2HeapFree(lpFileArg);
+		lpFileArg = NULL;
+	}
+}
+
 BOOL ActivatePrevInst(void) {
-	if ((flagNoReuseWindow && !flagSingleFileInstance) || flagStartAsTrayIcon || flagNewFromClipboard || flagPasteBoard) {
+	if ((flagNoReuseWindow && !flagSingleFileInstance) || flagStartAsTrayIcon || flagNewFromClipboard || flagPasteBoard || flagStdinSource || flagRangeArg) {
 		return FALSE;
 	}
 
 	if (flagSingleFileInstance && lpFileArg) {
-		ExpandEnvironmentStringsEx(lpFileArg, (DWORD)(NP2HeapSize(lpFileArg) / sizeof(WCHAR)));
-
-		if (PathIsRelative(lpFileArg)) {
-			WCHAR tchTmp[MAX_PATH];
-			lstrcpyn(tchTmp, g_wchWorkingDirectory, COUNTOF(tchTmp));
-			PathAppend(tchTmp, lpFileArg);
-			lstrcpy(lpFileArg, tchTmp);
-		}
-
+		MakeFileArgAbsolute();
 		GetLongPathNameEx(lpFileArg, MAX_PATH);
 
 		HWND hwnd = NULL;
@@ -7860,62 +9123,7 @@ BOOL ActivatePrevInst(void) {
 			SetForegroundWindow(hwnd);
 
 			if (lpFileArg) {
-				ExpandEnvironmentStringsEx(lpFileArg, (DWORD)(NP2HeapSize(lpFileArg) / sizeof(WCHAR)));
-
-				if (PathIsRelative(lpFileArg)) {
-					WCHAR tchTmp[MAX_PATH];
-					lstrcpyn(tchTmp, g_wchWorkingDirectory, COUNTOF(tchTmp));
-					PathAppend(tchTmp, lpFileArg);
-					lstrcpy(lpFileArg, tchTmp);
-				}
-
-				DWORD cb = sizeof(NP2PARAMS);
-				cb += (lstrlen(lpFileArg) + 1) * sizeof(WCHAR);
-
-				if (lpSchemeArg) {
-					cb += (lstrlen(lpSchemeArg) + 1) * sizeof(WCHAR);
-				}
-
-				const int cchTitleExcerpt = lstrlen(szTitleExcerpt);
-				if (cchTitleExcerpt) {
-					cb += (cchTitleExcerpt + 1) * sizeof(WCHAR);
-				}
-
-				LPNP2PARAMS params = (LPNP2PARAMS)GlobalAlloc(GPTR, cb);
-				params->flagFileSpecified = TRUE;
-				lstrcpy(&params->wchData, lpFileArg);
-				params->flagChangeNotify = flagChangeNotify;
-				params->flagQuietCreate = flagQuietCreate;
-				params->flagLexerSpecified = flagLexerSpecified;
-				if (flagLexerSpecified && lpSchemeArg) {
-					lstrcpy(StrEnd(&params->wchData) + 1, lpSchemeArg);
-					params->iInitialLexer = 0;
-				} else {
-					params->iInitialLexer = iInitialLexer;
-				}
-				params->flagJumpTo = flagJumpTo;
-				params->iInitialLine = iInitialLine;
-				params->iInitialColumn = iInitialColumn;
-
-				params->iSrcEncoding = (lpEncodingArg) ? Encoding_Match(lpEncodingArg) : -1;
-				params->flagSetEncoding = flagSetEncoding;
-				params->flagSetEOLMode = flagSetEOLMode;
-
-				if (cchTitleExcerpt) {
-					lstrcpy(StrEnd(&params->wchData) + 1, szTitleExcerpt);
-					params->flagTitleExcerpt = 1;
-				} else {
-					params->flagTitleExcerpt = 0;
-				}
-
-				COPYDATASTRUCT cds;
-				cds.dwData = DATA_NOTEPAD2_PARAMS;
-				cds.cbData = (DWORD)GlobalSize(params);
-				cds.lpData = params;
-
-				SendMessage(hwnd, WM_COPYDATA, 0, (LPARAM)&cds);
-				GlobalFree(params);
-				NP2HeapFree(lpFileArg);
+				SendParamsToInst(hwnd);
 			}
 			return TRUE;
 		}
@@ -7929,6 +9137,95 @@ BOOL ActivatePrevInst(void) {
 	return FALSE;
 }
 
+//=============================================================================
+//
+// ActivateResidentInst()
+//
+// Hand the command line over to a hidden standby instance (ResidentInstance=1 in [Settings2]),
+// which already has settings, lexers, Direct2D and fonts initialized.
+//
+BOOL CALLBACK EnumWndProcStandby(HWND hwnd, LPARAM lParam) {
+	BOOL bContinue = TRUE;
+	WCHAR szClassName[64];
+
+	if (GetClassName(hwnd, szClassName, COUNTOF(szClassName))) {
+		if (StrCaseEqual(szClassName, wchWndClass) && GetProp(hwnd, PROP_RESIDENT_STANDBY) != NULL && IsWindowEnabled(hwnd)) {
+			*(HWND *)lParam = hwnd;
+			bContinue = FALSE;
+		}
+	}
+	return bContinue;
+}
+
+BOOL ActivateResidentInst(void) {
+	// options that only apply to a newly created window
+	if (!bResidentInstance || flagResidentStandby || flagStartAsTrayIcon || flagNewFromClipboard || flagPasteBoard
+		|| flagPosParam || flagMatchText || flagAlwaysOnTop || lpSessionArg) {
+		return FALSE;
+	}
+
+	HWND hwnd = NULL;
+	EnumWindows(EnumWndProcStandby, (LPARAM)&hwnd);
+	if (hwnd == NULL) {
+		return FALSE;
+	}
+
+	// we are the foreground process, let the standby window take over foreground.
+	DWORD dwProcessId = 0;
+	GetWindowThreadProcessId(hwnd, &dwProcessId);
+	AllowSetForegroundWindow(dwProcessId);
+
+	SendParamsToInst(hwnd);
+	return TRUE;
+}
+
+void StartResidentInst(void) {
+	if (!bResidentInstance) {
+		return;
+	}
+
+	HWND hwnd = NULL;
+	EnumWindows(EnumWndProcStandby, (LPARAM)&hwnd);
+	if (hwnd != NULL) {
+		return;
+	}
+
+	WCHAR szModuleName[MAX_PATH];
+	GetModuleFileName(NULL, szModuleName, COUNTOF(szModuleName));
+	LPWSTR szParameters = (LPWSTR)NP2HeapAlloc(sizeof(WCHAR) * 1024);
+	wsprintf(szParameters, L"-appid=\"%s\" -sysmru=%i -f", g_wchAppUserModelID, (flagUseSystemMRU == 2));
+	if (StrNotEmpty(szIniFile)) {
+		lstrcat(szParameters, L" \"");
+		lstrcat(szParameters, szIniFile);
+		lstrcat(szParameters, L"\"");
+	} else {
+		lstrcat(szParameters, L"0");
+	}
+	lstrcat(szParameters, L" -standby");
+
+	SHELLEXECUTEINFO sei;
+	ZeroMemory(&sei, sizeof(SHELLEXECUTEINFO));
+	sei.cbSize = sizeof(SHELLEXECUTEINFO);
+	sei.fMask = SEE_MASK_NOZONECHECKS | SEE_MASK_FLAG_NO_UI;
+	sei.hwnd = NULL;
+	sei.lpVerb = NULL;
+	sei.lpFile = szModuleName;
+	sei.lpParameters = szParameters;
+	sei.lpDirectory = g_wchWorkingDirectory;
+	sei.nShow = SW_HIDE;
+
+	ShellExecuteEx(&sei);
+	NP2HeapFree(szParameters);
+}
+
+void LeaveResidentStandby(HWND hwnd) {
+	// now a normal window, prepare another standby instance for next launch.
+	RemoveProp(hwnd, PROP_RESIDENT_STANDBY);
+	flagResidentStandby = 0;
+	flagStartAsTrayIcon = 0;
+	StartResidentInst();
+}
+
 //=============================================================================
 //
 // RelaunchMultiInst()
@@ -8315,40 +9612,116 @@ void ShowNotificationMessage(int notifyPos, UINT uidMessage, ...) {
 // InstallFileWatching()
 //
 //
+#define FILE_WATCH_BUFFER_SIZE	(16*1024)
+
+static DWORD WINAPI FileWatchThread(LPVOID lpParam) {
+	FileWatchStatus *status = (FileWatchStatus *)lpParam;
+	BackgroundWorker *worker = &status->worker;
+	const int cchFileName = lstrlen(status->szFileName);
+	DWORD *buffer = (DWORD *)NP2HeapAlloc(FILE_WATCH_BUFFER_SIZE);
+	OVERLAPPED overlapped;
+	ZeroMemory(&overlapped, sizeof(overlapped));
+	overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	const HANDLE handles[2] = { worker->eventCancel, overlapped.hEvent };
+
+	while (buffer != NULL && overlapped.hEvent != NULL && BackgroundWorker_Continue(worker)) {
+		ResetEvent(overlapped.hEvent);
+		if (!ReadDirectoryChangesW(status->hDirectory, buffer, FILE_WATCH_BUFFER_SIZE, FALSE,
+			FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE,
+			NULL, &overlapped, NULL)) {
+			InterlockedExchange(&status->pending, 1);
+			PostMessage(worker->hwnd, APPM_CHANGENOTIFY, FileWatchNotify_Failed, 0);
+			break;
+		}
+
+		DWORD cbReturned = 0;
+		if (WaitForMultipleObjects(COUNTOF(handles), handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) {
+			CancelIo(status->hDirectory);
+			GetOverlappedResult(status->hDirectory, &overlapped, &cbReturned, TRUE);
+			break;
+		}
+
+		// zero bytes returned when buffer overflowed, changes are unknown
+		BOOL changed = !GetOverlappedResult(status->hDirectory, &overlapped, &cbReturned, FALSE) || cbReturned == 0;
+		const BYTE *ptr = (const BYTE *)buffer;
+		while (!changed) {
+			const FILE_NOTIFY_INFORMATION *info = (const FILE_NOTIFY_INFORMATION *)ptr;
+			const int cchName = (int)(info->FileNameLength / sizeof(WCHAR));
+			changed = cchName == cchFileName && StrCmpNI(info->FileName, status->szFileName, cchName) == 0;
+			if (info->NextEntryOffset == 0) {
+				break;
+			}
+			ptr += info->NextEntryOffset;
+		}
+		if (changed && InterlockedExchange(&status->pending, 1) == 0) {
+			PostMessage(worker->hwnd, APPM_CHANGENOTIFY, FileWatchNotify_Changed, 0);
+		}
+	}
+
+	if (overlapped.hEvent != NULL) {
+		CloseHandle(overlapped.hEvent);
+	}
+	if (buffer != NULL) {
+		NP2HeapFree(buffer);
+	}
+	return 0;
+}
+
+static void FileWatch_Stop(void) {
+	if (fileWatch.worker.eventCancel != NULL) {
+		BackgroundWorker_Cancel(&fileWatch.worker);
+	}
+	if (fileWatch.hDirectory != NULL) {
+		CloseHandle(fileWatch.hDirectory);
+		fileWatch.hDirectory = NULL;
+	}
+}
+
+static BOOL FileWatch_Start(void) {
+	WCHAR tchDirectory[MAX_PATH];
+	lstrcpy(tchDirectory, szCurFile);
+	PathRemoveFileSpec(tchDirectory);
+	lstrcpyn(fileWatch.szFileName, PathFindFileName(szCurFile), COUNTOF(fileWatch.szFileName));
+
+	HANDLE hDirectory = CreateFile(tchDirectory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (hDirectory == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+	if (fileWatch.worker.eventCancel == NULL) {
+		BackgroundWorker_Init(&fileWatch.worker, hwndMain);
+	}
+	fileWatch.hDirectory = hDirectory;
+	fileWatch.pending = 0;
+	fileWatch.worker.workerThread = CreateThread(NULL, 0, FileWatchThread, &fileWatch, 0, NULL);
+	if (fileWatch.worker.workerThread == NULL) {
+		CloseHandle(hDirectory);
+		fileWatch.hDirectory = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
 void InstallFileWatching(BOOL terminate) {
 	terminate = terminate || !iFileWatchingMode || StrIsEmpty(szCurFile);
 	// Terminate
 	if (bRunningWatch) {
-		if (hChangeHandle) {
-			FindCloseChangeNotification(hChangeHandle);
-			hChangeHandle = NULL;
-		}
-		if (terminate) {
-			KillTimer(NULL, ID_WATCHTIMER);
-		}
+		FileWatch_Stop();
+		KillWatchTimer();
 	}
 
 	bRunningWatch = !terminate;
 	dwChangeNotifyTime = 0;
 	if (!terminate) {
-		// Install
-		SetTimer(NULL, ID_WATCHTIMER, dwFileCheckInterval, WatchTimerProc);
-
-		WCHAR tchDirectory[MAX_PATH];
-		lstrcpy(tchDirectory, szCurFile);
-		PathRemoveFileSpec(tchDirectory);
-
 		// Save data of current file
 		if (!GetFileAttributesEx(szCurFile, GetFileExInfoStandard, &fdCurFile)) {
 			ZeroMemory(&fdCurFile, sizeof(WIN32_FIND_DATA));
 		}
 
-		hChangeHandle = iFileWatchingMethod ? NULL : FindFirstChangeNotification(tchDirectory, FALSE,
-						FILE_NOTIFY_CHANGE_FILE_NAME	| \
-						FILE_NOTIFY_CHANGE_DIR_NAME		| \
-						FILE_NOTIFY_CHANGE_ATTRIBUTES	| \
-						FILE_NOTIFY_CHANGE_SIZE			| \
-						FILE_NOTIFY_CHANGE_LAST_WRITE);
+		// Install, poll the file when directory can't be watched
+		if (iFileWatchingMethod || !FileWatch_Start()) {
+			SetWatchTimer();
+		}
 	}
 }
 
@@ -8372,21 +9745,18 @@ static void CheckCurrentFileChangedOutsideApp(void) {
 	// Check if the changes affect the current file
 	if (IsCurrentFileChangedOutsideApp()) {
 		// Shutdown current watching and give control to main window
-		if (hChangeHandle) {
-			FindCloseChangeNotification(hChangeHandle);
-			hChangeHandle = NULL;
-		}
+		FileWatch_Stop();
 		if (iFileWatchingMode == 2) {
+			// wait for the file to be quiet before reloading it
 			bRunningWatch = TRUE;
 			dwChangeNotifyTime = GetTickCount();
+			SetWatchTimer();
 		} else {
-			KillTimer(NULL, ID_WATCHTIMER);
+			KillWatchTimer();
 			bRunningWatch = FALSE;
 			dwChangeNotifyTime = 0;
 			SendMessage(hwndMain, APPM_CHANGENOTIFY, 0, 0);
 		}
-	} else if (iFileWatchingMethod == 0) {
-		FindNextChangeNotification(hChangeHandle);
 	}
 }
 
@@ -8403,27 +9773,919 @@ void CALLBACK WatchTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTim
 
 	if (bRunningWatch) {
 		if (dwChangeNotifyTime > 0 && GetTickCount() - dwChangeNotifyTime > dwAutoReloadTimeout) {
-			if (hChangeHandle) {
-				FindCloseChangeNotification(hChangeHandle);
-				hChangeHandle = NULL;
-			}
-			KillTimer(NULL, ID_WATCHTIMER);
+			KillWatchTimer();
 			bRunningWatch = FALSE;
 			dwChangeNotifyTime = 0;
 			SendMessage(hwndMain, APPM_CHANGENOTIFY, 0, 0);
 		}
 		// polling, not very efficient but useful for watching continuously updated file
-		else if (iFileWatchingMethod) {
-			if (dwChangeNotifyTime == 0) {
-				CheckCurrentFileChangedOutsideApp();
+		else if (dwChangeNotifyTime == 0) {
+			CheckCurrentFileChangedOutsideApp();
+		}
+	}
+}
+
+static void SetWatchTimer(void) {
+	bWatchTimer = TRUE;
+	if (!bTimersSuspended) {
+		SetCoalescableTimerEx(hwndMain, ID_WATCHTIMER, dwFileCheckInterval, WatchTimerProc, dwFileCheckInterval/4);
+	}
+}
+
+static void KillWatchTimer(void) {
+	bWatchTimer = FALSE;
+	KillTimer(hwndMain, ID_WATCHTIMER);
+}
+
+// polling timers are stopped while the window is minimized, the file is checked once on restore.
+static void SuspendPollingTimers(BOOL suspend) {
+	if (suspend == bTimersSuspended) {
+		return;
+	}
+	bTimersSuspended = suspend;
+	if (bWatchTimer) {
+		if (suspend) {
+			KillTimer(hwndMain, ID_WATCHTIMER);
+		} else {
+			SetWatchTimer();
+			WatchTimerProc(hwndMain, WM_TIMER, ID_WATCHTIMER, 0);
+		}
+	}
+}
+
+//=============================================================================
+//
+// AutoSave
+//
+// modified document is periodically written to a snapshot file when idle, and offered for recovery
+// on next start if the program exited unexpectedly. Only text after the first position changed since
+// last snapshot is copied and written, the file is written on a worker thread.
+//
+#define NP2_AUTOSAVE_IDLE_TIME		2000
+#define NP2_AUTOSAVE_WRITE_CHUNK_SIZE	(4*1024*1024)
+#define INI_SECTION_NAME_RECOVERY	L"Recovery"
+
+typedef struct AutoSaveStatus {
+	BackgroundWorker worker;
+	HANDLE hMutex;			// marks snapshot of this instance as in use
+	char *snapshot;
+	Sci_Position snapshotStart;
+	Sci_Position snapshotLength;
+	Sci_Position dirtyStart;	// -1 for unchanged since last snapshot
+	DWORD dwLastModified;
+	BOOL active;
+	BOOL success;
+	BOOL bDeferred;
+	BOOL bTimerArmed;		// ID_AUTOSAVETIMER only runs while there are unsaved changes
+	BOOL bSnapshotExists;
+	UINT cpEdit;
+	int iEncoding;
+	WCHAR szCurFile[MAX_PATH + 40];
+	WCHAR szDirectory[MAX_PATH];
+	WCHAR szSnapshot[MAX_PATH];
+	WCHAR szInfo[MAX_PATH];
+} AutoSaveStatus;
+
+static AutoSaveStatus autoSaveStatus;
+
+static void AutoSave_GetFilePath(LPCWSTR pszName, LPCWSTR pszExt, LPWSTR pszPath) {
+	lstrcpy(pszPath, autoSaveStatus.szDirectory);
+	PathAppend(pszPath, pszName);
+	lstrcat(pszPath, pszExt);
+}
+
+static inline void AutoSave_GetMutexName(LPCWSTR pszName, LPWSTR pszMutex) {
+	wsprintf(pszMutex, L"%s-AutoSave-%s", wchWndClass, pszName);
+}
+
+void AutoSave_Init(void) {
+	AutoSaveStatus *status = &autoSaveStatus;
+	ZeroMemory(status, sizeof(AutoSaveStatus));
+	status->dirtyStart = -1;
+	if (StrNotEmpty(tchAutoSaveDir)) {
+		PathAbsoluteFromApp(tchAutoSaveDir, status->szDirectory, COUNTOF(status->szDirectory), TRUE);
+	} else if (StrNotEmpty(szIniFile)) {
+		lstrcpy(status->szDirectory, szIniFile);
+		PathRemoveFileSpec(status->szDirectory);
+		PathAppend(status->szDirectory, L"Recovery");
+	} else {
+		GetTempPath(COUNTOF(status->szDirectory), status->szDirectory);
+		PathAppend(status->szDirectory, L"Notepad2 Recovery");
+	}
+
+	// unique name, process id can be reused by a later instance
+	WCHAR tchName[32];
+	WCHAR tchMutex[128];
+	wsprintf(tchName, L"%08X%08X", GetCurrentProcessId(), GetTickCount());
+	AutoSave_GetMutexName(tchName, tchMutex);
+	status->hMutex = CreateMutex(NULL, FALSE, tchMutex);
+	AutoSave_GetFilePath(tchName, L".txt", status->szSnapshot);
+	AutoSave_GetFilePath(tchName, L".ini", status->szInfo);
+}
+
+static DWORD WINAPI AutoSaveThread(LPVOID lpParam) {
+	AutoSaveStatus *status = (AutoSaveStatus *)lpParam;
+	BackgroundWorker *worker = &status->worker;
+
+	CreateDirectory(status->szDirectory, NULL);
+	HANDLE hFile = CreateFile(status->szSnapshot, GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	BOOL success = hFile != INVALID_HANDLE_VALUE;
+	if (success) {
+		LARGE_INTEGER offset;
+		offset.QuadPart = status->snapshotStart;
+		success = SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN);
+		const char *ptr = status->snapshot;
+		Sci_Position remaining = status->snapshotLength;
+		while (success && remaining != 0 && BackgroundWorker_Continue(worker)) {
+			const DWORD cbChunk = (DWORD)min_pos(remaining, NP2_AUTOSAVE_WRITE_CHUNK_SIZE);
+			DWORD cbWritten = 0;
+			success = WriteFile(hFile, ptr, cbChunk, &cbWritten, NULL) && cbWritten == cbChunk;
+			ptr += cbChunk;
+			remaining -= cbChunk;
+		}
+		// snapshot should survive a forced restart
+		success = success && remaining == 0 && SetEndOfFile(hFile) && FlushFileBuffers(hFile);
+		CloseHandle(hFile);
+	}
+
+	if (success) {
+		WCHAR tchValue[32];
+		LPCWSTR const pszInfo = status->szInfo;
+		WritePrivateProfileString(INI_SECTION_NAME_RECOVERY, L"File", status->szCurFile, pszInfo);
+		wsprintf(tchValue, L"%d", status->iEncoding);
+		WritePrivateProfileString(INI_SECTION_NAME_RECOVERY, L"Encoding", tchValue, pszInfo);
+		wsprintf(tchValue, L"%u", status->cpEdit);
+		success = WritePrivateProfileString(INI_SECTION_NAME_RECOVERY, L"CodePage", tchValue, pszInfo);
+	}
+
+	status->success = success;
+	PostMessage(worker->hwnd, APPM_AUTOSAVE, 0, 0);
+	return 0;
+}
+
+static BOOL AutoSave_Prepare(AutoSaveStatus *status) {
+	// whole text is written when there is no valid snapshot
+	const Sci_Position start = status->bSnapshotExists ? status->dirtyStart : 0;
+	const Sci_Position iDocLen = SciCall_GetLength();
+	const Sci_Position length = iDocLen - start;
+	char *snapshot = (char *)NP2HeapAlloc(length + 1);
+	if (snapshot == NULL) {
+		return FALSE;
+	}
+
+	// copy from Scintilla's buffer segments, without moving the gap.
+	Sci_Position position = start;
+	while (position < iDocLen) {
+		Sci_Position end = 0;
+		const char *ptr = SciCall_GetSegmentPointer(position, &end);
+		CopyMemory(snapshot + (position - start), ptr, end - position);
+		position = end;
+	}
+
+	BackgroundWorker_Init(&status->worker, hwndMain);
+	status->snapshot = snapshot;
+	status->snapshotStart = start;
+	status->snapshotLength = length;
+	status->dirtyStart = -1;
+	status->cpEdit = SciCall_GetCodePage();
+	status->iEncoding = iEncoding;
+	lstrcpy(status->szCurFile, szCurFile);
+	status->active = TRUE;
+	return TRUE;
+}
+
+static void AutoSave_Stop(AutoSaveStatus *status) {
+	if (status->active) {
+		// APPM_AUTOSAVE dispatched while waiting is ignored
+		status->active = FALSE;
+		BackgroundWorker_Destroy(&status->worker);
+		NP2HeapFree(status->snapshot);
+		status->snapshot = NULL;
+		// snapshot is incomplete
+		status->bSnapshotExists = FALSE;
+	}
+}
+
+void AutoSave_OnSnapshotWritten(void) {
+	AutoSaveStatus *status = &autoSaveStatus;
+	if (!status->active) {
+		return;
+	}
+
+	// the thread exits after posting the message
+	WaitForSingleObject(status->worker.workerThread, INFINITE);
+	BackgroundWorker_Destroy(&status->worker);
+	status->active = FALSE;
+	NP2HeapFree(status->snapshot);
+	status->snapshot = NULL;
+	status->bSnapshotExists = status->success;
+	if (!status->success && status->dirtyStart < 0) {
+		status->dirtyStart = 0;
+	}
+}
+
+// record first changed position since last snapshot
+void AutoSave_OnModified(Sci_Position position) {
+	AutoSaveStatus *status = &autoSaveStatus;
+	if (status->dirtyStart < 0 || position < status->dirtyStart) {
+		status->dirtyStart = position;
+	}
+	status->dwLastModified = GetTickCount();
+	if (!status->bTimerArmed && dwAutoSaveInterval != 0) {
+		status->bTimerArmed = TRUE;
+		SetCoalescableTimerEx(hwndMain, ID_AUTOSAVETIMER, dwAutoSaveInterval, AutoSaveTimerProc, dwAutoSaveInterval/10);
+	}
+}
+
+// document is saved, reverted to the save point or replaced, snapshot is no longer needed.
+void AutoSave_Discard(void) {
+	AutoSaveStatus *status = &autoSaveStatus;
+	AutoSave_Stop(status);
+	if (StrNotEmpty(status->szSnapshot)) {
+		DeleteFile(status->szSnapshot);
+		DeleteFile(status->szInfo);
+	}
+	status->bSnapshotExists = FALSE;
+	status->dirtyStart = -1;
+}
+
+// keep the snapshot when session ends with unsaved changes, e.g. restart for system update.
+void AutoSave_Shutdown(BOOL bKeepSnapshot) {
+	AutoSaveStatus *status = &autoSaveStatus;
+	KillTimer(hwndMain, ID_AUTOSAVETIMER);
+	status->bTimerArmed = FALSE;
+	if (bKeepSnapshot && dwAutoSaveInterval != 0 && bModified) {
+		if (status->active) {
+			WaitForSingleObject(status->worker.workerThread, INFINITE);
+			AutoSave_OnSnapshotWritten();
+		}
+		if ((status->dirtyStart >= 0 || !status->bSnapshotExists) && AutoSave_Prepare(status)) {
+			// write on current thread, posted APPM_AUTOSAVE is never handled
+			AutoSaveThread(status);
+			status->active = FALSE;
+			BackgroundWorker_Destroy(&status->worker);
+			NP2HeapFree(status->snapshot);
+			status->snapshot = NULL;
+		}
+	} else {
+		AutoSave_Discard();
+	}
+	if (status->hMutex) {
+		CloseHandle(status->hMutex);
+		status->hMutex = NULL;
+	}
+}
+
+void CALLBACK AutoSaveTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
+	UNREFERENCED_PARAMETER(uMsg);
+	UNREFERENCED_PARAMETER(dwTime);
+
+	AutoSaveStatus *status = &autoSaveStatus;
+	const BOOL bDeferred = status->bDeferred;
+	if (bDeferred) {
+		status->bDeferred = FALSE;
+		SetCoalescableTimerEx(hwnd, idEvent, dwAutoSaveInterval, AutoSaveTimerProc, dwAutoSaveInterval/10);
+	}
+	if (status->active) {
+		return;
+	}
+	if (!bModified || (status->dirtyStart < 0 && status->bSnapshotExists)) {
+		// nothing to write, armed again by next modification
+		status->bTimerArmed = FALSE;
+		KillTimer(hwnd, idEvent);
+		return;
+	}
+
+	// wait once for a pause in typing
+	if (!bDeferred && GetTickCount() - status->dwLastModified < NP2_AUTOSAVE_IDLE_TIME) {
+		status->bDeferred = TRUE;
+		SetCoalescableTimerEx(hwnd, idEvent, NP2_AUTOSAVE_IDLE_TIME, AutoSaveTimerProc, NP2_AUTOSAVE_IDLE_TIME/10);
+		return;
+	}
+
+	if (AutoSave_Prepare(status)) {
+		if (!BackgroundWorker_Start(&status->worker, AutoSaveThread, status, WorkerPriority_Low)) {
+			AutoSave_Stop(status);
+		}
+	}
+}
+
+static BOOL AutoSave_LoadSnapshot(LPCWSTR pszSnapshot, LPCWSTR pszFile, UINT cpSnapshot) {
+	HANDLE hFile = CreateFile(pszSnapshot, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize;
+	char *lpData = NULL;
+	DWORD cbData = 0;
+	if (GetFileSizeEx(hFile, &fileSize) && fileSize.HighPart == 0 && fileSize.LowPart < MAXDWORD) {
+		lpData = (char *)NP2HeapAlloc(fileSize.LowPart + 1);
+		if (lpData != NULL && !(ReadFile(hFile, lpData, fileSize.LowPart, &cbData, NULL) && cbData == fileSize.LowPart)) {
+			NP2HeapFree(lpData);
+			lpData = NULL;
+		}
+	}
+	CloseHandle(hFile);
+	if (lpData == NULL) {
+		return FALSE;
+	}
+
+	if (StrNotEmpty(pszFile) && PathFileExists(pszFile)) {
+		FileLoad(TRUE, FALSE, FALSE, FALSE, pszFile);
+	} else {
+		FileLoad(TRUE, TRUE, FALSE, FALSE, L"");
+	}
+
+	const UINT cpEdit = SciCall_GetCodePage();
+	if (cpSnapshot != cpEdit && cbData != 0) {
+		LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc((cbData + 1) * sizeof(WCHAR));
+		const int cbDataWide = MultiByteToWideChar(cpSnapshot, 0, lpData, cbData, lpDataWide, cbData + 1);
+		NP2HeapFree(lpData);
+		cbData = WideCharToMultiByte(cpEdit, 0, lpDataWide, cbDataWide, NULL, 0, NULL, NULL);
+		lpData = (char *)NP2HeapAlloc(cbData + 1);
+		WideCharToMultiByte(cpEdit, 0, lpDataWide, cbDataWide, lpData, cbData, NULL, NULL);
+		NP2HeapFree(lpDataWide);
+	}
+
+	// replace as one undo action, so the file content can be restored with undo.
+	SciCall_SetTargetRange(0, SciCall_GetLength());
+	SciCall_ReplaceTarget(cbData, lpData);
+	NP2HeapFree(lpData);
+	return TRUE;
+}
+
+// offer snapshots left by instances which didn't exit normally
+void AutoSave_Recover(void) {
+	WCHAR tchPattern[MAX_PATH];
+	AutoSave_GetFilePath(L"*", L".ini", tchPattern);
+	WIN32_FIND_DATA fd;
+	HANDLE hFind = FindFirstFile(tchPattern, &fd);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	BOOL bRecovered = bModified;
+	do {
+		WCHAR tchName[MAX_PATH];
+		WCHAR tchMutex[MAX_PATH + 64];
+		lstrcpyn(tchName, fd.cFileName, COUNTOF(tchName));
+		PathRemoveExtension(tchName);
+		AutoSave_GetMutexName(tchName, tchMutex);
+		HANDLE hMutex = OpenMutex(SYNCHRONIZE, FALSE, tchMutex);
+		if (hMutex != NULL) {
+			// owner is still running
+			CloseHandle(hMutex);
+			continue;
+		}
+
+		WCHAR tchInfo[MAX_PATH];
+		WCHAR tchSnapshot[MAX_PATH];
+		WCHAR tchFile[MAX_PATH + 40];
+		AutoSave_GetFilePath(tchName, L".ini", tchInfo);
+		AutoSave_GetFilePath(tchName, L".txt", tchSnapshot);
+		GetPrivateProfileString(INI_SECTION_NAME_RECOVERY, L"File", L"", tchFile, COUNTOF(tchFile), tchInfo);
+		const UINT cpSnapshot = GetPrivateProfileInt(INI_SECTION_NAME_RECOVERY, L"CodePage", SC_CP_UTF8, tchInfo);
+		if (!bRecovered) {
+			WCHAR tch[MAX_PATH + 40];
+			if (StrNotEmpty(tchFile)) {
+				lstrcpy(tch, tchFile);
+			} else {
+				GetString(IDS_UNTITLED, tch, COUNTOF(tch));
 			}
+			if (MsgBoxAsk(MB_YESNO, IDS_AUTOSAVE_RECOVER, tch) == IDYES) {
+				bRecovered = AutoSave_LoadSnapshot(tchSnapshot, tchFile, cpSnapshot);
+				if (!bRecovered) {
+					// keep it for next start
+					continue;
+				}
+			}
+			DeleteFile(tchSnapshot);
+			DeleteFile(tchInfo);
 		}
-		// Check Change Notification Handle
-		// TODO: notification not fired for continuously updated file
-		else if (WAIT_OBJECT_0 == WaitForSingleObject(hChangeHandle, 0)) {
-			CheckCurrentFileChangedOutsideApp();
+	} while (FindNextFile(hFind, &fd));
+	FindClose(hFind);
+}
+
+//=============================================================================
+//
+// View State Cache
+//
+// when a file is closed, its encoding, lexer, selection, scroll position, folded lines and bookmarks
+// are written to a small file keyed by the path. Reopening the unchanged file (same size and
+// modification time) skips encoding and lexer detection, and brings back the view.
+//
+#define NP2_VIEWSTATE_MAX_LINES		512
+#define NP2_VIEWSTATE_EXPIRE_DAYS	90
+#define INI_SECTION_NAME_VIEWSTATE	L"ViewState"
+
+typedef struct ViewState {
+	int iEncoding;
+	int rid;
+	int lang;
+	Sci_Position iAnchorPos;
+	Sci_Position iCurPos;
+	Sci_Line iDocTopLine;
+	int iXOffset;
+	WCHAR tchFolds[NP2_VIEWSTATE_MAX_LINES*21];
+	WCHAR tchBookmarks[NP2_VIEWSTATE_MAX_LINES*21];
+} ViewState;
+
+static ViewState viewStateCache;
+
+static LONGLONG ViewState_GetInt64(LPCWSTR lpSection, LPCWSTR lpKeyName, LPCWSTR pszInfo) {
+	WCHAR tchValue[32];
+	GetPrivateProfileString(lpSection, lpKeyName, L"0", tchValue, COUNTOF(tchValue), pszInfo);
+	return _wtoi64(tchValue);
+}
+
+static void ViewState_SetInt64(LPCWSTR lpSection, LPCWSTR lpKeyName, LONGLONG value, LPCWSTR pszInfo) {
+	WCHAR tchValue[32];
+	_i64tow(value, tchValue, 10);
+	WritePrivateProfileString(lpSection, lpKeyName, tchValue, pszInfo);
+}
+
+static void ViewState_FormatLines(LPWSTR p, Sci_Line line, BOOL bFolds) {
+	*p = L'\0';
+	for (int count = 0; line >= 0 && count < NP2_VIEWSTATE_MAX_LINES; count++) {
+		if (count != 0) {
+			*p++ = L',';
+		}
+		_i64tow(line, p, 10);
+		p += lstrlen(p);
+		line = bFolds ? SciCall_ContractedFoldNext(line + 1) : SciCall_MarkerNext(line + 1, MarkerBitmask_Bookmark);
+	}
+}
+
+static void ViewState_Capture(ViewState *state) {
+	state->iEncoding = iOriginalEncoding;
+	state->rid = pLexCurrent->rid;
+	state->lang = np2LexLangIndex;
+	state->iAnchorPos = SciCall_GetAnchor();
+	state->iCurPos = SciCall_GetCurrentPos();
+	state->iDocTopLine = SciCall_DocLineFromVisible(SciCall_GetFirstVisibleLine());
+	state->iXOffset = SciCall_GetXOffset();
+	ViewState_FormatLines(state->tchFolds, SciCall_ContractedFoldNext(0), TRUE);
+	ViewState_FormatLines(state->tchBookmarks, SciCall_MarkerNext(0, MarkerBitmask_Bookmark), FALSE);
+}
+
+static void ViewState_Restore(const ViewState *state) {
+	int64_t lines[NP2_VIEWSTATE_MAX_LINES];
+	const Sci_Line lineCount = SciCall_GetLineCount();
+	int count = ParseCommaList64(state->tchFolds, lines, COUNTOF(lines));
+	for (int i = 0; i < count; i++) {
+		const Sci_Line line = (Sci_Line)lines[i];
+		if (line >= 0 && line < lineCount) {
+			// folds are recorded in ascending order, only style up to the last one.
+			SciCall_EnsureStyledTo(SciCall_PositionFromLine(line + 1));
+			if ((SciCall_GetFoldLevel(line) & SC_FOLDLEVELHEADERFLAG) && SciCall_GetFoldExpanded(line)) {
+				SciCall_FoldLine(line, SC_FOLDACTION_CONTRACT);
+			}
+		}
+	}
+
+	count = ParseCommaList64(state->tchBookmarks, lines, COUNTOF(lines));
+	for (int i = 0; i < count; i++) {
+		const Sci_Line line = (Sci_Line)lines[i];
+		if (line >= 0 && line < lineCount) {
+			SciCall_MarkerAdd(line, MarkerNumber_Bookmark);
 		}
 	}
+
+	const Sci_Line iTopLine = min_pos(state->iDocTopLine, lineCount - 1);
+	SciCall_SetSel(state->iAnchorPos, state->iCurPos);
+	SciCall_EnsureVisible(iTopLine);
+	SciCall_SetFirstVisibleLine(SciCall_VisibleFromDocLine(iTopLine));
+	SciCall_SetXOffset(state->iXOffset);
+}
+
+static void ViewState_Read(ViewState *state, LPCWSTR lpSection, LPCWSTR pszInfo) {
+	state->iEncoding = GetPrivateProfileInt(lpSection, L"Encoding", CPI_DEFAULT, pszInfo);
+	state->rid = GetPrivateProfileInt(lpSection, L"Lexer", NP2LEX_TEXTFILE, pszInfo);
+	state->lang = GetPrivateProfileInt(lpSection, L"Language", 0, pszInfo);
+	state->iAnchorPos = (Sci_Position)ViewState_GetInt64(lpSection, L"Anchor", pszInfo);
+	state->iCurPos = (Sci_Position)ViewState_GetInt64(lpSection, L"Caret", pszInfo);
+	state->iDocTopLine = (Sci_Line)ViewState_GetInt64(lpSection, L"TopLine", pszInfo);
+	state->iXOffset = GetPrivateProfileInt(lpSection, L"XOffset", 0, pszInfo);
+	GetPrivateProfileString(lpSection, L"Folds", L"", state->tchFolds, COUNTOF(state->tchFolds), pszInfo);
+	GetPrivateProfileString(lpSection, L"Bookmarks", L"", state->tchBookmarks, COUNTOF(state->tchBookmarks), pszInfo);
+}
+
+static void ViewState_Write(const ViewState *state, LPCWSTR lpSection, LPCWSTR pszInfo) {
+	WCHAR tchValue[32];
+	wsprintf(tchValue, L"%d", state->iEncoding);
+	WritePrivateProfileString(lpSection, L"Encoding", tchValue, pszInfo);
+	wsprintf(tchValue, L"%d", state->rid);
+	WritePrivateProfileString(lpSection, L"Lexer", tchValue, pszInfo);
+	wsprintf(tchValue, L"%d", state->lang);
+	WritePrivateProfileString(lpSection, L"Language", tchValue, pszInfo);
+	ViewState_SetInt64(lpSection, L"Anchor", state->iAnchorPos, pszInfo);
+	ViewState_SetInt64(lpSection, L"Caret", state->iCurPos, pszInfo);
+	ViewState_SetInt64(lpSection, L"TopLine", state->iDocTopLine, pszInfo);
+	wsprintf(tchValue, L"%d", state->iXOffset);
+	WritePrivateProfileString(lpSection, L"XOffset", tchValue, pszInfo);
+	WritePrivateProfileString(lpSection, L"Folds", state->tchFolds, pszInfo);
+	WritePrivateProfileString(lpSection, L"Bookmarks", state->tchBookmarks, pszInfo);
+}
+
+static void ViewState_GetDirectory(LPCWSTR pszName, LPWSTR pszDir) {
+	if (StrNotEmpty(szIniFile)) {
+		lstrcpy(pszDir, szIniFile);
+		PathRemoveFileSpec(pszDir);
+		PathAppend(pszDir, pszName);
+	} else {
+		WCHAR tchName[32];
+		wsprintf(tchName, L"Notepad2 %s", pszName);
+		GetTempPath(MAX_PATH, pszDir);
+		PathAppend(pszDir, tchName);
+	}
+}
+
+// FNV-1a hash of case folded path as file name
+static void ViewState_GetFilePath(LPCWSTR pszFile, LPWSTR pszInfo) {
+	WCHAR tchFile[MAX_PATH];
+	lstrcpyn(tchFile, pszFile, COUNTOF(tchFile));
+	CharLower(tchFile);
+	UINT64 hash = UINT64_C(0xCBF29CE484222325);
+	for (LPCWSTR p = tchFile; *p; p++) {
+		hash = (hash ^ *p) * UINT64_C(0x100000001B3);
+	}
+
+	WCHAR tchName[32];
+	wsprintf(tchName, L"%08X%08X.ini", (UINT)(hash >> 32), (UINT)hash);
+	ViewState_GetDirectory(L"ViewState", pszInfo);
+	PathAppend(pszInfo, tchName);
+}
+
+static BOOL ViewState_GetFileInfo(LPCWSTR pszFile, LONGLONG *size, LONGLONG *time) {
+	WIN32_FILE_ATTRIBUTE_DATA fad;
+	if (!GetFileAttributesEx(pszFile, GetFileExInfoStandard, &fad)) {
+		return FALSE;
+	}
+	*size = ((LONGLONG)fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+	*time = ((LONGLONG)fad.ftLastWriteTime.dwHighDateTime << 32) | fad.ftLastWriteTime.dwLowDateTime;
+	return TRUE;
+}
+
+// remove entries not updated for a long time, once per process.
+static void ViewState_Prune(void) {
+	static BOOL pruned = FALSE;
+	if (pruned) {
+		return;
+	}
+	pruned = TRUE;
+
+	WCHAR tchDir[MAX_PATH];
+	WCHAR tchPath[MAX_PATH];
+	ViewState_GetDirectory(L"ViewState", tchDir);
+	lstrcpy(tchPath, tchDir);
+	PathAppend(tchPath, L"*.ini");
+	WIN32_FIND_DATA fd;
+	HANDLE hFind = FindFirstFile(tchPath, &fd);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	FILETIME ftNow;
+	GetSystemTimeAsFileTime(&ftNow);
+	const ULONGLONG now = ((ULONGLONG)ftNow.dwHighDateTime << 32) | ftNow.dwLowDateTime;
+	const ULONGLONG expire = (ULONGLONG)NP2_VIEWSTATE_EXPIRE_DAYS * 24 * 3600 * 10000000;
+	do {
+		const ULONGLONG time = ((ULONGLONG)fd.ftLastWriteTime.dwHighDateTime << 32) | fd.ftLastWriteTime.dwLowDateTime;
+		if (now - time > expire) {
+			lstrcpy(tchPath, tchDir);
+			PathAppend(tchPath, fd.cFileName);
+			DeleteFile(tchPath);
+		}
+	} while (FindNextFile(hFind, &fd));
+	FindClose(hFind);
+}
+
+// cached state is only used when the file is not changed since it's recorded.
+BOOL ViewState_Load(LPCWSTR pszFile, int *piSrcEncoding) {
+	if (!bViewStateCache) {
+		return FALSE;
+	}
+
+	LONGLONG size;
+	LONGLONG time;
+	WCHAR tchInfo[MAX_PATH];
+	WCHAR tchFile[MAX_PATH];
+	ViewState_GetFilePath(pszFile, tchInfo);
+	GetPrivateProfileString(INI_SECTION_NAME_VIEWSTATE, L"File", L"", tchFile, COUNTOF(tchFile), tchInfo);
+	if (!StrCaseEqual(tchFile, pszFile) || !ViewState_GetFileInfo(pszFile, &size, &time)
+		|| size != ViewState_GetInt64(INI_SECTION_NAME_VIEWSTATE, L"Size", tchInfo)
+		|| time != ViewState_GetInt64(INI_SECTION_NAME_VIEWSTATE, L"Time", tchInfo)) {
+		return FALSE;
+	}
+
+	ViewState *state = &viewStateCache;
+	ViewState_Read(state, INI_SECTION_NAME_VIEWSTATE, tchInfo);
+	if (!Encoding_IsValid(state->iEncoding)) {
+		return FALSE;
+	}
+	// UTF-16 file is loaded with the encoding without BOM, the BOM is detected again.
+	switch (state->iEncoding) {
+	case CPI_UNICODEBOM:
+		*piSrcEncoding = CPI_UNICODE;
+		break;
+	case CPI_UNICODEBEBOM:
+		*piSrcEncoding = CPI_UNICODEBE;
+		break;
+	default:
+		*piSrcEncoding = state->iEncoding;
+		break;
+	}
+	return TRUE;
+}
+
+void ViewState_ApplyLexer(void) {
+	Style_SetLexerFromIDEx(viewStateCache.rid, viewStateCache.lang);
+}
+
+void ViewState_ApplyView(void) {
+	ViewState_Restore(&viewStateCache);
+}
+
+// record current file before it's closed, document with discarded changes doesn't match the file.
+void ViewState_Save(void) {
+	LONGLONG size;
+	LONGLONG time;
+	if (!bViewStateCache || StrIsEmpty(szCurFile) || HexView_IsActive() || Session_IsPending() || bModified
+		|| !ViewState_GetFileInfo(szCurFile, &size, &time)) {
+		return;
+	}
+
+	WCHAR tchInfo[MAX_PATH];
+	WCHAR tchDir[MAX_PATH];
+	ViewState_Prune();
+	ViewState_GetDirectory(L"ViewState", tchDir);
+	CreateDirectory(tchDir, NULL);
+	ViewState_GetFilePath(szCurFile, tchInfo);
+
+	ViewState *state = &viewStateCache;
+	ViewState_Capture(state);
+	WritePrivateProfileString(INI_SECTION_NAME_VIEWSTATE, L"File", szCurFile, tchInfo);
+	ViewState_SetInt64(INI_SECTION_NAME_VIEWSTATE, L"Size", size, tchInfo);
+	ViewState_SetInt64(INI_SECTION_NAME_VIEWSTATE, L"Time", time, tchInfo);
+	ViewState_Write(state, INI_SECTION_NAME_VIEWSTATE, tchInfo);
+}
+
+//=============================================================================
+//
+// Session
+//
+// when the system restarts or shuts down, each window records its file, view state and window position
+// together with a preview of the visible text. On next start, one process per recorded window is launched,
+// the window shows the preview immediately, the file is loaded when the window is activated.
+//
+#define NP2_SESSION_PREVIEW_SIZE	(64*1024)
+#define INI_SECTION_NAME_SESSION	L"Session"
+
+typedef struct SessionEntry {
+	BOOL pending;			// preview is shown, file not loaded yet
+	UINT cpPreview;
+	char *preview;
+	DWORD cbPreview;
+	WCHAR szFile[MAX_PATH];
+	ViewState view;
+} SessionEntry;
+
+static SessionEntry sessionEntry;
+
+// started without file, launch one instance for each recorded window and restore the first one here.
+void RestoreSession(void) {
+	if (!bRestoreSession || lpFileArg || lpSessionArg || flagResidentStandby || flagStartAsTrayIcon
+		|| flagNewFromClipboard || flagPasteBoard) {
+		return;
+	}
+
+	WCHAR tchDir[MAX_PATH];
+	WCHAR tchPattern[MAX_PATH];
+	ViewState_GetDirectory(L"Session", tchDir);
+	lstrcpy(tchPattern, tchDir);
+	PathAppend(tchPattern, L"*.ini");
+	WIN32_FIND_DATA fd;
+	HANDLE hFind = FindFirstFile(tchPattern, &fd);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	WCHAR szModuleName[MAX_PATH];
+	GetModuleFileName(NULL, szModuleName, COUNTOF(szModuleName));
+	LPWSTR szParameters = (LPWSTR)NP2HeapAlloc(sizeof(WCHAR) * 1024);
+	do {
+		// claim the entry by renaming it, so it's restored only once.
+		WCHAR tchInfo[MAX_PATH];
+		WCHAR tchClaimed[MAX_PATH];
+		lstrcpy(tchInfo, tchDir);
+		PathAppend(tchInfo, fd.cFileName);
+		lstrcpy(tchClaimed, tchInfo);
+		PathRenameExtension(tchClaimed, L".restore");
+		if (!MoveFile(tchInfo, tchClaimed)) {
+			continue;
+		}
+
+		if (lpSessionArg == NULL) {
+			lpSessionArg = StrDup(tchClaimed);
+			flagNoReuseWindow = 1;
+			flagSingleFileInstance = 0;
+			continue;
+		}
+
+		wsprintf(szParameters, L"-appid=\"%s\" -sysmru=%i -f", g_wchAppUserModelID, (flagUseSystemMRU == 2));
+		if (StrNotEmpty(szIniFile)) {
+			lstrcat(szParameters, L" \"");
+			lstrcat(szParameters, szIniFile);
+			lstrcat(szParameters, L"\"");
+		} else {
+			lstrcat(szParameters, L"0");
+		}
+		lstrcat(szParameters, L" -session=\"");
+		lstrcat(szParameters, tchClaimed);
+		lstrcat(szParameters, L"\"");
+
+		SHELLEXECUTEINFO sei;
+		ZeroMemory(&sei, sizeof(SHELLEXECUTEINFO));
+		sei.cbSize = sizeof(SHELLEXECUTEINFO);
+		sei.fMask = SEE_MASK_NOZONECHECKS | SEE_MASK_FLAG_NO_UI;
+		sei.hwnd = NULL;
+		sei.lpVerb = NULL;
+		sei.lpFile = szModuleName;
+		sei.lpParameters = szParameters;
+		sei.lpDirectory = g_wchWorkingDirectory;
+		// keep current instance in foreground
+		sei.nShow = SW_SHOWNOACTIVATE;
+		ShellExecuteEx(&sei);
+	} while (FindNextFile(hFind, &fd));
+	FindClose(hFind);
+	NP2HeapFree(szParameters);
+}
+
+// read the entry before main window is created, files of the entry are deleted.
+BOOL Session_LoadEntry(LPCWSTR pszInfo) {
+	SessionEntry *entry = &sessionEntry;
+	GetPrivateProfileString(INI_SECTION_NAME_SESSION, L"File", L"", entry->szFile, COUNTOF(entry->szFile), pszInfo);
+	entry->cpPreview = GetPrivateProfileInt(INI_SECTION_NAME_SESSION, L"CodePage", SC_CP_UTF8, pszInfo);
+	ViewState_Read(&entry->view, INI_SECTION_NAME_SESSION, pszInfo);
+
+	WCHAR tchValue[64];
+	GetPrivateProfileString(INI_SECTION_NAME_SESSION, L"Window", L"", tchValue, COUNTOF(tchValue), pszInfo);
+	int cord[5] = { 0 };
+	if (ParseCommaList(tchValue, cord, COUNTOF(cord)) == 5 && cord[2] > 0 && cord[3] > 0) {
+		flagDefaultPos = 0;
+		wi.x = cord[0];
+		wi.y = cord[1];
+		wi.cx = cord[2];
+		wi.cy = cord[3];
+		wi.max = cord[4] != 0;
+	}
+
+	WCHAR tchPreview[MAX_PATH];
+	lstrcpy(tchPreview, pszInfo);
+	PathRenameExtension(tchPreview, L".txt");
+	HANDLE hFile = CreateFile(tchPreview, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile != INVALID_HANDLE_VALUE) {
+		char *preview = (char *)NP2HeapAlloc(NP2_SESSION_PREVIEW_SIZE + 1);
+		DWORD cbRead = 0;
+		if (ReadFile(hFile, preview, NP2_SESSION_PREVIEW_SIZE, &cbRead, NULL)) {
+			entry->preview = preview;
+			entry->cbPreview = cbRead;
+		} else {
+			NP2HeapFree(preview);
+		}
+		CloseHandle(hFile);
+	}
+	DeleteFile(tchPreview);
+	DeleteFile(pszInfo);
+
+	entry->pending = StrNotEmpty(entry->szFile) && PathIsFile(entry->szFile);
+	if (!entry->pending) {
+		Session_Discard();
+	}
+	return entry->pending;
+}
+
+BOOL Session_IsPending(void) {
+	return sessionEntry.pending;
+}
+
+// cheap stand-in for the file: file name in title, first screen of text with the lexer, locked for editing.
+void Session_ShowPreview(void) {
+	const SessionEntry *entry = &sessionEntry;
+	lstrcpy(szCurFile, entry->szFile);
+	SetDlgItemText(hwndMain, IDC_FILENAME, szCurFile);
+	SetDlgItemInt(hwndMain, IDC_REUSELOCK, GetTickCount(), FALSE);
+	FileVars_Init(NULL, 0, &fvCurFile);
+	SciCall_SetCodePage(entry->cpPreview);
+	EditSetNewText(entry->preview, entry->cbPreview, 1);
+	Style_SetLexerFromIDEx(entry->view.rid, entry->view.lang);
+	bLockedForEditing = TRUE;
+	SciCall_SetReadOnly(TRUE);
+	bModified = FALSE;
+	UpdateStatusBarCache(STATUS_CODEPAGE);
+	UpdateStatusBarCache(STATUS_EOLMODE);
+	UpdateStatusBarCacheLineColumn();
+	UpdateDocumentModificationStatus();
+}
+
+void Session_LoadPending(void) {
+	SessionEntry *entry = &sessionEntry;
+	if (!entry->pending) {
+		return;
+	}
+
+	// same file name as the preview, current lexer is kept.
+	WCHAR szFile[MAX_PATH];
+	lstrcpy(szFile, entry->szFile);
+	if (FileLoad(TRUE, FALSE, FALSE, FALSE, szFile)) {
+		ViewState_Restore(&entry->view);
+	}
+}
+
+// preview is replaced with another document.
+void Session_Discard(void) {
+	SessionEntry *entry = &sessionEntry;
+	entry->pending = FALSE;
+	if (entry->preview) {
+		NP2HeapFree(entry->preview);
+		entry->preview = NULL;
+		entry->cbPreview = 0;
+	}
+}
+
+// record current window when session ends, window with unsaved changes is left for AutoSave recovery.
+void Session_Save(void) {
+	if (!bRestoreSession) {
+		return;
+	}
+
+	SessionEntry *entry = &sessionEntry;
+	if (!entry->pending) {
+		if (StrIsEmpty(szCurFile) || HexView_IsActive() || (bModified && dwAutoSaveInterval != 0)) {
+			return;
+		}
+		lstrcpy(entry->szFile, szCurFile);
+		entry->cpPreview = SciCall_GetCodePage();
+		ViewState_Capture(&entry->view);
+
+		const Sci_Position iStartPos = SciCall_PositionFromLine(entry->view.iDocTopLine);
+		const Sci_Position iEndPos = SciCall_PositionFromLine(entry->view.iDocTopLine + SciCall_LinesOnScreen() + 1);
+		entry->cbPreview = (DWORD)min_pos(iEndPos - iStartPos, NP2_SESSION_PREVIEW_SIZE);
+		entry->preview = (char *)SciCall_GetRangePointer(iStartPos, entry->cbPreview);
+	}
+
+	WCHAR tchDir[MAX_PATH];
+	WCHAR tchName[32];
+	WCHAR tchInfo[MAX_PATH];
+	WCHAR tchPreview[MAX_PATH];
+	ViewState_GetDirectory(L"Session", tchDir);
+	CreateDirectory(tchDir, NULL);
+	wsprintf(tchName, L"%08X%08X", GetCurrentProcessId(), GetTickCount());
+	PathCombine(tchInfo, tchDir, tchName);
+	lstrcat(tchInfo, L".ini");
+	PathCombine(tchPreview, tchDir, tchName);
+	lstrcat(tchPreview, L".txt");
+
+	HANDLE hFile = CreateFile(tchPreview, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile != INVALID_HANDLE_VALUE) {
+		DWORD cbWritten = 0;
+		WriteFile(hFile, entry->preview, entry->cbPreview, &cbWritten, NULL);
+		CloseHandle(hFile);
+	}
+	if (!entry->pending) {
+		// pointer into Scintilla's buffer
+		entry->preview = NULL;
+		entry->cbPreview = 0;
+	}
+
+	WCHAR tchValue[64];
+	WritePrivateProfileString(INI_SECTION_NAME_SESSION, L"File", entry->szFile, tchInfo);
+	wsprintf(tchValue, L"%u", entry->cpPreview);
+	WritePrivateProfileString(INI_SECTION_NAME_SESSION, L"CodePage", tchValue, tchInfo);
+	ViewState_Write(&entry->view, INI_SECTION_NAME_SESSION, tchInfo);
+	wsprintf(tchValue, L"%d,%d,%d,%d,%d", wi.x, wi.y, wi.cx, wi.cy, wi.max);
+	WritePrivateProfileString(INI_SECTION_NAME_SESSION, L"Window", tchValue, tchInfo);
+}
+
+//=============================================================================
+//
+// UpdateUITimerProc()
+//
+//
+void CALLBACK UpdateUITimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
+	UNREFERENCED_PARAMETER(uMsg);
+	UNREFERENCED_PARAMETER(dwTime);
+
+	KillTimer(hwnd, idEvent);
+	const UINT pending = pendingUIUpdate;
+	pendingUIUpdate = 0;
+	if (pending & PendingUIUpdate_Toolbar) {
+		UpdateToolbar();
+	}
+	if (pending & PendingUIUpdate_Statusbar) {
+		UpdateStatusbar();
+	}
 }
 
 //=============================================================================
@@ -8432,12 +10694,11 @@ void CALLBACK WatchTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTim
 //
 //
 void CALLBACK PasteBoardTimer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
-	UNREFERENCED_PARAMETER(hwnd);
 	UNREFERENCED_PARAMETER(uMsg);
-	UNREFERENCED_PARAMETER(idEvent);
 	UNREFERENCED_PARAMETER(dwTime);
 
-	if (dwLastCopyTime > 0 && GetTickCount() - dwLastCopyTime > 200) {
+	KillTimer(hwnd, idEvent);
+	if (dwLastCopyTime > 0) {
 		if (SciCall_CanPaste()) {
 			const BOOL back = autoCompletionConfig.bIndentText;
 			autoCompletionConfig.bIndentText = FALSE;
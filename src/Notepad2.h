@@ -59,6 +59,10 @@ typedef struct NP2PARAMS {
 #define IDC_EDITFRAME		0xFB04
 #define IDC_FILENAME		0xFB05
 #define IDC_REUSELOCK		0xFB06
+#define IDC_HEXVIEW			0xFB07
+#define IDC_MINIMAP			0xFB08
+// window property of hidden standby instance
+#define PROP_RESIDENT_STANDBY	L"NP2Standby"
 
 // submenu in popup menu, IDR_POPUPMENU
 #define IDP_POPUP_SUBMENU_EDIT	0
@@ -83,9 +87,23 @@ typedef struct NP2PARAMS {
 #define APPM_CHANGENOTIFY			(WM_APP + 2)	// file change notifications
 //#define APPM_CHANGENOTIFYCLEAR	(WM_APP + 3)
 #define APPM_TRAYMESSAGE			(WM_APP + 4)	// callback message from system tray
+#define APPM_DOCWORDINDEX			(WM_APP + 5)	// document word index for auto-completion is built
+#define APPM_SIGNATUREINDEX			(WM_APP + 6)	// function signature index for call tips is built
+#define APPM_AUTOSAVE				(WM_APP + 7)	// snapshot of modified document is written
+#define APPM_FINDINFILES			(WM_APP + 8)	// matches from a searched file, or search is finished
+#define APPM_FILEMRU_RESOLVED		(WM_APP + 9)	// icon and state of a recent file are resolved
+#define APPM_SESSIONLOAD			(WM_APP + 10)	// restored window is activated, load the file
+#define APPM_PIPESOURCE				(WM_APP + 11)	// text is read from stdin or a named pipe, or reading is finished
+#define APPM_DOCSTATISTICS			(WM_APP + 12)	// document statistics is counted
+#define APPM_AUTOMATION				(WM_APP + 13)	// batch of commands is received from automation pipe
 
 #define ID_WATCHTIMER				0xA000	// file watch timer
 #define ID_PASTEBOARDTIMER			0xA001	// paste board timer
+#define ID_AUTOSAVETIMER			0xA002	// auto save timer
+#define ID_FINDINFILESTIMER			0xA003	// find in files progress timer
+#define ID_UPDATEUITIMER			0xA004	// coalesced toolbar and statusbar update timer
+#define ID_MACROREPLAYTIMER			0xA005	// macro replay with timing
+#define ID_CSVINDEXTIMER			0xA006	// CSV column index in slices
 
 #define REUSEWINDOWLOCKTIMEOUT		1000	// Reuse Window Lock Timeout
 
@@ -126,8 +144,12 @@ extern WCHAR szCurFile[MAX_PATH + 40];
 BOOL InitApplication(HINSTANCE hInstance);
 void InitInstance(HINSTANCE hInstance, int nCmdShow);
 BOOL ActivatePrevInst(void);
+BOOL ActivateResidentInst(void);
+void StartResidentInst(void);
+void LeaveResidentStandby(HWND hwnd);
 void GetRelaunchParameters(LPWSTR szParameters, LPCWSTR lpszFile, BOOL newWind, BOOL emptyWind);
 BOOL RelaunchMultiInst(void);
+void RestoreSession(void);
 BOOL RelaunchElevated(void);
 void SnapToDefaultPos(HWND hwnd);
 void ShowNotifyIcon(HWND hwnd, BOOL bAdd);
@@ -141,6 +163,26 @@ void InstallFileWatching(BOOL terminate);
 void CALLBACK WatchTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
 void CALLBACK PasteBoardTimer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
 
+void AutoSave_Init(void);
+void AutoSave_Recover(void);
+void AutoSave_OnModified(Sci_Position position);
+void AutoSave_OnSnapshotWritten(void);
+void AutoSave_Discard(void);
+void AutoSave_Shutdown(BOOL bKeepSnapshot);
+void CALLBACK AutoSaveTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
+
+BOOL ViewState_Load(LPCWSTR pszFile, int *piSrcEncoding);
+void ViewState_ApplyLexer(void);
+void ViewState_ApplyView(void);
+void ViewState_Save(void);
+
+BOOL Session_LoadEntry(LPCWSTR pszInfo);
+BOOL Session_IsPending(void);
+void Session_ShowPreview(void);
+void Session_LoadPending(void);
+void Session_Discard(void);
+void Session_Save(void);
+
 void LoadSettings(void);
 void SaveSettingsNow(BOOL bOnlySaveStyle, BOOL bQuiet);
 void SaveSettings(BOOL bSaveSettingsNow);
@@ -161,6 +203,7 @@ void UpdateStatusbar(void);
 void UpdateStatusBarCache(int item);
 void UpdateStatusBarWidth(void);
 void UpdateToolbar(void);
+void CALLBACK UpdateUITimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
 void UpdateFoldMarginWidth(void);
 void UpdateLineNumberWidth(void);
 void UpdateBookmarkMarginWidth(void);
@@ -180,6 +223,9 @@ typedef struct EditFileIOStatus {
 
 	BOOL bFileTooBig;	// load output
 	BOOL bUnicodeErr;	// load output
+	BOOL bLoadCancelled;// load output, cancelled with Esc
+	BOOL bCompressed;	// load output, decompressed from gzip or zstd file
+	BOOL bReload;		// load input, apply changes to current document to keep undo history
 
 	// inconsistent line endings
 	BOOL bLineEndingsDefaultNo; // set default button to "No"
@@ -192,6 +238,12 @@ typedef struct EditFileIOStatus {
 
 BOOL FileIO(BOOL fLoad, LPWSTR pszFile, BOOL bFlag, EditFileIOStatus *status);
 BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWSTR lpszFile);
+BOOL FileLoadHexView(LPCWSTR lpszFile, BOOL bLocked);
+// NULL for stdin
+BOOL FileLoadPipe(BOOL bDontSave, LPCWSTR lpszPipe);
+// part of the file, range is updated to the loaded part.
+struct EditFileRange;
+BOOL FileLoadRange(BOOL bDontSave, LPCWSTR lpszFile, struct EditFileRange *range);
 BOOL FileSave(BOOL bSaveAlways, BOOL bAsk, BOOL bSaveAs, BOOL bSaveCopy);
 BOOL OpenFileDlg(HWND hwnd, LPWSTR lpstrFile, int cchFile, LPCWSTR lpstrInitialDir);
 BOOL SaveFileDlg(HWND hwnd, BOOL Untitled, LPWSTR lpstrFile, int cchFile, LPCWSTR lpstrInitialDir);
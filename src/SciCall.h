@@ -187,6 +187,14 @@ NP2_inline Sci_Position SciCall_ReplaceTargetEx(BOOL regex, Sci_Position length,
 	return SciCall(regex ? SCI_REPLACETARGETRE : SCI_REPLACETARGET, length, (LPARAM)text);
 }
 
+NP2_inline Sci_Position SciCall_SubstituteTargetRE(const char *text, char *substituted) {
+	return SciCall(SCI_SUBSTITUTETARGETRE, (WPARAM)text, (LPARAM)substituted);
+}
+
+NP2_inline Sci_Position SciCall_ReplaceRanges(Sci_Position count, const struct Sci_TextReplacement *ranges) {
+	return SciCall(SCI_REPLACERANGES, count, (LPARAM)ranges);
+}
+
 // Overtype
 
 NP2_inline BOOL SciCall_GetOvertype(void) {
@@ -261,6 +269,24 @@ NP2_inline void SciCall_EndUndoAction(void) {
 	SciCall(SCI_ENDUNDOACTION, 0, 0);
 }
 
+NP2_inline void SciCall_BeginBulkModification(void) {
+	SciCall(SCI_BEGINBULKMODIFICATION, 0, 0);
+}
+
+NP2_inline void SciCall_EndBulkModification(void) {
+	SciCall(SCI_ENDBULKMODIFICATION, 0, 0);
+}
+
+// Macro recording
+
+NP2_inline void SciCall_StartRecord(void) {
+	SciCall(SCI_STARTRECORD, 0, 0);
+}
+
+NP2_inline void SciCall_StopRecord(void) {
+	SciCall(SCI_STOPRECORD, 0, 0);
+}
+
 // Selection and information
 
 NP2_inline Sci_Position SciCall_GetLength(void) {
@@ -275,6 +301,10 @@ NP2_inline void SciCall_AllocateLines(Sci_Line lineCount) {
 	SciCall(SCI_ALLOCATELINES, lineCount, 0);
 }
 
+NP2_inline void SciCall_SetLargePages(BOOL useLargePages) {
+	SciCall(SCI_SETLARGEPAGES, useLargePages, 0);
+}
+
 NP2_inline void SciCall_SetSel(Sci_Position anchor, Sci_Position caret) {
 	SciCall(SCI_SETSEL, anchor, caret);
 }
@@ -423,6 +453,22 @@ NP2_inline void SciCall_CountCharactersAndColumns(struct Sci_TextToFind *ft) {
 	SciCall(SCI_COUNTCHARACTERSANDCOLUMNS, 0, (LPARAM)ft);
 }
 
+NP2_inline int SciCall_GetLineCharacterIndex(void) {
+	return (int)SciCall(SCI_GETLINECHARACTERINDEX, 0, 0);
+}
+
+NP2_inline void SciCall_AllocateLineCharacterIndex(int lineCharacterIndex) {
+	SciCall(SCI_ALLOCATELINECHARACTERINDEX, lineCharacterIndex, 0);
+}
+
+NP2_inline void SciCall_ReleaseLineCharacterIndex(int lineCharacterIndex) {
+	SciCall(SCI_RELEASELINECHARACTERINDEX, lineCharacterIndex, 0);
+}
+
+NP2_inline Sci_Position SciCall_PositionRelative(Sci_Position pos, Sci_Position relative) {
+	return SciCall(SCI_POSITIONRELATIVE, pos, relative);
+}
+
 // Multiple Selection and Virtual Space
 
 NP2_inline void SciCall_SetMultipleSelection(BOOL multipleSelection) {
@@ -491,6 +537,14 @@ NP2_inline Sci_Line SciCall_GetFirstVisibleLine(void) {
 	return SciCall(SCI_GETFIRSTVISIBLELINE, 0, 0);
 }
 
+NP2_inline void SciCall_SetFirstVisibleLine(Sci_Line displayLine) {
+	SciCall(SCI_SETFIRSTVISIBLELINE, displayLine, 0);
+}
+
+NP2_inline Sci_Line SciCall_LinesOnScreen(void) {
+	return SciCall(SCI_LINESONSCREEN, 0, 0);
+}
+
 NP2_inline void SciCall_SetXOffset(int xOffset) {
 	SciCall(SCI_SETXOFFSET, xOffset, 0);
 }
@@ -600,6 +654,14 @@ NP2_inline void SciCall_SetIdleStyling(int idleStyling) {
 	SciCall(SCI_SETIDLESTYLING, idleStyling, 0);
 }
 
+NP2_inline void SciCall_SetStyleWindow(Sci_Position windowSize) {
+	SciCall(SCI_SETSTYLEWINDOW, windowSize, 0);
+}
+
+NP2_inline void SciCall_SetStyleBudget(int milliseconds) {
+	SciCall(SCI_SETSTYLEBUDGET, milliseconds, 0);
+}
+
 NP2_inline void SciCall_StartStyling(Sci_Position start) {
 	SciCall(SCI_STARTSTYLING, start, 0);
 }
@@ -622,10 +684,18 @@ NP2_inline void SciCall_CopyStyles(size_t sourceIndex, LPARAM destStyles) {
 	SciCall(SCI_COPYSTYLES, sourceIndex, destStyles);
 }
 
+NP2_inline void SciCall_StyleSetDefinitions(Sci_Position count, const struct Sci_StyleDefinition *definitions) {
+	SciCall(SCI_STYLESETDEFINITIONS, count, (LPARAM)definitions);
+}
+
 NP2_inline void SciCall_StyleSetFont(int style, const char *fontName) {
 	SciCall(SCI_STYLESETFONT, style, (LPARAM)fontName);
 }
 
+NP2_inline int SciCall_StyleGetFont(int style, char *fontName) {
+	return (int)SciCall(SCI_STYLEGETFONT, style, (LPARAM)fontName);
+}
+
 NP2_inline void SciCall_StyleSetSizeFractional(int style, int sizeHundredthPoints) {
 	SciCall(SCI_STYLESETSIZEFRACTIONAL, style, sizeHundredthPoints);
 }
@@ -638,14 +708,26 @@ NP2_inline void SciCall_StyleSetWeight(int style, int weight) {
 	SciCall(SCI_STYLESETWEIGHT, style, weight);
 }
 
+NP2_inline int SciCall_StyleGetWeight(int style) {
+	return (int)SciCall(SCI_STYLEGETWEIGHT, style, 0);
+}
+
 NP2_inline void SciCall_StyleSetItalic(int style, BOOL italic) {
 	SciCall(SCI_STYLESETITALIC, style, italic);
 }
 
+NP2_inline BOOL SciCall_StyleGetItalic(int style) {
+	return (BOOL)SciCall(SCI_STYLEGETITALIC, style, 0);
+}
+
 NP2_inline void SciCall_StyleSetUnderline(int style, BOOL underline) {
 	SciCall(SCI_STYLESETUNDERLINE, style, underline);
 }
 
+NP2_inline BOOL SciCall_StyleGetUnderline(int style) {
+	return (BOOL)SciCall(SCI_STYLEGETUNDERLINE, style, 0);
+}
+
 NP2_inline void SciCall_StyleSetStrike(int style, BOOL strike) {
 	SciCall(SCI_STYLESETSTRIKE, style, strike);
 }
@@ -788,6 +870,36 @@ NP2_inline void SciCall_SetMarginOptions(int marginOptions) {
 	SciCall(SCI_SETMARGINOPTIONS, marginOptions, 0);
 }
 
+// Annotations
+
+NP2_inline void SciCall_AnnotationSetText(Sci_Line line, const char *text) {
+	SciCall(SCI_ANNOTATIONSETTEXT, line, (LPARAM)text);
+}
+
+NP2_inline void SciCall_AnnotationSetStyle(Sci_Line line, int style) {
+	SciCall(SCI_ANNOTATIONSETSTYLE, line, style);
+}
+
+NP2_inline void SciCall_AnnotationClearAll(void) {
+	SciCall(SCI_ANNOTATIONCLEARALL, 0, 0);
+}
+
+NP2_inline void SciCall_AnnotationSetVisible(int visible) {
+	SciCall(SCI_ANNOTATIONSETVISIBLE, visible, 0);
+}
+
+NP2_inline void SciCall_AnnotationSetStyleOffset(int style) {
+	SciCall(SCI_ANNOTATIONSETSTYLEOFFSET, style, 0);
+}
+
+NP2_inline void SciCall_ReleaseAllExtendedStyles(void) {
+	SciCall(SCI_RELEASEALLEXTENDEDSTYLES, 0, 0);
+}
+
+NP2_inline int SciCall_AllocateExtendedStyles(int numberStyles) {
+	return (int)SciCall(SCI_ALLOCATEEXTENDEDSTYLES, numberStyles, 0);
+}
+
 // Other settings
 
 NP2_inline void SciCall_SetCodePage(UINT codePage) {
@@ -849,10 +961,26 @@ NP2_inline Sci_Position SciCall_BraceMatch(Sci_Position pos) {
 	return SciCall(SCI_BRACEMATCH, pos, 0);
 }
 
+NP2_inline Sci_Position SciCall_BraceMatchWithin(Sci_Position pos, Sci_Position maxDistance) {
+	return SciCall(SCI_BRACEMATCH, pos, maxDistance);
+}
+
 NP2_inline Sci_Position SciCall_BraceMatchNext(Sci_Position pos, Sci_Position startPos) {
 	return SciCall(SCI_BRACEMATCHNEXT, pos, startPos);
 }
 
+NP2_inline void SciCall_SetTagStyle(int style, BOOL tag) {
+	SciCall(SCI_SETTAGSTYLE, style, tag);
+}
+
+NP2_inline void SciCall_SetVoidTags(BOOL caseSensitive, const char *tags) {
+	SciCall(SCI_SETVOIDTAGS, caseSensitive, (LPARAM)tags);
+}
+
+NP2_inline Sci_Position SciCall_FindTag(Sci_Position pos, int which) {
+	return SciCall(SCI_FINDTAG, pos, which);
+}
+
 // Tabs and Indentation Guides
 
 NP2_inline void SciCall_SetTabWidth(int tabWidth) {
@@ -867,6 +995,18 @@ NP2_inline void SciCall_SetTabMinimumWidth(int pixels) {
 	SciCall(SCI_SETTABMINIMUMWIDTH, pixels, 0);
 }
 
+NP2_inline void SciCall_ClearTabStops(Sci_Line line) {
+	SciCall(SCI_CLEARTABSTOPS, line, 0);
+}
+
+NP2_inline void SciCall_AddTabStop(Sci_Line line, int x) {
+	SciCall(SCI_ADDTABSTOP, line, x);
+}
+
+NP2_inline void SciCall_SetFieldDelimiter(int delimiter) {
+	SciCall(SCI_SETFIELDDELIMITER, delimiter, 0);
+}
+
 NP2_inline void SciCall_SetUseTabs(BOOL useTabs) {
 	SciCall(SCI_SETUSETABS, useTabs, 0);
 }
@@ -995,10 +1135,18 @@ NP2_inline void SciCall_IndicSetStrokeWidth(int indicator, int hundredths) {
 	SciCall(SCI_INDICSETSTROKEWIDTH, indicator, hundredths);
 }
 
+NP2_inline void SciCall_IndicSetFlags(int indicator, int flags) {
+	SciCall(SCI_INDICSETFLAGS, indicator, flags);
+}
+
 NP2_inline void SciCall_SetIndicatorCurrent(int indicator) {
 	SciCall(SCI_SETINDICATORCURRENT, indicator, 0);
 }
 
+NP2_inline void SciCall_SetIndicatorValue(int value) {
+	SciCall(SCI_SETINDICATORVALUE, value, 0);
+}
+
 NP2_inline void SciCall_IndicatorClearRange(Sci_Position start, Sci_Position length) {
 	SciCall(SCI_INDICATORCLEARRANGE, start, length);
 }
@@ -1007,6 +1155,10 @@ NP2_inline void SciCall_IndicatorFillRange(Sci_Position start, Sci_Position leng
 	SciCall(SCI_INDICATORFILLRANGE, start, length);
 }
 
+NP2_inline void SciCall_IndicatorFillRanges(Sci_Position count, const Sci_Position *ranges) {
+	SciCall(SCI_INDICATORFILLRANGES, count, (LPARAM)ranges);
+}
+
 // Autocompletion
 
 NP2_inline void SciCall_AutoCShow(Sci_Position lengthEntered, const char *itemList) {
@@ -1213,6 +1365,22 @@ NP2_inline const char* SciCall_GetRangePointer(Sci_Position start, Sci_Position
 	return (const char *)SciCall(SCI_GETRANGEPOINTER, start, lengthRange);
 }
 
+NP2_inline const char* SciCall_GetSegmentPointer(Sci_Position position, Sci_Position *segmentEnd) {
+	return (const char *)SciCall(SCI_GETSEGMENTPOINTER, position, (LPARAM)segmentEnd);
+}
+
+NP2_inline const unsigned char* SciCall_GetStyleRangePointer(Sci_Position start, Sci_Position lengthRange) {
+	return (const unsigned char *)SciCall(SCI_GETSTYLERANGEPOINTER, start, lengthRange);
+}
+
+NP2_inline const char* SciCall_AcquireTextSnapshot(void) {
+	return (const char *)SciCall(SCI_ACQUIRETEXTSNAPSHOT, 0, 0);
+}
+
+NP2_inline void SciCall_ReleaseTextSnapshot(const char *snapshot) {
+	SciCall(SCI_RELEASETEXTSNAPSHOT, 0, (LPARAM)snapshot);
+}
+
 // Multiple views
 
 NP2_inline void SciCall_SetDocPointer(HANDLE doc) {
@@ -1231,12 +1399,20 @@ NP2_inline int SciCall_GetDocumentOptions(void) {
 	return (int)SciCall(SCI_GETDOCUMENTOPTIONS, 0, 0);
 }
 
+NP2_inline void SciCall_ConvertToLargeDocument(int options) {
+	SciCall(SCI_CONVERTTOLARGEDOCUMENT, options, 0);
+}
+
 // Folding
 
 NP2_inline Sci_Line SciCall_DocLineFromVisible(Sci_Line displayLine) {
 	return SciCall(SCI_DOCLINEFROMVISIBLE, displayLine, 0);
 }
 
+NP2_inline Sci_Line SciCall_VisibleFromDocLine(Sci_Line line) {
+	return SciCall(SCI_VISIBLEFROMDOCLINE, line, 0);
+}
+
 NP2_inline BOOL SciCall_GetLineVisible(Sci_Line line) {
 	return (BOOL)SciCall(SCI_GETLINEVISIBLE, line, 0);
 }
@@ -1269,6 +1445,14 @@ NP2_inline void SciCall_ToggleFold(Sci_Line line) {
 	SciCall(SCI_TOGGLEFOLD, line, 0);
 }
 
+NP2_inline void SciCall_FoldLine(Sci_Line line, int action) {
+	SciCall(SCI_FOLDLINE, line, action);
+}
+
+NP2_inline Sci_Line SciCall_ContractedFoldNext(Sci_Line lineStart) {
+	return SciCall(SCI_CONTRACTEDFOLDNEXT, lineStart, 0);
+}
+
 NP2_inline void SciCall_ToggleFoldShowText(Sci_Line line, const char *text) {
 	SciCall(SCI_TOGGLEFOLDSHOWTEXT, line, (LPARAM)text);
 }
@@ -1315,6 +1499,22 @@ NP2_inline void SciCall_SetLayoutCache(int cacheMode) {
 	SciCall(SCI_SETLAYOUTCACHE, cacheMode, 0);
 }
 
+NP2_inline void SciCall_SetLayoutCacheBudget(Sci_Position bytes) {
+	SciCall(SCI_SETLAYOUTCACHEBUDGET, bytes, 0);
+}
+
+NP2_inline void SciCall_SetLayoutThreads(int threads) {
+	SciCall(SCI_SETLAYOUTTHREADS, threads, 0);
+}
+
+NP2_inline Sci_Position SciCall_GetMemoryUsage(int usage) {
+	return SciCall(SCI_GETMEMORYUSAGE, usage, 0);
+}
+
+NP2_inline Sci_Position SciCall_GetStylingStatistic(int statistic) {
+	return SciCall(SCI_GETSTYLINGSTATISTIC, statistic, 0);
+}
+
 NP2_inline void SciCall_LinesSplit(int pixelWidth) {
 	SciCall(SCI_LINESSPLIT, pixelWidth, 0);
 }
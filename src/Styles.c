@@ -37,6 +37,10 @@
 #include "Edit.h"
 #include "Styles.h"
 #include "Dialogs.h"
+#include "MiniMap.h"
+#include "CsvView.h"
+#include "Compare.h"
+#include "MarkTerms.h"
 #include "resource.h"
 
 extern EDITLEXER lexGlobal;
@@ -304,6 +308,7 @@ static const COLORREF defaultCustomColor[MAX_CUSTOM_COLOR_COUNT] = {
 static COLORREF customColor[MAX_CUSTOM_COLOR_COUNT];
 
 static BOOL iCustomColorLoaded = FALSE;
+static UINT64 hashStylesSection;
 
 BOOL	bUse2ndGlobalStyle;
 int		np2StyleTheme;
@@ -329,6 +334,18 @@ int		cyStyleCustomizeDlg;
 #define ALL_FILE_EXTENSIONS_BYTE_SIZE	((MATCH_LEXER_COUNT * MAX_EDITLEXER_EXT_SIZE) * sizeof(WCHAR))
 static LPWSTR g_AllFileExtensions = NULL;
 
+// file extension to lexer map, built on first lookup after extensions are loaded or edited.
+typedef struct FileExtensionNode {
+	UINT hash;
+	UINT length;
+	LPCWSTR ext;	// points into szExtensions, not NUL terminated
+	PEDITLEXER pLex;
+} FileExtensionNode;
+
+static FileExtensionNode *fileExtensionMap = NULL;
+static UINT fileExtensionMask;
+static BOOL bFileExtensionMapValid = FALSE;
+
 // Notepad2.c
 extern HWND hwndMain;
 extern int	iEncoding;
@@ -338,6 +355,7 @@ extern int	iDefaultCharSet;
 extern INT	iHighlightCurrentLine;
 extern BOOL	bShowBookmarkMargin;
 extern int	iZoomLevel;
+extern BOOL	bLargeFileProfile;
 
 extern FILEVARS fvCurFile;
 extern EditTabSettings tabSettings;
@@ -371,6 +389,60 @@ struct DetailStyle {
 	char fontFace[LF_FACESIZE * kMaxMultiByteCount];
 };
 
+// styles set between Style_BeginBatch() and Style_EndBatch() are applied
+// with one SCI_STYLESETDEFINITIONS, which invalidates style data only once.
+typedef struct StyleDefinitionBatch {
+	UINT count;
+	struct Sci_StyleDefinition definitions[STYLE_MAX + 1];
+	char fontFace[STYLE_MAX + 1][LF_FACESIZE * kMaxMultiByteCount];
+} StyleDefinitionBatch;
+
+static StyleDefinitionBatch *styleBatch;
+
+static void Style_BeginBatch(void) {
+	styleBatch = (StyleDefinitionBatch *)NP2HeapAlloc(sizeof(StyleDefinitionBatch));
+}
+
+static void Style_FlushBatch(void) {
+	if (styleBatch->count != 0) {
+		SciCall_StyleSetDefinitions(styleBatch->count, styleBatch->definitions);
+		styleBatch->count = 0;
+	}
+}
+
+static void Style_EndBatch(void) {
+	if (styleBatch) {
+		Style_FlushBatch();
+		NP2HeapFree(styleBatch);
+		styleBatch = NULL;
+	}
+}
+
+// copy last style to each 8-bit non-zero style index in destStyles, see SciCall_CopyStyles().
+// only valid after StyleClearAll, when destination styles still equal to STYLE_DEFAULT.
+static void Style_CopyStyles(int iStyle, UINT destStyles) {
+	if (styleBatch && styleBatch->count != 0) {
+		const struct Sci_StyleDefinition *source = &styleBatch->definitions[styleBatch->count - 1];
+		do {
+			if (styleBatch->count == COUNTOF(styleBatch->definitions)) {
+				// full: flush and copy from source again
+				Style_FlushBatch();
+				SciCall_CopyStyles(iStyle, destStyles);
+				return;
+			}
+			const int dest = destStyles & 0xff;
+			if (dest != 0) {
+				struct Sci_StyleDefinition *def = &styleBatch->definitions[styleBatch->count++];
+				*def = *source;
+				def->style = dest;
+			}
+			destStyles >>= 8;
+		} while (destStyles);
+	} else {
+		SciCall_CopyStyles(iStyle, destStyles);
+	}
+}
+
 /*
 style in other lexers is inherited from it's lexer default (first) style and global default style.
 	This also means other "Default" styles in lexHTML don't work as expected.
@@ -602,6 +674,9 @@ HFONT Style_CreateCodeFont(UINT dpi) {
 
 void Style_ReleaseResources(void) {
 	NP2HeapFree(g_AllFileExtensions);
+	if (fileExtensionMap) {
+		NP2HeapFree(fileExtensionMap);
+	}
 	for (UINT iLexer = 0; iLexer < ALL_LEXER_COUNT; iLexer++) {
 		PEDITLEXER pLex = pLexArray[iLexer];
 		if (pLex->szStyleBuf) {
@@ -763,6 +838,7 @@ void Style_Load(void) {
 	IniSectionInit(pIniSection, 128);
 
 	LoadIniSection(INI_SECTION_NAME_STYLES, pIniSectionBuf, cchIniSection);
+	hashStylesSection = IniSectionHash(INI_SECTION_NAME_STYLES, pIniSectionBuf);
 	IniSectionParse(pIniSection, pIniSectionBuf);
 
 	// 2nd default
@@ -799,13 +875,14 @@ void Style_Load(void) {
 			lstrcpyn(pLex->szExtensions, value, MAX_EDITLEXER_EXT_SIZE);
 		}
 	}
+	bFileExtensionMapValid = FALSE;
 
 	if (np2StyleTheme == StyleTheme_Dark) {
 		FindDarkThemeFile();
 	}
 
+	// other schemes are loaded on demand by Style_SetLexer()
 	Style_LoadOneEx(pLexGlobal, pIniSection, pIniSectionBuf, cchIniSection);
-	Style_LoadOneEx(pLexArray[iDefaultLexerIndex], pIniSection, pIniSectionBuf, cchIniSection);
 
 	FindSystemDefaultCodeFont();
 	FindSystemDefaultTextFont();
@@ -889,7 +966,7 @@ void Style_Save(void) {
 	// auto select
 	IniSectionSetBoolEx(pIniSection, L"AutoSelect", bAutoSelect, 1);
 
-	SaveIniSection(INI_SECTION_NAME_STYLES, pIniSectionBuf);
+	SaveIniSectionIfChanged(INI_SECTION_NAME_STYLES, pIniSectionBuf, &hashStylesSection);
 
 	// file extensions
 	if (fStylesModified & STYLESMODIFIED_FILE_EXT) {
@@ -1009,6 +1086,7 @@ BOOL Style_Import(HWND hwnd) {
 						break;
 					}
 				}
+				bFileExtensionMapValid = FALSE;
 			}
 		}
 
@@ -1124,6 +1202,7 @@ static void Style_ResetAll(BOOL resetColor) {
 		}
 	}
 
+	bFileExtensionMapValid = FALSE;
 	fStylesModified |= STYLESMODIFIED_ALL_STYLE | STYLESMODIFIED_FILE_EXT | STYLESMODIFIED_COLOR;
 }
 
@@ -1631,6 +1710,7 @@ void Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged) {
 
 		Style_UpdateLexerKeywords(pLexNew);
 		Style_UpdateLexerKeywordAttr(pLexNew);
+		Style_ResetLexerKeywordIndex();
 		// Add keyword lists
 		for (int i = 0; i < KEYWORDSET_MAX; i++) {
 			const char *pKeywords = pLexNew->pKeyWords->pszKeyWords[i];
@@ -1642,6 +1722,16 @@ void Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged) {
 			}
 		}
 
+		// index start and end tags for tag matching
+		SciCall_SetTagStyle(-1, FALSE);
+		if (iLexer == SCLEX_HTML || iLexer == SCLEX_XML) {
+			SciCall_SetTagStyle(SCE_H_TAG, TRUE);
+			SciCall_SetTagStyle(SCE_H_TAGUNKNOWN, TRUE);
+			// void elements, see classifyTagHTML() in LexHTML.cxx
+			SciCall_SetVoidTags(iLexer == SCLEX_XML, (iLexer == SCLEX_XML) ? NULL :
+				"area base basefont br col command embed frame hr img input isindex keygen link meta param source track wbr");
+		}
+
 		// Clear
 		SciCall_ClearDocumentStyle();
 	}
@@ -1706,6 +1796,9 @@ void Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged) {
 	SciCall_StyleClearAll();
 	//! end STYLE_DEFAULT
 
+	// remaining styles are applied together, only STYLE_DEFAULT is queried below.
+	Style_BeginBatch();
+
 	Style_SetDefaultStyle(GlobalStyleIndex_LineNumber);
 	Style_DefineIndicator(GlobalStyleIndex_MatchBrace, IndicatorNumber_MatchBrace, INDIC_ROUNDBOX);
 	Style_DefineIndicator(GlobalStyleIndex_MatchBraceError, IndicatorNumber_MatchBraceError, INDIC_ROUNDBOX);
@@ -1899,9 +1992,10 @@ void Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged) {
 			const int first = iStyle & 0xff;
 			Style_SetStyles(first, szValue);
 			if (iStyle > 0xFF) {
-				SciCall_CopyStyles(first, iStyle >> 8);
+				Style_CopyStyles(first, iStyle >> 8);
 			}
 		}
+		Style_EndBatch();
 		switch (iLexer) {
 		case SCLEX_PERL:
 #if defined(_WIN64)
@@ -1918,6 +2012,7 @@ void Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged) {
 		Style_SetStyles(STYLE_LINENUMBER, szValue);
 		szValue = pLexNew->Styles[ANSIArtStyleIndex_FoldDispalyText].szValue;
 		Style_SetStyles(STYLE_FOLDDISPLAYTEXT, szValue);
+		Style_EndBatch();
 	}
 
 	// update style font, color, etc. don't need colorizing (analyzing whole document) again,
@@ -1925,7 +2020,8 @@ void Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged) {
 	if (bLexerChanged) {
 		// cache layout for visible lines.
 		// SC_CACHE_PAGE depends on line height (i.e. styles in current lexer) and edit window height.
-		SciCall_SetLayoutCache(SC_CACHE_PAGE);
+		// large file profile caches layout for whole document within a budget.
+		SciCall_SetLayoutCache(bLargeFileProfile ? SC_CACHE_DOCUMENT : SC_CACHE_PAGE);
 
 #if 0
 		// profile lexer performance
@@ -1952,6 +2048,11 @@ void Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged) {
 	UpdateLineNumberWidth();
 	UpdateBookmarkMarginWidth();
 	UpdateFoldMarginWidth();
+	MiniMap_Reset();
+	CsvView_OnStyleChanged();
+	Compare_OnStyleChanged();
+	MarkTerms_OnStyleChanged();
+	EditPrintInvalidatePages(0);
 }
 
 //=============================================================================
@@ -2259,25 +2360,82 @@ int Style_GetDocTypeLanguage(void) {
 	return 0;
 }
 
+// preprocessor (2) and Objective-C directive (3) keywords of lexCPP, indexed once by
+// content detection instead of searching the keyword strings for each line.
+#define CPP_DETECT_KEYWORD_TABLE_SIZE	256
+typedef struct CPPDetectKeyword {
+	const char *word;
+	UINT length;
+	UINT lists;	// bit mask of keyword list index
+} CPPDetectKeyword;
+
+static CPPDetectKeyword cppDetectKeywordTable[CPP_DETECT_KEYWORD_TABLE_SIZE];
+static BOOL bCPPDetectKeywordTableBuilt = FALSE;
+
+static inline UINT CPPDetectKeywordHash(const char *word, UINT length) {
+	UINT hash = 2166136261U ^ length;
+	for (UINT i = 0; i < length; i++) {
+		hash = (hash ^ (UINT)word[i]) * 16777619U;
+	}
+	return hash;
+}
+
+static CPPDetectKeyword *FindCPPDetectKeyword(const char *word, UINT length) {
+	const UINT mask = CPP_DETECT_KEYWORD_TABLE_SIZE - 1;
+	UINT index = CPPDetectKeywordHash(word, length) & mask;
+	CPPDetectKeyword *node;
+	while ((node = &cppDetectKeywordTable[index])->word != NULL) {
+		if (node->length == length && memcmp(node->word, word, length) == 0) {
+			break;
+		}
+		index = (index + 1) & mask;
+	}
+	return node;
+}
+
+static void BuildCPPDetectKeywordTable(void) {
+	for (int index = 2; index <= 3; index++) {
+		const char *p = lexCPP.pKeyWords->pszKeyWords[index];
+		while (*p) {
+			while (*p == ' ') {
+				++p;
+			}
+			const char * const word = p;
+			BOOL valid = TRUE;
+			while (*p && *p != ' ') {
+				// words like `property()` never match identifier from MatchCPPKeyword()
+				valid = valid && (*p == '_' || (*p >= 'a' && *p <= 'z'));
+				++p;
+			}
+			const UINT length = (UINT)(p - word);
+			if (valid && length != 0) {
+				CPPDetectKeyword *node = FindCPPDetectKeyword(word, length);
+				node->word = word;
+				node->length = length;
+				node->lists |= 1U << index;
+			}
+		}
+	}
+	bCPPDetectKeywordTableBuilt = TRUE;
+}
+
 BOOL MatchCPPKeyword(const char *p, int index) {
 	if (*p < 'a' || *p > 'z') {
 		return FALSE;
 	}
 
-	char word[32];
-	word[0] = ' ';
-	word[1] = *p++;
-	int len = 2;
-	while (len < 30 && (*p == '_' || (*p >= 'a' && *p <= 'z'))) {
-		word[len++] = *p++;
+	const char * const word = p++;
+	while (p - word < 29 && (*p == '_' || (*p >= 'a' && *p <= 'z'))) {
+		++p;
 	}
-	if (len == 30 || IsAlphaNumeric(*p)) {
+	if (p - word == 29 || IsAlphaNumeric(*p)) {
 		return FALSE;
 	}
-	word[len++] = ' ';
-	word[len++] = 0;
-	p = strstr(lexCPP.pKeyWords->pszKeyWords[index], word);
-	return p != NULL;
+	if (!bCPPDetectKeywordTableBuilt) {
+		BuildCPPDetectKeywordTable();
+	}
+	const CPPDetectKeyword *node = FindCPPDetectKeyword(word, (UINT)(p - word));
+	return (node->lists >> index) & 1;
 }
 
 PEDITLEXER Style_DetectObjCAndMatlab(void) {
@@ -2484,6 +2642,25 @@ LPCWSTR Style_GetCurrentLexerName(LPWSTR lpszName, int cchName) {
 	return pLexCurrent->pszName;
 }
 
+//=============================================================================
+//
+// Style_GetStyleName()
+//
+// name of the current scheme's style item which applies to the style, NULL when it's not listed.
+LPCWSTR Style_GetStyleName(int style) {
+	for (UINT i = 0; i < pLexCurrent->iStyleCount; i++) {
+		// up to four styles are packed with MULTI_STYLE()
+		UINT value = pLexCurrent->Styles[i].iStyle;
+		do {
+			if ((int)(value & 0xff) == style) {
+				return pLexCurrent->Styles[i].pszName;
+			}
+			value >>= 8;
+		} while (value != 0);
+	}
+	return NULL;
+}
+
 static void Style_UpdateLexerLang(PEDITLEXER pLex, LPCWSTR lpszExt, LPCWSTR lpszName) {
 	switch (pLex->rid) {
 	case NP2LEX_BASH:
@@ -2580,6 +2757,96 @@ static void Style_UpdateLexerLang(PEDITLEXER pLex, LPCWSTR lpszExt, LPCWSTR lpsz
 	}
 }
 
+//=============================================================================
+// file extension to lexer map
+//
+static inline BOOL IsFileExtensionSeparator(WCHAR ch) {
+	return ch == L';' || ch == L' ';
+}
+
+static inline UINT FileExtensionHash(LPCWSTR ext, UINT length) {
+	// case insensitive, all non-ASCII characters are hashed the same and compared with StrCmpNI()
+	UINT hash = 2166136261U ^ length;
+	for (UINT i = 0; i < length; i++) {
+		UINT ch = ext[i];
+		ch = (ch >= 0x80) ? 0x80 : ((ch >= L'A' && ch <= L'Z') ? (ch | 0x20) : ch);
+		hash = (hash ^ ch) * 16777619U;
+	}
+	return hash;
+}
+
+static const FileExtensionNode *Style_FindFileExtension(LPCWSTR ext, UINT length, UINT hash) {
+	const UINT mask = fileExtensionMask;
+	UINT index = hash & mask;
+	const FileExtensionNode *node;
+	while ((node = &fileExtensionMap[index])->ext != NULL) {
+		if (node->hash == hash && node->length == length && StrCmpNI(node->ext, ext, length) == 0) {
+			return node;
+		}
+		index = (index + 1) & mask;
+	}
+	return NULL;
+}
+
+static void Style_BuildFileExtensionMap(void) {
+	UINT count = 0;
+	for (UINT iLexer = LEXER_INDEX_MATCH; iLexer < ALL_LEXER_COUNT; iLexer++) {
+		LPCWSTR p = pLexArray[iLexer]->szExtensions;
+		while (*p) {
+			if (!IsFileExtensionSeparator(*p) && (p[1] == L'\0' || IsFileExtensionSeparator(p[1]))) {
+				++count;
+			}
+			++p;
+		}
+	}
+
+	UINT size = 64;
+	while (size < 2*count) {
+		size <<= 1;
+	}
+	if (fileExtensionMap == NULL || size - 1 != fileExtensionMask) {
+		if (fileExtensionMap) {
+			NP2HeapFree(fileExtensionMap);
+		}
+		fileExtensionMap = (FileExtensionNode *)NP2HeapAlloc(size * sizeof(FileExtensionNode));
+		fileExtensionMask = size - 1;
+	} else {
+		ZeroMemory(fileExtensionMap, size * sizeof(FileExtensionNode));
+	}
+
+	const UINT mask = fileExtensionMask;
+	for (UINT iLexer = LEXER_INDEX_MATCH; iLexer < ALL_LEXER_COUNT; iLexer++) {
+		PEDITLEXER pLex = pLexArray[iLexer];
+		LPCWSTR p = pLex->szExtensions;
+		while (*p) {
+			while (IsFileExtensionSeparator(*p)) {
+				++p;
+			}
+			LPCWSTR ext = p;
+			while (*p && !IsFileExtensionSeparator(*p)) {
+				++p;
+			}
+			const UINT length = (UINT)(p - ext);
+			if (length != 0) {
+				// same extension in later lexer is ignored, as it never matched with previous linear search.
+				const UINT hash = FileExtensionHash(ext, length);
+				if (Style_FindFileExtension(ext, length, hash) == NULL) {
+					UINT index = hash & mask;
+					while (fileExtensionMap[index].ext != NULL) {
+						index = (index + 1) & mask;
+					}
+					FileExtensionNode *node = &fileExtensionMap[index];
+					node->hash = hash;
+					node->length = length;
+					node->ext = ext;
+					node->pLex = pLex;
+				}
+			}
+		}
+	}
+	bFileExtensionMapValid = TRUE;
+}
+
 //=============================================================================
 // find lexer from file extension
 // Style_MatchLexer()
@@ -2604,23 +2871,15 @@ PEDITLEXER Style_MatchLexer(LPCWSTR lpszMatch, BOOL bCheckNames) {
 			}
 		}
 
-		const int cch = lstrlen(lpszMatch);
-		for (UINT iLexer = LEXER_INDEX_MATCH; iLexer < ALL_LEXER_COUNT; iLexer++) {
-			PEDITLEXER pLex = pLexArray[iLexer];
-			LPCWSTR p1 = pLex->szExtensions;
-			do {
-				LPCWSTR p2 = StrStrI(p1, lpszMatch);
-				if (p2 == NULL) {
-					break;
-				}
-
-				const WCHAR ch = (p2 == p1)? L'\0' : p2[-1];
-				p2 += cch;
-				if ((ch == L';' || ch == ' ' || ch == L'\0') && (*p2 == L';' || *p2 == L' ' || *p2 == L'\0')) {
-					return pLex;
-				}
-				p1 = StrChr(p2, L';');
-			} while (p1 != NULL);
+		const UINT cch = lstrlen(lpszMatch);
+		if (cch != 0) {
+			if (!bFileExtensionMapValid) {
+				Style_BuildFileExtensionMap();
+			}
+			const FileExtensionNode *node = Style_FindFileExtension(lpszMatch, cch, FileExtensionHash(lpszMatch, cch));
+			if (node != NULL) {
+				return node->pLex;
+			}
 		}
 	} else {
 		const int cch = lstrlen(lpszMatch);
@@ -2887,9 +3146,8 @@ BOOL Style_CanOpenFile(LPCWSTR lpszFile) {
 	return pLexNew != NULL || StrIsEmpty(lpszExt) || bDotFile || StrCaseEqual(lpszExt, L"cgi") || StrCaseEqual(lpszExt, L"fcgi");
 }
 
-BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
-#if 1
-	UNREFERENCED_PARAMETER(lpszFile);
+// headerLen excludes last byte of the header, which may be read as second control character.
+BOOL Style_MaybeBinaryHeader(const uint8_t *ptr, Sci_Position headerLen) {
 	/* Test C0 Control Character
 	These characters are not reused in most text encodings, and do not appear in normal text files.
 	Most binary files have reserved fields (mostly zeros) or small values in the header.
@@ -2898,12 +3156,6 @@ BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
 
 	// see tools/GenerateTable.py for this mask.
 	const UINT C0Mask = 0x0FFFC1FFU;
-	const Sci_Position headerLen = min_pos(1023, SciCall_GetLength() - 1);
-	const uint8_t *ptr = (const uint8_t *)SciCall_GetRangePointer(0, headerLen + 1);
-	if (ptr == NULL || headerLen <= 0) {
-		return FALSE; // empty file
-	}
-
 	const uint8_t * const end = ptr + headerLen;
 	UINT count = 0;
 	while (ptr < end) {
@@ -2916,6 +3168,18 @@ BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
 			}
 		}
 	}
+	return FALSE;
+}
+
+BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
+#if 1
+	UNREFERENCED_PARAMETER(lpszFile);
+	const Sci_Position headerLen = min_pos(1023, SciCall_GetLength() - 1);
+	const uint8_t *ptr = (const uint8_t *)SciCall_GetRangePointer(0, headerLen + 1);
+	if (ptr == NULL || headerLen <= 0) {
+		return FALSE; // empty file
+	}
+	return Style_MaybeBinaryHeader(ptr, headerLen);
 #else
 	uint8_t buf[5] = {0}; // file magic
 	SciCall_GetText(COUNTOF(buf), buf);
@@ -3125,6 +3389,13 @@ void Style_SetLexerFromID(int rid) {
 	Style_SetLexer(pLexArray[iLexer], TRUE);
 }
 
+// lexer and language are known, e.g. recorded in view state cache.
+void Style_SetLexerFromIDEx(int rid, int lang) {
+	const int iLexer = Style_GetMatchLexerIndex(rid);
+	np2LexLangIndex = lang;
+	Style_SetLexer(pLexArray[iLexer], TRUE);
+}
+
 int Style_GetMatchLexerIndex(int rid) {
 	for (UINT iLexer = LEXER_INDEX_MATCH; iLexer < ALL_LEXER_COUNT; iLexer++) {
 		if (pLexArray[iLexer]->rid == rid) {
@@ -3819,63 +4090,94 @@ BOOL Style_SelectColor(HWND hwnd, BOOL bFore, LPWSTR lpszStyle, int cchStyle) {
 //
 // Style_SetStyles()
 //
-void Style_SetStyles(int iStyle, LPCWSTR lpszStyle) {
+static void Style_ParseDefinition(struct Sci_StyleDefinition *def, char *fontFace, int iStyle, LPCWSTR lpszStyle) {
 	WCHAR tch[LF_FACESIZE];
+	int mask = SC_STYLEDEFINITION_NONE;
 	int iValue;
 	COLORREF rgb;
 
+	ZeroMemory(def, sizeof(struct Sci_StyleDefinition));
+	def->style = iStyle;
+
 	// Font
 	if (Style_StrGetFont(lpszStyle, tch, COUNTOF(tch))) {
-		char mch[LF_FACESIZE * kMaxMultiByteCount];
-		WideCharToMultiByte(CP_UTF8, 0, tch, -1, mch, COUNTOF(mch), NULL, NULL);
-		SciCall_StyleSetFont(iStyle, mch);
+		WideCharToMultiByte(CP_UTF8, 0, tch, -1, fontFace, LF_FACESIZE * kMaxMultiByteCount, NULL, NULL);
+		def->fontName = fontFace;
+		mask |= SC_STYLEDEFINITION_FONT;
 	}
 
 	// Size
 	if (Style_StrGetFontSize(lpszStyle, &iValue)) {
-		SciCall_StyleSetSizeFractional(iStyle, iValue);
+		def->sizeFractional = iValue;
+		mask |= SC_STYLEDEFINITION_SIZE;
 	}
 
 	// Fore
 	if (Style_StrGetForeColor(lpszStyle, &rgb)) {
-		SciCall_StyleSetFore(iStyle, rgb);
+		def->fore = rgb;
+		mask |= SC_STYLEDEFINITION_FORE;
 	}
 
 	// Back
 	if (Style_StrGetBackColor(lpszStyle, &rgb)) {
-		SciCall_StyleSetBack(iStyle, rgb);
+		def->back = rgb;
+		mask |= SC_STYLEDEFINITION_BACK;
 	}
 
 	// Weight
 	if (Style_StrGetFontWeight(lpszStyle, &iValue)) {
-		SciCall_StyleSetWeight(iStyle, iValue);
+		def->weight = iValue;
+		mask |= SC_STYLEDEFINITION_WEIGHT;
 	}
 
 	// Italic
 	if (Style_StrGetItalic(lpszStyle)) {
-		SciCall_StyleSetItalic(iStyle, TRUE);
+		def->italic = TRUE;
+		mask |= SC_STYLEDEFINITION_ITALIC;
 	}
 	// Underline
 	if (Style_StrGetUnderline(lpszStyle)) {
-		SciCall_StyleSetUnderline(iStyle, TRUE);
+		def->underline = TRUE;
+		mask |= SC_STYLEDEFINITION_UNDERLINE;
 	}
 	// Strike
 	if (Style_StrGetStrike(lpszStyle)) {
-		SciCall_StyleSetStrike(iStyle, TRUE);
+		def->strike = TRUE;
+		mask |= SC_STYLEDEFINITION_STRIKE;
 	}
 	// EOL Filled
 	if (Style_StrGetEOLFilled(lpszStyle)) {
-		SciCall_StyleSetEOLFilled(iStyle, TRUE);
+		def->eolFilled = TRUE;
+		mask |= SC_STYLEDEFINITION_EOLFILLED;
 	}
 
 	// Case
 	if (Style_StrGetCase(lpszStyle, &iValue)) {
-		SciCall_StyleSetCase(iStyle, iValue);
+		def->caseForce = iValue;
+		mask |= SC_STYLEDEFINITION_CASE;
 	}
 
 	// Character Set
 	if (Style_StrGetCharSet(lpszStyle, &iValue)) {
-		SciCall_StyleSetCharacterSet(iStyle, iValue);
+		def->characterSet = iValue;
+		mask |= SC_STYLEDEFINITION_CHARACTERSET;
+	}
+
+	def->mask = mask;
+}
+
+void Style_SetStyles(int iStyle, LPCWSTR lpszStyle) {
+	if (styleBatch) {
+		if (styleBatch->count == COUNTOF(styleBatch->definitions)) {
+			Style_FlushBatch();
+		}
+		const UINT index = styleBatch->count++;
+		Style_ParseDefinition(&styleBatch->definitions[index], styleBatch->fontFace[index], iStyle, lpszStyle);
+	} else {
+		struct Sci_StyleDefinition def;
+		char fontFace[LF_FACESIZE * kMaxMultiByteCount];
+		Style_ParseDefinition(&def, fontFace, iStyle, lpszStyle);
+		SciCall_StyleSetDefinitions(1, &def);
 	}
 }
 
@@ -4872,16 +5174,16 @@ void Style_ConfigDlg(HWND hwnd) {
 	if (IDCANCEL == ThemedDialogBoxParam(g_hInstance, MAKEINTRESOURCE(IDD_STYLECONFIG), GetParent(hwnd), Style_ConfigDlgProc, (LPARAM)(&param))) {
 		// Restore Styles
 		CopyMemory(g_AllFileExtensions, param.extBackup, ALL_FILE_EXTENSIONS_BYTE_SIZE);
+		bFileExtensionMapValid = FALSE;
 		CopyMemory(customColor, param.colorBackup, MAX_CUSTOM_COLOR_COUNT * sizeof(COLORREF));
 		for (UINT iLexer = 0; iLexer < ALL_LEXER_COUNT; iLexer++) {
 			PEDITLEXER pLex = pLexArray[iLexer];
 			CopyMemory(pLex->szStyleBuf, param.styleBackup[iLexer], EDITSTYLE_BufferSize(pLex->iStyleCount));
 		}
 	} else {
-		if (!(fStylesModified & STYLESMODIFIED_FILE_EXT)) {
-			if (memcmp(param.extBackup, g_AllFileExtensions, ALL_FILE_EXTENSIONS_BYTE_SIZE) != 0) {
-				fStylesModified |= STYLESMODIFIED_FILE_EXT;
-			}
+		if (memcmp(param.extBackup, g_AllFileExtensions, ALL_FILE_EXTENSIONS_BYTE_SIZE) != 0) {
+			bFileExtensionMapValid = FALSE;
+			fStylesModified |= STYLESMODIFIED_FILE_EXT;
 		}
 		if (!(fStylesModified & STYLESMODIFIED_COLOR)) {
 			if (memcmp(param.colorBackup, customColor, MAX_CUSTOM_COLOR_COUNT * sizeof(COLORREF)) != 0) {
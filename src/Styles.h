@@ -55,17 +55,22 @@ void	Style_OnDPIChanged(PEDITLEXER pLex);
 void	Style_OnStyleThemeChanged(int theme);
 void	Style_InitDefaultColor(void);
 void	Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged);
+PEDITLEXER Style_AutoDetect(BOOL bDotFile);
 BOOL	Style_SetLexerFromFile(LPCWSTR lpszFile);
 void	Style_SetLexerFromName(LPCWSTR lpszFile, LPCWSTR lpszName);
+BOOL	Style_MaybeBinaryHeader(const uint8_t *ptr, Sci_Position headerLen);
 BOOL	Style_MaybeBinaryFile(LPCWSTR lpszFile);
 BOOL	Style_CanOpenFile(LPCWSTR lpszFile);
 void	Style_SetLexerFromID(int rid);
+void	Style_SetLexerFromIDEx(int rid, int lang);
 int		Style_GetMatchLexerIndex(int rid);
 
 int		Style_GetDocTypeLanguage(void);
 void	Style_UpdateLexerKeywords(LPCEDITLEXER pLexNew);
 void	Style_UpdateLexerKeywordAttr(LPCEDITLEXER pLexNew);
+void	Style_ResetLexerKeywordIndex(void);
 LPCWSTR Style_GetCurrentLexerName(LPWSTR lpszName, int cchName);
+LPCWSTR Style_GetStyleName(int style);
 void	Style_SetLexerByLangIndex(int lang);
 void	Style_UpdateSchemeMenu(HMENU hmenu);
 
@@ -38,6 +38,8 @@
 #define IDC_SCI_PAGE_TEXT				111
 #define IDC_SCI_PAGE_LINK				112
 #define IDC_BUILD_INFO					113
+#define IDC_MEMORY_USAGE				114
+#define IDC_STYLING_STATS				115
 // Find/Replace Text
 #define IDD_FIND						118
 #define IDD_REPLACE						119
@@ -67,6 +69,24 @@
 #define IDC_RESETPOSITION				159
 #define IDC_USEMONOSPACEDFONT			160
 #define IDC_FINDALLBOOKMARK				161
+// Find in Files, also uses controls from Find/Replace Text
+#define IDD_FINDINFILES					132
+#define IDC_FINDINFILES_DIR				170
+#define IDC_FINDINFILES_BROWSE			171
+#define IDC_FINDINFILES_FILTER			172
+#define IDC_FINDINFILES_SUBDIR			173
+#define IDC_FINDINFILES_RESULT			174
+#define IDC_FINDINFILES_STATUS			175
+#define IDC_FINDINFILES_STOP			176
+#define IDD_OPENRANGE					133
+#define IDC_OPENRANGE_LINES				177
+#define IDC_OPENRANGE_BYTES				178
+#define IDC_OPENRANGE_FROM				179
+#define IDC_OPENRANGE_TO				180
+// Mark Terms, also uses controls from Find/Replace Text
+#define IDD_MARKTERMS					134
+#define IDC_MARKTERMS_LIST				181
+#define IDC_MARKTERMS_LOAD				182
 // IDR_ACCFINDREPLACE
 #define IDACC_FIND						200
 #define IDACC_REPLACE					201
@@ -276,6 +296,12 @@
 #define IDC_SORT_IGNORE_CASE			106
 #define IDC_SORT_LOGICAL_NUMBER			107
 #define IDC_SORT_COLUMN					108
+#define IDC_SORT_FIELD					109
+#define IDC_SORT_FIELD_INDEX			110
+#define IDC_SORT_FIELD_DELIMITER		111
+#define IDC_SORT_FIELD_TYPE				112
+#define IDC_SORT_FIELD_DELIMITER_OPTIONS	211
+#define IDC_SORT_FIELD_TYPE_OPTIONS		212
 // Align Lines
 #define IDD_ALIGN						112
 #define IDC_ALIGN_LEFT					100
@@ -336,6 +362,19 @@
 #define IDS_BACKSLASHHELP				10019
 #define IDS_REGEXPHELP					10020
 #define IDS_WILDCARDHELP				10021
+#define IDS_FINDINFILES_DIR				10022
+#define IDS_FINDINFILES_STATUS			10023
+#define IDS_HEXVIEW_DOCPOS				10024
+#define IDS_MACRO_REPLAY_TIMING			10025
+#define IDS_LARGEFILE_DOCSIZE			10026
+#define IDS_PIPESOURCE_FINISHED			10027
+#define IDS_OPENRANGE_LINES				10028
+#define IDS_OPENRANGE_BYTES				10029
+#define IDS_DOCSTATISTICS				10030
+#define IDS_ERR_AUTOMATION				10031
+#define IDS_MARKTERMS_RESULT			10032
+#define IDS_ERR_MARKTERMS				10033
+#define IDS_ERR_REPLACEALL				10034
 
 #define CMD_ESCAPE						20000	// Esc					None/Min To Tray/Exit
 #define CMD_SHIFTESC					20001	// Shift+Esc			Exit
@@ -595,6 +634,8 @@
 #define IDM_EDIT_COPY_BINARY			40395
 #define IDM_EDIT_PASTE_BINARY			40396
 #define IDM_EDIT_CLEARDOCUMENT			40397
+#define IDM_EDIT_REMOVEDUPLICATELINES	40398
+#define IDM_EDIT_REMOVEDUPLICATELINES_NOCASE	40399
 
 #define IDM_VIEW_SCHEME					40400	// F12
 #define IDM_VIEW_USE2NDGLOBALSTYLE		40401	// Shift+F12
@@ -688,6 +729,12 @@
 #define IDM_EDIT_GOTO_NEXT_SIBLING_BLOCK		40490	// Alt+>
 #define IDM_EDIT_NAVIGATE_BACKWARD				40491	// Alt+Left
 #define IDM_EDIT_NAVIGATE_FORWARD				40492	// Alt+Right
+#define IDM_EDIT_FINDINFILES			40493
+#define IDM_VIEW_HEXVIEW				40494
+#define IDM_VIEW_MINIMAP				40495
+#define IDM_EDIT_MACRO_RECORD			40496	// Ctrl+F10
+#define IDM_EDIT_MACRO_PLAY				40497	// Ctrl+Shift+F10
+#define IDM_EDIT_MACRO_REPLAY_TIMING	40498
 
 #define IDM_HELP_ABOUT					40500	// F1
 #define IDM_CMDLINE_HELP				40501
@@ -698,6 +745,24 @@
 #define IDM_HELP_ONLINE_WIKI			40506
 #define IDM_HELP_LATEST_BUILD			40507
 
+#define IDM_EDIT_FORMAT_JSON			40510
+#define IDM_EDIT_MINIFY_JSON			40511
+#define IDM_VIEW_CSV_COLUMNS			40512
+#define IDM_EDIT_CSV_NEXT_FIELD			40513
+#define IDM_EDIT_CSV_PREV_FIELD			40514
+#define IDM_EDIT_CSV_SELECT_COLUMN		40515
+#define IDM_EDIT_CSV_COPY_COLUMN		40516
+#define IDM_FILE_COMPARE_FILE			40517
+#define IDM_FILE_COMPARE_SAVED			40518
+#define IDM_FILE_COMPARE_NEXT			40519
+#define IDM_FILE_COMPARE_PREV			40520
+#define IDM_FILE_COMPARE_CLEAR			40521
+#define IDM_FILE_OPENRANGE				40522
+#define IDM_EDIT_SELECTTAGCONTENTS		40523
+#define IDM_FILE_STATISTICS				40524
+#define IDM_EDIT_MARKTERMS				40525
+#define IDM_EDIT_MARKTERMS_CLEAR		40526
+
 #define IDM_TRAY_RESTORE				40600
 #define IDM_TRAY_EXIT					40601
 
@@ -837,6 +902,12 @@
 #define IDS_LOCKED						50041
 #define IDS_BINARY_FILE_LOCKED			50042
 #define IDS_CHANGE_LANG_RESTART			50043
+#define IDS_AUTOSAVE_RECOVER			50044
+#define IDS_JSON_INVALID				50045
+#define IDS_COMPARE_IDENTICAL			50046
+#define IDS_COMPARE_RESULT				50047
+#define IDS_COMPARE_MORE_LINES			50048
+#define IDS_STYLING_DEGRADED			50049
 #define IDS_CMDLINEHELP					60000
 #define IDS_EOLMODENAME_CRLF			62000
 #define IDS_EOLMODENAME_LF				62001
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+# Large document corpus for scintilla/CorpusBench.cpp and comparison of its results against a baseline.
+import sys
+import os.path
+import json
+import random
+
+# same as findText in CorpusBench.cpp, every document contains it
+Marker = 'np2mark'
+# distinct blocks per document, larger documents repeat them
+BlockCount = 16
+BlockSize = 1024*1024
+
+Words = ['value', 'index', 'count', 'buffer', 'length', 'position', 'style', 'line', 'text', 'result',
+	'request', 'response', 'session', 'client', 'server', 'cache', 'query', 'token', 'config', 'handler']
+
+def make_log_block(rand, index):
+	levels = ['INFO', 'INFO', 'INFO', 'DEBUG', 'WARN', 'ERROR']
+	lines = []
+	size = 0
+	seconds = index*3600
+	while size < BlockSize:
+		seconds += rand.randrange(3)
+		hour, minute, second = (seconds // 3600) % 24, (seconds // 60) % 60, seconds % 60
+		words = ' '.join(rand.choice(Words) for _ in range(rand.randrange(4, 16)))
+		mark = Marker if rand.randrange(50) == 0 else ''
+		line = f'2024-01-{index % 28 + 1:02d} {hour:02d}:{minute:02d}:{second:02d}.{rand.randrange(1000):03d} [{rand.choice(levels):5}] thread-{rand.randrange(64)} {words} {mark} id={rand.randrange(1 << 32):08x}\n'
+		lines.append(line)
+		size += len(line)
+	return ''.join(lines)
+
+def make_js_block(rand, index):
+	# minified code, one line for each block
+	parts = []
+	size = 0
+	while size < BlockSize:
+		name = rand.choice(Words)
+		arg = rand.choice(Words)
+		kind = rand.randrange(4)
+		if kind == 0:
+			part = f'function {name}{index}_{size}({arg},b){{if({arg}>b){{return {arg}-b}}return "{Marker}"+b}}'
+		elif kind == 1:
+			part = f'var {name}=[{",".join(str(rand.randrange(1000)) for _ in range(rand.randrange(2, 12)))}];'
+		elif kind == 2:
+			part = f'for(var i=0;i<{name}.length;i++){{{arg}+={name}[i]*{rand.randrange(100)}}}'
+		else:
+			part = f'{name}.{arg}=function(e){{return e&&e.{rand.choice(Words)}?/[a-z]+\\d*/g.test(e):!1}};'
+		parts.append(part)
+		size += len(part)
+	parts.append('\n')
+	return ''.join(parts)
+
+def make_json_block(rand, index):
+	# one object for each block, members are nested up to depth levels
+	depth = 48
+	lines = ['{"block": %d, "items": [\n' % index]
+	size = 0
+	while size < BlockSize:
+		for level in range(1, depth + 1):
+			indent = '  '*level
+			items = ', '.join(f'"{rand.choice(Words)}": {rand.randrange(100000)}' for _ in range(rand.randrange(1, 4)))
+			mark = f', "{Marker}": true' if rand.randrange(20) == 0 else ''
+			tail = ', "child":' if level < depth else '}'
+			line = f'{indent}{{"level": {level}, {items}{mark}{tail}\n'
+			lines.append(line)
+			size += len(line)
+		line = '  ' + '}'*(depth - 1) + ',\n'
+		lines.append(line)
+		size += len(line)
+	lines.append('  null]}')
+	return ''.join(lines)
+
+def make_xml_block(rand, index):
+	# one element for each block, children are nested up to depth levels
+	depth = 40
+	lines = [f'<block index="{index}">\n']
+	size = 0
+	while size < BlockSize:
+		tags = []
+		for level in range(1, depth + 1):
+			indent = ' '*level
+			tag = f'{rand.choice(Words)}{level}'
+			text = Marker if rand.randrange(20) == 0 else ' '.join(rand.choice(Words) for _ in range(rand.randrange(1, 6)))
+			line = f'{indent}<{tag} {rand.choice(Words)}="{rand.randrange(100000)}">{text}<!-- {rand.choice(Words)} --><item/>\n'
+			lines.append(line)
+			size += len(line)
+			tags.append(tag)
+		for level in range(depth, 0, -1):
+			line = f'{" "*level}</{tags[level - 1]}>\n'
+			lines.append(line)
+			size += len(line)
+	lines.append('</block>\n')
+	return ''.join(lines)
+
+def make_csv_block(rand, index):
+	columns = 200
+	lines = []
+	size = 0
+	row = index*100000
+	while size < BlockSize:
+		fields = [str(row)]
+		for column in range(1, columns):
+			kind = column % 4
+			if kind == 0:
+				fields.append(str(rand.randrange(1000000)))
+			elif kind == 1:
+				fields.append(f'{rand.random()*1000:.3f}')
+			elif kind == 2:
+				fields.append(rand.choice(Words))
+			else:
+				fields.append(f'"{rand.choice(Words)}, {rand.choice(Words)}"')
+		if rand.randrange(10) == 0:
+			fields[rand.randrange(1, columns)] = Marker
+		line = ','.join(fields) + '\n'
+		lines.append(line)
+		size += len(line)
+		row += 1
+	return ''.join(lines)
+
+# text that can be encoded in every code page used by the mixed encoding documents
+MixedText = {
+	'utf8': ['English text', 'Français déjà vu', 'Ελληνικά', 'Русский текст', '中文文本', '日本語のテキスト', '한국어 텍스트', 'emoji 😀🚀'],
+	'utf16le': ['English text', 'Français déjà vu', 'Ελληνικά', 'Русский текст', '中文文本', '日本語のテキスト', '한국어 텍스트', 'emoji 😀🚀'],
+	'cp936': ['English text', '中文文本', '简体中文', '全角字符：１２３', 'Русский текст'],
+	'cp1252': ['English text', 'Français déjà vu', 'Deutsch Größe', 'Español niño', '€ price'],
+}
+
+def make_mixed_block(rand, index, encoding):
+	texts = MixedText[encoding]
+	lines = []
+	size = 0
+	while size < BlockSize:
+		words = ' '.join(rand.choice(texts) for _ in range(rand.randrange(2, 8)))
+		mark = f' {Marker}' if rand.randrange(50) == 0 else ''
+		line = f'{index}\t{words}{mark}\n'
+		lines.append(line)
+		size += len(line.encode('utf-8'))
+	return ''.join(lines)
+
+Workloads = [
+	# file name, MiB, block function, prefix, separator, suffix
+	('log.utf8.log', 1024, make_log_block, '', '', ''),
+	('minified.utf8.js', 64, make_js_block, '', '', ''),
+	('nested.utf8.json', 64, make_json_block, '[\n', ',\n', '\n]\n'),
+	('nested.utf8.xml', 64, make_xml_block, '<?xml version="1.0" encoding="UTF-8"?>\n<root>\n', '', '</root>\n'),
+	('wide.utf8.csv', 128, make_csv_block, '', '', ''),
+	('mixed.utf8.txt', 32, lambda rand, index: make_mixed_block(rand, index, 'utf8'), '', '', ''),
+	('mixed.utf16le.txt', 32, lambda rand, index: make_mixed_block(rand, index, 'utf16le'), '\ufeff', '', ''),
+	('mixed.cp936.txt', 32, lambda rand, index: make_mixed_block(rand, index, 'cp936'), '', '', ''),
+	('mixed.cp1252.txt', 32, lambda rand, index: make_mixed_block(rand, index, 'cp1252'), '', '', ''),
+]
+
+def python_encoding(name):
+	encoding = name.split('.')[1]
+	if encoding == 'utf8':
+		return 'utf-8'
+	if encoding == 'utf16le':
+		return 'utf-16-le'
+	return encoding
+
+def generate_corpus(corpus, scale=1.0):
+	# fixed seed for each document, output is the same on every run and every machine
+	os.makedirs(corpus, exist_ok=True)
+	for name, size, make_block, prefix, separator, suffix in Workloads:
+		path = os.path.join(corpus, name)
+		encoding = python_encoding(name)
+		size = max(1, int(size*scale))*1024*1024
+		rand = random.Random(name)
+		blocks = []
+		written = 0
+		with open(path, 'wb') as fd:
+			fd.write(prefix.encode(encoding))
+			index = 0
+			while written < size:
+				if index < BlockCount:
+					blocks.append(make_block(rand, index).encode(encoding))
+				if index != 0 and separator:
+					fd.write(separator.encode(encoding))
+				block = blocks[index % BlockCount]
+				fd.write(block)
+				written += len(block)
+				index += 1
+			fd.write(suffix.encode(encoding))
+		print('generate:', path, written >> 20, 'MiB')
+
+def load_result(path):
+	with open(path, encoding='utf-8') as fd:
+		items = json.load(fd)
+	return {(item['file'], item['op']): item for item in items if 'op' in item}
+
+def compare_result(baseline_path, result_path, tolerance=10.0, slack=1.0):
+	# regression when slower than baseline by more than tolerance percent and slack milliseconds
+	baseline = load_result(baseline_path)
+	result = load_result(result_path)
+	regression = 0
+	print(f'{"file":24} {"op":12} {"baseline ms":>12} {"ms":>12} {"change":>8}')
+	for key, item in result.items():
+		base = baseline.get(key)
+		if base is None:
+			print(f'{key[0]:24} {key[1]:12} {"":>12} {item["ms"]:12.3f} {"new":>8}')
+			continue
+		base_ms = base['ms']
+		current_ms = item['ms']
+		change = (current_ms - base_ms)*100/base_ms if base_ms > 0 else 0
+		status = ''
+		if current_ms > base_ms*(1 + tolerance/100) + slack:
+			status = ' REGRESSION'
+			regression += 1
+		print(f'{key[0]:24} {key[1]:12} {base_ms:12.3f} {current_ms:12.3f} {change:+7.1f}%{status}')
+	for key in baseline:
+		if key not in result:
+			print(f'{key[0]:24} {key[1]:12} {baseline[key]["ms"]:12.3f} {"":>12} {"missing":>8}')
+	print(f'{regression} regression(s) over {tolerance}% tolerance')
+	return regression == 0
+
+if __name__ == '__main__':
+	if len(sys.argv) > 2 and sys.argv[1] == 'generate':
+		generate_corpus(sys.argv[2], float(sys.argv[3]) if len(sys.argv) > 3 else 1.0)
+	elif len(sys.argv) > 3 and sys.argv[1] == 'compare':
+		ok = compare_result(sys.argv[2], sys.argv[3], float(sys.argv[4]) if len(sys.argv) > 4 else 10.0)
+		sys.exit(0 if ok else 1)
+	else:
+		print("""Usage: %s generate corpus [scale]
+       %s compare baseline.json result.json [tolerance percent]
+
+generate    write deterministic documents into corpus, scale multiplies default sizes (1 GiB log).
+compare     compare output of `CorpusBench -json corpus` against a baseline, exit code is 1
+            when any operation is slower than tolerance (default 10%%) plus 1 ms.""" % (sys.argv[0], sys.argv[0]))